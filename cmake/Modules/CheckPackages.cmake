@@ -54,3 +54,10 @@ if (DBUS)
         PURPOSE "Required by the DBUS feature"
     )
 endif()
+if (IO_URING)
+    if (LibtorrentRasterbar_VERSION VERSION_LESS ${minLibtorrentVersion})
+        message(FATAL_ERROR "IO_URING feature requires libtorrent >= ${minLibtorrentVersion}")
+    endif()
+    include(FindPkgConfig)
+    pkg_check_modules(liburing REQUIRED IMPORTED_TARGET GLOBAL "liburing")
+endif()
@@ -109,3 +109,7 @@ endif()
 if (LibtorrentRasterbar_VERSION VERSION_GREATER_EQUAL ${minLibtorrentVersion})
     target_compile_definitions(qbt_common_cfg INTERFACE QBT_USES_LIBTORRENT2)
 endif()
+
+if (IO_URING)
+    target_compile_definitions(qbt_common_cfg INTERFACE QBT_USES_IO_URING)
+endif()
@@ -46,8 +46,10 @@
 #include <QByteArray>
 #include <QDebug>
 #include <QLibraryInfo>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QMetaObject>
-#include <QProcess>
+#include <QTimer>
 
 #ifndef DISABLE_GUI
 #include <QAbstractButton>
@@ -81,13 +83,18 @@
 #include "base/search/searchpluginmanager.h"
 #include "base/settingsstorage.h"
 #include "base/torrentfileswatcher.h"
+#include "base/tracing.h"
 #include "base/utils/fs.h"
+#include "base/utils/io.h"
 #include "base/utils/misc.h"
 #include "base/utils/os.h"
 #include "base/utils/string.h"
 #include "base/version.h"
 #include "applicationinstancemanager.h"
+#include "externalprogramrunner.h"
 #include "filelogger.h"
+#include "shardsupervisor.h"
+#include "stallwatchdog.h"
 #include "upgrade.h"
 
 #ifndef DISABLE_GUI
@@ -113,6 +120,8 @@ namespace
 
     const QString LOG_FOLDER = u"logs"_s;
     const QChar PARAMS_SEPARATOR = u'|';
+    // the parameters received from other instances within this period are processed together
+    const std::chrono::milliseconds PARAMS_COALESCING_DELAY {300};
 
     const Path DEFAULT_PORTABLE_MODE_PROFILE_DIR {u"profile"_s};
 
@@ -120,6 +129,11 @@ namespace
     const int MAX_FILELOG_SIZE = 1000 * 1024 * 1024; // 1000MiB
     const int DEFAULT_FILELOG_SIZE = 65 * 1024; // 65KiB
 
+    const QString STALL_REPORT_FILENAME = u"qbittorrent-stalls.log"_s;
+    const int MIN_STALL_THRESHOLD = 100; // ms
+    const int MAX_STALL_THRESHOLD = 60000; // ms
+    const int DEFAULT_STALL_THRESHOLD = 1000; // ms
+
 #ifndef DISABLE_GUI
     const int PIXMAP_CACHE_SIZE = 64 * 1024 * 1024;  // 64MiB
 #endif
@@ -235,6 +249,8 @@ Application::Application(int &argc, char **argv)
     , m_storeFileLoggerAgeType(FILELOGGER_SETTINGS_KEY(u"AgeType"_s))
     , m_storeFileLoggerPath(FILELOGGER_SETTINGS_KEY(u"Path"_s))
     , m_storeMemoryWorkingSetLimit(SETTINGS_KEY(u"MemoryWorkingSetLimit"_s))
+    , m_storeStallWatchdogEnabled(SETTINGS_KEY(u"StallWatchdog/Enabled"_s))
+    , m_storeStallWatchdogThreshold(SETTINGS_KEY(u"StallWatchdog/ThresholdMs"_s))
 #ifdef Q_OS_WIN
     , m_processMemoryPriority(SETTINGS_KEY(u"ProcessMemoryPriority"_s))
 #endif
@@ -243,6 +259,8 @@ Application::Application(int &argc, char **argv)
     , m_storeNotificationTorrentAdded(NOTIFICATIONS_SETTINGS_KEY(u"TorrentAdded"_s))
 #endif
 {
+    m_startupTimer.start();
+
     qRegisterMetaType<Log::Msg>("Log::Msg");
     qRegisterMetaType<Log::Peer>("Log::Peer");
 
@@ -285,6 +303,12 @@ Application::Application(int &argc, char **argv)
 
     connect(this, &QCoreApplication::aboutToQuit, this, &Application::cleanup);
     connect(m_instanceManager, &ApplicationInstanceManager::messageReceived, this, &Application::processMessage);
+
+    m_paramsCoalescingTimer = new QTimer(this);
+    m_paramsCoalescingTimer->setSingleShot(true);
+    m_paramsCoalescingTimer->setInterval(PARAMS_COALESCING_DELAY);
+    connect(m_paramsCoalescingTimer, &QTimer::timeout, this, &Application::processQueuedParams);
+
 #if defined(Q_OS_WIN) && !defined(DISABLE_GUI)
     connect(this, &QGuiApplication::commitDataRequest, this, &Application::shutdownCleanup, Qt::DirectConnection);
 #endif
@@ -301,10 +325,22 @@ Application::Application(int &argc, char **argv)
     {
         LogMsg(tr("Using config directory: %1").arg(Profile::instance()->location(SpecialFolder::Config).toString()));
     }
+    finishStartupPhase(u"profile and settings"_s, 0);
 
     if (isFileLoggerEnabled())
         m_fileLogger = new FileLogger(fileLoggerPath(), isFileLoggerBackup(), fileLoggerMaxSize(), isFileLoggerDeleteOld(), fileLoggerAge(), static_cast<FileLogger::FileLogAgeType>(fileLoggerAgeType()));
 
+    if (!m_commandLineArgs.traceFile.isEmpty())
+    {
+        Tracing::setEnabled(true);
+        LogMsg(tr("Tracing is enabled. Trace will be saved to: %1").arg(m_commandLineArgs.traceFile.toString()));
+    }
+
+    if (isStallWatchdogEnabled())
+        m_stallWatchdog = new StallWatchdog(std::chrono::milliseconds(stallWatchdogThreshold()), (fileLoggerPath() / Path(STALL_REPORT_FILENAME)), this);
+
+    m_externalProgramRunner = new ExternalProgramRunner(this);
+
     if (m_commandLineArgs.webUIPort > 0) // it will be -1 when user did not set any value
         Preferences::instance()->setWebUIPort(m_commandLineArgs.webUIPort);
 
@@ -392,6 +428,37 @@ void Application::setMemoryWorkingSetLimit(const int size)
 #endif
 }
 
+bool Application::isStallWatchdogEnabled() const
+{
+    return m_storeStallWatchdogEnabled.get(false);
+}
+
+void Application::setStallWatchdogEnabled(const bool value)
+{
+    if (value && !m_stallWatchdog)
+        m_stallWatchdog = new StallWatchdog(std::chrono::milliseconds(stallWatchdogThreshold()), (fileLoggerPath() / Path(STALL_REPORT_FILENAME)), this);
+    else if (!value)
+        delete m_stallWatchdog;
+    m_storeStallWatchdogEnabled = value;
+}
+
+int Application::stallWatchdogThreshold() const
+{
+    const int val = m_storeStallWatchdogThreshold.get(DEFAULT_STALL_THRESHOLD);
+    return std::clamp(val, MIN_STALL_THRESHOLD, MAX_STALL_THRESHOLD);
+}
+
+void Application::setStallWatchdogThreshold(const int milliseconds)
+{
+    const int clampedValue = std::clamp(milliseconds, MIN_STALL_THRESHOLD, MAX_STALL_THRESHOLD);
+    if (clampedValue == stallWatchdogThreshold())
+        return;
+
+    m_storeStallWatchdogThreshold = clampedValue;
+    if (m_stallWatchdog)
+        m_stallWatchdog->setThreshold(std::chrono::milliseconds(clampedValue));
+}
+
 bool Application::isFileLoggerEnabled() const
 {
     return m_storeFileLoggerEnabled.get(true);
@@ -502,13 +569,11 @@ void Application::processMessage(const QString &message)
     }
 #endif
 
-    const QBtCommandLineParameters params = parseParams(message);
     // If Application is not allowed to process params immediately
-    // (i.e., other components are not ready) store params
+    // (i.e., other components are not ready) they are processed once it gets ready
+    m_paramsQueue.append(parseParams(message));
     if (m_isProcessingParamsAllowed)
-        processParams(params);
-    else
-        m_paramsQueue.append(params);
+        m_paramsCoalescingTimer->start();
 }
 
 void Application::runExternalProgram(const QString &programTemplate, const BitTorrent::Torrent *torrent) const
@@ -576,12 +641,19 @@ void Application::runExternalProgram(const QString &programTemplate, const BitTo
         return str;
     };
 
-    const QString logMsg = tr("Running external program. Torrent: \"%1\". Command: `%2`");
-    const QString logMsgError = tr("Failed to run external program. Torrent: \"%1\". Command: `%2`");
+    const Preferences *pref = Preferences::instance();
+    // the batch is shared by many torrents, so their variables are passed in input only
+    const bool isBatchMode = pref->isAutoRunBatchModeEnabled();
+    const auto expand = [&replaceVariables, isBatchMode](const QString &str)
+    {
+        return isBatchMode ? str : replaceVariables(str);
+    };
+
+    ExternalProgramRunner::Command command;
 
     // The processing sequenece is different for Windows and other OS, this is intentional
 #if defined(Q_OS_WIN)
-    const QString program = replaceVariables(programTemplate);
+    const QString program = expand(programTemplate);
     const std::wstring programWStr = program.toStdWString();
 
     // Need to split arguments manually because QProcess::startDetached(QString)
@@ -597,35 +669,9 @@ void Application::runExternalProgram(const QString &programTemplate, const BitTo
     for (int i = 1; i < argCount; ++i)
         argList += QString::fromWCharArray(args[i]);
 
-    QProcess proc;
-    proc.setProgram(QString::fromWCharArray(args[0]));
-    proc.setArguments(argList);
-    proc.setCreateProcessArgumentsModifier([](QProcess::CreateProcessArguments *args)
-    {
-        if (Preferences::instance()->isAutoRunConsoleEnabled())
-        {
-            args->flags |= CREATE_NEW_CONSOLE;
-            args->flags &= ~(CREATE_NO_WINDOW | DETACHED_PROCESS);
-        }
-        else
-        {
-            args->flags |= CREATE_NO_WINDOW;
-            args->flags &= ~(CREATE_NEW_CONSOLE | DETACHED_PROCESS);
-        }
-        args->inheritHandles = false;
-        args->startupInfo->dwFlags &= ~STARTF_USESTDHANDLES;
-        ::CloseHandle(args->startupInfo->hStdInput);
-        ::CloseHandle(args->startupInfo->hStdOutput);
-        ::CloseHandle(args->startupInfo->hStdError);
-        args->startupInfo->hStdInput = nullptr;
-        args->startupInfo->hStdOutput = nullptr;
-        args->startupInfo->hStdError = nullptr;
-    });
-
-    if (proc.startDetached())
-        LogMsg(logMsg.arg(torrent->name(), program));
-    else
-        LogMsg(logMsgError.arg(torrent->name(), program));
+    command.program = QString::fromWCharArray(args[0]);
+    command.arguments = argList;
+    command.displayText = program;
 #else // Q_OS_WIN
     QStringList args = Utils::String::splitCommand(programTemplate);
 
@@ -638,25 +684,42 @@ void Application::runExternalProgram(const QString &programTemplate, const BitTo
         if (arg.startsWith(u'"') && arg.endsWith(u'"'))
             arg = arg.mid(1, (arg.size() - 2));
 
-        arg = replaceVariables(arg);
+        arg = expand(arg);
     }
 
-    const QString command = args.takeFirst();
-    QProcess proc;
-    proc.setProgram(command);
-    proc.setArguments(args);
+    command.program = args.takeFirst();
+    command.arguments = args;
+    // show intended command in log
+    command.displayText = expand(programTemplate);
+#endif
 
-    if (proc.startDetached())
-    {
-        // show intended command in log
-        LogMsg(logMsg.arg(torrent->name(), replaceVariables(programTemplate)));
-    }
-    else
+    m_externalProgramRunner->setMaxConcurrent(pref->autoRunMaxConcurrentPrograms());
+    if (!isBatchMode)
     {
-        // show intended command in log
-        LogMsg(logMsgError.arg(torrent->name(), replaceVariables(programTemplate)));
+        m_externalProgramRunner->run(command, torrent->name());
+        return;
     }
-#endif
+
+    QJsonArray tags;
+    for (const Tag &tag : asConst(torrent->tags()))
+        tags.append(tag.toString());
+
+    const BitTorrent::InfoHash infoHash = torrent->infoHash();
+    const QJsonObject torrentData {
+        {u"id"_s, torrent->id().toString()},
+        {u"name"_s, torrent->name()},
+        {u"category"_s, torrent->category()},
+        {u"tags"_s, tags},
+        {u"content_path"_s, torrent->contentPath().toString()},
+        {u"root_path"_s, torrent->rootPath().toString()},
+        {u"save_path"_s, torrent->savePath().toString()},
+        {u"files_count"_s, torrent->filesCount()},
+        {u"total_size"_s, torrent->totalSize()},
+        {u"tracker"_s, torrent->currentTracker()},
+        {u"infohash_v1"_s, (infoHash.v1().isValid() ? infoHash.v1().toString() : QString())},
+        {u"infohash_v2"_s, (infoHash.v2().isValid() ? infoHash.v2().toString() : QString())}
+    };
+    m_externalProgramRunner->addToBatch(programTemplate, command, torrentData);
 }
 
 void Application::sendNotificationEmail(const BitTorrent::Torrent *torrent)
@@ -671,8 +734,10 @@ void Application::sendNotificationEmail(const BitTorrent::Torrent *torrent)
 
     // Send the notification email
     const Preferences *pref = Preferences::instance();
-    auto *smtp = new Net::Smtp(this);
-    smtp->sendMail(pref->getMailNotificationSender(),
+    // notifications of torrents finished in burst share the connection
+    if (!m_smtp || m_smtp->isClosing())
+        m_smtp = new Net::Smtp(this);
+    m_smtp->sendMail(pref->getMailNotificationSender(),
                      pref->getMailNotificationEmail(),
                      tr("Torrent \"%1\" has finished downloading").arg(torrent->name()),
                      content);
@@ -799,14 +864,49 @@ void Application::processParams(const QBtCommandLineParameters &params)
     AddTorrentOption addTorrentOption = AddTorrentOption::Default;
     if (params.skipDialog.has_value())
         addTorrentOption = params.skipDialog.value() ? AddTorrentOption::SkipDialog : AddTorrentOption::ShowDialog;
-    for (const QString &torrentSource : params.torrentSources)
-        m_addTorrentManager->addTorrent(torrentSource, params.addTorrentParams, addTorrentOption);
+    m_addTorrentManager->addTorrents(params.torrentSources, params.addTorrentParams, addTorrentOption);
 #else
+    if (!m_shardSupervisor)
+    {
+        m_addTorrentManager->addTorrents(params.torrentSources, params.addTorrentParams);
+        return;
+    }
+
+    QList<QStringList> sourcesByShard {m_shardSupervisor->shardCount()};
     for (const QString &torrentSource : params.torrentSources)
-        m_addTorrentManager->addTorrent(torrentSource, params.addTorrentParams);
+        sourcesByShard[m_shardSupervisor->shardOf(torrentSource)].append(torrentSource);
+
+    m_addTorrentManager->addTorrents(sourcesByShard[0], params.addTorrentParams);
+    for (int i = 1; i < sourcesByShard.size(); ++i)
+    {
+        if (!sourcesByShard[i].isEmpty())
+            m_shardSupervisor->addTorrents(i, sourcesByShard[i], params.addTorrentParams, params.skipDialog.value_or(false));
+    }
 #endif
 }
 
+void Application::processQueuedParams()
+{
+    // parameters of the instances started in burst are merged, so their torrents are added together
+    QList<QBtCommandLineParameters> mergedParams;
+    for (const QBtCommandLineParameters &params : asConst(m_paramsQueue))
+    {
+        if (!mergedParams.isEmpty() && (mergedParams.last().skipDialog == params.skipDialog)
+                && (mergedParams.last().addTorrentParams == params.addTorrentParams))
+        {
+            mergedParams.last().torrentSources += params.torrentSources;
+        }
+        else
+        {
+            mergedParams.append(params);
+        }
+    }
+    m_paramsQueue.clear();
+
+    for (const QBtCommandLineParameters &params : asConst(mergedParams))
+        processParams(params);
+}
+
 int Application::exec()
 {
 #if !defined(DISABLE_WEBUI) && defined(DISABLE_GUI)
@@ -823,10 +923,51 @@ int Application::exec()
     adjustThreadPriority();
 #endif
 
+    qint64 phaseStart = m_startupTimer.elapsed();
     Net::ProxyConfigurationManager::initInstance();
     Net::DownloadManager::initInstance();
+    phaseStart = finishStartupPhase(u"network"_s, phaseStart);
 
     BitTorrent::Session::initInstance();
+    const qint64 restoreStart = finishStartupPhase(u"BitTorrent session"_s, phaseStart);
+
+#ifdef DISABLE_GUI
+    if (m_commandLineArgs.shardCount > 1)
+    {
+        const ShardSupervisor::Settings shardSettings
+        {
+            .shardCount = m_commandLineArgs.shardCount,
+            .profileDir = m_commandLineArgs.profileDir,
+            .configurationName = m_commandLineArgs.configurationName,
+            .relativeFastresumePaths = m_commandLineArgs.relativeFastresumePaths,
+            .webUIPort = Preferences::instance()->getWebUIPort(),
+            .torrentingPort = BitTorrent::Session::instance()->port()
+        };
+        m_shardSupervisor = new ShardSupervisor(shardSettings, this);
+        LogMsg(tr("Torrents are spread over %1 instances").arg(m_commandLineArgs.shardCount));
+    }
+#endif
+
+    // Subsystems which don't depend on the torrents are started while the torrents are being restored,
+    // so their loading overlaps with the resume data being read by the storage thread
+    phaseStart = m_startupTimer.elapsed();
+    Net::GeoIPManager::initInstance();
+    phaseStart = finishStartupPhase(u"GeoIP database"_s, phaseStart);
+
+    new RSS::Session; // create RSS::Session singleton
+    finishStartupPhase(u"RSS feeds"_s, phaseStart);
+
+    if (Preferences::instance()->isSearchEnabled())
+    {
+        // plugin discovery may need to run python, let the torrents restoring start first
+        QMetaObject::invokeMethod(this, [this]
+        {
+            const qint64 searchPhaseStart = m_startupTimer.elapsed();
+            SearchPluginManager::instance();
+            finishStartupPhase(u"search plugins"_s, searchPhaseStart);
+        }, Qt::QueuedConnection);
+    }
+
 #ifndef DISABLE_GUI
     UIThemeManager::initInstance();
 
@@ -862,19 +1003,18 @@ int Application::exec()
         connect(m_desktopIntegration, &DesktopIntegration::activationRequested, this, &Application::createStartupProgressDialog);
     }
 #endif
-    connect(BitTorrent::Session::instance(), &BitTorrent::Session::restored, this, [this]()
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::restored, this, [this, restoreStart]()
     {
+        qint64 phaseStart = finishStartupPhase(u"torrents restoring"_s, restoreStart);
+
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentAdded, this, &Application::torrentAdded);
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentFinished, this, &Application::torrentFinished);
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::allTorrentsFinished, this, &Application::allTorrentsFinished, Qt::QueuedConnection);
 
         m_addTorrentManager = new AddTorrentManagerImpl(this, BitTorrent::Session::instance(), this);
-
-        Net::GeoIPManager::initInstance();
         TorrentFilesWatcher::initInstance();
-
-        new RSS::Session; // create RSS::Session singleton
         new RSS::AutoDownloader(this); // create RSS::AutoDownloader singleton
+        phaseStart = finishStartupPhase(u"torrent adding services"_s, phaseStart);
 
 #ifndef DISABLE_GUI
         const auto *btSession = BitTorrent::Session::instance();
@@ -915,6 +1055,7 @@ int Application::exec()
         m_window = new MainWindow(this, windowState, instanceName());
 
         delete m_startupProgressDialog;
+        phaseStart = finishStartupPhase(u"main window"_s, phaseStart);
 #endif // DISABLE_GUI
 
 #ifndef DISABLE_WEBUI
@@ -960,12 +1101,13 @@ int Application::exec()
             printf("%s\n", qUtf8Printable(tr("The WebUI is disabled! To enable the WebUI, edit the config file manually.")));
         }
 #endif // DISABLE_GUI
+        finishStartupPhase(u"WebUI"_s, phaseStart);
 #endif // DISABLE_WEBUI
 
+        LogMsg(tr("Startup finished in %1 ms").arg(m_startupTimer.elapsed()));
+
         m_isProcessingParamsAllowed = true;
-        for (const QBtCommandLineParameters &params : m_paramsQueue)
-            processParams(params);
-        m_paramsQueue.clear();
+        processQueuedParams();
     });
 
     const QBtCommandLineParameters params = commandLineArgs();
@@ -975,6 +1117,14 @@ int Application::exec()
     return BaseApplication::exec();
 }
 
+// Logs the duration of startup phase and returns the time it finished at
+qint64 Application::finishStartupPhase(const QString &name, const qint64 phaseStart) const
+{
+    const qint64 now = m_startupTimer.elapsed();
+    LogMsg(tr("Startup phase \"%1\" took %2 ms (%3 ms since start)").arg(name, QString::number(now - phaseStart), QString::number(now)));
+    return now;
+}
+
 bool Application::hasAnotherInstance() const
 {
     return !m_instanceManager->isFirstInstance();
@@ -1095,11 +1245,10 @@ bool Application::event(QEvent *ev)
         QBtCommandLineParameters params;
         params.torrentSources.append(path);
         // If Application is not allowed to process params immediately
-        // (i.e., other components are not ready) store params
+        // (i.e., other components are not ready) they are processed once it gets ready
+        m_paramsQueue.append(params);
         if (m_isProcessingParamsAllowed)
-            processParams(params);
-        else
-            m_paramsQueue.append(params);
+            m_paramsCoalescingTimer->start();
 
         return true;
     }
@@ -1316,6 +1465,12 @@ void Application::cleanup()
 
     LogMsg(tr("qBittorrent termination initiated"));
 
+#ifdef DISABLE_GUI
+    // the shards shut down along with this instance
+    if (m_shardSupervisor)
+        m_shardSupervisor->stop();
+#endif
+
 #ifndef DISABLE_GUI
     if (m_desktopIntegration)
     {
@@ -1360,6 +1515,10 @@ void Application::cleanup()
     TorrentFilesWatcher::freeInstance();
     delete m_addTorrentManager;
     BitTorrent::Session::freeInstance();
+    delete m_externalProgramRunner;
+#ifdef DISABLE_GUI
+    delete m_shardSupervisor;
+#endif
     Net::GeoIPManager::freeInstance();
     Net::DownloadManager::freeInstance();
     Net::ProxyConfigurationManager::freeInstance();
@@ -1369,6 +1528,15 @@ void Application::cleanup()
     Utils::Fs::removeDirRecursively(Utils::Fs::tempPath());
 
     LogMsg(tr("qBittorrent is now ready to exit"));
+    if (!m_commandLineArgs.traceFile.isEmpty())
+    {
+        Tracing::setEnabled(false);
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(m_commandLineArgs.traceFile, Tracing::toChromeTraceJson());
+        if (!result)
+            LogMsg(tr("Couldn't save trace. File: \"%1\". Error: \"%2\"").arg(m_commandLineArgs.traceFile.toString(), result.error()), Log::WARNING);
+    }
+
+    delete m_stallWatchdog;
     Logger::freeInstance();
     delete m_fileLogger;
 
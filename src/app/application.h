@@ -34,6 +34,7 @@
 
 #include <QtSystemDetection>
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QPointer>
 #include <QStringList>
 #include <QTranslator>
@@ -54,19 +55,29 @@
 #endif
 
 class ApplicationInstanceManager;
+class ExternalProgramRunner;
 class FileLogger;
+class ShardSupervisor;
+class StallWatchdog;
 
 namespace BitTorrent
 {
     class Torrent;
 }
 
+namespace Net
+{
+    class Smtp;
+}
+
 namespace RSS
 {
     class Session;
     class AutoDownloader;
 }
 
+class QTimer;
+
 #ifndef DISABLE_GUI
 class QProgressDialog;
 
@@ -127,6 +138,11 @@ public:
     int memoryWorkingSetLimit() const override;
     void setMemoryWorkingSetLimit(int size) override;
 
+    bool isStallWatchdogEnabled() const override;
+    void setStallWatchdogEnabled(bool value) override;
+    int stallWatchdogThreshold() const override;
+    void setStallWatchdogThreshold(int milliseconds) override;
+
     void sendTestEmail() const override;
 
 #ifdef Q_OS_WIN
@@ -163,7 +179,9 @@ private:
 #endif
 
     void initializeTranslation();
+    qint64 finishStartupPhase(const QString &name, qint64 phaseStart) const;
     void processParams(const QBtCommandLineParameters &params);
+    void processQueuedParams();
     void runExternalProgram(const QString &programTemplate, const BitTorrent::Torrent *torrent) const;
     void sendNotificationEmail(const BitTorrent::Torrent *torrent);
 
@@ -190,14 +208,22 @@ private:
     bool m_isProcessingParamsAllowed = false;
     ShutdownDialogAction m_shutdownAct = ShutdownDialogAction::Exit;
     QBtCommandLineParameters m_commandLineArgs;
+    QElapsedTimer m_startupTimer;
 
     // FileLog
     QPointer<FileLogger> m_fileLogger;
+    QPointer<StallWatchdog> m_stallWatchdog;
+    QPointer<ExternalProgramRunner> m_externalProgramRunner;
+    QPointer<Net::Smtp> m_smtp;
+#ifdef DISABLE_GUI
+    QPointer<ShardSupervisor> m_shardSupervisor;
+#endif
 
     QTranslator m_qtTranslator;
     QTranslator m_translator;
 
     QList<QBtCommandLineParameters> m_paramsQueue;
+    QTimer *m_paramsCoalescingTimer = nullptr;
 
     SettingValue<QString> m_storeInstanceName;
     SettingValue<bool> m_storeFileLoggerEnabled;
@@ -208,6 +234,8 @@ private:
     SettingValue<int> m_storeFileLoggerAgeType;
     SettingValue<Path> m_storeFileLoggerPath;
     SettingValue<int> m_storeMemoryWorkingSetLimit;
+    SettingValue<bool> m_storeStallWatchdogEnabled;
+    SettingValue<int> m_storeStallWatchdogThreshold;
 
 #ifdef Q_OS_WIN
     SettingValue<MemoryPriority> m_processMemoryPriority;
@@ -29,6 +29,7 @@
 #include "applicationinstancemanager.h"
 
 #include <QtSystemDetection>
+#include <QThread>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -47,6 +48,17 @@ ApplicationInstanceManager::ApplicationInstanceManager(const Path &instancePath,
 {
     connect(m_peer, &QtLocalPeer::messageReceived, this, &ApplicationInstanceManager::messageReceived);
 
+    if (m_isFirstInstance)
+    {
+        // Receiving the messages blocks while the client socket is read,
+        // so it is done in dedicated thread not to stall the GUI when many instances are started at once
+        m_ipcThread.reset(new QThread);
+        m_peer->setParent(nullptr);
+        m_peer->moveToThread(m_ipcThread.get());
+        connect(m_ipcThread.get(), &QThread::finished, m_peer, &QObject::deleteLater);
+        m_ipcThread->start();
+    }
+
 #ifdef Q_OS_WIN
     const QString sharedMemoryKey = instancePath.data() + u"/shared-memory";
     auto sharedMem = new QSharedMemory(sharedMemoryKey, this);
@@ -31,6 +31,7 @@
 #include <QObject>
 
 #include "base/pathfwd.h"
+#include "base/utils/thread.h"
 
 class QtLocalPeer;
 
@@ -53,4 +54,5 @@ signals:
 private:
     QtLocalPeer *m_peer = nullptr;
     const bool m_isFirstInstance;
+    Utils::Thread::UniquePtr m_ipcThread;
 };
@@ -30,6 +30,7 @@
 
 #include "cmdoptions.h"
 
+#include <algorithm>
 #include <cstdio>
 
 #include <QCoreApplication>
@@ -314,9 +315,14 @@ namespace
 #endif
     constexpr const IntOption WEBUI_PORT_OPTION {"webui-port"};
     constexpr const IntOption TORRENTING_PORT_OPTION {"torrenting-port"};
+#ifdef DISABLE_GUI
+    constexpr const IntOption SHARDS_OPTION {"shards"};
+    const int MAX_SHARD_COUNT = 64;
+#endif
     constexpr const StringOption PROFILE_OPTION {"profile"};
     constexpr const StringOption CONFIGURATION_OPTION {"configuration"};
     constexpr const BoolOption RELATIVE_FASTRESUME {"relative-fastresume"};
+    constexpr const StringOption TRACE_OPTION {"trace"};
     constexpr const StringOption SAVE_PATH_OPTION {"save-path"};
     constexpr const TriStateBoolOption STOPPED_OPTION {"add-stopped", true};
     constexpr const BoolOption SKIP_HASH_CHECK_OPTION {"skip-hash-check"};
@@ -336,9 +342,13 @@ QBtCommandLineParameters::QBtCommandLineParameters(const QProcessEnvironment &en
 #endif
     , webUIPort(WEBUI_PORT_OPTION.value(env, -1))
     , torrentingPort(TORRENTING_PORT_OPTION.value(env, -1))
+#ifdef DISABLE_GUI
+    , shardCount(std::clamp(SHARDS_OPTION.value(env, 1), 1, MAX_SHARD_COUNT))
+#endif
     , skipDialog(SKIP_DIALOG_OPTION.value(env))
     , profileDir(Utils::Fs::toAbsolutePath(Path(PROFILE_OPTION.value(env))))
     , configurationName(CONFIGURATION_OPTION.value(env))
+    , traceFile(Utils::Fs::toAbsolutePath(Path(TRACE_OPTION.value(env))))
 {
     addTorrentParams.savePath = Path(SAVE_PATH_OPTION.value(env));
     addTorrentParams.category = CATEGORY_OPTION.value(env);
@@ -390,6 +400,17 @@ QBtCommandLineParameters parseCommandLine(const QStringList &args)
                                                     .arg(u"--torrenting-port"_s));
                 }
             }
+#ifdef DISABLE_GUI
+            else if (arg == SHARDS_OPTION)
+            {
+                result.shardCount = SHARDS_OPTION.value(arg);
+                if ((result.shardCount < 1) || (result.shardCount > MAX_SHARD_COUNT))
+                {
+                    throw CommandLineParameterError(QCoreApplication::translate("CMD Options", "%1 must specify a number from 1 to %2.")
+                                                    .arg(u"--shards"_s, QString::number(MAX_SHARD_COUNT)));
+                }
+            }
+#endif
 #ifndef DISABLE_GUI
             else if (arg == NO_SPLASH_OPTION)
             {
@@ -413,6 +434,10 @@ QBtCommandLineParameters parseCommandLine(const QStringList &args)
             {
                 result.configurationName = CONFIGURATION_OPTION.value(arg);
             }
+            else if (arg == TRACE_OPTION)
+            {
+                result.traceFile = Utils::Fs::toAbsolutePath(Path(TRACE_OPTION.value(arg)));
+            }
             else if (arg == SAVE_PATH_OPTION)
             {
                 result.addTorrentParams.savePath = Path(SAVE_PATH_OPTION.value(arg));
@@ -504,6 +529,12 @@ QString makeUsage(const QString &prgName)
         + TORRENTING_PORT_OPTION.usage(QCoreApplication::translate("CMD Options", "port"))
         + wrapText(QCoreApplication::translate("CMD Options", "Change the torrenting port"))
         + u'\n'
+#ifdef DISABLE_GUI
+        + SHARDS_OPTION.usage(QCoreApplication::translate("CMD Options", "count"))
+        + wrapText(QCoreApplication::translate("CMD Options", "Spread the torrents over <count> instances with their own sessions "
+                                "to use more CPU cores. Additional instances use configurations named after this one "
+                                "and the ports following its ports")) + u'\n'
+#endif
 #ifndef DISABLE_GUI
         + NO_SPLASH_OPTION.usage() + wrapText(QCoreApplication::translate("CMD Options", "Disable splash screen")) + u'\n'
 #elif !defined(Q_OS_WIN)
@@ -517,6 +548,9 @@ QString makeUsage(const QString &prgName)
         + RELATIVE_FASTRESUME.usage()
         + wrapText(QCoreApplication::translate("CMD Options", "Hack into libtorrent fastresume files and make file paths relative "
                                 "to the profile directory")) + u'\n'
+        + TRACE_OPTION.usage(QCoreApplication::translate("CMD Options", "file"))
+        + wrapText(QCoreApplication::translate("CMD Options", "Record timings of internal operations and save them to <file> "
+                                "in Chrome trace format on exit")) + u'\n'
         + Option::padUsageText(QCoreApplication::translate("CMD Options", "files or URLs"))
         + wrapText(QCoreApplication::translate("CMD Options", "Download the torrents passed by the user")) + u'\n'
         + u'\n'
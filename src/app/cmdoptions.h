@@ -56,9 +56,13 @@ struct QBtCommandLineParameters
 #endif
     int webUIPort = -1;
     int torrentingPort = -1;
+#ifdef DISABLE_GUI
+    int shardCount = 1;
+#endif
     std::optional<bool> skipDialog;
     Path profileDir;
     QString configurationName;
+    Path traceFile;
 
     QStringList torrentSources;
     BitTorrent::AddTorrentParams addTorrentParams;
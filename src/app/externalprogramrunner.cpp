@@ -0,0 +1,254 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "externalprogramrunner.h"
+
+#include <chrono>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QTimer>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/preferences.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // batch is run once no more torrents are added to it for this long
+    const std::chrono::milliseconds BATCH_DELAY = 1s;
+    const int MAX_BATCH_SIZE = 1000;
+    const std::chrono::milliseconds SHUTDOWN_TIMEOUT = 10s;
+
+#ifdef Q_OS_WIN
+    void setCreateProcessArgumentsModifier(QProcess &proc, const bool detached)
+    {
+        proc.setCreateProcessArgumentsModifier([detached](QProcess::CreateProcessArguments *args)
+        {
+            if (Preferences::instance()->isAutoRunConsoleEnabled())
+            {
+                args->flags |= CREATE_NEW_CONSOLE;
+                args->flags &= ~(CREATE_NO_WINDOW | DETACHED_PROCESS);
+            }
+            else
+            {
+                args->flags |= CREATE_NO_WINDOW;
+                args->flags &= ~(CREATE_NEW_CONSOLE | DETACHED_PROCESS);
+            }
+
+            // standard handles are used to pass the input to attached process
+            if (!detached)
+                return;
+
+            args->inheritHandles = false;
+            args->startupInfo->dwFlags &= ~STARTF_USESTDHANDLES;
+            ::CloseHandle(args->startupInfo->hStdInput);
+            ::CloseHandle(args->startupInfo->hStdOutput);
+            ::CloseHandle(args->startupInfo->hStdError);
+            args->startupInfo->hStdInput = nullptr;
+            args->startupInfo->hStdOutput = nullptr;
+            args->startupInfo->hStdError = nullptr;
+        });
+    }
+#endif
+}
+
+ExternalProgramRunner::ExternalProgramRunner(QObject *parent)
+    : QObject(parent)
+    , m_batchTimer {new QTimer(this)}
+{
+    m_batchTimer->setSingleShot(true);
+    m_batchTimer->setInterval(BATCH_DELAY);
+    connect(m_batchTimer, &QTimer::timeout, this, &ExternalProgramRunner::flushBatches);
+}
+
+ExternalProgramRunner::~ExternalProgramRunner()
+{
+    // the programs requested before exit are still run, they are likely to process completed torrents
+    flushBatches();
+    while (!m_queue.isEmpty())
+        start(m_queue.dequeue());
+
+    const QDeadlineTimer deadline {SHUTDOWN_TIMEOUT};
+    for (QProcess *proc : asConst(findChildren<QProcess *>()))
+        proc->waitForFinished(static_cast<int>(deadline.remainingTime()));
+}
+
+void ExternalProgramRunner::setMaxConcurrent(const int count)
+{
+    if (count == m_maxConcurrent)
+        return;
+
+    m_maxConcurrent = count;
+    startNext();
+}
+
+void ExternalProgramRunner::run(const Command &command, const QString &torrentName)
+{
+    enqueue({.command = command, .torrentName = torrentName});
+}
+
+void ExternalProgramRunner::addToBatch(const QString &key, const Command &command, const QJsonObject &torrent)
+{
+    Batch &batch = m_batches[key];
+    if (batch.torrents.isEmpty())
+        batch.command = command;
+    batch.torrents.append(torrent);
+
+    if (batch.torrents.size() >= MAX_BATCH_SIZE)
+    {
+        enqueue({.command = batch.command, .torrentsCount = static_cast<int>(batch.torrents.size())
+                , .input = QJsonDocument(batch.torrents).toJson(QJsonDocument::Compact)});
+        m_batches.remove(key);
+        return;
+    }
+
+    m_batchTimer->start();
+}
+
+void ExternalProgramRunner::flushBatches()
+{
+    m_batchTimer->stop();
+
+    for (const Batch &batch : asConst(m_batches))
+    {
+        enqueue({.command = batch.command, .torrentsCount = static_cast<int>(batch.torrents.size())
+                , .input = QJsonDocument(batch.torrents).toJson(QJsonDocument::Compact)});
+    }
+    m_batches.clear();
+}
+
+void ExternalProgramRunner::enqueue(Job job)
+{
+    // nothing needs to be tracked if the number of processes isn't limited
+    if ((m_maxConcurrent <= 0) && job.input.isEmpty())
+    {
+        startDetached(job);
+        return;
+    }
+
+    m_queue.enqueue(std::move(job));
+    startNext();
+}
+
+void ExternalProgramRunner::startNext()
+{
+    while (!m_queue.isEmpty() && ((m_maxConcurrent <= 0) || (m_runningCount < m_maxConcurrent)))
+        start(m_queue.dequeue());
+}
+
+void ExternalProgramRunner::start(const Job &job)
+{
+    auto *proc = new QProcess(this);
+    proc->setProgram(job.command.program);
+    proc->setArguments(job.command.arguments);
+    proc->setStandardOutputFile(QProcess::nullDevice());
+    proc->setStandardErrorFile(QProcess::nullDevice());
+    if (job.input.isEmpty())
+        proc->setStandardInputFile(QProcess::nullDevice());
+#ifdef Q_OS_WIN
+    setCreateProcessArgumentsModifier(*proc, false);
+#endif
+
+    ++m_runningCount;
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    const auto onProcessDone = [this, proc]
+    {
+        proc->disconnect(this);
+        proc->deleteLater();
+        --m_runningCount;
+        startNext();
+    };
+
+    connect(proc, &QProcess::errorOccurred, this, [this, proc, job, onProcessDone](const QProcess::ProcessError error)
+    {
+        if (error != QProcess::FailedToStart)
+            return;
+
+        logStarted(job, false);
+        onProcessDone();
+    });
+    connect(proc, &QProcess::started, this, [this, proc, job]
+    {
+        logStarted(job, true);
+        if (!job.input.isEmpty())
+        {
+            proc->write(job.input);
+            proc->closeWriteChannel();
+        }
+    });
+    connect(proc, &QProcess::finished, this, [job, elapsedTimer, onProcessDone](const int exitCode, const QProcess::ExitStatus exitStatus)
+    {
+        const QString exitCodeStr = (exitStatus == QProcess::NormalExit) ? QString::number(exitCode) : tr("crashed");
+        LogMsg(tr("External program finished. Command: `%1`. Exit code: %2. Elapsed time: %3 ms")
+                .arg(job.command.displayText, exitCodeStr, QString::number(elapsedTimer.elapsed())));
+        onProcessDone();
+    });
+
+    proc->start();
+}
+
+void ExternalProgramRunner::startDetached(const Job &job) const
+{
+    QProcess proc;
+    proc.setProgram(job.command.program);
+    proc.setArguments(job.command.arguments);
+#ifdef Q_OS_WIN
+    setCreateProcessArgumentsModifier(proc, true);
+#endif
+
+    logStarted(job, proc.startDetached());
+}
+
+void ExternalProgramRunner::logStarted(const Job &job, const bool success) const
+{
+    if (job.input.isEmpty())
+    {
+        const QString logMsg = success
+                ? tr("Running external program. Torrent: \"%1\". Command: `%2`")
+                : tr("Failed to run external program. Torrent: \"%1\". Command: `%2`");
+        LogMsg(logMsg.arg(job.torrentName, job.command.displayText));
+    }
+    else
+    {
+        const QString logMsg = success
+                ? tr("Running external program for %1 torrents. Command: `%2`")
+                : tr("Failed to run external program for %1 torrents. Command: `%2`");
+        LogMsg(logMsg.arg(QString::number(job.torrentsCount), job.command.displayText));
+    }
+}
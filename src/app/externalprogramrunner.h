@@ -0,0 +1,95 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+
+// Runs external programs so that no more than the configured number of them run at once,
+// the rest waits in queue. In batch mode the runs of the same command requested shortly one
+// after another are merged into single run which gets the torrents as JSON array on its stdin.
+class ExternalProgramRunner final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(ExternalProgramRunner)
+
+public:
+    struct Command
+    {
+        QString program;
+        QStringList arguments;
+        // intended command line shown in log
+        QString displayText;
+    };
+
+    explicit ExternalProgramRunner(QObject *parent = nullptr);
+    ~ExternalProgramRunner() override;
+
+    // 0 means unlimited, the programs are started detached then unless they get input
+    void setMaxConcurrent(int count);
+
+    void run(const Command &command, const QString &torrentName);
+    // the runs added with the same key until the batch is flushed share single process
+    void addToBatch(const QString &key, const Command &command, const QJsonObject &torrent);
+
+private:
+    struct Job
+    {
+        Command command;
+        QString torrentName;
+        int torrentsCount = 1;
+        QByteArray input;
+    };
+
+    struct Batch
+    {
+        Command command;
+        QJsonArray torrents;
+    };
+
+    void enqueue(Job job);
+    void startNext();
+    void start(const Job &job);
+    void startDetached(const Job &job) const;
+    void logStarted(const Job &job, bool success) const;
+    void flushBatches();
+
+    int m_maxConcurrent = 0;
+    int m_runningCount = 0;
+    QQueue<Job> m_queue;
+    QHash<QString, Batch> m_batches;
+    QTimer *m_batchTimer = nullptr;
+};
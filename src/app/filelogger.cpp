@@ -29,162 +29,293 @@
 #include "filelogger.h"
 
 #include <chrono>
+#include <utility>
 
+#include <QByteArray>
 #include <QDateTime>
+#include <QDeadlineTimer>
 #include <QDir>
-#include <QTextStream>
-#include <QVector>
+#include <QMutexLocker>
+#include <QThread>
 
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/utils/fs.h"
+#include "base/utils/gzip.h"
+#include "base/utils/io.h"
 
 namespace
 {
-    const std::chrono::seconds FLUSH_INTERVAL {2};
+    const std::chrono::seconds WRITE_INTERVAL {2};
+    // wake up the writer before the interval expires if that many messages are pending
+    const int WAKE_THRESHOLD = 1000;
+    const qsizetype WRITE_BUFFER_SIZE = 256 * 1024;
+
+    QString typePrefix(const Log::MsgType type)
+    {
+        switch (type)
+        {
+        case Log::INFO:
+            return u"(I) "_s;
+        case Log::WARNING:
+            return u"(W) "_s;
+        case Log::CRITICAL:
+            return u"(C) "_s;
+        default:
+            return u"(N) "_s;
+        }
+    }
+
+    QByteArray formatMessage(const Log::MsgType type, const qint64 timestamp, const QString &message)
+    {
+        return (typePrefix(type) + QDateTime::fromSecsSinceEpoch(timestamp).toString(Qt::ISODate)
+                + u" - " + message + u'\n').toUtf8();
+    }
 }
 
 FileLogger::FileLogger(const Path &path, const bool backup
                        , const int maxSize, const bool deleteOld, const int age
                        , const FileLogAgeType ageType)
-    : m_backup(backup)
+    : m_path(path)
+    , m_backup(backup)
     , m_maxSize(maxSize)
+    , m_isPathChanged(true)
 {
-    m_flusher.setInterval(FLUSH_INTERVAL);
-    m_flusher.setSingleShot(true);
-    connect(&m_flusher, &QTimer::timeout, this, &FileLogger::flushLog);
-
-    changePath(path);
     if (deleteOld)
-        this->deleteOld(age, ageType);
+        m_deleteOldRequest = DeleteOldRequest {.age = age, .ageType = ageType};
 
-    const Logger *const logger = Logger::instance();
-    for (const Log::Msg &msg : asConst(logger->getMessages()))
-        addLogMessage(msg);
+    // The writer takes messages directly from the logger buffer, so nothing is copied here.
+    // Emitting thread only wakes the writer up when a lot of messages are pending.
+    connect(Logger::instance(), &Logger::newLogMessage, this, [this](const Log::Msg &msg)
+    {
+        if ((msg.id - m_lastWrittenId.load(std::memory_order_relaxed)) >= WAKE_THRESHOLD)
+            notifyWriter();
+    }, Qt::DirectConnection);
 
-    connect(logger, &Logger::newLogMessage, this, &FileLogger::addLogMessage);
+    m_thread.reset(QThread::create([this] { run(); }));
+    m_thread->start(QThread::LowPriority);
 }
 
 FileLogger::~FileLogger()
 {
-    closeLogFile();
+    disconnect(Logger::instance(), nullptr, this, nullptr);
+
+    {
+        const QMutexLocker locker {&m_mutex};
+        m_stopping = true;
+    }
+    m_wake.wakeAll();
+
+    m_thread->wait();
 }
 
 void FileLogger::changePath(const Path &newPath)
 {
+    const QMutexLocker locker {&m_mutex};
+
     // compare paths as strings to perform case sensitive comparison on all the platforms
-    if (newPath.data() == m_path.parentPath().data())
+    if (newPath.data() == m_path.data())
         return;
 
-    closeLogFile();
-
-    m_path = newPath / Path(u"qbittorrent.log"_s);
-    m_logFile.setFileName(m_path.data());
-
-    Utils::Fs::mkpath(newPath);
-    openLogFile();
+    m_path = newPath;
+    m_isPathChanged = true;
+    m_wake.wakeAll();
 }
 
 void FileLogger::deleteOld(const int age, const FileLogAgeType ageType)
 {
-    const QDateTime date = QDateTime::currentDateTime();
-    const QDir dir {m_path.parentPath().data()};
-    const QFileInfoList fileList = dir.entryInfoList(QStringList(u"qbittorrent.log.bak*"_s)
-        , (QDir::Files | QDir::Writable), (QDir::Time | QDir::Reversed));
-
-    for (const QFileInfo &file : fileList)
-    {
-        QDateTime modificationDate = file.lastModified();
-        switch (ageType)
-        {
-        case DAYS:
-            modificationDate = modificationDate.addDays(age);
-            break;
-        case MONTHS:
-            modificationDate = modificationDate.addMonths(age);
-            break;
-        default:
-            modificationDate = modificationDate.addYears(age);
-        }
-        if (modificationDate > date)
-            break;
-        Utils::Fs::removeFile(Path(file.absoluteFilePath()));
-    }
+    const QMutexLocker locker {&m_mutex};
+    m_deleteOldRequest = DeleteOldRequest {.age = age, .ageType = ageType};
+    m_wake.wakeAll();
 }
 
 void FileLogger::setBackup(const bool value)
 {
+    const QMutexLocker locker {&m_mutex};
     m_backup = value;
 }
 
 void FileLogger::setMaxSize(const int value)
 {
+    const QMutexLocker locker {&m_mutex};
     m_maxSize = value;
 }
 
-void FileLogger::addLogMessage(const Log::Msg &msg)
+void FileLogger::notifyWriter()
 {
-    if (!m_logFile.isOpen()) return;
+    if (m_hasPendingMessages.exchange(true))
+        return;
 
-    QTextStream stream(&m_logFile);
+    // lock is required so the writer cannot miss the wake-up between checking the flag and waiting
+    const QMutexLocker locker {&m_mutex};
+    m_wake.wakeAll();
+}
 
-    switch (msg.type)
+void FileLogger::run()
+{
+    bool stopping = false;
+    while (!stopping)
     {
-    case Log::INFO:
-        stream << QStringView(u"(I) ");
-        break;
-    case Log::WARNING:
-        stream << QStringView(u"(W) ");
-        break;
-    case Log::CRITICAL:
-        stream << QStringView(u"(C) ");
-        break;
-    default:
-        stream << QStringView(u"(N) ");
+        Path path;
+        bool isPathChanged = false;
+        bool backup = false;
+        qint64 maxSize = 0;
+        std::optional<DeleteOldRequest> deleteOldRequest;
+        {
+            QMutexLocker locker {&m_mutex};
+            if (!m_stopping && !m_isPathChanged && !m_deleteOldRequest && !m_hasPendingMessages)
+                m_wake.wait(&m_mutex, QDeadlineTimer(WRITE_INTERVAL));
+
+            stopping = m_stopping;
+            path = m_path;
+            isPathChanged = std::exchange(m_isPathChanged, false);
+            backup = m_backup;
+            maxSize = m_maxSize;
+            deleteOldRequest = std::exchange(m_deleteOldRequest, std::nullopt);
+        }
+        m_hasPendingMessages = false;
+
+        if (isPathChanged)
+        {
+            closeLogFile();
+            m_logFilePath = path / Path(u"qbittorrent.log"_s);
+            Utils::Fs::mkpath(path);
+            openLogFile();
+        }
+
+        writeMessages(backup, maxSize);
+
+        if (deleteOldRequest)
+            removeOldLogFiles(*deleteOldRequest);
     }
 
-    stream << QDateTime::fromSecsSinceEpoch(msg.timestamp).toString(Qt::ISODate) << QStringView(u" - ") << msg.message << QChar(u'\n');
+    closeLogFile();
+}
 
-    if (m_backup && (m_logFile.size() >= m_maxSize))
-    {
-        closeLogFile();
-        int counter = 0;
-        Path backupLogFilename = m_path + u".bak";
+void FileLogger::writeMessages(const bool backup, const qint64 maxSize)
+{
+    const Logger::MessagesView messages = Logger::instance()->messages(m_lastWrittenId.load(std::memory_order_relaxed));
+    if (messages.isEmpty())
+        return;
 
-        while (backupLogFilename.exists())
+    QByteArray buffer;
+    buffer.reserve(WRITE_BUFFER_SIZE);
+    const auto writeBuffer = [this, &buffer]
+    {
+        if (m_logFile.isOpen() && !buffer.isEmpty())
         {
-            ++counter;
-            backupLogFilename = m_path + u".bak" + QString::number(counter);
+            m_logFile.write(buffer);
+            m_logFileSize += buffer.size();
         }
+        buffer.clear();
+    };
 
-        Utils::Fs::renameFile(m_path, backupLogFilename);
-        openLogFile();
+    const int lastWrittenId = m_lastWrittenId.load(std::memory_order_relaxed);
+    const int droppedCount = messages.begin()->id - (lastWrittenId + 1);
+    if ((lastWrittenId >= 0) && (droppedCount > 0))
+    {
+        buffer += formatMessage(Log::WARNING, QDateTime::currentSecsSinceEpoch()
+            , tr("%1 log messages were discarded because they were produced faster than they could be written.").arg(droppedCount));
     }
-    else
+
+    for (const Log::Msg &msg : messages)
     {
-        if (!m_flusher.isActive())
-            m_flusher.start();
+        buffer += formatMessage(msg.type, msg.timestamp, msg.message);
+
+        if (backup && ((m_logFileSize + buffer.size()) >= maxSize))
+        {
+            writeBuffer();
+            rotateLogFile();
+        }
+        else if (buffer.size() >= WRITE_BUFFER_SIZE)
+        {
+            writeBuffer();
+        }
     }
+    writeBuffer();
+
+    m_lastWrittenId.store((messages.begin()->id + messages.size() - 1), std::memory_order_relaxed);
+}
+
+void FileLogger::rotateLogFile()
+{
+    closeLogFile();
+
+    int counter = 0;
+    Path backupLogFilename = m_logFilePath + u".bak";
+    while (backupLogFilename.exists() || (backupLogFilename + u".gz").exists())
+    {
+        ++counter;
+        backupLogFilename = m_logFilePath + u".bak" + QString::number(counter);
+    }
+
+    const bool isRenamed = Utils::Fs::renameFile(m_logFilePath, backupLogFilename);
+    openLogFile();
+
+    if (isRenamed)
+        compressLogFile(backupLogFilename);
+}
+
+void FileLogger::compressLogFile(const Path &path)
+{
+    const auto readResult = Utils::IO::readFile(path, -1);
+    if (!readResult)
+        return;
+
+    bool ok = false;
+    const QByteArray compressed = Utils::Gzip::compress(readResult.value(), 6, &ok);
+    if (!ok)
+        return;
+
+    // keep uncompressed backup if compressed one cannot be saved
+    if (Utils::IO::saveToFile((path + u".gz"), compressed))
+        Utils::Fs::removeFile(path);
 }
 
-void FileLogger::flushLog()
+void FileLogger::removeOldLogFiles(const DeleteOldRequest &request)
 {
-    if (m_logFile.isOpen())
-        m_logFile.flush();
+    const QDateTime date = QDateTime::currentDateTime();
+    const QDir dir {m_logFilePath.parentPath().data()};
+    const QFileInfoList fileList = dir.entryInfoList(QStringList(u"qbittorrent.log.bak*"_s)
+        , (QDir::Files | QDir::Writable), (QDir::Time | QDir::Reversed));
+
+    for (const QFileInfo &file : fileList)
+    {
+        QDateTime modificationDate = file.lastModified();
+        switch (request.ageType)
+        {
+        case DAYS:
+            modificationDate = modificationDate.addDays(request.age);
+            break;
+        case MONTHS:
+            modificationDate = modificationDate.addMonths(request.age);
+            break;
+        default:
+            modificationDate = modificationDate.addYears(request.age);
+        }
+        if (modificationDate > date)
+            break;
+        Utils::Fs::removeFile(Path(file.absoluteFilePath()));
+    }
 }
 
 void FileLogger::openLogFile()
 {
-    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)
+    m_logFile.setFileName(m_logFilePath.data());
+    // messages are buffered by the writer and written in large blocks
+    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text | QIODevice::Unbuffered)
         || !m_logFile.setPermissions(QFile::ReadOwner | QFile::WriteOwner))
     {
         m_logFile.close();
         LogMsg(tr("An error occurred while trying to open the log file. Logging to file is disabled."), Log::CRITICAL);
+        return;
     }
+
+    m_logFileSize = m_logFile.size();
 }
 
 void FileLogger::closeLogFile()
 {
-    m_flusher.stop();
     m_logFile.close();
+    m_logFileSize = 0;
 }
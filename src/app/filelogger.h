@@ -28,16 +28,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <optional>
+
 #include <QFile>
+#include <QMutex>
 #include <QObject>
-#include <QTimer>
+#include <QWaitCondition>
 
 #include "base/path.h"
 
-namespace Log
-{
-    struct Msg;
-}
+class QThread;
 
 class FileLogger : public QObject
 {
@@ -60,17 +62,41 @@ public:
     void setBackup(bool value);
     void setMaxSize(int value);
 
-private slots:
-    void addLogMessage(const Log::Msg &msg);
-    void flushLog();
-
 private:
+    struct DeleteOldRequest
+    {
+        int age = 0;
+        FileLogAgeType ageType = DAYS;
+    };
+
+    void notifyWriter();
+
+    // writer thread
+    void run();
+    void writeMessages(bool backup, qint64 maxSize);
+    void rotateLogFile();
+    void compressLogFile(const Path &path);
+    void removeOldLogFiles(const DeleteOldRequest &request);
     void openLogFile();
     void closeLogFile();
 
+    std::atomic_bool m_hasPendingMessages {false};
+    std::atomic_int m_lastWrittenId {-1};
+
+    // protected by m_mutex
+    QMutex m_mutex;
+    QWaitCondition m_wake;
     Path m_path;
-    bool m_backup;
-    int m_maxSize;
+    bool m_backup = false;
+    int m_maxSize = 0;
+    bool m_isPathChanged = false;
+    std::optional<DeleteOldRequest> m_deleteOldRequest;
+    bool m_stopping = false;
+
+    // owned by writer thread
+    Path m_logFilePath;
     QFile m_logFile;
-    QTimer m_flusher;
+    qint64 m_logFileSize = 0;
+
+    std::unique_ptr<QThread> m_thread;
 };
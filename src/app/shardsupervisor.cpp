@@ -0,0 +1,233 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "shardsupervisor.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDeadlineTimer>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTimer>
+
+#include "base/bittorrent/addtorrentparams.h"
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/torrentdescriptor.h"
+#include "base/global.h"
+#include "base/logger.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    const int MIN_RESTART_DELAY = 5000;
+    const int MAX_RESTART_DELAY = 60000;
+    // shards running for this long before they exit are restarted with the minimum delay
+    const std::chrono::milliseconds STABLE_RUN_DURATION = 1min;
+    const std::chrono::milliseconds STOP_TIMEOUT = 30s;
+
+    QProcessEnvironment shardEnvironment()
+    {
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        // the options of supervising instance must not be applied to the shards
+        env.remove(u"QBT_SHARDS"_s);
+        env.remove(u"QBT_DAEMON"_s);
+        env.remove(u"QBT_WEBUI_PORT"_s);
+        env.remove(u"QBT_TORRENTING_PORT"_s);
+        return env;
+    }
+}
+
+ShardSupervisor::ShardSupervisor(const Settings &settings, QObject *parent)
+    : QObject(parent)
+    , m_settings {settings}
+{
+    // shard 0 is this instance
+    m_shards.resize(std::max(1, m_settings.shardCount));
+    for (int i = 1; i < m_shards.size(); ++i)
+        startShard(i);
+}
+
+ShardSupervisor::~ShardSupervisor()
+{
+    stop();
+
+    const QDeadlineTimer deadline {STOP_TIMEOUT};
+    for (int i = 1; i < m_shards.size(); ++i)
+    {
+        const Shard &shard = m_shards[i];
+        if (!shard.process || (shard.process->state() == QProcess::NotRunning))
+            continue;
+
+        if (!shard.process->waitForFinished(std::max<qint64>(0, deadline.remainingTime())))
+        {
+            LogMsg(tr("Shard didn't exit in time, killing it. Configuration: \"%1\"").arg(configurationName(i))
+                , Log::WARNING);
+            shard.process->kill();
+            shard.process->waitForFinished();
+        }
+    }
+}
+
+int ShardSupervisor::shardCount() const
+{
+    return m_shards.size();
+}
+
+int ShardSupervisor::shardOf(const QString &torrentSource) const
+{
+    // the same torrent always goes to the same shard when its info hash is known from the source
+    QString key = torrentSource;
+    if (const auto parseResult = BitTorrent::TorrentDescriptor::parse(torrentSource)
+            ; parseResult && parseResult.value().infoHash().isValid())
+    {
+        key = parseResult.value().infoHash().toTorrentID().toString();
+    }
+
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+    const auto value = static_cast<quint32>(static_cast<uchar>(hash[0]))
+        | (static_cast<quint32>(static_cast<uchar>(hash[1])) << 8)
+        | (static_cast<quint32>(static_cast<uchar>(hash[2])) << 16);
+    return static_cast<int>(value % static_cast<quint32>(m_shards.size()));
+}
+
+void ShardSupervisor::addTorrents(const int shardIndex, const QStringList &sources
+        , const BitTorrent::AddTorrentParams &params, const bool skipDialog) const
+{
+    Q_ASSERT((shardIndex > 0) && (shardIndex < m_shards.size()));
+
+    QStringList arguments = identityArguments(shardIndex);
+    if (!params.savePath.isEmpty())
+        arguments.append(u"--save-path=" + params.savePath.toString());
+    if (params.addStopped.has_value())
+        arguments.append(u"--add-stopped=" + (*params.addStopped ? u"true"_s : u"false"_s));
+    if (params.skipChecking)
+        arguments.append(u"--skip-hash-check"_s);
+    if (!params.category.isEmpty())
+        arguments.append(u"--category=" + params.category);
+    if (params.sequential)
+        arguments.append(u"--sequential"_s);
+    if (params.firstLastPiecePriority)
+        arguments.append(u"--first-and-last"_s);
+    if (skipDialog)
+        arguments.append(u"--skip-dialog=true"_s);
+    arguments.append(sources);
+
+    // the started instance finds the shard running and forwards the torrents to it
+    QProcess process;
+    process.setProgram(QCoreApplication::applicationFilePath());
+    process.setArguments(arguments);
+    process.setProcessEnvironment(shardEnvironment());
+    if (!process.startDetached())
+    {
+        LogMsg(tr("Couldn't pass torrents to shard. Configuration: \"%1\"").arg(configurationName(shardIndex))
+            , Log::WARNING);
+    }
+}
+
+void ShardSupervisor::stop()
+{
+    if (m_isStopping)
+        return;
+
+    m_isStopping = true;
+    for (const Shard &shard : asConst(m_shards))
+    {
+        if (shard.process && (shard.process->state() != QProcess::NotRunning))
+            shard.process->terminate();
+    }
+}
+
+QString ShardSupervisor::configurationName(const int shardIndex) const
+{
+    const QString suffix = u"shard" + QString::number(shardIndex);
+    return m_settings.configurationName.isEmpty() ? suffix : (m_settings.configurationName + u'_' + suffix);
+}
+
+QStringList ShardSupervisor::identityArguments(const int shardIndex) const
+{
+    QStringList arguments {u"--configuration=" + configurationName(shardIndex)};
+    if (!m_settings.profileDir.isEmpty())
+        arguments.append(u"--profile=" + m_settings.profileDir.toString());
+    if (m_settings.relativeFastresumePaths)
+        arguments.append(u"--relative-fastresume"_s);
+    return arguments;
+}
+
+void ShardSupervisor::startShard(const int shardIndex)
+{
+    Shard &shard = m_shards[shardIndex];
+    if (!shard.process)
+    {
+        shard.process = new QProcess(this);
+        shard.process->setProcessChannelMode(QProcess::ForwardedChannels);
+
+        shard.process->setProcessEnvironment(shardEnvironment());
+
+        connect(shard.process, &QProcess::finished, this, [this, shardIndex]
+        {
+            handleShardFinished(shardIndex);
+        });
+    }
+
+    QStringList arguments = identityArguments(shardIndex);
+    arguments.append(u"--confirm-legal-notice"_s);
+    if (m_settings.webUIPort > 0)
+        arguments.append(u"--webui-port=" + QString::number(std::min(65535, (m_settings.webUIPort + shardIndex))));
+    if (m_settings.torrentingPort > 0)
+        arguments.append(u"--torrenting-port=" + QString::number(std::min(65535, (m_settings.torrentingPort + shardIndex))));
+
+    shard.runTimer.start();
+    shard.process->start(QCoreApplication::applicationFilePath(), arguments);
+    LogMsg(tr("Started shard. Configuration: \"%1\"").arg(configurationName(shardIndex)));
+}
+
+void ShardSupervisor::handleShardFinished(const int shardIndex)
+{
+    if (m_isStopping)
+        return;
+
+    Shard &shard = m_shards[shardIndex];
+    const bool ranStably = shard.runTimer.hasExpired(STABLE_RUN_DURATION.count());
+    shard.restartDelay = ranStably
+        ? MIN_RESTART_DELAY
+        : std::clamp((shard.restartDelay * 2), MIN_RESTART_DELAY, MAX_RESTART_DELAY);
+
+    LogMsg(tr("Shard exited unexpectedly, it will be restarted in %1 seconds. Configuration: \"%2\". Exit code: %3")
+        .arg(QString::number(shard.restartDelay / 1000), configurationName(shardIndex), QString::number(shard.process->exitCode()))
+        , Log::WARNING);
+
+    QTimer::singleShot(shard.restartDelay, this, [this, shardIndex]
+    {
+        if (!m_isStopping)
+            startShard(shardIndex);
+    });
+}
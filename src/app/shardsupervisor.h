@@ -0,0 +1,97 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "base/path.h"
+
+class QProcess;
+
+namespace BitTorrent
+{
+    struct AddTorrentParams;
+}
+
+// Runs the additional instances of qBittorrent ("shards") with their own sessions and resume data,
+// so the torrents spread over them can use more CPU cores than a single session can.
+// Each shard uses the configuration named after the one of this instance and listens on
+// the ports following the ports of this instance. Shards which exit unexpectedly are restarted.
+class ShardSupervisor final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(ShardSupervisor)
+
+public:
+    struct Settings
+    {
+        int shardCount = 1;
+        Path profileDir;
+        QString configurationName;
+        bool relativeFastresumePaths = false;
+        int webUIPort = 0;
+        // 0 means the shards pick their ports themselves
+        int torrentingPort = 0;
+    };
+
+    explicit ShardSupervisor(const Settings &settings, QObject *parent = nullptr);
+    // waits for the shards to exit
+    ~ShardSupervisor() override;
+
+    int shardCount() const;
+    // Returns index of the shard the torrent belongs to, 0 is this instance
+    int shardOf(const QString &torrentSource) const;
+    // the torrents are passed to the running shard as if they were opened with it
+    void addTorrents(int shardIndex, const QStringList &sources, const BitTorrent::AddTorrentParams &params
+            , bool skipDialog) const;
+
+    // asks the shards to exit, it doesn't wait for them
+    void stop();
+
+private:
+    struct Shard
+    {
+        QProcess *process = nullptr;
+        QElapsedTimer runTimer;
+        int restartDelay = 0;
+    };
+
+    QString configurationName(int shardIndex) const;
+    QStringList identityArguments(int shardIndex) const;
+    void startShard(int shardIndex);
+    void handleShardFinished(int shardIndex);
+
+    const Settings m_settings;
+    QList<Shard> m_shards;
+    bool m_isStopping = false;
+};
@@ -28,9 +28,69 @@
 
 #include "stacktrace.h"
 
+#ifdef Q_OS_UNIX
+#include <atomic>
+#include <csignal>
+#include <thread>
+#endif
+
 #include <boost/stacktrace.hpp>
 
+#ifdef Q_OS_UNIX
+namespace
+{
+    // Only async-signal-safe operations are allowed in the handler, so the stack is dumped
+    // as raw frame addresses and symbols are resolved afterwards by the requesting thread
+    boost::stacktrace::frame::native_frame_ptr_t dumpBuffer[128];
+    std::atomic<std::size_t> dumpedFrames {0};
+    std::atomic_bool isDumpReady {false};
+    bool isDumpPending = false;
+
+    void dumpStacktraceHandler(const int)
+    {
+        dumpedFrames.store(boost::stacktrace::safe_dump_to(dumpBuffer, sizeof(dumpBuffer)), std::memory_order_relaxed);
+        isDumpReady.store(true, std::memory_order_release);
+    }
+}
+#endif
+
 std::string getStacktrace()
 {
     return boost::stacktrace::to_string(boost::stacktrace::stacktrace());
 }
+
+#ifdef Q_OS_UNIX
+bool installThreadStacktraceHandler()
+{
+    struct sigaction action {};
+    action.sa_handler = dumpStacktraceHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return (sigaction(SIGUSR2, &action, nullptr) == 0);
+}
+
+std::string getThreadStacktrace(const pthread_t thread, const std::chrono::milliseconds timeout)
+{
+    // a handler which missed the previous timeout could still overwrite the buffer,
+    // so no new request is sent until it has finished
+    if (isDumpPending && !isDumpReady.load(std::memory_order_acquire))
+        return {};
+
+    isDumpReady.store(false, std::memory_order_relaxed);
+    if (pthread_kill(thread, SIGUSR2) != 0)
+        return {};
+
+    isDumpPending = true;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!isDumpReady.load(std::memory_order_acquire))
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return {};
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    isDumpPending = false;
+
+    const std::size_t frames = dumpedFrames.load(std::memory_order_relaxed);
+    return boost::stacktrace::to_string(boost::stacktrace::stacktrace::from_dump(dumpBuffer, (frames * sizeof(dumpBuffer[0]))));
+}
+#endif
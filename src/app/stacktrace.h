@@ -28,6 +28,21 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 
+#include <QtSystemDetection>
+
+#ifdef Q_OS_UNIX
+#include <pthread.h>
+#endif
+
 std::string getStacktrace();
+
+#ifdef Q_OS_UNIX
+// Must be called once before `getThreadStacktrace()` is used
+bool installThreadStacktraceHandler();
+// Interrupts `thread` and returns its current stack, empty string if it couldn't be captured in `timeout`.
+// Not reentrant, only one thread is supposed to request the stacks
+std::string getThreadStacktrace(pthread_t thread, std::chrono::milliseconds timeout);
+#endif
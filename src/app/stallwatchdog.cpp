@@ -0,0 +1,179 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "stallwatchdog.h"
+
+#include <optional>
+
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QFile>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
+#include "base/activityscope.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/utils/fs.h"
+
+#if defined(STACKTRACE) && defined(Q_OS_UNIX)
+#include "stacktrace.h"
+#endif
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    const std::chrono::milliseconds HEARTBEAT_INTERVAL = 50ms;
+    const std::chrono::milliseconds CHECK_INTERVAL = 50ms;
+#if defined(STACKTRACE) && defined(Q_OS_UNIX)
+    const std::chrono::milliseconds STACKTRACE_TIMEOUT = 500ms;
+#endif
+    const qint64 MAX_REPORT_FILE_SIZE = 1024 * 1024; // 1MiB
+
+    qint64 steadyNow()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+StallWatchdog::StallWatchdog(const std::chrono::milliseconds threshold, const Path &reportPath, QObject *parent)
+    : QObject(parent)
+    , m_heartbeatTimer {new QTimer(this)}
+    , m_lastBeat {steadyNow()}
+    , m_threshold {threshold.count()}
+    , m_reportPath {reportPath}
+#if defined(STACKTRACE) && defined(Q_OS_UNIX)
+    , m_mainThread {pthread_self()}
+#endif
+{
+#if defined(STACKTRACE) && defined(Q_OS_UNIX)
+    installThreadStacktraceHandler();
+#endif
+
+    m_heartbeatTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &StallWatchdog::beat);
+    m_heartbeatTimer->start(HEARTBEAT_INTERVAL);
+
+    m_thread.reset(QThread::create([this] { run(); }));
+    m_thread->start(QThread::HighPriority);
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    {
+        const QMutexLocker locker {&m_mutex};
+        m_stopping = true;
+    }
+    m_wake.wakeAll();
+
+    m_thread->wait();
+}
+
+void StallWatchdog::setThreshold(const std::chrono::milliseconds threshold)
+{
+    m_threshold.store(threshold.count(), std::memory_order_relaxed);
+}
+
+void StallWatchdog::beat()
+{
+    m_lastBeat.store(steadyNow(), std::memory_order_relaxed);
+}
+
+void StallWatchdog::run()
+{
+    // handler and stack are captured while the stall lasts, the report is finished once the main thread is back
+    std::optional<StallReport> currentStall;
+    qint64 stalledBeat = 0;
+
+    bool stopping = false;
+    while (!stopping)
+    {
+        {
+            QMutexLocker locker {&m_mutex};
+            if (!m_stopping)
+                m_wake.wait(&m_mutex, QDeadlineTimer(CHECK_INTERVAL));
+            stopping = m_stopping;
+        }
+
+        const qint64 lastBeat = m_lastBeat.load(std::memory_order_relaxed);
+        const qint64 now = steadyNow();
+
+        if (currentStall)
+        {
+            if (lastBeat == stalledBeat)
+                continue;
+
+            currentStall->duration = lastBeat - stalledBeat - HEARTBEAT_INTERVAL.count();
+            writeReport(*currentStall);
+
+            const QString message = tr("Main thread was blocked for %1 ms in %2").arg(QString::number(currentStall->duration), currentStall->handler);
+            QMetaObject::invokeMethod(this, [message] { LogMsg(message, Log::WARNING); }, Qt::QueuedConnection);
+
+            currentStall.reset();
+            continue;
+        }
+
+        // heartbeat is expected every HEARTBEAT_INTERVAL, anything later than that is the stall
+        if ((now - lastBeat - HEARTBEAT_INTERVAL.count()) < m_threshold.load(std::memory_order_relaxed))
+            continue;
+
+        const char *handler = ActivityScope::current();
+        currentStall = StallReport {
+            .startTime = QDateTime::currentMSecsSinceEpoch() - (now - lastBeat),
+            .handler = (handler ? QString::fromLatin1(handler) : tr("unknown handler"))
+        };
+#if defined(STACKTRACE) && defined(Q_OS_UNIX)
+        currentStall->stacktrace = QString::fromStdString(getThreadStacktrace(m_mainThread, STACKTRACE_TIMEOUT));
+#endif
+        stalledBeat = lastBeat;
+    }
+}
+
+void StallWatchdog::writeReport(const StallReport &report)
+{
+    if (m_reportPath.exists() && (QFile(m_reportPath.data()).size() >= MAX_REPORT_FILE_SIZE))
+    {
+        const Path backupPath = m_reportPath + u".bak";
+        Utils::Fs::removeFile(backupPath);
+        Utils::Fs::renameFile(m_reportPath, backupPath);
+    }
+
+    Utils::Fs::mkpath(m_reportPath.parentPath());
+    QFile file {m_reportPath.data()};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        return;
+
+    QString entry = QDateTime::fromMSecsSinceEpoch(report.startTime).toString(Qt::ISODateWithMs)
+            + u" - blocked for " + QString::number(report.duration) + u" ms in " + report.handler + u'\n';
+    if (!report.stacktrace.isEmpty())
+        entry += report.stacktrace + u'\n';
+    file.write(entry.toUtf8());
+}
@@ -0,0 +1,92 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+
+#include "base/path.h"
+
+#if defined(STACKTRACE) && defined(Q_OS_UNIX)
+#include <pthread.h>
+#endif
+
+class QThread;
+class QTimer;
+
+// Detects periods when the main thread event loop doesn't process events.
+// Main thread updates heartbeat timestamp periodically and the watchdog thread checks it,
+// once heartbeat is late by more than threshold the stall is attributed to the handler
+// marked by ActivityScope (and to the main thread stack, if it can be captured).
+// Finished stalls are appended to the report file and to the log.
+class StallWatchdog final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(StallWatchdog)
+
+public:
+    StallWatchdog(std::chrono::milliseconds threshold, const Path &reportPath, QObject *parent = nullptr);
+    ~StallWatchdog() override;
+
+    void setThreshold(std::chrono::milliseconds threshold);
+
+private:
+    struct StallReport
+    {
+        qint64 startTime = 0;
+        qint64 duration = 0;
+        QString handler;
+        QString stacktrace;
+    };
+
+    void beat();
+
+    // watchdog thread
+    void run();
+    void writeReport(const StallReport &report);
+
+    QTimer *m_heartbeatTimer = nullptr;
+    std::atomic<qint64> m_lastBeat {0};
+    std::atomic<qint64> m_threshold {0};
+    Path m_reportPath;
+#if defined(STACKTRACE) && defined(Q_OS_UNIX)
+    pthread_t m_mainThread;
+#endif
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stopping = false;
+
+    std::unique_ptr<QThread> m_thread;
+};
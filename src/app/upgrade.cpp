@@ -30,17 +30,21 @@
 
 #include <QtSystemDetection>
 #include <QCoreApplication>
+#include <QDir>
 #include <QMetaEnum>
+#include <QRegularExpression>
 
 #include "base/bittorrent/sharelimitaction.h"
 #include "base/bittorrent/torrentcontentlayout.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/net/proxyconfigurationmanager.h"
+#include "base/path.h"
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/settingsstorage.h"
 #include "base/settingvalue.h"
+#include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "base/utils/string.h"
 
@@ -478,6 +482,77 @@ namespace
         settingsStorage->storeValue(newKey, settingsStorage->loadValue<bool>(oldKey));
         settingsStorage->removeValue(oldKey);
     }
+
+    // Layout of fastresume files folder follows the user option which can be changed at any time,
+    // so files are moved between flat and sharded layouts on each startup rather than once.
+    void migrateResumeDataStorageLayout()
+    {
+        const bool sharded = SettingsStorage::instance()->loadValue<bool>(u"BitTorrent/Session/ShardedResumeDataStorage"_s);
+        const Path backupPath = specialFolderLocation(SpecialFolder::Data) / Path(u"BT_backup"_s);
+        if (!backupPath.exists())
+            return;
+
+        const QRegularExpression filenamePattern {u"^[A-Fa-f0-9]{40}\\.(fastresume|torrent|counters)$"_s};
+        int movedCount = 0;
+        const auto moveFile = [&movedCount](const Path &from, const Path &to)
+        {
+            if (!Utils::Fs::renameFile(from, to))
+            {
+                LogMsg(QCoreApplication::translate("Upgrade", "Couldn't move resume data file. Source: \"%1\". Destination: \"%2\"")
+                        .arg(from.toString(), to.toString()), Log::WARNING);
+                return;
+            }
+
+            ++movedCount;
+        };
+
+        if (sharded)
+        {
+            const QStringList filenames = QDir(backupPath.data()).entryList(QDir::Files);
+            for (const QString &filename : filenames)
+            {
+                if (!filenamePattern.match(filename).hasMatch())
+                    continue;
+
+                const Path shardPath = backupPath / Path(filename.left(2).toLower());
+                if (!shardPath.exists() && !Utils::Fs::mkdir(shardPath))
+                {
+                    LogMsg(QCoreApplication::translate("Upgrade", "Couldn't create resume data folder: \"%1\"")
+                            .arg(shardPath.toString()), Log::WARNING);
+                    continue;
+                }
+
+                moveFile((backupPath / Path(filename)), (shardPath / Path(filename)));
+            }
+        }
+        else
+        {
+            const QRegularExpression shardPattern {u"^[A-Fa-f0-9]{2}$"_s};
+            const QStringList shardNames = QDir(backupPath.data()).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+            for (const QString &shardName : shardNames)
+            {
+                if (!shardPattern.match(shardName).hasMatch())
+                    continue;
+
+                const Path shardPath = backupPath / Path(shardName);
+                const QStringList filenames = QDir(shardPath.data()).entryList(QDir::Files);
+                for (const QString &filename : filenames)
+                {
+                    if (filenamePattern.match(filename).hasMatch())
+                        moveFile((shardPath / Path(filename)), (backupPath / Path(filename)));
+                }
+
+                // it is only removed if nothing else is left there
+                Utils::Fs::rmdir(shardPath);
+            }
+        }
+
+        if (movedCount > 0)
+        {
+            LogMsg(QCoreApplication::translate("Upgrade", "Migrated resume data folder layout. Moved files: %1").arg(movedCount)
+                    , Log::INFO);
+        }
+    }
 }
 
 bool upgrade()
@@ -525,6 +600,8 @@ bool upgrade()
         version = MIGRATION_VERSION;
     }
 
+    migrateResumeDataStorageLayout();
+
     return true;
 }
 
@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt and libtorrent.
- * Copyright (C) 2019  sledgehammer999 <hammered999@gmail.com>
+ * Copyright (C) 2026  qBittorrent project
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -26,27 +26,26 @@
  * exception statement from your version.
  */
 
-#include "logfiltermodel.h"
+#include "activityscope.h"
 
-#include "logmodel.h"
+#include <atomic>
 
-LogFilterModel::LogFilterModel(const Log::MsgTypes types, QObject *parent)
-    : QSortFilterProxyModel(parent)
-    , m_types(types)
+namespace
 {
+    std::atomic<const char *> currentActivity {nullptr};
 }
 
-void LogFilterModel::setMessageTypes(const Log::MsgTypes types)
+ActivityScope::ActivityScope(const char *name) noexcept
+    : m_previous {currentActivity.exchange(name, std::memory_order_relaxed)}
 {
-    m_types = types;
-    invalidateRowsFilter();
 }
 
-bool LogFilterModel::filterAcceptsRow(const int sourceRow, const QModelIndex &sourceParent) const
+ActivityScope::~ActivityScope() noexcept
 {
-    const QAbstractItemModel *const sourceModel = this->sourceModel();
-    const QModelIndex index = sourceModel->index(sourceRow, 0, sourceParent);
-    const Log::MsgType type = static_cast<Log::MsgType>(sourceModel->data(index, BaseLogModel::TypeRole).toInt());
+    currentActivity.store(m_previous, std::memory_order_relaxed);
+}
 
-    return m_types.testFlag(type);
+const char *ActivityScope::current() noexcept
+{
+    return currentActivity.load(std::memory_order_relaxed);
 }
@@ -29,6 +29,8 @@
 
 #include "addtorrentmanager.h"
 
+#include <utility>
+
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrentdescriptor.h"
@@ -62,7 +64,7 @@ bool AddTorrentManager::addTorrent(const QString &source, const BitTorrent::AddT
         LogMsg(tr("Downloading torrent... Source: \"%1\"").arg(source));
         const auto *pref = Preferences::instance();
         // Launch downloader
-        Net::DownloadManager::instance()->download(Net::DownloadRequest(source).limit(pref->getTorrentFileSizeLimit())
+        Net::DownloadManager::instance()->download(Net::DownloadRequest(source).limit(pref->getTorrentFileSizeLimit()).priority(Net::DownloadPriority::High)
                 , pref->useProxyForGeneralPurposes(), this, &AddTorrentManager::onDownloadFinished);
         m_downloadedTorrents[source] = params;
         return true;
@@ -95,9 +97,50 @@ bool AddTorrentManager::addTorrent(const QString &source, const BitTorrent::AddT
     return false;
 }
 
+void AddTorrentManager::addTorrents(const QStringList &sources, const BitTorrent::AddTorrentParams &params)
+{
+    // files with individual file options can't share the batch parameters
+    if (!params.filePaths.isEmpty() || !params.filePriorities.isEmpty())
+    {
+        for (const QString &source : sources)
+            addTorrent(source, params);
+        return;
+    }
+
+    m_batchParams = params;
+    for (const QString &source : sources)
+        addTorrent(source, params);
+    m_batchParams.reset();
+
+    const QList<BatchedTorrent> batchedTorrents = std::exchange(m_batchedTorrents, {});
+    if (batchedTorrents.isEmpty())
+        return;
+
+    QList<BitTorrent::TorrentDescriptor> torrentDescrs;
+    torrentDescrs.reserve(batchedTorrents.size());
+    for (const BatchedTorrent &batchedTorrent : batchedTorrents)
+        torrentDescrs.append(batchedTorrent.torrentDescr);
+
+    btSession()->addTorrents(torrentDescrs, params);
+
+    // the torrents rejected by the session are logged by it
+    for (const BatchedTorrent &batchedTorrent : batchedTorrents)
+    {
+        const BitTorrent::InfoHash infoHash = batchedTorrent.torrentDescr.infoHash();
+        if (btSession()->isKnownTorrent(infoHash))
+            m_sourcesByInfoHash[infoHash] = batchedTorrent.source;
+    }
+}
+
 bool AddTorrentManager::addTorrentToSession(const QString &source, const BitTorrent::TorrentDescriptor &torrentDescr
         , const BitTorrent::AddTorrentParams &addTorrentParams)
 {
+    if (m_batchParams && (addTorrentParams == *m_batchParams))
+    {
+        m_batchedTorrents.append({.source = source, .torrentDescr = torrentDescr});
+        return true;
+    }
+
     const bool result = btSession()->addTorrent(torrentDescr, addTorrentParams);
     if (result)
        m_sourcesByInfoHash[torrentDescr.infoHash()] = source;
@@ -30,12 +30,16 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
 #include <QHash>
+#include <QList>
 #include <QObject>
+#include <QStringList>
 
 #include "base/applicationcomponent.h"
 #include "base/bittorrent/addtorrentparams.h"
+#include "base/bittorrent/torrentdescriptor.h"
 #include "base/torrentfileguard.h"
 
 namespace BitTorrent
@@ -43,7 +47,6 @@ namespace BitTorrent
     class InfoHash;
     class Session;
     class Torrent;
-    class TorrentDescriptor;
 }
 
 namespace Net
@@ -63,6 +66,9 @@ public:
 
     BitTorrent::Session *btSession() const;
     bool addTorrent(const QString &source, const BitTorrent::AddTorrentParams &params = {});
+    // The torrents which are available immediately (from files and magnet links) are added to the session
+    // in single batch, the ones being downloaded are added once they are downloaded.
+    void addTorrents(const QStringList &sources, const BitTorrent::AddTorrentParams &params = {});
 
 signals:
     void torrentAdded(const QString &source, BitTorrent::Torrent *torrent);
@@ -77,6 +83,12 @@ protected:
     std::shared_ptr<TorrentFileGuard> releaseTorrentFileGuard(const QString &source);
 
 private:
+    struct BatchedTorrent
+    {
+        QString source;
+        BitTorrent::TorrentDescriptor torrentDescr;
+    };
+
     void onDownloadFinished(const Net::DownloadResult &result);
     void onSessionTorrentAdded(BitTorrent::Torrent *torrent);
     void onSessionAddTorrentFailed(const BitTorrent::InfoHash &infoHash, const QString &reason);
@@ -87,4 +99,7 @@ private:
     QHash<QString, BitTorrent::AddTorrentParams> m_downloadedTorrents;
     QHash<BitTorrent::InfoHash, QString> m_sourcesByInfoHash;
     QHash<QString, std::shared_ptr<TorrentFileGuard>> m_guardedTorrentFiles;
+    // torrents collected by addTorrents() to be added to the session together
+    std::optional<BitTorrent::AddTorrentParams> m_batchParams;
+    QList<BatchedTorrent> m_batchedTorrents;
 };
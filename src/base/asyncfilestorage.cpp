@@ -28,8 +28,12 @@
 
 #include "asyncfilestorage.h"
 
+#include <algorithm>
+
 #include <QDebug>
 #include <QMetaObject>
+#include <QMutexLocker>
+#include <QTimer>
 
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
@@ -79,11 +83,34 @@ AsyncFileStorage::AsyncFileStorage(const Path &storageFolderPath, QObject *paren
     }
 }
 
-AsyncFileStorage::~AsyncFileStorage() = default;
+AsyncFileStorage::~AsyncFileStorage()
+{
+    // the worker can be stopped before the scheduled flush
+    flush();
+}
 
 void AsyncFileStorage::store(const Path &filePath, const QByteArray &data)
 {
-    QMetaObject::invokeMethod(this, [this, data, filePath] { store_impl(filePath, data); }, Qt::QueuedConnection);
+    {
+        const QMutexLocker locker {&m_pendingDataMutex};
+
+        const auto it = m_pendingData.find(filePath);
+        if (it != m_pendingData.end())
+        {
+            it.value() = data;
+            ++m_coalescedWriteCount;
+            return;
+        }
+
+        m_pendingData.insert(filePath, data);
+        m_pendingFiles.append(filePath);
+        if (m_isFlushScheduled)
+            return;
+
+        m_isFlushScheduled = true;
+    }
+
+    QMetaObject::invokeMethod(this, &AsyncFileStorage::scheduleFlush, Qt::QueuedConnection);
 }
 
 Path AsyncFileStorage::storageDir() const
@@ -91,11 +118,64 @@ Path AsyncFileStorage::storageDir() const
     return m_storageDir;
 }
 
+std::chrono::milliseconds AsyncFileStorage::flushLatency() const
+{
+    return std::chrono::milliseconds(m_flushLatency.load());
+}
+
+void AsyncFileStorage::setFlushLatency(const std::chrono::milliseconds latency)
+{
+    m_flushLatency = std::max<std::chrono::milliseconds::rep>(0, latency.count());
+}
+
+qsizetype AsyncFileStorage::queueDepth() const
+{
+    const QMutexLocker locker {&m_pendingDataMutex};
+    return m_pendingFiles.size();
+}
+
+qint64 AsyncFileStorage::writeCount() const
+{
+    return m_writeCount;
+}
+
+qint64 AsyncFileStorage::coalescedWriteCount() const
+{
+    return m_coalescedWriteCount;
+}
+
+void AsyncFileStorage::scheduleFlush()
+{
+    const std::chrono::milliseconds latency = flushLatency();
+    if (latency > std::chrono::milliseconds::zero())
+        QTimer::singleShot(latency, this, &AsyncFileStorage::flush);
+    else
+        flush();
+}
+
+void AsyncFileStorage::flush()
+{
+    QHash<Path, QByteArray> pendingData;
+    QList<Path> pendingFiles;
+    {
+        const QMutexLocker locker {&m_pendingDataMutex};
+        pendingData.swap(m_pendingData);
+        pendingFiles.swap(m_pendingFiles);
+        m_isFlushScheduled = false;
+    }
+
+    // all the files pending at once are written in single batch
+    // so the disk is synchronized for them one after another rather than interleaved with other work
+    for (const Path &fileName : pendingFiles)
+        store_impl(fileName, pendingData.value(fileName));
+}
+
 void AsyncFileStorage::store_impl(const Path &fileName, const QByteArray &data)
 {
     const Path filePath = m_storageDir / fileName;
     qDebug() << "AsyncFileStorage: Saving data to" << filePath.toString();
 
+    ++m_writeCount;
     const nonstd::expected<void, QString> result = Utils::IO::saveToFile(filePath, data);
     if (!result)
     {
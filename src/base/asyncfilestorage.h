@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 
 #include <QFile>
 #include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
 
@@ -53,19 +56,40 @@ public:
     explicit AsyncFileStorage(const Path &storageFolderPath, QObject *parent = nullptr);
     ~AsyncFileStorage() override;
 
+    // the data is written by the worker, when the same file is stored several times
+    // before it is written only the latest data is actually written
     void store(const Path &filePath, const QByteArray &data);
 
     Path storageDir() const;
 
+    // time the data waits for the newer versions before it is written
+    std::chrono::milliseconds flushLatency() const;
+    void setFlushLatency(std::chrono::milliseconds latency);
+
+    qsizetype queueDepth() const;
+    qint64 writeCount() const;
+    qint64 coalescedWriteCount() const;
+
 signals:
     void failed(const Path &filePath, const QString &errorString);
 
 private:
-    Q_INVOKABLE void store_impl(const Path &fileName, const QByteArray &data);
+    void scheduleFlush();
+    void flush();
+    void store_impl(const Path &fileName, const QByteArray &data);
 
     Path m_storageDir;
     std::shared_ptr<QFile> m_lockFile;
 
+    mutable QMutex m_pendingDataMutex;
+    QHash<Path, QByteArray> m_pendingData;
+    // keeps the files written in the order they were stored first
+    QList<Path> m_pendingFiles;
+    bool m_isFlushScheduled = false;
+    std::atomic<std::chrono::milliseconds::rep> m_flushLatency = 0;
+    std::atomic<qint64> m_writeCount = 0;
+    std::atomic<qint64> m_coalescedWriteCount = 0;
+
     static QHash<Path, std::weak_ptr<QFile>> m_reservedPaths;
     static QReadWriteLock m_reservedPathsLock;
 };
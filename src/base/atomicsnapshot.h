@@ -0,0 +1,89 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include <QtGlobal>
+
+// Holds an immutable value that can be read from any thread without locking.
+// Writers never modify the current value in place, they publish a replacement,
+// so readers keep using the snapshot they've got until they release it.
+template <typename T>
+class AtomicSnapshot
+{
+public:
+    using Pointer = std::shared_ptr<const T>;
+
+    AtomicSnapshot()
+        : m_value {std::make_shared<const T>()}
+    {
+    }
+
+    explicit AtomicSnapshot(T value)
+        : m_value {std::make_shared<const T>(std::move(value))}
+    {
+    }
+
+    AtomicSnapshot(const AtomicSnapshot &) = delete;
+    AtomicSnapshot &operator=(const AtomicSnapshot &) = delete;
+
+    Pointer load() const
+    {
+#ifdef __cpp_lib_atomic_shared_ptr
+        return m_value.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&m_value, std::memory_order_acquire);
+#endif
+    }
+
+    void store(Pointer value)
+    {
+        Q_ASSERT(value);
+#ifdef __cpp_lib_atomic_shared_ptr
+        m_value.store(std::move(value), std::memory_order_release);
+#else
+        std::atomic_store_explicit(&m_value, std::move(value), std::memory_order_release);
+#endif
+    }
+
+    void store(T value)
+    {
+        store(std::make_shared<const T>(std::move(value)));
+    }
+
+private:
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::atomic<Pointer> m_value;
+#else
+    Pointer m_value;
+#endif
+};
@@ -0,0 +1,77 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "announcescheduler.h"
+
+#include <algorithm>
+
+#include "base/algorithm.h"
+
+using namespace BitTorrent;
+
+AnnounceScheduler::AnnounceScheduler(const int announcesPerSecond)
+    : m_announcesPerSecond {std::max(1, announcesPerSecond)}
+{
+}
+
+int AnnounceScheduler::announcesPerSecond() const
+{
+    return m_announcesPerSecond;
+}
+
+void AnnounceScheduler::setAnnouncesPerSecond(const int announcesPerSecond)
+{
+    m_announcesPerSecond = std::max(1, announcesPerSecond);
+}
+
+std::chrono::milliseconds AnnounceScheduler::schedule(const QString &host, const Clock::time_point now)
+{
+    Clock::time_point &nextFreeSlot = m_nextFreeSlots[host];
+    const Clock::time_point slot = std::max(nextFreeSlot, now);
+    nextFreeSlot = slot + slotInterval();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(slot - now);
+}
+
+std::chrono::milliseconds AnnounceScheduler::pendingDelay(const QString &host, const Clock::time_point now) const
+{
+    const Clock::time_point nextFreeSlot = m_nextFreeSlots.value(host, now);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::max(nextFreeSlot, now) - now);
+}
+
+void AnnounceScheduler::purge(const Clock::time_point now)
+{
+    Algorithm::removeIf(m_nextFreeSlots, [now](const QString &, const Clock::time_point &nextFreeSlot)
+    {
+        return (nextFreeSlot <= now);
+    });
+}
+
+std::chrono::milliseconds AnnounceScheduler::slotInterval() const
+{
+    return std::chrono::milliseconds(1000) / m_announcesPerSecond;
+}
@@ -0,0 +1,65 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <QHash>
+#include <QString>
+
+namespace BitTorrent
+{
+    // Assigns announce slots to tracker hosts so that no host receives more than
+    // the given number of announces per second, announces exceeding the rate are delayed.
+    class AnnounceScheduler
+    {
+        Q_DISABLE_COPY_MOVE(AnnounceScheduler)
+
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit AnnounceScheduler(int announcesPerSecond = 1);
+
+        int announcesPerSecond() const;
+        void setAnnouncesPerSecond(int announcesPerSecond);
+
+        // reserves the next free slot of the host and returns delay until it
+        std::chrono::milliseconds schedule(const QString &host, Clock::time_point now = Clock::now());
+        // returns delay until the next free slot of the host without reserving it
+        std::chrono::milliseconds pendingDelay(const QString &host, Clock::time_point now = Clock::now()) const;
+        // forgets hosts which have no pending announces
+        void purge(Clock::time_point now = Clock::now());
+
+    private:
+        std::chrono::milliseconds slotInterval() const;
+
+        int m_announcesPerSecond = 1;
+        QHash<QString, Clock::time_point> m_nextFreeSlots;
+    };
+}
@@ -0,0 +1,122 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "bandwidthprofile.h"
+
+#include <algorithm>
+
+#include <QStringList>
+
+#include "base/global.h"
+
+namespace
+{
+    const int SECONDS_PER_DAY = 24 * 60 * 60;
+
+    int secondsOfDay(const QTime &time)
+    {
+        return QTime(0, 0).secsTo(time);
+    }
+}
+
+BandwidthProfile::BandwidthProfile(QList<Entry> entries, const std::chrono::seconds transitionTime)
+    : m_entries {std::move(entries)}
+    , m_transitionTime {transitionTime}
+{
+    // only the last entry with the same start time is kept
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry &left, const Entry &right)
+    {
+        return left.start < right.start;
+    });
+    const auto last = std::unique(m_entries.rbegin(), m_entries.rend(), [](const Entry &left, const Entry &right)
+    {
+        return left.start == right.start;
+    });
+    m_entries.erase(m_entries.begin(), last.base());
+}
+
+QList<BandwidthProfile::Entry> BandwidthProfile::parseEntries(const QString &str)
+{
+    QList<Entry> entries;
+    for (const QString &item : asConst(str.split(u',', Qt::SkipEmptyParts)))
+    {
+        const QStringList parts = item.split(u'=');
+        if (parts.size() != 2)
+            continue;
+
+        const QTime start = QTime::fromString(parts[0].trimmed(), u"HH:mm"_s);
+        bool ok = false;
+        const int percent = parts[1].trimmed().toInt(&ok);
+        if (start.isValid() && ok && (percent >= 1) && (percent <= 100))
+            entries.append({.start = start, .percent = percent});
+    }
+
+    return entries;
+}
+
+QString BandwidthProfile::entriesToString(const QList<Entry> &entries)
+{
+    QStringList items;
+    items.reserve(entries.size());
+    for (const Entry &entry : entries)
+        items.append(u"%1=%2"_s.arg(entry.start.toString(u"HH:mm"_s), QString::number(entry.percent)));
+
+    return items.join(u", "_s);
+}
+
+bool BandwidthProfile::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+QList<BandwidthProfile::Entry> BandwidthProfile::entries() const
+{
+    return m_entries;
+}
+
+int BandwidthProfile::percentAt(const QTime &time) const
+{
+    if (m_entries.isEmpty())
+        return 100;
+
+    const int seconds = secondsOfDay(time);
+    // the last profile of the day is still in effect before the first one starts
+    const auto nextIter = std::upper_bound(m_entries.cbegin(), m_entries.cend(), seconds
+        , [](const int value, const Entry &entry) { return value < secondsOfDay(entry.start); });
+    const qsizetype index = (nextIter == m_entries.cbegin())
+            ? (m_entries.size() - 1) : (std::distance(m_entries.cbegin(), nextIter) - 1);
+    const Entry &current = m_entries[index];
+    const Entry &previous = m_entries[(index + m_entries.size() - 1) % m_entries.size()];
+
+    const int elapsed = (seconds - secondsOfDay(current.start) + SECONDS_PER_DAY) % SECONDS_PER_DAY;
+    const auto transitionTime = static_cast<int>(m_transitionTime.count());
+    if (elapsed >= transitionTime)
+        return current.percent;
+
+    return previous.percent + (((current.percent - previous.percent) * elapsed) / transitionTime);
+}
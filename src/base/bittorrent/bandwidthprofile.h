@@ -0,0 +1,66 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <QList>
+#include <QString>
+#include <QTime>
+
+// Daily table of speed limit profiles. Each profile is in effect from its start time
+// until the start of the next one and scales the speed limits by its percentage.
+// The limits are changed gradually during the transition time after the start of
+// the profile, so the peers aren't all choked at once.
+class BandwidthProfile
+{
+public:
+    struct Entry
+    {
+        QTime start;
+        int percent = 100;
+
+        friend bool operator==(const Entry &left, const Entry &right) = default;
+    };
+
+    BandwidthProfile() = default;
+    BandwidthProfile(QList<Entry> entries, std::chrono::seconds transitionTime);
+
+    // entries are written as "HH:mm=percent" separated by commas, e.g. "07:00=30, 18:00=10, 22:00=100"
+    static QList<Entry> parseEntries(const QString &str);
+    static QString entriesToString(const QList<Entry> &entries);
+
+    bool isEmpty() const;
+    QList<Entry> entries() const;
+    int percentAt(const QTime &time) const;
+
+private:
+    QList<Entry> m_entries;
+    std::chrono::seconds m_transitionTime {0};
+};
@@ -47,14 +47,32 @@ BandwidthScheduler::BandwidthScheduler(QObject *parent)
 
 void BandwidthScheduler::start()
 {
-    m_lastAlternative = isTimeForAlternative();
-    emit bandwidthLimitRequested(m_lastAlternative);
+    const BandwidthProfile profile = loadProfile();
+    if (profile.isEmpty())
+    {
+        m_lastAlternative = isTimeForAlternative();
+        m_lastPercent = 100;
+        emit bandwidthLimitRequested(m_lastAlternative);
+    }
+    else
+    {
+        m_lastAlternative = false;
+        m_lastPercent = profile.percentAt(QTime::currentTime());
+    }
+    emit bandwidthPercentRequested(m_lastPercent);
 
     // Timeout regularly to accommodate for external system clock changes
     // eg from the user or from a timesync utility
     m_timer.start(30s);
 }
 
+BandwidthProfile BandwidthScheduler::loadProfile()
+{
+    const Preferences *const pref = Preferences::instance();
+    return {BandwidthProfile::parseEntries(pref->getSchedulerProfiles())
+        , std::chrono::minutes(pref->getSchedulerTransitionTime())};
+}
+
 bool BandwidthScheduler::isTimeForAlternative() const
 {
     const Preferences *const pref = Preferences::instance();
@@ -112,6 +130,24 @@ bool BandwidthScheduler::isTimeForAlternative() const
 
 void BandwidthScheduler::onTimeout()
 {
+    if (const BandwidthProfile profile = loadProfile(); !profile.isEmpty())
+    {
+        const int percent = profile.percentAt(QTime::currentTime());
+        if (percent != m_lastPercent)
+        {
+            m_lastPercent = percent;
+            emit bandwidthPercentRequested(percent);
+        }
+        return;
+    }
+
+    if (m_lastPercent != 100)
+    {
+        // profiles were removed
+        m_lastPercent = 100;
+        emit bandwidthPercentRequested(m_lastPercent);
+    }
+
     const bool alternative = isTimeForAlternative();
 
     if (alternative != m_lastAlternative)
@@ -32,6 +32,8 @@
 #include <QObject>
 #include <QTimer>
 
+#include "bandwidthprofile.h"
+
 class BandwidthScheduler : public QObject
 {
     Q_OBJECT
@@ -43,11 +45,16 @@ public:
 
 signals:
     void bandwidthLimitRequested(bool alternative);
+    // when rate profiles are set they are used instead of alternative limits
+    void bandwidthPercentRequested(int percent);
 
 private:
+    static BandwidthProfile loadProfile();
+
     bool isTimeForAlternative() const;
     void onTimeout();
 
     QTimer m_timer;
     bool m_lastAlternative = false;
+    int m_lastPercent = 100;
 };
@@ -0,0 +1,130 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "bannedpeershistory.h"
+
+#include <algorithm>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+
+#include "base/global.h"
+#include "base/profile.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const QString TABLE_NAME = u"banned_peers"_s;
+}
+
+bool BannedPeersHistory::Cursor::isValid() const
+{
+    return (id > 0);
+}
+
+BannedPeersHistory::BannedPeersHistory(const Path &dbPath)
+    : m_connectionName {u"BannedPeersHistory-%1"_s.arg(reinterpret_cast<quintptr>(this), 0, 16)}
+{
+    auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, m_connectionName);
+    db.setDatabaseName(dbPath.data());
+    // the database is written by the peer logger only
+    db.setConnectOptions(u"QSQLITE_OPEN_READONLY"_s);
+}
+
+BannedPeersHistory::~BannedPeersHistory()
+{
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+Path BannedPeersHistory::databasePath()
+{
+    return specialFolderLocation(SpecialFolder::Data) / Path(u"peers.db"_s);
+}
+
+BannedPeersHistory::Cursor BannedPeersHistory::cursorAfter(const BannedPeerRecord &record)
+{
+    return {.lastBanned = record.lastBanned.toSecsSinceEpoch(), .id = record.id};
+}
+
+QList<BannedPeerRecord> BannedPeersHistory::fetch(const Filter &filter, const Cursor &after, const int limit)
+{
+    auto db = QSqlDatabase::database(m_connectionName);
+    // the database doesn't exist until the first peer is banned
+    if (!db.isOpen() && !db.open())
+        return {};
+
+    QStringList conditions;
+    if (!filter.tag.isEmpty())
+        conditions.append(u"tag = :tag"_s);
+    if (!filter.client.isEmpty())
+        conditions.append(u"client = :client"_s);
+    if (after.isValid())
+        conditions.append(u"(updated, id) < (:updated, :id)"_s);
+
+    // each filter has its own index ending with the ban time, so no query scans or sorts the table
+    QString statement = u"SELECT id, ip, client, pid, tag, hits, updated FROM '%1'"_s.arg(TABLE_NAME);
+    if (!conditions.isEmpty())
+        statement += u" WHERE " + conditions.join(u" AND ");
+    statement += u" ORDER BY updated DESC, id DESC LIMIT :limit";
+
+    QSqlQuery query {db};
+    if (!query.prepare(statement))
+        return {};
+
+    if (!filter.tag.isEmpty())
+        query.bindValue(u":tag"_s, filter.tag);
+    if (!filter.client.isEmpty())
+        query.bindValue(u":client"_s, filter.client);
+    if (after.isValid())
+    {
+        query.bindValue(u":updated"_s, after.lastBanned);
+        query.bindValue(u":id"_s, after.id);
+    }
+    query.bindValue(u":limit"_s, std::clamp(limit, 1, MAX_PAGE_SIZE));
+
+    query.setForwardOnly(true);
+    if (!query.exec())
+        return {};
+
+    QList<BannedPeerRecord> records;
+    while (query.next())
+    {
+        records.append({
+            .id = query.value(0).toLongLong(),
+            .ip = query.value(1).toString(),
+            .client = query.value(2).toString(),
+            .peerIDPrefix = query.value(3).toString().toLatin1(),
+            .tag = query.value(4).toString(),
+            .hits = query.value(5).toInt(),
+            .lastBanned = QDateTime::fromSecsSinceEpoch(query.value(6).toLongLong())});
+    }
+    return records;
+}
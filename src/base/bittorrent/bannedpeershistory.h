@@ -0,0 +1,88 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+#include "base/path.h"
+
+namespace BitTorrent
+{
+    struct BannedPeerRecord
+    {
+        qint64 id = 0;
+        QString ip;
+        QString client;
+        QByteArray peerIDPrefix;
+        QString tag;
+        int hits = 0;
+        QDateTime lastBanned;
+    };
+
+    // Reads the history of banned peers written by the peer logger.
+    // Records are ordered from the most recently banned one and are fetched in pages
+    // continuing after the last record of the previous page (keyset pagination),
+    // so each page costs the same regardless of how deep in the history it is.
+    class BannedPeersHistory
+    {
+        Q_DISABLE_COPY_MOVE(BannedPeersHistory)
+
+    public:
+        struct Filter
+        {
+            QString tag;
+            QString client;
+        };
+
+        // Position in the history, default constructed one points at its beginning
+        struct Cursor
+        {
+            qint64 lastBanned = 0;
+            qint64 id = 0;
+
+            bool isValid() const;
+        };
+
+        static constexpr int MAX_PAGE_SIZE = 1000;
+
+        explicit BannedPeersHistory(const Path &dbPath = databasePath());
+        ~BannedPeersHistory();
+
+        static Path databasePath();
+        static Cursor cursorAfter(const BannedPeerRecord &record);
+
+        QList<BannedPeerRecord> fetch(const Filter &filter, const Cursor &after, int limit);
+
+    private:
+        QString m_connectionName;
+    };
+}
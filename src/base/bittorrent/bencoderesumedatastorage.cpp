@@ -28,6 +28,10 @@
 
 #include "bencoderesumedatastorage.h"
 
+#include <cstring>
+#include <optional>
+#include <vector>
+
 #include <libtorrent/bdecode.hpp>
 #include <libtorrent/entry.hpp>
 #include <libtorrent/read_resume_data.hpp>
@@ -37,8 +41,15 @@
 #include <QByteArray>
 #include <QDebug>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
 #include <QRegularExpression>
+#include <QSet>
 #include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
+
+#include <zlib.h>
 
 #include "base/exceptions.h"
 #include "base/global.h"
@@ -46,6 +57,7 @@
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/tagset.h"
+#include "base/tracing.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "base/utils/sslkey.h"
@@ -60,14 +72,24 @@ namespace BitTorrent
         Q_DISABLE_COPY_MOVE(Worker)
 
     public:
-        explicit Worker(const Path &resumeDataDir);
+        Worker(const Path &resumeDataDir, bool sharded);
 
         void store(const TorrentID &id, const LoadTorrentParams &resumeData) const;
+        void storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const;
+        void storeCounters(const TorrentID &id, const ResumeDataCounters &counters) const;
         void remove(const TorrentID &id) const;
         void storeQueue(const QVector<TorrentID> &queue) const;
 
     private:
+        bool isMetadataStored(const TorrentID &id) const;
+
+        Path filePath(const TorrentID &id, const QString &extension) const;
+
         const Path m_resumeDataDir;
+        const bool m_sharded;
+        // it's accessed by the threads storing several torrents at once
+        mutable QMutex m_storedMetadataMutex;
+        mutable QSet<TorrentID> m_storedMetadata;
     };
 }
 
@@ -77,6 +99,8 @@ namespace
     const char KEY_SSL_PRIVATE_KEY[] = "qBt-sslPrivateKey";
     const char KEY_SSL_DH_PARAMS[] = "qBt-sslDhParams";
 
+    const qsizetype MIN_PARALLEL_STORE_COUNT = 100;
+
     template <typename LTStr>
     QString fromLTString(const LTStr &str)
     {
@@ -89,6 +113,96 @@ namespace
         return {str.data(), static_cast<qsizetype>(str.size())};
     }
 
+    // Queue snapshot is stored as a fixed size header followed by the array of raw torrent IDs.
+    // Header contains (little endian) signature, format version, ID length, number of IDs
+    // and CRC-32 checksum of the ID array.
+    const QByteArray QUEUE_SNAPSHOT_SIGNATURE = QByteArrayLiteral("QBTQ");
+    const quint16 QUEUE_SNAPSHOT_VERSION = 1;
+    const qsizetype QUEUE_SNAPSHOT_HEADER_SIZE = 16;
+    const qint64 QUEUE_SNAPSHOT_MAX_SIZE = 64 * 1024 * 1024;
+
+    quint32 queueChecksum(const char *data, const qsizetype size)
+    {
+        return static_cast<quint32>(::crc32(::crc32(0, nullptr, 0), reinterpret_cast<const Bytef *>(data), static_cast<uInt>(size)));
+    }
+
+    QByteArray toQueueSnapshot(const QVector<BitTorrent::TorrentID> &queue)
+    {
+        const qsizetype idLength = BitTorrent::TorrentID::length();
+
+        QByteArray data {(QUEUE_SNAPSHOT_HEADER_SIZE + (idLength * queue.size())), Qt::Uninitialized};
+        char *ids = data.data() + QUEUE_SNAPSHOT_HEADER_SIZE;
+        for (qsizetype i = 0; i < queue.size(); ++i)
+        {
+            const lt::sha1_hash nativeID = queue[i];
+            std::memcpy((ids + (i * idLength)), nativeID.data(), idLength);
+        }
+
+        char *header = data.data();
+        std::memcpy(header, QUEUE_SNAPSHOT_SIGNATURE.constData(), 4);
+        qToLittleEndian<quint16>(QUEUE_SNAPSHOT_VERSION, (header + 4));
+        qToLittleEndian<quint16>(static_cast<quint16>(idLength), (header + 6));
+        qToLittleEndian<quint32>(static_cast<quint32>(queue.size()), (header + 8));
+        qToLittleEndian<quint32>(queueChecksum(ids, (idLength * queue.size())), (header + 12));
+        return data;
+    }
+
+    std::optional<QVector<BitTorrent::TorrentID>> fromQueueSnapshot(const QByteArray &data)
+    {
+        if ((data.size() < QUEUE_SNAPSHOT_HEADER_SIZE) || !data.startsWith(QUEUE_SNAPSHOT_SIGNATURE))
+            return std::nullopt;
+
+        const char *header = data.constData();
+        const qsizetype idLength = qFromLittleEndian<quint16>(header + 6);
+        const qsizetype count = qFromLittleEndian<quint32>(header + 8);
+        if ((qFromLittleEndian<quint16>(header + 4) != QUEUE_SNAPSHOT_VERSION)
+                || (idLength != BitTorrent::TorrentID::length())
+                || (data.size() != (QUEUE_SNAPSHOT_HEADER_SIZE + (idLength * count))))
+        {
+            return std::nullopt;
+        }
+
+        const char *ids = header + QUEUE_SNAPSHOT_HEADER_SIZE;
+        if (qFromLittleEndian<quint32>(header + 12) != queueChecksum(ids, (idLength * count)))
+            return std::nullopt;
+
+        QVector<BitTorrent::TorrentID> queue;
+        queue.reserve(count);
+        for (qsizetype i = 0; i < count; ++i)
+            queue.append(BitTorrent::TorrentID(lt::sha1_hash(ids + (i * idLength))));
+        return queue;
+    }
+
+    Path resumeDataFilePath(const Path &resumeDataDir, const bool sharded, const BitTorrent::TorrentID &id, const QString &extension)
+    {
+        const QString idString = id.toString();
+        const Path filename {idString + extension};
+        return sharded ? (resumeDataDir / Path(idString.left(2)) / filename) : (resumeDataDir / filename);
+    }
+
+    QVector<BitTorrent::TorrentID> findRegisteredTorrents(const Path &dirPath)
+    {
+        const QRegularExpression filenamePattern {u"^([A-Fa-f0-9]{40})\\.fastresume$"_s};
+        const QStringList filenames = QDir(dirPath.data()).entryList({u"*.fastresume"_s}, QDir::Files);
+
+        QVector<BitTorrent::TorrentID> torrentIDs;
+        torrentIDs.reserve(filenames.size());
+        for (const QString &filename : filenames)
+        {
+            const QRegularExpressionMatch rxMatch = filenamePattern.match(filename);
+            if (rxMatch.hasMatch())
+                torrentIDs.append(BitTorrent::TorrentID::fromString(rxMatch.captured(1)));
+        }
+        return torrentIDs;
+    }
+
+    using MapFileResult = nonstd::expected<std::shared_ptr<const Utils::IO::MappedFile>, Utils::IO::ReadError>;
+
+    QByteArray mappedData(const MapFileResult &result)
+    {
+        return result ? result.value()->data() : QByteArray();
+    }
+
     using ListType = lt::entry::list_type;
 
     ListType setToEntryList(const TagSet &input)
@@ -101,10 +215,11 @@ namespace
     }
 }
 
-BitTorrent::BencodeResumeDataStorage::BencodeResumeDataStorage(const Path &path, QObject *parent)
+BitTorrent::BencodeResumeDataStorage::BencodeResumeDataStorage(const Path &path, const bool sharded, QObject *parent)
     : ResumeDataStorage(path, parent)
+    , m_sharded {sharded}
     , m_ioThread {new QThread}
-    , m_asyncWorker {new Worker(path)}
+    , m_asyncWorker {new Worker(path, sharded)}
 {
     Q_ASSERT(path.isAbsolute());
 
@@ -114,18 +229,62 @@ BitTorrent::BencodeResumeDataStorage::BencodeResumeDataStorage(const Path &path,
                     .arg(path.toString()));
     }
 
-    const QRegularExpression filenamePattern {u"^([A-Fa-f0-9]{40})\\.fastresume$"_s};
-    const QStringList filenames = QDir(path.data()).entryList({u"*.fastresume"_s}, QDir::Files);
+    if (m_sharded)
+    {
+        // shards are independent directories, so they are enumerated in parallel
+        const QStringList shardNames = QDir(path.data()).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        std::vector<QVector<TorrentID>> shardTorrents(shardNames.size());
+        {
+            QThreadPool enumerationPool;
+            for (qsizetype i = 0; i < shardNames.size(); ++i)
+            {
+                if (shardNames[i].size() != 2)
+                    continue;
+
+                enumerationPool.start([&shardTorrents, i, shardPath = (path / Path(shardNames[i]))]
+                {
+                    shardTorrents[i] = findRegisteredTorrents(shardPath);
+                });
+            }
+            enumerationPool.waitForDone();
+        }
 
-    m_registeredTorrents.reserve(filenames.size());
-    for (const QString &filename : filenames)
+        qsizetype torrentsCount = 0;
+        for (const QVector<TorrentID> &torrentIDs : shardTorrents)
+            torrentsCount += torrentIDs.size();
+
+        m_registeredTorrents.reserve(torrentsCount);
+        for (const QVector<TorrentID> &torrentIDs : shardTorrents)
+            m_registeredTorrents.append(torrentIDs);
+    }
+    else
     {
-         const QRegularExpressionMatch rxMatch = filenamePattern.match(filename);
-         if (rxMatch.hasMatch())
-             m_registeredTorrents.append(TorrentID::fromString(rxMatch.captured(1)));
+        m_registeredTorrents = findRegisteredTorrents(path);
     }
 
-    loadQueue(path / Path(u"queue"_s));
+    // queued torrents go first, in the order they were stored
+    const QVector<TorrentID> queue = loadQueue();
+    if (!queue.isEmpty())
+    {
+        QHash<TorrentID, qsizetype> indexes;
+        indexes.reserve(m_registeredTorrents.size());
+        for (qsizetype i = 0; i < m_registeredTorrents.size(); ++i)
+            indexes.insert(m_registeredTorrents[i], i);
+
+        qsizetype start = 0;
+        for (const TorrentID &torrentID : queue)
+        {
+            const auto iter = indexes.constFind(torrentID);
+            if ((iter == indexes.cend()) || (iter.value() < start))
+                continue;
+
+            const qsizetype pos = iter.value();
+            indexes[m_registeredTorrents[start]] = pos;
+            indexes[torrentID] = start;
+            std::swap(m_registeredTorrents[start], m_registeredTorrents[pos]);
+            ++start;
+        }
+    }
 
     qDebug() << "Registered torrents count: " << m_registeredTorrents.size();
 
@@ -141,25 +300,24 @@ QVector<BitTorrent::TorrentID> BitTorrent::BencodeResumeDataStorage::registeredT
 
 BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::load(const TorrentID &id) const
 {
-    const QString idString = id.toString();
-    const Path fastresumePath = path() / Path(idString + u".fastresume");
-    const Path torrentFilePath = path() / Path(idString + u".torrent");
+    const Path fastresumePath = resumeDataFilePath(path(), m_sharded, id, u".fastresume"_s);
+    const Path torrentFilePath = resumeDataFilePath(path(), m_sharded, id, u".torrent"_s);
     const qint64 torrentSizeLimit = Preferences::instance()->getTorrentFileSizeLimit();
 
-    const auto resumeDataReadResult = Utils::IO::readFile(fastresumePath, torrentSizeLimit);
+    const auto resumeDataReadResult = Utils::IO::mapFile(fastresumePath, torrentSizeLimit);
     if (!resumeDataReadResult)
         return nonstd::make_unexpected(resumeDataReadResult.error().message);
 
-    const auto metadataReadResult = Utils::IO::readFile(torrentFilePath, torrentSizeLimit);
+    const auto metadataReadResult = Utils::IO::mapFile(torrentFilePath, torrentSizeLimit);
     if (!metadataReadResult)
     {
         if (metadataReadResult.error().status != Utils::IO::ReadError::NotExist)
             return nonstd::make_unexpected(metadataReadResult.error().message);
     }
 
-    const QByteArray data = resumeDataReadResult.value();
-    const QByteArray metadata = metadataReadResult.value_or(QByteArray());
-    return loadTorrentResumeData(data, metadata);
+    const auto countersReadResult = Utils::IO::mapFile(resumeDataFilePath(path(), m_sharded, id, u".counters"_s), torrentSizeLimit);
+
+    return loadTorrentResumeData(mappedData(resumeDataReadResult), mappedData(metadataReadResult), mappedData(countersReadResult));
 }
 
 void BitTorrent::BencodeResumeDataStorage::doLoadAll() const
@@ -168,28 +326,68 @@ void BitTorrent::BencodeResumeDataStorage::doLoadAll() const
 
     emit const_cast<BencodeResumeDataStorage *>(this)->loadStarted(m_registeredTorrents);
 
+    const qint64 torrentSizeLimit = Preferences::instance()->getTorrentFileSizeLimit();
     for (const TorrentID &torrentID : asConst(m_registeredTorrents))
-        onResumeDataLoaded(torrentID, load(torrentID));
+    {
+        // files are mapped sequentially by this thread, the rest is done by decoding threads
+        // which bdecode them right from the mapped memory, so the data is never copied
+        // into heap and its pages are released as soon as the torrent is decoded
+        const auto resumeDataReadResult = Utils::IO::mapFile(resumeDataFilePath(path(), m_sharded, torrentID, u".fastresume"_s), torrentSizeLimit);
+        const auto metadataReadResult = Utils::IO::mapFile(resumeDataFilePath(path(), m_sharded, torrentID, u".torrent"_s), torrentSizeLimit);
+        const auto countersReadResult = Utils::IO::mapFile(resumeDataFilePath(path(), m_sharded, torrentID, u".counters"_s), torrentSizeLimit);
+        enqueueResumeDataDecoding(torrentID, [this, resumeDataReadResult, metadataReadResult, countersReadResult]() -> LoadResumeDataResult
+        {
+            if (!resumeDataReadResult)
+                return nonstd::make_unexpected(resumeDataReadResult.error().message);
+
+            if (!metadataReadResult && (metadataReadResult.error().status != Utils::IO::ReadError::NotExist))
+                return nonstd::make_unexpected(metadataReadResult.error().message);
+
+            return loadTorrentResumeData(mappedData(resumeDataReadResult), mappedData(metadataReadResult), mappedData(countersReadResult));
+        });
+    }
+
+    waitForResumeDataDecoding();
 
     emit const_cast<BencodeResumeDataStorage *>(this)->loadFinished();
 }
 
-void BitTorrent::BencodeResumeDataStorage::loadQueue(const Path &queueFilename)
+QVector<BitTorrent::TorrentID> BitTorrent::BencodeResumeDataStorage::loadQueue() const
 {
-    const int lineMaxLength = 48;
+    // Text queue file is only written by older versions (newer ones remove it once the snapshot is stored),
+    // so if it exists it is more recent than the snapshot.
+    const Path legacyQueueFilename = path() / Path(u"queue"_s);
+    if (!legacyQueueFilename.exists())
+    {
+        const auto readResult = Utils::IO::readFile((path() / Path(u"queue.bin"_s)), QUEUE_SNAPSHOT_MAX_SIZE);
+        if (!readResult)
+        {
+            if (readResult.error().status != Utils::IO::ReadError::NotExist)
+                LogMsg(tr("Couldn't load torrents queue: %1").arg(readResult.error().message), Log::WARNING);
+            return {};
+        }
 
-    QFile queueFile {queueFilename.data()};
-    if (!queueFile.exists())
-        return;
+        std::optional<QVector<TorrentID>> queue = fromQueueSnapshot(readResult.value());
+        if (!queue)
+        {
+            LogMsg(tr("Couldn't load torrents queue: %1").arg(tr("Invalid data format")), Log::WARNING);
+            return {};
+        }
+
+        return std::move(*queue);
+    }
+
+    const int lineMaxLength = 48;
 
+    QFile queueFile {legacyQueueFilename.data()};
     if (!queueFile.open(QFile::ReadOnly))
     {
         LogMsg(tr("Couldn't load torrents queue: %1").arg(queueFile.errorString()), Log::WARNING);
-        return;
+        return {};
     }
 
+    QVector<TorrentID> queue;
     const QRegularExpression hashPattern {u"^([A-Fa-f0-9]{40})$"_s};
-    int start = 0;
     while (true)
     {
         const auto line = QString::fromLatin1(queueFile.readLine(lineMaxLength).trimmed());
@@ -198,19 +396,14 @@ void BitTorrent::BencodeResumeDataStorage::loadQueue(const Path &queueFilename)
 
         const QRegularExpressionMatch rxMatch = hashPattern.match(line);
         if (rxMatch.hasMatch())
-        {
-            const auto torrentID = BitTorrent::TorrentID::fromString(rxMatch.captured(1));
-            const int pos = m_registeredTorrents.indexOf(torrentID, start);
-            if (pos != -1)
-            {
-                std::swap(m_registeredTorrents[start], m_registeredTorrents[pos]);
-                ++start;
-            }
-        }
+            queue.append(BitTorrent::TorrentID::fromString(rxMatch.captured(1)));
     }
+
+    return queue;
 }
 
-BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::loadTorrentResumeData(const QByteArray &data, const QByteArray &metadata) const
+BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::loadTorrentResumeData(const QByteArray &data
+        , const QByteArray &metadata, const QByteArray &counters) const
 {
     const auto *pref = Preferences::instance();
 
@@ -290,6 +483,13 @@ BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::loadTorre
 
     p = lt::read_resume_data(resumeDataRoot, ec);
 
+    // counters stored after resume data are more recent than the ones it contains
+    if (!counters.isEmpty())
+    {
+        if (const std::optional<ResumeDataCounters> resumeDataCounters = ResumeDataCounters::fromBencodedData(counters))
+            resumeDataCounters->applyTo(p);
+    }
+
     if (!metadata.isEmpty())
     {
         const auto *pref = Preferences::instance();
@@ -346,6 +546,23 @@ void BitTorrent::BencodeResumeDataStorage::store(const TorrentID &id, const Load
     });
 }
 
+void BitTorrent::BencodeResumeDataStorage::storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, resumeData]()
+    {
+        m_asyncWorker->storeAll(resumeData);
+    });
+}
+
+void BitTorrent::BencodeResumeDataStorage::storeCounters(const QHash<TorrentID, ResumeDataCounters> &counters) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, counters]()
+    {
+        for (auto it = counters.cbegin(); it != counters.cend(); ++it)
+            m_asyncWorker->storeCounters(it.key(), it.value());
+    });
+}
+
 void BitTorrent::BencodeResumeDataStorage::remove(const TorrentID &id) const
 {
     QMetaObject::invokeMethod(m_asyncWorker, [this, id]()
@@ -354,6 +571,15 @@ void BitTorrent::BencodeResumeDataStorage::remove(const TorrentID &id) const
     });
 }
 
+void BitTorrent::BencodeResumeDataStorage::removeAll(const QVector<TorrentID> &ids) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, ids]()
+    {
+        for (const TorrentID &id : ids)
+            m_asyncWorker->remove(id);
+    });
+}
+
 void BitTorrent::BencodeResumeDataStorage::storeQueue(const QVector<TorrentID> &queue) const
 {
     QMetaObject::invokeMethod(m_asyncWorker, [this, queue]()
@@ -362,13 +588,21 @@ void BitTorrent::BencodeResumeDataStorage::storeQueue(const QVector<TorrentID> &
     });
 }
 
-BitTorrent::BencodeResumeDataStorage::Worker::Worker(const Path &resumeDataDir)
+BitTorrent::BencodeResumeDataStorage::Worker::Worker(const Path &resumeDataDir, const bool sharded)
     : m_resumeDataDir {resumeDataDir}
+    , m_sharded {sharded}
+{
+}
+
+Path BitTorrent::BencodeResumeDataStorage::Worker::filePath(const TorrentID &id, const QString &extension) const
 {
+    return resumeDataFilePath(m_resumeDataDir, m_sharded, id, extension);
 }
 
 void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
 {
+    QBT_TRACE_SCOPE("BencodeResumeDataStorage::store");
+
     // We need to adjust native libtorrent resume data
     lt::add_torrent_params p = resumeData.ltAddTorrentParams;
     p.save_path = Profile::instance()->toPortablePath(Path(p.save_path))
@@ -393,6 +627,17 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
         }
     }
 
+    // Metadata never changes once it is received, so it is written only once
+    // and then the rest of resume data is stored without it.
+    const bool hasStoredMetadata = p.ti && isMetadataStored(id);
+#ifdef QBT_USES_LIBTORRENT2
+    // piece layers of v2 torrents are kept in resume data, they can be generated along with metadata only
+    if (hasStoredMetadata && !p.ti->info_hashes().has_v2())
+#else
+    if (hasStoredMetadata)
+#endif
+        p.ti.reset();
+
     lt::entry data = lt::write_resume_data(p);
 
     // metadata is stored in separate .torrent file
@@ -406,13 +651,19 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
         metadataDict.insert(dataDict.extract("created by"));
         metadataDict.insert(dataDict.extract("comment"));
 
-        const Path torrentFilepath = m_resumeDataDir / Path(u"%1.torrent"_s.arg(id.toString()));
-        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(torrentFilepath, metadata);
-        if (!result)
+        if (!hasStoredMetadata)
         {
-            LogMsg(tr("Couldn't save torrent metadata to '%1'. Error: %2.")
-                   .arg(torrentFilepath.toString(), result.error()), Log::CRITICAL);
-            return;
+            const Path torrentFilepath = filePath(id, u".torrent"_s);
+            const nonstd::expected<void, QString> result = Utils::IO::saveToFile(torrentFilepath, metadata);
+            if (!result)
+            {
+                LogMsg(tr("Couldn't save torrent metadata to '%1'. Error: %2.")
+                       .arg(torrentFilepath.toString(), result.error()), Log::CRITICAL);
+                return;
+            }
+
+            const QMutexLocker locker {&m_storedMetadataMutex};
+            m_storedMetadata.insert(id);
         }
     }
 
@@ -442,7 +693,10 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
         data["qBt-downloadPath"] = Profile::instance()->toPortablePath(resumeData.downloadPath).data().toStdString();
     }
 
-    const Path resumeFilepath = m_resumeDataDir / Path(u"%1.fastresume"_s.arg(id.toString()));
+    // counters saved before are obsolete now, so they shouldn't override the new ones
+    Utils::Fs::removeFile(filePath(id, u".counters"_s));
+
+    const Path resumeFilepath = filePath(id, u".fastresume"_s);
     const nonstd::expected<void, QString> result = Utils::IO::saveToFile(resumeFilepath, data);
     if (!result)
     {
@@ -451,27 +705,77 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
     }
 }
 
+// Each torrent is written to its own files, so the large batches (e.g. resume data moved
+// from another storage) are written in parallel
+void BitTorrent::BencodeResumeDataStorage::Worker::storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const
+{
+    if (resumeData.size() < MIN_PARALLEL_STORE_COUNT)
+    {
+        for (auto it = resumeData.cbegin(); it != resumeData.cend(); ++it)
+            store(it.key(), it.value());
+        return;
+    }
+
+    QThreadPool storingPool;
+    for (auto it = resumeData.cbegin(); it != resumeData.cend(); ++it)
+    {
+        storingPool.start([this, id = it.key(), &params = it.value()]
+        {
+            store(id, params);
+        });
+    }
+    storingPool.waitForDone();
+}
+
+void BitTorrent::BencodeResumeDataStorage::Worker::storeCounters(const TorrentID &id, const ResumeDataCounters &counters) const
+{
+    const Path countersFilepath = filePath(id, u".counters"_s);
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(countersFilepath, counters.toBencodedData());
+    if (!result)
+    {
+        LogMsg(tr("Couldn't save torrent resume data to '%1'. Error: %2.")
+               .arg(countersFilepath.toString(), result.error()), Log::CRITICAL);
+    }
+}
+
 void BitTorrent::BencodeResumeDataStorage::Worker::remove(const TorrentID &id) const
 {
-    const Path resumeFilename {u"%1.fastresume"_s.arg(id.toString())};
-    Utils::Fs::removeFile(m_resumeDataDir / resumeFilename);
+    Utils::Fs::removeFile(filePath(id, u".fastresume"_s));
+    Utils::Fs::removeFile(filePath(id, u".counters"_s));
+    Utils::Fs::removeFile(filePath(id, u".torrent"_s));
 
-    const Path torrentFilename {u"%1.torrent"_s.arg(id.toString())};
-    Utils::Fs::removeFile(m_resumeDataDir / torrentFilename);
+    const QMutexLocker locker {&m_storedMetadataMutex};
+    m_storedMetadata.remove(id);
 }
 
-void BitTorrent::BencodeResumeDataStorage::Worker::storeQueue(const QVector<TorrentID> &queue) const
+bool BitTorrent::BencodeResumeDataStorage::Worker::isMetadataStored(const TorrentID &id) const
 {
-    QByteArray data;
-    data.reserve(((BitTorrent::TorrentID::length() * 2) + 1) * queue.size());
-    for (const BitTorrent::TorrentID &torrentID : queue)
-        data += (torrentID.toString().toLatin1() + '\n');
+    {
+        const QMutexLocker locker {&m_storedMetadataMutex};
+        if (m_storedMetadata.contains(id))
+            return true;
+    }
+
+    // metadata could be stored during previous sessions
+    if (!filePath(id, u".torrent"_s).exists())
+        return false;
+
+    const QMutexLocker locker {&m_storedMetadataMutex};
+    m_storedMetadata.insert(id);
+    return true;
+}
 
-    const Path filepath = m_resumeDataDir / Path(u"queue"_s);
-    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(filepath, data);
+void BitTorrent::BencodeResumeDataStorage::Worker::storeQueue(const QVector<TorrentID> &queue) const
+{
+    const Path filepath = m_resumeDataDir / Path(u"queue.bin"_s);
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(filepath, toQueueSnapshot(queue));
     if (!result)
     {
         LogMsg(tr("Couldn't save data to '%1'. Error: %2")
             .arg(filepath.toString(), result.error()), Log::CRITICAL);
+        return;
     }
+
+    // queue file written by older versions would take precedence over the snapshot
+    Utils::Fs::removeFile(m_resumeDataDir / Path(u"queue"_s));
 }
@@ -47,19 +47,25 @@ namespace BitTorrent
         Q_DISABLE_COPY_MOVE(BencodeResumeDataStorage)
 
     public:
-        explicit BencodeResumeDataStorage(const Path &path, QObject *parent = nullptr);
+        // In sharded layout files of each torrent are kept in subdirectory
+        // named after the first two characters of torrent ID.
+        explicit BencodeResumeDataStorage(const Path &path, bool sharded = false, QObject *parent = nullptr);
 
         QVector<TorrentID> registeredTorrents() const override;
         LoadResumeDataResult load(const TorrentID &id) const override;
         void store(const TorrentID &id, const LoadTorrentParams &resumeData) const override;
+        void storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const override;
+        void storeCounters(const QHash<TorrentID, ResumeDataCounters> &counters) const override;
         void remove(const TorrentID &id) const override;
+        void removeAll(const QVector<TorrentID> &ids) const override;
         void storeQueue(const QVector<TorrentID> &queue) const override;
 
     private:
         void doLoadAll() const override;
-        void loadQueue(const Path &queueFilename);
-        LoadResumeDataResult loadTorrentResumeData(const QByteArray &data, const QByteArray &metadata) const;
+        QVector<TorrentID> loadQueue() const;
+        LoadResumeDataResult loadTorrentResumeData(const QByteArray &data, const QByteArray &metadata, const QByteArray &counters) const;
 
+        const bool m_sharded;
         QVector<TorrentID> m_registeredTorrents;
         Utils::Thread::UniquePtr m_ioThread;
 
@@ -0,0 +1,274 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "blockreadcache.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace BitTorrent;
+
+namespace
+{
+    // blocks requested by peers are 16 KiB, it is only used to size the history
+    const qint64 BLOCK_SIZE = 16 * 1024;
+    const qsizetype MIN_HISTORY_SIZE = 256;
+    // part of the capacity the blocks hit after insertion can take
+    const int PROTECTED_PERCENT = 80;
+
+    qint64 pieceID(const int storage, const int piece)
+    {
+        return (static_cast<qint64>(storage) << 32) | static_cast<quint32>(piece);
+    }
+}
+
+std::size_t BitTorrent::qHash(const BlockReadCache::BlockKey &key, const std::size_t seed)
+{
+    return qHashMulti(seed, key.storage, key.piece, key.offset, key.length);
+}
+
+BlockReadCache::BlockReadCache(const qint64 capacity)
+    : m_capacity {std::max<qint64>(0, capacity)}
+{
+}
+
+qint64 BlockReadCache::capacity() const
+{
+    return m_capacity;
+}
+
+void BlockReadCache::setCapacity(const qint64 capacity)
+{
+    m_capacity = std::max<qint64>(0, capacity);
+
+    demoteProtected(0);
+    evict();
+
+    while (m_history.size() > static_cast<std::size_t>(historyCapacity()))
+    {
+        m_historyIndex.remove(m_history.front().key);
+        m_history.pop_front();
+    }
+}
+
+qint64 BlockReadCache::size() const
+{
+    return m_size;
+}
+
+int BlockReadCache::count() const
+{
+    return m_blocks.size();
+}
+
+QByteArray BlockReadCache::find(const BlockKey &key)
+{
+    const auto it = m_blocks.constFind(key);
+    if (it == m_blocks.cend())
+    {
+        ++m_misses;
+        remember(key);
+        return {};
+    }
+
+    ++m_hits;
+    const BlockList::iterator blockIt = it.value();
+    const QByteArray data = blockIt->data;
+    promote(blockIt);
+    return data;
+}
+
+bool BlockReadCache::isAdmitted(const BlockKey &key) const
+{
+    if (m_capacity <= 0)
+        return false;
+
+    const auto it = m_historyIndex.constFind(key);
+    return (it != m_historyIndex.cend()) && (it.value()->requests > 1);
+}
+
+quint64 BlockReadCache::generation(const int storage) const
+{
+    return m_generations.value(storage, 0);
+}
+
+bool BlockReadCache::insert(const BlockKey &key, const QByteArray &data, const quint64 generation)
+{
+    if ((data.size() > m_capacity) || (generation != this->generation(key.storage)))
+        return false;
+    if (m_blocks.contains(key))
+        return true;
+    if (!isAdmitted(key))
+        return false;
+
+    const auto historyIt = m_historyIndex.find(key);
+    m_history.erase(historyIt.value());
+    m_historyIndex.erase(historyIt);
+
+    m_probation.push_back({.key = key, .data = data});
+    m_blocks.insert(key, std::prev(m_probation.end()));
+    ++m_pieceBlocks[pieceID(key.storage, key.piece)];
+    m_size += data.size();
+    evict();
+    return true;
+}
+
+void BlockReadCache::removePiece(const int storage, const int piece)
+{
+    if (!m_pieceBlocks.contains(pieceID(storage, piece)))
+        return;
+
+    for (BlockList *blocks : {&m_probation, &m_protected})
+    {
+        for (auto it = blocks->begin(); it != blocks->end();)
+        {
+            const auto blockIt = it++;
+            if ((blockIt->key.storage == storage) && (blockIt->key.piece == piece))
+                remove(blockIt);
+        }
+    }
+}
+
+void BlockReadCache::removeStorage(const int storage)
+{
+    ++m_generations[storage];
+
+    for (BlockList *blocks : {&m_probation, &m_protected})
+    {
+        for (auto it = blocks->begin(); it != blocks->end();)
+        {
+            const auto blockIt = it++;
+            if (blockIt->key.storage == storage)
+                remove(blockIt);
+        }
+    }
+
+    for (auto it = m_history.begin(); it != m_history.end();)
+    {
+        if (it->key.storage == storage)
+        {
+            m_historyIndex.remove(it->key);
+            it = m_history.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+qint64 BlockReadCache::hits() const
+{
+    return m_hits;
+}
+
+qint64 BlockReadCache::misses() const
+{
+    return m_misses;
+}
+
+void BlockReadCache::remember(const BlockKey &key)
+{
+    if (m_capacity <= 0)
+        return;
+
+    if (const auto it = m_historyIndex.constFind(key); it != m_historyIndex.cend())
+    {
+        const HistoryList::iterator historyIt = it.value();
+        ++historyIt->requests;
+        m_history.splice(m_history.end(), m_history, historyIt);
+        return;
+    }
+
+    if (m_history.size() >= static_cast<std::size_t>(historyCapacity()))
+    {
+        m_historyIndex.remove(m_history.front().key);
+        m_history.pop_front();
+    }
+
+    m_history.push_back({.key = key, .requests = 1});
+    m_historyIndex.insert(key, std::prev(m_history.end()));
+}
+
+void BlockReadCache::promote(const BlockList::iterator it)
+{
+    if (it->isProtected)
+    {
+        m_protected.splice(m_protected.end(), m_protected, it);
+        return;
+    }
+
+    it->isProtected = true;
+    m_protectedSize += it->data.size();
+    m_protected.splice(m_protected.end(), m_probation, it);
+    demoteProtected(1);
+}
+
+// moves least recently used protected blocks back to probation segment
+// so that they become the next eviction candidates
+void BlockReadCache::demoteProtected(const std::size_t minCount)
+{
+    while ((m_protected.size() > minCount) && ((m_protectedSize * 100) > (m_capacity * PROTECTED_PERCENT)))
+    {
+        Block &block = m_protected.front();
+        block.isProtected = false;
+        m_protectedSize -= block.data.size();
+        m_probation.splice(m_probation.end(), m_protected, m_protected.begin());
+    }
+}
+
+void BlockReadCache::remove(const BlockList::iterator it)
+{
+    m_size -= it->data.size();
+    m_blocks.remove(it->key);
+    if (const auto pieceIt = m_pieceBlocks.find(pieceID(it->key.storage, it->key.piece)); --pieceIt.value() == 0)
+        m_pieceBlocks.erase(pieceIt);
+    if (it->isProtected)
+    {
+        m_protectedSize -= it->data.size();
+        m_protected.erase(it);
+    }
+    else
+    {
+        m_probation.erase(it);
+    }
+}
+
+void BlockReadCache::evict()
+{
+    while (m_size > m_capacity)
+        remove(!m_probation.empty() ? m_probation.begin() : m_protected.begin());
+}
+
+qsizetype BlockReadCache::historyCapacity() const
+{
+    if (m_capacity <= 0)
+        return 0;
+
+    return std::max(MIN_HISTORY_SIZE, static_cast<qsizetype>(m_capacity / BLOCK_SIZE));
+}
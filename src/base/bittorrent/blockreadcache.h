@@ -0,0 +1,129 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+
+#include <QByteArray>
+#include <QHash>
+#include <QtTypes>
+
+namespace BitTorrent
+{
+    // Cache of blocks read for peers, meant for pieces requested by many peers at once
+    // (newly released torrents being seeded). Block is only admitted once it was requested
+    // again while still remembered in the history of recent misses, so blocks read just once
+    // don't push the popular ones out. Cached blocks are kept in segmented LRU: blocks hit
+    // after insertion are promoted to protected segment and evicted only after the blocks
+    // that weren't requested again.
+    class BlockReadCache
+    {
+        Q_DISABLE_COPY_MOVE(BlockReadCache)
+
+    public:
+        struct BlockKey
+        {
+            int storage = -1;
+            int piece = -1;
+            int offset = 0;
+            int length = 0;
+
+            friend bool operator==(const BlockKey &left, const BlockKey &right) = default;
+        };
+
+        explicit BlockReadCache(qint64 capacity = 0);
+
+        // size limit of cached data in bytes, 0 disables the cache
+        qint64 capacity() const;
+        void setCapacity(qint64 capacity);
+        qint64 size() const;
+        int count() const;
+
+        // returns null byte array if the block isn't cached
+        QByteArray find(const BlockKey &key);
+        // whether the block is requested often enough to be worth caching once it is read
+        bool isAdmitted(const BlockKey &key) const;
+        // changes each time the storage is removed, blocks read before that are rejected
+        quint64 generation(int storage) const;
+        bool insert(const BlockKey &key, const QByteArray &data, quint64 generation);
+
+        // piece is only read once it was written and verified, so its reads don't race with writes
+        void removePiece(int storage, int piece);
+        void removeStorage(int storage);
+
+        qint64 hits() const;
+        qint64 misses() const;
+
+    private:
+        struct Block
+        {
+            BlockKey key;
+            QByteArray data;
+            bool isProtected = false;
+        };
+
+        struct HistoryEntry
+        {
+            BlockKey key;
+            int requests = 0;
+        };
+
+        using BlockList = std::list<Block>;
+        using HistoryList = std::list<HistoryEntry>;
+
+        void remember(const BlockKey &key);
+        void promote(BlockList::iterator it);
+        void demoteProtected(std::size_t minCount);
+        void remove(BlockList::iterator it);
+        void evict();
+        qsizetype historyCapacity() const;
+
+        qint64 m_capacity = 0;
+        qint64 m_size = 0;
+        qint64 m_protectedSize = 0;
+        qint64 m_hits = 0;
+        qint64 m_misses = 0;
+
+        // least recently used blocks are at the front
+        BlockList m_probation;
+        BlockList m_protected;
+        QHash<BlockKey, BlockList::iterator> m_blocks;
+        // number of cached blocks of each piece
+        QHash<qint64, int> m_pieceBlocks;
+
+        // keys of recently missed blocks, the least recently missed are at the front
+        HistoryList m_history;
+        QHash<BlockKey, HistoryList::iterator> m_historyIndex;
+
+        QHash<int, quint64> m_generations;
+    };
+
+    std::size_t qHash(const BlockReadCache::BlockKey &key, std::size_t seed = 0);
+}
@@ -28,6 +28,8 @@
 
 #include "categoryoptions.h"
 
+#include <algorithm>
+
 #include <QJsonObject>
 #include <QJsonValue>
 
@@ -35,6 +37,8 @@
 
 const QString OPTION_SAVEPATH = u"save_path"_s;
 const QString OPTION_DOWNLOADPATH = u"download_path"_s;
+const QString OPTION_UPLOADLIMIT = u"upload_limit"_s;
+const QString OPTION_DOWNLOADLIMIT = u"download_limit"_s;
 
 BitTorrent::CategoryOptions BitTorrent::CategoryOptions::fromJSON(const QJsonObject &jsonObj)
 {
@@ -47,6 +51,9 @@ BitTorrent::CategoryOptions BitTorrent::CategoryOptions::fromJSON(const QJsonObj
     else if (downloadPathValue.isString())
         options.downloadPath = {true, Path(downloadPathValue.toString())};
 
+    options.uploadLimit = std::max(jsonObj.value(OPTION_UPLOADLIMIT).toInt(), 0);
+    options.downloadLimit = std::max(jsonObj.value(OPTION_DOWNLOADLIMIT).toInt(), 0);
+
     return options;
 }
 
@@ -61,14 +68,22 @@ QJsonObject BitTorrent::CategoryOptions::toJSON() const
             downloadPathValue = false;
     }
 
-    return {
+    QJsonObject jsonObj {
         {OPTION_SAVEPATH, savePath.data()},
         {OPTION_DOWNLOADPATH, downloadPathValue}
     };
+    if (uploadLimit > 0)
+        jsonObj[OPTION_UPLOADLIMIT] = uploadLimit;
+    if (downloadLimit > 0)
+        jsonObj[OPTION_DOWNLOADLIMIT] = downloadLimit;
+
+    return jsonObj;
 }
 
 bool BitTorrent::operator==(const BitTorrent::CategoryOptions &left, const BitTorrent::CategoryOptions &right)
 {
     return ((left.savePath == right.savePath)
-            && (left.downloadPath == right.downloadPath));
+            && (left.downloadPath == right.downloadPath)
+            && (left.uploadLimit == right.uploadLimit)
+            && (left.downloadLimit == right.downloadLimit));
 }
@@ -43,6 +43,9 @@ namespace BitTorrent
     {
         Path savePath;
         std::optional<DownloadPathOption> downloadPath;
+        // combined rate limits (in bytes/s) of the torrents, including the ones of subcategories
+        int uploadLimit = 0;
+        int downloadLimit = 0;
 
         static CategoryOptions fromJSON(const QJsonObject &jsonObj);
         QJsonObject toJSON() const;
@@ -0,0 +1,79 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "connectionbudget.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "bandwidthshare.h"
+
+namespace
+{
+    // libtorrent doesn't allow less than 2 connections per torrent
+    const int MIN_BUDGET = 2;
+    const int MIN_DEMAND = 4;
+    // upload rate a single connection is expected to carry
+    const int UPLOAD_RATE_PER_CONNECTION = 8 * 1024;
+    const int MIN_BUDGET_CHANGE = 4;
+}
+
+int BitTorrent::connectionDemand(const ConnectionDemand &demand)
+{
+    int value = std::max({(demand.interestedPeers + (demand.interestedPeers / 2))
+            , (demand.uploadRate / UPLOAD_RATE_PER_CONNECTION), MIN_DEMAND});
+
+    if ((demand.budget > 0) && (demand.connections >= (demand.budget - (demand.budget / 10))))
+        value = std::max(value, (demand.connections + (demand.connections / 2) + 1));
+
+    // there is no point in having more connections than there are peers in the swarm
+    if (demand.swarmPeers >= 0)
+        value = std::min(value, std::max(demand.swarmPeers, MIN_DEMAND));
+
+    return value;
+}
+
+QList<int> BitTorrent::rebalanceConnections(const int budget, const QList<ConnectionDemand> &demands)
+{
+    QList<int> values;
+    values.reserve(demands.size());
+    for (const ConnectionDemand &demand : demands)
+        values.append(connectionDemand(demand));
+
+    QList<int> budgets = shareBandwidth(budget, values);
+    for (qsizetype i = 0; i < budgets.size(); ++i)
+    {
+        budgets[i] = std::max(budgets[i], MIN_BUDGET);
+
+        const int currentBudget = demands[i].budget;
+        if ((currentBudget > 0) && (std::abs(budgets[i] - currentBudget) < std::max(MIN_BUDGET_CHANGE, (currentBudget / 5))))
+            budgets[i] = currentBudget;
+    }
+
+    return budgets;
+}
@@ -28,37 +28,200 @@
 
 #include "customstorage.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
 #include <libtorrent/download_priority.hpp>
 
+#include <QMutex>
+#include <QSet>
+#include <QStorageInfo>
+
 #include "base/utils/fs.h"
 #include "common.h"
+#include "diskiostatistics.h"
+
+namespace
+{
+    QMutex trustedResumeDataMutex;
+    QSet<BitTorrent::TorrentID> trustedResumeDataTorrents;
+
+    bool takeTrustedResumeData(const BitTorrent::TorrentID &torrentID)
+    {
+        const QMutexLocker locker {&trustedResumeDataMutex};
+        return trustedResumeDataTorrents.remove(torrentID);
+    }
+
+    bool hasLinks(const lt::aux::vector<std::string, lt::file_index_t> &links)
+    {
+        return std::any_of(links.cbegin(), links.cend(), [](const std::string &link) { return !link.empty(); });
+    }
+}
+
+void trustResumeData(const BitTorrent::TorrentID &torrentID)
+{
+    const QMutexLocker locker {&trustedResumeDataMutex};
+    trustedResumeDataTorrents.insert(torrentID);
+}
 
 #ifdef QBT_USES_LIBTORRENT2
+#include <boost/asio/post.hpp>
+#include <libtorrent/disk_buffer_holder.hpp>
 #include <libtorrent/mmap_disk_io.hpp>
 #include <libtorrent/posix_disk_io.hpp>
 #include <libtorrent/session.hpp>
 
+#ifdef QBT_USES_IO_URING
+#include "iouringdiskio.h"
+#endif
+
+using BitTorrent::BlockReadCache;
+using BitTorrent::DiskJobScheduler;
+using BitTorrent::DiskJobType;
+
+namespace
+{
+    std::atomic_int maxActiveJobsPerDevice {0};
+    std::atomic_int readsPerHashJob {4};
+    std::atomic<qint64> readCacheSize {0};
+
+    // owns copies of cached blocks handed over to libtorrent
+    class CachedBlockAllocator final : public lt::buffer_allocator_interface
+    {
+    public:
+        void free_disk_buffer(char *buffer) override
+        {
+            delete[] buffer;
+        }
+    };
+
+    CachedBlockAllocator cachedBlockAllocator;
+
+    int toStatisticsIndex(const lt::storage_index_t storage)
+    {
+        return static_cast<int>(static_cast<std::uint32_t>(storage));
+    }
+
+    // identifies the device (or at least the file system) the path resides on
+    QString storageDevice(const Path &path)
+    {
+        // save path may not exist yet
+        Path existingPath = path;
+        while (!existingPath.exists())
+        {
+            const Path parentPath = existingPath.parentPath();
+            if (parentPath.isEmpty() || (parentPath == existingPath))
+                break;
+            existingPath = parentPath;
+        }
+
+        const QStorageInfo storageInfo {existingPath.data()};
+        if (!storageInfo.isValid())
+            return {};
+
+        const QByteArray device = storageInfo.device();
+        return device.isEmpty() ? storageInfo.rootPath() : QString::fromLocal8Bit(device);
+    }
+}
+
 std::unique_ptr<lt::disk_interface> customDiskIOConstructor(
         lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::default_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(ioContext, lt::default_disk_io_constructor(ioContext, settings, counters));
 }
 
 std::unique_ptr<lt::disk_interface> customPosixDiskIOConstructor(
         lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::posix_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(ioContext, lt::posix_disk_io_constructor(ioContext, settings, counters));
 }
 
 std::unique_ptr<lt::disk_interface> customMMapDiskIOConstructor(
         lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::mmap_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(ioContext, lt::mmap_disk_io_constructor(ioContext, settings, counters));
 }
 
-CustomDiskIOThread::CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread)
-    : m_nativeDiskIO {std::move(nativeDiskIOThread)}
+#ifdef QBT_USES_IO_URING
+std::unique_ptr<lt::disk_interface> customIOUringDiskIOConstructor(
+        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
 {
+    return std::make_unique<CustomDiskIOThread>(ioContext
+            , std::make_unique<IOUringDiskIO>(ioContext, settings, lt::posix_disk_io_constructor(ioContext, settings, counters)));
+}
+#endif
+
+CustomDiskIOThread::CustomDiskIOThread(lt::io_context &ioContext, std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread)
+    : m_ioContext {ioContext}
+    , m_nativeDiskIO {std::move(nativeDiskIOThread)}
+    , m_statistics {BitTorrent::DiskIOStatisticsCollector::instance()}
+{
+}
+
+void CustomDiskIOThread::setMaxActiveJobsPerDevice(const int value)
+{
+    maxActiveJobsPerDevice.store(value, std::memory_order_relaxed);
+}
+
+void CustomDiskIOThread::setReadsPerHashJob(const int value)
+{
+    readsPerHashJob.store(value, std::memory_order_relaxed);
+}
+
+void CustomDiskIOThread::setReadCacheSize(const qint64 size)
+{
+    readCacheSize.store(size, std::memory_order_relaxed);
+}
+
+// Wraps completion handler of disk job so that its duration is recorded once it is completed
+template <typename Handler>
+auto CustomDiskIOThread::measured(const DiskJobType type, Handler handler)
+{
+    m_statistics->jobStarted();
+    return [statistics = m_statistics, type, startTime = BitTorrent::DiskIOStatisticsCollector::Clock::now()
+            , handler = std::move(handler)]<typename... Args>(Args &&...args) mutable
+    {
+        statistics->jobFinished(type, startTime);
+        handler(std::forward<Args>(args)...);
+    };
+}
+
+// Passes read and hash jobs through per device queues. The job is submitted to native
+// disk I/O once the device has free slot and its completion releases the slot.
+template <typename Handler, typename Submit>
+void CustomDiskIOThread::schedule(const lt::storage_index_t storage, const DiskJobScheduler::JobClass jobClass
+        , Handler handler, Submit submit)
+{
+    m_scheduler.setMaxActiveJobs(maxActiveJobsPerDevice.load(std::memory_order_relaxed));
+    m_scheduler.setReadsPerHashJob(readsPerHashJob.load(std::memory_order_relaxed));
+
+    const auto storageIt = m_storageData.constFind(storage);
+    const QString device = (storageIt != m_storageData.cend()) ? storageIt->device : QString();
+    auto scheduledHandler = [this, device, handler = std::move(handler)]<typename... Args>(Args &&...args) mutable
+    {
+        if (m_scheduler.jobFinished(device))
+            m_nativeDiskIO->submit_jobs();
+        handler(std::forward<Args>(args)...);
+    };
+
+    m_scheduler.submit(device, toStatisticsIndex(storage), jobClass
+            , [submit = std::move(submit), scheduledHandler = std::move(scheduledHandler)]() mutable
+    {
+        submit(std::move(scheduledHandler));
+    });
+}
+
+// Operations on the storage must not overtake its jobs still waiting in device queue
+void CustomDiskIOThread::flushScheduledJobs(const lt::storage_index_t storage)
+{
+    m_scheduler.flushStorage(toStatisticsIndex(storage));
+}
+
+void CustomDiskIOThread::updateReadCacheStatistics() const
+{
+    m_statistics->setReadCacheStatistics({.hits = m_readCache.hits(), .misses = m_readCache.misses(), .size = m_readCache.size()});
 }
 
 lt::storage_holder CustomDiskIOThread::new_torrent(const lt::storage_params &storageParams, const std::shared_ptr<void> &torrent)
@@ -66,47 +229,122 @@ lt::storage_holder CustomDiskIOThread::new_torrent(const lt::storage_params &sto
     lt::storage_holder storageHolder = m_nativeDiskIO->new_torrent(storageParams, torrent);
 
     const Path savePath {storageParams.path};
+    const auto torrentID = BitTorrent::TorrentID::fromSHA1Hash(storageParams.info_hash);
     m_storageData[storageHolder] =
     {
         savePath,
+        storageDevice(savePath),
         storageParams.mapped_files ? *storageParams.mapped_files : storageParams.files,
-        storageParams.priorities
+        storageParams.priorities,
+        takeTrustedResumeData(torrentID)
     };
+    m_statistics->addStorage(toStatisticsIndex(storageHolder), torrentID);
 
     return storageHolder;
 }
 
 void CustomDiskIOThread::remove_torrent(lt::storage_index_t storage)
 {
+    flushScheduledJobs(storage);
+    m_readCache.removeStorage(toStatisticsIndex(storage));
+    updateReadCacheStatistics();
     m_nativeDiskIO->remove_torrent(storage);
+    m_statistics->removeStorage(toStatisticsIndex(storage));
 }
 
 void CustomDiskIOThread::async_read(lt::storage_index_t storage, const lt::peer_request &peerRequest
                                     , std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> handler
                                     , lt::disk_job_flags_t flags)
 {
-    m_nativeDiskIO->async_read(storage, peerRequest, std::move(handler), flags);
+    if (const qint64 cacheSize = readCacheSize.load(std::memory_order_relaxed); cacheSize != m_readCache.capacity())
+    {
+        m_readCache.setCapacity(cacheSize);
+        updateReadCacheStatistics();
+    }
+
+    const BlockReadCache::BlockKey blockKey
+    {
+        .storage = toStatisticsIndex(storage),
+        .piece = static_cast<int>(peerRequest.piece),
+        .offset = peerRequest.start,
+        .length = peerRequest.length
+    };
+    quint64 cacheGeneration = 0;
+    if (m_readCache.capacity() > 0)
+    {
+        const QByteArray block = m_readCache.find(blockKey);
+        updateReadCacheStatistics();
+        if (!block.isNull())
+        {
+            // libtorrent doesn't expect the handler to be invoked before the job is submitted
+            boost::asio::post(m_ioContext, [block, handler = std::move(handler)]
+            {
+                auto *buffer = new char[block.size()];
+                std::memcpy(buffer, block.constData(), block.size());
+                handler(lt::disk_buffer_holder(cachedBlockAllocator, buffer, static_cast<int>(block.size())), {});
+            });
+            return;
+        }
+
+        cacheGeneration = m_readCache.generation(blockKey.storage);
+    }
+
+    auto readHandler = measured(DiskJobType::Read
+            , [this, blockKey, cacheGeneration, handler = std::move(handler)](lt::disk_buffer_holder buffer, const lt::storage_error &error)
+    {
+        if (!error)
+        {
+            m_statistics->addBytesRead(blockKey.storage, blockKey.length);
+            if (m_readCache.isAdmitted(blockKey)
+                    && m_readCache.insert(blockKey, QByteArray(buffer.data(), buffer.size()), cacheGeneration))
+            {
+                updateReadCacheStatistics();
+            }
+        }
+        handler(std::move(buffer), error);
+    });
+    schedule(storage, DiskJobScheduler::JobClass::Read, std::move(readHandler)
+            , [this, storage, peerRequest, flags](auto scheduledHandler)
+    {
+        m_nativeDiskIO->async_read(storage, peerRequest, std::move(scheduledHandler), flags);
+    });
 }
 
 bool CustomDiskIOThread::async_write(lt::storage_index_t storage, const lt::peer_request &peerRequest
                                      , const char *buf, std::shared_ptr<lt::disk_observer> diskObserver
                                      , std::function<void (const lt::storage_error &)> handler, lt::disk_job_flags_t flags)
 {
-    return m_nativeDiskIO->async_write(storage, peerRequest, buf, std::move(diskObserver), std::move(handler), flags);
+    m_readCache.removePiece(toStatisticsIndex(storage), static_cast<int>(peerRequest.piece));
+
+    return m_nativeDiskIO->async_write(storage, peerRequest, buf, std::move(diskObserver), measured(DiskJobType::Write
+            , [this, storage, length = peerRequest.length, handler = std::move(handler)](const lt::storage_error &error)
+    {
+        if (!error)
+            m_statistics->addBytesWritten(toStatisticsIndex(storage), length);
+        handler(error);
+    }), flags);
 }
 
 void CustomDiskIOThread::async_hash(lt::storage_index_t storage, lt::piece_index_t piece
                                     , lt::span<lt::sha256_hash> hash, lt::disk_job_flags_t flags
                                     , std::function<void (lt::piece_index_t, const lt::sha1_hash &, const lt::storage_error &)> handler)
 {
-    m_nativeDiskIO->async_hash(storage, piece, hash, flags, std::move(handler));
+    schedule(storage, DiskJobScheduler::JobClass::Hash, measured(DiskJobType::Hash, std::move(handler))
+            , [this, storage, piece, hash, flags](auto scheduledHandler)
+    {
+        m_nativeDiskIO->async_hash(storage, piece, hash, flags, std::move(scheduledHandler));
+    });
 }
 
 void CustomDiskIOThread::async_hash2(lt::storage_index_t storage, lt::piece_index_t piece
                                      , int offset, lt::disk_job_flags_t flags
                                      , std::function<void (lt::piece_index_t, const lt::sha256_hash &, const lt::storage_error &)> handler)
 {
-    m_nativeDiskIO->async_hash2(storage, piece, offset, flags, std::move(handler));
+    schedule(storage, DiskJobScheduler::JobClass::Hash, measured(DiskJobType::Hash, std::move(handler))
+            , [this, storage, piece, offset, flags](auto scheduledHandler)
+    {
+        m_nativeDiskIO->async_hash2(storage, piece, offset, flags, std::move(scheduledHandler));
+    });
 }
 
 void CustomDiskIOThread::async_move_storage(lt::storage_index_t storage, std::string path, lt::move_flags_t flags
@@ -117,7 +355,11 @@ void CustomDiskIOThread::async_move_storage(lt::storage_index_t storage, std::st
     if (flags == lt::move_flags_t::dont_replace)
         handleCompleteFiles(storage, newSavePath);
 
-    m_nativeDiskIO->async_move_storage(storage, path, flags
+    flushScheduledJobs(storage);
+    m_readCache.removeStorage(toStatisticsIndex(storage));
+    updateReadCacheStatistics();
+
+    m_nativeDiskIO->async_move_storage(storage, path, flags, measured(DiskJobType::Other
             , [=, this, handler = std::move(handler)](lt::status_t status, const std::string &path, const lt::storage_error &error)
     {
 #if LIBTORRENT_VERSION_NUM < 20100
@@ -125,63 +367,98 @@ void CustomDiskIOThread::async_move_storage(lt::storage_index_t storage, std::st
 #else
         if ((status != lt::disk_status::fatal_disk_error) && (status != lt::disk_status::file_exist))
 #endif
-            m_storageData[storage].savePath = newSavePath;
+        {
+            StorageData &storageData = m_storageData[storage];
+            storageData.savePath = newSavePath;
+            storageData.device = storageDevice(newSavePath);
+        }
 
         handler(status, path, error);
-    });
+    }));
 }
 
 void CustomDiskIOThread::async_release_files(lt::storage_index_t storage, std::function<void ()> handler)
 {
-    m_nativeDiskIO->async_release_files(storage, std::move(handler));
+    flushScheduledJobs(storage);
+    m_nativeDiskIO->async_release_files(storage, measured(DiskJobType::Other, std::move(handler)));
 }
 
 void CustomDiskIOThread::async_check_files(lt::storage_index_t storage, const lt::add_torrent_params *resume_data
                                            , lt::aux::vector<std::string, lt::file_index_t> links
                                            , std::function<void (lt::status_t, const lt::storage_error &)> handler)
 {
-    handleCompleteFiles(storage, m_storageData[storage].savePath);
-    m_nativeDiskIO->async_check_files(storage, resume_data, std::move(links), std::move(handler));
+    StorageData &storageData = m_storageData[storage];
+    // Native check initializes the storage as well, it only matters for the files
+    // which aren't downloaded (they may be kept in part file) or have to be linked
+    const bool isTrusted = std::exchange(storageData.isResumeDataTrusted, false) && resume_data && !hasLinks(links)
+            && std::none_of(storageData.filePriorities.cbegin(), storageData.filePriorities.cend()
+                    , [](const lt::download_priority_t priority) { return priority == lt::dont_download; });
+    if (isTrusted)
+    {
+        // files are known to be left intact since the resume data was saved
+        boost::asio::post(m_ioContext, [handler = std::move(handler)]
+        {
+            handler(lt::status_t::no_error, {});
+        });
+        return;
+    }
+
+    handleCompleteFiles(storage, storageData.savePath);
+    flushScheduledJobs(storage);
+    // files may have been changed externally
+    m_readCache.removeStorage(toStatisticsIndex(storage));
+    updateReadCacheStatistics();
+    m_nativeDiskIO->async_check_files(storage, resume_data, std::move(links), measured(DiskJobType::Other, std::move(handler)));
 }
 
 void CustomDiskIOThread::async_stop_torrent(lt::storage_index_t storage, std::function<void ()> handler)
 {
-    m_nativeDiskIO->async_stop_torrent(storage, std::move(handler));
+    flushScheduledJobs(storage);
+    m_readCache.removeStorage(toStatisticsIndex(storage));
+    updateReadCacheStatistics();
+    m_nativeDiskIO->async_stop_torrent(storage, measured(DiskJobType::Other, std::move(handler)));
 }
 
 void CustomDiskIOThread::async_rename_file(lt::storage_index_t storage, lt::file_index_t index, std::string name
                                            , std::function<void (const std::string &, lt::file_index_t, const lt::storage_error &)> handler)
 {
-    m_nativeDiskIO->async_rename_file(storage, index, name
+    flushScheduledJobs(storage);
+    m_nativeDiskIO->async_rename_file(storage, index, name, measured(DiskJobType::Other
             , [=, this, handler = std::move(handler)](const std::string &name, lt::file_index_t index, const lt::storage_error &error)
     {
         if (!error)
             m_storageData[storage].files.rename_file(index, name);
         handler(name, index, error);
-    });
+    }));
 }
 
 void CustomDiskIOThread::async_delete_files(lt::storage_index_t storage, lt::remove_flags_t options
                                             , std::function<void (const lt::storage_error &)> handler)
 {
-    m_nativeDiskIO->async_delete_files(storage, options, std::move(handler));
+    flushScheduledJobs(storage);
+    m_readCache.removeStorage(toStatisticsIndex(storage));
+    updateReadCacheStatistics();
+    m_nativeDiskIO->async_delete_files(storage, options, measured(DiskJobType::Other, std::move(handler)));
 }
 
 void CustomDiskIOThread::async_set_file_priority(lt::storage_index_t storage, lt::aux::vector<lt::download_priority_t, lt::file_index_t> priorities
                                                  , std::function<void (const lt::storage_error &, lt::aux::vector<lt::download_priority_t, lt::file_index_t>)> handler)
 {
+    flushScheduledJobs(storage);
     m_nativeDiskIO->async_set_file_priority(storage, std::move(priorities)
-            , [=, this, handler = std::move(handler)](const lt::storage_error &error, const lt::aux::vector<lt::download_priority_t, lt::file_index_t> &priorities)
+            , measured(DiskJobType::Other, [=, this, handler = std::move(handler)](const lt::storage_error &error, const lt::aux::vector<lt::download_priority_t, lt::file_index_t> &priorities)
     {
         m_storageData[storage].filePriorities = priorities;
         handler(error, priorities);
-    });
+    }));
 }
 
 void CustomDiskIOThread::async_clear_piece(lt::storage_index_t storage, lt::piece_index_t index
                                            , std::function<void (lt::piece_index_t)> handler)
 {
-    m_nativeDiskIO->async_clear_piece(storage, index, std::move(handler));
+    flushScheduledJobs(storage);
+    m_readCache.removePiece(toStatisticsIndex(storage), static_cast<int>(index));
+    m_nativeDiskIO->async_clear_piece(storage, index, measured(DiskJobType::Other, std::move(handler)));
 }
 
 void CustomDiskIOThread::update_stats_counters(lt::counters &counters) const
@@ -196,6 +473,7 @@ std::vector<lt::open_file_state> CustomDiskIOThread::get_status(lt::storage_inde
 
 void CustomDiskIOThread::abort(bool wait)
 {
+    m_scheduler.flushAll();
     m_nativeDiskIO->abort(wait);
 }
 
@@ -246,11 +524,16 @@ lt::storage_interface *customStorageConstructor(const lt::storage_params &params
 CustomStorage::CustomStorage(const lt::storage_params &params, lt::file_pool &filePool)
     : lt::default_storage(params, filePool)
     , m_savePath {params.path}
+    , m_isResumeDataTrusted {params.info && takeTrustedResumeData(BitTorrent::TorrentID::fromInfoHash(params.info->info_hash()))}
 {
 }
 
 bool CustomStorage::verify_resume_data(const lt::add_torrent_params &rd, const lt::aux::vector<std::string, lt::file_index_t> &links, lt::storage_error &ec)
 {
+    // files are known to be left intact since the resume data was saved
+    if (std::exchange(m_isResumeDataTrusted, false) && !hasLinks(links))
+        return true;
+
     handleCompleteFiles(m_savePath);
     return lt::default_storage::verify_resume_data(rd, links, ec);
 }
@@ -34,6 +34,7 @@
 #include <QString>
 
 #include "base/path.h"
+#include "infohash.h"
 
 #ifdef QBT_USES_LIBTORRENT2
 #include <libtorrent/disk_interface.hpp>
@@ -41,10 +42,18 @@
 #include <libtorrent/io_context.hpp>
 
 #include <QHash>
+
+#include "blockreadcache.h"
+#include "diskiostatistics.h"
+#include "diskjobscheduler.h"
 #else
 #include <libtorrent/storage.hpp>
 #endif
 
+// Resume data of the torrent is trusted to be consistent with its files, so they aren't
+// examined when the torrent is added next time. Applies to the next addition only.
+void trustResumeData(const BitTorrent::TorrentID &torrentID);
+
 #ifdef QBT_USES_LIBTORRENT2
 std::unique_ptr<lt::disk_interface> customDiskIOConstructor(
         lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
@@ -52,11 +61,21 @@ std::unique_ptr<lt::disk_interface> customPosixDiskIOConstructor(
         lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
 std::unique_ptr<lt::disk_interface> customMMapDiskIOConstructor(
         lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
+#ifdef QBT_USES_IO_URING
+std::unique_ptr<lt::disk_interface> customIOUringDiskIOConstructor(
+        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
+#endif
 
 class CustomDiskIOThread final : public lt::disk_interface
 {
 public:
-    explicit CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread);
+    CustomDiskIOThread(lt::io_context &ioContext, std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread);
+
+    // applied to all the instances, 0 means unlimited
+    static void setMaxActiveJobsPerDevice(int value);
+    static void setReadsPerHashJob(int value);
+    // size of the cache of blocks requested by many peers in bytes, 0 disables it
+    static void setReadCacheSize(qint64 size);
 
     lt::storage_holder new_torrent(const lt::storage_params &storageParams, const std::shared_ptr<void> &torrent) override;
     void remove_torrent(lt::storage_index_t storageIndex) override;
@@ -91,14 +110,26 @@ public:
 
 private:
     void handleCompleteFiles(libtorrent::storage_index_t storage, const Path &savePath);
-
+    template <typename Handler>
+    auto measured(BitTorrent::DiskJobType type, Handler handler);
+    template <typename Handler, typename Submit>
+    void schedule(lt::storage_index_t storage, BitTorrent::DiskJobScheduler::JobClass jobClass, Handler handler, Submit submit);
+    void flushScheduledJobs(lt::storage_index_t storage);
+    void updateReadCacheStatistics() const;
+
+    lt::io_context &m_ioContext;
     std::unique_ptr<lt::disk_interface> m_nativeDiskIO;
+    BitTorrent::DiskIOStatisticsCollector *m_statistics = nullptr;
+    BitTorrent::DiskJobScheduler m_scheduler;
+    BitTorrent::BlockReadCache m_readCache;
 
     struct StorageData
     {
         Path savePath;
+        QString device;
         lt::file_storage files;
         lt::aux::vector<lt::download_priority_t, lt::file_index_t> filePriorities;
+        bool isResumeDataTrusted = false;
     };
     QHash<lt::storage_index_t, StorageData> m_storageData;
 };
@@ -121,5 +152,6 @@ private:
 
     lt::aux::vector<lt::download_priority_t, lt::file_index_t> m_filePriorities;
     Path m_savePath;
+    bool m_isResumeDataTrusted = false;
 };
 #endif
@@ -28,9 +28,11 @@
 
 #include "dbresumedatastorage.h"
 
+#include <algorithm>
+#include <deque>
 #include <memory>
-#include <queue>
 #include <utility>
+#include <vector>
 
 #include <libtorrent/bdecode.hpp>
 #include <libtorrent/bencode.hpp>
@@ -41,6 +43,8 @@
 
 #include <QByteArray>
 #include <QDebug>
+#include <QDeadlineTimer>
+#include <QHash>
 #include <QMutex>
 #include <QSet>
 #include <QSqlDatabase>
@@ -54,9 +58,11 @@
 #include "base/exceptions.h"
 #include "base/global.h"
 #include "base/logger.h"
+#include "base/memoryusage.h"
 #include "base/path.h"
 #include "base/preferences.h"
 #include "base/profile.h"
+#include "base/tracing.h"
 #include "base/utils/fs.h"
 #include "base/utils/sslkey.h"
 #include "base/utils/string.h"
@@ -67,7 +73,7 @@ namespace
 {
     const QString DB_CONNECTION_NAME = u"ResumeDataStorage"_s;
 
-    const int DB_VERSION = 8;
+    const int DB_VERSION = 9;
 
     const QString DB_TABLE_META = u"meta"_s;
     const QString DB_TABLE_TORRENTS = u"torrents"_s;
@@ -86,22 +92,42 @@ namespace
     class StoreJob final : public Job
     {
     public:
-        StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData);
+        StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData, QSet<TorrentID> &storedMetadata);
         void perform(QSqlDatabase db) override;
 
+        TorrentID torrentID() const;
+        void setResumeData(const LoadTorrentParams &resumeData);
+        void applyCounters(const ResumeDataCounters &counters);
+
+    private:
+        const TorrentID m_torrentID;
+        LoadTorrentParams m_resumeData;
+        QSet<TorrentID> &m_storedMetadata;
+    };
+
+    class StoreCountersJob final : public Job
+    {
+    public:
+        StoreCountersJob(const TorrentID &torrentID, const ResumeDataCounters &counters);
+        void perform(QSqlDatabase db) override;
+
+        TorrentID torrentID() const;
+        void setCounters(const ResumeDataCounters &counters);
+
     private:
         const TorrentID m_torrentID;
-        const LoadTorrentParams m_resumeData;
+        ResumeDataCounters m_counters;
     };
 
     class RemoveJob final : public Job
     {
     public:
-        explicit RemoveJob(const TorrentID &torrentID);
+        RemoveJob(const TorrentID &torrentID, QSet<TorrentID> &storedMetadata);
         void perform(QSqlDatabase db) override;
 
     private:
         const TorrentID m_torrentID;
+        QSet<TorrentID> &m_storedMetadata;
     };
 
     class StoreQueueJob final : public Job
@@ -149,6 +175,7 @@ namespace
     const Column DB_COLUMN_SSL_DH_PARAMS = makeColumn("ssl_dh_params");
     const Column DB_COLUMN_RESUMEDATA = makeColumn("libtorrent_resume_data");
     const Column DB_COLUMN_METADATA = makeColumn("metadata");
+    const Column DB_COLUMN_RESUMEDATA_COUNTERS = makeColumn("resume_data_counters");
     const Column DB_COLUMN_VALUE = makeColumn("value");
 
     template <typename LTStr>
@@ -219,48 +246,48 @@ namespace
         return u"%1 %2"_s.arg(quoted(column.name), QString::fromLatin1(definition));
     }
 
-    LoadTorrentParams parseQueryResultRow(const QSqlQuery &query)
+    LoadTorrentParams parseQueryResultRow(const QSqlRecord &record)
     {
         LoadTorrentParams resumeData;
-        resumeData.name = query.value(DB_COLUMN_NAME.name).toString();
-        resumeData.category = query.value(DB_COLUMN_CATEGORY.name).toString();
-        const QString tagsData = query.value(DB_COLUMN_TAGS.name).toString();
+        resumeData.name = record.value(DB_COLUMN_NAME.name).toString();
+        resumeData.category = record.value(DB_COLUMN_CATEGORY.name).toString();
+        const QString tagsData = record.value(DB_COLUMN_TAGS.name).toString();
         if (!tagsData.isEmpty())
         {
             const QStringList tagList = tagsData.split(u',');
             resumeData.tags.insert(tagList.cbegin(), tagList.cend());
         }
-        resumeData.hasFinishedStatus = query.value(DB_COLUMN_HAS_SEED_STATUS.name).toBool();
-        resumeData.firstLastPiecePriority = query.value(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY.name).toBool();
-        resumeData.ratioLimit = query.value(DB_COLUMN_RATIO_LIMIT.name).toInt() / 1000.0;
-        resumeData.seedingTimeLimit = query.value(DB_COLUMN_SEEDING_TIME_LIMIT.name).toInt();
-        resumeData.inactiveSeedingTimeLimit = query.value(DB_COLUMN_INACTIVE_SEEDING_TIME_LIMIT.name).toInt();
+        resumeData.hasFinishedStatus = record.value(DB_COLUMN_HAS_SEED_STATUS.name).toBool();
+        resumeData.firstLastPiecePriority = record.value(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY.name).toBool();
+        resumeData.ratioLimit = record.value(DB_COLUMN_RATIO_LIMIT.name).toInt() / 1000.0;
+        resumeData.seedingTimeLimit = record.value(DB_COLUMN_SEEDING_TIME_LIMIT.name).toInt();
+        resumeData.inactiveSeedingTimeLimit = record.value(DB_COLUMN_INACTIVE_SEEDING_TIME_LIMIT.name).toInt();
         resumeData.shareLimitAction = Utils::String::toEnum<ShareLimitAction>(
-                query.value(DB_COLUMN_SHARE_LIMIT_ACTION.name).toString(), ShareLimitAction::Default);
+                record.value(DB_COLUMN_SHARE_LIMIT_ACTION.name).toString(), ShareLimitAction::Default);
         resumeData.contentLayout = Utils::String::toEnum<TorrentContentLayout>(
-                query.value(DB_COLUMN_CONTENT_LAYOUT.name).toString(), TorrentContentLayout::Original);
+                record.value(DB_COLUMN_CONTENT_LAYOUT.name).toString(), TorrentContentLayout::Original);
         resumeData.operatingMode = Utils::String::toEnum<TorrentOperatingMode>(
-                query.value(DB_COLUMN_OPERATING_MODE.name).toString(), TorrentOperatingMode::AutoManaged);
-        resumeData.stopped = query.value(DB_COLUMN_STOPPED.name).toBool();
+                record.value(DB_COLUMN_OPERATING_MODE.name).toString(), TorrentOperatingMode::AutoManaged);
+        resumeData.stopped = record.value(DB_COLUMN_STOPPED.name).toBool();
         resumeData.stopCondition = Utils::String::toEnum(
-                query.value(DB_COLUMN_STOP_CONDITION.name).toString(), Torrent::StopCondition::None);
+                record.value(DB_COLUMN_STOP_CONDITION.name).toString(), Torrent::StopCondition::None);
         resumeData.sslParameters =
         {
-            .certificate = QSslCertificate(query.value(DB_COLUMN_SSL_CERTIFICATE.name).toByteArray()),
-            .privateKey = Utils::SSLKey::load(query.value(DB_COLUMN_SSL_PRIVATE_KEY.name).toByteArray()),
-            .dhParams = query.value(DB_COLUMN_SSL_DH_PARAMS.name).toByteArray()
+            .certificate = QSslCertificate(record.value(DB_COLUMN_SSL_CERTIFICATE.name).toByteArray()),
+            .privateKey = Utils::SSLKey::load(record.value(DB_COLUMN_SSL_PRIVATE_KEY.name).toByteArray()),
+            .dhParams = record.value(DB_COLUMN_SSL_DH_PARAMS.name).toByteArray()
         };
 
         resumeData.savePath = Profile::instance()->fromPortablePath(
-                    Path(query.value(DB_COLUMN_TARGET_SAVE_PATH.name).toString()));
+                    Path(record.value(DB_COLUMN_TARGET_SAVE_PATH.name).toString()));
         resumeData.useAutoTMM = resumeData.savePath.isEmpty();
         if (!resumeData.useAutoTMM)
         {
             resumeData.downloadPath = Profile::instance()->fromPortablePath(
-                        Path(query.value(DB_COLUMN_DOWNLOAD_PATH.name).toString()));
+                        Path(record.value(DB_COLUMN_DOWNLOAD_PATH.name).toString()));
         }
 
-        const QByteArray bencodedResumeData = query.value(DB_COLUMN_RESUMEDATA.name).toByteArray();
+        const QByteArray bencodedResumeData = record.value(DB_COLUMN_RESUMEDATA.name).toByteArray();
         const auto *pref = Preferences::instance();
         const int bdecodeDepthLimit = pref->getBdecodeDepthLimit();
         const int bdecodeTokenLimit = pref->getBdecodeTokenLimit();
@@ -273,7 +300,15 @@ namespace
 
         p = lt::read_resume_data(resumeDataRoot, ec);
 
-        if (const QByteArray bencodedMetadata = query.value(DB_COLUMN_METADATA.name).toByteArray()
+        // counters stored after resume data are more recent than the ones it contains
+        if (const QByteArray bencodedCounters = record.value(DB_COLUMN_RESUMEDATA_COUNTERS.name).toByteArray()
+                ; !bencodedCounters.isEmpty())
+        {
+            if (const std::optional<ResumeDataCounters> counters = ResumeDataCounters::fromBencodedData(bencodedCounters))
+                counters->applyTo(p);
+        }
+
+        if (const QByteArray bencodedMetadata = record.value(DB_COLUMN_METADATA.name).toByteArray()
                 ; !bencodedMetadata.isEmpty())
         {
             const lt::bdecode_node torentInfoRoot = lt::bdecode(bencodedMetadata, ec
@@ -306,18 +341,34 @@ namespace BitTorrent
         void run() override;
         void requestInterruption();
 
+        void setBatchLimits(int maxJobs, int latency);
+
         void store(const TorrentID &id, const LoadTorrentParams &resumeData);
+        void storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData);
+        void storeCounters(const QHash<TorrentID, ResumeDataCounters> &counters);
         void remove(const TorrentID &id);
+        void removeAll(const QVector<TorrentID> &ids);
         void storeQueue(const QVector<TorrentID> &queue);
 
+        MemoryUsage::Entry estimateMemoryUsage();
+
     private:
         void addJob(std::unique_ptr<Job> job);
+        void enqueueStoreJob(const TorrentID &id, const LoadTorrentParams &resumeData);
+        std::vector<std::unique_ptr<Job>> takeBatch();
 
         const QString m_connectionName = u"ResumeDataStorageWorker"_s;
         const Path m_path;
         QReadWriteLock &m_dbLock;
 
-        std::queue<std::unique_ptr<Job>> m_jobs;
+        std::deque<std::unique_ptr<Job>> m_jobs;
+        // store jobs that are still queued, so newer resume data can replace the queued one
+        QHash<TorrentID, StoreJob *> m_queuedStoreJobs;
+        QHash<TorrentID, StoreCountersJob *> m_queuedStoreCountersJobs;
+        // torrents whose metadata is already in database, it is accessed by jobs only
+        QSet<TorrentID> m_storedMetadata;
+        qsizetype m_maxBatchSize = 1000;
+        int m_batchLatency = 100;
         QMutex m_jobsMutex;
         QWaitCondition m_waitCondition;
     };
@@ -347,6 +398,16 @@ BitTorrent::DBResumeDataStorage::DBResumeDataStorage(const Path &dbPath, QObject
 
     m_asyncWorker = new Worker(dbPath, m_dbLock, this);
     m_asyncWorker->start();
+
+    MemoryUsage::registerEstimator(this, [this]() -> QList<MemoryUsage::Entry>
+    {
+        return {m_asyncWorker->estimateMemoryUsage()};
+    });
+}
+
+void BitTorrent::DBResumeDataStorage::setBatchLimits(const int maxJobs, const int latency)
+{
+    m_asyncWorker->setBatchLimits(maxJobs, latency);
 }
 
 BitTorrent::DBResumeDataStorage::~DBResumeDataStorage()
@@ -400,7 +461,7 @@ BitTorrent::LoadResumeDataResult BitTorrent::DBResumeDataStorage::load(const Tor
             .arg(id.toString(), err.message()));
     }
 
-    return parseQueryResultRow(query);
+    return parseQueryResultRow(query.record());
 }
 
 void BitTorrent::DBResumeDataStorage::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
@@ -408,11 +469,26 @@ void BitTorrent::DBResumeDataStorage::store(const TorrentID &id, const LoadTorre
     m_asyncWorker->store(id, resumeData);
 }
 
+void BitTorrent::DBResumeDataStorage::storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const
+{
+    m_asyncWorker->storeAll(resumeData);
+}
+
+void BitTorrent::DBResumeDataStorage::storeCounters(const QHash<TorrentID, ResumeDataCounters> &counters) const
+{
+    m_asyncWorker->storeCounters(counters);
+}
+
 void BitTorrent::DBResumeDataStorage::remove(const BitTorrent::TorrentID &id) const
 {
     m_asyncWorker->remove(id);
 }
 
+void BitTorrent::DBResumeDataStorage::removeAll(const QVector<TorrentID> &ids) const
+{
+    m_asyncWorker->removeAll(ids);
+}
+
 void BitTorrent::DBResumeDataStorage::storeQueue(const QVector<TorrentID> &queue) const
 {
     m_asyncWorker->storeQueue(queue);
@@ -449,11 +525,17 @@ void BitTorrent::DBResumeDataStorage::doLoadAll() const
         if (!query.exec(selectStatement))
             throw RuntimeError(query.lastError().text());
 
+        // rows are fetched sequentially by this thread, the rest is done by decoding threads
         while (query.next())
         {
             const auto torrentID = TorrentID::fromString(query.value(DB_COLUMN_TORRENT_ID.name).toString());
-            onResumeDataLoaded(torrentID, parseQueryResultRow(query));
+            enqueueResumeDataDecoding(torrentID, [record = query.record()]() -> LoadResumeDataResult
+            {
+                return parseQueryResultRow(record);
+            });
         }
+
+        waitForResumeDataDecoding();
     }
 
     emit const_cast<DBResumeDataStorage *>(this)->loadFinished();
@@ -553,7 +635,8 @@ void BitTorrent::DBResumeDataStorage::createDB() const
             makeColumnDefinition(DB_COLUMN_SSL_PRIVATE_KEY, "TEXT"),
             makeColumnDefinition(DB_COLUMN_SSL_DH_PARAMS, "TEXT"),
             makeColumnDefinition(DB_COLUMN_RESUMEDATA, "BLOB NOT NULL"),
-            makeColumnDefinition(DB_COLUMN_METADATA, "BLOB")
+            makeColumnDefinition(DB_COLUMN_METADATA, "BLOB"),
+            makeColumnDefinition(DB_COLUMN_RESUMEDATA_COUNTERS, "BLOB")
         };
         const QString createTableTorrentsQuery = makeCreateTableStatement(DB_TABLE_TORRENTS, tableTorrentsItems);
         if (!query.exec(createTableTorrentsQuery))
@@ -654,6 +737,9 @@ void BitTorrent::DBResumeDataStorage::updateDB(const int fromVersion) const
                 throw RuntimeError(query.lastError().text());
         }
 
+        if (fromVersion <= 8)
+            addColumn(DB_TABLE_TORRENTS, DB_COLUMN_RESUMEDATA_COUNTERS, "BLOB");
+
         const QString updateMetaVersionQuery = makeUpdateStatement(DB_TABLE_META, {DB_COLUMN_NAME, DB_COLUMN_VALUE});
         if (!query.prepare(updateMetaVersionQuery))
             throw RuntimeError(query.lastError().text());
@@ -705,48 +791,41 @@ void BitTorrent::DBResumeDataStorage::Worker::run()
         if (!db.open())
             throw RuntimeError(db.lastError().text());
 
-        int64_t transactedJobsCount = 0;
-        while (true)
         {
-            m_jobsMutex.lock();
-            if (m_jobs.empty())
+            const auto selectStoredMetadataStatement = u"SELECT %1 FROM %2 WHERE %3 IS NOT NULL;"_s
+                    .arg(quoted(DB_COLUMN_TORRENT_ID.name), quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_METADATA.name));
+
+            const QReadLocker locker {&m_dbLock};
+            QSqlQuery query {db};
+            if (query.exec(selectStoredMetadataStatement))
             {
-                if (transactedJobsCount > 0)
-                {
-                    db.commit();
-                    m_dbLock.unlock();
+                while (query.next())
+                    m_storedMetadata.insert(TorrentID::fromString(query.value(0).toString()));
+            }
+        }
 
-                    qDebug() << "Resume data changes are committed. Transacted jobs:" << transactedJobsCount;
-                    transactedJobsCount = 0;
-                }
+        while (true)
+        {
+            const std::vector<std::unique_ptr<Job>> jobs = takeBatch();
+            if (jobs.empty())
+                break;
 
-                if (isInterruptionRequested())
-                {
-                    m_jobsMutex.unlock();
-                    break;
-                }
+            m_dbLock.lockForWrite();
+            if (!db.transaction())
+            {
+                LogMsg(tr("Couldn't begin transaction. Error: %1").arg(db.lastError().text()), Log::WARNING);
+                m_dbLock.unlock();
+                break;
+            }
 
-                m_waitCondition.wait(&m_jobsMutex);
-                if (isInterruptionRequested())
-                {
-                    m_jobsMutex.unlock();
-                    break;
-                }
+            for (const std::unique_ptr<Job> &job : jobs)
+                job->perform(db);
 
-                m_dbLock.lockForWrite();
-                if (!db.transaction())
-                {
-                    LogMsg(tr("Couldn't begin transaction. Error: %1").arg(db.lastError().text()), Log::WARNING);
-                    m_dbLock.unlock();
-                    break;
-                }
-            }
-            std::unique_ptr<Job> job = std::move(m_jobs.front());
-            m_jobs.pop();
-            m_jobsMutex.unlock();
+            if (!db.commit())
+                LogMsg(tr("Couldn't commit transaction. Error: %1").arg(db.lastError().text()), Log::WARNING);
+            m_dbLock.unlock();
 
-            job->perform(db);
-            ++transactedJobsCount;
+            qDebug() << "Resume data changes are committed. Transacted jobs:" << jobs.size();
         }
 
         db.close();
@@ -755,20 +834,146 @@ void BitTorrent::DBResumeDataStorage::Worker::run()
     QSqlDatabase::removeDatabase(m_connectionName);
 }
 
+// Waits for jobs and takes the next batch of them, so they get performed within single transaction.
+// Once the first job is queued it waits up to batch latency for more jobs to come.
+// Returns empty batch if interruption is requested and there are no more jobs.
+std::vector<std::unique_ptr<Job>> BitTorrent::DBResumeDataStorage::Worker::takeBatch()
+{
+    const QMutexLocker locker {&m_jobsMutex};
+
+    while (m_jobs.empty())
+    {
+        if (isInterruptionRequested())
+            return {};
+        m_waitCondition.wait(&m_jobsMutex);
+    }
+
+    const QDeadlineTimer deadline {m_batchLatency};
+    while ((static_cast<qsizetype>(m_jobs.size()) < m_maxBatchSize) && !deadline.hasExpired() && !isInterruptionRequested())
+        m_waitCondition.wait(&m_jobsMutex, deadline);
+
+    const auto batchSize = std::min(static_cast<qsizetype>(m_jobs.size()), m_maxBatchSize);
+    std::vector<std::unique_ptr<Job>> jobs;
+    jobs.reserve(batchSize);
+    for (qsizetype i = 0; i < batchSize; ++i)
+    {
+        std::unique_ptr<Job> job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+
+        if (auto *storeJob = dynamic_cast<StoreJob *>(job.get()))
+        {
+            const auto iter = m_queuedStoreJobs.find(storeJob->torrentID());
+            if ((iter != m_queuedStoreJobs.end()) && (iter.value() == storeJob))
+                m_queuedStoreJobs.erase(iter);
+        }
+        else if (auto *storeCountersJob = dynamic_cast<StoreCountersJob *>(job.get()))
+        {
+            const auto iter = m_queuedStoreCountersJobs.find(storeCountersJob->torrentID());
+            if ((iter != m_queuedStoreCountersJobs.end()) && (iter.value() == storeCountersJob))
+                m_queuedStoreCountersJobs.erase(iter);
+        }
+
+        jobs.push_back(std::move(job));
+    }
+
+    return jobs;
+}
+
 void DBResumeDataStorage::Worker::requestInterruption()
 {
     QThread::requestInterruption();
     m_waitCondition.wakeAll();
 }
 
+void BitTorrent::DBResumeDataStorage::Worker::setBatchLimits(const int maxJobs, const int latency)
+{
+    const QMutexLocker locker {&m_jobsMutex};
+    m_maxBatchSize = std::max(1, maxJobs);
+    m_batchLatency = std::max(0, latency);
+}
+
 void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData)
 {
-    addJob(std::make_unique<StoreJob>(id, resumeData));
+    m_jobsMutex.lock();
+    enqueueStoreJob(id, resumeData);
+    m_jobsMutex.unlock();
+
+    m_waitCondition.wakeAll();
+}
+
+// Jobs are queued at once, so they get performed within as few transactions as possible
+void BitTorrent::DBResumeDataStorage::Worker::storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData)
+{
+    if (resumeData.isEmpty())
+        return;
+
+    m_jobsMutex.lock();
+    for (auto it = resumeData.cbegin(); it != resumeData.cend(); ++it)
+        enqueueStoreJob(it.key(), it.value());
+    m_jobsMutex.unlock();
+
+    m_waitCondition.wakeAll();
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::storeCounters(const QHash<TorrentID, ResumeDataCounters> &counters)
+{
+    if (counters.isEmpty())
+        return;
+
+    m_jobsMutex.lock();
+    for (auto it = counters.cbegin(); it != counters.cend(); ++it)
+    {
+        const TorrentID &id = it.key();
+        // queued resume data isn't stored yet, so it can simply get more recent counters
+        if (StoreJob *queuedJob = m_queuedStoreJobs.value(id))
+        {
+            queuedJob->applyCounters(it.value());
+        }
+        else if (StoreCountersJob *queuedCountersJob = m_queuedStoreCountersJobs.value(id))
+        {
+            queuedCountersJob->setCounters(it.value());
+        }
+        else
+        {
+            auto job = std::make_unique<StoreCountersJob>(id, it.value());
+            m_queuedStoreCountersJobs.insert(id, job.get());
+            m_jobs.push_back(std::move(job));
+        }
+    }
+    m_jobsMutex.unlock();
+
+    m_waitCondition.wakeAll();
 }
 
 void BitTorrent::DBResumeDataStorage::Worker::remove(const TorrentID &id)
 {
-    addJob(std::make_unique<RemoveJob>(id));
+    m_jobsMutex.lock();
+    // torrent can be stored again after removal, so it must not be collapsed with the store queued before
+    m_queuedStoreJobs.remove(id);
+    m_queuedStoreCountersJobs.remove(id);
+    m_jobs.push_back(std::make_unique<RemoveJob>(id, m_storedMetadata));
+    m_jobsMutex.unlock();
+
+    m_waitCondition.wakeAll();
+}
+
+// Jobs are queued at once, so they get performed within as few transactions as possible
+void BitTorrent::DBResumeDataStorage::Worker::removeAll(const QVector<TorrentID> &ids)
+{
+    if (ids.isEmpty())
+        return;
+
+    m_jobsMutex.lock();
+    for (const TorrentID &id : ids)
+    {
+        // torrent can be stored again after removal, so it must not be collapsed with the store queued before
+        m_queuedStoreJobs.remove(id);
+        m_queuedStoreCountersJobs.remove(id);
+        m_jobs.push_back(std::make_unique<RemoveJob>(id, m_storedMetadata));
+    }
+    m_jobsMutex.unlock();
+
+    m_waitCondition.wakeAll();
 }
 
 void BitTorrent::DBResumeDataStorage::Worker::storeQueue(const QVector<TorrentID> &queue)
@@ -776,27 +981,72 @@ void BitTorrent::DBResumeDataStorage::Worker::storeQueue(const QVector<TorrentID
     addJob(std::make_unique<StoreQueueJob>(queue));
 }
 
+MemoryUsage::Entry BitTorrent::DBResumeDataStorage::Worker::estimateMemoryUsage()
+{
+    const QMutexLocker locker {&m_jobsMutex};
+    // store jobs keep the resume data, the other ones are negligible
+    const qint64 size = (static_cast<qint64>(m_jobs.size()) * sizeof(std::unique_ptr<Job>))
+        + (m_queuedStoreJobs.size() * sizeof(LoadTorrentParams))
+        + (m_queuedStoreCountersJobs.size() * sizeof(ResumeDataCounters));
+    return {u"resumedata.queuedjobs"_s, static_cast<qint64>(m_jobs.size()), size};
+}
+
 void BitTorrent::DBResumeDataStorage::Worker::addJob(std::unique_ptr<Job> job)
 {
     m_jobsMutex.lock();
-    m_jobs.push(std::move(job));
+    m_jobs.push_back(std::move(job));
     m_jobsMutex.unlock();
 
     m_waitCondition.wakeAll();
 }
 
+// Must be called with jobs mutex locked
+void BitTorrent::DBResumeDataStorage::Worker::enqueueStoreJob(const TorrentID &id, const LoadTorrentParams &resumeData)
+{
+    if (StoreJob *queuedJob = m_queuedStoreJobs.value(id))
+    {
+        queuedJob->setResumeData(resumeData);
+        return;
+    }
+
+    auto job = std::make_unique<StoreJob>(id, resumeData, m_storedMetadata);
+    m_queuedStoreJobs.insert(id, job.get());
+    m_jobs.push_back(std::move(job));
+
+    // counters queued before are included in the new resume data, store job is going to discard them anyway
+    m_queuedStoreCountersJobs.remove(id);
+}
+
 namespace
 {
     using namespace BitTorrent;
 
-    StoreJob::StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData)
+    StoreJob::StoreJob(const TorrentID &torrentID, const LoadTorrentParams &resumeData, QSet<TorrentID> &storedMetadata)
         : m_torrentID {torrentID}
         , m_resumeData {resumeData}
+        , m_storedMetadata {storedMetadata}
+    {
+    }
+
+    TorrentID StoreJob::torrentID() const
     {
+        return m_torrentID;
+    }
+
+    void StoreJob::setResumeData(const LoadTorrentParams &resumeData)
+    {
+        m_resumeData = resumeData;
+    }
+
+    void StoreJob::applyCounters(const ResumeDataCounters &counters)
+    {
+        counters.applyTo(m_resumeData.ltAddTorrentParams);
     }
 
     void StoreJob::perform(QSqlDatabase db)
     {
+        QBT_TRACE_SCOPE("DBResumeDataStorage::store");
+
         // We need to adjust native libtorrent resume data
         lt::add_torrent_params p = m_resumeData.ltAddTorrentParams;
         p.save_path = Profile::instance()->toPortablePath(Path(p.save_path))
@@ -841,9 +1091,22 @@ namespace
             DB_COLUMN_SSL_CERTIFICATE,
             DB_COLUMN_SSL_PRIVATE_KEY,
             DB_COLUMN_SSL_DH_PARAMS,
-            DB_COLUMN_RESUMEDATA
+            DB_COLUMN_RESUMEDATA,
+            // counters stored before are included in resume data, so they are reset
+            DB_COLUMN_RESUMEDATA_COUNTERS
         };
 
+        // Metadata never changes once it is received, so it is written only once
+        // and then the rest of resume data is stored without it.
+        const bool isMetadataStored = p.ti && m_storedMetadata.contains(m_torrentID);
+#ifdef QBT_USES_LIBTORRENT2
+        // piece layers of v2 torrents are kept in resume data, they can be generated along with metadata only
+        if (isMetadataStored && !p.ti->info_hashes().has_v2())
+#else
+        if (isMetadataStored)
+#endif
+            p.ti.reset();
+
         lt::entry data = lt::write_resume_data(p);
 
         // metadata is stored in separate column
@@ -858,19 +1121,22 @@ namespace
             metadataDict.insert(dataDict.extract("created by"));
             metadataDict.insert(dataDict.extract("comment"));
 
-            try
+            if (!isMetadataStored)
             {
-                bencodedMetadata.reserve(512 * 1024);
-                lt::bencode(std::back_inserter(bencodedMetadata), metadata);
-            }
-            catch (const std::exception &err)
-            {
-                LogMsg(ResumeDataStorage::tr("Couldn't save torrent metadata. Error: %1.")
-                        .arg(QString::fromLocal8Bit(err.what())), Log::CRITICAL);
-                return;
-            }
+                try
+                {
+                    bencodedMetadata.reserve(512 * 1024);
+                    lt::bencode(std::back_inserter(bencodedMetadata), metadata);
+                }
+                catch (const std::exception &err)
+                {
+                    LogMsg(ResumeDataStorage::tr("Couldn't save torrent metadata. Error: %1.")
+                            .arg(QString::fromLocal8Bit(err.what())), Log::CRITICAL);
+                    return;
+                }
 
-            columns.append(DB_COLUMN_METADATA);
+                columns.append(DB_COLUMN_METADATA);
+            }
         }
 
         QByteArray bencodedResumeData;
@@ -917,6 +1183,9 @@ namespace
 
             if (!query.exec())
                 throw RuntimeError(query.lastError().text());
+
+            if (!bencodedMetadata.isEmpty())
+                m_storedMetadata.insert(m_torrentID);
         }
         catch (const RuntimeError &err)
         {
@@ -925,13 +1194,16 @@ namespace
         }
     }
 
-    RemoveJob::RemoveJob(const TorrentID &torrentID)
+    RemoveJob::RemoveJob(const TorrentID &torrentID, QSet<TorrentID> &storedMetadata)
         : m_torrentID {torrentID}
+        , m_storedMetadata {storedMetadata}
     {
     }
 
     void RemoveJob::perform(QSqlDatabase db)
     {
+        m_storedMetadata.remove(m_torrentID);
+
         const auto deleteTorrentStatement = u"DELETE FROM %1 WHERE %2 = %3;"_s
                 .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
 
@@ -953,13 +1225,58 @@ namespace
         }
     }
 
+    StoreCountersJob::StoreCountersJob(const TorrentID &torrentID, const ResumeDataCounters &counters)
+        : m_torrentID {torrentID}
+        , m_counters {counters}
+    {
+    }
+
+    TorrentID StoreCountersJob::torrentID() const
+    {
+        return m_torrentID;
+    }
+
+    void StoreCountersJob::setCounters(const ResumeDataCounters &counters)
+    {
+        m_counters = counters;
+    }
+
+    void StoreCountersJob::perform(QSqlDatabase db)
+    {
+        const auto updateCountersStatement = u"UPDATE %1 SET %2 = %3 WHERE %4 = %5;"_s
+                .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_RESUMEDATA_COUNTERS.name), DB_COLUMN_RESUMEDATA_COUNTERS.placeholder
+                        , quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
+
+        QSqlQuery query {db};
+        try
+        {
+            if (!query.prepare(updateCountersStatement))
+                throw RuntimeError(query.lastError().text());
+
+            query.bindValue(DB_COLUMN_RESUMEDATA_COUNTERS.placeholder, m_counters.toBencodedData());
+            query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, m_torrentID.toString());
+
+            if (!query.exec())
+                throw RuntimeError(query.lastError().text());
+        }
+        catch (const RuntimeError &err)
+        {
+            LogMsg(ResumeDataStorage::tr("Couldn't store resume data for torrent '%1'. Error: %2")
+                    .arg(m_torrentID.toString(), err.message()), Log::CRITICAL);
+        }
+    }
+
     StoreQueueJob::StoreQueueJob(const QVector<TorrentID> &queue)
         : m_queue {queue}
     {
     }
 
+    // Only the rows whose queue position has actually changed are updated,
+    // so moving a single torrent doesn't rewrite the positions of the whole queue.
     void StoreQueueJob::perform(QSqlDatabase db)
     {
+        const auto selectQueuePosStatement = u"SELECT %1, %2 FROM %3;"_s
+                .arg(quoted(DB_COLUMN_TORRENT_ID.name), quoted(DB_COLUMN_QUEUE_POSITION.name), quoted(DB_TABLE_TORRENTS));
         const auto updateQueuePosStatement = u"UPDATE %1 SET %2 = %3 WHERE %4 = %5;"_s
                 .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name), DB_COLUMN_QUEUE_POSITION.placeholder
                         , quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
@@ -968,13 +1285,29 @@ namespace
         {
             QSqlQuery query {db};
 
+            if (!query.exec(selectQueuePosStatement))
+                throw RuntimeError(query.lastError().text());
+
+            QHash<QString, int> storedPositions;
+            while (query.next())
+                storedPositions.insert(query.value(0).toString(), query.value(1).toInt());
+
             if (!query.prepare(updateQueuePosStatement))
                 throw RuntimeError(query.lastError().text());
 
             int pos = 0;
             for (const TorrentID &torrentID : m_queue)
             {
-                query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, torrentID.toString());
+                const QString torrentIDString = torrentID.toString();
+                const auto iter = storedPositions.constFind(torrentIDString);
+                // there is nothing to update if the torrent isn't stored (yet)
+                if ((iter == storedPositions.cend()) || (iter.value() == pos))
+                {
+                    ++pos;
+                    continue;
+                }
+
+                query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, torrentIDString);
                 query.bindValue(DB_COLUMN_QUEUE_POSITION.placeholder, pos++);
                 if (!query.exec())
                     throw RuntimeError(query.lastError().text());
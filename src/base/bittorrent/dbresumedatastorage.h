@@ -51,9 +51,16 @@ namespace BitTorrent
         LoadResumeDataResult load(const TorrentID &id) const override;
 
         void store(const TorrentID &id, const LoadTorrentParams &resumeData) const override;
+        void storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const override;
+        void storeCounters(const QHash<TorrentID, ResumeDataCounters> &counters) const override;
         void remove(const TorrentID &id) const override;
+        void removeAll(const QVector<TorrentID> &ids) const override;
         void storeQueue(const QVector<TorrentID> &queue) const override;
 
+        // Queued changes are written within single transaction per batch of at most maxJobs jobs.
+        // Worker waits up to latency (in milliseconds) for more changes before it starts a batch.
+        void setBatchLimits(int maxJobs, int latency);
+
     private:
         void doLoadAll() const override;
         int currentDBVersion() const;
@@ -0,0 +1,148 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "diskiostatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QMutexLocker>
+
+using namespace BitTorrent;
+
+void DiskJobLatency::add(const qint64 time)
+{
+    const qint64 timeUs = time / 1000;
+    const auto it = std::lower_bound(BUCKET_BOUNDS.cbegin(), BUCKET_BOUNDS.cend(), timeUs);
+    ++buckets[std::distance(BUCKET_BOUNDS.cbegin(), it)];
+
+    ++count;
+    totalTime += time;
+    maxTime = std::max(maxTime, time);
+}
+
+qint64 DiskJobLatency::quantile(const double q) const
+{
+    if (count == 0)
+        return 0;
+
+    const auto rank = static_cast<qint64>(std::ceil(std::clamp(q, 0.0, 1.0) * count));
+    qint64 accumulated = 0;
+    for (std::size_t i = 0; i < BUCKET_BOUNDS.size(); ++i)
+    {
+        accumulated += buckets[i];
+        if (accumulated >= std::max<qint64>(rank, 1))
+            return std::min((BUCKET_BOUNDS[i] * 1000), maxTime);
+    }
+
+    return maxTime;
+}
+
+DiskIOStatisticsCollector *DiskIOStatisticsCollector::instance()
+{
+    static DiskIOStatisticsCollector collector;
+    return &collector;
+}
+
+void DiskIOStatisticsCollector::addStorage(const int storageIndex, const TorrentID &id)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_storages[storageIndex] = {.id = id, .stats = {}};
+}
+
+void DiskIOStatisticsCollector::removeStorage(const int storageIndex)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_storages.remove(storageIndex);
+}
+
+void DiskIOStatisticsCollector::jobStarted()
+{
+    const QMutexLocker locker {&m_mutex};
+    ++m_queueDepth;
+    m_maxQueueDepth = std::max(m_maxQueueDepth, m_queueDepth);
+}
+
+void DiskIOStatisticsCollector::jobFinished(const DiskJobType type, const Clock::time_point startTime, const Clock::time_point finishTime)
+{
+    const qint64 time = std::chrono::duration_cast<std::chrono::nanoseconds>(finishTime - startTime).count();
+
+    const QMutexLocker locker {&m_mutex};
+    m_queueDepth = std::max<qint64>((m_queueDepth - 1), 0);
+    m_latency[static_cast<int>(type)].add(time);
+}
+
+void DiskIOStatisticsCollector::addBytesRead(const int storageIndex, const qint64 bytes)
+{
+    const QMutexLocker locker {&m_mutex};
+    if (const auto it = m_storages.find(storageIndex); it != m_storages.end())
+        it->stats.bytesRead += bytes;
+}
+
+void DiskIOStatisticsCollector::addBytesWritten(const int storageIndex, const qint64 bytes)
+{
+    const QMutexLocker locker {&m_mutex};
+    if (const auto it = m_storages.find(storageIndex); it != m_storages.end())
+        it->stats.bytesWritten += bytes;
+}
+
+void DiskIOStatisticsCollector::setReadCacheStatistics(const ReadCacheStatistics &stats)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_readCache = stats;
+}
+
+DiskIOStatistics DiskIOStatisticsCollector::statistics() const
+{
+    const QMutexLocker locker {&m_mutex};
+
+    DiskIOStatistics result
+    {
+        .latency = m_latency,
+        .queueDepth = m_queueDepth,
+        .maxQueueDepth = m_maxQueueDepth,
+        .readCache = m_readCache,
+        .torrents = {}
+    };
+    result.torrents.reserve(m_storages.size());
+    for (const StorageStatistics &storage : m_storages)
+    {
+        // the same torrent may briefly have old and new storage while it is being readded
+        TorrentDiskIOStatistics &stats = result.torrents[storage.id];
+        stats.bytesRead += storage.stats.bytesRead;
+        stats.bytesWritten += storage.stats.bytesWritten;
+    }
+
+    return result;
+}
+
+ReadCacheStatistics DiskIOStatisticsCollector::readCacheStatistics() const
+{
+    const QMutexLocker locker {&m_mutex};
+    return m_readCache;
+}
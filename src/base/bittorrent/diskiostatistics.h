@@ -0,0 +1,135 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include <QHash>
+#include <QMutex>
+#include <QtTypes>
+
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    enum class DiskJobType
+    {
+        Read,
+        Write,
+        Hash,
+        Other
+    };
+
+    inline constexpr int DISK_JOB_TYPE_COUNT = 4;
+
+    // Distribution of disk job durations accumulated since the session start
+    struct DiskJobLatency
+    {
+        // upper bounds of histogram buckets in microseconds, the last bucket is unbounded
+        static constexpr std::array<qint64, 15> BUCKET_BOUNDS
+        {
+            50, 100, 250, 500, 1'000, 2'500, 5'000, 10'000, 25'000, 50'000
+            , 100'000, 250'000, 500'000, 1'000'000, 2'500'000
+        };
+
+        std::array<qint64, (BUCKET_BOUNDS.size() + 1)> buckets {};
+        qint64 count = 0;
+        qint64 totalTime = 0;  // nanoseconds
+        qint64 maxTime = 0;  // nanoseconds
+
+        void add(qint64 time);
+        // upper bound of the bucket containing given quantile in nanoseconds,
+        // maximal duration if quantile falls into unbounded bucket
+        qint64 quantile(double q) const;
+    };
+
+    struct TorrentDiskIOStatistics
+    {
+        qint64 bytesRead = 0;
+        qint64 bytesWritten = 0;
+    };
+
+    struct ReadCacheStatistics
+    {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 size = 0;  // bytes
+    };
+
+    struct DiskIOStatistics
+    {
+        std::array<DiskJobLatency, DISK_JOB_TYPE_COUNT> latency;
+        // number of jobs submitted to disk I/O backend and not completed yet
+        qint64 queueDepth = 0;
+        qint64 maxQueueDepth = 0;
+        ReadCacheStatistics readCache;
+        QHash<TorrentID, TorrentDiskIOStatistics> torrents;
+    };
+
+    // Collects statistics of custom disk I/O backend. Updated from libtorrent network thread,
+    // snapshots can be taken from any thread.
+    class DiskIOStatisticsCollector
+    {
+        Q_DISABLE_COPY_MOVE(DiskIOStatisticsCollector)
+
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        DiskIOStatisticsCollector() = default;
+
+        static DiskIOStatisticsCollector *instance();
+
+        void addStorage(int storageIndex, const TorrentID &id);
+        void removeStorage(int storageIndex);
+
+        void jobStarted();
+        void jobFinished(DiskJobType type, Clock::time_point startTime, Clock::time_point finishTime = Clock::now());
+        void addBytesRead(int storageIndex, qint64 bytes);
+        void addBytesWritten(int storageIndex, qint64 bytes);
+        void setReadCacheStatistics(const ReadCacheStatistics &stats);
+
+        DiskIOStatistics statistics() const;
+        ReadCacheStatistics readCacheStatistics() const;
+
+    private:
+        struct StorageStatistics
+        {
+            TorrentID id;
+            TorrentDiskIOStatistics stats;
+        };
+
+        mutable QMutex m_mutex;
+        std::array<DiskJobLatency, DISK_JOB_TYPE_COUNT> m_latency;
+        qint64 m_queueDepth = 0;
+        qint64 m_maxQueueDepth = 0;
+        ReadCacheStatistics m_readCache;
+        QHash<int, StorageStatistics> m_storages;
+    };
+}
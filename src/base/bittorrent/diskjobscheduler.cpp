@@ -0,0 +1,175 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "diskjobscheduler.h"
+
+#include <algorithm>
+
+using namespace BitTorrent;
+
+int DiskJobScheduler::maxActiveJobs() const
+{
+    return m_maxActiveJobs;
+}
+
+void DiskJobScheduler::setMaxActiveJobs(const int value)
+{
+    m_maxActiveJobs = std::max(0, value);
+}
+
+int DiskJobScheduler::readsPerHashJob() const
+{
+    return m_readsPerHashJob;
+}
+
+void DiskJobScheduler::setReadsPerHashJob(const int value)
+{
+    m_readsPerHashJob = std::max(1, value);
+}
+
+void DiskJobScheduler::submit(const QString &device, const int storage, const JobClass jobClass, Job job)
+{
+    DeviceQueue &queue = m_devices[device];
+    if (hasFreeSlot(queue) && queue.reads.empty() && queue.hashJobs.empty())
+    {
+        countDispatched(queue, jobClass);
+        run(queue, std::move(job));
+        return;
+    }
+
+    auto &jobs = (jobClass == JobClass::Read) ? queue.reads : queue.hashJobs;
+    jobs.push_back({.storage = storage, .job = std::move(job)});
+}
+
+bool DiskJobScheduler::jobFinished(const QString &device)
+{
+    const auto it = m_devices.find(device);
+    if (it == m_devices.end())
+        return false;
+
+    it->activeJobs = std::max(0, (it->activeJobs - 1));
+    return dispatch(it.value());
+}
+
+bool DiskJobScheduler::flushStorage(const int storage)
+{
+    bool flushed = false;
+    for (DeviceQueue &queue : m_devices)
+    {
+        for (auto *jobs : {&queue.reads, &queue.hashJobs})
+        {
+            std::deque<Entry> remaining;
+            while (!jobs->empty())
+            {
+                Entry entry = std::move(jobs->front());
+                jobs->pop_front();
+                if (entry.storage == storage)
+                {
+                    run(queue, std::move(entry.job));
+                    flushed = true;
+                }
+                else
+                {
+                    remaining.push_back(std::move(entry));
+                }
+            }
+            *jobs = std::move(remaining);
+        }
+    }
+
+    return flushed;
+}
+
+bool DiskJobScheduler::flushAll()
+{
+    bool flushed = false;
+    for (DeviceQueue &queue : m_devices)
+    {
+        for (auto *jobs : {&queue.reads, &queue.hashJobs})
+        {
+            std::deque<Entry> waiting = std::move(*jobs);
+            jobs->clear();
+            for (Entry &entry : waiting)
+            {
+                run(queue, std::move(entry.job));
+                flushed = true;
+            }
+        }
+    }
+
+    return flushed;
+}
+
+int DiskJobScheduler::activeJobs(const QString &device) const
+{
+    const auto it = m_devices.constFind(device);
+    return (it != m_devices.cend()) ? it->activeJobs : 0;
+}
+
+int DiskJobScheduler::waitingJobs(const QString &device) const
+{
+    const auto it = m_devices.constFind(device);
+    return (it != m_devices.cend()) ? static_cast<int>(it->reads.size() + it->hashJobs.size()) : 0;
+}
+
+bool DiskJobScheduler::hasFreeSlot(const DeviceQueue &queue) const
+{
+    return (m_maxActiveJobs <= 0) || (queue.activeJobs < m_maxActiveJobs);
+}
+
+bool DiskJobScheduler::dispatch(DeviceQueue &queue)
+{
+    bool dispatched = false;
+    while (hasFreeSlot(queue) && (!queue.reads.empty() || !queue.hashJobs.empty()))
+    {
+        const bool isHashJobDue = !queue.hashJobs.empty()
+            && (queue.reads.empty() || (queue.readsSinceHashJob >= m_readsPerHashJob));
+
+        std::deque<Entry> &jobs = isHashJobDue ? queue.hashJobs : queue.reads;
+        Job job = std::move(jobs.front().job);
+        jobs.pop_front();
+
+        countDispatched(queue, (isHashJobDue ? JobClass::Hash : JobClass::Read));
+        run(queue, std::move(job));
+        dispatched = true;
+    }
+
+    return dispatched;
+}
+
+void DiskJobScheduler::countDispatched(DeviceQueue &queue, const JobClass jobClass) const
+{
+    queue.readsSinceHashJob = (jobClass == JobClass::Hash)
+        ? 0 : std::min((queue.readsSinceHashJob + 1), m_readsPerHashJob);
+}
+
+void DiskJobScheduler::run(DeviceQueue &queue, Job job)
+{
+    ++queue.activeJobs;
+    job();
+}
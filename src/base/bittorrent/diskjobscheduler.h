@@ -0,0 +1,101 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+
+#include <QHash>
+#include <QString>
+
+namespace BitTorrent
+{
+    // Limits number of the jobs running concurrently on each storage device. Jobs exceeding
+    // the limit wait in per device queues, peer reads are preferred over hash jobs but every
+    // given number of reads waiting hash job is dispatched so that rechecks still progress.
+    class DiskJobScheduler
+    {
+        Q_DISABLE_COPY_MOVE(DiskJobScheduler)
+
+    public:
+        enum class JobClass
+        {
+            Read,
+            Hash
+        };
+
+        using Job = std::function<void ()>;
+
+        DiskJobScheduler() = default;
+
+        // 0 means unlimited
+        int maxActiveJobs() const;
+        void setMaxActiveJobs(int value);
+        int readsPerHashJob() const;
+        void setReadsPerHashJob(int value);
+
+        // runs the job immediately if the device has free slot, otherwise enqueues it,
+        // each job must be followed by jobFinished() call once it completes
+        void submit(const QString &device, int storage, JobClass jobClass, Job job);
+        // releases device slot and runs waiting jobs, returns whether some job was run
+        bool jobFinished(const QString &device);
+        // runs all waiting jobs of the storage regardless of the limit,
+        // used before operations which must not overtake previously submitted jobs
+        bool flushStorage(int storage);
+        bool flushAll();
+
+        int activeJobs(const QString &device) const;
+        int waitingJobs(const QString &device) const;
+
+    private:
+        struct Entry
+        {
+            int storage = -1;
+            Job job;
+        };
+
+        struct DeviceQueue
+        {
+            int activeJobs = 0;
+            int readsSinceHashJob = 0;
+            std::deque<Entry> reads;
+            std::deque<Entry> hashJobs;
+        };
+
+        bool hasFreeSlot(const DeviceQueue &queue) const;
+        bool dispatch(DeviceQueue &queue);
+        void countDispatched(DeviceQueue &queue, JobClass jobClass) const;
+        void run(DeviceQueue &queue, Job job);
+
+        int m_maxActiveJobs = 0;
+        int m_readsPerHashJob = 4;
+        // devices are never forgotten, there are only few of them
+        QHash<QString, DeviceQueue> m_devices;
+    };
+}
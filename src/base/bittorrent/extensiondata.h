@@ -28,11 +28,15 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
 
 #include <libtorrent/announce_entry.hpp>
+#include <libtorrent/socket.hpp>
 #include <libtorrent/torrent_status.hpp>
 
 #ifdef QBT_USES_LIBTORRENT2
@@ -42,9 +46,63 @@ using LTClientData = lt::client_data_t;
 using LTClientData = void *;
 #endif
 
+// Counters of a peer connection, they are kept by the torrent extension since the peer is connected
+struct PeerStats
+{
+    lt::tcp::endpoint endpoint;
+    // client name from the extension handshake, it's empty if the peer doesn't support extensions
+    std::string client;
+    std::int64_t uploadedPayload = 0;
+    std::int64_t downloadedPayload = 0;
+    int uploadPayloadRate = 0;
+    int downloadPayloadRate = 0;
+    // number of pieces the peer has, it is accurate only once the peer sent its bitfield
+    int piecesCount = 0;
+    bool isSeed = false;
+    // peer is interested in pieces we have
+    bool isInterested = false;
+    // failed pieces the peer sent data of
+    int hashFailures = 0;
+};
+
+struct PeerStatsSnapshot
+{
+    std::vector<PeerStats> peers;
+    int seedsCount = 0;
+    int interestedCount = 0;
+    std::int64_t uploadedPayload = 0;
+    std::int64_t downloadedPayload = 0;
+    int uploadPayloadRate = 0;
+    int downloadPayloadRate = 0;
+    int hashFailures = 0;
+};
+
+// Snapshot is published by the torrent extension once per tick and can be read from any thread,
+// it's immutable so the readers can keep it as long as they need to
+class PeerStatsHolder
+{
+public:
+    std::shared_ptr<const PeerStatsSnapshot> snapshot() const
+    {
+        const std::lock_guard lock {m_mutex};
+        return m_snapshot;
+    }
+
+    void publish(std::shared_ptr<const PeerStatsSnapshot> snapshot)
+    {
+        const std::lock_guard lock {m_mutex};
+        m_snapshot = std::move(snapshot);
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const PeerStatsSnapshot> m_snapshot = std::make_shared<const PeerStatsSnapshot>();
+};
+
 struct ExtensionData
 {
     lt::torrent_status status;
     std::vector<lt::announce_entry> trackers;
     std::set<std::string> urlSeeds;
+    std::shared_ptr<PeerStatsHolder> peerStats = std::make_shared<PeerStatsHolder>();
 };
@@ -0,0 +1,125 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "fakeprogressdetector.h"
+
+#include <algorithm>
+
+#include <QList>
+#include <QStringList>
+
+#include "base/algorithm.h"
+
+namespace
+{
+    // pieces the peer is still downloading aren't reported, so it is never judged
+    // before getting at least this many pieces worth of data
+    const qint64 MIN_UPLOADED_PIECES = 4;
+    // peers that are gone for so long are forgotten
+    const int FORGET_AFTER_PASSES = 600;
+}
+
+using namespace BitTorrent;
+
+FakeProgressDetector::FakeProgressDetector(const Options &options)
+    : m_options {options}
+{
+}
+
+FakeProgressDetector::Options FakeProgressDetector::options() const
+{
+    return m_options;
+}
+
+void FakeProgressDetector::setOptions(const Options &options)
+{
+    m_options = options;
+}
+
+QStringList FakeProgressDetector::analyze(const TorrentID &torrentID, const qint64 torrentSize
+        , const qint64 pieceLength, const QList<PeerSample> &peers)
+{
+    TorrentState &torrentState = m_torrents[torrentID];
+    const int pass = ++torrentState.pass;
+    const qint64 minUploaded = std::max(m_options.minUploaded, (MIN_UPLOADED_PIECES * pieceLength));
+
+    QStringList detectedIPs;
+    for (const PeerSample &peer : peers)
+    {
+        // seeds don't download anything
+        if (peer.progress >= 1)
+        {
+            torrentState.peers.remove(peer.ip);
+            continue;
+        }
+
+        const auto iter = torrentState.peers.find(peer.ip);
+        if (iter == torrentState.peers.end())
+        {
+            torrentState.peers.insert(peer.ip, {.baseProgress = peer.progress, .uploaded = 0
+                    , .lastUploaded = peer.uploaded, .lastSeenPass = pass});
+            continue;
+        }
+
+        PeerState &state = iter.value();
+        // several connections from the same IP are judged by the first one
+        if (state.lastSeenPass == pass)
+            continue;
+
+        // upload counter starts from zero with each connection
+        state.uploaded += (peer.uploaded >= state.lastUploaded) ? (peer.uploaded - state.lastUploaded) : peer.uploaded;
+        state.lastUploaded = peer.uploaded;
+        state.lastSeenPass = pass;
+        if (state.uploaded < minUploaded)
+            continue;
+
+        const qreal reportedGain = std::max<qreal>(0, (peer.progress - state.baseProgress)) * torrentSize;
+        if (reportedGain < (state.uploaded * m_options.minProgressRatio))
+        {
+            detectedIPs.append(peer.ip);
+            torrentState.peers.erase(iter);
+            continue;
+        }
+
+        // the peer passed, next time it is judged by the data uploaded since now
+        state.baseProgress = peer.progress;
+        state.uploaded = 0;
+    }
+
+    Algorithm::removeIf(torrentState.peers, [pass](const QString &, const PeerState &state)
+    {
+        return ((pass - state.lastSeenPass) > FORGET_AFTER_PASSES);
+    });
+
+    return detectedIPs;
+}
+
+void FakeProgressDetector::removeTorrent(const TorrentID &torrentID)
+{
+    m_torrents.remove(torrentID);
+}
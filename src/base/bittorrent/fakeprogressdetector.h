@@ -0,0 +1,88 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QtContainerFwd>
+#include <QHash>
+#include <QString>
+
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    // Finds peers that take upload from us without making the corresponding progress,
+    // i.e. leechers reporting stuck or fake progress. Each analysis pass gets the current peers
+    // of a torrent, data uploaded to each peer is accumulated since it was last judged,
+    // even across reconnections, and compared with the growth of its reported progress.
+    class FakeProgressDetector
+    {
+    public:
+        struct Options
+        {
+            // peer isn't judged until it gets this much data from us
+            qint64 minUploaded = 0;
+            // reported progress growth relative to the uploaded data required to pass
+            qreal minProgressRatio = 0;
+        };
+
+        struct PeerSample
+        {
+            QString ip;
+            qreal progress = 0;
+            qint64 uploaded = 0;
+        };
+
+        explicit FakeProgressDetector(const Options &options = {});
+
+        Options options() const;
+        void setOptions(const Options &options);
+
+        // returns IPs of the peers that failed the check, they are forgotten afterwards
+        QStringList analyze(const TorrentID &torrentID, qint64 torrentSize, qint64 pieceLength, const QList<PeerSample> &peers);
+        void removeTorrent(const TorrentID &torrentID);
+
+    private:
+        struct PeerState
+        {
+            qreal baseProgress = 0;
+            qint64 uploaded = 0;
+            qint64 lastUploaded = 0;
+            int lastSeenPass = 0;
+        };
+
+        struct TorrentState
+        {
+            QHash<QString, PeerState> peers;
+            int pass = 0;
+        };
+
+        Options m_options;
+        QHash<TorrentID, TorrentState> m_torrents;
+    };
+}
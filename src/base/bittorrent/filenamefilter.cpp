@@ -0,0 +1,108 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "filenamefilter.h"
+
+#include <QList>
+
+#include "base/path.h"
+
+using namespace BitTorrent;
+
+FileNameFilter::FileNameFilter(const QStringList &wildcards)
+{
+    QStringList patterns;
+    patterns.reserve(wildcards.size());
+    for (const QString &wildcard : wildcards)
+    {
+        if (!wildcard.isEmpty())
+            patterns.append(QRegularExpression::wildcardToRegularExpression(wildcard));
+    }
+
+    if (patterns.isEmpty())
+        return;
+
+    // each converted wildcard is anchored on its own, so they can be joined as alternatives
+    m_regex = QRegularExpression(patterns.join(u'|'), QRegularExpression::CaseInsensitiveOption);
+    m_regex.optimize();
+}
+
+bool FileNameFilter::isEmpty() const
+{
+    return m_regex.pattern().isEmpty();
+}
+
+bool FileNameFilter::isExcluded(const Path &filePath, FolderVerdicts &folderVerdicts) const
+{
+    if (isEmpty())
+        return false;
+
+    const QString pathStr = filePath.data();
+    const qsizetype slashIndex = pathStr.lastIndexOf(u'/');
+    if (matches(QStringView(pathStr).sliced(slashIndex + 1)))
+        return true;
+
+    return (slashIndex > 0) && isFolderExcluded(pathStr.left(slashIndex), folderVerdicts);
+}
+
+bool FileNameFilter::matches(const QStringView name) const
+{
+    return m_regex.matchView(name).hasMatch();
+}
+
+bool FileNameFilter::isFolderExcluded(const QString &folderPath, FolderVerdicts &folderVerdicts) const
+{
+    // go up until some folder having known verdict, then evaluate the unknown ones downwards
+    QList<QString> unknownFolders;
+    bool excluded = false;
+    QString folder = folderPath;
+    while (true)
+    {
+        if (const auto it = folderVerdicts.constFind(folder); it != folderVerdicts.cend())
+        {
+            excluded = it.value();
+            break;
+        }
+
+        unknownFolders.append(folder);
+        const qsizetype slashIndex = folder.lastIndexOf(u'/');
+        if (slashIndex <= 0)
+            break;
+
+        folder.truncate(slashIndex);
+    }
+
+    for (auto it = unknownFolders.crbegin(); it != unknownFolders.crend(); ++it)
+    {
+        const QString &unknownFolder = *it;
+        excluded = excluded || matches(QStringView(unknownFolder).sliced(unknownFolder.lastIndexOf(u'/') + 1));
+        folderVerdicts.insert(unknownFolder, excluded);
+    }
+
+    return excluded;
+}
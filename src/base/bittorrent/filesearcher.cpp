@@ -27,47 +27,119 @@
  */
 
 #include "filesearcher.h"
+
+#include <QtSystemDetection>
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
 #include "base/bittorrent/common.h"
-#include "base/bittorrent/infohash.h"
 
-void FileSearcher::search(const BitTorrent::TorrentID &id, const PathList &originalFileNames
-                          , const Path &savePath, const Path &downloadPath, const bool forceAppendExt)
+namespace
 {
-    const auto findInDir = [](const Path &dirPath, PathList &fileNames, const bool forceAppendExt) -> bool
+    // number of lookups in a directory after which it is listed instead of checking every file separately
+    const int DIRECTORY_LISTING_THRESHOLD = 8;
+
+    QString normalizedEntryName(const QString &name)
+    {
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+        return name.toCaseFolded();
+#else
+        return name;
+#endif
+    }
+
+    // Answers file existence queries of the whole search batch. Directories with many lookups
+    // (i.e. containing files of big torrents) are listed once and the following lookups are
+    // answered from the list of their entries, so only a few file system calls are needed
+    // even for torrents with tens of thousands of files.
+    class DirectoryIndex
     {
-        bool found = false;
-        for (Path &fileName : fileNames)
+    public:
+        bool exists(const Path &filePath)
         {
-            if ((dirPath / fileName).exists())
-            {
-                found = true;
-            }
-            else
+            Directory &directory = m_directories[filePath.parentPath()];
+            if (!directory.isListed && (++directory.lookupCount > DIRECTORY_LISTING_THRESHOLD))
+                listDirectory(filePath.parentPath(), directory);
+
+            if (directory.isListed)
+                return directory.entries.contains(normalizedEntryName(filePath.filename()));
+
+            return filePath.exists();
+        }
+
+    private:
+        struct Directory
+        {
+            int lookupCount = 0;
+            bool isListed = false;
+            QSet<QString> entries;
+        };
+
+        static void listDirectory(const Path &dirPath, Directory &directory)
+        {
+            const QStringList entries = QDir(dirPath.data()).entryList((QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot), QDir::Unsorted);
+            directory.entries.reserve(entries.size());
+            for (const QString &entry : entries)
+                directory.entries.insert(normalizedEntryName(entry));
+            directory.isListed = true;
+        }
+
+        QHash<Path, Directory> m_directories;
+    };
+
+    FileSearchResult searchFiles(const FileSearchRequest &request, const bool forceAppendExt, DirectoryIndex &directoryIndex)
+    {
+        const auto findInDir = [&directoryIndex](const Path &dirPath, PathList &fileNames, const bool forceAppendExt) -> bool
+        {
+            bool found = false;
+            for (Path &fileName : fileNames)
             {
-                const Path incompleteFilename = fileName + QB_EXT;
-                if ((dirPath / incompleteFilename).exists())
+                if (directoryIndex.exists(dirPath / fileName))
                 {
                     found = true;
-                    fileName = incompleteFilename;
                 }
-                else if (forceAppendExt)
+                else
                 {
-                    fileName = incompleteFilename;
+                    const Path incompleteFilename = fileName + QB_EXT;
+                    if (directoryIndex.exists(dirPath / incompleteFilename))
+                    {
+                        found = true;
+                        fileName = incompleteFilename;
+                    }
+                    else if (forceAppendExt)
+                    {
+                        fileName = incompleteFilename;
+                    }
                 }
             }
-        }
 
-        return found;
-    };
+            return found;
+        };
 
-    Path usedPath = savePath;
-    PathList adjustedFileNames = originalFileNames;
-    const bool found = findInDir(usedPath, adjustedFileNames, (forceAppendExt && downloadPath.isEmpty()));
-    if (!found && !downloadPath.isEmpty())
-    {
-        usedPath = downloadPath;
-        findInDir(usedPath, adjustedFileNames, forceAppendExt);
+        Path usedPath = request.savePath;
+        PathList adjustedFileNames = request.originalFileNames;
+        const bool found = findInDir(usedPath, adjustedFileNames, (forceAppendExt && request.downloadPath.isEmpty()));
+        if (!found && !request.downloadPath.isEmpty())
+        {
+            usedPath = request.downloadPath;
+            findInDir(usedPath, adjustedFileNames, forceAppendExt);
+        }
+
+        return {request.id, usedPath, adjustedFileNames};
     }
+}
+
+void FileSearcher::search(const QList<FileSearchRequest> &requests, const bool forceAppendExt)
+{
+    // directory index is shared by all the requests, so the directories are listed once per batch
+    DirectoryIndex directoryIndex;
+
+    QList<FileSearchResult> results;
+    results.reserve(requests.size());
+    for (const FileSearchRequest &request : requests)
+        results.append(searchFiles(request, forceAppendExt, directoryIndex));
 
-    emit searchFinished(id, usedPath, adjustedFileNames);
+    emit searchFinished(results);
 }
@@ -28,14 +28,26 @@
 
 #pragma once
 
+#include <QList>
 #include <QObject>
 
+#include "base/bittorrent/infohash.h"
 #include "base/path.h"
 
-namespace BitTorrent
+struct FileSearchRequest
 {
-    class TorrentID;
-}
+    BitTorrent::TorrentID id;
+    PathList originalFileNames;
+    Path savePath;
+    Path downloadPath;
+};
+
+struct FileSearchResult
+{
+    BitTorrent::TorrentID id;
+    Path savePath;
+    PathList fileNames;
+};
 
 class FileSearcher final : public QObject
 {
@@ -46,9 +58,9 @@ public:
     FileSearcher() = default;
 
 public slots:
-    void search(const BitTorrent::TorrentID &id, const PathList &originalFileNames
-                , const Path &savePath, const Path &downloadPath, bool forceAppendExt);
+    // Results of all the requests are reported at once
+    void search(const QList<FileSearchRequest> &requests, bool forceAppendExt);
 
 signals:
-    void searchFinished(const BitTorrent::TorrentID &id, const Path &savePath, const PathList &fileNames);
+    void searchFinished(const QList<FileSearchResult> &results);
 };
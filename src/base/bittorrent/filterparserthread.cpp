@@ -28,414 +28,555 @@
 
 #include "filterparserthread.h"
 
-#include <cctype>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <libtorrent/error_code.hpp>
 
+#include <QCryptographicHash>
 #include <QDataStream>
+#include <QDateTime>
 #include <QFile>
+#include <QScopeGuard>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
 
 #include "base/global.h"
 #include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/io.h"
 
 namespace
 {
-    class IPv4Parser
+    const int MAX_LOGGED_ERRORS = 5;
+    // files smaller than this are parsed by single thread
+    const qint64 MIN_CHUNK_SIZE = 256 * 1024;
+
+    enum class ParseError
     {
-    public:
-        bool tryParse(const char *str)
-        {
-            unsigned char octetIndex = 0;
+        Malformed,
+        MalformedStartIP,
+        MalformedEndIP,
+        MixedIPVersions
+    };
 
-            const char *octetStart = str;
-            char *endptr = nullptr;
-            for (; *str; ++str)
+    // IP ranges of a part of filter file, IPv4 addresses are in host byte order
+    struct ParsedRanges
+    {
+        std::vector<std::pair<quint32, quint32>> v4;
+        std::vector<std::pair<lt::address_v6::bytes_type, lt::address_v6::bytes_type>> v6;
+        int ruleCount = 0;
+        int lineCount = 0;
+        int errorCount = 0;
+        // line numbers are relative to the beginning of the part
+        std::vector<std::pair<int, ParseError>> loggedErrors;
+    };
+
+    bool isSpace(const char c)
+    {
+        return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\v') || (c == '\f');
+    }
+
+    std::string_view trimmed(std::string_view str)
+    {
+        while (!str.empty() && isSpace(str.front()))
+            str.remove_prefix(1);
+        while (!str.empty() && isSpace(str.back()))
+            str.remove_suffix(1);
+        return str;
+    }
+
+    // accepts leading zeros in octets, e.g. "001.009.096.105"
+    bool parseIPv4Address(const std::string_view str, quint32 &address)
+    {
+        quint32 result = 0;
+        int octetCount = 0;
+        std::size_t pos = 0;
+        while (octetCount < 4)
+        {
+            const std::size_t octetStart = pos;
+            quint32 octet = 0;
+            while ((pos < str.size()) && (str[pos] >= '0') && (str[pos] <= '9'))
             {
-                if (*str == '.')
-                {
-                    const long int extractedNum = strtol(octetStart, &endptr, 10);
-                    if ((extractedNum >= 0L) && (extractedNum <= 255L))
-                        m_buf[octetIndex++] = static_cast<unsigned char>(extractedNum);
-                    else
-                        return false;
-
-                    if (endptr != str)
-                        return false;
-                    if (octetIndex == 4)
-                        return true;
-
-                    octetStart = str + 1;
-                }
+                octet = (octet * 10) + (str[pos] - '0');
+                if (octet > 255)
+                    return false;
+                ++pos;
             }
+            if (pos == octetStart)
+                return false;
 
-            if (str != octetStart)
+            result = (result << 8) | octet;
+            ++octetCount;
+
+            if (octetCount < 4)
             {
-                const long int extractedNum = strtol(octetStart, &endptr, 10);
-                if ((extractedNum >= 0L) && (extractedNum <= 255L))
-                    m_buf[octetIndex] = static_cast<unsigned char>(strtol(octetStart, &endptr, 10));
-                else
+                if ((pos >= str.size()) || (str[pos] != '.'))
                     return false;
-
-                if ((endptr == str) && (octetIndex == 3))
-                    return true;
+                ++pos;
             }
+        }
 
+        if (pos != str.size())
             return false;
-        }
 
-        lt::address_v4::bytes_type parsed() const
+        address = result;
+        return true;
+    }
+
+    bool parseIPAddress(const std::string_view str, lt::address &address)
+    {
+        if (quint32 v4Address = 0; parseIPv4Address(str, v4Address))
         {
-            return m_buf;
+            address = lt::address_v4(v4Address);
+            return true;
         }
 
-    private:
-        lt::address_v4::bytes_type m_buf {};
-    };
-
-    bool parseIPAddress(const char *data, lt::address &address)
-    {
-        IPv4Parser parser;
         lt::error_code ec;
-
-        if (parser.tryParse(data))
-            address = lt::address_v4(parser.parsed());
-        else
-            address = lt::make_address(data, ec);
-
+        address = lt::make_address(std::string(str), ec);
         return !ec;
     }
 
-    const int BUFFER_SIZE = 2 * 1024 * 1024; // 2 MiB
-    const int MAX_LOGGED_ERRORS = 5;
-}
-
-FilterParserThread::FilterParserThread(QObject *parent)
-    : QThread(parent)
-{
-}
-
-FilterParserThread::~FilterParserThread()
-{
-    m_abort = true;
-    wait();
-}
-
-// Parser for eMule ip filter in DAT format
-int FilterParserThread::parseDATFilterFile()
-{
-    int ruleCount = 0;
-    QFile file {m_filePath.data()};
-    if (!file.exists()) return ruleCount;
-
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // Each line should follow this format:
+    // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
+    // The 3rd entry is access level and if above 127 the IP range isn't blocked.
+    // Returns the IP range part of the line or nothing if the line shall be ignored
+    std::optional<std::string_view> extractDATRange(const std::string_view line)
     {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
+        const std::size_t firstComma = line.find(',');
+        if (firstComma == std::string_view::npos)
+            return line;
+
+        // Check if there is an access value (apparently not mandatory)
+        std::string_view accessPart = line.substr(firstComma + 1);
+        accessPart = trimmed(accessPart.substr(0, accessPart.find(',')));
+        long int nbAccess = 0;
+        std::from_chars(accessPart.data(), (accessPart.data() + accessPart.size()), nbAccess);
+        // Ignoring this rule because access value is too high
+        if (nbAccess > 127L)
+            return std::nullopt;
+
+        return line.substr(0, firstComma);
     }
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QVector
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
+    // Each line should follow this format:
+    // Some organization:1.0.0.0-1.255.255.255
+    // The "Some organization" part might contain a ':' char itself so we find the last occurrence
+    std::optional<std::string_view> extractP2PRange(const std::string_view line)
     {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
-    };
+        const std::size_t partsDelimiter = line.rfind(':');
+        if (partsDelimiter == std::string_view::npos)
+            return std::string_view();
 
-    while (true)
-    {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
+        return line.substr(partsDelimiter + 1);
+    }
 
-        for (start = 0; start < dataSize; ++start)
+    template <typename RangeExtractor>
+    ParsedRanges parseTextRanges(const std::string_view data, RangeExtractor &&extractRange, const bool &abort)
+    {
+        ParsedRanges ranges;
+        const auto addError = [&ranges](const ParseError error)
         {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0)))
-            {
-                for (int i = start; i < dataSize; ++i)
-                {
-                    if (buffer[i] == '\n')
-                    {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
-            }
-
-            if (endOfLine == -1)
-            {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
-                break;
-            }
+            ++ranges.errorCount;
+            if (ranges.errorCount <= MAX_LOGGED_ERRORS)
+                ranges.loggedErrors.emplace_back(ranges.lineCount, error);
+        };
 
-            ++nbLine;
-
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/'))))
-                {
-                start = endOfLine;
+        std::size_t lineStart = 0;
+        while ((lineStart < data.size()) && !abort)
+        {
+            std::size_t lineEnd = data.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos)
+                lineEnd = data.size();
+            const std::string_view line = data.substr(lineStart, (lineEnd - lineStart));
+            lineStart = lineEnd + 1;
+            ++ranges.lineCount;
+
+            if (line.starts_with('#') || line.starts_with("//") || trimmed(line).empty())
                 continue;
-            }
-
-            // Each line should follow this format:
-            // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
-            // The 3rd entry is access level and if above 127 the IP range isn't blocked.
-            const int firstComma = findAndNullDelimiter(buffer.data(), ',', start, endOfLine);
-            if (firstComma != -1)
-                findAndNullDelimiter(buffer.data(), ',', firstComma + 1, endOfLine);
 
-            // Check if there is an access value (apparently not mandatory)
-            if (firstComma != -1)
-            {
-                // There is possibly one
-                const long int nbAccess = strtol(buffer.data() + firstComma + 1, nullptr, 10);
-                // Ignoring this rule because access value is too high
-                if (nbAccess > 127L)
-                {
-                    start = endOfLine;
-                    continue;
-                }
-            }
+            const std::optional<std::string_view> range = extractRange(line);
+            if (!range)
+                continue;
 
             // IP Range should be split by a dash
-            const int endOfIPRange = ((firstComma == -1) ? (endOfLine - 1) : (firstComma - 1));
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', start, endOfIPRange);
-            if (delimIP == -1)
+            const std::size_t delimIP = range->find('-');
+            if (delimIP == std::string_view::npos)
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
+                addError(ParseError::Malformed);
                 continue;
             }
 
             lt::address startAddr;
-            int newStart = trim(buffer.data(), start, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr))
+            if (!parseIPAddress(trimmed(range->substr(0, delimIP)), startAddr))
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
+                addError(ParseError::MalformedStartIP);
                 continue;
             }
 
             lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfIPRange);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr))
+            if (!parseIPAddress(trimmed(range->substr(delimIP + 1)), endAddr))
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
+                addError(ParseError::MalformedEndIP);
                 continue;
             }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6()))
-                {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
+            if (startAddr.is_v4() != endAddr.is_v4())
+            {
+                addError(ParseError::MixedIPVersions);
                 continue;
             }
 
-            start = endOfLine;
+            if (startAddr.is_v4())
+                ranges.v4.emplace_back(startAddr.to_v4().to_uint(), endAddr.to_v4().to_uint());
+            else
+                ranges.v6.emplace_back(startAddr.to_v6().to_bytes(), endAddr.to_v6().to_bytes());
+            ++ranges.ruleCount;
+        }
 
-            // Now Add to the filter
-            try
-            {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &e)
+        return ranges;
+    }
+
+    // Splits data into parts of whole lines and parses them simultaneously
+    template <typename RangeExtractor>
+    std::vector<ParsedRanges> parseTextRangesInParallel(const std::string_view data, RangeExtractor extractRange, const bool &abort)
+    {
+        const qint64 chunkCount = std::clamp<qint64>((static_cast<qint64>(data.size()) / MIN_CHUNK_SIZE), 1, QThread::idealThreadCount());
+
+        std::vector<std::string_view> chunks;
+        chunks.reserve(chunkCount);
+        std::size_t chunkStart = 0;
+        for (qint64 i = 1; (i <= chunkCount) && (chunkStart < data.size()); ++i)
+        {
+            std::size_t chunkEnd = data.size();
+            if (i < chunkCount)
             {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
+                chunkEnd = data.find('\n', std::max(chunkStart, static_cast<std::size_t>(data.size() * i / chunkCount)));
+                chunkEnd = (chunkEnd == std::string_view::npos) ? data.size() : (chunkEnd + 1);
             }
+            chunks.push_back(data.substr(chunkStart, (chunkEnd - chunkStart)));
+            chunkStart = chunkEnd;
         }
 
-        if (start >= dataSize)
-            offset = 0;
-    }
+        std::vector<ParsedRanges> results(chunks.size());
+        if (chunks.size() == 1)
+        {
+            results[0] = parseTextRanges(chunks[0], extractRange, abort);
+            return results;
+        }
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
-        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
-}
+        QSemaphore parsedCount;
+        for (std::size_t i = 0; i < chunks.size(); ++i)
+        {
+            QThreadPool::globalInstance()->start([&results, &chunks, &extractRange, &abort, &parsedCount, i]
+            {
+                results[i] = parseTextRanges(chunks[i], extractRange, abort);
+                parsedCount.release();
+            });
+        }
+        parsedCount.acquire(static_cast<int>(chunks.size()));
 
-// Parser for PeerGuardian ip filter in p2p format
-int FilterParserThread::parseP2PFilterFile()
-{
-    int ruleCount = 0;
-    QFile file {m_filePath.data()};
-    if (!file.exists()) return ruleCount;
+        return results;
+    }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    lt::address_v6::bytes_type nextAddress(lt::address_v6::bytes_type address)
     {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
+        for (auto it = address.rbegin(); it != address.rend(); ++it)
+        {
+            if (++(*it) != 0)
+                break;
+        }
+        return address;
     }
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QVector
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
+    // Sorts ranges and merges the overlapping and adjacent ones
+    template <typename T, typename NextFunc>
+    void mergeRanges(std::vector<std::pair<T, T>> &ranges, NextFunc &&next, const T &maxValue)
     {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
-    };
+        if (ranges.empty())
+            return;
 
-    while (true)
-    {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
+        for (auto &[first, last] : ranges)
+        {
+            if (last < first)
+                std::swap(first, last);
+        }
+        std::sort(ranges.begin(), ranges.end());
 
-        for (start = 0; start < dataSize; ++start)
+        std::size_t mergedCount = 0;
+        for (std::size_t i = 1; i < ranges.size(); ++i)
         {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0)))
+            std::pair<T, T> &merged = ranges[mergedCount];
+            const std::pair<T, T> &range = ranges[i];
+            if ((merged.second == maxValue) || (range.first <= next(merged.second)))
             {
-                for (int i = start; i < dataSize; ++i)
-                {
-                    if (buffer[i] == '\n')
-                    {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
-                }
+                merged.second = std::max(merged.second, range.second);
             }
             else
             {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
+                ranges[++mergedCount] = range;
             }
+        }
+        ranges.resize(mergedCount + 1);
+    }
 
-            if (endOfLine == -1)
-            {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
-                break;
-            }
+    // lt::ip_filter merges each new rule with the existing ones, so the ranges are
+    // merged beforehand and added in order to make every insertion a simple append
+    void applyRanges(lt::ip_filter &filter, ParsedRanges &ranges)
+    {
+        mergeRanges(ranges.v4, [](const quint32 address) { return address + 1; }, std::numeric_limits<quint32>::max());
+        lt::address_v6::bytes_type maxV6Address;
+        maxV6Address.fill(0xFF);
+        mergeRanges(ranges.v6, nextAddress, maxV6Address);
+
+        for (const auto &[first, last] : ranges.v4)
+            filter.add_rule(lt::address_v4(first), lt::address_v4(last), lt::ip_filter::blocked);
+        for (const auto &[first, last] : ranges.v6)
+            filter.add_rule(lt::address_v6(first), lt::address_v6(last), lt::ip_filter::blocked);
+    }
 
-            ++nbLine;
+    // Compiled filter is stored along with identity of its source file,
+    // so the same filter file doesn't have to be parsed again.
+    // Header is followed by blocked IPv4 ranges as pairs of quint32 (host byte order)
+    // and then by blocked IPv6 ranges as pairs of 16 byte addresses.
+    struct FilterCacheHeader
+    {
+        char magic[8];
+        quint32 version;
+        qint32 ruleCount;
+        qint64 sourceSize;
+        qint64 sourceModificationTime;
+        char sourceHash[32];
+        quint32 v4RangeCount;
+        quint32 v6RangeCount;
+    };
+    static_assert(sizeof(FilterCacheHeader) == 72);
 
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/'))))
-                {
-                start = endOfLine;
-                continue;
-            }
+    const QString FILTER_CACHE_FILENAME = u"ipfilter.cache"_s;
+    const char FILTER_CACHE_MAGIC[8] = {'q', 'B', 'I', 'P', 'F', 'L', 'T', '\0'};
+    // cache is stored in native byte order, so version doesn't match on the other architecture
+    const quint32 FILTER_CACHE_VERSION = 1;
 
-            // Each line should follow this format:
-            // Some organization:1.0.0.0-1.255.255.255
-            // The "Some organization" part might contain a ':' char itself so we find the last occurrence
-            const int partsDelimiter = findAndNullDelimiter(buffer.data(), ':', start, endOfLine, true);
-            if (partsDelimiter == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+    struct FilterSourceInfo
+    {
+        qint64 size = 0;
+        qint64 modificationTime = 0;
+        QByteArray hash;
+    };
 
-            // IP Range should be split by a dash
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', partsDelimiter + 1, endOfLine);
-            if (delimIP == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+    std::optional<FilterSourceInfo> readFilterSourceInfo(const Path &path)
+    {
+        QFile file {path.data()};
+        if (!file.open(QIODevice::ReadOnly))
+            return std::nullopt;
 
-            lt::address startAddr;
-            int newStart = trim(buffer.data(), partsDelimiter + 1, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        QCryptographicHash hash {QCryptographicHash::Sha256};
+        if (!hash.addData(&file))
+            return std::nullopt;
 
-            lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfLine);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
+        return FilterSourceInfo
+        {
+            .size = file.size(),
+            .modificationTime = file.fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch(),
+            .hash = hash.result()
+        };
+    }
+
+    // returns rule count of the cached filter if it is valid for the given source file
+    std::optional<int> loadFilterCache(const Path &cachePath, const FilterSourceInfo &sourceInfo, lt::ip_filter &filter)
+    {
+        QFile file {cachePath.data()};
+        if (!file.open(QIODevice::ReadOnly) || (file.size() < static_cast<qint64>(sizeof(FilterCacheHeader))))
+            return std::nullopt;
+
+        const uchar *data = file.map(0, file.size());
+        if (!data)
+            return std::nullopt;
+
+        FilterCacheHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if ((std::memcmp(header.magic, FILTER_CACHE_MAGIC, sizeof(header.magic)) != 0)
+                || (header.version != FILTER_CACHE_VERSION)
+                || (header.sourceSize != sourceInfo.size)
+                || (header.sourceModificationTime != sourceInfo.modificationTime)
+                || (QByteArray::fromRawData(header.sourceHash, sizeof(header.sourceHash)) != sourceInfo.hash))
+        {
+            return std::nullopt;
+        }
+
+        using V4Range = std::array<quint32, 2>;
+        using V6Range = std::array<lt::address_v6::bytes_type, 2>;
+        const qint64 expectedSize = static_cast<qint64>(sizeof(header))
+                + (static_cast<qint64>(header.v4RangeCount) * static_cast<qint64>(sizeof(V4Range)))
+                + (static_cast<qint64>(header.v6RangeCount) * static_cast<qint64>(sizeof(V6Range)));
+        if (file.size() != expectedSize)
+            return std::nullopt;
+
+        const uchar *rangesData = data + sizeof(header);
+        for (quint32 i = 0; i < header.v4RangeCount; ++i)
+        {
+            V4Range range;
+            std::memcpy(range.data(), rangesData, sizeof(range));
+            rangesData += sizeof(range);
+            filter.add_rule(lt::address_v4(range[0]), lt::address_v4(range[1]), lt::ip_filter::blocked);
+        }
+        for (quint32 i = 0; i < header.v6RangeCount; ++i)
+        {
+            V6Range range;
+            std::memcpy(range.data(), rangesData, sizeof(range));
+            rangesData += sizeof(range);
+            filter.add_rule(lt::address_v6(range[0]), lt::address_v6(range[1]), lt::ip_filter::blocked);
+        }
+
+        return header.ruleCount;
+    }
+
+    nonstd::expected<void, QString> saveFilterCache(const Path &cachePath, const FilterSourceInfo &sourceInfo
+            , const int ruleCount, const lt::ip_filter &filter)
+    {
+        const auto [v4Ranges, v6Ranges] = filter.export_filter();
+        const auto isBlocked = [](const auto &range) { return range.flags == lt::ip_filter::blocked; };
+
+        FilterCacheHeader header {};
+        std::memcpy(header.magic, FILTER_CACHE_MAGIC, sizeof(header.magic));
+        header.version = FILTER_CACHE_VERSION;
+        header.ruleCount = ruleCount;
+        header.sourceSize = sourceInfo.size;
+        header.sourceModificationTime = sourceInfo.modificationTime;
+        std::memcpy(header.sourceHash, sourceInfo.hash.constData(), std::min<std::size_t>(sourceInfo.hash.size(), sizeof(header.sourceHash)));
+        header.v4RangeCount = static_cast<quint32>(std::count_if(v4Ranges.cbegin(), v4Ranges.cend(), isBlocked));
+        header.v6RangeCount = static_cast<quint32>(std::count_if(v6Ranges.cbegin(), v6Ranges.cend(), isBlocked));
+
+        QByteArray data;
+        data.reserve(sizeof(header) + (header.v4RangeCount * 2 * sizeof(quint32))
+                + (header.v6RangeCount * 2 * sizeof(lt::address_v6::bytes_type)));
+        data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (const auto &range : v4Ranges)
+        {
+            if (!isBlocked(range))
                 continue;
-            }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6()))
-                {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
+            const std::array<quint32, 2> values {range.first.to_uint(), range.last.to_uint()};
+            data.append(reinterpret_cast<const char *>(values.data()), sizeof(values));
+        }
+        for (const auto &range : v6Ranges)
+        {
+            if (!isBlocked(range))
                 continue;
-            }
 
-            start = endOfLine;
+            const std::array<lt::address_v6::bytes_type, 2> values {range.first.to_bytes(), range.last.to_bytes()};
+            data.append(reinterpret_cast<const char *>(values.data()), sizeof(values));
+        }
 
-            try
-            {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &e)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
-            }
+        return Utils::IO::saveToFile(cachePath, data);
+    }
+}
+
+FilterParserThread::FilterParserThread(QObject *parent)
+    : QThread(parent)
+{
+}
+
+FilterParserThread::~FilterParserThread()
+{
+    m_abort = true;
+    wait();
+}
+
+// Parser for eMule ip filter in DAT format and PeerGuardian ip filter in p2p format
+int FilterParserThread::parseTextFilterFile(const TextFilterFormat format)
+{
+    QFile file {m_filePath.data()};
+    if (!file.exists()) return 0;
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
+        return 0;
+    }
+
+    const qint64 fileSize = file.size();
+    if (fileSize <= 0)
+        return 0;
+
+    // the file is mapped into memory, so its data isn't copied
+    QByteArray fileData;
+    std::string_view data;
+    if (const uchar *mappedData = file.map(0, fileSize))
+    {
+        data = {reinterpret_cast<const char *>(mappedData), static_cast<std::size_t>(fileSize)};
+    }
+    else
+    {
+        fileData = file.readAll();
+        data = {fileData.constData(), static_cast<std::size_t>(fileData.size())};
+    }
+
+    std::vector<ParsedRanges> results = (format == TextFilterFormat::DAT)
+            ? parseTextRangesInParallel(data, extractDATRange, m_abort)
+            : parseTextRangesInParallel(data, extractP2PRange, m_abort);
+    if (m_abort)
+        return 0;
+
+    ParsedRanges ranges;
+    int lineOffset = 0;
+    for (ParsedRanges &result : results)
+    {
+        for (const auto &[line, error] : result.loggedErrors)
+        {
+            if (std::ssize(ranges.loggedErrors) < MAX_LOGGED_ERRORS)
+                ranges.loggedErrors.emplace_back((lineOffset + line), error);
         }
+        lineOffset += result.lineCount;
 
-        if (start >= dataSize)
-            offset = 0;
+        ranges.ruleCount += result.ruleCount;
+        ranges.errorCount += result.errorCount;
+        ranges.v4.insert(ranges.v4.end(), result.v4.cbegin(), result.v4.cend());
+        ranges.v6.insert(ranges.v6.end(), result.v6.cbegin(), result.v6.cend());
+        result = {};
     }
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
+    for (const auto &[line, error] : ranges.loggedErrors)
+    {
+        switch (error)
+        {
+        case ParseError::Malformed:
+            LogMsg(tr("IP filter line %1 is malformed.").arg(line), Log::CRITICAL);
+            break;
+        case ParseError::MalformedStartIP:
+            LogMsg(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(line), Log::CRITICAL);
+            break;
+        case ParseError::MalformedEndIP:
+            LogMsg(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(line), Log::CRITICAL);
+            break;
+        case ParseError::MixedIPVersions:
+            LogMsg(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(line), Log::CRITICAL);
+            break;
+        }
+    }
+    if (ranges.errorCount > MAX_LOGGED_ERRORS)
         LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
+               .arg(ranges.errorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
+
+    try
+    {
+        applyRanges(m_filter, ranges);
+    }
+    catch (const std::exception &e)
+    {
+        LogMsg(tr("IP filter exception thrown. Exception is: %1").arg(QString::fromLocal8Bit(e.what())), Log::CRITICAL);
+        return 0;
+    }
+
+    return ranges.ruleCount;
 }
 
 int FilterParserThread::getlineInStream(QDataStream &stream, std::string &name, const char delim)
@@ -478,6 +619,17 @@ int FilterParserThread::parseP2BFilterFile()
         return ruleCount;
     }
 
+    // the ranges read until an error occurs are still applied
+    ParsedRanges ranges;
+    [[maybe_unused]] const auto applyRangesGuard = qScopeGuard([this, &ranges]
+    {
+        try
+        {
+            applyRanges(m_filter, ranges);
+        }
+        catch (const std::exception &) {}
+    });
+
     QDataStream stream(&file);
     // Read header
     char buf[7];
@@ -506,17 +658,8 @@ int FilterParserThread::parseP2BFilterFile()
             }
 
             // Network byte order to Host byte order
-            // asio address_v4 constructor expects it
-            // that way
-            const lt::address_v4 first(ntohl(start));
-            const lt::address_v4 last(ntohl(end));
-            // Apply to bittorrent session
-            try
-            {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &) {}
+            ranges.v4.emplace_back(ntohl(start), ntohl(end));
+            ++ruleCount;
         }
     }
     else if (version == 3)
@@ -564,17 +707,8 @@ int FilterParserThread::parseP2BFilterFile()
             }
 
             // Network byte order to Host byte order
-            // asio address_v4 constructor expects it
-            // that way
-            const lt::address_v4 first(ntohl(start));
-            const lt::address_v4 last(ntohl(end));
-            // Apply to bittorrent session
-            try
-            {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &) {}
+            ranges.v4.emplace_back(ntohl(start), ntohl(end));
+            ++ruleCount;
 
             if (m_abort) return ruleCount;
         }
@@ -592,7 +726,8 @@ int FilterParserThread::parseP2BFilterFile()
 //  * eMule IP list (DAT): http://wiki.phoenixlabs.org/wiki/DAT_Format
 //  * PeerGuardian Text (P2P): http://wiki.phoenixlabs.org/wiki/P2P_Format
 //  * PeerGuardian Binary (P2B): http://wiki.phoenixlabs.org/wiki/P2B_Format
-void FilterParserThread::processFilterFile(const Path &filePath)
+// Compiled filter is cached in cachePath, default location is used if it isn't provided
+void FilterParserThread::processFilterFile(const Path &filePath, const Path &cachePath)
 {
     if (isRunning())
     {
@@ -603,6 +738,7 @@ void FilterParserThread::processFilterFile(const Path &filePath)
 
     m_abort = false;
     m_filePath = filePath;
+    m_cachePath = cachePath.isEmpty() ? (specialFolderLocation(SpecialFolder::Data) / Path(FILTER_CACHE_FILENAME)) : cachePath;
     m_filter = lt::ip_filter();
     // Run it
     start();
@@ -616,90 +752,64 @@ lt::ip_filter FilterParserThread::IPfilter()
 void FilterParserThread::run()
 {
     qDebug("Processing filter file");
-    int ruleCount = 0;
-    if (m_filePath.hasExtension(u".p2p"_s))
-    {
-        // PeerGuardian p2p file
-        ruleCount = parseP2PFilterFile();
-    }
-    else if (m_filePath.hasExtension(u".p2b"_s))
-    {
-        // PeerGuardian p2b file
-        ruleCount = parseP2BFilterFile();
-    }
-    else if (m_filePath.hasExtension(u".dat"_s))
-    {
-        // eMule DAT format
-        ruleCount = parseDATFilterFile();
-    }
 
-    if (m_abort) return;
+    const Path cachePath = m_cachePath;
+    const std::optional<FilterSourceInfo> sourceInfo = readFilterSourceInfo(m_filePath);
 
-    try
-    {
-        emit IPFilterParsed(ruleCount);
-    }
-    catch (const std::exception &)
+    std::optional<int> cachedRuleCount;
+    if (sourceInfo)
     {
-        emit IPFilterError();
+        try
+        {
+            cachedRuleCount = loadFilterCache(cachePath, *sourceInfo, m_filter);
+        }
+        catch (const std::exception &)
+        {
+            m_filter = lt::ip_filter();
+        }
     }
 
-    qDebug("IP Filter thread: finished parsing, filter applied");
-}
-
-int FilterParserThread::findAndNullDelimiter(char *const data, const char delimiter, const int start, const int end, const bool reverse)
-{
-    if (!reverse)
+    int ruleCount = 0;
+    if (cachedRuleCount)
     {
-        for (int i = start; i <= end; ++i)
-        {
-            if (data[i] == delimiter)
-            {
-                data[i] = '\0';
-                return i;
-            }
-        }
+        qDebug("IP Filter thread: filter is loaded from cache");
+        ruleCount = *cachedRuleCount;
     }
     else
     {
-        for (int i = end; i >= start; --i)
+        if (m_filePath.hasExtension(u".p2p"_s))
         {
-            if (data[i] == delimiter)
-            {
-                data[i] = '\0';
-                return i;
-            }
+            // PeerGuardian p2p file
+            ruleCount = parseTextFilterFile(TextFilterFormat::P2P);
         }
-    }
-
-    return -1;
-}
-
-int FilterParserThread::trim(char *const data, const int start, const int end)
-{
-    if (start >= end) return start;
-    int newStart = start;
-
-    for (int i = start; i <= end; ++i)
-    {
-        if (isspace(data[i]) != 0)
+        else if (m_filePath.hasExtension(u".p2b"_s))
         {
-            data[i] = '\0';
+            // PeerGuardian p2b file
+            ruleCount = parseP2BFilterFile();
         }
-        else
+        else if (m_filePath.hasExtension(u".dat"_s))
         {
-            newStart = i;
-            break;
+            // eMule DAT format
+            ruleCount = parseTextFilterFile(TextFilterFormat::DAT);
+        }
+
+        if (m_abort) return;
+
+        if (sourceInfo && (ruleCount > 0))
+        {
+            if (const nonstd::expected<void, QString> result = saveFilterCache(cachePath, *sourceInfo, ruleCount, m_filter); !result)
+                LogMsg(tr("Couldn't save IP filter cache. Error: %1").arg(result.error()), Log::WARNING);
         }
     }
 
-    for (int i = end; i >= start; --i)
+    try
     {
-        if (isspace(data[i]) != 0)
-            data[i] = '\0';
-        else
-            break;
+        emit IPFilterParsed(ruleCount);
+    }
+    catch (const std::exception &)
+    {
+        emit IPFilterError();
     }
 
-    return newStart;
+    qDebug("IP Filter thread: finished parsing, filter applied");
 }
@@ -44,7 +44,7 @@ class FilterParserThread final : public QThread
 public:
     FilterParserThread(QObject *parent = nullptr);
     ~FilterParserThread();
-    void processFilterFile(const Path &filePath);
+    void processFilterFile(const Path &filePath, const Path &cachePath = {});
     lt::ip_filter IPfilter();
 
 signals:
@@ -55,14 +55,18 @@ protected:
     void run() override;
 
 private:
-    int findAndNullDelimiter(char *data, char delimiter, int start, int end, bool reverse = false);
-    int trim(char *data, int start, int end);
-    int parseDATFilterFile();
-    int parseP2PFilterFile();
+    enum class TextFilterFormat
+    {
+        DAT,
+        P2P
+    };
+
+    int parseTextFilterFile(TextFilterFormat format);
     int getlineInStream(QDataStream &stream, std::string &name, char delim);
     int parseP2BFilterFile();
 
     bool m_abort = false;
     Path m_filePath;
+    Path m_cachePath;
     lt::ip_filter m_filter;
 };
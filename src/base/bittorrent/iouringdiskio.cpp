@@ -0,0 +1,529 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "iouringdiskio.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <boost/asio/post.hpp>
+#include <libtorrent/download_priority.hpp>
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "base/global.h"
+#include "base/logger.h"
+
+namespace
+{
+    const unsigned int QUEUE_DEPTH = 256;
+    // peers request 16 KiB blocks
+    const int BUFFER_SIZE = 16 * 1024;
+    const int BUFFER_COUNT = 256;
+    // offsets and sizes of O_DIRECT reads have to be multiples of logical block size
+    const qint64 DIRECT_IO_ALIGNMENT = 4096;
+    const qsizetype MAX_OPEN_FILES = 512;
+
+    bool isAligned(const qint64 value)
+    {
+        return (value % DIRECT_IO_ALIGNMENT) == 0;
+    }
+
+    qint64 fileID(const lt::storage_index_t storage, const lt::file_index_t fileIndex)
+    {
+        return (static_cast<qint64>(static_cast<std::uint32_t>(storage)) << 32)
+            | static_cast<std::uint32_t>(static_cast<int>(fileIndex));
+    }
+
+    int storageOfFileID(const qint64 id)
+    {
+        return static_cast<int>(id >> 32);
+    }
+}
+
+IOUringDiskIO::IOUringDiskIO(lt::io_context &ioContext, const lt::settings_interface &settings
+        , std::unique_ptr<lt::disk_interface> nativeDiskIO)
+    : m_ioContext {ioContext}
+    , m_settings {settings}
+    , m_nativeDiskIO {std::move(nativeDiskIO)}
+{
+    if (const int ret = io_uring_queue_init(QUEUE_DEPTH, &m_ring, 0); ret < 0)
+    {
+        LogMsg(tr("Failed to initialize io_uring, POSIX disk I/O is used instead. Error: \"%1\"")
+            .arg(QString::fromLocal8Bit(std::strerror(-ret))), Log::WARNING);
+        return;
+    }
+    m_isRingInitialized = true;
+
+    m_buffers = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, (BUFFER_COUNT * BUFFER_SIZE)));
+    if (!m_buffers)
+    {
+        io_uring_queue_exit(&m_ring);
+        m_isRingInitialized = false;
+        return;
+    }
+
+    std::vector<iovec> iovecs;
+    iovecs.reserve(BUFFER_COUNT);
+    m_freeBuffers.reserve(BUFFER_COUNT);
+    for (int i = 0; i < BUFFER_COUNT; ++i)
+    {
+        iovecs.push_back({.iov_base = bufferAt(i), .iov_len = BUFFER_SIZE});
+        m_freeBuffers.push_back(BUFFER_COUNT - 1 - i);
+    }
+    // registration may fail because of locked memory limit, the reads just cost more then
+    m_hasRegisteredBuffers = (io_uring_register_buffers(&m_ring, iovecs.data(), iovecs.size()) == 0);
+
+    m_reaperThread.reset(QThread::create([this] { reapCompletions(); }));
+    m_reaperThread->setObjectName(u"IOUringDiskIO reaper"_s);
+    m_reaperThread->start();
+}
+
+IOUringDiskIO::~IOUringDiskIO()
+{
+    stopReaper();
+    closeAllFiles();
+
+    if (m_isRingInitialized)
+        io_uring_queue_exit(&m_ring);
+    std::free(m_buffers);
+}
+
+lt::storage_holder IOUringDiskIO::new_torrent(const lt::storage_params &storageParams, const std::shared_ptr<void> &torrent)
+{
+    lt::storage_holder storageHolder = m_nativeDiskIO->new_torrent(storageParams, torrent);
+
+    m_storageData[storageHolder] =
+    {
+        .savePath = Path(storageParams.path),
+        .files = storageParams.mapped_files ? *storageParams.mapped_files : storageParams.files,
+        .filePriorities = storageParams.priorities
+    };
+
+    return storageHolder;
+}
+
+void IOUringDiskIO::remove_torrent(const lt::storage_index_t storage)
+{
+    closeFiles(storage);
+    m_storageData.remove(storage);
+    m_nativeDiskIO->remove_torrent(storage);
+}
+
+void IOUringDiskIO::async_read(const lt::storage_index_t storage, const lt::peer_request &peerRequest
+        , std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> handler
+        , const lt::disk_job_flags_t flags)
+{
+    if (!submitRead(storage, peerRequest, handler, flags))
+        m_nativeDiskIO->async_read(storage, peerRequest, std::move(handler), flags);
+}
+
+bool IOUringDiskIO::async_write(const lt::storage_index_t storage, const lt::peer_request &peerRequest
+        , const char *buf, std::shared_ptr<lt::disk_observer> diskObserver
+        , std::function<void (const lt::storage_error &)> handler, const lt::disk_job_flags_t flags)
+{
+    return m_nativeDiskIO->async_write(storage, peerRequest, buf, std::move(diskObserver), std::move(handler), flags);
+}
+
+void IOUringDiskIO::async_hash(const lt::storage_index_t storage, const lt::piece_index_t piece
+        , const lt::span<lt::sha256_hash> hash, const lt::disk_job_flags_t flags
+        , std::function<void (lt::piece_index_t, const lt::sha1_hash &, const lt::storage_error &)> handler)
+{
+    m_nativeDiskIO->async_hash(storage, piece, hash, flags, std::move(handler));
+}
+
+void IOUringDiskIO::async_hash2(const lt::storage_index_t storage, const lt::piece_index_t piece
+        , const int offset, const lt::disk_job_flags_t flags
+        , std::function<void (lt::piece_index_t, const lt::sha256_hash &, const lt::storage_error &)> handler)
+{
+    m_nativeDiskIO->async_hash2(storage, piece, offset, flags, std::move(handler));
+}
+
+void IOUringDiskIO::async_move_storage(const lt::storage_index_t storage, std::string path, const lt::move_flags_t flags
+        , std::function<void (lt::status_t, const std::string &, const lt::storage_error &)> handler)
+{
+    closeFiles(storage);
+
+    const Path newSavePath {path};
+    m_nativeDiskIO->async_move_storage(storage, path, flags
+            , [=, this, handler = std::move(handler)](const lt::status_t status, const std::string &path, const lt::storage_error &error)
+    {
+#if LIBTORRENT_VERSION_NUM < 20100
+        if ((status != lt::status_t::fatal_disk_error) && (status != lt::status_t::file_exist))
+#else
+        if ((status != lt::disk_status::fatal_disk_error) && (status != lt::disk_status::file_exist))
+#endif
+        {
+            closeFiles(storage);
+            if (const auto it = m_storageData.find(storage); it != m_storageData.end())
+                it->savePath = newSavePath;
+        }
+
+        handler(status, path, error);
+    });
+}
+
+void IOUringDiskIO::async_release_files(const lt::storage_index_t storage, std::function<void ()> handler)
+{
+    closeFiles(storage);
+    m_nativeDiskIO->async_release_files(storage, std::move(handler));
+}
+
+void IOUringDiskIO::async_check_files(const lt::storage_index_t storage, const lt::add_torrent_params *resume_data
+        , lt::aux::vector<std::string, lt::file_index_t> links
+        , std::function<void (lt::status_t, const lt::storage_error &)> handler)
+{
+    closeFiles(storage);
+    m_nativeDiskIO->async_check_files(storage, resume_data, std::move(links), std::move(handler));
+}
+
+void IOUringDiskIO::async_stop_torrent(const lt::storage_index_t storage, std::function<void ()> handler)
+{
+    closeFiles(storage);
+    m_nativeDiskIO->async_stop_torrent(storage, std::move(handler));
+}
+
+void IOUringDiskIO::async_rename_file(const lt::storage_index_t storage, const lt::file_index_t index, std::string name
+        , std::function<void (const std::string &, lt::file_index_t, const lt::storage_error &)> handler)
+{
+    closeFiles(storage);
+    m_nativeDiskIO->async_rename_file(storage, index, name
+            , [=, this, handler = std::move(handler)](const std::string &name, const lt::file_index_t index, const lt::storage_error &error)
+    {
+        if (!error)
+        {
+            if (const auto it = m_storageData.find(storage); it != m_storageData.end())
+                it->files.rename_file(index, name);
+        }
+        handler(name, index, error);
+    });
+}
+
+void IOUringDiskIO::async_delete_files(const lt::storage_index_t storage, const lt::remove_flags_t options
+        , std::function<void (const lt::storage_error &)> handler)
+{
+    closeFiles(storage);
+    m_nativeDiskIO->async_delete_files(storage, options, std::move(handler));
+}
+
+void IOUringDiskIO::async_set_file_priority(const lt::storage_index_t storage, lt::aux::vector<lt::download_priority_t, lt::file_index_t> priorities
+        , std::function<void (const lt::storage_error &, lt::aux::vector<lt::download_priority_t, lt::file_index_t>)> handler)
+{
+    // pieces of files with zero priority are kept in partfile
+    closeFiles(storage);
+    m_nativeDiskIO->async_set_file_priority(storage, std::move(priorities)
+            , [=, this, handler = std::move(handler)](const lt::storage_error &error, const lt::aux::vector<lt::download_priority_t, lt::file_index_t> &priorities)
+    {
+        if (const auto it = m_storageData.find(storage); it != m_storageData.end())
+            it->filePriorities = priorities;
+        handler(error, priorities);
+    });
+}
+
+void IOUringDiskIO::async_clear_piece(const lt::storage_index_t storage, const lt::piece_index_t index
+        , std::function<void (lt::piece_index_t)> handler)
+{
+    m_nativeDiskIO->async_clear_piece(storage, index, std::move(handler));
+}
+
+void IOUringDiskIO::update_stats_counters(lt::counters &counters) const
+{
+    m_nativeDiskIO->update_stats_counters(counters);
+}
+
+std::vector<lt::open_file_state> IOUringDiskIO::get_status(const lt::storage_index_t index) const
+{
+    return m_nativeDiskIO->get_status(index);
+}
+
+void IOUringDiskIO::abort(const bool wait)
+{
+    stopReaper();
+    m_nativeDiskIO->abort(wait);
+}
+
+void IOUringDiskIO::submit_jobs()
+{
+    submitPending();
+    m_nativeDiskIO->submit_jobs();
+}
+
+void IOUringDiskIO::settings_updated()
+{
+    m_nativeDiskIO->settings_updated();
+}
+
+void IOUringDiskIO::free_disk_buffer(char *buffer)
+{
+    const auto index = static_cast<int>((buffer - m_buffers) / BUFFER_SIZE);
+
+    const QMutexLocker locker {&m_freeBuffersMutex};
+    m_freeBuffers.push_back(index);
+}
+
+bool IOUringDiskIO::submitRead(const lt::storage_index_t storage, const lt::peer_request &peerRequest
+        , std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> &handler, const lt::disk_job_flags_t flags)
+{
+    if (!m_isRingInitialized || m_isAborted || (peerRequest.length <= 0) || (peerRequest.length > BUFFER_SIZE))
+        return false;
+
+    const auto storageIt = m_storageData.constFind(storage);
+    if (storageIt == m_storageData.cend())
+        return false;
+
+    const StorageData &storageData = storageIt.value();
+    const std::vector<lt::file_slice> fileSlices = storageData.files.map_block(peerRequest.piece, peerRequest.start, peerRequest.length);
+    if (io_uring_sq_space_left(&m_ring) < fileSlices.size())
+    {
+        submitPending();
+        if (io_uring_sq_space_left(&m_ring) < fileSlices.size())
+            return false;
+    }
+
+    const bool isDirectIOPreferred = (m_settings.get_int(lt::settings_pack::disk_io_read_mode) == lt::settings_pack::disable_os_cache);
+    std::vector<int> fds;
+    fds.reserve(fileSlices.size());
+    qint64 bufferOffset = 0;
+    for (const lt::file_slice &fileSlice : fileSlices)
+    {
+        // data of pad files and of files with zero priority (partfile) isn't in regular files
+        if (storageData.files.pad_file_at(fileSlice.file_index))
+            return false;
+        if ((fileSlice.file_index < storageData.filePriorities.end_index())
+                && (storageData.filePriorities[fileSlice.file_index] == lt::dont_download))
+        {
+            return false;
+        }
+
+        const bool isDirect = isDirectIOPreferred && isAligned(fileSlice.offset)
+            && isAligned(fileSlice.size) && isAligned(bufferOffset);
+        const int fd = openFile(storage, fileSlice.file_index, isDirect);
+        if (fd < 0)
+            return false;
+
+        fds.push_back(fd);
+        bufferOffset += fileSlice.size;
+    }
+
+    const int bufferIndex = acquireBuffer();
+    if (bufferIndex < 0)
+        return false;
+
+    auto *job = new ReadJob
+    {
+        .storage = storage,
+        .peerRequest = peerRequest,
+        .flags = flags,
+        .handler = std::move(handler),
+        .bufferIndex = bufferIndex,
+        .slices = {},
+        .pendingSlices = static_cast<int>(fileSlices.size()),
+        .isFailed = false
+    };
+    job->slices.reserve(fileSlices.size());
+
+    char *buffer = bufferAt(bufferIndex);
+    for (std::size_t i = 0; i < fileSlices.size(); ++i)
+    {
+        const auto size = static_cast<int>(fileSlices[i].size);
+        ReadSlice &slice = job->slices.emplace_back(ReadSlice {.job = job, .size = size});
+
+        io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+        if (m_hasRegisteredBuffers)
+            io_uring_prep_read_fixed(sqe, fds[i], buffer, size, fileSlices[i].offset, bufferIndex);
+        else
+            io_uring_prep_read(sqe, fds[i], buffer, size, fileSlices[i].offset);
+        io_uring_sqe_set_data(sqe, &slice);
+        buffer += size;
+    }
+
+    m_inflightSlices += static_cast<int>(fileSlices.size());
+    ++m_pendingSubmissions;
+    return true;
+}
+
+void IOUringDiskIO::completeRead(ReadJob *job)
+{
+    const std::unique_ptr<ReadJob> readJob {job};
+    if (readJob->isFailed)
+    {
+        // let native disk I/O report the error (or succeed where reading regular file can't)
+        free_disk_buffer(bufferAt(readJob->bufferIndex));
+        m_nativeDiskIO->async_read(readJob->storage, readJob->peerRequest, std::move(readJob->handler), readJob->flags);
+        m_nativeDiskIO->submit_jobs();
+        return;
+    }
+
+    readJob->handler(lt::disk_buffer_holder(*this, bufferAt(readJob->bufferIndex), readJob->peerRequest.length), {});
+}
+
+void IOUringDiskIO::reapCompletions()
+{
+    bool isStopRequested = false;
+    while (!isStopRequested || (m_inflightSlices.load() > 0))
+    {
+        io_uring_cqe *cqe = nullptr;
+        if (const int ret = io_uring_wait_cqe(&m_ring, &cqe); ret < 0)
+        {
+            if (ret == -EINTR)
+                continue;
+            break;
+        }
+
+        auto *slice = static_cast<ReadSlice *>(io_uring_cqe_get_data(cqe));
+        const int result = cqe->res;
+        io_uring_cqe_seen(&m_ring, cqe);
+
+        if (!slice)
+        {
+            isStopRequested = true;
+            continue;
+        }
+
+        --m_inflightSlices;
+        ReadJob *job = slice->job;
+        // short read means the file is smaller than expected
+        if (result != slice->size)
+            job->isFailed = true;
+        if (--job->pendingSlices == 0)
+            boost::asio::post(m_ioContext, [this, job] { completeRead(job); });
+    }
+}
+
+void IOUringDiskIO::stopReaper()
+{
+    if (m_isAborted || !m_reaperThread)
+        return;
+
+    m_isAborted = true;
+
+    // completion without job tells the reaper to exit once all the reads are completed
+    submitPending();
+    io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+    if (!sqe)
+    {
+        io_uring_submit(&m_ring);
+        sqe = io_uring_get_sqe(&m_ring);
+    }
+    if (!sqe)
+        return;
+
+    io_uring_prep_nop(sqe);
+    io_uring_sqe_set_data(sqe, nullptr);
+    io_uring_submit(&m_ring);
+    m_reaperThread->wait();
+}
+
+void IOUringDiskIO::submitPending()
+{
+    if (m_pendingSubmissions == 0)
+        return;
+
+    io_uring_submit(&m_ring);
+    m_pendingSubmissions = 0;
+}
+
+int IOUringDiskIO::openFile(const lt::storage_index_t storage, const lt::file_index_t fileIndex, const bool isDirect)
+{
+    const qint64 id = fileID(storage, fileIndex);
+    OpenFile &file = m_openFiles[id];
+    int &fd = isDirect ? file.directFd : file.fd;
+    if (fd >= 0)
+        return fd;
+
+    if (m_openFiles.size() > MAX_OPEN_FILES)
+    {
+        closeAllFiles();
+        return openFile(storage, fileIndex, isDirect);
+    }
+
+    const StorageData &storageData = m_storageData[storage];
+    const std::string filePath = storageData.files.file_path(fileIndex, storageData.savePath.toString().toStdString());
+    fd = ::open(filePath.c_str(), (O_RDONLY | O_CLOEXEC | (isDirect ? O_DIRECT : 0)));
+    return fd;
+}
+
+void IOUringDiskIO::closeFiles(const lt::storage_index_t storage)
+{
+    // queued reads have to be submitted before their files get closed
+    submitPending();
+
+    const int storageIndex = static_cast<int>(static_cast<std::uint32_t>(storage));
+    for (auto it = m_openFiles.begin(); it != m_openFiles.end();)
+    {
+        if (storageOfFileID(it.key()) != storageIndex)
+        {
+            ++it;
+            continue;
+        }
+
+        for (const int fd : {it->fd, it->directFd})
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+        it = m_openFiles.erase(it);
+    }
+}
+
+void IOUringDiskIO::closeAllFiles()
+{
+    submitPending();
+
+    for (const OpenFile &openFile : m_openFiles)
+    {
+        for (const int fd : {openFile.fd, openFile.directFd})
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    }
+    m_openFiles.clear();
+}
+
+int IOUringDiskIO::acquireBuffer()
+{
+    const QMutexLocker locker {&m_freeBuffersMutex};
+    if (m_freeBuffers.empty())
+        return -1;
+
+    const int index = m_freeBuffers.back();
+    m_freeBuffers.pop_back();
+    return index;
+}
+
+char *IOUringDiskIO::bufferAt(const int index) const
+{
+    return m_buffers + (static_cast<qint64>(index) * BUFFER_SIZE);
+}
@@ -0,0 +1,167 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <liburing.h>
+
+#include <libtorrent/aux_/vector.hpp>
+#include <libtorrent/disk_buffer_holder.hpp>
+#include <libtorrent/disk_interface.hpp>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/io_context.hpp>
+#include <libtorrent/settings_pack.hpp>
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+
+#include "base/path.h"
+
+class QThread;
+
+// Serves peer reads of complete files via io_uring, everything else (writes, hashing,
+// partfiles, storage operations) as well as reads the ring can't serve are passed to
+// POSIX disk I/O. Reads are queued by async_read() and submitted to the kernel in batch
+// by submit_jobs(), which libtorrent calls once it has issued all jobs of current round.
+// Completions are reaped by dedicated thread and handlers are posted to network thread.
+class IOUringDiskIO final : public lt::disk_interface, public lt::buffer_allocator_interface
+{
+    Q_DECLARE_TR_FUNCTIONS(IOUringDiskIO)
+    Q_DISABLE_COPY_MOVE(IOUringDiskIO)
+
+public:
+    IOUringDiskIO(lt::io_context &ioContext, const lt::settings_interface &settings
+            , std::unique_ptr<lt::disk_interface> nativeDiskIO);
+    ~IOUringDiskIO() override;
+
+    lt::storage_holder new_torrent(const lt::storage_params &storageParams, const std::shared_ptr<void> &torrent) override;
+    void remove_torrent(lt::storage_index_t storage) override;
+    void async_read(lt::storage_index_t storage, const lt::peer_request &peerRequest
+                    , std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> handler
+                    , lt::disk_job_flags_t flags) override;
+    bool async_write(lt::storage_index_t storage, const lt::peer_request &peerRequest
+                     , const char *buf, std::shared_ptr<lt::disk_observer> diskObserver
+                     , std::function<void (const lt::storage_error &)> handler, lt::disk_job_flags_t flags) override;
+    void async_hash(lt::storage_index_t storage, lt::piece_index_t piece, lt::span<lt::sha256_hash> hash, lt::disk_job_flags_t flags
+                    , std::function<void (lt::piece_index_t, const lt::sha1_hash &, const lt::storage_error &)> handler) override;
+    void async_hash2(lt::storage_index_t storage, lt::piece_index_t piece, int offset, lt::disk_job_flags_t flags
+                     , std::function<void (lt::piece_index_t, const lt::sha256_hash &, const lt::storage_error &)> handler) override;
+    void async_move_storage(lt::storage_index_t storage, std::string path, lt::move_flags_t flags
+                            , std::function<void (lt::status_t, const std::string &, const lt::storage_error &)> handler) override;
+    void async_release_files(lt::storage_index_t storage, std::function<void ()> handler) override;
+    void async_check_files(lt::storage_index_t storage, const lt::add_torrent_params *resume_data
+                           , lt::aux::vector<std::string, lt::file_index_t> links
+                           , std::function<void (lt::status_t, const lt::storage_error &)> handler) override;
+    void async_stop_torrent(lt::storage_index_t storage, std::function<void ()> handler) override;
+    void async_rename_file(lt::storage_index_t storage, lt::file_index_t index, std::string name
+                           , std::function<void (const std::string &, lt::file_index_t, const lt::storage_error &)> handler) override;
+    void async_delete_files(lt::storage_index_t storage, lt::remove_flags_t options, std::function<void (const lt::storage_error &)> handler) override;
+    void async_set_file_priority(lt::storage_index_t storage, lt::aux::vector<lt::download_priority_t, lt::file_index_t> priorities
+                                 , std::function<void (const lt::storage_error &, lt::aux::vector<lt::download_priority_t, lt::file_index_t>)> handler) override;
+    void async_clear_piece(lt::storage_index_t storage, lt::piece_index_t index, std::function<void (lt::piece_index_t)> handler) override;
+    void update_stats_counters(lt::counters &counters) const override;
+    std::vector<lt::open_file_state> get_status(lt::storage_index_t index) const override;
+    void abort(bool wait) override;
+    void submit_jobs() override;
+    void settings_updated() override;
+
+    void free_disk_buffer(char *buffer) override;
+
+private:
+    struct ReadJob;
+
+    struct ReadSlice
+    {
+        ReadJob *job = nullptr;
+        int size = 0;
+    };
+
+    struct ReadJob
+    {
+        lt::storage_index_t storage;
+        lt::peer_request peerRequest;
+        lt::disk_job_flags_t flags;
+        std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> handler;
+        int bufferIndex = -1;
+        std::vector<ReadSlice> slices;
+        int pendingSlices = 0;
+        bool isFailed = false;
+    };
+
+    struct OpenFile
+    {
+        int fd = -1;
+        int directFd = -1;
+    };
+
+    struct StorageData
+    {
+        Path savePath;
+        lt::file_storage files;
+        lt::aux::vector<lt::download_priority_t, lt::file_index_t> filePriorities;
+    };
+
+    bool submitRead(lt::storage_index_t storage, const lt::peer_request &peerRequest
+            , std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> &handler, lt::disk_job_flags_t flags);
+    void completeRead(ReadJob *job);
+    void reapCompletions();
+    void stopReaper();
+    void submitPending();
+
+    int openFile(lt::storage_index_t storage, lt::file_index_t fileIndex, bool isDirect);
+    void closeFiles(lt::storage_index_t storage);
+    void closeAllFiles();
+
+    int acquireBuffer();
+    char *bufferAt(int index) const;
+
+    lt::io_context &m_ioContext;
+    const lt::settings_interface &m_settings;
+    std::unique_ptr<lt::disk_interface> m_nativeDiskIO;
+
+    io_uring m_ring {};
+    bool m_isRingInitialized = false;
+    bool m_hasRegisteredBuffers = false;
+    bool m_isAborted = false;
+    int m_pendingSubmissions = 0;
+    std::atomic_int m_inflightSlices {0};
+    std::unique_ptr<QThread> m_reaperThread;
+
+    // read buffers are allocated at once so that they can be registered with the ring
+    char *m_buffers = nullptr;
+    QMutex m_freeBuffersMutex;
+    std::vector<int> m_freeBuffers;
+
+    QHash<lt::storage_index_t, StorageData> m_storageData;
+    QHash<qint64, OpenFile> m_openFiles;
+};
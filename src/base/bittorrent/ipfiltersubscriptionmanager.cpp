@@ -0,0 +1,531 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "ipfiltersubscriptionmanager.h"
+
+#include <algorithm>
+#include <optional>
+#include <queue>
+#include <utility>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QUrl>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/net/downloadmanager.h"
+#include "base/preferences.h"
+#include "base/profile.h"
+#include "base/utils/fs.h"
+#include "base/utils/gzip.h"
+#include "base/utils/io.h"
+#include "filterparserthread.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    const QString SUBSCRIPTIONS_FOLDER = u"IPFilterSubscriptions"_s;
+    const QString STATE_FILENAME = u"subscriptions.json"_s;
+    const qint64 STATE_FILE_MAX_SIZE = 10 * 1024 * 1024;
+    const std::chrono::milliseconds REFRESH_CHECK_INTERVAL = 1h;
+
+    const QString KEY_ETAG = u"etag"_s;
+    const QString KEY_LAST_MODIFIED = u"last_modified"_s;
+    const QString KEY_LAST_UPDATED = u"last_updated"_s;
+    const QString KEY_FILE_NAME = u"file_name"_s;
+
+    QString subscriptionID(const QString &url)
+    {
+        return QString::fromLatin1(QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+    }
+
+    // FilterParserThread recognizes the format by file extension
+    QString detectFilterFormat(const QString &url, const QByteArray &data)
+    {
+        if (data.startsWith("\xFF\xFF\xFF\xFFP2B"))
+            return u".p2b"_s;
+
+        const QString urlPath = QUrl(url).path();
+        if (urlPath.endsWith(u".p2p", Qt::CaseInsensitive) || urlPath.endsWith(u".p2p.gz", Qt::CaseInsensitive))
+            return u".p2p"_s;
+        if (urlPath.endsWith(u".dat", Qt::CaseInsensitive) || urlPath.endsWith(u".dat.gz", Qt::CaseInsensitive))
+            return u".dat"_s;
+
+        // DAT lines start with IP range ("1.0.0.0 - 1.0.0.255 , 000 , Name"),
+        // P2P lines start with name followed by colon ("Name:1.0.0.0-1.0.0.255")
+        qsizetype lineStart = 0;
+        while (lineStart < data.size())
+        {
+            qsizetype lineEnd = data.indexOf('\n', lineStart);
+            if (lineEnd < 0)
+                lineEnd = data.size();
+            const QByteArray line = data.mid(lineStart, (lineEnd - lineStart)).trimmed();
+            lineStart = lineEnd + 1;
+
+            if (line.isEmpty() || line.startsWith('#') || line.startsWith("//"))
+                continue;
+
+            const qsizetype colonPos = line.lastIndexOf(':');
+            const qsizetype dashPos = line.indexOf('-');
+            return ((colonPos >= 0) && (dashPos > colonPos)) ? u".p2p"_s : u".dat"_s;
+        }
+
+        return u".dat"_s;
+    }
+
+    template <typename Address>
+    Address nextAddress(const Address &address);
+
+    template <>
+    lt::address_v4 nextAddress(const lt::address_v4 &address)
+    {
+        return lt::address_v4(address.to_uint() + 1);
+    }
+
+    template <>
+    lt::address_v6 nextAddress(const lt::address_v6 &address)
+    {
+        lt::address_v6::bytes_type bytes = address.to_bytes();
+        for (auto it = bytes.rbegin(); it != bytes.rend(); ++it)
+        {
+            if (++(*it) != 0)
+                break;
+        }
+        return lt::address_v6(bytes);
+    }
+
+    template <typename Address>
+    bool isMaxAddress(const Address &address)
+    {
+        return (nextAddress(address) < address);
+    }
+
+    // Merges sorted lists of non overlapping ranges into the filter. Ranges are taken from
+    // the lists in ascending order, so the filter only appends each merged range.
+    template <typename Address>
+    void mergeRanges(const std::vector<const std::vector<lt::ip_range<Address>> *> &lists, lt::ip_filter &filter)
+    {
+        // position in list: list index, range index
+        using Cursor = std::pair<std::size_t, std::size_t>;
+        const auto rangeAt = [&lists](const Cursor &cursor) -> const lt::ip_range<Address> &
+        {
+            return (*lists[cursor.first])[cursor.second];
+        };
+        const auto isGreater = [&rangeAt](const Cursor &left, const Cursor &right)
+        {
+            return (rangeAt(right).first < rangeAt(left).first);
+        };
+
+        std::priority_queue<Cursor, std::vector<Cursor>, decltype(isGreater)> heap {isGreater};
+        for (std::size_t i = 0; i < lists.size(); ++i)
+        {
+            if (!lists[i]->empty())
+                heap.push({i, 0});
+        }
+
+        std::optional<lt::ip_range<Address>> current;
+        while (!heap.empty())
+        {
+            const Cursor cursor = heap.top();
+            heap.pop();
+            const lt::ip_range<Address> &range = rangeAt(cursor);
+            if ((cursor.second + 1) < lists[cursor.first]->size())
+                heap.push({cursor.first, (cursor.second + 1)});
+
+            if (current && (isMaxAddress(current->last) || !(nextAddress(current->last) < range.first)))
+            {
+                if (current->last < range.last)
+                    current->last = range.last;
+            }
+            else
+            {
+                if (current)
+                    filter.add_rule(current->first, current->last, lt::ip_filter::blocked);
+                current = range;
+            }
+        }
+
+        if (current)
+            filter.add_rule(current->first, current->last, lt::ip_filter::blocked);
+    }
+}
+
+BitTorrent::IPRangeSet BitTorrent::IPRangeSet::fromFilter(const lt::ip_filter &filter)
+{
+    const auto isAllowed = [](const auto &range) { return (range.flags != lt::ip_filter::blocked); };
+
+    auto [v4Ranges, v6Ranges] = filter.export_filter();
+    v4Ranges.erase(std::remove_if(v4Ranges.begin(), v4Ranges.end(), isAllowed), v4Ranges.end());
+    v6Ranges.erase(std::remove_if(v6Ranges.begin(), v6Ranges.end(), isAllowed), v6Ranges.end());
+    return {.v4 = std::move(v4Ranges), .v6 = std::move(v6Ranges)};
+}
+
+BitTorrent::IPFilterSubscriptionManager::IPFilterSubscriptionManager(QObject *parent)
+    : QObject(parent)
+    , m_refreshTimer {new QTimer(this)}
+{
+    m_refreshTimer->setInterval(REFRESH_CHECK_INTERVAL);
+    connect(m_refreshTimer, &QTimer::timeout, this, &IPFilterSubscriptionManager::refresh);
+
+    loadState();
+}
+
+BitTorrent::IPFilterSubscriptionManager::~IPFilterSubscriptionManager()
+{
+    delete m_filterParser;
+}
+
+QStringList BitTorrent::IPFilterSubscriptionManager::urls() const
+{
+    QStringList urls;
+    urls.reserve(m_subscriptions.size());
+    for (const auto &subscription : m_subscriptions)
+        urls.append(subscription->url);
+    return urls;
+}
+
+void BitTorrent::IPFilterSubscriptionManager::setURLs(const QStringList &urls)
+{
+    QStringList newURLs;
+    for (const QString &url : urls)
+    {
+        const QString trimmedURL = url.trimmed();
+        if (!trimmedURL.isEmpty() && !newURLs.contains(trimmedURL))
+            newURLs.append(trimmedURL);
+    }
+
+    if (newURLs == this->urls())
+        return;
+
+    bool isRangesChanged = false;
+    std::vector<std::unique_ptr<Subscription>> subscriptions;
+    subscriptions.reserve(newURLs.size());
+    for (const QString &url : asConst(newURLs))
+    {
+        const auto iter = std::find_if(m_subscriptions.begin(), m_subscriptions.end()
+                , [&url](const std::unique_ptr<Subscription> &subscription) { return subscription->url == url; });
+        if (iter != m_subscriptions.end())
+        {
+            subscriptions.push_back(std::move(*iter));
+            m_subscriptions.erase(iter);
+        }
+        else
+        {
+            auto subscription = std::make_unique<Subscription>();
+            subscription->url = url;
+            subscription->id = subscriptionID(url);
+            subscriptions.push_back(std::move(subscription));
+        }
+    }
+
+    // remaining subscriptions are removed
+    for (const auto &subscription : m_subscriptions)
+    {
+        if (!subscription->filePath.isEmpty())
+        {
+            Utils::Fs::removeFile(subscription->filePath);
+            Utils::Fs::removeFile(subscriptionsPath() / Path(subscription->id + u".cache"));
+        }
+        isRangesChanged = isRangesChanged || (subscription->ruleCount > 0);
+    }
+
+    m_subscriptions = std::move(subscriptions);
+    storeState();
+
+    if (m_isEnabled)
+        refresh();
+    if (isRangesChanged)
+        emit rangesChanged();
+}
+
+std::chrono::hours BitTorrent::IPFilterSubscriptionManager::refreshInterval() const
+{
+    return m_refreshInterval;
+}
+
+void BitTorrent::IPFilterSubscriptionManager::setRefreshInterval(const std::chrono::hours interval)
+{
+    m_refreshInterval = std::max(interval, 1h);
+}
+
+bool BitTorrent::IPFilterSubscriptionManager::isEnabled() const
+{
+    return m_isEnabled;
+}
+
+void BitTorrent::IPFilterSubscriptionManager::setEnabled(const bool enabled)
+{
+    if (enabled == m_isEnabled)
+        return;
+
+    m_isEnabled = enabled;
+    if (!m_isEnabled)
+    {
+        m_refreshTimer->stop();
+        return;
+    }
+
+    // lists downloaded in previous sessions are compiled before they are checked for updates
+    for (const auto &subscription : m_subscriptions)
+    {
+        if (!subscription->filePath.isEmpty() && (subscription->ruleCount == 0) && subscription->filePath.exists())
+            enqueueParsing(subscription->url);
+    }
+
+    m_refreshTimer->start();
+    refresh();
+}
+
+void BitTorrent::IPFilterSubscriptionManager::refresh()
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (const auto &subscription : m_subscriptions)
+    {
+        if (subscription->isDownloading)
+            continue;
+
+        const bool isOutdated = !subscription->lastUpdated.isValid() || !subscription->filePath.exists()
+                || (subscription->lastUpdated.secsTo(now) >= std::chrono::seconds(m_refreshInterval).count());
+        if (isOutdated)
+            download(*subscription);
+    }
+}
+
+lt::ip_filter BitTorrent::IPFilterSubscriptionManager::merge(const lt::ip_filter &filter) const
+{
+    if (!m_isEnabled || (ruleCount() == 0))
+        return filter;
+
+    const IPRangeSet filterRanges = IPRangeSet::fromFilter(filter);
+
+    std::vector<const std::vector<lt::ip_range<lt::address_v4>> *> v4Lists {&filterRanges.v4};
+    std::vector<const std::vector<lt::ip_range<lt::address_v6>> *> v6Lists {&filterRanges.v6};
+    for (const auto &subscription : m_subscriptions)
+    {
+        v4Lists.push_back(&subscription->ranges.v4);
+        v6Lists.push_back(&subscription->ranges.v6);
+    }
+
+    lt::ip_filter mergedFilter;
+    mergeRanges(v4Lists, mergedFilter);
+    mergeRanges(v6Lists, mergedFilter);
+    return mergedFilter;
+}
+
+int BitTorrent::IPFilterSubscriptionManager::ruleCount() const
+{
+    int count = 0;
+    for (const auto &subscription : m_subscriptions)
+        count += subscription->ruleCount;
+    return count;
+}
+
+BitTorrent::IPFilterSubscriptionManager::Subscription *BitTorrent::IPFilterSubscriptionManager::findSubscription(const QString &url)
+{
+    const auto iter = std::find_if(m_subscriptions.cbegin(), m_subscriptions.cend()
+            , [&url](const std::unique_ptr<Subscription> &subscription) { return subscription->url == url; });
+    return (iter != m_subscriptions.cend()) ? iter->get() : nullptr;
+}
+
+void BitTorrent::IPFilterSubscriptionManager::loadState()
+{
+    const auto readResult = Utils::IO::readFile((subscriptionsPath() / Path(STATE_FILENAME)), STATE_FILE_MAX_SIZE);
+    if (!readResult)
+        return;
+
+    const QJsonObject state = QJsonDocument::fromJson(readResult.value()).object();
+    for (auto it = state.constBegin(); it != state.constEnd(); ++it)
+    {
+        const QJsonObject data = it.value().toObject();
+
+        auto subscription = std::make_unique<Subscription>();
+        subscription->url = it.key();
+        subscription->id = subscriptionID(subscription->url);
+        subscription->eTag = data.value(KEY_ETAG).toString();
+        subscription->lastModified = data.value(KEY_LAST_MODIFIED).toString();
+        if (const qint64 lastUpdated = data.value(KEY_LAST_UPDATED).toInteger(); lastUpdated > 0)
+            subscription->lastUpdated = QDateTime::fromSecsSinceEpoch(lastUpdated);
+        if (const QString fileName = data.value(KEY_FILE_NAME).toString(); !fileName.isEmpty())
+            subscription->filePath = subscriptionsPath() / Path(fileName);
+        m_subscriptions.push_back(std::move(subscription));
+    }
+}
+
+void BitTorrent::IPFilterSubscriptionManager::storeState() const
+{
+    QJsonObject state;
+    for (const auto &subscription : m_subscriptions)
+    {
+        state[subscription->url] = QJsonObject
+        {
+            {KEY_ETAG, subscription->eTag},
+            {KEY_LAST_MODIFIED, subscription->lastModified},
+            {KEY_LAST_UPDATED, (subscription->lastUpdated.isValid() ? subscription->lastUpdated.toSecsSinceEpoch() : 0)},
+            {KEY_FILE_NAME, subscription->filePath.filename()}
+        };
+    }
+
+    const Path statePath = subscriptionsPath() / Path(STATE_FILENAME);
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(statePath, QJsonDocument(state).toJson(QJsonDocument::Compact));
+    if (!result)
+    {
+        LogMsg(tr("Couldn't save IP filter subscriptions. File: \"%1\". Error: \"%2\"")
+                .arg(statePath.toString(), result.error()), Log::WARNING);
+    }
+}
+
+void BitTorrent::IPFilterSubscriptionManager::download(Subscription &subscription)
+{
+    subscription.isDownloading = true;
+
+    // validators are only useful if the previously downloaded list is still available
+    const bool hasFile = !subscription.filePath.isEmpty() && subscription.filePath.exists();
+    const auto request = Net::DownloadRequest(subscription.url)
+            .eTag(hasFile ? subscription.eTag : QString())
+            .lastModified(hasFile ? subscription.lastModified : QString())
+            .priority(Net::DownloadPriority::Low);
+    Net::DownloadManager::instance()->download(request, Preferences::instance()->useProxyForGeneralPurposes(), this
+            , [this, url = subscription.url](const Net::DownloadResult &result) { handleDownloadFinished(url, result); });
+}
+
+void BitTorrent::IPFilterSubscriptionManager::handleDownloadFinished(const QString &url, const Net::DownloadResult &result)
+{
+    Subscription *subscription = findSubscription(url);
+    if (!subscription)
+        return;
+
+    subscription->isDownloading = false;
+
+    if (result.status == Net::DownloadStatus::NotModified)
+    {
+        subscription->lastUpdated = QDateTime::currentDateTimeUtc();
+        storeState();
+        return;
+    }
+
+    if (result.status != Net::DownloadStatus::Success)
+    {
+        LogMsg(tr("Couldn't download IP filter list. URL: \"%1\". Reason: \"%2\"").arg(url, result.errorString), Log::WARNING);
+        return;
+    }
+
+    QByteArray data = result.data;
+    if (data.startsWith("\x1F\x8B"))
+    {
+        bool ok = false;
+        data = Utils::Gzip::decompress(data, &ok);
+        if (!ok)
+        {
+            LogMsg(tr("Couldn't decompress IP filter list. URL: \"%1\"").arg(url), Log::WARNING);
+            return;
+        }
+    }
+
+    const Path filePath = subscriptionsPath() / Path(subscription->id + detectFilterFormat(url, data));
+    if (const nonstd::expected<void, QString> saveResult = Utils::IO::saveToFile(filePath, data); !saveResult)
+    {
+        LogMsg(tr("Couldn't save IP filter list. URL: \"%1\". Error: \"%2\"").arg(url, saveResult.error()), Log::WARNING);
+        return;
+    }
+
+    if (!subscription->filePath.isEmpty() && (subscription->filePath != filePath))
+        Utils::Fs::removeFile(subscription->filePath);
+
+    subscription->filePath = filePath;
+    subscription->eTag = result.eTag;
+    subscription->lastModified = result.lastModified;
+    subscription->lastUpdated = QDateTime::currentDateTimeUtc();
+    storeState();
+
+    enqueueParsing(url);
+}
+
+void BitTorrent::IPFilterSubscriptionManager::enqueueParsing(const QString &url)
+{
+    if (!m_parsingQueue.contains(url))
+        m_parsingQueue.enqueue(url);
+    parseNext();
+}
+
+// Lists are parsed one after another, each producing its own range set
+void BitTorrent::IPFilterSubscriptionManager::parseNext()
+{
+    if (!m_parsingURL.isEmpty())
+        return;
+
+    while (!m_parsingQueue.isEmpty())
+    {
+        const QString url = m_parsingQueue.dequeue();
+        const Subscription *subscription = findSubscription(url);
+        if (!subscription || subscription->filePath.isEmpty())
+            continue;
+
+        if (!m_filterParser)
+        {
+            m_filterParser = new FilterParserThread(this);
+            connect(m_filterParser.data(), &FilterParserThread::IPFilterParsed, this, &IPFilterSubscriptionManager::handleParsingFinished);
+            connect(m_filterParser.data(), &FilterParserThread::IPFilterError, this, &IPFilterSubscriptionManager::handleParsingFailed);
+        }
+
+        m_parsingURL = url;
+        m_filterParser->processFilterFile(subscription->filePath, (subscriptionsPath() / Path(subscription->id + u".cache")));
+        return;
+    }
+}
+
+void BitTorrent::IPFilterSubscriptionManager::handleParsingFinished(const int ruleCount)
+{
+    const QString url = std::exchange(m_parsingURL, {});
+    if (Subscription *subscription = findSubscription(url))
+    {
+        subscription->ranges = IPRangeSet::fromFilter(m_filterParser->IPfilter());
+        subscription->ruleCount = ruleCount;
+        LogMsg(tr("IP filter list is updated. URL: \"%1\". Number of rules: %2").arg(url, QString::number(ruleCount)));
+        emit rangesChanged();
+    }
+
+    parseNext();
+}
+
+void BitTorrent::IPFilterSubscriptionManager::handleParsingFailed()
+{
+    const QString url = std::exchange(m_parsingURL, {});
+    LogMsg(tr("Failed to parse IP filter list. URL: \"%1\"").arg(url), Log::WARNING);
+
+    parseNext();
+}
+
+Path BitTorrent::IPFilterSubscriptionManager::subscriptionsPath() const
+{
+    return specialFolderLocation(SpecialFolder::Data) / Path(SUBSCRIPTIONS_FOLDER);
+}
@@ -0,0 +1,127 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <libtorrent/ip_filter.hpp>
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QStringList>
+
+#include "base/path.h"
+
+class QTimer;
+class FilterParserThread;
+
+namespace Net
+{
+    struct DownloadResult;
+}
+
+namespace BitTorrent
+{
+    // Blocked IP ranges sorted in ascending order, ranges don't overlap
+    struct IPRangeSet
+    {
+        std::vector<lt::ip_range<lt::address_v4>> v4;
+        std::vector<lt::ip_range<lt::address_v6>> v6;
+
+        static IPRangeSet fromFilter(const lt::ip_filter &filter);
+    };
+
+    // Keeps remote IP filter lists up to date. Each list is compiled into its own range set,
+    // so only the changed list is parsed again when it is updated.
+    class IPFilterSubscriptionManager final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(IPFilterSubscriptionManager)
+
+    public:
+        explicit IPFilterSubscriptionManager(QObject *parent = nullptr);
+        ~IPFilterSubscriptionManager() override;
+
+        QStringList urls() const;
+        void setURLs(const QStringList &urls);
+        std::chrono::hours refreshInterval() const;
+        void setRefreshInterval(std::chrono::hours interval);
+        bool isEnabled() const;
+        void setEnabled(bool enabled);
+
+        void refresh();
+
+        // builds new filter containing blocked ranges of given filter and all the subscribed lists
+        lt::ip_filter merge(const lt::ip_filter &filter) const;
+        int ruleCount() const;
+
+    signals:
+        void rangesChanged();
+
+    private:
+        struct Subscription
+        {
+            QString url;
+            QString id;
+            QString eTag;
+            QString lastModified;
+            QDateTime lastUpdated;
+            Path filePath;
+            IPRangeSet ranges;
+            int ruleCount = 0;
+            bool isDownloading = false;
+        };
+
+        Subscription *findSubscription(const QString &url);
+        void loadState();
+        void storeState() const;
+        void download(Subscription &subscription);
+        void handleDownloadFinished(const QString &url, const Net::DownloadResult &result);
+        void enqueueParsing(const QString &url);
+        void parseNext();
+        void handleParsingFinished(int ruleCount);
+        void handleParsingFailed();
+        void scheduleRefresh();
+        Path subscriptionsPath() const;
+
+        std::vector<std::unique_ptr<Subscription>> m_subscriptions;
+        std::chrono::hours m_refreshInterval {24};
+        bool m_isEnabled = false;
+
+        QTimer *m_refreshTimer = nullptr;
+        QPointer<FilterParserThread> m_filterParser;
+        QQueue<QString> m_parsingQueue;
+        QString m_parsingURL;
+    };
+}
@@ -59,6 +59,7 @@ namespace BitTorrent
         Torrent::StopCondition stopCondition = Torrent::StopCondition::None;
 
         bool addToQueueTop = false; // only for new torrents
+        bool isDeferred = false; // only for torrents restored after the session startup is finished
 
         qreal ratioLimit = Torrent::USE_GLOBAL_RATIO;
         int seedingTimeLimit = Torrent::USE_GLOBAL_SEEDING_TIME;
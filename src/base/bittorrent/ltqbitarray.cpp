@@ -28,6 +28,9 @@
 
 #include "ltqbitarray.h"
 
+#include <cstdint>
+#include <cstring>
+
 #include <libtorrent/bitfield.hpp>
 
 #include <QBitArray>
@@ -50,6 +53,15 @@ namespace
         };
         return table[byte];
     }
+
+    // Reverses bit order in each of the 8 bytes at once
+    std::uint64_t reverseBytes(std::uint64_t word)
+    {
+        word = ((word >> 1) & 0x5555555555555555) | ((word & 0x5555555555555555) << 1);
+        word = ((word >> 2) & 0x3333333333333333) | ((word & 0x3333333333333333) << 2);
+        word = ((word >> 4) & 0x0F0F0F0F0F0F0F0F) | ((word & 0x0F0F0F0F0F0F0F0F) << 4);
+        return word;
+    }
 }
 
 namespace BitTorrent::LT
@@ -62,7 +74,17 @@ namespace BitTorrent::LT
         const int dataLength = (bits.size() + 7) / 8;
 
         QVarLengthArray<char, STACK_ALLOC_SIZE> tmp(dataLength);
-        for (int i = 0; i < dataLength; ++i)
+
+        // bit order within bytes doesn't depend on endianness, so whole words can be processed
+        int i = 0;
+        for (; (i + static_cast<int>(sizeof(std::uint64_t))) <= dataLength; i += sizeof(std::uint64_t))
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, (bitsData + i), sizeof(word));
+            word = reverseBytes(word);
+            std::memcpy((tmp.data() + i), &word, sizeof(word));
+        }
+        for (; i < dataLength; ++i)
             tmp[i] = reverseByte(bitsData[i]);
 
         return QBitArray::fromBits(tmp.data(), bits.size());
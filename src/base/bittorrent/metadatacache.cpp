@@ -0,0 +1,106 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "metadatacache.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/utils/fs.h"
+#include "infohash.h"
+#include "torrentinfo.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const QString FILE_EXTENSION = u".torrent"_s;
+
+    // hybrid torrents are stored by v1 info hash, so they are found by magnet links of both kinds
+    // as long as v1 info hash is present in them
+    TorrentID cacheID(const InfoHash &infoHash)
+    {
+        return infoHash.v1().isValid() ? TorrentID::fromSHA1Hash(infoHash.v1()) : TorrentID::fromInfoHash(infoHash);
+    }
+}
+
+MetadataCache::MetadataCache(const Path &folderPath)
+    : m_folderPath {folderPath}
+{
+}
+
+std::optional<TorrentInfo> MetadataCache::load(const InfoHash &infoHash) const
+{
+    const Path path = filePath(cacheID(infoHash));
+    if (!path.exists())
+        return std::nullopt;
+
+    const nonstd::expected<TorrentInfo, QString> loadResult = TorrentInfo::loadFromFile(path);
+    if (!loadResult || !loadResult.value().matchesInfoHash(infoHash))
+    {
+        LogMsg(tr("Removed corrupted cached metadata. File: \"%1\"")
+            .arg(path.toString()), Log::WARNING);
+        Utils::Fs::removeFile(path);
+        return std::nullopt;
+    }
+
+    return loadResult.value();
+}
+
+void MetadataCache::store(const TorrentInfo &metadata) const
+{
+    if (!metadata.isValid())
+        return;
+
+    const Path path = filePath(cacheID(metadata.infoHash()));
+    if (path.exists())
+        return;
+
+    if (!Utils::Fs::mkpath(m_folderPath))
+        return;
+
+    if (const nonstd::expected<void, QString> result = metadata.saveToFile(path); !result)
+    {
+        LogMsg(tr("Failed to store metadata in cache. File: \"%1\". Error: \"%2\"")
+            .arg(path.toString(), result.error()), Log::WARNING);
+    }
+}
+
+void MetadataCache::prune(const int maxCount) const
+{
+    const QFileInfoList files = QDir(m_folderPath.data()).entryInfoList({u'*' + FILE_EXTENSION}, QDir::Files, QDir::Time);
+    for (qsizetype i = maxCount; i < files.size(); ++i)
+        Utils::Fs::removeFile(Path(files[i].filePath()));
+}
+
+Path MetadataCache::filePath(const TorrentID &id) const
+{
+    return m_folderPath / Path(id.toString() + FILE_EXTENSION);
+}
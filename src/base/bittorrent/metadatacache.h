@@ -0,0 +1,63 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <optional>
+
+#include <QCoreApplication>
+
+#include "base/path.h"
+
+namespace BitTorrent
+{
+    class InfoHash;
+    class TorrentID;
+    class TorrentInfo;
+
+    // Keeps metadata of torrents on disk, so that metadata of magnet links which was received once
+    // is not downloaded from the swarm again. Files are named by info hash and are verified
+    // against it when loaded. It only refers to the folder, so it can be copied to worker threads.
+    class MetadataCache
+    {
+        Q_DECLARE_TR_FUNCTIONS(MetadataCache)
+
+    public:
+        explicit MetadataCache(const Path &folderPath);
+
+        std::optional<TorrentInfo> load(const InfoHash &infoHash) const;
+        void store(const TorrentInfo &metadata) const;
+        // removes the least recently stored metadata beyond the given count
+        void prune(int maxCount) const;
+
+    private:
+        Path filePath(const TorrentID &id) const;
+
+        Path m_folderPath;
+    };
+}
@@ -28,8 +28,129 @@
 
 #include "nativetorrentextension.h"
 
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <libtorrent/bdecode.hpp>
+#include <libtorrent/bitfield.hpp>
+#include <libtorrent/peer_connection_handle.hpp>
+#include <libtorrent/peer_request.hpp>
 #include <libtorrent/torrent_status.hpp>
 
+// Keeps the counters of a peer connection, it is updated by libtorrent in the network thread
+class NativePeerExtension final : public lt::peer_plugin
+{
+public:
+    explicit NativePeerExtension(const lt::peer_connection_handle &peerConnection)
+    {
+        m_stats.endpoint = peerConnection.remote();
+    }
+
+    bool isConnected() const
+    {
+        return m_isConnected;
+    }
+
+    const PeerStats &stats() const
+    {
+        return m_stats;
+    }
+
+    void updateRates(const lt::clock_type::duration interval)
+    {
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(interval).count();
+        if (milliseconds <= 0)
+            return;
+
+        m_stats.uploadPayloadRate = static_cast<int>((m_stats.uploadedPayload - m_lastUploadedPayload) * 1000 / milliseconds);
+        m_stats.downloadPayloadRate = static_cast<int>((m_stats.downloadedPayload - m_lastDownloadedPayload) * 1000 / milliseconds);
+        m_lastUploadedPayload = m_stats.uploadedPayload;
+        m_lastDownloadedPayload = m_stats.downloadedPayload;
+    }
+
+private:
+    void on_disconnect(const lt::error_code &) override
+    {
+        m_isConnected = false;
+    }
+
+    bool on_extension_handshake(const lt::bdecode_node &handshake) override
+    {
+        m_stats.client = std::string(handshake.dict_find_string_value("v"));
+        return true;
+    }
+
+    bool on_have(const lt::piece_index_t) override
+    {
+        // duplicate messages are not expected from well behaved clients
+        ++m_stats.piecesCount;
+        return false;
+    }
+
+    bool on_dont_have(const lt::piece_index_t) override
+    {
+        m_stats.piecesCount = std::max(0, (m_stats.piecesCount - 1));
+        m_stats.isSeed = false;
+        return false;
+    }
+
+    bool on_bitfield(const lt::bitfield &bitfield) override
+    {
+        m_stats.piecesCount = bitfield.count();
+        m_stats.isSeed = bitfield.all_set();
+        return false;
+    }
+
+    bool on_have_all() override
+    {
+        m_stats.isSeed = true;
+        return false;
+    }
+
+    bool on_have_none() override
+    {
+        m_stats.piecesCount = 0;
+        m_stats.isSeed = false;
+        return false;
+    }
+
+    bool on_interested() override
+    {
+        m_stats.isInterested = true;
+        return false;
+    }
+
+    bool on_not_interested() override
+    {
+        m_stats.isInterested = false;
+        return false;
+    }
+
+    bool on_piece(const lt::peer_request &piece, lt::span<const char>) override
+    {
+        m_stats.downloadedPayload += piece.length;
+        return false;
+    }
+
+    void sent_payload(const int bytes) override
+    {
+        m_stats.uploadedPayload += bytes;
+    }
+
+    void on_piece_failed(const lt::piece_index_t) override
+    {
+        ++m_stats.hashFailures;
+    }
+
+    PeerStats m_stats;
+    std::int64_t m_lastUploadedPayload = 0;
+    std::int64_t m_lastDownloadedPayload = 0;
+    bool m_isConnected = true;
+};
+
+std::atomic_bool NativeTorrentExtension::m_isCheckingScheduled {false};
+
 NativeTorrentExtension::NativeTorrentExtension(const lt::torrent_handle &torrentHandle, ExtensionData *data)
     : m_torrentHandle {torrentHandle}
     , m_data {data}
@@ -41,8 +162,11 @@ NativeTorrentExtension::NativeTorrentExtension(const lt::torrent_handle &torrent
         m_data->status = m_torrentHandle.status();
         m_data->trackers = m_torrentHandle.trackers();
         m_data->urlSeeds = m_torrentHandle.url_seeds();
+        m_peerStats = m_data->peerStats;
     }
 
+    m_lastTickTime = lt::clock_type::now();
+
     on_state(m_data ? m_data->status.state : m_torrentHandle.status({}).state);
 }
 
@@ -51,6 +175,22 @@ NativeTorrentExtension::~NativeTorrentExtension()
     delete m_data;
 }
 
+void NativeTorrentExtension::setCheckingScheduled(const bool enabled)
+{
+    m_isCheckingScheduled.store(enabled, std::memory_order_relaxed);
+}
+
+std::shared_ptr<lt::peer_plugin> NativeTorrentExtension::new_connection(const lt::peer_connection_handle &peerConnection)
+{
+    // torrents added to download metadata only are not tracked
+    if (!m_peerStats)
+        return nullptr;
+
+    auto peer = std::make_shared<NativePeerExtension>(peerConnection);
+    m_peers.push_back(peer);
+    return peer;
+}
+
 void NativeTorrentExtension::on_state(const lt::torrent_status::state_t state)
 {
     if ((m_state == lt::torrent_status::downloading_metadata)
@@ -59,6 +199,54 @@ void NativeTorrentExtension::on_state(const lt::torrent_status::state_t state)
         m_torrentHandle.unset_flags(lt::torrent_flags::auto_managed);
         m_torrentHandle.pause();
     }
+    else if (m_data && (state == lt::torrent_status::checking_files)
+            && m_isCheckingScheduled.load(std::memory_order_relaxed))
+    {
+        // the torrent waits in checking queue of the session until it is resumed
+        m_torrentHandle.unset_flags(lt::torrent_flags::auto_managed);
+        m_torrentHandle.pause();
+    }
 
     m_state = state;
 }
+
+void NativeTorrentExtension::tick()
+{
+    if (!m_peerStats)
+        return;
+
+    const lt::clock_type::time_point now = lt::clock_type::now();
+    const lt::clock_type::duration interval = now - std::exchange(m_lastTickTime, now);
+
+    std::erase_if(m_peers, [](const std::weak_ptr<NativePeerExtension> &peer)
+    {
+        const std::shared_ptr<NativePeerExtension> peerExtension = peer.lock();
+        return !peerExtension || !peerExtension->isConnected();
+    });
+
+    // most of the torrents don't have any peers, there's nothing to publish for them
+    if (m_peers.empty() && m_isPublishedSnapshotEmpty)
+        return;
+
+    auto snapshot = std::make_shared<PeerStatsSnapshot>();
+    snapshot->peers.reserve(m_peers.size());
+    for (const std::weak_ptr<NativePeerExtension> &peer : m_peers)
+    {
+        const std::shared_ptr<NativePeerExtension> peerExtension = peer.lock();
+        peerExtension->updateRates(interval);
+
+        const PeerStats &stats = snapshot->peers.emplace_back(peerExtension->stats());
+        if (stats.isSeed)
+            ++snapshot->seedsCount;
+        if (stats.isInterested)
+            ++snapshot->interestedCount;
+        snapshot->uploadedPayload += stats.uploadedPayload;
+        snapshot->downloadedPayload += stats.downloadedPayload;
+        snapshot->uploadPayloadRate += stats.uploadPayloadRate;
+        snapshot->downloadPayloadRate += stats.downloadPayloadRate;
+        snapshot->hashFailures += stats.hashFailures;
+    }
+
+    m_isPublishedSnapshotEmpty = snapshot->peers.empty();
+    m_peerStats->publish(std::move(snapshot));
+}
@@ -28,21 +28,41 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <libtorrent/extensions.hpp>
+#include <libtorrent/time.hpp>
 #include <libtorrent/torrent_handle.hpp>
 
 #include "extensiondata.h"
 
+class NativePeerExtension;
+
 class NativeTorrentExtension final : public lt::torrent_plugin
 {
 public:
     NativeTorrentExtension(const lt::torrent_handle &torrentHandle, ExtensionData *data);
     ~NativeTorrentExtension();
 
+    // when enabled, torrents are held before checking their files until the session starts the check
+    static void setCheckingScheduled(bool enabled);
+
 private:
+    std::shared_ptr<lt::peer_plugin> new_connection(const lt::peer_connection_handle &peerConnection) override;
     void on_state(lt::torrent_status::state_t state) override;
+    void tick() override;
 
     lt::torrent_handle m_torrentHandle;
     lt::torrent_status::state_t m_state = lt::torrent_status::checking_resume_data;
     ExtensionData *m_data = nullptr;
+
+    // peers are only accessed in the network thread, their stats are published to `m_peerStats`
+    std::shared_ptr<PeerStatsHolder> m_peerStats;
+    std::vector<std::weak_ptr<NativePeerExtension>> m_peers;
+    lt::clock_type::time_point m_lastTickTime;
+    bool m_isPublishedSnapshotEmpty = true;
+
+    static std::atomic_bool m_isCheckingScheduled;
 };
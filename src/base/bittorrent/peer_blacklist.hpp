@@ -1,116 +1,191 @@
 #pragma once
 
-#include <regex>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
 
-#include <libtorrent/torrent_info.hpp>
+#include <libtorrent/peer_info.hpp>
 
 #include <QHostAddress>
 
 #include "base/net/geoipmanager.h"
 
-#include "peer_filter_plugin.hpp"
-#include "peer_logger.hpp"
+namespace {
 
-// bad peer filter
-bool is_bad_peer(const lt::peer_info& info)
+bool is_ascii_digit(char c)
 {
-  static const std::regex id_filter("-(XL|SD|XF|QD|BN|DL|TS|DT|HP)(\\d+)-");
-  static const std::regex ua_filter(R"((\d+.\d+.\d+.\d+|cacao_torrent))");
-  static const std::regex consume_filter(R"(((dt|hp|xm)/torrent|Gopeed dev|Rain 0.0.0|(Taipei-torrent( dev)?)))", std::regex_constants::icase);
-
-  // TODO: trafficConsume by thank243(senis) but it's hard to determine GT0003 is legitimate client or not...
-  // Anyway, block dt/torrent and Taipei-torrent with specific case first.
-  QString country = Net::GeoIPManager::instance()->lookup(QHostAddress(info.ip.data()));
-  if (country == QLatin1String("CN") && std::regex_match(info.client, consume_filter)) {
-      return true;
-  }
+  return c >= '0' && c <= '9';
+}
 
-  return std::regex_match(info.pid.data(), info.pid.data() + 8, id_filter) || std::regex_match(info.client, ua_filter);
+bool is_word_char(char c)
+{
+  return is_ascii_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
 }
 
-// Unknown Peer filter
-bool is_unknown_peer(const lt::peer_info& info)
+char to_ascii_lower(char c)
 {
-  QString country = Net::GeoIPManager::instance()->lookup(QHostAddress(info.ip.data()));
-  return info.client.find("Unknown") != std::string::npos && country == QLatin1String("CN");
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
 }
 
-// Offline Downloader filter
-bool is_offline_downloader(const lt::peer_info& info)
+bool contains(std::string_view str, std::string_view needle)
 {
-  static const std::regex id_filter("-LT(1220|2070)-");
-  unsigned short port = info.ip.port();
-  QString country = Net::GeoIPManager::instance()->lookup(QHostAddress(info.ip.data()));
-  // 115: Old data, may out of date.
-  bool fake_transmission = port >= 65000 && country == QLatin1String("CN") && info.client.find("Transmission") != std::string::npos;
-  // PikPak: PikPak is renting Worldstream server and announce as LT1220/LT2070, the best way is block the ip range via ip filter(?)
-  // Xunlei: it seems Xunlei is using LT2070 too
-  bool fake_libtorrent = (country == QLatin1String("NL") || country == QLatin1String("CN")) && std::regex_match(info.pid.data(), info.pid.data() + 8, id_filter);
-  return fake_transmission || fake_libtorrent;
+  return str.find(needle) != std::string_view::npos;
 }
 
-// BitTorrent Media Player Peer filter
-bool is_bittorrent_media_player(const lt::peer_info& info)
+// case insensitive match of the whole string, '?' in pattern matches any character
+bool wildcard_match_icase(std::string_view str, std::string_view pattern)
 {
-  if (info.client.find("StellarPlayer") != std::string::npos || info.client.find("Elementum") != std::string::npos) {
-    return true;
+  if (str.size() != pattern.size())
+    return false;
+
+  for (std::size_t i = 0; i < str.size(); ++i) {
+    if (pattern[i] != '?' && to_ascii_lower(str[i]) != pattern[i])
+      return false;
   }
-  static const std::regex player_filter("-(UW\\w{4}|SP(([0-2]\\d{3})|(3[0-5]\\d{2})))-");
-  return !!std::regex_match(info.pid.data(), info.pid.data() + 8, player_filter);
+  return true;
 }
 
-
-// drop connection action
-void drop_connection(lt::peer_connection_handle ph)
+// equivalent of matching the whole string against `\d+(.\d+){groups - 1}`
+bool match_numeric_groups(std::string_view str, int groups)
 {
-  ph.disconnect(boost::asio::error::connection_refused, lt::operation_t::bittorrent, lt::disconnect_severity_t{0});
+  for (std::size_t i = 0; i < str.size() && is_ascii_digit(str[i]); ++i) {
+    const std::string_view rest = str.substr(i + 1);
+    if (groups == 1) {
+      if (rest.empty())
+        return true;
+      continue;
+    }
+    if (!rest.empty() && match_numeric_groups(rest.substr(1), groups - 1))
+      return true;
+  }
+  return false;
 }
 
+}
 
-template<typename F>
-auto wrap_filter(F filter, const std::string& tag)
+// Built-in peer rules compiled into a single matcher.
+// Azureus-style peer ids ('-' + 2 chars client code + 4 chars version + '-') are
+// dispatched via lookup table indexed by client code, so each peer id is only
+// inspected by the rules that can actually match it. Client name rules are plain
+// string checks, country is only looked up if some otherwise matching rule needs it.
+class builtin_peer_rules
 {
-  return [=](const lt::peer_info& info, bool handshake, bool* stop_filtering) {
-    bool matched = filter(info);
-    *stop_filtering = !handshake && !matched;
-    if (matched)
-      peer_logger_singleton::instance().log_peer(info, tag);
-    return matched;
+public:
+  struct options
+  {
+    bool unknown_peers = false;
+    bool offline_downloaders = false;
+    bool media_players = false;
   };
-}
 
+  explicit builtin_peer_rules(const options& opts)
+    : m_options(opts)
+  {
+  }
 
-std::shared_ptr<lt::torrent_plugin> create_peer_action_plugin(
-    const lt::torrent_handle& th,
-    filter_function filter,
-    action_function action)
-{
-  // ignore private torrents
-  if (th.torrent_file() && th.torrent_file()->priv())
-    return nullptr;
+  // returns tag of the first matching rule or nullptr if none of the rules match
+  const char* match(const lt::peer_info& info) const
+  {
+    quint16 country = 0;
+    bool country_resolved = false;
+    const auto peer_country = [&]() {
+      if (!country_resolved) {
+        country = Net::GeoIPManager::instance()->lookupCountryCode(QHostAddress(info.ip.data()));
+        country_resolved = true;
+      }
+      return country;
+    };
+
+    const std::string_view pid(info.pid.data(), 8);
+    const std::string_view client(info.client);
+    const bool is_azureus_pid = (pid[0] == '-') && (pid[7] == '-');
+    const std::uint8_t pid_rules = is_azureus_pid ? code_table()[code_index(pid[1], pid[2])] : 0;
+    const std::string_view version = pid.substr(3, 4);
+
+    // bad peer
+    if ((pid_rules & BadPeerCode) && std::all_of(version.begin(), version.end(), is_ascii_digit))
+      return "bad peer";
+    if (match_numeric_groups(client, 4) || (client == "cacao_torrent"))
+      return "bad peer";
+    // TODO: trafficConsume by thank243(senis) but it's hard to determine GT0003 is legitimate client or not...
+    // Anyway, block dt/torrent and Taipei-torrent with specific case first.
+    if (is_traffic_consumer(client) && (peer_country() == CN))
+      return "bad peer";
+
+    // Unknown peer
+    if (m_options.unknown_peers && contains(client, "Unknown") && (peer_country() == CN))
+      return "unknown peer";
+
+    // Offline downloader
+    if (m_options.offline_downloaders) {
+      // 115: Old data, may out of date.
+      if ((info.ip.port() >= 65000) && contains(client, "Transmission") && (peer_country() == CN))
+        return "offline downloader";
+      // PikPak: PikPak is renting Worldstream server and announce as LT1220/LT2070, the best way is block the ip range via ip filter(?)
+      // Xunlei: it seems Xunlei is using LT2070 too
+      if ((pid_rules & OfflineDownloaderCode) && ((version == "1220") || (version == "2070"))) {
+        const quint16 c = peer_country();
+        if ((c == NL) || (c == CN))
+          return "offline downloader";
+      }
+    }
+
+    // BitTorrent media player
+    if (m_options.media_players) {
+      if (contains(client, "StellarPlayer") || contains(client, "Elementum"))
+        return "bittorrent media player";
+      if ((pid_rules & MediaPlayerWordCode) && std::all_of(version.begin(), version.end(), is_word_char))
+        return "bittorrent media player";
+      // SP0000-SP3599
+      if ((pid_rules & MediaPlayerNumericCode) && std::all_of(version.begin(), version.end(), is_ascii_digit)
+          && ((version[0] < '3') || ((version[0] == '3') && (version[1] <= '5'))))
+        return "bittorrent media player";
+    }
 
-  return std::make_shared<peer_action_plugin>(std::move(filter), std::move(action));
-}
+    return nullptr;
+  }
 
+private:
+  static constexpr quint16 CN = Net::GeoIPManager::countryCode("CN");
+  static constexpr quint16 NL = Net::GeoIPManager::countryCode("NL");
 
-// plugins factory functions
+  enum code_rule : std::uint8_t
+  {
+    BadPeerCode = 1,
+    OfflineDownloaderCode = 2,
+    MediaPlayerWordCode = 4,
+    MediaPlayerNumericCode = 8
+  };
 
-std::shared_ptr<lt::torrent_plugin> create_drop_bad_peers_plugin(lt::torrent_handle const& th, client_data)
-{
-  return create_peer_action_plugin(th, wrap_filter(is_bad_peer, "bad peer"), drop_connection);
-}
+  static std::size_t code_index(char c1, char c2)
+  {
+    return (static_cast<std::size_t>(static_cast<unsigned char>(c1)) << 8) | static_cast<unsigned char>(c2);
+  }
 
-std::shared_ptr<lt::torrent_plugin> create_drop_unknown_peers_plugin(lt::torrent_handle const& th, client_data)
-{
-  return create_peer_action_plugin(th, wrap_filter(is_unknown_peer, "unknown peer"), drop_connection);
-}
+  static const std::array<std::uint8_t, 65536>& code_table()
+  {
+    static const std::array<std::uint8_t, 65536> table = [] {
+      std::array<std::uint8_t, 65536> t {};
+      for (const char* code : {"XL", "SD", "XF", "QD", "BN", "DL", "TS", "DT", "HP"})
+        t[code_index(code[0], code[1])] |= BadPeerCode;
+      t[code_index('L', 'T')] |= OfflineDownloaderCode;
+      t[code_index('U', 'W')] |= MediaPlayerWordCode;
+      t[code_index('S', 'P')] |= MediaPlayerNumericCode;
+      return t;
+    }();
+    return table;
+  }
 
-std::shared_ptr<lt::torrent_plugin> create_drop_offline_downloader_plugin(lt::torrent_handle const& th, client_data)
-{
-  return create_peer_action_plugin(th, wrap_filter(is_offline_downloader, "offline downloader"), drop_connection);
-}
+  static bool is_traffic_consumer(std::string_view client)
+  {
+    static const std::string_view patterns[] = {
+      "dt/torrent", "hp/torrent", "xm/torrent", "gopeed dev", "rain 0?0?0", "taipei-torrent", "taipei-torrent dev"
+    };
+    return std::any_of(std::begin(patterns), std::end(patterns)
+                       , [client](std::string_view pattern) { return wildcard_match_icase(client, pattern); });
+  }
 
-std::shared_ptr<lt::torrent_plugin> create_drop_bittorrent_media_player_plugin(lt::torrent_handle const& th, client_data)
-{
-  return create_peer_action_plugin(th, wrap_filter(is_bittorrent_media_player, "bittorrent media player"), drop_connection);
-}
+  options m_options;
+};
@@ -21,6 +21,36 @@ bool qregex_has_match(const QRegularExpression& re, const QString& str)
   return m.hasMatch();
 }
 
+// Returns literal text any match of the pattern must contain, if it is easy to tell.
+// Only the leading literal run of simple patterns (no alternation, no inline options)
+// is considered, anchors are not taken into account.
+QString required_literal(const QString& pattern)
+{
+  if (pattern.contains(u'|'))
+    return {};
+
+  const QStringView meta = u"\\^$.|?*+()[]{}";
+  const qsizetype start = pattern.startsWith(u'^') ? 1 : 0;
+  qsizetype end = start;
+  while ((end < pattern.size()) && !meta.contains(pattern[end]))
+    ++end;
+
+  // the last literal char is optional if it is followed by a quantifier
+  if ((end < pattern.size()) && (end > start)
+      && ((pattern[end] == u'?') || (pattern[end] == u'*') || (pattern[end] == u'{')))
+    --end;
+
+  return pattern.mid(start, end - start);
+}
+
+struct peer_filter_rule
+{
+  QRegularExpression peer_id_re;
+  QRegularExpression client_re;
+  // cheap prefilter for peer id expression, empty if there is none
+  QString peer_id_literal;
+};
+
 }
 
 class peer_filter
@@ -45,19 +75,33 @@ public:
       if (!client_re.isValid())
         LogMsg(msg_tmpl.arg(log_tag).arg(u"client name"_s).arg(client_re.pattern()).arg(line), Log::WARNING);
 
-      if (peer_id_re.isValid() && client_re.isValid())
-        m_filters.append({peer_id_re, client_re});
+      if (peer_id_re.isValid() && client_re.isValid()) {
+        // rules are applied on network thread for every new peer, so compile them upfront
+        peer_id_re.optimize();
+        client_re.optimize();
+        m_filters.append({peer_id_re, client_re, required_literal(peer_id_re.pattern())});
+      }
     }
   }
 
   bool match_peer(const lt::peer_info& info, bool skip_name) const
   {
-    QString peer_id = QString::fromLatin1(info.pid.data(), 8);
-    QString client = QString::fromStdString(info.client);
+    const QString peer_id = QString::fromLatin1(info.pid.data(), 8);
+    QString client;
+    bool client_converted = false;
     return std::any_of(m_filters.begin(), m_filters.end(),
-                       [&](const auto& filter) {
-                           return qregex_has_match(filter[0], peer_id) &&
-                               (skip_name || qregex_has_match(filter[1], client));
+                       [&](const peer_filter_rule& filter) {
+                           if (!filter.peer_id_literal.isEmpty() && !peer_id.contains(filter.peer_id_literal))
+                             return false;
+                           if (!qregex_has_match(filter.peer_id_re, peer_id))
+                             return false;
+                           if (skip_name)
+                             return true;
+                           if (!client_converted) {
+                             client = QString::fromStdString(info.client);
+                             client_converted = true;
+                           }
+                           return qregex_has_match(filter.client_re, client);
                        });
   }
 
@@ -65,5 +109,5 @@ public:
   int rules_count() const { return m_filters.size(); }
 
 private:
-  QVector<QVector<QRegularExpression>> m_filters;
+  QVector<peer_filter_rule> m_filters;
 };
@@ -1,11 +1,28 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <libtorrent/peer_info.hpp>
 
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSqlDatabase>
 #include <QSqlQuery>
-
+#include <QSqlRecord>
+#include <QStringList>
+#include <QThread>
 #include <QVariant>
+#include <QWaitCondition>
+
+#include "peerreputationtable.h"
 
 
 class db_connection
@@ -19,27 +36,68 @@ public:
 
   void init(const QString& db_path)
   {
-    m_db.setDatabaseName(db_path);
-    m_db.open();
+    m_db_path = db_path;
   }
 
-  QSqlDatabase connection() const
+  QString path() const
   {
-    return m_db;
+    return m_db_path;
   }
 
 protected:
-  db_connection()
-    : m_db(QSqlDatabase::addDatabase(u"QSQLITE"_s))
-  {}
+  db_connection() = default;
+
+private:
+  QString m_db_path;
+};
 
-  ~db_connection()
+
+struct peer_log_entry
+{
+  lt::address ip;
+  std::string client;
+  std::string pid;
+  std::string tag;
+  peer_log_entry* next = nullptr;
+};
+
+
+// Lock-free multiple producers single consumer queue.
+// Producers push entries onto intrusive stack, consumer takes the whole stack at once
+// and restores the order entries were pushed in.
+class peer_log_queue
+{
+public:
+  ~peer_log_queue()
+  {
+    take_all();
+  }
+
+  void push(std::unique_ptr<peer_log_entry> entry)
   {
-    m_db.close();
+    peer_log_entry* head = m_head.load(std::memory_order_relaxed);
+    do {
+      entry->next = head;
+    } while (!m_head.compare_exchange_weak(head, entry.get(), std::memory_order_release, std::memory_order_relaxed));
+    entry.release();
+  }
+
+  std::vector<std::unique_ptr<peer_log_entry>> take_all()
+  {
+    peer_log_entry* head = m_head.exchange(nullptr, std::memory_order_acquire);
+
+    std::vector<std::unique_ptr<peer_log_entry>> entries;
+    while (head) {
+      peer_log_entry* next = head->next;
+      entries.emplace_back(head);
+      head = next;
+    }
+    std::reverse(entries.begin(), entries.end());
+    return entries;
   }
 
 private:
-  QSqlDatabase m_db;
+  std::atomic<peer_log_entry*> m_head {nullptr};
 };
 
 
@@ -51,25 +109,93 @@ public:
     , m_table(table)
   {
     if (!db.tables().contains(table)) {
-      db.exec(u"CREATE TABLE '%1' ("
-              u"    'id'      INTEGER PRIMARY KEY,"
-              u"    'ip'      TEXT NOT NULL UNIQUE,"
-              u"    'client'  TEXT NOT NULL,"
-              u"    'pid'     BLOB NOT NULL,"
-              u"    'tag'     TEXT"
-              u");"_s.arg(table));
-      db.commit();
+      QSqlQuery(db).exec(u"CREATE TABLE '%1' ("
+                         u"    'id'      INTEGER PRIMARY KEY,"
+                         u"    'ip'      TEXT NOT NULL UNIQUE,"
+                         u"    'client'  TEXT NOT NULL,"
+                         u"    'pid'     BLOB NOT NULL,"
+                         u"    'tag'     TEXT,"
+                         u"    'hits'    INTEGER NOT NULL DEFAULT 1,"
+                         u"    'updated' INTEGER NOT NULL DEFAULT 0"
+                         u");"_s.arg(table));
+    } else {
+      // table created by older version
+      const QSqlRecord record = db.record(table);
+      if (!record.contains(u"hits"_s))
+        QSqlQuery(db).exec(u"ALTER TABLE '%1' ADD COLUMN 'hits' INTEGER NOT NULL DEFAULT 1;"_s.arg(table));
+      if (!record.contains(u"updated"_s)) {
+        // ban time of the existing rows is unknown, retention period starts from now for them
+        QSqlQuery(db).exec(u"ALTER TABLE '%1' ADD COLUMN 'updated' INTEGER NOT NULL DEFAULT 0;"_s.arg(table));
+        QSqlQuery(db).exec(u"UPDATE '%1' SET updated = strftime('%s', 'now');"_s.arg(table));
+      }
     }
+
+    // history is browsed from the most recent ban, optionally filtered by tag or client
+    QSqlQuery(db).exec(u"CREATE INDEX IF NOT EXISTS '%1_updated' ON '%1' (updated);"_s.arg(table));
+    QSqlQuery(db).exec(u"CREATE INDEX IF NOT EXISTS '%1_tag' ON '%1' (tag, updated);"_s.arg(table));
+    QSqlQuery(db).exec(u"CREATE INDEX IF NOT EXISTS '%1_client' ON '%1' (client, updated);"_s.arg(table));
   }
 
-  bool log_peer(const lt::peer_info& info, const std::string& tag = {})
+  // writes all the entries in single transaction, repeated offenders only increase their hit counter
+  bool log_peers(const std::vector<std::unique_ptr<peer_log_entry>>& entries)
+  {
+    if (entries.empty())
+      return true;
+
+    struct row
+    {
+      const peer_log_entry* entry;
+      int hits;
+    };
+
+    // coalesce entries for the same address, the latest one wins
+    std::vector<row> rows;
+    QHash<QString, std::size_t> row_indexes;
+    QStringList ips;
+    for (const auto& entry : entries) {
+      const QString ip = QString::fromStdString(entry->ip.to_string());
+      const auto it = row_indexes.constFind(ip);
+      if (it != row_indexes.cend()) {
+        rows[*it].entry = entry.get();
+        ++rows[*it].hits;
+      } else {
+        row_indexes.insert(ip, rows.size());
+        rows.push_back({entry.get(), 1});
+        ips.append(ip);
+      }
+    }
+
+    if (!m_db.transaction())
+      return false;
+
+    QSqlQuery q(m_db);
+    q.prepare(u"INSERT INTO '%1' (ip, client, pid, tag, hits, updated) VALUES (?, ?, ?, ?, ?, ?)"
+              u" ON CONFLICT(ip) DO UPDATE SET client = excluded.client, pid = excluded.pid,"
+              u" tag = excluded.tag, hits = hits + excluded.hits, updated = excluded.updated"_s.arg(m_table));
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      const peer_log_entry* entry = rows[i].entry;
+      q.addBindValue(ips[static_cast<qsizetype>(i)]);
+      q.addBindValue(QString::fromStdString(entry->client));
+      q.addBindValue(QString::fromLatin1(entry->pid.data(), static_cast<qsizetype>(entry->pid.size())));
+      q.addBindValue(QString::fromStdString(entry->tag));
+      q.addBindValue(rows[i].hits);
+      q.addBindValue(now);
+      if (!q.exec()) {
+        m_db.rollback();
+        return false;
+      }
+    }
+
+    return m_db.commit();
+  }
+
+  // removes peers that weren't banned again for longer than retention period
+  bool purge(std::chrono::seconds retention)
   {
     QSqlQuery q(m_db);
-    q.prepare(u"INSERT INTO '%1' (ip, client, pid, tag) VALUES (?, ?, ?, ?)"_s.arg(m_table));
-    q.addBindValue(QString::fromStdString(info.ip.address().to_string()));
-    q.addBindValue(QString::fromStdString(info.client));
-    q.addBindValue(QString::fromLatin1(info.pid.data(), 8));
-    q.addBindValue(QString::fromStdString(tag));
+    q.prepare(u"DELETE FROM '%1' WHERE updated < ?"_s.arg(m_table));
+    q.addBindValue(QDateTime::currentSecsSinceEpoch() - static_cast<qint64>(retention.count()));
     return q.exec();
   }
 
@@ -79,6 +205,74 @@ private:
 };
 
 
+// Keeps peer reputation between restarts, the whole table is rewritten on each save
+class peer_reputation_storage
+{
+public:
+  explicit peer_reputation_storage(QSqlDatabase db)
+    : m_db(db)
+  {
+    QSqlQuery(db).exec(u"CREATE TABLE IF NOT EXISTS 'peer_reputation' ("
+                       u"    'ip'      TEXT NOT NULL,"
+                       u"    'pid'     BLOB NOT NULL,"
+                       u"    'score'   REAL NOT NULL,"
+                       u"    'updated' INTEGER NOT NULL,"
+                       u"    PRIMARY KEY (ip, pid)"
+                       u");"_s);
+  }
+
+  QList<BitTorrent::PeerReputationTable::Entry> load()
+  {
+    QList<BitTorrent::PeerReputationTable::Entry> entries;
+
+    QSqlQuery q(m_db);
+    if (!q.exec(u"SELECT ip, pid, score, updated FROM 'peer_reputation'"_s))
+      return entries;
+
+    while (q.next()) {
+      lt::error_code ec;
+      const lt::address ip = lt::make_address(q.value(0).toString().toStdString(), ec);
+      if (ec)
+        continue;
+
+      const std::chrono::seconds updated {q.value(3).toLongLong()};
+      entries.append({ip, q.value(1).toByteArray(), q.value(2).toDouble()
+                      , BitTorrent::PeerReputationTable::Clock::time_point(updated)});
+    }
+    return entries;
+  }
+
+  bool store(const QList<BitTorrent::PeerReputationTable::Entry>& entries)
+  {
+    if (!m_db.transaction())
+      return false;
+
+    QSqlQuery(m_db).exec(u"DELETE FROM 'peer_reputation'"_s);
+
+    QSqlQuery q(m_db);
+    q.prepare(u"INSERT INTO 'peer_reputation' (ip, pid, score, updated) VALUES (?, ?, ?, ?)"_s);
+    for (const auto& entry : entries) {
+      q.addBindValue(QString::fromStdString(entry.address.to_string()));
+      q.addBindValue(entry.peerIDPrefix);
+      q.addBindValue(entry.score);
+      q.addBindValue(static_cast<qlonglong>(std::chrono::duration_cast<std::chrono::seconds>(entry.updateTime.time_since_epoch()).count()));
+      if (!q.exec()) {
+        m_db.rollback();
+        return false;
+      }
+    }
+
+    return m_db.commit();
+  }
+
+private:
+  QSqlDatabase m_db;
+};
+
+
+// Peers are logged from libtorrent network thread, so logging is only allowed to queue
+// entries. Dedicated thread owns database connection and periodically flushes queued
+// entries in batches.
 class peer_logger_singleton
 {
 public:
@@ -90,14 +284,115 @@ public:
 
   void log_peer(const lt::peer_info& info, const std::string& tag)
   {
-    m_logger.log_peer(info, tag);
+    if (m_stopped.load(std::memory_order_relaxed))
+      return;
+
+    auto entry = std::make_unique<peer_log_entry>();
+    entry->ip = info.ip.address();
+    entry->client = info.client;
+    entry->pid.assign(info.pid.data(), 8);
+    entry->tag = tag;
+    m_queue.push(std::move(entry));
+  }
+
+  // zero keeps the history forever
+  void set_retention_days(int days)
+  {
+    m_retention_days.store(days, std::memory_order_relaxed);
+  }
+
+  void start()
+  {
+    if (m_thread)
+      return;
+
+    m_thread.reset(QThread::create([this] { run(); }));
+    m_thread->start();
+  }
+
+  // flushes pending entries and stops logger thread
+  void stop()
+  {
+    if (!m_thread || m_stopped.exchange(true))
+      return;
+
+    {
+      const QMutexLocker locker {&m_mutex};
+      m_stopping = true;
+    }
+    m_wake.wakeAll();
+
+    m_thread->wait();
   }
 
 protected:
-  peer_logger_singleton()
-    : m_logger(db_connection::instance().connection(), QStringLiteral("banned_peers"))
-  {}
+  peer_logger_singleton() = default;
+
+  ~peer_logger_singleton()
+  {
+    stop();
+  }
 
 private:
-  peer_logger m_logger;
+  void run()
+  {
+    const QString connection_name = u"peer_logger"_s;
+    {
+      QSqlDatabase db = QSqlDatabase::addDatabase(u"QSQLITE"_s, connection_name);
+      db.setDatabaseName(db_connection::instance().path());
+      std::unique_ptr<peer_logger> logger;
+      std::unique_ptr<peer_reputation_storage> reputation_storage;
+      if (db.open()) {
+        QSqlQuery(db).exec(u"PRAGMA journal_mode = WAL;"_s);
+        QSqlQuery(db).exec(u"PRAGMA synchronous = NORMAL;"_s);
+        logger = std::make_unique<peer_logger>(db, u"banned_peers"_s);
+        reputation_storage = std::make_unique<peer_reputation_storage>(db);
+        BitTorrent::PeerReputationTable::instance().load(reputation_storage->load());
+      }
+
+      QDeadlineTimer save_reputation_timer {REPUTATION_SAVE_INTERVAL};
+      QDeadlineTimer purge_timer {0};
+      bool stopping = false;
+      while (!stopping) {
+        {
+          QMutexLocker locker {&m_mutex};
+          if (!m_stopping)
+            m_wake.wait(&m_mutex, QDeadlineTimer(FLUSH_INTERVAL));
+          stopping = m_stopping;
+        }
+
+        const auto entries = m_queue.take_all();
+        if (logger)
+          logger->log_peers(entries);
+
+        if (logger && !stopping && purge_timer.hasExpired()) {
+          if (const int days = m_retention_days.load(std::memory_order_relaxed); days > 0)
+            logger->purge(std::chrono::hours(24 * days));
+          purge_timer.setRemainingTime(PURGE_INTERVAL);
+        }
+
+        if (reputation_storage && (stopping || save_reputation_timer.hasExpired())) {
+          reputation_storage->store(BitTorrent::PeerReputationTable::instance().entries());
+          save_reputation_timer.setRemainingTime(REPUTATION_SAVE_INTERVAL);
+        }
+      }
+
+      db.close();
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+  }
+
+  static constexpr std::chrono::milliseconds FLUSH_INTERVAL {1000};
+  static constexpr std::chrono::minutes REPUTATION_SAVE_INTERVAL {5};
+  static constexpr std::chrono::hours PURGE_INTERVAL {1};
+
+  peer_log_queue m_queue;
+  std::atomic_bool m_stopped {false};
+  std::atomic_int m_retention_days {0};
+
+  QMutex m_mutex;
+  QWaitCondition m_wake;
+  bool m_stopping = false;
+
+  std::unique_ptr<QThread> m_thread;
 };
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <libtorrent/extensions.hpp>
+#include <libtorrent/peer_connection_handle.hpp>
+#include <libtorrent/peer_info.hpp>
+#include <libtorrent/torrent_handle.hpp>
+#include <libtorrent/torrent_info.hpp>
+
+#include <QFile>
+
+#include "base/atomicsnapshot.h"
+#include "base/logger.h"
+#include "base/path.h"
+#include "base/profile.h"
+#include "base/tracing.h"
+
+#include "peer_blacklist.hpp"
+#include "peer_filter.hpp"
+#include "peer_logger.hpp"
+#include "peerreputationtable.h"
+#include "shadowbantable.h"
+
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+using client_data = lt::client_data_t;
+#else
+using client_data = void*;
+#endif
+
+// filter factory function
+std::unique_ptr<peer_filter> create_peer_filter(const QString& filename)
+{
+  Path qbt_data_dir = specialFolderLocation(SpecialFolder::Data) / Path(filename);
+
+  QString filter_file = qbt_data_dir.toString();
+  // do not create plugin if filter file doesn't exists
+  if (!QFile::exists(filter_file)) {
+    LogMsg(u"'%1' doesn't exist. The corresponding filter is disabled."_s.arg(filename), Log::NORMAL);
+
+    return nullptr;
+  }
+
+  auto filter = std::make_unique<peer_filter>(filter_file);
+  if (filter->is_empty()) {
+    LogMsg(u"'%1' has no valid rules. The corresponding filter is disabled."_s.arg(filename), Log::WARNING);
+    filter.reset();
+  } else {
+    LogMsg(u"'%1' contains %2 valid rules."_s.arg(filename).arg(filter->rules_count()), Log::INFO);
+  }
+
+  return filter;
+}
+
+
+struct peer_filter_set
+{
+  std::unique_ptr<peer_filter> blacklist;
+  std::unique_ptr<peer_filter> whitelist;
+};
+
+
+// All the peer policies of the session: user blacklist and whitelist, built-in rules
+// and shadowban. Compiled once and shared by all torrents and connections.
+// User filters can be reloaded at any time, new rules are published via atomic
+// pointer swap and generation number tells connections to evaluate peer again.
+class peer_policy
+{
+public:
+  peer_policy(const builtin_peer_rules::options& builtin_options, bool shadowban)
+    : m_builtin_rules(builtin_options)
+    , m_shadowban(shadowban)
+  {
+    reload_filters();
+  }
+
+  // parses filter files and publishes the new rules, can be called from any thread
+  void reload_filters()
+  {
+    const std::lock_guard<std::mutex> lock(m_reload_mutex);
+
+    auto filters = std::make_shared<peer_filter_set>();
+    filters->blacklist = create_peer_filter(u"peer_blacklist.txt"_s);
+    filters->whitelist = create_peer_filter(u"peer_whitelist.txt"_s);
+    m_filters.store(std::move(filters));
+    // the recorded violations may be caused by the replaced rules
+    if (m_generation.fetch_add(1, std::memory_order_release) > 0)
+      BitTorrent::PeerReputationTable::instance().clear();
+  }
+
+  std::uint64_t generation() const { return m_generation.load(std::memory_order_acquire); }
+
+  bool is_shadowban_enabled() const { return m_shadowban; }
+
+  // returns tag of the first policy the peer violates or nullptr if there is none
+  const char* match(const lt::peer_info& info, bool handshake, bool* stop_filtering) const
+  {
+    const auto filters = m_filters.load();
+
+    // always match with both pid & client name when applying blacklist
+    if (filters->blacklist && filters->blacklist->match_peer(info, false)) {
+      *stop_filtering = true;
+      return "blacklist";
+    }
+
+    if (const char* tag = m_builtin_rules.match(info)) {
+      *stop_filtering = true;
+      return tag;
+    }
+
+    if (filters->whitelist && !filters->whitelist->match_peer(info, handshake)) {
+      *stop_filtering = true;
+      return "whitelist";
+    }
+
+    // if the peer got passed the handshake phase and get here, don't filter it anymore
+    *stop_filtering = !handshake;
+    return nullptr;
+  }
+
+private:
+  AtomicSnapshot<peer_filter_set> m_filters;
+  std::atomic<std::uint64_t> m_generation {0};
+  std::mutex m_reload_mutex;
+  builtin_peer_rules m_builtin_rules;
+  bool m_shadowban;
+};
+
+
+class peer_policy_plugin final : public lt::peer_plugin
+{
+public:
+  peer_policy_plugin(lt::peer_connection_handle p, std::shared_ptr<const peer_policy> policy)
+    : m_peer_connection(p)
+    , m_policy(std::move(policy))
+    , m_generation(m_policy->generation())
+  {}
+
+  bool on_handshake(lt::span<char const> d) override
+  {
+    handle_peer(true);
+    return peer_plugin::on_handshake(d);
+  }
+
+  bool on_extension_handshake(lt::bdecode_node const& d) override
+  {
+    handle_peer(true);
+    return peer_plugin::on_extension_handshake(d);
+  }
+
+  bool on_interested() override
+  {
+    handle_peer();
+    return peer_plugin::on_interested();
+  }
+
+  bool on_not_interested() override
+  {
+    handle_peer();
+    return peer_plugin::on_not_interested();
+  }
+
+  bool on_have(lt::piece_index_t p) override
+  {
+    handle_peer();
+    return peer_plugin::on_have(p);
+  }
+
+  bool on_dont_have(lt::piece_index_t p) override
+  {
+    handle_peer();
+    return peer_plugin::on_dont_have(p);
+  }
+
+  bool on_bitfield(lt::bitfield const& bitfield) override
+  {
+    handle_peer();
+    return peer_plugin::on_bitfield(bitfield);
+  }
+
+  bool on_have_all() override
+  {
+    handle_peer();
+    return peer_plugin::on_have_all();
+  }
+
+  bool on_have_none() override
+  {
+    handle_peer();
+    return peer_plugin::on_have_none();
+  }
+
+  bool on_request(lt::peer_request const& r) override
+  {
+    handle_peer();
+    // ignore requests of shadowbanned peer
+    if (is_shadowbanned_peer())
+      return true;
+    return peer_plugin::on_request(r);
+  }
+
+  // don't send request if peer shadowbanned to prevent use this function to leech
+  bool write_request(lt::peer_request const& r) override
+  {
+    if (is_shadowbanned_peer())
+      return true;
+    return peer_plugin::write_request(r);
+  }
+
+  // shadowbanned peer must never be unchoked, otherwise it occupies an upload slot
+  void sent_unchoke() override
+  {
+    if (is_shadowbanned_peer())
+      m_peer_connection.choke_this_peer();
+  }
+
+protected:
+  // The filters only depend on peer id, client name and port. Peer id is known once
+  // the handshake is received and client name may only change with extension handshake,
+  // so both handshakes are always evaluated and any other message only settles the verdict
+  // once and then reuses it while those fields stay the same.
+  void handle_peer(bool handshake = false)
+  {
+    QBT_TRACE_SCOPE("peer_policy_plugin::handle_peer");
+
+    if (const std::uint64_t generation = m_policy->generation(); generation != m_generation) {
+      // rules were reloaded, evaluate the peer again
+      m_generation = generation;
+      m_verdict_settled = false;
+      m_stop_filtering = false;
+    }
+
+    if (m_stop_filtering)
+      return;
+
+    if (!handshake && m_verdict_settled && !is_peer_changed()) {
+      if (m_matched)
+        drop_connection();
+      return;
+    }
+
+    auto& reputation = BitTorrent::PeerReputationTable::instance();
+
+    // peer that violated the policies recently (on any torrent) is refused right away
+    if (handshake && reputation.isBanned(m_peer_connection.remote().address(), m_peer_connection.pid())) {
+      m_matched = true;
+      m_stop_filtering = true;
+      drop_connection();
+      return;
+    }
+
+    lt::peer_info info;
+    m_peer_connection.get_peer_info(info);
+
+    m_pid = info.pid;
+    m_port = info.ip.port();
+    m_verdict_settled = !handshake;
+    const char* tag = m_policy->match(info, handshake, &m_stop_filtering);
+    m_matched = (tag != nullptr);
+    if (m_matched) {
+      reputation.addViolation(info.ip.address(), info.pid);
+      peer_logger_singleton::instance().log_peer(info, tag);
+      drop_connection();
+    }
+  }
+
+  bool is_peer_changed() const
+  {
+    return (m_peer_connection.pid() != m_pid) || (m_peer_connection.remote().port() != m_port);
+  }
+
+  // the verdict is cached per connection and only looked up again after the
+  // list of shadowbanned IPs is changed, so requests cost a single atomic load
+  bool is_shadowbanned_peer()
+  {
+    if (!m_policy->is_shadowban_enabled())
+      return false;
+
+    if (const std::uint64_t generation = BitTorrent::ShadowBanTable::generation(); generation != m_shadowban_generation) {
+      m_shadowban_generation = generation;
+      const auto table = BitTorrent::ShadowBanTable::current();
+      m_shadowbanned = !table->isEmpty() && table->contains(m_peer_connection.remote().address());
+    }
+
+    return m_shadowbanned;
+  }
+
+  void drop_connection()
+  {
+    m_peer_connection.disconnect(boost::asio::error::connection_refused, lt::operation_t::bittorrent, lt::disconnect_severity_t{0});
+  }
+
+private:
+  lt::peer_connection_handle m_peer_connection;
+  std::shared_ptr<const peer_policy> m_policy;
+  std::uint64_t m_generation;
+
+  lt::peer_id m_pid;
+  unsigned short m_port = 0;
+  bool m_verdict_settled = false;
+  bool m_matched = false;
+  bool m_stop_filtering = false;
+  std::uint64_t m_shadowban_generation = 0;
+  bool m_shadowbanned = false;
+};
+
+
+// Torrent plugin has no per torrent state, so single instance is shared by all torrents
+class peer_policy_torrent_plugin final : public lt::torrent_plugin
+{
+public:
+  explicit peer_policy_torrent_plugin(std::shared_ptr<const peer_policy> policy)
+    : m_policy(std::move(policy))
+  {}
+
+  std::shared_ptr<lt::peer_plugin> new_connection(lt::peer_connection_handle const& p) override
+  {
+    return std::make_shared<peer_policy_plugin>(p, m_policy);
+  }
+
+private:
+  std::shared_ptr<const peer_policy> m_policy;
+};
+
+
+class peer_policy_session_plugin final : public lt::plugin
+{
+public:
+  explicit peer_policy_session_plugin(std::shared_ptr<const peer_policy> policy)
+    : m_torrent_plugin(std::make_shared<peer_policy_torrent_plugin>(std::move(policy)))
+  {
+  }
+
+  std::shared_ptr<lt::torrent_plugin> new_torrent(const lt::torrent_handle& th, client_data) override
+  {
+    // ignore private torrents
+    if (th.torrent_file() && th.torrent_file()->priv())
+      return nullptr;
+
+    return m_torrent_plugin;
+  }
+
+private:
+  std::shared_ptr<peer_policy_torrent_plugin> m_torrent_plugin;
+};
@@ -30,19 +30,19 @@
 
 #include <QBitArray>
 
-#include "base/algorithm.h"
 #include "base/bittorrent/ltqbitarray.h"
 #include "base/net/geoipmanager.h"
-#include "base/settingvalue.h"
 #include "base/unicodestrings.h"
 #include "base/utils/bytearray.h"
 #include "peeraddress.h"
+#include "session.h"
+#include "shadowbantable.h"
 
 using namespace BitTorrent;
 
-PeerInfo::PeerInfo(const lt::peer_info &nativeInfo, const QBitArray &allPieces)
+PeerInfo::PeerInfo(const lt::peer_info &nativeInfo, const QBitArray &missingPieces, const int missingPiecesCount)
     : m_nativeInfo(nativeInfo)
-    , m_relevance(calcRelevance(allPieces))
+    , m_relevance(calcRelevance(missingPieces, missingPiecesCount))
 {
     determineFlags();
 }
@@ -121,15 +121,10 @@ bool PeerInfo::isSeed() const
 
 bool PeerInfo::isShadowBanned() const
 {
-    if (!CachedSettingValue<bool>(u"BitTorrent/Session/ShadowBan"_s, false))
-    {
+    if (!Session::instance()->isShadowBanEnabled())
         return false;
-    }
-    QString peer_ip = address().ip.toString();
-    QStringList shadowbannedIPs =
-        CachedSettingValue<QStringList>(u"State/ShadowBannedIPs"_s, QStringList(), Algorithm::sorted<QStringList>).get();
 
-    return shadowbannedIPs.contains(peer_ip);
+    return ShadowBanTable::current()->contains(m_nativeInfo.ip.address());
 }
 
 bool PeerInfo::optimisticUnchoke() const
@@ -286,15 +281,17 @@ QString PeerInfo::connectionType() const
         : u"Web"_s;
 }
 
-qreal PeerInfo::calcRelevance(const QBitArray &allPieces) const
+qreal PeerInfo::calcRelevance(const QBitArray &missingPieces, const int missingPiecesCount) const
 {
-    const int localMissing = allPieces.count(false);
-    if (localMissing <= 0)
+    if (missingPiecesCount <= 0)
         return 0;
 
     const QBitArray peerPieces = pieces();
-    const int remoteHaves = (peerPieces & (~allPieces)).count(true);
-    return static_cast<qreal>(remoteHaves) / localMissing;
+    if (peerPieces.size() != missingPieces.size())
+        return 0;
+
+    const int remoteHaves = (peerPieces & missingPieces).count(true);
+    return static_cast<qreal>(remoteHaves) / missingPiecesCount;
 }
 
 qreal PeerInfo::relevance() const
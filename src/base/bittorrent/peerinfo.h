@@ -44,7 +44,8 @@ namespace BitTorrent
 
     public:
         PeerInfo() = default;
-        PeerInfo(const lt::peer_info &nativeInfo, const QBitArray &allPieces);
+        // missingPieces are the pieces the torrent doesn't have yet, they are shared by all the peers of the torrent
+        PeerInfo(const lt::peer_info &nativeInfo, const QBitArray &missingPieces, int missingPiecesCount);
 
         bool fromDHT() const;
         bool fromPeX() const;
@@ -95,7 +96,7 @@ namespace BitTorrent
         int downloadingPieceIndex() const;
 
     private:
-        qreal calcRelevance(const QBitArray &allPieces) const;
+        qreal calcRelevance(const QBitArray &missingPieces, int missingPiecesCount) const;
         void determineFlags();
 
         lt::peer_info m_nativeInfo = {};
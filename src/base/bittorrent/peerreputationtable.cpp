@@ -0,0 +1,239 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "peerreputationtable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include <boost/asio/ip/address.hpp>
+
+#include <QHashFunctions>
+#include <QList>
+#include <QMutexLocker>
+
+#include "base/global.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    // collisions beyond this distance evict the entry with the lowest score
+    const qsizetype MAX_PROBES = 16;
+    const qreal BAN_THRESHOLD = 0.5;
+    // entries with lower score are as good as forgotten and aren't persisted
+    const qreal MIN_SCORE = 0.01;
+
+    qint64 toSecsSinceEpoch(const PeerReputationTable::Clock::time_point time)
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    }
+
+    qreal decayed(const qreal score, const qint64 elapsed)
+    {
+        if (elapsed <= 0)
+            return score;
+        return score * std::exp2(-static_cast<qreal>(elapsed) / PeerReputationTable::HALF_LIFE.count());
+    }
+
+    template <typename Prefix>
+    Prefix peerIDPrefix(const char *data, const qsizetype size)
+    {
+        Prefix prefix {};
+        std::memcpy(prefix.data(), data, std::min<std::size_t>(size, prefix.size()));
+        return prefix;
+    }
+}
+
+PeerReputationTable::PeerReputationTable(const int capacity)
+    : m_slots(std::bit_ceil(static_cast<std::size_t>(std::max(capacity, 1))))
+    , m_mask {m_slots.size() - 1}
+{
+}
+
+void PeerReputationTable::addViolation(const lt::address &address, const lt::peer_id &peerID, const Clock::time_point now)
+{
+    const qint64 nowSecs = toSecsSinceEpoch(now);
+
+    const QMutexLocker locker {&m_mutex};
+
+    Slot &slot = insertSlot(addressBytes(address), peerIDPrefix<PeerIDPrefix>(peerID.data(), peerID.size()), nowSecs);
+    slot.score = static_cast<float>(decayedScore(slot, nowSecs) + 1);
+    slot.updateTime = nowSecs;
+}
+
+qreal PeerReputationTable::score(const lt::address &address, const lt::peer_id &peerID, const Clock::time_point now) const
+{
+    const QMutexLocker locker {&m_mutex};
+
+    const qsizetype index = findSlot(addressBytes(address), peerIDPrefix<PeerIDPrefix>(peerID.data(), peerID.size()));
+    return (index >= 0) ? decayedScore(m_slots[index], toSecsSinceEpoch(now)) : 0;
+}
+
+bool PeerReputationTable::isBanned(const lt::address &address, const lt::peer_id &peerID, const Clock::time_point now) const
+{
+    return (score(address, peerID, now) >= BAN_THRESHOLD);
+}
+
+std::vector<lt::address> PeerReputationTable::bannedAddresses(const Clock::time_point now) const
+{
+    std::vector<lt::address> result;
+    for (const Entry &entry : asConst(entries(now)))
+    {
+        if (entry.score >= BAN_THRESHOLD)
+            result.push_back(entry.address);
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QList<PeerReputationTable::Entry> PeerReputationTable::entries(const Clock::time_point now) const
+{
+    const qint64 nowSecs = toSecsSinceEpoch(now);
+
+    const QMutexLocker locker {&m_mutex};
+
+    QList<Entry> result;
+    for (const Slot &slot : m_slots)
+    {
+        if (!slot.isUsed)
+            continue;
+
+        const qreal score = decayedScore(slot, nowSecs);
+        if (score < MIN_SCORE)
+            continue;
+
+        const lt::address_v6 addressV6 {slot.address};
+        const lt::address address = addressV6.is_v4_mapped()
+                ? lt::address(boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, addressV6))
+                : lt::address(addressV6);
+        result.append({address, QByteArray(slot.peerIDPrefix.data(), PEER_ID_PREFIX_SIZE)
+                , score, Clock::time_point(std::chrono::seconds(nowSecs))});
+    }
+    return result;
+}
+
+void PeerReputationTable::load(const QList<Entry> &entries)
+{
+    const QMutexLocker locker {&m_mutex};
+
+    for (const Entry &entry : entries)
+    {
+        const qint64 updateTime = toSecsSinceEpoch(entry.updateTime);
+        Slot &slot = insertSlot(addressBytes(entry.address)
+                , peerIDPrefix<PeerIDPrefix>(entry.peerIDPrefix.constData(), entry.peerIDPrefix.size()), updateTime);
+        // the peer may have been recorded already before the stored entries got loaded
+        const qint64 time = std::max(slot.updateTime, updateTime);
+        slot.score = static_cast<float>(decayedScore(slot, time) + decayed(entry.score, (time - updateTime)));
+        slot.updateTime = time;
+    }
+}
+
+void PeerReputationTable::clear()
+{
+    const QMutexLocker locker {&m_mutex};
+
+    std::fill(m_slots.begin(), m_slots.end(), Slot());
+}
+
+PeerReputationTable &PeerReputationTable::instance()
+{
+    static PeerReputationTable table;
+    return table;
+}
+
+PeerReputationTable::AddressBytes PeerReputationTable::addressBytes(const lt::address &address)
+{
+    // IPv4 addresses are stored as IPv4-mapped IPv6 ones, so both forms refer to the same peer
+    if (address.is_v4())
+        return boost::asio::ip::make_address_v6(boost::asio::ip::v4_mapped, address.to_v4()).to_bytes();
+    return address.to_v6().to_bytes();
+}
+
+qreal PeerReputationTable::decayedScore(const Slot &slot, const qint64 now)
+{
+    return decayed(slot.score, (now - slot.updateTime));
+}
+
+std::size_t PeerReputationTable::slotHash(const AddressBytes &address, const PeerIDPrefix &peerIDPrefix)
+{
+    std::array<char, (sizeof(AddressBytes) + sizeof(PeerIDPrefix))> key {};
+    std::memcpy(key.data(), address.data(), address.size());
+    std::memcpy((key.data() + address.size()), peerIDPrefix.data(), peerIDPrefix.size());
+    return qHashBits(key.data(), key.size());
+}
+
+qsizetype PeerReputationTable::findSlot(const AddressBytes &address, const PeerIDPrefix &peerIDPrefix) const
+{
+    const std::size_t hash = slotHash(address, peerIDPrefix);
+
+    for (qsizetype i = 0; i < MAX_PROBES; ++i)
+    {
+        const auto index = static_cast<qsizetype>((hash + i) & m_mask);
+        const Slot &slot = m_slots[index];
+        // entries are never removed one by one, so probing can stop at the first unused slot
+        if (!slot.isUsed)
+            return -1;
+        if ((slot.address == address) && (slot.peerIDPrefix == peerIDPrefix))
+            return index;
+    }
+    return -1;
+}
+
+PeerReputationTable::Slot &PeerReputationTable::insertSlot(const AddressBytes &address, const PeerIDPrefix &peerIDPrefix, const qint64 now)
+{
+    const std::size_t hash = slotHash(address, peerIDPrefix);
+
+    Slot *leastScoredSlot = nullptr;
+    qreal leastScore = 0;
+    for (qsizetype i = 0; i < MAX_PROBES; ++i)
+    {
+        Slot &slot = m_slots[(hash + i) & m_mask];
+        if (!slot.isUsed)
+        {
+            slot = {address, peerIDPrefix, 0, now, true};
+            return slot;
+        }
+
+        if ((slot.address == address) && (slot.peerIDPrefix == peerIDPrefix))
+            return slot;
+
+        if (const qreal score = decayedScore(slot, now); !leastScoredSlot || (score < leastScore))
+        {
+            leastScoredSlot = &slot;
+            leastScore = score;
+        }
+    }
+
+    *leastScoredSlot = {address, peerIDPrefix, 0, now, true};
+    return *leastScoredSlot;
+}
@@ -0,0 +1,106 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <libtorrent/address.hpp>
+#include <libtorrent/peer_id.hpp>
+
+#include <QtContainerFwd>
+#include <QByteArray>
+#include <QMutex>
+
+namespace BitTorrent
+{
+    // Session-wide reputation of peers shared by all torrents.
+    // Peers are identified by their address and client prefix of peer ID. Each recorded violation
+    // adds to the peer score, which halves every `HALF_LIFE`, and the peer is refused while its score
+    // stays above the ban threshold. Scores are kept in fixed size open addressing table,
+    // so it can be queried from libtorrent network thread on every handshake.
+    class PeerReputationTable
+    {
+        Q_DISABLE_COPY_MOVE(PeerReputationTable)
+
+    public:
+        using Clock = std::chrono::system_clock;
+
+        static constexpr int PEER_ID_PREFIX_SIZE = 8;
+        static constexpr std::chrono::seconds HALF_LIFE {std::chrono::hours(1)};
+
+        struct Entry
+        {
+            lt::address address;
+            QByteArray peerIDPrefix;
+            qreal score = 0;
+            Clock::time_point updateTime;
+        };
+
+        explicit PeerReputationTable(int capacity = 16384);
+
+        void addViolation(const lt::address &address, const lt::peer_id &peerID, Clock::time_point now = Clock::now());
+        qreal score(const lt::address &address, const lt::peer_id &peerID, Clock::time_point now = Clock::now()) const;
+        bool isBanned(const lt::address &address, const lt::peer_id &peerID, Clock::time_point now = Clock::now()) const;
+        // sorted addresses banned with any peer ID, to filter the peers whose ID isn't known yet
+        std::vector<lt::address> bannedAddresses(Clock::time_point now = Clock::now()) const;
+
+        // entries that aren't decayed yet, to be persisted
+        QList<Entry> entries(Clock::time_point now = Clock::now()) const;
+        void load(const QList<Entry> &entries);
+        void clear();
+
+        static PeerReputationTable &instance();
+
+    private:
+        using AddressBytes = std::array<unsigned char, 16>;
+        using PeerIDPrefix = std::array<char, PEER_ID_PREFIX_SIZE>;
+
+        struct Slot
+        {
+            AddressBytes address {};
+            PeerIDPrefix peerIDPrefix {};
+            float score = 0;
+            qint64 updateTime = 0;
+            bool isUsed = false;
+        };
+
+        static AddressBytes addressBytes(const lt::address &address);
+        static qreal decayedScore(const Slot &slot, qint64 now);
+        static std::size_t slotHash(const AddressBytes &address, const PeerIDPrefix &peerIDPrefix);
+
+        qsizetype findSlot(const AddressBytes &address, const PeerIDPrefix &peerIDPrefix) const;
+        Slot &insertSlot(const AddressBytes &address, const PeerIDPrefix &peerIDPrefix, qint64 now);
+
+        mutable QMutex m_mutex;
+        std::vector<Slot> m_slots;
+        std::size_t m_mask = 0;
+    };
+}
@@ -28,8 +28,11 @@
 
 #include "portforwarderimpl.h"
 
+#include <numeric>
 #include <utility>
 
+#include <QMetaObject>
+
 #include "base/bittorrent/sessionimpl.h"
 
 PortForwarderImpl::PortForwarderImpl(BitTorrent::SessionImpl *provider, QObject *parent)
@@ -65,13 +68,21 @@ void PortForwarderImpl::setEnabled(const bool enabled)
 
 void PortForwarderImpl::setPorts(const QString &profile, QSet<quint16> ports)
 {
-    const QSet<quint16> oldForwardedPorts = std::accumulate(m_portProfiles.cbegin(), m_portProfiles.cend(), QSet<quint16>());
+    if (ports.isEmpty())
+    {
+        if (m_portProfiles.remove(profile) == 0)
+            return;
+    }
+    else
+    {
+        QSet<quint16> &profilePorts = m_portProfiles[profile];
+        if (profilePorts == ports)
+            return;
 
-    m_portProfiles[profile] = std::move(ports);
-    const QSet<quint16> newForwardedPorts = std::accumulate(m_portProfiles.cbegin(), m_portProfiles.cend(), QSet<quint16>());
+        profilePorts = std::move(ports);
+    }
 
-    m_provider->removeMappedPorts(oldForwardedPorts - newForwardedPorts);
-    m_provider->addMappedPorts(newForwardedPorts - oldForwardedPorts);
+    scheduleMappedPortsUpdate();
 }
 
 void PortForwarderImpl::removePorts(const QString &profile)
@@ -82,11 +93,30 @@ void PortForwarderImpl::removePorts(const QString &profile)
 void PortForwarderImpl::start()
 {
     m_provider->enablePortMapping();
-    for (const QSet<quint16> &ports : asConst(m_portProfiles))
-        m_provider->addMappedPorts(ports);
+    m_provider->setMappedPorts(forwardedPorts());
 }
 
 void PortForwarderImpl::stop()
 {
     m_provider->disablePortMapping();
 }
+
+QSet<quint16> PortForwarderImpl::forwardedPorts() const
+{
+    return std::accumulate(m_portProfiles.cbegin(), m_portProfiles.cend(), QSet<quint16>());
+}
+
+void PortForwarderImpl::scheduleMappedPortsUpdate()
+{
+    // profiles are often changed one after another (e.g. when settings are applied),
+    // so all the changes made meanwhile are reconciled at once
+    if (m_isMappedPortsUpdateScheduled)
+        return;
+
+    m_isMappedPortsUpdateScheduled = true;
+    QMetaObject::invokeMethod(this, [this]
+    {
+        m_isMappedPortsUpdateScheduled = false;
+        m_provider->setMappedPorts(forwardedPorts());
+    }, Qt::QueuedConnection);
+}
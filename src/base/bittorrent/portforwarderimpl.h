@@ -57,9 +57,12 @@ public:
 private:
     void start();
     void stop();
+    QSet<quint16> forwardedPorts() const;
+    void scheduleMappedPortsUpdate();
 
     CachedSettingValue<bool> m_storeActive;
 
     BitTorrent::SessionImpl *const m_provider = nullptr;
     QHash<QString, QSet<quint16>> m_portProfiles;
+    bool m_isMappedPortsUpdateScheduled = false;
 };
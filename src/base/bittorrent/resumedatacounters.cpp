@@ -0,0 +1,98 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "resumedatacounters.h"
+
+#include <iterator>
+
+#include <libtorrent/add_torrent_params.hpp>
+#include <libtorrent/bdecode.hpp>
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/entry.hpp>
+
+namespace
+{
+    // the same keys are used by libtorrent resume data
+    const char KEY_TOTAL_UPLOADED[] = "total_uploaded";
+    const char KEY_TOTAL_DOWNLOADED[] = "total_downloaded";
+    const char KEY_ACTIVE_TIME[] = "active_time";
+    const char KEY_FINISHED_TIME[] = "finished_time";
+    const char KEY_SEEDING_TIME[] = "seeding_time";
+    const char KEY_LAST_SEEN_COMPLETE[] = "last_seen_complete";
+    const char KEY_NUM_COMPLETE[] = "num_complete";
+    const char KEY_NUM_INCOMPLETE[] = "num_incomplete";
+}
+
+std::optional<BitTorrent::ResumeDataCounters> BitTorrent::ResumeDataCounters::fromBencodedData(const QByteArray &data)
+{
+    lt::error_code ec;
+    const lt::bdecode_node root = lt::bdecode(data, ec);
+    if (ec || (root.type() != lt::bdecode_node::dict_t))
+        return std::nullopt;
+
+    return ResumeDataCounters
+    {
+        .totalUploaded = root.dict_find_int_value(KEY_TOTAL_UPLOADED),
+        .totalDownloaded = root.dict_find_int_value(KEY_TOTAL_DOWNLOADED),
+        .activeTime = root.dict_find_int_value(KEY_ACTIVE_TIME),
+        .finishedTime = root.dict_find_int_value(KEY_FINISHED_TIME),
+        .seedingTime = root.dict_find_int_value(KEY_SEEDING_TIME),
+        .lastSeenComplete = root.dict_find_int_value(KEY_LAST_SEEN_COMPLETE),
+        .numComplete = static_cast<int>(root.dict_find_int_value(KEY_NUM_COMPLETE, -1)),
+        .numIncomplete = static_cast<int>(root.dict_find_int_value(KEY_NUM_INCOMPLETE, -1))
+    };
+}
+
+QByteArray BitTorrent::ResumeDataCounters::toBencodedData() const
+{
+    lt::entry data {lt::entry::dictionary_t};
+    data[KEY_TOTAL_UPLOADED] = totalUploaded;
+    data[KEY_TOTAL_DOWNLOADED] = totalDownloaded;
+    data[KEY_ACTIVE_TIME] = activeTime;
+    data[KEY_FINISHED_TIME] = finishedTime;
+    data[KEY_SEEDING_TIME] = seedingTime;
+    data[KEY_LAST_SEEN_COMPLETE] = lastSeenComplete;
+    data[KEY_NUM_COMPLETE] = numComplete;
+    data[KEY_NUM_INCOMPLETE] = numIncomplete;
+
+    QByteArray bencodedData;
+    lt::bencode(std::back_inserter(bencodedData), data);
+    return bencodedData;
+}
+
+void BitTorrent::ResumeDataCounters::applyTo(lt::add_torrent_params &params) const
+{
+    params.total_uploaded = totalUploaded;
+    params.total_downloaded = totalDownloaded;
+    params.active_time = static_cast<int>(activeTime);
+    params.finished_time = static_cast<int>(finishedTime);
+    params.seeding_time = static_cast<int>(seedingTime);
+    params.last_seen_complete = lastSeenComplete;
+    params.num_complete = numComplete;
+    params.num_incomplete = numIncomplete;
+}
@@ -30,17 +30,29 @@
 
 #include <utility>
 
+#include <QElapsedTimer>
 #include <QMetaObject>
 #include <QMutexLocker>
 #include <QThread>
 #include <QVector>
 
+#include "base/global.h"
+#include "base/logger.h"
+
 const int TORRENTIDLIST_TYPEID = qRegisterMetaType<QVector<BitTorrent::TorrentID>>();
 
+namespace
+{
+    // limits memory used by decoded resume data which isn't fetched yet
+    const int MAX_PENDING_DECODING_COUNT = 256;
+}
+
 BitTorrent::ResumeDataStorage::ResumeDataStorage(const Path &path, QObject *parent)
     : QObject(parent)
     , m_path {path}
+    , m_decodingSlots {MAX_PENDING_DECODING_COUNT}
 {
+    m_decodingThreadPool.setObjectName(u"ResumeDataStorage m_decodingThreadPool"_s);
 }
 
 Path BitTorrent::ResumeDataStorage::path() const
@@ -48,13 +60,31 @@ Path BitTorrent::ResumeDataStorage::path() const
     return m_path;
 }
 
+void BitTorrent::ResumeDataStorage::storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const
+{
+    for (auto it = resumeData.cbegin(); it != resumeData.cend(); ++it)
+        store(it.key(), it.value());
+}
+
+void BitTorrent::ResumeDataStorage::removeAll(const QVector<TorrentID> &ids) const
+{
+    for (const TorrentID &id : ids)
+        remove(id);
+}
+
 void BitTorrent::ResumeDataStorage::loadAll() const
 {
     m_loadedResumeData.reserve(1024);
 
     auto *loadingThread = QThread::create([this]()
     {
+        QElapsedTimer loadingTimer;
+        loadingTimer.start();
+
         doLoadAll();
+
+        LogMsg(tr("Resume data loaded. Elapsed time: %1 ms. Decoding threads: %2")
+                .arg(QString::number(loadingTimer.elapsed()), QString::number(m_decodingThreadPool.maxThreadCount())));
     });
     connect(loadingThread, &QThread::finished, loadingThread, &QObject::deleteLater);
     loadingThread->start();
@@ -70,8 +100,39 @@ QList<BitTorrent::LoadedResumeData> BitTorrent::ResumeDataStorage::fetchLoadedRe
     return loadedResumeData;
 }
 
-void BitTorrent::ResumeDataStorage::onResumeDataLoaded(const TorrentID &torrentID, const LoadResumeDataResult &loadResumeDataResult) const
+void BitTorrent::ResumeDataStorage::enqueueResumeDataDecoding(const TorrentID &torrentID
+        , std::function<LoadResumeDataResult ()> decoder) const
+{
+    m_decodingSlots.acquire();
+
+    const qint64 index = m_enqueuedCount++;
+    m_decodingThreadPool.start([this, index, torrentID, decoder = std::move(decoder)]
+    {
+        onResumeDataDecoded(index, {torrentID, decoder()});
+    });
+}
+
+void BitTorrent::ResumeDataStorage::waitForResumeDataDecoding() const
+{
+    m_decodingThreadPool.waitForDone();
+}
+
+void BitTorrent::ResumeDataStorage::onResumeDataDecoded(const qint64 index, const LoadedResumeData &loadedResumeData) const
 {
     const QMutexLocker locker {&m_loadedResumeDataMutex};
-    m_loadedResumeData.append({torrentID, loadResumeDataResult});
+
+    m_decodedResumeData.emplace(index, loadedResumeData);
+
+    // publish all the results which are in order now
+    int publishedCount = 0;
+    for (auto it = m_decodedResumeData.begin(); (it != m_decodedResumeData.end()) && (it->first == m_publishedCount)
+            ; it = m_decodedResumeData.erase(it))
+    {
+        m_loadedResumeData.append(std::move(it->second));
+        ++m_publishedCount;
+        ++publishedCount;
+    }
+
+    if (publishedCount > 0)
+        m_decodingSlots.release(publishedCount);
 }
@@ -28,15 +28,22 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+
 #include <QtContainerFwd>
+#include <QHash>
 #include <QList>
 #include <QMutex>
 #include <QObject>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #include "base/3rdparty/expected.hpp"
 #include "base/path.h"
 #include "infohash.h"
 #include "loadtorrentparams.h"
+#include "resumedatacounters.h"
 
 namespace BitTorrent
 {
@@ -61,7 +68,14 @@ namespace BitTorrent
         virtual QVector<TorrentID> registeredTorrents() const = 0;
         virtual LoadResumeDataResult load(const TorrentID &id) const = 0;
         virtual void store(const TorrentID &id, const LoadTorrentParams &resumeData) const = 0;
+        // Stores resume data of several torrents at once, so the storage can write it in one go
+        virtual void storeAll(const QHash<TorrentID, LoadTorrentParams> &resumeData) const;
+        // Stores counters separately from the rest of resume data, so it doesn't have to be rewritten.
+        // They are applied on top of resume data when it is loaded and discarded once it is stored again.
+        virtual void storeCounters(const QHash<TorrentID, ResumeDataCounters> &counters) const = 0;
         virtual void remove(const TorrentID &id) const = 0;
+        // Removes resume data of several torrents at once, so the storage can do it in one go
+        virtual void removeAll(const QVector<TorrentID> &ids) const;
         virtual void storeQueue(const QVector<TorrentID> &queue) const = 0;
 
         void loadAll() const;
@@ -72,13 +86,24 @@ namespace BitTorrent
         void loadFinished();
 
     protected:
-        void onResumeDataLoaded(const TorrentID &torrentID, const LoadResumeDataResult &loadResumeDataResult) const;
+        // Decodes resume data using thread pool. Results become available in the same order
+        // they were enqueued in. Blocks while too many of them are waiting to be fetched.
+        void enqueueResumeDataDecoding(const TorrentID &torrentID, std::function<LoadResumeDataResult ()> decoder) const;
+        void waitForResumeDataDecoding() const;
 
     private:
         virtual void doLoadAll() const = 0;
 
+        void onResumeDataDecoded(qint64 index, const LoadedResumeData &loadedResumeData) const;
+
         const Path m_path;
         mutable QList<LoadedResumeData> m_loadedResumeData;
         mutable QMutex m_loadedResumeDataMutex;
+
+        mutable QThreadPool m_decodingThreadPool;
+        mutable QSemaphore m_decodingSlots;
+        mutable qint64 m_enqueuedCount = 0;
+        mutable qint64 m_publishedCount = 0;
+        mutable std::map<qint64, LoadedResumeData> m_decodedResumeData;
     };
 }
@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <span>
+
 #include <QtContainerFwd>
 #include <QObject>
 
@@ -38,6 +41,7 @@
 #include "categoryoptions.h"
 #include "sharelimitaction.h"
 #include "torrentcontentremoveoption.h"
+#include "torrentstatusfield.h"
 #include "trackerentry.h"
 #include "trackerentrystatus.h"
 
@@ -51,6 +55,9 @@ namespace BitTorrent
     class TorrentID;
     class TorrentInfo;
     struct CacheStatus;
+    struct MoveStorageJobInfo;
+    struct PeerAddress;
+    struct SessionMetrics;
     struct SessionStatus;
 
     enum class TorrentRemoveOption
@@ -93,7 +100,8 @@ namespace BitTorrent
             Default = 0,
             MMap = 1,
             Posix = 2,
-            SimplePreadPwrite = 3
+            SimplePreadPwrite = 3,
+            IOUring = 4  // requires QBT_USES_IO_URING
         };
         Q_ENUM_NS(DiskIOType)
 
@@ -164,6 +172,8 @@ namespace BitTorrent
         virtual bool addCategory(const QString &name, const CategoryOptions &options = {}) = 0;
         virtual bool editCategory(const QString &name, const CategoryOptions &options) = 0;
         virtual bool removeCategory(const QString &name) = 0;
+        // Sets category of all the given torrents in one pass and emits `torrentsCategoryChanged` once
+        virtual bool setTorrentsCategory(const QVector<TorrentID> &ids, const QString &category) = 0;
         virtual bool isSubcategoriesEnabled() const = 0;
         virtual void setSubcategoriesEnabled(bool value) = 0;
         virtual bool useCategoryPathsInManualMode() const = 0;
@@ -176,6 +186,10 @@ namespace BitTorrent
         virtual bool hasTag(const Tag &tag) const = 0;
         virtual bool addTag(const Tag &tag) = 0;
         virtual bool removeTag(const Tag &tag) = 0;
+        // Add/remove tag of all the given torrents in one pass and emit `torrentsTagAdded`/`torrentsTagRemoved` once,
+        // return the number of the changed torrents
+        virtual qsizetype addTorrentsTag(const QVector<TorrentID> &ids, const Tag &tag) = 0;
+        virtual qsizetype removeTorrentsTag(const QVector<TorrentID> &ids, const Tag &tag) = 0;
 
         // Torrent Management Mode subsystem (TMM)
         //
@@ -245,6 +259,19 @@ namespace BitTorrent
         virtual bool isAutoBanBTPlayerPeerEnabled() const = 0;
         virtual void setAutoBanBTPlayerPeer(bool value) = 0;
 
+        // Auto ban peers taking upload without making the corresponding progress
+        virtual bool isAutoBanFakeProgressPeerEnabled() const = 0;
+        virtual void setAutoBanFakeProgressPeer(bool value) = 0;
+        // in MiB
+        virtual int fakeProgressPeerMinUpload() const = 0;
+        virtual void setFakeProgressPeerMinUpload(int value) = 0;
+        // reported progress growth relative to the uploaded data, in percents
+        virtual int fakeProgressPeerMinProgress() const = 0;
+        virtual void setFakeProgressPeerMinProgress(int value) = 0;
+        // how long banned peers are kept in the history, zero keeps them forever
+        virtual int bannedPeersHistoryDays() const = 0;
+        virtual void setBannedPeersHistoryDays(int days) = 0;
+
         // Shadowban IP
         virtual bool isShadowBanEnabled() const = 0;
         virtual void setShadowBan(bool value) = 0;
@@ -257,6 +284,8 @@ namespace BitTorrent
         virtual QString publicTrackers() const = 0;
         virtual void setPublicTrackers(const QString &trackers) = 0;
         virtual void updatePublicTracker() = 0;
+        virtual int maxPublicTrackersPerTorrent() const = 0;
+        virtual void setMaxPublicTrackersPerTorrent(int value) = 0;
 
         virtual int globalDownloadSpeedLimit() const = 0;
         virtual void setGlobalDownloadSpeedLimit(int limit) = 0;
@@ -327,6 +356,13 @@ namespace BitTorrent
         virtual void setIPFilteringEnabled(bool enabled) = 0;
         virtual Path IPFilterFile() const = 0;
         virtual void setIPFilterFile(const Path &path) = 0;
+        virtual QStringList IPFilterSubscriptions() const = 0;
+        virtual void setIPFilterSubscriptions(const QStringList &urls) = 0;
+        virtual int IPFilterSubscriptionsRefreshInterval() const = 0;
+        virtual void setIPFilterSubscriptionsRefreshInterval(int hours) = 0;
+        // ISO 3166-1 alpha-2 codes of the countries whose address ranges are blocked by IP filter
+        virtual QStringList blockedCountries() const = 0;
+        virtual void setBlockedCountries(const QStringList &countryCodes) = 0;
         virtual bool announceToAllTrackers() const = 0;
         virtual void setAnnounceToAllTrackers(bool val) = 0;
         virtual bool announceToAllTiers() const = 0;
@@ -337,6 +373,9 @@ namespace BitTorrent
         virtual void setPeerTurnoverCutoff(int val) = 0;
         virtual int peerTurnoverInterval() const = 0;
         virtual void setPeerTurnoverInterval(int val) = 0;
+        // connections are distributed among the running torrents according to their demand instead of a fixed per-torrent limit
+        virtual bool isConnectionsRebalancingEnabled() const = 0;
+        virtual void setConnectionsRebalancingEnabled(bool enabled) = 0;
         virtual int requestQueueSize() const = 0;
         virtual void setRequestQueueSize(int val) = 0;
         virtual int asyncIOThreads() const = 0;
@@ -355,6 +394,12 @@ namespace BitTorrent
         virtual void setDiskQueueSize(qint64 size) = 0;
         virtual DiskIOType diskIOType() const = 0;
         virtual void setDiskIOType(DiskIOType type) = 0;
+        virtual int diskIOJobsPerDevice() const = 0;
+        virtual void setDiskIOJobsPerDevice(int value) = 0;
+        virtual int diskIOReadsPerHashJob() const = 0;
+        virtual void setDiskIOReadsPerHashJob(int value) = 0;
+        virtual int diskReadCacheSize() const = 0;
+        virtual void setDiskReadCacheSize(int size) = 0;
         virtual DiskIOReadMode diskIOReadMode() const = 0;
         virtual void setDiskIOReadMode(DiskIOReadMode mode) = 0;
         virtual DiskIOWriteMode diskIOWriteMode() const = 0;
@@ -409,7 +454,11 @@ namespace BitTorrent
         virtual void setMaxConcurrentHTTPAnnounces(int value) = 0;
         virtual bool isReannounceWhenAddressChangedEnabled() const = 0;
         virtual void setReannounceWhenAddressChangedEnabled(bool enabled) = 0;
-        virtual void reannounceToAllTrackers() const = 0;
+        virtual void reannounceToAllTrackers() = 0;
+        virtual int announceRampRate() const = 0;
+        virtual void setAnnounceRampRate(int value) = 0;
+        virtual int announceJitter() const = 0;
+        virtual void setAnnounceJitter(int value) = 0;
         virtual int stopTrackerTimeout() const = 0;
         virtual void setStopTrackerTimeout(int value) = 0;
         virtual int maxConnections() const = 0;
@@ -453,12 +502,31 @@ namespace BitTorrent
         virtual void setBannedIPs(const QStringList &newList) = 0;
         virtual ResumeDataStorageType resumeDataStorageType() const = 0;
         virtual void setResumeDataStorageType(ResumeDataStorageType type) = 0;
+        virtual bool isResumeDataStorageSharded() const = 0;
+        virtual void setResumeDataStorageSharded(bool sharded) = 0;
+        virtual bool isDeferredStoppedTorrentsLoadingEnabled() const = 0;
+        virtual void setDeferredStoppedTorrentsLoadingEnabled(bool enabled) = 0;
+        virtual bool isTrustedResumeDataEnabled() const = 0;
+        virtual void setTrustedResumeDataEnabled(bool enabled) = 0;
+        virtual int resumeDataStorageBatchSize() const = 0;
+        virtual void setResumeDataStorageBatchSize(int size) = 0;
+        virtual int resumeDataStorageBatchLatency() const = 0;
+        virtual void setResumeDataStorageBatchLatency(int latency) = 0;
         virtual bool isMergeTrackersEnabled() const = 0;
         virtual void setMergeTrackersEnabled(bool enabled) = 0;
         virtual bool isStartPaused() const = 0;
         virtual void setStartPaused(bool value) = 0;
         virtual TorrentContentRemoveOption torrentContentRemoveOption() const = 0;
         virtual void setTorrentContentRemoveOption(TorrentContentRemoveOption option) = 0;
+        virtual int maxActiveMoveStorageJobsPerDevice() const = 0;
+        virtual void setMaxActiveMoveStorageJobsPerDevice(int value) = 0;
+        virtual QList<MoveStorageJobInfo> moveStorageJobs() const = 0;
+        virtual int maxActiveCheckingTorrentsPerDevice() const = 0;
+        virtual void setMaxActiveCheckingTorrentsPerDevice(int value) = 0;
+        virtual int maxActiveMetadataDownloads() const = 0;
+        virtual void setMaxActiveMetadataDownloads(int value) = 0;
+        virtual int metadataDownloadTimeout() const = 0;
+        virtual void setMetadataDownloadTimeout(int value) = 0;
 
         virtual bool isRestored() const = 0;
 
@@ -469,17 +537,34 @@ namespace BitTorrent
         virtual Torrent *getTorrent(const TorrentID &id) const = 0;
         virtual Torrent *findTorrent(const InfoHash &infoHash) const = 0;
         virtual QVector<Torrent *> torrents() const = 0;
+        // Torrents can be iterated without copying them, the view is invalidated once torrents are added or removed
+        virtual std::span<Torrent *const> torrentsView() const = 0;
+        // It is changed each time torrents are added or removed
+        virtual quint64 torrentsGeneration() const = 0;
         virtual qsizetype torrentsCount() const = 0;
         virtual const SessionStatus &status() const = 0;
         virtual const CacheStatus &cacheStatus() const = 0;
+        virtual SessionMetrics metrics() const = 0;
         virtual bool isListening() const = 0;
+        // Torrent and session statuses are refreshed at full rate only for a while after
+        // somebody has demanded it, otherwise they are refreshed at slow idle rate
+        virtual void demandRefresh() = 0;
 
-        virtual void banIP(const QString &ip) = 0;
-        virtual void shadowbanIP(const QString &ip) = 0;
+        // Zero duration bans the address permanently
+        virtual void banIP(const QString &ip, std::chrono::seconds duration = {}) = 0;
+        virtual void shadowbanIP(const QString &ip, std::chrono::seconds duration = {}) = 0;
+        // Queues connections of the torrents to the peers, they are made gradually within the connection speed.
+        // Duplicate, banned and blocked peers are rejected, returns the number of accepted peers of each torrent.
+        virtual QHash<TorrentID, int> connectPeers(const QList<TorrentID> &torrentIDs, const QList<PeerAddress> &peers) = 0;
 
         virtual bool isKnownTorrent(const InfoHash &infoHash) const = 0;
         virtual bool addTorrent(const TorrentDescriptor &torrentDescr, const AddTorrentParams &params = {}) = 0;
+        // Adds torrents sharing the same parameters in one go, returns the number of the torrents being added.
+        // Parameters must not contain file paths and priorities since they are specific to single torrent.
+        virtual qsizetype addTorrents(const QList<TorrentDescriptor> &torrentDescrs, const AddTorrentParams &params = {}) = 0;
         virtual bool removeTorrent(const TorrentID &id, TorrentRemoveOption deleteOption = TorrentRemoveOption::KeepContent) = 0;
+        // Removes torrents in one go, returns the number of the removed torrents
+        virtual qsizetype removeTorrents(const QVector<TorrentID> &ids, TorrentRemoveOption deleteOption = TorrentRemoveOption::KeepContent) = 0;
         virtual bool downloadMetadata(const TorrentDescriptor &torrentDescr) = 0;
         virtual bool cancelDownloadMetadata(const TorrentID &id) = 0;
 
@@ -508,19 +593,31 @@ namespace BitTorrent
         void tagAdded(const Tag &tag);
         void tagRemoved(const Tag &tag);
         void torrentAboutToBeRemoved(Torrent *torrent);
+        // emitted once for all the torrents removed at once, before `torrentAboutToBeRemoved` of each of them
+        void torrentsAboutToBeRemoved(const QVector<Torrent *> &torrents);
         void torrentAdded(Torrent *torrent);
+        // progress of removing content of the removed torrents, both values are zero when nothing is being removed
+        void torrentContentRemovingProgressChanged(int removedFiles, int totalFiles);
         void torrentCategoryChanged(Torrent *torrent, const QString &oldCategory);
+        // emitted instead of `torrentCategoryChanged` for the torrents changed at once, keys are the changed torrents
+        void torrentsCategoryChanged(const QHash<Torrent *, QString> &oldCategories);
         void torrentFinished(Torrent *torrent);
         void torrentFinishedChecking(Torrent *torrent);
         void torrentMetadataReceived(Torrent *torrent);
+        // data is empty if the piece couldn't be read
+        void torrentPieceRead(Torrent *torrent, int pieceIndex, const QByteArray &data);
         void torrentStopped(Torrent *torrent);
         void torrentStarted(Torrent *torrent);
         void torrentSavePathChanged(Torrent *torrent);
         void torrentSavingModeChanged(Torrent *torrent);
         void torrentsLoaded(const QVector<Torrent *> &torrents);
-        void torrentsUpdated(const QVector<Torrent *> &torrents);
+        // changedFields[i] tells which groups of torrents[i] data have changed
+        void torrentsUpdated(const QVector<Torrent *> &torrents, const QVector<TorrentStatusFields> &changedFields);
         void torrentTagAdded(Torrent *torrent, const Tag &tag);
         void torrentTagRemoved(Torrent *torrent, const Tag &tag);
+        // emitted instead of `torrentTagAdded`/`torrentTagRemoved` for the torrents changed at once
+        void torrentsTagAdded(const QVector<Torrent *> &torrents, const Tag &tag);
+        void torrentsTagRemoved(const QVector<Torrent *> &torrents, const Tag &tag);
         void trackerError(Torrent *torrent, const QString &tracker);
         void trackersAdded(Torrent *torrent, const QVector<TrackerEntry> &trackers);
         void trackersChanged(Torrent *torrent);
@@ -33,6 +33,7 @@
 #include <chrono>
 #include <cstdint>
 #include <ctime>
+#include <limits>
 #include <queue>
 #include <string>
 
@@ -47,6 +48,7 @@
 #include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/address.hpp>
 #include <libtorrent/alert_types.hpp>
+#include <libtorrent/bdecode.hpp>
 #include <libtorrent/error_code.hpp>
 #include <libtorrent/extensions/smart_ban.hpp>
 #include <libtorrent/extensions/ut_metadata.hpp>
@@ -58,9 +60,13 @@
 #include <libtorrent/session_status.hpp>
 #include <libtorrent/torrent_info.hpp>
 
+#include <QDate>
 #include <QDeadlineTimer>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QHostAddress>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -74,14 +80,19 @@
 #include <QThread>
 #include <QThreadPool>
 #include <QTimer>
+#include <QUrl>
 #include <QUuid>
 
+#include "base/activityscope.h"
 #include "base/algorithm.h"
+#include "base/exceptions.h"
 #include "base/global.h"
 #include "base/logger.h"
+#include "base/net/geoipmanager.h"
 #include "base/net/proxyconfigurationmanager.h"
 #include "base/preferences.h"
 #include "base/profile.h"
+#include "base/tracing.h"
 #include "base/unicodestrings.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
@@ -90,26 +101,33 @@
 #include "base/utils/random.h"
 #include "base/version.h"
 #include "bandwidthscheduler.h"
+#include "bandwidthshare.h"
+#include "bannedpeershistory.h"
 #include "bencoderesumedatastorage.h"
+#include "connectionbudget.h"
 #include "customstorage.h"
 #include "dbresumedatastorage.h"
 #include "downloadpriority.h"
 #include "extensiondata.h"
 #include "filesearcher.h"
 #include "filterparserthread.h"
+#include "ipfiltersubscriptionmanager.h"
 #include "loadtorrentparams.h"
 #include "lttypecast.h"
+#include "movestoragejobinfo.h"
 #include "nativesessionextension.h"
-#include "peer_blacklist.hpp"
-#include "peer_filter_session_plugin.hpp"
-#include "peer_shadowban_plugin.hpp"
+#include "nativetorrentextension.h"
+#include "peer_policy_plugin.hpp"
+#include "peerreputationtable.h"
 #include "portforwarderimpl.h"
 #include "resumedatastorage.h"
+#include "shadowbantable.h"
 #include "torrentcontentremover.h"
 #include "torrentdescriptor.h"
 #include "torrentimpl.h"
 #include "tracker.h"
 #include "trackerentry.h"
+#include "transferstatisticsstorage.h"
 #include "base/net/downloadmanager.h"
 
 using namespace std::chrono_literals;
@@ -117,43 +135,59 @@ using namespace BitTorrent;
 
 const Path CATEGORIES_FILE_NAME {u"categories.json"_s};
 const int MAX_PROCESSING_RESUMEDATA_COUNT = 50;
-const int STATISTICS_SAVE_INTERVAL = std::chrono::milliseconds(15min).count();
+// how many times counters can be stored apart from resume data before it is generated in full again
+const int MAX_RESUMEDATA_COUNTERS_SAVE_COUNT = 5;
+// statistics are written to the database in background, so they can be saved often
+const int STATISTICS_SAVE_INTERVAL = std::chrono::milliseconds(1min).count();
+const int IDLE_REFRESH_INTERVAL = std::chrono::milliseconds(10s).count();
+const qint64 REFRESH_DEMAND_TIMEOUT = std::chrono::milliseconds(30s).count();
+const std::chrono::minutes PUBLIC_TRACKERS_RANKING_INTERVAL {30};
+const std::chrono::minutes SESSION_STATE_SAVE_INTERVAL {15};
+const Path SESSION_STATE_FILE_NAME {u"session.state"_s};
+const std::chrono::hours FAKE_PROGRESS_PEER_BAN_DURATION {24};
+const std::chrono::seconds CONNECTIONS_REBALANCE_INTERVAL {30};
+// verified pieces are never used, distributed copies and accurate counters are
+// costly to compute and only displayed to user
+const lt::status_flags_t FULL_STATUS_FLAGS = lt::status_flags_t::all() & ~lt::torrent_handle::query_verified_pieces;
+const lt::status_flags_t IDLE_STATUS_FLAGS = FULL_STATUS_FLAGS
+        & ~lt::torrent_handle::query_distributed_copies & ~lt::torrent_handle::query_accurate_download_counters;
 
 namespace
 {
     const char PEER_ID[] = "qB";
     const auto USER_AGENT = QStringLiteral("qBittorrent/" QBT_VERSION_2);
     const QString DEFAULT_DHT_BOOTSTRAP_NODES = u"dht.libtorrent.org:25401, dht.transmissionbt.com:6881, router.bittorrent.com:6881, router.utorrent.com:6881, dht.aelitis.com:6881"_s;
+    const int MAX_CACHED_METADATA_COUNT = 1000;
 
-    void torrentQueuePositionUp(const lt::torrent_handle &handle)
+    // is written to the storage locations of the torrents on clean shutdown
+    const Path CLEAN_SHUTDOWN_MARKER {u".qBittorrent_clean_shutdown"_s};
+    // files of the torrents resumed with trusted resume data are verified once the session runs for a while
+    const auto TRUSTED_RESUME_DATA_VERIFICATION_DELAY = 2min;
+
+    // exists while resume data is moved to SQLite storage, so the interrupted migration is started over
+    const Path RESUME_DATA_MIGRATION_MARKER {u"torrents.db.migrating"_s};
+    // resume data moved to another storage is stored in batches, so the storage can write it in one go
+    const int RESUME_DATA_MIGRATION_BATCH_SIZE = 1000;
+
+    struct ExpectedFile
     {
-        try
-        {
-            handle.queue_position_up();
-        }
-        catch (const std::exception &exc)
-        {
-            qDebug() << Q_FUNC_INFO << " fails: " << exc.what();
-        }
-    }
+        Path path;
+        qint64 size = 0;
+        bool isComplete = false;
+    };
 
-    void torrentQueuePositionDown(const lt::torrent_handle &handle)
+    struct ExpectedTorrentFiles
     {
-        try
-        {
-            handle.queue_position_down();
-        }
-        catch (const std::exception &exc)
-        {
-            qDebug() << Q_FUNC_INFO << " fails: " << exc.what();
-        }
-    }
+        TorrentID torrentID;
+        Path storageLocation;
+        QList<ExpectedFile> files;
+    };
 
-    void torrentQueuePositionTop(const lt::torrent_handle &handle)
+    void torrentQueuePositionSet(const lt::torrent_handle &handle, const int position)
     {
         try
         {
-            handle.queue_position_top();
+            handle.queue_position_set(lt::queue_position_t {position});
         }
         catch (const std::exception &exc)
         {
@@ -190,6 +224,29 @@ namespace
         return expanded;
     }
 
+    std::pair<lt::address, lt::address> toNativeRange(const Utils::Net::Subnet &subnet)
+    {
+        const auto &[address, prefixLength] = subnet;
+        if (address.protocol() == QAbstractSocket::IPv4Protocol)
+        {
+            const quint32 mask = (prefixLength > 0) ? (~quint32(0) << (32 - prefixLength)) : 0;
+            const quint32 first = address.toIPv4Address() & mask;
+            return {lt::address_v4(first), lt::address_v4(first | ~mask)};
+        }
+
+        const Q_IPV6ADDR addr = address.toIPv6Address();
+        lt::address_v6::bytes_type first {};
+        lt::address_v6::bytes_type last {};
+        for (int i = 0; i < 16; ++i)
+        {
+            const int maskBits = std::clamp((prefixLength - (i * 8)), 0, 8);
+            const auto mask = static_cast<quint8>(0xFF << (8 - maskBits));
+            first[i] = addr[i] & mask;
+            last[i] = first[i] | static_cast<quint8>(~mask);
+        }
+        return {lt::address_v6(first), lt::address_v6(last)};
+    }
+
     QString toString(const lt::socket_type_t socketType)
     {
         switch (socketType)
@@ -327,11 +384,23 @@ struct BitTorrent::SessionImpl::ResumeSessionContext final : public QObject
     int64_t finishedResumeDataCount = 0;
     bool isLoadFinished = false;
     bool isLoadedResumeDataHandlingEnqueued = false;
+    bool isDeferringEnabled = false;
+    bool isLoadingDeferred = false;
+    QList<LoadedResumeData> deferredResumeData;
     QSet<QString> recoveredCategories;
+    QElapsedTimer startupTimer;
+    qint64 loadStartedTime = 0;
+    qint64 loadFinishedTime = 0;
 #ifdef QBT_USES_LIBTORRENT2
     QSet<TorrentID> indexedTorrents;
     QSet<TorrentID> skippedIDs;
 #endif
+    // whether the session was shut down cleanly, by storage location
+    QHash<Path, bool> cleanShutdownPaths;
+    // resume data loaded from the previous storage which waits to be moved to the current one
+    QHash<TorrentID, LoadTorrentParams> migratedResumeData;
+    qint64 migratedResumeDataCount = 0;
+    Path migrationMarkerPath;
 };
 
 const int addTorrentParamsId = qRegisterMetaType<AddTorrentParams>();
@@ -405,6 +474,10 @@ SessionImpl::SessionImpl(QObject *parent)
     , m_isIPFilteringEnabled(BITTORRENT_SESSION_KEY(u"IPFilteringEnabled"_s), false)
     , m_isTrackerFilteringEnabled(BITTORRENT_SESSION_KEY(u"TrackerFilteringEnabled"_s), false)
     , m_IPFilterFile(BITTORRENT_SESSION_KEY(u"IPFilter"_s))
+    , m_IPFilterSubscriptions(BITTORRENT_SESSION_KEY(u"IPFilterSubscriptions"_s))
+    , m_IPFilterSubscriptionsRefreshInterval(BITTORRENT_SESSION_KEY(u"IPFilterSubscriptionsRefreshInterval"_s), 24
+        , clampValue(1, 24 * 30))
+    , m_blockedCountries(BITTORRENT_SESSION_KEY(u"BlockedCountries"_s))
     , m_announceToAllTrackers(BITTORRENT_SESSION_KEY(u"AnnounceToAllTrackers"_s), false)
     , m_announceToAllTiers(BITTORRENT_SESSION_KEY(u"AnnounceToAllTiers"_s), true)
     , m_asyncIOThreads(BITTORRENT_SESSION_KEY(u"AsyncIOThreadsCount"_s), 10)
@@ -415,6 +488,9 @@ SessionImpl::SessionImpl(QObject *parent)
     , m_diskCacheTTL(BITTORRENT_SESSION_KEY(u"DiskCacheTTL"_s), 60)
     , m_diskQueueSize(BITTORRENT_SESSION_KEY(u"DiskQueueSize"_s), (1024 * 1024))
     , m_diskIOType(BITTORRENT_SESSION_KEY(u"DiskIOType"_s), DiskIOType::Default)
+    , m_diskIOJobsPerDevice(BITTORRENT_SESSION_KEY(u"DiskIOJobsPerDevice"_s), 0, clampValue(0, 1024))
+    , m_diskIOReadsPerHashJob(BITTORRENT_SESSION_KEY(u"DiskIOReadsPerHashJob"_s), 4, clampValue(1, 1024))
+    , m_diskReadCacheSize(BITTORRENT_SESSION_KEY(u"DiskReadCacheSize"_s), 0, clampValue(0, 65536))
     , m_diskIOReadMode(BITTORRENT_SESSION_KEY(u"DiskIOReadMode"_s), DiskIOReadMode::EnableOSCache)
     , m_diskIOWriteMode(BITTORRENT_SESSION_KEY(u"DiskIOWriteMode"_s), DiskIOWriteMode::EnableOSCache)
 #ifdef Q_OS_WIN
@@ -449,6 +525,8 @@ SessionImpl::SessionImpl(QObject *parent)
     , m_announceIP(BITTORRENT_SESSION_KEY(u"AnnounceIP"_s))
     , m_maxConcurrentHTTPAnnounces(BITTORRENT_SESSION_KEY(u"MaxConcurrentHTTPAnnounces"_s), 50)
     , m_isReannounceWhenAddressChangedEnabled(BITTORRENT_SESSION_KEY(u"ReannounceWhenAddressChanged"_s), false)
+    , m_announceRampRate(BITTORRENT_SESSION_KEY(u"AnnounceRampRate"_s), 10, clampValue(1, 1000))
+    , m_announceJitter(BITTORRENT_SESSION_KEY(u"AnnounceJitter"_s), 30, clampValue(0, 3600))
     , m_stopTrackerTimeout(BITTORRENT_SESSION_KEY(u"StopTrackerTimeout"_s), 2)
     , m_maxConnections(BITTORRENT_SESSION_KEY(u"MaxConnections"_s), 500, lowerLimited(0, -1))
     , m_maxUploads(BITTORRENT_SESSION_KEY(u"MaxUploads"_s), 20, lowerLimited(0, -1))
@@ -517,11 +595,18 @@ SessionImpl::SessionImpl(QObject *parent)
     , m_peerTurnover(BITTORRENT_SESSION_KEY(u"PeerTurnover"_s), 4)
     , m_peerTurnoverCutoff(BITTORRENT_SESSION_KEY(u"PeerTurnoverCutOff"_s), 90)
     , m_peerTurnoverInterval(BITTORRENT_SESSION_KEY(u"PeerTurnoverInterval"_s), 300)
+    , m_isConnectionsRebalancingEnabled(BITTORRENT_SESSION_KEY(u"ConnectionsRebalancing"_s), false)
     , m_requestQueueSize(BITTORRENT_SESSION_KEY(u"RequestQueueSize"_s), 500)
     , m_isExcludedFileNamesEnabled(BITTORRENT_KEY(u"ExcludedFileNamesEnabled"_s), false)
     , m_excludedFileNames(BITTORRENT_SESSION_KEY(u"ExcludedFileNames"_s))
     , m_bannedIPs(u"State/BannedIPs"_s, QStringList(), Algorithm::sorted<QStringList>)
+    , m_bannedIPsExpiration(u"State/BannedIPsExpiration"_s)
     , m_resumeDataStorageType(BITTORRENT_SESSION_KEY(u"ResumeDataStorageType"_s), ResumeDataStorageType::Legacy)
+    , m_isResumeDataStorageSharded(BITTORRENT_SESSION_KEY(u"ShardedResumeDataStorage"_s), false)
+    , m_isDeferredStoppedTorrentsLoadingEnabled(BITTORRENT_SESSION_KEY(u"DeferStoppedTorrentsLoading"_s), false)
+    , m_isTrustedResumeDataEnabled(BITTORRENT_SESSION_KEY(u"TrustResumeDataAfterCleanShutdown"_s), false)
+    , m_resumeDataStorageBatchSize(BITTORRENT_SESSION_KEY(u"ResumeDataStorageBatchSize"_s), 1000, lowerLimited(1))
+    , m_resumeDataStorageBatchLatency(BITTORRENT_SESSION_KEY(u"ResumeDataStorageBatchLatency"_s), 100, lowerLimited(0))
     , m_isMergeTrackersEnabled(BITTORRENT_KEY(u"MergeTrackersEnabled"_s), false)
     , m_isI2PEnabled {BITTORRENT_SESSION_KEY(u"I2P/Enabled"_s), false}
     , m_I2PAddress {BITTORRENT_SESSION_KEY(u"I2P/Address"_s), u"127.0.0.1"_s}
@@ -532,21 +617,43 @@ SessionImpl::SessionImpl(QObject *parent)
     , m_I2PInboundLength {BITTORRENT_SESSION_KEY(u"I2P/InboundLength"_s), 3}
     , m_I2POutboundLength {BITTORRENT_SESSION_KEY(u"I2P/OutboundLength"_s), 3}
     , m_torrentContentRemoveOption {BITTORRENT_SESSION_KEY(u"TorrentContentRemoveOption"_s), TorrentContentRemoveOption::Delete}
+    , m_maxActiveMoveStorageJobsPerDevice {BITTORRENT_SESSION_KEY(u"MaxActiveMoveStorageJobsPerDevice"_s), 1, clampValue(1, 64)}
+    , m_maxActiveCheckingTorrentsPerDevice {BITTORRENT_SESSION_KEY(u"MaxActiveCheckingTorrentsPerDevice"_s), 0, clampValue(0, 64)}
+    , m_maxActiveMetadataDownloads {BITTORRENT_SESSION_KEY(u"MaxActiveMetadataDownloads"_s), 0, clampValue(0, 1000)}
+    , m_metadataDownloadTimeout {BITTORRENT_SESSION_KEY(u"MetadataDownloadTimeout"_s), 300, clampValue(30, 86400)}
     , m_startPaused {BITTORRENT_SESSION_KEY(u"StartPaused"_s)}
     , m_publicTrackers(BITTORRENT_SESSION_KEY(u"PublicTrackersList"_s))
     , m_autoBanUnknownPeer(BITTORRENT_SESSION_KEY(u"AutoBanUnknownPeer"_s), false)
     , m_autoBanBTPlayerPeer(BITTORRENT_SESSION_KEY(u"AutoBanBTPlayerPeer"_s), false)
+    , m_autoBanFakeProgressPeer(BITTORRENT_SESSION_KEY(u"AutoBanFakeProgressPeer"_s), false)
+    , m_fakeProgressPeerMinUpload(BITTORRENT_SESSION_KEY(u"FakeProgressPeerMinUpload"_s), 16, lowerLimited(1))
+    , m_fakeProgressPeerMinProgress(BITTORRENT_SESSION_KEY(u"FakeProgressPeerMinProgress"_s), 50, clampValue(1, 100))
+    , m_bannedPeersHistoryDays(BITTORRENT_SESSION_KEY(u"BannedPeersHistoryDays"_s), 90, clampValue(0, 3650))
     , m_shadowBan(BITTORRENT_SESSION_KEY(u"ShadowBan"_s), false)
     , m_shadowBannedIPs(u"State/ShadowBannedIPs"_s, QStringList(), Algorithm::sorted<QStringList>)
+    , m_shadowBannedIPsExpiration(u"State/ShadowBannedIPsExpiration"_s)
     , m_isAutoUpdateTrackersEnabled(BITTORRENT_SESSION_KEY(u"AutoUpdateTrackersEnabled"_s), false)
+    , m_maxPublicTrackersPerTorrent(BITTORRENT_SESSION_KEY(u"MaxPublicTrackersPerTorrent"_s), 20, clampValue(1, 1000))
+    , m_publicTrackersSourceURL(u"State/PublicTrackersSourceURL"_s)
+    , m_publicTrackersETag(u"State/PublicTrackersETag"_s)
+    , m_publicTrackersLastModified(u"State/PublicTrackersLastModified"_s)
     , m_seedingLimitTimer {new QTimer(this)}
     , m_resumeDataTimer {new QTimer(this)}
+    , m_refreshTimer {new QTimer(this)}
+    , m_bannedIPsApplyTimer {new QTimer(this)}
+    , m_banExpirationTimer {new QTimer(this)}
+    , m_peerConnectTimer {new QTimer(this)}
     , m_ioThread {new QThread}
     , m_asyncWorker {new QThreadPool(this)}
+    , m_metadataCache {specialFolderLocation(SpecialFolder::Cache) / Path(u"metadata"_s)}
     , m_recentErroredTorrentsTimer {new QTimer(this)}
 {
     // It is required to perform async access to libtorrent sequentially
     m_asyncWorker->setMaxThreadCount(1);
+    invokeAsync([metadataCache = m_metadataCache]
+    {
+        metadataCache.prune(MAX_CACHED_METADATA_COUNT);
+    });
 
     if (port() < 0)
         m_port = Utils::Random::rand(1024, 65535);
@@ -557,20 +664,37 @@ SessionImpl::SessionImpl(QObject *parent)
             m_sslPort = Utils::Random::rand(1024, 65535);
     }
 
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setTimerType(Qt::CoarseTimer);
+    connect(m_refreshTimer, &QTimer::timeout, this, &SessionImpl::postRefresh);
+
     m_recentErroredTorrentsTimer->setSingleShot(true);
     m_recentErroredTorrentsTimer->setInterval(1s);
     connect(m_recentErroredTorrentsTimer, &QTimer::timeout
         , this, [this]() { m_recentErroredTorrents.clear(); });
 
-    m_seedingLimitTimer->setInterval(10s);
-    connect(m_seedingLimitTimer, &QTimer::timeout, this, [this]
-    {
-        // We shouldn't iterate over `m_torrents` in the loop below
-        // since `deleteTorrent()` modifies it indirectly
-        const QHash<TorrentID, TorrentImpl *> torrents {m_torrents};
-        for (TorrentImpl *torrent : torrents)
-            processTorrentShareLimits(torrent);
-    });
+    m_banExpirationTimer->setInterval(1s);
+    connect(m_banExpirationTimer, &QTimer::timeout, this, &SessionImpl::processBanExpirations);
+    loadBanExpirations();
+
+    const QStringList bannedIPs = m_bannedIPs.get();
+    m_bannedIPsIndex = QSet<QString>(bannedIPs.cbegin(), bannedIPs.cend());
+    // bans issued within short period are applied in one go
+    m_bannedIPsApplyTimer->setSingleShot(true);
+    m_bannedIPsApplyTimer->setInterval(500ms);
+    connect(m_bannedIPsApplyTimer, &QTimer::timeout, this, &SessionImpl::applyPendingBannedIPs);
+    // connection speed is the number of connection attempts per second
+    m_peerConnectTimer->setInterval(1s);
+    connect(m_peerConnectTimer, &QTimer::timeout, this, &SessionImpl::processPeerConnectQueue);
+
+    m_IPFilterSubscriptionManager = new IPFilterSubscriptionManager(this);
+    m_IPFilterSubscriptionManager->setRefreshInterval(std::chrono::hours(m_IPFilterSubscriptionsRefreshInterval.get()));
+    m_IPFilterSubscriptionManager->setURLs(m_IPFilterSubscriptions);
+    connect(m_IPFilterSubscriptionManager, &IPFilterSubscriptionManager::rangesChanged
+        , this, &SessionImpl::handleIPFilterSubscriptionsChanged);
+
+    m_seedingLimitTimer->setSingleShot(true);
+    connect(m_seedingLimitTimer, &QTimer::timeout, this, &SessionImpl::processDueShareLimitsChecks);
 
     initializeNativeSession();
     configureComponents();
@@ -592,11 +716,10 @@ SessionImpl::SessionImpl(QObject *parent)
             m_tags.insert(tag);
     }
 
-    updateSeedingLimitTimer();
     populateAdditionalTrackers();
     populatePublicTrackers();
     if (isExcludedFileNamesEnabled())
-        populateExcludedFileNamesRegExpList();
+        populateExcludedFileNamesFilter();
 
     connect(Net::ProxyConfigurationManager::instance()
         , &Net::ProxyConfigurationManager::proxyConfigurationChanged
@@ -605,17 +728,23 @@ SessionImpl::SessionImpl(QObject *parent)
     m_fileSearcher = new FileSearcher;
     m_fileSearcher->moveToThread(m_ioThread.get());
     connect(m_ioThread.get(), &QThread::finished, m_fileSearcher, &QObject::deleteLater);
-    connect(m_fileSearcher, &FileSearcher::searchFinished, this, &SessionImpl::fileSearchFinished);
+    connect(m_fileSearcher, &FileSearcher::searchFinished, this, [this](const QList<FileSearchResult> &results)
+    {
+        for (const FileSearchResult &result : results)
+            fileSearchFinished(result.id, result.savePath, result.fileNames);
+    });
 
-    m_torrentContentRemover = new TorrentContentRemover;
-    m_torrentContentRemover->moveToThread(m_ioThread.get());
-    connect(m_ioThread.get(), &QThread::finished, m_torrentContentRemover, &QObject::deleteLater);
+    m_torrentContentRemover = new TorrentContentRemover(this);
     connect(m_torrentContentRemover, &TorrentContentRemover::jobFinished, this, &SessionImpl::torrentContentRemovingFinished);
+    connect(m_torrentContentRemover, &TorrentContentRemover::progressChanged, this, &Session::torrentContentRemovingProgressChanged);
 
     m_ioThread->start();
 
     initMetrics();
+    MemoryUsage::registerEstimator(this, [this] { return estimateMemoryUsage(); });
     loadStatistics();
+    loadCheckingQueue();
+    NativeTorrentExtension::setCheckingScheduled(maxActiveCheckingTorrentsPerDevice() > 0);
 
     // initialize PortForwarder instance
     new PortForwarderImpl(this);
@@ -623,6 +752,9 @@ SessionImpl::SessionImpl(QObject *parent)
     // start embedded tracker
     enableTracker(isTrackerEnabled());
 
+    // GeoIP manager is created after the session, so loading of its database doesn't delay the torrents restoring
+    QMetaObject::invokeMethod(this, &SessionImpl::initCountryFiltering, Qt::QueuedConnection);
+
     prepareStartup();
 
     // Update Tracker
@@ -633,12 +765,37 @@ SessionImpl::SessionImpl(QObject *parent)
         updatePublicTracker();
         m_updateTimer->start();
     }
+
+    m_publicTrackersRankingTimer = new QTimer(this);
+    m_publicTrackersRankingTimer->setInterval(PUBLIC_TRACKERS_RANKING_INTERVAL);
+    connect(m_publicTrackersRankingTimer, &QTimer::timeout, this, [this]
+    {
+        rankPublicTrackers();
+        if (isAutoUpdateTrackersEnabled())
+            removeFailingPublicTrackers();
+    });
+    m_publicTrackersRankingTimer->start();
+
+    m_sessionStateSaveTimer = new QTimer(this);
+    m_sessionStateSaveTimer->setInterval(SESSION_STATE_SAVE_INTERVAL);
+    connect(m_sessionStateSaveTimer, &QTimer::timeout, this, &SessionImpl::saveSessionState);
+    m_sessionStateSaveTimer->start();
+
+    m_announceScheduler.setAnnouncesPerSecond(announceRampRate());
 }
 
 SessionImpl::~SessionImpl()
 {
+    m_isTrustedResumeDataVerificationAborted = true;
+    m_trustedResumeDataVerificationThread.reset();
+
+    // alerts are read synchronously from now on
+    stopAlertsThread();
+
     m_nativeSession->pause();
 
+    applyPendingBannedIPs();
+
     const auto timeout = (m_shutdownTimeout >= 0) ? (static_cast<qint64>(m_shutdownTimeout) * 1000) : -1;
     const QDeadlineTimer shutdownDeadlineTimer {timeout};
 
@@ -653,11 +810,32 @@ SessionImpl::~SessionImpl()
     // After this, (ideally) no more important alerts will be generated/handled
     saveResumeData();
 
+    // resume data is consistent with the files in the storage locations where nothing else is going on
+    QSet<Path> cleanShutdownPaths;
+    if (isTrustedResumeDataEnabled() && (m_numResumeData == 0))
+    {
+        QSet<Path> busyPaths;
+        for (const TorrentImpl *torrent : asConst(m_torrents))
+        {
+            if (!torrent->hasMetadata())
+                continue;
+
+            const Path storageLocation = torrent->actualStorageLocation();
+            if (torrent->isChecking() || torrent->isMoving() || torrent->hasError())
+                busyPaths.insert(storageLocation);
+            else
+                cleanShutdownPaths.insert(storageLocation);
+        }
+        cleanShutdownPaths.subtract(busyPaths);
+    }
+
     saveStatistics();
+    saveSessionState();
 
     // We must delete FilterParserThread
     // before we delete lt::session
     delete m_filterParser;
+    delete m_IPFilterSubscriptionManager;
 
     // We must delete PortForwarderImpl before
     // we delete lt::session
@@ -671,6 +849,9 @@ SessionImpl::~SessionImpl()
     auto *nativeSessionProxy = new lt::session_proxy(m_nativeSession->abort());
     delete m_nativeSession;
 
+    // no more peers can be logged by plugins at this point
+    peer_logger_singleton::instance().stop();
+
     qDebug("Deleting resume data storage...");
     delete m_resumeDataStorage;
     LogMsg(tr("Saving resume data completed."));
@@ -683,9 +864,15 @@ SessionImpl::~SessionImpl()
     connect(sessionTerminateThread, &QThread::finished, sessionTerminateThread, &QObject::deleteLater);
     sessionTerminateThread->start();
     if (sessionTerminateThread->wait(shutdownDeadlineTimer))
+    {
         LogMsg(tr("BitTorrent session successfully finished."));
+        // all the files are closed now
+        writeCleanShutdownMarkers(cleanShutdownPaths);
+    }
     else
+    {
         LogMsg(tr("Session shutdown timed out."));
+    }
 }
 
 QString SessionImpl::getDHTBootstrapNodes() const
@@ -756,8 +943,8 @@ void SessionImpl::setDownloadPathEnabled(const bool enabled)
     if (enabled != isDownloadPathEnabled())
     {
         m_isDownloadPathEnabled = enabled;
-        for (TorrentImpl *const torrent : asConst(m_torrents))
-            torrent->handleCategoryOptionsChanged();
+        clearCategoryPathsCache();
+        relocateTorrents(m_torrents.values(), tr("download path toggled"));
     }
 }
 
@@ -837,27 +1024,155 @@ QString SessionImpl::publicTrackers() const
 
 void SessionImpl::setPublicTrackers(const QString &trackers)
 {
-    if (trackers != publicTrackers()) {
-        m_publicTrackers = trackers;
-        populatePublicTrackers();
+    if (trackers == publicTrackers())
+        return;
+
+    const QVector<TrackerEntry> oldPublicTrackers = m_publicTrackerList;
+    const QVector<TrackerEntry> oldRankedPublicTrackers = m_rankedPublicTrackers;
+
+    m_publicTrackers = trackers;
+    populatePublicTrackers();
+
+    if (!isAutoUpdateTrackersEnabled())
+        return;
+
+    // Existing torrents only get the changes, i.e. the trackers that are no more listed are removed
+    // and the newly listed ones are added if they are ranked high enough
+    QSet<QString> newPublicTrackerURLs;
+    for (const TrackerEntry &trackerEntry : asConst(m_publicTrackerList))
+        newPublicTrackerURLs.insert(trackerEntry.url);
+    QSet<QString> oldRankedPublicTrackerURLs;
+    for (const TrackerEntry &trackerEntry : oldRankedPublicTrackers)
+        oldRankedPublicTrackerURLs.insert(trackerEntry.url);
+
+    QSet<QString> removedTrackers;
+    for (const TrackerEntry &trackerEntry : oldPublicTrackers)
+    {
+        if (!newPublicTrackerURLs.contains(trackerEntry.url))
+            removedTrackers.insert(trackerEntry.url);
+    }
+
+    QVector<TrackerEntry> addedTrackers;
+    for (const TrackerEntry &trackerEntry : asConst(m_rankedPublicTrackers))
+    {
+        if (!oldRankedPublicTrackerURLs.contains(trackerEntry.url))
+            addedTrackers.append(trackerEntry);
+    }
+
+    if (removedTrackers.isEmpty() && addedTrackers.isEmpty())
+        return;
+
+    // merge with the changes which are not applied to all the torrents yet
+    m_addedPublicTrackers.removeIf([&removedTrackers](const TrackerEntry &trackerEntry)
+    {
+        return removedTrackers.contains(trackerEntry.url);
+    });
+    for (const TrackerEntry &trackerEntry : asConst(addedTrackers))
+        m_removedPublicTrackers.remove(trackerEntry.url);
+    m_removedPublicTrackers.unite(removedTrackers);
+    m_addedPublicTrackers.append(addedTrackers);
+
+    const bool isUpdateInProgress = !m_publicTrackersUpdateQueue.isEmpty();
+    m_publicTrackersUpdateQueue = m_torrents.keys();
+    if (!isUpdateInProgress)
+        QMetaObject::invokeMethod(this, &SessionImpl::applyPublicTrackersUpdate, Qt::QueuedConnection);
+}
+
+void SessionImpl::applyPublicTrackersUpdate()
+{
+    // torrents are processed in small batches to keep application responsive
+    const int batchSize = 100;
+
+    for (int i = 0; (i < batchSize) && !m_publicTrackersUpdateQueue.isEmpty(); ++i)
+    {
+        TorrentImpl *torrent = m_torrents.value(m_publicTrackersUpdateQueue.takeLast());
+        if (!torrent || torrent->isPrivate())
+            continue;
+
+        const QVector<TrackerEntryStatus> trackerStatuses = torrent->trackers();
+
+        QVector<TrackerEntry> trackers;
+        trackers.reserve(trackerStatuses.size() + m_addedPublicTrackers.size());
+        QSet<QString> trackerURLs;
+        bool isChanged = false;
+        for (const TrackerEntryStatus &status : trackerStatuses)
+        {
+            if (m_removedPublicTrackers.contains(status.url))
+            {
+                isChanged = true;
+                continue;
+            }
+
+            trackers.append({.url = status.url, .tier = status.tier});
+            trackerURLs.insert(status.url);
+        }
+
+        for (const TrackerEntry &trackerEntry : asConst(m_addedPublicTrackers))
+        {
+            if (!trackerURLs.contains(trackerEntry.url))
+            {
+                trackers.append(trackerEntry);
+                isChanged = true;
+            }
+        }
+
+        // all the changes are applied with single tracker list replacement
+        if (isChanged)
+            torrent->replaceTrackers(std::move(trackers));
     }
+
+    if (m_publicTrackersUpdateQueue.isEmpty())
+    {
+        m_removedPublicTrackers.clear();
+        m_addedPublicTrackers.clear();
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, &SessionImpl::applyPublicTrackersUpdate, Qt::QueuedConnection);
+}
+
+int SessionImpl::maxPublicTrackersPerTorrent() const
+{
+    return m_maxPublicTrackersPerTorrent;
+}
+
+void SessionImpl::setMaxPublicTrackersPerTorrent(const int value)
+{
+    if (value == maxPublicTrackersPerTorrent())
+        return;
+
+    m_maxPublicTrackersPerTorrent = value;
+    rankPublicTrackers();
 }
 
 void SessionImpl::updatePublicTracker()
 {
     Preferences *const pref = Preferences::instance();
-    Net::DownloadManager::instance()->download(Net::DownloadRequest(pref->customizeTrackersListUrl()).userAgent(QStringLiteral("qBittorrent/" QBT_VERSION_2)), Preferences::instance()->useProxyForGeneralPurposes(), this, &SessionImpl::handlePublicTrackerTxtDownloadFinished);
+    const QString url = pref->customizeTrackersListUrl();
+    // the list is only downloaded again if it has been modified since the last time
+    const bool isSameSource = (url == m_publicTrackersSourceURL.get());
+    const auto request = Net::DownloadRequest(url).userAgent(QStringLiteral("qBittorrent/" QBT_VERSION_2))
+            .priority(Net::DownloadPriority::Low)
+            .eTag(isSameSource ? m_publicTrackersETag.get() : QString())
+            .lastModified(isSameSource ? m_publicTrackersLastModified.get() : QString());
+    Net::DownloadManager::instance()->download(request, pref->useProxyForGeneralPurposes(), this, &SessionImpl::handlePublicTrackerTxtDownloadFinished);
 }
 
 void SessionImpl::handlePublicTrackerTxtDownloadFinished(const Net::DownloadResult &result)
 {
     switch (result.status) {
         case Net::DownloadStatus::Success:
-            setPublicTrackers(QString::fromUtf8(result.data.data()));
+            m_publicTrackersSourceURL = result.url;
+            m_publicTrackersETag = result.eTag;
+            m_publicTrackersLastModified = result.lastModified;
+            setPublicTrackers(QString::fromUtf8(result.data));
             LogMsg(tr("The public tracker list updated."), Log::INFO);
             break;
+        case Net::DownloadStatus::NotModified:
+            LogMsg(tr("The public tracker list is up to date."), Log::INFO);
+            break;
         default:
-            LogMsg(tr("Updating the public tracker list failed: %1").arg(result.errorString, Log::WARNING));
+            LogMsg(tr("Updating the public tracker list failed: %1").arg(result.errorString), Log::WARNING);
     }
 }
 
@@ -912,7 +1227,12 @@ CategoryOptions SessionImpl::categoryOptions(const QString &categoryName) const
 
 Path SessionImpl::categorySavePath(const QString &categoryName) const
 {
-    return categorySavePath(categoryName, categoryOptions(categoryName));
+    if (const auto iter = m_categorySavePathsCache.constFind(categoryName); iter != m_categorySavePathsCache.cend())
+        return iter.value();
+
+    const Path path = categorySavePath(categoryName, categoryOptions(categoryName));
+    m_categorySavePathsCache.insert(categoryName, path);
+    return path;
 }
 
 Path SessionImpl::categorySavePath(const QString &categoryName, const CategoryOptions &options) const
@@ -941,7 +1261,12 @@ Path SessionImpl::categorySavePath(const QString &categoryName, const CategoryOp
 
 Path SessionImpl::categoryDownloadPath(const QString &categoryName) const
 {
-    return categoryDownloadPath(categoryName, categoryOptions(categoryName));
+    if (const auto iter = m_categoryDownloadPathsCache.constFind(categoryName); iter != m_categoryDownloadPathsCache.cend())
+        return iter.value();
+
+    const Path path = categoryDownloadPath(categoryName, categoryOptions(categoryName));
+    m_categoryDownloadPathsCache.insert(categoryName, path);
+    return path;
 }
 
 Path SessionImpl::categoryDownloadPath(const QString &categoryName, const CategoryOptions &options) const
@@ -985,6 +1310,13 @@ DownloadPathOption SessionImpl::resolveCategoryDownloadPathOption(const QString
     return resolveCategoryDownloadPathOption(parentName, categoryOptions(parentName).downloadPath);
 }
 
+void SessionImpl::clearCategoryPathsCache()
+{
+    // implicit paths of subcategories depend on their parents, so the whole cache is outdated
+    m_categorySavePathsCache.clear();
+    m_categoryDownloadPathsCache.clear();
+}
+
 bool SessionImpl::addCategory(const QString &name, const CategoryOptions &options)
 {
     if (name.isEmpty())
@@ -1006,6 +1338,7 @@ bool SessionImpl::addCategory(const QString &name, const CategoryOptions &option
     }
 
     m_categories[name] = options;
+    clearCategoryPathsCache();
     storeCategories();
     emit categoryAdded(name);
 
@@ -1022,9 +1355,15 @@ bool SessionImpl::editCategory(const QString &name, const CategoryOptions &optio
     if (options == currentOptions)
         return false;
 
+    const bool pathsChanged = (options.savePath != currentOptions.savePath)
+            || (options.downloadPath != currentOptions.downloadPath);
     currentOptions = options;
     storeCategories();
-    if (isDisableAutoTMMWhenCategorySavePathChanged())
+    // changed rate limits are applied on the next refresh
+    if (pathsChanged)
+        clearCategoryPathsCache();
+
+    if (pathsChanged && isDisableAutoTMMWhenCategorySavePathChanged())
     {
         for (TorrentImpl *const torrent : asConst(m_torrents))
         {
@@ -1032,13 +1371,16 @@ bool SessionImpl::editCategory(const QString &name, const CategoryOptions &optio
                 torrent->setAutoTMMEnabled(false);
         }
     }
-    else
+    else if (pathsChanged)
     {
+        // implicit paths of subcategories are based on the paths of this one
+        QVector<TorrentImpl *> categoryTorrents;
         for (TorrentImpl *const torrent : asConst(m_torrents))
         {
-            if (torrent->category() == name)
-                torrent->handleCategoryOptionsChanged();
+            if (torrent->belongsToCategory(name))
+                categoryTorrents.append(torrent);
         }
+        relocateTorrents(categoryTorrents, tr("paths of category \"%1\" changed").arg(name));
     }
 
     emit categoryOptionsChanged(name);
@@ -1047,11 +1389,13 @@ bool SessionImpl::editCategory(const QString &name, const CategoryOptions &optio
 
 bool SessionImpl::removeCategory(const QString &name)
 {
-    for (TorrentImpl *const torrent : asConst(m_torrents))
+    QVector<TorrentID> categoryTorrentIDs;
+    for (const TorrentImpl *torrent : asConst(m_torrents))
     {
         if (torrent->belongsToCategory(name))
-            torrent->setCategory(u""_s);
+            categoryTorrentIDs.append(torrent->id());
     }
+    setTorrentsCategory(categoryTorrentIDs, u""_s);
 
     // remove stored category and its subcategories if exist
     bool result = false;
@@ -1075,6 +1419,7 @@ bool SessionImpl::removeCategory(const QString &name)
 
     if (result)
     {
+        clearCategoryPathsCache();
         // update stored categories
         storeCategories();
         emit categoryRemoved(name);
@@ -1106,6 +1451,7 @@ void SessionImpl::setSubcategoriesEnabled(const bool value)
     }
 
     m_isSubcategoriesEnabled = value;
+    clearCategoryPathsCache();
     emit subcategoriesSupportChanged();
 }
 
@@ -1160,8 +1506,13 @@ bool SessionImpl::removeTag(const Tag &tag)
 {
     if (m_tags.remove(tag))
     {
-        for (TorrentImpl *const torrent : asConst(m_torrents))
-            torrent->removeTag(tag);
+        QVector<TorrentID> taggedTorrentIDs;
+        for (const TorrentImpl *torrent : asConst(m_torrents))
+        {
+            if (torrent->hasTag(tag))
+                taggedTorrentIDs.append(torrent->id());
+        }
+        removeTorrentsTag(taggedTorrentIDs, tag);
 
         m_storedTags = QStringList(m_tags.cbegin(), m_tags.cend());
 
@@ -1171,6 +1522,69 @@ bool SessionImpl::removeTag(const Tag &tag)
     return false;
 }
 
+qsizetype SessionImpl::addTorrentsTag(const QVector<TorrentID> &ids, const Tag &tag)
+{
+    if (!tag.isValid())
+        return 0;
+    if (!hasTag(tag) && !addTag(tag))
+        return 0;
+
+    QVector<Torrent *> changedTorrents;
+    m_isBulkChangeInProgress = true;
+    for (const TorrentID &id : ids)
+    {
+        TorrentImpl *const torrent = m_torrents.value(id);
+        if (torrent && torrent->addTag(tag))
+            changedTorrents.append(torrent);
+    }
+    m_isBulkChangeInProgress = false;
+
+    if (!changedTorrents.isEmpty())
+        emit torrentsTagAdded(changedTorrents, tag);
+    return changedTorrents.size();
+}
+
+qsizetype SessionImpl::removeTorrentsTag(const QVector<TorrentID> &ids, const Tag &tag)
+{
+    QVector<Torrent *> changedTorrents;
+    m_isBulkChangeInProgress = true;
+    for (const TorrentID &id : ids)
+    {
+        TorrentImpl *const torrent = m_torrents.value(id);
+        if (torrent && torrent->removeTag(tag))
+            changedTorrents.append(torrent);
+    }
+    m_isBulkChangeInProgress = false;
+
+    if (!changedTorrents.isEmpty())
+        emit torrentsTagRemoved(changedTorrents, tag);
+    return changedTorrents.size();
+}
+
+bool SessionImpl::setTorrentsCategory(const QVector<TorrentID> &ids, const QString &category)
+{
+    if (!category.isEmpty() && !m_categories.contains(category))
+        return false;
+
+    QHash<Torrent *, QString> oldCategories;
+    m_isBulkChangeInProgress = true;
+    for (const TorrentID &id : ids)
+    {
+        TorrentImpl *const torrent = m_torrents.value(id);
+        if (!torrent || (torrent->category() == category))
+            continue;
+
+        const QString oldCategory = torrent->category();
+        if (torrent->setCategory(category))
+            oldCategories.insert(torrent, oldCategory);
+    }
+    m_isBulkChangeInProgress = false;
+
+    if (!oldCategories.isEmpty())
+        emit torrentsCategoryChanged(oldCategories);
+    return true;
+}
+
 bool SessionImpl::isAutoTMMDisabledByDefault() const
 {
     return m_isAutoTMMDisabledByDefault;
@@ -1271,7 +1685,7 @@ void SessionImpl::setGlobalMaxRatio(qreal ratio)
     if (ratio != globalMaxRatio())
     {
         m_globalMaxRatio = ratio;
-        updateSeedingLimitTimer();
+        rescheduleShareLimitsChecks();
     }
 }
 
@@ -1288,7 +1702,7 @@ void SessionImpl::setGlobalMaxSeedingMinutes(int minutes)
     if (minutes != globalMaxSeedingMinutes())
     {
         m_globalMaxSeedingMinutes = minutes;
-        updateSeedingLimitTimer();
+        rescheduleShareLimitsChecks();
     }
 }
 
@@ -1304,18 +1718,36 @@ void SessionImpl::setGlobalMaxInactiveSeedingMinutes(int minutes)
     if (minutes != globalMaxInactiveSeedingMinutes())
     {
         m_globalMaxInactiveSeedingMinutes = minutes;
-        updateSeedingLimitTimer();
+        rescheduleShareLimitsChecks();
     }
 }
 
 void SessionImpl::applyBandwidthLimits()
 {
     lt::settings_pack settingsPack;
-    settingsPack.set_int(lt::settings_pack::download_rate_limit, downloadSpeedLimit());
-    settingsPack.set_int(lt::settings_pack::upload_rate_limit, uploadSpeedLimit());
+    settingsPack.set_int(lt::settings_pack::download_rate_limit, scheduledSpeedLimit(downloadSpeedLimit()));
+    settingsPack.set_int(lt::settings_pack::upload_rate_limit, scheduledSpeedLimit(uploadSpeedLimit()));
     m_nativeSession->apply_settings(std::move(settingsPack));
 }
 
+int SessionImpl::scheduledSpeedLimit(const int limit) const
+{
+    // unlimited stays unlimited
+    if ((limit <= 0) || (m_scheduledBandwidthPercent >= 100))
+        return limit;
+
+    return std::max(1, static_cast<int>((static_cast<qint64>(limit) * m_scheduledBandwidthPercent) / 100));
+}
+
+void SessionImpl::setScheduledBandwidthPercent(const int percent)
+{
+    if (percent == m_scheduledBandwidthPercent)
+        return;
+
+    m_scheduledBandwidthPercent = percent;
+    applyBandwidthLimits();
+}
+
 void SessionImpl::configure()
 {
     m_nativeSession->apply_settings(loadLTSettings());
@@ -1351,21 +1783,41 @@ void SessionImpl::prepareStartup()
 
     auto *context = new ResumeSessionContext(this);
     context->currentStorageType = resumeDataStorageType();
+    context->startupTimer.start();
 
     if (context->currentStorageType == ResumeDataStorageType::SQLite)
     {
-        m_resumeDataStorage = new DBResumeDataStorage(dbPath, this);
-
-        if (!dbStorageExists)
+        // Resume data files are kept once they are moved to the database, so the migration
+        // interrupted by previous session is just started over, overwriting the data moved so far.
+        // The marker is created before the database, so the database never exists without it
+        // until the migration is complete.
+        const Path migrationMarkerPath = specialFolderLocation(SpecialFolder::Data) / RESUME_DATA_MIGRATION_MARKER;
+        const bool isMigrationInterrupted = dbStorageExists && migrationMarkerPath.exists();
+        if (!dbStorageExists || isMigrationInterrupted)
         {
+            if (isMigrationInterrupted)
+            {
+                LogMsg(tr("Moving resume data to the database was interrupted. Starting it over"), Log::WARNING);
+            }
+            else if (const auto result = Utils::IO::saveToFile(migrationMarkerPath, {}); !result)
+            {
+                LogMsg(tr("Failed to create resume data migration marker. File: \"%1\". Error: \"%2\"")
+                        .arg(migrationMarkerPath.toString(), result.error()), Log::WARNING);
+            }
+
             const Path dataPath = specialFolderLocation(SpecialFolder::Data) / Path(u"BT_backup"_s);
-            context->startupStorage = new BencodeResumeDataStorage(dataPath, this);
+            context->startupStorage = new BencodeResumeDataStorage(dataPath, isResumeDataStorageSharded(), this);
+            context->migrationMarkerPath = migrationMarkerPath;
         }
+
+        auto *dbStorage = new DBResumeDataStorage(dbPath, this);
+        dbStorage->setBatchLimits(resumeDataStorageBatchSize(), resumeDataStorageBatchLatency());
+        m_resumeDataStorage = dbStorage;
     }
     else
     {
         const Path dataPath = specialFolderLocation(SpecialFolder::Data) / Path(u"BT_backup"_s);
-        m_resumeDataStorage = new BencodeResumeDataStorage(dataPath, this);
+        m_resumeDataStorage = new BencodeResumeDataStorage(dataPath, isResumeDataStorageSharded(), this);
 
         if (dbStorageExists)
             context->startupStorage = new DBResumeDataStorage(dbPath, this);
@@ -1374,10 +1826,20 @@ void SessionImpl::prepareStartup()
     if (!context->startupStorage)
         context->startupStorage = m_resumeDataStorage;
 
+    // loading can't be deferred while resume data is being moved to another storage
+    context->isDeferringEnabled = isDeferredStoppedTorrentsLoadingEnabled() && (context->startupStorage == m_resumeDataStorage);
+
     connect(context->startupStorage, &ResumeDataStorage::loadStarted, context
             , [this, context](const QVector<TorrentID> &torrents)
     {
+        context->loadStartedTime = context->startupTimer.elapsed();
         context->totalResumeDataCount = torrents.size();
+        if (context->startupStorage != m_resumeDataStorage)
+        {
+            LogMsg(tr("Moving resume data of %1 torrents to %2 storage")
+                    .arg(QString::number(torrents.size())
+                        , ((context->currentStorageType == ResumeDataStorageType::SQLite) ? u"SQLite"_s : tr("file based"))));
+        }
 #ifdef QBT_USES_LIBTORRENT2
         context->indexedTorrents = QSet<TorrentID>(torrents.cbegin(), torrents.cend());
 #endif
@@ -1387,6 +1849,7 @@ void SessionImpl::prepareStartup()
 
     connect(context->startupStorage, &ResumeDataStorage::loadFinished, context, [context]()
     {
+        context->loadFinishedTime = context->startupTimer.elapsed();
         context->isLoadFinished = true;
     });
 
@@ -1402,7 +1865,8 @@ void SessionImpl::prepareStartup()
 
         if (!m_refreshEnqueued)
         {
-            m_nativeSession->post_torrent_updates();
+            m_postedStatusFlags = lt::status_flags_t::all();
+            m_nativeSession->post_torrent_updates(m_postedStatusFlags);
             m_refreshEnqueued = true;
         }
 
@@ -1440,6 +1904,16 @@ void SessionImpl::handleLoadedResumeData(ResumeSessionContext *context)
             break;
         }
 
+        // stopped completed torrents aren't needed to get the session running,
+        // so they can be restored after the startup is finished
+        if (const LoadResumeDataResult &result = context->loadedResumeData.first().result
+                ; context->isDeferringEnabled && result && result->stopped && result->hasFinishedStatus)
+        {
+            context->deferredResumeData.append(context->loadedResumeData.takeFirst());
+            --context->totalResumeDataCount;
+            continue;
+        }
+
         processNextResumeData(context);
         ++count;
     }
@@ -1449,6 +1923,8 @@ void SessionImpl::handleLoadedResumeData(ResumeSessionContext *context)
 
 void SessionImpl::processNextResumeData(ResumeSessionContext *context)
 {
+    QBT_TRACE_SCOPE("SessionImpl::processNextResumeData");
+
     const LoadedResumeData loadedResumeDataItem = context->loadedResumeData.takeFirst();
 
     TorrentID torrentID = loadedResumeDataItem.torrentID;
@@ -1530,8 +2006,10 @@ void SessionImpl::processNextResumeData(ResumeSessionContext *context)
     }
 #endif
 
-    if (m_resumeDataStorage != context->startupStorage)
-       needStore = true;
+    // resume data moved to the current storage is stored in batches along with the other torrents
+    const bool isMigrated = (m_resumeDataStorage != context->startupStorage);
+    if (isMigrated)
+        needStore = true;
 
     // TODO: Remove the following upgrade code in v4.6
     // == BEGIN UPGRADE CODE ==
@@ -1545,8 +2023,16 @@ void SessionImpl::processNextResumeData(ResumeSessionContext *context)
     }
     // == END UPGRADE CODE ==
 
-    if (needStore)
-         m_resumeDataStorage->store(torrentID, resumeData);
+    if (isMigrated)
+    {
+        context->migratedResumeData.insert(torrentID, resumeData);
+        if (context->migratedResumeData.size() >= RESUME_DATA_MIGRATION_BATCH_SIZE)
+            storeMigratedResumeData(context);
+    }
+    else if (needStore)
+    {
+        m_resumeDataStorage->store(torrentID, resumeData);
+    }
 
     const QString category = resumeData.category;
     bool isCategoryRecovered = context->recoveredCategories.contains(category);
@@ -1606,10 +2092,21 @@ void SessionImpl::processNextResumeData(ResumeSessionContext *context)
     });
 
     resumeData.ltAddTorrentParams.userdata = LTClientData(new ExtensionData);
+    // connections budgets are assigned again once the torrents are running
+    resumeData.ltAddTorrentParams.max_connections = maxConnectionsPerTorrent();
 #ifndef QBT_USES_LIBTORRENT2
     resumeData.ltAddTorrentParams.storage = customStorageConstructor;
 #endif
 
+    resumeData.isDeferred = context->isLoadingDeferred;
+
+    if (isTrustedResumeDataEnabled() && resumeData.ltAddTorrentParams.ti
+            && isCleanShutdownPath(context, Path(resumeData.ltAddTorrentParams.save_path)))
+    {
+        trustResumeData(torrentID);
+        m_trustedResumeDataTorrents.insert(torrentID);
+    }
+
     qDebug() << "Starting up torrent" << torrentID.toString() << "...";
     m_loadingTorrents.insert(torrentID, resumeData);
 #ifdef QBT_USES_LIBTORRENT2
@@ -1624,8 +2121,67 @@ void SessionImpl::processNextResumeData(ResumeSessionContext *context)
     ++context->processingResumeDataCount;
 }
 
+void SessionImpl::storeMigratedResumeData(ResumeSessionContext *context)
+{
+    if (context->migratedResumeData.isEmpty())
+        return;
+
+    context->migratedResumeDataCount += context->migratedResumeData.size();
+    m_resumeDataStorage->storeAll(std::exchange(context->migratedResumeData, {}));
+
+    LogMsg(tr("Moving resume data to the new storage. Progress: %1/%2")
+            .arg(QString::number(context->migratedResumeDataCount), QString::number(context->totalResumeDataCount)));
+}
+
 void SessionImpl::endStartup(ResumeSessionContext *context)
 {
+    if (m_resumeDataStorage != context->startupStorage)
+    {
+        storeMigratedResumeData(context);
+        LogMsg(tr("Moved resume data of %1 torrents to the new storage").arg(QString::number(context->migratedResumeDataCount)));
+        // the data is queued to the storage which writes it before it's destroyed
+        if (!context->migrationMarkerPath.isEmpty())
+            Utils::Fs::removeFile(context->migrationMarkerPath);
+    }
+
+    const qint64 startupTime = context->startupTimer.elapsed();
+    LogMsg(tr("Restored %1 torrents in %2 ms. Listing torrents: %3 ms. Loading resume data: %4 ms. Adding remaining torrents: %5 ms")
+            .arg(QString::number(m_torrents.size()), QString::number(startupTime), QString::number(context->loadStartedTime)
+                , QString::number(context->loadFinishedTime - context->loadStartedTime), QString::number(startupTime - context->loadFinishedTime)));
+
+    if (!context->deferredResumeData.isEmpty())
+    {
+        // The startup context finishes its job as usual, so the session becomes restored.
+        // Deferred torrents are then restored by separate context in the background.
+        auto *deferredContext = new ResumeSessionContext(this);
+        deferredContext->startupStorage = context->startupStorage;
+        deferredContext->currentStorageType = context->currentStorageType;
+        deferredContext->loadedResumeData = std::exchange(context->deferredResumeData, {});
+        deferredContext->isLoadFinished = true;
+        deferredContext->isLoadingDeferred = true;
+        deferredContext->recoveredCategories = context->recoveredCategories;
+        deferredContext->cleanShutdownPaths = context->cleanShutdownPaths;
+#ifdef QBT_USES_LIBTORRENT2
+        deferredContext->indexedTorrents = context->indexedTorrents;
+        deferredContext->skippedIDs = context->skippedIDs;
+#endif
+        deferredContext->startupTimer.start();
+
+        connect(this, &SessionImpl::addTorrentAlertsReceived, deferredContext, [this, deferredContext]
+        {
+            if (!deferredContext->isLoadedResumeDataHandlingEnqueued)
+            {
+                QMetaObject::invokeMethod(this, [this, deferredContext] { handleDeferredResumeData(deferredContext); }, Qt::QueuedConnection);
+                deferredContext->isLoadedResumeDataHandlingEnqueued = true;
+            }
+        });
+        connect(this, &SessionImpl::restored, deferredContext, [this, deferredContext]
+        {
+            LogMsg(tr("Restoring %1 stopped torrents in the background").arg(deferredContext->loadedResumeData.size()));
+            handleDeferredResumeData(deferredContext);
+        }, Qt::SingleShotConnection);
+    }
+
     if (m_resumeDataStorage != context->startupStorage)
     {
         if (isQueueingSystemEnabled())
@@ -1680,53 +2236,196 @@ void SessionImpl::endStartup(ResumeSessionContext *context)
         m_wakeupCheckTimestamp = QDateTime::currentDateTime();
         m_wakeupCheckTimer->start(30s);
 
+        if (!m_trustedResumeDataTorrents.isEmpty())
+        {
+            LogMsg(tr("Skipped checking files of %1 torrents after clean shutdown. They will be verified in the background")
+                .arg(m_trustedResumeDataTorrents.size()));
+            QTimer::singleShot(TRUSTED_RESUME_DATA_VERIFICATION_DELAY, this, &SessionImpl::verifyTrustedResumeData);
+        }
+
         m_isRestored = true;
         emit startupProgressUpdated(100);
         emit restored();
     });
 }
 
-void SessionImpl::initializeNativeSession()
+void SessionImpl::handleDeferredResumeData(ResumeSessionContext *context)
 {
-    lt::settings_pack pack = loadLTSettings();
-
-    const std::string peerId = lt::generate_fingerprint(PEER_ID, QBT_VERSION_MAJOR, QBT_VERSION_MINOR, QBT_VERSION_BUGFIX, QBT_VERSION_BUILD);
-    pack.set_str(lt::settings_pack::peer_fingerprint, peerId);
+    context->isLoadedResumeDataHandlingEnqueued = false;
 
-    pack.set_bool(lt::settings_pack::listen_system_port_fallback, false);
-    pack.set_str(lt::settings_pack::user_agent, USER_AGENT.toStdString());
-    pack.set_bool(lt::settings_pack::use_dht_as_fallback, false);
-    // Speed up exit
-    pack.set_int(lt::settings_pack::auto_scrape_interval, 1200); // 20 minutes
-    pack.set_int(lt::settings_pack::auto_scrape_min_interval, 900); // 15 minutes
-    // libtorrent 1.1 enables UPnP & NAT-PMP by default
-    // turn them off before `lt::session` ctor to avoid split second effects
-    pack.set_bool(lt::settings_pack::enable_upnp, false);
-    pack.set_bool(lt::settings_pack::enable_natpmp, false);
+    // torrents added by user are counted too, so they aren't slowed down by the background loading
+    while (!context->loadedResumeData.isEmpty() && (m_loadingTorrents.size() < MAX_PROCESSING_RESUMEDATA_COUNT))
+    {
+        // the same torrent could be added by user in the meantime
+        if (m_torrents.contains(context->loadedResumeData.first().torrentID))
+        {
+            context->loadedResumeData.removeFirst();
+            continue;
+        }
 
-#ifdef QBT_USES_LIBTORRENT2
-    // preserve the same behavior as in earlier libtorrent versions
-    pack.set_bool(lt::settings_pack::enable_set_file_valid_data, true);
+        processNextResumeData(context);
+    }
 
-    // This is a special case. We use MMap disk IO but tweak it to always fallback to pread/pwrite.
-    if (diskIOType() == DiskIOType::SimplePreadPwrite)
+    if (context->loadedResumeData.isEmpty())
     {
-        pack.set_int(lt::settings_pack::mmap_file_size_cutoff, std::numeric_limits<int>::max());
-        pack.set_int(lt::settings_pack::disk_write_mode, lt::settings_pack::mmap_write_mode_t::always_pwrite);
+        LogMsg(tr("Restored stopped torrents in the background. Elapsed time: %1 ms")
+                .arg(QString::number(context->startupTimer.elapsed())));
+        context->deleteLater();
     }
-#endif
+}
 
-    lt::session_params sessionParams {std::move(pack), {}};
-#ifdef QBT_USES_LIBTORRENT2
-    switch (diskIOType())
+bool SessionImpl::isCleanShutdownPath(ResumeSessionContext *context, const Path &path) const
+{
+    if (const auto it = context->cleanShutdownPaths.constFind(path); it != context->cleanShutdownPaths.cend())
+        return it.value();
+
+    const Path markerPath = path / CLEAN_SHUTDOWN_MARKER;
+    const bool isClean = markerPath.exists();
+    // the files can be modified once the session is started, so the marker is valid only once
+    if (isClean)
+        Utils::Fs::removeFile(markerPath);
+
+    context->cleanShutdownPaths.insert(path, isClean);
+    return isClean;
+}
+
+void SessionImpl::writeCleanShutdownMarkers(const QSet<Path> &paths) const
+{
+    const QByteArray data = QDateTime::currentDateTime().toString(Qt::ISODate).toLatin1();
+    for (const Path &path : paths)
     {
-    case DiskIOType::Posix:
-        sessionParams.disk_io_constructor = customPosixDiskIOConstructor;
-        break;
-    case DiskIOType::MMap:
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile((path / CLEAN_SHUTDOWN_MARKER), data);
+        if (!result)
+        {
+            LogMsg(tr("Failed to mark clean shutdown. Path: \"%1\". Error: \"%2\"")
+                .arg(path.toString(), result.error()), Log::WARNING);
+        }
+    }
+}
+
+void SessionImpl::verifyTrustedResumeData()
+{
+    QList<ExpectedTorrentFiles> torrents;
+    torrents.reserve(m_trustedResumeDataTorrents.size());
+    for (const TorrentID &torrentID : asConst(m_trustedResumeDataTorrents))
+    {
+        const TorrentImpl *torrent = m_torrents.value(torrentID);
+        if (!torrent || !torrent->hasMetadata() || torrent->isChecking() || torrent->isMoving())
+            continue;
+
+        ExpectedTorrentFiles expected {torrentID, torrent->actualStorageLocation(), {}};
+        const QVector<qreal> filesProgress = torrent->filesProgress();
+        for (int i = 0; i < filesProgress.size(); ++i)
+        {
+            // nothing is expected on the disk yet
+            if (filesProgress[i] <= 0)
+                continue;
+
+            expected.files.append({(expected.storageLocation / torrent->actualFilePath(i)), torrent->fileSize(i), (filesProgress[i] >= 1)});
+        }
+
+        if (!expected.files.isEmpty())
+            torrents.append(std::move(expected));
+    }
+    m_trustedResumeDataTorrents.clear();
+
+    // it stats every file so it is run in separate low priority thread not to delay any other disk access
+    m_trustedResumeDataVerificationThread.reset(QThread::create([this, torrents = std::move(torrents)]
+    {
+        QHash<TorrentID, Path> failedTorrents;
+        for (const ExpectedTorrentFiles &torrent : torrents)
+        {
+            if (m_isTrustedResumeDataVerificationAborted)
+                return;
+
+            const bool isIntact = std::all_of(torrent.files.cbegin(), torrent.files.cend(), [](const ExpectedFile &file)
+            {
+                const QFileInfo fileInfo {file.path.data()};
+                return fileInfo.exists() && (!file.isComplete || (fileInfo.size() == file.size));
+            });
+            if (!isIntact)
+                failedTorrents.insert(torrent.torrentID, torrent.storageLocation);
+        }
+
+        QMetaObject::invokeMethod(this, [this, failedTorrents]
+        {
+            handleTrustedResumeDataVerified(failedTorrents);
+        }, Qt::QueuedConnection);
+    }));
+    m_trustedResumeDataVerificationThread->start(QThread::IdlePriority);
+}
+
+void SessionImpl::handleTrustedResumeDataVerified(const QHash<TorrentID, Path> &failedTorrents)
+{
+    m_trustedResumeDataVerificationThread.reset();
+
+    for (auto it = failedTorrents.cbegin(); it != failedTorrents.cend(); ++it)
+    {
+        TorrentImpl *torrent = m_torrents.value(it.key());
+        // the torrent could be removed or relocated in the meantime
+        if (!torrent || (torrent->actualStorageLocation() != it.value()))
+            continue;
+
+        LogMsg(tr("Files of the torrent don't match its trusted fastresume data. Rechecking torrent. Torrent: \"%1\"")
+            .arg(torrent->name()), Log::WARNING);
+        torrent->forceRecheck();
+    }
+
+    LogMsg(tr("Verified files of the torrents resumed after clean shutdown. Mismatching torrents: %1")
+        .arg(failedTorrents.size()));
+}
+
+void SessionImpl::initializeNativeSession()
+{
+    lt::settings_pack pack = loadLTSettings();
+
+    const std::string peerId = lt::generate_fingerprint(PEER_ID, QBT_VERSION_MAJOR, QBT_VERSION_MINOR, QBT_VERSION_BUGFIX, QBT_VERSION_BUILD);
+    pack.set_str(lt::settings_pack::peer_fingerprint, peerId);
+
+    pack.set_bool(lt::settings_pack::listen_system_port_fallback, false);
+    pack.set_str(lt::settings_pack::user_agent, USER_AGENT.toStdString());
+    pack.set_bool(lt::settings_pack::use_dht_as_fallback, false);
+    // Speed up exit
+    pack.set_int(lt::settings_pack::auto_scrape_interval, 1200); // 20 minutes
+    pack.set_int(lt::settings_pack::auto_scrape_min_interval, 900); // 15 minutes
+    // libtorrent 1.1 enables UPnP & NAT-PMP by default
+    // turn them off before `lt::session` ctor to avoid split second effects
+    pack.set_bool(lt::settings_pack::enable_upnp, false);
+    pack.set_bool(lt::settings_pack::enable_natpmp, false);
+
+#ifdef QBT_USES_LIBTORRENT2
+    // preserve the same behavior as in earlier libtorrent versions
+    pack.set_bool(lt::settings_pack::enable_set_file_valid_data, true);
+
+    // This is a special case. We use MMap disk IO but tweak it to always fallback to pread/pwrite.
+    if (diskIOType() == DiskIOType::SimplePreadPwrite)
+    {
+        pack.set_int(lt::settings_pack::mmap_file_size_cutoff, std::numeric_limits<int>::max());
+        pack.set_int(lt::settings_pack::disk_write_mode, lt::settings_pack::mmap_write_mode_t::always_pwrite);
+    }
+#endif
+
+    lt::session_params sessionParams {std::move(pack), {}};
+    loadSessionState(sessionParams);
+#ifdef QBT_USES_LIBTORRENT2
+    CustomDiskIOThread::setMaxActiveJobsPerDevice(diskIOJobsPerDevice());
+    CustomDiskIOThread::setReadsPerHashJob(diskIOReadsPerHashJob());
+    CustomDiskIOThread::setReadCacheSize(diskReadCacheSize() * 1024LL * 1024);
+
+    switch (diskIOType())
+    {
+    case DiskIOType::Posix:
+        sessionParams.disk_io_constructor = customPosixDiskIOConstructor;
+        break;
+    case DiskIOType::MMap:
     case DiskIOType::SimplePreadPwrite:
         sessionParams.disk_io_constructor = customMMapDiskIOConstructor;
         break;
+#ifdef QBT_USES_IO_URING
+    case DiskIOType::IOUring:
+        sessionParams.disk_io_constructor = customIOUringDiskIOConstructor;
+        break;
+#endif
     default:
         sessionParams.disk_io_constructor = customDiskIOConstructor;
         break;
@@ -1745,27 +2444,30 @@ void SessionImpl::initializeNativeSession()
     LogMsg(tr("Distributed Hash Table (DHT) support: %1").arg(isDHTEnabled() ? tr("ON") : tr("OFF")), Log::INFO);
     LogMsg(tr("Local Peer Discovery support: %1").arg(isLSDEnabled() ? tr("ON") : tr("OFF")), Log::INFO);
     // Enhanced features
-    const Path peersDbPath = specialFolderLocation(SpecialFolder::Data) / Path(u"peers.db"_s);
-    db_connection::instance().init(peersDbPath.toString());
-    m_nativeSession->add_extension(&create_drop_bad_peers_plugin);
-    if (isAutoBanUnknownPeerEnabled()) {
-        m_nativeSession->add_extension(&create_drop_unknown_peers_plugin);
-        m_nativeSession->add_extension(&create_drop_offline_downloader_plugin);
-    }
-    if (isAutoBanBTPlayerPeerEnabled())
-        m_nativeSession->add_extension(&create_drop_bittorrent_media_player_plugin);
-    m_nativeSession->add_extension(std::make_shared<peer_filter_session_plugin>());
-    if (isShadowBanEnabled())
-        m_nativeSession->add_extension(&create_peer_shadowban_plugin);
+    db_connection::instance().init(BannedPeersHistory::databasePath().toString());
+    peer_logger_singleton::instance().set_retention_days(bannedPeersHistoryDays());
+    peer_logger_singleton::instance().start();
+    builtin_peer_rules::options peerRulesOptions;
+    peerRulesOptions.unknown_peers = isAutoBanUnknownPeerEnabled();
+    peerRulesOptions.offline_downloaders = isAutoBanUnknownPeerEnabled();
+    peerRulesOptions.media_players = isAutoBanBTPlayerPeerEnabled();
+    m_shadowBanPeerClass = m_nativeSession->create_peer_class("shadowbanned");
+    lt::peer_class_info shadowBanClassInfo = m_nativeSession->get_peer_class(m_shadowBanPeerClass);
+    // zero means unlimited, so the slowest possible rate is used instead
+    shadowBanClassInfo.upload_limit = 1;
+    shadowBanClassInfo.upload_priority = 1;
+    m_nativeSession->set_peer_class(m_shadowBanPeerClass, shadowBanClassInfo);
+    ShadowBanTable::publish(m_shadowBannedIPs);
+    // all the peer policies are evaluated by single plugin per connection
+    m_peerPolicy = std::make_shared<peer_policy>(peerRulesOptions, isShadowBanEnabled());
+    m_nativeSession->add_extension(std::make_shared<peer_policy_session_plugin>(m_peerPolicy));
+    watchPeerFilters();
 
     LogMsg(tr("Peer Exchange (PeX) support: %1").arg(isPeXEnabled() ? tr("ON") : tr("OFF")), Log::INFO);
     LogMsg(tr("Anonymous mode: %1").arg(isAnonymousModeEnabled() ? tr("ON") : tr("OFF")), Log::INFO);
     LogMsg(tr("Encryption support: %1").arg((encryption() == 0) ? tr("ON") : ((encryption() == 1) ? tr("FORCED") : tr("OFF"))), Log::INFO);
 
-    m_nativeSession->set_alert_notify([this]()
-    {
-        QMetaObject::invokeMethod(this, &SessionImpl::readAlerts, Qt::QueuedConnection);
-    });
+    startAlertsThread();
 
     // Enabling plugins
     m_nativeSession->add_extension(&lt::create_smart_ban_plugin);
@@ -1778,19 +2480,332 @@ void SessionImpl::initializeNativeSession()
     m_nativeSessionExtension = nativeSessionExtension.get();
 }
 
+void SessionImpl::initCountryFiltering()
+{
+    auto *geoIPManager = Net::GeoIPManager::instance();
+    if (!geoIPManager)
+        return;
+
+    connect(geoIPManager, &Net::GeoIPManager::databaseChanged, this, &SessionImpl::updateBlockedCountryRanges);
+    if (geoIPManager->isDatabaseLoaded())
+        updateBlockedCountryRanges();
+    // the ranges are updated once the database is loaded
+    geoIPManager->setDatabaseRequired(!blockedCountries().isEmpty());
+}
+
+void SessionImpl::updateBlockedCountryRanges()
+{
+    QSet<quint16> countryCodes;
+    for (const QString &country : asConst(blockedCountries()))
+        countryCodes.insert(Net::GeoIPManager::countryCode(country));
+
+    std::vector<std::pair<lt::address, lt::address>> ranges;
+    if (auto *geoIPManager = Net::GeoIPManager::instance(); geoIPManager && !countryCodes.isEmpty())
+    {
+        const QList<Utils::Net::Subnet> networks = geoIPManager->countryNetworks(countryCodes);
+        ranges.reserve(networks.size());
+        for (const Utils::Net::Subnet &network : networks)
+            ranges.push_back(toNativeRange(network));
+    }
+
+    if (ranges.empty() && m_blockedCountryRanges.empty())
+        return;
+
+    m_blockedCountryRanges = std::move(ranges);
+    applyParsedIPFilter();
+
+    if (!m_blockedCountryRanges.empty())
+    {
+        LogMsg(tr("Blocked address ranges of the countries: %1. Number of ranges: %2")
+            .arg(blockedCountries().join(u", "), QString::number(m_blockedCountryRanges.size())));
+    }
+}
+
+void SessionImpl::processBlockedCountries(lt::ip_filter &filter) const
+{
+    for (const auto &[first, last] : m_blockedCountryRanges)
+        filter.add_rule(first, last, lt::ip_filter::blocked);
+}
+
 void SessionImpl::processBannedIPs(lt::ip_filter &filter)
 {
+    const QVariantMap expirations = m_bannedIPsExpiration;
+    m_bannedIPsFilterAccess.clear();
+
     // First, import current filter
-    for (const QString &ip : asConst(m_bannedIPs.get()))
+    for (const QString &ip : asConst(m_bannedIPsIndex))
     {
         lt::error_code ec;
         const lt::address addr = lt::make_address(ip.toLatin1().constData(), ec);
         Q_ASSERT(!ec);
-        if (!ec)
-            filter.add_rule(addr, addr, lt::ip_filter::blocked);
+        if (ec)
+            continue;
+
+        if (expirations.contains(ip))
+            m_bannedIPsFilterAccess.insert(ip, filter.access(addr));
+        filter.add_rule(addr, addr, lt::ip_filter::blocked);
+    }
+}
+
+void SessionImpl::applyParsedIPFilter()
+{
+    applyIPFilter(m_IPFilterSubscriptionManager->merge(m_parsedIPFilter));
+}
+
+void SessionImpl::handleIPFilterSubscriptionsChanged()
+{
+    if (!isIPFilteringEnabled())
+        return;
+
+    applyParsedIPFilter();
+    LogMsg(tr("Applied IP filter subscriptions. Number of rules: %1").arg(m_IPFilterSubscriptionManager->ruleCount()));
+}
+
+void SessionImpl::applyIPFilter(lt::ip_filter filter)
+{
+    // country rules go first, so the access restored when a ban expires includes them
+    processBlockedCountries(filter);
+    processBannedIPs(filter);
+    m_IPFilter = std::move(filter);
+    m_nativeSession->set_ip_filter(m_IPFilter);
+}
+
+void SessionImpl::applyPendingBannedIPs()
+{
+    m_bannedIPsApplyTimer->stop();
+    if (m_pendingBannedIPs.isEmpty())
+        return;
+
+    const QVariantMap expirations = m_bannedIPsExpiration;
+    for (const QString &ip : asConst(m_pendingBannedIPs))
+    {
+        lt::error_code ec;
+        const lt::address addr = lt::make_address(ip.toLatin1().constData(), ec);
+        if (ec)
+            continue;
+
+        if (expirations.contains(ip))
+            m_bannedIPsFilterAccess.insert(ip, m_IPFilter.access(addr));
+        m_IPFilter.add_rule(addr, addr, lt::ip_filter::blocked);
+    }
+    m_nativeSession->set_ip_filter(m_IPFilter);
+
+    QStringList bannedIPs = m_bannedIPs;
+    bannedIPs.append(m_pendingBannedIPs);
+    bannedIPs.sort();
+    m_bannedIPs = bannedIPs;
+
+    m_pendingBannedIPs.clear();
+}
+
+void SessionImpl::loadBanExpirations()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    m_banExpirationWheel = TimerWheel<ExpiringBan>(now);
+
+    const auto load = [this, now](CachedSettingValue<QStringList> &bannedIPs
+        , CachedSettingValue<QVariantMap> &expirations, const bool isShadowBan)
+    {
+        const QStringList storedIPs = bannedIPs;
+        const QVariantMap storedExpirations = expirations;
+        if (storedExpirations.isEmpty())
+            return;
+
+        const QSet<QString> ips {storedIPs.cbegin(), storedIPs.cend()};
+        QSet<QString> expiredIPs;
+        QVariantMap validExpirations;
+        for (auto it = storedExpirations.cbegin(); it != storedExpirations.cend(); ++it)
+        {
+            // ban could be lifted by editing the list
+            if (!ips.contains(it.key()))
+                continue;
+
+            const qint64 expiresAt = it.value().toLongLong();
+            if (expiresAt <= now)
+            {
+                expiredIPs.insert(it.key());
+                continue;
+            }
+
+            validExpirations.insert(it.key(), expiresAt);
+            m_banExpirationWheel.insert({.ip = it.key(), .isShadowBan = isShadowBan}, expiresAt);
+        }
+
+        if (!expiredIPs.isEmpty())
+        {
+            QStringList remainingIPs = storedIPs;
+            remainingIPs.removeIf([&expiredIPs](const QString &ip) { return expiredIPs.contains(ip); });
+            bannedIPs = remainingIPs;
+        }
+        expirations = validExpirations;
+    };
+
+    load(m_bannedIPs, m_bannedIPsExpiration, false);
+    load(m_shadowBannedIPs, m_shadowBannedIPsExpiration, true);
+
+    if (!m_banExpirationWheel.isEmpty())
+        m_banExpirationTimer->start();
+}
+
+void SessionImpl::updateBanExpiration(const QString &ip, const std::chrono::seconds duration
+    , const bool isShadowBan, const bool isBanned)
+{
+    CachedSettingValue<QVariantMap> &storedExpirations = isShadowBan ? m_shadowBannedIPsExpiration : m_bannedIPsExpiration;
+    QVariantMap expirations = storedExpirations;
+    const auto it = expirations.find(ip);
+
+    if (duration <= 0s)
+    {
+        // permanent ban overrides temporary one
+        if (it == expirations.end())
+            return;
+
+        expirations.erase(it);
+        if (!isShadowBan)
+            m_bannedIPsFilterAccess.remove(ip);
+    }
+    else
+    {
+        // already banned permanently
+        if (isBanned && (it == expirations.end()))
+            return;
+
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        const qint64 expiresAt = now + duration.count();
+        if ((it != expirations.end()) && (it.value().toLongLong() >= expiresAt))
+            return;
+
+        expirations[ip] = expiresAt;
+        // stale entry of prolonged ban stays in the wheel and is skipped once it expires
+        m_banExpirationWheel.advance(now);
+        m_banExpirationWheel.insert({.ip = ip, .isShadowBan = isShadowBan}, expiresAt);
+        if (!m_banExpirationTimer->isActive())
+            m_banExpirationTimer->start();
+    }
+
+    storedExpirations = expirations;
+}
+
+void SessionImpl::processBanExpirations()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const QList<ExpiringBan> expiredBans = m_banExpirationWheel.advance(now);
+    if (m_banExpirationWheel.isEmpty())
+        m_banExpirationTimer->stop();
+    if (expiredBans.isEmpty())
+        return;
+
+    QVariantMap bannedIPsExpiration = m_bannedIPsExpiration;
+    QVariantMap shadowBannedIPsExpiration = m_shadowBannedIPsExpiration;
+    QSet<QString> unbannedIPs;
+    QSet<QString> unshadowbannedIPs;
+    for (const ExpiringBan &ban : expiredBans)
+    {
+        QVariantMap &expirations = ban.isShadowBan ? shadowBannedIPsExpiration : bannedIPsExpiration;
+        const auto it = expirations.find(ban.ip);
+        // ban could be made permanent, prolonged or lifted in the meantime
+        if ((it == expirations.end()) || (it.value().toLongLong() > now))
+            continue;
+
+        expirations.erase(it);
+        (ban.isShadowBan ? unshadowbannedIPs : unbannedIPs).insert(ban.ip);
+    }
+
+    if (!unbannedIPs.isEmpty())
+    {
+        applyPendingBannedIPs();
+
+        for (const QString &ip : asConst(unbannedIPs))
+        {
+            m_bannedIPsIndex.remove(ip);
+
+            lt::error_code ec;
+            const lt::address addr = lt::make_address(ip.toLatin1().constData(), ec);
+            if (!ec)
+                m_IPFilter.add_rule(addr, addr, m_bannedIPsFilterAccess.take(ip));
+        }
+        m_nativeSession->set_ip_filter(m_IPFilter);
+
+        QStringList bannedIPs = m_bannedIPs;
+        bannedIPs.removeIf([&unbannedIPs](const QString &ip) { return unbannedIPs.contains(ip); });
+        m_bannedIPs = bannedIPs;
+        m_bannedIPsExpiration = bannedIPsExpiration;
+    }
+
+    if (!unshadowbannedIPs.isEmpty())
+    {
+        QStringList shadowBannedIPs = m_shadowBannedIPs;
+        shadowBannedIPs.removeIf([&unshadowbannedIPs](const QString &ip) { return unshadowbannedIPs.contains(ip); });
+        m_shadowBannedIPs = shadowBannedIPs;
+        m_shadowBannedIPsExpiration = shadowBannedIPsExpiration;
+        publishShadowBannedIPs(shadowBannedIPs);
     }
 }
 
+void SessionImpl::watchPeerFilters()
+{
+    const Path dataDir = specialFolderLocation(SpecialFolder::Data);
+    const QStringList filterFiles {(dataDir / Path(u"peer_blacklist.txt"_s)).data()
+        , (dataDir / Path(u"peer_whitelist.txt"_s)).data()};
+    const auto filesModified = [filterFiles]
+    {
+        QList<QDateTime> result;
+        for (const QString &file : filterFiles)
+            result.append(QFileInfo(file).lastModified());
+        return result;
+    };
+
+    m_peerFiltersModified = filesModified();
+
+    // editors may save file in several steps, so reload rules once the changes settle
+    m_peerFiltersReloadTimer = new QTimer(this);
+    m_peerFiltersReloadTimer->setSingleShot(true);
+    m_peerFiltersReloadTimer->setInterval(1s);
+    connect(m_peerFiltersReloadTimer, &QTimer::timeout, this, [this, filesModified]
+    {
+        QList<QDateTime> modified = filesModified();
+        if (modified == m_peerFiltersModified)
+            return;
+
+        m_peerFiltersModified = std::move(modified);
+        reloadPeerFilters();
+    });
+
+    // files which are replaced or created later aren't tracked by watcher,
+    // so the data directory is watched as well and files are added again
+    m_peerFiltersWatcher = new QFileSystemWatcher(this);
+    const auto watchFiles = [this, filterFiles]
+    {
+        const QStringList watchedFiles = m_peerFiltersWatcher->files();
+        for (const QString &file : filterFiles)
+        {
+            if (!watchedFiles.contains(file) && QFile::exists(file))
+                m_peerFiltersWatcher->addPath(file);
+        }
+    };
+    m_peerFiltersWatcher->addPath(dataDir.data());
+    watchFiles();
+
+    connect(m_peerFiltersWatcher, &QFileSystemWatcher::fileChanged, m_peerFiltersReloadTimer, qOverload<>(&QTimer::start));
+    connect(m_peerFiltersWatcher, &QFileSystemWatcher::directoryChanged, this, [this, watchFiles]
+    {
+        watchFiles();
+        m_peerFiltersReloadTimer->start();
+    });
+}
+
+void SessionImpl::reloadPeerFilters()
+{
+    LogMsg(tr("Peer filter files changed. Reloading peer filters."));
+
+    // parsing rules may take a while, existing connections are evaluated
+    // again once the new rules are published
+    QThreadPool::globalInstance()->start([peerPolicy = m_peerPolicy]
+    {
+        peerPolicy->reload_filters();
+    });
+}
+
 void SessionImpl::initMetrics()
 {
     const auto findMetricIndex = [](const char *name) -> int
@@ -1842,6 +2857,20 @@ void SessionImpl::initMetrics()
             .diskJobTime = findMetricIndex("disk.disk_job_time")
         }
     };
+
+    const std::vector<lt::stats_metric> statsMetrics = lt::session_stats_metrics();
+    m_sessionCounters.reserve(static_cast<qsizetype>(statsMetrics.size()));
+    for (const lt::stats_metric &metric : statsMetrics)
+    {
+        const SessionCounter counter
+        {
+            .name = QString::fromLatin1(metric.name),
+            .isGauge = (metric.type == lt::metric_type_t::gauge)
+        };
+        m_sessionCounters.append({counter, metric.value_index});
+    }
+
+    m_metricsTimer.start();
 }
 
 void SessionImpl::populatePublicTrackers()
@@ -1855,6 +2884,79 @@ void SessionImpl::populatePublicTrackers()
         if (!tracker.isEmpty())
             m_publicTrackerList.append({tracker.toString()});
     }
+
+    rankPublicTrackers();
+}
+
+void SessionImpl::rankPublicTrackers()
+{
+    m_rankedPublicTrackers = m_trackerHealthRegistry.rankTrackers(m_publicTrackerList, maxPublicTrackersPerTorrent());
+
+    // forget announces which never got any result
+    const lt::time_point expirationTime = lt::clock_type::now() - lt::minutes(10);
+    const QMutexLocker updatedTrackerStatusesLocker {&m_updatedTrackerStatusesMutex};
+    Algorithm::removeIf(m_trackerAnnounceTimes, [&expirationTime](const lt::torrent_handle &, QHash<std::string, lt::time_point> &announceTimes)
+    {
+        Algorithm::removeIf(announceTimes, [&expirationTime](const std::string &, const lt::time_point &time)
+        {
+            return time < expirationTime;
+        });
+        return announceTimes.isEmpty();
+    });
+}
+
+void SessionImpl::removeFailingPublicTrackers()
+{
+    QSet<QString> failingTrackers;
+    for (const TrackerEntry &trackerEntry : asConst(m_publicTrackerList))
+    {
+        if (m_trackerHealthRegistry.isFailing(TrackerHealthRegistry::trackerHost(trackerEntry.url)))
+            failingTrackers.insert(trackerEntry.url);
+    }
+
+    if (failingTrackers.isEmpty())
+        return;
+
+    int affectedTorrentsCount = 0;
+    for (TorrentImpl *torrent : asConst(m_torrents))
+    {
+        if (torrent->isPrivate())
+            continue;
+
+        QStringList removedTrackers;
+        QSet<QString> trackers;
+        for (const TrackerEntryStatus &status : asConst(torrent->trackers()))
+        {
+            trackers.insert(status.url);
+            if (failingTrackers.contains(status.url))
+                removedTrackers.append(status.url);
+        }
+
+        if (removedTrackers.isEmpty())
+            continue;
+
+        torrent->removeTrackers(removedTrackers);
+
+        // replace removed trackers with the healthiest ones torrent doesn't have yet
+        QVector<TrackerEntry> replacementTrackers;
+        for (const TrackerEntry &trackerEntry : asConst(m_rankedPublicTrackers))
+        {
+            if (replacementTrackers.size() >= removedTrackers.size())
+                break;
+            if (!trackers.contains(trackerEntry.url))
+                replacementTrackers.append(trackerEntry);
+        }
+        if (!replacementTrackers.isEmpty())
+            torrent->addTrackers(std::move(replacementTrackers));
+
+        ++affectedTorrentsCount;
+    }
+
+    if (affectedTorrentsCount > 0)
+    {
+        LogMsg(tr("Removed failing public trackers from torrents. Trackers: %1. Torrents: %2")
+            .arg(QString::number(failingTrackers.size()), QString::number(affectedTorrentsCount)));
+    }
 }
 
 lt::settings_pack SessionImpl::loadLTSettings() const
@@ -1866,6 +2968,7 @@ lt::settings_pack SessionImpl::loadLTSettings() const
         | lt::alert::ip_block_notification
         | lt::alert::peer_notification
         | (isPerformanceWarningEnabled() ? lt::alert::performance_warning : lt::alert_category_t())
+        | lt::alert::piece_progress_notification
         | lt::alert::port_mapping_notification
         | lt::alert::status_notification
         | lt::alert::storage_notification
@@ -1882,8 +2985,8 @@ lt::settings_pack SessionImpl::loadLTSettings() const
 
     applyNetworkInterfacesSettings(settingsPack);
 
-    settingsPack.set_int(lt::settings_pack::download_rate_limit, downloadSpeedLimit());
-    settingsPack.set_int(lt::settings_pack::upload_rate_limit, uploadSpeedLimit());
+    settingsPack.set_int(lt::settings_pack::download_rate_limit, scheduledSpeedLimit(downloadSpeedLimit()));
+    settingsPack.set_int(lt::settings_pack::upload_rate_limit, scheduledSpeedLimit(uploadSpeedLimit()));
 
     // The most secure, rc4 only so that all streams are encrypted
     settingsPack.set_int(lt::settings_pack::allowed_enc_level, lt::settings_pack::pe_rc4);
@@ -2296,12 +3399,33 @@ void SessionImpl::configurePeerClasses()
         }
         catch (const std::exception &) {}
     }
-    m_nativeSession->set_peer_class_filter(f);
 
-    lt::peer_class_type_filter peerClassTypeFilter;
-    peerClassTypeFilter.add(lt::peer_class_type_filter::tcp_socket, lt::session::tcp_peer_class_id);
-    peerClassTypeFilter.add(lt::peer_class_type_filter::ssl_tcp_socket, lt::session::tcp_peer_class_id);
-    peerClassTypeFilter.add(lt::peer_class_type_filter::i2p_socket, lt::session::tcp_peer_class_id);
+    if (isShadowBanEnabled())
+    {
+        // shadow banned peers leave the global (and local) class, so they are
+        // only subject to the upload limit of their own class
+        for (const QString &ip : asConst(m_shadowBannedIPs))
+        {
+            lt::error_code ec;
+            const lt::address addr = lt::make_address(ip.toLatin1().constData(), ec);
+            if (ec)
+                continue;
+
+            f.add_rule(addr, addr, 1 << LT::toUnderlyingType(m_shadowBanPeerClass));
+            // IPv4 peers may connect over IPv6 socket
+            if (addr.is_v4())
+            {
+                const lt::address mappedAddr = boost::asio::ip::make_address_v6(boost::asio::ip::v4_mapped, addr.to_v4());
+                f.add_rule(mappedAddr, mappedAddr, 1 << LT::toUnderlyingType(m_shadowBanPeerClass));
+            }
+        }
+    }
+    m_nativeSession->set_peer_class_filter(f);
+
+    lt::peer_class_type_filter peerClassTypeFilter;
+    peerClassTypeFilter.add(lt::peer_class_type_filter::tcp_socket, lt::session::tcp_peer_class_id);
+    peerClassTypeFilter.add(lt::peer_class_type_filter::ssl_tcp_socket, lt::session::tcp_peer_class_id);
+    peerClassTypeFilter.add(lt::peer_class_type_filter::i2p_socket, lt::session::tcp_peer_class_id);
     if (!isUTPRateLimited())
     {
         peerClassTypeFilter.disallow(lt::peer_class_type_filter::utp_socket
@@ -2312,6 +3436,12 @@ void SessionImpl::configurePeerClasses()
     m_nativeSession->set_peer_class_type_filter(peerClassTypeFilter);
 }
 
+void SessionImpl::publishShadowBannedIPs(const QStringList &ips)
+{
+    ShadowBanTable::publish(ips);
+    configurePeerClasses();
+}
+
 void SessionImpl::enableTracker(const bool enable)
 {
     const QString profile = u"embeddedTracker"_s;
@@ -2345,6 +3475,8 @@ void SessionImpl::enableBandwidthScheduler()
         m_bwScheduler = new BandwidthScheduler(this);
         connect(m_bwScheduler.data(), &BandwidthScheduler::bandwidthLimitRequested
                 , this, &SessionImpl::setAltGlobalSpeedLimitEnabled);
+        connect(m_bwScheduler.data(), &BandwidthScheduler::bandwidthPercentRequested
+                , this, &SessionImpl::setScheduledBandwidthPercent);
     }
     m_bwScheduler->start();
 }
@@ -2418,6 +3550,139 @@ void SessionImpl::processTorrentShareLimits(TorrentImpl *torrent)
     }
 }
 
+std::optional<qlonglong> SessionImpl::shareLimitsCheckDelay(const TorrentImpl *torrent) const
+{
+    if (!torrent->isFinished() || torrent->isForced())
+        return std::nullopt;
+
+    // the following actions have nothing to do with such torrents
+    const ShareLimitAction shareLimitAction = (torrent->shareLimitAction() == ShareLimitAction::Default) ? m_shareLimitAction : torrent->shareLimitAction();
+    if (((shareLimitAction == ShareLimitAction::Stop) || (shareLimitAction == ShareLimitAction::EnableSuperSeeding)) && torrent->isStopped())
+        return std::nullopt;
+    if ((shareLimitAction == ShareLimitAction::EnableSuperSeeding) && torrent->superSeeding())
+        return std::nullopt;
+
+    const auto effectiveLimit = []<typename T>(const T limit, const T useGlobalLimit, const T globalLimit) -> T
+    {
+        return (limit == useGlobalLimit) ? globalLimit : limit;
+    };
+
+    const qreal ratioLimit = effectiveLimit(torrent->ratioLimit(), Torrent::USE_GLOBAL_RATIO, globalMaxRatio());
+    const int seedingTimeLimit = effectiveLimit(torrent->seedingTimeLimit(), Torrent::USE_GLOBAL_SEEDING_TIME, globalMaxSeedingMinutes());
+    const int inactiveSeedingTimeLimit = effectiveLimit(torrent->inactiveSeedingTimeLimit(), Torrent::USE_GLOBAL_INACTIVE_SEEDING_TIME, globalMaxInactiveSeedingMinutes());
+
+    std::optional<qlonglong> delay;
+    const auto addDelay = [&delay](const qlonglong seconds)
+    {
+        delay = std::min(delay.value_or(seconds), std::max<qlonglong>(seconds, 0));
+    };
+
+    if (ratioLimit >= 0)
+    {
+        // projected by current upload rate, so it is updated along with the torrent status
+        if (const qlonglong timeToReachRatio = torrent->timeToReachRatio(ratioLimit); timeToReachRatio >= 0)
+            addDelay(timeToReachRatio);
+    }
+
+    // both times grow no faster than the clock, so the limits can't be reached before the deadline
+    if (const qlonglong seedingTime = torrent->finishedTime();
+            (seedingTimeLimit >= 0) && ((seedingTime / 60) <= Torrent::MAX_SEEDING_TIME))
+    {
+        addDelay((seedingTimeLimit * 60LL) - seedingTime);
+    }
+
+    if (const qlonglong inactiveSeedingTime = std::max<qlonglong>(torrent->timeSinceActivity(), 0);
+            (inactiveSeedingTimeLimit >= 0) && ((inactiveSeedingTime / 60) <= Torrent::MAX_INACTIVE_SEEDING_TIME))
+    {
+        addDelay((inactiveSeedingTimeLimit * 60LL) - inactiveSeedingTime);
+    }
+
+    return delay;
+}
+
+void SessionImpl::scheduleShareLimitsCheck(TorrentImpl *torrent)
+{
+    const std::optional<qlonglong> delay = shareLimitsCheckDelay(torrent);
+    if (!delay)
+        return;
+
+    // check torrent at least one second later to not spin on limit which is reached but can't be processed
+    const qint64 deadline = QElapsedTimer::msecsSinceReference() + (std::max<qlonglong>(*delay, 1) * 1000);
+
+    // earlier deadline remains valid since the torrent is checked again anyway
+    const auto deadlineIter = m_shareLimitsDeadlines.find(torrent);
+    if ((deadlineIter != m_shareLimitsDeadlines.end()) && (deadlineIter.value() <= deadline))
+        return;
+
+    m_shareLimitsDeadlines[torrent] = deadline;
+
+    const bool isEarliestDeadline = m_shareLimitsDeadlinesQueue.empty() || (deadline < m_shareLimitsDeadlinesQueue.top().deadline);
+    m_shareLimitsDeadlinesQueue.push({deadline, torrent});
+
+    // get rid of outdated entries once they prevail
+    if (m_shareLimitsDeadlinesQueue.size() > static_cast<std::size_t>((m_shareLimitsDeadlines.size() * 2) + 100))
+    {
+        std::vector<ShareLimitsDeadline> deadlines;
+        deadlines.reserve(m_shareLimitsDeadlines.size());
+        for (auto it = m_shareLimitsDeadlines.cbegin(); it != m_shareLimitsDeadlines.cend(); ++it)
+            deadlines.push_back({it.value(), it.key()});
+        m_shareLimitsDeadlinesQueue = decltype(m_shareLimitsDeadlinesQueue)(std::greater<>(), std::move(deadlines));
+    }
+
+    if (isEarliestDeadline)
+        startSeedingLimitTimer();
+}
+
+void SessionImpl::rescheduleShareLimitsChecks()
+{
+    m_shareLimitsDeadlines.clear();
+    m_shareLimitsDeadlinesQueue = {};
+
+    for (TorrentImpl *torrent : asConst(m_torrents))
+    {
+        torrent->handleGlobalShareLimitsChanged();
+        scheduleShareLimitsCheck(torrent);
+    }
+
+    startSeedingLimitTimer();
+}
+
+void SessionImpl::processDueShareLimitsChecks()
+{
+    const qint64 now = QElapsedTimer::msecsSinceReference();
+    while (!m_shareLimitsDeadlinesQueue.empty() && (m_shareLimitsDeadlinesQueue.top().deadline <= now))
+    {
+        const ShareLimitsDeadline item = m_shareLimitsDeadlinesQueue.top();
+        m_shareLimitsDeadlinesQueue.pop();
+
+        const auto deadlineIter = m_shareLimitsDeadlines.find(item.torrent);
+        if ((deadlineIter == m_shareLimitsDeadlines.end()) || (deadlineIter.value() != item.deadline))
+            continue;
+
+        m_shareLimitsDeadlines.erase(deadlineIter);
+
+        const TorrentID torrentID = item.torrent->id();
+        processTorrentShareLimits(item.torrent);
+        // torrent could be removed
+        if (TorrentImpl *torrent = m_torrents.value(torrentID))
+            scheduleShareLimitsCheck(torrent);
+    }
+
+    startSeedingLimitTimer();
+}
+
+void SessionImpl::startSeedingLimitTimer()
+{
+    if (m_shareLimitsDeadlinesQueue.empty())
+    {
+        m_seedingLimitTimer->stop();
+        return;
+    }
+
+    const qint64 interval = m_shareLimitsDeadlinesQueue.top().deadline - QElapsedTimer::msecsSinceReference();
+    m_seedingLimitTimer->start(static_cast<int>(std::clamp<qint64>(interval, 0, std::numeric_limits<int>::max())));
+}
+
 void SessionImpl::fileSearchFinished(const TorrentID &id, const Path &savePath, const PathList &fileNames)
 {
     TorrentImpl *torrent = m_torrents.value(id);
@@ -2476,34 +3741,34 @@ Torrent *SessionImpl::findTorrent(const InfoHash &infoHash) const
     return m_torrents.value(altID);
 }
 
-void SessionImpl::banIP(const QString &ip)
+void SessionImpl::banIP(const QString &ip, const std::chrono::seconds duration)
 {
-    if (m_bannedIPs.get().contains(ip))
+    if (m_bannedIPsIndex.contains(ip))
+    {
+        updateBanExpiration(ip, duration, false, true);
         return;
+    }
 
     lt::error_code ec;
-    const lt::address addr = lt::make_address(ip.toLatin1().constData(), ec);
+    lt::make_address(ip.toLatin1().constData(), ec); // Only check IP valid.
     Q_ASSERT(!ec);
     if (ec)
         return;
 
-    invokeAsync([session = m_nativeSession, addr]
-    {
-        lt::ip_filter filter = session->get_ip_filter();
-        filter.add_rule(addr, addr, lt::ip_filter::blocked);
-        session->set_ip_filter(std::move(filter));
-    });
-
-    QStringList bannedIPs = m_bannedIPs;
-    bannedIPs.append(ip);
-    bannedIPs.sort();
-    m_bannedIPs = bannedIPs;
+    updateBanExpiration(ip, duration, false, false);
+    m_bannedIPsIndex.insert(ip);
+    m_pendingBannedIPs.append(ip);
+    if (!m_bannedIPsApplyTimer->isActive())
+        m_bannedIPsApplyTimer->start();
 }
 
-void SessionImpl::shadowbanIP(const QString &ip)
+void SessionImpl::shadowbanIP(const QString &ip, const std::chrono::seconds duration)
 {
     if (m_shadowBannedIPs.get().contains(ip))
+    {
+        updateBanExpiration(ip, duration, true, true);
         return;
+    }
 
     lt::error_code ec;
     lt::make_address(ip.toLatin1().constData(), ec); // Only check IP valid.
@@ -2511,19 +3776,158 @@ void SessionImpl::shadowbanIP(const QString &ip)
     if (ec)
         return;
 
+    updateBanExpiration(ip, duration, true, false);
+
     QStringList shadowBannedIPs = m_shadowBannedIPs;
     shadowBannedIPs.append(ip);
     shadowBannedIPs.sort();
     m_shadowBannedIPs = shadowBannedIPs;
+    publishShadowBannedIPs(shadowBannedIPs);
+}
+
+QHash<TorrentID, int> SessionImpl::connectPeers(const QList<TorrentID> &torrentIDs, const QList<PeerAddress> &peers)
+{
+    // the peers are filtered once for all the torrents
+    const std::vector<lt::address> reputationBannedAddresses = PeerReputationTable::instance().bannedAddresses();
+    const QStringList shadowBannedIPs = m_shadowBannedIPs;
+
+    QList<PeerAddress> acceptedPeers;
+    acceptedPeers.reserve(peers.size());
+    QSet<PeerAddress> uniquePeers;
+    uniquePeers.reserve(peers.size());
+    for (const PeerAddress &peer : peers)
+    {
+        if ((peer.port == 0) || uniquePeers.contains(peer))
+            continue;
+
+        const QString ip = peer.ip.toString();
+        lt::error_code ec;
+        const lt::address addr = lt::make_address(ip.toStdString(), ec);
+        if (ec)
+            continue;
+
+        // banned IPs which aren't applied to the filter yet are checked by the index
+        if (m_bannedIPsIndex.contains(ip) || shadowBannedIPs.contains(ip)
+            || (m_IPFilter.access(addr) & lt::ip_filter::blocked)
+            || std::binary_search(reputationBannedAddresses.cbegin(), reputationBannedAddresses.cend(), addr))
+        {
+            continue;
+        }
+
+        uniquePeers.insert(peer);
+        acceptedPeers.append(peer);
+    }
+
+    QHash<TorrentID, int> acceptedCounts;
+    for (const TorrentID &torrentID : torrentIDs)
+    {
+        if (!m_torrents.contains(torrentID) || acceptedCounts.contains(torrentID))
+            continue;
+
+        acceptedCounts.insert(torrentID, acceptedPeers.size());
+        for (const PeerAddress &peer : asConst(acceptedPeers))
+        {
+            // peer that is already queued will be connected anyway
+            if (m_queuedPeerConnects.contains({torrentID, peer}))
+                continue;
+
+            m_queuedPeerConnects.insert({torrentID, peer});
+            m_peerConnectQueue.push_back({torrentID, peer});
+        }
+    }
+
+    if (!m_peerConnectQueue.empty() && !m_peerConnectTimer->isActive())
+    {
+        processPeerConnectQueue();
+        if (!m_peerConnectQueue.empty())
+            m_peerConnectTimer->start();
+    }
+
+    return acceptedCounts;
+}
+
+void SessionImpl::processPeerConnectQueue()
+{
+    // libtorrent makes its own connection attempts within the same limit, so the queued peers get half of it
+    int budget = std::max(1, (connectionSpeed() / 2));
+    while ((budget > 0) && !m_peerConnectQueue.empty())
+    {
+        const PeerConnectRequest request = m_peerConnectQueue.front();
+        m_peerConnectQueue.pop_front();
+        m_queuedPeerConnects.remove({request.torrentID, request.address});
+
+        // torrent could be removed in the meantime
+        TorrentImpl *torrent = m_torrents.value(request.torrentID);
+        if (!torrent)
+            continue;
+
+        torrent->connectPeer(request.address);
+        --budget;
+    }
+
+    if (m_peerConnectQueue.empty())
+        m_peerConnectTimer->stop();
 }
 
 // Delete a torrent from the session, given its hash
 // and from the disk, if the corresponding deleteOption is chosen
 bool SessionImpl::removeTorrent(const TorrentID &id, const TorrentRemoveOption deleteOption)
 {
-    TorrentImpl *const torrent = m_torrents.take(id);
-    if (!torrent)
-        return false;
+    return (removeTorrents({id}, deleteOption) > 0);
+}
+
+qsizetype SessionImpl::removeTorrents(const QVector<TorrentID> &ids, const TorrentRemoveOption deleteOption)
+{
+    QVector<TorrentImpl *> torrents;
+    QVector<Torrent *> removedTorrents;
+    QVector<TorrentID> removedIDs;
+    torrents.reserve(ids.size());
+    removedTorrents.reserve(ids.size());
+    removedIDs.reserve(ids.size());
+    for (const TorrentID &id : ids)
+    {
+        if (TorrentImpl *const torrent = m_torrents.take(id))
+        {
+            m_torrentRegistry.remove(torrent);
+            torrents.append(torrent);
+            removedTorrents.append(torrent);
+            removedIDs.append(id);
+        }
+    }
+
+    if (torrents.isEmpty())
+        return 0;
+
+    // listeners handling many torrents at once are notified only once
+    emit torrentsAboutToBeRemoved(removedTorrents);
+
+    for (TorrentImpl *const torrent : asConst(torrents))
+        removeTorrentFromSession(torrent, deleteOption);
+
+    // Remove them from torrent resume directory
+    m_resumeDataStorage->removeAll(removedIDs);
+
+    for (TorrentImpl *const torrent : asConst(torrents))
+    {
+        LogMsg(tr("Torrent removed. Torrent: \"%1\"").arg(torrent->name()));
+        delete torrent;
+    }
+
+    scheduleTrackerURLPoolPurge();
+    return torrents.size();
+}
+
+void SessionImpl::removeTorrentFromSession(TorrentImpl *const torrent, const TorrentRemoveOption deleteOption)
+{
+    m_shareLimitsDeadlines.remove(torrent);
+    m_fakeProgressDetector.removeTorrent(torrent->id());
+    m_transferStatistics.removeTorrent(torrent->id());
+    m_pendingResumeData.remove(torrent->id());
+    m_resumeDataRequestTimes.remove(torrent);
+    m_interruptedCheckingTorrents.remove(torrent->id());
+    removeCheckingJob(torrent->id());
+    m_metadataDownloads.remove(torrent->id());
+    m_timedOutMetadataDownloads.remove(torrent->id());
 
     const TorrentID torrentID = torrent->id();
     const QString torrentName = torrent->name();
@@ -2561,28 +3965,21 @@ bool SessionImpl::removeTorrent(const TorrentID &id, const TorrentRemoveOption d
     {
         m_removingTorrents[torrentID] = {torrentName, torrent->actualStorageLocation(), torrent->actualFilePaths(), deleteOption};
 
-        if (m_moveStorageQueue.size() > 1)
+        // Delete "move storage job" for the deleted torrent
+        // (note: we shouldn't delete active job)
+        const auto iter = std::find_if(m_moveStorageQueue.begin(), m_moveStorageQueue.end()
+            , [torrent](const MoveStorageJob &job)
         {
-            // Delete "move storage job" for the deleted torrent
-            // (note: we shouldn't delete active job)
-            const auto iter = std::find_if((m_moveStorageQueue.begin() + 1), m_moveStorageQueue.end()
-                , [torrent](const MoveStorageJob &job)
-            {
-                return job.torrentHandle == torrent->nativeHandle();
-            });
-            if (iter != m_moveStorageQueue.end())
-                m_moveStorageQueue.erase(iter);
+            return !job.isActive && (job.torrentHandle == torrent->nativeHandle());
+        });
+        if (iter != m_moveStorageQueue.end())
+        {
+            m_moveStorageQueue.erase(iter);
+            handleRelocationFinished(torrent->nativeHandle(), true);
         }
 
         m_nativeSession->remove_torrent(torrent->nativeHandle(), lt::session::delete_partfile);
     }
-
-    // Remove it from torrent resume directory
-    m_resumeDataStorage->remove(torrentID);
-
-    LogMsg(tr("Torrent removed. Torrent: \"%1\"").arg(torrentName));
-    delete torrent;
-    return true;
 }
 
 bool SessionImpl::cancelDownloadMetadata(const TorrentID &id)
@@ -2612,130 +4009,144 @@ bool SessionImpl::cancelDownloadMetadata(const TorrentID &id)
     return true;
 }
 
-void SessionImpl::increaseTorrentsQueuePos(const QVector<TorrentID> &ids)
+QVector<TorrentImpl *> SessionImpl::queuedTorrents() const
 {
-    using ElementType = std::pair<int, const TorrentImpl *>;
-    std::priority_queue<ElementType
-        , std::vector<ElementType>
-        , std::greater<ElementType>> torrentQueue;
-
-    // Sort torrents by queue position
-    for (const TorrentID &id : ids)
+    QVector<TorrentImpl *> queue;
+    queue.reserve(m_torrents.size());
+    for (TorrentImpl *torrent : asConst(m_torrents))
     {
-        const TorrentImpl *torrent = m_torrents.value(id);
-        if (!torrent) continue;
-        if (const int position = torrent->queuePosition(); position >= 0)
-            torrentQueue.emplace(position, torrent);
+        if (torrent->queuePosition() >= 0)
+            queue.append(torrent);
     }
 
-    // Increase torrents queue position (starting with the one in the highest queue position)
-    while (!torrentQueue.empty())
+    std::sort(queue.begin(), queue.end(), [](const TorrentImpl *left, const TorrentImpl *right)
+    {
+        return (left->queuePosition() < right->queuePosition());
+    });
+
+    return queue;
+}
+
+void SessionImpl::applyTorrentsQueue(const QVector<TorrentImpl *> &currentQueue, const QVector<TorrentImpl *> &newQueue)
+{
+    Q_ASSERT(currentQueue.size() == newQueue.size());
+
+    // Torrents are placed in ascending order of their new positions. Torrents which aren't moved
+    // keep their relative order, so only the torrents which break it need to be moved explicitly.
+    QSet<const TorrentImpl *> movedTorrents;
+    qsizetype currentIndex = 0;
+    for (qsizetype position = 0; position < newQueue.size(); ++position)
     {
-        const TorrentImpl *torrent = torrentQueue.top().second;
-        torrentQueuePositionUp(torrent->nativeHandle());
-        torrentQueue.pop();
+        while ((currentIndex < currentQueue.size()) && movedTorrents.contains(currentQueue[currentIndex]))
+            ++currentIndex;
+
+        TorrentImpl *torrent = newQueue[position];
+        if ((currentIndex < currentQueue.size()) && (currentQueue[currentIndex] == torrent))
+        {
+            ++currentIndex;
+        }
+        else
+        {
+            torrentQueuePositionSet(torrent->nativeHandle(), static_cast<int>(position));
+            movedTorrents.insert(torrent);
+        }
+
+        if (torrent->queuePosition() != position)
+            torrent->handleQueuePositionChanged(static_cast<int>(position));
     }
 
-    m_torrentsQueueChanged = true;
+    if (!movedTorrents.isEmpty())
+        m_torrentsQueueChanged = true;
 }
 
-void SessionImpl::decreaseTorrentsQueuePos(const QVector<TorrentID> &ids)
+void SessionImpl::increaseTorrentsQueuePos(const QVector<TorrentID> &ids)
 {
-    using ElementType = std::pair<int, const TorrentImpl *>;
-    std::priority_queue<ElementType> torrentQueue;
+    const QSet<TorrentID> selectedIDs {ids.cbegin(), ids.cend()};
+    const QVector<TorrentImpl *> currentQueue = queuedTorrents();
 
-    // Sort torrents by queue position
-    for (const TorrentID &id : ids)
+    // Move each selected torrent one position up, starting with the one in the highest queue position.
+    // The torrents at the top of the queue can't be moved, the same applies to the selected ones right after them.
+    QVector<TorrentImpl *> newQueue = currentQueue;
+    for (qsizetype i = 1; i < newQueue.size(); ++i)
     {
-        const TorrentImpl *torrent = m_torrents.value(id);
-        if (!torrent) continue;
-        if (const int position = torrent->queuePosition(); position >= 0)
-            torrentQueue.emplace(position, torrent);
+        if (selectedIDs.contains(newQueue[i]->id()) && !selectedIDs.contains(newQueue[i - 1]->id()))
+            std::swap(newQueue[i - 1], newQueue[i]);
     }
 
-    // Decrease torrents queue position (starting with the one in the lowest queue position)
-    while (!torrentQueue.empty())
+    applyTorrentsQueue(currentQueue, newQueue);
+}
+
+void SessionImpl::decreaseTorrentsQueuePos(const QVector<TorrentID> &ids)
+{
+    const QSet<TorrentID> selectedIDs {ids.cbegin(), ids.cend()};
+    const QVector<TorrentImpl *> currentQueue = queuedTorrents();
+
+    // Move each selected torrent one position down, starting with the one in the lowest queue position
+    QVector<TorrentImpl *> newQueue = currentQueue;
+    for (qsizetype i = (newQueue.size() - 2); i >= 0; --i)
     {
-        const TorrentImpl *torrent = torrentQueue.top().second;
-        torrentQueuePositionDown(torrent->nativeHandle());
-        torrentQueue.pop();
+        if (selectedIDs.contains(newQueue[i]->id()) && !selectedIDs.contains(newQueue[i + 1]->id()))
+            std::swap(newQueue[i], newQueue[i + 1]);
     }
 
+    applyTorrentsQueue(currentQueue, newQueue);
+
     for (const lt::torrent_handle &torrentHandle : asConst(m_downloadedMetadata))
         torrentQueuePositionBottom(torrentHandle);
-
-    m_torrentsQueueChanged = true;
 }
 
 void SessionImpl::topTorrentsQueuePos(const QVector<TorrentID> &ids)
 {
-    using ElementType = std::pair<int, const TorrentImpl *>;
-    std::priority_queue<ElementType> torrentQueue;
-
-    // Sort torrents by queue position
-    for (const TorrentID &id : ids)
-    {
-        const TorrentImpl *torrent = m_torrents.value(id);
-        if (!torrent) continue;
-        if (const int position = torrent->queuePosition(); position >= 0)
-            torrentQueue.emplace(position, torrent);
-    }
+    const QSet<TorrentID> selectedIDs {ids.cbegin(), ids.cend()};
+    const QVector<TorrentImpl *> currentQueue = queuedTorrents();
 
-    // Top torrents queue position (starting with the one in the lowest queue position)
-    while (!torrentQueue.empty())
+    QVector<TorrentImpl *> newQueue = currentQueue;
+    std::stable_partition(newQueue.begin(), newQueue.end(), [&selectedIDs](const TorrentImpl *torrent)
     {
-        const TorrentImpl *torrent = torrentQueue.top().second;
-        torrentQueuePositionTop(torrent->nativeHandle());
-        torrentQueue.pop();
-    }
+        return selectedIDs.contains(torrent->id());
+    });
 
-    m_torrentsQueueChanged = true;
+    applyTorrentsQueue(currentQueue, newQueue);
 }
 
 void SessionImpl::bottomTorrentsQueuePos(const QVector<TorrentID> &ids)
 {
-    using ElementType = std::pair<int, const TorrentImpl *>;
-    std::priority_queue<ElementType
-        , std::vector<ElementType>
-        , std::greater<ElementType>> torrentQueue;
+    const QSet<TorrentID> selectedIDs {ids.cbegin(), ids.cend()};
+    const QVector<TorrentImpl *> currentQueue = queuedTorrents();
 
-    // Sort torrents by queue position
-    for (const TorrentID &id : ids)
+    QVector<TorrentImpl *> newQueue = currentQueue;
+    std::stable_partition(newQueue.begin(), newQueue.end(), [&selectedIDs](const TorrentImpl *torrent)
     {
-        const TorrentImpl *torrent = m_torrents.value(id);
-        if (!torrent) continue;
-        if (const int position = torrent->queuePosition(); position >= 0)
-            torrentQueue.emplace(position, torrent);
-    }
+        return !selectedIDs.contains(torrent->id());
+    });
 
-    // Bottom torrents queue position (starting with the one in the highest queue position)
-    while (!torrentQueue.empty())
-    {
-        const TorrentImpl *torrent = torrentQueue.top().second;
-        torrentQueuePositionBottom(torrent->nativeHandle());
-        torrentQueue.pop();
-    }
+    applyTorrentsQueue(currentQueue, newQueue);
 
     for (const lt::torrent_handle &torrentHandle : asConst(m_downloadedMetadata))
         torrentQueuePositionBottom(torrentHandle);
-
-    m_torrentsQueueChanged = true;
 }
 
 void SessionImpl::handleTorrentResumeDataRequested(const TorrentImpl *torrent)
 {
     qDebug("Saving resume data is requested for torrent '%s'...", qUtf8Printable(torrent->name()));
     ++m_numResumeData;
+    if (!m_resumeDataRequestTimes.contains(torrent))
+        m_resumeDataRequestTimes.insert(torrent, m_metricsTimer.nsecsElapsed());
 }
 
 QVector<Torrent *> SessionImpl::torrents() const
 {
-    QVector<Torrent *> result;
-    result.reserve(m_torrents.size());
-    for (TorrentImpl *torrent : asConst(m_torrents))
-        result << torrent;
+    return {m_torrentRegistry.begin(), m_torrentRegistry.end()};
+}
 
-    return result;
+std::span<Torrent *const> SessionImpl::torrentsView() const
+{
+    return m_torrentRegistry.values();
+}
+
+quint64 SessionImpl::torrentsGeneration() const
+{
+    return m_torrentRegistry.generation();
 }
 
 qsizetype SessionImpl::torrentsCount() const
@@ -2748,7 +4159,47 @@ bool SessionImpl::addTorrent(const TorrentDescriptor &torrentDescr, const AddTor
     if (!isRestored())
         return false;
 
-    return addTorrent_impl(torrentDescr, params);
+    AddTorrentsBatch batch;
+    const bool result = addTorrent_impl(torrentDescr, params, batch);
+    submitAddTorrentsBatch(batch);
+    return result;
+}
+
+qsizetype SessionImpl::addTorrents(const QList<TorrentDescriptor> &torrentDescrs, const AddTorrentParams &params)
+{
+    Q_ASSERT(params.filePaths.isEmpty() && params.filePriorities.isEmpty());
+
+    if (!isRestored())
+        return 0;
+
+    AddTorrentsBatch batch;
+    qsizetype addedCount = 0;
+    for (const TorrentDescriptor &torrentDescr : torrentDescrs)
+    {
+        if (addTorrent_impl(torrentDescr, params, batch))
+            ++addedCount;
+    }
+    submitAddTorrentsBatch(batch);
+
+    if (torrentDescrs.size() > 1)
+    {
+        LogMsg(tr("Added torrents in batch. Accepted: %1. Total: %2")
+                .arg(QString::number(addedCount), QString::number(torrentDescrs.size())));
+    }
+
+    return addedCount;
+}
+
+void SessionImpl::submitAddTorrentsBatch(const AddTorrentsBatch &batch)
+{
+    for (const TorrentID &id : batch.readyTorrentIDs)
+    {
+        if (const auto loadingTorrentsIter = m_loadingTorrents.constFind(id); loadingTorrentsIter != m_loadingTorrents.cend())
+            m_nativeSession->async_add_torrent(loadingTorrentsIter->ltAddTorrentParams);
+    }
+
+    if (!batch.fileSearchRequests.isEmpty())
+        findIncompleteFiles(batch.fileSearchRequests);
 }
 
 LoadTorrentParams SessionImpl::initLoadTorrentParams(const AddTorrentParams &addTorrentParams)
@@ -2816,7 +4267,7 @@ LoadTorrentParams SessionImpl::initLoadTorrentParams(const AddTorrentParams &add
 }
 
 // Add a torrent to the BitTorrent session
-bool SessionImpl::addTorrent_impl(const TorrentDescriptor &source, const AddTorrentParams &addTorrentParams)
+bool SessionImpl::addTorrent_impl(const TorrentDescriptor &source, const AddTorrentParams &addTorrentParams, AddTorrentsBatch &batch)
 {
     Q_ASSERT(isRestored());
 
@@ -2866,6 +4317,17 @@ bool SessionImpl::addTorrent_impl(const TorrentDescriptor &source, const AddTorr
         return false;
     }
 
+    // metadata which was received once is taken from the cache instead of the swarm
+    if (!hasMetadata)
+    {
+        if (std::optional<TorrentInfo> cachedMetadata = m_metadataCache.load(infoHash))
+        {
+            TorrentDescriptor torrentDescr = source;
+            torrentDescr.setTorrentInfo(std::move(*cachedMetadata));
+            return addTorrent_impl(torrentDescr, addTorrentParams, batch);
+        }
+    }
+
     // It looks illogical that we don't just use an existing handle,
     // but as previous experience has shown, it actually creates unnecessary
     // problems and unwanted behavior due to the fact that it was originally
@@ -2874,14 +4336,20 @@ bool SessionImpl::addTorrent_impl(const TorrentDescriptor &source, const AddTorr
     if (infoHash.isHybrid())
         cancelDownloadMetadata(altID);
 
-    LoadTorrentParams loadTorrentParams = initLoadTorrentParams(addTorrentParams);
+    if (!batch.loadTorrentParams)
+    {
+        const LoadTorrentParams &batchParams = batch.loadTorrentParams.emplace(initLoadTorrentParams(addTorrentParams));
+        batch.actualSavePath = batchParams.useAutoTMM ? categorySavePath(batchParams.category) : batchParams.savePath;
+        batch.actualDownloadPath = batchParams.useAutoTMM ? categoryDownloadPath(batchParams.category) : batchParams.downloadPath;
+    }
+
+    LoadTorrentParams loadTorrentParams = *batch.loadTorrentParams;
     lt::add_torrent_params &p = loadTorrentParams.ltAddTorrentParams;
     p = source.ltAddTorrentParams();
 
     bool isFindingIncompleteFiles = false;
 
-    const bool useAutoTMM = loadTorrentParams.useAutoTMM;
-    const Path actualSavePath = useAutoTMM ? categorySavePath(loadTorrentParams.category) : loadTorrentParams.savePath;
+    const Path &actualSavePath = batch.actualSavePath;
 
     if (hasMetadata)
     {
@@ -2943,9 +4411,8 @@ bool SessionImpl::addTorrent_impl(const TorrentDescriptor &source, const AddTorr
 
         if (!loadTorrentParams.hasFinishedStatus)
         {
-            const Path actualDownloadPath = useAutoTMM
-                    ? categoryDownloadPath(loadTorrentParams.category) : loadTorrentParams.downloadPath;
-            findIncompleteFiles(torrentInfo, actualSavePath, actualDownloadPath, filePaths);
+            batch.fileSearchRequests.append({.id = TorrentID::fromInfoHash(torrentInfo.infoHash()), .originalFileNames = filePaths
+                    , .savePath = actualSavePath, .downloadPath = batch.actualDownloadPath});
             isFindingIncompleteFiles = true;
         }
 
@@ -2991,10 +4458,11 @@ bool SessionImpl::addTorrent_impl(const TorrentDescriptor &source, const AddTorr
     }
 
     if (isAutoUpdateTrackersEnabled() && !(hasMetadata && p.ti->priv())) {
-        p.trackers.reserve(p.trackers.size() + static_cast<std::size_t>(m_publicTrackerList.size()));
-        p.tracker_tiers.reserve(p.trackers.size() + static_cast<std::size_t>(m_publicTrackerList.size()));
+        // only the healthiest public trackers are added, so that dead ones don't waste announce slots
+        p.trackers.reserve(p.trackers.size() + static_cast<std::size_t>(m_rankedPublicTrackers.size()));
+        p.tracker_tiers.reserve(p.trackers.size() + static_cast<std::size_t>(m_rankedPublicTrackers.size()));
         p.tracker_tiers.resize(p.trackers.size(), 0);
-        for (const TrackerEntry &trackerEntry : asConst(m_publicTrackerList))
+        for (const TrackerEntry &trackerEntry : asConst(m_rankedPublicTrackers))
         {
             p.trackers.push_back(trackerEntry.url.toStdString());
             p.tracker_tiers.push_back(trackerEntry.tier);
@@ -3045,21 +4513,39 @@ bool SessionImpl::addTorrent_impl(const TorrentDescriptor &source, const AddTorr
     if (infoHash.isHybrid())
         m_hybridTorrentsByAltID.insert(altID, nullptr);
     if (!isFindingIncompleteFiles)
-        m_nativeSession->async_add_torrent(p);
+        batch.readyTorrentIDs.append(id);
 
     return true;
 }
 
 void SessionImpl::findIncompleteFiles(const TorrentInfo &torrentInfo, const Path &savePath
-        , const Path &downloadPath, const PathList &filePaths) const
+        , const Path &downloadPath, const PathList &filePaths)
 {
     Q_ASSERT(filePaths.isEmpty() || (filePaths.size() == torrentInfo.filesCount()));
 
-    const auto searchId = TorrentID::fromInfoHash(torrentInfo.infoHash());
-    const PathList originalFileNames = (filePaths.isEmpty() ? torrentInfo.filePaths() : filePaths);
-    QMetaObject::invokeMethod(m_fileSearcher, [=, this]
+    const FileSearchRequest request
+    {
+        .id = TorrentID::fromInfoHash(torrentInfo.infoHash()),
+        .originalFileNames = (filePaths.isEmpty() ? torrentInfo.filePaths() : filePaths),
+        .savePath = savePath,
+        .downloadPath = downloadPath
+    };
+    findIncompleteFiles(QList<FileSearchRequest> {request});
+}
+
+void SessionImpl::findIncompleteFiles(const QList<FileSearchRequest> &requests)
+{
+    const bool isSubmitPending = !m_pendingFileSearchRequests.isEmpty();
+    m_pendingFileSearchRequests.append(requests);
+    if (!isSubmitPending)
+        QMetaObject::invokeMethod(this, &SessionImpl::submitFileSearchRequests, Qt::QueuedConnection);
+}
+
+void SessionImpl::submitFileSearchRequests()
+{
+    QMetaObject::invokeMethod(m_fileSearcher, [this, requests = std::exchange(m_pendingFileSearchRequests, {})]
     {
-        m_fileSearcher->search(searchId, originalFileNames, savePath, downloadPath, isAppendExtensionEnabled());
+        m_fileSearcher->search(requests, isAppendExtensionEnabled());
     });
 }
 
@@ -3100,13 +4586,26 @@ void SessionImpl::disablePortMapping()
     });
 }
 
-void SessionImpl::addMappedPorts(const QSet<quint16> &ports)
+void SessionImpl::setMappedPorts(const QSet<quint16> &ports)
 {
     invokeAsync([this, ports]
     {
         if (!m_isPortMappingEnabled)
             return;
 
+        // mappings of the ports that stay forwarded are left intact,
+        // so their leases aren't renewed needlessly
+        Algorithm::removeIf(m_mappedPorts, [this, &ports](const quint16 port, const std::vector<lt::port_mapping_t> &handles)
+        {
+            if (ports.contains(port))
+                return false;
+
+            for (const lt::port_mapping_t &handle : handles)
+                m_nativeSession->delete_port_mapping(handle);
+
+            return true;
+        });
+
         for (const quint16 port : ports)
         {
             if (!m_mappedPorts.contains(port))
@@ -3115,27 +4614,7 @@ void SessionImpl::addMappedPorts(const QSet<quint16> &ports)
     });
 }
 
-void SessionImpl::removeMappedPorts(const QSet<quint16> &ports)
-{
-    invokeAsync([this, ports]
-    {
-        if (!m_isPortMappingEnabled)
-            return;
-
-        Algorithm::removeIf(m_mappedPorts, [this, ports](const quint16 port, const std::vector<lt::port_mapping_t> &handles)
-        {
-            if (!ports.contains(port))
-                return false;
-
-            for (const lt::port_mapping_t &handle : handles)
-                m_nativeSession->delete_port_mapping(handle);
-
-            return true;
-        });
-    });
-}
-
-void SessionImpl::invokeAsync(std::function<void ()> func)
+void SessionImpl::invokeAsync(std::function<void ()> func)
 {
     m_asyncWorker->start(std::move(func));
 }
@@ -3155,6 +4634,16 @@ bool SessionImpl::downloadMetadata(const TorrentDescriptor &torrentDescr)
     if (isKnownTorrent(infoHash))
         return false;
 
+    if (const std::optional<TorrentInfo> cachedMetadata = m_metadataCache.load(infoHash))
+    {
+        // it is reported asynchronously as if it was downloaded
+        QMetaObject::invokeMethod(this, [this, metadata = *cachedMetadata]
+        {
+            emit metadataDownloaded(metadata);
+        }, Qt::QueuedConnection);
+        return true;
+    }
+
     lt::add_torrent_params p = torrentDescr.ltAddTorrentParams();
 
     if (isAddTrackersEnabled())
@@ -3207,6 +4696,14 @@ bool SessionImpl::downloadMetadata(const TorrentDescriptor &torrentDescr)
     return true;
 }
 
+void SessionImpl::storeMetadata(const TorrentInfo &metadata)
+{
+    invokeAsync([metadataCache = m_metadataCache, metadata]
+    {
+        metadataCache.store(metadata);
+    });
+}
+
 void SessionImpl::exportTorrentFile(const Torrent *torrent, const Path &folderPath)
 {
     if (!folderPath.exists() && !Utils::Fs::mkpath(folderPath))
@@ -3233,18 +4730,40 @@ void SessionImpl::exportTorrentFile(const Torrent *torrent, const Path &folderPa
 
 void SessionImpl::generateResumeData()
 {
+    QHash<TorrentID, ResumeDataCounters> changedCounters;
     for (TorrentImpl *const torrent : asConst(m_torrents))
     {
-        if (torrent->needSaveResumeData())
+        const bool isCountersChanged = torrent->isResumeDataCountersChanged();
+        // libtorrent doesn't tell what exactly is changed, so resume data is also generated in full
+        // once in a while to include changes unknown to us and to replace the stored counters
+        if (torrent->needSaveResumeData() && (!isCountersChanged || torrent->hasUnsavedResumeDataProgress()
+                || (torrent->resumeDataCountersSaveCount() >= MAX_RESUMEDATA_COUNTERS_SAVE_COUNT)))
+        {
             torrent->requestResumeData();
+        }
+        else if (isCountersChanged)
+        {
+            const ResumeDataCounters counters = torrent->resumeDataCounters();
+            changedCounters.insert(torrent->id(), counters);
+            torrent->handleResumeDataCountersStored(counters);
+        }
     }
+
+    if (!changedCounters.isEmpty())
+        m_resumeDataStorage->storeCounters(changedCounters);
 }
 
 // Called on exit
 void SessionImpl::saveResumeData()
 {
+    QHash<TorrentID, ResumeDataCounters> changedCounters;
     for (TorrentImpl *torrent : asConst(m_torrents))
     {
+        // libtorrent doesn't generate resume data if it considers torrent unmodified
+        // so the counters changed since they were stored need to be stored separately
+        if (!torrent->needSaveResumeData() && torrent->isResumeDataCountersChanged())
+            changedCounters.insert(torrent->id(), torrent->resumeDataCounters());
+
         // When the session is terminated due to unrecoverable error
         // some of the torrent handles can be corrupted
         try
@@ -3254,9 +4773,11 @@ void SessionImpl::saveResumeData()
         catch (const std::exception &) {}
     }
 
-    // clear queued storage move jobs except the current ongoing one
-    if (m_moveStorageQueue.size() > 1)
-        m_moveStorageQueue.resize(1);
+    if (!changedCounters.isEmpty())
+        m_resumeDataStorage->storeCounters(changedCounters);
+
+    // clear queued storage move jobs except the currently ongoing ones
+    m_moveStorageQueue.removeIf([](const MoveStorageJob &job) { return !job.isActive; });
 
     QElapsedTimer timer;
     timer.start();
@@ -3290,11 +4811,26 @@ void SessionImpl::saveResumeData()
             handleAlert(alert);
         }
 
+        storePendingResumeData();
+
         if (hasWantedAlert)
             timer.start();
     }
 }
 
+void SessionImpl::storePendingResumeData()
+{
+    if (m_pendingResumeData.isEmpty())
+        return;
+
+    if (m_pendingResumeData.size() == 1)
+        m_resumeDataStorage->store(m_pendingResumeData.cbegin().key(), m_pendingResumeData.cbegin().value());
+    else
+        m_resumeDataStorage->storeAll(m_pendingResumeData);
+
+    m_pendingResumeData.clear();
+}
+
 void SessionImpl::saveTorrentsQueue()
 {
     QVector<TorrentID> queue;
@@ -3344,8 +4880,8 @@ void SessionImpl::setSavePath(const Path &path)
     }
 
     m_savePath = newPath;
-    for (TorrentImpl *const torrent : asConst(m_torrents))
-        torrent->handleCategoryOptionsChanged();
+    clearCategoryPathsCache();
+    relocateTorrents(m_torrents.values(), tr("default save path changed"));
 }
 
 void SessionImpl::setDownloadPath(const Path &path)
@@ -3375,8 +4911,8 @@ void SessionImpl::setDownloadPath(const Path &path)
     }
 
     m_downloadPath = newPath;
-    for (TorrentImpl *const torrent : asConst(m_torrents))
-        torrent->handleCategoryOptionsChanged();
+    clearCategoryPathsCache();
+    relocateTorrents(m_torrents.values(), tr("default download path changed"));
 }
 
 QStringList SessionImpl::getListeningIPs() const
@@ -3641,7 +5177,10 @@ void SessionImpl::setBandwidthSchedulerEnabled(const bool enabled)
         if (enabled)
             enableBandwidthScheduler();
         else
+        {
             delete m_bwScheduler;
+            setScheduledBandwidthPercent(100);
+        }
     }
 }
 
@@ -4018,6 +5557,71 @@ void SessionImpl::setIPFilterFile(const Path &path)
     }
 }
 
+QStringList SessionImpl::IPFilterSubscriptions() const
+{
+    return m_IPFilterSubscriptions;
+}
+
+void SessionImpl::setIPFilterSubscriptions(const QStringList &urls)
+{
+    QStringList filteredURLs;
+    filteredURLs.reserve(urls.size());
+    for (const QString &url : urls)
+    {
+        const QString trimmedURL = url.trimmed();
+        if (!trimmedURL.isEmpty() && !filteredURLs.contains(trimmedURL))
+            filteredURLs.append(trimmedURL);
+    }
+
+    if (filteredURLs == IPFilterSubscriptions())
+        return;
+
+    m_IPFilterSubscriptions = filteredURLs;
+    m_IPFilterSubscriptionManager->setURLs(filteredURLs);
+}
+
+QStringList SessionImpl::blockedCountries() const
+{
+    return m_blockedCountries;
+}
+
+void SessionImpl::setBlockedCountries(const QStringList &countryCodes)
+{
+    QStringList filteredCodes;
+    filteredCodes.reserve(countryCodes.size());
+    for (const QString &code : countryCodes)
+    {
+        const QString trimmedCode = code.trimmed().toUpper();
+        if ((trimmedCode.size() == 2) && !filteredCodes.contains(trimmedCode))
+            filteredCodes.append(trimmedCode);
+    }
+    filteredCodes.sort();
+
+    if (filteredCodes == blockedCountries())
+        return;
+
+    m_blockedCountries = filteredCodes;
+    if (auto *geoIPManager = Net::GeoIPManager::instance())
+    {
+        updateBlockedCountryRanges();
+        geoIPManager->setDatabaseRequired(!filteredCodes.isEmpty());
+    }
+}
+
+int SessionImpl::IPFilterSubscriptionsRefreshInterval() const
+{
+    return m_IPFilterSubscriptionsRefreshInterval;
+}
+
+void SessionImpl::setIPFilterSubscriptionsRefreshInterval(const int hours)
+{
+    if (hours == IPFilterSubscriptionsRefreshInterval())
+        return;
+
+    m_IPFilterSubscriptionsRefreshInterval = hours;
+    m_IPFilterSubscriptionManager->setRefreshInterval(std::chrono::hours(IPFilterSubscriptionsRefreshInterval()));
+}
+
 bool SessionImpl::isExcludedFileNamesEnabled() const
 {
     return m_isExcludedFileNamesEnabled;
@@ -4031,9 +5635,9 @@ void SessionImpl::setExcludedFileNamesEnabled(const bool enabled)
     m_isExcludedFileNamesEnabled = enabled;
 
     if (enabled)
-        populateExcludedFileNamesRegExpList();
+        populateExcludedFileNamesFilter();
     else
-        m_excludedFileNamesRegExpList.clear();
+        m_excludedFileNamesFilter = {};
 }
 
 QStringList SessionImpl::excludedFileNames() const
@@ -4046,59 +5650,35 @@ void SessionImpl::setExcludedFileNames(const QStringList &excludedFileNames)
     if (excludedFileNames != m_excludedFileNames)
     {
         m_excludedFileNames = excludedFileNames;
-        populateExcludedFileNamesRegExpList();
+        populateExcludedFileNamesFilter();
     }
 }
 
-void SessionImpl::populateExcludedFileNamesRegExpList()
+void SessionImpl::populateExcludedFileNamesFilter()
 {
-    const QStringList excludedNames = excludedFileNames();
-
-    m_excludedFileNamesRegExpList.clear();
-    m_excludedFileNamesRegExpList.reserve(excludedNames.size());
-
-    for (const QString &str : excludedNames)
-    {
-        const QString pattern = QRegularExpression::wildcardToRegularExpression(str);
-        const QRegularExpression re {pattern, QRegularExpression::CaseInsensitiveOption};
-        m_excludedFileNamesRegExpList.append(re);
-    }
+    m_excludedFileNamesFilter = FileNameFilter(excludedFileNames());
 }
 
 void SessionImpl::applyFilenameFilter(const PathList &files, QList<DownloadPriority> &priorities)
 {
-    if (!isExcludedFileNamesEnabled())
+    if (!isExcludedFileNamesEnabled() || m_excludedFileNamesFilter.isEmpty())
         return;
 
-    const auto isFilenameExcluded = [patterns = m_excludedFileNamesRegExpList](const Path &fileName)
-    {
-        return std::any_of(patterns.begin(), patterns.end(), [&fileName](const QRegularExpression &re)
-        {
-            Path path = fileName;
-            while (!re.match(path.filename()).hasMatch())
-            {
-                path = path.parentPath();
-                if (path.isEmpty())
-                    return false;
-            }
-            return true;
-        });
-    };
-
+    FileNameFilter::FolderVerdicts folderVerdicts;
     priorities.resize(files.count(), DownloadPriority::Normal);
     for (int i = 0; i < priorities.size(); ++i)
     {
         if (priorities[i] == BitTorrent::DownloadPriority::Ignored)
             continue;
 
-        if (isFilenameExcluded(files.at(i)))
+        if (m_excludedFileNamesFilter.isExcluded(files.at(i), folderVerdicts))
             priorities[i] = BitTorrent::DownloadPriority::Ignored;
     }
 }
 
 void SessionImpl::setBannedIPs(const QStringList &newList)
 {
-    if (newList == m_bannedIPs)
+    if (newList == bannedIPs())
         return; // do nothing
     // here filter out incorrect IP
     QStringList filteredList;
@@ -4122,12 +5702,19 @@ void SessionImpl::setBannedIPs(const QStringList &newList)
     filteredList.sort();
     filteredList.removeDuplicates();
     // Again ensure that the new list is different from the stored one.
-    if (filteredList == m_bannedIPs)
+    if (filteredList == bannedIPs())
         return; // do nothing
     // store to session settings
     // also here we have to recreate filter list including 3rd party ban file
     // and install it again into m_session
+    m_pendingBannedIPs.clear();
+    m_bannedIPsApplyTimer->stop();
     m_bannedIPs = filteredList;
+    m_bannedIPsIndex = QSet<QString>(filteredList.cbegin(), filteredList.cend());
+    // addresses removed from the list are not subject to expiration anymore
+    QVariantMap expirations = m_bannedIPsExpiration;
+    expirations.removeIf([this](const QVariantMap::iterator it) { return !m_bannedIPsIndex.contains(it.key()); });
+    m_bannedIPsExpiration = expirations;
     m_IPFilteringConfigured = false;
     configureDeferred();
 }
@@ -4142,6 +5729,66 @@ void SessionImpl::setResumeDataStorageType(const ResumeDataStorageType type)
     m_resumeDataStorageType = type;
 }
 
+bool SessionImpl::isResumeDataStorageSharded() const
+{
+    return m_isResumeDataStorageSharded;
+}
+
+void SessionImpl::setResumeDataStorageSharded(const bool sharded)
+{
+    m_isResumeDataStorageSharded = sharded;
+}
+
+bool SessionImpl::isDeferredStoppedTorrentsLoadingEnabled() const
+{
+    return m_isDeferredStoppedTorrentsLoadingEnabled;
+}
+
+void SessionImpl::setDeferredStoppedTorrentsLoadingEnabled(const bool enabled)
+{
+    m_isDeferredStoppedTorrentsLoadingEnabled = enabled;
+}
+
+bool SessionImpl::isTrustedResumeDataEnabled() const
+{
+    return m_isTrustedResumeDataEnabled;
+}
+
+void SessionImpl::setTrustedResumeDataEnabled(const bool enabled)
+{
+    m_isTrustedResumeDataEnabled = enabled;
+}
+
+int SessionImpl::resumeDataStorageBatchSize() const
+{
+    return m_resumeDataStorageBatchSize;
+}
+
+void SessionImpl::setResumeDataStorageBatchSize(const int size)
+{
+    if (size == m_resumeDataStorageBatchSize)
+        return;
+
+    m_resumeDataStorageBatchSize = size;
+    if (auto *dbStorage = qobject_cast<DBResumeDataStorage *>(m_resumeDataStorage))
+        dbStorage->setBatchLimits(resumeDataStorageBatchSize(), resumeDataStorageBatchLatency());
+}
+
+int SessionImpl::resumeDataStorageBatchLatency() const
+{
+    return m_resumeDataStorageBatchLatency;
+}
+
+void SessionImpl::setResumeDataStorageBatchLatency(const int latency)
+{
+    if (latency == m_resumeDataStorageBatchLatency)
+        return;
+
+    m_resumeDataStorageBatchLatency = latency;
+    if (auto *dbStorage = qobject_cast<DBResumeDataStorage *>(m_resumeDataStorage))
+        dbStorage->setBatchLimits(resumeDataStorageBatchSize(), resumeDataStorageBatchLatency());
+}
+
 bool SessionImpl::isMergeTrackersEnabled() const
 {
     return m_isMergeTrackersEnabled;
@@ -4172,9 +5819,104 @@ void SessionImpl::setTorrentContentRemoveOption(const TorrentContentRemoveOption
     m_torrentContentRemoveOption = option;
 }
 
+int SessionImpl::maxActiveMoveStorageJobsPerDevice() const
+{
+    return m_maxActiveMoveStorageJobsPerDevice;
+}
+
+void SessionImpl::setMaxActiveMoveStorageJobsPerDevice(const int value)
+{
+    if (value == maxActiveMoveStorageJobsPerDevice())
+        return;
+
+    m_maxActiveMoveStorageJobsPerDevice = value;
+    startQueuedMoveStorageJobs();
+}
+
+int SessionImpl::maxActiveMetadataDownloads() const
+{
+    return m_maxActiveMetadataDownloads;
+}
+
+void SessionImpl::setMaxActiveMetadataDownloads(const int value)
+{
+    if (value == maxActiveMetadataDownloads())
+        return;
+
+    m_maxActiveMetadataDownloads = value;
+    updateMetadataDownloads();
+}
+
+int SessionImpl::metadataDownloadTimeout() const
+{
+    return m_metadataDownloadTimeout;
+}
+
+void SessionImpl::setMetadataDownloadTimeout(const int value)
+{
+    if (value == metadataDownloadTimeout())
+        return;
+
+    m_metadataDownloadTimeout = value;
+    // every torrent gets another chance with the new timeout
+    m_timedOutMetadataDownloads.clear();
+}
+
+int SessionImpl::maxActiveCheckingTorrentsPerDevice() const
+{
+    return m_maxActiveCheckingTorrentsPerDevice;
+}
+
+void SessionImpl::setMaxActiveCheckingTorrentsPerDevice(const int value)
+{
+    if (value == maxActiveCheckingTorrentsPerDevice())
+        return;
+
+    m_maxActiveCheckingTorrentsPerDevice = value;
+    NativeTorrentExtension::setCheckingScheduled(value > 0);
+
+    if (value > 0)
+    {
+        startQueuedCheckingJobs();
+        return;
+    }
+
+    // checks held by the scheduler are started right away and left to libtorrent
+    for (const CheckingJob &job : asConst(m_checkingQueue))
+    {
+        if (const TorrentImpl *torrent = m_torrents.value(job.torrentID); torrent && !job.isActive)
+            torrent->nativeHandle().resume();
+    }
+    m_checkingQueue.clear();
+    storeCheckingQueue();
+}
+
+QList<MoveStorageJobInfo> SessionImpl::moveStorageJobs() const
+{
+    QList<MoveStorageJobInfo> jobs;
+    jobs.reserve(m_moveStorageQueue.size());
+    for (const MoveStorageJob &job : m_moveStorageQueue)
+    {
+#ifdef QBT_USES_LIBTORRENT2
+        const auto id = TorrentID::fromInfoHash(job.torrentHandle.info_hashes());
+#else
+        const auto id = TorrentID::fromInfoHash(job.torrentHandle.info_hash());
+#endif
+        jobs.append({.torrentID = id, .sourcePath = job.sourcePath, .destinationPath = job.path, .isActive = job.isActive});
+    }
+
+    return jobs;
+}
+
 QStringList SessionImpl::bannedIPs() const
 {
-    return m_bannedIPs;
+    if (m_pendingBannedIPs.isEmpty())
+        return m_bannedIPs;
+
+    QStringList bannedIPs = m_bannedIPs;
+    bannedIPs.append(m_pendingBannedIPs);
+    bannedIPs.sort();
+    return bannedIPs;
 }
 
 bool SessionImpl::isRestored() const
@@ -4240,6 +5982,10 @@ void SessionImpl::setMaxConnectionsPerTorrent(int max)
 
         for (const TorrentImpl *torrent : asConst(m_torrents))
         {
+            // rebalanced torrents get the default limit once their budget is released
+            if (torrent->connectionsBudget() > 0)
+                continue;
+
             try
             {
                 torrent->nativeHandle().set_max_connections(max);
@@ -4342,6 +6088,21 @@ void SessionImpl::setPeerTurnoverInterval(const int val)
     configureDeferred();
 }
 
+bool SessionImpl::isConnectionsRebalancingEnabled() const
+{
+    return m_isConnectionsRebalancingEnabled;
+}
+
+void SessionImpl::setConnectionsRebalancingEnabled(const bool enabled)
+{
+    if (enabled == isConnectionsRebalancingEnabled())
+        return;
+
+    m_isConnectionsRebalancingEnabled = enabled;
+    // the budgets are assigned (or released) on the next refresh
+    m_connectionsRebalanceTime = {};
+}
+
 DiskIOType SessionImpl::diskIOType() const
 {
     return m_diskIOType;
@@ -4355,6 +6116,54 @@ void SessionImpl::setDiskIOType(const DiskIOType type)
     }
 }
 
+int SessionImpl::diskIOJobsPerDevice() const
+{
+    return m_diskIOJobsPerDevice;
+}
+
+void SessionImpl::setDiskIOJobsPerDevice(const int value)
+{
+    if (value == m_diskIOJobsPerDevice)
+        return;
+
+    m_diskIOJobsPerDevice = value;
+#ifdef QBT_USES_LIBTORRENT2
+    CustomDiskIOThread::setMaxActiveJobsPerDevice(m_diskIOJobsPerDevice);
+#endif
+}
+
+int SessionImpl::diskIOReadsPerHashJob() const
+{
+    return m_diskIOReadsPerHashJob;
+}
+
+void SessionImpl::setDiskIOReadsPerHashJob(const int value)
+{
+    if (value == m_diskIOReadsPerHashJob)
+        return;
+
+    m_diskIOReadsPerHashJob = value;
+#ifdef QBT_USES_LIBTORRENT2
+    CustomDiskIOThread::setReadsPerHashJob(m_diskIOReadsPerHashJob);
+#endif
+}
+
+int SessionImpl::diskReadCacheSize() const
+{
+    return m_diskReadCacheSize;
+}
+
+void SessionImpl::setDiskReadCacheSize(const int size)
+{
+    if (size == m_diskReadCacheSize)
+        return;
+
+    m_diskReadCacheSize = size;
+#ifdef QBT_USES_LIBTORRENT2
+    CustomDiskIOThread::setReadCacheSize(m_diskReadCacheSize * 1024LL * 1024);
+#endif
+}
+
 int SessionImpl::requestQueueSize() const
 {
     return m_requestQueueSize;
@@ -4905,16 +6714,79 @@ void SessionImpl::setReannounceWhenAddressChangedEnabled(const bool enabled)
     m_isReannounceWhenAddressChangedEnabled = enabled;
 }
 
-void SessionImpl::reannounceToAllTrackers() const
+// Reannounces of all the torrents are ramped up per tracker host and additionally
+// spread out by random jitter so trackers aren't flooded by thousands of simultaneous announces.
+void SessionImpl::reannounceToAllTrackers()
 {
-    for (const TorrentImpl *torrent : asConst(m_torrents))
+    m_announceScheduler.purge();
+
+    for (TorrentImpl *torrent : asConst(m_torrents))
+        scheduleReannounce(torrent, -1, lt::torrent_handle::ignore_min_interval, announceJitter());
+}
+
+int SessionImpl::announceRampRate() const
+{
+    return m_announceRampRate;
+}
+
+void SessionImpl::setAnnounceRampRate(const int value)
+{
+    if (value == announceRampRate())
+        return;
+
+    m_announceRampRate = value;
+    m_announceScheduler.setAnnouncesPerSecond(announceRampRate());
+}
+
+int SessionImpl::announceJitter() const
+{
+    return m_announceJitter;
+}
+
+void SessionImpl::setAnnounceJitter(const int value)
+{
+    m_announceJitter = value;
+}
+
+void SessionImpl::scheduleReannounce(TorrentImpl *torrent, const int trackerIndex
+        , const lt::reannounce_flags_t flags, const int maxJitter)
+{
+    const QList<TrackerEntryStatus> trackers = torrent->trackers();
+    if ((trackerIndex >= trackers.size()) || trackers.isEmpty())
+        return;
+
+    const int firstIndex = (trackerIndex < 0) ? 0 : trackerIndex;
+    const int lastIndex = (trackerIndex < 0) ? (trackers.size() - 1) : trackerIndex;
+    const auto now = AnnounceScheduler::Clock::now();
+    const QDateTime currentDateTime = QDateTime::currentDateTime();
+
+    QHash<QString, TrackerEntryStatus> scheduledTrackers;
+    for (int i = firstIndex; i <= lastIndex; ++i)
     {
+        const QString host = TrackerHealthRegistry::trackerHost(trackers[i].url);
+        int delay = std::chrono::ceil<std::chrono::seconds>(m_announceScheduler.schedule(host, now)).count();
+        if (maxJitter > 0)
+            delay += static_cast<int>(Utils::Random::rand(0, static_cast<uint32_t>(maxJitter)));
+
         try
         {
-            torrent->nativeHandle().force_reannounce(0, -1, lt::torrent_handle::ignore_min_interval);
+            torrent->nativeHandle().force_reannounce(delay, i, flags);
+        }
+        catch (const std::exception &)
+        {
+            continue;
+        }
+
+        if (delay > 0)
+        {
+            TrackerEntryStatus status = torrent->scheduleTrackerEntryAnnounce(i, currentDateTime.addSecs(delay));
+            const QString url = status.url;
+            scheduledTrackers.emplace(url, std::move(status));
         }
-        catch (const std::exception &) {}
     }
+
+    if (!scheduledTrackers.isEmpty())
+        emit trackerEntryStatusesUpdated(torrent, scheduledTrackers);
 }
 
 int SessionImpl::stopTrackerTimeout() const
@@ -5109,15 +6981,64 @@ void SessionImpl::setAutoBanBTPlayerPeer(bool value)
     }
 }
 
-bool SessionImpl::isShadowBanEnabled() const
+bool SessionImpl::isAutoBanFakeProgressPeerEnabled() const
 {
-    return m_shadowBan;
+    return m_autoBanFakeProgressPeer;
 }
 
-void SessionImpl::setShadowBan(bool value)
+void SessionImpl::setAutoBanFakeProgressPeer(const bool value)
 {
-    if (value != isShadowBanEnabled()) {
-        m_shadowBan = value;
+    if (value == isAutoBanFakeProgressPeerEnabled())
+        return;
+
+    m_autoBanFakeProgressPeer = value;
+    if (!value)
+        m_fakeProgressDetector = FakeProgressDetector();
+}
+
+int SessionImpl::fakeProgressPeerMinUpload() const
+{
+    return m_fakeProgressPeerMinUpload;
+}
+
+void SessionImpl::setFakeProgressPeerMinUpload(const int value)
+{
+    m_fakeProgressPeerMinUpload = value;
+}
+
+int SessionImpl::fakeProgressPeerMinProgress() const
+{
+    return m_fakeProgressPeerMinProgress;
+}
+
+void SessionImpl::setFakeProgressPeerMinProgress(const int value)
+{
+    m_fakeProgressPeerMinProgress = value;
+}
+
+int SessionImpl::bannedPeersHistoryDays() const
+{
+    return m_bannedPeersHistoryDays;
+}
+
+void SessionImpl::setBannedPeersHistoryDays(const int days)
+{
+    if (days == m_bannedPeersHistoryDays)
+        return;
+
+    m_bannedPeersHistoryDays = days;
+    peer_logger_singleton::instance().set_retention_days(bannedPeersHistoryDays());
+}
+
+bool SessionImpl::isShadowBanEnabled() const
+{
+    return m_shadowBan;
+}
+
+void SessionImpl::setShadowBan(bool value)
+{
+    if (value != isShadowBanEnabled()) {
+        m_shadowBan = value;
         LogMsg(tr("Restart is required to toggle Auto Ban Shadow Ban"), Log::WARNING);
     }
 }
@@ -5155,11 +7076,18 @@ void SessionImpl::setShadowBannedIPs(const QStringList &newList)
     // Again ensure that the new list is different from the stored one.
     if (filteredList == m_shadowBannedIPs)
         return; // do nothing
-    // store to session settings
-    // also here we have to recreate filter list including 3rd party ban file
-    // and install it again into m_session
+    // store to session settings and publish the new lookup table
+    // to the shadowban plugin and peer lists
     m_shadowBannedIPs = filteredList;
-    configureDeferred();
+    publishShadowBannedIPs(filteredList);
+
+    // addresses removed from the list are not subject to expiration anymore
+    QVariantMap expirations = m_shadowBannedIPsExpiration;
+    expirations.removeIf([&filteredList](const QVariantMap::iterator it)
+    {
+        return !std::binary_search(filteredList.cbegin(), filteredList.cend(), it.key());
+    });
+    m_shadowBannedIPsExpiration = expirations;
 }
 
 bool SessionImpl::isListening() const
@@ -5176,7 +7104,11 @@ void SessionImpl::setShareLimitAction(const ShareLimitAction act)
 {
     Q_ASSERT(act != ShareLimitAction::Default);
 
+    if (act == m_shareLimitAction)
+        return;
+
     m_shareLimitAction = act;
+    rescheduleShareLimitsChecks();
 }
 
 bool SessionImpl::isKnownTorrent(const InfoHash &infoHash) const
@@ -5194,24 +7126,9 @@ bool SessionImpl::isKnownTorrent(const InfoHash &infoHash) const
     return findTorrent(infoHash);
 }
 
-void SessionImpl::updateSeedingLimitTimer()
-{
-    if ((globalMaxRatio() == Torrent::NO_RATIO_LIMIT) && !hasPerTorrentRatioLimit()
-        && (globalMaxSeedingMinutes() == Torrent::NO_SEEDING_TIME_LIMIT) && !hasPerTorrentSeedingTimeLimit()
-        && (globalMaxInactiveSeedingMinutes() == Torrent::NO_INACTIVE_SEEDING_TIME_LIMIT) && !hasPerTorrentInactiveSeedingTimeLimit())
-    {
-        if (m_seedingLimitTimer->isActive())
-            m_seedingLimitTimer->stop();
-    }
-    else if (!m_seedingLimitTimer->isActive())
-    {
-        m_seedingLimitTimer->start();
-    }
-}
-
-void SessionImpl::handleTorrentShareLimitChanged(TorrentImpl *const)
+void SessionImpl::handleTorrentShareLimitChanged(TorrentImpl *const torrent)
 {
-    updateSeedingLimitTimer();
+    scheduleShareLimitsCheck(torrent);
 }
 
 void SessionImpl::handleTorrentNameChanged(TorrentImpl *const)
@@ -5225,17 +7142,36 @@ void SessionImpl::handleTorrentSavePathChanged(TorrentImpl *const torrent)
 
 void SessionImpl::handleTorrentCategoryChanged(TorrentImpl *const torrent, const QString &oldCategory)
 {
-    emit torrentCategoryChanged(torrent, oldCategory);
+    if (!m_isBulkChangeInProgress)
+        emit torrentCategoryChanged(torrent, oldCategory);
 }
 
 void SessionImpl::handleTorrentTagAdded(TorrentImpl *const torrent, const Tag &tag)
 {
-    emit torrentTagAdded(torrent, tag);
+    if (!m_isBulkChangeInProgress)
+        emit torrentTagAdded(torrent, tag);
 }
 
 void SessionImpl::handleTorrentTagRemoved(TorrentImpl *const torrent, const Tag &tag)
 {
-    emit torrentTagRemoved(torrent, tag);
+    if (!m_isBulkChangeInProgress)
+        emit torrentTagRemoved(torrent, tag);
+}
+
+int SessionImpl::tagIndex(const Tag &tag) const
+{
+    return m_tagIndexes.value(tag.toString(), -1);
+}
+
+int SessionImpl::internTag(const Tag &tag)
+{
+    const auto iter = m_tagIndexes.constFind(tag.toString());
+    if (iter != m_tagIndexes.cend())
+        return iter.value();
+
+    const int index = m_tagIndexes.size();
+    m_tagIndexes.insert(tag.toString(), index);
+    return index;
 }
 
 void SessionImpl::handleTorrentSavingModeChanged(TorrentImpl *const torrent)
@@ -5255,11 +7191,34 @@ void SessionImpl::handleTorrentTrackersRemoved(TorrentImpl *const torrent, const
     for (const QString &deletedTracker : deletedTrackers)
         LogMsg(tr("Removed tracker from torrent. Torrent: \"%1\". Tracker: \"%2\"").arg(torrent->name(), deletedTracker));
     emit trackersRemoved(torrent, deletedTrackers);
+
+    scheduleTrackerURLPoolPurge();
 }
 
 void SessionImpl::handleTorrentTrackersChanged(TorrentImpl *const torrent)
 {
     emit trackersChanged(torrent);
+
+    scheduleTrackerURLPoolPurge();
+}
+
+QString SessionImpl::internTrackerURL(const QString &url)
+{
+    return m_trackerURLPool.intern(url);
+}
+
+void SessionImpl::scheduleTrackerURLPoolPurge()
+{
+    if (m_trackerURLPoolPurgeScheduled)
+        return;
+
+    // trackers are often removed from many torrents at once so the pool is purged after all of them
+    m_trackerURLPoolPurgeScheduled = true;
+    QMetaObject::invokeMethod(this, [this]
+    {
+        m_trackerURLPoolPurgeScheduled = false;
+        m_trackerURLPool.purge();
+    }, Qt::QueuedConnection);
 }
 
 void SessionImpl::handleTorrentUrlSeedsAdded(TorrentImpl *const torrent, const QVector<QUrl> &newUrlSeeds)
@@ -5274,14 +7233,28 @@ void SessionImpl::handleTorrentUrlSeedsRemoved(TorrentImpl *const torrent, const
         LogMsg(tr("Removed URL seed from torrent. Torrent: \"%1\". URL: \"%2\"").arg(torrent->name(), urlSeed.toString()));
 }
 
+void SessionImpl::handleTorrentPieceRead(TorrentImpl *const torrent, const int pieceIndex, const QByteArray &data)
+{
+    emit torrentPieceRead(torrent, pieceIndex, data);
+}
+
 void SessionImpl::handleTorrentMetadataReceived(TorrentImpl *const torrent)
 {
+    m_metadataDownloads.remove(torrent->id());
+    m_timedOutMetadataDownloads.remove(torrent->id());
+    storeMetadata(torrent->info());
+
     if (!torrentExportDirectory().isEmpty())
         exportTorrentFile(torrent, torrentExportDirectory());
 
     emit torrentMetadataReceived(torrent);
 }
 
+void SessionImpl::handleTorrentReannounceRequested(TorrentImpl *const torrent, const int trackerIndex)
+{
+    scheduleReannounce(torrent, trackerIndex, {}, 0);
+}
+
 void SessionImpl::handleTorrentStopped(TorrentImpl *const torrent)
 {
     torrent->resetTrackerEntryStatuses();
@@ -5306,9 +7279,44 @@ void SessionImpl::handleTorrentStarted(TorrentImpl *const torrent)
 
 void SessionImpl::handleTorrentChecked(TorrentImpl *const torrent)
 {
+    removeCheckingJob(torrent->id());
+
+    // Files of the torrent were only partially checked before shutdown, so the pieces
+    // restored from its resume data can't be trusted and it has to be checked again
+    if (m_interruptedCheckingTorrents.remove(torrent->id()))
+    {
+        LogMsg(tr("Torrent checking was interrupted. Checking it again. Torrent: \"%1\"").arg(torrent->name()));
+        storeCheckingQueue();
+        torrent->forceRecheck();
+    }
+
     emit torrentFinishedChecking(torrent);
 }
 
+void SessionImpl::handleTorrentCheckingQueued(TorrentImpl *const torrent)
+{
+    // stopped torrent isn't checked until it is started
+    if ((maxActiveCheckingTorrentsPerDevice() <= 0) || torrent->isStopped())
+        return;
+
+    // the torrent is going to be fully checked anyway
+    const TorrentID torrentID = torrent->id();
+    m_interruptedCheckingTorrents.remove(torrentID);
+
+    const bool isQueued = std::any_of(m_checkingQueue.cbegin(), m_checkingQueue.cend()
+        , [&torrentID](const CheckingJob &job) { return job.torrentID == torrentID; });
+    if (isQueued)
+        return;
+
+    m_checkingQueue.append({
+        .torrentID = torrentID,
+        .device = Utils::Fs::storageDeviceID(torrent->actualStorageLocation()),
+        .size = torrent->totalSize()
+    });
+    storeCheckingQueue();
+    startQueuedCheckingJobs();
+}
+
 void SessionImpl::handleTorrentFinished(TorrentImpl *const torrent)
 {
     m_pendingFinishedTorrents.append(torrent);
@@ -5316,7 +7324,9 @@ void SessionImpl::handleTorrentFinished(TorrentImpl *const torrent)
 
 void SessionImpl::handleTorrentResumeDataReady(TorrentImpl *const torrent, const LoadTorrentParams &data)
 {
-    m_resumeDataStorage->store(torrent->id(), data);
+    QBT_TRACE_SCOPE("SessionImpl::handleTorrentResumeDataReady");
+
+    m_pendingResumeData.insert(torrent->id(), data);
     const auto iter = m_changedTorrentIDs.find(torrent->id());
     if (iter != m_changedTorrentIDs.end())
     {
@@ -5337,12 +7347,18 @@ void SessionImpl::handleTorrentInfoHashChanged(TorrentImpl *torrent, const InfoH
     {
         m_torrents[torrent->id()] = m_torrents.take(prevID);
         m_changedTorrentIDs[torrent->id()] = prevID;
+
+        for (CheckingJob &job : m_checkingQueue)
+        {
+            if (job.torrentID == prevID)
+                job.torrentID = currentID;
+        }
     }
 }
 
 void SessionImpl::handleTorrentStorageMovingStateChanged(TorrentImpl *torrent)
 {
-    emit torrentsUpdated({torrent});
+    emit torrentsUpdated({torrent}, {TorrentStatusField::State});
 }
 
 bool SessionImpl::addMoveTorrentStorageJob(TorrentImpl *torrent, const Path &newPath, const MoveStorageMode mode, const MoveStorageContext context)
@@ -5351,30 +7367,33 @@ bool SessionImpl::addMoveTorrentStorageJob(TorrentImpl *torrent, const Path &new
 
     const lt::torrent_handle torrentHandle = torrent->nativeHandle();
     const Path currentLocation = torrent->actualStorageLocation();
-    const bool torrentHasActiveJob = !m_moveStorageQueue.isEmpty() && (m_moveStorageQueue.first().torrentHandle == torrentHandle);
-
-    if (m_moveStorageQueue.size() > 1)
+    const auto activeJobIter = std::find_if(m_moveStorageQueue.cbegin(), m_moveStorageQueue.cend()
+            , [&torrentHandle](const MoveStorageJob &job)
     {
-        auto iter = std::find_if((m_moveStorageQueue.begin() + 1), m_moveStorageQueue.end()
-                , [&torrentHandle](const MoveStorageJob &job)
-        {
-            return job.torrentHandle == torrentHandle;
-        });
+        return job.isActive && (job.torrentHandle == torrentHandle);
+    });
+    const bool torrentHasActiveJob = (activeJobIter != m_moveStorageQueue.cend());
+    // the job cannot start before the active one is finished so it moves the files from its destination
+    const Path sourcePath = torrentHasActiveJob ? activeJobIter->path : currentLocation;
 
-        if (iter != m_moveStorageQueue.end())
-        {
-            // remove existing inactive job
-            torrent->handleMoveStorageJobFinished(currentLocation, iter->context, torrentHasActiveJob);
-            LogMsg(tr("Torrent move canceled. Torrent: \"%1\". Source: \"%2\". Destination: \"%3\"").arg(torrent->name(), currentLocation.toString(), iter->path.toString()));
-            m_moveStorageQueue.erase(iter);
-        }
+    const auto queuedJobIter = std::find_if(m_moveStorageQueue.begin(), m_moveStorageQueue.end()
+            , [&torrentHandle](const MoveStorageJob &job)
+    {
+        return !job.isActive && (job.torrentHandle == torrentHandle);
+    });
+    if (queuedJobIter != m_moveStorageQueue.end())
+    {
+        // remove existing inactive job
+        torrent->handleMoveStorageJobFinished(currentLocation, queuedJobIter->context, torrentHasActiveJob);
+        LogMsg(tr("Torrent move canceled. Torrent: \"%1\". Source: \"%2\". Destination: \"%3\"").arg(torrent->name(), currentLocation.toString(), queuedJobIter->path.toString()));
+        m_moveStorageQueue.erase(queuedJobIter);
     }
 
     if (torrentHasActiveJob)
     {
         // if there is active job for this torrent prevent creating meaningless
         // job that will move torrent to the same location as current one
-        if (m_moveStorageQueue.first().path == newPath)
+        if (sourcePath == newPath)
         {
             LogMsg(tr("Failed to enqueue torrent move. Torrent: \"%1\". Source: \"%2\". Destination: \"%3\". Reason: torrent is currently moving to the destination")
                    .arg(torrent->name(), currentLocation.toString(), newPath.toString()));
@@ -5391,16 +7410,279 @@ bool SessionImpl::addMoveTorrentStorageJob(TorrentImpl *torrent, const Path &new
         }
     }
 
-    const MoveStorageJob moveStorageJob {torrentHandle, newPath, mode, context};
+    const MoveStorageJob moveStorageJob {
+        .torrentHandle = torrentHandle,
+        .path = newPath,
+        .mode = mode,
+        .context = context,
+        .sourcePath = sourcePath,
+        .devices = {storageDeviceID(sourcePath), storageDeviceID(newPath)}
+    };
     m_moveStorageQueue << moveStorageJob;
-    LogMsg(tr("Enqueued torrent move. Torrent: \"%1\". Source: \"%2\". Destination: \"%3\"").arg(torrent->name(), currentLocation.toString(), newPath.toString()));
 
-    if (m_moveStorageQueue.size() == 1)
-        moveTorrentStorage(moveStorageJob);
+    if (m_isRelocationBatchBeingFilled)
+    {
+        // the batch is logged as a whole and its jobs are started once all of them are enqueued
+        m_relocationBatches.last().pendingTorrents.insert(torrentHandle);
+        return true;
+    }
+
+    LogMsg(tr("Enqueued torrent move. Torrent: \"%1\". Source: \"%2\". Destination: \"%3\"").arg(torrent->name(), currentLocation.toString(), newPath.toString()));
+    startQueuedMoveStorageJobs();
 
     return true;
 }
 
+void SessionImpl::relocateTorrents(const QVector<TorrentImpl *> &torrents, const QString &batchName)
+{
+    m_relocationBatches.append({.name = batchName});
+    m_isRelocationBatchBeingFilled = true;
+    for (TorrentImpl *const torrent : torrents)
+        torrent->handleCategoryOptionsChanged();
+    m_isRelocationBatchBeingFilled = false;
+    m_relocationDeviceIDs.clear();
+
+    RelocationBatch &batch = m_relocationBatches.last();
+    batch.torrentsCount = static_cast<int>(batch.pendingTorrents.size());
+    if (batch.torrentsCount == 0)
+    {
+        m_relocationBatches.removeLast();
+        return;
+    }
+
+    LogMsg(tr("Enqueued relocation of torrents. Reason: %1. Torrents: %2").arg(batchName, QString::number(batch.torrentsCount)));
+    startQueuedMoveStorageJobs();
+}
+
+void SessionImpl::handleRelocationFinished(const lt::torrent_handle &torrentHandle, const bool isFailed)
+{
+    // the torrent can belong to several batches if it was relocated again before its move started
+    for (auto it = m_relocationBatches.begin(); it != m_relocationBatches.end();)
+    {
+        RelocationBatch &batch = *it;
+        if (batch.pendingTorrents.erase(torrentHandle) == 0)
+        {
+            ++it;
+            continue;
+        }
+
+        if (isFailed)
+            ++batch.failedCount;
+
+        const int finishedCount = batch.torrentsCount - static_cast<int>(batch.pendingTorrents.size());
+        if (batch.pendingTorrents.empty())
+        {
+            LogMsg(tr("Relocation of torrents finished. Reason: %1. Moved: %2. Failed: %3").arg(batch.name
+                , QString::number(batch.torrentsCount - batch.failedCount), QString::number(batch.failedCount))
+                , ((batch.failedCount > 0) ? Log::WARNING : Log::NORMAL));
+            it = m_relocationBatches.erase(it);
+            continue;
+        }
+
+        if (const int percentage = (finishedCount * 100 / batch.torrentsCount); percentage >= (batch.reportedPercentage + 10))
+        {
+            batch.reportedPercentage = percentage - (percentage % 10);
+            LogMsg(tr("Relocating torrents. Reason: %1. Progress: %2/%3").arg(batch.name
+                , QString::number(finishedCount), QString::number(batch.torrentsCount)));
+        }
+        ++it;
+    }
+}
+
+QByteArray SessionImpl::storageDeviceID(const Path &path)
+{
+    // torrents relocated together mostly share a few locations
+    if (!m_isRelocationBatchBeingFilled)
+        return Utils::Fs::storageDeviceID(path);
+
+    auto iter = m_relocationDeviceIDs.find(path);
+    if (iter == m_relocationDeviceIDs.end())
+        iter = m_relocationDeviceIDs.insert(path, Utils::Fs::storageDeviceID(path));
+    return iter.value();
+}
+
+void SessionImpl::startQueuedMoveStorageJobs()
+{
+    // Moves between different devices don't compete for disk I/O so they can run
+    // concurrently, while the number of moves sharing the same devices is limited
+    QHash<std::pair<QByteArray, QByteArray>, int> activeJobsCount;
+    std::unordered_set<lt::torrent_handle> movingTorrents;
+    for (const MoveStorageJob &job : asConst(m_moveStorageQueue))
+    {
+        if (job.isActive)
+        {
+            ++activeJobsCount[job.devices];
+            movingTorrents.insert(job.torrentHandle);
+        }
+    }
+
+    const int maxActiveJobs = maxActiveMoveStorageJobsPerDevice();
+    for (MoveStorageJob &job : m_moveStorageQueue)
+    {
+        // torrent storage can be moved by only one job at a time
+        if (job.isActive || movingTorrents.contains(job.torrentHandle))
+            continue;
+
+        int &jobsCount = activeJobsCount[job.devices];
+        if (jobsCount >= maxActiveJobs)
+            continue;
+
+        ++jobsCount;
+        movingTorrents.insert(job.torrentHandle);
+        job.isActive = true;
+        moveTorrentStorage(job);
+    }
+}
+
+void SessionImpl::startQueuedCheckingJobs()
+{
+    // Checks of different devices don't compete for disk I/O so they can run concurrently.
+    // Smaller torrents are checked first so that they aren't blocked by large ones.
+    const int maxActiveJobsPerDevice = maxActiveCheckingTorrentsPerDevice();
+    if (maxActiveJobsPerDevice <= 0)
+        return;
+
+    QHash<QByteArray, int> activeJobsCount;
+    int totalActiveJobsCount = 0;
+    QList<CheckingJob *> queuedJobs;
+    for (CheckingJob &job : m_checkingQueue)
+    {
+        if (job.isActive)
+        {
+            ++activeJobsCount[job.device];
+            ++totalActiveJobsCount;
+        }
+        else
+        {
+            queuedJobs.append(&job);
+        }
+    }
+
+    std::stable_sort(queuedJobs.begin(), queuedJobs.end(), [](const CheckingJob *left, const CheckingJob *right)
+    {
+        return left->size < right->size;
+    });
+
+    const int maxActiveJobs = maxActiveCheckingTorrents();
+    for (CheckingJob *job : asConst(queuedJobs))
+    {
+        if ((maxActiveJobs >= 0) && (totalActiveJobsCount >= maxActiveJobs))
+            break;
+
+        int &jobsCount = activeJobsCount[job->device];
+        if (jobsCount >= maxActiveJobsPerDevice)
+            continue;
+
+        const TorrentImpl *torrent = m_torrents.value(job->torrentID);
+        Q_ASSERT(torrent);
+        if (!torrent) [[unlikely]]
+            continue;
+
+        ++jobsCount;
+        ++totalActiveJobsCount;
+        job->isActive = true;
+        torrent->nativeHandle().resume();
+    }
+}
+
+void SessionImpl::updateMetadataDownloads()
+{
+    // Queued torrents don't download metadata, so magnet links added in bulk would get it
+    // one by one as download slots are freed. Some of them are started out of the queue
+    // to download metadata meanwhile, they go back to the queue once it is received.
+    const int maxActiveDownloads = isQueueingSystemEnabled() ? maxActiveMetadataDownloads() : 0;
+    const lt::clock_type::time_point now = lt::clock_type::now();
+    const std::chrono::seconds timeout {metadataDownloadTimeout()};
+
+    for (auto iter = m_metadataDownloads.begin(); iter != m_metadataDownloads.end();)
+    {
+        TorrentImpl *torrent = m_torrents.value(iter.key());
+        if (!torrent || !torrent->isDownloadingMetadataOutOfQueue())
+        {
+            iter = m_metadataDownloads.erase(iter);
+            continue;
+        }
+
+        const bool isTimedOut = ((now - iter.value()) >= timeout);
+        if ((maxActiveDownloads <= 0) || isTimedOut)
+        {
+            if (isTimedOut)
+            {
+                m_timedOutMetadataDownloads.insert(iter.key());
+                LogMsg(tr("Failed to download metadata in time, the torrent is returned to the queue. Torrent: \"%1\"")
+                    .arg(torrent->name()));
+            }
+
+            torrent->returnToQueue();
+            iter = m_metadataDownloads.erase(iter);
+            continue;
+        }
+
+        ++iter;
+    }
+
+    const qsizetype freeSlots = maxActiveDownloads - m_metadataDownloads.size();
+    if (freeSlots <= 0)
+        return;
+
+    QList<TorrentImpl *> queuedTorrents;
+    for (TorrentImpl *torrent : asConst(m_torrents))
+    {
+        if (!torrent->hasMetadata() && torrent->isQueued() && !torrent->isDownloadingMetadataOutOfQueue()
+                && !m_timedOutMetadataDownloads.contains(torrent->id()))
+        {
+            queuedTorrents.append(torrent);
+        }
+    }
+
+    // torrents are picked in queue order
+    const qsizetype startedCount = std::min(freeSlots, queuedTorrents.size());
+    std::partial_sort(queuedTorrents.begin(), (queuedTorrents.begin() + startedCount), queuedTorrents.end()
+        , [](const TorrentImpl *left, const TorrentImpl *right) { return left->queuePosition() < right->queuePosition(); });
+    for (qsizetype i = 0; i < startedCount; ++i)
+    {
+        TorrentImpl *torrent = queuedTorrents[i];
+        torrent->downloadMetadataOutOfQueue();
+        m_metadataDownloads.insert(torrent->id(), now);
+    }
+}
+
+void SessionImpl::removeCheckingJob(const TorrentID &id)
+{
+    const auto iter = std::find_if(m_checkingQueue.cbegin(), m_checkingQueue.cend()
+        , [&id](const CheckingJob &job) { return job.torrentID == id; });
+    if (iter == m_checkingQueue.cend())
+        return;
+
+    m_checkingQueue.erase(iter);
+    storeCheckingQueue();
+    startQueuedCheckingJobs();
+}
+
+void SessionImpl::storeCheckingQueue() const
+{
+    QStringList torrentIDs;
+    torrentIDs.reserve(m_checkingQueue.size() + m_interruptedCheckingTorrents.size());
+    for (const CheckingJob &job : m_checkingQueue)
+        torrentIDs.append(job.torrentID.toString());
+    for (const TorrentID &id : m_interruptedCheckingTorrents)
+        torrentIDs.append(id.toString());
+
+    std::unique_ptr<QSettings> settings = Profile::instance()->applicationSettings(u"qBittorrent-data"_s);
+    settings->setValue(u"Checking/QueuedTorrents"_s, torrentIDs);
+}
+
+void SessionImpl::loadCheckingQueue()
+{
+    const std::unique_ptr<QSettings> settings = Profile::instance()->applicationSettings(u"qBittorrent-data"_s);
+    const QStringList torrentIDs = settings->value(u"Checking/QueuedTorrents"_s).toStringList();
+    for (const QString &idString : torrentIDs)
+    {
+        if (const auto id = TorrentID::fromString(idString); id.isValid())
+            m_interruptedCheckingTorrents.insert(id);
+    }
+}
+
 void SessionImpl::moveTorrentStorage(const MoveStorageJob &job) const
 {
 #ifdef QBT_USES_LIBTORRENT2
@@ -5415,11 +7697,20 @@ void SessionImpl::moveTorrentStorage(const MoveStorageJob &job) const
     job.torrentHandle.move_storage(job.path.toString().toStdString(), toNative(job.mode));
 }
 
-void SessionImpl::handleMoveTorrentStorageJobFinished(const Path &newPath)
+void SessionImpl::handleMoveTorrentStorageJobFinished(const lt::torrent_handle &torrentHandle, const Path &newPath)
 {
-    const MoveStorageJob finishedJob = m_moveStorageQueue.takeFirst();
-    if (!m_moveStorageQueue.isEmpty())
-        moveTorrentStorage(m_moveStorageQueue.first());
+    const auto finishedJobIter = std::find_if(m_moveStorageQueue.cbegin(), m_moveStorageQueue.cend()
+            , [&torrentHandle](const MoveStorageJob &job)
+    {
+        return job.isActive && (job.torrentHandle == torrentHandle);
+    });
+    Q_ASSERT(finishedJobIter != m_moveStorageQueue.cend());
+    if (finishedJobIter == m_moveStorageQueue.cend())
+        return;
+
+    const MoveStorageJob finishedJob = *finishedJobIter;
+    m_moveStorageQueue.erase(finishedJobIter);
+    startQueuedMoveStorageJobs();
 
     const auto iter = std::find_if(m_moveStorageQueue.cbegin(), m_moveStorageQueue.cend()
             , [&finishedJob](const MoveStorageJob &job)
@@ -5428,6 +7719,8 @@ void SessionImpl::handleMoveTorrentStorageJobFinished(const Path &newPath)
     });
 
     const bool torrentHasOutstandingJob = (iter != m_moveStorageQueue.cend());
+    if (!torrentHasOutstandingJob)
+        handleRelocationFinished(finishedJob.torrentHandle, (newPath != finishedJob.path));
 
     TorrentImpl *torrent = m_torrents.value(finishedJob.torrentHandle.info_hash());
     if (torrent)
@@ -5553,30 +7846,6 @@ void SessionImpl::loadCategories()
     }
 }
 
-bool SessionImpl::hasPerTorrentRatioLimit() const
-{
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentImpl *torrent)
-    {
-        return (torrent->ratioLimit() >= 0);
-    });
-}
-
-bool SessionImpl::hasPerTorrentSeedingTimeLimit() const
-{
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentImpl *torrent)
-    {
-        return (torrent->seedingTimeLimit() >= 0);
-    });
-}
-
-bool SessionImpl::hasPerTorrentInactiveSeedingTimeLimit() const
-{
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentImpl *torrent)
-    {
-       return (torrent->inactiveSeedingTimeLimit() >= 0);
-    });
-}
-
 void SessionImpl::configureDeferred()
 {
     if (m_deferredConfigureScheduled)
@@ -5602,6 +7871,7 @@ void SessionImpl::enableIPFilter()
         connect(m_filterParser.data(), &FilterParserThread::IPFilterError, this, &SessionImpl::handleIPFilterError);
     }
     m_filterParser->processFilterFile(IPFilterFile());
+    m_IPFilterSubscriptionManager->setEnabled(true);
 }
 
 // Disable IP Filtering
@@ -5613,13 +7883,13 @@ void SessionImpl::disableIPFilter()
         disconnect(m_filterParser.data(), nullptr, this, nullptr);
         delete m_filterParser;
     }
+    m_IPFilterSubscriptionManager->setEnabled(false);
+    m_parsedIPFilter = {};
 
     // Add the banned IPs after the IPFilter disabling
     // which creates an empty filter and overrides all previously
     // applied bans.
-    lt::ip_filter filter;
-    processBannedIPs(filter);
-    m_nativeSession->set_ip_filter(filter);
+    applyIPFilter({});
 }
 
 const SessionStatus &SessionImpl::status() const
@@ -5632,77 +7902,231 @@ const CacheStatus &SessionImpl::cacheStatus() const
     return m_cacheStatus;
 }
 
+SessionMetrics SessionImpl::metrics() const
+{
+    SessionMetrics metrics = m_metrics;
+    metrics.counters.reserve(m_sessionCounters.size());
+    for (const auto &[counter, index] : asConst(m_sessionCounters))
+    {
+        SessionCounter &item = metrics.counters.emplaceBack(counter);
+        if (static_cast<std::size_t>(index) < m_sessionStats.size())
+            item.value = m_sessionStats[index];
+    }
+#ifdef QBT_USES_LIBTORRENT2
+    metrics.diskIO = DiskIOStatisticsCollector::instance()->statistics();
+#endif
+
+    return metrics;
+}
+
+QList<MemoryUsage::Entry> SessionImpl::estimateMemoryUsage() const
+{
+    qint64 torrentsSize = 0;
+    qint64 filesCount = 0;
+    qint64 filesSize = 0;
+    for (const TorrentImpl *torrent : asConst(m_torrents))
+    {
+        torrentsSize += torrent->estimatedMemoryUsage();
+        filesCount += torrent->filesCount();
+        filesSize += torrent->estimatedFilesMemoryUsage();
+    }
+
+    return {
+        {u"torrents"_s, m_torrents.size(), torrentsSize}
+        , {u"torrents.files"_s, filesCount, filesSize}
+        , {u"torrents.loading"_s, m_loadingTorrents.size(), static_cast<qint64>(m_loadingTorrents.size() * sizeof(LoadTorrentParams))}
+        , {u"resumedata.pending"_s, m_pendingResumeData.size(), static_cast<qint64>(m_pendingResumeData.size() * sizeof(LoadTorrentParams))}
+    };
+}
+
 void SessionImpl::enqueueRefresh()
 {
     Q_ASSERT(!m_refreshEnqueued);
 
-    QTimer::singleShot(refreshInterval(), Qt::CoarseTimer, this, [this]
+    m_refreshTimer->start(isRefreshDemanded() ? refreshInterval() : std::max(refreshInterval(), IDLE_REFRESH_INTERVAL));
+    m_refreshEnqueued = true;
+}
+
+void SessionImpl::postRefresh()
+{
+    m_postedStatusFlags = isRefreshDemanded() ? FULL_STATUS_FLAGS : IDLE_STATUS_FLAGS;
+    m_nativeSession->post_torrent_updates(m_postedStatusFlags);
+    m_nativeSession->post_session_stats();
+
+    if (m_torrentsQueueChanged)
     {
-        m_nativeSession->post_torrent_updates();
-        m_nativeSession->post_session_stats();
+        m_torrentsQueueChanged = false;
+        m_needSaveTorrentsQueue = true;
+    }
+}
+
+bool SessionImpl::isRefreshDemanded() const
+{
+    return m_refreshDemandTimer.isValid() && !m_refreshDemandTimer.hasExpired(REFRESH_DEMAND_TIMEOUT);
+}
+
+void SessionImpl::demandRefresh()
+{
+    const bool wasDemanded = isRefreshDemanded();
+    m_refreshDemandTimer.start();
+
+    // refresh enqueued at idle rate is brought forward to deliver full statuses soon
+    if (!wasDemanded && m_refreshTimer->isActive() && (m_refreshTimer->remainingTime() > refreshInterval()))
+        m_refreshTimer->start(0);
+}
+
+void SessionImpl::handleIPFilterParsed(const int ruleCount)
+{
+    if (m_filterParser)
+    {
+        m_parsedIPFilter = m_filterParser->IPfilter();
+        applyParsedIPFilter();
+    }
+    LogMsg(tr("Successfully parsed the IP filter file. Number of rules applied: %1").arg(ruleCount));
+    emit IPFilterParsed(false, ruleCount);
+}
+
+void SessionImpl::handleIPFilterError()
+{
+    // subscribed lists are still applied even if the filter file is broken
+    m_parsedIPFilter = {};
+    applyParsedIPFilter();
+
+    LogMsg(tr("Failed to parse the IP filter file"), Log::WARNING);
+    emit IPFilterParsed(true, 0);
+}
+
+std::vector<lt::alert *> SessionImpl::getPendingAlerts(const lt::time_duration time) const
+{
+    if (time > lt::time_duration::zero())
+        m_nativeSession->wait_for_alert(time);
+
+    std::vector<lt::alert *> alerts;
+    m_nativeSession->pop_alerts(&alerts);
+    return alerts;
+}
 
-        if (m_torrentsQueueChanged)
+TorrentContentLayout SessionImpl::torrentContentLayout() const
+{
+    return m_torrentContentLayout;
+}
+
+void SessionImpl::setTorrentContentLayout(const TorrentContentLayout value)
+{
+    m_torrentContentLayout = value;
+}
+
+void SessionImpl::startAlertsThread()
+{
+    m_alertsThread.reset(QThread::create([this] { runAlertsThread(); }));
+    m_alertsThread->setObjectName(u"SessionImpl m_alertsThread"_s);
+    m_alertsThread->start();
+}
+
+void SessionImpl::stopAlertsThread()
+{
+    if (!m_alertsThread)
+        return;
+
+    {
+        const QMutexLocker locker {&m_pendingAlertsMutex};
+        m_isAlertsThreadStopping = true;
+    }
+    m_pendingAlertsProcessed.wakeAll();
+    m_alertsThread.reset();
+
+    // handle the alerts the thread has handed over last, they stay valid until the next pop_alerts() call
+    readAlerts();
+}
+
+void SessionImpl::runAlertsThread()
+{
+    std::vector<lt::alert *> mainThreadAlerts;
+    while (true)
+    {
         {
-            m_torrentsQueueChanged = false;
-            m_needSaveTorrentsQueue = true;
+            const QMutexLocker locker {&m_pendingAlertsMutex};
+            if (m_isAlertsThreadStopping)
+                break;
+        }
+
+        const std::vector<lt::alert *> alerts = getPendingAlerts(lt::milliseconds(500));
+
+        mainThreadAlerts.clear();
+        for (lt::alert *alert : alerts)
+        {
+            if (!handleAlertInBackground(alert))
+                mainThreadAlerts.push_back(alert);
+        }
+
+        if (mainThreadAlerts.empty())
+            continue;
+
+        QMutexLocker locker {&m_pendingAlertsMutex};
+        m_pendingAlerts.swap(mainThreadAlerts);
+        if (m_isAlertsThreadStopping)
+            break;
+
+        QMetaObject::invokeMethod(this, &SessionImpl::readAlerts, Qt::QueuedConnection);
+        // popped alerts are only valid until the next pop_alerts() call,
+        // so wait until main thread is done with them
+        while (!m_pendingAlerts.empty() && !m_isAlertsThreadStopping)
+            m_pendingAlertsProcessed.wait(&m_pendingAlertsMutex);
+    }
+}
+
+// Handles the alerts which don't need main thread, returns false for the others
+bool SessionImpl::handleAlertInBackground(const lt::alert *alert)
+{
+    try
+    {
+        switch (alert->type())
+        {
+        case lt::tracker_announce_alert::alert_type:
+        case lt::tracker_error_alert::alert_type:
+        case lt::tracker_reply_alert::alert_type:
+        case lt::tracker_warning_alert::alert_type:
+            handleTrackerAlert(static_cast<const lt::tracker_alert *>(alert));
+            return true;
+        case lt::peer_blocked_alert::alert_type:
+            handlePeerBlockedAlert(static_cast<const lt::peer_blocked_alert *>(alert));
+            return true;
+        case lt::peer_ban_alert::alert_type:
+            handlePeerBanAlert(static_cast<const lt::peer_ban_alert *>(alert));
+            return true;
+        default:
+            return false;
         }
-    });
-
-    m_refreshEnqueued = true;
-}
-
-void SessionImpl::handleIPFilterParsed(const int ruleCount)
-{
-    if (m_filterParser)
+    }
+    catch (const std::exception &exc)
     {
-        lt::ip_filter filter = m_filterParser->IPfilter();
-        processBannedIPs(filter);
-        m_nativeSession->set_ip_filter(filter);
+        qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromStdString(exc.what());
     }
-    LogMsg(tr("Successfully parsed the IP filter file. Number of rules applied: %1").arg(ruleCount));
-    emit IPFilterParsed(false, ruleCount);
-}
-
-void SessionImpl::handleIPFilterError()
-{
-    lt::ip_filter filter;
-    processBannedIPs(filter);
-    m_nativeSession->set_ip_filter(filter);
 
-    LogMsg(tr("Failed to parse the IP filter file"), Log::WARNING);
-    emit IPFilterParsed(true, 0);
+    return true;
 }
 
-std::vector<lt::alert *> SessionImpl::getPendingAlerts(const lt::time_duration time) const
+// Handle alerts handed over by alerts thread
+void SessionImpl::readAlerts()
 {
-    if (time > lt::time_duration::zero())
-        m_nativeSession->wait_for_alert(time);
+    const ActivityScope activityScope {"BitTorrent::SessionImpl::readAlerts"};
+    QBT_TRACE_SCOPE("SessionImpl::readAlerts");
 
-    std::vector<lt::alert *> alerts;
-    m_nativeSession->pop_alerts(&alerts);
-    return alerts;
-}
+    QMutexLocker locker {&m_pendingAlertsMutex};
+    const std::vector<lt::alert *> alerts = m_pendingAlerts;
+    locker.unlock();
 
-TorrentContentLayout SessionImpl::torrentContentLayout() const
-{
-    return m_torrentContentLayout;
-}
+    if (alerts.empty())
+        return;
 
-void SessionImpl::setTorrentContentLayout(const TorrentContentLayout value)
-{
-    m_torrentContentLayout = value;
-}
+    QElapsedTimer processingTimer;
+    processingTimer.start();
 
-// Read alerts sent by libtorrent session
-void SessionImpl::readAlerts()
-{
     // cache current datetime of Qt and libtorrent clocks in order
     // to optimize conversion of time points from lt to Qt clocks
     m_ltNow = lt::clock_type::now();
     m_qNow = QDateTime::currentDateTime();
 
-    const std::vector<lt::alert *> alerts = getPendingAlerts();
-
     Q_ASSERT(m_loadedTorrents.isEmpty());
     Q_ASSERT(m_receivedAddTorrentAlertsCount == 0);
 
@@ -5712,6 +8136,8 @@ void SessionImpl::readAlerts()
     for (const lt::alert *a : alerts)
         handleAlert(a);
 
+    storePendingResumeData();
+
     if (m_receivedAddTorrentAlertsCount > 0)
     {
         emit addTorrentAlertsReceived(m_receivedAddTorrentAlertsCount);
@@ -5729,6 +8155,13 @@ void SessionImpl::readAlerts()
 
     // Some torrents may become "finished" after different alerts handling.
     processPendingFinishedTorrents();
+
+    locker.relock();
+    m_pendingAlerts.clear();
+    locker.unlock();
+    m_pendingAlertsProcessed.wakeAll();
+
+    m_metrics.alertsProcessing.add(processingTimer.nsecsElapsed());
 }
 
 void SessionImpl::handleAddTorrentAlert(const lt::add_torrent_alert *alert)
@@ -5822,6 +8255,8 @@ void SessionImpl::handleAlert(const lt::alert *alert)
         case lt::torrent_checked_alert::alert_type:
         case lt::metadata_received_alert::alert_type:
         case lt::performance_alert::alert_type:
+        case lt::piece_finished_alert::alert_type:
+        case lt::read_piece_alert::alert_type:
             dispatchTorrentAlert(static_cast<const lt::torrent_alert *>(alert));
             break;
         case lt::state_update_alert::alert_type:
@@ -5933,6 +8368,16 @@ void SessionImpl::dispatchTorrentAlert(const lt::torrent_alert *alert)
 
     if (torrent)
     {
+        if ((alert->type() == lt::save_resume_data_alert::alert_type)
+                || (alert->type() == lt::save_resume_data_failed_alert::alert_type))
+        {
+            if (const auto requestTimeIter = m_resumeDataRequestTimes.constFind(torrent); requestTimeIter != m_resumeDataRequestTimes.cend())
+            {
+                m_metrics.resumeDataSaving.add(m_metricsTimer.nsecsElapsed() - requestTimeIter.value());
+                m_resumeDataRequestTimes.erase(requestTimeIter);
+            }
+        }
+
         torrent->handleAlert(alert);
         return;
     }
@@ -5949,10 +8394,12 @@ TorrentImpl *SessionImpl::createTorrent(const lt::torrent_handle &nativeHandle,
 {
     auto *const torrent = new TorrentImpl(this, m_nativeSession, nativeHandle, params);
     m_torrents.insert(torrent->id(), torrent);
+    m_torrentRegistry.insert(torrent);
     if (const InfoHash infoHash = torrent->infoHash(); infoHash.isHybrid())
         m_hybridTorrentsByAltID.insert(TorrentID::fromSHA1Hash(infoHash.v1()), torrent);
 
-    if (isRestored())
+    const bool isNewTorrent = isRestored() && !params.isDeferred;
+    if (isNewTorrent)
     {
         if (params.addToQueueTop)
             nativeHandle.queue_position_top();
@@ -5967,13 +8414,9 @@ TorrentImpl *SessionImpl::createTorrent(const lt::torrent_handle &nativeHandle,
         }
     }
 
-    if (((torrent->ratioLimit() >= 0) || (torrent->seedingTimeLimit() >= 0))
-        && !m_seedingLimitTimer->isActive())
-    {
-        m_seedingLimitTimer->start();
-    }
+    scheduleShareLimitsCheck(torrent);
 
-    if (!isRestored())
+    if (!isNewTorrent)
     {
         LogMsg(tr("Restored torrent. Torrent: \"%1\"").arg(torrent->name()));
     }
@@ -6064,6 +8507,7 @@ void SessionImpl::handleMetadataReceivedAlert(const lt::metadata_received_alert
     {
         const TorrentInfo metadata {*alert->handle.torrent_file()};
         m_nativeSession->remove_torrent(alert->handle, lt::session::delete_files);
+        storeMetadata(metadata);
 
         emit metadataDownloaded(metadata);
     }
@@ -6105,39 +8549,40 @@ void SessionImpl::handlePortmapAlert(const lt::portmap_alert *alert)
 
 void SessionImpl::handlePeerBlockedAlert(const lt::peer_blocked_alert *alert)
 {
-    QString reason;
-    switch (alert->reason)
-    {
-    case lt::peer_blocked_alert::ip_filter:
-        reason = tr("IP filter", "this peer was blocked. Reason: IP filter.");
-        break;
-    case lt::peer_blocked_alert::port_filter:
-        reason = tr("filtered port (%1)", "this peer was blocked. Reason: filtered port (8899).").arg(QString::number(alert->endpoint.port()));
-        break;
-    case lt::peer_blocked_alert::i2p_mixed:
-        reason = tr("%1 mixed mode restrictions", "this peer was blocked. Reason: I2P mixed mode restrictions.").arg(u"I2P"_s); // don't translate I2P
-        break;
-    case lt::peer_blocked_alert::privileged_ports:
-        reason = tr("privileged port (%1)", "this peer was blocked. Reason: privileged port (80).").arg(QString::number(alert->endpoint.port()));
-        break;
-    case lt::peer_blocked_alert::utp_disabled:
-        reason = tr("%1 is disabled", "this peer was blocked. Reason: uTP is disabled.").arg(C_UTP); // don't translate μTP
-        break;
-    case lt::peer_blocked_alert::tcp_disabled:
-        reason = tr("%1 is disabled", "this peer was blocked. Reason: TCP is disabled.").arg(u"TCP"_s); // don't translate TCP
-        break;
-    }
-
     const QString ip {toString(alert->endpoint.address())};
-    if (!ip.isEmpty())
-        Logger::instance()->addPeer(ip, true, reason);
+    if (ip.isEmpty())
+        return;
+
+    // blocked peers keep reconnecting, so the reason is formatted only for the entries being logged
+    const int reasonType = alert->reason;
+    const quint16 port = alert->endpoint.port();
+    Logger::instance()->addThrottledPeer(ip, true, QString::number(reasonType), [reasonType, port]() -> QString
+    {
+        switch (reasonType)
+        {
+        case lt::peer_blocked_alert::ip_filter:
+            return tr("IP filter", "this peer was blocked. Reason: IP filter.");
+        case lt::peer_blocked_alert::port_filter:
+            return tr("filtered port (%1)", "this peer was blocked. Reason: filtered port (8899).").arg(QString::number(port));
+        case lt::peer_blocked_alert::i2p_mixed:
+            return tr("%1 mixed mode restrictions", "this peer was blocked. Reason: I2P mixed mode restrictions.").arg(u"I2P"_s); // don't translate I2P
+        case lt::peer_blocked_alert::privileged_ports:
+            return tr("privileged port (%1)", "this peer was blocked. Reason: privileged port (80).").arg(QString::number(port));
+        case lt::peer_blocked_alert::utp_disabled:
+            return tr("%1 is disabled", "this peer was blocked. Reason: uTP is disabled.").arg(C_UTP); // don't translate μTP
+        case lt::peer_blocked_alert::tcp_disabled:
+            return tr("%1 is disabled", "this peer was blocked. Reason: TCP is disabled.").arg(u"TCP"_s); // don't translate TCP
+        default:
+            return {};
+        }
+    });
 }
 
 void SessionImpl::handlePeerBanAlert(const lt::peer_ban_alert *alert)
 {
     const QString ip {toString(alert->endpoint.address())};
     if (!ip.isEmpty())
-        Logger::instance()->addPeer(ip, false);
+        Logger::instance()->addThrottledPeer(ip, false, {}, [] { return QString(); });
 }
 
 void SessionImpl::handleUrlSeedAlert(const lt::url_seed_alert *alert)
@@ -6146,17 +8591,24 @@ void SessionImpl::handleUrlSeedAlert(const lt::url_seed_alert *alert)
     if (!torrent)
         return;
 
+    // failing URL seeds are retried all the time, the repeats are collapsed by torrent and URL
+    const QString url = QString::fromUtf8(alert->server_url());
+    const QString key = torrent->id().toString() + u' ' + url;
     if (alert->error)
     {
-        LogMsg(tr("URL seed DNS lookup failed. Torrent: \"%1\". URL: \"%2\". Error: \"%3\"")
-            .arg(torrent->name(), QString::fromUtf8(alert->server_url()), QString::fromStdString(alert->message()))
-            , Log::WARNING);
+        LogThrottledMsg(u"URLSeedError"_s, key, [name = torrent->name(), url, message = alert->message()]
+        {
+            return tr("URL seed DNS lookup failed. Torrent: \"%1\". URL: \"%2\". Error: \"%3\"")
+                .arg(name, url, QString::fromStdString(message));
+        }, Log::WARNING);
     }
     else
     {
-        LogMsg(tr("Received error message from URL seed. Torrent: \"%1\". URL: \"%2\". Message: \"%3\"")
-            .arg(torrent->name(), QString::fromUtf8(alert->server_url()), QString::fromUtf8(alert->error_message()))
-            , Log::WARNING);
+        LogThrottledMsg(u"URLSeedMessage"_s, key, [name = torrent->name(), url, message = std::string(alert->error_message())]
+        {
+            return tr("Received error message from URL seed. Torrent: \"%1\". URL: \"%2\". Message: \"%3\"")
+                .arg(name, url, QString::fromStdString(message));
+        }, Log::WARNING);
     }
 }
 
@@ -6209,6 +8661,7 @@ void SessionImpl::handleSessionStatsAlert(const lt::session_stats_alert *alert)
     m_statsLastTimestamp = alert->timestamp();
 
     const auto stats = alert->counters();
+    m_sessionStats.assign(stats.begin(), stats.end());
 
     m_status.hasIncomingConnections = static_cast<bool>(stats[m_metricIndices.net.hasIncomingConnections]);
 
@@ -6256,18 +8709,23 @@ void SessionImpl::handleSessionStatsAlert(const lt::session_stats_alert *alert)
     m_status.diskWriteQueue = stats[m_metricIndices.peer.numPeersDownDisk];
     m_status.peersCount = stats[m_metricIndices.peer.numPeersConnected];
 
+    TransferTotals transferred;
     if (totalDownload > m_status.totalDownload)
     {
+        transferred.downloaded = totalDownload - m_status.totalDownload;
         m_status.totalDownload = totalDownload;
         m_isStatisticsDirty = true;
     }
 
     if (totalUpload > m_status.totalUpload)
     {
+        transferred.uploaded = totalUpload - m_status.totalUpload;
         m_status.totalUpload = totalUpload;
         m_isStatisticsDirty = true;
     }
 
+    m_transferStatistics.addSessionTransfer(QDate::currentDate(), transferred);
+
     m_status.allTimeDownload = m_previouslyDownloaded + m_status.totalDownload;
     m_status.allTimeUpload = m_previouslyUploaded + m_status.totalUpload;
 
@@ -6277,7 +8735,12 @@ void SessionImpl::handleSessionStatsAlert(const lt::session_stats_alert *alert)
     m_cacheStatus.totalUsedBuffers = stats[m_metricIndices.disk.diskBlocksInUse];
     m_cacheStatus.jobQueueLength = stats[m_metricIndices.disk.queuedDiskJobs];
 
-#ifndef QBT_USES_LIBTORRENT2
+#ifdef QBT_USES_LIBTORRENT2
+    // only blocks cached by custom disk I/O, libtorrent 2.0 relies on OS cache otherwise
+    const ReadCacheStatistics readCache = DiskIOStatisticsCollector::instance()->readCacheStatistics();
+    m_cacheStatus.readRatio = static_cast<qreal>(readCache.hits) / std::max<qint64>((readCache.hits + readCache.misses), 1);
+    m_cacheStatus.readCacheSize = readCache.size;
+#else
     const int64_t numBlocksRead = stats[m_metricIndices.disk.numBlocksRead];
     const int64_t numBlocksCacheHits = stats[m_metricIndices.disk.numBlocksCacheHits];
     m_cacheStatus.readRatio = static_cast<qreal>(numBlocksCacheHits) / std::max<int64_t>((numBlocksCacheHits + numBlocksRead), 1);
@@ -6299,38 +8762,38 @@ void SessionImpl::handleAlertsDroppedAlert(const lt::alerts_dropped_alert *alert
 
 void SessionImpl::handleStorageMovedAlert(const lt::storage_moved_alert *alert)
 {
-    Q_ASSERT(!m_moveStorageQueue.isEmpty());
-
-    const MoveStorageJob &currentJob = m_moveStorageQueue.first();
-    Q_ASSERT(currentJob.torrentHandle == alert->handle);
-
     const Path newPath {QString::fromUtf8(alert->storage_path())};
-    Q_ASSERT(newPath == currentJob.path);
 
 #ifdef QBT_USES_LIBTORRENT2
-    const auto id = TorrentID::fromInfoHash(currentJob.torrentHandle.info_hashes());
+    const auto id = TorrentID::fromInfoHash(alert->handle.info_hashes());
 #else
-    const auto id = TorrentID::fromInfoHash(currentJob.torrentHandle.info_hash());
+    const auto id = TorrentID::fromInfoHash(alert->handle.info_hash());
 #endif
 
     TorrentImpl *torrent = m_torrents.value(id);
     const QString torrentName = (torrent ? torrent->name() : id.toString());
     LogMsg(tr("Moved torrent successfully. Torrent: \"%1\". Destination: \"%2\"").arg(torrentName, newPath.toString()));
 
-    handleMoveTorrentStorageJobFinished(newPath);
+    handleMoveTorrentStorageJobFinished(alert->handle, newPath);
 }
 
 void SessionImpl::handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert *alert)
 {
-    Q_ASSERT(!m_moveStorageQueue.isEmpty());
+    const auto currentJobIter = std::find_if(m_moveStorageQueue.cbegin(), m_moveStorageQueue.cend()
+            , [alert](const MoveStorageJob &job)
+    {
+        return job.isActive && (job.torrentHandle == alert->handle);
+    });
+    Q_ASSERT(currentJobIter != m_moveStorageQueue.cend());
+    if (currentJobIter == m_moveStorageQueue.cend())
+        return;
 
-    const MoveStorageJob &currentJob = m_moveStorageQueue.first();
-    Q_ASSERT(currentJob.torrentHandle == alert->handle);
+    const Path destinationPath = currentJobIter->path;
 
 #ifdef QBT_USES_LIBTORRENT2
-    const auto id = TorrentID::fromInfoHash(currentJob.torrentHandle.info_hashes());
+    const auto id = TorrentID::fromInfoHash(alert->handle.info_hashes());
 #else
-    const auto id = TorrentID::fromInfoHash(currentJob.torrentHandle.info_hash());
+    const auto id = TorrentID::fromInfoHash(alert->handle.info_hash());
 #endif
 
     TorrentImpl *torrent = m_torrents.value(id);
@@ -6339,15 +8802,22 @@ void SessionImpl::handleStorageMovedFailedAlert(const lt::storage_moved_failed_a
             : Path(alert->handle.status(lt::torrent_handle::query_save_path).save_path));
     const QString errorMessage = QString::fromStdString(alert->message());
     LogMsg(tr("Failed to move torrent. Torrent: \"%1\". Source: \"%2\". Destination: \"%3\". Reason: \"%4\"")
-           .arg(torrentName, currentLocation.toString(), currentJob.path.toString(), errorMessage), Log::WARNING);
+           .arg(torrentName, currentLocation.toString(), destinationPath.toString(), errorMessage), Log::WARNING);
 
-    handleMoveTorrentStorageJobFinished(currentLocation);
+    handleMoveTorrentStorageJobFinished(alert->handle, currentLocation);
 }
 
 void SessionImpl::handleStateUpdateAlert(const lt::state_update_alert *alert)
 {
+    QBT_TRACE_SCOPE("SessionImpl::handleStateUpdateAlert");
+
+    QElapsedTimer refreshTimer;
+    refreshTimer.start();
+
     QVector<Torrent *> updatedTorrents;
     updatedTorrents.reserve(static_cast<decltype(updatedTorrents)::size_type>(alert->status.size()));
+    QVector<TorrentStatusFields> changedFields;
+    changedFields.reserve(updatedTorrents.capacity());
 
     for (const lt::torrent_status &status : alert->status)
     {
@@ -6360,22 +8830,85 @@ void SessionImpl::handleStateUpdateAlert(const lt::state_update_alert *alert)
         if (!torrent)
             continue;
 
-        torrent->handleStateUpdate(status);
+        const TorrentStatusFields torrentChangedFields = torrent->handleStateUpdate(status, m_postedStatusFlags);
+        if (torrentChangedFields)
+            scheduleShareLimitsCheck(torrent);
+
+        m_transferStatistics.updateTorrent(id, torrent->category(), QUrl(torrent->currentTracker()).host()
+                , {.downloaded = torrent->totalDownload(), .uploaded = torrent->totalUpload()});
+
+        changedFields.push_back(torrentChangedFields);
         updatedTorrents.push_back(torrent);
     }
 
     if (!updatedTorrents.isEmpty())
-        emit torrentsUpdated(updatedTorrents);
+        emit torrentsUpdated(updatedTorrents, changedFields);
 
     if (m_needSaveTorrentsQueue)
         saveTorrentsQueue();
 
+    updateTrackerEntryStatuses();
+    updateCategoryBandwidthShares();
+    rebalanceConnections();
+    updateMetadataDownloads();
+    if (isAutoBanFakeProgressPeerEnabled())
+        analyzeSwarms(updatedTorrents);
+
+    m_metrics.refresh.add(refreshTimer.nsecsElapsed());
+
     if (m_refreshEnqueued)
         m_refreshEnqueued = false;
     else
         enqueueRefresh();
 }
 
+// Peers are analyzed once per refresh using the peer stats collected by the torrent extension,
+// only torrents we are uploading to are considered
+void SessionImpl::analyzeSwarms(const QVector<Torrent *> &torrents)
+{
+    m_fakeProgressDetector.setOptions({.minUploaded = (static_cast<qint64>(fakeProgressPeerMinUpload()) * 1024 * 1024)
+            , .minProgressRatio = (fakeProgressPeerMinProgress() / 100.0)});
+
+    for (Torrent *torrent : torrents)
+    {
+        // peer policies don't apply to private torrents
+        if (!torrent->hasMetadata() || torrent->isPrivate() || (torrent->uploadPayloadRate() <= 0))
+            continue;
+
+        analyzeSwarm(static_cast<TorrentImpl *>(torrent));
+    }
+}
+
+void SessionImpl::analyzeSwarm(TorrentImpl *torrent)
+{
+    const std::shared_ptr<const PeerStatsSnapshot> peerStats = torrent->peerStats();
+    const int piecesCount = torrent->piecesCount();
+    if (piecesCount <= 0)
+        return;
+
+    QList<FakeProgressDetector::PeerSample> samples;
+    samples.reserve(static_cast<qsizetype>(peerStats->peers.size()));
+    for (const PeerStats &peer : peerStats->peers)
+    {
+        if (peer.isSeed)
+            continue;
+
+        const qreal progress = std::min(1.0, (static_cast<qreal>(peer.piecesCount) / piecesCount));
+        samples.append({.ip = QHostAddress(peer.endpoint.data()).toString(), .progress = progress, .uploaded = peer.uploadedPayload});
+    }
+
+    const QStringList detectedIPs = m_fakeProgressDetector.analyze(torrent->id(), torrent->totalSize(), torrent->pieceLength(), samples);
+    for (const QString &ip : detectedIPs)
+    {
+        LogMsg(tr("Banned peer taking upload without making progress. Torrent: \"%1\". IP: \"%2\"")
+                .arg(torrent->name(), ip), Log::WARNING);
+        if (isShadowBanEnabled())
+            shadowbanIP(ip, FAKE_PROGRESS_PEER_BAN_DURATION);
+        else
+            banIP(ip, FAKE_PROGRESS_PEER_BAN_DURATION);
+    }
+}
+
 void SessionImpl::handleSocks5Alert(const lt::socks5_alert *alert) const
 {
     if (alert->error)
@@ -6398,21 +8931,47 @@ void SessionImpl::handleI2PAlert(const lt::i2p_alert *alert) const
     }
 }
 
+// Called from alerts thread, so it must not access main thread data.
+// Collected statuses are delivered on refresh by updateTrackerEntryStatuses(),
+// statuses of unknown torrents are dropped there.
 void SessionImpl::handleTrackerAlert(const lt::tracker_alert *alert)
 {
-    TorrentImpl *torrent = m_torrents.value(alert->handle.info_hash());
-    if (!torrent)
-        return;
-
     [[maybe_unused]] const QMutexLocker updatedTrackerStatusesLocker {&m_updatedTrackerStatusesMutex};
 
-    const auto prevSize = m_updatedTrackerStatuses.size();
-    QMap<int, int> &updateInfo = m_updatedTrackerStatuses[torrent->nativeHandle()][std::string(alert->tracker_url())][alert->local_endpoint];
-    if (prevSize < m_updatedTrackerStatuses.size())
-        updateTrackerEntryStatuses(torrent->nativeHandle());
+    const std::string trackerURL {alert->tracker_url()};
+    QMap<int, int> &updateInfo = m_updatedTrackerStatuses[alert->handle][trackerURL][alert->local_endpoint];
+
+    const auto takeAnnounceLatency = [this, alert, &trackerURL]() -> std::optional<std::chrono::milliseconds>
+    {
+        const auto handleIter = m_trackerAnnounceTimes.find(alert->handle);
+        if (handleIter == m_trackerAnnounceTimes.end())
+            return std::nullopt;
+
+        const auto timeIter = handleIter->constFind(trackerURL);
+        if (timeIter == handleIter->cend())
+            return std::nullopt;
+
+        const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(alert->timestamp() - *timeIter);
+        handleIter->erase(timeIter);
+        if (handleIter->isEmpty())
+            m_trackerAnnounceTimes.erase(handleIter);
+        return latency;
+    };
 
-    if (alert->type() == lt::tracker_reply_alert::alert_type)
+    if (alert->type() == lt::tracker_announce_alert::alert_type)
+    {
+        m_trackerAnnounceTimes[alert->handle][trackerURL] = alert->timestamp();
+    }
+    else if (alert->type() == lt::tracker_error_alert::alert_type)
+    {
+        takeAnnounceLatency();
+        m_trackerHealthRegistry.addFailure(TrackerHealthRegistry::trackerHost(QString::fromStdString(trackerURL)));
+    }
+    else if (alert->type() == lt::tracker_reply_alert::alert_type)
     {
+        const std::chrono::milliseconds latency = takeAnnounceLatency().value_or(std::chrono::milliseconds::zero());
+        m_trackerHealthRegistry.addSuccess(TrackerHealthRegistry::trackerHost(QString::fromStdString(trackerURL)), latency);
+
         const int numPeers = static_cast<const lt::tracker_reply_alert *>(alert)->num_peers;
 #ifdef QBT_USES_LIBTORRENT2
         const int protocolVersionNum = (static_cast<const lt::tracker_reply_alert *>(alert)->version == lt::protocol_version::V1) ? 1 : 2;
@@ -6471,54 +9030,304 @@ void SessionImpl::handleTorrentConflictAlert(const lt::torrent_conflict_alert *a
 }
 #endif
 
-void SessionImpl::saveStatistics() const
+void SessionImpl::saveStatistics()
 {
-    if (!m_isStatisticsDirty)
+    if (!m_isStatisticsDirty && !m_transferStatistics.hasPending())
         return;
 
-    const QVariantHash stats {
-        {u"AlltimeDL"_s, m_status.allTimeDownload},
-        {u"AlltimeUL"_s, m_status.allTimeUpload}};
-    std::unique_ptr<QSettings> settings = Profile::instance()->applicationSettings(u"qBittorrent-data"_s);
-    settings->setValue(u"Stats/AllStats"_s, stats);
+    if (m_statisticsStorage)
+    {
+        m_statisticsStorage->store(m_transferStatistics.takePending());
+    }
+    else
+    {
+        // keep the all-time totals in settings if the database can't be used
+        const QVariantHash stats {
+            {u"AlltimeDL"_s, m_status.allTimeDownload},
+            {u"AlltimeUL"_s, m_status.allTimeUpload}};
+        std::unique_ptr<QSettings> settings = Profile::instance()->applicationSettings(u"qBittorrent-data"_s);
+        settings->setValue(u"Stats/AllStats"_s, stats);
+        m_transferStatistics.takePending();
+    }
 
     m_statisticsLastUpdateTimer.start();
     m_isStatisticsDirty = false;
 }
 
+// Only DHT state (routing table nodes and node ID) is kept, the settings are always applied from preferences
+void SessionImpl::saveSessionState() const
+{
+#ifdef QBT_USES_LIBTORRENT2
+    const std::vector<char> buffer = lt::write_session_params_buf(m_nativeSession->session_state(lt::session::save_dht_state)
+            , lt::session::save_dht_state);
+    const QByteArray data {buffer.data(), static_cast<qsizetype>(buffer.size())};
+#else
+    lt::entry data;
+    m_nativeSession->save_state(data, lt::session::save_dht_state);
+#endif
+
+    const Path path = specialFolderLocation(SpecialFolder::Data) / SESSION_STATE_FILE_NAME;
+    m_asyncWorker->start([path, data]
+    {
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(path, data);
+        if (!result)
+        {
+            LogMsg(tr("Failed to save session state. File: \"%1\". Error: \"%2\"")
+                    .arg(path.toString(), result.error()), Log::WARNING);
+        }
+    });
+}
+
+void SessionImpl::loadSessionState(lt::session_params &sessionParams) const
+{
+    const Path path = specialFolderLocation(SpecialFolder::Data) / SESSION_STATE_FILE_NAME;
+    if (!path.exists())
+        return;
+
+    const int fileMaxSize = 16 * 1024 * 1024;
+    const auto readResult = Utils::IO::readFile(path, fileMaxSize);
+    if (!readResult)
+    {
+        LogMsg(tr("Failed to load session state. %1").arg(readResult.error().message), Log::WARNING);
+        return;
+    }
+
+    const QByteArray &data = readResult.value();
+    lt::error_code ec;
+    const lt::bdecode_node root = lt::bdecode(data, ec);
+    if (ec || (root.type() != lt::bdecode_node::dict_t))
+    {
+        LogMsg(tr("Failed to parse session state. File: \"%1\". Error: \"%2\"")
+                .arg(path.toString(), (ec ? QString::fromLocal8Bit(ec.message().c_str()) : tr("Invalid data format"))), Log::WARNING);
+        return;
+    }
+
+    // DHT continues with the nodes known before, rather than bootstrapping from scratch
+    sessionParams.dht_state = lt::read_session_params(root, lt::session::save_dht_state).dht_state;
+}
+
 void SessionImpl::loadStatistics()
 {
+    try
+    {
+        m_statisticsStorage = new TransferStatisticsStorage(TransferStatisticsStorage::defaultPath(), this);
+    }
+    catch (const RuntimeError &err)
+    {
+        LogMsg(tr("Failed to open transfer statistics database. Error: \"%1\"").arg(err.message()), Log::WARNING);
+    }
+
     const std::unique_ptr<QSettings> settings = Profile::instance()->applicationSettings(u"qBittorrent-data"_s);
     const QVariantHash value = settings->value(u"Stats/AllStats"_s).toHash();
+    const TransferTotals legacyTotals {
+        .downloaded = value[u"AlltimeDL"_s].toLongLong(),
+        .uploaded = value[u"AlltimeUL"_s].toLongLong()};
+
+    if (!m_statisticsStorage)
+    {
+        m_previouslyDownloaded = legacyTotals.downloaded;
+        m_previouslyUploaded = legacyTotals.uploaded;
+        return;
+    }
+
+    // the totals previously kept in settings are moved to the database once
+    TransferTotals allTime = m_statisticsStorage->loadAllTime();
+    if (!legacyTotals.isEmpty())
+    {
+        m_statisticsStorage->store({.allTime = legacyTotals});
+        allTime += legacyTotals;
+        settings->remove(u"Stats/AllStats"_s);
+    }
 
-    m_previouslyDownloaded = value[u"AlltimeDL"_s].toLongLong();
-    m_previouslyUploaded = value[u"AlltimeUL"_s].toLongLong();
+    m_previouslyDownloaded = allTime.downloaded;
+    m_previouslyUploaded = allTime.uploaded;
 }
 
-void SessionImpl::updateTrackerEntryStatuses(lt::torrent_handle torrentHandle)
+// Torrents of a category having rate limits share them in max-min fair manner according
+// to their current speeds, so the limits are rebalanced on each refresh. Limits of parent
+// categories apply to the torrents of subcategories too, each torrent is then limited by
+// the smallest of the shares it gets.
+void SessionImpl::updateCategoryBandwidthShares()
 {
-    invokeAsync([this, torrentHandle = std::move(torrentHandle)]() mutable
+    QHash<QString, std::pair<int, int>> categoryLimits;
+    for (auto it = m_categories.cbegin(); it != m_categories.cend(); ++it)
     {
-        try
+        if ((it->uploadLimit > 0) || (it->downloadLimit > 0))
+            categoryLimits.insert(it.key(), {it->uploadLimit, it->downloadLimit});
+    }
+
+    if (categoryLimits.isEmpty() && !m_hasCategoryBandwidthShares)
+        return;
+
+    QHash<QString, QList<TorrentImpl *>> categoryTorrents;
+    for (TorrentImpl *const torrent : asConst(m_torrents))
+    {
+        const QString category = torrent->category();
+        if (category.isEmpty() || torrent->isStopped())
+            continue;
+
+        const QStringList categories = isSubcategoriesEnabled() ? expandCategory(category) : QStringList {category};
+        for (const QString &name : categories)
+        {
+            if (categoryLimits.contains(name))
+                categoryTorrents[name].append(torrent);
+        }
+    }
+
+    // a little more than current speed is demanded so the torrents are able to speed up
+    const auto demand = [](const int rate) { return rate + (rate / 4) + 1024; };
+    const auto mergeShare = [](int &share, const int value) { share = (share > 0) ? std::min(share, value) : value; };
+
+    QHash<TorrentImpl *, std::pair<int, int>> shares;
+    for (auto it = categoryTorrents.cbegin(); it != categoryTorrents.cend(); ++it)
+    {
+        const QList<TorrentImpl *> &torrents = it.value();
+        const auto [uploadLimit, downloadLimit] = categoryLimits[it.key()];
+
+        QList<int> uploadDemands;
+        QList<int> downloadDemands;
+        uploadDemands.reserve(torrents.size());
+        downloadDemands.reserve(torrents.size());
+        for (const TorrentImpl *torrent : torrents)
+        {
+            uploadDemands.append(demand(torrent->uploadPayloadRate()));
+            downloadDemands.append(demand(torrent->downloadPayloadRate()));
+        }
+
+        const QList<int> uploadShares = (uploadLimit > 0) ? shareBandwidth(uploadLimit, uploadDemands) : QList<int>();
+        const QList<int> downloadShares = (downloadLimit > 0) ? shareBandwidth(downloadLimit, downloadDemands) : QList<int>();
+        for (qsizetype i = 0; i < torrents.size(); ++i)
+        {
+            std::pair<int, int> &share = shares[torrents[i]];
+            if (!uploadShares.isEmpty())
+                mergeShare(share.first, uploadShares[i]);
+            if (!downloadShares.isEmpty())
+                mergeShare(share.second, downloadShares[i]);
+        }
+    }
+
+    for (TorrentImpl *const torrent : asConst(m_torrents))
+    {
+        const std::pair<int, int> share = shares.value(torrent);
+        torrent->setBandwidthShare(share.first, share.second);
+    }
+
+    m_hasCategoryBandwidthShares = !shares.isEmpty();
+}
+
+// Fixed per-torrent limit spreads connections evenly over the torrents, so idle ones hold the slots
+// while busy swarms hit the limit. Instead, the connections of the session are periodically distributed
+// among the running torrents according to their demand: interested peers, upload rate and size of the
+// part of the swarm worth connecting to (only leechers once the torrent is finished).
+void SessionImpl::rebalanceConnections()
+{
+    const int budget = maxConnections();
+    if (!isConnectionsRebalancingEnabled() || (budget <= 0))
+    {
+        if (m_hasConnectionsBudgets)
+        {
+            for (TorrentImpl *const torrent : asConst(m_torrents))
+                torrent->setConnectionsBudget(0);
+            m_hasConnectionsBudgets = false;
+        }
+        return;
+    }
+
+    const lt::clock_type::time_point now = lt::clock_type::now();
+    if ((now - m_connectionsRebalanceTime) < CONNECTIONS_REBALANCE_INTERVAL)
+        return;
+    m_connectionsRebalanceTime = now;
+
+    QList<TorrentImpl *> torrents;
+    QList<ConnectionDemand> demands;
+    torrents.reserve(m_torrents.size());
+    demands.reserve(m_torrents.size());
+    for (TorrentImpl *const torrent : asConst(m_torrents))
+    {
+        if (torrent->isStopped() || torrent->isQueued())
+        {
+            torrent->setConnectionsBudget(0);
+            continue;
+        }
+
+        const std::shared_ptr<const PeerStatsSnapshot> peerStats = torrent->peerStats();
+        const int swarmPeers = torrent->isFinished()
+                ? torrent->totalLeechersCount()
+                : (torrent->totalSeedsCount() + torrent->totalLeechersCount());
+
+        torrents.append(torrent);
+        demands.append({.connections = torrent->connectionsCount()
+                , .budget = torrent->connectionsBudget()
+                , .interestedPeers = (peerStats ? peerStats->interestedCount : 0)
+                , .uploadRate = torrent->uploadPayloadRate()
+                , .swarmPeers = swarmPeers});
+    }
+
+    const QList<int> budgets = BitTorrent::rebalanceConnections(budget, demands);
+    for (qsizetype i = 0; i < torrents.size(); ++i)
+        torrents[i]->setConnectionsBudget(budgets[i]);
+
+    m_hasConnectionsBudgets = true;
+}
+
+// Tracker statuses collected since previous refresh are processed in single batch.
+// Only one batch is in flight at a time, statuses reported meanwhile are coalesced
+// per torrent and tracker and wait for the next refresh.
+void SessionImpl::updateTrackerEntryStatuses()
+{
+    if (m_isTrackerEntryStatusesUpdating)
+        return;
+
+    {
+        [[maybe_unused]] const QMutexLocker updatedTrackerStatusesLocker {&m_updatedTrackerStatusesMutex};
+        if (m_updatedTrackerStatuses.isEmpty())
+            return;
+    }
+
+    m_isTrackerEntryStatusesUpdating = true;
+    invokeAsync([this]
+    {
+        QMutexLocker updatedTrackerStatusesLocker {&m_updatedTrackerStatusesMutex};
+        const QHash<lt::torrent_handle, QHash<std::string, QHash<lt::tcp::endpoint, QMap<int, int>>>> updatedTrackerStatuses
+                = std::exchange(m_updatedTrackerStatuses, {});
+        updatedTrackerStatusesLocker.unlock();
+
+        struct TrackerEntryStatusesUpdate
+        {
+            lt::torrent_handle torrentHandle;
+            std::vector<lt::announce_entry> nativeTrackers;
+            QHash<std::string, QHash<lt::tcp::endpoint, QMap<int, int>>> updatedTrackers;
+        };
+
+        std::vector<TrackerEntryStatusesUpdate> updates;
+        updates.reserve(updatedTrackerStatuses.size());
+        for (auto it = updatedTrackerStatuses.cbegin(); it != updatedTrackerStatuses.cend(); ++it)
         {
-            std::vector<lt::announce_entry> nativeTrackers = torrentHandle.trackers();
+            try
+            {
+                updates.push_back({it.key(), it.key().trackers(), it.value()});
+            }
+            catch (const std::exception &)
+            {
+            }
+        }
 
-            QMutexLocker updatedTrackerStatusesLocker {&m_updatedTrackerStatusesMutex};
-            QHash<std::string, QHash<lt::tcp::endpoint, QMap<int, int>>> updatedTrackers = m_updatedTrackerStatuses.take(torrentHandle);
-            updatedTrackerStatusesLocker.unlock();
+        invoke([this, updates = std::move(updates)]
+        {
+            m_isTrackerEntryStatusesUpdating = false;
 
-            invoke([this, torrentHandle, nativeTrackers = std::move(nativeTrackers), updatedTrackers = std::move(updatedTrackers)]
+            for (const TrackerEntryStatusesUpdate &update : updates)
             {
-                TorrentImpl *torrent = m_torrents.value(torrentHandle.info_hash());
+                TorrentImpl *torrent = m_torrents.value(update.torrentHandle.info_hash());
                 if (!torrent || torrent->isStopped())
-                    return;
+                    continue;
 
                 QHash<QString, TrackerEntryStatus> trackers;
-                trackers.reserve(updatedTrackers.size());
-                for (const lt::announce_entry &announceEntry : nativeTrackers)
+                trackers.reserve(update.updatedTrackers.size());
+                for (const lt::announce_entry &announceEntry : update.nativeTrackers)
                 {
-                    const auto updatedTrackersIter = updatedTrackers.find(announceEntry.url);
-                    if (updatedTrackersIter == updatedTrackers.end())
+                    const auto updatedTrackersIter = update.updatedTrackers.find(announceEntry.url);
+                    if (updatedTrackersIter == update.updatedTrackers.end())
                         continue;
 
                     const auto &updateInfo = updatedTrackersIter.value();
@@ -6528,11 +9337,8 @@ void SessionImpl::updateTrackerEntryStatuses(lt::torrent_handle torrentHandle)
                 }
 
                 emit trackerEntryStatusesUpdated(torrent, trackers);
-            });
-        }
-        catch (const std::exception &)
-        {
-        }
+            }
+        });
     });
 }
 
@@ -6552,11 +9358,8 @@ void SessionImpl::handleRemovedTorrent(const TorrentID &torrentID, const QString
     if ((removingTorrentDataIter->removeOption == TorrentRemoveOption::RemoveContent)
             && !removingTorrentDataIter->contentStoragePath.isEmpty())
     {
-        QMetaObject::invokeMethod(m_torrentContentRemover, [this, jobData = *removingTorrentDataIter]
-        {
-            m_torrentContentRemover->performJob(jobData.name, jobData.contentStoragePath
-                    , jobData.fileNames, m_torrentContentRemoveOption);
-        });
+        m_torrentContentRemover->addJob(removingTorrentDataIter->name, removingTorrentDataIter->contentStoragePath
+                , removingTorrentDataIter->fileNames, m_torrentContentRemoveOption);
     }
 
     m_removingTorrents.erase(removingTorrentDataIter);
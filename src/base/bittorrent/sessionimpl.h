@@ -29,14 +29,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <libtorrent/fwd.hpp>
+#include <libtorrent/ip_filter.hpp>
+#include <libtorrent/peer_class.hpp>
 #include <libtorrent/portmap.hpp>
 #include <libtorrent/torrent_handle.hpp>
 
 #include <QtContainerFwd>
+#include <QByteArray>
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QHash>
@@ -44,20 +55,37 @@
 #include <QMutex>
 #include <QPointer>
 #include <QSet>
+#include <QVariantMap>
 #include <QVector>
+#include <QWaitCondition>
 
+#include "base/denseset.h"
+#include "base/memoryusage.h"
 #include "base/path.h"
 #include "base/settingvalue.h"
+#include "base/stringpool.h"
+#include "base/timerwheel.h"
 #include "base/utils/thread.h"
 #include "addtorrentparams.h"
+#include "announcescheduler.h"
 #include "cachestatus.h"
 #include "categoryoptions.h"
+#include "fakeprogressdetector.h"
+#include "filenamefilter.h"
+#include "filesearcher.h"
+#include "loadtorrentparams.h"
+#include "metadatacache.h"
+#include "peeraddress.h"
 #include "session.h"
+#include "sessionmetrics.h"
 #include "sessionstatus.h"
 #include "torrentinfo.h"
 #include "trackerentrystatus.h"
+#include "trackerhealthregistry.h"
+#include "transferstatistics.h"
 #include "base/net/downloadmanager.h"
 
+class QFileSystemWatcher;
 class QString;
 class QThread;
 class QThreadPool;
@@ -65,9 +93,9 @@ class QTimer;
 class QUrl;
 
 class BandwidthScheduler;
-class FileSearcher;
 class FilterParserThread;
 class NativeSessionExtension;
+class peer_policy;
 
 namespace BitTorrent
 {
@@ -75,12 +103,14 @@ namespace BitTorrent
     enum class MoveStorageContext;
 
     class InfoHash;
+    class IPFilterSubscriptionManager;
     class ResumeDataStorage;
     class Torrent;
     class TorrentContentRemover;
     class TorrentDescriptor;
     class TorrentImpl;
     class Tracker;
+    class TransferStatisticsStorage;
 
     struct LoadTorrentParams;
     struct TrackerEntry;
@@ -153,6 +183,7 @@ namespace BitTorrent
         bool addCategory(const QString &name, const CategoryOptions &options = {}) override;
         bool editCategory(const QString &name, const CategoryOptions &options) override;
         bool removeCategory(const QString &name) override;
+        bool setTorrentsCategory(const QVector<TorrentID> &ids, const QString &category) override;
         bool isSubcategoriesEnabled() const override;
         void setSubcategoriesEnabled(bool value) override;
         bool useCategoryPathsInManualMode() const override;
@@ -165,6 +196,8 @@ namespace BitTorrent
         bool hasTag(const Tag &tag) const override;
         bool addTag(const Tag &tag) override;
         bool removeTag(const Tag &tag) override;
+        qsizetype addTorrentsTag(const QVector<TorrentID> &ids, const Tag &tag) override;
+        qsizetype removeTorrentsTag(const QVector<TorrentID> &ids, const Tag &tag) override;
 
         bool isAutoTMMDisabledByDefault() const override;
         void setAutoTMMDisabledByDefault(bool value) override;
@@ -284,6 +317,12 @@ namespace BitTorrent
         void setIPFilteringEnabled(bool enabled) override;
         Path IPFilterFile() const override;
         void setIPFilterFile(const Path &path) override;
+        QStringList IPFilterSubscriptions() const override;
+        void setIPFilterSubscriptions(const QStringList &urls) override;
+        int IPFilterSubscriptionsRefreshInterval() const override;
+        void setIPFilterSubscriptionsRefreshInterval(int hours) override;
+        QStringList blockedCountries() const override;
+        void setBlockedCountries(const QStringList &countryCodes) override;
         bool announceToAllTrackers() const override;
         void setAnnounceToAllTrackers(bool val) override;
         bool announceToAllTiers() const override;
@@ -294,6 +333,8 @@ namespace BitTorrent
         void setPeerTurnoverCutoff(int val) override;
         int peerTurnoverInterval() const override;
         void setPeerTurnoverInterval(int val) override;
+        bool isConnectionsRebalancingEnabled() const override;
+        void setConnectionsRebalancingEnabled(bool enabled) override;
         int requestQueueSize() const override;
         void setRequestQueueSize(int val) override;
         int asyncIOThreads() const override;
@@ -312,6 +353,12 @@ namespace BitTorrent
         void setDiskQueueSize(qint64 size) override;
         DiskIOType diskIOType() const override;
         void setDiskIOType(DiskIOType type) override;
+        int diskIOJobsPerDevice() const override;
+        void setDiskIOJobsPerDevice(int value) override;
+        int diskIOReadsPerHashJob() const override;
+        void setDiskIOReadsPerHashJob(int value) override;
+        int diskReadCacheSize() const override;
+        void setDiskReadCacheSize(int size) override;
         DiskIOReadMode diskIOReadMode() const override;
         void setDiskIOReadMode(DiskIOReadMode mode) override;
         DiskIOWriteMode diskIOWriteMode() const override;
@@ -366,7 +413,11 @@ namespace BitTorrent
         void setMaxConcurrentHTTPAnnounces(int value) override;
         bool isReannounceWhenAddressChangedEnabled() const override;
         void setReannounceWhenAddressChangedEnabled(bool enabled) override;
-        void reannounceToAllTrackers() const override;
+        void reannounceToAllTrackers() override;
+        int announceRampRate() const override;
+        void setAnnounceRampRate(int value) override;
+        int announceJitter() const override;
+        void setAnnounceJitter(int value) override;
         int stopTrackerTimeout() const override;
         void setStopTrackerTimeout(int value) override;
         int maxConnections() const override;
@@ -410,12 +461,31 @@ namespace BitTorrent
         void setBannedIPs(const QStringList &newList) override;
         ResumeDataStorageType resumeDataStorageType() const override;
         void setResumeDataStorageType(ResumeDataStorageType type) override;
+        bool isResumeDataStorageSharded() const override;
+        void setResumeDataStorageSharded(bool sharded) override;
+        bool isDeferredStoppedTorrentsLoadingEnabled() const override;
+        void setDeferredStoppedTorrentsLoadingEnabled(bool enabled) override;
+        bool isTrustedResumeDataEnabled() const override;
+        void setTrustedResumeDataEnabled(bool enabled) override;
+        int resumeDataStorageBatchSize() const override;
+        void setResumeDataStorageBatchSize(int size) override;
+        int resumeDataStorageBatchLatency() const override;
+        void setResumeDataStorageBatchLatency(int latency) override;
         bool isMergeTrackersEnabled() const override;
         void setMergeTrackersEnabled(bool enabled) override;
         bool isStartPaused() const override;
         void setStartPaused(bool value) override;
         TorrentContentRemoveOption torrentContentRemoveOption() const override;
         void setTorrentContentRemoveOption(TorrentContentRemoveOption option) override;
+        int maxActiveMoveStorageJobsPerDevice() const override;
+        void setMaxActiveMoveStorageJobsPerDevice(int value) override;
+        QList<MoveStorageJobInfo> moveStorageJobs() const override;
+        int maxActiveCheckingTorrentsPerDevice() const override;
+        void setMaxActiveCheckingTorrentsPerDevice(int value) override;
+        int maxActiveMetadataDownloads() const override;
+        void setMaxActiveMetadataDownloads(int value) override;
+        int metadataDownloadTimeout() const override;
+        void setMetadataDownloadTimeout(int value) override;
 
         bool isRestored() const override;
 
@@ -426,17 +496,24 @@ namespace BitTorrent
         Torrent *getTorrent(const TorrentID &id) const override;
         Torrent *findTorrent(const InfoHash &infoHash) const override;
         QVector<Torrent *> torrents() const override;
+        std::span<Torrent *const> torrentsView() const override;
+        quint64 torrentsGeneration() const override;
         qsizetype torrentsCount() const override;
         const SessionStatus &status() const override;
         const CacheStatus &cacheStatus() const override;
+        SessionMetrics metrics() const override;
         bool isListening() const override;
+        void demandRefresh() override;
 
-        void banIP(const QString &ip) override;
-        void shadowbanIP(const QString &ip) override;
+        void banIP(const QString &ip, std::chrono::seconds duration = {}) override;
+        void shadowbanIP(const QString &ip, std::chrono::seconds duration = {}) override;
+        QHash<TorrentID, int> connectPeers(const QList<TorrentID> &torrentIDs, const QList<PeerAddress> &peers) override;
 
         bool isKnownTorrent(const InfoHash &infoHash) const override;
         bool addTorrent(const TorrentDescriptor &torrentDescr, const AddTorrentParams &params = {}) override;
+        qsizetype addTorrents(const QList<TorrentDescriptor> &torrentDescrs, const AddTorrentParams &params = {}) override;
         bool removeTorrent(const TorrentID &id, TorrentRemoveOption deleteOption = TorrentRemoveOption::KeepContent) override;
+        qsizetype removeTorrents(const QVector<TorrentID> &ids, TorrentRemoveOption deleteOption = TorrentRemoveOption::KeepContent) override;
         bool downloadMetadata(const TorrentDescriptor &torrentDescr) override;
         bool cancelDownloadMetadata(const TorrentID &id) override;
 
@@ -453,15 +530,23 @@ namespace BitTorrent
         void handleTorrentCategoryChanged(TorrentImpl *torrent, const QString &oldCategory);
         void handleTorrentTagAdded(TorrentImpl *torrent, const Tag &tag);
         void handleTorrentTagRemoved(TorrentImpl *torrent, const Tag &tag);
+        // Tags are interned into indexes that stay the same for the session lifetime, returns -1 for unknown tag
+        int tagIndex(const Tag &tag) const;
+        int internTag(const Tag &tag);
         void handleTorrentSavingModeChanged(TorrentImpl *torrent);
         void handleTorrentMetadataReceived(TorrentImpl *torrent);
         void handleTorrentStopped(TorrentImpl *torrent);
         void handleTorrentStarted(TorrentImpl *torrent);
         void handleTorrentChecked(TorrentImpl *torrent);
+        void handleTorrentCheckingQueued(TorrentImpl *torrent);
         void handleTorrentFinished(TorrentImpl *torrent);
+        void handleTorrentPieceRead(TorrentImpl *torrent, int pieceIndex, const QByteArray &data);
         void handleTorrentTrackersAdded(TorrentImpl *torrent, const QVector<TrackerEntry> &newTrackers);
         void handleTorrentTrackersRemoved(TorrentImpl *torrent, const QStringList &deletedTrackers);
         void handleTorrentTrackersChanged(TorrentImpl *torrent);
+        void handleTorrentReannounceRequested(TorrentImpl *torrent, int trackerIndex);
+        // tracker URLs of all the torrents share the same strings
+        QString internTrackerURL(const QString &url);
         void handleTorrentUrlSeedsAdded(TorrentImpl *torrent, const QVector<QUrl> &newUrlSeeds);
         void handleTorrentUrlSeedsRemoved(TorrentImpl *torrent, const QVector<QUrl> &urlSeeds);
         void handleTorrentResumeDataReady(TorrentImpl *torrent, const LoadTorrentParams &data);
@@ -471,12 +556,14 @@ namespace BitTorrent
         bool addMoveTorrentStorageJob(TorrentImpl *torrent, const Path &newPath, MoveStorageMode mode, MoveStorageContext context);
 
         void findIncompleteFiles(const TorrentInfo &torrentInfo, const Path &savePath
-                                 , const Path &downloadPath, const PathList &filePaths = {}) const;
+                                 , const Path &downloadPath, const PathList &filePaths = {});
+        void findIncompleteFiles(const QList<FileSearchRequest> &requests);
+        void submitFileSearchRequests();
 
         void enablePortMapping();
         void disablePortMapping();
-        void addMappedPorts(const QSet<quint16> &ports);
-        void removeMappedPorts(const QSet<quint16> &ports);
+        // only the difference between the currently mapped ports and the given ones is applied
+        void setMappedPorts(const QSet<quint16> &ports);
 
         QDateTime fromLTTimePoint32(const lt::time_point32 &timePoint) const;
 
@@ -495,6 +582,14 @@ namespace BitTorrent
         // Auto ban Bittorrent Media Player Peer
         bool isAutoBanBTPlayerPeerEnabled() const override;
         void setAutoBanBTPlayerPeer(bool value) override;
+        bool isAutoBanFakeProgressPeerEnabled() const override;
+        void setAutoBanFakeProgressPeer(bool value) override;
+        int fakeProgressPeerMinUpload() const override;
+        void setFakeProgressPeerMinUpload(int value) override;
+        int fakeProgressPeerMinProgress() const override;
+        void setFakeProgressPeerMinProgress(int value) override;
+        int bannedPeersHistoryDays() const override;
+        void setBannedPeersHistoryDays(int days) override;
 
         // Shadowban Peers
         bool isShadowBanEnabled() const override;
@@ -508,6 +603,8 @@ namespace BitTorrent
         QString publicTrackers() const override;
         void setPublicTrackers(const QString &trackers) override;
         void updatePublicTracker() override;
+        int maxPublicTrackersPerTorrent() const override;
+        void setMaxPublicTrackersPerTorrent(int value) override;
 
     signals:
         void addTorrentAlertsReceived(qsizetype count);
@@ -516,9 +613,12 @@ namespace BitTorrent
         void configureDeferred();
         void readAlerts();
         void enqueueRefresh();
+        void postRefresh();
         void generateResumeData();
         void handleIPFilterParsed(int ruleCount);
         void handleIPFilterError();
+        void handleIPFilterSubscriptionsChanged();
+        void updateBlockedCountryRanges();
         void fileSearchFinished(const TorrentID &id, const Path &savePath, const PathList &fileNames);
         void torrentContentRemovingFinished(const QString &torrentName, const QString &errorMessage);
 
@@ -534,6 +634,30 @@ namespace BitTorrent
             Path path;
             MoveStorageMode mode {};
             MoveStorageContext context {};
+            Path sourcePath;
+            // jobs are limited per pair of source and destination devices
+            std::pair<QByteArray, QByteArray> devices;
+            bool isActive = false;
+        };
+
+        // Torrents relocated at once because paths of their categories changed,
+        // they are enqueued together and their progress is reported as a whole
+        struct RelocationBatch
+        {
+            QString name;
+            std::unordered_set<lt::torrent_handle> pendingTorrents;
+            int torrentsCount = 0;
+            int failedCount = 0;
+            int reportedPercentage = 0;
+        };
+
+        struct CheckingJob
+        {
+            TorrentID torrentID;
+            // checks are limited per device of torrent storage
+            QByteArray device;
+            qint64 size = 0;
+            bool isActive = false;
         };
 
         struct RemovingTorrentData
@@ -547,9 +671,6 @@ namespace BitTorrent
         explicit SessionImpl(QObject *parent = nullptr);
         ~SessionImpl();
 
-        bool hasPerTorrentRatioLimit() const;
-        bool hasPerTorrentSeedingTimeLimit() const;
-        bool hasPerTorrentInactiveSeedingTimeLimit() const;
 
         // Session configuration
         Q_INVOKABLE void configure();
@@ -558,9 +679,24 @@ namespace BitTorrent
         lt::settings_pack loadLTSettings() const;
         void applyNetworkInterfacesSettings(lt::settings_pack &settingsPack) const;
         void configurePeerClasses();
+        void publishShadowBannedIPs(const QStringList &ips);
         void initMetrics();
+        QList<MemoryUsage::Entry> estimateMemoryUsage() const;
         void applyBandwidthLimits();
+        int scheduledSpeedLimit(int limit) const;
+        void setScheduledBandwidthPercent(int percent);
+        void initCountryFiltering();
+        void processBlockedCountries(lt::ip_filter &filter) const;
         void processBannedIPs(lt::ip_filter &filter);
+        void applyIPFilter(lt::ip_filter filter);
+        void applyParsedIPFilter();
+        void applyPendingBannedIPs();
+        void processPeerConnectQueue();
+        void loadBanExpirations();
+        void updateBanExpiration(const QString &ip, std::chrono::seconds duration, bool isShadowBan, bool isBanned);
+        void processBanExpirations();
+        void watchPeerFilters();
+        void reloadPeerFilters();
         QStringList getListeningIPs() const;
         void configureListeningInterface();
         void enableTracker(bool enable);
@@ -569,22 +705,55 @@ namespace BitTorrent
         void enableIPFilter();
         void disableIPFilter();
         void processTorrentShareLimits(TorrentImpl *torrent);
-        void populateExcludedFileNamesRegExpList();
+        // returns delay in seconds after which share limits of torrent have to be checked again,
+        // nothing if none of the limits can be reached until its state changes
+        std::optional<qlonglong> shareLimitsCheckDelay(const TorrentImpl *torrent) const;
+        void scheduleShareLimitsCheck(TorrentImpl *torrent);
+        void rescheduleShareLimitsChecks();
+        void processDueShareLimitsChecks();
+        void startSeedingLimitTimer();
+        void populateExcludedFileNamesFilter();
         void prepareStartup();
         void handleLoadedResumeData(ResumeSessionContext *context);
         void processNextResumeData(ResumeSessionContext *context);
+        void storeMigratedResumeData(ResumeSessionContext *context);
         void endStartup(ResumeSessionContext *context);
+        void handleDeferredResumeData(ResumeSessionContext *context);
+        bool isCleanShutdownPath(ResumeSessionContext *context, const Path &path) const;
+        void writeCleanShutdownMarkers(const QSet<Path> &paths) const;
+        void verifyTrustedResumeData();
+        void handleTrustedResumeDataVerified(const QHash<TorrentID, Path> &failedTorrents);
+
+        // returns torrents which are in queue, sorted by queue position
+        QVector<TorrentImpl *> queuedTorrents() const;
+        void applyTorrentsQueue(const QVector<TorrentImpl *> &currentQueue, const QVector<TorrentImpl *> &newQueue);
+
+        // Torrents added together share the options resolved from their parameters
+        // and are submitted to libtorrent (or to file searcher) in one go
+        struct AddTorrentsBatch
+        {
+            // initialized when the first torrent of the batch is actually added
+            std::optional<LoadTorrentParams> loadTorrentParams;
+            Path actualSavePath;
+            Path actualDownloadPath;
+            QList<FileSearchRequest> fileSearchRequests;
+            QVector<TorrentID> readyTorrentIDs;
+        };
 
         LoadTorrentParams initLoadTorrentParams(const AddTorrentParams &addTorrentParams);
-        bool addTorrent_impl(const TorrentDescriptor &source, const AddTorrentParams &addTorrentParams);
+        bool addTorrent_impl(const TorrentDescriptor &source, const AddTorrentParams &addTorrentParams, AddTorrentsBatch &batch);
+        void submitAddTorrentsBatch(const AddTorrentsBatch &batch);
+        void storePendingResumeData();
 
-        void updateSeedingLimitTimer();
         void exportTorrentFile(const Torrent *torrent, const Path &folderPath);
+        void removeTorrentFromSession(TorrentImpl *torrent, TorrentRemoveOption deleteOption);
+        void storeMetadata(const TorrentInfo &metadata);
 
         void handleAlert(const lt::alert *alert);
         void dispatchTorrentAlert(const lt::torrent_alert *alert);
         void handleAddTorrentAlert(const lt::add_torrent_alert *alert);
         void handleStateUpdateAlert(const lt::state_update_alert *alert);
+        bool isRefreshDemanded() const;
         void handleMetadataReceivedAlert(const lt::metadata_received_alert *alert);
         void handleFileErrorAlert(const lt::file_error_alert *alert);
         void handleTorrentRemovedAlert(const lt::torrent_removed_alert *alert);
@@ -607,6 +776,10 @@ namespace BitTorrent
         void handleSocks5Alert(const lt::socks5_alert *alert) const;
         void handleI2PAlert(const lt::i2p_alert *alert) const;
         void handleTrackerAlert(const lt::tracker_alert *alert);
+        bool handleAlertInBackground(const lt::alert *alert);
+        void startAlertsThread();
+        void stopAlertsThread();
+        void runAlertsThread();
 #ifdef QBT_USES_LIBTORRENT2
         void handleTorrentConflictAlert(const lt::torrent_conflict_alert *alert);
 #endif
@@ -618,22 +791,43 @@ namespace BitTorrent
         void removeTorrentsQueue();
 
         void populatePublicTrackers();
+        void rankPublicTrackers();
+        void removeFailingPublicTrackers();
+        void scheduleTrackerURLPoolPurge();
+        void applyPublicTrackersUpdate();
+        void scheduleReannounce(TorrentImpl *torrent, int trackerIndex, lt::reannounce_flags_t flags, int maxJitter);
 
         std::vector<lt::alert *> getPendingAlerts(lt::time_duration time = lt::time_duration::zero()) const;
 
         void moveTorrentStorage(const MoveStorageJob &job) const;
-        void handleMoveTorrentStorageJobFinished(const Path &newPath);
+        void handleMoveTorrentStorageJobFinished(const lt::torrent_handle &torrentHandle, const Path &newPath);
+        void startQueuedMoveStorageJobs();
+        void relocateTorrents(const QVector<TorrentImpl *> &torrents, const QString &batchName);
+        void handleRelocationFinished(const lt::torrent_handle &torrentHandle, bool isFailed);
+        QByteArray storageDeviceID(const Path &path);
+        void updateCategoryBandwidthShares();
+        void rebalanceConnections();
+        void startQueuedCheckingJobs();
+        void updateMetadataDownloads();
+        void analyzeSwarms(const QVector<Torrent *> &torrents);
+        void analyzeSwarm(TorrentImpl *torrent);
+        void removeCheckingJob(const TorrentID &id);
+        void storeCheckingQueue() const;
+        void loadCheckingQueue();
         void processPendingFinishedTorrents();
 
         void loadCategories();
         void storeCategories() const;
         void upgradeCategories();
         DownloadPathOption resolveCategoryDownloadPathOption(const QString &categoryName, const std::optional<DownloadPathOption> &option) const;
+        void clearCategoryPathsCache();
 
-        void saveStatistics() const;
+        void saveStatistics();
         void loadStatistics();
+        void saveSessionState() const;
+        void loadSessionState(lt::session_params &sessionParams) const;
 
-        void updateTrackerEntryStatuses(lt::torrent_handle torrentHandle);
+        void updateTrackerEntryStatuses();
 
         void handleRemovedTorrent(const TorrentID &torrentID, const QString &partfileRemoveError = {});
 
@@ -644,6 +838,9 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isIPFilteringEnabled;
         CachedSettingValue<bool> m_isTrackerFilteringEnabled;
         CachedSettingValue<Path> m_IPFilterFile;
+        CachedSettingValue<QStringList> m_IPFilterSubscriptions;
+        CachedSettingValue<int> m_IPFilterSubscriptionsRefreshInterval;
+        CachedSettingValue<QStringList> m_blockedCountries;
         CachedSettingValue<bool> m_announceToAllTrackers;
         CachedSettingValue<bool> m_announceToAllTiers;
         CachedSettingValue<int> m_asyncIOThreads;
@@ -654,6 +851,9 @@ namespace BitTorrent
         CachedSettingValue<int> m_diskCacheTTL;
         CachedSettingValue<qint64> m_diskQueueSize;
         CachedSettingValue<DiskIOType> m_diskIOType;
+        CachedSettingValue<int> m_diskIOJobsPerDevice;
+        CachedSettingValue<int> m_diskIOReadsPerHashJob;
+        CachedSettingValue<int> m_diskReadCacheSize;
         CachedSettingValue<DiskIOReadMode> m_diskIOReadMode;
         CachedSettingValue<DiskIOWriteMode> m_diskIOWriteMode;
         CachedSettingValue<bool> m_coalesceReadWriteEnabled;
@@ -684,6 +884,8 @@ namespace BitTorrent
         CachedSettingValue<QString> m_announceIP;
         CachedSettingValue<int> m_maxConcurrentHTTPAnnounces;
         CachedSettingValue<bool> m_isReannounceWhenAddressChangedEnabled;
+        CachedSettingValue<int> m_announceRampRate;
+        CachedSettingValue<int> m_announceJitter;
         CachedSettingValue<int> m_stopTrackerTimeout;
         CachedSettingValue<int> m_maxConnections;
         CachedSettingValue<int> m_maxUploads;
@@ -747,11 +949,18 @@ namespace BitTorrent
         CachedSettingValue<int> m_peerTurnover;
         CachedSettingValue<int> m_peerTurnoverCutoff;
         CachedSettingValue<int> m_peerTurnoverInterval;
+        CachedSettingValue<bool> m_isConnectionsRebalancingEnabled;
         CachedSettingValue<int> m_requestQueueSize;
         CachedSettingValue<bool> m_isExcludedFileNamesEnabled;
         CachedSettingValue<QStringList> m_excludedFileNames;
         CachedSettingValue<QStringList> m_bannedIPs;
+        CachedSettingValue<QVariantMap> m_bannedIPsExpiration;
         CachedSettingValue<ResumeDataStorageType> m_resumeDataStorageType;
+        CachedSettingValue<bool> m_isResumeDataStorageSharded;
+        CachedSettingValue<bool> m_isDeferredStoppedTorrentsLoadingEnabled;
+        CachedSettingValue<bool> m_isTrustedResumeDataEnabled;
+        CachedSettingValue<int> m_resumeDataStorageBatchSize;
+        CachedSettingValue<int> m_resumeDataStorageBatchLatency;
         CachedSettingValue<bool> m_isMergeTrackersEnabled;
         CachedSettingValue<bool> m_isI2PEnabled;
         CachedSettingValue<QString> m_I2PAddress;
@@ -762,6 +971,10 @@ namespace BitTorrent
         CachedSettingValue<int> m_I2PInboundLength;
         CachedSettingValue<int> m_I2POutboundLength;
         CachedSettingValue<TorrentContentRemoveOption> m_torrentContentRemoveOption;
+        CachedSettingValue<int> m_maxActiveMoveStorageJobsPerDevice;
+        CachedSettingValue<int> m_maxActiveCheckingTorrentsPerDevice;
+        CachedSettingValue<int> m_maxActiveMetadataDownloads;
+        CachedSettingValue<int> m_metadataDownloadTimeout;
         SettingValue<bool> m_startPaused;
 
         lt::session *m_nativeSession = nullptr;
@@ -775,10 +988,29 @@ namespace BitTorrent
         CachedSettingValue<QString> m_publicTrackers;
         CachedSettingValue<bool> m_autoBanUnknownPeer;
         CachedSettingValue<bool> m_autoBanBTPlayerPeer;
+        CachedSettingValue<bool> m_autoBanFakeProgressPeer;
+        CachedSettingValue<int> m_fakeProgressPeerMinUpload;
+        CachedSettingValue<int> m_fakeProgressPeerMinProgress;
+        CachedSettingValue<int> m_bannedPeersHistoryDays;
         CachedSettingValue<bool> m_shadowBan;
         CachedSettingValue<QStringList> m_shadowBannedIPs;
+        CachedSettingValue<QVariantMap> m_shadowBannedIPsExpiration;
         CachedSettingValue<bool> m_isAutoUpdateTrackersEnabled;
+        CachedSettingValue<int> m_maxPublicTrackersPerTorrent;
+        // HTTP validators of the downloaded public trackers list
+        SettingValue<QString> m_publicTrackersSourceURL;
+        SettingValue<QString> m_publicTrackersETag;
+        SettingValue<QString> m_publicTrackersLastModified;
         QTimer *m_updateTimer;
+        QTimer *m_publicTrackersRankingTimer = nullptr;
+        QTimer *m_sessionStateSaveTimer = nullptr;
+        std::shared_ptr<peer_policy> m_peerPolicy;
+        // shadow banned peers are assigned to this class to have their upload throttled by libtorrent
+        lt::peer_class_t m_shadowBanPeerClass {};
+        QFileSystemWatcher *m_peerFiltersWatcher = nullptr;
+        QTimer *m_peerFiltersReloadTimer = nullptr;
+        QList<QDateTime> m_peerFiltersModified;
+        FakeProgressDetector m_fakeProgressDetector;
 
         bool m_isRestored = false;
         bool m_isPaused = isStartPaused();
@@ -791,40 +1023,119 @@ namespace BitTorrent
         int m_numResumeData = 0;
         QVector<TrackerEntry> m_additionalTrackerEntries;
         QVector<TrackerEntry> m_publicTrackerList;
-        QVector<QRegularExpression> m_excludedFileNamesRegExpList;
+        // healthiest public trackers which are added to new torrents
+        QVector<TrackerEntry> m_rankedPublicTrackers;
+        TrackerHealthRegistry m_trackerHealthRegistry;
+        // forced reannounces to the same tracker host are spread out at announce ramp rate
+        AnnounceScheduler m_announceScheduler;
+        StringPool m_trackerURLPool;
+        bool m_trackerURLPoolPurgeScheduled = false;
+        // changes of the public trackers list which are being applied to existing torrents
+        QSet<QString> m_removedPublicTrackers;
+        QVector<TrackerEntry> m_addedPublicTrackers;
+        QList<TorrentID> m_publicTrackersUpdateQueue;
+        FileNameFilter m_excludedFileNamesFilter;
 
         // Statistics
         mutable QElapsedTimer m_statisticsLastUpdateTimer;
         mutable bool m_isStatisticsDirty = false;
         qint64 m_previouslyUploaded = 0;
         qint64 m_previouslyDownloaded = 0;
+        TransferStatistics m_transferStatistics;
+        TransferStatisticsStorage *m_statisticsStorage = nullptr;
 
         bool m_torrentsQueueChanged = false;
         bool m_needSaveTorrentsQueue = false;
         bool m_refreshEnqueued = false;
+        // per-torrent tag/category change signals are suppressed while changing many torrents at once
+        bool m_isBulkChangeInProgress = false;
         QTimer *m_seedingLimitTimer = nullptr;
+        // Torrents are checked against their share limits only when the earliest
+        // moment the limits can be reached comes. Queue may contain outdated entries,
+        // only the ones matching the deadline of torrent are valid.
+        struct ShareLimitsDeadline
+        {
+            qint64 deadline;
+            TorrentImpl *torrent;
+
+            friend bool operator>(const ShareLimitsDeadline &left, const ShareLimitsDeadline &right)
+            {
+                return left.deadline > right.deadline;
+            }
+        };
+        std::priority_queue<ShareLimitsDeadline, std::vector<ShareLimitsDeadline>, std::greater<>> m_shareLimitsDeadlinesQueue;
+        QHash<TorrentImpl *, qint64> m_shareLimitsDeadlines;
         QTimer *m_resumeDataTimer = nullptr;
+        QTimer *m_refreshTimer = nullptr;
+        QElapsedTimer m_refreshDemandTimer;
+        lt::status_flags_t m_postedStatusFlags = lt::status_flags_t::all();
         // IP filtering
         QPointer<FilterParserThread> m_filterParser;
+        IPFilterSubscriptionManager *m_IPFilterSubscriptionManager = nullptr;
+        // Rules of the filter file, they are merged with subscribed lists when either of them changes
+        lt::ip_filter m_parsedIPFilter;
+        // Address ranges of the blocked countries expanded from GeoIP database, they are added
+        // to the filter, so the peers from these countries are rejected before they are connected
+        std::vector<std::pair<lt::address, lt::address>> m_blockedCountryRanges;
+        // Currently applied filter (parsed filter file rules + subscribed lists + banned IPs), kept here
+        // so that new bans can be added without fetching it back from libtorrent
+        lt::ip_filter m_IPFilter;
+        QSet<QString> m_bannedIPsIndex;
+        QStringList m_pendingBannedIPs;
+        QTimer *m_bannedIPsApplyTimer = nullptr;
+        // Temporary bans, expiration times are stored in settings as seconds since epoch
+        struct ExpiringBan
+        {
+            QString ip;
+            bool isShadowBan = false;
+        };
+        TimerWheel<ExpiringBan> m_banExpirationWheel;
+        // access flags the filter had for temporarily banned addresses before they were banned
+        QHash<QString, quint32> m_bannedIPsFilterAccess;
+        QTimer *m_banExpirationTimer = nullptr;
+        // Peers added by the user are connected in portions, so that the burst of connection attempts
+        // doesn't exceed the connection speed and get dropped
+        struct PeerConnectRequest
+        {
+            TorrentID torrentID;
+            PeerAddress address;
+        };
+        std::deque<PeerConnectRequest> m_peerConnectQueue;
+        QSet<std::pair<TorrentID, PeerAddress>> m_queuedPeerConnects;
+        QTimer *m_peerConnectTimer = nullptr;
         QPointer<BandwidthScheduler> m_bwScheduler;
+        // percentage of the global speed limits requested by scheduler rate profile
+        int m_scheduledBandwidthPercent = 100;
         // Tracker
         QPointer<Tracker> m_tracker;
 
         Utils::Thread::UniquePtr m_ioThread;
         QThreadPool *m_asyncWorker = nullptr;
+        MetadataCache m_metadataCache;
         ResumeDataStorage *m_resumeDataStorage = nullptr;
         FileSearcher *m_fileSearcher = nullptr;
+        // requests issued during one event loop iteration are searched in single batch
+        QList<FileSearchRequest> m_pendingFileSearchRequests;
         TorrentContentRemover *m_torrentContentRemover = nullptr;
 
         QHash<TorrentID, lt::torrent_handle> m_downloadedMetadata;
 
         QHash<TorrentID, TorrentImpl *> m_torrents;
+        // the same torrents as in m_torrents kept contiguously
+        DenseSet<Torrent *> m_torrentRegistry;
         QHash<TorrentID, TorrentImpl *> m_hybridTorrentsByAltID;
         QHash<TorrentID, LoadTorrentParams> m_loadingTorrents;
+        // torrents resumed without examining their files, they are verified in the background later
+        QSet<TorrentID> m_trustedResumeDataTorrents;
+        Utils::Thread::UniquePtr m_trustedResumeDataVerificationThread;
+        std::atomic_bool m_isTrustedResumeDataVerificationAborted = false;
+        // Resume data received while handling alerts is stored at once
+        QHash<TorrentID, LoadTorrentParams> m_pendingResumeData;
         QHash<TorrentID, RemovingTorrentData> m_removingTorrents;
         QHash<TorrentID, TorrentID> m_changedTorrentIDs;
         QMap<QString, CategoryOptions> m_categories;
         TagSet m_tags;
+        QHash<QString, int> m_tagIndexes;
 
         qsizetype m_receivedAddTorrentAlertsCount = 0;
         QList<Torrent *> m_loadedTorrents;
@@ -832,7 +1143,19 @@ namespace BitTorrent
         // This field holds amounts of peers reported by trackers in their responses to announces
         // (torrent.tracker_name.tracker_local_endpoint.protocol_version.num_peers)
         QHash<lt::torrent_handle, QHash<std::string, QHash<lt::tcp::endpoint, QMap<int, int>>>> m_updatedTrackerStatuses;
+        // Start times of ongoing announces used to measure tracker latency
+        // (guarded by m_updatedTrackerStatusesMutex as well)
+        QHash<lt::torrent_handle, QHash<std::string, lt::time_point>> m_trackerAnnounceTimes;
         QMutex m_updatedTrackerStatusesMutex;
+        bool m_isTrackerEntryStatusesUpdating = false;
+
+        // Alerts are popped by dedicated thread, which handles the frequent ones that don't
+        // depend on main thread state itself and hands the rest over to readAlerts()
+        Utils::Thread::UniquePtr m_alertsThread;
+        QMutex m_pendingAlertsMutex;
+        QWaitCondition m_pendingAlertsProcessed;
+        std::vector<lt::alert *> m_pendingAlerts;
+        bool m_isAlertsThreadStopping = false;
 
         // I/O errored torrents
         QSet<TorrentID> m_recentErroredTorrents;
@@ -840,11 +1163,34 @@ namespace BitTorrent
 
         SessionMetricIndices m_metricIndices;
         lt::time_point m_statsLastTimestamp = lt::clock_type::now();
+        // all the session counters, values are indexes of them in session stats
+        QList<std::pair<SessionCounter, int>> m_sessionCounters;
+        std::vector<std::int64_t> m_sessionStats;
+        SessionMetrics m_metrics;
+        QElapsedTimer m_metricsTimer;
+        QHash<const TorrentImpl *, qint64> m_resumeDataRequestTimes;
 
         SessionStatus m_status;
         CacheStatus m_cacheStatus;
 
         QList<MoveStorageJob> m_moveStorageQueue;
+        QList<RelocationBatch> m_relocationBatches;
+        // while set, the enqueued moves are added to the last relocation batch and they are started all at once
+        bool m_isRelocationBatchBeingFilled = false;
+        QHash<Path, QByteArray> m_relocationDeviceIDs;
+        // resolved category paths, most of torrents share a few categories
+        mutable QHash<QString, Path> m_categorySavePathsCache;
+        mutable QHash<QString, Path> m_categoryDownloadPathsCache;
+        QList<CheckingJob> m_checkingQueue;
+        bool m_hasCategoryBandwidthShares = false;
+        bool m_hasConnectionsBudgets = false;
+        lt::clock_type::time_point m_connectionsRebalanceTime;
+        // torrents whose check was interrupted by previous shutdown
+        QSet<TorrentID> m_interruptedCheckingTorrents;
+        // queued torrents which are started to download metadata, by the time they were started
+        QHash<TorrentID, lt::clock_type::time_point> m_metadataDownloads;
+        // torrents which failed to get metadata in time are left to the queue for good
+        QSet<TorrentID> m_timedOutMetadataDownloads;
 
         QString m_lastExternalIP;
 
@@ -0,0 +1,76 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <QList>
+#include <QString>
+#include <QtTypes>
+
+#include "diskiostatistics.h"
+
+namespace BitTorrent
+{
+    // Durations of recurring operation accumulated since the session start
+    struct OperationTimings
+    {
+        qint64 count = 0;
+        qint64 totalTime = 0;  // nanoseconds
+        qint64 maxTime = 0;  // nanoseconds
+
+        void add(const qint64 time)
+        {
+            ++count;
+            totalTime += time;
+            maxTime = std::max(maxTime, time);
+        }
+    };
+
+    struct SessionCounter
+    {
+        QString name;  // libtorrent metric name, e.g. "net.sent_bytes"
+        bool isGauge = false;
+        qint64 value = 0;
+    };
+
+    struct SessionMetrics
+    {
+        // values of the latest session stats reported by libtorrent
+        QList<SessionCounter> counters;
+
+        OperationTimings alertsProcessing;
+        OperationTimings refresh;
+        // from requesting resume data until it is received from libtorrent
+        OperationTimings resumeDataSaving;
+
+        // collected by custom disk I/O backend, only available with libtorrent 2.0
+        DiskIOStatistics diskIO;
+    };
+}
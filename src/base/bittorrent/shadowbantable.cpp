@@ -0,0 +1,115 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "shadowbantable.h"
+
+#include <atomic>
+#include <functional>
+#include <string_view>
+
+#include <boost/asio/ip/address.hpp>
+
+#include <QStringList>
+
+#include "base/atomicsnapshot.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    AtomicSnapshot<ShadowBanTable> &currentTable()
+    {
+        static AtomicSnapshot<ShadowBanTable> table;
+        return table;
+    }
+
+    std::atomic<std::uint64_t> tableGeneration {0};
+
+    lt::address normalized(const lt::address &addr)
+    {
+        // IPv4-mapped IPv6 peers must match plain IPv4 entries
+        if (addr.is_v6() && addr.to_v6().is_v4_mapped())
+            return boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, addr.to_v6());
+        return addr;
+    }
+}
+
+std::size_t ShadowBanTable::AddressHash::operator()(const lt::address &addr) const noexcept
+{
+    if (addr.is_v4())
+        return std::hash<lt::address_v4::uint_type> {}(addr.to_v4().to_uint());
+
+    const lt::address_v6::bytes_type bytes = addr.to_v6().to_bytes();
+    return std::hash<std::string_view> {}({reinterpret_cast<const char *>(bytes.data()), bytes.size()});
+}
+
+ShadowBanTable::ShadowBanTable(const QStringList &ips)
+{
+    m_addresses.reserve(ips.size());
+    for (const QString &ip : ips)
+    {
+        lt::error_code ec;
+        const lt::address addr = lt::make_address(ip.toLatin1().constData(), ec);
+        if (!ec)
+            m_addresses.insert(normalized(addr));
+    }
+}
+
+bool ShadowBanTable::contains(const lt::address &addr) const
+{
+    if (m_addresses.empty())
+        return false;
+
+    return m_addresses.contains(normalized(addr));
+}
+
+bool ShadowBanTable::isEmpty() const
+{
+    return m_addresses.empty();
+}
+
+qsizetype ShadowBanTable::count() const
+{
+    return static_cast<qsizetype>(m_addresses.size());
+}
+
+std::shared_ptr<const ShadowBanTable> ShadowBanTable::current()
+{
+    return currentTable().load();
+}
+
+void ShadowBanTable::publish(const QStringList &ips)
+{
+    currentTable().store(ShadowBanTable(ips));
+    tableGeneration.fetch_add(1, std::memory_order_release);
+}
+
+std::uint64_t ShadowBanTable::generation()
+{
+    return tableGeneration.load(std::memory_order_acquire);
+}
@@ -0,0 +1,144 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "speedhistory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace
+{
+    Sample<quint32> toStored(const SpeedSample &sample)
+    {
+        const auto clamp = [](const qlonglong value) -> quint32
+        {
+            return std::clamp<qlonglong>(value, 0, std::numeric_limits<quint32>::max());
+        };
+        return {clamp(sample.download), clamp(sample.upload)};
+    }
+
+    SpeedSample transferred(const SpeedSample &rate, const qint64 duration)
+    {
+        return {rate.download * duration, rate.upload * duration};
+    }
+}
+
+qint64 SpeedHistory::resolution(const Period period)
+{
+    return LEVELS[static_cast<int>(period)].resolution;
+}
+
+int SpeedHistory::samplesCount(const Period period)
+{
+    return LEVELS[static_cast<int>(period)].count;
+}
+
+qint64 SpeedHistory::currentTimestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void SpeedHistory::addSample(const SpeedSample &sample, const qint64 timestamp)
+{
+    if ((m_lastTimestamp >= 0) && (timestamp > m_lastTimestamp))
+    {
+        for (int i = 0; i < LEVELS_COUNT; ++i)
+        {
+            const Level &level = LEVELS[i];
+            SpeedSample &accumulator = m_accumulators[i];
+
+            qint64 from = m_lastTimestamp;
+            const qint64 bucket = m_lastTimestamp / level.resolution;
+            const qint64 currentBucket = timestamp / level.resolution;
+            if (bucket < currentBucket)
+            {
+                accumulator += transferred(m_current, (((bucket + 1) * level.resolution) - from));
+                store(level, bucket, {accumulator.download / level.resolution, accumulator.upload / level.resolution});
+                accumulator = {};
+
+                // the skipped buckets had the same rate all the time
+                for (qint64 b = std::max((bucket + 1), (currentBucket - level.count)); b < currentBucket; ++b)
+                    store(level, b, m_current);
+
+                from = currentBucket * level.resolution;
+            }
+
+            accumulator += transferred(m_current, (timestamp - from));
+        }
+    }
+
+    if (timestamp > m_lastTimestamp)
+        m_lastTimestamp = timestamp;
+    m_current = {std::max<qlonglong>(sample.download, 0), std::max<qlonglong>(sample.upload, 0)};
+}
+
+QList<SpeedSample> SpeedHistory::samples(const Period period, const qint64 timestamp) const
+{
+    const int levelIndex = static_cast<int>(period);
+    const Level &level = LEVELS[levelIndex];
+
+    QList<SpeedSample> result;
+    result.reserve(level.count);
+    if (m_lastTimestamp < 0)
+    {
+        result.resize(level.count);
+        return result;
+    }
+
+    const qint64 bucket = m_lastTimestamp / level.resolution;
+    const qint64 endBucket = std::max(timestamp, m_lastTimestamp) / level.resolution;
+    for (qint64 i = (endBucket - level.count); i < endBucket; ++i)
+    {
+        if (i < bucket)
+        {
+            // buckets preceding the first sample are never stored so they remain empty
+            const StoredSample &stored = m_buckets[level.offset + (i % level.count)];
+            result.append({stored.download, stored.upload});
+        }
+        else if (i == bucket)
+        {
+            // the last bucket isn't stored until the next sample is added
+            SpeedSample accumulator = m_accumulators[levelIndex];
+            accumulator += transferred(m_current, (((bucket + 1) * level.resolution) - m_lastTimestamp));
+            result.append({accumulator.download / level.resolution, accumulator.upload / level.resolution});
+        }
+        else
+        {
+            result.append(m_current);
+        }
+    }
+
+    return result;
+}
+
+void SpeedHistory::store(const Level &level, const qint64 bucket, const SpeedSample &sample)
+{
+    m_buckets[level.offset + (bucket % level.count)] = toStored(sample);
+}
@@ -0,0 +1,88 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <QtTypes>
+#include <QList>
+
+#include "speedmonitor.h"
+
+// Speed history of fixed size kept at several resolutions.
+// Each resolution is a ring of buckets holding average speed (in bytes/s) over
+// the bucket interval. Rates are considered to stay the same until the next sample,
+// so samples may come at irregular intervals and only changes need to be reported.
+// Buckets are aligned to the timestamps, so histories queried with the same
+// timestamp can be aggregated by summing the buckets.
+class SpeedHistory
+{
+public:
+    enum class Period
+    {
+        Minute,
+        Hour,
+        Day
+    };
+
+    static qint64 resolution(Period period);
+    static int samplesCount(Period period);
+    static qint64 currentTimestamp();
+
+    // `timestamp` is in milliseconds
+    void addSample(const SpeedSample &sample, qint64 timestamp);
+    // completed buckets of the period preceding the one containing `timestamp`, the oldest first
+    QList<SpeedSample> samples(Period period, qint64 timestamp) const;
+
+private:
+    using StoredSample = Sample<quint32>;
+
+    struct Level
+    {
+        qint64 resolution;
+        int offset;
+        int count;
+    };
+
+    static constexpr int LEVELS_COUNT = 3;
+    static constexpr std::array<Level, LEVELS_COUNT> LEVELS {{
+        {.resolution = 5'000, .offset = 0, .count = 12},
+        {.resolution = 60'000, .offset = 12, .count = 60},
+        {.resolution = 900'000, .offset = 72, .count = 96}
+    }};
+    static constexpr int BUCKETS_COUNT = 168;
+
+    void store(const Level &level, qint64 bucket, const SpeedSample &sample);
+
+    std::array<StoredSample, BUCKETS_COUNT> m_buckets {};
+    // transferred amount (in bytes * ms) during current bucket of each level
+    std::array<SpeedSample, LEVELS_COUNT> m_accumulators {};
+    SpeedSample m_current;
+    qint64 m_lastTimestamp = -1;
+};
@@ -38,7 +38,9 @@
 #include "base/pathfwd.h"
 #include "base/tagset.h"
 #include "sharelimitaction.h"
+#include "speedhistory.h"
 #include "torrentcontenthandler.h"
+#include "torrentstatusfield.h"
 
 class QBitArray;
 class QByteArray;
@@ -206,7 +208,7 @@ namespace BitTorrent
         virtual bool belongsToCategory(const QString &category) const = 0;
         virtual bool setCategory(const QString &category) = 0;
 
-        virtual TagSet tags() const = 0;
+        virtual const TagSet &tags() const = 0;
         virtual bool hasTag(const Tag &tag) const = 0;
         virtual bool addTag(const Tag &tag) = 0;
         virtual bool removeTag(const Tag &tag) = 0;
@@ -287,15 +289,23 @@ namespace BitTorrent
         virtual qreal popularity() const = 0;
         virtual int uploadPayloadRate() const = 0;
         virtual int downloadPayloadRate() const = 0;
+        virtual QList<SpeedSample> payloadRateHistory(SpeedHistory::Period period, qint64 timestamp) const = 0;
         virtual qlonglong totalPayloadUpload() const = 0;
         virtual qlonglong totalPayloadDownload() const = 0;
         virtual int connectionsCount() const = 0;
         virtual int connectionsLimit() const = 0;
         virtual qlonglong nextAnnounce() const = 0;
+        // Increases each time any of the torrent data is changed, so the data is unchanged while it is the same.
+        // It is unique among all the torrents.
+        virtual quint64 statusRevision() const = 0;
 
         virtual void setName(const QString &name) = 0;
         virtual void setSequentialDownload(bool enable) = 0;
         virtual void setFirstLastPiecePriority(bool enabled) = 0;
+        // The piece is downloaded before the deadline (in milliseconds) if possible and its data
+        // is delivered with Session::torrentPieceRead() once it is available, even if it's downloaded already
+        virtual void setPieceDeadline(int pieceIndex, int deadline) = 0;
+        virtual void resetPieceDeadline(int pieceIndex) = 0;
         virtual void stop() = 0;
         virtual void start(TorrentOperatingMode mode = TorrentOperatingMode::AutoManaged) = 0;
         virtual void forceReannounce(int index = -1) = 0;
@@ -324,6 +334,9 @@ namespace BitTorrent
         virtual QString createMagnetURI() const = 0;
         virtual nonstd::expected<QByteArray, QString> exportToBuffer() const = 0;
         virtual nonstd::expected<void, QString> exportToFile(const Path &path) const = 0;
+        // Same as `exportToBuffer()` but the file is generated in background.
+        // The result is delivered even if the torrent is removed meanwhile.
+        virtual void fetchTorrentFile(std::function<void (nonstd::expected<QByteArray, QString>)> resultHandler) const = 0;
 
         virtual void fetchPeerInfo(std::function<void (QVector<PeerInfo>)> resultHandler) const = 0;
         virtual void fetchURLSeeds(std::function<void (QVector<QUrl>)> resultHandler) const = 0;
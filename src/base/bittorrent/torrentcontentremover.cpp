@@ -28,34 +28,157 @@
 
 #include "torrentcontentremover.h"
 
+#include <chrono>
+
+#include <QTimer>
+
+#include "base/global.h"
 #include "base/utils/fs.h"
 
-void BitTorrent::TorrentContentRemover::performJob(const QString &torrentName, const Path &basePath
+using namespace std::chrono_literals;
+
+struct BitTorrent::TorrentContentRemover::Job
+{
+    QString torrentName;
+    Path basePath;
+    PathList fileNames;
+    TorrentContentRemoveOption option;
+    std::atomic_int removedFiles = 0;
+};
+
+BitTorrent::TorrentContentRemover::TorrentContentRemover(QObject *parent)
+    : QObject(parent)
+    , m_progressTimer {new QTimer(this)}
+{
+    m_progressTimer->setInterval(500ms);
+    connect(m_progressTimer, &QTimer::timeout, this, &TorrentContentRemover::reportProgress);
+}
+
+BitTorrent::TorrentContentRemover::~TorrentContentRemover()
+{
+    cancelAll();
+    m_threadPool.waitForDone();
+}
+
+void BitTorrent::TorrentContentRemover::addJob(const QString &torrentName, const Path &basePath
         , const PathList &fileNames, const TorrentContentRemoveOption option)
 {
-    QString errorMessage;
+    auto job = std::make_shared<Job>();
+    job->torrentName = torrentName;
+    job->basePath = basePath;
+    job->fileNames = fileNames;
+    job->option = option;
+
+    const QByteArray deviceID = Utils::Fs::storageDeviceID(basePath);
+    m_deviceQueues[deviceID].queuedJobs.enqueue(std::move(job));
+    startNextJob(deviceID);
 
-    if (!fileNames.isEmpty())
+    if (!m_progressTimer->isActive())
+        m_progressTimer->start();
+}
+
+void BitTorrent::TorrentContentRemover::cancelAll()
+{
+    m_isCancelled = true;
+
+    for (DeviceQueue &deviceQueue : m_deviceQueues)
+        deviceQueue.queuedJobs.clear();
+}
+
+void BitTorrent::TorrentContentRemover::startNextJob(const QByteArray &deviceID)
+{
+    const auto iter = m_deviceQueues.find(deviceID);
+    if (iter == m_deviceQueues.end())
+        return;
+
+    DeviceQueue &deviceQueue = iter.value();
+    if (deviceQueue.activeJob)
+        return;
+
+    if (deviceQueue.queuedJobs.isEmpty())
+    {
+        m_deviceQueues.erase(iter);
+        return;
+    }
+
+    deviceQueue.activeJob = deviceQueue.queuedJobs.dequeue();
+    m_threadPool.start([this, deviceID, job = deviceQueue.activeJob]
     {
-        const auto removeFileFn = [&option](const Path &filePath)
+        const QString errorMessage = removeContent(*job, m_isCancelled);
+        QMetaObject::invokeMethod(this, [this, deviceID, torrentName = job->torrentName, errorMessage]
         {
-            return ((option == TorrentContentRemoveOption::MoveToTrash)
-                    ? Utils::Fs::moveFileToTrash : Utils::Fs::removeFile)(filePath);
-        };
+            handleJobFinished(deviceID, torrentName, errorMessage);
+        });
+    });
+}
 
-        for (const Path &fileName : fileNames)
+void BitTorrent::TorrentContentRemover::handleJobFinished(const QByteArray &deviceID
+        , const QString &torrentName, const QString &errorMessage)
+{
+    if (const auto iter = m_deviceQueues.find(deviceID); iter != m_deviceQueues.end())
+    {
+        m_finishedJobsFiles += iter->activeJob->fileNames.size();
+        iter->activeJob.reset();
+    }
+
+    emit jobFinished(torrentName, errorMessage);
+
+    startNextJob(deviceID);
+    if (m_deviceQueues.isEmpty())
+    {
+        m_progressTimer->stop();
+        m_finishedJobsFiles = 0;
+        emit progressChanged(0, 0);
+    }
+}
+
+void BitTorrent::TorrentContentRemover::reportProgress()
+{
+    int removedFiles = m_finishedJobsFiles;
+    int totalFiles = m_finishedJobsFiles;
+    for (const DeviceQueue &deviceQueue : asConst(m_deviceQueues))
+    {
+        if (deviceQueue.activeJob)
         {
-            if (const auto result = removeFileFn(basePath / fileName)
-                    ; !result && errorMessage.isEmpty())
-            {
-                errorMessage = result.error();
-            }
+            removedFiles += deviceQueue.activeJob->removedFiles.load(std::memory_order_relaxed);
+            totalFiles += deviceQueue.activeJob->fileNames.size();
         }
 
-        const Path rootPath = Path::findRootFolder(fileNames);
-        if (!rootPath.isEmpty())
-            Utils::Fs::smartRemoveEmptyFolderTree(basePath / rootPath);
+        for (const std::shared_ptr<Job> &job : deviceQueue.queuedJobs)
+            totalFiles += job->fileNames.size();
     }
 
-    emit jobFinished(torrentName, errorMessage);
+    emit progressChanged(removedFiles, totalFiles);
+}
+
+QString BitTorrent::TorrentContentRemover::removeContent(Job &job, const std::atomic_bool &isCancelled)
+{
+    if (job.fileNames.isEmpty())
+        return {};
+
+    const auto removeFileFn = [&job](const Path &filePath)
+    {
+        return ((job.option == TorrentContentRemoveOption::MoveToTrash)
+                ? Utils::Fs::moveFileToTrash : Utils::Fs::removeFile)(filePath);
+    };
+
+    QString errorMessage;
+    for (const Path &fileName : asConst(job.fileNames))
+    {
+        if (isCancelled.load(std::memory_order_relaxed))
+            return tr("Removal was interrupted");
+
+        if (const auto result = removeFileFn(job.basePath / fileName)
+                ; !result && errorMessage.isEmpty())
+        {
+            errorMessage = result.error();
+        }
+        job.removedFiles.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const Path rootPath = Path::findRootFolder(job.fileNames);
+    if (!rootPath.isEmpty())
+        Utils::Fs::smartRemoveEmptyFolderTree(job.basePath / rootPath);
+
+    return errorMessage;
 }
@@ -28,26 +28,64 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+
+#include <QByteArray>
+#include <QHash>
 #include <QObject>
+#include <QQueue>
+#include <QThreadPool>
 
 #include "base/path.h"
 #include "torrentcontentremoveoption.h"
 
+class QTimer;
+
 namespace BitTorrent
 {
+    // Removes content of the torrents on its own thread pool. Jobs removing files located
+    // on the same storage device are performed one after another, so they don't compete
+    // for the disk, while removal on different devices runs in parallel.
     class TorrentContentRemover final : public QObject
     {
         Q_OBJECT
         Q_DISABLE_COPY_MOVE(TorrentContentRemover)
 
     public:
-        using QObject::QObject;
+        explicit TorrentContentRemover(QObject *parent = nullptr);
+        ~TorrentContentRemover() override;
 
-    public slots:
-        void performJob(const QString &torrentName, const Path &basePath
+        void addJob(const QString &torrentName, const Path &basePath
                 , const PathList &fileNames, TorrentContentRemoveOption option);
+        // drops queued jobs and stops running ones after the file being removed
+        void cancelAll();
 
     signals:
         void jobFinished(const QString &torrentName, const QString &errorMessage);
+        // aggregated progress of all queued and running jobs, emitted with zero values once all of them are finished
+        void progressChanged(int removedFiles, int totalFiles);
+
+    private:
+        struct Job;
+
+        struct DeviceQueue
+        {
+            std::shared_ptr<Job> activeJob;
+            QQueue<std::shared_ptr<Job>> queuedJobs;
+        };
+
+        static QString removeContent(Job &job, const std::atomic_bool &isCancelled);
+
+        void startNextJob(const QByteArray &deviceID);
+        void handleJobFinished(const QByteArray &deviceID, const QString &torrentName, const QString &errorMessage);
+        void reportProgress();
+
+        QHash<QByteArray, DeviceQueue> m_deviceQueues;
+        QThreadPool m_threadPool;
+        QTimer *m_progressTimer = nullptr;
+        std::atomic_bool m_isCancelled = false;
+        // files of the jobs which were finished since the removing was idle
+        int m_finishedJobsFiles = 0;
     };
 }
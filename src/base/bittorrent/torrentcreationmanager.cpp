@@ -29,6 +29,7 @@
 
 #include "torrentcreationmanager.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <boost/multi_index_container.hpp>
@@ -39,6 +40,9 @@
 
 #include <QUuid>
 
+#include "base/global.h"
+#include "base/utils/fs.h"
+
 #define SETTINGS_KEY(name) u"TorrentCreator/Manager/" name
 
 namespace BitTorrent
@@ -60,7 +64,8 @@ namespace BitTorrent
 BitTorrent::TorrentCreationManager::TorrentCreationManager(IApplication *app, QObject *parent)
     : ApplicationComponent(app, parent)
     , m_maxTasks {SETTINGS_KEY(u"MaxTasks"_s), 256}
-    , m_numThreads {SETTINGS_KEY(u"NumThreads"_s), 1}
+    , m_numThreads {SETTINGS_KEY(u"NumThreads"_s), 0}
+    , m_maxTasksPerDevice {SETTINGS_KEY(u"MaxTasksPerDevice"_s), 1}
     , m_tasks {std::make_unique<TaskSet>()}
 {
     if (m_numThreads > 0)
@@ -91,11 +96,81 @@ std::shared_ptr<BitTorrent::TorrentCreationTask> BitTorrent::TorrentCreationMana
     connect(creationTask.get(), &QObject::destroyed, torrentCreator, &BitTorrent::TorrentCreator::requestInterruption);
 
     m_tasks->get<ByID>().insert(creationTask);
-    m_threadPool.start(torrentCreator);
+    enqueueTask(taskID, torrentCreator);
 
     return creationTask;
 }
 
+void BitTorrent::TorrentCreationManager::enqueueTask(const QString &taskID, TorrentCreator *torrentCreator)
+{
+    const QByteArray deviceID = Utils::Fs::storageDeviceID(torrentCreator->params().sourcePath);
+
+    const auto handleFinished = [this, deviceID] { handleTaskFinished(deviceID); };
+    connect(torrentCreator, &TorrentCreator::creationSuccess, this, handleFinished);
+    connect(torrentCreator, &TorrentCreator::creationFailure, this, handleFinished);
+
+    m_deviceQueues[deviceID].queuedTasks.append({.taskID = taskID, .torrentCreator = torrentCreator});
+    startQueuedTasks(deviceID);
+}
+
+void BitTorrent::TorrentCreationManager::startQueuedTasks(const QByteArray &deviceID)
+{
+    const auto iter = m_deviceQueues.find(deviceID);
+    if (iter == m_deviceQueues.end())
+        return;
+
+    DeviceQueue &deviceQueue = iter.value();
+    const int maxActiveTasks = std::max(1, m_maxTasksPerDevice.get());
+    while ((deviceQueue.activeTasks < maxActiveTasks) && !deviceQueue.queuedTasks.isEmpty())
+    {
+        const QPointer<TorrentCreator> torrentCreator = deviceQueue.queuedTasks.takeFirst().torrentCreator;
+        if (!torrentCreator)
+            continue;
+
+        // task has been deleted while it was queued
+        if (torrentCreator->isInterruptionRequested())
+        {
+            delete torrentCreator;
+            continue;
+        }
+
+        ++deviceQueue.activeTasks;
+        m_threadPool.start(torrentCreator);
+    }
+
+    if ((deviceQueue.activeTasks == 0) && deviceQueue.queuedTasks.isEmpty())
+        m_deviceQueues.erase(iter);
+}
+
+void BitTorrent::TorrentCreationManager::handleTaskFinished(const QByteArray &deviceID)
+{
+    const auto iter = m_deviceQueues.find(deviceID);
+    if (iter == m_deviceQueues.end())
+        return;
+
+    --iter->activeTasks;
+    startQueuedTasks(deviceID);
+}
+
+int BitTorrent::TorrentCreationManager::queuePosition(const QString &id) const
+{
+    for (const DeviceQueue &deviceQueue : asConst(m_deviceQueues))
+    {
+        int position = 0;
+        for (const QueuedTask &queuedTask : deviceQueue.queuedTasks)
+        {
+            if (!queuedTask.torrentCreator || queuedTask.torrentCreator->isInterruptionRequested())
+                continue;
+
+            ++position;
+            if (queuedTask.taskID == id)
+                return position;
+        }
+    }
+
+    return 0;
+}
+
 QString BitTorrent::TorrentCreationManager::generateTaskID() const
 {
     const auto &tasksByID = m_tasks->get<ByID>();
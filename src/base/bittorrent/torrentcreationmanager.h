@@ -32,7 +32,11 @@
 #include <memory>
 
 #include <QtContainerFwd>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
 #include <QObject>
+#include <QPointer>
 #include <QThreadPool>
 
 #include "base/applicationcomponent.h"
@@ -42,6 +46,9 @@
 
 namespace BitTorrent
 {
+    // Tasks are scheduled per storage device of their source data: tasks reading from
+    // the same device run one after another (up to MaxTasksPerDevice at once), so they
+    // don't compete for the disk, while tasks on different devices run in parallel.
     class TorrentCreationManager final : public ApplicationComponent<QObject>
     {
         Q_OBJECT
@@ -55,16 +62,35 @@ namespace BitTorrent
         std::shared_ptr<TorrentCreationTask> getTask(const QString &id) const;
         QList<std::shared_ptr<TorrentCreationTask>> tasks() const;
         bool deleteTask(const QString &id);
+        // 1-based position of the queued task among the tasks waiting for the same device, 0 if it isn't queued
+        int queuePosition(const QString &id) const;
 
     private:
+        struct QueuedTask
+        {
+            QString taskID;
+            QPointer<TorrentCreator> torrentCreator;
+        };
+
+        struct DeviceQueue
+        {
+            int activeTasks = 0;
+            QList<QueuedTask> queuedTasks;
+        };
+
         QString generateTaskID() const;
+        void enqueueTask(const QString &taskID, TorrentCreator *torrentCreator);
+        void startQueuedTasks(const QByteArray &deviceID);
+        void handleTaskFinished(const QByteArray &deviceID);
 
         CachedSettingValue<qint32> m_maxTasks;
         CachedSettingValue<qint32> m_numThreads;
+        CachedSettingValue<qint32> m_maxTasksPerDevice;
 
         class TaskSet;
         std::unique_ptr<TaskSet> m_tasks;
 
+        QHash<QByteArray, DeviceQueue> m_deviceQueues;
         QThreadPool m_threadPool;
     };
 }
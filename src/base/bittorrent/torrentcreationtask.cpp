@@ -29,6 +29,8 @@
 
 #include "torrentcreationtask.h"
 
+#include <algorithm>
+
 #include "base/addtorrentmanager.h"
 #include "base/interfaces/iapplication.h"
 #include "base/bittorrent/addtorrentparams.h"
@@ -123,6 +125,16 @@ int BitTorrent::TorrentCreationTask::progress() const
     return m_progress;
 }
 
+qlonglong BitTorrent::TorrentCreationTask::eta() const
+{
+    if (!isRunning() || (m_progress <= 0))
+        return MAX_ETA;
+
+    // hashing speed is fairly constant, so the remaining time is extrapolated from the elapsed time
+    const qint64 elapsedSecs = m_timeStarted.secsTo(QDateTime::currentDateTime());
+    return std::min<qlonglong>(MAX_ETA, ((elapsedSecs * (100 - m_progress)) / m_progress));
+}
+
 const BitTorrent::TorrentCreatorResult &BitTorrent::TorrentCreationTask::result() const
 {
     return m_result;
@@ -34,6 +34,7 @@
 #include <QString>
 
 #include "base/applicationcomponent.h"
+#include "base/types.h"
 #include "torrentcreator.h"
 
 namespace BitTorrent
@@ -65,6 +66,7 @@ namespace BitTorrent
         QDateTime timeStarted() const;
         QDateTime timeFinished() const;
         int progress() const;
+        qlonglong eta() const;
         const TorrentCreatorResult &result() const;
         QString errorMsg() const;
 
@@ -30,16 +30,29 @@
 
 #include "torrentcreator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include <libtorrent/create_torrent.hpp>
 #include <libtorrent/file_storage.hpp>
+#include <libtorrent/hasher.hpp>
 #include <libtorrent/torrent_info.hpp>
 
 #include <QtSystemDetection>
 #include <QDirIterator>
+#include <QFile>
 #include <QFileInfo>
 #include <QHash>
+#include <QScopeGuard>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
 
 #include "base/exceptions.h"
 #include "base/global.h"
@@ -47,6 +60,9 @@
 #include "base/utils/io.h"
 #include "base/version.h"
 #include "lttypecast.h"
+#include "session.h"
+#include "torrent.h"
+#include "torrentinfo.h"
 
 namespace
 {
@@ -57,6 +73,229 @@ namespace
         return !Path(f).filename().startsWith(u'.');
     }
 
+    using namespace std::chrono_literals;
+
+    // amount of data read and hashed by single job (but at least one piece)
+    const qint64 HASH_JOB_SIZE = 4 * 1024 * 1024;
+    // limits memory used by piece buffers of concurrently running jobs
+    const qint64 HASH_BUFFERS_MAX_SIZE = 512 * 1024 * 1024;
+#ifdef QBT_USES_LIBTORRENT2
+    // size of the leaf blocks of v2 merkle trees
+    const int MERKLE_BLOCK_SIZE = 16 * 1024;
+#endif
+
+    struct PieceHashJob
+    {
+        int firstPiece = 0;
+        int pieceCount = 0;
+        std::vector<lt::sha1_hash> v1Hashes;
+#ifdef QBT_USES_LIBTORRENT2
+        // piece layer hashes, null hash for pieces which have no v2 hash
+        std::vector<lt::sha256_hash> v2Hashes;
+#endif
+        QString error;
+        QSemaphore finished;
+    };
+
+#ifdef QBT_USES_LIBTORRENT2
+    // root of the subtree over `leafCount` leaves (power of two), missing leaves are zero
+    lt::sha256_hash merkleRoot(std::vector<lt::sha256_hash> nodes, const int leafCount)
+    {
+        nodes.resize(leafCount);
+        while (nodes.size() > 1)
+        {
+            for (std::size_t i = 0; i < (nodes.size() / 2); ++i)
+            {
+                lt::hasher256 hasher;
+                hasher.update(nodes[2 * i].data(), lt::sha256_hash::size());
+                hasher.update(nodes[(2 * i) + 1].data(), lt::sha256_hash::size());
+                nodes[i] = hasher.final();
+            }
+            nodes.resize(nodes.size() / 2);
+        }
+        return nodes.front();
+    }
+
+    // piece layer hash of piece data belonging to single file, as required by BEP 52
+    lt::sha256_hash pieceLayerHash(const lt::file_storage &fs, const lt::file_index_t fileIndex, const char *data, const int dataSize)
+    {
+        const int blockCount = (dataSize + MERKLE_BLOCK_SIZE - 1) / MERKLE_BLOCK_SIZE;
+        std::vector<lt::sha256_hash> blockHashes;
+        blockHashes.reserve(blockCount);
+        for (int offset = 0; offset < dataSize; offset += MERKLE_BLOCK_SIZE)
+            blockHashes.push_back(lt::hasher256(data + offset, std::min(MERKLE_BLOCK_SIZE, (dataSize - offset))).final());
+
+        // tree of file which is smaller than single piece is padded to the next power of two only
+        const std::int64_t fileSize = fs.file_size(fileIndex);
+        const int leafCount = (fileSize < fs.piece_length())
+            ? static_cast<int>(std::bit_ceil(static_cast<quint64>((fileSize + MERKLE_BLOCK_SIZE - 1) / MERKLE_BLOCK_SIZE)))
+            : (fs.piece_length() / MERKLE_BLOCK_SIZE);
+        return merkleRoot(std::move(blockHashes), leafCount);
+    }
+#endif
+
+    void hashPieces(const lt::file_storage &fs, const std::string &basePath, const bool hashV1, const bool hashV2
+        , const std::vector<bool> &knownPieces, PieceHashJob &job, const std::atomic_bool &aborted)
+    {
+        job.v1Hashes.resize(hashV1 ? job.pieceCount : 0);
+#ifdef QBT_USES_LIBTORRENT2
+        job.v2Hashes.resize(hashV2 ? job.pieceCount : 0);
+#else
+        Q_UNUSED(hashV2);
+#endif
+
+        std::vector<char> buffer(fs.piece_length());
+        QFile file;
+        lt::file_index_t openedFileIndex {-1};
+        for (int i = 0; i < job.pieceCount; ++i)
+        {
+            if (aborted.load(std::memory_order_relaxed))
+                return;
+
+            if (knownPieces[job.firstPiece + i])
+                continue;
+
+            const lt::piece_index_t pieceIndex {job.firstPiece + i};
+            const int pieceSize = fs.piece_size(pieceIndex);
+            int bufferPos = 0;
+            // pieces are hashed in order, so each file is read sequentially
+            for (const lt::file_slice &slice : fs.map_block(pieceIndex, 0, pieceSize))
+            {
+                const auto sliceSize = static_cast<int>(slice.size);
+                if (fs.pad_file_at(slice.file_index))
+                {
+                    std::fill_n((buffer.data() + bufferPos), sliceSize, 0);
+                    bufferPos += sliceSize;
+                    continue;
+                }
+
+                if (slice.file_index != openedFileIndex)
+                {
+                    file.close();
+                    file.setFileName(QString::fromStdString(fs.file_path(slice.file_index, basePath)));
+                    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+                    {
+                        job.error = BitTorrent::TorrentCreator::tr("Cannot read file \"%1\". Error: \"%2\"").arg(file.fileName(), file.errorString());
+                        return;
+                    }
+                    openedFileIndex = slice.file_index;
+                }
+
+                if ((file.pos() != slice.offset) && !file.seek(slice.offset))
+                {
+                    job.error = BitTorrent::TorrentCreator::tr("Cannot read file \"%1\". Error: \"%2\"").arg(file.fileName(), file.errorString());
+                    return;
+                }
+
+                qint64 bytesRead = 0;
+                while (bytesRead < sliceSize)
+                {
+                    const qint64 result = file.read((buffer.data() + bufferPos + bytesRead), (sliceSize - bytesRead));
+                    if (result <= 0)
+                    {
+                        job.error = (result < 0)
+                            ? BitTorrent::TorrentCreator::tr("Cannot read file \"%1\". Error: \"%2\"").arg(file.fileName(), file.errorString())
+                            : BitTorrent::TorrentCreator::tr("File \"%1\" is shorter than expected").arg(file.fileName());
+                        return;
+                    }
+                    bytesRead += result;
+                }
+                bufferPos += sliceSize;
+            }
+
+            if (hashV1)
+                job.v1Hashes[i] = lt::hasher(buffer.data(), pieceSize).final();
+
+#ifdef QBT_USES_LIBTORRENT2
+            if (hashV2)
+            {
+                // v2 pieces are aligned to files, so piece data starts with the only file it belongs to
+                const lt::file_index_t fileIndex = fs.file_index_at_piece(pieceIndex);
+                if (!fs.pad_file_at(fileIndex))
+                {
+                    const std::int64_t fileEnd = fs.file_offset(fileIndex) + fs.file_size(fileIndex);
+                    const auto dataSize = static_cast<int>(std::min<std::int64_t>(pieceSize, (fileEnd - (static_cast<std::int64_t>(job.firstPiece + i) * fs.piece_length()))));
+                    job.v2Hashes[i] = pieceLayerHash(fs, fileIndex, buffer.data(), dataSize);
+                }
+            }
+#endif
+        }
+    }
+
+    // Pieces are split into jobs of consecutive pieces, each job reads its data with large sequential
+    // reads and hashes it on the worker pool. Jobs are queued ahead of the one being collected, so the
+    // data is read ahead while the hashes are assembled into the torrent in piece order.
+    void setPieceHashes(lt::create_torrent &torrent, const Path &basePath, const bool hashV1, const bool hashV2
+        , const std::vector<bool> &knownPieces, const std::function<void (int hashedPieces)> &progressHandler)
+    {
+        const lt::file_storage &fs = torrent.files();
+        const int numPieces = torrent.num_pieces();
+        const int pieceLength = torrent.piece_length();
+        const int piecesPerJob = std::max<int>(1, (HASH_JOB_SIZE / pieceLength));
+        const int threadCount = std::clamp<int>((HASH_BUFFERS_MAX_SIZE / pieceLength), 1, QThread::idealThreadCount());
+        const int maxQueuedJobs = 2 * threadCount;
+        const std::string basePathStr = basePath.toString().toStdString();
+
+        std::atomic_bool aborted = false;
+        std::deque<std::unique_ptr<PieceHashJob>> jobs;
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(threadCount);
+        // wait for the running jobs (threadPool is destroyed after this guard) if collecting is interrupted
+        [[maybe_unused]] const auto abortGuard = qScopeGuard([&aborted] { aborted = true; });
+
+        int nextPiece = 0;
+        const auto enqueueJobs = [&]
+        {
+            while ((nextPiece < numPieces) && (std::ssize(jobs) < maxQueuedJobs))
+            {
+                auto job = std::make_unique<PieceHashJob>();
+                job->firstPiece = nextPiece;
+                job->pieceCount = std::min(piecesPerJob, (numPieces - nextPiece));
+                nextPiece += job->pieceCount;
+
+                threadPool.start([&fs, &basePathStr, hashV1, hashV2, &knownPieces, &aborted, job = job.get()]
+                {
+                    hashPieces(fs, basePathStr, hashV1, hashV2, knownPieces, *job, aborted);
+                    job->finished.release();
+                });
+                jobs.push_back(std::move(job));
+            }
+        };
+
+        enqueueJobs();
+        while (!jobs.empty())
+        {
+            PieceHashJob &job = *jobs.front();
+            while (!job.finished.tryAcquire(1, 100ms))
+                progressHandler(job.firstPiece);
+
+            if (!job.error.isEmpty())
+                throw RuntimeError(job.error);
+
+            for (int i = 0; i < job.pieceCount; ++i)
+            {
+                if (knownPieces[job.firstPiece + i])
+                    continue;
+
+                const lt::piece_index_t pieceIndex {job.firstPiece + i};
+                if (hashV1)
+                    torrent.set_hash(pieceIndex, job.v1Hashes[i]);
+#ifdef QBT_USES_LIBTORRENT2
+                if (hashV2 && !job.v2Hashes[i].is_all_zeros())
+                {
+                    const lt::file_index_t fileIndex = fs.file_index_at_piece(pieceIndex);
+                    const auto filePieceIndex = static_cast<int>(BitTorrent::LT::toUnderlyingType(pieceIndex) - (fs.file_offset(fileIndex) / pieceLength));
+                    torrent.set_hash2(fileIndex, lt::piece_index_t::diff_type {filePieceIndex}, job.v2Hashes[i]);
+                }
+#endif
+            }
+
+            progressHandler(job.firstPiece + job.pieceCount);
+            jobs.pop_front();
+            enqueueJobs();
+        }
+    }
+
 #ifdef QBT_USES_LIBTORRENT2
     lt::create_flags_t toNativeTorrentFormatFlag(const BitTorrent::TorrentFormat torrentFormat)
     {
@@ -80,6 +319,137 @@ TorrentCreator::TorrentCreator(const TorrentCreatorParams &params, QObject *pare
     : QObject(parent)
     , m_params {params}
 {
+    if (m_params.reuseExistingPieceHashes)
+        collectPieceHashSources();
+}
+
+void TorrentCreator::collectPieceHashSources()
+{
+    // torrents of the session can only be accessed from the main thread,
+    // so the data needed to match their files is taken in advance
+    for (const Torrent *torrent : Session::instance()->torrentsView())
+    {
+        if (!torrent->hasMetadata() || torrent->isChecking() || torrent->isMoving() || torrent->hasMissingFiles())
+            continue;
+        if ((m_params.pieceSize > 0) && (torrent->pieceLength() != m_params.pieceSize))
+            continue;
+
+        const TorrentInfo info = torrent->info();
+        const QVector<lt::file_index_t> nativeIndexes = info.nativeIndexes();
+        const Path storageLocation = torrent->actualStorageLocation();
+        const PathList filePaths = torrent->actualFilePaths();
+
+        PieceHashSource source;
+        for (int i = 0; i < filePaths.size(); ++i)
+        {
+            const Path filePath = storageLocation / filePaths[i];
+            if ((filePath == m_params.sourcePath) || filePath.hasAncestor(m_params.sourcePath))
+                source.files.insert(filePath, nativeIndexes[i]);
+        }
+        if (source.files.isEmpty())
+            continue;
+
+        source.nativeInfo = info.nativeInfo();
+        source.pieces = torrent->pieces();
+        m_pieceHashSources.append(source);
+    }
+}
+
+// Copies hashes of the pieces whose data is known to be the same as pieces the source torrents have.
+// Returns the pieces all required hashes of which are set.
+std::vector<bool> TorrentCreator::copyKnownPieceHashes(lt::create_torrent &torrent, const Path &basePath, const bool hashV1, const bool hashV2) const
+{
+    const int numPieces = torrent.num_pieces();
+    std::vector<bool> v1Known(numPieces, !hashV1);
+    std::vector<bool> v2Known(numPieces, !hashV2);
+
+    const lt::file_storage &fs = torrent.files();
+    const int pieceLength = torrent.piece_length();
+    const std::string basePathStr = basePath.toString().toStdString();
+    for (const lt::file_index_t fileIndex : fs.file_range())
+    {
+        const std::int64_t fileSize = fs.file_size(fileIndex);
+        if (fs.pad_file_at(fileIndex) || (fileSize == 0))
+            continue;
+
+        const Path filePath {QString::fromStdString(fs.file_path(fileIndex, basePathStr))};
+        const std::int64_t fileOffset = fs.file_offset(fileIndex);
+        for (const PieceHashSource &source : m_pieceHashSources)
+        {
+            const lt::torrent_info &sourceInfo = *source.nativeInfo;
+            const auto iter = source.files.constFind(filePath);
+            if ((iter == source.files.cend()) || (sourceInfo.piece_length() != pieceLength))
+                continue;
+
+            const lt::file_index_t sourceFileIndex = iter.value();
+            const lt::file_storage &sourceFiles = sourceInfo.files();
+            if (sourceFiles.file_size(sourceFileIndex) != fileSize)
+                continue;
+
+            const std::int64_t sourceFileOffset = sourceFiles.file_offset(sourceFileIndex);
+#ifdef QBT_USES_LIBTORRENT2
+            const bool sourceHasV1 = sourceInfo.info_hashes().has_v1();
+#else
+            const bool sourceHasV1 = true;
+#endif
+            // pieces lying entirely within the file have the same data if the file
+            // has the same offset from piece boundaries in both torrents
+            if (hashV1 && sourceHasV1 && (((fileOffset - sourceFileOffset) % pieceLength) == 0))
+            {
+                const auto firstPiece = static_cast<int>((fileOffset + pieceLength - 1) / pieceLength);
+                const auto endPiece = static_cast<int>((fileOffset + fileSize) / pieceLength);
+                const auto pieceShift = static_cast<int>((sourceFileOffset - fileOffset) / pieceLength);
+                for (int piece = firstPiece; piece < endPiece; ++piece)
+                {
+                    const int sourcePiece = piece + pieceShift;
+                    if (v1Known[piece] || !source.pieces.testBit(sourcePiece))
+                        continue;
+
+                    torrent.set_hash(lt::piece_index_t {piece}, sourceInfo.hash_for_piece(lt::piece_index_t {sourcePiece}));
+                    v1Known[piece] = true;
+                }
+            }
+
+#ifdef QBT_USES_LIBTORRENT2
+            // v2 hashes only depend on the file data, so they are taken from the file
+            // piece layer (or from the file root if the file fits into single piece)
+            if (hashV2 && sourceInfo.info_hashes().has_v2())
+            {
+                const auto firstPiece = static_cast<int>(fileOffset / pieceLength);
+                const auto sourceFirstPiece = static_cast<int>(sourceFileOffset / pieceLength);
+                const auto pieceCount = static_cast<int>((fileSize + pieceLength - 1) / pieceLength);
+
+                bool hasAllPieces = true;
+                for (int i = 0; hasAllPieces && (i < pieceCount); ++i)
+                    hasAllPieces = source.pieces.testBit(sourceFirstPiece + i);
+
+                const lt::span<const char> pieceLayer = sourceInfo.piece_layer(sourceFileIndex);
+                const lt::sha256_hash fileRoot = sourceFiles.root(sourceFileIndex);
+                const bool hasHashes = (pieceCount == 1)
+                    ? !fileRoot.is_all_zeros()
+                    : (pieceLayer.size() == (static_cast<std::ptrdiff_t>(pieceCount) * lt::sha256_hash::size()));
+                if (hasAllPieces && hasHashes)
+                {
+                    for (int i = 0; i < pieceCount; ++i)
+                    {
+                        if (v2Known[firstPiece + i])
+                            continue;
+
+                        const lt::sha256_hash pieceHash = (pieceCount == 1)
+                            ? fileRoot : lt::sha256_hash(pieceLayer.data() + (i * lt::sha256_hash::size()));
+                        torrent.set_hash2(fileIndex, lt::piece_index_t::diff_type {i}, pieceHash);
+                        v2Known[firstPiece + i] = true;
+                    }
+                }
+            }
+#endif
+        }
+    }
+
+    std::vector<bool> knownPieces(numPieces);
+    for (int i = 0; i < numPieces; ++i)
+        knownPieces[i] = v1Known[i] && v2Known[i];
+    return knownPieces;
 }
 
 void TorrentCreator::sendProgressSignal(int currentPieceIdx, int totalPieces)
@@ -111,7 +481,6 @@ void TorrentCreator::run()
     try
     {
         const Path parentPath = m_params.sourcePath.parentPath();
-        const Utils::Compare::NaturalLessThan<Qt::CaseInsensitive> naturalLessThan {};
 
         // Adding files to the torrent
         lt::file_storage fs;
@@ -137,7 +506,7 @@ void TorrentCreator::run()
                 const QString filePath = dirIter.next();
                 dirs.append(filePath);
             }
-            std::sort(dirs.begin(), dirs.end(), naturalLessThan);
+            Utils::Compare::naturalSort<Qt::CaseInsensitive>(dirs);
 
             QStringList fileNames;
             QHash<QString, qint64> fileSizeMap;
@@ -161,7 +530,7 @@ void TorrentCreator::run()
                     fileSizeMap[tmpNames.last()] = fileInfo.size();
                 }
 
-                std::sort(tmpNames.begin(), tmpNames.end(), naturalLessThan);
+                Utils::Compare::naturalSort<Qt::CaseInsensitive>(tmpNames);
                 fileNames += tmpNames;
             }
 
@@ -196,11 +565,20 @@ void TorrentCreator::run()
         }
 
         // calculate the hash for all pieces
-        lt::set_piece_hashes(newTorrent, parentPath.toString().toStdString()
-            , [this, &newTorrent](const lt::piece_index_t n)
+#ifdef QBT_USES_LIBTORRENT2
+        const bool hashV1 = (m_params.torrentFormat != TorrentFormat::V2);
+        const bool hashV2 = (m_params.torrentFormat != TorrentFormat::V1);
+#else
+        const bool hashV1 = true;
+        const bool hashV2 = false;
+#endif
+        const std::vector<bool> knownPieces = m_pieceHashSources.isEmpty()
+            ? std::vector<bool>(newTorrent.num_pieces(), false)
+            : copyKnownPieceHashes(newTorrent, parentPath, hashV1, hashV2);
+        setPieceHashes(newTorrent, parentPath, hashV1, hashV2, knownPieces, [this, &newTorrent](const int hashedPieces)
         {
             checkInterruptionRequested();
-            sendProgressSignal(LT::toUnderlyingType(n), newTorrent.num_pieces());
+            sendProgressSignal(hashedPieces, newTorrent.num_pieces());
         });
 
         // Set qBittorrent as creator and add user comment to
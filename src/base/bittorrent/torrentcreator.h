@@ -31,7 +31,14 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
+#include <vector>
 
+#include <libtorrent/fwd.hpp>
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QStringList>
@@ -65,6 +72,8 @@ namespace BitTorrent
         QString source;
         QStringList trackers;
         QStringList urlSeeds;
+        // copy piece hashes of unchanged files from the torrents of the session instead of hashing them
+        bool reuseExistingPieceHashes = false;
     };
 
     struct TorrentCreatorResult
@@ -104,10 +113,22 @@ namespace BitTorrent
         void progressUpdated(int progress);
 
     private:
+        // snapshot of a torrent of the session having some of the source files
+        struct PieceHashSource
+        {
+            std::shared_ptr<const lt::torrent_info> nativeInfo;
+            // absolute paths of the source files contained by the torrent
+            QHash<Path, lt::file_index_t> files;
+            QBitArray pieces;
+        };
+
         void sendProgressSignal(int currentPieceIdx, int totalPieces);
         void checkInterruptionRequested() const;
+        void collectPieceHashSources();
+        std::vector<bool> copyKnownPieceHashes(lt::create_torrent &torrent, const Path &basePath, bool hashV1, bool hashV2) const;
 
         TorrentCreatorParams m_params;
+        QList<PieceHashSource> m_pieceHashSources;
         std::atomic_bool m_interruptionRequested;
     };
 }
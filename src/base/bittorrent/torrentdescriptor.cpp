@@ -35,7 +35,10 @@
 #include <libtorrent/write_resume_data.hpp>
 
 #include <QByteArray>
+#include <QList>
 #include <QRegularExpression>
+#include <QSemaphore>
+#include <QThreadPool>
 #include <QUrl>
 
 #include "base/global.h"
@@ -98,6 +101,32 @@ catch (const lt::system_error &err)
     return nonstd::make_unexpected(QString::fromLocal8Bit(err.what()));
 }
 
+QList<nonstd::expected<BitTorrent::TorrentDescriptor, QString>>
+BitTorrent::TorrentDescriptor::loadAll(const QList<QByteArray> &data)
+{
+    QList<nonstd::expected<TorrentDescriptor, QString>> results;
+    results.resize(data.size());
+    if (data.size() == 1)
+    {
+        results[0] = load(data[0]);
+        return results;
+    }
+
+    nonstd::expected<TorrentDescriptor, QString> *resultsData = results.data();
+    QSemaphore loadedCount;
+    for (qsizetype i = 0; i < data.size(); ++i)
+    {
+        QThreadPool::globalInstance()->start([&data, &loadedCount, resultsData, i]
+        {
+            resultsData[i] = load(data[i]);
+            loadedCount.release();
+        });
+    }
+    loadedCount.acquire(data.size());
+
+    return results;
+}
+
 nonstd::expected<BitTorrent::TorrentDescriptor, QString>
 BitTorrent::TorrentDescriptor::loadFromFile(const Path &path) noexcept
 try
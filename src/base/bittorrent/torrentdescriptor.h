@@ -69,6 +69,8 @@ namespace BitTorrent
         static nonstd::expected<TorrentDescriptor, QString> load(const QByteArray &data) noexcept;
         static nonstd::expected<TorrentDescriptor, QString> loadFromFile(const Path &path) noexcept;
         static nonstd::expected<TorrentDescriptor, QString> parse(const QString &str) noexcept;
+        // Loads the data using global thread pool, results are in the same order as the data
+        static QList<nonstd::expected<TorrentDescriptor, QString>> loadAll(const QList<QByteArray> &data);
         nonstd::expected<void, QString> saveToFile(const Path &path) const;
 
         const lt::add_torrent_params &ltAddTorrentParams() const;
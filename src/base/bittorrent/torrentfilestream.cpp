@@ -0,0 +1,186 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentfilestream.h"
+
+#include <algorithm>
+
+#include "base/global.h"
+#include "session.h"
+#include "torrent.h"
+#include "torrentinfo.h"
+
+namespace
+{
+    const qint64 READ_AHEAD_SIZE = 16 * 1024 * 1024;
+    const int MIN_READ_AHEAD_PIECES = 2;
+    // deadline of the piece at read position, the following ones get it increased by the step
+    const int FIRST_PIECE_DEADLINE = 0;
+    const int PIECE_DEADLINE_STEP = 250;
+}
+
+using namespace BitTorrent;
+
+TorrentFileStream::TorrentFileStream(Session *session, const Torrent *torrent, const int fileIndex
+        , const qint64 offset, const qint64 size, QObject *parent)
+    : QObject(parent)
+    , m_session {session}
+    , m_torrentID {torrent->id()}
+    , m_pieceLength {torrent->pieceLength()}
+{
+    Q_ASSERT(torrent->hasMetadata());
+    Q_ASSERT((fileIndex >= 0) && (fileIndex < torrent->filesCount()));
+    Q_ASSERT((offset >= 0) && ((offset + size) <= torrent->fileSize(fileIndex)));
+
+    const qint64 fileOffset = torrent->info().fileOffset(fileIndex);
+    m_position = fileOffset + offset;
+    m_end = m_position + size;
+    m_readAheadPieces = std::max<int>(MIN_READ_AHEAD_PIECES, (READ_AHEAD_SIZE / m_pieceLength));
+
+    connect(m_session, &Session::torrentPieceRead, this, &TorrentFileStream::handlePieceRead);
+    connect(m_session, &Session::torrentAboutToBeRemoved, this, &TorrentFileStream::handleTorrentAboutToBeRemoved);
+
+    updateReadAheadWindow();
+}
+
+TorrentFileStream::~TorrentFileStream()
+{
+    // the pieces nobody waits for anymore are downloaded as usual
+    Torrent *torrent = m_session->getTorrent(m_torrentID);
+    if (!torrent)
+        return;
+
+    for (const int pieceIndex : asConst(m_requestedPieces))
+        torrent->resetPieceDeadline(pieceIndex);
+}
+
+bool TorrentFileStream::atEnd() const
+{
+    return (m_position >= m_end);
+}
+
+qint64 TorrentFileStream::bytesLeft() const
+{
+    return (m_end - m_position);
+}
+
+QByteArray TorrentFileStream::read(const qint64 maxSize)
+{
+    QByteArray result;
+    while (!atEnd() && (result.size() < maxSize))
+    {
+        const int pieceIndex = pieceAt(m_position);
+        const auto pieceIter = m_pieces.constFind(pieceIndex);
+        if (pieceIter == m_pieces.cend())
+            break;
+
+        const QByteArray &pieceData = pieceIter.value();
+        const qint64 offsetInPiece = m_position - (pieceIndex * m_pieceLength);
+        const qint64 chunkSize = std::min({(pieceData.size() - offsetInPiece), (m_end - m_position), (maxSize - result.size())});
+        if (chunkSize <= 0) [[unlikely]]
+        {
+            emit failed(tr("Piece data is incomplete. Piece: %1").arg(pieceIndex));
+            return {};
+        }
+
+        result.append(pieceData.sliced(offsetInPiece, chunkSize));
+        m_position += chunkSize;
+
+        if ((offsetInPiece + chunkSize) >= pieceData.size())
+            m_pieces.remove(pieceIndex);
+    }
+
+    if (!result.isEmpty())
+        updateReadAheadWindow();
+
+    return result;
+}
+
+int TorrentFileStream::pieceAt(const qint64 torrentOffset) const
+{
+    return static_cast<int>(torrentOffset / m_pieceLength);
+}
+
+void TorrentFileStream::updateReadAheadWindow()
+{
+    Torrent *torrent = m_session->getTorrent(m_torrentID);
+    if (!torrent || atEnd())
+        return;
+
+    const int firstPiece = pieceAt(m_position);
+    const int lastPiece = std::min((firstPiece + m_readAheadPieces - 1), pieceAt(m_end - 1));
+
+    // pieces left behind were read already, so they can only be the ones requested before a seek
+    for (auto it = m_requestedPieces.begin(); it != m_requestedPieces.end();)
+    {
+        if (*it < firstPiece)
+        {
+            torrent->resetPieceDeadline(*it);
+            it = m_requestedPieces.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (int pieceIndex = firstPiece; pieceIndex <= lastPiece; ++pieceIndex)
+    {
+        if (m_pieces.contains(pieceIndex) || m_requestedPieces.contains(pieceIndex))
+            continue;
+
+        const int deadline = FIRST_PIECE_DEADLINE + ((pieceIndex - firstPiece) * PIECE_DEADLINE_STEP);
+        torrent->setPieceDeadline(pieceIndex, deadline);
+        m_requestedPieces.insert(pieceIndex);
+    }
+}
+
+void TorrentFileStream::handlePieceRead(Torrent *torrent, const int pieceIndex, const QByteArray &data)
+{
+    if ((torrent->id() != m_torrentID) || !m_requestedPieces.remove(pieceIndex))
+        return;
+
+    if (data.isEmpty())
+    {
+        emit failed(tr("Couldn't read piece %1").arg(pieceIndex));
+        return;
+    }
+
+    m_pieces.insert(pieceIndex, data);
+    if (pieceIndex == pieceAt(m_position))
+        emit readyRead();
+}
+
+void TorrentFileStream::handleTorrentAboutToBeRemoved(Torrent *torrent)
+{
+    if (torrent->id() != m_torrentID)
+        return;
+
+    m_requestedPieces.clear();
+    emit failed(tr("Torrent is removed"));
+}
@@ -0,0 +1,85 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    class Session;
+    class Torrent;
+
+    // Reads a byte range of torrent file while the torrent is being downloaded.
+    // The pieces of sliding window ahead of the read position are requested with
+    // increasing deadlines, so they are downloaded in order even if the rest of
+    // the torrent isn't. The data of each piece is kept until it is read.
+    class TorrentFileStream final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(TorrentFileStream)
+
+    public:
+        // streams `size` bytes of the file starting at `offset` within it
+        TorrentFileStream(Session *session, const Torrent *torrent, int fileIndex
+                , qint64 offset, qint64 size, QObject *parent = nullptr);
+        ~TorrentFileStream() override;
+
+        bool atEnd() const;
+        qint64 bytesLeft() const;
+
+        // Returns up to `maxSize` bytes available at the read position, the data
+        // is empty if the piece at the read position isn't available yet
+        QByteArray read(qint64 maxSize);
+
+    signals:
+        void readyRead();
+        void failed(const QString &errorMessage);
+
+    private:
+        int pieceAt(qint64 torrentOffset) const;
+        void updateReadAheadWindow();
+        void handlePieceRead(Torrent *torrent, int pieceIndex, const QByteArray &data);
+        void handleTorrentAboutToBeRemoved(Torrent *torrent);
+
+        Session *m_session = nullptr;
+        TorrentID m_torrentID;
+        qint64 m_pieceLength = 0;
+        int m_readAheadPieces = 0;
+        // offsets within the torrent
+        qint64 m_position = 0;
+        qint64 m_end = 0;
+        QSet<int> m_requestedPieces;
+        QHash<int, QByteArray> m_pieces;
+    };
+}
@@ -30,7 +30,10 @@
 #include "torrentimpl.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <memory>
+#include <utility>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -59,6 +62,7 @@
 #include "base/exceptions.h"
 #include "base/global.h"
 #include "base/logger.h"
+#include "base/memoryusage.h"
 #include "base/preferences.h"
 #include "base/types.h"
 #include "base/utils/fs.h"
@@ -215,6 +219,8 @@ namespace
             if (numUpdating > 0)
             {
                 trackerEntryStatus.state = TrackerEndpointState::Updating;
+                // scheduled announce is being sent
+                trackerEntryStatus.scheduledAnnounceTime = {};
             }
             else if (numWorking > 0)
             {
@@ -285,6 +291,72 @@ namespace
     {
         return ((value < 0) || (value == std::numeric_limits<int>::max())) ? 0 : value;
     }
+
+    int effectiveLimitValue(const int limit, const int share)
+    {
+        if ((limit > 0) && (share > 0))
+            return std::min(limit, share);
+        return std::max(limit, share);
+    }
+
+    QVector<PeerInfo> queryPeerInfo(const lt::torrent_handle &nativeHandle, const QBitArray &allPieces)
+    {
+        try
+        {
+            std::vector<lt::peer_info> nativePeers;
+            nativeHandle.get_peer_info(nativePeers);
+
+            // the pieces missing locally are the same for every peer so they are only computed once
+            const QBitArray missingPieces = ~allPieces;
+            const int missingPiecesCount = missingPieces.count(true);
+
+            QVector<PeerInfo> peers;
+            peers.reserve(static_cast<decltype(peers)::size_type>(nativePeers.size()));
+            for (const lt::peer_info &peer : nativePeers)
+                peers.append(PeerInfo(peer, missingPieces, missingPiecesCount));
+            return peers;
+        }
+        catch (const std::exception &) {}
+
+        return {};
+    }
+
+    nonstd::expected<lt::entry, QString> generateTorrentFile([[maybe_unused]] const lt::torrent_handle &nativeHandle
+            , const std::shared_ptr<lt::torrent_info> &nativeInfo, const QVector<TrackerEntryStatus> &trackers)
+    {
+        try
+        {
+#ifdef QBT_USES_LIBTORRENT2
+            const std::shared_ptr<lt::torrent_info> completeTorrentInfo = nativeHandle.torrent_file_with_hashes();
+            const std::shared_ptr<lt::torrent_info> torrentInfo = (completeTorrentInfo ? completeTorrentInfo : nativeInfo);
+#else
+            const std::shared_ptr<lt::torrent_info> torrentInfo = nativeInfo;
+#endif
+            lt::create_torrent creator {*torrentInfo};
+
+            for (const TrackerEntryStatus &status : trackers)
+                creator.add_tracker(status.url.toStdString(), status.tier);
+
+            return creator.generate();
+        }
+        catch (const lt::system_error &err)
+        {
+            return nonstd::make_unexpected(QString::fromLocal8Bit(err.what()));
+        }
+    }
+
+    QByteArray bencodeTorrentFile(const lt::entry &torrentFile)
+    {
+        // usually torrent size should be smaller than 1 MB,
+        // however there are >100 MB v2/hybrid torrent files out in the wild
+        QByteArray buffer;
+        buffer.reserve(1024 * 1024);
+        lt::bencode(std::back_inserter(buffer), torrentFile);
+        return buffer;
+    }
+
+    // revisions are shared by all the torrents, so the re-added torrent doesn't repeat the revisions of the removed one
+    quint64 lastStatusRevision = 0;
 }
 
 // TorrentImpl
@@ -320,6 +392,9 @@ TorrentImpl::TorrentImpl(SessionImpl *session, lt::session *nativeSession
     , m_downloadLimit(cleanLimitValue(m_ltAddTorrentParams.download_limit))
     , m_uploadLimit(cleanLimitValue(m_ltAddTorrentParams.upload_limit))
 {
+    for (const Tag &tag : asConst(m_tags))
+        setTagBit(m_session->internTag(tag), true);
+
     if (m_ltAddTorrentParams.ti)
     {
         if (const std::time_t creationDate = m_ltAddTorrentParams.ti->creation_date(); creationDate > 0)
@@ -342,7 +417,7 @@ TorrentImpl::TorrentImpl(SessionImpl *session, lt::session *nativeSession
                         , LT::toNative(m_ltAddTorrentParams.file_priorities.empty() ? DownloadPriority::Normal : DownloadPriority::Ignored));
 
         m_completedFiles.fill(static_cast<bool>(m_ltAddTorrentParams.flags & lt::torrent_flags::seed_mode), filesCount);
-        m_filesProgress.resize(filesCount);
+        resetFilesProgress();
 
         for (int i = 0; i < filesCount; ++i)
         {
@@ -364,11 +439,13 @@ TorrentImpl::TorrentImpl(SessionImpl *session, lt::session *nativeSession
     const auto *extensionData = static_cast<ExtensionData *>(m_ltAddTorrentParams.userdata);
     m_trackerEntryStatuses.reserve(static_cast<decltype(m_trackerEntryStatuses)::size_type>(extensionData->trackers.size()));
     for (const lt::announce_entry &announceEntry : extensionData->trackers)
-        m_trackerEntryStatuses.append({QString::fromStdString(announceEntry.url), announceEntry.tier});
+        m_trackerEntryStatuses.append({m_session->internTrackerURL(QString::fromStdString(announceEntry.url)), announceEntry.tier});
     m_urlSeeds.reserve(static_cast<decltype(m_urlSeeds)::size_type>(extensionData->urlSeeds.size()));
     for (const std::string &urlSeed : extensionData->urlSeeds)
         m_urlSeeds.append(QString::fromStdString(urlSeed));
     m_nativeStatus = extensionData->status;
+    m_peerStats = extensionData->peerStats;
+    m_storedResumeDataCounters = resumeDataCounters();
 
     m_addedTime = QDateTime::fromSecsSinceEpoch(m_nativeStatus.added_time);
     if (m_nativeStatus.completed_time > 0)
@@ -383,6 +460,8 @@ TorrentImpl::TorrentImpl(SessionImpl *session, lt::session *nativeSession
 
     if (hasMetadata())
         applyFirstLastPiecePriority(m_hasFirstLastPiecePriority);
+
+    m_statusRevision = ++lastStatusRevision;
 }
 
 TorrentImpl::~TorrentImpl() = default;
@@ -648,7 +727,7 @@ void TorrentImpl::addTrackers(QVector<TrackerEntry> trackers)
     for (const TrackerEntry &tracker : asConst(trackers))
     {
         m_nativeHandle.add_tracker(makeNativeAnnounceEntry(tracker.url, tracker.tier));
-        m_trackerEntryStatuses.append({tracker.url, tracker.tier});
+        m_trackerEntryStatuses.append({m_session->internTrackerURL(tracker.url), tracker.tier});
     }
     std::sort(m_trackerEntryStatuses.begin(), m_trackerEntryStatuses.end()
         , [](const TrackerEntryStatus &left, const TrackerEntryStatus &right) { return left.tier < right.tier; });
@@ -697,7 +776,7 @@ void TorrentImpl::replaceTrackers(QVector<TrackerEntry> trackers)
     for (const TrackerEntry &tracker : trackers)
     {
         nativeTrackers.emplace_back(makeNativeAnnounceEntry(tracker.url, tracker.tier));
-        m_trackerEntryStatuses.append({tracker.url, tracker.tier});
+        m_trackerEntryStatuses.append({m_session->internTrackerURL(tracker.url), tracker.tier});
     }
 
     m_nativeHandle.replace_trackers(nativeTrackers);
@@ -836,16 +915,60 @@ bool TorrentImpl::needSaveResumeData() const
     return m_nativeStatus.need_save_resume;
 }
 
+ResumeDataCounters TorrentImpl::resumeDataCounters() const
+{
+    return
+    {
+        .totalUploaded = m_nativeStatus.all_time_upload,
+        .totalDownloaded = m_nativeStatus.all_time_download,
+        .activeTime = lt::total_seconds(m_nativeStatus.active_duration),
+        .finishedTime = lt::total_seconds(m_nativeStatus.finished_duration),
+        .seedingTime = lt::total_seconds(m_nativeStatus.seeding_duration),
+        .lastSeenComplete = m_nativeStatus.last_seen_complete,
+        .numComplete = m_nativeStatus.num_complete,
+        .numIncomplete = m_nativeStatus.num_incomplete
+    };
+}
+
+bool TorrentImpl::isResumeDataCountersChanged() const
+{
+    return (resumeDataCounters() != m_storedResumeDataCounters);
+}
+
+bool TorrentImpl::hasUnsavedResumeDataProgress() const
+{
+    return m_hasUnsavedResumeDataProgress;
+}
+
+int TorrentImpl::resumeDataCountersSaveCount() const
+{
+    return m_resumeDataCountersSaveCount;
+}
+
+void TorrentImpl::handleResumeDataCountersStored(const ResumeDataCounters &counters)
+{
+    m_storedResumeDataCounters = counters;
+    ++m_resumeDataCountersSaveCount;
+}
+
 void TorrentImpl::requestResumeData(const lt::resume_data_flags_t flags)
 {
     m_nativeHandle.save_resume_data(flags);
     m_deferredRequestResumeDataInvoked = false;
 
+    // generated resume data includes everything changed so far
+    m_storedResumeDataCounters = resumeDataCounters();
+    m_resumeDataCountersSaveCount = 0;
+    m_hasUnsavedResumeDataProgress = false;
+
     m_session->handleTorrentResumeDataRequested(this);
 }
 
 void TorrentImpl::deferredRequestResumeData()
 {
+    // every property which is changed by application is stored in resume data
+    markStatusFieldsChanged(TorrentStatusField::Properties);
+
     if (!m_deferredRequestResumeDataInvoked)
     {
         QMetaObject::invokeMethod(this, [this]
@@ -908,17 +1031,20 @@ bool TorrentImpl::belongsToCategory(const QString &category) const
     if (m_category == category)
         return true;
 
-    return (m_session->isSubcategoriesEnabled() && m_category.startsWith(category + u'/'));
+    // check for subcategory without constructing "category/" string
+    return (m_session->isSubcategoriesEnabled() && (m_category.size() > category.size())
+            && (m_category.at(category.size()) == u'/') && m_category.startsWith(category));
 }
 
-TagSet TorrentImpl::tags() const
+const TagSet &TorrentImpl::tags() const
 {
     return m_tags;
 }
 
 bool TorrentImpl::hasTag(const Tag &tag) const
 {
-    return m_tags.contains(tag);
+    const int tagIndex = m_session->tagIndex(tag);
+    return (tagIndex >= 0) && (tagIndex < m_tagBits.size()) && m_tagBits.testBit(tagIndex);
 }
 
 bool TorrentImpl::addTag(const Tag &tag)
@@ -934,6 +1060,7 @@ bool TorrentImpl::addTag(const Tag &tag)
             return false;
     }
     m_tags.insert(tag);
+    setTagBit(m_session->internTag(tag), true);
     deferredRequestResumeData();
     m_session->handleTorrentTagAdded(this, tag);
     return true;
@@ -943,6 +1070,7 @@ bool TorrentImpl::removeTag(const Tag &tag)
 {
     if (m_tags.remove(tag))
     {
+        setTagBit(m_session->tagIndex(tag), false);
         deferredRequestResumeData();
         m_session->handleTorrentTagRemoved(this, tag);
         return true;
@@ -952,10 +1080,25 @@ bool TorrentImpl::removeTag(const Tag &tag)
 
 void TorrentImpl::removeAllTags()
 {
-    for (const Tag &tag : asConst(tags()))
+    const TagSet tags = m_tags;
+    for (const Tag &tag : tags)
         removeTag(tag);
 }
 
+void TorrentImpl::setTagBit(const int tagIndex, const bool value)
+{
+    if (tagIndex < 0)
+        return;
+
+    if (tagIndex >= m_tagBits.size())
+    {
+        if (!value)
+            return;
+        m_tagBits.resize(tagIndex + 1);
+    }
+    m_tagBits.setBit(tagIndex, value);
+}
+
 QDateTime TorrentImpl::addedTime() const
 {
     return m_addedTime;
@@ -1160,25 +1303,7 @@ bool TorrentImpl::isCompleted() const
 
 bool TorrentImpl::isActive() const
 {
-    switch (m_state)
-    {
-    case TorrentState::StalledDownloading:
-        return (uploadPayloadRate() > 0);
-
-    case TorrentState::DownloadingMetadata:
-    case TorrentState::ForcedDownloadingMetadata:
-    case TorrentState::Downloading:
-    case TorrentState::ForcedDownloading:
-    case TorrentState::Uploading:
-    case TorrentState::ForcedUploading:
-    case TorrentState::Moving:
-        return true;
-
-    default:
-        break;
-    };
-
-    return false;
+    return m_derivedStatus.isActive;
 }
 
 bool TorrentImpl::isInactive() const
@@ -1276,6 +1401,96 @@ void TorrentImpl::updateState()
         else
             m_state = TorrentState::StalledDownloading;
     }
+
+    updateDerivedStatus();
+}
+
+void TorrentImpl::updateDerivedStatus()
+{
+    switch (m_state)
+    {
+    case TorrentState::StalledDownloading:
+        m_derivedStatus.isActive = (uploadPayloadRate() > 0);
+        break;
+
+    case TorrentState::DownloadingMetadata:
+    case TorrentState::ForcedDownloadingMetadata:
+    case TorrentState::Downloading:
+    case TorrentState::ForcedDownloading:
+    case TorrentState::Uploading:
+    case TorrentState::ForcedUploading:
+    case TorrentState::Moving:
+        m_derivedStatus.isActive = true;
+        break;
+
+    default:
+        m_derivedStatus.isActive = false;
+        break;
+    };
+
+    const int64_t upload = m_nativeStatus.all_time_upload;
+    const int64_t download = ratioDownloadedBytes();
+    if (download == 0)
+    {
+        m_derivedStatus.realRatio = (upload == 0) ? 0 : MAX_RATIO;
+    }
+    else
+    {
+        const qreal ratio = upload / static_cast<qreal>(download);
+        Q_ASSERT(ratio >= 0);
+        m_derivedStatus.realRatio = (ratio > MAX_RATIO) ? MAX_RATIO : ratio;
+    }
+
+    m_derivedStatus.eta = MAX_ETA;
+    m_derivedStatus.etaDeadline.reset();
+
+    const SpeedSampleAvg speedAverage = m_payloadRateMonitor.average();
+
+    if (!isFinished())
+    {
+        if (speedAverage.download > 0)
+            m_derivedStatus.eta = (wantedSize() - completedSize()) / speedAverage.download;
+        return;
+    }
+
+    const qreal maxRatioValue = maxRatio();
+    const int maxSeedingTimeValue = maxSeedingTime();
+    const int maxInactiveSeedingTimeValue = maxInactiveSeedingTime();
+
+    if ((speedAverage.upload > 0) && (maxRatioValue >= 0))
+    {
+        qlonglong realDL = totalDownload();
+        if (realDL <= 0)
+            realDL = wantedSize();
+
+        m_derivedStatus.eta = ((realDL * maxRatioValue) - totalUpload()) / speedAverage.upload;
+    }
+
+    // seeding time only goes on while torrent is running and inactivity time
+    // only once there was some activity, otherwise corresponding ETA stays the same
+    qlonglong timeLimitEta = MAX_ETA;
+
+    if (maxSeedingTimeValue >= 0)
+    {
+        const qlonglong seedingTimeEta = std::max<qlonglong>(((maxSeedingTimeValue * 60) - finishedTime()), 0);
+        if (m_nativeStatus.flags & lt::torrent_flags::paused)
+            m_derivedStatus.eta = std::min(m_derivedStatus.eta, seedingTimeEta);
+        else
+            timeLimitEta = std::min(timeLimitEta, seedingTimeEta);
+    }
+
+    if (maxInactiveSeedingTimeValue >= 0)
+    {
+        const qlonglong inactiveTime = timeSinceActivity();
+        const qlonglong inactiveSeedingTimeEta = std::max<qlonglong>(((maxInactiveSeedingTimeValue * 60) - inactiveTime), 0);
+        if (inactiveTime < 0)
+            m_derivedStatus.eta = std::min(m_derivedStatus.eta, inactiveSeedingTimeEta);
+        else
+            timeLimitEta = std::min(timeLimitEta, inactiveSeedingTimeEta);
+    }
+
+    if (timeLimitEta < MAX_ETA)
+        m_derivedStatus.etaDeadline = lt::clock_type::now() + std::chrono::seconds(timeLimitEta);
 }
 
 bool TorrentImpl::hasMetadata() const
@@ -1326,50 +1541,11 @@ qlonglong TorrentImpl::eta() const
 {
     if (isStopped()) return MAX_ETA;
 
-    const SpeedSampleAvg speedAverage = m_payloadRateMonitor.average();
-
-    if (isFinished())
-    {
-        const qreal maxRatioValue = maxRatio();
-        const int maxSeedingTimeValue = maxSeedingTime();
-        const int maxInactiveSeedingTimeValue = maxInactiveSeedingTime();
-        if ((maxRatioValue < 0) && (maxSeedingTimeValue < 0) && (maxInactiveSeedingTimeValue < 0)) return MAX_ETA;
-
-        qlonglong ratioEta = MAX_ETA;
-
-        if ((speedAverage.upload > 0) && (maxRatioValue >= 0))
-        {
-
-            qlonglong realDL = totalDownload();
-            if (realDL <= 0)
-                realDL = wantedSize();
-
-            ratioEta = ((realDL * maxRatioValue) - totalUpload()) / speedAverage.upload;
-        }
-
-        qlonglong seedingTimeEta = MAX_ETA;
-
-        if (maxSeedingTimeValue >= 0)
-        {
-            seedingTimeEta = (maxSeedingTimeValue * 60) - finishedTime();
-            if (seedingTimeEta < 0)
-                seedingTimeEta = 0;
-        }
-
-        qlonglong inactiveSeedingTimeEta = MAX_ETA;
-
-        if (maxInactiveSeedingTimeValue >= 0)
-        {
-            inactiveSeedingTimeEta = (maxInactiveSeedingTimeValue * 60) - timeSinceActivity();
-            inactiveSeedingTimeEta = std::max<qlonglong>(inactiveSeedingTimeEta, 0);
-        }
+    if (!m_derivedStatus.etaDeadline)
+        return m_derivedStatus.eta;
 
-        return std::min({ratioEta, seedingTimeEta, inactiveSeedingTimeEta});
-    }
-
-    if (!speedAverage.download) return MAX_ETA;
-
-    return (wantedSize() - completedSize()) / speedAverage.download;
+    const qlonglong timeLimitEta = std::max<qlonglong>(lt::total_seconds(*m_derivedStatus.etaDeadline - lt::clock_type::now()), 0);
+    return std::min(m_derivedStatus.eta, timeLimitEta);
 }
 
 QVector<qreal> TorrentImpl::filesProgress() const
@@ -1377,27 +1553,12 @@ QVector<qreal> TorrentImpl::filesProgress() const
     if (!hasMetadata())
         return {};
 
-    const int count = m_filesProgress.size();
-    Q_ASSERT(count == filesCount());
-    if (count != filesCount()) [[unlikely]]
+    Q_ASSERT(m_filesProgressFractions.size() == filesCount());
+    if (m_filesProgressFractions.size() != filesCount()) [[unlikely]]
         return {};
 
-    if (m_completedFiles.count(true) == count)
-        return QVector<qreal>(count, 1);
-
-    QVector<qreal> result;
-    result.reserve(count);
-    for (int i = 0; i < count; ++i)
-    {
-        const int64_t progress = m_filesProgress.at(i);
-        const int64_t size = fileSize(i);
-        if ((size <= 0) || (progress == size))
-            result << 1;
-        else
-            result << (progress / static_cast<qreal>(size));
-    }
-
-    return result;
+    // it is kept up to date as pieces are finished, so it is just shared with the caller
+    return m_filesProgressFractions;
 }
 
 int TorrentImpl::seedsCount() const
@@ -1463,16 +1624,18 @@ bool TorrentImpl::isLSDDisabled() const
 
 QVector<PeerInfo> TorrentImpl::peers() const
 {
-    std::vector<lt::peer_info> nativePeers;
-    m_nativeHandle.get_peer_info(nativePeers);
-
-    QVector<PeerInfo> peers;
-    peers.reserve(static_cast<decltype(peers)::size_type>(nativePeers.size()));
-
-    for (const lt::peer_info &peer : nativePeers)
-        peers.append(PeerInfo(peer, pieces()));
+    if (!m_peerInfoSnapshotTimer.isValid())
+    {
+        // there is no snapshot yet so it has to be queried right away
+        m_peerInfoSnapshot = queryPeerInfo(m_nativeHandle, pieces());
+        m_peerInfoSnapshotTimer.start();
+    }
+    else if (m_peerInfoSnapshotTimer.hasExpired(m_session->refreshInterval()))
+    {
+        requestPeerInfo();
+    }
 
-    return peers;
+    return m_peerInfoSnapshot;
 }
 
 QBitArray TorrentImpl::pieces() const
@@ -1532,20 +1695,31 @@ int TorrentImpl::maxInactiveSeedingTime() const
     return m_inactiveSeedingTimeLimit;
 }
 
-qreal TorrentImpl::realRatio() const
+qint64 TorrentImpl::ratioDownloadedBytes() const
 {
-    const int64_t upload = m_nativeStatus.all_time_upload;
     // special case for a seeder who lost its stats, also assume nobody will import a 99% done torrent
-    const int64_t download = (m_nativeStatus.all_time_download < (m_nativeStatus.total_done * 0.01))
+    return (m_nativeStatus.all_time_download < (m_nativeStatus.total_done * 0.01))
         ? m_nativeStatus.total_done
         : m_nativeStatus.all_time_download;
+}
 
-    if (download == 0)
-        return (upload == 0) ? 0 : MAX_RATIO;
+qreal TorrentImpl::realRatio() const
+{
+    return m_derivedStatus.realRatio;
+}
 
-    const qreal ratio = upload / static_cast<qreal>(download);
-    Q_ASSERT(ratio >= 0);
-    return (ratio > MAX_RATIO) ? MAX_RATIO : ratio;
+qlonglong TorrentImpl::timeToReachRatio(const qreal ratio) const
+{
+    if (realRatio() >= ratio)
+        return 0;
+
+    const int rate = uploadPayloadRate();
+    const qint64 download = ratioDownloadedBytes();
+    if ((rate <= 0) || (download == 0))
+        return -1;
+
+    const qreal bytesLeft = (ratio * download) - m_nativeStatus.all_time_upload;
+    return static_cast<qlonglong>(std::ceil(bytesLeft / rate));
 }
 
 int TorrentImpl::uploadPayloadRate() const
@@ -1560,6 +1734,11 @@ int TorrentImpl::downloadPayloadRate() const
     return isStopped() ? 0 : m_nativeStatus.download_payload_rate;
 }
 
+QList<SpeedSample> TorrentImpl::payloadRateHistory(const SpeedHistory::Period period, const qint64 timestamp) const
+{
+    return m_payloadRateHistory.samples(period, timestamp);
+}
+
 qlonglong TorrentImpl::totalPayloadUpload() const
 {
     return m_nativeStatus.total_payload_upload;
@@ -1580,11 +1759,36 @@ int TorrentImpl::connectionsLimit() const
     return m_nativeStatus.connections_limit;
 }
 
+int TorrentImpl::connectionsBudget() const
+{
+    return m_connectionsBudget;
+}
+
+void TorrentImpl::setConnectionsBudget(const int budget)
+{
+    if (budget == m_connectionsBudget)
+        return;
+
+    m_connectionsBudget = budget;
+    m_nativeHandle.set_max_connections((m_connectionsBudget > 0) ? m_connectionsBudget : m_session->maxConnectionsPerTorrent());
+}
+
 qlonglong TorrentImpl::nextAnnounce() const
 {
     return lt::total_seconds(m_nativeStatus.next_announce);
 }
 
+quint64 TorrentImpl::statusRevision() const
+{
+    return m_statusRevision;
+}
+
+void TorrentImpl::markStatusFieldsChanged(const TorrentStatusFields fields)
+{
+    m_changedStatusFields |= fields;
+    m_statusRevision = ++lastStatusRevision;
+}
+
 qreal TorrentImpl::popularity() const
 {
     // in order to produce floating-point numbers using `std::chrono::duration_cast`,
@@ -1630,7 +1834,7 @@ bool TorrentImpl::setCategory(const QString &category)
 
 void TorrentImpl::forceReannounce(const int index)
 {
-    m_nativeHandle.force_reannounce(0, index);
+    m_session->handleTorrentReannounceRequested(this, index);
 }
 
 void TorrentImpl::forceDHTAnnounce()
@@ -1654,7 +1858,7 @@ void TorrentImpl::forceRecheck()
     m_ltAddTorrentParams.verified_pieces.clear();
     m_ltAddTorrentParams.unfinished_pieces.clear();
     m_completedFiles.fill(false);
-    m_filesProgress.fill(0);
+    resetFilesProgress();
     m_pieces.fill(false);
     m_unchecked = false;
 
@@ -1708,6 +1912,22 @@ void TorrentImpl::setFirstLastPiecePriority(const bool enabled)
     deferredRequestResumeData();
 }
 
+void TorrentImpl::setPieceDeadline(const int pieceIndex, const int deadline)
+{
+    if (!hasMetadata() || (pieceIndex < 0) || (pieceIndex >= piecesCount()))
+        return;
+
+    m_nativeHandle.set_piece_deadline(lt::piece_index_t {pieceIndex}, deadline, lt::torrent_handle::alert_when_available);
+}
+
+void TorrentImpl::resetPieceDeadline(const int pieceIndex)
+{
+    if (!hasMetadata() || (pieceIndex < 0) || (pieceIndex >= piecesCount()))
+        return;
+
+    m_nativeHandle.reset_piece_deadline(lt::piece_index_t {pieceIndex});
+}
+
 void TorrentImpl::applyFirstLastPiecePriority(const bool enabled)
 {
     Q_ASSERT(hasMetadata());
@@ -1783,6 +2003,17 @@ TrackerEntryStatus TorrentImpl::updateTrackerEntryStatus(const lt::announce_entr
     return *it;
 }
 
+TrackerEntryStatus TorrentImpl::scheduleTrackerEntryAnnounce(const int index, const QDateTime &announceTime)
+{
+    Q_ASSERT((index >= 0) && (index < m_trackerEntryStatuses.size()));
+    if ((index < 0) || (index >= m_trackerEntryStatuses.size())) [[unlikely]]
+        return {};
+
+    TrackerEntryStatus &status = m_trackerEntryStatuses[index];
+    status.scheduledAnnounceTime = announceTime;
+    return status;
+}
+
 void TorrentImpl::resetTrackerEntryStatuses()
 {
     for (TrackerEntryStatus &status : m_trackerEntryStatuses)
@@ -1823,7 +2054,7 @@ void TorrentImpl::endReceivedMetadataHandling(const Path &savePath, const PathLi
             , LT::toNative(p.file_priorities.empty() ? DownloadPriority::Normal : DownloadPriority::Ignored));
 
     m_completedFiles.fill(static_cast<bool>(p.flags & lt::torrent_flags::seed_mode), filesCount());
-    m_filesProgress.resize(filesCount());
+    resetFilesProgress();
     updateProgress();
 
     for (int i = 0; i < fileNames.size(); ++i)
@@ -1857,6 +2088,8 @@ void TorrentImpl::endReceivedMetadataHandling(const Path &savePath, const PathLi
         m_session->handleTorrentStopped(this);
     }
 
+    // the torrent is reloaded according to its operating mode
+    m_isDownloadingMetadataOutOfQueue = false;
     reload();
 
     // If first/last piece priority was specified when adding this torrent,
@@ -1875,7 +2108,7 @@ void TorrentImpl::reload()
     try
     {
         m_completedFiles.fill(false);
-        m_filesProgress.fill(0);
+        resetFilesProgress();
         m_pieces.fill(false);
         m_nativeStatus.pieces.clear_all();
         m_nativeStatus.num_pieces = 0;
@@ -1888,6 +2121,12 @@ void TorrentImpl::reload()
         p.flags |= lt::torrent_flags::update_subscribe
                 | lt::torrent_flags::override_trackers
                 | lt::torrent_flags::override_web_seeds;
+        // category shares are applied again on the next refresh
+        p.upload_limit = m_uploadLimit;
+        p.download_limit = m_downloadLimit;
+        m_uploadShare = 0;
+        m_downloadShare = 0;
+        m_connectionsBudget = 0;
 
         if (m_isStopped)
         {
@@ -1911,6 +2150,7 @@ void TorrentImpl::reload()
         m_nativeHandle = m_nativeSession->add_torrent(p);
 
         m_nativeStatus = extensionData->status;
+        m_peerStats = extensionData->peerStats;
 
         if (queuePos >= lt::queue_position_t {})
             m_nativeHandle.queue_position_set(queuePos);
@@ -1935,6 +2175,7 @@ void TorrentImpl::stop()
         m_session->handleTorrentStopped(this);
     }
 
+    m_isDownloadingMetadataOutOfQueue = false;
     if (m_maintenanceJob == MaintenanceJob::None)
     {
         setAutoManaged(false);
@@ -1970,6 +2211,7 @@ void TorrentImpl::start(const TorrentOperatingMode mode)
         m_session->handleTorrentStarted(this);
     }
 
+    m_isDownloadingMetadataOutOfQueue = false;
     if (m_maintenanceJob == MaintenanceJob::None)
     {
         setAutoManaged(m_operatingMode == TorrentOperatingMode::AutoManaged);
@@ -1978,6 +2220,32 @@ void TorrentImpl::start(const TorrentOperatingMode mode)
     }
 }
 
+void TorrentImpl::downloadMetadataOutOfQueue()
+{
+    Q_ASSERT(!hasMetadata());
+    if (hasMetadata() || m_isStopped || (m_maintenanceJob != MaintenanceJob::None))
+        return;
+
+    m_isDownloadingMetadataOutOfQueue = true;
+    setAutoManaged(false);
+    m_nativeHandle.resume();
+}
+
+void TorrentImpl::returnToQueue()
+{
+    if (!m_isDownloadingMetadataOutOfQueue)
+        return;
+
+    m_isDownloadingMetadataOutOfQueue = false;
+    if (!m_isStopped && (m_maintenanceJob == MaintenanceJob::None))
+        setAutoManaged(m_operatingMode == TorrentOperatingMode::AutoManaged);
+}
+
+bool TorrentImpl::isDownloadingMetadataOutOfQueue() const
+{
+    return m_isDownloadingMetadataOutOfQueue;
+}
+
 void TorrentImpl::moveStorage(const Path &newPath, const MoveStorageContext context)
 {
     if (!hasMetadata())
@@ -2019,9 +2287,18 @@ void TorrentImpl::renameFile(const int index, const Path &path)
     doRenameFile(index, targetActualPath);
 }
 
-void TorrentImpl::handleStateUpdate(const lt::torrent_status &nativeStatus)
+TorrentStatusFields TorrentImpl::handleStateUpdate(const lt::torrent_status &nativeStatus, const lt::status_flags_t queriedFields)
+{
+    updateStatus(nativeStatus, queriedFields);
+    return std::exchange(m_changedStatusFields, {});
+}
+
+void TorrentImpl::handleQueuePositionChanged(const int position)
 {
-    updateStatus(nativeStatus);
+    // libtorrent applies new position asynchronously, so it is cached immediately
+    // to let subsequent queue operations take it into account
+    m_nativeStatus.queue_position = lt::queue_position_t {position};
+    markStatusFieldsChanged(TorrentStatusField::State);
 }
 
 void TorrentImpl::handleQueueingModeChanged()
@@ -2242,6 +2519,9 @@ void TorrentImpl::prepareResumeData(const lt::add_torrent_params &params)
 
     // We shouldn't save upload_mode flag to allow torrent operate normally on next run
     m_ltAddTorrentParams.flags &= ~lt::torrent_flags::upload_mode;
+    // native limits may be reduced to the share of category limits which shouldn't be saved
+    m_ltAddTorrentParams.upload_limit = m_uploadLimit;
+    m_ltAddTorrentParams.download_limit = m_downloadLimit;
 
     const LoadTorrentParams resumeData
     {
@@ -2353,7 +2633,9 @@ void TorrentImpl::handleFileRenamedAlert(const lt::file_renamed_alert *p)
     while (!isMoveInProgress() && (m_renameCount == 0) && !m_moveFinishedTriggers.isEmpty())
         m_moveFinishedTriggers.takeFirst()();
 
-    deferredRequestResumeData();
+    // Save resume data once the whole batch of renames is done
+    if (m_renameCount == 0)
+        deferredRequestResumeData();
 }
 
 void TorrentImpl::handleFileRenameFailedAlert(const lt::file_rename_failed_alert *p)
@@ -2368,7 +2650,8 @@ void TorrentImpl::handleFileRenameFailedAlert(const lt::file_rename_failed_alert
     while (!isMoveInProgress() && (m_renameCount == 0) && !m_moveFinishedTriggers.isEmpty())
         m_moveFinishedTriggers.takeFirst()();
 
-    deferredRequestResumeData();
+    if (m_renameCount == 0)
+        deferredRequestResumeData();
 }
 
 void TorrentImpl::handleFileCompletedAlert(const lt::file_completed_alert *p)
@@ -2398,12 +2681,42 @@ void TorrentImpl::handleFileCompletedAlert(const lt::file_completed_alert *p)
         const Path path = filePath(fileIndex);
         if (actualPath != path)
         {
-            qDebug("Renaming %s to %s", qUtf8Printable(actualPath.toString()), qUtf8Printable(path.toString()));
-            doRenameFile(fileIndex, path);
+            // Files are usually completed in bursts (e.g. when a torrent finishes),
+            // so collect them and rename them all at once when the alerts are processed
+            if (m_pendingCompletionRenames.isEmpty())
+                QMetaObject::invokeMethod(this, &TorrentImpl::renameCompletedFiles, Qt::QueuedConnection);
+
+            m_pendingCompletionRenames.append(fileIndex);
+            // Keep "move finished" triggers waiting for the pending renames
+            ++m_renameCount;
         }
     }
 }
 
+void TorrentImpl::renameCompletedFiles()
+{
+    const QList<int> fileIndexes = std::exchange(m_pendingCompletionRenames, {});
+    m_renameCount -= fileIndexes.size();
+
+    if (!m_nativeHandle.is_valid() || !hasMetadata()) [[unlikely]]
+        return;
+
+    for (const int fileIndex : fileIndexes)
+    {
+        // File could have been renamed while the batch was pending
+        const Path actualPath = actualFilePath(fileIndex);
+        const Path path = filePath(fileIndex);
+        if (actualPath == path)
+            continue;
+
+        qDebug("Renaming %s to %s", qUtf8Printable(actualPath.toString()), qUtf8Printable(path.toString()));
+        doRenameFile(fileIndex, path);
+    }
+
+    while (!isMoveInProgress() && (m_renameCount == 0) && !m_moveFinishedTriggers.isEmpty())
+        m_moveFinishedTriggers.takeFirst()();
+}
+
 void TorrentImpl::handleFileErrorAlert(const lt::file_error_alert *p)
 {
     m_lastFileError = {p->error, p->op};
@@ -2437,12 +2750,42 @@ void TorrentImpl::handlePerformanceAlert(const lt::performance_alert *p) const
            , Log::INFO);
 }
 
+void TorrentImpl::handlePieceFinishedAlert(const lt::piece_finished_alert *p)
+{
+    // pieces are tracked once metadata is handled, the rest are picked up from the next status update
+    const int pieceIndex = LT::toUnderlyingType(p->piece_index);
+    if ((pieceIndex < 0) || (pieceIndex >= m_pieces.size()) || m_pieces.testBit(pieceIndex))
+        return;
+
+    m_pieces.setBit(pieceIndex);
+    applyPieceProgress(pieceIndex, true);
+}
+
+void TorrentImpl::handleReadPieceAlert(const lt::read_piece_alert *p)
+{
+    const int pieceIndex = LT::toUnderlyingType(p->piece);
+    if (p->error)
+    {
+        LogMsg(tr("Failed to read piece. Torrent: \"%1\". Piece: %2. Reason: \"%3\"")
+            .arg(name(), QString::number(pieceIndex), QString::fromLocal8Bit(p->error.message().c_str())), Log::WARNING);
+        m_session->handleTorrentPieceRead(this, pieceIndex, {});
+        return;
+    }
+
+    m_session->handleTorrentPieceRead(this, pieceIndex, QByteArray(p->buffer.get(), p->size));
+}
+
 void TorrentImpl::handleCategoryOptionsChanged()
 {
     if (m_useAutoTMM)
         adjustStorageLocation();
 }
 
+void TorrentImpl::handleGlobalShareLimitsChanged()
+{
+    updateDerivedStatus();
+}
+
 void TorrentImpl::handleAppendExtensionToggled()
 {
     if (!hasMetadata())
@@ -2507,6 +2850,12 @@ void TorrentImpl::handleAlert(const lt::alert *a)
     case lt::performance_alert::alert_type:
         handlePerformanceAlert(static_cast<const lt::performance_alert*>(a));
         break;
+    case lt::piece_finished_alert::alert_type:
+        handlePieceFinishedAlert(static_cast<const lt::piece_finished_alert*>(a));
+        break;
+    case lt::read_piece_alert::alert_type:
+        handleReadPieceAlert(static_cast<const lt::read_piece_alert*>(a));
+        break;
     }
 }
 
@@ -2630,7 +2979,7 @@ bool TorrentImpl::isMoveInProgress() const
     return m_storageIsMoving;
 }
 
-void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
+void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus, const lt::status_flags_t queriedFields)
 {
     // Since libtorrent alerts are handled asynchronously there can be obsolete
     // "state update" event reached here after torrent was reloaded in libtorrent.
@@ -2640,8 +2989,74 @@ void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
 
     const lt::torrent_status oldStatus = std::exchange(m_nativeStatus, nativeStatus);
 
+    // fields which weren't queried keep their previous values
+    if (!(queriedFields & lt::torrent_handle::query_distributed_copies))
+    {
+        m_nativeStatus.distributed_full_copies = oldStatus.distributed_full_copies;
+        m_nativeStatus.distributed_fraction = oldStatus.distributed_fraction;
+        m_nativeStatus.distributed_copies = oldStatus.distributed_copies;
+    }
+
+    const lt::torrent_status &newStatus = m_nativeStatus;
+    if ((newStatus.state != oldStatus.state) || (newStatus.flags != oldStatus.flags)
+            || (newStatus.errc != oldStatus.errc) || (newStatus.is_seeding != oldStatus.is_seeding)
+            || (newStatus.is_finished != oldStatus.is_finished) || (newStatus.has_metadata != oldStatus.has_metadata)
+            || (newStatus.moving_storage != oldStatus.moving_storage) || (newStatus.queue_position != oldStatus.queue_position)
+            || (newStatus.save_path != oldStatus.save_path) || (newStatus.name != oldStatus.name))
+    {
+        markStatusFieldsChanged(TorrentStatusField::State);
+    }
+    if ((newStatus.total_done != oldStatus.total_done) || (newStatus.total != oldStatus.total)
+            || (newStatus.total_wanted_done != oldStatus.total_wanted_done) || (newStatus.total_wanted != oldStatus.total_wanted)
+            || (newStatus.progress_ppm != oldStatus.progress_ppm) || (newStatus.num_pieces != oldStatus.num_pieces))
+    {
+        markStatusFieldsChanged(TorrentStatusField::Progress);
+    }
+    if ((newStatus.total_download != oldStatus.total_download) || (newStatus.total_upload != oldStatus.total_upload)
+            || (newStatus.total_payload_download != oldStatus.total_payload_download)
+            || (newStatus.total_payload_upload != oldStatus.total_payload_upload)
+            || (newStatus.all_time_download != oldStatus.all_time_download) || (newStatus.all_time_upload != oldStatus.all_time_upload)
+            || (newStatus.total_failed_bytes != oldStatus.total_failed_bytes)
+            || (newStatus.total_redundant_bytes != oldStatus.total_redundant_bytes))
+    {
+        markStatusFieldsChanged(TorrentStatusField::Totals);
+    }
+    if ((newStatus.num_seeds != oldStatus.num_seeds) || (newStatus.num_peers != oldStatus.num_peers)
+            || (newStatus.num_complete != oldStatus.num_complete) || (newStatus.num_incomplete != oldStatus.num_incomplete)
+            || (newStatus.list_seeds != oldStatus.list_seeds) || (newStatus.list_peers != oldStatus.list_peers)
+            || (newStatus.num_connections != oldStatus.num_connections))
+    {
+        markStatusFieldsChanged(TorrentStatusField::Peers);
+    }
+    if ((newStatus.distributed_copies != oldStatus.distributed_copies)
+            || (newStatus.distributed_full_copies != oldStatus.distributed_full_copies)
+            || (newStatus.distributed_fraction != oldStatus.distributed_fraction))
+    {
+        markStatusFieldsChanged(TorrentStatusField::Availability);
+    }
+    if ((newStatus.active_duration != oldStatus.active_duration) || (newStatus.finished_duration != oldStatus.finished_duration)
+            || (newStatus.seeding_duration != oldStatus.seeding_duration) || (newStatus.completed_time != oldStatus.completed_time)
+            || (newStatus.last_seen_complete != oldStatus.last_seen_complete) || (newStatus.added_time != oldStatus.added_time)
+            || (newStatus.last_upload != oldStatus.last_upload) || (newStatus.last_download != oldStatus.last_download)
+            || (newStatus.next_announce != oldStatus.next_announce))
+    {
+        markStatusFieldsChanged(TorrentStatusField::Times);
+    }
+    if (newStatus.current_tracker != oldStatus.current_tracker)
+        markStatusFieldsChanged(TorrentStatusField::Trackers);
+
     if (m_nativeStatus.num_pieces != oldStatus.num_pieces)
-        updateProgress();
+    {
+        // finished pieces are usually applied already as their alerts are received,
+        // so the whole piece set is only compared if something is missed (e.g. pieces
+        // restored from resume data or lost due to failed check)
+        if (hasMetadata() && (m_nativeStatus.num_pieces != m_pieces.count(true)))
+            updateProgress();
+
+        // pieces restored from resume data while it is being checked are already saved
+        if (oldStatus.state != lt::torrent_status::checking_resume_data)
+            m_hasUnsavedResumeDataProgress = true;
+    }
 
     if (m_nativeStatus.completed_time != oldStatus.completed_time)
         m_completedTime = (m_nativeStatus.completed_time > 0) ? QDateTime::fromSecsSinceEpoch(m_nativeStatus.completed_time) : QDateTime();
@@ -2649,10 +3064,24 @@ void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
     if (m_nativeStatus.last_seen_complete != oldStatus.last_seen_complete)
         m_lastSeenComplete = QDateTime::fromSecsSinceEpoch(m_nativeStatus.last_seen_complete);
 
-    updateState();
-
+    // speeds are displayed as averages, so they can change even if current rates stay the same
+    const SpeedSampleAvg oldSpeedAverage = m_payloadRateMonitor.average();
     m_payloadRateMonitor.addSample({nativeStatus.download_payload_rate
                               , nativeStatus.upload_payload_rate});
+    const SpeedSampleAvg speedAverage = m_payloadRateMonitor.average();
+    m_payloadRateHistory.addSample({downloadPayloadRate(), uploadPayloadRate()}, SpeedHistory::currentTimestamp());
+    if ((speedAverage.download != oldSpeedAverage.download) || (speedAverage.upload != oldSpeedAverage.upload)
+            || (nativeStatus.download_payload_rate != oldStatus.download_payload_rate)
+            || (nativeStatus.upload_payload_rate != oldStatus.upload_payload_rate))
+    {
+        markStatusFieldsChanged(TorrentStatusField::Transfer);
+    }
+
+    // derived status is updated along with state, so speed samples must be already taken
+    const TorrentState oldState = m_state;
+    updateState();
+    if (m_state != oldState)
+        markStatusFieldsChanged(TorrentStatusField::State);
 
     if (hasMetadata())
     {
@@ -2664,6 +3093,13 @@ void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
             m_unchecked = true;
     }
 
+    // the session decides when the files are actually checked
+    if ((m_nativeStatus.state == lt::torrent_status::checking_files)
+            && (oldStatus.state != lt::torrent_status::checking_files) && hasMetadata())
+    {
+        m_session->handleTorrentCheckingQueued(this);
+    }
+
     while (!m_statusUpdatedTriggers.isEmpty())
         std::invoke(m_statusUpdatedTriggers.dequeue());
 }
@@ -2674,35 +3110,51 @@ void TorrentImpl::updateProgress()
     if (!hasMetadata()) [[unlikely]]
         return;
 
-    Q_ASSERT(!m_filesProgress.isEmpty());
-    if (m_filesProgress.isEmpty()) [[unlikely]]
-        m_filesProgress.resize(filesCount());
+    Q_ASSERT(m_filesProgress.size() == filesCount());
+    if (m_filesProgress.size() != filesCount()) [[unlikely]]
+        resetFilesProgress();
 
     const QBitArray oldPieces = std::exchange(m_pieces, LT::toQBitArray(m_nativeStatus.pieces));
-    const QBitArray newPieces = m_pieces ^ oldPieces;
+    const QBitArray changedPieces = m_pieces ^ oldPieces;
 
-    const int64_t pieceSize = m_torrentInfo.pieceLength();
-    for (qsizetype index = 0; index < newPieces.size(); ++index)
+    for (qsizetype index = 0; index < changedPieces.size(); ++index)
     {
-        if (!newPieces.at(index))
-            continue;
+        if (changedPieces.at(index))
+            applyPieceProgress(index, m_pieces.at(index));
+    }
+}
 
-        int64_t size = m_torrentInfo.pieceLength(index);
-        int64_t pieceOffset = index * pieceSize;
+void TorrentImpl::resetFilesProgress()
+{
+    const int count = filesCount();
+    m_filesProgress.fill(0, count);
 
-        for (const int fileIndex : asConst(m_torrentInfo.fileIndicesForPiece(index)))
-        {
-            const int64_t fileOffsetInPiece = pieceOffset - m_torrentInfo.fileOffset(fileIndex);
-            const int64_t add = std::min<int64_t>((m_torrentInfo.fileSize(fileIndex) - fileOffsetInPiece), size);
+    m_filesProgressFractions.resize(count);
+    for (int i = 0; i < count; ++i)
+        m_filesProgressFractions[i] = (fileSize(i) <= 0) ? 1 : 0;
+}
+
+void TorrentImpl::applyPieceProgress(const int pieceIndex, const bool isAdded)
+{
+    int64_t size = m_torrentInfo.pieceLength(pieceIndex);
+    int64_t pieceOffset = static_cast<int64_t>(pieceIndex) * m_torrentInfo.pieceLength();
 
-            m_filesProgress[fileIndex] += add;
+    for (const int fileIndex : asConst(m_torrentInfo.fileIndicesForPiece(pieceIndex)))
+    {
+        const int64_t totalSize = m_torrentInfo.fileSize(fileIndex);
+        const int64_t fileOffsetInPiece = pieceOffset - m_torrentInfo.fileOffset(fileIndex);
+        const int64_t add = std::min<int64_t>((totalSize - fileOffsetInPiece), size);
 
-            size -= add;
-            if (size <= 0)
-                break;
+        int64_t &progress = m_filesProgress[fileIndex];
+        progress += (isAdded ? add : -add);
+        m_filesProgressFractions[fileIndex] = ((totalSize <= 0) || (progress == totalSize))
+                ? 1 : (progress / static_cast<qreal>(totalSize));
 
-            pieceOffset += add;
-        }
+        size -= add;
+        if (size <= 0)
+            break;
+
+        pieceOffset += add;
     }
 }
 
@@ -2716,6 +3168,7 @@ void TorrentImpl::setRatioLimit(qreal limit)
     if (m_ratioLimit != limit)
     {
         m_ratioLimit = limit;
+        updateDerivedStatus();
         deferredRequestResumeData();
         m_session->handleTorrentShareLimitChanged(this);
     }
@@ -2731,6 +3184,7 @@ void TorrentImpl::setSeedingTimeLimit(int limit)
     if (m_seedingTimeLimit != limit)
     {
         m_seedingTimeLimit = limit;
+        updateDerivedStatus();
         deferredRequestResumeData();
         m_session->handleTorrentShareLimitChanged(this);
     }
@@ -2746,6 +3200,7 @@ void TorrentImpl::setInactiveSeedingTimeLimit(int limit)
     if (m_inactiveSeedingTimeLimit != limit)
     {
         m_inactiveSeedingTimeLimit = limit;
+        updateDerivedStatus();
         deferredRequestResumeData();
         m_session->handleTorrentShareLimitChanged(this);
     }
@@ -2773,7 +3228,7 @@ void TorrentImpl::setUploadLimit(const int limit)
         return;
 
     m_uploadLimit = cleanValue;
-    m_nativeHandle.set_upload_limit(m_uploadLimit);
+    m_nativeHandle.set_upload_limit(effectiveLimitValue(m_uploadLimit, m_uploadShare));
     deferredRequestResumeData();
 }
 
@@ -2784,10 +3239,25 @@ void TorrentImpl::setDownloadLimit(const int limit)
         return;
 
     m_downloadLimit = cleanValue;
-    m_nativeHandle.set_download_limit(m_downloadLimit);
+    m_nativeHandle.set_download_limit(effectiveLimitValue(m_downloadLimit, m_downloadShare));
     deferredRequestResumeData();
 }
 
+void TorrentImpl::setBandwidthShare(const int uploadShare, const int downloadShare)
+{
+    if (uploadShare != m_uploadShare)
+    {
+        m_uploadShare = uploadShare;
+        m_nativeHandle.set_upload_limit(effectiveLimitValue(m_uploadLimit, m_uploadShare));
+    }
+
+    if (downloadShare != m_downloadShare)
+    {
+        m_downloadShare = downloadShare;
+        m_nativeHandle.set_download_limit(effectiveLimitValue(m_downloadLimit, m_downloadShare));
+    }
+}
+
 void TorrentImpl::setSuperSeeding(const bool enable)
 {
     if (enable == superSeeding())
@@ -2887,25 +3357,7 @@ nonstd::expected<lt::entry, QString> TorrentImpl::exportTorrent() const
     if (!hasMetadata())
         return nonstd::make_unexpected(tr("Missing metadata"));
 
-    try
-    {
-#ifdef QBT_USES_LIBTORRENT2
-        const std::shared_ptr<lt::torrent_info> completeTorrentInfo = m_nativeHandle.torrent_file_with_hashes();
-        const std::shared_ptr<lt::torrent_info> torrentInfo = (completeTorrentInfo ? completeTorrentInfo : info().nativeInfo());
-#else
-        const std::shared_ptr<lt::torrent_info> torrentInfo = info().nativeInfo();
-#endif
-        lt::create_torrent creator {*torrentInfo};
-
-        for (const TrackerEntryStatus &status : asConst(trackers()))
-            creator.add_tracker(status.url.toStdString(), status.tier);
-
-        return creator.generate();
-    }
-    catch (const lt::system_error &err)
-    {
-        return nonstd::make_unexpected(QString::fromLocal8Bit(err.what()));
-    }
+    return generateTorrentFile(m_nativeHandle, info().nativeInfo(), trackers());
 }
 
 nonstd::expected<QByteArray, QString> TorrentImpl::exportToBuffer() const
@@ -2914,12 +3366,7 @@ nonstd::expected<QByteArray, QString> TorrentImpl::exportToBuffer() const
     if (!preparationResult)
         return preparationResult.get_unexpected();
 
-    // usually torrent size should be smaller than 1 MB,
-    // however there are >100 MB v2/hybrid torrent files out in the wild
-    QByteArray buffer;
-    buffer.reserve(1024 * 1024);
-    lt::bencode(std::back_inserter(buffer), preparationResult.value());
-    return buffer;
+    return bencodeTorrentFile(preparationResult.value());
 }
 
 nonstd::expected<void, QString> TorrentImpl::exportToFile(const Path &path) const
@@ -2935,25 +3382,95 @@ nonstd::expected<void, QString> TorrentImpl::exportToFile(const Path &path) cons
     return {};
 }
 
-void TorrentImpl::fetchPeerInfo(std::function<void (QVector<PeerInfo>)> resultHandler) const
+void TorrentImpl::fetchTorrentFile(std::function<void (nonstd::expected<QByteArray, QString>)> resultHandler) const
 {
-    invokeAsync([nativeHandle = m_nativeHandle, allPieces = pieces()]() -> QVector<PeerInfo>
+    if (!hasMetadata())
     {
-        try
+        m_session->invoke([resultHandler = std::move(resultHandler)]
         {
-            std::vector<lt::peer_info> nativePeers;
-            nativeHandle.get_peer_info(nativePeers);
-            QVector<PeerInfo> peers;
-            peers.reserve(static_cast<decltype(peers)::size_type>(nativePeers.size()));
-            for (const lt::peer_info &peer : nativePeers)
-                peers.append(PeerInfo(peer, allPieces));
-            return peers;
-        }
-        catch (const std::exception &) {}
+            resultHandler(nonstd::make_unexpected(tr("Missing metadata")));
+        });
+        return;
+    }
 
-        return {};
+    m_session->invokeAsync([session = m_session, nativeHandle = m_nativeHandle, nativeInfo = info().nativeInfo()
+            , trackers = trackers(), resultHandler = std::move(resultHandler)]() mutable
+    {
+        const nonstd::expected<lt::entry, QString> torrentFile = generateTorrentFile(nativeHandle, nativeInfo, trackers);
+        nonstd::expected<QByteArray, QString> result = torrentFile
+                ? nonstd::expected<QByteArray, QString>(bencodeTorrentFile(torrentFile.value()))
+                : nonstd::expected<QByteArray, QString>(torrentFile.get_unexpected());
+        session->invoke([result = std::move(result), resultHandler = std::move(resultHandler)]
+        {
+            resultHandler(result);
+        });
+    });
+}
+
+std::shared_ptr<const PeerStatsSnapshot> TorrentImpl::peerStats() const
+{
+    return m_peerStats->snapshot();
+}
+
+qint64 TorrentImpl::estimatedMemoryUsage() const
+{
+    qint64 size = sizeof(*this)
+        + MemoryUsage::sizeOf(m_name) + MemoryUsage::sizeOf(m_comment) + MemoryUsage::sizeOf(m_creator)
+        + (m_pieces.size() / 8)
+        + (m_peerInfoSnapshot.capacity() * sizeof(PeerInfo))
+        + (m_trackerEntryStatuses.capacity() * sizeof(TrackerEntryStatus));
+    for (const QUrl &urlSeed : asConst(m_urlSeeds))
+        size += sizeof(QUrl) + (urlSeed.toString().size() * sizeof(QChar));
+    return size;
+}
+
+qint64 TorrentImpl::estimatedFilesMemoryUsage() const
+{
+    // hash nodes keep the key, the value and the pointer to the next node
+    qint64 size = (m_indexMap.size() * (sizeof(lt::file_index_t) + sizeof(int) + sizeof(void *)))
+        + (m_filePriorities.capacity() * sizeof(DownloadPriority))
+        + (m_completedFiles.size() / 8)
+        + (m_filesProgress.capacity() * sizeof(std::int64_t))
+        + (m_filesProgressFractions.capacity() * sizeof(qreal));
+    for (const Path &filePath : asConst(m_filePaths))
+        size += MemoryUsage::sizeOf(filePath.data());
+    return size;
+}
+
+void TorrentImpl::fetchPeerInfo(std::function<void (QVector<PeerInfo>)> resultHandler) const
+{
+    if (m_peerInfoSnapshotTimer.isValid() && !m_peerInfoSnapshotTimer.hasExpired(m_session->refreshInterval()))
+    {
+        // keep the result delivered asynchronously as the callers expect
+        QMetaObject::invokeMethod(const_cast<TorrentImpl *>(this)
+                , [resultHandler = std::move(resultHandler), peers = m_peerInfoSnapshot] { resultHandler(peers); }
+                , Qt::QueuedConnection);
+        return;
     }
-    , std::move(resultHandler));
+
+    m_peerInfoHandlers.append(std::move(resultHandler));
+    requestPeerInfo();
+}
+
+void TorrentImpl::requestPeerInfo() const
+{
+    if (m_isPeerInfoRequested)
+        return;
+
+    m_isPeerInfoRequested = true;
+    invokeAsync([nativeHandle = m_nativeHandle, allPieces = pieces()]
+    {
+        return queryPeerInfo(nativeHandle, allPieces);
+    }
+    , [this](QVector<PeerInfo> peers)
+    {
+        m_isPeerInfoRequested = false;
+        m_peerInfoSnapshot = std::move(peers);
+        m_peerInfoSnapshotTimer.start();
+
+        for (const auto &handler : asConst(std::exchange(m_peerInfoHandlers, {})))
+            handler(m_peerInfoSnapshot);
+    });
 }
 
 void TorrentImpl::fetchURLSeeds(std::function<void (QVector<QUrl>)> resultHandler) const
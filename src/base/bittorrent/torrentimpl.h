@@ -31,6 +31,7 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 
 #include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/fwd.hpp>
@@ -40,6 +41,7 @@
 
 #include <QBitArray>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QMap>
 #include <QObject>
@@ -49,7 +51,10 @@
 
 #include "base/path.h"
 #include "base/tagset.h"
+#include "base/types.h"
 #include "infohash.h"
+#include "peerinfo.h"
+#include "resumedatacounters.h"
 #include "speedmonitor.h"
 #include "sslparameters.h"
 #include "torrent.h"
@@ -57,6 +62,9 @@
 #include "torrentinfo.h"
 #include "trackerentrystatus.h"
 
+class PeerStatsHolder;
+struct PeerStatsSnapshot;
+
 namespace BitTorrent
 {
     class SessionImpl;
@@ -128,7 +136,7 @@ namespace BitTorrent
         bool belongsToCategory(const QString &category) const override;
         bool setCategory(const QString &category) override;
 
-        TagSet tags() const override;
+        const TagSet &tags() const override;
         bool hasTag(const Tag &tag) const override;
         bool addTag(const Tag &tag) override;
         bool removeTag(const Tag &tag) override;
@@ -215,16 +223,25 @@ namespace BitTorrent
         qreal popularity() const override;
         int uploadPayloadRate() const override;
         int downloadPayloadRate() const override;
+        QList<SpeedSample> payloadRateHistory(SpeedHistory::Period period, qint64 timestamp) const override;
+        // rates (in bytes/s) the torrent may use out of its category limits, 0 means no limit
+        void setBandwidthShare(int uploadShare, int downloadShare);
         qlonglong totalPayloadUpload() const override;
         qlonglong totalPayloadDownload() const override;
         int connectionsCount() const override;
         int connectionsLimit() const override;
+        // connections limit assigned by the session out of its connections, 0 means the default limit
+        int connectionsBudget() const;
+        void setConnectionsBudget(int budget);
         qlonglong nextAnnounce() const override;
+        quint64 statusRevision() const override;
         QVector<qreal> availableFileFractions() const override;
 
         void setName(const QString &name) override;
         void setSequentialDownload(bool enable) override;
         void setFirstLastPiecePriority(bool enabled) override;
+        void setPieceDeadline(int pieceIndex, int deadline) override;
+        void resetPieceDeadline(int pieceIndex) override;
         void stop() override;
         void start(TorrentOperatingMode mode = TorrentOperatingMode::AutoManaged) override;
         void forceReannounce(int index = -1) override;
@@ -257,6 +274,7 @@ namespace BitTorrent
         QString createMagnetURI() const override;
         nonstd::expected<QByteArray, QString> exportToBuffer() const override;
         nonstd::expected<void, QString> exportToFile(const Path &path) const override;
+        void fetchTorrentFile(std::function<void (nonstd::expected<QByteArray, QString>)> resultHandler) const override;
 
         void fetchPeerInfo(std::function<void (QVector<PeerInfo>)> resultHandler) const override;
         void fetchURLSeeds(std::function<void (QVector<QUrl>)> resultHandler) const override;
@@ -264,32 +282,78 @@ namespace BitTorrent
         void fetchDownloadingPieces(std::function<void (QBitArray)> resultHandler) const override;
         void fetchAvailableFileFractions(std::function<void (QVector<qreal>)> resultHandler) const override;
 
+        // Latest stats of the connected peers collected by the torrent extension,
+        // it is cheap to get unlike the peer info queried from libtorrent
+        std::shared_ptr<const PeerStatsSnapshot> peerStats() const;
+
+        // Approximate size of the data kept for the torrent apart from libtorrent,
+        // the file tables are estimated separately since they depend on the number of files
+        qint64 estimatedMemoryUsage() const;
+        qint64 estimatedFilesMemoryUsage() const;
+
         bool needSaveResumeData() const;
 
+        // Counters can be stored apart from the rest of resume data while they are
+        // the only known changes since resume data was generated last time
+        ResumeDataCounters resumeDataCounters() const;
+        bool isResumeDataCountersChanged() const;
+        bool hasUnsavedResumeDataProgress() const;
+        int resumeDataCountersSaveCount() const;
+        void handleResumeDataCountersStored(const ResumeDataCounters &counters);
+
         // Session interface
         lt::torrent_handle nativeHandle() const;
 
         void handleAlert(const lt::alert *a);
-        void handleStateUpdate(const lt::torrent_status &nativeStatus);
+        // Returns the groups of fields changed since the previous update
+        TorrentStatusFields handleStateUpdate(const lt::torrent_status &nativeStatus, lt::status_flags_t queriedFields = lt::status_flags_t::all());
         void handleQueueingModeChanged();
+        void handleQueuePositionChanged(int position);
         void handleCategoryOptionsChanged();
+        void handleGlobalShareLimitsChanged();
         void handleAppendExtensionToggled();
         void handleUnwantedFolderToggled();
         void requestResumeData(lt::resume_data_flags_t flags = {});
         void deferredRequestResumeData();
+        void setTagBit(int tagIndex, bool value);
         void handleMoveStorageJobFinished(const Path &path, MoveStorageContext context, bool hasOutstandingJob);
         void fileSearchFinished(const Path &savePath, const PathList &fileNames);
         TrackerEntryStatus updateTrackerEntryStatus(const lt::announce_entry &announceEntry, const QHash<lt::tcp::endpoint, QMap<int, int>> &updateInfo);
+        // marks the tracker as having forced announce delayed until the given time
+        TrackerEntryStatus scheduleTrackerEntryAnnounce(int index, const QDateTime &announceTime);
         void resetTrackerEntryStatuses();
+        // Returns seconds left until the given ratio is reached at current upload rate or -1 if it won't be reached
+        qlonglong timeToReachRatio(qreal ratio) const;
+        // Queued torrent without metadata can be started for a while to download it,
+        // it keeps its operating mode and is returned to the queue afterwards
+        void downloadMetadataOutOfQueue();
+        void returnToQueue();
+        bool isDownloadingMetadataOutOfQueue() const;
 
     private:
         using EventTrigger = std::function<void ()>;
 
+        // Values derived from torrent status, they are evaluated once it is updated
+        // rather than each time they are queried.
+        struct DerivedStatus
+        {
+            bool isActive = false;
+            qreal realRatio = 0;
+            // part of ETA that doesn't change by itself
+            qlonglong eta = MAX_ETA;
+            // seeding time limits keep approaching between status updates
+            std::optional<lt::clock_type::time_point> etaDeadline;
+        };
+
         std::shared_ptr<const lt::torrent_info> nativeTorrentInfo() const;
 
-        void updateStatus(const lt::torrent_status &nativeStatus);
+        void updateStatus(const lt::torrent_status &nativeStatus, lt::status_flags_t queriedFields = lt::status_flags_t::all());
+        qint64 ratioDownloadedBytes() const;
         void updateProgress();
+        void resetFilesProgress();
+        void applyPieceProgress(int pieceIndex, bool isAdded);
         void updateState();
+        void updateDerivedStatus();
 
         void handleFastResumeRejectedAlert(const lt::fastresume_rejected_alert *p);
         void handleFileCompletedAlert(const lt::file_completed_alert *p);
@@ -301,6 +365,8 @@ namespace BitTorrent
         void handleFileRenameFailedAlert(const lt::file_rename_failed_alert *p);
         void handleMetadataReceivedAlert(const lt::metadata_received_alert *p);
         void handlePerformanceAlert(const lt::performance_alert *p) const;
+        void handlePieceFinishedAlert(const lt::piece_finished_alert *p);
+        void handleReadPieceAlert(const lt::read_piece_alert *p);
         void handleSaveResumeDataAlert(const lt::save_resume_data_alert *p);
         void handleSaveResumeDataFailedAlert(const lt::save_resume_data_failed_alert *p);
         void handleTorrentCheckedAlert(const lt::torrent_checked_alert *p);
@@ -316,6 +382,7 @@ namespace BitTorrent
         Path makeUserPath(const Path &path) const;
         void adjustStorageLocation();
         void doRenameFile(int index, const Path &path);
+        void renameCompletedFiles();
         void moveStorage(const Path &newPath, MoveStorageContext context);
         void manageActualFilePaths();
         void applyFirstLastPiecePriority(bool enabled);
@@ -326,6 +393,10 @@ namespace BitTorrent
 
         nonstd::expected<lt::entry, QString> exportTorrent() const;
 
+        void requestPeerInfo() const;
+        // each change of the fields increases the status revision
+        void markStatusFieldsChanged(TorrentStatusFields fields);
+
         template <typename Func, typename Callback>
         void invokeAsync(Func func, Callback resultHandler) const;
 
@@ -334,12 +405,19 @@ namespace BitTorrent
         lt::torrent_handle m_nativeHandle;
         mutable lt::torrent_status m_nativeStatus;
         TorrentState m_state = TorrentState::Unknown;
+        DerivedStatus m_derivedStatus;
+        TorrentStatusFields m_changedStatusFields = TorrentStatusField::All;
+        quint64 m_statusRevision = 0;
         TorrentInfo m_torrentInfo;
         PathList m_filePaths;
         QHash<lt::file_index_t, int> m_indexMap;
         QVector<DownloadPriority> m_filePriorities;
         QBitArray m_completedFiles;
         SpeedMonitor m_payloadRateMonitor;
+        SpeedHistory m_payloadRateHistory;
+        int m_uploadShare = 0;
+        int m_downloadShare = 0;
+        int m_connectionsBudget = 0;
 
         InfoHash m_infoHash;
 
@@ -356,6 +434,8 @@ namespace BitTorrent
         QQueue<EventTrigger> m_moveFinishedTriggers;
         int m_renameCount = 0;
         bool m_storageIsMoving = false;
+        // Completed files whose incomplete extension is to be removed in the next batch
+        QList<int> m_pendingCompletionRenames;
 
         QQueue<EventTrigger> m_statusUpdatedTriggers;
 
@@ -371,6 +451,8 @@ namespace BitTorrent
         Path m_downloadPath;
         QString m_category;
         TagSet m_tags;
+        // bits are indexed by the session-wide tag indexes, so looking up a tag doesn't need to compare strings
+        QBitArray m_tagBits;
         qreal m_ratioLimit = 0;
         int m_seedingTimeLimit = 0;
         int m_inactiveSeedingTimeLimit = 0;
@@ -382,6 +464,7 @@ namespace BitTorrent
         bool m_hasFirstLastPiecePriority = false;
         bool m_useAutoTMM = false;
         bool m_isStopped = false;
+        bool m_isDownloadingMetadataOutOfQueue = false;
         StopCondition m_stopCondition = StopCondition::None;
         SSLParameters m_sslParams;
 
@@ -394,7 +477,20 @@ namespace BitTorrent
 
         QBitArray m_pieces;
         QVector<std::int64_t> m_filesProgress;
+        QVector<qreal> m_filesProgressFractions;
+
+        // Peers are queried from libtorrent at most once per refresh interval,
+        // all the consumers share the latest snapshot
+        mutable QVector<PeerInfo> m_peerInfoSnapshot;
+        mutable QElapsedTimer m_peerInfoSnapshotTimer;
+        mutable QList<std::function<void (QVector<PeerInfo>)>> m_peerInfoHandlers;
+        mutable bool m_isPeerInfoRequested = false;
+        std::shared_ptr<PeerStatsHolder> m_peerStats;
 
         bool m_deferredRequestResumeDataInvoked = false;
+
+        ResumeDataCounters m_storedResumeDataCounters;
+        int m_resumeDataCountersSaveCount = 0;
+        bool m_hasUnsavedResumeDataProgress = false;
     };
 }
@@ -28,6 +28,8 @@
 
 #include "torrentinfo.h"
 
+#include <algorithm>
+
 #include <libtorrent/create_torrent.hpp>
 #include <libtorrent/error_code.hpp>
 #include <libtorrent/version.hpp>
@@ -238,10 +240,13 @@ Path TorrentInfo::filePath(const int index) const
 
 PathList TorrentInfo::filePaths() const
 {
+    if (!isValid()) return {};
+
+    const lt::file_storage &fileStorage = m_nativeInfo->orig_files();
     PathList list;
-    list.reserve(filesCount());
-    for (int i = 0; i < filesCount(); ++i)
-        list << filePath(i);
+    list.reserve(m_nativeIndexes.size());
+    for (const lt::file_index_t nativeIndex : asConst(m_nativeIndexes))
+        list.emplaceBack(fileStorage.file_path(nativeIndex));
 
     return list;
 }
@@ -341,7 +346,7 @@ QVector<int> TorrentInfo::fileIndicesForPiece(const int pieceIndex) const
     res.reserve(static_cast<decltype(res)::size_type>(files.size()));
     for (const lt::file_slice &fileSlice : files)
     {
-        const int index = m_nativeIndexes.indexOf(fileSlice.file_index);
+        const int index = indexOfNativeIndex(fileSlice.file_index);
         if (index >= 0)
             res.append(index);
     }
@@ -429,6 +434,17 @@ bool TorrentInfo::matchesInfoHash(const InfoHash &otherInfoHash) const
     return true;
 }
 
+int TorrentInfo::indexOfNativeIndex(const lt::file_index_t nativeIndex) const
+{
+    // native indexes are collected in ascending order, so the lookup is logarithmic
+    // instead of scanning all the files (it is done for each completed piece)
+    const auto iter = std::lower_bound(m_nativeIndexes.cbegin(), m_nativeIndexes.cend(), nativeIndex);
+    if ((iter == m_nativeIndexes.cend()) || (*iter != nativeIndex))
+        return -1;
+
+    return static_cast<int>(iter - m_nativeIndexes.cbegin());
+}
+
 int TorrentInfo::fileIndex(const Path &filePath) const
 {
     // the check whether the object is valid is not needed here
@@ -101,6 +101,8 @@ namespace BitTorrent
     private:
         // returns file index or -1 if fileName is not found
         int fileIndex(const Path &filePath) const;
+        // returns file index or -1 if it is a pad file
+        int indexOfNativeIndex(lt::file_index_t nativeIndex) const;
 
         std::shared_ptr<const lt::torrent_info> m_nativeInfo;
 
@@ -0,0 +1,55 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QFlags>
+
+namespace BitTorrent
+{
+    // Groups of torrent data, used to tell which of them have changed since the previous update
+    enum class TorrentStatusField
+    {
+        State = 0x1,
+        Progress = 0x2,
+        Transfer = 0x4,
+        Totals = 0x8,
+        Peers = 0x10,
+        Availability = 0x20,
+        Times = 0x40,
+        Trackers = 0x80,
+        // properties set by application, which aren't part of libtorrent status
+        Properties = 0x100,
+
+        All = 0x1FF
+    };
+
+    Q_DECLARE_FLAGS(TorrentStatusFields, TorrentStatusField)
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(BitTorrent::TorrentStatusFields)
@@ -40,6 +40,7 @@ void BitTorrent::TrackerEntryStatus::clear()
     numDownloaded = -1;
     nextAnnounceTime = {};
     minAnnounceTime = {};
+    scheduledAnnounceTime = {};
     endpoints.clear();
 }
 
@@ -78,6 +78,8 @@ namespace BitTorrent
 
         QDateTime nextAnnounceTime {};
         QDateTime minAnnounceTime {};
+        // forced announce delayed by session announce scheduler
+        QDateTime scheduledAnnounceTime {};
 
         QHash<std::pair<QString, int>, TrackerEndpointStatus> endpoints {};
 
@@ -0,0 +1,142 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "trackerhealthregistry.h"
+
+#include <algorithm>
+
+#include <QList>
+#include <QMutexLocker>
+#include <QUrl>
+
+#include "base/global.h"
+
+namespace
+{
+    // weight of the latest result in moving averages
+    const qreal SMOOTHING_FACTOR = 0.2;
+    // latency at which score is halved
+    const qreal REFERENCE_LATENCY = 1000;
+    const int MAX_CONSECUTIVE_FAILURES = 20;
+    // failing tracker gets another chance after it
+    const std::chrono::hours FAILURE_EXPIRATION {24};
+}
+
+using namespace BitTorrent;
+
+void TrackerHealthRegistry::addSuccess(const QString &host, const std::chrono::milliseconds latency)
+{
+    const QMutexLocker locker {&m_mutex};
+
+    Stats &stats = m_stats[host];
+    stats.successRate += SMOOTHING_FACTOR * (1 - stats.successRate);
+    stats.latency = (stats.latency < 0)
+            ? latency.count() : (stats.latency + (SMOOTHING_FACTOR * (latency.count() - stats.latency)));
+    stats.consecutiveFailures = 0;
+}
+
+void TrackerHealthRegistry::addFailure(const QString &host)
+{
+    const QMutexLocker locker {&m_mutex};
+
+    Stats &stats = m_stats[host];
+    stats.successRate -= SMOOTHING_FACTOR * stats.successRate;
+    ++stats.consecutiveFailures;
+    stats.lastFailureTime = std::chrono::steady_clock::now();
+}
+
+bool TrackerHealthRegistry::isFailing(const QString &host) const
+{
+    const QMutexLocker locker {&m_mutex};
+
+    const auto iter = m_stats.constFind(host);
+    return (iter != m_stats.cend()) && isFailing(*iter, std::chrono::steady_clock::now());
+}
+
+qreal TrackerHealthRegistry::score(const QString &host) const
+{
+    const QMutexLocker locker {&m_mutex};
+
+    return score(m_stats.value(host));
+}
+
+QList<TrackerEntry> TrackerHealthRegistry::rankTrackers(const QList<TrackerEntry> &trackers, const int limit) const
+{
+    struct RankedTracker
+    {
+        const TrackerEntry *entry = nullptr;
+        qreal score = 0;
+    };
+
+    QList<RankedTracker> rankedTrackers;
+    rankedTrackers.reserve(trackers.size());
+    {
+        const QMutexLocker locker {&m_mutex};
+
+        const auto now = std::chrono::steady_clock::now();
+        for (const TrackerEntry &tracker : trackers)
+        {
+            const Stats stats = m_stats.value(trackerHost(tracker.url));
+            if (!isFailing(stats, now))
+                rankedTrackers.append({.entry = &tracker, .score = score(stats)});
+        }
+    }
+
+    // trackers having the same score keep their original order
+    std::stable_sort(rankedTrackers.begin(), rankedTrackers.end()
+            , [](const RankedTracker &left, const RankedTracker &right) { return left.score > right.score; });
+
+    QList<TrackerEntry> result;
+    result.reserve(std::min<qsizetype>(limit, rankedTrackers.size()));
+    for (const RankedTracker &rankedTracker : asConst(rankedTrackers))
+    {
+        if (result.size() >= limit)
+            break;
+        result.append(*rankedTracker.entry);
+    }
+
+    return result;
+}
+
+QString TrackerHealthRegistry::trackerHost(const QString &url)
+{
+    return QUrl(url).host();
+}
+
+bool TrackerHealthRegistry::isFailing(const Stats &stats, const std::chrono::steady_clock::time_point now)
+{
+    return (stats.consecutiveFailures >= MAX_CONSECUTIVE_FAILURES)
+            && ((now - stats.lastFailureTime) < FAILURE_EXPIRATION);
+}
+
+qreal TrackerHealthRegistry::score(const Stats &stats)
+{
+    // unknown latency is considered as the reference one
+    const qreal latency = (stats.latency < 0) ? REFERENCE_LATENCY : stats.latency;
+    return stats.successRate * REFERENCE_LATENCY / (REFERENCE_LATENCY + latency);
+}
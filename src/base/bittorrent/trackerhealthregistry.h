@@ -0,0 +1,78 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <QtContainerFwd>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "trackerentry.h"
+
+namespace BitTorrent
+{
+    // Collects announce results of trackers grouped by their hosts and ranks trackers
+    // by success rate and response latency. Results can be added from any thread.
+    class TrackerHealthRegistry
+    {
+        Q_DISABLE_COPY_MOVE(TrackerHealthRegistry)
+
+    public:
+        TrackerHealthRegistry() = default;
+
+        void addSuccess(const QString &host, std::chrono::milliseconds latency);
+        void addFailure(const QString &host);
+
+        // tracker is failing if it failed too many times in a row recently
+        bool isFailing(const QString &host) const;
+        qreal score(const QString &host) const;
+        // returns up to `limit` trackers starting from the healthiest one, failing trackers are omitted
+        QList<TrackerEntry> rankTrackers(const QList<TrackerEntry> &trackers, int limit) const;
+
+        static QString trackerHost(const QString &url);
+
+    private:
+        struct Stats
+        {
+            // trackers without any results are considered as moderately healthy to give them a chance
+            qreal successRate = 0.5;
+            qreal latency = -1;
+            int consecutiveFailures = 0;
+            std::chrono::steady_clock::time_point lastFailureTime;
+        };
+
+        static bool isFailing(const Stats &stats, std::chrono::steady_clock::time_point now);
+        static qreal score(const Stats &stats);
+
+        mutable QMutex m_mutex;
+        QHash<QString, Stats> m_stats;
+    };
+}
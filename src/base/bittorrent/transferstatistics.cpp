@@ -0,0 +1,97 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "transferstatistics.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace BitTorrent;
+
+bool TransferTotals::isEmpty() const
+{
+    return (downloaded == 0) && (uploaded == 0);
+}
+
+TransferTotals &TransferTotals::operator+=(const TransferTotals &other)
+{
+    downloaded += other.downloaded;
+    uploaded += other.uploaded;
+    return *this;
+}
+
+bool TransferStatistics::Pending::isEmpty() const
+{
+    return allTime.isEmpty() && days.isEmpty() && categories.isEmpty() && trackers.isEmpty();
+}
+
+void TransferStatistics::addSessionTransfer(const QDate &day, const TransferTotals &transferred)
+{
+    if (transferred.isEmpty())
+        return;
+
+    m_pending.allTime += transferred;
+    m_pending.days[day] += transferred;
+}
+
+void TransferStatistics::updateTorrent(const TorrentID &id, const QString &category, const QString &trackerHost, const TransferTotals &totals)
+{
+    const auto it = m_torrentTotals.find(id);
+    if (it == m_torrentTotals.end())
+    {
+        m_torrentTotals.insert(id, totals);
+        return;
+    }
+
+    const TransferTotals previous = std::exchange(*it, totals);
+    // counters may go back if torrent is re-added, they are only taken as the new base then
+    const TransferTotals transferred {
+        .downloaded = std::max<qint64>((totals.downloaded - previous.downloaded), 0),
+        .uploaded = std::max<qint64>((totals.uploaded - previous.uploaded), 0)};
+    if (transferred.isEmpty())
+        return;
+
+    m_pending.categories[category] += transferred;
+    if (!trackerHost.isEmpty())
+        m_pending.trackers[trackerHost] += transferred;
+}
+
+void TransferStatistics::removeTorrent(const TorrentID &id)
+{
+    m_torrentTotals.remove(id);
+}
+
+bool TransferStatistics::hasPending() const
+{
+    return !m_pending.isEmpty();
+}
+
+TransferStatistics::Pending TransferStatistics::takePending()
+{
+    return std::exchange(m_pending, {});
+}
@@ -0,0 +1,77 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    struct TransferTotals
+    {
+        qint64 downloaded = 0;
+        qint64 uploaded = 0;
+
+        bool isEmpty() const;
+        TransferTotals &operator+=(const TransferTotals &other);
+    };
+
+    // Accumulates transferred data that isn't written to the storage yet.
+    // Session wide totals are split by day, while the data transferred by torrents
+    // is split by their category and by the tracker they are announced to.
+    class TransferStatistics
+    {
+    public:
+        struct Pending
+        {
+            TransferTotals allTime;
+            QHash<QDate, TransferTotals> days;
+            QHash<QString, TransferTotals> categories;
+            QHash<QString, TransferTotals> trackers;
+
+            bool isEmpty() const;
+        };
+
+        void addSessionTransfer(const QDate &day, const TransferTotals &transferred);
+        // the data transferred by torrent is the difference from its previously known totals,
+        // nothing is counted when torrent is seen for the first time
+        void updateTorrent(const TorrentID &id, const QString &category, const QString &trackerHost, const TransferTotals &totals);
+        void removeTorrent(const TorrentID &id);
+
+        bool hasPending() const;
+        Pending takePending();
+
+    private:
+        QHash<TorrentID, TransferTotals> m_torrentTotals;
+        Pending m_pending;
+    };
+}
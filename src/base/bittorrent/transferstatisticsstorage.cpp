@@ -0,0 +1,219 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "transferstatisticsstorage.h"
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+
+#include "base/exceptions.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/profile.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const QString TABLE_NAME = u"transfer_totals"_s;
+
+    void createTable(QSqlDatabase &db)
+    {
+        const auto createTableStatement = u"CREATE TABLE IF NOT EXISTS '%1' (kind INTEGER NOT NULL, name TEXT NOT NULL"
+                " , downloaded INTEGER NOT NULL DEFAULT 0, uploaded INTEGER NOT NULL DEFAULT 0"
+                " , PRIMARY KEY (kind, name)) WITHOUT ROWID;"_s.arg(TABLE_NAME);
+
+        QSqlQuery query {db};
+        if (!query.exec(createTableStatement))
+            throw RuntimeError(query.lastError().text());
+    }
+}
+
+class TransferStatisticsStorage::Worker final : public QObject
+{
+    Q_DISABLE_COPY_MOVE(Worker)
+
+public:
+    explicit Worker(const Path &dbPath);
+
+    void store(const TransferStatistics::Pending &pending);
+    void close();
+
+private:
+    bool add(QSqlQuery &query, Kind kind, const QString &name, const TransferTotals &totals);
+
+    const Path m_path;
+    const QString m_connectionName;
+};
+
+TransferStatisticsStorage::TransferStatisticsStorage(const Path &dbPath, QObject *parent)
+    : QObject(parent)
+    , m_connectionName {u"TransferStatistics-%1"_s.arg(reinterpret_cast<quintptr>(this), 0, 16)}
+    , m_ioThread {new QThread}
+{
+    auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, m_connectionName);
+    db.setDatabaseName(dbPath.data());
+    if (!db.open())
+    {
+        const QString errorMessage = db.lastError().text();
+        db = {};
+        QSqlDatabase::removeDatabase(m_connectionName);
+        throw RuntimeError(errorMessage);
+    }
+
+    createTable(db);
+
+    m_asyncWorker = new Worker(dbPath);
+    m_asyncWorker->moveToThread(m_ioThread.get());
+    connect(m_ioThread.get(), &QThread::finished, m_asyncWorker, &QObject::deleteLater);
+    m_ioThread->start();
+}
+
+TransferStatisticsStorage::~TransferStatisticsStorage()
+{
+    // the changes which are already queued get written before the worker connection is closed
+    QMetaObject::invokeMethod(m_asyncWorker, [worker = m_asyncWorker] { worker->close(); }, Qt::BlockingQueuedConnection);
+
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+Path TransferStatisticsStorage::defaultPath()
+{
+    return specialFolderLocation(SpecialFolder::Data) / Path(u"statistics.db"_s);
+}
+
+TransferTotals TransferStatisticsStorage::loadAllTime() const
+{
+    return load(Kind::AllTime).value(QString());
+}
+
+QHash<QString, TransferTotals> TransferStatisticsStorage::load(const Kind kind) const
+{
+    const auto selectStatement = u"SELECT name, downloaded, uploaded FROM '%1' WHERE kind = :kind;"_s.arg(TABLE_NAME);
+
+    QSqlQuery query {QSqlDatabase::database(m_connectionName)};
+    query.setForwardOnly(true);
+    if (!query.prepare(selectStatement))
+        return {};
+
+    query.bindValue(u":kind"_s, static_cast<int>(kind));
+    if (!query.exec())
+        return {};
+
+    QHash<QString, TransferTotals> result;
+    while (query.next())
+    {
+        result.insert(query.value(0).toString()
+                , {.downloaded = query.value(1).toLongLong(), .uploaded = query.value(2).toLongLong()});
+    }
+    return result;
+}
+
+void TransferStatisticsStorage::store(const TransferStatistics::Pending &pending) const
+{
+    if (pending.isEmpty())
+        return;
+
+    QMetaObject::invokeMethod(m_asyncWorker, [worker = m_asyncWorker, pending]
+    {
+        worker->store(pending);
+    });
+}
+
+TransferStatisticsStorage::Worker::Worker(const Path &dbPath)
+    : m_path {dbPath}
+    , m_connectionName {u"TransferStatisticsWorker-%1"_s.arg(reinterpret_cast<quintptr>(this), 0, 16)}
+{
+}
+
+void TransferStatisticsStorage::Worker::store(const TransferStatistics::Pending &pending)
+{
+    if (!QSqlDatabase::contains(m_connectionName))
+    {
+        auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, m_connectionName);
+        db.setDatabaseName(m_path.data());
+    }
+
+    auto db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen() || !db.transaction())
+    {
+        LogMsg(TransferStatisticsStorage::tr("Couldn't store transfer statistics. Error: %1").arg(db.lastError().text()), Log::WARNING);
+        return;
+    }
+
+    const auto upsertStatement = u"INSERT INTO '%1' (kind, name, downloaded, uploaded) VALUES (:kind, :name, :downloaded, :uploaded)"
+            " ON CONFLICT (kind, name) DO UPDATE SET downloaded = downloaded + excluded.downloaded"
+            " , uploaded = uploaded + excluded.uploaded;"_s.arg(TABLE_NAME);
+
+    QSqlQuery query {db};
+    bool ok = query.prepare(upsertStatement);
+    if (ok)
+    {
+        ok = add(query, Kind::AllTime, {}, pending.allTime);
+        for (auto it = pending.days.cbegin(); ok && (it != pending.days.cend()); ++it)
+            ok = add(query, Kind::Day, it.key().toString(Qt::ISODate), it.value());
+        for (auto it = pending.categories.cbegin(); ok && (it != pending.categories.cend()); ++it)
+            ok = add(query, Kind::Category, it.key(), it.value());
+        for (auto it = pending.trackers.cbegin(); ok && (it != pending.trackers.cend()); ++it)
+            ok = add(query, Kind::Tracker, it.key(), it.value());
+    }
+
+    if (!ok)
+    {
+        LogMsg(TransferStatisticsStorage::tr("Couldn't store transfer statistics. Error: %1").arg(query.lastError().text()), Log::WARNING);
+        db.rollback();
+        return;
+    }
+
+    if (!db.commit())
+        LogMsg(TransferStatisticsStorage::tr("Couldn't store transfer statistics. Error: %1").arg(db.lastError().text()), Log::WARNING);
+}
+
+void TransferStatisticsStorage::Worker::close()
+{
+    if (!QSqlDatabase::contains(m_connectionName))
+        return;
+
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool TransferStatisticsStorage::Worker::add(QSqlQuery &query, const Kind kind, const QString &name, const TransferTotals &totals)
+{
+    if (totals.isEmpty())
+        return true;
+
+    query.bindValue(u":kind"_s, static_cast<int>(kind));
+    query.bindValue(u":name"_s, name);
+    query.bindValue(u":downloaded"_s, totals.downloaded);
+    query.bindValue(u":uploaded"_s, totals.uploaded);
+    return query.exec();
+}
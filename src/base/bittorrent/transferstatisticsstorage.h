@@ -0,0 +1,76 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include "base/path.h"
+#include "base/utils/thread.h"
+#include "transferstatistics.h"
+
+namespace BitTorrent
+{
+    // Transfer totals are stored in the database apart from the settings, so they can be
+    // written often without rewriting any settings file. The writes are performed in
+    // worker thread, while loading is only expected at startup.
+    class TransferStatisticsStorage final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(TransferStatisticsStorage)
+
+    public:
+        enum class Kind
+        {
+            AllTime = 0,
+            Day = 1,
+            Category = 2,
+            Tracker = 3
+        };
+
+        explicit TransferStatisticsStorage(const Path &dbPath, QObject *parent = nullptr);
+        ~TransferStatisticsStorage() override;
+
+        static Path defaultPath();
+
+        TransferTotals loadAllTime() const;
+        QHash<QString, TransferTotals> load(Kind kind) const;
+
+        // pending totals are added to the stored ones
+        void store(const TransferStatistics::Pending &pending) const;
+
+    private:
+        class Worker;
+
+        const QString m_connectionName;
+        Utils::Thread::UniquePtr m_ioThread;
+        Worker *m_asyncWorker = nullptr;
+    };
+}
@@ -0,0 +1,125 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <QHash>
+
+// Set keeping its values in a contiguous array, so they can be iterated without copying.
+// Values are removed by moving the last one in their place, so the order is not preserved.
+// Generation is changed on each modification, so the users can tell if the set is changed.
+template <typename T>
+class DenseSet
+{
+public:
+    using value_type = T;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    bool insert(const T &value)
+    {
+        if (m_indexes.contains(value))
+            return false;
+
+        m_indexes.insert(value, static_cast<qsizetype>(m_values.size()));
+        m_values.push_back(value);
+        ++m_generation;
+        return true;
+    }
+
+    bool remove(const T &value)
+    {
+        const auto indexIter = m_indexes.constFind(value);
+        if (indexIter == m_indexes.cend())
+            return false;
+
+        const qsizetype index = indexIter.value();
+        m_indexes.erase(indexIter);
+        if (index != static_cast<qsizetype>(m_values.size() - 1))
+        {
+            m_values[index] = std::move(m_values.back());
+            m_indexes[m_values[index]] = index;
+        }
+        m_values.pop_back();
+        ++m_generation;
+        return true;
+    }
+
+    void clear()
+    {
+        if (m_values.empty())
+            return;
+
+        m_values.clear();
+        m_indexes.clear();
+        ++m_generation;
+    }
+
+    bool contains(const T &value) const
+    {
+        return m_indexes.contains(value);
+    }
+
+    qsizetype size() const
+    {
+        return static_cast<qsizetype>(m_values.size());
+    }
+
+    bool isEmpty() const
+    {
+        return m_values.empty();
+    }
+
+    // The view is invalidated when the set is modified
+    std::span<const T> values() const
+    {
+        return m_values;
+    }
+
+    quint64 generation() const
+    {
+        return m_generation;
+    }
+
+    const_iterator begin() const
+    {
+        return m_values.cbegin();
+    }
+
+    const_iterator end() const
+    {
+        return m_values.cend();
+    }
+
+private:
+    std::vector<T> m_values;
+    QHash<T, qsizetype> m_indexes;
+    quint64 m_generation = 0;
+};
@@ -0,0 +1,92 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "byterange.h"
+
+#include <algorithm>
+
+#include <QStringView>
+
+using namespace Http;
+
+qint64 ByteRange::size() const
+{
+    return last - first + 1;
+}
+
+ByteRangeStatus Http::parseByteRange(QStringView headerValue, const qint64 resourceSize, ByteRange &range)
+{
+    // examples: "bytes=0-499", "bytes=500-", "bytes=-500"
+    headerValue = headerValue.trimmed();
+    const QStringView unitPrefix = u"bytes=";
+    if (!headerValue.startsWith(unitPrefix, Qt::CaseInsensitive))
+        return ByteRangeStatus::None;
+
+    const QStringView rangeSpec = headerValue.sliced(unitPrefix.size()).trimmed();
+    if (rangeSpec.contains(u','))
+        return ByteRangeStatus::None;
+
+    const qsizetype separatorPos = rangeSpec.indexOf(u'-');
+    if (separatorPos < 0)
+        return ByteRangeStatus::None;
+
+    const QStringView firstStr = rangeSpec.first(separatorPos).trimmed();
+    const QStringView lastStr = rangeSpec.sliced(separatorPos + 1).trimmed();
+
+    bool ok = false;
+    if (firstStr.isEmpty())
+    {
+        // suffix range, i.e. the last N bytes
+        const qint64 suffixLength = lastStr.toLongLong(&ok);
+        if (!ok || (suffixLength < 0))
+            return ByteRangeStatus::None;
+        if ((suffixLength == 0) || (resourceSize == 0))
+            return ByteRangeStatus::Unsatisfiable;
+
+        range = {.first = std::max<qint64>(0, (resourceSize - suffixLength)), .last = (resourceSize - 1)};
+        return ByteRangeStatus::Satisfiable;
+    }
+
+    const qint64 first = firstStr.toLongLong(&ok);
+    if (!ok || (first < 0))
+        return ByteRangeStatus::None;
+
+    qint64 last = resourceSize - 1;
+    if (!lastStr.isEmpty())
+    {
+        last = lastStr.toLongLong(&ok);
+        if (!ok || (last < first))
+            return ByteRangeStatus::None;
+    }
+
+    if (first >= resourceSize)
+        return ByteRangeStatus::Unsatisfiable;
+
+    range = {.first = first, .last = std::min(last, (resourceSize - 1))};
+    return ByteRangeStatus::Satisfiable;
+}
@@ -30,21 +30,43 @@
 
 #include "connection.h"
 
+#include <QSslConfiguration>
+#include <QSslSocket>
 #include <QTcpSocket>
 
-#include "irequesthandler.h"
-#include "requestparser.h"
+#include "base/utils/gzip.h"
+#include "http2session.h"
 #include "responsegenerator.h"
+#include "responsestream.h"
 
 using namespace Http;
 
-Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent)
+namespace
+{
+    // smaller content is sent together with the headers, larger one is passed to the socket
+    // as is so it only shares the data instead of copying it
+    const qsizetype MIN_SEPARATE_CONTENT_SIZE = 16 * 1024;
+
+    // lower compression level keeps up with the streams produced as fast as they are sent
+    const int STREAM_COMPRESSION_LEVEL = 4;
+}
+
+Connection::Connection(QTcpSocket *socket, RequestDispatcher dispatcher, QObject *parent)
     : QObject(parent)
     , m_socket(socket)
-    , m_requestHandler(requestHandler)
+    , m_dispatcher(std::move(dispatcher))
 {
     m_socket->setParent(this);
     connect(m_socket, &QAbstractSocket::disconnected, this, &Connection::closed);
+    if (auto *sslSocket = qobject_cast<QSslSocket *>(m_socket))
+    {
+        connect(sslSocket, &QSslSocket::encrypted, this, [this, sslSocket]
+        {
+            // [rfc9113] 3.2. Starting HTTP/2 for "https" URIs
+            if (sslSocket->sslConfiguration().nextNegotiatedProtocol() == QSslConfiguration::ALPNProtocolHTTP2)
+                startHttp2Session();
+        });
+    }
 
     // reserve common size for requests, don't use the max allowed size which is too big for
     // memory constrained platforms
@@ -57,12 +79,43 @@ Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObj
         m_idleTimer.start();
         read();
     });
-    connect(m_socket, &QIODevice::bytesWritten, this, [this]()
+    connect(m_socket, &QIODevice::bytesWritten, this, [this](const qint64 bytes)
     {
         m_idleTimer.start();
+        if (m_http2Session)
+            m_http2Session->sendPendingData();
+        else if (m_stream)
+            handleStreamDataSent(bytes);
     });
 }
 
+Connection::~Connection()
+{
+    if (m_stream)
+        m_stream->detach();
+}
+
+void Connection::startHttp2Session()
+{
+    const auto writer = [this](const QByteArray &data)
+    {
+        m_socket->write(data);
+    };
+    const auto pendingSizeGetter = [this]
+    {
+        return m_socket->bytesToWrite();
+    };
+    const auto dispatcher = [this](const quint32 streamID, Request request)
+    {
+        m_idleTimer.start();
+        Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
+        m_dispatcher(streamID, std::move(request), std::move(env));
+    };
+
+    m_http2Session = std::make_unique<Http2Session>(writer, pendingSizeGetter, dispatcher);
+    m_http2Session->start();
+}
+
 void Connection::read()
 {
     // reuse existing buffer and avoid unnecessary memory allocation/relocation
@@ -78,14 +131,37 @@ void Connection::read()
     if (bytesRead < bytesAvailable) [[unlikely]]
         m_receivedData.chop(bytesAvailable - bytesRead);
 
-    while (!m_receivedData.isEmpty())
+    if (m_http2Session)
     {
-        const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
+        // the session keeps incomplete frames itself
+        const bool isOK = m_http2Session->receive(m_receivedData);
+        m_receivedData.clear();
+        if (!isOK)
+            m_socket->disconnectFromHost();
+        return;
+    }
+
+    processReceivedData();
+}
+
+void Connection::processReceivedData()
+{
+    // pipelined requests are parsed one after another from the same buffer,
+    // consumed data is only removed once all the complete requests are handled.
+    // Parser keeps the state of incomplete request, so the data consumed by it is removed
+    // as well and parsing continues with newly received data
+    qsizetype offset = 0;
+    while (!m_isProcessingRequest && (offset < m_receivedData.size()))
+    {
+        RequestParser::ParseResult result = m_requestParser.parse(QByteArrayView(m_receivedData).sliced(offset));
+        offset += result.consumedSize;
 
         switch (result.status)
         {
         case RequestParser::ParseStatus::Incomplete:
             {
+                m_receivedData.remove(0, offset);
+
                 const long bufferLimit = RequestParser::MAX_CONTENT_SIZE * 1.1;  // some margin for headers
                 if (m_receivedData.size() > bufferLimit)
                 {
@@ -129,33 +205,18 @@ void Connection::read()
 
         case RequestParser::ParseStatus::OK:
             {
-                const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
-
-                if (result.request.method == HEADER_REQUEST_METHOD_HEAD)
-                {
-                    Request getRequest = result.request;
-                    getRequest.method = HEADER_REQUEST_METHOD_GET;
+                Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
 
-                    Response resp = m_requestHandler->processRequest(getRequest, env);
-
-                    resp.headers[HEADER_CONNECTION] = u"keep-alive"_s;
-                    resp.headers[HEADER_CONTENT_LENGTH] = QString::number(resp.content.length());
-                    resp.content.clear();
-
-                    sendResponse(resp);
-                }
+                Request request = std::move(result.request);
+                m_isHeadRequest = (request.method == HEADER_REQUEST_METHOD_HEAD);
+                if (m_isHeadRequest)
+                    request.method = HEADER_REQUEST_METHOD_GET;
                 else
-                {
-                    Response resp = m_requestHandler->processRequest(result.request, env);
-
-                    if (acceptsGzipEncoding(result.request.headers.value(u"accept-encoding"_s)))
-                        resp.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
-                    resp.headers[HEADER_CONNECTION] = u"keep-alive"_s;
-
-                    sendResponse(resp);
-                }
+                    m_acceptsGzipEncoding = acceptsGzipEncoding(request.headers.value(u"accept-encoding"_s));
+                m_supportsChunkedEncoding = (request.version != u"1.0");
 
-                m_receivedData.remove(0, result.frameSize);
+                m_isProcessingRequest = true;
+                m_dispatcher(0, std::move(request), std::move(env));
             }
             break;
 
@@ -164,59 +225,214 @@ void Connection::read()
             return;
         }
     }
+
+    m_receivedData.remove(0, offset);
+}
+
+void Connection::handleResponse(const quint32 requestID, Response response)
+{
+    if (m_http2Session)
+    {
+        m_idleTimer.start();
+        m_http2Session->sendResponse(requestID, std::move(response));
+        return;
+    }
+
+    Q_ASSERT(m_isProcessingRequest);
+    m_isProcessingRequest = false;
+    m_idleTimer.start();
+
+    if (response.stream)
+    {
+        // keep the request marked as being processed, streamed data continues until the connection is closed
+        m_isProcessingRequest = true;
+        m_stream = response.stream;
+        response.gzipContent.clear();
+        response.headers[HEADER_CONNECTION] = u"keep-alive"_s;
+        response.headers[HEADER_CACHE_CONTROL] = u"no-cache"_s;
+
+        if (m_isHeadRequest)
+        {
+            m_isStreamChunked = false;
+            response.content.clear();
+            sendResponse(std::move(response));
+            finishStream();
+            return;
+        }
+
+        // length of the stream isn't known in advance unless the handler sets it
+        m_isStreamChunked = m_supportsChunkedEncoding && !response.headers.contains(HEADER_CONTENT_LENGTH);
+        if (m_isStreamChunked)
+        {
+            response.headers[HEADER_TRANSFER_ENCODING] = u"chunked"_s;
+            if (m_acceptsGzipEncoding && isCompressibleStream(response.headers.value(HEADER_CONTENT_TYPE)))
+            {
+                response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
+                m_streamCompressor = std::make_unique<Utils::Gzip::Compressor>(STREAM_COMPRESSION_LEVEL);
+            }
+        }
+
+        // the content is sent as the beginning of the stream
+        const QByteArray content = std::exchange(response.content, {});
+        sendResponse(std::move(response));
+
+        m_streamChunks.clear();
+        m_streamQueuedSize = 0;
+        m_streamSentSize = -m_socket->bytesToWrite();
+
+        bool isClosed = false;
+        const QByteArray pendingData = m_stream->start(isClosed);
+        writeStreamData(content, 0);
+        writeStreamData(pendingData, pendingData.size());
+        if (isClosed)
+            finishStream();
+        return;
+    }
+
+    if (m_isHeadRequest)
+    {
+        response.headers[HEADER_CONNECTION] = u"keep-alive"_s;
+        response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
+        response.content.clear();
+        response.gzipContent.clear();
+    }
+    else
+    {
+        if (m_acceptsGzipEncoding)
+            response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
+        response.headers[HEADER_CONNECTION] = u"keep-alive"_s;
+    }
+
+    sendResponse(std::move(response));
+
+    // continue with the requests received while this one was processed
+    processReceivedData();
 }
 
-void Connection::sendResponse(const Response &response) const
+void Connection::writeStream(const ResponseStream *stream, const QByteArray &data)
 {
-    m_socket->write(toByteArray(response));
+    if (m_http2Session)
+    {
+        m_idleTimer.start();
+        m_http2Session->writeStream(stream, data);
+        return;
+    }
+
+    if (!m_stream || (m_stream.get() != stream))
+        return;
+
+    writeStreamData(data, data.size());
 }
 
-bool Connection::hasExpired(const qint64 timeout) const
+void Connection::closeStream(const ResponseStream *stream)
 {
-    return (m_socket->bytesAvailable() == 0)
-        && (m_socket->bytesToWrite() == 0)
-        && m_idleTimer.hasExpired(timeout);
+    if (m_http2Session)
+    {
+        m_http2Session->closeStream(stream);
+        return;
+    }
+
+    if (!m_stream || (m_stream.get() != stream))
+        return;
+
+    finishStream();
 }
 
-bool Connection::acceptsGzipEncoding(QString codings)
+void Connection::writeStreamData(QByteArray data, const qint64 size)
 {
-    // [rfc7231] 5.3.4. Accept-Encoding
+    if (data.isEmpty())
+        return;
 
-    const auto isCodingAvailable = [](const QList<QStringView> &list, const QStringView encoding) -> bool
+    m_idleTimer.start();
+
+    if (m_streamCompressor)
     {
-        for (const QStringView &str : list)
+        QByteArray compressedData;
+        if (!m_streamCompressor->compress(data, compressedData)) [[unlikely]]
         {
-            if (!str.startsWith(encoding))
-                continue;
+            m_stream->detach();
+            m_socket->abort();
+            return;
+        }
+        data = std::move(compressedData);
+    }
 
-            // without quality values
-            if (str == encoding)
-                return true;
+    qint64 writtenSize = data.size();
+    if (m_isStreamChunked)
+    {
+        // [rfc9112] 7.1. Chunked Transfer Coding
+        const QByteArray chunkHeader = QByteArray::number(data.size(), 16) + CRLF;
+        m_socket->write(chunkHeader);
+        m_socket->write(data);
+        m_socket->write(CRLF);
+        writtenSize += chunkHeader.size() + 2;
+    }
+    else
+    {
+        m_socket->write(data);
+    }
 
-            // [rfc7231] 5.3.1. Quality Values
-            const QStringView substr = str.mid(encoding.size() + 3);  // ex. skip over "gzip;q="
+    m_streamQueuedSize += writtenSize;
+    m_streamChunks.emplaceBack(m_streamQueuedSize, size);
+}
 
-            bool ok = false;
-            const double qvalue = substr.toDouble(&ok);
-            if (!ok || (qvalue <= 0))
-                return false;
+void Connection::finishStream()
+{
+    m_stream->detach();
 
-            return true;
-        }
-        return false;
-    };
+    if (!m_isStreamChunked)
+    {
+        m_socket->disconnectFromHost();
+        return;
+    }
 
-    const QList<QStringView> list = QStringView(codings.remove(u' ').remove(u'\t')).split(u',', Qt::SkipEmptyParts);
-    if (list.isEmpty())
-        return false;
+    if (m_streamCompressor)
+    {
+        QByteArray streamEnd;
+        m_streamCompressor->finish(streamEnd);
+        m_streamCompressor.reset();
+        writeStreamData(streamEnd, 0);
+    }
 
-    const bool canGzip = isCodingAvailable(list, u"gzip"_s);
-    if (canGzip)
-        return true;
+    // last chunk without any trailer fields
+    m_socket->write(QByteArray("0") + CRLF + CRLF);
 
-    const bool canAny = isCodingAvailable(list, u"*"_s);
-    if (canAny)
-        return true;
+    m_stream.reset();
+    m_streamChunks.clear();
+    m_isStreamChunked = false;
+    m_isProcessingRequest = false;
+    m_idleTimer.start();
 
-    return false;
+    // continue with the requests received while the stream was sent
+    processReceivedData();
+}
+
+void Connection::handleStreamDataSent(const qint64 bytes)
+{
+    m_streamSentSize += bytes;
+    while (!m_streamChunks.isEmpty() && (m_streamChunks.first().first <= m_streamSentSize))
+        m_stream->handleDataSent(m_streamChunks.takeFirst().second);
+}
+
+void Connection::sendResponse(Response response) const
+{
+    QByteArray header = serializeHeader(response);
+    if (response.content.size() < MIN_SEPARATE_CONTENT_SIZE)
+    {
+        header += response.content;
+        m_socket->write(header);
+        return;
+    }
+
+    m_socket->write(header);
+    m_socket->write(response.content);
+}
+
+bool Connection::hasExpired(const qint64 timeout) const
+{
+    return !m_isProcessingRequest
+        && !(m_http2Session && m_http2Session->hasActiveStreams())
+        && (m_socket->bytesAvailable() == 0)
+        && (m_socket->bytesToWrite() == 0)
+        && m_idleTimer.hasExpired(timeout);
 }
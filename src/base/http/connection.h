@@ -30,15 +30,27 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <utility>
+
 #include <QElapsedTimer>
+#include <QList>
 #include <QObject>
 
+#include "requestparser.h"
+#include "types.h"
+
 class QTcpSocket;
 
+namespace Utils::Gzip
+{
+    class Compressor;
+}
+
 namespace Http
 {
-    class IRequestHandler;
-    struct Response;
+    class Http2Session;
 
     class Connection : public QObject
     {
@@ -46,21 +58,58 @@ namespace Http
         Q_DISABLE_COPY_MOVE(Connection)
 
     public:
-        Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent = nullptr);
+        // Dispatcher passes request to its handler and later delivers the result via `handleResponse()`,
+        // it must not call `handleResponse()` synchronously.
+        // `requestID` tells apart concurrent requests of HTTP/2 connection, it's 0 for HTTP/1.x
+        using RequestDispatcher = std::function<void (quint32 requestID, Request request, Environment env)>;
+
+        Connection(QTcpSocket *socket, RequestDispatcher dispatcher, QObject *parent = nullptr);
+        ~Connection() override;
 
         bool hasExpired(qint64 timeout) const;
+        void handleResponse(quint32 requestID, Response response);
+
+        void writeStream(const ResponseStream *stream, const QByteArray &data);
+        void closeStream(const ResponseStream *stream);
 
     signals:
         void closed();
 
     private:
-        static bool acceptsGzipEncoding(QString codings);
+        void startHttp2Session();
         void read();
-        void sendResponse(const Response &response) const;
+        void processReceivedData();
+        void sendResponse(Response response) const;
+        // `size` is the size of the data as it was written to the stream
+        void writeStreamData(QByteArray data, qint64 size);
+        void finishStream();
+        void handleStreamDataSent(qint64 bytes);
 
         QTcpSocket *m_socket = nullptr;
-        IRequestHandler *m_requestHandler = nullptr;
+        RequestDispatcher m_dispatcher;
+        // received data not consumed by the parser yet
         QByteArray m_receivedData;
+        RequestParser m_requestParser;
         QElapsedTimer m_idleTimer;
+
+        // requests are processed one at a time so pipelined responses are sent in order
+        bool m_isProcessingRequest = false;
+        bool m_isHeadRequest = false;
+        bool m_acceptsGzipEncoding = false;
+        bool m_supportsChunkedEncoding = false;
+
+        // no further requests are processed on this connection while streamed response is sent,
+        // the stream without chunked transfer coding ends when the connection is closed
+        std::shared_ptr<ResponseStream> m_stream;
+        bool m_isStreamChunked = false;
+        std::unique_ptr<Utils::Gzip::Compressor> m_streamCompressor;
+        // written chunks by the offset of their end in the socket data, with their size as written to the stream,
+        // so the stream is told how much of its data is sent even if it's compressed
+        QList<std::pair<qint64, qint64>> m_streamChunks;
+        qint64 m_streamQueuedSize = 0;
+        qint64 m_streamSentSize = 0;
+
+        // set once HTTP/2 is negotiated, the session handles all the requests of the connection then
+        std::unique_ptr<Http2Session> m_http2Session;
     };
 }
@@ -0,0 +1,216 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "connectionpool.h"
+
+#include <chrono>
+#include <memory>
+#include <new>
+
+#include <QtLogging>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QSslSocket>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "connection.h"
+#include "irequesthandler.h"
+#include "responsestream.h"
+#include "server.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    const int KEEP_ALIVE_DURATION = std::chrono::milliseconds(7s).count();
+    const std::chrono::seconds CONNECTIONS_SCAN_INTERVAL {2};
+    // sessions issued with the previous keys can't be resumed after the rotation
+    const std::chrono::hours TLS_SESSION_KEYS_LIFETIME {12};
+}
+
+using namespace Http;
+
+ConnectionPool::ConnectionPool(IRequestHandler *requestHandler, QObject *handlerContext)
+    : m_requestHandler(requestHandler)
+    , m_handlerContext(handlerContext)
+{
+    auto *dropConnectionTimer = new QTimer(this);
+    connect(dropConnectionTimer, &QTimer::timeout, this, &ConnectionPool::dropTimedOutConnections);
+    dropConnectionTimer->start(CONNECTIONS_SCAN_INTERVAL);
+}
+
+void ConnectionPool::addConnection(const qintptr socketDescriptor, const bool https, const bool http2
+        , const QList<QSslCertificate> &certificates, const QSslKey &key)
+{
+    std::unique_ptr<QTcpSocket> serverSocket = https ? std::make_unique<QSslSocket>(this) : std::make_unique<QTcpSocket>(this);
+    if (!serverSocket->setSocketDescriptor(socketDescriptor))
+    {
+        emit connectionsRemoved(1);
+        return;
+    }
+
+    try
+    {
+        if (https)
+        {
+            auto *sslSocket = static_cast<QSslSocket *>(serverSocket.get());
+            sslSocket->setSslConfiguration(sslConfiguration(http2, certificates, key));
+
+            QElapsedTimer handshakeTimer;
+            handshakeTimer.start();
+            connect(sslSocket, &QSslSocket::encrypted, this
+                    , [this, sslSocket, handshakeTimer, revision = m_sslConfigurationRevision]
+            {
+                Server::addTLSHandshake(true, handshakeTimer.nsecsElapsed());
+                handleHandshakeFinished(revision, sslSocket->sslConfiguration());
+            });
+            connect(sslSocket, &QAbstractSocket::errorOccurred, this, [sslSocket, handshakeTimer](const QAbstractSocket::SocketError error)
+            {
+                if ((error == QAbstractSocket::SslHandshakeFailedError) && !sslSocket->isEncrypted())
+                    Server::addTLSHandshake(false, handshakeTimer.nsecsElapsed());
+            });
+
+            sslSocket->startServerEncryption();
+        }
+
+        const quint64 connectionID = ++m_lastConnectionID;
+        auto *connection = new Connection(serverSocket.release(), [this, connectionID](const quint32 requestID, Request request, Environment env)
+        {
+            dispatchRequest(connectionID, requestID, std::move(request), std::move(env));
+        }, this);
+        m_connections.insert(connectionID, connection);
+        connect(connection, &Connection::closed, this, [this, connectionID] { removeConnection(connectionID); });
+    }
+    catch (const std::bad_alloc &exception)
+    {
+        // drop the connection instead of throwing exception and crash
+        qWarning("Failed to allocate memory for HTTP connection. Connection closed.");
+        emit connectionsRemoved(1);
+    }
+}
+
+QSslConfiguration ConnectionPool::sslConfiguration(const bool http2, const QList<QSslCertificate> &certificates, const QSslKey &key)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const bool isExpired = (now - m_sslConfigurationCreationTime) >= TLS_SESSION_KEYS_LIFETIME;
+    if ((m_sslConfigurationRevision > 0) && !isExpired && (http2 == m_sslHttp2)
+            && (certificates == m_sslCertificates) && (key == m_sslKey))
+    {
+        return m_sslConfiguration;
+    }
+
+    QSslConfiguration sslConf = QSslConfiguration::defaultConfiguration();
+    if (http2)
+    {
+        // the protocol is negotiated with ALPN during the handshake
+        sslConf.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2, QSslConfiguration::NextProtocolHttp1_1});
+    }
+    sslConf.setProtocol(QSsl::SecureProtocols);
+    sslConf.setPrivateKey(key);
+    sslConf.setLocalCertificateChain(certificates);
+    sslConf.setPeerVerifyMode(QSslSocket::VerifyNone);
+    sslConf.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+    sslConf.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+
+    m_sslConfiguration = sslConf;
+    ++m_sslConfigurationRevision;
+    m_isSslConfigurationEstablished = false;
+    m_sslConfigurationCreationTime = now;
+    m_sslHttp2 = http2;
+    m_sslCertificates = certificates;
+    m_sslKey = key;
+    return m_sslConfiguration;
+}
+
+void ConnectionPool::handleHandshakeFinished(const quint64 sslConfigurationRevision, const QSslConfiguration &established)
+{
+    // the connections which were set up with outdated configuration must not bring back the old keys
+    if (m_isSslConfigurationEstablished || (sslConfigurationRevision != m_sslConfigurationRevision))
+        return;
+
+    m_sslConfiguration = established;
+    m_isSslConfigurationEstablished = true;
+}
+
+void ConnectionPool::dispatchRequest(const quint64 connectionID, const quint32 requestID, Request request, Environment env)
+{
+    QMetaObject::invokeMethod(m_handlerContext, [this, connectionID, requestID, request = std::move(request), env = std::move(env)]
+    {
+        Response response = m_requestHandler->processRequest(request, env);
+        if (response.stream)
+            response.stream->attach(this, connectionID);
+
+        // connection is looked up by its ID since it could be closed in the meantime
+        QMetaObject::invokeMethod(this, [this, connectionID, requestID, response = std::move(response)]() mutable
+        {
+            if (Connection *connection = m_connections.value(connectionID))
+                connection->handleResponse(requestID, std::move(response));
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void ConnectionPool::writeStream(const quint64 connectionID, const ResponseStream *stream, const QByteArray &data)
+{
+    if (Connection *connection = m_connections.value(connectionID))
+        connection->writeStream(stream, data);
+}
+
+void ConnectionPool::closeStream(const quint64 connectionID, const ResponseStream *stream)
+{
+    if (Connection *connection = m_connections.value(connectionID))
+        connection->closeStream(stream);
+}
+
+void ConnectionPool::removeConnection(const quint64 connectionID)
+{
+    Connection *connection = m_connections.take(connectionID);
+    if (!connection)
+        return;
+
+    connection->deleteLater();
+    emit connectionsRemoved(1);
+}
+
+void ConnectionPool::dropTimedOutConnections()
+{
+    int removedCount = 0;
+    m_connections.removeIf([&removedCount](const QHash<quint64, Connection *>::iterator it)
+    {
+        Connection *connection = it.value();
+        if (!connection->hasExpired(KEEP_ALIVE_DURATION))
+            return false;
+
+        connection->deleteLater();
+        ++removedCount;
+        return true;
+    });
+
+    if (removedCount > 0)
+        emit connectionsRemoved(removedCount);
+}
@@ -0,0 +1,93 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSslCertificate>
+#include <QSslConfiguration>
+#include <QSslKey>
+
+#include "types.h"
+
+namespace Http
+{
+    class Connection;
+    class IRequestHandler;
+
+    // Owns the connections handled by one I/O thread. Sockets, TLS, request parsing and
+    // response compression stay in that thread, only the requests themselves are processed
+    // by the handler in the thread of `handlerContext`.
+    class ConnectionPool final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(ConnectionPool)
+
+    public:
+        ConnectionPool(IRequestHandler *requestHandler, QObject *handlerContext);
+
+        // must be called in the thread of the pool, `http2` offers HTTP/2 to the clients of HTTPS connection
+        void addConnection(qintptr socketDescriptor, bool https, bool http2
+                , const QList<QSslCertificate> &certificates, const QSslKey &key);
+
+        // `stream` identifies the stream the data belongs to, the connection can continue with
+        // another one once the previous is closed
+        void writeStream(quint64 connectionID, const ResponseStream *stream, const QByteArray &data);
+        void closeStream(quint64 connectionID, const ResponseStream *stream);
+
+    signals:
+        void connectionsRemoved(int count);
+
+    private:
+        void dispatchRequest(quint64 connectionID, quint32 requestID, Request request, Environment env);
+        void removeConnection(quint64 connectionID);
+        void dropTimedOutConnections();
+        QSslConfiguration sslConfiguration(bool http2, const QList<QSslCertificate> &certificates, const QSslKey &key);
+        void handleHandshakeFinished(quint64 sslConfigurationRevision, const QSslConfiguration &established);
+
+        IRequestHandler *m_requestHandler = nullptr;
+        QObject *m_handlerContext = nullptr;
+        QHash<quint64, Connection *> m_connections;  // for tracking persistent connections
+        quint64 m_lastConnectionID = 0;
+
+        // TLS sessions (session cache and ticket keys) are kept by the SSL context shared through
+        // the configuration of the established connection, so reconnecting clients resume them
+        // instead of doing the full handshake. The context is recreated periodically to rotate the keys.
+        QSslConfiguration m_sslConfiguration;
+        quint64 m_sslConfigurationRevision = 0;
+        bool m_isSslConfigurationEstablished = false;
+        std::chrono::steady_clock::time_point m_sslConfigurationCreationTime;
+        bool m_sslHttp2 = false;
+        QList<QSslCertificate> m_sslCertificates;
+        QSslKey m_sslKey;
+    };
+}
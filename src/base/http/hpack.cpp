@@ -0,0 +1,645 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "hpack.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace
+{
+    using namespace Http::HPack;
+
+    // [rfc7541] Appendix A. Static Table Definition
+    const std::array<std::pair<const char *, const char *>, 61> STATIC_TABLE
+    {{
+        {":authority", ""},
+        {":method", "GET"},
+        {":method", "POST"},
+        {":path", "/"},
+        {":path", "/index.html"},
+        {":scheme", "http"},
+        {":scheme", "https"},
+        {":status", "200"},
+        {":status", "204"},
+        {":status", "206"},
+        {":status", "304"},
+        {":status", "400"},
+        {":status", "404"},
+        {":status", "500"},
+        {"accept-charset", ""},
+        {"accept-encoding", "gzip, deflate"},
+        {"accept-language", ""},
+        {"accept-ranges", ""},
+        {"accept", ""},
+        {"access-control-allow-origin", ""},
+        {"age", ""},
+        {"allow", ""},
+        {"authorization", ""},
+        {"cache-control", ""},
+        {"content-disposition", ""},
+        {"content-encoding", ""},
+        {"content-language", ""},
+        {"content-length", ""},
+        {"content-location", ""},
+        {"content-range", ""},
+        {"content-type", ""},
+        {"cookie", ""},
+        {"date", ""},
+        {"etag", ""},
+        {"expect", ""},
+        {"expires", ""},
+        {"from", ""},
+        {"host", ""},
+        {"if-match", ""},
+        {"if-modified-since", ""},
+        {"if-none-match", ""},
+        {"if-range", ""},
+        {"if-unmodified-since", ""},
+        {"last-modified", ""},
+        {"link", ""},
+        {"location", ""},
+        {"max-forwards", ""},
+        {"proxy-authenticate", ""},
+        {"proxy-authorization", ""},
+        {"range", ""},
+        {"referer", ""},
+        {"refresh", ""},
+        {"retry-after", ""},
+        {"server", ""},
+        {"set-cookie", ""},
+        {"strict-transport-security", ""},
+        {"transfer-encoding", ""},
+        {"user-agent", ""},
+        {"vary", ""},
+        {"via", ""},
+        {"www-authenticate", ""},
+    }};
+
+    // [rfc7541] 4.1. Calculating Table Size
+    const qsizetype ENTRY_OVERHEAD = 32;
+
+    // integers larger than this aren't expected in valid header blocks
+    const quint64 MAX_INTEGER = (1ULL << 32);
+
+    struct HuffmanCode
+    {
+        quint32 code;
+        int length;
+    };
+
+    // [rfc7541] Appendix B. Huffman Code, the last one is EOS
+    const std::array<HuffmanCode, 257> HUFFMAN_CODES
+    {{
+        {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28}, {0xfffffe4, 28}, {0xfffffe5, 28},
+        {0xfffffe6, 28}, {0xfffffe7, 28}, {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+        {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28}, {0xfffffed, 28}, {0xfffffee, 28},
+        {0xfffffef, 28}, {0xffffff0, 28}, {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+        {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28}, {0xffffff8, 28}, {0xffffff9, 28},
+        {0xffffffa, 28}, {0xffffffb, 28}, {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+        {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11}, {0x3fa, 10}, {0x3fb, 10},
+        {0xf9, 8}, {0x7fb, 11}, {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+        {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6}, {0x1a, 6}, {0x1b, 6},
+        {0x1c, 6}, {0x1d, 6}, {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+        {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10}, {0x1ffa, 13}, {0x21, 6},
+        {0x5d, 7}, {0x5e, 7}, {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+        {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7}, {0x67, 7}, {0x68, 7},
+        {0x69, 7}, {0x6a, 7}, {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+        {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7}, {0xfc, 8}, {0x73, 7},
+        {0xfd, 8}, {0x1ffb, 13}, {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+        {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5}, {0x24, 6}, {0x5, 5},
+        {0x25, 6}, {0x26, 6}, {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+        {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5}, {0x2b, 6}, {0x76, 7},
+        {0x2c, 6}, {0x8, 5}, {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+        {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15}, {0x7fc, 11}, {0x3ffd, 14},
+        {0x1ffd, 13}, {0xffffffc, 28}, {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+        {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23}, {0x3fffd6, 22}, {0x7fffda, 23},
+        {0x7fffdb, 23}, {0x7fffdc, 23}, {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+        {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23}, {0xffffee, 24}, {0x7fffe1, 23},
+        {0x7fffe2, 23}, {0x7fffe3, 23}, {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+        {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24}, {0x3fffda, 22}, {0x1fffdd, 21},
+        {0xfffe9, 20}, {0x3fffdb, 22}, {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+        {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24}, {0x1fffdf, 21}, {0x3fffdf, 22},
+        {0x7fffeb, 23}, {0x7fffec, 23}, {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+        {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23}, {0xfffea, 20}, {0x3fffe2, 22},
+        {0x3fffe3, 22}, {0x3fffe4, 22}, {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+        {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19}, {0x3fffe7, 22}, {0x7ffff2, 23},
+        {0x3fffe8, 22}, {0x1ffffec, 25}, {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+        {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25}, {0x7fff2, 19}, {0x1fffe3, 21},
+        {0x3ffffe6, 26}, {0x7ffffe0, 27}, {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+        {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26}, {0xffffffd, 28}, {0x7ffffe3, 27},
+        {0x7ffffe4, 27}, {0x7ffffe5, 27}, {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+        {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23}, {0x3fffea, 22}, {0x3fffeb, 22},
+        {0x1ffffee, 25}, {0x1ffffef, 25}, {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+        {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26}, {0x7ffffe7, 27}, {0x7ffffe8, 27},
+        {0x7ffffe9, 27}, {0x7ffffea, 27}, {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+        {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26}, {0x3fffffff, 30},
+    }};
+
+    const int HUFFMAN_EOS = 256;
+
+    // Binary tree of the Huffman codes, decoding follows it bit by bit
+    class HuffmanTree
+    {
+    public:
+        struct Node
+        {
+            std::array<qint16, 2> children {-1, -1};
+            qint16 symbol = -1;
+        };
+
+        HuffmanTree()
+        {
+            m_nodes.reserve(HUFFMAN_CODES.size() * 2);
+            m_nodes.emplaceBack();
+            for (qsizetype symbol = 0; symbol < static_cast<qsizetype>(HUFFMAN_CODES.size()); ++symbol)
+            {
+                const HuffmanCode &code = HUFFMAN_CODES[symbol];
+                qsizetype node = 0;
+                for (int bit = (code.length - 1); bit >= 0; --bit)
+                {
+                    const int branch = (code.code >> bit) & 1;
+                    if (m_nodes[node].children[branch] < 0)
+                    {
+                        m_nodes[node].children[branch] = static_cast<qint16>(m_nodes.size());
+                        m_nodes.emplaceBack();
+                    }
+                    node = m_nodes[node].children[branch];
+                }
+                m_nodes[node].symbol = static_cast<qint16>(symbol);
+            }
+        }
+
+        const Node &node(const qsizetype index) const
+        {
+            return m_nodes[index];
+        }
+
+    private:
+        QList<Node> m_nodes;
+    };
+
+    const HuffmanTree &huffmanTree()
+    {
+        static const HuffmanTree tree;
+        return tree;
+    }
+
+    qsizetype entrySize(const HeaderField &field)
+    {
+        return field.name.size() + field.value.size() + ENTRY_OVERHEAD;
+    }
+
+    qsizetype staticIndexOf(const HeaderField &field)
+    {
+        for (qsizetype i = 0; i < static_cast<qsizetype>(STATIC_TABLE.size()); ++i)
+        {
+            if ((field.name == STATIC_TABLE[i].first) && (field.value == STATIC_TABLE[i].second))
+                return (i + 1);
+        }
+        return 0;
+    }
+
+    qsizetype staticIndexOfName(const QByteArrayView name)
+    {
+        for (qsizetype i = 0; i < static_cast<qsizetype>(STATIC_TABLE.size()); ++i)
+        {
+            if (name == STATIC_TABLE[i].first)
+                return (i + 1);
+        }
+        return 0;
+    }
+
+    // Values of these headers are mostly the same in all the responses, so they are worth storing in the table.
+    // The other ones are either unique (e.g. date, content-length) or sensitive.
+    bool isIndexable(const QByteArrayView name)
+    {
+        static const std::array<QByteArrayView, 12> indexableNames
+        {
+            "accept-ranges", "cache-control", "content-encoding", "content-security-policy", "content-type"
+            , "cross-origin-opener-policy", "referrer-policy", "server", "vary", "x-content-type-options"
+            , "x-frame-options", "x-xss-protection"
+        };
+        return std::find(indexableNames.cbegin(), indexableNames.cend(), name) != indexableNames.cend();
+    }
+
+    bool isSensitive(const QByteArrayView name)
+    {
+        return (name == "set-cookie") || (name == "authorization") || (name == "cookie");
+    }
+
+    void encodeString(const QByteArrayView data, QByteArray &output)
+    {
+        // [rfc7541] 5.2. String Literal Representation
+        if (const qsizetype encodedSize = huffmanEncodedSize(data); encodedSize < data.size())
+        {
+            encodeInteger(encodedSize, 7, 0x80, output);
+            huffmanEncode(data, output);
+        }
+        else
+        {
+            encodeInteger(data.size(), 7, 0x00, output);
+            output.append(data);
+        }
+    }
+
+    bool decodeString(const QByteArrayView data, qsizetype &pos, QByteArray &output)
+    {
+        if (pos >= data.size())
+            return false;
+
+        const bool isHuffmanEncoded = (static_cast<quint8>(data[pos]) & 0x80);
+        quint64 length = 0;
+        if (!decodeInteger(data, pos, 7, length) || (length > static_cast<quint64>(data.size() - pos)))
+            return false;
+
+        const QByteArrayView stringData = data.sliced(pos, static_cast<qsizetype>(length));
+        pos += static_cast<qsizetype>(length);
+        if (!isHuffmanEncoded)
+        {
+            output = stringData.toByteArray();
+            return true;
+        }
+
+        output.clear();
+        return huffmanDecode(stringData, output);
+    }
+}
+
+Http::HPack::DynamicTable::DynamicTable(const qsizetype maxSize)
+    : m_maxSize {maxSize}
+{
+}
+
+qsizetype Http::HPack::DynamicTable::count() const
+{
+    return m_entries.size();
+}
+
+qsizetype Http::HPack::DynamicTable::size() const
+{
+    return m_size;
+}
+
+qsizetype Http::HPack::DynamicTable::maxSize() const
+{
+    return m_maxSize;
+}
+
+void Http::HPack::DynamicTable::setMaxSize(const qsizetype maxSize)
+{
+    m_maxSize = maxSize;
+    evict(m_maxSize);
+}
+
+const HeaderField &Http::HPack::DynamicTable::at(const qsizetype index) const
+{
+    return m_entries[index];
+}
+
+qsizetype Http::HPack::DynamicTable::indexOf(const HeaderField &field) const
+{
+    return m_entries.indexOf(field);
+}
+
+qsizetype Http::HPack::DynamicTable::indexOfName(const QByteArrayView name) const
+{
+    const auto it = std::find_if(m_entries.cbegin(), m_entries.cend(), [name](const HeaderField &entry)
+    {
+        return entry.name == name;
+    });
+    return (it != m_entries.cend()) ? (it - m_entries.cbegin()) : -1;
+}
+
+void Http::HPack::DynamicTable::insert(HeaderField field)
+{
+    // [rfc7541] 4.4. Entry Eviction When Adding New Entries
+    const qsizetype size = entrySize(field);
+    if (size > m_maxSize)
+    {
+        // table is emptied by too large entry
+        evict(0);
+        return;
+    }
+
+    evict(m_maxSize - size);
+    m_entries.prepend(std::move(field));
+    m_size += size;
+}
+
+void Http::HPack::DynamicTable::evict(const qsizetype maxSize)
+{
+    while (m_size > maxSize)
+        m_size -= entrySize(m_entries.takeLast());
+}
+
+Http::HPack::Decoder::Decoder(const qsizetype maxTableSize)
+    : m_table {maxTableSize}
+    , m_maxTableSize {maxTableSize}
+{
+}
+
+const HeaderField *Http::HPack::Decoder::field(const quint64 index) const
+{
+    // [rfc7541] 2.3.3. Index Address Space
+    if (index == 0)
+        return nullptr;
+
+    if (index <= STATIC_TABLE.size())
+    {
+        static const QList<HeaderField> staticFields = []
+        {
+            QList<HeaderField> fields;
+            fields.reserve(STATIC_TABLE.size());
+            for (const auto &[name, value] : STATIC_TABLE)
+                fields.append({QByteArray(name), QByteArray(value)});
+            return fields;
+        }();
+        return &staticFields[index - 1];
+    }
+
+    const quint64 dynamicIndex = index - STATIC_TABLE.size() - 1;
+    if (dynamicIndex >= static_cast<quint64>(m_table.count()))
+        return nullptr;
+    return &m_table.at(static_cast<qsizetype>(dynamicIndex));
+}
+
+bool Http::HPack::Decoder::decode(const QByteArrayView block, HeaderList &headers)
+{
+    // [rfc7541] 6. Binary Format
+    bool isFieldDecoded = false;
+    qsizetype pos = 0;
+    while (pos < block.size())
+    {
+        const auto firstByte = static_cast<quint8>(block[pos]);
+        if (firstByte & 0x80)
+        {
+            // 6.1. Indexed Header Field Representation
+            quint64 index = 0;
+            if (!decodeInteger(block, pos, 7, index))
+                return false;
+
+            const HeaderField *indexedField = field(index);
+            if (!indexedField)
+                return false;
+
+            headers.append(*indexedField);
+            isFieldDecoded = true;
+        }
+        else if ((firstByte & 0xE0) == 0x20)
+        {
+            // 6.3. Dynamic Table Size Update, it is allowed only at the beginning of the block
+            quint64 maxSize = 0;
+            if (isFieldDecoded || !decodeInteger(block, pos, 5, maxSize) || (maxSize > static_cast<quint64>(m_maxTableSize)))
+                return false;
+
+            m_table.setMaxSize(static_cast<qsizetype>(maxSize));
+        }
+        else
+        {
+            // 6.2. Literal Header Field Representation
+            const bool isIndexed = ((firstByte & 0xC0) == 0x40);
+            quint64 nameIndex = 0;
+            if (!decodeInteger(block, pos, (isIndexed ? 6 : 4), nameIndex))
+                return false;
+
+            HeaderField literalField;
+            if (nameIndex > 0)
+            {
+                const HeaderField *indexedField = field(nameIndex);
+                if (!indexedField)
+                    return false;
+                literalField.name = indexedField->name;
+            }
+            else if (!decodeString(block, pos, literalField.name))
+            {
+                return false;
+            }
+
+            if (!decodeString(block, pos, literalField.value))
+                return false;
+
+            if (isIndexed)
+                m_table.insert(literalField);
+            headers.append(std::move(literalField));
+            isFieldDecoded = true;
+        }
+    }
+
+    return true;
+}
+
+Http::HPack::Encoder::Encoder()
+    : m_table {DEFAULT_TABLE_SIZE}
+{
+}
+
+void Http::HPack::Encoder::setMaxTableSize(const qsizetype maxTableSize)
+{
+    const qsizetype tableSize = std::min(maxTableSize, DEFAULT_TABLE_SIZE);
+    if ((tableSize == m_table.maxSize()) && (m_pendingTableSize < 0))
+        return;
+
+    // [rfc7541] 4.2. Maximum Table Size, the smallest size is signalled as well if it was changed several times
+    m_minPendingTableSize = (m_minPendingTableSize < 0) ? tableSize : std::min(m_minPendingTableSize, tableSize);
+    m_pendingTableSize = tableSize;
+    m_table.setMaxSize(m_minPendingTableSize);
+}
+
+QByteArray Http::HPack::Encoder::encode(const HeaderList &headers)
+{
+    QByteArray output;
+    output.reserve(512);
+
+    if (m_pendingTableSize >= 0)
+    {
+        encodeInteger(m_minPendingTableSize, 5, 0x20, output);
+        if (m_pendingTableSize != m_minPendingTableSize)
+            encodeInteger(m_pendingTableSize, 5, 0x20, output);
+        m_table.setMaxSize(m_pendingTableSize);
+        m_minPendingTableSize = -1;
+        m_pendingTableSize = -1;
+    }
+
+    for (const HeaderField &field : headers)
+        encodeField(field, output);
+    return output;
+}
+
+void Http::HPack::Encoder::encodeField(const HeaderField &field, QByteArray &output)
+{
+    if (const qsizetype index = staticIndexOf(field); index > 0)
+    {
+        encodeInteger(index, 7, 0x80, output);
+        return;
+    }
+
+    if (const qsizetype index = m_table.indexOf(field); index >= 0)
+    {
+        encodeInteger((STATIC_TABLE.size() + index + 1), 7, 0x80, output);
+        return;
+    }
+
+    qsizetype nameIndex = staticIndexOfName(field.name);
+    if (nameIndex == 0)
+    {
+        if (const qsizetype index = m_table.indexOfName(field.name); index >= 0)
+            nameIndex = (STATIC_TABLE.size() + index + 1);
+    }
+
+    if (isIndexable(field.name))
+    {
+        // 6.2.1. Literal Header Field with Incremental Indexing
+        encodeInteger(nameIndex, 6, 0x40, output);
+        m_table.insert(field);
+    }
+    else
+    {
+        // 6.2.2. Literal Header Field without Indexing, 6.2.3. Literal Header Field Never Indexed
+        encodeInteger(nameIndex, 4, (isSensitive(field.name) ? 0x10 : 0x00), output);
+    }
+
+    if (nameIndex == 0)
+        encodeString(field.name, output);
+    encodeString(field.value, output);
+}
+
+void Http::HPack::encodeInteger(quint64 value, const int prefixBits, const quint8 flags, QByteArray &output)
+{
+    // [rfc7541] 5.1. Integer Representation
+    const quint64 prefixMax = (1U << prefixBits) - 1;
+    if (value < prefixMax)
+    {
+        output.append(static_cast<char>(flags | value));
+        return;
+    }
+
+    output.append(static_cast<char>(flags | prefixMax));
+    value -= prefixMax;
+    while (value >= 128)
+    {
+        output.append(static_cast<char>((value % 128) + 128));
+        value /= 128;
+    }
+    output.append(static_cast<char>(value));
+}
+
+bool Http::HPack::decodeInteger(const QByteArrayView data, qsizetype &pos, const int prefixBits, quint64 &value)
+{
+    if (pos >= data.size())
+        return false;
+
+    const quint64 prefixMax = (1U << prefixBits) - 1;
+    value = static_cast<quint8>(data[pos++]) & prefixMax;
+    if (value < prefixMax)
+        return true;
+
+    int shift = 0;
+    while (pos < data.size())
+    {
+        const auto byte = static_cast<quint8>(data[pos++]);
+        value += static_cast<quint64>(byte & 0x7F) << shift;
+        if (value > MAX_INTEGER)
+            return false;
+        if ((byte & 0x80) == 0)
+            return true;
+        shift += 7;
+    }
+
+    return false;
+}
+
+qsizetype Http::HPack::huffmanEncodedSize(const QByteArrayView data)
+{
+    qint64 bitCount = 0;
+    for (const char c : data)
+        bitCount += HUFFMAN_CODES[static_cast<quint8>(c)].length;
+    return static_cast<qsizetype>((bitCount + 7) / 8);
+}
+
+void Http::HPack::huffmanEncode(const QByteArrayView data, QByteArray &output)
+{
+    quint64 bits = 0;
+    int bitCount = 0;
+    for (const char c : data)
+    {
+        const HuffmanCode &code = HUFFMAN_CODES[static_cast<quint8>(c)];
+        bits = (bits << code.length) | code.code;
+        bitCount += code.length;
+        while (bitCount >= 8)
+        {
+            bitCount -= 8;
+            output.append(static_cast<char>(bits >> bitCount));
+        }
+        bits &= (1ULL << bitCount) - 1;
+    }
+
+    // the last byte is padded with the most significant bits of EOS
+    if (bitCount > 0)
+        output.append(static_cast<char>((bits << (8 - bitCount)) | (0xFF >> bitCount)));
+}
+
+bool Http::HPack::huffmanDecode(const QByteArrayView data, QByteArray &output)
+{
+    const HuffmanTree &tree = huffmanTree();
+
+    output.reserve(output.size() + (data.size() * 8 / 5));
+    qsizetype node = 0;
+    // bits read since the last decoded symbol
+    int pendingBitCount = 0;
+    bool isPendingAllOnes = true;
+    for (const char c : data)
+    {
+        const auto byte = static_cast<quint8>(c);
+        for (int bit = 7; bit >= 0; --bit)
+        {
+            const int branch = (byte >> bit) & 1;
+            node = tree.node(node).children[branch];
+            if (node < 0)
+                return false;
+
+            ++pendingBitCount;
+            isPendingAllOnes = isPendingAllOnes && (branch == 1);
+
+            const qint16 symbol = tree.node(node).symbol;
+            if (symbol < 0)
+                continue;
+            if (symbol == HUFFMAN_EOS)
+                return false;
+
+            output.append(static_cast<char>(symbol));
+            node = 0;
+            pendingBitCount = 0;
+            isPendingAllOnes = true;
+        }
+    }
+
+    // [rfc7541] 5.2. padding longer than 7 bits or not corresponding to the EOS is an error
+    return (pendingBitCount <= 7) && isPendingAllOnes;
+}
@@ -0,0 +1,118 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+
+namespace Http::HPack
+{
+    // [rfc7541] HPACK: Header Compression for HTTP/2
+
+    inline const qsizetype DEFAULT_TABLE_SIZE = 4096;
+
+    struct HeaderField
+    {
+        QByteArray name;
+        QByteArray value;
+
+        friend bool operator==(const HeaderField &left, const HeaderField &right) = default;
+    };
+
+    using HeaderList = QList<HeaderField>;
+
+    class DynamicTable
+    {
+    public:
+        explicit DynamicTable(qsizetype maxSize = DEFAULT_TABLE_SIZE);
+
+        qsizetype count() const;
+        qsizetype size() const;
+        qsizetype maxSize() const;
+        void setMaxSize(qsizetype maxSize);
+
+        // entries are indexed from the newest one
+        const HeaderField &at(qsizetype index) const;
+        qsizetype indexOf(const HeaderField &field) const;
+        qsizetype indexOfName(QByteArrayView name) const;
+        void insert(HeaderField field);
+
+    private:
+        void evict(qsizetype maxSize);
+
+        QList<HeaderField> m_entries;
+        qsizetype m_size = 0;
+        qsizetype m_maxSize = 0;
+    };
+
+    class Decoder
+    {
+    public:
+        // `maxTableSize` is the limit announced to the encoder of the peer
+        explicit Decoder(qsizetype maxTableSize = DEFAULT_TABLE_SIZE);
+
+        // Appends decoded header fields of complete header block to `headers`.
+        // Returns false on decoding error, the decoder can't be used anymore then.
+        bool decode(QByteArrayView block, HeaderList &headers);
+
+    private:
+        const HeaderField *field(quint64 index) const;
+
+        DynamicTable m_table;
+        qsizetype m_maxTableSize = 0;
+    };
+
+    class Encoder
+    {
+    public:
+        Encoder();
+
+        // Sets the table size allowed by the decoder of the peer, the table isn't larger than the default one anyway
+        void setMaxTableSize(qsizetype maxTableSize);
+
+        QByteArray encode(const HeaderList &headers);
+
+    private:
+        void encodeField(const HeaderField &field, QByteArray &output);
+
+        DynamicTable m_table;
+        // table size updates to be signalled at the beginning of the next header block
+        qsizetype m_minPendingTableSize = -1;
+        qsizetype m_pendingTableSize = -1;
+    };
+
+    void encodeInteger(quint64 value, int prefixBits, quint8 flags, QByteArray &output);
+    // Decodes the integer at `pos` and moves `pos` past it
+    bool decodeInteger(QByteArrayView data, qsizetype &pos, int prefixBits, quint64 &value);
+
+    qsizetype huffmanEncodedSize(QByteArrayView data);
+    void huffmanEncode(QByteArrayView data, QByteArray &output);
+    bool huffmanDecode(QByteArrayView data, QByteArray &output);
+}
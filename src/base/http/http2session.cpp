@@ -0,0 +1,1029 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "http2session.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QtEndian>
+
+#include "base/utils/gzip.h"
+#include "responsegenerator.h"
+#include "responsestream.h"
+
+using namespace Http;
+
+namespace
+{
+    const QByteArrayView CONNECTION_PREFACE = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+    const qsizetype FRAME_HEADER_SIZE = 9;
+
+    // [rfc9113] 6.5.2. Defined Settings
+    const qint64 DEFAULT_WINDOW_SIZE = 65535;
+    const qint64 MAX_WINDOW_SIZE = 0x7FFFFFFF;
+    const qint64 DEFAULT_MAX_FRAME_SIZE = 16384;
+    const qint64 MAX_FRAME_SIZE = 0xFFFFFF;
+
+    const quint32 MAX_CONCURRENT_STREAMS = 100;
+    // request bodies can be received at once instead of waiting for the window updates
+    const qint64 RECEIVE_WINDOW_SIZE = 1024 * 1024;
+    const qsizetype MAX_HEADER_BLOCK_SIZE = 64 * 1024;
+    // data is held back once this much is written but not sent yet, so the preferred streams can go first
+    const qint64 MAX_PENDING_SIZE = 256 * 1024;
+    const int STREAM_COMPRESSION_LEVEL = 4;
+
+    enum SettingsParameter : quint16
+    {
+        HeaderTableSize = 0x1,
+        EnablePush = 0x2,
+        MaxConcurrentStreams = 0x3,
+        InitialWindowSize = 0x4,
+        MaxFrameSize = 0x5
+    };
+
+    enum Flags : quint8
+    {
+        FlagAck = 0x1,
+        FlagEndStream = 0x1,
+        FlagEndHeaders = 0x4,
+        FlagPadded = 0x8,
+        FlagPriority = 0x20
+    };
+
+    // Synchronization data is what keeps the UI up to date so it goes before the other API results,
+    // and those go before the static files
+    int streamPriority(const QStringView path)
+    {
+        if (path.startsWith(u"/api/v2/sync/"))
+            return 0;
+        if (path.startsWith(u"/api/"))
+            return 1;
+        return 2;
+    }
+
+    bool isConnectionSpecificHeader(const QByteArrayView name)
+    {
+        // [rfc9113] 8.2.2. Connection-Specific Header Fields
+        return (name == "connection") || (name == "keep-alive") || (name == "proxy-connection")
+            || (name == "transfer-encoding") || (name == "upgrade");
+    }
+
+    bool isValidFieldValue(const QByteArrayView value)
+    {
+        return std::none_of(value.cbegin(), value.cend(), [](const char c)
+        {
+            return (c == '\r') || (c == '\n') || (c == '\0');
+        });
+    }
+
+    bool isValidFieldName(const QByteArrayView name)
+    {
+        return !name.isEmpty() && isValidFieldValue(name) && std::none_of(name.cbegin(), name.cend(), [](const char c)
+        {
+            return ((c >= 'A') && (c <= 'Z')) || (c == ':') || (c == ' ');
+        });
+    }
+
+    void appendUInt32(QByteArray &data, const quint32 value)
+    {
+        const quint32 bigEndianValue = qToBigEndian(value);
+        data.append(reinterpret_cast<const char *>(&bigEndianValue), sizeof(bigEndianValue));
+    }
+
+    quint32 readUInt32(const QByteArrayView data, const qsizetype pos)
+    {
+        return qFromBigEndian<quint32>(data.constData() + pos);
+    }
+
+    // strips padding of DATA and HEADERS frames
+    bool removePadding(const quint8 flags, QByteArrayView &payload)
+    {
+        if (!(flags & FlagPadded))
+            return true;
+
+        if (payload.isEmpty())
+            return false;
+
+        const auto padLength = static_cast<quint8>(payload[0]);
+        if (padLength >= payload.size())
+            return false;
+
+        payload = payload.sliced(1, (payload.size() - 1 - padLength));
+        return true;
+    }
+}
+
+enum class Http2Session::ErrorCode : quint32
+{
+    // [rfc9113] 7. Error Codes
+    NoError = 0x0,
+    ProtocolError = 0x1,
+    InternalError = 0x2,
+    FlowControlError = 0x3,
+    StreamClosed = 0x5,
+    FrameSizeError = 0x6,
+    RefusedStream = 0x7,
+    CompressionError = 0x9,
+    EnhanceYourCalm = 0xb
+};
+
+enum class Http2Session::FrameType : quint8
+{
+    // [rfc9113] 6. Frame Definitions
+    Data = 0x0,
+    Headers = 0x1,
+    Priority = 0x2,
+    RstStream = 0x3,
+    Settings = 0x4,
+    PushPromise = 0x5,
+    Ping = 0x6,
+    GoAway = 0x7,
+    WindowUpdate = 0x8,
+    Continuation = 0x9
+};
+
+struct Http2Session::Stream
+{
+    quint32 id = 0;
+    int priority = 0;
+    bool isRemoteClosed = false;
+
+    // request
+    RequestParser requestParser;
+    // start lines of the request are held until the length of the body is known
+    QByteArray pendingStartLines;
+    // data not consumed by the parser yet
+    QByteArray requestData;
+    bool isContentLengthKnown = false;
+    bool isRequestDispatched = false;
+    bool isHeadRequest = false;
+    bool acceptsGzipEncoding = false;
+
+    // response, the data is queued with its size as it was written to the response stream
+    qint64 sendWindow = 0;
+    QList<std::pair<QByteArray, qint64>> sendQueue;
+    qsizetype sendQueueOffset = 0;
+    bool isSendFinished = false;
+    std::shared_ptr<ResponseStream> responseStream;
+    std::unique_ptr<Utils::Gzip::Compressor> compressor;
+};
+
+Http2Session::Http2Session(Writer writer, PendingSizeGetter pendingSizeGetter, RequestDispatcher dispatcher)
+    : m_writer {std::move(writer)}
+    , m_pendingSizeGetter {std::move(pendingSizeGetter)}
+    , m_dispatcher {std::move(dispatcher)}
+    , m_sendWindow {DEFAULT_WINDOW_SIZE}
+    , m_peerInitialWindowSize {DEFAULT_WINDOW_SIZE}
+    , m_peerMaxFrameSize {DEFAULT_MAX_FRAME_SIZE}
+{
+}
+
+Http2Session::~Http2Session()
+{
+    for (const auto &[streamID, stream] : m_streams)
+    {
+        if (stream->responseStream)
+            stream->responseStream->detach();
+    }
+}
+
+void Http2Session::start()
+{
+    // [rfc9113] 3.4. HTTP/2 Connection Preface
+    QByteArray settings;
+    const auto appendSetting = [&settings](const quint16 parameter, const quint32 value)
+    {
+        const quint16 bigEndianParameter = qToBigEndian(parameter);
+        settings.append(reinterpret_cast<const char *>(&bigEndianParameter), sizeof(bigEndianParameter));
+        appendUInt32(settings, value);
+    };
+    appendSetting(MaxConcurrentStreams, MAX_CONCURRENT_STREAMS);
+    appendSetting(InitialWindowSize, RECEIVE_WINDOW_SIZE);
+    writeFrame(FrameType::Settings, 0, 0, settings);
+    writeWindowUpdate(0, (RECEIVE_WINDOW_SIZE - DEFAULT_WINDOW_SIZE));
+}
+
+bool Http2Session::receive(const QByteArrayView data)
+{
+    if (m_isGoingAway)
+        return false;
+
+    m_receivedData.append(data);
+
+    qsizetype pos = 0;
+    if (!m_isPrefaceReceived)
+    {
+        const qsizetype size = std::min(m_receivedData.size(), CONNECTION_PREFACE.size());
+        if (QByteArrayView(m_receivedData).first(size) != CONNECTION_PREFACE.first(size))
+            return connectionError(ErrorCode::ProtocolError);
+        if (size < CONNECTION_PREFACE.size())
+            return true;
+
+        m_isPrefaceReceived = true;
+        pos = CONNECTION_PREFACE.size();
+    }
+
+    const QByteArrayView receivedData {m_receivedData};
+    while ((receivedData.size() - pos) >= FRAME_HEADER_SIZE)
+    {
+        // [rfc9113] 4.1. Frame Format
+        const qint64 length = (static_cast<quint8>(receivedData[pos]) << 16)
+            | (static_cast<quint8>(receivedData[pos + 1]) << 8)
+            | static_cast<quint8>(receivedData[pos + 2]);
+        if (length > DEFAULT_MAX_FRAME_SIZE)
+            return connectionError(ErrorCode::FrameSizeError);
+        if ((receivedData.size() - pos) < (FRAME_HEADER_SIZE + length))
+            break;
+
+        const auto type = static_cast<FrameType>(receivedData[pos + 3]);
+        const auto flags = static_cast<quint8>(receivedData[pos + 4]);
+        const quint32 streamID = readUInt32(receivedData, (pos + 5)) & 0x7FFFFFFF;
+        const QByteArrayView payload = receivedData.sliced((pos + FRAME_HEADER_SIZE), length);
+        pos += FRAME_HEADER_SIZE + length;
+
+        if (!processFrame(type, flags, streamID, payload))
+            return false;
+    }
+
+    m_receivedData.remove(0, pos);
+    return true;
+}
+
+bool Http2Session::processFrame(const FrameType type, const quint8 flags, const quint32 streamID, const QByteArrayView payload)
+{
+    // [rfc9113] 3.4. the first frame must be SETTINGS
+    if (!m_isSettingsReceived && (type != FrameType::Settings))
+        return connectionError(ErrorCode::ProtocolError);
+
+    // [rfc9113] 6.10. header block can't be interleaved with any other frame
+    if ((m_headerBlockStreamID != 0) && ((type != FrameType::Continuation) || (streamID != m_headerBlockStreamID)))
+        return connectionError(ErrorCode::ProtocolError);
+
+    switch (type)
+    {
+    case FrameType::Data:
+        return processDataFrame(flags, streamID, payload);
+
+    case FrameType::Headers:
+        return processHeadersFrame(flags, streamID, payload);
+
+    case FrameType::Continuation:
+        return processContinuationFrame(flags, streamID, payload);
+
+    case FrameType::Priority:
+        // stream priorities are decided by the server
+        if (streamID == 0)
+            return connectionError(ErrorCode::ProtocolError);
+        if (payload.size() != 5)
+            resetStream(streamID, ErrorCode::FrameSizeError);
+        return true;
+
+    case FrameType::RstStream:
+        if (streamID == 0)
+            return connectionError(ErrorCode::ProtocolError);
+        if (payload.size() != 4)
+            return connectionError(ErrorCode::FrameSizeError);
+        removeStream(streamID);
+        return true;
+
+    case FrameType::Settings:
+        return processSettingsFrame(flags, streamID, payload);
+
+    case FrameType::PushPromise:
+        // clients can't push
+        return connectionError(ErrorCode::ProtocolError);
+
+    case FrameType::Ping:
+        if (streamID != 0)
+            return connectionError(ErrorCode::ProtocolError);
+        if (payload.size() != 8)
+            return connectionError(ErrorCode::FrameSizeError);
+        if (!(flags & FlagAck))
+            writeFrame(FrameType::Ping, FlagAck, 0, payload);
+        return true;
+
+    case FrameType::GoAway:
+        // streams being processed are completed, the client won't open new ones
+        if (streamID != 0)
+            return connectionError(ErrorCode::ProtocolError);
+        return true;
+
+    case FrameType::WindowUpdate:
+        return processWindowUpdateFrame(streamID, payload);
+
+    default:
+        // [rfc9113] 4.1. unknown frame types are ignored
+        return true;
+    }
+}
+
+bool Http2Session::processDataFrame(const quint8 flags, const quint32 streamID, QByteArrayView payload)
+{
+    if (streamID == 0)
+        return connectionError(ErrorCode::ProtocolError);
+
+    // received data is consumed at once so the whole window is available again
+    const auto frameSize = static_cast<quint32>(payload.size());
+    if (frameSize > 0)
+        writeWindowUpdate(0, frameSize);
+
+    if (!removePadding(flags, payload))
+        return connectionError(ErrorCode::ProtocolError);
+
+    const auto it = m_streams.find(streamID);
+    if (it == m_streams.end())
+    {
+        // the data of reset streams can still be on the way
+        if (streamID > m_lastStreamID)
+            return connectionError(ErrorCode::ProtocolError);
+        return true;
+    }
+
+    Stream &stream = *it->second;
+    if (stream.isRemoteClosed)
+    {
+        resetStream(streamID, ErrorCode::StreamClosed);
+        removeStream(streamID);
+        return true;
+    }
+
+    stream.isRemoteClosed = (flags & FlagEndStream);
+    if ((frameSize > 0) && !stream.isRemoteClosed)
+        writeWindowUpdate(streamID, frameSize);
+
+    feedRequest(stream, payload);
+    return true;
+}
+
+bool Http2Session::processHeadersFrame(const quint8 flags, const quint32 streamID, QByteArrayView payload)
+{
+    if (streamID == 0)
+        return connectionError(ErrorCode::ProtocolError);
+
+    if (!removePadding(flags, payload))
+        return connectionError(ErrorCode::ProtocolError);
+
+    if (flags & FlagPriority)
+    {
+        // stream dependency and weight
+        if (payload.size() < 5)
+            return connectionError(ErrorCode::FrameSizeError);
+        payload = payload.sliced(5);
+    }
+
+    m_headerBlock = payload.toByteArray();
+    m_headerBlockStreamID = streamID;
+    m_isHeaderBlockEndStream = (flags & FlagEndStream);
+
+    if (flags & FlagEndHeaders)
+        return processHeaderBlock();
+    return true;
+}
+
+bool Http2Session::processContinuationFrame(const quint8 flags, const quint32 streamID, const QByteArrayView payload)
+{
+    if ((m_headerBlockStreamID == 0) || (streamID != m_headerBlockStreamID))
+        return connectionError(ErrorCode::ProtocolError);
+
+    if ((m_headerBlock.size() + payload.size()) > MAX_HEADER_BLOCK_SIZE)
+        return connectionError(ErrorCode::EnhanceYourCalm);
+
+    m_headerBlock.append(payload);
+
+    if (flags & FlagEndHeaders)
+        return processHeaderBlock();
+    return true;
+}
+
+bool Http2Session::processHeaderBlock()
+{
+    const quint32 streamID = std::exchange(m_headerBlockStreamID, 0);
+    const QByteArray headerBlock = std::exchange(m_headerBlock, {});
+
+    // header block is decoded even if the stream is refused, so the state of decoder matches the one of encoder
+    HPack::HeaderList headers;
+    if (!m_decoder.decode(headerBlock, headers))
+        return connectionError(ErrorCode::CompressionError);
+
+    if (const auto it = m_streams.find(streamID); it != m_streams.end())
+    {
+        // trailer fields end the request, they are ignored
+        Stream &stream = *it->second;
+        if (stream.isRemoteClosed || !m_isHeaderBlockEndStream)
+        {
+            resetStream(streamID, (stream.isRemoteClosed ? ErrorCode::StreamClosed : ErrorCode::ProtocolError));
+            removeStream(streamID);
+            return true;
+        }
+
+        stream.isRemoteClosed = true;
+        feedRequest(stream, {});
+        return true;
+    }
+
+    // [rfc9113] 5.1.1. Stream Identifiers
+    if (((streamID % 2) == 0) || (streamID <= m_lastStreamID))
+        return connectionError(ErrorCode::ProtocolError);
+
+    m_lastStreamID = streamID;
+
+    if (m_streams.size() >= MAX_CONCURRENT_STREAMS)
+    {
+        resetStream(streamID, ErrorCode::RefusedStream);
+        return true;
+    }
+
+    auto stream = std::make_unique<Stream>();
+    stream->id = streamID;
+    stream->sendWindow = m_peerInitialWindowSize;
+    stream->isRemoteClosed = m_isHeaderBlockEndStream;
+    Stream &newStream = *m_streams.emplace(streamID, std::move(stream)).first->second;
+
+    startRequest(newStream, headers);
+    return true;
+}
+
+bool Http2Session::processSettingsFrame(const quint8 flags, const quint32 streamID, const QByteArrayView payload)
+{
+    if (streamID != 0)
+        return connectionError(ErrorCode::ProtocolError);
+
+    if (flags & FlagAck)
+    {
+        if (!payload.isEmpty())
+            return connectionError(ErrorCode::FrameSizeError);
+        return true;
+    }
+
+    if ((payload.size() % 6) != 0)
+        return connectionError(ErrorCode::FrameSizeError);
+
+    for (qsizetype pos = 0; pos < payload.size(); pos += 6)
+    {
+        const auto parameter = qFromBigEndian<quint16>(payload.constData() + pos);
+        const quint32 value = readUInt32(payload, (pos + 2));
+        switch (parameter)
+        {
+        case HeaderTableSize:
+            m_encoder.setMaxTableSize(value);
+            break;
+
+        case EnablePush:
+            if (value > 1)
+                return connectionError(ErrorCode::ProtocolError);
+            break;
+
+        case InitialWindowSize:
+            {
+                if (value > MAX_WINDOW_SIZE)
+                    return connectionError(ErrorCode::FlowControlError);
+
+                // [rfc9113] 6.9.2. the change applies to the windows of all the streams
+                const qint64 delta = value - m_peerInitialWindowSize;
+                for (const auto &[id, stream] : m_streams)
+                {
+                    stream->sendWindow += delta;
+                    if (stream->sendWindow > MAX_WINDOW_SIZE)
+                        return connectionError(ErrorCode::FlowControlError);
+                }
+                m_peerInitialWindowSize = value;
+            }
+            break;
+
+        case MaxFrameSize:
+            if ((value < DEFAULT_MAX_FRAME_SIZE) || (value > MAX_FRAME_SIZE))
+                return connectionError(ErrorCode::ProtocolError);
+            m_peerMaxFrameSize = value;
+            break;
+
+        default:
+            // unknown settings are ignored
+            break;
+        }
+    }
+
+    m_isSettingsReceived = true;
+    writeFrame(FrameType::Settings, FlagAck, 0);
+    sendPendingData();
+    return true;
+}
+
+bool Http2Session::processWindowUpdateFrame(const quint32 streamID, const QByteArrayView payload)
+{
+    if (payload.size() != 4)
+        return connectionError(ErrorCode::FrameSizeError);
+
+    const qint64 increment = readUInt32(payload, 0) & 0x7FFFFFFF;
+    if (streamID == 0)
+    {
+        if (increment == 0)
+            return connectionError(ErrorCode::ProtocolError);
+
+        m_sendWindow += increment;
+        if (m_sendWindow > MAX_WINDOW_SIZE)
+            return connectionError(ErrorCode::FlowControlError);
+    }
+    else
+    {
+        const auto it = m_streams.find(streamID);
+        if (it == m_streams.end())
+            return true;
+
+        Stream &stream = *it->second;
+        stream.sendWindow += increment;
+        if ((increment == 0) || (stream.sendWindow > MAX_WINDOW_SIZE))
+        {
+            resetStream(streamID, ((increment == 0) ? ErrorCode::ProtocolError : ErrorCode::FlowControlError));
+            removeStream(streamID);
+            return true;
+        }
+    }
+
+    sendPendingData();
+    return true;
+}
+
+bool Http2Session::connectionError(const ErrorCode errorCode)
+{
+    // [rfc9113] 5.4.1. Connection Error Handling
+    QByteArray payload;
+    appendUInt32(payload, m_lastStreamID);
+    appendUInt32(payload, static_cast<quint32>(errorCode));
+    writeFrame(FrameType::GoAway, 0, 0, payload);
+
+    m_isGoingAway = true;
+    return false;
+}
+
+void Http2Session::startRequest(Stream &stream, const HPack::HeaderList &headers)
+{
+    // [rfc9113] 8.3.1. Request Pseudo-Header Fields
+    QByteArray method;
+    QByteArray path;
+    QByteArray authority;
+    QByteArray cookies;
+    QByteArray headerLines;
+    bool hasHost = false;
+    bool hasContentLength = false;
+    bool isRegularFieldFound = false;
+    bool isMalformed = false;
+    for (const HPack::HeaderField &field : headers)
+    {
+        if (!isValidFieldValue(field.value))
+        {
+            isMalformed = true;
+            break;
+        }
+
+        if (field.name.startsWith(':'))
+        {
+            if (isRegularFieldFound)
+            {
+                isMalformed = true;
+                break;
+            }
+
+            if (field.name == ":method")
+                method = field.value;
+            else if (field.name == ":path")
+                path = field.value;
+            else if (field.name == ":authority")
+                authority = field.value;
+            else if (field.name != ":scheme")
+                isMalformed = true;
+            continue;
+        }
+
+        isRegularFieldFound = true;
+        if (!isValidFieldName(field.name))
+        {
+            isMalformed = true;
+            break;
+        }
+
+        if (isConnectionSpecificHeader(field.name))
+            continue;
+
+        // [rfc9113] 8.2.3. Compressing the Cookie Header Field
+        if (field.name == "cookie")
+        {
+            if (!cookies.isEmpty())
+                cookies.append("; ");
+            cookies.append(field.value);
+            continue;
+        }
+
+        if (field.name == "host")
+            hasHost = true;
+        else if (field.name == "content-length")
+            hasContentLength = true;
+        else if (field.name == "accept-encoding")
+            stream.acceptsGzipEncoding = acceptsGzipEncoding(QString::fromLatin1(field.value));
+
+        headerLines.append(field.name).append(": ").append(field.value).append(CRLF);
+    }
+
+    if (isMalformed || method.isEmpty() || path.isEmpty())
+    {
+        resetStream(stream.id, ErrorCode::ProtocolError);
+        removeStream(stream.id);
+        return;
+    }
+
+    if (!hasHost && !authority.isEmpty())
+        headerLines.append("host: ").append(authority).append(CRLF);
+    if (!cookies.isEmpty())
+        headerLines.append("cookie: ").append(cookies).append(CRLF);
+
+    stream.priority = streamPriority(QString::fromLatin1(path));
+    stream.isHeadRequest = (method == "HEAD");
+    if (stream.isHeadRequest)
+        stream.acceptsGzipEncoding = false;
+
+    // the request is converted to HTTP/1.1 message, so it's parsed the same way
+    const QByteArray startLines = method + ' ' + path + " HTTP/1.1" + CRLF + headerLines;
+    if (hasContentLength || stream.isRemoteClosed)
+    {
+        stream.isContentLengthKnown = true;
+        feedRequest(stream, QByteArray(startLines + CRLF));
+    }
+    else
+    {
+        stream.pendingStartLines = startLines;
+    }
+}
+
+void Http2Session::feedRequest(Stream &stream, const QByteArrayView data)
+{
+    // data following the complete request is ignored
+    if (stream.isRequestDispatched)
+        return;
+
+    stream.requestData.append(data);
+
+    if (!stream.isContentLengthKnown)
+    {
+        if (stream.requestData.size() > RequestParser::MAX_CONTENT_SIZE)
+        {
+            rejectRequest(stream, 413, u"Payload Too Large"_s);
+            return;
+        }
+
+        if (!stream.isRemoteClosed)
+            return;
+
+        stream.requestData.prepend(stream.pendingStartLines + "content-length: " + QByteArray::number(stream.requestData.size())
+            + CRLF + CRLF);
+        stream.pendingStartLines.clear();
+        stream.isContentLengthKnown = true;
+    }
+
+    RequestParser::ParseResult result = stream.requestParser.parse(stream.requestData);
+    stream.requestData.remove(0, result.consumedSize);
+
+    switch (result.status)
+    {
+    case RequestParser::ParseStatus::OK:
+        {
+            Request request = std::move(result.request);
+            request.version = u"2.0"_s;
+            if (stream.isHeadRequest)
+                request.method = HEADER_REQUEST_METHOD_GET;
+
+            stream.isRequestDispatched = true;
+            stream.requestData.clear();
+            m_dispatcher(stream.id, std::move(request));
+        }
+        break;
+
+    case RequestParser::ParseStatus::Incomplete:
+        if (stream.isRemoteClosed)
+            rejectRequest(stream, 400, u"Bad Request"_s);
+        else if (stream.requestData.size() > RequestParser::MAX_CONTENT_SIZE)
+            rejectRequest(stream, 413, u"Payload Too Large"_s);
+        break;
+
+    case RequestParser::ParseStatus::BadMethod:
+        rejectRequest(stream, 501, u"Not Implemented"_s);
+        break;
+
+    case RequestParser::ParseStatus::BadRequest:
+        rejectRequest(stream, 400, u"Bad Request"_s);
+        break;
+    }
+}
+
+void Http2Session::rejectRequest(Stream &stream, const uint statusCode, const QString &statusText)
+{
+    stream.isRequestDispatched = true;
+    stream.requestData.clear();
+    sendResponse(stream.id, Response(statusCode, statusText));
+}
+
+void Http2Session::sendResponse(const quint32 streamID, Response response)
+{
+    const auto it = m_streams.find(streamID);
+    if (it == m_streams.end())
+    {
+        // the stream is reset by the client
+        if (response.stream)
+            response.stream->detach();
+        return;
+    }
+
+    Stream &stream = *it->second;
+    stream.isRequestDispatched = true;
+
+    if (response.stream)
+        response.headers[HEADER_CACHE_CONTROL] = u"no-cache"_s;
+
+    if (stream.isHeadRequest)
+    {
+        if (!response.stream)
+            response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
+        response.content.clear();
+        response.gzipContent.clear();
+    }
+    else if (stream.acceptsGzipEncoding)
+    {
+        if (!response.stream)
+        {
+            response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
+        }
+        else if (!response.headers.contains(HEADER_CONTENT_LENGTH) && isCompressibleStream(response.headers.value(HEADER_CONTENT_TYPE)))
+        {
+            response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
+            stream.compressor = std::make_unique<Utils::Gzip::Compressor>(STREAM_COMPRESSION_LEVEL);
+        }
+    }
+
+    // [rfc9113] 8.3.2. Response Pseudo-Header Fields
+    finalizeResponse(response);
+    HPack::HeaderList headers;
+    headers.reserve(response.headers.size() + 1);
+    headers.append(HPack::HeaderField {":status", QByteArray::number(response.status.code)});
+    for (auto i = response.headers.cbegin(); i != response.headers.cend(); ++i)
+    {
+        const QByteArray name = i.key().toLower().toLatin1();
+        if (!isConnectionSpecificHeader(name))
+            headers.append(HPack::HeaderField {name, i.value().toLatin1()});
+    }
+
+    const bool hasContent = !stream.isHeadRequest && (!response.content.isEmpty() || response.stream);
+    writeHeaders(streamID, headers, !hasContent);
+
+    if (!hasContent)
+    {
+        if (response.stream)
+            response.stream->detach();
+        if (!stream.isRemoteClosed)
+            resetStream(streamID, ErrorCode::NoError);
+        removeStream(streamID);
+        return;
+    }
+
+    stream.responseStream = response.stream;
+    if (!queueStreamData(stream, response.content, 0))
+        return;
+    if (stream.responseStream)
+    {
+        bool isClosed = false;
+        const QByteArray pendingData = stream.responseStream->start(isClosed);
+        if (!queueStreamData(stream, pendingData, pendingData.size()))
+            return;
+        if (isClosed)
+            finishStreamData(stream);
+    }
+    else
+    {
+        finishStreamData(stream);
+    }
+
+    sendPendingData();
+}
+
+void Http2Session::writeStream(const ResponseStream *responseStream, const QByteArray &data)
+{
+    Stream *stream = findStream(responseStream);
+    if (!stream || stream->isSendFinished)
+        return;
+
+    if (queueStreamData(*stream, data, data.size()))
+        sendPendingData();
+}
+
+void Http2Session::closeStream(const ResponseStream *responseStream)
+{
+    Stream *stream = findStream(responseStream);
+    if (!stream || stream->isSendFinished)
+        return;
+
+    stream->responseStream->detach();
+    finishStreamData(*stream);
+    sendPendingData();
+}
+
+Http2Session::Stream *Http2Session::findStream(const ResponseStream *responseStream)
+{
+    const auto it = std::find_if(m_streams.cbegin(), m_streams.cend(), [responseStream](const auto &item)
+    {
+        return item.second->responseStream.get() == responseStream;
+    });
+    return (it != m_streams.cend()) ? it->second.get() : nullptr;
+}
+
+bool Http2Session::queueStreamData(Stream &stream, QByteArray data, const qint64 size)
+{
+    if (data.isEmpty())
+        return true;
+
+    if (stream.compressor)
+    {
+        QByteArray compressedData;
+        if (!stream.compressor->compress(data, compressedData)) [[unlikely]]
+        {
+            resetStream(stream.id, ErrorCode::InternalError);
+            removeStream(stream.id);
+            return false;
+        }
+        data = std::move(compressedData);
+    }
+
+    stream.sendQueue.emplaceBack(std::move(data), size);
+    if (!m_sendingStreams.contains(stream.id))
+        m_sendingStreams.append(stream.id);
+    return true;
+}
+
+void Http2Session::finishStreamData(Stream &stream)
+{
+    if (stream.compressor)
+    {
+        QByteArray streamEnd;
+        stream.compressor->finish(streamEnd);
+        stream.compressor.reset();
+        queueStreamData(stream, streamEnd, 0);
+    }
+
+    stream.isSendFinished = true;
+    if (!m_sendingStreams.contains(stream.id))
+        m_sendingStreams.append(stream.id);
+}
+
+Http2Session::Stream *Http2Session::nextStreamToSend()
+{
+    Stream *nextStream = nullptr;
+    for (const quint32 streamID : asConst(m_sendingStreams))
+    {
+        Stream *stream = m_streams.at(streamID).get();
+        const bool canSend = stream->sendQueue.isEmpty()
+            ? stream->isSendFinished
+            : ((m_sendWindow > 0) && (stream->sendWindow > 0));
+        if (canSend && (!nextStream || (stream->priority < nextStream->priority)))
+            nextStream = stream;
+    }
+    return nextStream;
+}
+
+void Http2Session::sendPendingData()
+{
+    while (!m_isGoingAway && (m_pendingSizeGetter() < MAX_PENDING_SIZE))
+    {
+        Stream *stream = nextStreamToSend();
+        if (!stream)
+            return;
+
+        const quint32 streamID = stream->id;
+        m_sendingStreams.removeOne(streamID);
+
+        bool isLastFrame = true;
+        if (stream->sendQueue.isEmpty())
+        {
+            writeFrame(FrameType::Data, FlagEndStream, streamID);
+        }
+        else
+        {
+            const auto &[data, size] = stream->sendQueue.first();
+            const qint64 remainingSize = data.size() - stream->sendQueueOffset;
+            const qint64 frameSize = std::min({remainingSize, m_peerMaxFrameSize, m_sendWindow, stream->sendWindow});
+            isLastFrame = stream->isSendFinished && (frameSize == remainingSize) && (stream->sendQueue.size() == 1);
+
+            writeFrame(FrameType::Data, (isLastFrame ? FlagEndStream : 0), streamID
+                , QByteArrayView(data).sliced(stream->sendQueueOffset, frameSize));
+            m_sendWindow -= frameSize;
+            stream->sendWindow -= frameSize;
+            stream->sendQueueOffset += frameSize;
+
+            // the size is reported once the data is passed to the connection which sends it before long
+            if (stream->sendQueueOffset == data.size())
+            {
+                if (stream->responseStream && (size > 0))
+                    stream->responseStream->handleDataSent(size);
+                stream->sendQueue.removeFirst();
+                stream->sendQueueOffset = 0;
+            }
+        }
+
+        if (isLastFrame)
+        {
+            if (!stream->isRemoteClosed)
+                resetStream(streamID, ErrorCode::NoError);
+            removeStream(streamID);
+            continue;
+        }
+
+        // served stream goes after the other ones, so the streams of the same priority take turns
+        m_sendingStreams.append(streamID);
+    }
+}
+
+void Http2Session::resetStream(const quint32 streamID, const ErrorCode errorCode)
+{
+    QByteArray payload;
+    appendUInt32(payload, static_cast<quint32>(errorCode));
+    writeFrame(FrameType::RstStream, 0, streamID, payload);
+}
+
+void Http2Session::removeStream(const quint32 streamID)
+{
+    const auto it = m_streams.find(streamID);
+    if (it == m_streams.end())
+        return;
+
+    if (it->second->responseStream)
+        it->second->responseStream->detach();
+    m_sendingStreams.removeOne(streamID);
+    m_streams.erase(it);
+}
+
+bool Http2Session::hasActiveStreams() const
+{
+    return !m_streams.empty();
+}
+
+void Http2Session::writeFrame(const FrameType type, const quint8 flags, const quint32 streamID, const QByteArrayView payload)
+{
+    QByteArray frame;
+    frame.reserve(FRAME_HEADER_SIZE + payload.size());
+    frame.append(static_cast<char>((payload.size() >> 16) & 0xFF));
+    frame.append(static_cast<char>((payload.size() >> 8) & 0xFF));
+    frame.append(static_cast<char>(payload.size() & 0xFF));
+    frame.append(static_cast<char>(type));
+    frame.append(static_cast<char>(flags));
+    appendUInt32(frame, streamID);
+    frame.append(payload);
+    m_writer(frame);
+}
+
+void Http2Session::writeHeaders(const quint32 streamID, const HPack::HeaderList &headers, const bool isEndStream)
+{
+    // header block larger than the frame size is continued in CONTINUATION frames
+    const QByteArray headerBlock = m_encoder.encode(headers);
+    const QByteArrayView blockView {headerBlock};
+    qsizetype pos = 0;
+    do
+    {
+        const qsizetype fragmentSize = std::min<qsizetype>((blockView.size() - pos), m_peerMaxFrameSize);
+        const bool isLastFragment = ((pos + fragmentSize) == blockView.size());
+        const FrameType type = (pos == 0) ? FrameType::Headers : FrameType::Continuation;
+        quint8 flags = isLastFragment ? FlagEndHeaders : 0;
+        if ((type == FrameType::Headers) && isEndStream)
+            flags |= FlagEndStream;
+
+        writeFrame(type, flags, streamID, blockView.sliced(pos, fragmentSize));
+        pos += fragmentSize;
+    } while (pos < blockView.size());
+}
+
+void Http2Session::writeWindowUpdate(const quint32 streamID, const quint32 increment)
+{
+    QByteArray payload;
+    appendUInt32(payload, increment);
+    writeFrame(FrameType::WindowUpdate, 0, streamID, payload);
+}
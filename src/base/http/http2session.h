@@ -0,0 +1,134 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+
+#include "hpack.h"
+#include "requestparser.h"
+#include "types.h"
+
+namespace Utils::Gzip
+{
+    class Compressor;
+}
+
+namespace Http
+{
+    // [rfc9113] Server side of HTTP/2 connection, it handles the frames exchanged with the client
+    // while the socket itself is managed by the connection. Requests of the streams are
+    // converted to the ones handled by the HTTP/1.1 code, so the handlers don't see any difference.
+    class Http2Session
+    {
+        Q_DISABLE_COPY_MOVE(Http2Session)
+
+    public:
+        using Writer = std::function<void (const QByteArray &data)>;
+        // size of the written data which isn't sent yet
+        using PendingSizeGetter = std::function<qint64 ()>;
+        using RequestDispatcher = std::function<void (quint32 streamID, Request request)>;
+
+        Http2Session(Writer writer, PendingSizeGetter pendingSizeGetter, RequestDispatcher dispatcher);
+        ~Http2Session();
+
+        // sends the server connection preface
+        void start();
+        // Processes the data received from the client.
+        // Returns false on connection error, the connection should be closed then.
+        bool receive(QByteArrayView data);
+
+        void sendResponse(quint32 streamID, Response response);
+        void writeStream(const ResponseStream *responseStream, const QByteArray &data);
+        void closeStream(const ResponseStream *responseStream);
+        // continues with the data held back until the written data is sent
+        void sendPendingData();
+
+        bool hasActiveStreams() const;
+
+    private:
+        enum class ErrorCode : quint32;
+        enum class FrameType : quint8;
+        struct Stream;
+
+        bool processFrame(FrameType type, quint8 flags, quint32 streamID, QByteArrayView payload);
+        bool processDataFrame(quint8 flags, quint32 streamID, QByteArrayView payload);
+        bool processHeadersFrame(quint8 flags, quint32 streamID, QByteArrayView payload);
+        bool processContinuationFrame(quint8 flags, quint32 streamID, QByteArrayView payload);
+        bool processSettingsFrame(quint8 flags, quint32 streamID, QByteArrayView payload);
+        bool processWindowUpdateFrame(quint32 streamID, QByteArrayView payload);
+        bool processHeaderBlock();
+        bool connectionError(ErrorCode errorCode);
+
+        void startRequest(Stream &stream, const HPack::HeaderList &headers);
+        void feedRequest(Stream &stream, QByteArrayView data);
+        void rejectRequest(Stream &stream, uint statusCode, const QString &statusText);
+        void resetStream(quint32 streamID, ErrorCode errorCode);
+        void removeStream(quint32 streamID);
+        Stream *findStream(const ResponseStream *responseStream);
+        // returns false if the stream is reset
+        bool queueStreamData(Stream &stream, QByteArray data, qint64 size);
+        void finishStreamData(Stream &stream);
+        Stream *nextStreamToSend();
+
+        void writeFrame(FrameType type, quint8 flags, quint32 streamID, QByteArrayView payload = {});
+        void writeHeaders(quint32 streamID, const HPack::HeaderList &headers, bool isEndStream);
+        void writeWindowUpdate(quint32 streamID, quint32 increment);
+
+        Writer m_writer;
+        PendingSizeGetter m_pendingSizeGetter;
+        RequestDispatcher m_dispatcher;
+
+        QByteArray m_receivedData;
+        bool m_isPrefaceReceived = false;
+        bool m_isSettingsReceived = false;
+        bool m_isGoingAway = false;
+
+        HPack::Decoder m_decoder;
+        HPack::Encoder m_encoder;
+        // header block split into HEADERS and CONTINUATION frames
+        QByteArray m_headerBlock;
+        quint32 m_headerBlockStreamID = 0;
+        bool m_isHeaderBlockEndStream = false;
+
+        std::unordered_map<quint32, std::unique_ptr<Stream>> m_streams;
+        // streams having data to send, in the order they are served
+        QList<quint32> m_sendingStreams;
+        quint32 m_lastStreamID = 0;
+
+        qint64 m_sendWindow = 0;
+        qint64 m_peerInitialWindowSize = 0;
+        qint64 m_peerMaxFrameSize = 0;
+    };
+}
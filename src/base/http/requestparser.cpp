@@ -52,13 +52,6 @@ namespace
 {
     const QByteArray EOH = QByteArray(CRLF).repeated(2);
 
-    const QByteArrayView viewWithoutEndingWith(const QByteArrayView in, const QByteArrayView str)
-    {
-        if (in.endsWith(str))
-            return in.chopped(str.size());
-        return in;
-    }
-
     bool parseHeaderLine(const QStringView line, HeaderMap &out)
     {
         // [rfc7230] 3.2. Header Fields
@@ -77,37 +70,44 @@ namespace
     }
 }
 
-RequestParser::ParseResult RequestParser::parse(const QByteArray &data)
+RequestParser::ParseResult RequestParser::parse(const QByteArrayView data)
 {
     // Warning! Header names are converted to lowercase
-    return RequestParser().doParse(data);
+    ParseResult result = doParse(data);
+    if (result.status != ParseStatus::Incomplete)
+        reset();
+    return result;
 }
 
 RequestParser::ParseResult RequestParser::doParse(const QByteArrayView data)
 {
-    // we don't handle malformed requests which use double `LF` as delimiter
-    const int headerEnd = data.indexOf(EOH);
-    if (headerEnd < 0)
+    qsizetype headerLength = 0;
+    if (m_state == State::StartLines)
     {
-        qDebug() << Q_FUNC_INFO << "incomplete request";
-        return {ParseStatus::Incomplete, Request(), 0};
-    }
+        // we don't handle malformed requests which use double `LF` as delimiter
+        const int headerEnd = data.indexOf(EOH);
+        if (headerEnd < 0)
+        {
+            qDebug() << Q_FUNC_INFO << "incomplete request";
+            return {ParseStatus::Incomplete, Request(), 0};
+        }
 
-    const QString httpHeaders = QString::fromLatin1(data.constData(), headerEnd);
-    if (!parseStartLines(httpHeaders))
-    {
-        qWarning() << Q_FUNC_INFO << "header parsing error";
-        return {ParseStatus::BadRequest, Request(), 0};
-    }
+        const QString httpHeaders = QString::fromLatin1(data.constData(), headerEnd);
+        if (!parseStartLines(httpHeaders))
+        {
+            qWarning() << Q_FUNC_INFO << "header parsing error";
+            return {ParseStatus::BadRequest, Request(), 0};
+        }
 
-    const int headerLength = headerEnd + EOH.length();
+        headerLength = headerEnd + EOH.length();
 
-    // handle supported methods
-    if ((m_request.method == HEADER_REQUEST_METHOD_GET) || (m_request.method == HEADER_REQUEST_METHOD_HEAD))
-        return {ParseStatus::OK, m_request, headerLength};
+        // handle supported methods
+        if ((m_request.method == HEADER_REQUEST_METHOD_GET) || (m_request.method == HEADER_REQUEST_METHOD_HEAD))
+            return {ParseStatus::OK, std::move(m_request), headerLength};
+
+        if (m_request.method != HEADER_REQUEST_METHOD_POST)
+            return {ParseStatus::BadMethod, m_request, 0};
 
-    if (m_request.method == HEADER_REQUEST_METHOD_POST)
-    {
         const auto parseContentLength = [this]() -> int
         {
             // [rfc7230] 3.3.2. Content-Length
@@ -124,32 +124,107 @@ RequestParser::ParseResult RequestParser::doParse(const QByteArrayView data)
             qWarning() << Q_FUNC_INFO << "bad request: content-length invalid";
             return {ParseStatus::BadRequest, Request(), 0};
         }
-        if (contentLength > MAX_CONTENT_SIZE)
-        {
-            qWarning() << Q_FUNC_INFO << "bad request: message too long";
-            return {ParseStatus::BadRequest, Request(), 0};
-        }
 
-        if (contentLength > 0)
+        if (contentLength == 0)
+            return {ParseStatus::OK, std::move(m_request), headerLength};
+
+        const QString contentType = m_request.headers[HEADER_CONTENT_TYPE];
+        if (contentType.startsWith(CONTENT_TYPE_FORM_DATA, Qt::CaseInsensitive))
         {
-            const QByteArrayView httpBodyView = data.mid(headerLength, contentLength);
-            if (httpBodyView.length() < contentLength)
+            if (contentLength > MAX_FORM_DATA_SIZE)
+            {
+                qWarning() << Q_FUNC_INFO << "bad request: message too long";
+                return {ParseStatus::BadRequest, Request(), 0};
+            }
+
+            // [rfc2046] 5.1.1. Common Syntax
+
+            // find boundary delimiter
+            const QString boundaryFieldName = u"boundary="_s;
+            const int idx = contentType.indexOf(boundaryFieldName);
+            if (idx < 0)
+            {
+                qWarning() << Q_FUNC_INFO << "Could not find boundary in multipart/form-data header!";
+                return {ParseStatus::BadRequest, Request(), 0};
+            }
+
+            const QByteArray delimiter = Utils::String::unquote(QStringView(contentType).mid(idx + boundaryFieldName.size())).toLatin1();
+            if (delimiter.isEmpty())
             {
-                qDebug() << Q_FUNC_INFO << "incomplete request";
-                return {ParseStatus::Incomplete, Request(), 0};
+                qWarning() << Q_FUNC_INFO << "boundary delimiter field empty!";
+                return {ParseStatus::BadRequest, Request(), 0};
             }
 
-            if (!parsePostMessage(httpBodyView))
+            m_dashBoundary = QByteArray("--") + delimiter;
+            m_state = State::FormDataPreamble;
+        }
+        else
+        {
+            if (contentLength > MAX_CONTENT_SIZE)
             {
-                qWarning() << Q_FUNC_INFO << "message body parsing error";
+                qWarning() << Q_FUNC_INFO << "bad request: message too long";
                 return {ParseStatus::BadRequest, Request(), 0};
             }
+
+            m_state = State::Body;
         }
 
-        return {ParseStatus::OK, m_request, (headerLength + contentLength)};
+        m_remainingContentLength = contentLength;
     }
 
-    return {ParseStatus::BadMethod, m_request, 0};
+    const QByteArrayView body = data.sliced(headerLength).first(std::min(m_remainingContentLength, (data.size() - headerLength)));
+    const bool isBodyComplete = (body.size() == m_remainingContentLength);
+
+    if (m_state == State::Body)
+    {
+        // the whole body is needed at once
+        if (!isBodyComplete)
+        {
+            qDebug() << Q_FUNC_INFO << "incomplete request";
+            return {ParseStatus::Incomplete, Request(), headerLength};
+        }
+
+        if (!parsePostMessage(body))
+        {
+            qWarning() << Q_FUNC_INFO << "message body parsing error";
+            return {ParseStatus::BadRequest, Request(), 0};
+        }
+
+        return {ParseStatus::OK, std::move(m_request), (headerLength + body.size())};
+    }
+
+    const qsizetype consumedBodySize = parseFormData(body);
+    if (consumedBodySize < 0)
+    {
+        qWarning() << Q_FUNC_INFO << "message body parsing error";
+        return {ParseStatus::BadRequest, Request(), 0};
+    }
+
+    m_remainingContentLength -= consumedBodySize;
+    if (m_remainingContentLength > 0)
+    {
+        if (isBodyComplete)
+        {
+            // the body has ended before the closing boundary
+            qWarning() << Q_FUNC_INFO << "multipart/form-data format error";
+            return {ParseStatus::BadRequest, Request(), 0};
+        }
+
+        qDebug() << Q_FUNC_INFO << "incomplete request";
+        return {ParseStatus::Incomplete, Request(), (headerLength + consumedBodySize)};
+    }
+
+    return {ParseStatus::OK, std::move(m_request), (headerLength + consumedBodySize)};
+}
+
+void RequestParser::reset()
+{
+    m_state = State::StartLines;
+    m_request = {};
+    m_remainingContentLength = 0;
+    m_dashBoundary.clear();
+    m_partHeaders.clear();
+    m_partPayload.clear();
 }
 
 bool RequestParser::parseStartLines(const QStringView data)
@@ -258,64 +333,124 @@ bool RequestParser::parsePostMessage(const QByteArrayView data)
         return true;
     }
 
-    // multipart/form-data
-    if (contentTypeLower.startsWith(CONTENT_TYPE_FORM_DATA))
+    qWarning() << Q_FUNC_INFO << "unknown content type:" << contentType;
+    return false;
+}
+
+qsizetype RequestParser::parseFormData(const QByteArrayView data)
+{
+    // [rfc2046] 5.1.1. Common Syntax
+    // The parts are separated by "dash-boundary" lines, the one following the last part ends with "--".
+    // Each part payload is taken as soon as its ending delimiter is received, the payload received so far
+    // is kept by the parser, so the caller only needs to keep the bytes that may be start of the delimiter.
+    const QByteArray delimiter = CRLF + m_dashBoundary;
+
+    qsizetype pos = 0;
+    while (pos < data.size())
     {
-        // [rfc2046] 5.1.1. Common Syntax
+        const QByteArrayView rest = data.sliced(pos);
 
-        // find boundary delimiter
-        const QString boundaryFieldName = u"boundary="_s;
-        const int idx = contentType.indexOf(boundaryFieldName);
-        if (idx < 0)
+        switch (m_state)
         {
-            qWarning() << Q_FUNC_INFO << "Could not find boundary in multipart/form-data header!";
-            return false;
-        }
+        case State::FormDataPreamble:
+            {
+                // preamble before the first boundary is ignored
+                const qsizetype boundaryPos = rest.indexOf(m_dashBoundary);
+                if (boundaryPos < 0)
+                    return pos + std::max<qsizetype>(0, (rest.size() - m_dashBoundary.size() + 1));
+                if (rest.size() < (boundaryPos + m_dashBoundary.size() + 2))
+                    return pos + boundaryPos;
+
+                if (rest.sliced((boundaryPos + m_dashBoundary.size()), 2) != CRLF)
+                {
+                    qWarning() << Q_FUNC_INFO << "multipart empty";
+                    return -1;
+                }
+
+                pos += boundaryPos + m_dashBoundary.size() + 2;
+                m_state = State::FormDataPartHeaders;
+            }
+            break;
 
-        const QByteArray delimiter = Utils::String::unquote(QStringView(contentType).mid(idx + boundaryFieldName.size())).toLatin1();
-        if (delimiter.isEmpty())
-        {
-            qWarning() << Q_FUNC_INFO << "boundary delimiter field empty!";
-            return false;
-        }
+        case State::FormDataPartHeaders:
+            {
+                const qsizetype eohPos = rest.indexOf(EOH);
+                if (eohPos < 0)
+                {
+                    if (rest.size() > MAX_CONTENT_SIZE)
+                    {
+                        qWarning() << Q_FUNC_INFO << "multipart/form-data format error";
+                        return -1;
+                    }
+                    return pos;
+                }
+
+                if (!parseFormDataPartHeaders(rest.first(eohPos)))
+                    return -1;
+
+                pos += eohPos + EOH.size();
+                m_state = State::FormDataPartPayload;
+            }
+            break;
 
-        // split data by "dash-boundary"
-        const QByteArray dashDelimiter = QByteArray("--") + delimiter + CRLF;
-        QList<QByteArrayView> multipart = splitToViews(data, dashDelimiter, Qt::SkipEmptyParts);
-        if (multipart.isEmpty())
-        {
-            qWarning() << Q_FUNC_INFO << "multipart empty";
-            return false;
-        }
+        case State::FormDataPartPayload:
+            {
+                const qsizetype delimiterPos = rest.indexOf(delimiter);
+                const qsizetype payloadSize = (delimiterPos >= 0)
+                    ? delimiterPos : std::max<qsizetype>(0, (rest.size() - delimiter.size() + 1));
+                if ((m_partPayload.size() + payloadSize) > MAX_CONTENT_SIZE)
+                {
+                    qWarning() << Q_FUNC_INFO << "bad request: form data part too long";
+                    return -1;
+                }
+
+                m_partPayload.append(rest.first(payloadSize));
+                pos += payloadSize;
+
+                // the delimiter is followed either by CRLF or by "--" after the last part
+                if ((delimiterPos < 0) || (rest.size() < (delimiterPos + delimiter.size() + 2)))
+                    return pos;
+
+                if (!addFormDataPart())
+                    return -1;
+
+                const QByteArrayView delimiterEnd = rest.sliced((delimiterPos + delimiter.size()), 2);
+                if (delimiterEnd == "--")
+                {
+                    m_state = State::FormDataEpilogue;
+                }
+                else if (delimiterEnd == CRLF)
+                {
+                    m_state = State::FormDataPartHeaders;
+                }
+                else
+                {
+                    qWarning() << Q_FUNC_INFO << "multipart/form-data format error";
+                    return -1;
+                }
+
+                pos += delimiter.size() + 2;
+            }
+            break;
 
-        // remove the ending delimiter
-        const QByteArray endDelimiter = QByteArray("--") + delimiter + QByteArray("--") + CRLF;
-        multipart.push_back(viewWithoutEndingWith(multipart.takeLast(), endDelimiter));
+        case State::FormDataEpilogue:
+            // epilogue after the closing boundary is ignored
+            return data.size();
 
-        return std::all_of(multipart.cbegin(), multipart.cend(), [this](const QByteArrayView &part)
-        {
-            return this->parseFormData(part);
-        });
+        default:
+            Q_ASSERT(false);
+            return -1;
+        }
     }
 
-    qWarning() << Q_FUNC_INFO << "unknown content type:" << contentType;
-    return false;
+    return pos;
 }
 
-bool RequestParser::parseFormData(const QByteArrayView data)
+bool RequestParser::parseFormDataPartHeaders(const QByteArrayView data)
 {
-    const int eohPos = data.indexOf(EOH);
-
-    if (eohPos < 0)
-    {
-        qWarning() << Q_FUNC_INFO << "multipart/form-data format error";
-        return false;
-    }
+    const QString headers = QString::fromLatin1(data);
 
-    const QString headers = QString::fromLatin1(data.mid(0, eohPos));
-    const QByteArrayView payload = viewWithoutEndingWith(data.mid((eohPos + EOH.size()), data.size()), CRLF);
-
-    HeaderMap headersMap;
+    m_partHeaders.clear();
     const QList<QStringView> headerLines = QStringView(headers).split(QString::fromLatin1(CRLF), Qt::SkipEmptyParts);
     for (const auto &line : headerLines)
     {
@@ -332,27 +467,33 @@ bool RequestParser::parseFormData(const QByteArrayView data)
 
                 const QString name = directive.left(idx).trimmed().toString().toLower();
                 const QString value = Utils::String::unquote(directive.mid(idx + 1).trimmed()).toString();
-                headersMap[name] = value;
+                m_partHeaders[name] = value;
             }
         }
         else
         {
-            if (!parseHeaderLine(line.toString(), headersMap))
+            if (!parseHeaderLine(line.toString(), m_partHeaders))
                 return false;
         }
     }
 
+    return true;
+}
+
+bool RequestParser::addFormDataPart()
+{
     // pick data
     const QString filename = u"filename"_s;
     const QString name = u"name"_s;
 
-    if (headersMap.contains(filename))
+    const QByteArray payload = std::exchange(m_partPayload, {});
+    if (m_partHeaders.contains(filename))
     {
-        m_request.files.append({headersMap[filename], headersMap[HEADER_CONTENT_TYPE], payload.toByteArray()});
+        m_request.files.append({m_partHeaders[filename], m_partHeaders[HEADER_CONTENT_TYPE], payload});
     }
-    else if (headersMap.contains(name))
+    else if (m_partHeaders.contains(name))
     {
-        m_request.posts[headersMap[name]] = QString::fromUtf8(payload);
+        m_request.posts[m_partHeaders[name]] = QString::fromUtf8(payload);
     }
     else
     {
@@ -30,10 +30,17 @@
 
 #pragma once
 
+#include <QByteArray>
+#include <QByteArrayView>
+
 #include "types.h"
 
 namespace Http
 {
+    // Parses requests incrementally: the data can be given as it is received,
+    // whatever is consumed by the parser doesn't need to be kept by the caller.
+    // Parts of multipart/form-data body are decoded one by one as they arrive,
+    // so only the part being received is buffered rather than the whole body.
     class RequestParser
     {
     public:
@@ -47,26 +54,49 @@ namespace Http
 
         struct ParseResult
         {
-            // when `status != ParseStatus::OK`, `request` & `frameSize` are undefined
+            // when `status != ParseStatus::OK`, `request` is undefined
             ParseStatus status = ParseStatus::BadRequest;
             Request request;
-            long frameSize = 0;  // http request frame size (bytes)
+            // bytes of the data consumed, the following call should continue with the rest of the data
+            qsizetype consumedSize = 0;
         };
 
-        static ParseResult parse(const QByteArray &data);
+        // Continues parsing of the current request with the data following the one consumed so far.
+        // Parser is reset to start the next request once the current one is parsed or fails.
+        ParseResult parse(QByteArrayView data);
 
         static const long MAX_CONTENT_SIZE = 64 * 1024 * 1024;  // 64 MB
+        // multipart/form-data body isn't buffered as a whole, only its parts are limited by `MAX_CONTENT_SIZE`
+        static const long MAX_FORM_DATA_SIZE = 512 * 1024 * 1024;  // 512 MB
 
     private:
-        RequestParser() = default;
+        enum class State
+        {
+            StartLines,
+            Body,
+            FormDataPreamble,
+            FormDataPartHeaders,
+            FormDataPartPayload,
+            FormDataEpilogue
+        };
 
         ParseResult doParse(QByteArrayView data);
+        void reset();
         bool parseStartLines(QStringView data);
         bool parseRequestLine(const QString &line);
 
         bool parsePostMessage(QByteArrayView data);
-        bool parseFormData(QByteArrayView data);
+        // returns the number of bytes consumed, -1 on error
+        qsizetype parseFormData(QByteArrayView data);
+        bool parseFormDataPartHeaders(QByteArrayView data);
+        bool addFormDataPart();
 
+        State m_state = State::StartLines;
         Request m_request;
+        qsizetype m_remainingContentLength = 0;
+        // "--" + boundary
+        QByteArray m_dashBoundary;
+        HeaderMap m_partHeaders;
+        QByteArray m_partPayload;
     };
 }
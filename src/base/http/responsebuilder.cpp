@@ -50,6 +50,16 @@ void ResponseBuilder::print(const QByteArray &data, const QString &type)
     print_impl(data, type);
 }
 
+void ResponseBuilder::setGzipContent(const QByteArray &data)
+{
+    m_response.gzipContent = data;
+}
+
+void ResponseBuilder::setStream(std::shared_ptr<ResponseStream> stream)
+{
+    m_response.stream = std::move(stream);
+}
+
 void ResponseBuilder::clear()
 {
     m_response = Response();
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QString>
 
 #include "base/global.h"
@@ -42,6 +44,9 @@ namespace Http
         void setHeader(const Header &header);
         void print(const QString &text, const QString &type = CONTENT_TYPE_HTML);
         void print(const QByteArray &data, const QString &type = CONTENT_TYPE_HTML);
+        // gzip compressed variant of the printed content, sent if client accepts it
+        void setGzipContent(const QByteArray &data);
+        void setStream(std::shared_ptr<ResponseStream> stream);
         void clear();
 
         Response response() const;
@@ -30,20 +30,27 @@
 #include "responsegenerator.h"
 
 #include <QDateTime>
+#include <QList>
 
 #include "base/http/types.h"
 #include "base/utils/gzip.h"
 
 QByteArray Http::toByteArray(Response response)
 {
-    compressContent(response);
+    QByteArray buf = serializeHeader(response);
 
-    response.headers[HEADER_DATE] = httpDate();
-    if (QString &value = response.headers[HEADER_CONTENT_LENGTH]; value.isEmpty())
-        value = QString::number(response.content.length());
+    // message body
+    buf += response.content;
+
+    return buf;
+}
+
+QByteArray Http::serializeHeader(Response &response)
+{
+    finalizeResponse(response);
 
     QByteArray buf;
-    buf.reserve(1024 + response.content.length());
+    buf.reserve(1024);
 
     // Status Line
     buf.append("HTTP/1.1 ")  // TODO: depends on request
@@ -64,12 +71,24 @@ QByteArray Http::toByteArray(Response response)
     // the first empty line
     buf += CRLF;
 
-    // message body
-    buf += response.content;
-
     return buf;
 }
 
+void Http::finalizeResponse(Response &response)
+{
+    // streamed content is compressed by the connection as it is sent
+    if (!response.stream)
+        compressContent(response);
+
+    response.headers[HEADER_DATE] = httpDate();
+    // length of streamed content isn't known in advance, it ends when connection is closed
+    if (!response.stream)
+    {
+        if (QString &value = response.headers[HEADER_CONTENT_LENGTH]; value.isEmpty())
+            value = QString::number(response.content.length());
+    }
+}
+
 QString Http::httpDate()
 {
     // [RFC 7231] 7.1.1.1. Date/Time Formats
@@ -86,6 +105,13 @@ void Http::compressContent(Response &response)
 
     response.headers.remove(HEADER_CONTENT_ENCODING);
 
+    if (!response.gzipContent.isEmpty())
+    {
+        response.content = response.gzipContent;
+        response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
+        return;
+    }
+
     // for very small files, compressing them only wastes cpu cycles
     const int contentSize = response.content.size();
     if (contentSize <= 1024)  // 1 kb
@@ -98,7 +124,7 @@ void Http::compressContent(Response &response)
 
     // try compressing
     bool ok = false;
-    const QByteArray compressedData = Utils::Gzip::compress(response.content, 6, &ok);
+    const QByteArray compressedData = Utils::Gzip::compressParallel(response.content, Utils::Gzip::adaptiveLevel(contentSize), &ok);
     if (!ok)
         return;
 
@@ -109,3 +135,53 @@ void Http::compressContent(Response &response)
     response.content = compressedData;
     response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
 }
+
+bool Http::isCompressibleStream(const QString &contentType)
+{
+    // event streams are left as is, some proxies hold compressed responses until they are complete
+    return (contentType == CONTENT_TYPE_JSON) || (contentType == CONTENT_TYPE_CBOR)
+        || (contentType == CONTENT_TYPE_TXT);
+}
+
+bool Http::acceptsGzipEncoding(QString codings)
+{
+    // [rfc7231] 5.3.4. Accept-Encoding
+
+    const auto isCodingAvailable = [](const QList<QStringView> &list, const QStringView encoding) -> bool
+    {
+        for (const QStringView &str : list)
+        {
+            if (!str.startsWith(encoding))
+                continue;
+
+            // without quality values
+            if (str == encoding)
+                return true;
+
+            // [rfc7231] 5.3.1. Quality Values
+            const QStringView substr = str.mid(encoding.size() + 3);  // ex. skip over "gzip;q="
+
+            bool ok = false;
+            const double qvalue = substr.toDouble(&ok);
+            if (!ok || (qvalue <= 0))
+                return false;
+
+            return true;
+        }
+        return false;
+    };
+
+    const QList<QStringView> list = QStringView(codings.remove(u' ').remove(u'\t')).split(u',', Qt::SkipEmptyParts);
+    if (list.isEmpty())
+        return false;
+
+    const bool canGzip = isCodingAvailable(list, u"gzip"_s);
+    if (canGzip)
+        return true;
+
+    const bool canAny = isCodingAvailable(list, u"*"_s);
+    if (canAny)
+        return true;
+
+    return false;
+}
@@ -38,6 +38,14 @@ namespace Http
     struct Response;
 
     QByteArray toByteArray(Response response);
+    // Finalizes the response and returns its status line and header fields,
+    // the content is left for the caller to send
+    QByteArray serializeHeader(Response &response);
+    // Finalizes the response before it is sent (content compression, Date and Content-Length headers)
+    void finalizeResponse(Response &response);
     QString httpDate();
     void compressContent(Response &response);
+    bool acceptsGzipEncoding(QString codings);
+    // whether streamed content of the type is compressed as it is sent
+    bool isCompressibleStream(const QString &contentType);
 }
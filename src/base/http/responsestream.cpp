@@ -0,0 +1,114 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "responsestream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QMetaObject>
+
+#include "connectionpool.h"
+
+using namespace Http;
+
+bool ResponseStream::isOpen() const
+{
+    return m_isOpen.load(std::memory_order_relaxed);
+}
+
+qint64 ResponseStream::pendingSize() const
+{
+    // sent size includes the headers so it can slightly exceed the written one
+    return std::max<qint64>(0, m_pendingSize.load(std::memory_order_relaxed));
+}
+
+void ResponseStream::write(const QByteArray &data)
+{
+    if (!isOpen())
+        return;
+
+    m_pendingSize.fetch_add(data.size(), std::memory_order_relaxed);
+
+    const QMutexLocker locker {&m_mutex};
+    if (!m_isStarted)
+    {
+        m_pendingData += data;
+        return;
+    }
+
+    if (!m_connectionPool)
+        return;
+
+    QMetaObject::invokeMethod(m_connectionPool, [connectionPool = m_connectionPool.data(), connectionID = m_connectionID, stream = this, data]
+    {
+        connectionPool->writeStream(connectionID, stream, data);
+    }, Qt::QueuedConnection);
+}
+
+void ResponseStream::close()
+{
+    if (!m_isOpen.exchange(false))
+        return;
+
+    // not started stream is closed by the connection when it starts
+    const QMutexLocker locker {&m_mutex};
+    if (!m_isStarted || !m_connectionPool)
+        return;
+
+    QMetaObject::invokeMethod(m_connectionPool, [connectionPool = m_connectionPool.data(), connectionID = m_connectionID, stream = this]
+    {
+        connectionPool->closeStream(connectionID, stream);
+    }, Qt::QueuedConnection);
+}
+
+void ResponseStream::attach(ConnectionPool *connectionPool, const quint64 connectionID)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_connectionPool = connectionPool;
+    m_connectionID = connectionID;
+}
+
+QByteArray ResponseStream::start(bool &isClosed)
+{
+    const QMutexLocker locker {&m_mutex};
+    m_isStarted = true;
+    isClosed = !isOpen();
+    return std::exchange(m_pendingData, {});
+}
+
+void ResponseStream::handleDataSent(const qint64 size)
+{
+    m_pendingSize.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void ResponseStream::detach()
+{
+    // called from the I/O thread once the connection is gone
+    m_isOpen.store(false, std::memory_order_relaxed);
+}
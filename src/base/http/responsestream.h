@@ -0,0 +1,79 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QPointer>
+
+namespace Http
+{
+    class ConnectionPool;
+
+    // Body of a response which is written progressively after the response itself is sent,
+    // e.g. Server-Sent Events. It can be written from any thread, written data is forwarded
+    // to the connection in its I/O thread. Data written before the response is sent is
+    // kept until then.
+    // Unless the response has Content-Length, the body is sent with chunked transfer coding
+    // (compressed if the client accepts it) and the connection is kept alive once it is closed.
+    // On HTTP/2 connection the body is sent in DATA frames of the stream of its request.
+    class ResponseStream
+    {
+    public:
+        bool isOpen() const;
+        // Size of the written data which isn't sent to the client yet,
+        // it allows the writer to keep pace with the client
+        qint64 pendingSize() const;
+
+        void write(const QByteArray &data);
+        void close();
+
+    private:
+        friend class Connection;
+        friend class ConnectionPool;
+        friend class Http2Session;
+
+        void attach(ConnectionPool *connectionPool, quint64 connectionID);
+        // Called by the connection once the response is sent.
+        // Returns the data written so far, `isClosed` tells whether the stream was closed already.
+        QByteArray start(bool &isClosed);
+        void detach();
+        void handleDataSent(qint64 size);
+
+        mutable QMutex m_mutex;
+        QPointer<ConnectionPool> m_connectionPool;
+        quint64 m_connectionID = 0;
+        bool m_isStarted = false;
+        QByteArray m_pendingData;
+        std::atomic_bool m_isOpen {true};
+        std::atomic<qint64> m_pendingSize {0};
+    };
+}
@@ -31,30 +31,29 @@
 #include "server.h"
 
 #include <algorithm>
-#include <chrono>
-#include <memory>
-#include <new>
 
 #include <QtLogging>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QNetworkProxy>
 #include <QSslCipher>
 #include <QSslConfiguration>
-#include <QSslSocket>
 #include <QStringList>
-#include <QTimer>
+#include <QTcpSocket>
+#include <QThread>
 
 #include "base/global.h"
 #include "base/utils/net.h"
 #include "base/utils/sslkey.h"
-#include "connection.h"
-
-using namespace std::chrono_literals;
+#include "connectionpool.h"
 
 namespace
 {
-    const int KEEP_ALIVE_DURATION = std::chrono::milliseconds(7s).count();
-    const int CONNECTIONS_LIMIT = 500;
-    const std::chrono::seconds CONNECTIONS_SCAN_INTERVAL {2};
+    const int MAX_IO_THREADS = 4;
+
+    QMutex tlsHandshakeStatisticsMutex;
+    Http::TLSHandshakeStatistics tlsHandshakeStatisticsData;
 
     QList<QSslCipher> safeCipherList()
     {
@@ -99,7 +98,6 @@ using namespace Http;
 
 Server::Server(IRequestHandler *requestHandler, QObject *parent)
     : QTcpServer(parent)
-    , m_requestHandler(requestHandler)
 {
     setProxy(QNetworkProxy::NoProxy);
 
@@ -108,63 +106,77 @@ Server::Server(IRequestHandler *requestHandler, QObject *parent)
     sslConf.setCiphers(safeCipherList());
     QSslConfiguration::setDefaultConfiguration(sslConf);
 
-    auto *dropConnectionTimer = new QTimer(this);
-    connect(dropConnectionTimer, &QTimer::timeout, this, &Server::dropTimedOutConnection);
-    dropConnectionTimer->start(CONNECTIONS_SCAN_INTERVAL);
+    const int ioThreadsCount = std::clamp(QThread::idealThreadCount(), 1, MAX_IO_THREADS);
+    m_ioThreads.reserve(ioThreadsCount);
+    for (int i = 0; i < ioThreadsCount; ++i)
+    {
+        auto *connectionPool = new ConnectionPool(requestHandler, this);
+        connect(connectionPool, &ConnectionPool::connectionsRemoved, this, [this](const int count)
+        {
+            m_connectionsCount -= count;
+        });
+
+        Utils::Thread::UniquePtr &ioThread = m_ioThreads.emplace_back(new QThread);
+        connectionPool->moveToThread(ioThread.get());
+        connect(ioThread.get(), &QThread::finished, connectionPool, &QObject::deleteLater);
+        ioThread->start();
+
+        m_connectionPools.append(connectionPool);
+    }
 }
 
 void Server::incomingConnection(const qintptr socketDescriptor)
 {
-    std::unique_ptr<QTcpSocket> serverSocket = m_https ? std::make_unique<QSslSocket>(this) : std::make_unique<QTcpSocket>(this);
-    if (!serverSocket->setSocketDescriptor(socketDescriptor))
-        return;
-
-    if (m_connections.size() >= CONNECTIONS_LIMIT)
+    if (m_connectionsCount >= m_connectionsLimit)
     {
-        qWarning("Too many connections. Exceeded CONNECTIONS_LIMIT (%d). Connection closed.", CONNECTIONS_LIMIT);
+        qWarning("Too many connections. Exceeded connections limit (%d). Connection closed.", m_connectionsLimit);
+
+        // the socket takes ownership of the descriptor and closes it
+        QTcpSocket socket;
+        socket.setSocketDescriptor(socketDescriptor);
         return;
     }
 
-    try
-    {
-        if (m_https)
-        {
-            auto *sslSocket = static_cast<QSslSocket *>(serverSocket.get());
-            sslSocket->setProtocol(QSsl::SecureProtocols);
-            sslSocket->setPrivateKey(m_key);
-            sslSocket->setLocalCertificateChain(m_certificates);
-            sslSocket->setPeerVerifyMode(QSslSocket::VerifyNone);
-            sslSocket->startServerEncryption();
-        }
-
-        auto *connection = new Connection(serverSocket.release(), m_requestHandler, this);
-        m_connections.insert(connection);
-        connect(connection, &Connection::closed, this, [this, connection] { removeConnection(connection); });
-    }
-    catch (const std::bad_alloc &exception)
+    ++m_connectionsCount;
+
+    // the socket is created in the I/O thread so it belongs to that thread
+    ConnectionPool *connectionPool = m_connectionPools[m_nextConnectionPool];
+    m_nextConnectionPool = (m_nextConnectionPool + 1) % m_connectionPools.size();
+    QMetaObject::invokeMethod(connectionPool, [connectionPool, socketDescriptor, https = m_https, http2 = m_http2Enabled
+        , certificates = m_certificates, key = m_key]
     {
-        // drop the connection instead of throwing exception and crash
-        qWarning("Failed to allocate memory for HTTP connection. Connection closed.");
-        return;
-    }
+        connectionPool->addConnection(socketDescriptor, https, http2, certificates, key);
+    }, Qt::QueuedConnection);
+}
+
+int Server::connectionsLimit() const
+{
+    return m_connectionsLimit;
 }
 
-void Server::removeConnection(Connection *connection)
+void Server::setConnectionsLimit(const int limit)
 {
-    m_connections.remove(connection);
-    connection->deleteLater();
+    m_connectionsLimit = std::max(1, limit);
 }
 
-void Server::dropTimedOutConnection()
+TLSHandshakeStatistics Server::tlsHandshakeStatistics()
 {
-    m_connections.removeIf([](Connection *connection)
+    const QMutexLocker locker {&tlsHandshakeStatisticsMutex};
+    return tlsHandshakeStatisticsData;
+}
+
+void Server::addTLSHandshake(const bool succeeded, const qint64 time)
+{
+    const QMutexLocker locker {&tlsHandshakeStatisticsMutex};
+    if (!succeeded)
     {
-        if (!connection->hasExpired(KEEP_ALIVE_DURATION))
-            return false;
+        ++tlsHandshakeStatisticsData.failedCount;
+        return;
+    }
 
-        connection->deleteLater();
-        return true;
-    });
+    ++tlsHandshakeStatisticsData.count;
+    tlsHandshakeStatisticsData.totalTime += time;
+    tlsHandshakeStatisticsData.maxTime = std::max(tlsHandshakeStatisticsData.maxTime, time);
 }
 
 bool Server::setupHttps(const QByteArray &certificates, const QByteArray &privateKey)
@@ -195,3 +207,13 @@ bool Server::isHttps() const
 {
     return m_https;
 }
+
+bool Server::isHttp2Enabled() const
+{
+    return m_http2Enabled;
+}
+
+void Server::setHttp2Enabled(const bool enabled)
+{
+    m_http2Enabled = enabled;
+}
@@ -30,15 +30,28 @@
 
 #pragma once
 
-#include <QSet>
+#include <vector>
+
+#include <QList>
 #include <QSslCertificate>
 #include <QSslKey>
 #include <QTcpServer>
 
+#include "base/utils/thread.h"
+
 namespace Http
 {
     class IRequestHandler;
-    class Connection;
+    class ConnectionPool;
+
+    // Durations of TLS handshakes of all the servers accumulated since the application start
+    struct TLSHandshakeStatistics
+    {
+        qint64 count = 0;  // succeeded handshakes
+        qint64 failedCount = 0;
+        qint64 totalTime = 0;  // nanoseconds
+        qint64 maxTime = 0;  // nanoseconds
+    };
 
     class Server final : public QTcpServer
     {
@@ -51,18 +64,29 @@ namespace Http
         bool setupHttps(const QByteArray &certificates, const QByteArray &privateKey);
         void disableHttps();
         bool isHttps() const;
+        // HTTP/2 is negotiated only on HTTPS connections
+        bool isHttp2Enabled() const;
+        void setHttp2Enabled(bool enabled);
+
+        int connectionsLimit() const;
+        void setConnectionsLimit(int limit);
 
-    private slots:
-        void dropTimedOutConnection();
+        static TLSHandshakeStatistics tlsHandshakeStatistics();
+        // thread-safe, called by the connection pools from I/O threads
+        static void addTLSHandshake(bool succeeded, qint64 time);
 
     private:
         void incomingConnection(qintptr socketDescriptor) override;
-        void removeConnection(Connection *connection);
 
-        IRequestHandler *m_requestHandler = nullptr;
-        QSet<Connection *> m_connections;  // for tracking persistent connections
+        // connections are handled by I/O threads, requests are processed in the thread of the server
+        QList<ConnectionPool *> m_connectionPools;
+        std::vector<Utils::Thread::UniquePtr> m_ioThreads;
+        int m_nextConnectionPool = 0;
+        int m_connectionsCount = 0;
+        int m_connectionsLimit = 500;
 
         bool m_https = false;
+        bool m_http2Enabled = false;
         QList<QSslCertificate> m_certificates;
         QSslKey m_key;
     };
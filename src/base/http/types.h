@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QHostAddress>
 #include <QString>
 #include <QVector>
@@ -37,23 +39,34 @@
 
 namespace Http
 {
+    class ResponseStream;
+
     inline const QString METHOD_GET = u"GET"_s;
     inline const QString METHOD_POST = u"POST"_s;
 
+    inline const QString HEADER_ACCEPT = u"accept"_s;
+    inline const QString HEADER_ACCEPT_RANGES = u"accept-ranges"_s;
+    inline const QString HEADER_AUTHORIZATION = u"authorization"_s;
     inline const QString HEADER_CACHE_CONTROL = u"cache-control"_s;
     inline const QString HEADER_CONNECTION = u"connection"_s;
     inline const QString HEADER_CONTENT_DISPOSITION = u"content-disposition"_s;
     inline const QString HEADER_CONTENT_ENCODING = u"content-encoding"_s;
     inline const QString HEADER_CONTENT_LENGTH = u"content-length"_s;
+    inline const QString HEADER_CONTENT_RANGE = u"content-range"_s;
     inline const QString HEADER_CONTENT_SECURITY_POLICY = u"content-security-policy"_s;
     inline const QString HEADER_CONTENT_TYPE = u"content-type"_s;
     inline const QString HEADER_CROSS_ORIGIN_OPENER_POLICY  = u"cross-origin-opener-policy"_s;
     inline const QString HEADER_DATE = u"date"_s;
+    inline const QString HEADER_ETAG = u"etag"_s;
     inline const QString HEADER_HOST = u"host"_s;
+    inline const QString HEADER_IF_NONE_MATCH = u"if-none-match"_s;
     inline const QString HEADER_ORIGIN = u"origin"_s;
+    inline const QString HEADER_RANGE = u"range"_s;
     inline const QString HEADER_REFERER = u"referer"_s;
     inline const QString HEADER_REFERRER_POLICY = u"referrer-policy"_s;
     inline const QString HEADER_SET_COOKIE = u"set-cookie"_s;
+    inline const QString HEADER_TRANSFER_ENCODING = u"transfer-encoding"_s;
+    inline const QString HEADER_VARY = u"vary"_s;
     inline const QString HEADER_X_CONTENT_TYPE_OPTIONS = u"x-content-type-options"_s;
     inline const QString HEADER_X_FORWARDED_FOR = u"x-forwarded-for"_s;
     inline const QString HEADER_X_FORWARDED_HOST = u"x-forwarded-host"_s;
@@ -69,6 +82,7 @@ namespace Http
     inline const QString CONTENT_TYPE_TXT = u"text/plain; charset=UTF-8"_s;
     inline const QString CONTENT_TYPE_JS = u"application/javascript"_s;
     inline const QString CONTENT_TYPE_JSON = u"application/json"_s;
+    inline const QString CONTENT_TYPE_CBOR = u"application/cbor"_s;
     inline const QString CONTENT_TYPE_GIF = u"image/gif"_s;
     inline const QString CONTENT_TYPE_PNG = u"image/png"_s;
     inline const QString CONTENT_TYPE_FORM_ENCODED = u"application/x-www-form-urlencoded"_s;
@@ -123,6 +137,8 @@ namespace Http
         ResponseStatus status;
         HeaderMap headers;
         QByteArray content;
+        QByteArray gzipContent;  // precompressed `content`, used instead of compressing it on every request
+        std::shared_ptr<ResponseStream> stream;  // rest of the body written once `content` is sent
 
         Response(uint code = 200, const QString &text = u"OK"_s)
             : status {code, text}
@@ -83,6 +83,11 @@ public:
     virtual int memoryWorkingSetLimit() const = 0;
     virtual void setMemoryWorkingSetLimit(int size) = 0;
 
+    virtual bool isStallWatchdogEnabled() const = 0;
+    virtual void setStallWatchdogEnabled(bool value) = 0;
+    virtual int stallWatchdogThreshold() const = 0;
+    virtual void setStallWatchdogThreshold(int milliseconds) = 0;
+
     virtual void sendTestEmail() const = 0;
 
 #ifdef Q_OS_WIN
@@ -0,0 +1,240 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "base/atomicsnapshot.h"
+
+// Ring buffer of log entries that can be read from any thread without locking.
+// Each entry gets sequence number as its ID. Entries are stored in chunks that are never
+// overwritten: the slots of the last chunk are filled and published by advancing the entry
+// count, full chunks are followed by new ones and the oldest ones are released instead of
+// being reused, so readers can keep iterating the entries they've got while new ones are added.
+// Writers may be on any thread, they are serialized by a mutex which readers never take.
+template <typename T>
+class LogBuffer
+{
+    static constexpr int CHUNK_SIZE = 512;
+
+    struct Chunk
+    {
+        std::array<T, CHUNK_SIZE> entries;
+    };
+
+    struct Chunks
+    {
+        // sequence number of the first entry of the first chunk divided by `CHUNK_SIZE`
+        int firstChunk = 0;
+        QList<std::shared_ptr<Chunk>> chunks;
+
+        int endSequence() const
+        {
+            return (firstChunk + static_cast<int>(chunks.size())) * CHUNK_SIZE;
+        }
+
+        const T &entry(const int sequence) const
+        {
+            return chunks[(sequence / CHUNK_SIZE) - firstChunk]->entries[sequence % CHUNK_SIZE];
+        }
+    };
+
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = int;
+        using pointer = const T *;
+        using reference = const T &;
+
+        Iterator() = default;
+
+        reference operator*() const
+        {
+            return m_chunks->entry(m_sequence);
+        }
+
+        pointer operator->() const
+        {
+            return &m_chunks->entry(m_sequence);
+        }
+
+        Iterator &operator++()
+        {
+            ++m_sequence;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator it = *this;
+            ++m_sequence;
+            return it;
+        }
+
+        friend bool operator==(const Iterator &left, const Iterator &right)
+        {
+            return left.m_sequence == right.m_sequence;
+        }
+
+    private:
+        friend class LogBuffer;
+
+        Iterator(const Chunks *chunks, const int sequence)
+            : m_chunks {chunks}
+            , m_sequence {sequence}
+        {
+        }
+
+        const Chunks *m_chunks = nullptr;
+        int m_sequence = 0;
+    };
+
+    // Entries published at the time the view was taken, it keeps them alive while it exists
+    class View
+    {
+    public:
+        View() = default;
+
+        Iterator begin() const
+        {
+            return {m_chunks.get(), m_begin};
+        }
+
+        Iterator end() const
+        {
+            return {m_chunks.get(), m_end};
+        }
+
+        int size() const
+        {
+            return m_end - m_begin;
+        }
+
+        bool isEmpty() const
+        {
+            return m_begin == m_end;
+        }
+
+        // entries of the view have consecutive IDs starting from this one
+        int firstID() const
+        {
+            return m_begin;
+        }
+
+        const T &at(const int index) const
+        {
+            Q_ASSERT((index >= 0) && (index < size()));
+            return m_chunks->entry(m_begin + index);
+        }
+
+    private:
+        friend class LogBuffer;
+
+        View(std::shared_ptr<const Chunks> chunks, const int begin, const int end)
+            : m_chunks {std::move(chunks)}
+            , m_begin {begin}
+            , m_end {end}
+        {
+        }
+
+        std::shared_ptr<const Chunks> m_chunks;
+        int m_begin = 0;
+        int m_end = 0;
+    };
+
+    explicit LogBuffer(const int capacity)
+        : m_capacity {capacity}
+    {
+        Q_ASSERT(capacity > 0);
+    }
+
+    LogBuffer(const LogBuffer &) = delete;
+    LogBuffer &operator=(const LogBuffer &) = delete;
+
+    // Sets ID of the entry and publishes it, returns the entry as it is stored
+    T append(T entry)
+    {
+        const QMutexLocker locker {&m_writerMutex};
+
+        const int sequence = m_count.load(std::memory_order_relaxed);
+        entry.id = sequence;
+
+        auto chunks = m_chunks.load();
+        if (sequence == chunks->endSequence())
+        {
+            // the chunks are only added and released, so the readers holding the current ones aren't affected
+            auto newChunks = std::make_shared<Chunks>(*chunks);
+            newChunks->chunks.append(std::make_shared<Chunk>());
+            while (((newChunks->firstChunk + 1) * CHUNK_SIZE) <= (sequence + 1 - m_capacity))
+            {
+                newChunks->chunks.removeFirst();
+                ++newChunks->firstChunk;
+            }
+            chunks = newChunks;
+            m_chunks.store(std::move(newChunks));
+        }
+
+        // the slot isn't visible to readers until the count is advanced
+        chunks->chunks.last()->entries[sequence % CHUNK_SIZE] = entry;
+        m_count.store((sequence + 1), std::memory_order_release);
+
+        return entry;
+    }
+
+    // Returns the most recent entries with ID greater than `lastKnownID`, all the kept entries if it is -1
+    View view(const int lastKnownID = -1) const
+    {
+        auto chunks = m_chunks.load();
+        const int count = m_count.load(std::memory_order_acquire);
+
+        // entries stored in the chunks published after these ones were loaded aren't included
+        const int end = std::min(count, chunks->endSequence());
+        const int oldest = std::min(std::max((count - m_capacity), (chunks->firstChunk * CHUNK_SIZE)), end);
+        const int begin = std::clamp((lastKnownID + 1), oldest, end);
+        return {std::move(chunks), begin, end};
+    }
+
+private:
+    const int m_capacity;
+    QMutex m_writerMutex;
+    AtomicSnapshot<Chunks> m_chunks;
+    std::atomic<int> m_count {0};
+};
@@ -28,21 +28,23 @@
 
 #include "logger.h"
 
-#include <algorithm>
+#include <chrono>
+#include <utility>
 
 #include <QDateTime>
-#include <QVector>
+#include <QList>
+#include <QMetaObject>
+#include <QTimer>
+
+#include "base/global.h"
+#include "base/memoryusage.h"
+
+using namespace std::chrono_literals;
 
 namespace
 {
-    template <typename T>
-    QVector<T> loadFromBuffer(const boost::circular_buffer_space_optimized<T> &src, const int offset = 0)
-    {
-        QVector<T> ret;
-        ret.reserve(static_cast<typename decltype(ret)::size_type>(src.size()) - offset);
-        std::copy((src.begin() + offset), src.end(), std::back_inserter(ret));
-        return ret;
-    }
+    const std::chrono::milliseconds THROTTLE_WINDOW = 30s;
+    const std::chrono::milliseconds THROTTLE_CHECK_INTERVAL = 5s;
 }
 
 Logger *Logger::m_instance = nullptr;
@@ -50,7 +52,27 @@ Logger *Logger::m_instance = nullptr;
 Logger::Logger()
     : m_messages(MAX_LOG_MESSAGES)
     , m_peers(MAX_LOG_MESSAGES)
+    , m_throttleTimer {new QTimer(this)}
 {
+    m_throttleClock.start();
+    m_throttleTimer->setInterval(THROTTLE_CHECK_INTERVAL);
+    connect(m_throttleTimer, &QTimer::timeout, this, &Logger::flushThrottledEntries);
+
+    MemoryUsage::registerEstimator(this, [this]() -> QList<MemoryUsage::Entry>
+    {
+        const MessagesView messagesView = messages();
+        qint64 messagesSize = messagesView.size() * sizeof(Log::Msg);
+        for (const Log::Msg &msg : messagesView)
+            messagesSize += msg.message.capacity() * sizeof(QChar);
+
+        const PeersView peersView = peers();
+        qint64 peersSize = peersView.size() * sizeof(Log::Peer);
+        for (const Log::Peer &peer : peersView)
+            peersSize += (peer.ip.capacity() + peer.reason.capacity()) * sizeof(QChar);
+
+        return {{u"log.messages"_s, messagesView.size(), messagesSize}
+            , {u"log.peers"_s, peersView.size(), peersSize}};
+    });
 }
 
 Logger *Logger::instance()
@@ -72,57 +94,134 @@ void Logger::freeInstance()
 
 void Logger::addMessage(const QString &message, const Log::MsgType &type)
 {
-    QWriteLocker locker(&m_lock);
-    const Log::Msg msg = {m_msgCounter++, type, QDateTime::currentSecsSinceEpoch(), message};
-    m_messages.push_back(msg);
-    locker.unlock();
-
+    const Log::Msg msg = m_messages.append({.type = type, .timestamp = QDateTime::currentSecsSinceEpoch(), .message = message});
     emit newLogMessage(msg);
 }
 
 void Logger::addPeer(const QString &ip, const bool blocked, const QString &reason)
 {
-    QWriteLocker locker(&m_lock);
-    const Log::Peer msg = {m_peerCounter++, blocked, QDateTime::currentSecsSinceEpoch(), ip, reason};
-    m_peers.push_back(msg);
-    locker.unlock();
-
-    emit newLogPeer(msg);
+    const Log::Peer peer = m_peers.append({.blocked = blocked, .timestamp = QDateTime::currentSecsSinceEpoch(), .ip = ip, .reason = reason});
+    emit newLogPeer(peer);
 }
 
-QVector<Log::Msg> Logger::getMessages(const int lastKnownId) const
+void Logger::addThrottledMessage(const QString &category, const QString &key, const std::function<QString ()> &formatter
+        , const Log::MsgType &type)
 {
-    const QReadLocker locker(&m_lock);
-
-    const int diff = m_msgCounter - lastKnownId - 1;
-    const int size = static_cast<int>(m_messages.size());
+    const bool isLogged = throttle((category + u'\n' + key), [this, formatter, type](const int repeatCount)
+    {
+        addMessage(u"%1 (×%2)"_s.arg(formatter(), QString::number(repeatCount)), type);
+    });
+    if (isLogged)
+        addMessage(formatter(), type);
+}
 
-    if ((lastKnownId == -1) || (diff >= size))
-        return loadFromBuffer(m_messages);
+void Logger::addThrottledPeer(const QString &ip, const bool blocked, const QString &key, const std::function<QString ()> &reasonFormatter)
+{
+    const bool isLogged = throttle((u"Peer\n" + ip + u'\n' + key), [this, ip, blocked, reasonFormatter](const int repeatCount)
+    {
+        const QString reason = reasonFormatter();
+        addPeer(ip, blocked, (reason.isEmpty()
+                ? u"×%1"_s.arg(QString::number(repeatCount))
+                : u"%1 (×%2)"_s.arg(reason, QString::number(repeatCount))));
+    });
+    if (isLogged)
+        addPeer(ip, blocked, reasonFormatter());
+}
 
-    if (diff <= 0)
-        return {};
+bool Logger::throttle(const QString &key, std::function<void (int repeatCount)> logRepeats)
+{
+    std::function<void (int repeatCount)> expiredLogRepeats;
+    int expiredRepeatCount = 0;
+    {
+        const QMutexLocker locker {&m_throttleMutex};
+
+        const qint64 now = m_throttleClock.elapsed();
+        auto it = m_throttledEntries.find(key);
+        if (it == m_throttledEntries.end())
+        {
+            it = m_throttledEntries.insert(key, {});
+        }
+        else if (it->windowEnd > now)
+        {
+            ++it->repeatCount;
+            it->logRepeats = std::move(logRepeats);
+            return false;
+        }
+        else if (it->repeatCount > 0)
+        {
+            // the repeats of the ended window weren't flushed yet
+            expiredRepeatCount = std::exchange(it->repeatCount, 0);
+            expiredLogRepeats = std::exchange(it->logRepeats, {});
+        }
+
+        it->windowEnd = now + THROTTLE_WINDOW.count();
+
+        // entries can be added from any thread, the timer lives in the thread of the logger
+        if (!m_isThrottleTimerActive)
+        {
+            m_isThrottleTimerActive = true;
+            QMetaObject::invokeMethod(m_throttleTimer, [timer = m_throttleTimer] { timer->start(); }, Qt::QueuedConnection);
+        }
+    }
 
-    return loadFromBuffer(m_messages, (size - diff));
+    if (expiredLogRepeats)
+        expiredLogRepeats(expiredRepeatCount);
+    return true;
 }
 
-QVector<Log::Peer> Logger::getPeers(const int lastKnownId) const
+void Logger::flushThrottledEntries()
 {
-    const QReadLocker locker(&m_lock);
-
-    const int diff = m_peerCounter - lastKnownId - 1;
-    const int size = static_cast<int>(m_peers.size());
+    QList<std::pair<std::function<void (int repeatCount)>, int>> repeats;
+    {
+        const QMutexLocker locker {&m_throttleMutex};
+
+        const qint64 now = m_throttleClock.elapsed();
+        for (auto it = m_throttledEntries.begin(); it != m_throttledEntries.end();)
+        {
+            if (it->windowEnd > now)
+            {
+                ++it;
+            }
+            else if (it->repeatCount > 0)
+            {
+                // logged repeats start a new window, so the ongoing flood is collapsed again
+                repeats.emplaceBack(std::exchange(it->logRepeats, {}), std::exchange(it->repeatCount, 0));
+                it->windowEnd = now + THROTTLE_WINDOW.count();
+                ++it;
+            }
+            else
+            {
+                it = m_throttledEntries.erase(it);
+            }
+        }
+
+        if (m_throttledEntries.isEmpty())
+        {
+            m_isThrottleTimerActive = false;
+            m_throttleTimer->stop();
+        }
+    }
 
-    if ((lastKnownId == -1) || (diff >= size))
-        return loadFromBuffer(m_peers);
+    for (const auto &[logRepeats, repeatCount] : asConst(repeats))
+        logRepeats(repeatCount);
+}
 
-    if (diff <= 0)
-        return {};
+Logger::MessagesView Logger::messages(const int lastKnownId) const
+{
+    return m_messages.view(lastKnownId);
+}
 
-    return loadFromBuffer(m_peers, (size - diff));
+Logger::PeersView Logger::peers(const int lastKnownId) const
+{
+    return m_peers.view(lastKnownId);
 }
 
 void LogMsg(const QString &message, const Log::MsgType &type)
 {
     Logger::instance()->addMessage(message, type);
 }
+
+void LogThrottledMsg(const QString &category, const QString &key, const std::function<QString ()> &formatter, const Log::MsgType &type)
+{
+    Logger::instance()->addThrottledMessage(category, key, formatter, type);
+}
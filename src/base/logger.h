@@ -28,12 +28,17 @@
 
 #pragma once
 
-#include <boost/circular_buffer.hpp>
+#include <functional>
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
-#include <QReadWriteLock>
 #include <QString>
-#include <QtContainerFwd>
+
+#include "base/logbuffer.h"
+
+class QTimer;
 
 inline const int MAX_LOG_MESSAGES = 20000;
 
@@ -81,24 +86,56 @@ public:
 
     void addMessage(const QString &message, const Log::MsgType &type = Log::NORMAL);
     void addPeer(const QString &ip, bool blocked, const QString &reason = {});
-    QVector<Log::Msg> getMessages(int lastKnownId = -1) const;
-    QVector<Log::Peer> getPeers(int lastKnownId = -1) const;
+
+    // Messages of the same `category` and `key` are logged once per throttling window, the repeats
+    // are counted and logged as a single "×N" entry when the window ends. `formatter` is called only
+    // for the messages which are actually logged, so the dropped ones cost no string assembly.
+    void addThrottledMessage(const QString &category, const QString &key, const std::function<QString ()> &formatter
+            , const Log::MsgType &type = Log::NORMAL);
+    // Peers are throttled by their IP and `key` of the reason
+    void addThrottledPeer(const QString &ip, bool blocked, const QString &key, const std::function<QString ()> &reasonFormatter);
+
+    using MessagesView = LogBuffer<Log::Msg>::View;
+    using PeersView = LogBuffer<Log::Peer>::View;
+
+    // The views can be used from any thread and don't block adding of new entries,
+    // they only contain the entries with id greater than `lastKnownId`
+    MessagesView messages(int lastKnownId = -1) const;
+    PeersView peers(int lastKnownId = -1) const;
 
 signals:
     void newLogMessage(const Log::Msg &message);
     void newLogPeer(const Log::Peer &peer);
 
 private:
+    struct ThrottledEntry
+    {
+        qint64 windowEnd = 0;
+        int repeatCount = 0;
+        // logs the last repeat along with the number of repeats
+        std::function<void (int repeatCount)> logRepeats;
+    };
+
     Logger();
     ~Logger() = default;
 
+    // returns false if the entry is a repeat which shouldn't be logged now
+    bool throttle(const QString &key, std::function<void (int repeatCount)> logRepeats);
+    void flushThrottledEntries();
+
     static Logger *m_instance;
-    boost::circular_buffer_space_optimized<Log::Msg> m_messages;
-    boost::circular_buffer_space_optimized<Log::Peer> m_peers;
-    mutable QReadWriteLock m_lock;
-    int m_msgCounter = 0;
-    int m_peerCounter = 0;
+    LogBuffer<Log::Msg> m_messages;
+    LogBuffer<Log::Peer> m_peers;
+
+    QMutex m_throttleMutex;
+    QHash<QString, ThrottledEntry> m_throttledEntries;
+    QElapsedTimer m_throttleClock;
+    QTimer *m_throttleTimer = nullptr;
+    bool m_isThrottleTimerActive = false;
 };
 
 // Helper function
 void LogMsg(const QString &message, const Log::MsgType &type = Log::NORMAL);
+// Helper function, see `Logger::addThrottledMessage()`
+void LogThrottledMsg(const QString &category, const QString &key, const std::function<QString ()> &formatter
+        , const Log::MsgType &type = Log::NORMAL);
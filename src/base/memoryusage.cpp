@@ -0,0 +1,143 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "memoryusage.h"
+
+#include <algorithm>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QVariant>
+
+#include "base/global.h"
+
+namespace
+{
+    QMutex estimatorsMutex;
+    QHash<const QObject *, MemoryUsage::Estimator> estimators;
+}
+
+void MemoryUsage::registerEstimator(const QObject *owner, Estimator estimator)
+{
+    Q_ASSERT(owner);
+
+    {
+        const QMutexLocker locker {&estimatorsMutex};
+        estimators.insert(owner, std::move(estimator));
+    }
+
+    QObject::connect(owner, &QObject::destroyed, [owner]
+    {
+        const QMutexLocker locker {&estimatorsMutex};
+        estimators.remove(owner);
+    });
+}
+
+QList<MemoryUsage::Entry> MemoryUsage::report()
+{
+    QList<Estimator> currentEstimators;
+    {
+        // estimators are called unlocked, so they may take their own locks
+        const QMutexLocker locker {&estimatorsMutex};
+        currentEstimators = estimators.values();
+    }
+
+    QMap<QString, Entry> entries;
+    for (const Estimator &estimator : asConst(currentEstimators))
+    {
+        for (const Entry &entry : estimator())
+        {
+            Entry &total = entries[entry.name];
+            total.name = entry.name;
+            total.count += entry.count;
+            total.bytes += entry.bytes;
+        }
+    }
+
+    return entries.values();
+}
+
+qint64 MemoryUsage::sizeOf(const QString &str)
+{
+    return sizeof(QString) + (str.capacity() * sizeof(QChar));
+}
+
+qint64 MemoryUsage::sizeOf(const QByteArray &data)
+{
+    return sizeof(QByteArray) + data.capacity();
+}
+
+qint64 MemoryUsage::sizeOf(const QVariant &value)
+{
+    switch (value.typeId())
+    {
+    case QMetaType::QString:
+        // small values are stored within the variant itself, only the payload of the string is allocated
+        return sizeof(QVariant) + (value.toString().capacity() * sizeof(QChar));
+    case QMetaType::QByteArray:
+        return sizeof(QVariant) + value.toByteArray().capacity();
+    case QMetaType::QStringList:
+        {
+            const QStringList list = value.toStringList();
+            qint64 size = sizeof(QVariant) + ((list.capacity() - list.size()) * sizeof(QString));
+            for (const QString &str : list)
+                size += sizeOf(str);
+            return size;
+        }
+    case QMetaType::QVariantList:
+        {
+            const QVariantList list = value.toList();
+            qint64 size = sizeof(QVariant) + ((list.capacity() - list.size()) * sizeof(QVariant));
+            for (const QVariant &item : list)
+                size += sizeOf(item);
+            return size;
+        }
+    case QMetaType::QVariantMap:
+        {
+            const QVariantMap map = value.toMap();
+            qint64 size = sizeof(QVariant);
+            for (auto it = map.cbegin(); it != map.cend(); ++it)
+                size += sizeOf(it.key()) + sizeOf(it.value());
+            return size;
+        }
+    case QMetaType::QVariantHash:
+        {
+            const QVariantHash hash = value.toHash();
+            qint64 size = sizeof(QVariant);
+            for (auto it = hash.cbegin(); it != hash.cend(); ++it)
+                size += sizeOf(it.key()) + sizeOf(it.value());
+            return size;
+        }
+    default:
+        return sizeof(QVariant);
+    }
+}
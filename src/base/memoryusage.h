@@ -0,0 +1,64 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <QList>
+#include <QString>
+#include <QtTypes>
+
+class QByteArray;
+class QObject;
+class QVariant;
+
+// Estimates of the memory used by the major data structures, so the subsystem responsible
+// for a growth of the process memory can be found in production. The estimates are approximate:
+// they take into account the payload of the containers but not the allocator overhead.
+namespace MemoryUsage
+{
+    struct Entry
+    {
+        QString name;  // e.g. "torrents.files"
+        qint64 count = 0;  // number of items
+        qint64 bytes = 0;
+    };
+
+    using Estimator = std::function<QList<Entry> ()>;
+
+    // The estimator is called from the thread the report is requested in, i.e. the main thread,
+    // on every request. It is unregistered once the owner is destroyed.
+    void registerEstimator(const QObject *owner, Estimator estimator);
+    // Entries of the same name estimated by different owners are summed up, sorted by name
+    QList<Entry> report();
+
+    qint64 sizeOf(const QString &str);
+    qint64 sizeOf(const QByteArray &data);
+    qint64 sizeOf(const QVariant &value);
+}
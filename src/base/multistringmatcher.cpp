@@ -0,0 +1,142 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "multistringmatcher.h"
+
+#include <algorithm>
+#include <queue>
+
+MultiStringMatcher::MultiStringMatcher(const QStringList &patterns, const Qt::CaseSensitivity caseSensitivity)
+    : m_nodes(1)
+    , m_patternCount {patterns.size()}
+    , m_caseSensitivity {caseSensitivity}
+{
+    for (qsizetype i = 0; i < patterns.size(); ++i)
+    {
+        const QString pattern = (caseSensitivity == Qt::CaseInsensitive) ? patterns[i].toCaseFolded() : patterns[i];
+        if (pattern.isEmpty())
+            continue;
+
+        qsizetype node = 0;
+        for (const QChar c : pattern)
+            node = addChild(node, c.unicode());
+        m_nodes[node].patterns.push_back(i);
+    }
+
+    buildLinks();
+}
+
+qsizetype MultiStringMatcher::patternCount() const
+{
+    return m_patternCount;
+}
+
+QList<qsizetype> MultiStringMatcher::matchedPatterns(const QString &text) const
+{
+    QList<qsizetype> result;
+    if (m_nodes.size() == 1)
+        return result;
+
+    const QString str = (m_caseSensitivity == Qt::CaseInsensitive) ? text.toCaseFolded() : text;
+    std::vector<bool> reportedNodes(m_nodes.size(), false);
+    qsizetype node = 0;
+    for (const QChar c : str)
+    {
+        qsizetype next = child(node, c.unicode());
+        while ((next < 0) && (node != 0))
+        {
+            node = m_nodes[node].failure;
+            next = child(node, c.unicode());
+        }
+        node = std::max<qsizetype>(next, 0);
+
+        for (qsizetype out = m_nodes[node].output; (out >= 0) && !reportedNodes[out]; out = m_nodes[m_nodes[out].failure].output)
+        {
+            reportedNodes[out] = true;
+            for (const qsizetype pattern : m_nodes[out].patterns)
+                result.append(pattern);
+        }
+    }
+
+    return result;
+}
+
+qsizetype MultiStringMatcher::child(const qsizetype node, const char16_t c) const
+{
+    const auto &children = m_nodes[node].children;
+    const auto it = std::lower_bound(children.cbegin(), children.cend(), c
+            , [](const std::pair<char16_t, qsizetype> &child, const char16_t value) { return child.first < value; });
+    return ((it != children.cend()) && (it->first == c)) ? it->second : -1;
+}
+
+qsizetype MultiStringMatcher::addChild(const qsizetype node, const char16_t c)
+{
+    if (const qsizetype existing = child(node, c); existing >= 0)
+        return existing;
+
+    const auto newNode = static_cast<qsizetype>(m_nodes.size());
+    m_nodes.emplace_back();
+    auto &children = m_nodes[node].children;
+    const auto it = std::lower_bound(children.cbegin(), children.cend(), c
+            , [](const std::pair<char16_t, qsizetype> &child, const char16_t value) { return child.first < value; });
+    children.emplace(it, c, newNode);
+    return newNode;
+}
+
+void MultiStringMatcher::buildLinks()
+{
+    // Breadth-first traversal, so failure node (which is shallower) is always processed first
+    std::queue<qsizetype> queue;
+    queue.push(0);
+    while (!queue.empty())
+    {
+        const qsizetype node = queue.front();
+        queue.pop();
+
+        for (const auto &[c, childNode] : m_nodes[node].children)
+        {
+            qsizetype failure = 0;
+            if (node != 0)
+            {
+                qsizetype candidate = m_nodes[node].failure;
+                failure = child(candidate, c);
+                while ((failure < 0) && (candidate != 0))
+                {
+                    candidate = m_nodes[candidate].failure;
+                    failure = child(candidate, c);
+                }
+                failure = std::max<qsizetype>(failure, 0);
+            }
+
+            Node &nodeData = m_nodes[childNode];
+            nodeData.failure = failure;
+            nodeData.output = nodeData.patterns.empty() ? m_nodes[failure].output : childNode;
+            queue.push(childNode);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QtTypes>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Finds which of the (possibly many) patterns occur in the text in a single pass
+// over it, using Aho-Corasick automaton built from the patterns.
+class MultiStringMatcher
+{
+public:
+    // Empty patterns are never matched
+    explicit MultiStringMatcher(const QStringList &patterns = {}, Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
+
+    qsizetype patternCount() const;
+
+    // Returns indexes of the patterns occurring in the text, each one is reported once
+    QList<qsizetype> matchedPatterns(const QString &text) const;
+
+private:
+    struct Node
+    {
+        std::vector<std::pair<char16_t, qsizetype>> children; // sorted by character
+        std::vector<qsizetype> patterns;
+        qsizetype failure = 0;
+        // nearest node ending some pattern on the failure chain (including this one)
+        qsizetype output = -1;
+    };
+
+    qsizetype child(qsizetype node, char16_t c) const;
+    qsizetype addChild(qsizetype node, char16_t c);
+    void buildLinks();
+
+    std::vector<Node> m_nodes;
+    qsizetype m_patternCount = 0;
+    Qt::CaseSensitivity m_caseSensitivity = Qt::CaseSensitive;
+};
@@ -29,18 +29,21 @@
 
 #include "downloadhandlerimpl.h"
 
+#include <algorithm>
+
 #include <QtSystemDetection>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QTemporaryFile>
 #include <QUrl>
 
 #include "base/3rdparty/expected.hpp"
+#include "base/global.h"
 #include "base/utils/fs.h"
+#include "base/utils/gzip.h"
 #include "base/utils/io.h"
 #include "base/utils/misc.h"
 
-#ifdef QT_NO_COMPRESS
-#include "base/utils/gzip.h"
-#endif
-
 #if defined(Q_OS_MACOS) || defined(Q_OS_WIN)
 #include "base/preferences.h"
 #include "base/utils/os.h"
@@ -48,6 +51,27 @@
 
 const int MAX_REDIRECTIONS = 20;  // the common value for web browsers
 
+namespace
+{
+    // "Retry-After" value is either delay in seconds or HTTP date
+    std::chrono::seconds parseRetryAfter(const QByteArray &value)
+    {
+        if (value.isEmpty())
+            return std::chrono::seconds(0);
+
+        bool ok = false;
+        const qint64 delay = value.trimmed().toLongLong(&ok);
+        if (ok)
+            return std::chrono::seconds(std::max<qint64>(0, delay));
+
+        const QDateTime retryTime = QDateTime::fromString(QString::fromLatin1(value.trimmed()), Qt::RFC2822Date);
+        if (!retryTime.isValid())
+            return std::chrono::seconds(0);
+
+        return std::chrono::seconds(std::max<qint64>(0, QDateTime::currentDateTimeUtc().secsTo(retryTime)));
+    }
+}
+
 Net::DownloadHandlerImpl::DownloadHandlerImpl(DownloadManager *manager
         , const DownloadRequest &downloadRequest, const bool useProxy)
     : DownloadHandler {manager}
@@ -57,8 +81,13 @@ Net::DownloadHandlerImpl::DownloadHandlerImpl(DownloadManager *manager
 {
     m_result.url = url();
     m_result.status = DownloadStatus::Success;
+
+    if (m_downloadRequest.decompressGzip())
+        m_decompressor = std::make_unique<Utils::Gzip::Decompressor>();
 }
 
+Net::DownloadHandlerImpl::~DownloadHandlerImpl() = default;
+
 void Net::DownloadHandlerImpl::cancel()
 {
     if (m_isFinished)
@@ -89,6 +118,8 @@ void Net::DownloadHandlerImpl::assignNetworkReply(QNetworkReply *reply)
     m_reply->setParent(this);
     if (m_downloadRequest.limit() > 0)
         connect(m_reply, &QNetworkReply::downloadProgress, this, &DownloadHandlerImpl::checkDownloadSize);
+    if (isProcessingIncrementally())
+        connect(m_reply, &QNetworkReply::readyRead, this, &DownloadHandlerImpl::processReceivedData);
     connect(m_reply, &QNetworkReply::finished, this, &DownloadHandlerImpl::processFinishedDownload);
 }
 
@@ -117,12 +148,21 @@ void Net::DownloadHandlerImpl::processFinishedDownload()
 {
     qDebug("Download finished: %s", qUtf8Printable(url()));
 
+    // Processing of received data has failed, so the reply was aborted
+    if (!m_sinkError.isEmpty())
+    {
+        setError(m_sinkError);
+        finish();
+        return;
+    }
+
     // Check if the request was successful
     if (m_reply->error() != QNetworkReply::NoError)
     {
         // Failure
         qDebug("Download failure (%s), reason: %s", qUtf8Printable(url()), qUtf8Printable(errorCodeToString(m_reply->error())));
         setError(errorCodeToString(m_reply->error()));
+        m_result.retryAfter = parseRetryAfter(m_reply->rawHeader("Retry-After"));
         finish();
         return;
     }
@@ -135,14 +175,49 @@ void Net::DownloadHandlerImpl::processFinishedDownload()
         return;
     }
 
+    const int httpStatusCode = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatusCode == 304)
+    {
+        m_result.status = DownloadStatus::NotModified;
+        m_result.eTag = m_downloadRequest.eTag();
+        m_result.lastModified = m_downloadRequest.lastModified();
+        finish();
+        return;
+    }
+
     // Success
+    m_result.eTag = QString::fromLatin1(m_reply->rawHeader("ETag"));
+    m_result.lastModified = QString::fromLatin1(m_reply->rawHeader("Last-Modified"));
+
+    if (isProcessingIncrementally())
+    {
+        if (!completeReceivedData())
+        {
+            setError(m_sinkError);
+            finish();
+            return;
+        }
+
+        if (isStreamingToFile())
+        {
+#if defined(Q_OS_MACOS) || defined(Q_OS_WIN)
+            if (Preferences::instance()->isMarkOfTheWebEnabled())
+                Utils::OS::applyMarkOfTheWeb(m_result.filePath, m_result.url);
+#endif // Q_OS_MACOS || Q_OS_WIN
+            finish();
+            return;
+        }
+    }
+    else
+    {
 #ifdef QT_NO_COMPRESS
-    m_result.data = (m_reply->rawHeader("Content-Encoding") == "gzip")
-                    ? Utils::Gzip::decompress(m_reply->readAll())
-                    : m_reply->readAll();
+        m_result.data = (m_reply->rawHeader("Content-Encoding") == "gzip")
+                        ? Utils::Gzip::decompress(m_reply->readAll())
+                        : m_reply->readAll();
 #else
-    m_result.data = m_reply->readAll();
+        m_result.data = m_reply->readAll();
 #endif
+    }
 
     if (m_downloadRequest.saveToFile())
     {
@@ -186,6 +261,152 @@ void Net::DownloadHandlerImpl::processFinishedDownload()
     finish();
 }
 
+bool Net::DownloadHandlerImpl::isProcessingIncrementally() const
+{
+    return isStreamingToFile() || m_decompressor;
+}
+
+bool Net::DownloadHandlerImpl::isStreamingToFile() const
+{
+    return m_downloadRequest.saveToFile() && m_downloadRequest.streamToFile();
+}
+
+void Net::DownloadHandlerImpl::processReceivedData()
+{
+    if (!m_sinkError.isEmpty())
+        return;
+
+    // Only the content of successful reply is processed,
+    // redirections and errors are handled once the reply is finished
+    const int httpStatusCode = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if ((httpStatusCode >= 300) || ((httpStatusCode > 0) && (httpStatusCode < 200)))
+        return;
+
+    QByteArray data = m_reply->readAll();
+    if (data.isEmpty())
+        return;
+
+#ifdef QT_NO_COMPRESS
+    if (m_reply->rawHeader("Content-Encoding") == "gzip")
+    {
+        if (!m_contentDecoder)
+            m_contentDecoder = std::make_unique<Utils::Gzip::Decompressor>();
+
+        QByteArray decodedData;
+        if (!m_contentDecoder->decompress(data, decodedData))
+        {
+            abortWithError(tr("Could not decompress received data"));
+            return;
+        }
+        data = std::move(decodedData);
+    }
+#endif
+
+    if (m_decompressor)
+    {
+        QByteArray decompressedData;
+        if (!m_decompressor->decompress(data, decompressedData))
+        {
+            abortWithError(tr("Could not decompress received data"));
+            return;
+        }
+        data = std::move(decompressedData);
+    }
+
+    if (!isStreamingToFile())
+    {
+        m_result.data.append(data);
+        return;
+    }
+
+    if (!m_sinkFile && !openSinkFile())
+        return;
+
+    if (m_sinkFile->write(data) != data.size())
+        abortWithError(tr("I/O Error: %1").arg(m_sinkFile->errorString()));
+}
+
+// Processes the rest of the data once the reply is finished
+bool Net::DownloadHandlerImpl::completeReceivedData()
+{
+    processReceivedData();
+    if (!m_sinkError.isEmpty())
+        return false;
+
+    if (m_decompressor && !m_decompressor->isFinished())
+    {
+        m_sinkError = tr("Could not decompress received data");
+        return false;
+    }
+
+    if (!isStreamingToFile())
+        return true;
+
+    // the file is created even if there was no data received
+    if (!m_sinkFile && !openSinkFile())
+        return false;
+
+    if (auto *saveFile = qobject_cast<QSaveFile *>(m_sinkFile.get()))
+    {
+        if (!saveFile->commit())
+        {
+            m_sinkError = tr("I/O Error: %1").arg(saveFile->errorString());
+            return false;
+        }
+    }
+    else
+    {
+        if (!m_sinkFile->flush())
+        {
+            m_sinkError = tr("I/O Error: %1").arg(m_sinkFile->errorString());
+            return false;
+        }
+        static_cast<QTemporaryFile *>(m_sinkFile.get())->setAutoRemove(false);
+        m_sinkFile->close();
+    }
+
+    m_result.filePath = Path(m_sinkFile->fileName());
+    return true;
+}
+
+bool Net::DownloadHandlerImpl::openSinkFile()
+{
+    const Path destinationPath = m_downloadRequest.destFileName();
+    if (destinationPath.isEmpty())
+    {
+        auto tempFile = std::make_unique<QTemporaryFile>((Utils::Fs::tempPath() / Path(u"file_"_s)).data());
+        if (!tempFile->open())
+        {
+            abortWithError(tr("I/O Error: %1").arg(tempFile->errorString()));
+            return false;
+        }
+        m_sinkFile = std::move(tempFile);
+    }
+    else
+    {
+        if (const Path parentPath = destinationPath.parentPath(); !parentPath.isEmpty())
+            Utils::Fs::mkpath(parentPath);
+
+        // the file is only replaced once the whole content is received
+        auto saveFile = std::make_unique<QSaveFile>(destinationPath.data());
+        if (!saveFile->open(QIODevice::WriteOnly))
+        {
+            abortWithError(tr("I/O Error: %1").arg(saveFile->errorString()));
+            return false;
+        }
+        m_sinkFile = std::move(saveFile);
+    }
+
+    return true;
+}
+
+void Net::DownloadHandlerImpl::abortWithError(const QString &error)
+{
+    m_sinkError = error;
+    if (m_reply->isRunning())
+        m_reply->abort();
+}
+
 void Net::DownloadHandlerImpl::checkDownloadSize(const qint64 bytesReceived, const qint64 bytesTotal)
 {
     if ((bytesTotal > 0) && (bytesTotal <= m_downloadRequest.limit()))
@@ -29,13 +29,21 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QNetworkReply>
 
 #include "base/net/downloadmanager.h"
 
+class QFileDevice;
 class QObject;
 class QUrl;
 
+namespace Utils::Gzip
+{
+    class Decompressor;
+}
+
 namespace Net
 {
     class DownloadHandlerImpl final : public DownloadHandler
@@ -45,6 +53,7 @@ namespace Net
 
     public:
         DownloadHandlerImpl(DownloadManager *manager, const DownloadRequest &downloadRequest, bool useProxy);
+        ~DownloadHandlerImpl() override;
 
         void cancel() override;
 
@@ -57,6 +66,12 @@ namespace Net
 
     private:
         void processFinishedDownload();
+        void processReceivedData();
+        bool completeReceivedData();
+        bool openSinkFile();
+        bool isProcessingIncrementally() const;
+        bool isStreamingToFile() const;
+        void abortWithError(const QString &error);
         void checkDownloadSize(qint64 bytesReceived, qint64 bytesTotal);
         void handleRedirection(const QUrl &newUrl);
         void setError(const QString &error);
@@ -72,5 +87,13 @@ namespace Net
         short m_redirectionCount = 0;
         DownloadResult m_result;
         bool m_isFinished = false;
+
+        // used when the data is processed while it is received
+        std::unique_ptr<QFileDevice> m_sinkFile;
+        std::unique_ptr<Utils::Gzip::Decompressor> m_decompressor;
+#ifdef QT_NO_COMPRESS
+        std::unique_ptr<Utils::Gzip::Decompressor> m_contentDecoder;
+#endif
+        QString m_sinkError;
     };
 }
@@ -35,6 +35,7 @@
 #include <QByteArray>
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
 #include <QNetworkCookie>
 #include <QNetworkCookieJar>
@@ -55,6 +56,9 @@ using namespace std::chrono_literals;
 
 namespace
 {
+    // weight of the latest reply in average latency
+    const int LATENCY_SMOOTHING = 8;
+
     // Disguise as browser to circumvent website blocking
     QByteArray getBrowserUserAgent()
     {
@@ -167,7 +171,9 @@ Net::DownloadManager::DownloadManager(QObject *parent)
     connect(ProxyConfigurationManager::instance(), &ProxyConfigurationManager::proxyConfigurationChanged
             , this, &DownloadManager::applyProxySettings);
     connect(Preferences::instance(), &Preferences::changed, this, &DownloadManager::applyProxySettings);
+    connect(Preferences::instance(), &Preferences::changed, this, &DownloadManager::loadConnectionsPerHost);
     applyProxySettings();
+    loadConnectionsPerHost();
 }
 
 void Net::DownloadManager::initInstance()
@@ -191,31 +197,30 @@ Net::DownloadHandler *Net::DownloadManager::download(const DownloadRequest &down
 {
     // Process download request
     const auto serviceID = ServiceID::fromURL(downloadRequest.url());
-    const bool isSequentialService = m_sequentialServices.contains(serviceID);
+    const auto priority = static_cast<std::size_t>(downloadRequest.priority());
 
     auto *downloadHandler = new DownloadHandlerImpl(this, downloadRequest, useProxy);
-    connect(downloadHandler, &DownloadHandler::finished, this, [this, serviceID, downloadHandler]
+    connect(downloadHandler, &DownloadHandler::finished, this, [this, serviceID, priority, downloadHandler]
     {
         if (!downloadHandler->assignedNetworkReply())
         {
             // DownloadHandler was finished (canceled) before QNetworkReply was assigned,
             // so it's still in the queue. Just remove it from there.
-            m_waitingJobs[serviceID].removeOne(downloadHandler);
+            m_services[serviceID].waitingJobs[priority].removeOne(downloadHandler);
         }
 
         downloadHandler->deleteLater();
     });
 
-    if (isSequentialService && m_busyServices.contains(serviceID))
+    Service &service = m_services[serviceID];
+    if (service.activeJobs >= maxActiveJobs(serviceID))
     {
-        m_waitingJobs[serviceID].enqueue(downloadHandler);
+        service.waitingJobs[priority].enqueue(downloadHandler);
     }
     else
     {
         qDebug("Downloading %s...", qUtf8Printable(downloadRequest.url()));
-        if (isSequentialService)
-            m_busyServices.insert(serviceID);
-        processRequest(downloadHandler);
+        processRequest(serviceID, downloadHandler);
     }
 
     return downloadHandler;
@@ -226,6 +231,23 @@ void Net::DownloadManager::registerSequentialService(const Net::ServiceID &servi
     m_sequentialServices.insert(serviceID, delay);
 }
 
+QHash<Net::ServiceID, Net::ServiceStatistics> Net::DownloadManager::serviceStatistics() const
+{
+    QHash<ServiceID, ServiceStatistics> statistics;
+    statistics.reserve(m_services.size());
+    for (auto it = m_services.cbegin(); it != m_services.cend(); ++it)
+    {
+        const Service &service = it.value();
+        ServiceStatistics serviceStatistics = service.statistics;
+        serviceStatistics.activeRequests = service.activeJobs;
+        for (const QQueue<DownloadHandlerImpl *> &jobs : service.waitingJobs)
+            serviceStatistics.waitingRequests += jobs.size();
+        statistics.insert(it.key(), serviceStatistics);
+    }
+
+    return statistics;
+}
+
 QList<QNetworkCookie> Net::DownloadManager::cookiesForUrl(const QUrl &url) const
 {
     return m_networkCookieJar->cookiesForUrl(url);
@@ -299,24 +321,53 @@ void Net::DownloadManager::applyProxySettings()
         m_proxy.setCapabilities(m_proxy.capabilities() & ~QNetworkProxy::HostNameLookupCapability);
 }
 
-void Net::DownloadManager::processWaitingJobs(const ServiceID &serviceID)
+void Net::DownloadManager::loadConnectionsPerHost()
 {
-    const auto waitingJobsIter = m_waitingJobs.find(serviceID);
-    if ((waitingJobsIter == m_waitingJobs.end()) || waitingJobsIter.value().isEmpty())
-    {
-        // No more waiting jobs for given ServiceID
-        m_busyServices.remove(serviceID);
+    const int connectionsPerHost = Preferences::instance()->getDownloadConnectionsPerHost();
+    if (connectionsPerHost == m_connectionsPerHost)
         return;
+
+    const bool isIncreased = (connectionsPerHost > m_connectionsPerHost);
+    m_connectionsPerHost = connectionsPerHost;
+    if (isIncreased)
+    {
+        for (const ServiceID &serviceID : asConst(m_services.keys()))
+            processWaitingJobs(serviceID);
     }
+}
+
+int Net::DownloadManager::maxActiveJobs(const ServiceID &serviceID) const
+{
+    return m_sequentialServices.contains(serviceID) ? 1 : m_connectionsPerHost;
+}
+
+void Net::DownloadManager::processWaitingJobs(const ServiceID &serviceID)
+{
+    const auto serviceIter = m_services.find(serviceID);
+    if (serviceIter == m_services.end())
+        return;
 
-    auto *handler = waitingJobsIter.value().dequeue();
-    qDebug("Downloading %s...", qUtf8Printable(handler->url()));
-    processRequest(handler);
+    Service &service = serviceIter.value();
+    const int maxJobs = maxActiveJobs(serviceID);
+    for (QQueue<DownloadHandlerImpl *> &jobs : service.waitingJobs)
+    {
+        while (!jobs.isEmpty() && (service.activeJobs < maxJobs))
+        {
+            auto *handler = jobs.dequeue();
+            qDebug("Downloading %s...", qUtf8Printable(handler->url()));
+            processRequest(serviceID, handler);
+        }
+    }
 }
 
-void Net::DownloadManager::processRequest(DownloadHandlerImpl *downloadHandler)
+void Net::DownloadManager::processRequest(const ServiceID &serviceID, DownloadHandlerImpl *downloadHandler)
 {
-    m_networkManager->setProxy((downloadHandler->useProxy() == true) ? m_proxy : QNetworkProxy(QNetworkProxy::NoProxy));
+    ++m_services[serviceID].activeJobs;
+
+    // Changing proxy drops cached connections, so it is only done when really needed
+    const QNetworkProxy proxy = downloadHandler->useProxy() ? m_proxy : QNetworkProxy(QNetworkProxy::NoProxy);
+    if (m_networkManager->proxy() != proxy)
+        m_networkManager->setProxy(proxy);
 
     const DownloadRequest downloadRequest = downloadHandler->downloadRequest();
     QNetworkRequest request {downloadRequest.url()};
@@ -334,15 +385,34 @@ void Net::DownloadManager::processRequest(DownloadHandlerImpl *downloadHandler)
     // gzip encoding and manually decompress the reply data.
     request.setRawHeader("Accept-Encoding", "gzip");
 #endif
+    if (!downloadRequest.eTag().isEmpty())
+        request.setRawHeader("If-None-Match", downloadRequest.eTag().toLatin1());
+    if (!downloadRequest.lastModified().isEmpty())
+        request.setRawHeader("If-Modified-Since", downloadRequest.lastModified().toLatin1());
     // Qt doesn't support Magnet protocol so we need to handle redirections manually
     request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
 
+    // Use HTTP/2 with servers that support it, so that requests to the same host share single connection
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
     request.setTransferTimeout();
 
+    QElapsedTimer latencyTimer;
+    latencyTimer.start();
     QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, serviceID = ServiceID::fromURL(downloadHandler->url())]
+    connect(reply, &QNetworkReply::finished, this, [this, serviceID, latencyTimer]
     {
-        QTimer::singleShot(m_sequentialServices.value(serviceID, 0s), this, [this, serviceID] { processWaitingJobs(serviceID); });
+        ServiceStatistics &statistics = m_services[serviceID].statistics;
+        const auto latency = std::chrono::milliseconds(latencyTimer.elapsed());
+        statistics.averageLatency = (statistics.finishedRequests == 0)
+                ? latency : (statistics.averageLatency + ((latency - statistics.averageLatency) / LATENCY_SMOOTHING));
+        ++statistics.finishedRequests;
+
+        QTimer::singleShot(m_sequentialServices.value(serviceID, 0s), this, [this, serviceID]
+        {
+            --m_services[serviceID].activeJobs;
+            processWaitingJobs(serviceID);
+        });
     });
     downloadHandler->assignNetworkReply(reply);
 }
@@ -407,6 +477,61 @@ Net::DownloadRequest &Net::DownloadRequest::destFileName(const Path &value)
     return *this;
 }
 
+bool Net::DownloadRequest::streamToFile() const
+{
+    return m_streamToFile;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::streamToFile(const bool value)
+{
+    m_streamToFile = value;
+    return *this;
+}
+
+bool Net::DownloadRequest::decompressGzip() const
+{
+    return m_decompressGzip;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::decompressGzip(const bool value)
+{
+    m_decompressGzip = value;
+    return *this;
+}
+
+QString Net::DownloadRequest::eTag() const
+{
+    return m_eTag;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::eTag(const QString &value)
+{
+    m_eTag = value;
+    return *this;
+}
+
+QString Net::DownloadRequest::lastModified() const
+{
+    return m_lastModified;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::lastModified(const QString &value)
+{
+    m_lastModified = value;
+    return *this;
+}
+
+Net::DownloadPriority Net::DownloadRequest::priority() const
+{
+    return m_priority;
+}
+
+Net::DownloadRequest &Net::DownloadRequest::priority(const DownloadPriority value)
+{
+    m_priority = value;
+    return *this;
+}
+
 Net::ServiceID Net::ServiceID::fromURL(const QUrl &url)
 {
     return {url.host(), url.port(80)};
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 
 #include <QtTypes>
@@ -37,7 +38,6 @@
 #include <QNetworkProxy>
 #include <QObject>
 #include <QQueue>
-#include <QSet>
 
 #include "base/path.h"
 
@@ -64,9 +64,18 @@ namespace Net
     {
         Success,
         RedirectedToMagnet,
+        NotModified,  // for conditional requests only (see DownloadRequest::eTag)
         Failed
     };
 
+    // Requests waiting for the same service are started in priority order
+    enum class DownloadPriority
+    {
+        High,  // requested by user and waited for
+        Normal,
+        Low  // background tasks (icons, updates etc.)
+    };
+
     class DownloadRequest
     {
     public:
@@ -91,12 +100,37 @@ namespace Net
         Path destFileName() const;
         DownloadRequest &destFileName(const Path &value);
 
+        // if streamToFile is set along with saveToFile, the data is written to the file
+        // as it is received and DownloadResult::data is left empty
+        bool streamToFile() const;
+        DownloadRequest &streamToFile(bool value);
+
+        // if set, the downloaded content is expected to be gzip (or zlib) compressed
+        // and it is decompressed as it is received
+        bool decompressGzip() const;
+        DownloadRequest &decompressGzip(bool value);
+
+        // HTTP validators of previously downloaded data (see DownloadResult),
+        // if set, the data is only downloaded if it has been modified since then
+        QString eTag() const;
+        DownloadRequest &eTag(const QString &value);
+        QString lastModified() const;
+        DownloadRequest &lastModified(const QString &value);
+
+        DownloadPriority priority() const;
+        DownloadRequest &priority(DownloadPriority value);
+
     private:
         QString m_url;
         QString m_userAgent;
         qint64 m_limit = 0;
         bool m_saveToFile = false;
+        bool m_streamToFile = false;
+        bool m_decompressGzip = false;
         Path m_destFileName;
+        QString m_eTag;
+        QString m_lastModified;
+        DownloadPriority m_priority = DownloadPriority::Normal;
     };
 
     struct DownloadResult
@@ -107,6 +141,9 @@ namespace Net
         QByteArray data;
         Path filePath;
         QString magnetURI;
+        QString eTag;
+        QString lastModified;
+        std::chrono::seconds retryAfter {0};
     };
 
     class DownloadHandler : public QObject
@@ -123,6 +160,15 @@ namespace Net
         void finished(const DownloadResult &result);
     };
 
+    struct ServiceStatistics
+    {
+        int activeRequests = 0;
+        int waitingRequests = 0;
+        qint64 finishedRequests = 0;
+        // exponential moving average of time from sending request until reply is finished
+        std::chrono::milliseconds averageLatency {0};
+    };
+
     class DownloadHandlerImpl;
 
     class DownloadManager final : public QObject
@@ -142,6 +188,8 @@ namespace Net
 
         void registerSequentialService(const ServiceID &serviceID, std::chrono::seconds delay = std::chrono::seconds(0));
 
+        QHash<ServiceID, ServiceStatistics> serviceStatistics() const;
+
         QList<QNetworkCookie> cookiesForUrl(const QUrl &url) const;
         bool setCookiesFromUrl(const QList<QNetworkCookie> &cookieList, const QUrl &url);
         QList<QNetworkCookie> allCookies() const;
@@ -153,21 +201,31 @@ namespace Net
     private:
         class NetworkCookieJar;
 
+        struct Service
+        {
+            int activeJobs = 0;
+            // indexed by DownloadPriority
+            std::array<QQueue<DownloadHandlerImpl *>, 3> waitingJobs;
+            ServiceStatistics statistics;
+        };
+
         explicit DownloadManager(QObject *parent = nullptr);
 
         void applyProxySettings();
+        void loadConnectionsPerHost();
+        int maxActiveJobs(const ServiceID &serviceID) const;
         void processWaitingJobs(const ServiceID &serviceID);
-        void processRequest(DownloadHandlerImpl *downloadHandler);
+        void processRequest(const ServiceID &serviceID, DownloadHandlerImpl *downloadHandler);
 
         static DownloadManager *m_instance;
         NetworkCookieJar *m_networkCookieJar = nullptr;
         QNetworkAccessManager *m_networkManager = nullptr;
         QNetworkProxy m_proxy;
+        int m_connectionsPerHost = 0;
 
         // m_sequentialServices value is delay for same host requests
         QHash<ServiceID, std::chrono::seconds> m_sequentialServices;
-        QSet<ServiceID> m_busyServices;
-        QHash<ServiceID, QQueue<DownloadHandlerImpl *>> m_waitingJobs;
+        QHash<ServiceID, Service> m_services;
     };
 
     template <typename Context, typename Func>
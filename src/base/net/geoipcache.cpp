@@ -0,0 +1,73 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "geoipcache.h"
+
+#include <algorithm>
+
+#include <QMutexLocker>
+
+using namespace Net;
+
+GeoIPCache::GeoIPCache(const qsizetype capacity)
+{
+    const qsizetype shardCapacity = std::max<qsizetype>(1, (capacity / static_cast<qsizetype>(m_shards.size())));
+    for (Shard &s : m_shards)
+        s.entries.setMaxCost(shardCapacity);
+}
+
+std::optional<quint16> GeoIPCache::find(const QHostAddress &addr) const
+{
+    Shard &s = shard(addr);
+    const QMutexLocker locker {&s.mutex};
+    // QCache::object() also marks the entry as recently used
+    if (const quint16 *countryCode = s.entries.object(addr))
+        return *countryCode;
+    return std::nullopt;
+}
+
+void GeoIPCache::insert(const QHostAddress &addr, const quint16 countryCode)
+{
+    Shard &s = shard(addr);
+    const QMutexLocker locker {&s.mutex};
+    s.entries.insert(addr, new quint16 {countryCode});
+}
+
+void GeoIPCache::clear()
+{
+    for (Shard &s : m_shards)
+    {
+        const QMutexLocker locker {&s.mutex};
+        s.entries.clear();
+    }
+}
+
+GeoIPCache::Shard &GeoIPCache::shard(const QHostAddress &addr) const
+{
+    return m_shards[qHash(addr) % m_shards.size()];
+}
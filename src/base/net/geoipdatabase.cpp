@@ -28,6 +28,8 @@
 
 #include "geoipdatabase.h"
 
+#include <cstring>
+
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
@@ -75,36 +77,43 @@ struct DataFieldDescriptor
     };
 };
 
-GeoIPDatabase::GeoIPDatabase(const quint32 size)
-    : m_size(size)
-    , m_data(new uchar[size])
-{
-}
+GeoIPDatabase::GeoIPDatabase() = default;
 
 GeoIPDatabase *GeoIPDatabase::load(const Path &filename, QString &error)
 {
-    QFile file {filename.data()};
-    if (file.size() > MAX_FILE_SIZE)
+    auto file = std::make_unique<QFile>(filename.data());
+    if (file->size() > MAX_FILE_SIZE)
     {
         error = tr("Unsupported database file size.");
         return nullptr;
     }
 
-    if (!file.open(QFile::ReadOnly))
+    if (!file->open(QFile::ReadOnly))
     {
-        error = file.errorString();
+        error = file->errorString();
         return nullptr;
     }
 
-    auto *db = new GeoIPDatabase(file.size());
+    auto *db = new GeoIPDatabase;
+    db->m_size = file->size();
 
-    if (file.read(reinterpret_cast<char *>(db->m_data), db->m_size) != db->m_size)
+    // database is only read, so it is enough to map it into memory
+    if (const uchar *data = file->map(0, db->m_size))
     {
-        error = file.errorString();
-        delete db;
-        return nullptr;
+        db->m_data = data;
+        db->m_file = std::move(file);
+    }
+    else
+    {
+        db->m_buffer = file->readAll();
+        if (db->m_buffer.size() != db->m_size)
+        {
+            error = file->errorString();
+            delete db;
+            return nullptr;
+        }
+        db->m_data = reinterpret_cast<const uchar *>(db->m_buffer.constData());
     }
-
 
     if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error))
     {
@@ -123,9 +132,10 @@ GeoIPDatabase *GeoIPDatabase::load(const QByteArray &data, QString &error)
         return nullptr;
     }
 
-    auto *db = new GeoIPDatabase(data.size());
-
-    memcpy(reinterpret_cast<char *>(db->m_data), data.constData(), db->m_size);
+    auto *db = new GeoIPDatabase;
+    db->m_buffer = data;
+    db->m_size = data.size();
+    db->m_data = reinterpret_cast<const uchar *>(db->m_buffer.constData());
 
     if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error))
     {
@@ -136,10 +146,7 @@ GeoIPDatabase *GeoIPDatabase::load(const QByteArray &data, QString &error)
     return db;
 }
 
-GeoIPDatabase::~GeoIPDatabase()
-{
-    delete [] m_data;
-}
+GeoIPDatabase::~GeoIPDatabase() = default;
 
 QString GeoIPDatabase::type() const
 {
@@ -158,50 +165,263 @@ QDateTime GeoIPDatabase::buildEpoch() const
 
 QString GeoIPDatabase::lookup(const QHostAddress &hostAddr) const
 {
-    Q_IPV6ADDR addr = hostAddr.toIPv6Address();
+    const quint16 countryCode = lookupCountryCode(hostAddr);
+    if (countryCode == 0)
+        return {};
+
+    const char code[2] = {static_cast<char>(countryCode >> 8), static_cast<char>(countryCode & 0xFF)};
+    return QString::fromLatin1(code, 2);
+}
+
+quint16 GeoIPDatabase::lookupCountryCode(const QHostAddress &hostAddr) const
+{
+    const std::optional<quint32> recordOffset = findRecord(hostAddr);
+    if (!recordOffset)
+        return 0;
+
+    return countryCodeAt(*recordOffset);
+}
+
+quint16 GeoIPDatabase::countryCodeAt(const quint32 recordOffset) const
+{
+    // walk straight to "country" -> "iso_code" without decoding the rest of the record
+    quint32 offset = recordOffset;
+    if (!findMapValue(offset, "country") || !findMapValue(offset, "iso_code"))
+        return 0;
+
+    DataFieldDescriptor descr;
+    quint32 valueOffset = 0;
+    if (!resolveDataField(offset, valueOffset, descr)
+        || (descr.fieldType != DataType::String) || (descr.fieldSize != 2) || ((valueOffset + 2) > m_size))
+    {
+        return 0;
+    }
+
+    return static_cast<quint16>((m_data[valueOffset] << 8) | m_data[valueOffset + 1]);
+}
+
+QList<quint16> GeoIPDatabase::lookupCountryCodes(const QList<QHostAddress> &hostAddrs) const
+{
+    QList<quint16> countryCodes;
+    countryCodes.reserve(hostAddrs.size());
+    for (const QHostAddress &hostAddr : hostAddrs)
+        countryCodes.append(lookupCountryCode(hostAddr));
+    return countryCodes;
+}
+
+QList<Utils::Net::Subnet> GeoIPDatabase::countryNetworks(const QSet<quint16> &countryCodes) const
+{
+    QList<Utils::Net::Subnet> networks;
+    if (countryCodes.isEmpty())
+        return networks;
+
+    // the records are shared by many networks, so each one is only decoded once
+    QHash<quint32, bool> matchedRecords;
+    const auto isMatched = [this, &countryCodes, &matchedRecords](const quint32 offset)
+    {
+        auto it = matchedRecords.find(offset);
+        if (it == matchedRecords.end())
+            it = matchedRecords.insert(offset, countryCodes.contains(countryCodeAt(offset)));
+        return it.value();
+    };
+
+    // IPv4 addresses are stored in ::/96 subtree of IPv6 database, the same subtree is also
+    // referenced by the networks the IPv4 addresses are mapped to, e.g. ::ffff:0:0/96
+    std::optional<quint32> ipv4Root;
+    if (m_ipVersion == 4)
+    {
+        ipv4Root = 0;
+    }
+    else
+    {
+        quint32 node = 0;
+        for (int i = 0; (i < 96) && (node < m_nodeCount); ++i)
+            node = readNodeRecord(node, false);
+        if (node < m_nodeCount)
+            ipv4Root = node;
+    }
+
+    Q_IPV6ADDR addr {};
+    if (ipv4Root)
+    {
+        collectNetworks(*ipv4Root, addr, 96, std::nullopt
+            , [&networks, &isMatched](const Q_IPV6ADDR &networkAddr, const int prefixLength, const quint32 offset)
+        {
+            if (!isMatched(offset))
+                return;
 
-    const uchar *ptr = m_data;
+            const quint32 ipv4Addr = (static_cast<quint32>(networkAddr[12]) << 24) | (static_cast<quint32>(networkAddr[13]) << 16)
+                | (static_cast<quint32>(networkAddr[14]) << 8) | static_cast<quint32>(networkAddr[15]);
+            networks.append({QHostAddress(ipv4Addr), (prefixLength - 96)});
+        });
+    }
 
+    if (m_ipVersion == 6)
+    {
+        collectNetworks(0, addr, 0, ipv4Root
+            , [&networks, &isMatched](const Q_IPV6ADDR &networkAddr, const int prefixLength, const quint32 offset)
+        {
+            if (isMatched(offset))
+                networks.append({QHostAddress(networkAddr), prefixLength});
+        });
+    }
+
+    return networks;
+}
+
+void GeoIPDatabase::collectNetworks(const quint32 node, Q_IPV6ADDR &addr, const int depth
+        , const std::optional<quint32> skippedNode, const NetworkHandler &handler) const
+{
+    const int byteIndex = depth / 8;
+    const auto bitMask = static_cast<quint8>(0x80 >> (depth % 8));
+    for (const bool right : {false, true})
+    {
+        if (right)
+            addr[byteIndex] |= bitMask;
+
+        const quint32 record = readNodeRecord(node, right);
+        if (record > m_nodeCount)
+            handler(addr, (depth + 1), dataOffset(record));
+        else if ((record < m_nodeCount) && (record != skippedNode) && ((depth + 1) < 128))
+            collectNetworks(record, addr, (depth + 1), skippedNode, handler);
+    }
+    addr[byteIndex] &= ~bitMask;
+}
+
+std::optional<quint32> GeoIPDatabase::findRecord(const QHostAddress &hostAddr) const
+{
+    Q_IPV6ADDR addr = hostAddr.toIPv6Address();
+
+    quint32 node = 0;
     for (int i = 0; i < 16; ++i)
     {
         for (int j = 0; j < 8; ++j)
         {
             const bool right = static_cast<bool>((addr[i] >> (7 - j)) & 1);
-            // Interpret the left/right record as number
-            if (right)
-                ptr += m_recordBytes;
-
-            quint32 id = 0;
-            auto *idPtr = reinterpret_cast<uchar *>(&id);
-            memcpy(&idPtr[4 - m_recordBytes], ptr, m_recordBytes);
-            fromBigEndian(idPtr, 4);
+            const quint32 id = readNodeRecord(node, right);
 
             if (id == m_nodeCount)
-            {
-                return {};
-            }
+                return std::nullopt;
+
             if (id > m_nodeCount)
-            {
-                QString country = m_countries.value(id);
-                if (country.isEmpty())
-                {
-                    const quint32 offset = id - m_nodeCount - sizeof(DATA_SECTION_SEPARATOR);
-                    quint32 tmp = offset + m_indexSize + sizeof(DATA_SECTION_SEPARATOR);
-                    const QVariant val = readDataField(tmp);
-                    if (val.userType() == QMetaType::QVariantHash)
-                    {
-                        country = val.toHash()[u"country"_s].toHash()[u"iso_code"_s].toString();
-                        m_countries[id] = country;
-                    }
-                }
-                return country;
-            }
-
-            ptr = m_data + (id * m_nodeSize);
+                return dataOffset(id);
+
+            node = id;
         }
     }
 
-    return {};
+    return std::nullopt;
+}
+
+quint32 GeoIPDatabase::readNodeRecord(const quint32 node, const bool right) const
+{
+    // Interpret the left/right record as number
+    const uchar *ptr = m_data + (node * m_nodeSize);
+    if (right)
+        ptr += m_recordBytes;
+
+    quint32 id = 0;
+    auto *idPtr = reinterpret_cast<uchar *>(&id);
+    memcpy(&idPtr[4 - m_recordBytes], ptr, m_recordBytes);
+    fromBigEndian(idPtr, 4);
+    return id;
+}
+
+quint32 GeoIPDatabase::dataOffset(const quint32 record) const
+{
+    const quint32 offset = record - m_nodeCount - sizeof(DATA_SECTION_SEPARATOR);
+    return (offset + m_indexSize + sizeof(DATA_SECTION_SEPARATOR));
+}
+
+bool GeoIPDatabase::resolveDataField(quint32 &offset, quint32 &valueOffset, DataFieldDescriptor &out, bool *isPointer) const
+{
+    // On return `offset` points past the pointer if the field is referenced by pointer,
+    // otherwise to the field value, same as `valueOffset`
+    if (!readDataFieldDescriptor(offset, out))
+        return false;
+
+    valueOffset = offset;
+    if (isPointer)
+        *isPointer = (out.fieldType == DataType::Pointer);
+    if (out.fieldType == DataType::Pointer)
+    {
+        valueOffset = out.offset + m_indexSize + sizeof(DATA_SECTION_SEPARATOR);
+        if (!readDataFieldDescriptor(valueOffset, out) || (out.fieldType == DataType::Pointer))
+            return false;
+    }
+
+    return true;
+}
+
+bool GeoIPDatabase::skipDataField(quint32 &offset) const
+{
+    DataFieldDescriptor descr;
+    if (!readDataFieldDescriptor(offset, descr))
+        return false;
+
+    switch (descr.fieldType)
+    {
+    case DataType::Pointer:
+    case DataType::Boolean:
+        // value is stored in descriptor
+        return true;
+    case DataType::Map:
+        for (quint32 i = 0; i < descr.fieldSize; ++i)
+        {
+            if (!skipDataField(offset) || !skipDataField(offset))
+                return false;
+        }
+        return true;
+    case DataType::Array:
+        for (quint32 i = 0; i < descr.fieldSize; ++i)
+        {
+            if (!skipDataField(offset))
+                return false;
+        }
+        return true;
+    case DataType::DataCacheContainer:
+    case DataType::EndMarker:
+    case DataType::Unknown:
+        return false;
+    default:
+        offset += descr.fieldSize;
+        return (offset <= m_size);
+    }
+}
+
+bool GeoIPDatabase::findMapValue(quint32 &offset, const QByteArrayView key) const
+{
+    DataFieldDescriptor descr;
+    quint32 mapOffset = 0;
+    if (!resolveDataField(offset, mapOffset, descr) || (descr.fieldType != DataType::Map))
+        return false;
+
+    for (quint32 i = 0; i < descr.fieldSize; ++i)
+    {
+        DataFieldDescriptor keyDescr;
+        quint32 keyOffset = 0;
+        bool isPointer = false;
+        if (!resolveDataField(mapOffset, keyOffset, keyDescr, &isPointer) || (keyDescr.fieldType != DataType::String)
+            || ((keyOffset + keyDescr.fieldSize) > m_size))
+        {
+            return false;
+        }
+
+        if (!isPointer)
+            mapOffset += keyDescr.fieldSize;
+
+        if ((keyDescr.fieldSize == static_cast<quint32>(key.size()))
+            && (memcmp(m_data + keyOffset, key.data(), key.size()) == 0))
+        {
+            offset = mapOffset;
+            return true;
+        }
+
+        if (!skipDataField(mapOffset))
+            return false;
+    }
+
+    return false;
 }
 
 #define CHECK_METADATA_REQ(key, type) \
@@ -28,16 +28,25 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <optional>
+
 #include <QtTypes>
+#include <QByteArray>
+#include <QByteArrayView>
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QSet>
 #include <QVariant>
 
 #include "base/pathfwd.h"
+#include "base/utils/net.h"
 
-class QByteArray;
-class QHostAddress;
+class QFile;
 class QString;
 
 struct DataFieldDescriptor;
@@ -57,14 +66,35 @@ public:
     quint16 ipVersion() const;
     QDateTime buildEpoch() const;
     QString lookup(const QHostAddress &hostAddr) const;
+    // Country code is returned as two ISO 3166-1 alpha-2 chars packed into 16 bits
+    // (first char in high byte) or 0 if address is not found
+    quint16 lookupCountryCode(const QHostAddress &hostAddr) const;
+    QList<quint16> lookupCountryCodes(const QList<QHostAddress> &hostAddrs) const;
+    // Networks of the addresses located in the given countries, ordered by address.
+    // IPv4 networks are returned as such rather than within IPv4-mapped IPv6 ones.
+    QList<Utils::Net::Subnet> countryNetworks(const QSet<quint16> &countryCodes) const;
 
 private:
-    explicit GeoIPDatabase(quint32 size);
+    using NetworkHandler = std::function<void (const Q_IPV6ADDR &addr, int prefixLength, quint32 recordOffset)>;
+
+    GeoIPDatabase();
 
     bool parseMetadata(const QVariantHash &metadata, QString &error);
     bool loadDB(QString &error) const;
     QVariantHash readMetadata() const;
 
+    std::optional<quint32> findRecord(const QHostAddress &hostAddr) const;
+    quint32 readNodeRecord(quint32 node, bool right) const;
+    quint32 dataOffset(quint32 record) const;
+    quint16 countryCodeAt(quint32 recordOffset) const;
+    // Walks the search tree below `node` which is reached by the first `depth` bits of `addr`,
+    // the subtree of `skippedNode` is left out
+    void collectNetworks(quint32 node, Q_IPV6ADDR &addr, int depth, std::optional<quint32> skippedNode
+            , const NetworkHandler &handler) const;
+    bool resolveDataField(quint32 &offset, quint32 &valueOffset, DataFieldDescriptor &out, bool *isPointer = nullptr) const;
+    bool skipDataField(quint32 &offset) const;
+    bool findMapValue(quint32 &offset, QByteArrayView key) const;
+
     QVariant readDataField(quint32 &offset) const;
     bool readDataFieldDescriptor(quint32 &offset, DataFieldDescriptor &out) const;
     void fromBigEndian(uchar *buf, quint32 len) const;
@@ -83,7 +113,8 @@ private:
     QDateTime m_buildEpoch;
     QString m_dbType;
     // Search data
-    mutable QHash<quint32, QString> m_countries;
+    std::unique_ptr<QFile> m_file;
+    QByteArray m_buffer;
     quint32 m_size = 0;
-    uchar *m_data = nullptr;
+    const uchar *m_data = nullptr;
 };
@@ -38,7 +38,6 @@
 #include "base/preferences.h"
 #include "base/profile.h"
 #include "base/utils/fs.h"
-#include "base/utils/gzip.h"
 #include "base/utils/io.h"
 #include "downloadmanager.h"
 #include "geoipdatabase.h"
@@ -46,6 +45,7 @@
 const QString DATABASE_URL = u"https://download.db-ip.com/free/dbip-country-lite-%1.mmdb.gz"_s;
 const QString GEODB_FOLDER = u"GeoDB"_s;
 const QString GEODB_FILENAME = u"dbip-country-lite.mmdb"_s;
+const qsizetype LOOKUP_CACHE_CAPACITY = 65536;
 
 using namespace Net;
 
@@ -54,14 +54,18 @@ using namespace Net;
 GeoIPManager *GeoIPManager::m_instance = nullptr;
 
 GeoIPManager::GeoIPManager()
+    : m_cache {LOOKUP_CACHE_CAPACITY}
 {
+    m_loadingThreadPool.setObjectName("GeoIPManager m_loadingThreadPool");
+    m_loadingThreadPool.setMaxThreadCount(1);
+
     configure();
     connect(Preferences::instance(), &Preferences::changed, this, &GeoIPManager::configure);
 }
 
 GeoIPManager::~GeoIPManager()
 {
-    delete m_geoIPDatabase;
+    m_loadingThreadPool.waitForDone();
 }
 
 void GeoIPManager::initInstance()
@@ -81,21 +85,66 @@ GeoIPManager *GeoIPManager::instance()
     return m_instance;
 }
 
+void GeoIPManager::setDatabase(std::shared_ptr<const GeoIPDatabase> geoIPDatabase)
+{
+    const bool isChanged = (database() || geoIPDatabase);
+
+    m_geoIPDatabase.store(std::move(geoIPDatabase));
+    m_cache.clear();
+
+    if (isChanged)
+        emit databaseChanged();
+}
+
+std::shared_ptr<const GeoIPDatabase> GeoIPManager::database() const
+{
+    return *m_geoIPDatabase.load();
+}
+
+bool GeoIPManager::isDatabaseLoaded() const
+{
+    return static_cast<bool>(database());
+}
+
+void GeoIPManager::setDatabaseRequired(const bool required)
+{
+    if (m_isDatabaseRequired == required)
+        return;
+
+    m_isDatabaseRequired = required;
+    configure();
+}
+
 void GeoIPManager::loadDatabase()
 {
-    delete m_geoIPDatabase;
-    m_geoIPDatabase = nullptr;
+    setDatabase(nullptr);
 
     const Path filepath = specialFolderLocation(SpecialFolder::Data)
             / Path(GEODB_FOLDER) / Path(GEODB_FILENAME);
 
-    QString error;
-    m_geoIPDatabase = GeoIPDatabase::load(filepath, error);
-    if (m_geoIPDatabase)
+    const quint64 loadGeneration = ++m_loadGeneration;
+    m_loadingThreadPool.start([this, filepath, loadGeneration]
+    {
+        QString error;
+        std::shared_ptr<const GeoIPDatabase> geoIPDatabase {GeoIPDatabase::load(filepath, error)};
+        QMetaObject::invokeMethod(this, [this, loadGeneration, geoIPDatabase = std::move(geoIPDatabase), error]
+        {
+            handleDatabaseLoaded(loadGeneration, geoIPDatabase, error);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void GeoIPManager::handleDatabaseLoaded(const quint64 loadGeneration, std::shared_ptr<const GeoIPDatabase> geoIPDatabase, const QString &error)
+{
+    if (loadGeneration != m_loadGeneration)
+        return;
+
+    if (geoIPDatabase)
     {
         LogMsg(tr("IP geolocation database loaded. Type: %1. Build time: %2.")
-                                       .arg(m_geoIPDatabase->type(), m_geoIPDatabase->buildEpoch().toString()),
+                                       .arg(geoIPDatabase->type(), geoIPDatabase->buildEpoch().toString()),
                                        Log::INFO);
+        setDatabase(std::move(geoIPDatabase));
     }
     else
     {
@@ -121,7 +170,8 @@ void GeoIPManager::manageDatabaseUpdate()
         return false;
     };
 
-    if (!m_geoIPDatabase || expired(m_geoIPDatabase->buildEpoch()))
+    const std::shared_ptr<const GeoIPDatabase> geoIPDatabase = database();
+    if (!geoIPDatabase || expired(geoIPDatabase->buildEpoch()))
         downloadDatabaseFile();
 }
 
@@ -130,16 +180,76 @@ void GeoIPManager::downloadDatabaseFile()
     const QDateTime curDatetime = QDateTime::currentDateTimeUtc();
     const QString curUrl = DATABASE_URL.arg(QLocale::c().toString(curDatetime, u"yyyy-MM"));
     DownloadManager::instance()->download(
-            {curUrl}, Preferences::instance()->useProxyForGeneralPurposes()
+            DownloadRequest(curUrl).decompressGzip(true).priority(DownloadPriority::Low), Preferences::instance()->useProxyForGeneralPurposes()
             , this, &GeoIPManager::downloadFinished);
 }
 
 QString GeoIPManager::lookup(const QHostAddress &hostAddr) const
 {
-    if (m_enabled && m_geoIPDatabase)
-        return m_geoIPDatabase->lookup(hostAddr);
+    return countryCodeToString(lookupCountryCode(hostAddr));
+}
+
+quint16 GeoIPManager::lookupCountryCode(const QHostAddress &hostAddr) const
+{
+    if (!m_enabled)
+        return 0;
 
-    return {};
+    const std::shared_ptr<const GeoIPDatabase> geoIPDatabase = database();
+    if (!geoIPDatabase)
+        return 0;
+
+    if (const std::optional<quint16> cached = m_cache.find(hostAddr))
+        return *cached;
+
+    const quint16 code = geoIPDatabase->lookupCountryCode(hostAddr);
+    m_cache.insert(hostAddr, code);
+    return code;
+}
+
+QList<Utils::Net::Subnet> GeoIPManager::countryNetworks(const QSet<quint16> &countryCodes) const
+{
+    const std::shared_ptr<const GeoIPDatabase> geoIPDatabase = database();
+    if (!geoIPDatabase)
+        return {};
+
+    return geoIPDatabase->countryNetworks(countryCodes);
+}
+
+QList<quint16> GeoIPManager::lookupCountryCodes(const QList<QHostAddress> &hostAddrs) const
+{
+    const std::shared_ptr<const GeoIPDatabase> geoIPDatabase = m_enabled ? database() : nullptr;
+    if (!geoIPDatabase)
+        return QList<quint16>(hostAddrs.size(), 0);
+
+    QList<quint16> countryCodes;
+    countryCodes.reserve(hostAddrs.size());
+    for (const QHostAddress &hostAddr : hostAddrs)
+    {
+        const std::optional<quint16> cached = m_cache.find(hostAddr);
+        const quint16 code = cached ? *cached : geoIPDatabase->lookupCountryCode(hostAddr);
+        if (!cached)
+            m_cache.insert(hostAddr, code);
+        countryCodes.append(code);
+    }
+    return countryCodes;
+}
+
+quint16 GeoIPManager::countryCode(const QString &countryISOCode)
+{
+    if (countryISOCode.size() != 2)
+        return 0;
+
+    const char code[3] = {countryISOCode[0].toLatin1(), countryISOCode[1].toLatin1(), '\0'};
+    return countryCode(code);
+}
+
+QString GeoIPManager::countryCodeToString(const quint16 countryCode)
+{
+    if (countryCode == 0)
+        return {};
+
+    const char code[2] = {static_cast<char>(countryCode >> 8), static_cast<char>(countryCode & 0xFF)};
+    return QString::fromLatin1(code, 2);
 }
 
 QString GeoIPManager::CountryName(const QString &countryISOCode)
@@ -408,18 +518,21 @@ QString GeoIPManager::CountryName(const QString &countryISOCode)
 
 void GeoIPManager::configure()
 {
-    const bool enabled = Preferences::instance()->resolvePeerCountries();
-    if (m_enabled != enabled)
+    m_enabled = Preferences::instance()->resolvePeerCountries();
+
+    const bool isDatabaseNeeded = (m_enabled || m_isDatabaseRequired);
+    if (m_isDatabaseNeeded != isDatabaseNeeded)
     {
-        m_enabled = enabled;
-        if (m_enabled && !m_geoIPDatabase)
+        m_isDatabaseNeeded = isDatabaseNeeded;
+        if (m_isDatabaseNeeded && !database())
         {
             loadDatabase();
         }
-        else if (!m_enabled)
+        else if (!m_isDatabaseNeeded)
         {
-            delete m_geoIPDatabase;
-            m_geoIPDatabase = nullptr;
+            // discard the results of the pending loads
+            ++m_loadGeneration;
+            setDatabase(nullptr);
         }
     }
 }
@@ -432,31 +545,57 @@ void GeoIPManager::downloadFinished(const DownloadResult &result)
         return;
     }
 
-    bool ok = false;
-    const QByteArray data = Utils::Gzip::decompress(result.data, &ok);
-    if (!ok)
+    if (!m_isDatabaseNeeded)
+        return;
+
+    // the database file is decompressed while it is being downloaded
+    const quint64 loadGeneration = m_loadGeneration;
+    m_loadingThreadPool.start([this, data = result.data, loadGeneration]
     {
-        LogMsg(tr("Could not decompress IP geolocation database file."), Log::WARNING);
+        QString error;
+        std::shared_ptr<const GeoIPDatabase> geoIPDatabase {GeoIPDatabase::load(data, error)};
+        QMetaObject::invokeMethod(this, [this, loadGeneration, geoIPDatabase = std::move(geoIPDatabase), data, error]
+        {
+            handleDatabaseDownloaded(loadGeneration, geoIPDatabase, data, error);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void GeoIPManager::handleDatabaseDownloaded(const quint64 loadGeneration, std::shared_ptr<const GeoIPDatabase> geoIPDatabase
+        , const QByteArray &data, const QString &error)
+{
+    if (loadGeneration != m_loadGeneration)
+        return;
+
+    if (!geoIPDatabase)
+    {
+        LogMsg(tr("Couldn't load IP geolocation database. Reason: %1").arg(error), Log::WARNING);
         return;
     }
 
-    QString error;
-    GeoIPDatabase *geoIPDatabase = GeoIPDatabase::load(data, error);
-    if (geoIPDatabase)
+    const std::shared_ptr<const GeoIPDatabase> currentDatabase = database();
+    if (currentDatabase && (geoIPDatabase->buildEpoch() <= currentDatabase->buildEpoch()))
+        return;
+
+    LogMsg(tr("IP geolocation database loaded. Type: %1. Build time: %2.")
+        .arg(geoIPDatabase->type(), geoIPDatabase->buildEpoch().toString())
+           , Log::INFO);
+    setDatabase(std::move(geoIPDatabase));
+    saveDatabaseFile(data);
+}
+
+void GeoIPManager::saveDatabaseFile(const QByteArray &data)
+{
+    m_loadingThreadPool.start([this, data]
     {
-        if (!m_geoIPDatabase || (geoIPDatabase->buildEpoch() > m_geoIPDatabase->buildEpoch()))
+        const Path targetPath = specialFolderLocation(SpecialFolder::Data) / Path(GEODB_FOLDER);
+        if (!targetPath.exists())
+            Utils::Fs::mkpath(targetPath);
+
+        const auto path = targetPath / Path(GEODB_FILENAME);
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(path, data);
+        QMetaObject::invokeMethod(this, [result]
         {
-            delete m_geoIPDatabase;
-            m_geoIPDatabase = geoIPDatabase;
-            LogMsg(tr("IP geolocation database loaded. Type: %1. Build time: %2.")
-                .arg(m_geoIPDatabase->type(), m_geoIPDatabase->buildEpoch().toString())
-                   , Log::INFO);
-            const Path targetPath = specialFolderLocation(SpecialFolder::Data) / Path(GEODB_FOLDER);
-            if (!targetPath.exists())
-                Utils::Fs::mkpath(targetPath);
-
-            const auto path = targetPath / Path(GEODB_FILENAME);
-            const nonstd::expected<void, QString> result = Utils::IO::saveToFile(path, data);
             if (result)
             {
                 LogMsg(tr("Successfully updated IP geolocation database."), Log::INFO);
@@ -466,14 +605,6 @@ void GeoIPManager::downloadFinished(const DownloadResult &result)
                 LogMsg(tr("Couldn't save downloaded IP geolocation database file. Reason: %1")
                     .arg(result.error()), Log::WARNING);
             }
-        }
-        else
-        {
-            delete geoIPDatabase;
-        }
-    }
-    else
-    {
-        LogMsg(tr("Couldn't load IP geolocation database. Reason: %1").arg(error), Log::WARNING);
-    }
+        }, Qt::QueuedConnection);
+    });
 }
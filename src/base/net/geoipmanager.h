@@ -29,7 +29,16 @@
 
 #pragma once
 
+#include <memory>
+
+#include <QList>
 #include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include "base/atomicsnapshot.h"
+#include "base/utils/net.h"
+#include "geoipcache.h"
 
 class QHostAddress;
 class QString;
@@ -51,9 +60,30 @@ namespace Net
         static GeoIPManager *instance();
 
         QString lookup(const QHostAddress &hostAddr) const;
+        // Returns ISO 3166-1 alpha-2 country code packed into 16 bits, or 0 if not resolved
+        quint16 lookupCountryCode(const QHostAddress &hostAddr) const;
+        QList<quint16> lookupCountryCodes(const QList<QHostAddress> &hostAddrs) const;
+        // Networks of the given countries, empty until the database is loaded
+        QList<Utils::Net::Subnet> countryNetworks(const QSet<quint16> &countryCodes) const;
+
+        // The database is loaded while peer countries are resolved or it is required by other means,
+        // e.g. to block peers by country. `databaseChanged()` is emitted once it is (re)loaded.
+        void setDatabaseRequired(bool required);
+        bool isDatabaseLoaded() const;
 
         static QString CountryName(const QString &countryISOCode);
 
+        static constexpr quint16 countryCode(const char (&countryISOCode)[3])
+        {
+            return static_cast<quint16>((static_cast<uchar>(countryISOCode[0]) << 8) | static_cast<uchar>(countryISOCode[1]));
+        }
+
+        static quint16 countryCode(const QString &countryISOCode);
+        static QString countryCodeToString(quint16 countryCode);
+
+    signals:
+        void databaseChanged();
+
     private slots:
         void configure();
         void downloadFinished(const DownloadResult &result);
@@ -63,11 +93,26 @@ namespace Net
         ~GeoIPManager() override;
 
         void loadDatabase();
+        void handleDatabaseLoaded(quint64 loadGeneration, std::shared_ptr<const GeoIPDatabase> geoIPDatabase, const QString &error);
+        void handleDatabaseDownloaded(quint64 loadGeneration, std::shared_ptr<const GeoIPDatabase> geoIPDatabase
+                , const QByteArray &data, const QString &error);
+        void saveDatabaseFile(const QByteArray &data);
         void manageDatabaseUpdate();
         void downloadDatabaseFile();
+        void setDatabase(std::shared_ptr<const GeoIPDatabase> geoIPDatabase);
+        std::shared_ptr<const GeoIPDatabase> database() const;
 
         bool m_enabled = false;
-        GeoIPDatabase *m_geoIPDatabase = nullptr;
+        bool m_isDatabaseRequired = false;
+        bool m_isDatabaseNeeded = false;
+        // Lookups can be performed from other threads (e.g. by peer filters of libtorrent),
+        // so the database is replaced atomically and the old one is released by its last user
+        AtomicSnapshot<std::shared_ptr<const GeoIPDatabase>> m_geoIPDatabase;
+        mutable GeoIPCache m_cache;
+        // Databases are parsed in background. Results of the loads started
+        // before the database was unloaded or reloaded are discarded.
+        QThreadPool m_loadingThreadPool;
+        quint64 m_loadGeneration = 0;
 
         static GeoIPManager *m_instance;
     };
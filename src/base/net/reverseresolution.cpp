@@ -28,15 +28,41 @@
 
 #include "reverseresolution.h"
 
+#include <chrono>
+
+#include <QDebug>
 #include <QHostInfo>
-#include <QString>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
 
-const int CACHE_SIZE = 2048;
+#include "base/global.h"
+#include "base/path.h"
+#include "base/profile.h"
+#include "base/utils/io.h"
 
+using namespace std::chrono_literals;
 using namespace Net;
 
 namespace
 {
+    const int CACHE_SIZE = 2048;
+    const int CACHE_FILE_MAX_SIZE = 1024 * 1024;
+    const int MAX_CONCURRENT_LOOKUPS = 8;
+    const std::chrono::seconds RESOLVED_TTL = 24h;
+    // failed lookups are retried sooner
+    const std::chrono::seconds UNRESOLVED_TTL = 1h;
+
+    const QString KEY_IP = u"ip"_s;
+    const QString KEY_HOSTNAME = u"hostname"_s;
+    const QString KEY_EXPIRATION = u"expiration"_s;
+
+    Path cacheFilePath()
+    {
+        return specialFolderLocation(SpecialFolder::Cache) / Path(u"reverse_dns_cache.json"_s);
+    }
+
     bool isUsefulHostName(const QString &hostname, const QHostAddress &ip)
     {
         return (!hostname.isEmpty() && (hostname != ip.toString()));
@@ -47,6 +73,7 @@ ReverseResolution::ReverseResolution(QObject *parent)
     : QObject(parent)
 {
     m_cache.setMaxCost(CACHE_SIZE);
+    loadCache();
 }
 
 ReverseResolution::~ReverseResolution()
@@ -54,35 +81,120 @@ ReverseResolution::~ReverseResolution()
     // abort on-going lookups instead of waiting them
     for (auto iter = m_lookups.cbegin(); iter != m_lookups.cend(); ++iter)
         QHostInfo::abortHostLookup(iter.key());
+
+    storeCache();
 }
 
-void ReverseResolution::resolve(const QHostAddress &ip)
+void ReverseResolution::resolve(const QHostAddress &ip, const bool prioritized)
 {
-    const QString *hostname = m_cache.object(ip);
-    if (hostname)
+    if (const CacheEntry *entry = m_cache.object(ip))
     {
-        emit ipResolved(ip, *hostname);
+        if (entry->expiration > QDateTime::currentDateTimeUtc())
+        {
+            emit ipResolved(ip, entry->hostName);
+            return;
+        }
+
+        m_cache.remove(ip);
+    }
+
+    if (m_activeIPs.contains(ip))
         return;
+
+    if (prioritized)
+    {
+        if (!m_prioritizedIPs.contains(ip))
+        {
+            m_priorityQueue.append(ip);
+            m_prioritizedIPs.insert(ip);
+        }
+    }
+    else if (!m_queuedIPs.contains(ip))
+    {
+        m_queue.append(ip);
     }
+    m_queuedIPs.insert(ip);
 
-    // do reverse lookup: IP -> hostname
-    const int lookupId = QHostInfo::lookupHost(ip.toString(), this, &ReverseResolution::hostResolved);
-    m_lookups.insert(lookupId, ip);
+    startLookups();
 }
 
-void ReverseResolution::hostResolved(const QHostInfo &host)
+void ReverseResolution::startLookups()
 {
-    const QHostAddress ip = m_lookups.take(host.lookupId());
+    while ((m_lookups.size() < MAX_CONCURRENT_LOOKUPS) && !m_queuedIPs.isEmpty())
+    {
+        QList<QHostAddress> &queue = !m_priorityQueue.isEmpty() ? m_priorityQueue : m_queue;
+        const QHostAddress ip = queue.takeFirst();
+        if (!m_queuedIPs.remove(ip))
+            continue;
+        m_prioritizedIPs.remove(ip);
+
+        // do reverse lookup: IP -> hostname
+        const int lookupId = QHostInfo::lookupHost(ip.toString(), this, &ReverseResolution::hostResolved);
+        m_lookups.insert(lookupId, ip);
+        m_activeIPs.insert(ip);
+    }
 
-    if (host.error() != QHostInfo::NoError)
+    if (m_queuedIPs.isEmpty())
     {
-        emit ipResolved(ip, {});
-        return;
+        m_priorityQueue.clear();
+        m_queue.clear();
     }
+}
 
-    const QString hostname = isUsefulHostName(host.hostName(), ip)
+void ReverseResolution::hostResolved(const QHostInfo &host)
+{
+    const QHostAddress ip = m_lookups.take(host.lookupId());
+    m_activeIPs.remove(ip);
+
+    const QString hostname = ((host.error() == QHostInfo::NoError) && isUsefulHostName(host.hostName(), ip))
         ? host.hostName()
         : QString();
-    m_cache.insert(ip, new QString(hostname));
+    const std::chrono::seconds ttl = hostname.isEmpty() ? UNRESOLVED_TTL : RESOLVED_TTL;
+    m_cache.insert(ip, new CacheEntry {hostname, QDateTime::currentDateTimeUtc().addSecs(ttl.count())});
     emit ipResolved(ip, hostname);
+
+    startLookups();
+}
+
+void ReverseResolution::loadCache()
+{
+    const auto readResult = Utils::IO::readFile(cacheFilePath(), CACHE_FILE_MAX_SIZE);
+    if (!readResult)
+        return;
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QJsonArray entries = QJsonDocument::fromJson(readResult.value()).array();
+    for (const QJsonValue &entryVal : entries)
+    {
+        const QJsonObject entryObj = entryVal.toObject();
+        const QHostAddress ip {entryObj.value(KEY_IP).toString()};
+        const QDateTime expiration = QDateTime::fromSecsSinceEpoch(entryObj.value(KEY_EXPIRATION).toInteger());
+        if (ip.isNull() || (expiration <= now))
+            continue;
+
+        m_cache.insert(ip, new CacheEntry {entryObj.value(KEY_HOSTNAME).toString(), expiration});
+    }
+}
+
+void ReverseResolution::storeCache() const
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QJsonArray entries;
+    for (const QHostAddress &ip : asConst(m_cache.keys()))
+    {
+        const CacheEntry *entry = m_cache.object(ip);
+        if (entry->expiration <= now)
+            continue;
+
+        entries.append(QJsonObject {
+            {KEY_IP, ip.toString()},
+            {KEY_HOSTNAME, entry->hostName},
+            {KEY_EXPIRATION, entry->expiration.toSecsSinceEpoch()}
+        });
+    }
+
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(cacheFilePath()
+        , QJsonDocument(entries).toJson(QJsonDocument::Compact));
+    if (!result)
+        qWarning() << "Couldn't store reverse DNS cache. Error: " << result.error();
 }
@@ -29,14 +29,21 @@
 #pragma once
 
 #include <QCache>
+#include <QDateTime>
+#include <QHash>
 #include <QHostAddress>
+#include <QList>
 #include <QObject>
+#include <QSet>
+#include <QString>
 
 class QHostInfo;
-class QString;
 
 namespace Net
 {
+    // Host names are looked up in limited number of parallel lookups, the rest are queued.
+    // Results, including failed lookups, are cached for a limited time and the cache
+    // is stored in the profile, so it survives restarts.
     class ReverseResolution : public QObject
     {
         Q_OBJECT
@@ -46,7 +53,8 @@ namespace Net
         explicit ReverseResolution(QObject *parent = nullptr);
         ~ReverseResolution();
 
-        void resolve(const QHostAddress &ip);
+        // prioritized lookups are started before any other queued ones
+        void resolve(const QHostAddress &ip, bool prioritized = false);
 
     signals:
         void ipResolved(const QHostAddress &ip, const QString &hostname);
@@ -55,7 +63,23 @@ namespace Net
         void hostResolved(const QHostInfo &host);
 
     private:
+        struct CacheEntry
+        {
+            QString hostName;
+            QDateTime expiration;
+        };
+
+        void startLookups();
+        void loadCache();
+        void storeCache() const;
+
         QHash<int, QHostAddress> m_lookups;  // <LookupID, IP>
-        QCache<QHostAddress, QString> m_cache;  // <IP, HostName>
+        QSet<QHostAddress> m_activeIPs;
+        // queues may contain outdated entries, only IPs in `m_queuedIPs` are still waiting
+        QList<QHostAddress> m_priorityQueue;
+        QList<QHostAddress> m_queue;
+        QSet<QHostAddress> m_queuedIPs;
+        QSet<QHostAddress> m_prioritizedIPs;
+        QCache<QHostAddress, CacheEntry> m_cache;
     };
 }
@@ -32,11 +32,14 @@
 
 #include "smtp.h"
 
+#include <chrono>
+
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
 #include <QHostInfo>
 #include <QStringList>
+#include <QTimer>
 
 #ifndef QT_NO_OPENSSL
 #include <QSslSocket>
@@ -49,9 +52,13 @@
 #include "base/preferences.h"
 #include "base/utils/string.h"
 
+using namespace std::chrono_literals;
+
 namespace
 {
     const short DEFAULT_PORT = 25;
+    // the connection is kept open for a while, so the notifications sent in bursts share it
+    const std::chrono::milliseconds IDLE_TIMEOUT = 10s;
 #ifndef QT_NO_OPENSSL
     const short DEFAULT_PORT_SSL = 465;
 #endif
@@ -122,6 +129,11 @@ Smtp::Smtp(QObject *parent)
     connect(m_socket, &QAbstractSocket::disconnected, this, &QObject::deleteLater);
     connect(m_socket, &QAbstractSocket::errorOccurred, this, &Smtp::error);
 
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(IDLE_TIMEOUT);
+    connect(m_idleTimer, &QTimer::timeout, this, &Smtp::quit);
+
     // Test hmacMD5 function (http://www.faqs.org/rfcs/rfc2202.html)
     Q_ASSERT(hmacMD5("Jefe", "what do ya want for nothing?").toHex()
              == "750c783e6ab0b503eaa86e310a5db738");
@@ -136,8 +148,7 @@ Smtp::~Smtp()
 
 void Smtp::sendMail(const QString &from, const QString &to, const QString &subject, const QString &body)
 {
-    const Preferences *const pref = Preferences::instance();
-    m_message = "Date: " + getCurrentDateTime().toLatin1() + "\r\n"
+    QByteArray message = "Date: " + getCurrentDateTime().toLatin1() + "\r\n"
                 + encodeMimeHeader(u"From"_s, u"qBittorrent <%1>"_s.arg(from))
                 + encodeMimeHeader(u"Subject"_s, subject)
                 + encodeMimeHeader(u"To"_s, to)
@@ -150,9 +161,21 @@ void Smtp::sendMail(const QString &from, const QString &to, const QString &subje
     const QByteArray b = crlfBody.replace(u"\n"_s, u"\r\n"_s).toUtf8().toBase64();
     const int ct = b.length();
     for (int i = 0; i < ct; i += 78)
-        m_message += b.mid(i, 78);
-    m_from = from;
-    m_rcpt = to;
+        message += b.mid(i, 78);
+    m_pendingMails.enqueue({.from = from, .rcpt = to, .message = message});
+
+    if (m_state == Idle)
+    {
+        m_idleTimer->stop();
+        sendNextMail();
+        return;
+    }
+
+    // the mail is sent after the current one if the connection is set up already
+    if (m_socket->state() != QAbstractSocket::UnconnectedState)
+        return;
+
+    const Preferences *const pref = Preferences::instance();
     // Authentication
     if (pref->getMailNotificationSMTPAuth())
     {
@@ -242,10 +265,7 @@ void Smtp::readyRead()
         case Authenticated:
             if (code[0] == '2')
             {
-                qDebug() << "Sending <mail from>...";
-                m_socket->write("mail from:<" + m_from.toLatin1() + ">\r\n");
-                m_socket->flush();
-                m_state = Rcpt;
+                sendNextMail();
             }
             else
             {
@@ -296,10 +316,15 @@ void Smtp::readyRead()
         case Quit:
             if (code[0] == '2')
             {
-                m_socket->write("QUIT\r\n");
-                m_socket->flush();
-                // here, we just close.
-                m_state = Close;
+                if (m_pendingMails.isEmpty())
+                {
+                    m_state = Idle;
+                    m_idleTimer->start();
+                }
+                else
+                {
+                    sendNextMail();
+                }
             }
             else
             {
@@ -557,6 +582,35 @@ void Smtp::authLogin()
     }
 }
 
+bool Smtp::isClosing() const
+{
+    return (m_state == Close);
+}
+
+void Smtp::sendNextMail()
+{
+    const Mail mail = m_pendingMails.dequeue();
+    m_from = mail.from;
+    m_rcpt = mail.rcpt;
+    m_message = mail.message;
+
+    qDebug() << "Sending <mail from>...";
+    m_socket->write("mail from:<" + m_from.toLatin1() + ">\r\n");
+    m_socket->flush();
+    m_state = Rcpt;
+}
+
+void Smtp::quit()
+{
+    if (m_state != Idle)
+        return;
+
+    m_socket->write("QUIT\r\n");
+    m_socket->flush();
+    // here, we just close.
+    m_state = Close;
+}
+
 void Smtp::logError(const QString &msg)
 {
     qDebug() << "Email Notification Error:" << msg;
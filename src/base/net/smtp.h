@@ -36,6 +36,7 @@
 #include <QByteArray>
 #include <QHash>
 #include <QObject>
+#include <QQueue>
 #include <QString>
 
 #ifndef QT_NO_OPENSSL
@@ -44,6 +45,8 @@ class QSslSocket;
 class QTcpSocket;
 #endif
 
+class QTimer;
+
 namespace Net
 {
     class Smtp : public QObject
@@ -55,7 +58,10 @@ namespace Net
         Smtp(QObject *parent = nullptr);
         ~Smtp();
 
+        // Mails sent while the connection is open are delivered over it, the connection is
+        // closed once no mail is sent for a while. The object gets deleted after disconnection.
         void sendMail(const QString &from, const QString &to, const QString &subject, const QString &body);
+        bool isClosing() const;
 
     private slots:
         void readyRead();
@@ -78,9 +84,17 @@ namespace Net
             Init,
             Body,
             Quit,
+            Idle,
             Close
         };
 
+        struct Mail
+        {
+            QString from;
+            QString rcpt;
+            QByteArray message;
+        };
+
         enum AuthType
         {
             AuthPlain,
@@ -98,8 +112,12 @@ namespace Net
         void authPlain();
         void authLogin();
         void logError(const QString &msg);
+        void sendNextMail();
+        void quit();
         QString getCurrentDateTime() const;
 
+        QQueue<Mail> m_pendingMails;
+        QTimer *m_idleTimer = nullptr;
         QByteArray m_message;
 #ifndef QT_NO_OPENSSL
         QSslSocket *m_socket = nullptr;
@@ -0,0 +1,179 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "pathinterner.h"
+
+#include <QHashFunctions>
+#include <QStringView>
+
+PathInterner::PathInterner(const Qt::CaseSensitivity caseSensitivity)
+    : m_caseSensitivity {caseSensitivity}
+{
+    clear();
+}
+
+PathInterner::ID PathInterner::intern(const Path &path)
+{
+    const QString pathStr = path.data();
+    if (pathStr.isEmpty())
+        return ROOT_ID;
+
+    // empty components are kept, so that the leading separators of absolute paths are preserved
+    ID id = ROOT_ID;
+    for (const QStringView name : QStringView(pathStr).split(u'/'))
+        id = intern(id, name);
+    return id;
+}
+
+PathInterner::ID PathInterner::intern(const ID parentID, const QStringView name)
+{
+    Q_ASSERT(parentID < static_cast<ID>(m_nodes.size()));
+
+    if (const ID id = find(parentID, name); id != INVALID_ID)
+        return id;
+
+    const ID id = static_cast<ID>(m_nodes.size());
+    const Node &parentNode = m_nodes[parentID];
+    const std::size_t hash = childHash(parentID, name);
+    m_nodes.append({.parentID = parentID, .depth = (parentNode.depth + 1), .hash = hash, .name = name.toString()});
+    m_children.insert(hash, id);
+    return id;
+}
+
+PathInterner::ID PathInterner::find(const Path &path) const
+{
+    const QString pathStr = path.data();
+    if (pathStr.isEmpty())
+        return ROOT_ID;
+
+    ID id = ROOT_ID;
+    for (const QStringView name : QStringView(pathStr).split(u'/'))
+    {
+        id = find(id, name);
+        if (id == INVALID_ID)
+            break;
+    }
+    return id;
+}
+
+PathInterner::ID PathInterner::find(const ID parentID, const QStringView name) const
+{
+    if (parentID >= static_cast<ID>(m_nodes.size()))
+        return INVALID_ID;
+
+    const std::size_t hash = childHash(parentID, name);
+    for (auto [iter, end] = m_children.equal_range(hash); iter != end; ++iter)
+    {
+        const Node &node = m_nodes[iter.value()];
+        if ((node.parentID == parentID) && (name.compare(node.name, m_caseSensitivity) == 0))
+            return iter.value();
+    }
+
+    return INVALID_ID;
+}
+
+Path PathInterner::path(const ID id) const
+{
+    if ((id == ROOT_ID) || (id >= static_cast<ID>(m_nodes.size())))
+        return {};
+
+    const Node *node = &m_nodes[id];
+    QList<const QString *> names;
+    names.reserve(node->depth);
+    qsizetype length = node->depth - 1;
+    for (; node->parentID != INVALID_ID; node = &m_nodes[node->parentID])
+    {
+        names.append(&node->name);
+        length += node->name.size();
+    }
+
+    QString pathStr;
+    pathStr.reserve(length);
+    for (auto iter = names.crbegin(); iter != names.crend(); ++iter)
+    {
+        if (iter != names.crbegin())
+            pathStr.append(u'/');
+        pathStr.append(**iter);
+    }
+
+    return Path(pathStr);
+}
+
+QString PathInterner::name(const ID id) const
+{
+    return (id < static_cast<ID>(m_nodes.size())) ? m_nodes[id].name : QString();
+}
+
+PathInterner::ID PathInterner::parent(const ID id) const
+{
+    return (id < static_cast<ID>(m_nodes.size())) ? m_nodes[id].parentID : INVALID_ID;
+}
+
+int PathInterner::depth(const ID id) const
+{
+    return (id < static_cast<ID>(m_nodes.size())) ? m_nodes[id].depth : -1;
+}
+
+std::size_t PathInterner::hash(const ID id) const
+{
+    return (id < static_cast<ID>(m_nodes.size())) ? m_nodes[id].hash : 0;
+}
+
+bool PathInterner::hasAncestor(const ID id, const ID ancestorID) const
+{
+    if ((id >= static_cast<ID>(m_nodes.size())) || (ancestorID >= static_cast<ID>(m_nodes.size())))
+        return false;
+
+    const int ancestorDepth = m_nodes[ancestorID].depth;
+    ID currentID = id;
+    while (m_nodes[currentID].depth > ancestorDepth)
+        currentID = m_nodes[currentID].parentID;
+
+    return ((currentID == ancestorID) && (id != ancestorID));
+}
+
+qsizetype PathInterner::size() const
+{
+    return m_nodes.size();
+}
+
+void PathInterner::clear()
+{
+    m_children.clear();
+    m_nodes.clear();
+    m_nodes.append({});
+}
+
+std::size_t PathInterner::childHash(const ID parentID, const QStringView name) const
+{
+    const std::size_t parentHash = m_nodes[parentID].hash;
+    if (m_caseSensitivity == Qt::CaseSensitive)
+        return qHashMulti(parentHash, name);
+
+    return qHashMulti(parentHash, name.toString().toCaseFolded());
+}
@@ -0,0 +1,91 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <limits>
+
+#include <Qt>
+#include <QtTypes>
+#include <QList>
+#include <QMultiHash>
+#include <QString>
+
+#include "path.h"
+
+class QStringView;
+
+// Keeps tree of path components, so that each distinct path is stored only once and
+// is identified by a compact ID. Paths sharing a prefix share the nodes of that prefix,
+// and the hash of each node is calculated once, so looking up a path by its parent ID
+// and name neither allocates nor rehashes the whole path.
+// IDs are dense, so they can be used as indexes of per-path data. Not thread-safe.
+class PathInterner
+{
+public:
+    using ID = quint32;
+
+    // ID of the empty path, i.e. the parent of the top level items
+    static constexpr ID ROOT_ID = 0;
+    static constexpr ID INVALID_ID = std::numeric_limits<ID>::max();
+
+    explicit PathInterner(Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
+
+    ID intern(const Path &path);
+    ID intern(ID parentID, QStringView name);
+    // returns INVALID_ID if there is no such path
+    ID find(const Path &path) const;
+    ID find(ID parentID, QStringView name) const;
+
+    Path path(ID id) const;
+    QString name(ID id) const;
+    ID parent(ID id) const;
+    int depth(ID id) const;
+    std::size_t hash(ID id) const;
+    bool hasAncestor(ID id, ID ancestorID) const;
+
+    // number of interned paths, including the empty one
+    qsizetype size() const;
+    void clear();
+
+private:
+    struct Node
+    {
+        ID parentID = INVALID_ID;
+        int depth = 0;
+        std::size_t hash = 0;
+        QString name;
+    };
+
+    std::size_t childHash(ID parentID, QStringView name) const;
+
+    Qt::CaseSensitivity m_caseSensitivity;
+    QList<Node> m_nodes;
+    // child hash -> child ID
+    QMultiHash<std::size_t, ID> m_children;
+};
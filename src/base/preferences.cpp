@@ -46,6 +46,7 @@
 #include "path.h"
 #include "profile.h"
 #include "settingsstorage.h"
+#include "settingvalue.h"
 #include "utils/fs.h"
 
 namespace
@@ -188,7 +189,9 @@ void Preferences::setAlternatingRowColors(const bool b)
 
 bool Preferences::getHideZeroValues() const
 {
-    return value(u"Preferences/General/HideZeroValues"_s, false);
+    // read on every refresh of transfer and peer lists
+    static const SettingKey<bool> key {u"Preferences/General/HideZeroValues"_s, false};
+    return key.get();
 }
 
 void Preferences::setHideZeroValues(const bool b)
@@ -628,6 +631,32 @@ void Preferences::setSchedulerDays(const Scheduler::Days days)
     setValue(u"Preferences/Scheduler/days"_s, days);
 }
 
+QString Preferences::getSchedulerProfiles() const
+{
+    return value<QString>(u"Preferences/Scheduler/profiles"_s);
+}
+
+void Preferences::setSchedulerProfiles(const QString &profiles)
+{
+    if (profiles == getSchedulerProfiles())
+        return;
+
+    setValue(u"Preferences/Scheduler/profiles"_s, profiles);
+}
+
+int Preferences::getSchedulerTransitionTime() const
+{
+    return value(u"Preferences/Scheduler/transition_time"_s, 10);
+}
+
+void Preferences::setSchedulerTransitionTime(const int minutes)
+{
+    if (minutes == getSchedulerTransitionTime())
+        return;
+
+    setValue(u"Preferences/Scheduler/transition_time"_s, minutes);
+}
+
 // Search
 bool Preferences::isSearchEnabled() const
 {
@@ -642,6 +671,33 @@ void Preferences::setSearchEnabled(const bool enabled)
     setValue(u"Preferences/Search/SearchEnabled"_s, enabled);
 }
 
+int Preferences::searchMaxParallelPlugins() const
+{
+    // 0 means all the plugins are run by single process
+    return std::max(0, value(u"Preferences/Search/MaxParallelPlugins"_s, 0));
+}
+
+void Preferences::setSearchMaxParallelPlugins(const int count)
+{
+    if (count == searchMaxParallelPlugins())
+        return;
+
+    setValue(u"Preferences/Search/MaxParallelPlugins"_s, std::max(0, count));
+}
+
+int Preferences::searchPluginTimeout() const
+{
+    return std::max(1, value(u"Preferences/Search/PluginTimeout"_s, 60));
+}
+
+void Preferences::setSearchPluginTimeout(const int seconds)
+{
+    if (seconds == searchPluginTimeout())
+        return;
+
+    setValue(u"Preferences/Search/PluginTimeout"_s, std::max(1, seconds));
+}
+
 bool Preferences::isWebUIEnabled() const
 {
 #ifdef DISABLE_GUI
@@ -792,6 +848,19 @@ void Preferences::setWebUIPassword(const QByteArray &password)
     setValue(u"Preferences/WebUI/Password_PBKDF2"_s, password);
 }
 
+QByteArray Preferences::getWebUIAPIKeyHash() const
+{
+    return value<QByteArray>(u"Preferences/WebUI/APIKey_SHA256"_s);
+}
+
+void Preferences::setWebUIAPIKeyHash(const QByteArray &apiKeyHash)
+{
+    if (apiKeyHash == getWebUIAPIKeyHash())
+        return;
+
+    setValue(u"Preferences/WebUI/APIKey_SHA256"_s, apiKeyHash);
+}
+
 int Preferences::getWebUIMaxAuthFailCount() const
 {
     return value<int>(u"Preferences/WebUI/MaxAuthenticationFailCount"_s, 5);
@@ -831,6 +900,19 @@ void Preferences::setWebUISessionTimeout(const int timeout)
     setValue(u"Preferences/WebUI/SessionTimeout"_s, timeout);
 }
 
+int Preferences::getWebUIMaxConnections() const
+{
+    return value<int>(u"Preferences/WebUI/MaxConnections"_s, 500);
+}
+
+void Preferences::setWebUIMaxConnections(const int count)
+{
+    if (count == getWebUIMaxConnections())
+        return;
+
+    setValue(u"Preferences/WebUI/MaxConnections"_s, count);
+}
+
 QString Preferences::getWebAPISessionCookieName() const
 {
     return value<QString>(u"WebAPI/SessionCookieName"_s);
@@ -935,6 +1017,19 @@ void Preferences::setWebUIHttpsKeyPath(const Path &path)
     setValue(u"Preferences/WebUI/HTTPS/KeyPath"_s, path);
 }
 
+bool Preferences::isWebUIHttp2Enabled() const
+{
+    return value(u"Preferences/WebUI/HTTPS/HTTP2"_s, false);
+}
+
+void Preferences::setWebUIHttp2Enabled(const bool enabled)
+{
+    if (enabled == isWebUIHttp2Enabled())
+        return;
+
+    setValue(u"Preferences/WebUI/HTTPS/HTTP2"_s, enabled);
+}
+
 bool Preferences::isAltWebUIEnabled() const
 {
     return value(u"Preferences/WebUI/AlternativeUIEnabled"_s, false);
@@ -1172,6 +1267,32 @@ void Preferences::setAutoRunConsoleEnabled(const bool enabled)
 }
 #endif
 
+int Preferences::autoRunMaxConcurrentPrograms() const
+{
+    return std::max(value(u"AutoRun/MaxConcurrentPrograms"_s, 0), 0);
+}
+
+void Preferences::setAutoRunMaxConcurrentPrograms(const int count)
+{
+    if (count == autoRunMaxConcurrentPrograms())
+        return;
+
+    setValue(u"AutoRun/MaxConcurrentPrograms"_s, std::max(count, 0));
+}
+
+bool Preferences::isAutoRunBatchModeEnabled() const
+{
+    return value(u"AutoRun/BatchModeEnabled"_s, false);
+}
+
+void Preferences::setAutoRunBatchModeEnabled(const bool enabled)
+{
+    if (enabled == isAutoRunBatchModeEnabled())
+        return;
+
+    setValue(u"AutoRun/BatchModeEnabled"_s, enabled);
+}
+
 bool Preferences::shutdownWhenDownloadsComplete() const
 {
     return value(u"Preferences/Downloads/AutoShutDownOnCompletion"_s, false);
@@ -1252,7 +1373,9 @@ void Preferences::recheckTorrentsOnCompletion(const bool recheck)
 
 bool Preferences::resolvePeerCountries() const
 {
-    return value(u"Preferences/Connection/ResolvePeerCountries"_s, true);
+    // read for peers of every torrent which is being synced
+    static const SettingKey<bool> key {u"Preferences/Connection/ResolvePeerCountries"_s, true};
+    return key.get();
 }
 
 void Preferences::resolvePeerCountries(const bool resolve)
@@ -1265,7 +1388,8 @@ void Preferences::resolvePeerCountries(const bool resolve)
 
 bool Preferences::resolvePeerHostNames() const
 {
-    return value(u"Preferences/Connection/ResolvePeerHostNames"_s, false);
+    static const SettingKey<bool> key {u"Preferences/Connection/ResolvePeerHostNames"_s, false};
+    return key.get();
 }
 
 void Preferences::resolvePeerHostNames(const bool resolve)
@@ -1356,6 +1480,19 @@ void Preferences::setIgnoreSSLErrors(const bool enabled)
     setValue(u"Preferences/Advanced/IgnoreSSLErrors"_s, enabled);
 }
 
+int Preferences::getDownloadConnectionsPerHost() const
+{
+    return std::clamp(value(u"Preferences/Advanced/DownloadConnectionsPerHost"_s, 6), 1, 64);
+}
+
+void Preferences::setDownloadConnectionsPerHost(const int value)
+{
+    if (value == getDownloadConnectionsPerHost())
+        return;
+
+    setValue(u"Preferences/Advanced/DownloadConnectionsPerHost"_s, std::clamp(value, 1, 64));
+}
+
 Path Preferences::getPythonExecutablePath() const
 {
     return value(u"Preferences/Search/pythonExecutablePath"_s, Path());
@@ -165,10 +165,18 @@ public:
     void setSchedulerEndTime(const QTime &time);
     Scheduler::Days getSchedulerDays() const;
     void setSchedulerDays(Scheduler::Days days);
+    QString getSchedulerProfiles() const;
+    void setSchedulerProfiles(const QString &profiles);
+    int getSchedulerTransitionTime() const;
+    void setSchedulerTransitionTime(int minutes);
 
     // Search
     bool isSearchEnabled() const;
     void setSearchEnabled(bool enabled);
+    int searchMaxParallelPlugins() const;
+    void setSearchMaxParallelPlugins(int count);
+    int searchPluginTimeout() const;
+    void setSearchPluginTimeout(int seconds);
 
     // HTTP Server
     bool isWebUIEnabled() const;
@@ -193,12 +201,16 @@ public:
     void setWebUIUsername(const QString &username);
     QByteArray getWebUIPassword() const;
     void setWebUIPassword(const QByteArray &password);
+    QByteArray getWebUIAPIKeyHash() const;
+    void setWebUIAPIKeyHash(const QByteArray &apiKeyHash);
     int getWebUIMaxAuthFailCount() const;
     void setWebUIMaxAuthFailCount(int count);
     std::chrono::seconds getWebUIBanDuration() const;
     void setWebUIBanDuration(std::chrono::seconds duration);
     int getWebUISessionTimeout() const;
     void setWebUISessionTimeout(int timeout);
+    int getWebUIMaxConnections() const;
+    void setWebUIMaxConnections(int count);
     QString getWebAPISessionCookieName() const;
     void setWebAPISessionCookieName(const QString &cookieName);
 
@@ -219,6 +231,8 @@ public:
     void setWebUIHttpsCertificatePath(const Path &path);
     Path getWebUIHttpsKeyPath() const;
     void setWebUIHttpsKeyPath(const Path &path);
+    bool isWebUIHttp2Enabled() const;
+    void setWebUIHttp2Enabled(bool enabled);
     bool isAltWebUIEnabled() const;
     void setAltWebUIEnabled(bool enabled);
     Path getWebUIRootFolder() const;
@@ -266,6 +280,10 @@ public:
     bool isAutoRunConsoleEnabled() const;
     void setAutoRunConsoleEnabled(bool enabled);
 #endif
+    int autoRunMaxConcurrentPrograms() const;
+    void setAutoRunMaxConcurrentPrograms(int count);
+    bool isAutoRunBatchModeEnabled() const;
+    void setAutoRunBatchModeEnabled(bool enabled);
 
     bool shutdownWhenDownloadsComplete() const;
     void setShutdownWhenDownloadsComplete(bool shutdown);
@@ -297,6 +315,8 @@ public:
     void setMarkOfTheWebEnabled(bool enabled);
     bool isIgnoreSSLErrors() const;
     void setIgnoreSSLErrors(bool enabled);
+    int getDownloadConnectionsPerHost() const;
+    void setDownloadConnectionsPerHost(int value);
     Path getPythonExecutablePath() const;
     void setPythonExecutablePath(const Path &path);
 #if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
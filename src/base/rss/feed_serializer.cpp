@@ -31,6 +31,9 @@
 
 #include "feed_serializer.h"
 
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -38,19 +41,55 @@
 
 #include "base/logger.h"
 #include "base/path.h"
+#include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "rss_article.h"
 
 const int ARTICLEDATALIST_TYPEID = qRegisterMetaType<QVector<QVariantHash>>();
 
-void RSS::Private::FeedSerializer::load(const Path &dataFileName, const QString &url)
+namespace
 {
+    const quint32 LOG_MAGIC = 0x71625253; // "qbRS"
+    const quint32 LOG_VERSION = 1;
+    const QDataStream::Version LOG_STREAM_VERSION = QDataStream::Qt_6_0;
+
+    void writeLogEntry(QDataStream &stream, const RSS::Private::ArticleLogEntry &entry)
+    {
+        using RSS::Private::ArticleLogEntry;
+
+        stream << static_cast<quint8>(entry.type);
+        if ((entry.type == ArticleLogEntry::Type::Add) || (entry.type == ArticleLogEntry::Type::SetFeedProperties))
+            stream << entry.data;
+        else
+            stream << entry.guid;
+    }
+}
+
+void RSS::Private::FeedSerializer::load(const Path &dataFileName, const Path &legacyDataFileName, const QString &url)
+{
+    if (!dataFileName.exists() && legacyDataFileName.exists())
+    {
+        const auto readResult = Utils::IO::readFile(legacyDataFileName, -1);
+        if (!readResult)
+        {
+            LogMsg(tr("Failed to read RSS session data. %1").arg(readResult.error().message), Log::WARNING);
+            return;
+        }
+
+        const QVector<QVariantHash> articles = loadArticles(readResult.value(), url);
+        const bool isStored = store(dataFileName, articles);
+        if (isStored)
+            Utils::Fs::removeFile(legacyDataFileName);
+        emit loadingFinished(articles, {}, (isStored ? articles.size() : 0));
+        return;
+    }
+
     const auto readResult = Utils::IO::readFile(dataFileName, -1);
     if (!readResult)
     {
         if (readResult.error().status == Utils::IO::ReadError::NotExist)
         {
-            emit loadingFinished({});
+            emit loadingFinished({}, {}, 0);
             return;
         }
 
@@ -58,27 +97,168 @@ void RSS::Private::FeedSerializer::load(const Path &dataFileName, const QString
         return;
     }
 
-    emit loadingFinished(loadArticles(readResult.value(), url));
+    QVariantHash feedProperties;
+    qsizetype logSize = 0;
+    const QVector<QVariantHash> articles = loadLog(readResult.value(), url, feedProperties, logSize);
+    emit loadingFinished(articles, feedProperties, logSize);
 }
 
-void RSS::Private::FeedSerializer::store(const Path &dataFileName, const QVector<QVariantHash> &articlesData)
+bool RSS::Private::FeedSerializer::store(const Path &dataFileName, const QVector<QVariantHash> &articlesData
+        , const QVariantHash &feedProperties)
 {
-    QJsonArray arr;
-    for (const QVariantHash &data : articlesData)
-    {
-        auto jsonObj = QJsonObject::fromVariantHash(data);
-        // JSON object doesn't support DateTime so we need to convert it
-        jsonObj[Article::KeyDate] = data[Article::KeyDate].toDateTime().toString(Qt::RFC2822Date);
-
-        arr << jsonObj;
-    }
+    QByteArray data;
+    QDataStream stream {&data, QIODevice::WriteOnly};
+    stream.setVersion(LOG_STREAM_VERSION);
+    stream << LOG_MAGIC << LOG_VERSION;
+    for (const QVariantHash &articleData : articlesData)
+        writeLogEntry(stream, {.type = ArticleLogEntry::Type::Add, .guid = {}, .data = articleData});
+    if (!feedProperties.isEmpty())
+        writeLogEntry(stream, {.type = ArticleLogEntry::Type::SetFeedProperties, .guid = {}, .data = feedProperties});
 
-    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(dataFileName, QJsonDocument(arr).toJson());
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(dataFileName, data);
     if (!result)
     {
        LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(dataFileName.toString(), result.error())
               , Log::WARNING);
+       return false;
+    }
+
+    return true;
+}
+
+void RSS::Private::FeedSerializer::append(const Path &dataFileName, const QVector<ArticleLogEntry> &entries)
+{
+    QByteArray data;
+    QDataStream stream {&data, QIODevice::WriteOnly};
+    stream.setVersion(LOG_STREAM_VERSION);
+    for (const ArticleLogEntry &entry : entries)
+        writeLogEntry(stream, entry);
+
+    QFile file {dataFileName.data()};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || (file.write(data) != data.size()) || !file.flush())
+    {
+       LogMsg(tr("Failed to save RSS feed in '%1', Reason: %2").arg(dataFileName.toString(), file.errorString())
+              , Log::WARNING);
+    }
+}
+
+QVector<QVariantHash> RSS::Private::FeedSerializer::readArticles(const Path &dataFileName, const QString &url)
+{
+    const auto readResult = Utils::IO::readFile(dataFileName, -1);
+    if (!readResult)
+    {
+        LogMsg(tr("Failed to read RSS session data. %1").arg(readResult.error().message), Log::WARNING);
+        return {};
+    }
+
+    QVariantHash feedProperties;
+    qsizetype logSize = 0;
+    return loadLog(readResult.value(), url, feedProperties, logSize);
+}
+
+QVector<QVariantHash> RSS::Private::FeedSerializer::loadLog(const QByteArray &data, const QString &url
+        , QVariantHash &feedProperties, qsizetype &logSize)
+{
+    feedProperties.clear();
+    logSize = 0;
+
+    QDataStream stream {data};
+    stream.setVersion(LOG_STREAM_VERSION);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if ((stream.status() != QDataStream::Ok) || (magic != LOG_MAGIC) || (version != LOG_VERSION))
+    {
+        LogMsg(tr("Couldn't load RSS Session data. Invalid data format."), Log::WARNING);
+        return {};
     }
+
+    QVector<QVariantHash> result;
+    QHash<QString, qsizetype> indexes;  // <GUID, index in result>
+    qsizetype entryCount = 0;
+    bool isCorrupted = false;
+    while (!stream.atEnd())
+    {
+        quint8 type = 0;
+        QString guid;
+        QVariantHash articleData;
+        stream >> type;
+        if ((type == static_cast<quint8>(ArticleLogEntry::Type::Add))
+                || (type == static_cast<quint8>(ArticleLogEntry::Type::SetFeedProperties)))
+        {
+            stream >> articleData;
+        }
+        else
+        {
+            stream >> guid;
+        }
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            isCorrupted = true;
+            break;
+        }
+
+        switch (static_cast<ArticleLogEntry::Type>(type))
+        {
+        case ArticleLogEntry::Type::Add:
+            guid = articleData.value(Article::KeyId).toString();
+            if (const auto indexIter = indexes.constFind(guid); indexIter != indexes.cend())
+            {
+                result[indexIter.value()] = articleData;
+            }
+            else
+            {
+                indexes.insert(guid, result.size());
+                result.push_back(articleData);
+            }
+            break;
+        case ArticleLogEntry::Type::MarkAsRead:
+            if (const auto indexIter = indexes.constFind(guid); indexIter != indexes.cend())
+                result[indexIter.value()][Article::KeyIsRead] = true;
+            break;
+        case ArticleLogEntry::Type::SetFeedProperties:
+            feedProperties.insert(articleData);
+            break;
+        case ArticleLogEntry::Type::Remove:
+            if (const auto indexIter = indexes.find(guid); indexIter != indexes.end())
+            {
+                result[indexIter.value()].clear();
+                indexes.erase(indexIter);
+            }
+            break;
+        default:
+            isCorrupted = true;
+            break;
+        }
+
+        if (isCorrupted)
+            break;
+
+        ++entryCount;
+    }
+
+    if (isCorrupted)
+    {
+        // the log will be rewritten so that new entries aren't appended after corrupted data
+        LogMsg(tr("Couldn't load RSS article '%1#%2'. Invalid data format.")
+               .arg(url, QString::number(entryCount)), Log::WARNING);
+    }
+    else
+    {
+        logSize = entryCount;
+    }
+
+    // removed articles
+    result.removeIf([](const QVariantHash &articleData) { return articleData.isEmpty(); });
+
+    std::sort(result.begin(), result.end(), [](const QVariantHash &left, const QVariantHash &right)
+    {
+        return (left.value(Article::KeyDate).toDateTime() > right.value(Article::KeyDate).toDateTime());
+    });
+
+    return result;
 }
 
 QVector<QVariantHash> RSS::Private::FeedSerializer::loadArticles(const QByteArray &data, const QString &url)
@@ -40,6 +40,23 @@
 
 namespace RSS::Private
 {
+    // Feed articles are stored as the log of changes, so that new or read articles
+    // don't require the whole feed data to be written again.
+    struct ArticleLogEntry
+    {
+        enum class Type : quint8
+        {
+            Add = 1,
+            MarkAsRead = 2,
+            Remove = 3,
+            SetFeedProperties = 4
+        };
+
+        Type type = Type::Add;
+        QString guid;
+        QVariantHash data;  // article data for `Add` entries, feed properties for `SetFeedProperties` ones
+    };
+
     class FeedSerializer final : public QObject
     {
         Q_OBJECT
@@ -48,13 +65,21 @@ namespace RSS::Private
     public:
         using QObject::QObject;
 
-        void load(const Path &dataFileName, const QString &url);
-        void store(const Path &dataFileName, const QVector<QVariantHash> &articlesData);
+        // `legacyDataFileName` is JSON articles file used by previous versions,
+        // it is converted to the log if there is no log yet
+        void load(const Path &dataFileName, const Path &legacyDataFileName, const QString &url);
+        // rewrites the log so that it only contains the given articles and feed properties
+        bool store(const Path &dataFileName, const QVector<QVariantHash> &articlesData, const QVariantHash &feedProperties = {});
+        void append(const Path &dataFileName, const QVector<ArticleLogEntry> &entries);
+        // reads the stored articles without notifying about it
+        QVector<QVariantHash> readArticles(const Path &dataFileName, const QString &url);
 
     signals:
-        void loadingFinished(const QVector<QVariantHash> &articles);
+        // `logSize` is the number of entries in the log, it is 0 if the log should be rewritten
+        void loadingFinished(const QVector<QVariantHash> &articles, const QVariantHash &feedProperties, qsizetype logSize);
 
     private:
         QVector<QVariantHash> loadArticles(const QByteArray &data, const QString &url);
+        QVector<QVariantHash> loadLog(const QByteArray &data, const QString &url, QVariantHash &feedProperties, qsizetype &logSize);
     };
 }
@@ -30,6 +30,7 @@
 
 #include "rss_article.h"
 
+#include <QSet>
 #include <QVariant>
 
 #include "base/global.h"
@@ -53,12 +54,47 @@ Article::Article(Feed *feed, const QVariantHash &varHash)
     , m_date(varHash.value(KeyDate).toDateTime())
     , m_title(varHash.value(KeyTitle).toString())
     , m_author(varHash.value(KeyAuthor).toString())
-    , m_description(varHash.value(KeyDescription).toString())
     , m_torrentURL(varHash.value(KeyTorrentURL).toString())
     , m_link(varHash.value(KeyLink).toString())
     , m_isRead(varHash.value(KeyIsRead, false).toBool())
-    , m_data(varHash)
 {
+    setReleasableData(varHash);
+}
+
+void Article::setReleasableData(const QVariantHash &varHash)
+{
+    static const QSet<QString> standardKeys {KeyId, KeyDate, KeyTitle, KeyAuthor
+        , KeyDescription, KeyTorrentURL, KeyLink, KeyIsRead};
+
+    m_description = varHash.value(KeyDescription).toString();
+    m_extraData.clear();
+    for (auto it = varHash.cbegin(); it != varHash.cend(); ++it)
+    {
+        if (!standardKeys.contains(it.key()))
+            m_extraData.insert(it.key(), it.value());
+    }
+
+    m_isDataReleased = false;
+}
+
+void Article::releaseData()
+{
+    m_description = {};
+    m_extraData = {};
+    m_isDataReleased = true;
+}
+
+bool Article::isDataReleased() const
+{
+    return m_isDataReleased;
+}
+
+qsizetype Article::releasableDataSize() const
+{
+    qsizetype size = m_description.size();
+    for (auto it = m_extraData.cbegin(); it != m_extraData.cend(); ++it)
+        size += it.key().size() + it.value().toString().size();
+    return size * static_cast<qsizetype>(sizeof(QChar));
 }
 
 QString Article::guid() const
@@ -83,6 +119,7 @@ QString Article::author() const
 
 QString Article::description() const
 {
+    m_feed->useArticlesData();
     return m_description;
 }
 
@@ -103,7 +140,25 @@ bool Article::isRead() const
 
 QVariantHash Article::data() const
 {
-    return m_data;
+    m_feed->useArticlesData();
+
+    // Absent elements are left out so the data is the same as the one the article was created from
+    QVariantHash data = m_extraData;
+    data.insert(KeyId, m_guid);
+    data.insert(KeyDate, m_date);
+    if (!m_title.isNull())
+        data.insert(KeyTitle, m_title);
+    if (!m_author.isNull())
+        data.insert(KeyAuthor, m_author);
+    if (!m_description.isNull())
+        data.insert(KeyDescription, m_description);
+    if (!m_torrentURL.isNull())
+        data.insert(KeyTorrentURL, m_torrentURL);
+    if (!m_link.isNull())
+        data.insert(KeyLink, m_link);
+    if (m_isRead)
+        data.insert(KeyIsRead, m_isRead);
+    return data;
 }
 
 void Article::markAsRead()
@@ -111,7 +166,6 @@ void Article::markAsRead()
     if (!m_isRead)
     {
         m_isRead = true;
-        m_data[KeyIsRead] = m_isRead;
         emit read(this);
     }
 }
@@ -77,6 +77,13 @@ namespace RSS
         void read(Article *article = nullptr);
 
     private:
+        // Description and extra data take most of the memory, they can be released
+        // while the feed isn't used and loaded again when they are needed
+        void setReleasableData(const QVariantHash &varHash);
+        void releaseData();
+        bool isDataReleased() const;
+        qsizetype releasableDataSize() const;
+
         Feed *m_feed = nullptr;
         QString m_guid;
         QDateTime m_date;
@@ -86,6 +93,7 @@ namespace RSS
         QString m_torrentURL;
         QString m_link;
         bool m_isRead = false;
-        QVariantHash m_data;
+        bool m_isDataReleased = false;
+        QVariantHash m_extraData;  // data of the elements that don't have dedicated fields
     };
 }
@@ -28,6 +28,7 @@
 
 #include "rss_autodownloader.h"
 
+#include <algorithm>
 #include <queue>
 
 #include <QDataStream>
@@ -68,6 +69,35 @@ const QString RULES_FILE_NAME = u"download_rules.json"_s;
 
 namespace
 {
+    // Same torrent can be published by several feeds under different URLs, so the info hash
+    // of magnet links and the title are used to detect it too
+    QStringList articleIdentities(const QVariantHash &articleData)
+    {
+        QStringList identities;
+
+        const QString torrentURL = articleData.value(RSS::Article::KeyTorrentURL).toString();
+        if (!torrentURL.isEmpty())
+        {
+            identities.append(u"url:" + torrentURL);
+            if (torrentURL.startsWith(u"magnet:", Qt::CaseInsensitive))
+            {
+                if (const auto parseResult = BitTorrent::TorrentDescriptor::parse(torrentURL))
+                    identities.append(u"hash:" + parseResult.value().infoHash().toTorrentID().toString());
+            }
+        }
+
+        QString normalizedTitle;
+        for (const QChar c : asConst(articleData.value(RSS::Article::KeyTitle).toString()))
+        {
+            if (c.isLetterOrNumber())
+                normalizedTitle.append(c.toCaseFolded());
+        }
+        if (!normalizedTitle.isEmpty())
+            identities.append(u"title:" + normalizedTitle);
+
+        return identities;
+    }
+
     QVector<RSS::AutoDownloadRule> rulesFromJSON(const QByteArray &jsonData)
     {
         QJsonParseError jsonError;
@@ -107,6 +137,7 @@ AutoDownloader::AutoDownloader(IApplication *app)
     , m_storeProcessingEnabled {u"RSS/AutoDownloader/EnableProcessing"_s, false}
     , m_storeSmartEpisodeFilter {u"RSS/AutoDownloader/SmartEpisodeFilter"_s}
     , m_storeDownloadRepacks {u"RSS/AutoDownloader/DownloadRepacks"_s}
+    , m_storeDuplicateArticlesRetention {u"RSS/AutoDownloader/DuplicateArticlesRetention"_s, 24}
     , m_processingTimer {new QTimer(this)}
     , m_ioThread {new QThread}
 {
@@ -136,6 +167,8 @@ AutoDownloader::AutoDownloader(IApplication *app)
             , QRegularExpression::CaseInsensitiveOption
                     | QRegularExpression::ExtendedPatternSyntaxOption
                     | QRegularExpression::UseUnicodePropertiesOption);
+    // it is compiled once instead of lazily on first match of each article
+    m_smartEpisodeRegex.optimize();
 
     load();
 
@@ -233,6 +266,7 @@ void AutoDownloader::removeRule(const QString &ruleName)
 
     const auto index = m_rulesByName.take(ruleName);
     m_rules.removeAt(index);
+    m_rulesIndexOutdated = true;
     for (qsizetype i = index; i < m_rules.size(); ++i)
     {
         const AutoDownloadRule &rule = m_rules[i];
@@ -325,7 +359,7 @@ QStringList AutoDownloader::smartEpisodeFilters() const
     return filter.toStringList();
 }
 
-QRegularExpression AutoDownloader::smartEpisodeRegex() const
+const QRegularExpression &AutoDownloader::smartEpisodeRegex() const
 {
     return m_smartEpisodeRegex;
 }
@@ -336,6 +370,7 @@ void AutoDownloader::setSmartEpisodeFilters(const QStringList &filters)
 
     const QString regex = computeSmartFilterRegex(filters);
     m_smartEpisodeRegex.setPattern(regex);
+    m_smartEpisodeRegex.optimize();
 }
 
 bool AutoDownloader::downloadRepacks() const
@@ -348,6 +383,18 @@ void AutoDownloader::setDownloadRepacks(const bool enabled)
     m_storeDownloadRepacks = enabled;
 }
 
+int AutoDownloader::duplicateArticlesRetention() const
+{
+    return m_storeDuplicateArticlesRetention;
+}
+
+void AutoDownloader::setDuplicateArticlesRetention(const int hours)
+{
+    m_storeDuplicateArticlesRetention = std::max(0, hours);
+    if (m_storeDuplicateArticlesRetention == 0)
+        m_recentArticles.clear();
+}
+
 void AutoDownloader::process()
 {
     if (m_processingQueue.isEmpty()) // processing was disabled
@@ -376,7 +423,10 @@ void AutoDownloader::handleTorrentAdded(const QString &source)
 
 void AutoDownloader::handleAddTorrentFailed(const QString &source)
 {
-    m_waitingJobs.remove(source);
+    const auto job = m_waitingJobs.take(source);
+    // let the same torrent be downloaded from other feeds
+    if (job)
+        removeRecentArticle(job->articleData);
     // TODO: Re-schedule job here.
 }
 
@@ -396,6 +446,7 @@ void AutoDownloader::handleFeedURLChanged(Feed *feed, const QString &oldURL)
             feedURLs.replace(i, feed->url());
             rule.setFeedURLs(feedURLs);
             m_dirty = true;
+            m_rulesIndexOutdated = true;
         }
     }
 
@@ -427,6 +478,8 @@ void AutoDownloader::setRule_impl(const AutoDownloadRule &rule)
     {
         m_rules[index] = rule;
     }
+
+    m_rulesIndexOutdated = true;
 }
 
 void AutoDownloader::sortRules()
@@ -441,6 +494,51 @@ void AutoDownloader::sortRules()
         const AutoDownloadRule &rule = m_rules[i];
         m_rulesByName[rule.name()] = i;
     }
+
+    m_rulesIndexOutdated = true;
+}
+
+void AutoDownloader::buildRulesIndex()
+{
+    m_rulesByFeedURL.clear();
+    m_rulesByTitleLiteral.clear();
+    m_unfilteredRules = QList<bool>(m_rules.size(), false);
+
+    QStringList literals;
+    QHash<QString, qsizetype> literalIndexes;
+    for (qsizetype i = 0; i < m_rules.size(); ++i)
+    {
+        const AutoDownloadRule &rule = m_rules[i];
+        if (!rule.isEnabled())
+            continue;
+
+        for (const QString &feedURL : asConst(rule.feedURLs()))
+            m_rulesByFeedURL[feedURL].append(i);
+
+        const QStringList ruleLiterals = rule.titleLiterals();
+        if (ruleLiterals.isEmpty())
+        {
+            m_unfilteredRules[i] = true;
+            continue;
+        }
+
+        for (const QString &literal : ruleLiterals)
+        {
+            qsizetype literalIndex = literalIndexes.value(literal, -1);
+            if (literalIndex < 0)
+            {
+                literalIndex = literals.size();
+                literalIndexes.insert(literal, literalIndex);
+                literals.append(literal);
+                m_rulesByTitleLiteral.append({});
+            }
+
+            m_rulesByTitleLiteral[literalIndex].append(i);
+        }
+    }
+
+    m_titleLiteralMatcher = MultiStringMatcher(literals, Qt::CaseInsensitive);
+    m_rulesIndexOutdated = false;
 }
 
 void AutoDownloader::addJobForArticle(const Article *article)
@@ -449,9 +547,13 @@ void AutoDownloader::addJobForArticle(const Article *article)
     if (m_waitingJobs.contains(torrentURL))
         return;
 
+    const QVariantHash articleData = article->data();
+    if (isRecentArticle(articleData))
+        return;
+
     auto job = QSharedPointer<ProcessingJob>::create();
     job->feedURL = article->feed()->url();
-    job->articleData = article->data();
+    job->articleData = articleData;
     m_processingQueue.append(job);
     if (!m_processingTimer->isActive())
         m_processingTimer->start();
@@ -459,12 +561,32 @@ void AutoDownloader::addJobForArticle(const Article *article)
 
 void AutoDownloader::processJob(const QSharedPointer<ProcessingJob> &job)
 {
-    for (AutoDownloadRule &rule : m_rules)
+    if (m_rulesIndexOutdated)
+        buildRulesIndex();
+
+    const QList<qsizetype> feedRules = m_rulesByFeedURL.value(job->feedURL);
+    if (feedRules.isEmpty())
+        return;
+
+    // the same torrent could be downloaded from another feed since the job was queued
+    if (isRecentArticle(job->articleData))
+        return;
+
+    // Only the rules that can match article title are fully evaluated
+    QList<bool> plausibleRules = m_unfilteredRules;
+    const QString articleTitle = job->articleData.value(Article::KeyTitle).toString();
+    for (const qsizetype literalIndex : asConst(m_titleLiteralMatcher.matchedPatterns(articleTitle)))
     {
-        if (!rule.isEnabled())
-            continue;
-        if (!rule.feedURLs().contains(job->feedURL))
+        for (const qsizetype ruleIndex : asConst(m_rulesByTitleLiteral[literalIndex]))
+            plausibleRules[ruleIndex] = true;
+    }
+
+    for (const qsizetype ruleIndex : feedRules)
+    {
+        if (!plausibleRules[ruleIndex])
             continue;
+
+        AutoDownloadRule &rule = m_rules[ruleIndex];
         if (!rule.accepts(job->articleData))
             continue;
 
@@ -476,10 +598,15 @@ void AutoDownloader::processJob(const QSharedPointer<ProcessingJob> &job)
 
         const auto torrentURL = job->articleData.value(Article::KeyTorrentURL).toString();
         app()->addTorrentManager()->addTorrent(torrentURL, rule.addTorrentParams());
+        addRecentArticle(job->articleData);
+
+        Feed *feed = Session::instance()->feedByURL(job->feedURL);
+        if (feed)
+            feed->notifyArticleMatched();
 
         if (BitTorrent::TorrentDescriptor::parse(torrentURL))
         {
-            if (Feed *feed = Session::instance()->feedByURL(job->feedURL))
+            if (feed)
             {
                 if (Article *article = feed->articleByGUID(job->articleData.value(Article::KeyId).toString()))
                     article->markAsRead();
@@ -495,6 +622,40 @@ void AutoDownloader::processJob(const QSharedPointer<ProcessingJob> &job)
     }
 }
 
+bool AutoDownloader::isRecentArticle(const QVariantHash &articleData) const
+{
+    if (m_recentArticles.isEmpty())
+        return false;
+
+    const QDateTime expirationTime = QDateTime::currentDateTime().addSecs(-duplicateArticlesRetention() * 3600LL);
+    for (const QString &identity : asConst(articleIdentities(articleData)))
+    {
+        if (m_recentArticles.value(identity) > expirationTime)
+            return true;
+    }
+
+    return false;
+}
+
+void AutoDownloader::addRecentArticle(const QVariantHash &articleData)
+{
+    if (duplicateArticlesRetention() <= 0)
+        return;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const QDateTime expirationTime = now.addSecs(-duplicateArticlesRetention() * 3600LL);
+    m_recentArticles.removeIf([&expirationTime](const auto &item) { return (item.value() <= expirationTime); });
+
+    for (const QString &identity : asConst(articleIdentities(articleData)))
+        m_recentArticles.insert(identity, now);
+}
+
+void AutoDownloader::removeRecentArticle(const QVariantHash &articleData)
+{
+    for (const QString &identity : asConst(articleIdentities(articleData)))
+        m_recentArticles.remove(identity);
+}
+
 void AutoDownloader::load()
 {
     const qint64 maxFileSize = 10 * 1024 * 1024;
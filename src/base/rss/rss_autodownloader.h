@@ -29,6 +29,7 @@
 #pragma once
 
 #include <QBasicTimer>
+#include <QDateTime>
 #include <QHash>
 #include <QList>
 #include <QObject>
@@ -38,6 +39,7 @@
 
 #include "base/applicationcomponent.h"
 #include "base/exceptions.h"
+#include "base/multistringmatcher.h"
 #include "base/settingvalue.h"
 #include "base/utils/thread.h"
 
@@ -86,11 +88,16 @@ namespace RSS
 
         QStringList smartEpisodeFilters() const;
         void setSmartEpisodeFilters(const QStringList &filters);
-        QRegularExpression smartEpisodeRegex() const;
+        const QRegularExpression &smartEpisodeRegex() const;
 
         bool downloadRepacks() const;
         void setDownloadRepacks(bool enabled);
 
+        // Time (in hours) the downloaded articles are remembered for, so the same torrent found in
+        // other feeds is not downloaded again. 0 means duplicates are not detected.
+        int duplicateArticlesRetention() const;
+        void setDuplicateArticlesRetention(int hours);
+
         bool hasRule(const QString &ruleName) const;
         AutoDownloadRule ruleByName(const QString &ruleName) const;
         QList<AutoDownloadRule> rules() const;
@@ -120,10 +127,14 @@ namespace RSS
         void timerEvent(QTimerEvent *event) override;
         void setRule_impl(const AutoDownloadRule &rule);
         void sortRules();
+        void buildRulesIndex();
         void resetProcessingQueue();
         void startProcessing();
         void addJobForArticle(const Article *article);
         void processJob(const QSharedPointer<ProcessingJob> &job);
+        bool isRecentArticle(const QVariantHash &articleData) const;
+        void addRecentArticle(const QVariantHash &articleData);
+        void removeRecentArticle(const QVariantHash &articleData);
         void load();
         void loadRules(const QByteArray &data);
         void loadRulesLegacy();
@@ -139,14 +150,24 @@ namespace RSS
         CachedSettingValue<bool> m_storeProcessingEnabled;
         SettingValue<QVariant> m_storeSmartEpisodeFilter;
         SettingValue<bool> m_storeDownloadRepacks;
+        CachedSettingValue<int> m_storeDuplicateArticlesRetention;
 
         QTimer *m_processingTimer = nullptr;
         Utils::Thread::UniquePtr m_ioThread;
         AsyncFileStorage *m_fileStorage = nullptr;
         QList<AutoDownloadRule> m_rules;
         QHash<QString, qsizetype> m_rulesByName;
+        // Enabled rules indexed by feed URL and by literals required in article title,
+        // rebuilt when rules are changed
+        bool m_rulesIndexOutdated = true;
+        QHash<QString, QList<qsizetype>> m_rulesByFeedURL;
+        MultiStringMatcher m_titleLiteralMatcher;
+        QList<QList<qsizetype>> m_rulesByTitleLiteral;
+        QList<bool> m_unfilteredRules;
         QList<QSharedPointer<ProcessingJob>> m_processingQueue;
         QHash<QString, QSharedPointer<ProcessingJob>> m_waitingJobs;
+        // identities (torrent URL, info hash and normalized title) of downloaded articles by the time they were downloaded
+        QHash<QString, QDateTime> m_recentArticles;
         bool m_dirty = false;
         QBasicTimer m_savingTimer;
         QRegularExpression m_smartEpisodeRegex;
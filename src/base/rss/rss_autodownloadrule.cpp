@@ -30,7 +30,11 @@
 #include "rss_autodownloadrule.h"
 
 #include <algorithm>
+#include <optional>
+#include <tuple>
 
+#include <QDataStream>
+#include <QDate>
 #include <QDebug>
 #include <QHash>
 #include <QJsonArray>
@@ -52,6 +56,129 @@
 
 namespace
 {
+    // matched episodes are forgotten after this number of days, so history of long running rules doesn't grow infinitely
+    const qint64 MATCHED_EPISODE_MAX_AGE = 2 * 365;
+
+    enum EpisodeRelease : quint8
+    {
+        RegularRelease = 0,
+        RepackRelease = 1,
+        ProperRelease = 2
+    };
+
+    // Episode is identified by the numbers captured by smart episode filter, i.e. season and
+    // episode numbers, dates are stored as year and the number composed of month and day.
+    // Repacks and propers of an episode are stored apart from it.
+    struct EpisodeKey
+    {
+        qint32 season = -1;
+        qint64 episode = 0;
+        quint8 release = RegularRelease;
+
+        friend bool operator==(const EpisodeKey &left, const EpisodeKey &right) = default;
+
+        friend bool operator<(const EpisodeKey &left, const EpisodeKey &right)
+        {
+            return std::tie(left.season, left.episode, left.release) < std::tie(right.season, right.episode, right.release);
+        }
+    };
+
+    std::size_t qHash(const EpisodeKey &key, const std::size_t seed = 0)
+    {
+        return qHashMulti(seed, key.season, key.episode, key.release);
+    }
+
+    void appendNumbers(const QStringView text, QList<qint64> &numbers)
+    {
+        qsizetype start = -1;
+        for (qsizetype i = 0; i <= text.size(); ++i)
+        {
+            const bool isDigit = (i < text.size()) && text[i].isDigit();
+            if (isDigit && (start < 0))
+            {
+                start = i;
+            }
+            else if (!isDigit && (start >= 0))
+            {
+                numbers.append(text.sliced(start, (i - start)).toLongLong());
+                start = -1;
+            }
+        }
+    }
+
+    std::optional<EpisodeKey> makeEpisodeKey(const QList<qint64> &numbers, const quint8 release = RegularRelease)
+    {
+        if (numbers.isEmpty())
+            return std::nullopt;
+
+        if (numbers.size() == 1)
+            return EpisodeKey {.episode = numbers[0], .release = release};
+
+        EpisodeKey key {.season = static_cast<qint32>(numbers[0]), .episode = numbers[1], .release = release};
+        for (qsizetype i = 2; i < numbers.size(); ++i)
+            key.episode = (key.episode * 10000) + numbers[i];
+        return key;
+    }
+
+    // Episode names of the format stored by previous versions, e.g. "1x5-REPACK"
+    std::optional<EpisodeKey> parseEpisodeName(QStringView name)
+    {
+        quint8 release = RegularRelease;
+        if (name.endsWith(u"-PROPER"))
+        {
+            release |= ProperRelease;
+            name.chop(7);
+        }
+        if (name.endsWith(u"-REPACK"))
+        {
+            release |= RepackRelease;
+            name.chop(7);
+        }
+
+        QList<qint64> numbers;
+        appendNumbers(name, numbers);
+        return makeEpisodeKey(numbers, release);
+    }
+
+    // Episodes are stored sorted in binary form, they compress well since most of them differ by episode number only
+    QString serializeMatchedEpisodes(const QHash<EpisodeKey, qint64> &episodes)
+    {
+        if (episodes.isEmpty())
+            return {};
+
+        QList<EpisodeKey> keys = episodes.keys();
+        std::sort(keys.begin(), keys.end());
+
+        QByteArray data;
+        QDataStream out {&data, QIODevice::WriteOnly};
+        for (const EpisodeKey &key : asConst(keys))
+            out << key.season << key.episode << key.release << episodes[key];
+
+        return QString::fromLatin1(qCompress(data).toBase64());
+    }
+
+    QHash<EpisodeKey, qint64> parseMatchedEpisodes(const QString &str)
+    {
+        QHash<EpisodeKey, qint64> episodes;
+        if (str.isEmpty())
+            return episodes;
+
+        const QByteArray data = qUncompress(QByteArray::fromBase64(str.toLatin1()));
+        QDataStream in {data};
+        while (!in.atEnd())
+        {
+            EpisodeKey key;
+            qint64 matchedDay = 0;
+            in >> key.season >> key.episode >> key.release >> matchedDay;
+            if (in.status() != QDataStream::Ok)
+                break;
+
+            episodes.insert(key, matchedDay);
+        }
+
+        return episodes;
+    }
+
     std::optional<bool> toOptionalBool(const QJsonValue &jsonVal)
     {
         if (jsonVal.isBool())
@@ -114,6 +241,7 @@ const QString S_LAST_MATCH = u"lastMatch"_s;
 const QString S_IGNORE_DAYS = u"ignoreDays"_s;
 const QString S_SMART_FILTER = u"smartFilter"_s;
 const QString S_PREVIOUSLY_MATCHED = u"previouslyMatchedEpisodes"_s;
+const QString S_MATCHED_EPISODES = u"matchedEpisodes"_s;
 
 const QString S_SAVE_PATH = u"savePath"_s;
 const QString S_ASSIGNED_CATEGORY = u"assignedCategory"_s;
@@ -141,9 +269,10 @@ namespace RSS
         BitTorrent::AddTorrentParams addTorrentParams;
 
         bool smartFilter = false;
-        QStringList previouslyMatchedEpisodes;
+        // previously matched episodes by the Julian day they were matched on
+        QHash<EpisodeKey, qint64> matchedEpisodes;
 
-        mutable QStringList lastComputedEpisodes;
+        mutable QList<EpisodeKey> lastComputedEpisodes;
         mutable QHash<QString, QRegularExpression> cachedRegexes;
 
         friend bool operator==(const AutoDownloadRuleData &left, const AutoDownloadRuleData &right)
@@ -172,29 +301,18 @@ namespace RSS
 
 using namespace RSS;
 
-QString computeEpisodeName(const QString &article)
+std::optional<EpisodeKey> computeEpisodeKey(const QString &article)
 {
-    const QRegularExpression episodeRegex = AutoDownloader::instance()->smartEpisodeRegex();
-    const QRegularExpressionMatch match = episodeRegex.match(article);
+    const QRegularExpressionMatch match = AutoDownloader::instance()->smartEpisodeRegex().match(article);
 
     // See if we can extract an season/episode number or date from the title
     if (!match.hasMatch())
-        return {};
+        return std::nullopt;
 
-    QStringList ret;
+    QList<qint64> numbers;
     for (int i = 1; i <= match.lastCapturedIndex(); ++i)
-    {
-        const QString cap = match.captured(i);
-
-        if (cap.isEmpty())
-            continue;
-
-        bool isInt = false;
-        const int x = cap.toInt(&isInt);
-
-        ret.append(isInt ? QString::number(x) : cap);
-    }
-    return ret.join(u'x');
+        appendNumbers(match.capturedView(i), numbers);
+    return makeEpisodeKey(numbers);
 }
 
 AutoDownloadRule::AutoDownloadRule(const QString &name)
@@ -253,6 +371,42 @@ bool AutoDownloadRule::matchesExpression(const QString &articleTitle, const QStr
     return true;
 }
 
+QStringList AutoDownloadRule::titleLiterals() const
+{
+    // Regular expressions are not analyzed
+    if (m_dataPtr->useRegex || m_dataPtr->mustContain.isEmpty())
+        return {};
+
+    const QRegularExpression whitespace {u"\\s+"_s};
+    const QRegularExpression wildcardChars {u"[*?\\\\]"_s};
+
+    QStringList literals;
+    literals.reserve(m_dataPtr->mustContain.size());
+    for (const QString &expression : asConst(m_dataPtr->mustContain))
+    {
+        // All the wildcard tokens must match, so the longest literal part of any of them is used
+        QString literal;
+        for (const QString &wildcard : asConst(expression.split(whitespace, Qt::SkipEmptyParts)))
+        {
+            // Character sets are not analyzed, so the rest of the token is ignored
+            const QString token = wildcard.section(u'[', 0, 0);
+            for (const QString &part : asConst(token.split(wildcardChars, Qt::SkipEmptyParts)))
+            {
+                if (part.size() > literal.size())
+                    literal = part;
+            }
+        }
+
+        // An expression without literal parts can match any title
+        if (literal.isEmpty())
+            return {};
+
+        literals.append(literal);
+    }
+
+    return literals;
+}
+
 bool AutoDownloadRule::matchesMustContainExpression(const QString &articleTitle) const
 {
     if (m_dataPtr->mustContain.empty())
@@ -363,12 +517,12 @@ bool AutoDownloadRule::matchesSmartEpisodeFilter(const QString &articleTitle) co
     if (!useSmartFilter())
         return true;
 
-    const QString episodeStr = computeEpisodeName(articleTitle);
-    if (episodeStr.isEmpty())
+    const std::optional<EpisodeKey> episode = computeEpisodeKey(articleTitle);
+    if (!episode)
         return true;
 
     // See if this episode has been downloaded before
-    const bool previouslyMatched = m_dataPtr->previouslyMatchedEpisodes.contains(episodeStr);
+    const bool previouslyMatched = m_dataPtr->matchedEpisodes.contains(*episode);
     if (previouslyMatched)
     {
         if (!AutoDownloader::instance()->downloadRepacks())
@@ -381,27 +535,29 @@ bool AutoDownloadRule::matchesSmartEpisodeFilter(const QString &articleTitle) co
         if (!isRepack && !isProper)
             return false;
 
-        const QString fullEpisodeStr = u"%1%2%3"_s.arg(episodeStr,
-                                                        isRepack ? u"-REPACK" : u"",
-                                                        isProper ? u"-PROPER" : u"");
-        const bool previouslyMatchedFull = m_dataPtr->previouslyMatchedEpisodes.contains(fullEpisodeStr);
+        EpisodeKey fullEpisode = *episode;
+        fullEpisode.release = static_cast<quint8>((isRepack ? RepackRelease : RegularRelease) | (isProper ? ProperRelease : RegularRelease));
+        const bool previouslyMatchedFull = m_dataPtr->matchedEpisodes.contains(fullEpisode);
         if (previouslyMatchedFull)
             return false;
 
-        m_dataPtr->lastComputedEpisodes.append(fullEpisodeStr);
+        m_dataPtr->lastComputedEpisodes.append(fullEpisode);
 
         // If this is a REPACK and PROPER download, add the individual entries to the list
         // so we don't download those
         if (isRepack && isProper)
         {
-            m_dataPtr->lastComputedEpisodes.append(episodeStr + u"-REPACK");
-            m_dataPtr->lastComputedEpisodes.append(episodeStr + u"-PROPER");
+            EpisodeKey releaseEpisode = *episode;
+            releaseEpisode.release = RepackRelease;
+            m_dataPtr->lastComputedEpisodes.append(releaseEpisode);
+            releaseEpisode.release = ProperRelease;
+            m_dataPtr->lastComputedEpisodes.append(releaseEpisode);
         }
 
         return true;
     }
 
-    m_dataPtr->lastComputedEpisodes.append(episodeStr);
+    m_dataPtr->lastComputedEpisodes.append(*episode);
     return true;
 }
 
@@ -437,8 +593,15 @@ bool AutoDownloadRule::accepts(const QVariantHash &articleData)
     // If there's a matched episode string, add that to the previously matched list
     if (!m_dataPtr->lastComputedEpisodes.isEmpty())
     {
-        m_dataPtr->previouslyMatchedEpisodes.append(m_dataPtr->lastComputedEpisodes);
+        const qint64 today = QDate::currentDate().toJulianDay();
+        for (const EpisodeKey &episode : asConst(m_dataPtr->lastComputedEpisodes))
+            m_dataPtr->matchedEpisodes.insert(episode, today);
         m_dataPtr->lastComputedEpisodes.clear();
+
+        m_dataPtr->matchedEpisodes.removeIf([today](const auto &item)
+        {
+            return ((today - item.value()) > MATCHED_EPISODE_MAX_AGE);
+        });
     }
 
     return true;
@@ -472,7 +635,7 @@ QJsonObject AutoDownloadRule::toJsonObject() const
         , {S_LAST_MATCH, lastMatch().toString(Qt::RFC2822Date)}
         , {S_IGNORE_DAYS, ignoreDays()}
         , {S_SMART_FILTER, useSmartFilter()}
-        , {S_PREVIOUSLY_MATCHED, QJsonArray::fromStringList(previouslyMatchedEpisodes())}
+        , {S_MATCHED_EPISODES, serializeMatchedEpisodes(m_dataPtr->matchedEpisodes)}
 
         // TODO: The following code is deprecated. Replace with the commented one after several releases in 4.6.x.
         // === BEGIN DEPRECATED CODE === //
@@ -509,18 +672,25 @@ AutoDownloadRule AutoDownloadRule::fromJsonObject(const QJsonObject &jsonObj, co
         feedURLs << urlVal.toString();
     rule.setFeedURLs(feedURLs);
 
-    const QJsonValue previouslyMatchedVal = jsonObj.value(S_PREVIOUSLY_MATCHED);
-    QStringList previouslyMatched;
-    if (previouslyMatchedVal.isString())
+    // list of episode names is stored by previous versions, it is also sent by WebUI to clear the history
+    if (const QJsonValue previouslyMatchedVal = jsonObj.value(S_PREVIOUSLY_MATCHED); !previouslyMatchedVal.isUndefined())
     {
-        previouslyMatched << previouslyMatchedVal.toString();
+        QStringList previouslyMatched;
+        if (previouslyMatchedVal.isString())
+        {
+            previouslyMatched << previouslyMatchedVal.toString();
+        }
+        else
+        {
+            for (const QJsonValue &val : asConst(previouslyMatchedVal.toArray()))
+                previouslyMatched << val.toString();
+        }
+        rule.setPreviouslyMatchedEpisodes(previouslyMatched);
     }
     else
     {
-        for (const QJsonValue &val : asConst(previouslyMatchedVal.toArray()))
-            previouslyMatched << val.toString();
+        rule.m_dataPtr->matchedEpisodes = parseMatchedEpisodes(jsonObj.value(S_MATCHED_EPISODES).toString());
     }
-    rule.setPreviouslyMatchedEpisodes(previouslyMatched);
 
     // TODO: The following code is deprecated. Replace with the commented one after several releases in 4.6.x.
     // === BEGIN DEPRECATED CODE === //
@@ -735,14 +905,16 @@ void AutoDownloadRule::setUseRegex(const bool enabled)
     m_dataPtr->cachedRegexes.clear();
 }
 
-QStringList AutoDownloadRule::previouslyMatchedEpisodes() const
-{
-    return m_dataPtr->previouslyMatchedEpisodes;
-}
-
 void AutoDownloadRule::setPreviouslyMatchedEpisodes(const QStringList &previouslyMatchedEpisodes)
 {
-    m_dataPtr->previouslyMatchedEpisodes = previouslyMatchedEpisodes;
+    // the episodes are considered to be matched today, they don't have the date they were matched on
+    const qint64 today = QDate::currentDate().toJulianDay();
+    m_dataPtr->matchedEpisodes.clear();
+    for (const QString &episodeName : previouslyMatchedEpisodes)
+    {
+        if (const std::optional<EpisodeKey> episode = parseEpisodeName(episodeName))
+            m_dataPtr->matchedEpisodes.insert(*episode, today);
+    }
 }
 
 QString AutoDownloadRule::episodeFilter() const
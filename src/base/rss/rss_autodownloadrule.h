@@ -81,7 +81,7 @@ namespace RSS
         QString episodeFilter() const;
         void setEpisodeFilter(const QString &e);
 
-        QStringList previouslyMatchedEpisodes() const;
+        // Replaces the history of matched episodes with the episodes of the given names, e.g. "1x5"
         void setPreviouslyMatchedEpisodes(const QStringList &previouslyMatchedEpisodes);
 
         BitTorrent::AddTorrentParams addTorrentParams() const;
@@ -90,6 +90,10 @@ namespace RSS
         bool matches(const QVariantHash &articleData) const;
         bool accepts(const QVariantHash &articleData);
 
+        // Returns literal strings one of which (case insensitively) is contained in the title
+        // of any article the rule matches or empty list if there are no such strings
+        QStringList titleLiterals() const;
+
         friend bool operator==(const AutoDownloadRule &left, const AutoDownloadRule &right);
 
         QJsonObject toJsonObject() const;
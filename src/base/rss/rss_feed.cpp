@@ -32,6 +32,7 @@
 #include "rss_feed.h"
 
 #include <algorithm>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -39,6 +40,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QThreadPool>
 #include <QUrl>
 #include <QVector>
 
@@ -61,9 +63,30 @@ const QString KEY_LASTBUILDDATE = u"lastBuildDate"_s;
 const QString KEY_ISLOADING = u"isLoading"_s;
 const QString KEY_HASERROR = u"hasError"_s;
 const QString KEY_ARTICLES = u"articles"_s;
+const QString KEY_REMOVEDARTICLES = u"removedArticles"_s;
+const QString KEY_READARTICLES = u"readArticles"_s;
+const QString KEY_ETAG = u"eTag"_s;
+const QString KEY_LASTMODIFIED = u"lastModified"_s;
+
+// the articles log is never rewritten while it has less entries
+const qsizetype MIN_COMPACTED_LOG_SIZE = 100;
+// refresh interval of unchanged feed is doubled each time up to 4 times the configured one
+const int MAX_REFRESH_BACKOFF_EXPONENT = 2;
+const std::chrono::hours MATCHED_FEED_PERIOD {24};
 
 using namespace RSS;
 
+namespace
+{
+    QJsonObject articleToJsonObject(const Article *article)
+    {
+        auto articleObj = QJsonObject::fromVariantHash(article->data());
+        // JSON object doesn't support DateTime so we need to convert it
+        articleObj[Article::KeyDate] = article->date().toString(Qt::RFC2822Date);
+        return articleObj;
+    }
+}
+
 Feed::Feed(const QUuid &uid, const QString &url, const QString &path, Session *session)
     : Item(path)
     , m_session(session)
@@ -71,26 +94,28 @@ Feed::Feed(const QUuid &uid, const QString &url, const QString &path, Session *s
     , m_url(url)
 {
     const auto uidHex = QString::fromLatin1(m_uid.toRfc4122().toHex());
-    m_dataFileName = Path(uidHex + u".json");
+    m_dataFileName = Path(uidHex + u".dat");
+    // JSON articles file used before, it is converted to the log when loaded
+    m_legacyDataFileName = Path(uidHex + u".json");
 
     // Move to new file naming scheme (since v4.1.2)
     const QString legacyFilename = Utils::Fs::toValidFileName(m_url, u"_"_s) + u".json";
     const Path storageDir = m_session->dataFileStorage()->storageDir();
-    const Path dataFilePath = storageDir / m_dataFileName;
-    if (!dataFilePath.exists())
-        Utils::Fs::renameFile((storageDir / Path(legacyFilename)), dataFilePath);
+    const Path legacyDataFilePath = storageDir / m_legacyDataFileName;
+    if (!(storageDir / m_dataFileName).exists() && !legacyDataFilePath.exists())
+        Utils::Fs::renameFile((storageDir / Path(legacyFilename)), legacyDataFilePath);
 
     m_iconPath = storageDir / Path(uidHex + u".ico");
+    m_articlesDataUseTimer.start();
 
     m_serializer = new Private::FeedSerializer;
     m_serializer->moveToThread(m_session->workingThread());
     connect(this, &Feed::destroyed, m_serializer, &Private::FeedSerializer::deleteLater);
     connect(m_serializer, &Private::FeedSerializer::loadingFinished, this, &Feed::handleArticleLoadFinished);
 
-    m_parser = new Private::Parser(m_lastBuildDate);
-    m_parser->moveToThread(m_session->workingThread());
-    connect(this, &Feed::destroyed, m_parser, &Private::Parser::deleteLater);
-    connect(m_parser, &Private::Parser::finished, this, &Feed::handleParsingFinished);
+    // Parsing job may still be running when feed is destroyed, so the last owner deletes the parser
+    m_parser.reset(new Private::Parser(m_lastBuildDate), [](Private::Parser *parser) { parser->deleteLater(); });
+    connect(m_parser.get(), &Private::Parser::finished, this, &Feed::handleParsingFinished);
 
     connect(m_session, &Session::maxArticlesPerFeedChanged, this, &Feed::handleMaxArticlesPerFeedChanged);
 
@@ -125,13 +150,13 @@ void Feed::markAsRead()
             article->disconnect(this);
             article->markAsRead();
             --m_unreadCount;
+            appendLogEntry({.type = Private::ArticleLogEntry::Type::MarkAsRead, .guid = article->guid(), .data = {}});
             emit articleRead(article);
         }
     }
 
     if (m_unreadCount != oldUnreadCount)
     {
-        m_dirty = true;
         store();
         emit unreadCountChanged(this);
     }
@@ -139,7 +164,8 @@ void Feed::markAsRead()
 
 void Feed::refresh()
 {
-    if (!m_isInitialized)
+    // Refreshing is deferred until previously downloaded data is processed
+    if (!m_isInitialized || m_isParsing)
     {
         m_pendingRefresh = true;
         return;
@@ -150,7 +176,13 @@ void Feed::refresh()
 
     // NOTE: Should we allow manually refreshing for disabled session?
 
-    m_downloadHandler = Net::DownloadManager::instance()->download(m_url, Preferences::instance()->useProxyForRSS());
+    // Feed data is only downloaded if it has been modified since the last time it was processed.
+    // There is nothing to compare it with if no articles were got from it though.
+    Net::DownloadRequest request {m_url};
+    if (!m_articles.isEmpty())
+        request.eTag(m_eTag).lastModified(m_lastModified);
+
+    m_downloadHandler = Net::DownloadManager::instance()->download(request, Preferences::instance()->useProxyForRSS());
     connect(m_downloadHandler, &Net::DownloadHandler::finished, this, &Feed::handleDownloadFinished);
 
     if (!m_iconPath.exists())
@@ -229,26 +261,46 @@ void Feed::handleDownloadFinished(const Net::DownloadResult &result)
     {
         LogMsg(tr("RSS feed at '%1' is successfully downloaded. Starting to parse it.")
                 .arg(result.url));
-        // Parse the download RSS
-        QMetaObject::invokeMethod(m_parser, [this, data = result.data]()
+        m_pendingETag = result.eTag;
+        m_pendingLastModified = result.lastModified;
+        m_retryAfter = {};
+        // Parse the download RSS, data of already known articles is skipped
+        m_isParsing = true;
+        m_session->parsingThreadPool()->start([parser = m_parser, data = result.data
+                , knownArticleIDs = QSet<QString>(m_articles.keyBegin(), m_articles.keyEnd())]
         {
-            m_parser->parse(data);
+            parser->parse(data, knownArticleIDs);
         });
     }
+    else if (result.status == Net::DownloadStatus::NotModified)
+    {
+        m_isLoading = false;
+        m_hasError = false;
+        m_retryAfter = {};
+        ++m_unchangedRefreshCount;
+
+        LogMsg(tr("RSS feed at '%1' is not modified since last update.").arg(result.url));
+
+        emit refreshFinished(this);
+        emit stateChanged(this);
+    }
     else
     {
         m_isLoading = false;
         m_hasError = true;
+        m_retryAfter = result.retryAfter;
 
         LogMsg(tr("Failed to download RSS feed at '%1'. Reason: %2")
                .arg(result.url, result.errorString), Log::WARNING);
 
+        emit refreshFinished(this);
         emit stateChanged(this);
     }
 }
 
 void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
 {
+    m_isParsing = false;
     m_hasError = !result.error.isEmpty();
 
     if (!result.title.isEmpty() && (title() != result.title))
@@ -269,6 +321,19 @@ void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
     // as possible until we encounter corrupted data. So we can have some articles here
     // even in case of parsing error.
     const int newArticlesCount = updateArticles(result.articles);
+    m_unchangedRefreshCount = (newArticlesCount > 0) ? 0 : (m_unchangedRefreshCount + 1);
+    m_ttl = std::chrono::minutes(result.ttl);
+
+    // Partially parsed data should be processed again next time
+    const QString eTag = m_hasError ? QString() : std::exchange(m_pendingETag, {});
+    const QString lastModified = m_hasError ? QString() : std::exchange(m_pendingLastModified, {});
+    if ((eTag != m_eTag) || (lastModified != m_lastModified))
+    {
+        m_eTag = eTag;
+        m_lastModified = lastModified;
+        appendLogEntry({.type = Private::ArticleLogEntry::Type::SetFeedProperties, .guid = {}, .data = feedProperties()});
+    }
+
     store();
 
     if (m_hasError)
@@ -280,16 +345,24 @@ void Feed::handleParsingFinished(const RSS::Private::ParsingResult &result)
            .arg(url(), QString::number(newArticlesCount)));
 
     m_isLoading = false;
+    emit refreshFinished(this);
     emit stateChanged(this);
+
+    if (m_pendingRefresh)
+    {
+        m_pendingRefresh = false;
+        refresh();
+    }
 }
 
 void Feed::load()
 {
+    const Path storageDir = m_session->dataFileStorage()->storageDir();
     QMetaObject::invokeMethod(m_serializer
             , [serializer = m_serializer, url = m_url
-                , path = (m_session->dataFileStorage()->storageDir() / m_dataFileName)]
+                , path = (storageDir / m_dataFileName), legacyPath = (storageDir / m_legacyDataFileName)]
     {
-        serializer->load(path, url);
+        serializer->load(path, legacyPath, url);
     });
 }
 
@@ -301,6 +374,28 @@ void Feed::store()
     m_dirty = false;
     m_savingTimer.stop();
 
+    const Path dataFilePath = m_session->dataFileStorage()->storageDir() / m_dataFileName;
+
+    // Changes are appended to the log unless it mostly consists of outdated entries
+    // (e.g. of removed articles), then it is rewritten with the current articles only.
+    const qsizetype logSize = m_storedLogSize + m_pendingLogEntries.size();
+    if ((m_storedLogSize > 0) && (logSize <= std::max<qsizetype>((2 * m_articles.size()), MIN_COMPACTED_LOG_SIZE)))
+    {
+        if (!m_pendingLogEntries.isEmpty())
+        {
+            QMetaObject::invokeMethod(m_serializer
+                    , [entries = std::exchange(m_pendingLogEntries, {}), serializer = m_serializer, path = dataFilePath]
+            {
+                serializer->append(path, entries);
+            });
+            m_storedLogSize = logSize;
+        }
+        return;
+    }
+
+    m_pendingLogEntries.clear();
+    m_storedLogSize = m_articles.size();
+
     QVector<QVariantHash> articlesData;
     articlesData.reserve(m_articles.size());
 
@@ -308,10 +403,9 @@ void Feed::store()
         articlesData.push_back(article->data());
 
     QMetaObject::invokeMethod(m_serializer
-            , [articlesData, serializer = m_serializer
-                , path = (m_session->dataFileStorage()->storageDir() / m_dataFileName)]
+            , [articlesData, feedProperties = feedProperties(), serializer = m_serializer, path = dataFilePath]
     {
-        serializer->store(path, articlesData);
+        serializer->store(path, articlesData, feedProperties);
     });
 }
 
@@ -332,7 +426,7 @@ bool Feed::addArticle(const QVariantHash &articleData)
     if ((lowerBound - m_articlesByDate.begin()) >= maxArticles)
         return false; // we reach max articles
 
-    auto *article = new Article(this, articleData);
+    auto *article = createArticle(articleData);
     m_articles[article->guid()] = article;
     m_articlesByDate.insert(lowerBound, article);
     if (!article->isRead())
@@ -341,7 +435,7 @@ bool Feed::addArticle(const QVariantHash &articleData)
         connect(article, &Article::read, this, &Feed::handleArticleRead);
     }
 
-    m_dirty = true;
+    appendLogEntry({.type = Private::ArticleLogEntry::Type::Add, .guid = article->guid(), .data = articleData});
     emit newArticle(article);
 
     if (m_articlesByDate.size() > maxArticles)
@@ -357,6 +451,7 @@ void Feed::removeOldestArticle()
 
     m_articles.remove(oldestArticle->guid());
     m_articlesByDate.removeLast();
+    appendLogEntry({.type = Private::ArticleLogEntry::Type::Remove, .guid = oldestArticle->guid(), .data = {}});
     const bool isRead = oldestArticle->isRead();
     delete oldestArticle;
 
@@ -364,6 +459,34 @@ void Feed::removeOldestArticle()
         decreaseUnreadCount();
 }
 
+Article *Feed::createArticle(const QVariantHash &articleData)
+{
+    auto *article = new Article(this, articleData);
+
+    // articles of the same feed usually have the same author, so single copy of it is shared by all of them
+    if (!article->m_author.isEmpty())
+    {
+        const auto sharedAuthorIter = m_sharedStrings.constFind(article->m_author);
+        if (sharedAuthorIter != m_sharedStrings.cend())
+            article->m_author = *sharedAuthorIter;
+        else
+            m_sharedStrings.insert(article->m_author);
+    }
+
+    return article;
+}
+
+void Feed::appendLogEntry(Private::ArticleLogEntry entry)
+{
+    m_pendingLogEntries.append(std::move(entry));
+    m_dirty = true;
+}
+
+QVariantHash Feed::feedProperties() const
+{
+    return {{KEY_ETAG, m_eTag}, {KEY_LASTMODIFIED, m_lastModified}};
+}
+
 void Feed::increaseUnreadCount()
 {
     ++m_unreadCount;
@@ -385,7 +508,7 @@ void Feed::downloadIcon()
     const QUrl url(m_url);
     const auto iconUrl = u"%1://%2/favicon.ico"_s.arg(url.scheme(), url.host());
     Net::DownloadManager::instance()->download(
-            Net::DownloadRequest(iconUrl).saveToFile(true).destFileName(m_iconPath)
+            Net::DownloadRequest(iconUrl).saveToFile(true).destFileName(m_iconPath).priority(Net::DownloadPriority::Low)
             , Preferences::instance()->useProxyForRSS(), this, &Feed::handleIconDownloadFinished);
 }
 
@@ -466,9 +589,104 @@ void Feed::setURL(const QString &url)
 {
     const QString oldURL = m_url;
     m_url = url;
+    // validators of the old URL data mean nothing for the new one
+    if (!m_eTag.isEmpty() || !m_lastModified.isEmpty())
+    {
+        m_eTag.clear();
+        m_lastModified.clear();
+        appendLogEntry({.type = Private::ArticleLogEntry::Type::SetFeedProperties, .guid = {}, .data = feedProperties()});
+    }
+    m_unchangedRefreshCount = 0;
+    m_ttl = {};
+    m_retryAfter = {};
     emit urlChanged(oldURL);
 }
 
+void Feed::useArticlesData()
+{
+    m_articlesDataUseTimer.start();
+    if (!m_isArticlesDataReleased)
+        return;
+
+    m_isArticlesDataReleased = false;
+
+    // Blocking call is processed after all the writes of the feed data queued before
+    const Path dataFilePath = m_session->dataFileStorage()->storageDir() / m_dataFileName;
+    QVector<QVariantHash> articlesData;
+    QMetaObject::invokeMethod(m_serializer, [serializer = m_serializer, &dataFilePath, url = m_url, &articlesData]
+    {
+        articlesData = serializer->readArticles(dataFilePath, url);
+    }, Qt::BlockingQueuedConnection);
+
+    for (const QVariantHash &articleData : asConst(articlesData))
+    {
+        Article *article = m_articles.value(articleData.value(Article::KeyId).toString());
+        if (article && article->isDataReleased())
+            article->setReleasableData(articleData);
+    }
+
+    // Data of some articles may be missing if the feed data couldn't be stored
+    for (Article *article : asConst(m_articles))
+    {
+        if (article->isDataReleased())
+            article->setReleasableData({});
+    }
+}
+
+bool Feed::releaseArticlesData()
+{
+    if (m_isArticlesDataReleased || isLoading())
+        return false;
+
+    // Released data is loaded from the stored feed data later
+    store();
+
+    for (Article *article : asConst(m_articles))
+        article->releaseData();
+    m_isArticlesDataReleased = true;
+    return true;
+}
+
+qsizetype Feed::articlesDataSize() const
+{
+    if (m_isArticlesDataReleased)
+        return 0;
+
+    return std::accumulate(m_articles.cbegin(), m_articles.cend(), qsizetype(0), [](const qsizetype acc, const Article *article)
+    {
+        return (acc + article->releasableDataSize());
+    });
+}
+
+qsizetype Feed::estimatedArticlesMemoryUsage() const
+{
+    // articles are kept by GUID and by date, the data released while unused is only kept on disk
+    const qsizetype articleSize = sizeof(Article) + (3 * sizeof(void *)) + sizeof(QString);
+    return (m_articles.size() * articleSize) + articlesDataSize();
+}
+
+std::chrono::milliseconds Feed::articlesDataIdleTime() const
+{
+    return std::chrono::milliseconds(m_articlesDataUseTimer.elapsed());
+}
+
+void Feed::notifyArticleMatched()
+{
+    m_matchedPeriod.setRemainingTime(MATCHED_FEED_PERIOD);
+}
+
+std::chrono::seconds Feed::nextRefreshDelay() const
+{
+    std::chrono::seconds delay = std::chrono::minutes(m_session->refreshInterval());
+    if (!m_matchedPeriod.hasExpired())
+        delay /= 2;
+    else
+        delay *= (1 << std::min(m_unchangedRefreshCount, MAX_REFRESH_BACKOFF_EXPONENT));
+
+    // feed asks not to be refreshed sooner
+    return std::max({delay, m_ttl, m_retryAfter});
+}
+
 QJsonValue Feed::toJsonValue(const bool withData) const
 {
     QJsonObject jsonObj;
@@ -484,18 +702,37 @@ QJsonValue Feed::toJsonValue(const bool withData) const
 
         QJsonArray jsonArr;
         for (Article *article : asConst(m_articles))
-        {
-            auto articleObj = QJsonObject::fromVariantHash(article->data());
-            // JSON object doesn't support DateTime so we need to convert it
-            articleObj[Article::KeyDate] = article->date().toString(Qt::RFC2822Date);
-            jsonArr.append(articleObj);
-        }
+            jsonArr.append(articleToJsonObject(article));
         jsonObj.insert(KEY_ARTICLES, jsonArr);
     }
 
     return jsonObj;
 }
 
+QJsonValue Feed::toJsonValue(const ArticleChanges &changes) const
+{
+    QJsonObject jsonObj = toJsonValue(false).toObject();
+    jsonObj.insert(KEY_TITLE, title());
+    jsonObj.insert(KEY_LASTBUILDDATE, lastBuildDate());
+    jsonObj.insert(KEY_ISLOADING, isLoading());
+    jsonObj.insert(KEY_HASERROR, hasError());
+
+    QJsonArray addedArticles;
+    for (const QString &guid : changes.added)
+    {
+        if (const Article *article = articleByGUID(guid))
+            addedArticles.append(articleToJsonObject(article));
+    }
+    jsonObj.insert(KEY_ARTICLES, addedArticles);
+
+    if (!changes.removed.isEmpty())
+        jsonObj.insert(KEY_REMOVEDARTICLES, QJsonArray::fromStringList(changes.removed.values()));
+    if (!changes.read.isEmpty())
+        jsonObj.insert(KEY_READARTICLES, QJsonArray::fromStringList(changes.read.values()));
+
+    return jsonObj;
+}
+
 void Feed::handleSessionProcessingEnabledChanged(const bool enabled)
 {
     if (enabled)
@@ -512,15 +749,19 @@ void Feed::handleArticleRead(Article *article)
     decreaseUnreadCount();
     emit articleRead(article);
     // will be stored deferred
-    m_dirty = true;
+    appendLogEntry({.type = Private::ArticleLogEntry::Type::MarkAsRead, .guid = article->guid(), .data = {}});
     storeDeferred();
 }
 
-void Feed::handleArticleLoadFinished(QVector<QVariantHash> articles)
+void Feed::handleArticleLoadFinished(QVector<QVariantHash> articles, const QVariantHash &feedProperties, const qsizetype logSize)
 {
     Q_ASSERT(m_articles.isEmpty());
     Q_ASSERT(m_unreadCount == 0);
 
+    m_storedLogSize = logSize;
+    m_eTag = feedProperties.value(KEY_ETAG).toString();
+    m_lastModified = feedProperties.value(KEY_LASTMODIFIED).toString();
+
     const int maxArticles = m_session->maxArticlesPerFeed();
     if (articles.size() > maxArticles)
         articles.resize(maxArticles);
@@ -534,7 +775,7 @@ void Feed::handleArticleLoadFinished(QVector<QVariantHash> articles)
         if (m_articles.contains(articleID)) [[unlikely]]
             continue;
 
-        auto *article = new Article(this, articleData);
+        auto *article = createArticle(articleData);
         m_articles[articleID] = article;
         m_articlesByDate.append(article);
         if (!article->isRead())
@@ -563,7 +804,9 @@ void Feed::cleanup()
 {
     m_dirty = false;
     m_savingTimer.stop();
+    m_pendingLogEntries.clear();
     Utils::Fs::removeFile(m_session->dataFileStorage()->storageDir() / m_dataFileName);
+    Utils::Fs::removeFile(m_session->dataFileStorage()->storageDir() / m_legacyDataFileName);
     Utils::Fs::removeFile(m_iconPath);
 }
 
@@ -31,14 +31,21 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
+
 #include <QtContainerFwd>
 #include <QBasicTimer>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QList>
+#include <QSet>
 #include <QUuid>
 #include <QVariantHash>
 
 #include "base/path.h"
+#include "feed_serializer.h"
 #include "rss_item.h"
 
 class AsyncFileStorage;
@@ -53,10 +60,10 @@ namespace RSS
 {
     class Article;
     class Session;
+    struct ArticleChanges;
 
     namespace Private
     {
-        class FeedSerializer;
         class Parser;
         struct ParsingResult;
     }
@@ -66,6 +73,7 @@ namespace RSS
         Q_OBJECT
         Q_DISABLE_COPY_MOVE(Feed)
 
+        friend class Article;
         friend class Session;
 
         Feed(const QUuid &uid, const QString &url, const QString &path, Session *session);
@@ -86,13 +94,20 @@ namespace RSS
         bool isLoading() const;
         Article *articleByGUID(const QString &guid) const;
         Path iconPath() const;
+        // Feeds that recently provided articles accepted by AutoDownloader are refreshed more often
+        void notifyArticleMatched();
+        // Approximate size of the articles kept in memory
+        qsizetype estimatedArticlesMemoryUsage() const;
 
         QJsonValue toJsonValue(bool withData = false) const override;
+        // the same as toJsonValue(true) but only with the given articles changes
+        QJsonValue toJsonValue(const ArticleChanges &changes) const;
 
     signals:
         void iconLoaded(Feed *feed = nullptr);
         void titleChanged(Feed *feed = nullptr);
         void stateChanged(Feed *feed = nullptr);
+        void refreshFinished(Feed *feed = nullptr);
         void urlChanged(const QString &oldURL);
 
     private slots:
@@ -102,7 +117,7 @@ namespace RSS
         void handleDownloadFinished(const Net::DownloadResult &result);
         void handleParsingFinished(const Private::ParsingResult &result);
         void handleArticleRead(Article *article);
-        void handleArticleLoadFinished(QVector<QVariantHash> articles);
+        void handleArticleLoadFinished(QVector<QVariantHash> articles, const QVariantHash &feedProperties, qsizetype logSize);
 
     private:
         void timerEvent(QTimerEvent *event) override;
@@ -111,15 +126,25 @@ namespace RSS
         void store();
         void storeDeferred();
         bool addArticle(const QVariantHash &articleData);
+        Article *createArticle(const QVariantHash &articleData);
+        void appendLogEntry(Private::ArticleLogEntry entry);
+        QVariantHash feedProperties() const;
         void removeOldestArticle();
         void increaseUnreadCount();
         void decreaseUnreadCount();
         void downloadIcon();
         int updateArticles(const QList<QVariantHash> &loadedArticles);
         void setURL(const QString &url);
+        std::chrono::seconds nextRefreshDelay() const;
+        // loads released articles data back if needed
+        void useArticlesData();
+        bool releaseArticlesData();
+        qsizetype articlesDataSize() const;
+        std::chrono::milliseconds articlesDataIdleTime() const;
 
         Session *m_session = nullptr;
-        Private::Parser *m_parser = nullptr;
+        // Parser is only used by one parsing job at a time, so consecutive feed data is processed in order
+        std::shared_ptr<Private::Parser> m_parser;
         Private::FeedSerializer *m_serializer = nullptr;
         const QUuid m_uid;
         QString m_url;
@@ -129,11 +154,28 @@ namespace RSS
         bool m_isLoading = false;
         bool m_isInitialized = false;
         bool m_pendingRefresh = false;
+        bool m_isParsing = false;
         QHash<QString, Article *> m_articles;
         QList<Article *> m_articlesByDate;
         int m_unreadCount = 0;
         Path m_iconPath;
         Path m_dataFileName;
+        Path m_legacyDataFileName;
+        QVector<Private::ArticleLogEntry> m_pendingLogEntries;
+        qsizetype m_storedLogSize = 0;
+        QSet<QString> m_sharedStrings;
+        // HTTP validators of the last successfully processed feed data
+        QString m_eTag;
+        QString m_lastModified;
+        QString m_pendingETag;
+        QString m_pendingLastModified;
+        // automatic refresh scheduling
+        int m_unchangedRefreshCount = 0;
+        std::chrono::seconds m_ttl {0};
+        std::chrono::seconds m_retryAfter {0};
+        QDeadlineTimer m_matchedPeriod;
+        bool m_isArticlesDataReleased = false;
+        QElapsedTimer m_articlesDataUseTimer;
         QBasicTimer m_savingTimer;
         bool m_dirty = false;
         Net::DownloadHandler *m_downloadHandler = nullptr;
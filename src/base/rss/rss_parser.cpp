@@ -38,6 +38,7 @@
 #include <QXmlStreamReader>
 
 #include "base/global.h"
+#include "base/tracing.h"
 #include "rss_article.h"
 
 namespace
@@ -544,8 +545,11 @@ RSS::Private::Parser::Parser(const QString &lastBuildDate)
 }
 
 // read and create items from a rss document
-void RSS::Private::Parser::parse(const QByteArray &feedData)
+void RSS::Private::Parser::parse(const QByteArray &feedData, const QSet<QString> &knownArticleIDs)
 {
+    QBT_TRACE_SCOPE("RSS::Parser::parse");
+
+    m_knownArticleIDs = knownArticleIDs;
     QXmlStreamReader xml {feedData};
     m_fallbackDate = QDateTime::currentDateTime();
     XmlStreamEntityResolver resolver;
@@ -596,13 +600,16 @@ void RSS::Private::Parser::parse(const QByteArray &feedData)
     emit finished(m_result);
     m_result.articles.clear();
     m_result.error.clear();
+    m_result.ttl = 0;
     m_articleIDs.clear();
+    m_knownArticleIDs.clear();
 }
 
 void RSS::Private::Parser::parseRssArticle(QXmlStreamReader &xml)
 {
     QVariantHash article;
     QString altTorrentUrl;
+    bool isKnown = false;
 
     while (!xml.atEnd())
     {
@@ -614,7 +621,12 @@ void RSS::Private::Parser::parseRssArticle(QXmlStreamReader &xml)
 
         if (xml.isStartElement())
         {
-            if (name == u"title")
+            if (isKnown)
+            {
+                // Data of known article isn't used anyway
+                xml.skipCurrentElement();
+            }
+            else if (name == u"title")
             {
                 article[Article::KeyTitle] = xml.readElementText().trimmed();
             }
@@ -647,7 +659,9 @@ void RSS::Private::Parser::parseRssArticle(QXmlStreamReader &xml)
             }
             else if (name == u"guid")
             {
-                article[Article::KeyId] = xml.readElementText().trimmed();
+                const QString id = xml.readElementText().trimmed();
+                article[Article::KeyId] = id;
+                isKnown = m_knownArticleIDs.contains(id);
             }
             else
             {
@@ -687,6 +701,13 @@ void RSS::Private::Parser::parseRSSChannel(QXmlStreamReader &xml)
                     m_result.lastBuildDate = lastBuildDate;
                 }
             }
+            else if (xml.name() == u"ttl")
+            {
+                bool ok = false;
+                const int ttl = xml.readElementText().trimmed().toInt(&ok);
+                if (ok && (ttl > 0))
+                    m_result.ttl = ttl;
+            }
             else if (xml.name() == u"item")
             {
                 parseRssArticle(xml);
@@ -699,6 +720,7 @@ void RSS::Private::Parser::parseAtomArticle(QXmlStreamReader &xml)
 {
     QVariantHash article;
     bool doubleContent = false;
+    bool isKnown = false;
 
     while (!xml.atEnd())
     {
@@ -710,7 +732,12 @@ void RSS::Private::Parser::parseAtomArticle(QXmlStreamReader &xml)
 
         if (xml.isStartElement())
         {
-            if (name == u"title")
+            if (isKnown)
+            {
+                // Data of known article isn't used anyway
+                xml.skipCurrentElement();
+            }
+            else if (name == u"title")
             {
                 article[Article::KeyTitle] = xml.readElementText().trimmed();
             }
@@ -767,7 +794,9 @@ void RSS::Private::Parser::parseAtomArticle(QXmlStreamReader &xml)
             }
             else if (name == u"id")
             {
-                article[Article::KeyId] = xml.readElementText().trimmed();
+                const QString id = xml.readElementText().trimmed();
+                article[Article::KeyId] = id;
+                isKnown = m_knownArticleIDs.contains(id);
             }
             else
             {
@@ -847,5 +876,10 @@ void RSS::Private::Parser::addArticle(QVariantHash article)
     }
 
     m_articleIDs.insert(localId.toString());
+
+    // Known article only marks its position among the others
+    if (m_knownArticleIDs.contains(localId.toString()))
+        article = QVariantHash {{Article::KeyId, localId.toString()}};
+
     m_result.articles.prepend(article);
 }
@@ -45,6 +45,7 @@ namespace RSS::Private
         QString error;
         QString lastBuildDate;
         QString title;
+        int ttl = 0; // minutes
         QList<QVariantHash> articles;
     };
 
@@ -55,7 +56,8 @@ namespace RSS::Private
 
     public:
         explicit Parser(const QString &lastBuildDate);
-        void parse(const QByteArray &feedData);
+        // Data of articles with known IDs is not extracted, they are only reported by ID
+        void parse(const QByteArray &feedData, const QSet<QString> &knownArticleIDs = {});
 
     signals:
         void finished(const RSS::Private::ParsingResult &result);
@@ -71,6 +73,7 @@ namespace RSS::Private
         QString m_baseUrl;
         ParsingResult m_result;
         QSet<QString> m_articleIDs;
+        QSet<QString> m_knownArticleIDs;
     };
 }
 
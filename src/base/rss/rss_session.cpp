@@ -31,8 +31,11 @@
 
 #include "rss_session.h"
 
+#include <algorithm>
 #include <chrono>
+#include <vector>
 
+#include <QDateTime>
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -43,10 +46,12 @@
 #include "../asyncfilestorage.h"
 #include "../global.h"
 #include "../logger.h"
+#include "../memoryusage.h"
 #include "../profile.h"
 #include "../settingsstorage.h"
 #include "../utils/fs.h"
 #include "../utils/io.h"
+#include "../utils/random.h"
 #include "rss_article.h"
 #include "rss_feed.h"
 #include "rss_folder.h"
@@ -56,6 +61,14 @@ const QString CONF_FOLDER_NAME = u"rss"_s;
 const QString DATA_FOLDER_NAME = u"rss/articles"_s;
 const QString FEEDS_FILE_NAME = u"feeds.json"_s;
 
+// initial refreshes are spread over this period (or refresh interval if it is shorter)
+const std::chrono::minutes INITIAL_REFRESH_SPREAD {2};
+const std::chrono::hours MAX_REFRESH_TIMER_INTERVAL {1};
+const std::chrono::minutes ARTICLES_DATA_CACHE_CHECK_INTERVAL {1};
+const qsizetype MAX_ARTICLE_CHANGES = 10000;
+// data of recently used feed is never released
+const std::chrono::minutes MIN_ARTICLES_DATA_IDLE_TIME {10};
+
 using namespace RSS;
 
 QPointer<Session> Session::m_instance = nullptr;
@@ -65,12 +78,19 @@ Session::Session()
     , m_storeRefreshInterval(u"RSS/Session/RefreshInterval"_s, 30)
     , m_storeFetchDelay(u"RSS/Session/FetchDelay"_s, 2)
     , m_storeMaxArticlesPerFeed(u"RSS/Session/MaxArticlesPerFeed"_s, 50)
+    , m_storeParsingThreadCount(u"RSS/Session/ParsingThreads"_s, 2)
+    , m_storeArticlesDataCacheSize(u"RSS/Session/ArticlesDataCacheSize"_s, 32)
+    , m_storeStorageFlushLatency(u"RSS/Session/StorageFlushLatency"_s, 500)
     , m_workingThread(new QThread)
 {
+    m_parsingThreadPool.setObjectName(u"RSS::Session m_parsingThreadPool"_s);
+    m_parsingThreadPool.setMaxThreadCount(std::max(1, parsingThreadCount()));
+
     Q_ASSERT(!m_instance); // only one instance is allowed
     m_instance = this;
 
     m_confFileStorage = new AsyncFileStorage(specialFolderLocation(SpecialFolder::Config) / Path(CONF_FOLDER_NAME));
+    m_confFileStorage->setFlushLatency(storageFlushLatency());
     m_confFileStorage->moveToThread(m_workingThread.get());
     connect(m_workingThread.get(), &QThread::finished, m_confFileStorage, &AsyncFileStorage::deleteLater);
     connect(m_confFileStorage, &AsyncFileStorage::failed, [](const Path &fileName, const QString &errorString)
@@ -80,6 +100,7 @@ Session::Session()
     });
 
     m_dataFileStorage = new AsyncFileStorage(specialFolderLocation(SpecialFolder::Data) / Path(DATA_FOLDER_NAME));
+    m_dataFileStorage->setFlushLatency(storageFlushLatency());
     m_dataFileStorage->moveToThread(m_workingThread.get());
     connect(m_workingThread.get(), &QThread::finished, m_dataFileStorage, &AsyncFileStorage::deleteLater);
     connect(m_dataFileStorage, &AsyncFileStorage::failed, [](const Path &fileName, const QString &errorString)
@@ -90,15 +111,45 @@ Session::Session()
 
     m_itemsByPath.insert(u""_s, new Folder); // root folder
 
+    // Revisions start from the current time, so the ones known by clients
+    // since the previous run can't be mistaken for the new ones
+    m_articlesRevision = QDateTime::currentMSecsSinceEpoch();
+    m_articleChangesStartRevision = m_articlesRevision;
+    connect(rootFolder(), &Item::newArticle, this, [this](const Article *article)
+    {
+        recordArticleChange(article, ArticleChange::Added);
+    });
+    connect(rootFolder(), &Item::articleAboutToBeRemoved, this, [this](const Article *article)
+    {
+        recordArticleChange(article, ArticleChange::Removed);
+    });
+    connect(rootFolder(), &Item::articleRead, this, [this](const Article *article)
+    {
+        recordArticleChange(article, ArticleChange::Read);
+    });
+
     m_workingThread->start();
     load();
 
-    connect(&m_refreshTimer, &QTimer::timeout, this, &Session::refresh);
+    m_refreshTimer.setSingleShot(true);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &Session::processScheduledRefreshes);
     if (isProcessingEnabled())
+        scheduleInitialRefreshes();
+
+    connect(&m_articlesDataCacheTimer, &QTimer::timeout, this, &Session::trimArticlesDataCache);
+    m_articlesDataCacheTimer.start(ARTICLES_DATA_CACHE_CHECK_INTERVAL);
+
+    MemoryUsage::registerEstimator(this, [this]() -> QList<MemoryUsage::Entry>
     {
-        m_refreshTimer.start(std::chrono::minutes(refreshInterval()));
-        refresh();
-    }
+        qint64 articlesCount = 0;
+        qint64 articlesSize = 0;
+        for (const Feed *feed : asConst(feeds()))
+        {
+            articlesCount += feed->articles().size();
+            articlesSize += feed->estimatedArticlesMemoryUsage();
+        }
+        return {{u"rss.articles"_s, articlesCount, articlesSize}};
+    });
 
     // Remove legacy/corrupted settings
     // (at least on Windows, QSettings is case-insensitive and it can get
@@ -443,6 +494,7 @@ void Session::addItem(Item *item, Folder *destFolder)
         connect(feed, &Feed::titleChanged, this, &Session::handleFeedTitleChanged);
         connect(feed, &Feed::iconLoaded, this, &Session::feedIconLoaded);
         connect(feed, &Feed::stateChanged, this, &Session::feedStateChanged);
+        connect(feed, &Feed::refreshFinished, this, &Session::handleFeedRefreshFinished);
         connect(feed, &Feed::urlChanged, this, [this, feed](const QString &oldURL)
         {
             if (feed->name() == oldURL)
@@ -476,11 +528,11 @@ void Session::setProcessingEnabled(const bool enabled)
         m_storeProcessingEnabled = enabled;
         if (enabled)
         {
-            m_refreshTimer.start(std::chrono::minutes(refreshInterval()));
-            refresh();
+            scheduleInitialRefreshes();
         }
         else
         {
+            m_refreshSchedule.clear();
             m_refreshTimer.stop();
         }
 
@@ -523,7 +575,8 @@ void Session::setRefreshInterval(const int refreshInterval)
     if (m_storeRefreshInterval != refreshInterval)
     {
         m_storeRefreshInterval = refreshInterval;
-        m_refreshTimer.start(std::chrono::minutes(m_storeRefreshInterval));
+        for (Feed *feed : asConst(m_refreshSchedule.keys()))
+            scheduleNextRefresh(feed);
     }
 }
 
@@ -540,11 +593,149 @@ void Session::setFetchDelay(const std::chrono::seconds delay)
     rootFolder()->updateFetchDelay();
 }
 
+std::chrono::milliseconds Session::storageFlushLatency() const
+{
+    return std::chrono::milliseconds(std::max<qint64>(0, m_storeStorageFlushLatency));
+}
+
+void Session::setStorageFlushLatency(const std::chrono::milliseconds latency)
+{
+    if (latency == storageFlushLatency())
+        return;
+
+    m_storeStorageFlushLatency = static_cast<qint64>(latency.count());
+    m_confFileStorage->setFlushLatency(latency);
+    m_dataFileStorage->setFlushLatency(latency);
+}
+
 QThread *Session::workingThread() const
 {
     return m_workingThread.get();
 }
 
+QThreadPool *Session::parsingThreadPool()
+{
+    return &m_parsingThreadPool;
+}
+
+int Session::parsingThreadCount() const
+{
+    return m_storeParsingThreadCount;
+}
+
+void Session::setParsingThreadCount(const int count)
+{
+    if (count == parsingThreadCount())
+        return;
+
+    m_storeParsingThreadCount = count;
+    m_parsingThreadPool.setMaxThreadCount(std::max(1, count));
+}
+
+qint64 Session::articlesRevision() const
+{
+    return m_articlesRevision;
+}
+
+std::optional<QHash<QUuid, ArticleChanges>> Session::articleChanges(const qint64 sinceRevision) const
+{
+    if ((sinceRevision < m_articleChangesStartRevision) || (sinceRevision > m_articlesRevision))
+        return std::nullopt;
+
+    QHash<QUuid, ArticleChanges> changes;
+    const auto firstChangeIter = std::upper_bound(m_articleChanges.cbegin(), m_articleChanges.cend(), sinceRevision
+            , [](const qint64 revision, const ArticleChange &change) { return revision < change.revision; });
+    for (auto it = firstChangeIter; it != m_articleChanges.cend(); ++it)
+    {
+        ArticleChanges &feedChanges = changes[it->feedUID];
+        switch (it->type)
+        {
+        case ArticleChange::Added:
+            feedChanges.added.insert(it->guid);
+            break;
+        case ArticleChange::Removed:
+            // article that was added after the revision is just unknown to the client
+            if (!feedChanges.added.remove(it->guid))
+                feedChanges.removed.insert(it->guid);
+            feedChanges.read.remove(it->guid);
+            break;
+        case ArticleChange::Read:
+            // added article is reported with its current state
+            if (!feedChanges.added.contains(it->guid))
+                feedChanges.read.insert(it->guid);
+            break;
+        }
+    }
+
+    return changes;
+}
+
+void Session::recordArticleChange(const Article *article, const ArticleChange::Type changeType)
+{
+    ++m_articlesRevision;
+    m_articleChanges.append({.revision = m_articlesRevision, .type = changeType, .feedUID = article->feed()->uid(), .guid = article->guid()});
+    if (m_articleChanges.size() > MAX_ARTICLE_CHANGES)
+        m_articleChangesStartRevision = m_articleChanges.takeFirst().revision;
+}
+
+int Session::articlesDataCacheSize() const
+{
+    return m_storeArticlesDataCacheSize;
+}
+
+void Session::setArticlesDataCacheSize(const int size)
+{
+    if (size == articlesDataCacheSize())
+        return;
+
+    m_storeArticlesDataCacheSize = size;
+    trimArticlesDataCache();
+}
+
+void Session::trimArticlesDataCache()
+{
+    const qint64 cacheSize = static_cast<qint64>(articlesDataCacheSize()) * 1024 * 1024;
+    if (cacheSize <= 0)
+        return;
+
+    struct FeedDataUsage
+    {
+        Feed *feed = nullptr;
+        qsizetype dataSize = 0;
+        std::chrono::milliseconds idleTime {0};
+    };
+
+    qint64 totalSize = 0;
+    std::vector<FeedDataUsage> releasableFeeds;
+    for (Feed *feed : asConst(m_feedsByURL))
+    {
+        const qsizetype dataSize = feed->articlesDataSize();
+        totalSize += dataSize;
+
+        const std::chrono::milliseconds idleTime = feed->articlesDataIdleTime();
+        if ((dataSize > 0) && (idleTime >= MIN_ARTICLES_DATA_IDLE_TIME))
+            releasableFeeds.push_back({.feed = feed, .dataSize = dataSize, .idleTime = idleTime});
+    }
+
+    if (totalSize <= cacheSize)
+        return;
+
+    // Least recently used feeds first
+    std::sort(releasableFeeds.begin(), releasableFeeds.end(), [](const FeedDataUsage &left, const FeedDataUsage &right)
+    {
+        return (left.idleTime > right.idleTime);
+    });
+
+    for (const FeedDataUsage &usage : releasableFeeds)
+    {
+        if (totalSize <= cacheSize)
+            break;
+
+        if (usage.feed->releaseArticlesData())
+            totalSize -= usage.dataSize;
+    }
+}
+
 void Session::handleItemAboutToBeDestroyed(Item *item)
 {
     m_itemsByPath.remove(item->path());
@@ -553,6 +744,7 @@ void Session::handleItemAboutToBeDestroyed(Item *item)
     {
         m_feedsByUID.remove(feed->uid());
         m_feedsByURL.remove(feed->url());
+        m_refreshSchedule.remove(feed);
     }
 }
 
@@ -594,3 +786,68 @@ void Session::refresh()
     // NOTE: Should we allow manually refreshing for disabled session?
     rootFolder()->refresh();
 }
+
+void Session::handleFeedRefreshFinished(Feed *feed)
+{
+    if (!isProcessingEnabled())
+        return;
+
+    scheduleNextRefresh(feed);
+}
+
+void Session::scheduleNextRefresh(Feed *feed)
+{
+    // Feeds are refreshed independently of each other, so jitter keeps them from
+    // gathering into bursts of requests when they have the same refresh interval
+    const std::chrono::seconds delay = feed->nextRefreshDelay();
+    const auto jitter = static_cast<uint32_t>(delay.count() / 10);
+    scheduleRefresh(feed, (delay - std::chrono::seconds(jitter) + std::chrono::seconds(Utils::Random::rand(0, (2 * jitter)))));
+}
+
+void Session::scheduleInitialRefreshes()
+{
+    // Refresh feeds soon after startup, but not all at once
+    const std::chrono::milliseconds spread = std::min<std::chrono::milliseconds>(std::chrono::minutes(refreshInterval()), INITIAL_REFRESH_SPREAD);
+    const auto spreadMSecs = static_cast<uint32_t>(spread.count());
+    for (Feed *feed : asConst(feeds()))
+        scheduleRefresh(feed, std::chrono::milliseconds(Utils::Random::rand(0, spreadMSecs)));
+}
+
+void Session::scheduleRefresh(Feed *feed, const std::chrono::milliseconds delay)
+{
+    m_refreshSchedule[feed] = QDeadlineTimer(delay);
+    startRefreshTimer();
+}
+
+void Session::startRefreshTimer()
+{
+    if (m_refreshSchedule.isEmpty())
+    {
+        m_refreshTimer.stop();
+        return;
+    }
+
+    const QDeadlineTimer nextRefresh = *std::min_element(m_refreshSchedule.cbegin(), m_refreshSchedule.cend());
+    // wake up from time to time anyway since timer interval is limited
+    const auto remainingTime = std::chrono::duration_cast<std::chrono::milliseconds>(nextRefresh.remainingTimeAsDuration());
+    m_refreshTimer.start(std::min<std::chrono::milliseconds>(remainingTime, MAX_REFRESH_TIMER_INTERVAL));
+}
+
+void Session::processScheduledRefreshes()
+{
+    QList<Feed *> dueFeeds;
+    for (auto it = m_refreshSchedule.cbegin(); it != m_refreshSchedule.cend(); ++it)
+    {
+        if (it.value().hasExpired())
+            dueFeeds.append(it.key());
+    }
+
+    // feed is scheduled again when it is refreshed
+    for (Feed *feed : asConst(dueFeeds))
+    {
+        m_refreshSchedule.remove(feed);
+        feed->refresh();
+    }
+
+    startRefreshTimer();
+}
@@ -70,10 +70,15 @@
  */
 
 #include <chrono>
+#include <optional>
 
+#include <QDeadlineTimer>
 #include <QHash>
+#include <QList>
 #include <QObject>
 #include <QPointer>
+#include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 
 #include "base/3rdparty/expected.hpp"
@@ -87,10 +92,19 @@ class AsyncFileStorage;
 
 namespace RSS
 {
+    class Article;
     class Feed;
     class Folder;
     class Item;
 
+    // Changes of the feed articles since some revision
+    struct ArticleChanges
+    {
+        QSet<QString> added;
+        QSet<QString> removed;
+        QSet<QString> read;
+    };
+
     class Session final : public QObject
     {
         Q_OBJECT
@@ -108,6 +122,7 @@ namespace RSS
         void setProcessingEnabled(bool enabled);
 
         QThread *workingThread() const;
+        QThreadPool *parsingThreadPool();
         AsyncFileStorage *confFileStorage() const;
         AsyncFileStorage *dataFileStorage() const;
 
@@ -120,6 +135,18 @@ namespace RSS
         std::chrono::seconds fetchDelay() const;
         void setFetchDelay(std::chrono::seconds delay);
 
+        int parsingThreadCount() const;
+        void setParsingThreadCount(int count);
+
+        // Delay of writing the stored files, so repeated updates of them are written once
+        std::chrono::milliseconds storageFlushLatency() const;
+        void setStorageFlushLatency(std::chrono::milliseconds latency);
+
+        // Data of the articles of feeds that aren't used for a while is released
+        // when the total size exceeds this limit (in MiB), 0 means no limit
+        int articlesDataCacheSize() const;
+        void setArticlesDataCacheSize(int size);
+
         nonstd::expected<void, QString> addFolder(const QString &path);
         nonstd::expected<void, QString> addFeed(const QString &url, const QString &path);
         nonstd::expected<void, QString> setFeedURL(const QString &path, const QString &url);
@@ -135,6 +162,12 @@ namespace RSS
 
         Folder *rootFolder() const;
 
+        // Article changes are recorded so that clients can only request the changes since
+        // the revision they know. Changes are grouped by feed UID, std::nullopt is returned
+        // if the changes since given revision aren't available (anymore).
+        qint64 articlesRevision() const;
+        std::optional<QHash<QUuid, ArticleChanges>> articleChanges(qint64 sinceRevision) const;
+
     public slots:
         void refresh();
 
@@ -151,8 +184,25 @@ namespace RSS
     private slots:
         void handleItemAboutToBeDestroyed(Item *item);
         void handleFeedTitleChanged(Feed *feed);
+        void handleFeedRefreshFinished(Feed *feed);
+        void processScheduledRefreshes();
 
     private:
+        struct ArticleChange
+        {
+            enum Type
+            {
+                Added,
+                Removed,
+                Read
+            };
+
+            qint64 revision = 0;
+            Type type = Added;
+            QUuid feedUID;
+            QString guid;
+        };
+
         QUuid generateUID() const;
         void load();
         bool loadFolder(const QJsonObject &jsonObj, Folder *folder);
@@ -162,6 +212,12 @@ namespace RSS
         Folder *addSubfolder(const QString &name, Folder *parentFolder);
         Feed *addFeedToFolder(const QUuid &uid, const QString &url, const QString &name, Folder *parentFolder);
         void addItem(Item *item, Folder *destFolder);
+        void scheduleInitialRefreshes();
+        void scheduleNextRefresh(Feed *feed);
+        void scheduleRefresh(Feed *feed, std::chrono::milliseconds delay);
+        void startRefreshTimer();
+        void trimArticlesDataCache();
+        void recordArticleChange(const Article *article, ArticleChange::Type changeType);
 
         static QPointer<Session> m_instance;
 
@@ -169,10 +225,21 @@ namespace RSS
         CachedSettingValue<int> m_storeRefreshInterval;
         CachedSettingValue<qint64> m_storeFetchDelay;
         CachedSettingValue<int> m_storeMaxArticlesPerFeed;
+        CachedSettingValue<int> m_storeParsingThreadCount;
+        CachedSettingValue<int> m_storeArticlesDataCacheSize;
+        CachedSettingValue<qint64> m_storeStorageFlushLatency;
         Utils::Thread::UniquePtr m_workingThread;
+        QThreadPool m_parsingThreadPool;
         AsyncFileStorage *m_confFileStorage = nullptr;
         AsyncFileStorage *m_dataFileStorage = nullptr;
         QTimer m_refreshTimer;
+        QHash<Feed *, QDeadlineTimer> m_refreshSchedule;
+        QTimer m_articlesDataCacheTimer;
+
+        qint64 m_articlesRevision = 0;
+        // all the changes after this revision are recorded
+        qint64 m_articleChangesStartRevision = 0;
+        QList<ArticleChange> m_articleChanges;
         QHash<QString, Item *> m_itemsByPath;
         QHash<QUuid, Feed *> m_feedsByUID;
         QHash<QString, Feed *> m_feedsByURL;
@@ -38,6 +38,7 @@
 
 #include "base/global.h"
 #include "base/path.h"
+#include "base/preferences.h"
 #include "base/utils/foreignapps.h"
 #include "base/utils/fs.h"
 #include "searchpluginmanager.h"
@@ -58,6 +59,15 @@ namespace
         PL_PUB_DATE,
         NB_PLUGIN_COLUMNS
     };
+
+    void stopProcess(QProcess *process)
+    {
+#ifdef Q_OS_WIN
+        process->kill();
+#else
+        process->terminate();
+#endif
+    }
 }
 
 SearchHandler::SearchHandler(const QString &pattern, const QString &category, const QStringList &usedPlugins, SearchPluginManager *manager)
@@ -66,67 +76,155 @@ SearchHandler::SearchHandler(const QString &pattern, const QString &category, co
     , m_category {category}
     , m_usedPlugins {usedPlugins}
     , m_manager {manager}
-    , m_searchProcess {new QProcess(this)}
     , m_searchTimeout {new QTimer(this)}
 {
-    // Load environment variables (proxy)
-    m_searchProcess->setEnvironment(QProcess::systemEnvironment());
-
-    const QStringList params
+    // Plugins can be run by separate processes, so slow engines don't delay the others
+    // and can be given up on without cancelling the whole search.
+    const Preferences *pref = Preferences::instance();
+    if (const int maxParallelPlugins = pref->searchMaxParallelPlugins(); (maxParallelPlugins > 0) && (m_usedPlugins.size() > 1))
     {
-        Utils::ForeignApps::PYTHON_ISOLATE_MODE_FLAG,
-        (SearchPluginManager::engineLocation() / Path(u"nova2.py"_s)).toString(),
-        m_usedPlugins.join(u','),
-        m_category
-    };
-
-    // Launch search
-    m_searchProcess->setProgram(Utils::ForeignApps::pythonInfo().executableName);
-    m_searchProcess->setArguments(params + m_pattern.split(u' '));
-
-    connect(m_searchProcess, &QProcess::errorOccurred, this, &SearchHandler::processFailed);
-    connect(m_searchProcess, &QProcess::readyReadStandardOutput, this, &SearchHandler::readSearchOutput);
-    connect(m_searchProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished)
-            , this, &SearchHandler::processFinished);
+        m_pendingPlugins = m_usedPlugins;
+        m_maxProcesses = maxParallelPlugins;
+        m_pluginTimeout = std::chrono::seconds(pref->searchPluginTimeout());
+    }
 
     m_searchTimeout->setSingleShot(true);
     connect(m_searchTimeout, &QTimer::timeout, this, &SearchHandler::cancelSearch);
     m_searchTimeout->start(3min);
 
     // deferred start allows clients to handle starting-related signals
-    QMetaObject::invokeMethod(this, [this]() { m_searchProcess->start(QIODevice::ReadOnly); }
-        , Qt::QueuedConnection);
+    QMetaObject::invokeMethod(this, [this]()
+    {
+        if (m_searchCancelled)
+            return;
+
+        if (m_pendingPlugins.isEmpty())
+            startProcess(m_usedPlugins);
+        else
+            startNextProcesses();
+    }, Qt::QueuedConnection);
 }
 
 bool SearchHandler::isActive() const
 {
-    return (m_searchProcess->state() != QProcess::NotRunning);
+    return !m_searchProcesses.isEmpty() || !m_pendingPlugins.isEmpty();
 }
 
 void SearchHandler::cancelSearch()
 {
-    if ((m_searchProcess->state() == QProcess::NotRunning) || m_searchCancelled)
+    if (!isActive() || m_searchCancelled)
         return;
 
-#ifdef Q_OS_WIN
-    m_searchProcess->kill();
-#else
-    m_searchProcess->terminate();
-#endif
     m_searchCancelled = true;
     m_searchTimeout->stop();
+    m_pendingPlugins.clear();
+
+    if (m_searchProcesses.isEmpty())
+    {
+        emit searchFinished(true);
+        return;
+    }
+
+    const QList<QProcess *> processes = m_searchProcesses.keys();
+    for (QProcess *process : processes)
+        stopProcess(process);
+}
+
+void SearchHandler::startNextProcesses()
+{
+    while (!m_pendingPlugins.isEmpty() && (m_searchProcesses.size() < m_maxProcesses))
+        startProcess({m_pendingPlugins.takeFirst()});
+}
+
+void SearchHandler::startProcess(const QStringList &plugins)
+{
+    auto *process = new QProcess(this);
+    // Load environment variables (proxy)
+    process->setEnvironment(QProcess::systemEnvironment());
+
+    const QStringList params
+    {
+        Utils::ForeignApps::PYTHON_ISOLATE_MODE_FLAG,
+        (SearchPluginManager::engineLocation() / Path(u"nova2.py"_s)).toString(),
+        plugins.join(u','),
+        m_category
+    };
+
+    // Launch search
+    process->setProgram(Utils::ForeignApps::pythonInfo().executableName);
+    process->setArguments(params + m_pattern.split(u' '));
+
+    // failure to start is reported synchronously, handle it after the process is registered
+    connect(process, &QProcess::errorOccurred, this, [this, process]() { processFailed(process); }
+            , Qt::QueuedConnection);
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, process]()
+    {
+        const auto iter = m_searchProcesses.find(process);
+        if (iter != m_searchProcesses.end())
+            readSearchOutput(iter.value());
+    });
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished)
+            , this, [this, process](const int exitcode) { processFinished(process, exitcode); });
+
+    SearchProcess searchProcess {.process = process};
+    if (m_pluginTimeout > 0s)
+    {
+        searchProcess.timeout = new QTimer(process);
+        searchProcess.timeout->setSingleShot(true);
+        connect(searchProcess.timeout, &QTimer::timeout, process, [process]() { stopProcess(process); });
+        searchProcess.timeout->start(m_pluginTimeout);
+    }
+    m_searchProcesses.insert(process, searchProcess);
+
+    process->start(QIODevice::ReadOnly);
 }
 
 // Slot called when QProcess is Finished
 // QProcess can be finished for 3 reasons:
 // Error | Stopped by user | Finished normally
-void SearchHandler::processFinished(const int exitcode)
+void SearchHandler::processFinished(QProcess *process, const int exitcode)
 {
+    const auto iter = m_searchProcesses.find(process);
+    if (iter == m_searchProcesses.end())
+        return;
+
+    readSearchOutput(iter.value());
+    removeProcess(process, ((process->exitStatus() == QProcess::NormalExit) && (exitcode == 0)));
+}
+
+void SearchHandler::processFailed(QProcess *process)
+{
+    // the process may be already finished and removed
+    if (!m_searchProcesses.contains(process))
+        return;
+
+    // process which has started will report its finishing
+    if (process->error() == QProcess::FailedToStart)
+        removeProcess(process, false);
+}
+
+void SearchHandler::removeProcess(QProcess *process, const bool succeeded)
+{
+    if (!m_searchProcesses.remove(process))
+        return;
+
+    process->deleteLater();
+    if (succeeded)
+        ++m_succeededProcesses;
+
+    if (!m_searchCancelled)
+        startNextProcesses();
+
+    if (isActive())
+        return;
+
+    // search is finished as soon as the last process is finished,
+    // it is considered failed only if none of the processes succeeded
     m_searchTimeout->stop();
 
     if (m_searchCancelled)
         emit searchFinished(true);
-    else if ((m_searchProcess->exitStatus() == QProcess::NormalExit) && (exitcode == 0))
+    else if (m_succeededProcesses > 0)
         emit searchFinished(false);
     else
         emit searchFailed();
@@ -135,15 +233,18 @@ void SearchHandler::processFinished(const int exitcode)
 // search QProcess return output as soon as it gets new
 // stuff to read. We split it into lines and parse each
 // line to SearchResult calling parseSearchResult().
-void SearchHandler::readSearchOutput()
+void SearchHandler::readSearchOutput(SearchProcess &searchProcess)
 {
-    QByteArray output = m_searchProcess->readAllStandardOutput();
+    QByteArray output = searchProcess.process->readAllStandardOutput();
+    if (output.isEmpty())
+        return;
+
     output.replace('\r', "");
 
     QList<QByteArray> lines = output.split('\n');
-    if (!m_searchResultLineTruncated.isEmpty())
-        lines.prepend(m_searchResultLineTruncated + lines.takeFirst());
-    m_searchResultLineTruncated = lines.takeLast().trimmed();
+    if (!searchProcess.truncatedLine.isEmpty())
+        lines.prepend(searchProcess.truncatedLine + lines.takeFirst());
+    searchProcess.truncatedLine = lines.takeLast().trimmed();
 
     QVector<SearchResult> searchResultList;
     searchResultList.reserve(lines.size());
@@ -155,18 +256,13 @@ void SearchHandler::readSearchOutput()
             searchResultList << searchResult;
     }
 
-    if (!searchResultList.isEmpty())
-    {
-        for (const SearchResult &result : searchResultList)
-            m_results.append(result);
-        emit newSearchResults(searchResultList);
-    }
-}
+    if (searchResultList.isEmpty())
+        return;
 
-void SearchHandler::processFailed()
-{
-    if (!m_searchCancelled)
-        emit searchFailed();
+    // results already received from other engines aren't reported again
+    const QList<SearchResult> newResults = m_results.append(searchResultList);
+    if (!newResults.isEmpty())
+        emit newSearchResults(newResults);
 }
 
 // Parse one line of search results list
@@ -216,7 +312,7 @@ SearchPluginManager *SearchHandler::manager() const
     return m_manager;
 }
 
-QList<SearchResult> SearchHandler::results() const
+const SearchResultStore &SearchHandler::results() const
 {
     return m_results;
 }
@@ -29,29 +29,21 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <QByteArray>
-#include <QDateTime>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QString>
 #include <QtContainerFwd>
 
+#include "searchresult.h"
+#include "searchresultstore.h"
+
 class QProcess;
 class QTimer;
 
-struct SearchResult
-{
-    QString fileName;
-    QString fileUrl;
-    qlonglong fileSize = 0;
-    qlonglong nbSeeders = 0;
-    qlonglong nbLeechers = 0;
-    QString engineName;
-    QString siteUrl;
-    QString descrLink;
-    QDateTime pubDate;
-};
-
 class SearchPluginManager;
 
 class SearchHandler : public QObject
@@ -68,7 +60,7 @@ public:
     bool isActive() const;
     QString pattern() const;
     SearchPluginManager *manager() const;
-    QList<SearchResult> results() const;
+    const SearchResultStore &results() const;
 
     void cancelSearch();
 
@@ -78,18 +70,33 @@ signals:
     void newSearchResults(const QVector<SearchResult> &results);
 
 private:
-    void readSearchOutput();
-    void processFailed();
-    void processFinished(int exitcode);
+    // search process running one or more plugins
+    struct SearchProcess
+    {
+        QProcess *process = nullptr;
+        QTimer *timeout = nullptr;
+        QByteArray truncatedLine;
+    };
+
+    void startNextProcesses();
+    void startProcess(const QStringList &plugins);
+    void readSearchOutput(SearchProcess &searchProcess);
+    void processFailed(QProcess *process);
+    void processFinished(QProcess *process, int exitcode);
+    void removeProcess(QProcess *process, bool succeeded);
     bool parseSearchResult(QStringView line, SearchResult &searchResult);
 
     const QString m_pattern;
     const QString m_category;
     const QStringList m_usedPlugins;
     SearchPluginManager *m_manager = nullptr;
-    QProcess *m_searchProcess = nullptr;
+    // plugins which wait for free process slot, each one runs in its own process
+    QStringList m_pendingPlugins;
+    int m_maxProcesses = 1;
+    std::chrono::seconds m_pluginTimeout {0};
+    QHash<QProcess *, SearchProcess> m_searchProcesses;
     QTimer *m_searchTimeout = nullptr;
-    QByteArray m_searchResultLineTruncated;
     bool m_searchCancelled = false;
-    QList<SearchResult> m_results;
+    int m_succeededProcesses = 0;
+    SearchResultStore m_results;
 };
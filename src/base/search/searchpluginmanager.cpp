@@ -30,13 +30,18 @@
 #include "searchpluginmanager.h"
 
 #include <memory>
+#include <optional>
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QDirIterator>
 #include <QDomDocument>
 #include <QDomElement>
 #include <QDomNode>
 #include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QPointer>
 #include <QProcess>
 #include <QUrl>
@@ -50,11 +55,195 @@
 #include "base/utils/bytearray.h"
 #include "base/utils/foreignapps.h"
 #include "base/utils/fs.h"
+#include "base/utils/io.h"
 #include "searchdownloadhandler.h"
 #include "searchhandler.h"
 
 namespace
 {
+    const int CAPABILITIES_CACHE_MAX_SIZE = 1024 * 1024;
+
+    const QString KEY_NOVA = u"nova"_s;
+    const QString KEY_PYTHON = u"python"_s;
+    const QString KEY_FILES = u"files"_s;
+    const QString KEY_ENGINES = u"engines"_s;
+    const QString KEY_NAME = u"name"_s;
+    const QString KEY_FULL_NAME = u"fullName"_s;
+    const QString KEY_URL = u"url"_s;
+    const QString KEY_CATEGORIES = u"categories"_s;
+
+    struct PluginCapabilities
+    {
+        QString name;
+        QString fullName;
+        QString url;
+        QStringList categories;
+    };
+
+    Path capabilitiesCachePath()
+    {
+        return specialFolderLocation(SpecialFolder::Cache) / Path(u"search_capabilities.json"_s);
+    }
+
+    QString hashFile(const Path &path)
+    {
+        QFile file {path.data()};
+        if (!file.open(QIODevice::ReadOnly))
+            return {};
+
+        QCryptographicHash hash {QCryptographicHash::Sha1};
+        hash.addData(&file);
+        return QString::fromLatin1(hash.result().toHex());
+    }
+
+    // hashes of the plugin files which capabilities query result depends on
+    QHash<QString, QString> hashEngineFiles()
+    {
+        QHash<QString, QString> hashes;
+        QDirIterator iter {SearchPluginManager::pluginsLocation().data(), {u"*.py"_s}, QDir::Files};
+        while (iter.hasNext())
+        {
+            const Path filePath {iter.next()};
+            const QString name = filePath.removedExtension().filename();
+            if (name != u"__init__")
+                hashes[name] = hashFile(filePath);
+        }
+        return hashes;
+    }
+
+    std::optional<QList<PluginCapabilities>> loadCachedCapabilities(const QHash<QString, QString> &fileHashes)
+    {
+        const auto readResult = Utils::IO::readFile(capabilitiesCachePath(), CAPABILITIES_CACHE_MAX_SIZE);
+        if (!readResult)
+            return std::nullopt;
+
+        const QJsonObject cacheObj = QJsonDocument::fromJson(readResult.value()).object();
+        if ((cacheObj.value(KEY_NOVA).toString() != hashFile(SearchPluginManager::engineLocation() / Path(u"nova2.py"_s)))
+            || (cacheObj.value(KEY_PYTHON).toString() != Utils::ForeignApps::pythonInfo().executableName))
+        {
+            return std::nullopt;
+        }
+
+        const QJsonObject filesObj = cacheObj.value(KEY_FILES).toObject();
+        if (filesObj.size() != fileHashes.size())
+            return std::nullopt;
+        for (auto it = fileHashes.cbegin(); it != fileHashes.cend(); ++it)
+        {
+            if (it.value().isEmpty() || (filesObj.value(it.key()).toString() != it.value()))
+                return std::nullopt;
+        }
+
+        const QJsonArray enginesArray = cacheObj.value(KEY_ENGINES).toArray();
+        QList<PluginCapabilities> capabilities;
+        capabilities.reserve(enginesArray.size());
+        for (const QJsonValue &engineVal : enginesArray)
+        {
+            const QJsonObject engineObj = engineVal.toObject();
+            PluginCapabilities engine
+            {
+                .name = engineObj.value(KEY_NAME).toString(),
+                .fullName = engineObj.value(KEY_FULL_NAME).toString(),
+                .url = engineObj.value(KEY_URL).toString()
+            };
+            if (engine.name.isEmpty())
+                return std::nullopt;
+
+            const QJsonArray categoriesArray = engineObj.value(KEY_CATEGORIES).toArray();
+            for (const QJsonValue &cat : categoriesArray)
+                engine.categories.append(cat.toString());
+            capabilities.append(engine);
+        }
+        return capabilities;
+    }
+
+    void storeCachedCapabilities(const QHash<QString, QString> &fileHashes, const QList<PluginCapabilities> &capabilities)
+    {
+        QJsonObject filesObj;
+        for (auto it = fileHashes.cbegin(); it != fileHashes.cend(); ++it)
+            filesObj[it.key()] = it.value();
+
+        QJsonArray enginesArray;
+        for (const PluginCapabilities &engine : capabilities)
+        {
+            enginesArray.append(QJsonObject {
+                {KEY_NAME, engine.name},
+                {KEY_FULL_NAME, engine.fullName},
+                {KEY_URL, engine.url},
+                {KEY_CATEGORIES, QJsonArray::fromStringList(engine.categories)}
+            });
+        }
+
+        const QJsonObject cacheObj
+        {
+            {KEY_NOVA, hashFile(SearchPluginManager::engineLocation() / Path(u"nova2.py"_s))},
+            {KEY_PYTHON, Utils::ForeignApps::pythonInfo().executableName},
+            {KEY_FILES, filesObj},
+            {KEY_ENGINES, enginesArray}
+        };
+
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(capabilitiesCachePath()
+            , QJsonDocument(cacheObj).toJson(QJsonDocument::Compact));
+        if (!result)
+            qWarning() << "Couldn't store search plugins capabilities cache. Error: " << result.error();
+    }
+
+    std::optional<QList<PluginCapabilities>> queryCapabilities()
+    {
+        QProcess nova;
+        nova.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+
+        const QStringList params
+        {
+            Utils::ForeignApps::PYTHON_ISOLATE_MODE_FLAG,
+            (SearchPluginManager::engineLocation() / Path(u"/nova2.py"_s)).toString(),
+            u"--capabilities"_s
+        };
+        nova.start(Utils::ForeignApps::pythonInfo().executableName, params, QIODevice::ReadOnly);
+        nova.waitForFinished();
+
+        const auto capabilities = QString::fromUtf8(nova.readAllStandardOutput());
+        QDomDocument xmlDoc;
+        if (!xmlDoc.setContent(capabilities))
+        {
+            qWarning() << "Could not parse Nova search engine capabilities, msg: " << capabilities.toLocal8Bit().data();
+            qWarning() << "Error: " << nova.readAllStandardError().constData();
+            return std::nullopt;
+        }
+
+        const QDomElement root = xmlDoc.documentElement();
+        if (root.tagName() != u"capabilities")
+        {
+            qWarning() << "Invalid XML file for Nova search engine capabilities, msg: " << capabilities.toLocal8Bit().data();
+            return std::nullopt;
+        }
+
+        QList<PluginCapabilities> result;
+        for (QDomNode engineNode = root.firstChild(); !engineNode.isNull(); engineNode = engineNode.nextSibling())
+        {
+            const QDomElement engineElem = engineNode.toElement();
+            if (engineElem.isNull())
+                continue;
+
+            PluginCapabilities engine
+            {
+                .name = engineElem.tagName(),
+                .fullName = engineElem.elementsByTagName(u"name"_s).at(0).toElement().text(),
+                .url = engineElem.elementsByTagName(u"url"_s).at(0).toElement().text()
+            };
+
+            const QStringList categories = engineElem.elementsByTagName(u"categories"_s).at(0).toElement().text().split(u' ');
+            for (QString cat : categories)
+            {
+                cat = cat.trimmed();
+                if (!cat.isEmpty())
+                    engine.categories << cat;
+            }
+
+            result.append(engine);
+        }
+        return result;
+    }
+
     void clearPythonCache(const Path &path)
     {
         // remove python cache artifacts in `path` and subdirs
@@ -225,7 +414,7 @@ void SearchPluginManager::installPlugin(const QString &source)
     if (Net::DownloadManager::hasSupportedScheme(source))
     {
         using namespace Net;
-        DownloadManager::instance()->download(DownloadRequest(source).saveToFile(true)
+        DownloadManager::instance()->download(DownloadRequest(source).saveToFile(true).streamToFile(true)
                 , Preferences::instance()->useProxyForGeneralPurposes()
                 , this, &SearchPluginManager::pluginDownloadFinished);
     }
@@ -344,7 +533,7 @@ void SearchPluginManager::checkForUpdates()
 {
     // Download version file from update server
     using namespace Net;
-    DownloadManager::instance()->download({m_updateUrl + u"versions.txt"}
+    DownloadManager::instance()->download(DownloadRequest(m_updateUrl + u"versions.txt").priority(DownloadPriority::Low)
             , Preferences::instance()->useProxyForGeneralPurposes()
             , this, &SearchPluginManager::versionInfoDownloadFinished);
 }
@@ -518,71 +707,42 @@ void SearchPluginManager::updateNova()
 
 void SearchPluginManager::update()
 {
-    QProcess nova;
-    nova.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
-
-    const QStringList params
-    {
-        Utils::ForeignApps::PYTHON_ISOLATE_MODE_FLAG,
-        (engineLocation() / Path(u"/nova2.py"_s)).toString(),
-        u"--capabilities"_s
-    };
-    nova.start(Utils::ForeignApps::pythonInfo().executableName, params, QIODevice::ReadOnly);
-    nova.waitForFinished();
-
-    const auto capabilities = QString::fromUtf8(nova.readAllStandardOutput());
-    QDomDocument xmlDoc;
-    if (!xmlDoc.setContent(capabilities))
+    // Querying capabilities requires to start python interpreter and import every plugin
+    // so they are cached and the query is only repeated when some of the files change
+    const QHash<QString, QString> fileHashes = hashEngineFiles();
+    std::optional<QList<PluginCapabilities>> capabilities = loadCachedCapabilities(fileHashes);
+    if (!capabilities)
     {
-        qWarning() << "Could not parse Nova search engine capabilities, msg: " << capabilities.toLocal8Bit().data();
-        qWarning() << "Error: " << nova.readAllStandardError().constData();
-        return;
-    }
+        capabilities = queryCapabilities();
+        if (!capabilities)
+            return;
 
-    const QDomElement root = xmlDoc.documentElement();
-    if (root.tagName() != u"capabilities")
-    {
-        qWarning() << "Invalid XML file for Nova search engine capabilities, msg: " << capabilities.toLocal8Bit().data();
-        return;
+        storeCachedCapabilities(fileHashes, *capabilities);
     }
 
-    for (QDomNode engineNode = root.firstChild(); !engineNode.isNull(); engineNode = engineNode.nextSibling())
+    const QStringList disabledEngines = Preferences::instance()->getSearchEngDisabled();
+    for (const PluginCapabilities &engine : asConst(*capabilities))
     {
-        const QDomElement engineElem = engineNode.toElement();
-        if (!engineElem.isNull())
-        {
-            const QString pluginName = engineElem.tagName();
-
-            auto plugin = std::make_unique<PluginInfo>();
-            plugin->name = pluginName;
-            plugin->version = getPluginVersion(pluginPath(pluginName));
-            plugin->fullName = engineElem.elementsByTagName(u"name"_s).at(0).toElement().text();
-            plugin->url = engineElem.elementsByTagName(u"url"_s).at(0).toElement().text();
-
-            const QStringList categories = engineElem.elementsByTagName(u"categories"_s).at(0).toElement().text().split(u' ');
-            for (QString cat : categories)
-            {
-                cat = cat.trimmed();
-                if (!cat.isEmpty())
-                    plugin->supportedCategories << cat;
-            }
+        auto plugin = std::make_unique<PluginInfo>();
+        plugin->name = engine.name;
+        plugin->version = getPluginVersion(pluginPath(engine.name));
+        plugin->fullName = engine.fullName;
+        plugin->url = engine.url;
+        plugin->supportedCategories = engine.categories;
+        plugin->enabled = !disabledEngines.contains(engine.name);
 
-            const QStringList disabledEngines = Preferences::instance()->getSearchEngDisabled();
-            plugin->enabled = !disabledEngines.contains(pluginName);
+        updateIconPath(plugin.get());
 
-            updateIconPath(plugin.get());
-
-            if (!m_plugins.contains(pluginName))
-            {
-                m_plugins[pluginName] = plugin.release();
-                emit pluginInstalled(pluginName);
-            }
-            else if (m_plugins[pluginName]->version != plugin->version)
-            {
-                delete m_plugins.take(pluginName);
-                m_plugins[pluginName] = plugin.release();
-                emit pluginUpdated(pluginName);
-            }
+        if (!m_plugins.contains(engine.name))
+        {
+            m_plugins[engine.name] = plugin.release();
+            emit pluginInstalled(engine.name);
+        }
+        else if (m_plugins[engine.name]->version != plugin->version)
+        {
+            delete m_plugins.take(engine.name);
+            m_plugins[engine.name] = plugin.release();
+            emit pluginUpdated(engine.name);
         }
     }
 }
@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt and libtorrent.
- * Copyright (C) 2019  sledgehammer999 <hammered999@gmail.com>
+ * Copyright (C) 2026  qBittorrent project
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -28,21 +28,18 @@
 
 #pragma once
 
-#include <QSortFilterProxyModel>
+#include <QDateTime>
+#include <QString>
 
-#include "base/logger.h"
-
-class LogFilterModel final : public QSortFilterProxyModel
+struct SearchResult
 {
-    Q_OBJECT
-    Q_DISABLE_COPY_MOVE(LogFilterModel)
-
-public:
-    explicit LogFilterModel(Log::MsgTypes types = Log::ALL, QObject *parent = nullptr);
-    void setMessageTypes(Log::MsgTypes types);
-
-private:
-    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
-
-    Log::MsgTypes m_types;
+    QString fileName;
+    QString fileUrl;
+    qlonglong fileSize = 0;
+    qlonglong nbSeeders = 0;
+    qlonglong nbLeechers = 0;
+    QString engineName;
+    QString siteUrl;
+    QString descrLink;
+    QDateTime pubDate;
 };
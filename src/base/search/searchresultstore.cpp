@@ -0,0 +1,219 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "searchresultstore.h"
+
+#include <algorithm>
+
+#include <QStringList>
+
+#include "base/global.h"
+
+namespace
+{
+    const QString MAGNET_INFOHASH_PREFIX = u"xt=urn:btih:"_s;
+
+    template <typename T>
+    int threeWayCompare(const T &left, const T &right)
+    {
+        return (left < right) ? -1 : ((right < left) ? 1 : 0);
+    }
+}
+
+bool SearchResultStore::Query::isEmpty() const
+{
+    return (*this == Query());
+}
+
+SearchResultStore::SearchResultStore(const int maxResults)
+    : m_maxResults {maxResults}
+{
+}
+
+QList<SearchResult> SearchResultStore::append(const QList<SearchResult> &results)
+{
+    QList<SearchResult> addedResults;
+    addedResults.reserve(results.size());
+
+    for (const SearchResult &result : results)
+    {
+        if (m_results.size() >= m_maxResults)
+        {
+            ++m_droppedCount;
+            continue;
+        }
+
+        const QString key = dedupKey(result);
+        if (!key.isEmpty())
+        {
+            if (m_keys.contains(key))
+            {
+                ++m_duplicateCount;
+                continue;
+            }
+
+            m_keys.insert(key);
+        }
+
+        m_results.append(result);
+        addedResults.append(result);
+    }
+
+    return addedResults;
+}
+
+int SearchResultStore::size() const
+{
+    return m_results.size();
+}
+
+const SearchResult &SearchResultStore::at(const int index) const
+{
+    return m_results[index];
+}
+
+int SearchResultStore::duplicateCount() const
+{
+    return m_duplicateCount;
+}
+
+int SearchResultStore::droppedCount() const
+{
+    return m_droppedCount;
+}
+
+const QList<int> &SearchResultStore::select(const Query &query) const
+{
+    if (query != m_query)
+    {
+        m_query = query;
+        m_index.clear();
+        m_indexedCount = 0;
+    }
+
+    if (m_indexedCount == m_results.size())
+        return m_index;
+
+    const QStringList nameFilterWords = m_query.nameFilter.split(u' ', Qt::SkipEmptyParts);
+
+    QList<int> newIndexes;
+    for (int i = m_indexedCount; i < m_results.size(); ++i)
+    {
+        if (matches(m_results[i], nameFilterWords))
+            newIndexes.append(i);
+    }
+    m_indexedCount = m_results.size();
+
+    if (m_query.sortColumn == SortColumn::None)
+    {
+        m_index.append(newIndexes);
+        return m_index;
+    }
+
+    const auto compare = [this](const int left, const int right) { return lessThan(left, right); };
+    std::sort(newIndexes.begin(), newIndexes.end(), compare);
+
+    const qsizetype sortedCount = m_index.size();
+    m_index.append(newIndexes);
+    std::inplace_merge(m_index.begin(), (m_index.begin() + sortedCount), m_index.end(), compare);
+
+    return m_index;
+}
+
+QString SearchResultStore::dedupKey(const SearchResult &result)
+{
+    if (result.fileUrl.startsWith(u"magnet:", Qt::CaseInsensitive))
+    {
+        const qsizetype prefixPos = result.fileUrl.indexOf(MAGNET_INFOHASH_PREFIX, 0, Qt::CaseInsensitive);
+        if (prefixPos >= 0)
+        {
+            const qsizetype hashPos = prefixPos + MAGNET_INFOHASH_PREFIX.size();
+            const qsizetype hashEnd = result.fileUrl.indexOf(u'&', hashPos);
+            const QString infoHash = result.fileUrl.mid(hashPos, ((hashEnd < 0) ? -1 : (hashEnd - hashPos)));
+            if (!infoHash.isEmpty())
+                return (u"btih:" + infoHash.toLower());
+        }
+    }
+
+    if (!result.descrLink.isEmpty())
+        return result.descrLink;
+
+    return result.fileUrl;
+}
+
+bool SearchResultStore::matches(const SearchResult &result, const QStringList &nameFilterWords) const
+{
+    if ((m_query.minSeeders >= 0) && (result.nbSeeders < m_query.minSeeders))
+        return false;
+    if ((m_query.minSize >= 0) && (result.fileSize < m_query.minSize))
+        return false;
+    if ((m_query.maxSize >= 0) && (result.fileSize > m_query.maxSize))
+        return false;
+
+    return std::all_of(nameFilterWords.cbegin(), nameFilterWords.cend(), [&result](const QString &word)
+    {
+        return result.fileName.contains(word, Qt::CaseInsensitive);
+    });
+}
+
+bool SearchResultStore::lessThan(const int left, const int right) const
+{
+    const SearchResult &leftResult = m_results[left];
+    const SearchResult &rightResult = m_results[right];
+
+    int result = 0;
+    switch (m_query.sortColumn)
+    {
+    case SortColumn::Name:
+        result = leftResult.fileName.localeAwareCompare(rightResult.fileName);
+        break;
+    case SortColumn::Size:
+        result = threeWayCompare(leftResult.fileSize, rightResult.fileSize);
+        break;
+    case SortColumn::Seeders:
+        result = threeWayCompare(leftResult.nbSeeders, rightResult.nbSeeders);
+        break;
+    case SortColumn::Leechers:
+        result = threeWayCompare(leftResult.nbLeechers, rightResult.nbLeechers);
+        break;
+    case SortColumn::Engine:
+        result = leftResult.engineName.compare(rightResult.engineName, Qt::CaseInsensitive);
+        break;
+    case SortColumn::PubDate:
+        result = threeWayCompare(leftResult.pubDate, rightResult.pubDate);
+        break;
+    case SortColumn::None:
+        break;
+    }
+
+    if (m_query.descending)
+        result = -result;
+
+    // keep the order results were received in for equal values
+    return (result != 0) ? (result < 0) : (left < right);
+}
@@ -0,0 +1,105 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QtContainerFwd>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include "searchresult.h"
+
+// Append-only store of search results. Duplicates (the same torrent reported by several
+// engines or several times by the same engine) are dropped, so are all the results
+// exceeding the limit. Stored results never change their positions, so clients can
+// fetch them incrementally by offset.
+class SearchResultStore
+{
+    Q_DISABLE_COPY_MOVE(SearchResultStore)
+
+public:
+    enum class SortColumn
+    {
+        None,
+        Name,
+        Size,
+        Seeders,
+        Leechers,
+        Engine,
+        PubDate
+    };
+
+    struct Query
+    {
+        // all the words must be contained in result name, case insensitive
+        QString nameFilter;
+        qlonglong minSeeders = -1;
+        qlonglong minSize = -1;
+        qlonglong maxSize = -1;
+        SortColumn sortColumn = SortColumn::None;
+        bool descending = false;
+
+        bool isEmpty() const;
+
+        friend bool operator==(const Query &left, const Query &right) = default;
+    };
+
+    static const int DEFAULT_MAX_RESULTS = 50'000;
+
+    explicit SearchResultStore(int maxResults = DEFAULT_MAX_RESULTS);
+
+    // stores results which aren't duplicates of already stored ones and returns them
+    QList<SearchResult> append(const QList<SearchResult> &results);
+
+    int size() const;
+    const SearchResult &at(int index) const;
+    int duplicateCount() const;
+    int droppedCount() const;
+
+    // Returns indexes of stored results matching the query in requested order.
+    // Index of the last query is kept and only results added since then are merged into it.
+    const QList<int> &select(const Query &query) const;
+
+    // info hash of magnet links, otherwise description or download URL
+    static QString dedupKey(const SearchResult &result);
+
+private:
+    bool matches(const SearchResult &result, const QStringList &nameFilterWords) const;
+    bool lessThan(int left, int right) const;
+
+    int m_maxResults = DEFAULT_MAX_RESULTS;
+    QList<SearchResult> m_results;
+    QSet<QString> m_keys;
+    int m_duplicateCount = 0;
+    int m_droppedCount = 0;
+
+    mutable Query m_query;
+    mutable QList<int> m_index;
+    mutable int m_indexedCount = 0;
+};
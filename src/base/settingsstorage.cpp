@@ -30,34 +30,71 @@
 #include "settingsstorage.h"
 
 #include <chrono>
+#include <filesystem>
 #include <memory>
+#include <optional>
 
+#include <QDataStream>
 #include <QFile>
 #include <QHash>
+#include <QSet>
 
 #include "global.h"
 #include "logger.h"
 #include "path.h"
 #include "profile.h"
 #include "utils/fs.h"
+#include "utils/io.h"
 
 using namespace std::chrono_literals;
 
+namespace
+{
+    const qint64 MAX_SIDECAR_FILE_SIZE = 256 * 1024 * 1024;
+
+    // Values of these keys may be very large lists, so they are kept in separate files.
+    // Changing them doesn't rewrite the whole configuration file and vice versa.
+    const QSet<QString> &sidecarKeys()
+    {
+        static const QSet<QString> keys {
+            u"State/BannedIPs"_s,
+            u"State/BannedIPsExpiration"_s,
+            u"State/ShadowBannedIPs"_s,
+            u"State/ShadowBannedIPsExpiration"_s
+        };
+        return keys;
+    }
+
+    Path sidecarPath(const QString &key)
+    {
+        const QString fileName = QString(key).replace(u'/', u'_') + u".dat";
+        return specialFolderLocation(SpecialFolder::Config) / Path(u"settings"_s) / Path(fileName);
+    }
+}
+
 SettingsStorage *SettingsStorage::m_instance = nullptr;
 
 SettingsStorage::SettingsStorage()
     : m_nativeSettingsName {u"qBittorrent"_s}
 {
+    // writes must not overtake each other
+    m_writer.setMaxThreadCount(1);
+
     readNativeSettings();
+    readSidecarSettings();
 
     m_timer.setSingleShot(true);
     m_timer.setInterval(5s);
     connect(&m_timer, &QTimer::timeout, this, &SettingsStorage::save);
+
+    if (m_dirty || !m_dirtySidecarKeys.isEmpty())
+        m_timer.start();
 }
 
 SettingsStorage::~SettingsStorage()
 {
     save();
+    m_writer.waitForDone();
 }
 
 void SettingsStorage::initInstance()
@@ -79,21 +116,65 @@ SettingsStorage *SettingsStorage::instance()
 
 bool SettingsStorage::save()
 {
-    // return `true` only when settings is different AND is saved successfully
+    // return `true` only when settings is different AND is being saved
+    // settings are snapshotted here and written in background, write failure reschedules saving
 
     const QWriteLocker locker(&m_lock);  // guard for `m_dirty` too
-    if (!m_dirty) return false;
+    if (!m_dirty && m_dirtySidecarKeys.isEmpty())
+        return false;
 
-    if (!writeNativeSettings())
+    WriteJob job;
+    if (m_dirty)
     {
-        m_timer.start();
-        return false;
+        job.settings = m_data;
+        for (const QString &key : sidecarKeys())
+            job.settings->remove(key);
     }
+    for (const QString &key : asConst(m_dirtySidecarKeys))
+        job.sidecarSettings.insert(key, m_data.value(key));
 
     m_dirty = false;
+    m_dirtySidecarKeys.clear();
+
+    m_writer.start([this, nativeSettingsName = m_nativeSettingsName, job = std::move(job)]
+    {
+        std::optional<WriteJob> failedJob;
+
+        if (job.settings && !writeNativeSettings(nativeSettingsName, *job.settings))
+            failedJob.emplace().settings = job.settings;
+
+        for (auto it = job.sidecarSettings.cbegin(); it != job.sidecarSettings.cend(); ++it)
+        {
+            if (!writeSidecarSetting(it.key(), it.value()))
+            {
+                if (!failedJob)
+                    failedJob.emplace();
+                failedJob->sidecarSettings.insert(it.key(), it.value());
+            }
+        }
+
+        if (failedJob)
+        {
+            QMetaObject::invokeMethod(this, [this, failedJob = std::move(*failedJob)]
+            {
+                handleWriteFailed(failedJob);
+            }, Qt::QueuedConnection);
+        }
+    });
+
     return true;
 }
 
+void SettingsStorage::handleWriteFailed(const WriteJob &job)
+{
+    const QWriteLocker locker(&m_lock);
+    if (job.settings)
+        m_dirty = true;
+    for (auto it = job.sidecarSettings.cbegin(); it != job.sidecarSettings.cend(); ++it)
+        m_dirtySidecarKeys.insert(it.key());
+    m_timer.start();
+}
+
 QVariant SettingsStorage::loadValueImpl(const QString &key, const QVariant &defaultValue) const
 {
     const QReadLocker locker(&m_lock);
@@ -106,10 +187,63 @@ void SettingsStorage::storeValueImpl(const QString &key, const QVariant &value)
     QVariant &currentValue = m_data[key];
     if (currentValue != value)
     {
-        m_dirty = true;
+        markDirty(key);
         currentValue = value;
+        ++m_revision;
         m_timer.start();
+        updateSnapshot(key);
+    }
+}
+
+// must be called with write lock held
+void SettingsStorage::markDirty(const QString &key)
+{
+    if (sidecarKeys().contains(key))
+        m_dirtySidecarKeys.insert(key);
+    else
+        m_dirty = true;
+}
+
+int SettingsStorage::registerKeyImpl(const QString &key, const QVariant &defaultValue, Converter converter)
+{
+    const QWriteLocker locker(&m_lock);
+
+    for (const int index : asConst(m_registeredKeyIndexes.value(key)))
+    {
+        if (m_registeredKeys[index].defaultValue == defaultValue)
+            return index;
     }
+
+    const auto snapshot = m_snapshot.load();
+    Snapshot newSnapshot {.version = (snapshot->version + 1), .values = snapshot->values};
+    newSnapshot.values.append(converter(m_data.value(key)));
+
+    const int index = m_registeredKeys.size();
+    m_registeredKeys.append({.name = key, .defaultValue = defaultValue, .converter = std::move(converter)});
+    m_registeredKeyIndexes[key].append(index);
+    m_snapshot.store(std::move(newSnapshot));
+
+    return index;
+}
+
+// must be called with write lock held
+void SettingsStorage::updateSnapshot(const QString &key)
+{
+    const auto indexesIter = m_registeredKeyIndexes.constFind(key);
+    if (indexesIter == m_registeredKeyIndexes.cend())
+        return;
+
+    const auto snapshot = m_snapshot.load();
+    Snapshot newSnapshot {.version = (snapshot->version + 1), .values = snapshot->values};
+    const QVariant value = m_data.value(key);
+    for (const int index : indexesIter.value())
+        newSnapshot.values[index] = m_registeredKeys[index].converter(value);
+    m_snapshot.store(std::move(newSnapshot));
+}
+
+AtomicSnapshot<SettingsStorage::Snapshot>::Pointer SettingsStorage::snapshot() const
+{
+    return m_snapshot.load();
 }
 
 void SettingsStorage::readNativeSettings()
@@ -161,16 +295,90 @@ void SettingsStorage::readNativeSettings()
     }
 }
 
-bool SettingsStorage::writeNativeSettings() const
+void SettingsStorage::readSidecarSettings()
+{
+    for (const QString &key : sidecarKeys())
+    {
+        const Path path = sidecarPath(key);
+        if (!path.exists())
+        {
+            // value stored in configuration file by older version is moved to sidecar file
+            if (m_data.contains(key))
+            {
+                m_dirty = true;
+                m_dirtySidecarKeys.insert(key);
+            }
+            continue;
+        }
+
+        // sidecar file has priority over outdated value in configuration file
+        if (m_data.contains(key))
+            m_dirty = true;
+
+        const auto readResult = Utils::IO::readFile(path, MAX_SIDECAR_FILE_SIZE);
+        if (!readResult)
+        {
+            LogMsg(tr("Failed to load settings file. File: \"%1\". Error: \"%2\"")
+                    .arg(path.toString(), readResult.error().message), Log::WARNING);
+            continue;
+        }
+
+        QDataStream stream {readResult.value()};
+        stream.setVersion(QDataStream::Qt_6_0);
+        QVariant value;
+        stream >> value;
+        if ((stream.status() != QDataStream::Ok) || !value.isValid())
+        {
+            LogMsg(tr("Corrupted settings file. File: \"%1\"").arg(path.toString()), Log::WARNING);
+            continue;
+        }
+
+        m_data[key] = value;
+    }
+}
+
+bool SettingsStorage::writeSidecarSetting(const QString &key, const QVariant &value)
+{
+    const Path path = sidecarPath(key);
+    if (!value.isValid())
+    {
+        if (!path.exists())
+            return true;
+
+        const nonstd::expected<void, QString> result = Utils::Fs::removeFile(path);
+        if (!result)
+        {
+            LogMsg(tr("Failed to remove settings file. File: \"%1\". Error: \"%2\"")
+                    .arg(path.toString(), result.error()), Log::CRITICAL);
+        }
+        return result.has_value();
+    }
+
+    QByteArray data;
+    QDataStream stream {&data, QIODevice::WriteOnly};
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << value;
+
+    // file is replaced atomically
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(path, data);
+    if (!result)
+    {
+        LogMsg(tr("Failed to save settings file. File: \"%1\". Error: \"%2\"")
+                .arg(path.toString(), result.error()), Log::CRITICAL);
+    }
+    return result.has_value();
+}
+
+bool SettingsStorage::writeNativeSettings(const QString &nativeSettingsName, const QVariantHash &data)
 {
-    std::unique_ptr<QSettings> nativeSettings = Profile::instance()->applicationSettings(m_nativeSettingsName + u"_new");
+    std::unique_ptr<QSettings> nativeSettings = Profile::instance()->applicationSettings(nativeSettingsName + u"_new");
 
     // QSettings deletes the file before writing it out. This can result in problems
     // if the disk is full or a power outage occurs. Those events might occur
     // between deleting the file and recreating it. This is a safety measure.
     // Write everything to qBittorrent_new.ini/qBittorrent_new.conf and if it succeeds
     // replace qBittorrent.ini/qBittorrent.conf with it.
-    for (auto i = m_data.begin(); i != m_data.end(); ++i)
+    for (auto i = data.begin(); i != data.end(); ++i)
         nativeSettings->setValue(i.key(), i.value());
 
     nativeSettings->sync(); // Important to get error status
@@ -204,9 +412,17 @@ bool SettingsStorage::writeNativeSettings() const
     const int index = finalPathStr.lastIndexOf(u"_new", -1, Qt::CaseInsensitive);
     finalPathStr.remove(index, 4);
 
+    // replace existing file atomically, so it is never missing
     const Path finalPath {finalPathStr};
-    Utils::Fs::removeFile(finalPath);
-    return Utils::Fs::renameFile(newPath, finalPath);
+    std::error_code ec;
+    std::filesystem::rename(newPath.toStdFsPath(), finalPath.toStdFsPath(), ec);
+    if (ec)
+    {
+        LogMsg(tr("Failed to replace the configuration file. Error: \"%1\"")
+                .arg(QString::fromLocal8Bit(ec.message())), Log::CRITICAL);
+        return false;
+    }
+    return true;
 }
 
 void SettingsStorage::removeValue(const QString &key)
@@ -214,8 +430,10 @@ void SettingsStorage::removeValue(const QString &key)
     const QWriteLocker locker(&m_lock);
     if (m_data.remove(key))
     {
-        m_dirty = true;
+        markDirty(key);
+        ++m_revision;
         m_timer.start();
+        updateSnapshot(key);
     }
 }
 
@@ -230,3 +448,9 @@ bool SettingsStorage::isEmpty() const
     const QReadLocker locker {&m_lock};
     return m_data.isEmpty();
 }
+
+quint64 SettingsStorage::revision() const
+{
+    const QReadLocker locker(&m_lock);
+    return m_revision;
+}
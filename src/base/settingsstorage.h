@@ -30,14 +30,21 @@
 
 #pragma once
 
+#include <functional>
+#include <optional>
 #include <type_traits>
 
+#include <QHash>
+#include <QList>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVariant>
 #include <QVariantHash>
 
+#include "base/atomicsnapshot.h"
 #include "base/concepts/stringable.h"
 #include "utils/string.h"
 
@@ -57,6 +64,14 @@ class SettingsStorage final : public QObject
     ~SettingsStorage();
 
 public:
+    // Immutable copy of the values of registered keys, already converted to their types.
+    // New snapshot is published whenever some registered value changes.
+    struct Snapshot
+    {
+        quint64 version = 0;
+        QList<QVariant> values;
+    };
+
     static void initInstance();
     static void freeInstance();
     static SettingsStorage *instance();
@@ -69,26 +84,9 @@ public:
             // fast path for loading QVariant
             return loadValueImpl(key, defaultValue);
         }
-        else if constexpr (Stringable<T>)
-        {
-            const QString value = loadValue(key, defaultValue.toString());
-            return T {value};
-        }
-        else if constexpr (std::is_enum_v<T>)
-        {
-            const auto value = loadValue<QString>(key);
-            return Utils::String::toEnum(value, defaultValue);
-        }
-        else if constexpr (IsQFlags<T>)
-        {
-            const typename T::Int value = loadValue(key, static_cast<typename T::Int>(defaultValue));
-            return T {value};
-        }
         else
         {
-            const QVariant value = loadValueImpl(key);
-            // check if retrieved value is convertible to T
-            return value.template canConvert<T>() ? value.template value<T>() : defaultValue;
+            return fromVariant(loadValueImpl(key), defaultValue);
         }
     }
 
@@ -110,21 +108,94 @@ public:
     void removeValue(const QString &key);
     bool hasKey(const QString &key) const;
     bool isEmpty() const;
+    // Incremented whenever some stored value changes
+    quint64 revision() const;
+
+    // Registers the key in snapshot and returns index of its value there.
+    // Keys are meant to be registered once, registering the same key again reuses its index.
+    template <typename T>
+    int registerKey(const QString &key, const T &defaultValue = {})
+    {
+        return registerKeyImpl(key, QVariant::fromValue(defaultValue), [defaultValue](const QVariant &value)
+        {
+            return QVariant::fromValue(fromVariant(value, defaultValue));
+        });
+    }
+
+    // can be called from any thread, no locking is involved
+    AtomicSnapshot<Snapshot>::Pointer snapshot() const;
 
 public slots:
     bool save();
 
 private:
+    using Converter = std::function<QVariant (const QVariant &value)>;
+
+    struct RegisteredKey
+    {
+        QString name;
+        QVariant defaultValue;
+        Converter converter;
+    };
+
+    // settings to be written in background
+    struct WriteJob
+    {
+        std::optional<QVariantHash> settings;
+        // invalid value means the setting is removed
+        QVariantHash sidecarSettings;
+    };
+
+    template <typename T>
+    static T fromVariant(const QVariant &value, const T &defaultValue)
+    {
+        if constexpr (std::same_as<T, QVariant>)
+        {
+            return value.isValid() ? value : defaultValue;
+        }
+        else if constexpr (Stringable<T>)
+        {
+            return T {fromVariant(value, defaultValue.toString())};
+        }
+        else if constexpr (std::is_enum_v<T>)
+        {
+            return Utils::String::toEnum(fromVariant<QString>(value, {}), defaultValue);
+        }
+        else if constexpr (IsQFlags<T>)
+        {
+            return T {fromVariant(value, static_cast<typename T::Int>(defaultValue))};
+        }
+        else
+        {
+            // check if retrieved value is convertible to T
+            return value.template canConvert<T>() ? value.template value<T>() : defaultValue;
+        }
+    }
+
     QVariant loadValueImpl(const QString &key, const QVariant &defaultValue = {}) const;
     void storeValueImpl(const QString &key, const QVariant &value);
+    int registerKeyImpl(const QString &key, const QVariant &defaultValue, Converter converter);
+    void updateSnapshot(const QString &key);
+    void markDirty(const QString &key);
+    void handleWriteFailed(const WriteJob &job);
     void readNativeSettings();
-    bool writeNativeSettings() const;
+    void readSidecarSettings();
+    static bool writeNativeSettings(const QString &nativeSettingsName, const QVariantHash &data);
+    static bool writeSidecarSetting(const QString &key, const QVariant &value);
 
     static SettingsStorage *m_instance;
 
     const QString m_nativeSettingsName;
     bool m_dirty = false;
+    // large values which are stored in separate files
+    QSet<QString> m_dirtySidecarKeys;
     QVariantHash m_data;
+    quint64 m_revision = 0;
     QTimer m_timer;
+    QThreadPool m_writer;
     mutable QReadWriteLock m_lock;
+
+    QList<RegisteredKey> m_registeredKeys;
+    QHash<QString, QList<int>> m_registeredKeyIndexes;
+    AtomicSnapshot<Snapshot> m_snapshot;
 };
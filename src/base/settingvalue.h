@@ -63,6 +63,47 @@ private:
     const QString m_keyName;
 };
 
+// Precompiled handle of the setting, its value is read from immutable settings snapshot.
+// Reading is lock-free and can be done from any thread, so use it on hot paths.
+template <typename T>
+class SettingKey
+{
+public:
+    explicit SettingKey(const QString &keyName, const T &defaultValue = {})
+        : m_keyName {keyName}
+        , m_index {SettingsStorage::instance()->registerKey(keyName, defaultValue)}
+    {
+    }
+
+    T get() const
+    {
+        return get(*SettingsStorage::instance()->snapshot());
+    }
+
+    // allows to read several values from the same snapshot
+    T get(const SettingsStorage::Snapshot &snapshot) const
+    {
+        const QVariant &value = snapshot.values[m_index];
+        Q_ASSERT(value.metaType() == QMetaType::fromType<T>());
+        return *static_cast<const T *>(value.constData());
+    }
+
+    operator T() const
+    {
+        return get();
+    }
+
+    SettingKey<T> &operator=(const T &value)
+    {
+        SettingsStorage::instance()->storeValue(m_keyName, value);
+        return *this;
+    }
+
+private:
+    const QString m_keyName;
+    const int m_index;
+};
+
 template <typename T>
 class CachedSettingValue
 {
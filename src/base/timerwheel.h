@@ -0,0 +1,161 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include <QtTypes>
+#include <QList>
+
+// Hierarchical timer wheel for large amounts of coarse deadlines.
+// Time is measured in abstract ticks (e.g. seconds). Each level has 64 slots,
+// every slot of a level spans a whole lower level, so inserting an item is O(1)
+// and items are only moved when their slot of higher level comes due.
+template <typename T>
+class TimerWheel
+{
+public:
+    explicit TimerWheel(const qint64 now = 0)
+        : m_now {now}
+    {
+    }
+
+    qint64 currentTime() const
+    {
+        return m_now;
+    }
+
+    bool isEmpty() const
+    {
+        return (m_count == 0);
+    }
+
+    qsizetype count() const
+    {
+        return m_count;
+    }
+
+    void insert(const T &item, const qint64 deadline)
+    {
+        place({item, deadline});
+        ++m_count;
+    }
+
+    // Advances wheel to `now` returning all the items which deadlines are passed
+    QList<T> advance(const qint64 now)
+    {
+        QList<T> expired;
+
+        if (isEmpty())
+        {
+            m_now = std::max(m_now, now);
+            return expired;
+        }
+
+        while ((m_now < now) && !isEmpty())
+        {
+            ++m_now;
+
+            // cascade due slots of higher levels down, highest ones first
+            for (int level = LEVEL_COUNT - 1; level > 0; --level)
+            {
+                if ((m_now & ((qint64 {1} << (level * SLOT_BITS)) - 1)) == 0)
+                    cascade(m_levels[level][slotIndex(m_now, level)]);
+            }
+            if ((m_now & ((qint64 {1} << (LEVEL_COUNT * SLOT_BITS)) - 1)) == 0)
+                cascade(m_overflow);
+
+            collect(m_due, expired);
+            collect(m_levels[0][slotIndex(m_now, 0)], expired);
+        }
+
+        m_now = std::max(m_now, now);
+        return expired;
+    }
+
+private:
+    struct Entry
+    {
+        T item;
+        qint64 deadline;
+    };
+
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOT_COUNT = 1 << SLOT_BITS;
+    static constexpr int LEVEL_COUNT = 4;
+
+    static int slotIndex(const qint64 time, const int level)
+    {
+        return static_cast<int>((time >> (level * SLOT_BITS)) & (SLOT_COUNT - 1));
+    }
+
+    void place(Entry entry)
+    {
+        if (entry.deadline <= m_now)
+        {
+            m_due.append(std::move(entry));
+            return;
+        }
+
+        for (int level = 0; level < LEVEL_COUNT; ++level)
+        {
+            const int shift = (level + 1) * SLOT_BITS;
+            if ((entry.deadline >> shift) == (m_now >> shift))
+            {
+                m_levels[level][slotIndex(entry.deadline, level)].append(std::move(entry));
+                return;
+            }
+        }
+
+        m_overflow.append(std::move(entry));
+    }
+
+    void cascade(QList<Entry> &slot)
+    {
+        QList<Entry> entries;
+        entries.swap(slot);
+        for (Entry &entry : entries)
+            place(std::move(entry));
+    }
+
+    void collect(QList<Entry> &slot, QList<T> &expired)
+    {
+        for (Entry &entry : slot)
+            expired.append(std::move(entry.item));
+        m_count -= slot.size();
+        slot.clear();
+    }
+
+    qint64 m_now = 0;
+    qsizetype m_count = 0;
+    std::array<std::array<QList<Entry>, SLOT_COUNT>, LEVEL_COUNT> m_levels;
+    QList<Entry> m_overflow;
+    QList<Entry> m_due;
+};
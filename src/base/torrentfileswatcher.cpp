@@ -29,17 +29,32 @@
 
 #include "torrentfileswatcher.h"
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <QtSystemDetection>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 #include <QtAssert>
+#include <QDateTime>
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QFileSystemWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QSet>
+#include <QSocketNotifier>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVariant>
 
@@ -60,7 +75,16 @@
 using namespace std::chrono_literals;
 
 const std::chrono::seconds WATCH_INTERVAL {10};
+// delay for collecting the changes reported by native notifications before they are processed
+const std::chrono::seconds PROCESSING_DELAY {2};
+// natively watched folders are still rescanned from time to time in case some change isn't reported
+const std::chrono::minutes RECONCILIATION_INTERVAL {5};
 const int MAX_FAILED_RETRIES = 5;
+// files modified more recently are considered to be still written, they are parsed once their size and time stay unchanged
+const std::chrono::seconds STABLE_FILE_AGE {2};
+const int MAX_PARSING_THREADS = 4;
+// torrents are passed to the session in batches, so adding of a lot of them doesn't block it for long
+const qsizetype TORRENTS_BATCH_SIZE = 100;
 const QString CONF_FILE_NAME = u"watched_folders.json"_s;
 
 const QString OPTION_ADDTORRENTPARAMS = u"add_torrent_params"_s;
@@ -82,6 +106,120 @@ namespace
         return {{OPTION_ADDTORRENTPARAMS, BitTorrent::serializeAddTorrentParams(options.addTorrentParams)},
                 {OPTION_RECURSIVE, options.recursive}};
     }
+
+    bool isTorrentSourceFile(const Path &filePath)
+    {
+        return filePath.hasExtension(u".torrent"_s) || filePath.hasExtension(u".magnet"_s);
+    }
+
+#ifdef Q_OS_LINUX
+    // Unlike QFileSystemWatcher, which only tells that something in the directory has changed,
+    // it reports names of the entries which were written or moved into the watched directories,
+    // so only those entries need to be processed.
+    class InotifyWatcher final : public QObject
+    {
+        Q_DISABLE_COPY_MOVE(InotifyWatcher)
+
+    public:
+        using EntryAddedHandler = std::function<void (const Path &dirPath, const QString &name, bool isDir)>;
+        using EventsLostHandler = std::function<void ()>;
+
+        InotifyWatcher(EntryAddedHandler entryAddedHandler, EventsLostHandler eventsLostHandler, QObject *parent = nullptr)
+            : QObject(parent)
+            , m_fd {::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)}
+            , m_entryAddedHandler {std::move(entryAddedHandler)}
+            , m_eventsLostHandler {std::move(eventsLostHandler)}
+        {
+            if (m_fd < 0)
+                return;
+
+            m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+            connect(m_notifier, &QSocketNotifier::activated, this, &InotifyWatcher::readEvents);
+        }
+
+        ~InotifyWatcher() override
+        {
+            if (m_fd >= 0)
+                ::close(m_fd);
+        }
+
+        bool isValid() const
+        {
+            return (m_fd >= 0);
+        }
+
+        bool addPath(const Path &dirPath)
+        {
+            if (m_watchesByDir.contains(dirPath))
+                return true;
+
+            const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+            const int wd = ::inotify_add_watch(m_fd, QFile::encodeName(dirPath.data()).constData(), mask);
+            if (wd < 0)
+                return false;
+
+            m_watchesByDir.insert(dirPath, wd);
+            m_dirsByWatch.insert(wd, dirPath);
+            return true;
+        }
+
+        void removePath(const Path &dirPath)
+        {
+            const int wd = m_watchesByDir.take(dirPath);
+            if (wd <= 0)
+                return;
+
+            m_dirsByWatch.remove(wd);
+            ::inotify_rm_watch(m_fd, wd);
+        }
+
+    private:
+        void readEvents()
+        {
+            alignas(inotify_event) char buffer[64 * 1024];
+            ssize_t length = 0;
+            while ((length = ::read(m_fd, buffer, sizeof(buffer))) > 0)
+            {
+                for (const char *ptr = buffer; ptr < (buffer + length);)
+                {
+                    const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+                    ptr += sizeof(inotify_event) + event->len;
+
+                    if (event->mask & IN_Q_OVERFLOW)
+                    {
+                        m_eventsLostHandler();
+                        continue;
+                    }
+
+                    if (event->mask & IN_IGNORED)
+                    {
+                        // watched directory was removed
+                        if (const Path dirPath = m_dirsByWatch.take(event->wd); !dirPath.isEmpty())
+                            m_watchesByDir.remove(dirPath);
+                        continue;
+                    }
+
+                    const Path dirPath = m_dirsByWatch.value(event->wd);
+                    if (dirPath.isEmpty() || (event->len == 0))
+                        continue;
+
+                    // files are only processed once they are written completely,
+                    // while new directories need to be watched right away
+                    const bool isDir = (event->mask & IN_ISDIR);
+                    if (isDir ? (event->mask & (IN_CREATE | IN_MOVED_TO)) : (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+                        m_entryAddedHandler(dirPath, QFile::decodeName(event->name), isDir);
+                }
+            }
+        }
+
+        int m_fd = -1;
+        QSocketNotifier *m_notifier = nullptr;
+        EntryAddedHandler m_entryAddedHandler;
+        EventsLostHandler m_eventsLostHandler;
+        QHash<int, Path> m_dirsByWatch;
+        QHash<Path, int> m_watchesByDir;
+    };
+#endif
 }
 
 class TorrentFilesWatcher::Worker final : public QObject
@@ -97,25 +235,74 @@ public slots:
     void removeWatchedFolder(const Path &path);
 
 signals:
-    void torrentFound(const BitTorrent::TorrentDescriptor &torrentDescr, const BitTorrent::AddTorrentParams &addTorrentParams);
+    void torrentsFound(const QList<BitTorrent::TorrentDescriptor> &torrentDescrs, const BitTorrent::AddTorrentParams &addTorrentParams);
 
 private:
     void onTimeout();
     void scheduleWatchedFolderProcessing(const Path &path);
     void processWatchedFolder(const Path &path);
     void processFolder(const Path &path, const Path &watchedFolderPath, const TorrentFilesWatcher::WatchedFolderOptions &options);
-    void processFailedTorrents();
+    void processFiles(const QList<Path> &filePaths, const Path &folderPath, const Path &watchedFolderPath);
+    void processMagnetFile(const Path &filePath, QList<BitTorrent::TorrentDescriptor> &torrentDescrs);
+    // Parses the files in parallel, the failed ones are deferred
+    void loadTorrentFiles(const QList<Path> &filePaths, QList<BitTorrent::TorrentDescriptor> &torrentDescrs);
+    void processDeferredFiles();
+    void scheduleDeferredFilesProcessing();
+    void emitTorrentsFound(const QList<BitTorrent::TorrentDescriptor> &torrentDescrs, const Path &folderPath, const Path &watchedFolderPath);
     void addWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options);
     void updateWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options);
+    void watchFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options);
+    void unwatchFolder(const Path &path);
+    BitTorrent::AddTorrentParams folderAddTorrentParams(const Path &folderPath, const Path &watchedFolderPath
+            , const TorrentFilesWatcher::WatchedFolderOptions &options) const;
 
     QFileSystemWatcher *m_watcher = nullptr;
     QTimer *m_watchTimer = nullptr;
     QHash<Path, TorrentFilesWatcher::WatchedFolderOptions> m_watchedFolders;
     QSet<Path> m_watchedByTimeoutFolders;
 
-    // Failed torrents
+#ifdef Q_OS_LINUX
+    bool startNativeWatching(const Path &path, bool recursive);
+    void stopNativeWatching(const Path &path);
+    bool addNativeWatches(const Path &folderPath, const Path &watchedFolderPath, bool recursive);
+    void onEntryAdded(const Path &dirPath, const QString &name, bool isDir);
+    void onEventsLost();
+    void processPendingFiles();
+
+    InotifyWatcher *m_inotifyWatcher = nullptr;
+    // natively watched directories and the watched folders they belong to
+    QHash<Path, Path> m_nativelyWatchedDirs;
+    QSet<Path> m_nativelyWatchedFolders;
+    QTimer *m_reconciliationTimer = nullptr;
+    // files reported by native notifications, grouped by their directory
+    QHash<Path, QSet<Path>> m_pendingFiles;
+    QTimer *m_pendingFilesTimer = nullptr;
+#endif
+
+    struct FileState
+    {
+        qint64 size = -1;
+        QDateTime lastModified;
+
+        friend bool operator==(const FileState &left, const FileState &right) = default;
+    };
+
+    // torrent files which are still written or failed to be parsed
+    struct DeferredFile
+    {
+        Path folderPath;
+        Path watchedFolderPath;
+        FileState state;
+        // parsing of the file in this state has failed
+        bool isFailed = false;
+        int retries = 0;
+    };
+
+    static FileState fileState(const Path &filePath);
+
+    QThreadPool m_parsingThreadPool;
     QTimer *m_retryTorrentTimer = nullptr;
-    QHash<Path, QHash<Path, int>> m_failedTorrents;
+    QHash<Path, DeferredFile> m_deferredFiles;
 };
 
 TorrentFilesWatcher *TorrentFilesWatcher::m_instance = nullptr;
@@ -142,7 +329,7 @@ TorrentFilesWatcher::TorrentFilesWatcher(QObject *parent)
     , m_ioThread {new QThread}
     , m_asyncWorker {new TorrentFilesWatcher::Worker(new QFileSystemWatcher(this))}
 {
-    connect(m_asyncWorker, &TorrentFilesWatcher::Worker::torrentFound, this, &TorrentFilesWatcher::onTorrentFound);
+    connect(m_asyncWorker, &TorrentFilesWatcher::Worker::torrentsFound, this, &TorrentFilesWatcher::onTorrentsFound);
 
     m_asyncWorker->moveToThread(m_ioThread.get());
     connect(m_ioThread.get(), &QThread::finished, m_asyncWorker, &QObject::deleteLater);
@@ -305,10 +492,10 @@ void TorrentFilesWatcher::removeWatchedFolder(const Path &path)
     }
 }
 
-void TorrentFilesWatcher::onTorrentFound(const BitTorrent::TorrentDescriptor &torrentDescr
+void TorrentFilesWatcher::onTorrentsFound(const QList<BitTorrent::TorrentDescriptor> &torrentDescrs
         , const BitTorrent::AddTorrentParams &addTorrentParams)
 {
-    BitTorrent::Session::instance()->addTorrent(torrentDescr, addTorrentParams);
+    BitTorrent::Session::instance()->addTorrents(torrentDescrs, addTorrentParams);
 }
 
 TorrentFilesWatcher::Worker::Worker(QFileSystemWatcher *watcher)
@@ -316,13 +503,42 @@ TorrentFilesWatcher::Worker::Worker(QFileSystemWatcher *watcher)
     , m_watchTimer {new QTimer(this)}
     , m_retryTorrentTimer {new QTimer(this)}
 {
+    m_parsingThreadPool.setObjectName(u"TorrentFilesWatcher m_parsingThreadPool"_s);
+    m_parsingThreadPool.setMaxThreadCount(std::min(MAX_PARSING_THREADS, QThread::idealThreadCount()));
+
     connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path)
     {
         scheduleWatchedFolderProcessing(Path(path));
     });
     connect(m_watchTimer, &QTimer::timeout, this, &Worker::onTimeout);
 
-    connect(m_retryTorrentTimer, &QTimer::timeout, this, &Worker::processFailedTorrents);
+    connect(m_retryTorrentTimer, &QTimer::timeout, this, &Worker::processDeferredFiles);
+
+#ifdef Q_OS_LINUX
+    m_inotifyWatcher = new InotifyWatcher([this](const Path &dirPath, const QString &name, bool isDir)
+    {
+        onEntryAdded(dirPath, name, isDir);
+    }
+    , [this] { onEventsLost(); }, this);
+    if (!m_inotifyWatcher->isValid())
+    {
+        LogMsg(tr("Failed to initialize inotify. Watched folders will be checked for changes less efficiently."), Log::WARNING);
+        delete m_inotifyWatcher;
+        m_inotifyWatcher = nullptr;
+    }
+
+    m_reconciliationTimer = new QTimer(this);
+    connect(m_reconciliationTimer, &QTimer::timeout, this, [this]
+    {
+        for (const Path &path : asConst(m_nativelyWatchedFolders))
+            processWatchedFolder(path);
+    });
+
+    m_pendingFilesTimer = new QTimer(this);
+    m_pendingFilesTimer->setSingleShot(true);
+    m_pendingFilesTimer->setInterval(PROCESSING_DELAY);
+    connect(m_pendingFilesTimer, &QTimer::timeout, this, &Worker::processPendingFiles);
+#endif
 }
 
 void TorrentFilesWatcher::Worker::onTimeout()
@@ -343,19 +559,16 @@ void TorrentFilesWatcher::Worker::removeWatchedFolder(const Path &path)
 {
     m_watchedFolders.remove(path);
 
-    m_watcher->removePath(path.data());
-    m_watchedByTimeoutFolders.remove(path);
-    if (m_watchedByTimeoutFolders.isEmpty())
-        m_watchTimer->stop();
+    unwatchFolder(path);
 
-    m_failedTorrents.remove(path);
-    if (m_failedTorrents.isEmpty())
+    m_deferredFiles.removeIf([&path](const auto &item) { return (item.value().watchedFolderPath == path); });
+    if (m_deferredFiles.isEmpty())
         m_retryTorrentTimer->stop();
 }
 
 void TorrentFilesWatcher::Worker::scheduleWatchedFolderProcessing(const Path &path)
 {
-    QTimer::singleShot(2s, Qt::CoarseTimer, this, [this, path]
+    QTimer::singleShot(PROCESSING_DELAY, Qt::CoarseTimer, this, [this, path]
     {
         processWatchedFolder(path);
     });
@@ -366,157 +579,271 @@ void TorrentFilesWatcher::Worker::processWatchedFolder(const Path &path)
     const TorrentFilesWatcher::WatchedFolderOptions options = m_watchedFolders.value(path);
     processFolder(path, path, options);
 
-    if (!m_failedTorrents.empty() && !m_retryTorrentTimer->isActive())
-        m_retryTorrentTimer->start(WATCH_INTERVAL);
+    scheduleDeferredFilesProcessing();
+}
+
+BitTorrent::AddTorrentParams TorrentFilesWatcher::Worker::folderAddTorrentParams(const Path &folderPath
+        , const Path &watchedFolderPath, const TorrentFilesWatcher::WatchedFolderOptions &options) const
+{
+    BitTorrent::AddTorrentParams addTorrentParams = options.addTorrentParams;
+    if (folderPath != watchedFolderPath)
+    {
+        const Path subdirPath = watchedFolderPath.relativePathOf(folderPath);
+        const bool useAutoTMM = addTorrentParams.useAutoTMM.value_or(!BitTorrent::Session::instance()->isAutoTMMDisabledByDefault());
+        if (useAutoTMM)
+        {
+            addTorrentParams.category = addTorrentParams.category.isEmpty()
+                    ? subdirPath.data() : (addTorrentParams.category + u'/' + subdirPath.data());
+        }
+        else
+        {
+            addTorrentParams.savePath = addTorrentParams.savePath / subdirPath;
+        }
+    }
+
+    return addTorrentParams;
 }
 
 void TorrentFilesWatcher::Worker::processFolder(const Path &path, const Path &watchedFolderPath
                                               , const TorrentFilesWatcher::WatchedFolderOptions &options)
 {
+    QList<Path> filePaths;
     QDirIterator dirIter {path.data(), {u"*.torrent"_s, u"*.magnet"_s}, QDir::Files};
     while (dirIter.hasNext())
+        filePaths.append(Path(dirIter.next()));
+    processFiles(filePaths, path, watchedFolderPath);
+
+    if (options.recursive)
     {
-        const Path filePath {dirIter.next()};
-        BitTorrent::AddTorrentParams addTorrentParams = options.addTorrentParams;
-        if (path != watchedFolderPath)
+        QDirIterator iter {path.data(), (QDir::Dirs | QDir::NoDotAndDotDot)};
+        while (iter.hasNext())
         {
-            const Path subdirPath = watchedFolderPath.relativePathOf(path);
-            const bool useAutoTMM = addTorrentParams.useAutoTMM.value_or(!BitTorrent::Session::instance()->isAutoTMMDisabledByDefault());
-            if (useAutoTMM)
-            {
-                addTorrentParams.category = addTorrentParams.category.isEmpty()
-                        ? subdirPath.data() : (addTorrentParams.category + u'/' + subdirPath.data());
-            }
-            else
-            {
-                addTorrentParams.savePath = addTorrentParams.savePath / subdirPath;
-            }
+            const Path folderPath {iter.next()};
+            // Skip processing of subdirectory that is explicitly set as watched folder
+            if (!m_watchedFolders.contains(folderPath))
+                processFolder(folderPath, watchedFolderPath, options);
         }
+    }
+}
 
+void TorrentFilesWatcher::Worker::processFiles(const QList<Path> &filePaths, const Path &folderPath, const Path &watchedFolderPath)
+{
+    // torrents found in the folder are added in one go
+    QList<BitTorrent::TorrentDescriptor> torrentDescrs;
+    QList<Path> torrentFilePaths;
+    for (const Path &filePath : filePaths)
+    {
         if (filePath.hasExtension(u".magnet"_s))
         {
-            const int fileMaxSize = 100 * 1024 * 1024;
+            processMagnetFile(filePath, torrentDescrs);
+            continue;
+        }
 
-            QFile file {filePath.data()};
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text))
-            {
-                if (file.size() <= fileMaxSize)
-                {
-                    while (!file.atEnd())
-                    {
-                        const auto line = QString::fromLatin1(file.readLine()).trimmed();
-                        if (const auto parseResult = BitTorrent::TorrentDescriptor::parse(line))
-                            emit torrentFound(parseResult.value(), addTorrentParams);
-                        else
-                            LogMsg(tr("Invalid Magnet URI. URI: %1. Reason: %2").arg(line, parseResult.error()), Log::WARNING);
-                    }
+        // deferred files are only checked by the retry timer
+        if (m_deferredFiles.contains(filePath))
+            continue;
 
-                    file.close();
-                    Utils::Fs::removeFile(filePath);
-                }
-                else
-                {
-                    LogMsg(tr("Magnet file too big. File: %1").arg(file.errorString()), Log::WARNING);
-                }
-            }
-            else
+        // the files which are still written are parsed once they stay unchanged, so they aren't read repeatedly
+        const FileState state = fileState(filePath);
+        if (state.lastModified.secsTo(QDateTime::currentDateTime()) < STABLE_FILE_AGE.count())
+            m_deferredFiles.insert(filePath, {.folderPath = folderPath, .watchedFolderPath = watchedFolderPath, .state = state});
+        else
+            torrentFilePaths.append(filePath);
+    }
+
+    loadTorrentFiles(torrentFilePaths, torrentDescrs);
+    for (const Path &filePath : asConst(torrentFilePaths))
+    {
+        if (const auto it = m_deferredFiles.find(filePath); it != m_deferredFiles.end())
+        {
+            it->folderPath = folderPath;
+            it->watchedFolderPath = watchedFolderPath;
+        }
+    }
+
+    emitTorrentsFound(torrentDescrs, folderPath, watchedFolderPath);
+}
+
+void TorrentFilesWatcher::Worker::processMagnetFile(const Path &filePath, QList<BitTorrent::TorrentDescriptor> &torrentDescrs)
+{
+    const int fileMaxSize = 100 * 1024 * 1024;
+
+    QFile file {filePath.data()};
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        if (file.size() <= fileMaxSize)
+        {
+            while (!file.atEnd())
             {
-                LogMsg(tr("Failed to open magnet file: %1").arg(file.errorString()));
+                const auto line = QString::fromLatin1(file.readLine()).trimmed();
+                if (const auto parseResult = BitTorrent::TorrentDescriptor::parse(line))
+                    torrentDescrs.append(parseResult.value());
+                else
+                    LogMsg(tr("Invalid Magnet URI. URI: %1. Reason: %2").arg(line, parseResult.error()), Log::WARNING);
             }
+
+            file.close();
+            Utils::Fs::removeFile(filePath);
         }
         else
         {
-            if (const auto loadResult = BitTorrent::TorrentDescriptor::loadFromFile(filePath))
-            {
-                emit torrentFound(loadResult.value(), addTorrentParams);
-                Utils::Fs::removeFile(filePath);
-            }
-            else
+            LogMsg(tr("Magnet file too big. File: %1").arg(file.errorString()), Log::WARNING);
+        }
+    }
+    else
+    {
+        LogMsg(tr("Failed to open magnet file: %1").arg(file.errorString()));
+    }
+}
+
+void TorrentFilesWatcher::Worker::loadTorrentFiles(const QList<Path> &filePaths, QList<BitTorrent::TorrentDescriptor> &torrentDescrs)
+{
+    std::vector<nonstd::expected<BitTorrent::TorrentDescriptor, QString>> loadResults(filePaths.size(), nonstd::make_unexpected(QString()));
+    if (filePaths.size() > 1)
+    {
+        for (qsizetype i = 0; i < filePaths.size(); ++i)
+        {
+            m_parsingThreadPool.start([&loadResults, &filePaths, i]
             {
-                if (!m_failedTorrents.value(path).contains(filePath))
-                {
-                    m_failedTorrents[path][filePath] = 0;
-                }
-            }
+                loadResults[i] = BitTorrent::TorrentDescriptor::loadFromFile(filePaths[i]);
+            });
         }
+        m_parsingThreadPool.waitForDone();
+    }
+    else if (filePaths.size() == 1)
+    {
+        loadResults[0] = BitTorrent::TorrentDescriptor::loadFromFile(filePaths[0]);
     }
 
-    if (options.recursive)
+    for (qsizetype i = 0; i < filePaths.size(); ++i)
     {
-        QDirIterator iter {path.data(), (QDir::Dirs | QDir::NoDotAndDotDot)};
-        while (iter.hasNext())
+        const Path &filePath = filePaths[i];
+        if (loadResults[i])
         {
-            const Path folderPath {iter.next()};
-            // Skip processing of subdirectory that is explicitly set as watched folder
-            if (!m_watchedFolders.contains(folderPath))
-                processFolder(folderPath, watchedFolderPath, options);
+            torrentDescrs.append(loadResults[i].value());
+            Utils::Fs::removeFile(filePath);
+            m_deferredFiles.remove(filePath);
+        }
+        else
+        {
+            DeferredFile &deferredFile = m_deferredFiles[filePath];
+            deferredFile.state = fileState(filePath);
+            deferredFile.isFailed = true;
         }
     }
 }
 
-void TorrentFilesWatcher::Worker::processFailedTorrents()
+void TorrentFilesWatcher::Worker::processDeferredFiles()
 {
-    // Check which torrents are still partial
-    Algorithm::removeIf(m_failedTorrents, [this](const Path &watchedFolderPath, QHash<Path, int> &partialTorrents)
+    // the files are grouped by their folders, so they are added with the parameters of the folder
+    QHash<Path, QList<Path>> readyFiles;
+    for (auto it = m_deferredFiles.begin(); it != m_deferredFiles.end();)
     {
-        const TorrentFilesWatcher::WatchedFolderOptions options = m_watchedFolders.value(watchedFolderPath);
-        Algorithm::removeIf(partialTorrents, [this, &watchedFolderPath, &options](const Path &torrentPath, int &value)
+        const Path &filePath = it.key();
+        DeferredFile &deferredFile = it.value();
+        if (!filePath.exists())
         {
-            if (!torrentPath.exists())
-                return true;
-
-            if (const auto loadResult = BitTorrent::TorrentDescriptor::loadFromFile(torrentPath))
-            {
-                BitTorrent::AddTorrentParams addTorrentParams = options.addTorrentParams;
-                if (torrentPath != watchedFolderPath)
-                {
-                    const Path subdirPath = watchedFolderPath.relativePathOf(torrentPath);
-                    const bool useAutoTMM = addTorrentParams.useAutoTMM.value_or(!BitTorrent::Session::instance()->isAutoTMMDisabledByDefault());
-                    if (useAutoTMM)
-                    {
-                        addTorrentParams.category = addTorrentParams.category.isEmpty()
-                                ? subdirPath.data() : (addTorrentParams.category + u'/' + subdirPath.data());
-                    }
-                    else
-                    {
-                        addTorrentParams.savePath = addTorrentParams.savePath / subdirPath;
-                    }
-                }
-
-                emit torrentFound(loadResult.value(), addTorrentParams);
-                Utils::Fs::removeFile(torrentPath);
-
-                return true;
-            }
+            it = m_deferredFiles.erase(it);
+            continue;
+        }
 
-            if (value >= MAX_FAILED_RETRIES)
-            {
-                LogMsg(tr("Rejecting failed torrent file: %1").arg(torrentPath.toString()));
-                Utils::Fs::renameFile(torrentPath, (torrentPath + u".qbt_rejected"));
-                return true;
-            }
+        const FileState state = fileState(filePath);
+        if (state != deferredFile.state)
+        {
+            // the file is still written, it is checked again later
+            deferredFile.state = state;
+            deferredFile.isFailed = false;
+        }
+        else if (!deferredFile.isFailed)
+        {
+            readyFiles[deferredFile.folderPath].append(filePath);
+        }
+        else if (++deferredFile.retries >= MAX_FAILED_RETRIES)
+        {
+            // the file stays the same, so there is no point in parsing it again
+            LogMsg(tr("Rejecting failed torrent file: %1").arg(filePath.toString()));
+            Utils::Fs::renameFile(filePath, (filePath + u".qbt_rejected"));
+            it = m_deferredFiles.erase(it);
+            continue;
+        }
 
-            ++value;
-            return false;
-        });
+        ++it;
+    }
 
-        if (partialTorrents.isEmpty())
-            return true;
+    for (auto it = readyFiles.cbegin(); it != readyFiles.cend(); ++it)
+    {
+        const Path &folderPath = it.key();
+        const Path watchedFolderPath = m_deferredFiles.value(it.value().first()).watchedFolderPath;
 
-        return false;
-    });
+        QList<BitTorrent::TorrentDescriptor> torrentDescrs;
+        loadTorrentFiles(it.value(), torrentDescrs);
+        emitTorrentsFound(torrentDescrs, folderPath, watchedFolderPath);
+    }
 
     // Stop the partial timer if necessary
-    if (m_failedTorrents.empty())
+    if (m_deferredFiles.empty())
         m_retryTorrentTimer->stop();
     else
         m_retryTorrentTimer->start(WATCH_INTERVAL);
 }
 
+void TorrentFilesWatcher::Worker::scheduleDeferredFilesProcessing()
+{
+    if (!m_deferredFiles.empty() && !m_retryTorrentTimer->isActive())
+        m_retryTorrentTimer->start(WATCH_INTERVAL);
+}
+
+void TorrentFilesWatcher::Worker::emitTorrentsFound(const QList<BitTorrent::TorrentDescriptor> &torrentDescrs
+        , const Path &folderPath, const Path &watchedFolderPath)
+{
+    if (torrentDescrs.isEmpty())
+        return;
+
+    const BitTorrent::AddTorrentParams addTorrentParams = folderAddTorrentParams(folderPath, watchedFolderPath, m_watchedFolders.value(watchedFolderPath));
+    for (qsizetype i = 0; i < torrentDescrs.size(); i += TORRENTS_BATCH_SIZE)
+        emit torrentsFound(torrentDescrs.mid(i, TORRENTS_BATCH_SIZE), addTorrentParams);
+}
+
+TorrentFilesWatcher::Worker::FileState TorrentFilesWatcher::Worker::fileState(const Path &filePath)
+{
+    const QFileInfo fileInfo {filePath.data()};
+    return {.size = fileInfo.size(), .lastModified = fileInfo.lastModified()};
+}
+
 void TorrentFilesWatcher::Worker::addWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
 {
-    // Check if the `path` points to a network file system or not
-    if (Utils::Fs::isNetworkFileSystem(path) || options.recursive)
+    watchFolder(path, options);
+
+    m_watchedFolders[path] = options;
+
+    LogMsg(tr("Watching folder: \"%1\"").arg(path.toString()));
+}
+
+void TorrentFilesWatcher::Worker::updateWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
+{
+    const bool recursiveModeChanged = (m_watchedFolders[path].recursive != options.recursive);
+    m_watchedFolders[path] = options;
+
+    if (recursiveModeChanged && !Utils::Fs::isNetworkFileSystem(path))
+    {
+        unwatchFolder(path);
+        watchFolder(path, options);
+    }
+}
+
+void TorrentFilesWatcher::Worker::watchFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
+{
+    // Network file systems don't report changes reliably so they are always polled
+    const bool isNetworkFS = Utils::Fs::isNetworkFileSystem(path);
+#ifdef Q_OS_LINUX
+    if (!isNetworkFS && startNativeWatching(path, options.recursive))
+    {
+        scheduleWatchedFolderProcessing(path);
+        return;
+    }
+#endif
+
+    if (isNetworkFS || options.recursive)
     {
         m_watchedByTimeoutFolders.insert(path);
         if (!m_watchTimer->isActive())
@@ -527,37 +854,150 @@ void TorrentFilesWatcher::Worker::addWatchedFolder(const Path &path, const Torre
         m_watcher->addPath(path.data());
         scheduleWatchedFolderProcessing(path);
     }
+}
 
-    m_watchedFolders[path] = options;
+void TorrentFilesWatcher::Worker::unwatchFolder(const Path &path)
+{
+#ifdef Q_OS_LINUX
+    stopNativeWatching(path);
+#endif
 
-    LogMsg(tr("Watching folder: \"%1\"").arg(path.toString()));
+    m_watcher->removePath(path.data());
+    m_watchedByTimeoutFolders.remove(path);
+    if (m_watchedByTimeoutFolders.isEmpty())
+        m_watchTimer->stop();
 }
 
-void TorrentFilesWatcher::Worker::updateWatchedFolder(const Path &path, const TorrentFilesWatcher::WatchedFolderOptions &options)
+#ifdef Q_OS_LINUX
+bool TorrentFilesWatcher::Worker::startNativeWatching(const Path &path, const bool recursive)
 {
-    const bool recursiveModeChanged = (m_watchedFolders[path].recursive != options.recursive);
-    if (recursiveModeChanged && !Utils::Fs::isNetworkFileSystem(path))
+    if (!m_inotifyWatcher)
+        return false;
+
+    if (!addNativeWatches(path, path, recursive))
     {
-        if (options.recursive)
+        // e.g. the limit of inotify watches is reached
+        stopNativeWatching(path);
+        return false;
+    }
+
+    m_nativelyWatchedFolders.insert(path);
+    if (!m_reconciliationTimer->isActive())
+        m_reconciliationTimer->start(RECONCILIATION_INTERVAL);
+    return true;
+}
+
+void TorrentFilesWatcher::Worker::stopNativeWatching(const Path &path)
+{
+    if (!m_inotifyWatcher)
+        return;
+
+    Algorithm::removeIf(m_nativelyWatchedDirs, [this, &path](const Path &dirPath, const Path &watchedFolderPath)
+    {
+        if (watchedFolderPath != path)
+            return false;
+
+        m_inotifyWatcher->removePath(dirPath);
+        m_pendingFiles.remove(dirPath);
+        return true;
+    });
+
+    m_nativelyWatchedFolders.remove(path);
+    if (m_nativelyWatchedFolders.isEmpty())
+        m_reconciliationTimer->stop();
+}
+
+bool TorrentFilesWatcher::Worker::addNativeWatches(const Path &folderPath, const Path &watchedFolderPath, const bool recursive)
+{
+    if (!m_inotifyWatcher->addPath(folderPath))
+        return false;
+
+    m_nativelyWatchedDirs[folderPath] = watchedFolderPath;
+
+    if (recursive)
+    {
+        QDirIterator iter {folderPath.data(), (QDir::Dirs | QDir::NoDotAndDotDot)};
+        while (iter.hasNext())
         {
-            m_watcher->removePath(path.data());
+            const Path subfolderPath {iter.next()};
+            // Subdirectory that is explicitly set as watched folder is watched on its own
+            if (m_watchedFolders.contains(subfolderPath))
+                continue;
 
-            m_watchedByTimeoutFolders.insert(path);
-            if (!m_watchTimer->isActive())
-                m_watchTimer->start(WATCH_INTERVAL);
+            if (!addNativeWatches(subfolderPath, watchedFolderPath, true))
+                return false;
         }
-        else
+    }
+
+    return true;
+}
+
+void TorrentFilesWatcher::Worker::onEntryAdded(const Path &dirPath, const QString &name, const bool isDir)
+{
+    const Path watchedFolderPath = m_nativelyWatchedDirs.value(dirPath);
+    if (watchedFolderPath.isEmpty())
+        return;
+
+    const Path entryPath = dirPath / Path(name);
+    if (isDir)
+    {
+        const TorrentFilesWatcher::WatchedFolderOptions options = m_watchedFolders.value(watchedFolderPath);
+        if (!options.recursive || m_watchedFolders.contains(entryPath))
+            return;
+
+        if (!addNativeWatches(entryPath, watchedFolderPath, true))
+        {
+            LogMsg(tr("Failed to watch folder: \"%1\"").arg(entryPath.toString()), Log::WARNING);
+            return;
+        }
+
+        // Files could have been put into new subdirectory before it was watched
+        QTimer::singleShot(PROCESSING_DELAY, Qt::CoarseTimer, this, [this, entryPath, watchedFolderPath]
         {
-            m_watchedByTimeoutFolders.remove(path);
-            if (m_watchedByTimeoutFolders.isEmpty())
-                m_watchTimer->stop();
+            if (m_nativelyWatchedDirs.value(entryPath) != watchedFolderPath)
+                return;
 
-            m_watcher->addPath(path.data());
-            scheduleWatchedFolderProcessing(path);
+            processFolder(entryPath, watchedFolderPath, m_watchedFolders.value(watchedFolderPath));
+            scheduleDeferredFilesProcessing();
+        });
+    }
+    else if (isTorrentSourceFile(entryPath))
+    {
+        m_pendingFiles[dirPath].insert(entryPath);
+        if (!m_pendingFilesTimer->isActive())
+            m_pendingFilesTimer->start();
+    }
+}
+
+void TorrentFilesWatcher::Worker::onEventsLost()
+{
+    m_pendingFiles.clear();
+    for (const Path &path : asConst(m_nativelyWatchedFolders))
+        scheduleWatchedFolderProcessing(path);
+}
+
+void TorrentFilesWatcher::Worker::processPendingFiles()
+{
+    const QHash<Path, QSet<Path>> pendingFiles = std::exchange(m_pendingFiles, {});
+    for (auto it = pendingFiles.cbegin(); it != pendingFiles.cend(); ++it)
+    {
+        const Path &dirPath = it.key();
+        const Path watchedFolderPath = m_nativelyWatchedDirs.value(dirPath);
+        if (watchedFolderPath.isEmpty())
+            continue;
+
+        QList<Path> filePaths;
+        for (const Path &filePath : it.value())
+        {
+            // file could be already processed by regular scan
+            if (filePath.exists())
+                filePaths.append(filePath);
         }
+        processFiles(filePaths, dirPath, watchedFolderPath);
     }
 
-    m_watchedFolders[path] = options;
+    scheduleDeferredFilesProcessing();
 }
+#endif
 
 #include "torrentfileswatcher.moc"
@@ -68,7 +68,7 @@ signals:
     void watchedFolderRemoved(const Path &path);
 
 private slots:
-    void onTorrentFound(const BitTorrent::TorrentDescriptor &torrentDescr, const BitTorrent::AddTorrentParams &addTorrentParams);
+    void onTorrentsFound(const QList<BitTorrent::TorrentDescriptor> &torrentDescrs, const BitTorrent::AddTorrentParams &addTorrentParams);
 
 private:
     explicit TorrentFilesWatcher(QObject *parent = nullptr);
@@ -0,0 +1,172 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "tracing.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace
+{
+    // maximum number of spans kept per thread, the oldest ones are overwritten
+    const std::size_t BUFFER_CAPACITY = 32 * 1024;
+
+    struct Event
+    {
+        const char *name = nullptr;
+        qint64 start = 0;
+        qint64 duration = 0;
+    };
+
+    struct ThreadBuffer
+    {
+        int threadID = 0;
+        std::atomic_bool isThreadFinished {false};
+
+        // `mutex` is only contended while the spans are exported
+        QMutex mutex;
+        std::vector<Event> events;
+        std::size_t next = 0;
+    };
+
+    // Buffers outlive their threads, so spans of finished threads can still be exported.
+    // They are released once they are cleared.
+    QMutex buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    int lastThreadID = 0;
+
+    struct ThreadBufferHandle
+    {
+        ~ThreadBufferHandle()
+        {
+            if (buffer)
+                buffer->isThreadFinished = true;
+        }
+
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+
+    thread_local ThreadBufferHandle threadBuffer;
+
+    ThreadBuffer *currentThreadBuffer()
+    {
+        if (!threadBuffer.buffer)
+        {
+            auto buffer = std::make_shared<ThreadBuffer>();
+
+            const QMutexLocker locker {&buffersMutex};
+            buffer->threadID = ++lastThreadID;
+            buffers.push_back(buffer);
+            threadBuffer.buffer = std::move(buffer);
+        }
+
+        return threadBuffer.buffer.get();
+    }
+}
+
+std::atomic_bool Tracing::Detail::isEnabled {false};
+
+qint64 Tracing::Detail::now() noexcept
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracing::Detail::record(const char *name, const qint64 start, const qint64 end)
+{
+    ThreadBuffer *buffer = currentThreadBuffer();
+    const Event event {.name = name, .start = start, .duration = (end - start)};
+
+    const QMutexLocker locker {&buffer->mutex};
+    if (buffer->events.size() < BUFFER_CAPACITY)
+        buffer->events.push_back(event);
+    else
+        buffer->events[buffer->next] = event;
+    buffer->next = (buffer->next + 1) % BUFFER_CAPACITY;
+}
+
+void Tracing::setEnabled(const bool enabled)
+{
+    Detail::isEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Tracing::clear()
+{
+    const QMutexLocker locker {&buffersMutex};
+    std::erase_if(buffers, [](const std::shared_ptr<ThreadBuffer> &buffer)
+    {
+        const QMutexLocker bufferLocker {&buffer->mutex};
+        buffer->events.clear();
+        buffer->next = 0;
+        return buffer->isThreadFinished.load();
+    });
+}
+
+QByteArray Tracing::toChromeTraceJson()
+{
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    QByteArray json = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    bool isFirst = true;
+
+    const QMutexLocker locker {&buffersMutex};
+    for (const std::shared_ptr<ThreadBuffer> &buffer : buffers)
+    {
+        const QByteArray tid = QByteArray::number(buffer->threadID);
+
+        const QMutexLocker bufferLocker {&buffer->mutex};
+        json.reserve(json.size() + (static_cast<qsizetype>(buffer->events.size()) * 96));
+        for (const Event &event : buffer->events)
+        {
+            if (!isFirst)
+                json += ',';
+            isFirst = false;
+
+            json += R"({"name":")";
+            json += event.name;
+            json += R"(","cat":"qbt","ph":"X","ts":)";
+            json += QByteArray::number(event.start);
+            json += R"(,"dur":)";
+            json += QByteArray::number(event.duration);
+            json += R"(,"pid":)";
+            json += pid;
+            json += R"(,"tid":)";
+            json += tid;
+            json += '}';
+        }
+    }
+
+    json += "]}";
+    return json;
+}
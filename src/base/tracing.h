@@ -0,0 +1,89 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QtClassHelperMacros>
+#include <QtTypes>
+
+class QByteArray;
+
+#define QBT_TRACE_CONCAT_IMPL(a, b) a##b
+#define QBT_TRACE_CONCAT(a, b) QBT_TRACE_CONCAT_IMPL(a, b)
+
+// Records the time spent in the enclosing scope as a span named `name`, which must be a string literal
+#define QBT_TRACE_SCOPE(name) const Tracing::Span QBT_TRACE_CONCAT(traceSpan, __LINE__) {name}
+
+// Lightweight recording of scoped spans for offline analysis.
+// Every thread records its spans into its own ring buffer, so the recording threads don't contend
+// with each other. While tracing is disabled spans cost a single relaxed atomic load.
+namespace Tracing
+{
+    namespace Detail
+    {
+        extern std::atomic_bool isEnabled;
+
+        qint64 now() noexcept;
+        void record(const char *name, qint64 start, qint64 end);
+    }
+
+    inline bool isEnabled() noexcept
+    {
+        return Detail::isEnabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enabled);
+    // Removes all the recorded spans
+    void clear();
+    // Returns the recorded spans in Chrome trace event format, it can be opened in Perfetto or chrome://tracing
+    QByteArray toChromeTraceJson();
+
+    class Span
+    {
+        Q_DISABLE_COPY_MOVE(Span)
+
+    public:
+        explicit Span(const char *name) noexcept
+            : m_name {isEnabled() ? name : nullptr}
+            , m_start {m_name ? Detail::now() : 0}
+        {
+        }
+
+        ~Span()
+        {
+            if (m_name)
+                Detail::record(m_name, m_start, Detail::now());
+        }
+
+    private:
+        const char *m_name = nullptr;
+        qint64 m_start = 0;
+    };
+}
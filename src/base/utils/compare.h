@@ -28,7 +28,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <Qt>
+#include <QString>
 #include <QtSystemDetection>
 
 // for QT_FEATURE_xxx, see: https://wiki.qt.io/Qt5_Build_System#How_to
@@ -47,12 +52,52 @@
 #endif
 #endif
 
-class QString;
-
 namespace Utils::Compare
 {
     int naturalCompare(const QString &left, const QString &right, Qt::CaseSensitivity caseSensitivity);
 
+    template <Qt::CaseSensitivity caseSensitivity>
+    class NaturalCompare;
+
+    // Natural sort order key of a string, it is made by `NaturalCompare::sortKey()`.
+    // Comparing two keys yields the same result as comparing the strings, but it is much cheaper
+    // (plain byte comparison when QCollator is used), so it pays off when the same strings are compared
+    // many times, e.g. while sorting. Only keys made with the same case sensitivity are comparable.
+    class NaturalSortKey
+    {
+    public:
+        int compare(const NaturalSortKey &other) const
+        {
+#if (QBT_USE_QCOLLATOR == 0)
+            return naturalCompare(m_string, other.m_string, m_caseSensitivity);
+#else
+            return m_key.compare(other.m_key);
+#endif
+        }
+
+    private:
+        template <Qt::CaseSensitivity>
+        friend class NaturalCompare;
+
+#if (QBT_USE_QCOLLATOR == 0)
+        NaturalSortKey(const QString &string, const Qt::CaseSensitivity caseSensitivity)
+            : m_string {string}
+            , m_caseSensitivity {caseSensitivity}
+        {
+        }
+
+        QString m_string;
+        Qt::CaseSensitivity m_caseSensitivity;
+#else
+        explicit NaturalSortKey(QCollatorSortKey key)
+            : m_key {std::move(key)}
+        {
+        }
+
+        QCollatorSortKey m_key;
+#endif
+    };
+
     template <Qt::CaseSensitivity caseSensitivity>
     class NaturalCompare
     {
@@ -62,6 +107,11 @@ namespace Utils::Compare
         {
             return naturalCompare(left, right, caseSensitivity);
         }
+
+        NaturalSortKey sortKey(const QString &string) const
+        {
+            return {string, caseSensitivity};
+        }
 #else
         NaturalCompare()
         {
@@ -74,6 +124,11 @@ namespace Utils::Compare
             return m_collator.compare(left, right);
         }
 
+        NaturalSortKey sortKey(const QString &string) const
+        {
+            return NaturalSortKey(m_collator.sortKey(string));
+        }
+
     private:
         QCollator m_collator;
 #endif
@@ -91,4 +146,25 @@ namespace Utils::Compare
     private:
         NaturalCompare<caseSensitivity> m_comparator;
     };
+
+    // Sorts the strings in natural order, the sort key of each string is made only once
+    template <Qt::CaseSensitivity caseSensitivity, typename Container>
+    void naturalSort(Container &strings)
+    {
+        const NaturalCompare<caseSensitivity> comparator;
+
+        std::vector<std::pair<NaturalSortKey, QString>> items;
+        items.reserve(static_cast<std::size_t>(strings.size()));
+        for (QString &string : strings)
+            items.emplace_back(comparator.sortKey(string), std::move(string));
+
+        std::sort(items.begin(), items.end(), [](const auto &left, const auto &right)
+        {
+            return (left.first.compare(right.first) < 0);
+        });
+
+        auto stringIter = strings.begin();
+        for (auto &item : items)
+            *stringIter++ = std::move(item.second);
+    }
 }
@@ -213,6 +213,22 @@ qint64 Utils::Fs::freeDiskSpaceOnPath(const Path &path)
     return QStorageInfo(path.data()).bytesAvailable();
 }
 
+QByteArray Utils::Fs::storageDeviceID(const Path &path)
+{
+    // path may not exist yet (e.g. destination of some operation),
+    // so the device is determined by its nearest existing parent
+    Path existingPath = path;
+    while (!existingPath.isEmpty() && !existingPath.exists())
+        existingPath = existingPath.parentPath();
+
+    const QStorageInfo storageInfo {existingPath.data()};
+    if (!storageInfo.isValid())
+        return {};
+
+    const QByteArray device = storageInfo.device();
+    return device.isEmpty() ? storageInfo.rootPath().toUtf8() : device;
+}
+
 Path Utils::Fs::tempPath()
 {
     static const Path path = Path(QDir::tempPath()) / Path(u".qBittorrent"_s);
@@ -33,6 +33,7 @@
  * Utility functions related to file system.
  */
 
+#include <QByteArray>
 #include <QString>
 
 #include "base/3rdparty/expected.hpp"
@@ -45,6 +46,8 @@ namespace Utils::Fs
 {
     qint64 computePathSize(const Path &path);
     qint64 freeDiskSpaceOnPath(const Path &path);
+    // identifies the storage device (i.e. mounted volume) the path is located on
+    QByteArray storageDeviceID(const Path &path);
 
     bool isRegularFile(const Path &path);
     bool isDir(const Path &path);
@@ -29,16 +29,79 @@
 
 #include "gzip.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <QtAssert>
 #include <QByteArray>
+#include <QByteArrayView>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #ifndef ZLIB_CONST
 #define ZLIB_CONST  // make z_stream.next_in const
 #endif
 #include <zlib.h>
 
+namespace
+{
+    const qsizetype PARALLEL_BLOCK_SIZE = 1024 * 1024;
+    // each block is primed with the end of the preceding data, so the ratio is almost not affected by the split
+    const qsizetype DICTIONARY_SIZE = 32 * 1024;
+
+    struct CompressedBlock
+    {
+        QByteArray data;
+        uLong crc = 0;
+        bool isValid = false;
+    };
+
+    // compresses the block to raw deflate data, the blocks are joined into single deflate stream
+    CompressedBlock compressBlock(const QByteArrayView dictionary, const QByteArrayView data, const int level, const bool isLast)
+    {
+        CompressedBlock block;
+        block.crc = crc32(crc32(0, Z_NULL, 0), reinterpret_cast<const Bytef *>(data.data()), static_cast<uInt>(data.size()));
+
+        z_stream strm {};
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+
+        // negative windowBits to produce raw deflate data without header and trailer
+        if (deflateInit2(&strm, level, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+            return block;
+
+        if (!dictionary.isEmpty()
+            && (deflateSetDictionary(&strm, reinterpret_cast<const Bytef *>(dictionary.data()), static_cast<uInt>(dictionary.size())) != Z_OK))
+        {
+            deflateEnd(&strm);
+            return block;
+        }
+
+        strm.next_in = reinterpret_cast<const Bytef *>(data.data());
+        strm.avail_in = static_cast<uInt>(data.size());
+
+        // the bound is for Z_FINISH, sync flush adds the empty stored block of 5 bytes at most
+        block.data = QByteArray(static_cast<qsizetype>(deflateBound(&strm, data.size()) + 16), Qt::Uninitialized);
+        strm.next_out = reinterpret_cast<Bytef *>(block.data.data());
+        strm.avail_out = static_cast<uInt>(block.data.size());
+
+        // sync flush ends the block on byte boundary without marking it as the last one
+        const int result = deflate(&strm, (isLast ? Z_FINISH : Z_SYNC_FLUSH));
+        block.isValid = (strm.avail_in == 0) && (result == (isLast ? Z_STREAM_END : Z_OK));
+
+        deflateEnd(&strm);
+        block.data.truncate(strm.total_out);
+        return block;
+    }
+
+    void appendLittleEndian32(QByteArray &output, const uLong value)
+    {
+        for (int i = 0; i < 4; ++i)
+            output.append(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
 QByteArray Utils::Gzip::compress(const QByteArray &data, const int level, bool *ok)
 {
     if (ok)
@@ -79,6 +142,79 @@ QByteArray Utils::Gzip::compress(const QByteArray &data, const int level, bool *
     return ret;
 }
 
+QByteArray Utils::Gzip::compressParallel(const QByteArray &data, const int level, bool *ok)
+{
+    const qsizetype blockCount = (data.size() + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE;
+    if ((blockCount < 2) || (QThreadPool::globalInstance()->maxThreadCount() < 2))
+        return compress(data, level, ok);
+
+    if (ok)
+        *ok = false;
+
+    std::vector<CompressedBlock> blocks(blockCount);
+    QSemaphore compressedCount;
+    for (qsizetype i = 0; i < blockCount; ++i)
+    {
+        const qsizetype blockStart = i * PARALLEL_BLOCK_SIZE;
+        const qsizetype dictionaryStart = std::max<qsizetype>(0, (blockStart - DICTIONARY_SIZE));
+        const QByteArrayView dictionary = QByteArrayView(data).sliced(dictionaryStart, (blockStart - dictionaryStart));
+        const QByteArrayView blockData = QByteArrayView(data).mid(blockStart, PARALLEL_BLOCK_SIZE);
+        const bool isLast = (i == (blockCount - 1));
+
+        QThreadPool::globalInstance()->start([&blocks, &compressedCount, dictionary, blockData, level, isLast, i]
+        {
+            blocks[i] = compressBlock(dictionary, blockData, level, isLast);
+            compressedCount.release();
+        });
+    }
+    compressedCount.acquire(static_cast<int>(blockCount));
+
+    qsizetype compressedSize = 0;
+    for (const CompressedBlock &block : blocks)
+    {
+        if (!block.isValid)
+            return {};
+        compressedSize += block.data.size();
+    }
+
+    // [RFC 1952] 2.3. Member format
+    // ID1, ID2, CM = deflate, FLG, MTIME = not available, XFL, OS = unknown
+    const char header[] = {'\x1F', '\x8B', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xFF'};
+
+    QByteArray ret;
+    ret.reserve(sizeof(header) + compressedSize + 8);
+    ret.append(header, sizeof(header));
+
+    uLong crc = blocks[0].crc;
+    ret.append(blocks[0].data);
+    for (qsizetype i = 1; i < blockCount; ++i)
+    {
+        const qsizetype blockSize = std::min(PARALLEL_BLOCK_SIZE, (data.size() - (i * PARALLEL_BLOCK_SIZE)));
+        crc = crc32_combine(crc, blocks[i].crc, static_cast<z_off_t>(blockSize));
+        ret.append(blocks[i].data);
+    }
+
+    // CRC32 and size of the uncompressed data modulo 2^32
+    appendLittleEndian32(ret, crc);
+    appendLittleEndian32(ret, static_cast<uLong>(data.size() & 0xFFFFFFFF));
+
+    if (ok)
+        *ok = true;
+    return ret;
+}
+
+int Utils::Gzip::adaptiveLevel(const qsizetype size)
+{
+    const QThreadPool *threadPool = QThreadPool::globalInstance();
+    const bool isBusy = threadPool->activeThreadCount() >= threadPool->maxThreadCount();
+
+    if (size >= (16 * 1024 * 1024))
+        return isBusy ? 1 : 3;
+    if (size >= (2 * 1024 * 1024))
+        return isBusy ? 3 : 5;
+    return 6;
+}
+
 QByteArray Utils::Gzip::decompress(const QByteArray &data, bool *ok)
 {
     if (ok) *ok = false;
@@ -135,3 +271,136 @@ QByteArray Utils::Gzip::decompress(const QByteArray &data, bool *ok)
     if (ok) *ok = true;
     return output;
 }
+
+Utils::Gzip::Compressor::Compressor(const int level)
+    : m_stream {std::make_unique<z_stream>()}
+{
+    m_stream->zalloc = Z_NULL;
+    m_stream->zfree = Z_NULL;
+    m_stream->opaque = Z_NULL;
+
+    // windowBits = 15 + 16 to enable gzip
+    m_isValid = (deflateInit2(m_stream.get(), level, Z_DEFLATED, (15 + 16), 9, Z_DEFAULT_STRATEGY) == Z_OK);
+}
+
+Utils::Gzip::Compressor::~Compressor()
+{
+    if (m_isValid)
+        deflateEnd(m_stream.get());
+}
+
+bool Utils::Gzip::Compressor::compress(const QByteArrayView data, QByteArray &output)
+{
+    if (!m_isValid)
+        return false;
+    if (data.isEmpty())
+        return true;
+
+    m_stream->next_in = reinterpret_cast<const Bytef *>(data.data());
+    m_stream->avail_in = static_cast<uInt>(data.size());
+    // sync flush makes all the data compressed so far available to the receiver
+    return deflate(Z_SYNC_FLUSH, output);
+}
+
+bool Utils::Gzip::Compressor::finish(QByteArray &output)
+{
+    if (!m_isValid)
+        return false;
+
+    m_stream->next_in = Z_NULL;
+    m_stream->avail_in = 0;
+    const bool result = deflate(Z_FINISH, output);
+
+    m_isValid = false;
+    deflateEnd(m_stream.get());
+    return result;
+}
+
+bool Utils::Gzip::Compressor::deflate(const int flush, QByteArray &output)
+{
+    const int BUFSIZE = 64 * 1024;
+    std::vector<char> buffer(BUFSIZE);
+
+    // output buffer may be filled up before all the input is consumed
+    while (true)
+    {
+        m_stream->next_out = reinterpret_cast<Bytef *>(buffer.data());
+        m_stream->avail_out = BUFSIZE;
+
+        const int result = ::deflate(m_stream.get(), flush);
+        if ((result != Z_OK) && (result != Z_STREAM_END) && (result != Z_BUF_ERROR))
+        {
+            m_isValid = false;
+            deflateEnd(m_stream.get());
+            return false;
+        }
+
+        output.append(buffer.data(), (BUFSIZE - m_stream->avail_out));
+
+        if ((result == Z_STREAM_END) || (m_stream->avail_out != 0))
+            return true;
+    }
+}
+
+Utils::Gzip::Decompressor::Decompressor()
+    : m_stream {std::make_unique<z_stream>()}
+{
+    m_stream->zalloc = Z_NULL;
+    m_stream->zfree = Z_NULL;
+    m_stream->opaque = Z_NULL;
+
+    // Add 32 to windowBits to enable zlib and gzip decoding with automatic header detection
+    m_isValid = (inflateInit2(m_stream.get(), (15 + 32)) == Z_OK);
+}
+
+Utils::Gzip::Decompressor::~Decompressor()
+{
+    if (m_isValid)
+        inflateEnd(m_stream.get());
+}
+
+bool Utils::Gzip::Decompressor::decompress(const QByteArrayView data, QByteArray &output)
+{
+    // trailing data after the end of stream is ignored
+    if (m_isFinished)
+        return true;
+    if (!m_isValid)
+        return false;
+    if (data.isEmpty())
+        return true;
+
+    const int BUFSIZE = 64 * 1024;
+    std::vector<char> buffer(BUFSIZE);
+
+    m_stream->next_in = reinterpret_cast<const Bytef *>(data.data());
+    m_stream->avail_in = static_cast<uInt>(data.size());
+    // output buffer may be filled up before all the input is consumed
+    do
+    {
+        m_stream->next_out = reinterpret_cast<Bytef *>(buffer.data());
+        m_stream->avail_out = BUFSIZE;
+
+        const int result = inflate(m_stream.get(), Z_NO_FLUSH);
+        if ((result != Z_OK) && (result != Z_STREAM_END) && (result != Z_BUF_ERROR))
+        {
+            m_isValid = false;
+            inflateEnd(m_stream.get());
+            return false;
+        }
+
+        output.append(buffer.data(), (BUFSIZE - m_stream->avail_out));
+
+        if (result == Z_STREAM_END)
+        {
+            m_isFinished = true;
+            break;
+        }
+    } while ((m_stream->avail_in > 0) || (m_stream->avail_out == 0));
+
+    return true;
+}
+
+bool Utils::Gzip::Decompressor::isFinished() const
+{
+    return m_isFinished;
+}
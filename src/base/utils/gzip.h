@@ -29,10 +29,67 @@
 
 #pragma once
 
+#include <memory>
+
+#include <QtClassHelperMacros>
+#include <QtTypes>
+
 class QByteArray;
+class QByteArrayView;
+
+struct z_stream_s;
 
 namespace Utils::Gzip
 {
     QByteArray compress(const QByteArray &data, int level = 6, bool *ok = nullptr);
+    // Large data is split into blocks which are compressed by the global thread pool and joined
+    // into single gzip stream, the small one is compressed in the calling thread as by compress()
+    QByteArray compressParallel(const QByteArray &data, int level = 6, bool *ok = nullptr);
     QByteArray decompress(const QByteArray &data, bool *ok = nullptr);
+
+    // Compression level for the data of `size`, the large data is compressed faster at the cost
+    // of the ratio, even more so when the thread pool is busy
+    int adaptiveLevel(qsizetype size);
+
+    // Compresses data to gzip stream in chunks, each compressed chunk can be decompressed
+    // as soon as it is received, so the stream can be sent while it is being produced
+    class Compressor
+    {
+        Q_DISABLE_COPY_MOVE(Compressor)
+
+    public:
+        explicit Compressor(int level = 6);
+        ~Compressor();
+
+        // appends compressed data of the chunk to `output`, returns false on failure
+        bool compress(QByteArrayView data, QByteArray &output);
+        // appends the end of compressed stream to `output`, no more data can be compressed then
+        bool finish(QByteArray &output);
+
+    private:
+        bool deflate(int flush, QByteArray &output);
+
+        std::unique_ptr<z_stream_s> m_stream;
+        bool m_isValid = false;
+    };
+
+    // Decompresses gzip or zlib stream that is received in chunks
+    class Decompressor
+    {
+        Q_DISABLE_COPY_MOVE(Decompressor)
+
+    public:
+        Decompressor();
+        ~Decompressor();
+
+        // appends decompressed data of the chunk to `output`, returns false if the stream is corrupted
+        bool decompress(QByteArrayView data, QByteArray &output);
+        // whether the end of compressed stream has been reached
+        bool isFinished() const;
+
+    private:
+        std::unique_ptr<z_stream_s> m_stream;
+        bool m_isValid = false;
+        bool m_isFinished = false;
+    };
 }
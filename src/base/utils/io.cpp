@@ -128,6 +128,66 @@ nonstd::expected<QByteArray, Utils::IO::ReadError> Utils::IO::readFile(const Pat
     return ret;
 }
 
+Utils::IO::MappedFile::MappedFile(std::unique_ptr<QFile> file, const uchar *data, const qint64 size)
+    : m_file {std::move(file)}
+    , m_data {data}
+    , m_size {size}
+{
+}
+
+Utils::IO::MappedFile::~MappedFile()
+{
+    if (m_data)
+        m_file->unmap(const_cast<uchar *>(m_data));
+}
+
+QByteArray Utils::IO::MappedFile::data() const
+{
+    if (!m_data)
+        return {};
+
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(m_data), static_cast<qsizetype>(m_size));
+}
+
+nonstd::expected<std::shared_ptr<const Utils::IO::MappedFile>, Utils::IO::ReadError> Utils::IO::mapFile(const Path &path, const qint64 maxSize)
+{
+    auto file = std::make_unique<QFile>(path.data());
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        const QString message = QCoreApplication::translate("Utils::IO", "File open error. File: \"%1\". Error: \"%2\"")
+            .arg(file->fileName(), file->errorString());
+        return nonstd::make_unexpected(ReadError {ReadError::NotExist, message});
+    }
+
+    const qint64 fileSize = file->size();
+    if ((maxSize >= 0) && (fileSize > maxSize))
+    {
+        const QString message = QCoreApplication::translate("Utils::IO", "File size exceeds limit. File: \"%1\". File size: %2. Size limit: %3")
+            .arg(file->fileName(), QString::number(fileSize), QString::number(maxSize));
+        return nonstd::make_unexpected(ReadError {ReadError::ExceedSize, message});
+    }
+    if (!std::in_range<qsizetype>(fileSize))
+    {
+        const QString message = QCoreApplication::translate("Utils::IO", "File size exceeds data size limit. File: \"%1\". File size: %2. Array limit: %3")
+            .arg(file->fileName(), QString::number(fileSize), QString::number(std::numeric_limits<qsizetype>::max()));
+        return nonstd::make_unexpected(ReadError {ReadError::ExceedSize, message});
+    }
+
+    // empty files (as well as special ones, which size is reported as 0) can't be mapped
+    if (fileSize == 0)
+        return std::make_shared<const MappedFile>(std::move(file), nullptr, 0);
+
+    const uchar *data = file->map(0, fileSize);
+    if (!data)
+    {
+        const QString message = QCoreApplication::translate("Utils::IO", "File read error. File: \"%1\". Error: \"%2\"")
+            .arg(file->fileName(), file->errorString());
+        return nonstd::make_unexpected(ReadError {ReadError::Failed, message});
+    }
+
+    return std::make_shared<const MappedFile>(std::move(file), data, fileSize);
+}
+
 nonstd::expected<void, QString> Utils::IO::saveToFile(const Path &path, const QByteArray &data)
 {
     if (const Path parentPath = path.parentPath(); !parentPath.isEmpty())
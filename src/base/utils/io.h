@@ -39,6 +39,7 @@
 #include "base/pathfwd.h"
 
 class QByteArray;
+class QFile;
 class QFileDevice;
 class QString;
 
@@ -97,9 +98,30 @@ namespace Utils::IO
         QString message;
     };
 
+    // Read-only view of the file contents mapped into memory, so the data isn't copied.
+    // The data is valid until the object is destroyed, its pages are released then.
+    class MappedFile
+    {
+        Q_DISABLE_COPY_MOVE(MappedFile)
+
+    public:
+        explicit MappedFile(std::unique_ptr<QFile> file, const uchar *data, qint64 size);
+        ~MappedFile();
+
+        // returns raw data array referencing the mapped memory, it must not outlive the object
+        QByteArray data() const;
+
+    private:
+        std::unique_ptr<QFile> m_file;
+        const uchar *m_data = nullptr;
+        qint64 m_size = 0;
+    };
+
     // TODO: define a specific type for `additionalMode`
     // providing `size` is explicit and is strongly recommended
     nonstd::expected<QByteArray, ReadError> readFile(const Path &path, qint64 size, QIODevice::OpenMode additionalMode = {});
+    // Same as `readFile()` but maps the file into memory instead of reading it
+    nonstd::expected<std::shared_ptr<const MappedFile>, ReadError> mapFile(const Path &path, qint64 size);
 
     nonstd::expected<void, QString> saveToFile(const Path &path, const QByteArray &data);
     nonstd::expected<void, QString> saveToFile(const Path &path, const lt::entry &data);
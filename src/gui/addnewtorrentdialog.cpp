@@ -298,6 +298,8 @@ AddNewTorrentDialog::AddNewTorrentDialog(const BitTorrent::TorrentDescriptor &to
     , m_storeSplitterState {u"GUI/Qt6/" SETTINGS_KEY(u"SplitterState"_s)}
     , m_storeFilterPatternFormat {u"GUI/" SETTINGS_KEY(u"FilterPatternFormat"_s)}
 {
+    m_diskSpaceQueryPool.setMaxThreadCount(1);
+
     m_ui->setupUi(this);
 
     m_ui->savePath->setMode(FileSystemPathEdit::Mode::DirectorySave);
@@ -603,7 +605,28 @@ void AddNewTorrentDialog::updateDiskSpaceLabel()
         }
     }
 
-    const QString freeSpace = Utils::Misc::friendlyUnit(queryFreeDiskSpace(m_ui->savePath->selectedPath()));
+    const Path savePath = m_ui->savePath->selectedPath();
+    if (savePath != m_freeDiskSpacePath)
+    {
+        m_freeDiskSpacePath = savePath;
+        m_freeDiskSpace.reset();
+        m_diskSpaceQueryPool.start([this, savePath]
+        {
+            const qint64 freeDiskSpace = queryFreeDiskSpace(savePath);
+            QMetaObject::invokeMethod(this, [this, savePath, freeDiskSpace]
+            {
+                // ignore the result if the save path has been changed in the meantime
+                if (savePath != m_freeDiskSpacePath)
+                    return;
+
+                m_freeDiskSpace = freeDiskSpace;
+                updateDiskSpaceLabel();
+            });
+        });
+    }
+
+    const QString freeSpace = m_freeDiskSpace
+            ? Utils::Misc::friendlyUnit(*m_freeDiskSpace) : tr("Calculating...", "Free disk space is being calculated");
     const QString sizeString = tr("%1 (Free space on disk: %2)").arg(
         ((torrentSize > 0) ? Utils::Misc::friendlyUnit(torrentSize) : tr("Not available", "This size is unavailable."))
         , freeSpace);
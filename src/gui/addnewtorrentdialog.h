@@ -30,8 +30,10 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
 #include <QDialog>
+#include <QThreadPool>
 
 #include "base/path.h"
 #include "base/settingvalue.h"
@@ -112,4 +114,9 @@ private:
     SettingValue<QByteArray> m_storeTreeHeaderState;
     SettingValue<QByteArray> m_storeSplitterState;
     SettingValue<FilterPatternFormat> m_storeFilterPatternFormat;
+
+    // free disk space is queried in background since it can take a while (e.g. for network drives)
+    Path m_freeDiskSpacePath;
+    std::optional<qint64> m_freeDiskSpace;
+    QThreadPool m_diskSpaceQueryPool;
 };
@@ -35,9 +35,12 @@
 #include <QLabel>
 #include <QNetworkInterface>
 
+#include "base/bittorrent/bandwidthprofile.h"
 #include "base/bittorrent/session.h"
 #include "base/global.h"
 #include "base/preferences.h"
+#include "base/rss/rss_autodownloader.h"
+#include "base/rss/rss_session.h"
 #include "base/unicodestrings.h"
 #include "gui/addnewtorrentdialog.h"
 #include "gui/desktopintegration.h"
@@ -63,13 +66,24 @@ namespace
         // qBittorrent section
         QBITTORRENT_HEADER,
         RESUME_DATA_STORAGE,
+        SHARDED_RESUME_DATA_STORAGE,
+        DEFER_STOPPED_TORRENTS_LOADING,
+        TRUSTED_RESUME_DATA,
+        RESUME_DATA_STORAGE_BATCH_SIZE,
+        RESUME_DATA_STORAGE_BATCH_LATENCY,
         TORRENT_CONTENT_REMOVE_OPTION,
+        MAX_ACTIVE_MOVE_STORAGE_JOBS_PER_DEVICE,
+        MAX_ACTIVE_CHECKING_TORRENTS_PER_DEVICE,
+        MAX_ACTIVE_METADATA_DOWNLOADS,
+        METADATA_DOWNLOAD_TIMEOUT,
 #if defined(QBT_USES_LIBTORRENT2) && !defined(Q_OS_MACOS)
         MEMORY_WORKING_SET_LIMIT,
 #endif
 #if defined(Q_OS_WIN)
         OS_MEMORY_PRIORITY,
 #endif
+        STALL_WATCHDOG,
+        STALL_WATCHDOG_THRESHOLD,
         // network interface
         NETWORK_IFACE,
         //Optional network address
@@ -81,6 +95,12 @@ namespace
         RECHECK_COMPLETED,
         CONFIRM_AUTO_BAN_UNKNOWN_PEER,
         CONFIRM_AUTO_BAN_BT_Player,
+        AUTO_BAN_FAKE_PROGRESS_PEER,
+        FAKE_PROGRESS_PEER_MIN_UPLOAD,
+        FAKE_PROGRESS_PEER_MIN_PROGRESS,
+        BANNED_PEERS_HISTORY_DAYS,
+        AUTORUN_MAX_CONCURRENT_PROGRAMS,
+        AUTORUN_BATCH_MODE,
         // UI related
         APP_INSTANCE_NAME,
         LIST_REFRESH,
@@ -94,6 +114,9 @@ namespace
         CONFIRM_REMOVE_ALL_TAGS,
         CONFIRM_REMOVE_TRACKER_FROM_ALL_TORRENTS,
         REANNOUNCE_WHEN_ADDRESS_CHANGED,
+        ANNOUNCE_RAMP_RATE,
+        ANNOUNCE_JITTER,
+        MAX_PUBLIC_TRACKERS_PER_TORRENT,
         DOWNLOAD_TRACKER_FAVICON,
         SAVE_PATH_HISTORY_LENGTH,
         ENABLE_SPEED_WIDGET,
@@ -108,7 +131,12 @@ namespace
         ENABLE_MARK_OF_THE_WEB,
 #endif // Q_OS_MACOS || Q_OS_WIN
         IGNORE_SSL_ERRORS,
+        DOWNLOAD_CONNECTIONS_PER_HOST,
         PYTHON_EXECUTABLE_PATH,
+        SEARCH_MAX_PARALLEL_PLUGINS,
+        SEARCH_PLUGIN_TIMEOUT,
+        RSS_PARSING_THREADS,
+        RSS_DUPLICATE_ARTICLES_RETENTION,
         START_SESSION_PAUSED,
         SESSION_SHUTDOWN_TIMEOUT,
 
@@ -130,6 +158,9 @@ namespace
         DISK_QUEUE_SIZE,
 #ifdef QBT_USES_LIBTORRENT2
         DISK_IO_TYPE,
+        DISK_IO_JOBS_PER_DEVICE,
+        DISK_IO_READS_PER_HASH_JOB,
+        DISK_READ_CACHE,
 #endif
         DISK_IO_READ_MODE,
         DISK_IO_WRITE_MODE,
@@ -168,8 +199,14 @@ namespace
         PEER_TURNOVER,
         PEER_TURNOVER_CUTOFF,
         PEER_TURNOVER_INTERVAL,
+        CONNECTIONS_REBALANCING,
         REQUEST_QUEUE_SIZE,
         DHT_BOOTSTRAP_NODES,
+        IP_FILTER_SUBSCRIPTIONS,
+        IP_FILTER_SUBSCRIPTIONS_REFRESH_INTERVAL,
+        BLOCKED_COUNTRIES,
+        SCHEDULER_PROFILES,
+        SCHEDULER_TRANSITION_TIME,
 #if defined(QBT_USES_LIBTORRENT2) && TORRENT_USE_I2P
         I2P_INBOUND_QUANTITY,
         I2P_OUTBOUND_QUANTITY,
@@ -207,6 +244,11 @@ void AdvancedSettings::saveAdvancedSettings() const
     BitTorrent::Session *const session = BitTorrent::Session::instance();
 
     session->setResumeDataStorageType(m_comboBoxResumeDataStorage.currentData().value<BitTorrent::ResumeDataStorageType>());
+    session->setResumeDataStorageSharded(m_checkBoxShardedResumeDataStorage.isChecked());
+    session->setDeferredStoppedTorrentsLoadingEnabled(m_checkBoxDeferStoppedTorrentsLoading.isChecked());
+    session->setTrustedResumeDataEnabled(m_checkBoxTrustedResumeData.isChecked());
+    session->setResumeDataStorageBatchSize(m_spinBoxResumeDataStorageBatchSize.value());
+    session->setResumeDataStorageBatchLatency(m_spinBoxResumeDataStorageBatchLatency.value());
 #if defined(QBT_USES_LIBTORRENT2) && !defined(Q_OS_MACOS)
     // Physical memory (RAM) usage limit
     app()->setMemoryWorkingSetLimit(m_spinBoxMemoryWorkingSetLimit.value());
@@ -214,6 +256,9 @@ void AdvancedSettings::saveAdvancedSettings() const
 #if defined(Q_OS_WIN)
     app()->setProcessMemoryPriority(m_comboBoxOSMemoryPriority.currentData().value<MemoryPriority>());
 #endif
+    // Main thread stall watchdog
+    app()->setStallWatchdogEnabled(m_checkBoxStallWatchdog.isChecked());
+    app()->setStallWatchdogThreshold(m_spinBoxStallWatchdogThreshold.value());
     // Bdecode depth limit
     pref->setBdecodeDepthLimit(m_spinBoxBdecodeDepthLimit.value());
     // Bdecode token limit
@@ -237,6 +282,11 @@ void AdvancedSettings::saveAdvancedSettings() const
     session->setDiskQueueSize(m_spinBoxDiskQueueSize.value() * 1024);
 #ifdef QBT_USES_LIBTORRENT2
     session->setDiskIOType(m_comboBoxDiskIOType.currentData().value<BitTorrent::DiskIOType>());
+    // Disk IO scheduling
+    session->setDiskIOJobsPerDevice(m_spinBoxDiskIOJobsPerDevice.value());
+    session->setDiskIOReadsPerHashJob(m_spinBoxDiskIOReadsPerHashJob.value());
+    // Disk read cache
+    session->setDiskReadCacheSize(m_spinBoxDiskReadCache.value());
 #endif
     // Disk IO read mode
     session->setDiskIOReadMode(m_comboBoxDiskIOReadMode.currentData().value<BitTorrent::DiskIOReadMode>());
@@ -315,6 +365,15 @@ void AdvancedSettings::saveAdvancedSettings() const
     session->setAutoBanUnknownPeer(m_autoBanUnknownPeer.isChecked());
     // Auto ban Bittorrent Media Player Peer
     session->setAutoBanBTPlayerPeer(m_autoBanBTPlayerPeer.isChecked());
+    // Auto ban peers reporting fake progress
+    session->setAutoBanFakeProgressPeer(m_checkBoxAutoBanFakeProgressPeer.isChecked());
+    session->setFakeProgressPeerMinUpload(m_spinBoxFakeProgressPeerMinUpload.value());
+    session->setFakeProgressPeerMinProgress(m_spinBoxFakeProgressPeerMinProgress.value());
+    // Banned peers history
+    session->setBannedPeersHistoryDays(m_spinBoxBannedPeersHistoryDays.value());
+    // External programs
+    pref->setAutoRunMaxConcurrentPrograms(m_spinBoxAutoRunMaxConcurrentPrograms.value());
+    pref->setAutoRunBatchModeEnabled(m_checkBoxAutoRunBatchMode.isChecked());
     // Program notification
     app()->desktopIntegration()->setNotificationsEnabled(m_checkBoxProgramNotifications.isChecked());
 #ifdef QBT_USES_DBUS
@@ -323,6 +382,12 @@ void AdvancedSettings::saveAdvancedSettings() const
     app()->setTorrentAddedNotificationsEnabled(m_checkBoxTorrentAddedNotifications.isChecked());
     // Reannounce to all trackers when ip/port changed
     session->setReannounceWhenAddressChangedEnabled(m_checkBoxReannounceWhenAddressChanged.isChecked());
+    // Announce ramp rate
+    session->setAnnounceRampRate(m_spinBoxAnnounceRampRate.value());
+    // Announce jitter
+    session->setAnnounceJitter(m_spinBoxAnnounceJitter.value());
+    // Maximum public trackers per torrent
+    session->setMaxPublicTrackersPerTorrent(m_spinBoxMaxPublicTrackersPerTorrent.value());
     // Misc GUI properties
     app()->mainWindow()->setDownloadTrackerFavicon(m_checkBoxTrackerFavicon.isChecked());
     pref->setAddNewTorrentDialogSavePathHistoryLength(m_spinBoxSavePathHistoryLength.value());
@@ -341,8 +406,16 @@ void AdvancedSettings::saveAdvancedSettings() const
 #endif // Q_OS_MACOS || Q_OS_WIN
     // Ignore SSL errors
     pref->setIgnoreSSLErrors(m_checkBoxIgnoreSSLErrors.isChecked());
+    // Download connections per host
+    pref->setDownloadConnectionsPerHost(m_spinBoxDownloadConnectionsPerHost.value());
     // Python executable path
     pref->setPythonExecutablePath(Path(m_pythonExecutablePath.text().trimmed()));
+    // Search plugins
+    pref->setSearchMaxParallelPlugins(m_spinBoxSearchMaxParallelPlugins.value());
+    pref->setSearchPluginTimeout(m_spinBoxSearchPluginTimeout.value());
+    // RSS parsing threads
+    RSS::Session::instance()->setParsingThreadCount(m_spinBoxRSSParsingThreads.value());
+    RSS::AutoDownloader::instance()->setDuplicateArticlesRetention(m_spinBoxRSSDuplicateArticlesRetention.value());
     // Start session paused
     session->setStartPaused(m_checkBoxStartSessionPaused.isChecked());
     // Session shutdown timeout
@@ -363,10 +436,19 @@ void AdvancedSettings::saveAdvancedSettings() const
     session->setPeerTurnover(m_spinBoxPeerTurnover.value());
     session->setPeerTurnoverCutoff(m_spinBoxPeerTurnoverCutoff.value());
     session->setPeerTurnoverInterval(m_spinBoxPeerTurnoverInterval.value());
+    session->setConnectionsRebalancingEnabled(m_checkBoxConnectionsRebalancing.isChecked());
     // Maximum outstanding requests to a single peer
     session->setRequestQueueSize(m_spinBoxRequestQueueSize.value());
     // DHT bootstrap nodes
     session->setDHTBootstrapNodes(m_lineEditDHTBootstrapNodes.text());
+    // IP filter subscriptions
+    session->setIPFilterSubscriptions(m_lineEditIPFilterSubscriptions.text().split(u',', Qt::SkipEmptyParts));
+    session->setIPFilterSubscriptionsRefreshInterval(m_spinBoxIPFilterSubscriptionsRefreshInterval.value());
+    // Blocked countries
+    session->setBlockedCountries(m_lineEditBlockedCountries.text().split(u',', Qt::SkipEmptyParts));
+    // Scheduler rate profiles
+    pref->setSchedulerProfiles(BandwidthProfile::entriesToString(BandwidthProfile::parseEntries(m_lineEditSchedulerProfiles.text())));
+    pref->setSchedulerTransitionTime(m_spinBoxSchedulerTransitionTime.value());
 #if defined(QBT_USES_LIBTORRENT2) && TORRENT_USE_I2P
     // I2P session options
     session->setI2PInboundQuantity(m_spinBoxI2PInboundQuantity.value());
@@ -376,6 +458,10 @@ void AdvancedSettings::saveAdvancedSettings() const
 #endif
 
     session->setTorrentContentRemoveOption(m_comboBoxTorrentContentRemoveOption.currentData().value<BitTorrent::TorrentContentRemoveOption>());
+    session->setMaxActiveMoveStorageJobsPerDevice(m_spinBoxMaxActiveMoveStorageJobsPerDevice.value());
+    session->setMaxActiveCheckingTorrentsPerDevice(m_spinBoxMaxActiveCheckingTorrentsPerDevice.value());
+    session->setMaxActiveMetadataDownloads(m_spinBoxMaxActiveMetadataDownloads.value());
+    session->setMetadataDownloadTimeout(m_spinBoxMetadataDownloadTimeout.value());
 }
 
 #ifndef QBT_USES_LIBTORRENT2
@@ -484,11 +570,66 @@ void AdvancedSettings::loadAdvancedSettings()
     m_comboBoxResumeDataStorage.setCurrentIndex(m_comboBoxResumeDataStorage.findData(QVariant::fromValue(session->resumeDataStorageType())));
     addRow(RESUME_DATA_STORAGE, tr("Resume data storage type (requires restart)"), &m_comboBoxResumeDataStorage);
 
+    m_checkBoxShardedResumeDataStorage.setToolTip(tr("Fastresume files are spread across subfolders named after the first two characters of torrent ID."
+        " Existing files are moved on the next startup."));
+    m_checkBoxShardedResumeDataStorage.setChecked(session->isResumeDataStorageSharded());
+    addRow(SHARDED_RESUME_DATA_STORAGE, tr("Store fastresume files in subfolders (requires restart)"), &m_checkBoxShardedResumeDataStorage);
+
+    m_checkBoxDeferStoppedTorrentsLoading.setToolTip(tr("Stopped completed torrents are restored in the background once the session is started."
+        " They don't appear in the transfer list until then."));
+    m_checkBoxDeferStoppedTorrentsLoading.setChecked(session->isDeferredStoppedTorrentsLoadingEnabled());
+    addRow(DEFER_STOPPED_TORRENTS_LOADING, tr("Restore stopped completed torrents after startup"), &m_checkBoxDeferStoppedTorrentsLoading);
+
+    m_checkBoxTrustedResumeData.setToolTip(tr("Files of the torrents in the save paths marked on clean shutdown aren't checked against fastresume data on startup."
+        " They are verified later in the background instead."));
+    m_checkBoxTrustedResumeData.setChecked(session->isTrustedResumeDataEnabled());
+    addRow(TRUSTED_RESUME_DATA, tr("Trust fastresume data after clean shutdown"), &m_checkBoxTrustedResumeData);
+
+    m_spinBoxResumeDataStorageBatchSize.setMinimum(1);
+    m_spinBoxResumeDataStorageBatchSize.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxResumeDataStorageBatchSize.setValue(session->resumeDataStorageBatchSize());
+    m_spinBoxResumeDataStorageBatchSize.setToolTip(tr("Maximum number of resume data changes written to SQLite database within single transaction."));
+    addRow(RESUME_DATA_STORAGE_BATCH_SIZE, tr("SQLite database transaction batch size"), &m_spinBoxResumeDataStorageBatchSize);
+
+    m_spinBoxResumeDataStorageBatchLatency.setMinimum(0);
+    m_spinBoxResumeDataStorageBatchLatency.setMaximum(60000);
+    m_spinBoxResumeDataStorageBatchLatency.setValue(session->resumeDataStorageBatchLatency());
+    m_spinBoxResumeDataStorageBatchLatency.setSuffix(tr(" ms", " milliseconds"));
+    m_spinBoxResumeDataStorageBatchLatency.setToolTip(tr("How long to wait for more resume data changes before writing them to SQLite database."));
+    addRow(RESUME_DATA_STORAGE_BATCH_LATENCY, tr("SQLite database transaction batch latency"), &m_spinBoxResumeDataStorageBatchLatency);
+
     m_comboBoxTorrentContentRemoveOption.addItem(tr("Delete files permanently"), QVariant::fromValue(BitTorrent::TorrentContentRemoveOption::Delete));
     m_comboBoxTorrentContentRemoveOption.addItem(tr("Move files to trash (if possible)"), QVariant::fromValue(BitTorrent::TorrentContentRemoveOption::MoveToTrash));
     m_comboBoxTorrentContentRemoveOption.setCurrentIndex(m_comboBoxTorrentContentRemoveOption.findData(QVariant::fromValue(session->torrentContentRemoveOption())));
     addRow(TORRENT_CONTENT_REMOVE_OPTION, tr("Torrent content removing mode"), &m_comboBoxTorrentContentRemoveOption);
 
+    m_spinBoxMaxActiveMoveStorageJobsPerDevice.setMinimum(1);
+    m_spinBoxMaxActiveMoveStorageJobsPerDevice.setMaximum(64);
+    m_spinBoxMaxActiveMoveStorageJobsPerDevice.setValue(session->maxActiveMoveStorageJobsPerDevice());
+    m_spinBoxMaxActiveMoveStorageJobsPerDevice.setToolTip(tr("Torrents moved between different pairs of source and destination devices are moved concurrently."));
+    addRow(MAX_ACTIVE_MOVE_STORAGE_JOBS_PER_DEVICE, tr("Maximum concurrent torrent moves per device"), &m_spinBoxMaxActiveMoveStorageJobsPerDevice);
+
+    m_spinBoxMaxActiveCheckingTorrentsPerDevice.setMinimum(0);
+    m_spinBoxMaxActiveCheckingTorrentsPerDevice.setMaximum(64);
+    m_spinBoxMaxActiveCheckingTorrentsPerDevice.setSpecialValueText(tr("Disabled"));
+    m_spinBoxMaxActiveCheckingTorrentsPerDevice.setValue(session->maxActiveCheckingTorrentsPerDevice());
+    m_spinBoxMaxActiveCheckingTorrentsPerDevice.setToolTip(tr("Torrents stored on different devices are checked concurrently, smaller torrents are checked first."));
+    addRow(MAX_ACTIVE_CHECKING_TORRENTS_PER_DEVICE, tr("Maximum concurrent torrent checks per device"), &m_spinBoxMaxActiveCheckingTorrentsPerDevice);
+
+    m_spinBoxMaxActiveMetadataDownloads.setMinimum(0);
+    m_spinBoxMaxActiveMetadataDownloads.setMaximum(1000);
+    m_spinBoxMaxActiveMetadataDownloads.setSpecialValueText(tr("Disabled"));
+    m_spinBoxMaxActiveMetadataDownloads.setValue(session->maxActiveMetadataDownloads());
+    m_spinBoxMaxActiveMetadataDownloads.setToolTip(tr("Queued torrents added without metadata are started to download it regardless of the download slots."));
+    addRow(MAX_ACTIVE_METADATA_DOWNLOADS, tr("Maximum concurrent metadata downloads of queued torrents"), &m_spinBoxMaxActiveMetadataDownloads);
+
+    m_spinBoxMetadataDownloadTimeout.setMinimum(30);
+    m_spinBoxMetadataDownloadTimeout.setMaximum(86400);
+    m_spinBoxMetadataDownloadTimeout.setValue(session->metadataDownloadTimeout());
+    m_spinBoxMetadataDownloadTimeout.setSuffix(tr(" s", " seconds"));
+    m_spinBoxMetadataDownloadTimeout.setToolTip(tr("Torrent which didn't get metadata in time is returned to the queue."));
+    addRow(METADATA_DOWNLOAD_TIMEOUT, tr("Metadata download timeout of queued torrents"), &m_spinBoxMetadataDownloadTimeout);
+
 #if defined(QBT_USES_LIBTORRENT2) && !defined(Q_OS_MACOS)
     // Physical memory (RAM) usage limit
     m_spinBoxMemoryWorkingSetLimit.setMinimum(1);
@@ -510,6 +651,15 @@ void AdvancedSettings::loadAdvancedSettings()
         + u' ' + makeLink(u"https://docs.microsoft.com/en-us/windows/win32/api/processthreadsapi/ns-processthreadsapi-memory_priority_information", u"(?)"))
         , &m_comboBoxOSMemoryPriority);
 #endif
+    // Main thread stall watchdog
+    m_checkBoxStallWatchdog.setChecked(app()->isStallWatchdogEnabled());
+    m_checkBoxStallWatchdog.setToolTip(tr("Reports the periods when the application doesn't respond to the log and to the \"qbittorrent-stalls.log\" file in the log folder"));
+    addRow(STALL_WATCHDOG, tr("Report application stalls"), &m_checkBoxStallWatchdog);
+    m_spinBoxStallWatchdogThreshold.setMinimum(100);
+    m_spinBoxStallWatchdogThreshold.setMaximum(60000);
+    m_spinBoxStallWatchdogThreshold.setSuffix(tr(" ms", " milliseconds"));
+    m_spinBoxStallWatchdogThreshold.setValue(app()->stallWatchdogThreshold());
+    addRow(STALL_WATCHDOG_THRESHOLD, tr("Stall report threshold"), &m_spinBoxStallWatchdogThreshold);
     // Bdecode depth limit
     m_spinBoxBdecodeDepthLimit.setMinimum(0);
     m_spinBoxBdecodeDepthLimit.setMaximum(std::numeric_limits<int>::max());
@@ -595,9 +745,36 @@ void AdvancedSettings::loadAdvancedSettings()
     m_comboBoxDiskIOType.addItem(tr("Memory mapped files"), QVariant::fromValue(BitTorrent::DiskIOType::MMap));
     m_comboBoxDiskIOType.addItem(tr("POSIX-compliant"), QVariant::fromValue(BitTorrent::DiskIOType::Posix));
     m_comboBoxDiskIOType.addItem(tr("Simple pread/pwrite"), QVariant::fromValue(BitTorrent::DiskIOType::SimplePreadPwrite));
+#ifdef QBT_USES_IO_URING
+    m_comboBoxDiskIOType.addItem(tr("io_uring"), QVariant::fromValue(BitTorrent::DiskIOType::IOUring));
+#endif
     m_comboBoxDiskIOType.setCurrentIndex(m_comboBoxDiskIOType.findData(QVariant::fromValue(session->diskIOType())));
     addRow(DISK_IO_TYPE, tr("Disk IO type (requires restart)") + u' ' + makeLink(u"https://www.libtorrent.org/single-page-ref.html#default-disk-io-constructor", u"(?)")
            , &m_comboBoxDiskIOType);
+    // Disk IO scheduling
+    m_spinBoxDiskIOJobsPerDevice.setMinimum(0);
+    m_spinBoxDiskIOJobsPerDevice.setMaximum(1024);
+    m_spinBoxDiskIOJobsPerDevice.setSpecialValueText(tr("Unlimited"));
+    m_spinBoxDiskIOJobsPerDevice.setValue(session->diskIOJobsPerDevice());
+    m_spinBoxDiskIOJobsPerDevice.setToolTip(tr("Maximum number of read and hash jobs running at once on the same storage device. Slow device then doesn't hold back the others."));
+    addRow(DISK_IO_JOBS_PER_DEVICE, tr("Disk IO jobs per storage device"), &m_spinBoxDiskIOJobsPerDevice);
+    m_spinBoxDiskIOReadsPerHashJob.setMinimum(1);
+    m_spinBoxDiskIOReadsPerHashJob.setMaximum(1024);
+    m_spinBoxDiskIOReadsPerHashJob.setValue(session->diskIOReadsPerHashJob());
+    m_spinBoxDiskIOReadsPerHashJob.setToolTip(tr("When jobs wait for busy storage device, peer reads are preferred and waiting hash job is run after this many reads."));
+    addRow(DISK_IO_READS_PER_HASH_JOB, tr("Peer reads per hash job on busy device"), &m_spinBoxDiskIOReadsPerHashJob);
+    // Disk read cache
+    m_spinBoxDiskReadCache.setMinimum(0);
+#ifdef QBT_APP_64BIT
+    m_spinBoxDiskReadCache.setMaximum(65536);
+#else
+    m_spinBoxDiskReadCache.setMaximum(1024);
+#endif
+    m_spinBoxDiskReadCache.setSpecialValueText(tr("Disabled"));
+    m_spinBoxDiskReadCache.setSuffix(tr(" MiB"));
+    m_spinBoxDiskReadCache.setValue(session->diskReadCacheSize());
+    m_spinBoxDiskReadCache.setToolTip(tr("Keeps blocks requested by many peers in memory, so that they aren't read from disk again for each peer."));
+    addRow(DISK_READ_CACHE, tr("Cache of popular pieces"), &m_spinBoxDiskReadCache);
 #endif
     // Disk IO read mode
     m_comboBoxDiskIOReadMode.addItem(tr("Disable OS cache"), QVariant::fromValue(BitTorrent::DiskIOReadMode::DisableOSCache));
@@ -802,6 +979,37 @@ void AdvancedSettings::loadAdvancedSettings()
     // Auto Ban Bittorrent Media Player Peer
     m_autoBanBTPlayerPeer.setChecked(session->isAutoBanBTPlayerPeerEnabled());
     addRow(CONFIRM_AUTO_BAN_BT_Player, tr("Auto Ban Bittorrent Media Player Peer"), &m_autoBanBTPlayerPeer);
+    // Auto ban peers reporting fake progress
+    m_checkBoxAutoBanFakeProgressPeer.setChecked(session->isAutoBanFakeProgressPeerEnabled());
+    addRow(AUTO_BAN_FAKE_PROGRESS_PEER, tr("Auto ban peers taking upload without making progress"), &m_checkBoxAutoBanFakeProgressPeer);
+    m_spinBoxFakeProgressPeerMinUpload.setMinimum(1);
+    m_spinBoxFakeProgressPeerMinUpload.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxFakeProgressPeerMinUpload.setValue(session->fakeProgressPeerMinUpload());
+    m_spinBoxFakeProgressPeerMinUpload.setSuffix(tr(" MiB"));
+    addRow(FAKE_PROGRESS_PEER_MIN_UPLOAD, tr("Uploaded data before checking peer progress"), &m_spinBoxFakeProgressPeerMinUpload);
+    m_spinBoxFakeProgressPeerMinProgress.setMinimum(1);
+    m_spinBoxFakeProgressPeerMinProgress.setMaximum(100);
+    m_spinBoxFakeProgressPeerMinProgress.setValue(session->fakeProgressPeerMinProgress());
+    m_spinBoxFakeProgressPeerMinProgress.setSuffix(u" %"_s);
+    addRow(FAKE_PROGRESS_PEER_MIN_PROGRESS, tr("Minimum peer progress relative to uploaded data"), &m_spinBoxFakeProgressPeerMinProgress);
+    // Banned peers history
+    m_spinBoxBannedPeersHistoryDays.setMinimum(0);
+    m_spinBoxBannedPeersHistoryDays.setMaximum(3650);
+    m_spinBoxBannedPeersHistoryDays.setValue(session->bannedPeersHistoryDays());
+    m_spinBoxBannedPeersHistoryDays.setSuffix(tr(" days"));
+    m_spinBoxBannedPeersHistoryDays.setSpecialValueText(tr("Forever"));
+    addRow(BANNED_PEERS_HISTORY_DAYS, tr("Keep banned peers history for"), &m_spinBoxBannedPeersHistoryDays);
+    // External programs
+    m_spinBoxAutoRunMaxConcurrentPrograms.setMinimum(0);
+    m_spinBoxAutoRunMaxConcurrentPrograms.setMaximum(64);
+    m_spinBoxAutoRunMaxConcurrentPrograms.setSpecialValueText(tr("Unlimited"));
+    m_spinBoxAutoRunMaxConcurrentPrograms.setValue(pref->autoRunMaxConcurrentPrograms());
+    m_spinBoxAutoRunMaxConcurrentPrograms.setToolTip(tr("Further runs of external program wait in queue until some of the running ones finish"));
+    addRow(AUTORUN_MAX_CONCURRENT_PROGRAMS, tr("External programs running at once"), &m_spinBoxAutoRunMaxConcurrentPrograms);
+    m_checkBoxAutoRunBatchMode.setChecked(pref->isAutoRunBatchModeEnabled());
+    m_checkBoxAutoRunBatchMode.setToolTip(tr("External program is run once for the torrents added or finished shortly one after another. "
+        "They are passed as JSON array to its standard input and the parameters in command line aren't replaced."));
+    addRow(AUTORUN_BATCH_MODE, tr("Run external program once per batch of torrents"), &m_checkBoxAutoRunBatchMode);
     // Max concurrent HTTP announces
     m_spinBoxMaxConcurrentHTTPAnnounces.setMaximum(std::numeric_limits<int>::max());
     m_spinBoxMaxConcurrentHTTPAnnounces.setValue(session->maxConcurrentHTTPAnnounces());
@@ -833,6 +1041,27 @@ void AdvancedSettings::loadAdvancedSettings()
     // Reannounce to all trackers when ip/port changed
     m_checkBoxReannounceWhenAddressChanged.setChecked(session->isReannounceWhenAddressChangedEnabled());
     addRow(REANNOUNCE_WHEN_ADDRESS_CHANGED, tr("Reannounce to all trackers when IP or port changed"), &m_checkBoxReannounceWhenAddressChanged);
+    // Announce ramp rate
+    m_spinBoxAnnounceRampRate.setMinimum(1);
+    m_spinBoxAnnounceRampRate.setMaximum(1000);
+    m_spinBoxAnnounceRampRate.setValue(session->announceRampRate());
+    m_spinBoxAnnounceRampRate.setSuffix(tr(" /s", " per second"));
+    m_spinBoxAnnounceRampRate.setToolTip(tr("Forced reannounces exceeding this rate are delayed for each tracker host."));
+    addRow(ANNOUNCE_RAMP_RATE, tr("Maximum reannounces per tracker host"), &m_spinBoxAnnounceRampRate);
+    // Announce jitter
+    m_spinBoxAnnounceJitter.setMinimum(0);
+    m_spinBoxAnnounceJitter.setMaximum(3600);
+    m_spinBoxAnnounceJitter.setValue(session->announceJitter());
+    m_spinBoxAnnounceJitter.setSuffix(tr(" s", " seconds"));
+    m_spinBoxAnnounceJitter.setSpecialValueText(tr("0 (disabled)"));
+    m_spinBoxAnnounceJitter.setToolTip(tr("Reannounces of all torrents are additionally delayed by random time up to this value."));
+    addRow(ANNOUNCE_JITTER, tr("Reannounce to all trackers jitter"), &m_spinBoxAnnounceJitter);
+    // Maximum public trackers per torrent
+    m_spinBoxMaxPublicTrackersPerTorrent.setMinimum(1);
+    m_spinBoxMaxPublicTrackersPerTorrent.setMaximum(1000);
+    m_spinBoxMaxPublicTrackersPerTorrent.setValue(session->maxPublicTrackersPerTorrent());
+    m_spinBoxMaxPublicTrackersPerTorrent.setToolTip(tr("Only the public trackers having the best announce success rate and response time are added to torrents."));
+    addRow(MAX_PUBLIC_TRACKERS_PER_TORRENT, tr("Maximum public trackers per torrent"), &m_spinBoxMaxPublicTrackersPerTorrent);
     // Download tracker's favicon
     m_checkBoxTrackerFavicon.setChecked(app()->mainWindow()->isDownloadTrackerFavicon());
     addRow(DOWNLOAD_TRACKER_FAVICON, tr("Download tracker's favicon"), &m_checkBoxTrackerFavicon);
@@ -873,10 +1102,42 @@ void AdvancedSettings::loadAdvancedSettings()
     m_checkBoxIgnoreSSLErrors.setChecked(pref->isIgnoreSSLErrors());
     m_checkBoxIgnoreSSLErrors.setToolTip(tr("Affects certificate validation and non-torrent protocol activities (e.g. RSS feeds, program updates, torrent files, geoip db, etc)"));
     addRow(IGNORE_SSL_ERRORS, tr("Ignore SSL errors"), &m_checkBoxIgnoreSSLErrors);
+    // Download connections per host
+    m_spinBoxDownloadConnectionsPerHost.setMinimum(1);
+    m_spinBoxDownloadConnectionsPerHost.setMaximum(64);
+    m_spinBoxDownloadConnectionsPerHost.setValue(pref->getDownloadConnectionsPerHost());
+    m_spinBoxDownloadConnectionsPerHost.setToolTip(tr("Maximum number of simultaneous non-torrent downloads (e.g. RSS feeds, torrent files, icons) from the same host."));
+    addRow(DOWNLOAD_CONNECTIONS_PER_HOST, tr("Download connections per host"), &m_spinBoxDownloadConnectionsPerHost);
     // Python executable path
     m_pythonExecutablePath.setPlaceholderText(tr("(Auto detect if empty)"));
     m_pythonExecutablePath.setText(pref->getPythonExecutablePath().toString());
     addRow(PYTHON_EXECUTABLE_PATH, tr("Python executable path (may require restart)"), &m_pythonExecutablePath);
+    // Search plugins
+    m_spinBoxSearchMaxParallelPlugins.setMinimum(0);
+    m_spinBoxSearchMaxParallelPlugins.setMaximum(64);
+    m_spinBoxSearchMaxParallelPlugins.setSpecialValueText(tr("Disabled"));
+    m_spinBoxSearchMaxParallelPlugins.setValue(pref->searchMaxParallelPlugins());
+    m_spinBoxSearchMaxParallelPlugins.setToolTip(tr("Run each search plugin in its own process, at most this many at once. When disabled all plugins share single process."));
+    addRow(SEARCH_MAX_PARALLEL_PLUGINS, tr("Parallel search plugin processes"), &m_spinBoxSearchMaxParallelPlugins);
+    m_spinBoxSearchPluginTimeout.setMinimum(1);
+    m_spinBoxSearchPluginTimeout.setMaximum(180);
+    m_spinBoxSearchPluginTimeout.setSuffix(tr(" s", " seconds"));
+    m_spinBoxSearchPluginTimeout.setValue(pref->searchPluginTimeout());
+    m_spinBoxSearchPluginTimeout.setToolTip(tr("Search plugin running in its own process is stopped if it doesn't finish in time."));
+    addRow(SEARCH_PLUGIN_TIMEOUT, tr("Search plugin timeout"), &m_spinBoxSearchPluginTimeout);
+    // RSS parsing threads
+    m_spinBoxRSSParsingThreads.setMinimum(1);
+    m_spinBoxRSSParsingThreads.setMaximum(64);
+    m_spinBoxRSSParsingThreads.setValue(RSS::Session::instance()->parsingThreadCount());
+    m_spinBoxRSSParsingThreads.setToolTip(tr("Maximum number of RSS feeds parsed simultaneously."));
+    addRow(RSS_PARSING_THREADS, tr("RSS parsing threads"), &m_spinBoxRSSParsingThreads);
+    m_spinBoxRSSDuplicateArticlesRetention.setMinimum(0);
+    m_spinBoxRSSDuplicateArticlesRetention.setMaximum(24 * 30);
+    m_spinBoxRSSDuplicateArticlesRetention.setValue(RSS::AutoDownloader::instance()->duplicateArticlesRetention());
+    m_spinBoxRSSDuplicateArticlesRetention.setSuffix(tr(" h", " hours"));
+    m_spinBoxRSSDuplicateArticlesRetention.setSpecialValueText(tr("Disabled"));
+    m_spinBoxRSSDuplicateArticlesRetention.setToolTip(tr("Articles of the torrents downloaded by RSS auto downloader within this time are skipped in all feeds."));
+    addRow(RSS_DUPLICATE_ARTICLES_RETENTION, tr("RSS duplicate articles retention"), &m_spinBoxRSSDuplicateArticlesRetention);
     // Start session paused
     m_checkBoxStartSessionPaused.setChecked(session->isStartPaused());
     addRow(START_SESSION_PAUSED, tr("Start BitTorrent session in paused state"), &m_checkBoxStartSessionPaused);
@@ -945,6 +1206,9 @@ void AdvancedSettings::loadAdvancedSettings()
     m_spinBoxPeerTurnoverInterval.setValue(session->peerTurnoverInterval());
     addRow(PEER_TURNOVER_INTERVAL, (tr("Peer turnover disconnect interval") + u' ' + makeLink(u"https://www.libtorrent.org/reference-Settings.html#peer_turnover", u"(?)"))
             , &m_spinBoxPeerTurnoverInterval);
+    m_checkBoxConnectionsRebalancing.setChecked(session->isConnectionsRebalancingEnabled());
+    m_checkBoxConnectionsRebalancing.setToolTip(tr("Global maximum number of connections is distributed among the running torrents according to their demand instead of the per-torrent limit."));
+    addRow(CONNECTIONS_REBALANCING, tr("Rebalance connections among torrents"), &m_checkBoxConnectionsRebalancing);
     // Maximum outstanding requests to a single peer
     m_spinBoxRequestQueueSize.setMinimum(1);
     m_spinBoxRequestQueueSize.setMaximum(std::numeric_limits<int>::max());
@@ -956,6 +1220,33 @@ void AdvancedSettings::loadAdvancedSettings()
     m_lineEditDHTBootstrapNodes.setText(session->getDHTBootstrapNodes());
     addRow(DHT_BOOTSTRAP_NODES, (tr("DHT bootstrap nodes") + u' ' + makeLink(u"https://www.libtorrent.org/reference-Settings.html#dht_bootstrap_nodes", u"(?)"))
         , &m_lineEditDHTBootstrapNodes);
+    // IP filter subscriptions
+    m_lineEditIPFilterSubscriptions.setPlaceholderText(tr("Comma-separated URLs of .dat, .p2p or .p2b lists"));
+    m_lineEditIPFilterSubscriptions.setText(session->IPFilterSubscriptions().join(u','));
+    m_lineEditIPFilterSubscriptions.setToolTip(tr("Remote IP filter lists merged with the filter file while IP filtering is enabled."));
+    addRow(IP_FILTER_SUBSCRIPTIONS, tr("IP filter subscriptions"), &m_lineEditIPFilterSubscriptions);
+    // IP filter subscriptions refresh interval
+    m_spinBoxIPFilterSubscriptionsRefreshInterval.setMinimum(1);
+    m_spinBoxIPFilterSubscriptionsRefreshInterval.setMaximum(24 * 30);
+    m_spinBoxIPFilterSubscriptionsRefreshInterval.setValue(session->IPFilterSubscriptionsRefreshInterval());
+    m_spinBoxIPFilterSubscriptionsRefreshInterval.setSuffix(tr(" h"));
+    addRow(IP_FILTER_SUBSCRIPTIONS_REFRESH_INTERVAL, tr("IP filter subscriptions refresh interval"), &m_spinBoxIPFilterSubscriptionsRefreshInterval);
+    // Blocked countries
+    m_lineEditBlockedCountries.setPlaceholderText(tr("Comma-separated country codes, e.g. AA, BB"));
+    m_lineEditBlockedCountries.setText(session->blockedCountries().join(u", "));
+    m_lineEditBlockedCountries.setToolTip(tr("Address ranges of these countries are taken from IP geolocation database and blocked by IP filter, so their peers aren't connected at all."));
+    addRow(BLOCKED_COUNTRIES, tr("Blocked countries"), &m_lineEditBlockedCountries);
+    // Scheduler rate profiles
+    m_lineEditSchedulerProfiles.setPlaceholderText(tr("e.g. 07:00=30, 18:00=10, 22:00=100"));
+    m_lineEditSchedulerProfiles.setText(pref->getSchedulerProfiles());
+    m_lineEditSchedulerProfiles.setToolTip(tr("Percentages of the global speed limits in effect from the given time of day, used by the scheduler instead of the alternative speed limits."));
+    addRow(SCHEDULER_PROFILES, tr("Scheduler rate profiles"), &m_lineEditSchedulerProfiles);
+    // Scheduler transition time
+    m_spinBoxSchedulerTransitionTime.setMinimum(0);
+    m_spinBoxSchedulerTransitionTime.setMaximum(120);
+    m_spinBoxSchedulerTransitionTime.setValue(pref->getSchedulerTransitionTime());
+    m_spinBoxSchedulerTransitionTime.setSuffix(tr(" min"));
+    addRow(SCHEDULER_TRANSITION_TIME, tr("Scheduler rate profile transition time"), &m_spinBoxSchedulerTransitionTime);
 #if defined(QBT_USES_LIBTORRENT2) && TORRENT_USE_I2P
     // I2P session options
     m_spinBoxI2PInboundQuantity.setMinimum(1);
@@ -68,22 +68,32 @@ private:
     void loadAdvancedSettings();
     template <typename T> void addRow(int row, const QString &text, T *widget);
 
-    QSpinBox m_spinBoxSaveResumeDataInterval, m_spinBoxTorrentFileSizeLimit, m_spinBoxBdecodeDepthLimit, m_spinBoxBdecodeTokenLimit,
+    QSpinBox m_spinBoxSaveResumeDataInterval, m_spinBoxResumeDataStorageBatchSize, m_spinBoxResumeDataStorageBatchLatency, m_spinBoxTorrentFileSizeLimit, m_spinBoxBdecodeDepthLimit, m_spinBoxBdecodeTokenLimit,
              m_spinBoxAsyncIOThreads, m_spinBoxFilePoolSize, m_spinBoxCheckingMemUsage, m_spinBoxDiskQueueSize,
              m_spinBoxOutgoingPortsMin, m_spinBoxOutgoingPortsMax, m_spinBoxUPnPLeaseDuration, m_spinBoxPeerToS,
              m_spinBoxListRefresh, m_spinBoxTrackerPort, m_spinBoxSendBufferWatermark, m_spinBoxSendBufferLowWatermark,
              m_spinBoxSendBufferWatermarkFactor, m_spinBoxConnectionSpeed, m_spinBoxSocketSendBufferSize, m_spinBoxSocketReceiveBufferSize, m_spinBoxSocketBacklogSize,
-             m_spinBoxMaxConcurrentHTTPAnnounces, m_spinBoxStopTrackerTimeout, m_spinBoxSessionShutdownTimeout,
-             m_spinBoxSavePathHistoryLength, m_spinBoxPeerTurnover, m_spinBoxPeerTurnoverCutoff, m_spinBoxPeerTurnoverInterval, m_spinBoxRequestQueueSize;
+             m_spinBoxMaxConcurrentHTTPAnnounces, m_spinBoxStopTrackerTimeout, m_spinBoxSessionShutdownTimeout, m_spinBoxRSSParsingThreads, m_spinBoxRSSDuplicateArticlesRetention, m_spinBoxDownloadConnectionsPerHost,
+             m_spinBoxSavePathHistoryLength, m_spinBoxPeerTurnover, m_spinBoxPeerTurnoverCutoff, m_spinBoxPeerTurnoverInterval, m_spinBoxRequestQueueSize,
+             m_spinBoxIPFilterSubscriptionsRefreshInterval, m_spinBoxMaxActiveMoveStorageJobsPerDevice, m_spinBoxMaxActiveCheckingTorrentsPerDevice,
+             m_spinBoxMaxActiveMetadataDownloads, m_spinBoxMetadataDownloadTimeout,
+             m_spinBoxMaxPublicTrackersPerTorrent, m_spinBoxAnnounceRampRate, m_spinBoxAnnounceJitter, m_spinBoxSchedulerTransitionTime,
+             m_spinBoxSearchMaxParallelPlugins, m_spinBoxSearchPluginTimeout, m_spinBoxDiskIOJobsPerDevice,
+             m_spinBoxDiskIOReadsPerHashJob, m_spinBoxDiskReadCache, m_spinBoxStallWatchdogThreshold,
+             m_spinBoxFakeProgressPeerMinUpload, m_spinBoxFakeProgressPeerMinProgress,
+             m_spinBoxBannedPeersHistoryDays, m_spinBoxAutoRunMaxConcurrentPrograms;
     QCheckBox m_checkBoxOsCache, m_checkBoxRecheckCompleted, m_checkBoxResolveCountries, m_checkBoxResolveHosts,
               m_checkBoxProgramNotifications, m_checkBoxTorrentAddedNotifications, m_checkBoxReannounceWhenAddressChanged, m_checkBoxTrackerFavicon, m_checkBoxTrackerStatus,
               m_checkBoxTrackerPortForwarding, m_checkBoxIgnoreSSLErrors, m_checkBoxConfirmTorrentRecheck, m_checkBoxConfirmRemoveAllTags, m_checkBoxAnnounceAllTrackers,
               m_checkBoxAnnounceAllTiers, m_checkBoxMultiConnectionsPerIp, m_checkBoxValidateHTTPSTrackerCertificate, m_checkBoxSSRFMitigation, m_checkBoxBlockPeersOnPrivilegedPorts,
               m_checkBoxPieceExtentAffinity, m_checkBoxSuggestMode, m_checkBoxSpeedWidgetEnabled, m_checkBoxIDNSupport, m_checkBoxConfirmRemoveTrackerFromAllTorrents,
-              m_checkBoxStartSessionPaused, m_autoBanUnknownPeer, m_autoBanBTPlayerPeer;
+              m_checkBoxStartSessionPaused, m_autoBanUnknownPeer, m_autoBanBTPlayerPeer, m_checkBoxDeferStoppedTorrentsLoading, m_checkBoxTrustedResumeData,
+              m_checkBoxShardedResumeDataStorage, m_checkBoxStallWatchdog, m_checkBoxAutoBanFakeProgressPeer, m_checkBoxAutoRunBatchMode,
+              m_checkBoxConnectionsRebalancing;
     QComboBox m_comboBoxInterface, m_comboBoxInterfaceAddress, m_comboBoxDiskIOReadMode, m_comboBoxDiskIOWriteMode, m_comboBoxUtpMixedMode, m_comboBoxChokingAlgorithm,
               m_comboBoxSeedChokingAlgorithm, m_comboBoxResumeDataStorage, m_comboBoxTorrentContentRemoveOption;
-    QLineEdit m_lineEditAppInstanceName, m_pythonExecutablePath, m_lineEditAnnounceIP, m_lineEditDHTBootstrapNodes;
+    QLineEdit m_lineEditAppInstanceName, m_pythonExecutablePath, m_lineEditAnnounceIP, m_lineEditDHTBootstrapNodes, m_lineEditIPFilterSubscriptions, m_lineEditBlockedCountries,
+              m_lineEditSchedulerProfiles;
 
 #ifndef QBT_USES_LIBTORRENT2
     QSpinBox m_spinBoxCache, m_spinBoxCacheTTL;
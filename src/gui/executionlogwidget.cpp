@@ -29,11 +29,17 @@
 #include "executionlogwidget.h"
 
 #include <QDateTime>
+#include <QHBoxLayout>
+#include <QHeaderView>
 #include <QMenu>
 #include <QPalette>
+#include <QPushButton>
+#include <QTreeView>
+#include <QVBoxLayout>
 
 #include "base/global.h"
-#include "log/logfiltermodel.h"
+#include "lineedit.h"
+#include "log/bannedpeersmodel.h"
 #include "log/loglistview.h"
 #include "log/logmodel.h"
 #include "ui_executionlogwidget.h"
@@ -42,35 +48,38 @@
 ExecutionLogWidget::ExecutionLogWidget(const Log::MsgTypes types, QWidget *parent)
     : QWidget(parent)
     , m_ui(new Ui::ExecutionLogWidget)
-    , m_messageFilterModel(new LogFilterModel(types, this))
+    , m_messageModel(new LogMessageModel(types, this))
+    , m_peerModel(new LogPeerModel(this))
 {
     m_ui->setupUi(this);
 
-    LogMessageModel *messageModel = new LogMessageModel(this);
-    m_messageFilterModel->setSourceModel(messageModel);
     LogListView *messageView = new LogListView(this);
-    messageView->setModel(m_messageFilterModel);
+    messageView->setModel(m_messageModel);
     messageView->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(messageView, &LogListView::customContextMenuRequested, this, [this, messageView, messageModel]()
+    connect(messageView, &LogListView::customContextMenuRequested, this, [this, messageView]()
     {
-        displayContextMenu(messageView, messageModel);
+        displayContextMenu(messageView, m_messageModel);
     });
 
-    LogPeerModel *peerModel = new LogPeerModel(this);
     LogListView *peerView = new LogListView(this);
-    peerView->setModel(peerModel);
+    peerView->setModel(m_peerModel);
     peerView->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(peerView, &LogListView::customContextMenuRequested, this, [this, peerView, peerModel]()
+    connect(peerView, &LogListView::customContextMenuRequested, this, [this, peerView]()
     {
-        displayContextMenu(peerView, peerModel);
+        displayContextMenu(peerView, m_peerModel);
     });
 
+    // the models only follow the log while their tab is visible
+    connect(m_ui->tabConsole, &QTabWidget::currentChanged, this, &ExecutionLogWidget::updateModelsActivity);
+
     m_ui->tabGeneral->layout()->addWidget(messageView);
     m_ui->tabBan->layout()->addWidget(peerView);
+    initBannedPeersHistory();
 
 #ifndef Q_OS_MACOS
     m_ui->tabConsole->setTabIcon(0, UIThemeManager::instance()->getIcon(u"help-contents"_s, u"view-calendar-journal"_s));
     m_ui->tabConsole->setTabIcon(1, UIThemeManager::instance()->getIcon(u"ip-blocked"_s, u"view-filter"_s));
+    m_ui->tabConsole->setTabIcon(2, UIThemeManager::instance()->getIcon(u"view-calendar-journal"_s));
 #endif
 }
 
@@ -81,7 +90,63 @@ ExecutionLogWidget::~ExecutionLogWidget()
 
 void ExecutionLogWidget::setMessageTypes(const Log::MsgTypes types)
 {
-    m_messageFilterModel->setMessageTypes(types);
+    m_messageModel->setMessageTypes(types);
+}
+
+void ExecutionLogWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    updateModelsActivity();
+}
+
+void ExecutionLogWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    updateModelsActivity();
+}
+
+void ExecutionLogWidget::updateModelsActivity()
+{
+    const bool isShown = isVisible();
+    m_messageModel->setActive(isShown && (m_ui->tabConsole->currentWidget() == m_ui->tabGeneral));
+    m_peerModel->setActive(isShown && (m_ui->tabConsole->currentWidget() == m_ui->tabBan));
+}
+
+void ExecutionLogWidget::initBannedPeersHistory()
+{
+    auto *model = new BannedPeersModel(this);
+
+    // filters match exactly, so they can be served by the database indexes
+    auto *tagFilterEdit = new LineEdit(this);
+    tagFilterEdit->setPlaceholderText(tr("Filter by rule..."));
+    auto *clientFilterEdit = new LineEdit(this);
+    clientFilterEdit->setPlaceholderText(tr("Filter by client..."));
+    auto *refreshButton = new QPushButton(UIThemeManager::instance()->getIcon(u"view-refresh"_s), tr("Refresh"), this);
+
+    const auto applyFilter = [model, tagFilterEdit, clientFilterEdit]()
+    {
+        model->setFilter({.tag = tagFilterEdit->text().trimmed(), .client = clientFilterEdit->text().trimmed()});
+    };
+    connect(tagFilterEdit, &LineEdit::textChanged, this, applyFilter);
+    connect(clientFilterEdit, &LineEdit::textChanged, this, applyFilter);
+    connect(refreshButton, &QPushButton::clicked, model, &BannedPeersModel::refresh);
+
+    auto *filterLayout = new QHBoxLayout;
+    filterLayout->addWidget(tagFilterEdit);
+    filterLayout->addWidget(clientFilterEdit);
+    filterLayout->addWidget(refreshButton);
+
+    auto *view = new QTreeView(this);
+    view->setRootIsDecorated(false);
+    view->setUniformRowHeights(true);
+    view->setAllColumnsShowFocus(true);
+    view->setModel(model);
+    view->header()->setStretchLastSection(false);
+    view->header()->setSectionResizeMode(BannedPeersModel::ClientColumn, QHeaderView::Stretch);
+
+    auto *layout = static_cast<QVBoxLayout *>(m_ui->tabBannedPeers->layout());
+    layout->addLayout(filterLayout);
+    layout->addWidget(view);
 }
 
 void ExecutionLogWidget::displayContextMenu(const LogListView *view, const BaseLogModel *model) const
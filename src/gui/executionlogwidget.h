@@ -38,8 +38,9 @@ namespace Ui
 }
 
 class BaseLogModel;
-class LogFilterModel;
 class LogListView;
+class LogMessageModel;
+class LogPeerModel;
 
 class ExecutionLogWidget : public QWidget
 {
@@ -53,8 +54,14 @@ public:
     void setMessageTypes(Log::MsgTypes types);
 
 private:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+    void updateModelsActivity();
+    void initBannedPeersHistory();
     void displayContextMenu(const LogListView *view, const BaseLogModel *model) const;
 
     Ui::ExecutionLogWidget *m_ui = nullptr;
-    LogFilterModel *m_messageFilterModel = nullptr;
+    LogMessageModel *m_messageModel = nullptr;
+    LogPeerModel *m_peerModel = nullptr;
 };
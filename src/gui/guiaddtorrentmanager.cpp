@@ -82,6 +82,20 @@ GUIAddTorrentManager::GUIAddTorrentManager(IGUIApplication *app, BitTorrent::Ses
     connect(btSession(), &BitTorrent::Session::metadataDownloaded, this, &GUIAddTorrentManager::onMetadataDownloaded);
 }
 
+void GUIAddTorrentManager::addTorrents(const QStringList &sources, const BitTorrent::AddTorrentParams &params, const AddTorrentOption option)
+{
+    if ((option == AddTorrentOption::SkipDialog)
+            || ((option == AddTorrentOption::Default) && !Preferences::instance()->isAddNewTorrentDialogEnabled()))
+    {
+        AddTorrentManager::addTorrents(sources, params);
+        return;
+    }
+
+    // each torrent gets its own dialog
+    for (const QString &source : sources)
+        addTorrent(source, params, option);
+}
+
 bool GUIAddTorrentManager::addTorrent(const QString &source, const BitTorrent::AddTorrentParams &params, const AddTorrentOption option)
 {
     // `source`: .torrent file path,  magnet URI or URL
@@ -101,7 +115,7 @@ bool GUIAddTorrentManager::addTorrent(const QString &source, const BitTorrent::A
     {
         LogMsg(tr("Downloading torrent... Source: \"%1\"").arg(source));
         // Launch downloader
-        Net::DownloadManager::instance()->download(Net::DownloadRequest(source).limit(pref->getTorrentFileSizeLimit())
+        Net::DownloadManager::instance()->download(Net::DownloadRequest(source).limit(pref->getTorrentFileSizeLimit()).priority(Net::DownloadPriority::High)
                 , pref->useProxyForGeneralPurposes(), this, &GUIAddTorrentManager::onDownloadFinished);
         m_downloadedTorrents[source] = params;
 
@@ -120,22 +134,39 @@ bool GUIAddTorrentManager::addTorrent(const QString &source, const BitTorrent::A
 
     const Path decodedPath {source.startsWith(u"file://", Qt::CaseInsensitive)
             ? QUrl::fromEncoded(source.toLocal8Bit()).toLocalFile() : source};
-    auto torrentFileGuard = std::make_shared<TorrentFileGuard>(decodedPath);
-    if (const auto loadResult = BitTorrent::TorrentDescriptor::loadFromFile(decodedPath))
+    m_loadingThreadPool.start([this, source, decodedPath, params]
     {
-        const BitTorrent::TorrentDescriptor &torrentDescriptor = loadResult.value();
-        const bool isProcessing = processTorrent(source, torrentDescriptor, params);
-        if (isProcessing)
-            setTorrentFileGuard(source, torrentFileGuard);
-        return isProcessing;
-    }
-    else
+        const auto loadResult = BitTorrent::TorrentDescriptor::loadFromFile(decodedPath);
+        QMetaObject::invokeMethod(this, [this, source, decodedPath, loadResult, params]
+        {
+            onTorrentFileLoaded(source, decodedPath, loadResult, params);
+        });
+    });
+
+    return true;
+}
+
+void GUIAddTorrentManager::onTorrentFileLoaded(const QString &source, const Path &path
+        , const nonstd::expected<BitTorrent::TorrentDescriptor, QString> &loadResult, const BitTorrent::AddTorrentParams &params)
+{
+    if (!loadResult)
     {
-        handleAddTorrentFailed(decodedPath.toString(), loadResult.error());
-        return false;
+        handleAddTorrentFailed(path.toString(), loadResult.error());
+        return;
     }
 
-    return false;
+    auto torrentFileGuard = std::make_shared<TorrentFileGuard>(path);
+    if (processTorrent(source, loadResult.value(), params))
+        setTorrentFileGuard(source, torrentFileGuard);
+}
+
+void GUIAddTorrentManager::onTorrentDataLoaded(const QString &source
+        , const nonstd::expected<BitTorrent::TorrentDescriptor, QString> &loadResult, const BitTorrent::AddTorrentParams &params)
+{
+    if (loadResult)
+        processTorrent(source, loadResult.value(), params);
+    else
+        handleAddTorrentFailed(source, loadResult.error());
 }
 
 void GUIAddTorrentManager::onDownloadFinished(const Net::DownloadResult &result)
@@ -146,10 +177,14 @@ void GUIAddTorrentManager::onDownloadFinished(const Net::DownloadResult &result)
     switch (result.status)
     {
     case Net::DownloadStatus::Success:
-        if (const auto loadResult = BitTorrent::TorrentDescriptor::load(result.data))
-            processTorrent(source, loadResult.value(), addTorrentParams);
-        else
-            handleAddTorrentFailed(source, loadResult.error());
+        m_loadingThreadPool.start([this, source, data = result.data, addTorrentParams]
+        {
+            const auto loadResult = BitTorrent::TorrentDescriptor::load(data);
+            QMetaObject::invokeMethod(this, [this, source, loadResult, addTorrentParams]
+            {
+                onTorrentDataLoaded(source, loadResult, addTorrentParams);
+            });
+        });
         break;
     case Net::DownloadStatus::RedirectedToMagnet:
         if (const auto parseResult = BitTorrent::TorrentDescriptor::parse(result.magnetURI))
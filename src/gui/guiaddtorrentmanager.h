@@ -29,11 +29,14 @@
 
 #pragma once
 
+#include "base/3rdparty/expected.hpp"
 #include "base/addtorrentmanager.h"
 #include "base/bittorrent/infohash.h"
+#include "base/path.h"
 #include "guiapplicationcomponent.h"
 
 #include <QHash>
+#include <QThreadPool>
 
 namespace BitTorrent
 {
@@ -63,12 +66,20 @@ public:
     GUIAddTorrentManager(IGUIApplication *app, BitTorrent::Session *session, QObject *parent = nullptr);
 
     bool addTorrent(const QString &source, const BitTorrent::AddTorrentParams &params = {}, AddTorrentOption option = AddTorrentOption::Default);
+    void addTorrents(const QStringList &sources, const BitTorrent::AddTorrentParams &params = {}, AddTorrentOption option = AddTorrentOption::Default);
 
 private:
     void onDownloadFinished(const Net::DownloadResult &result);
     void onMetadataDownloaded(const BitTorrent::TorrentInfo &metadata);
+    void onTorrentFileLoaded(const QString &source, const Path &path
+            , const nonstd::expected<BitTorrent::TorrentDescriptor, QString> &loadResult, const BitTorrent::AddTorrentParams &params);
+    void onTorrentDataLoaded(const QString &source
+            , const nonstd::expected<BitTorrent::TorrentDescriptor, QString> &loadResult, const BitTorrent::AddTorrentParams &params);
     bool processTorrent(const QString &source, const BitTorrent::TorrentDescriptor &torrentDescr, const BitTorrent::AddTorrentParams &params);
 
     QHash<QString, BitTorrent::AddTorrentParams> m_downloadedTorrents;
     QHash<BitTorrent::InfoHash, AddNewTorrentDialog *> m_dialogs;
+    // Torrent files are decoded in background so that adding a lot of them at once
+    // doesn't block the UI. It must be destroyed first to wait for running tasks.
+    QThreadPool m_loadingThreadPool;
 };
@@ -0,0 +1,151 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "bannedpeersmodel.h"
+
+#include <QLocale>
+
+#include "base/global.h"
+
+namespace
+{
+    const int PAGE_SIZE = 200;
+}
+
+BannedPeersModel::BannedPeersModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void BannedPeersModel::setFilter(const BitTorrent::BannedPeersHistory::Filter &filter)
+{
+    m_filter = filter;
+    refresh();
+}
+
+void BannedPeersModel::refresh()
+{
+    beginResetModel();
+    m_records.clear();
+    m_isFetchedAll = false;
+    endResetModel();
+}
+
+int BannedPeersModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_records.size());
+}
+
+int BannedPeersModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant BannedPeersModel::data(const QModelIndex &index, const int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid))
+        return {};
+
+    const BitTorrent::BannedPeerRecord &record = m_records[index.row()];
+
+    if (role == Qt::TextAlignmentRole)
+    {
+        if (index.column() == HitsColumn)
+            return QVariant {Qt::AlignRight | Qt::AlignVCenter};
+        return {};
+    }
+
+    if ((role != Qt::DisplayRole) && (role != Qt::ToolTipRole))
+        return {};
+
+    switch (index.column())
+    {
+    case LastBannedColumn:
+        return QLocale().toString(record.lastBanned.toLocalTime(), QLocale::ShortFormat);
+    case IPColumn:
+        return record.ip;
+    case ClientColumn:
+        return record.client;
+    case PeerIDColumn:
+        return QString::fromLatin1(record.peerIDPrefix.toHex());
+    case TagColumn:
+        return record.tag;
+    case HitsColumn:
+        return record.hits;
+    default:
+        return {};
+    }
+}
+
+QVariant BannedPeersModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+        return {};
+
+    switch (section)
+    {
+    case LastBannedColumn:
+        return tr("Last banned");
+    case IPColumn:
+        return tr("IP");
+    case ClientColumn:
+        return tr("Client");
+    case PeerIDColumn:
+        return tr("Peer ID");
+    case TagColumn:
+        return tr("Rule");
+    case HitsColumn:
+        return tr("Hits");
+    default:
+        return {};
+    }
+}
+
+bool BannedPeersModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_isFetchedAll;
+}
+
+void BannedPeersModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    const BitTorrent::BannedPeersHistory::Cursor cursor = m_records.isEmpty()
+        ? BitTorrent::BannedPeersHistory::Cursor()
+        : BitTorrent::BannedPeersHistory::cursorAfter(m_records.last());
+    const QList<BitTorrent::BannedPeerRecord> page = m_history.fetch(m_filter, cursor, PAGE_SIZE);
+    m_isFetchedAll = (page.size() < PAGE_SIZE);
+    if (page.isEmpty())
+        return;
+
+    const auto firstRow = static_cast<int>(m_records.size());
+    beginInsertRows({}, firstRow, (firstRow + static_cast<int>(page.size()) - 1));
+    m_records.append(page);
+    endInsertRows();
+}
@@ -26,52 +26,43 @@
  * modify file(s), you may extend this exception to your version of the file(s),
  * but you are not obligated to do so. If you do not wish to do so, delete this
  * exception statement from your version.
- */
 
 #include "logmodel.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include <QApplication>
 #include <QDateTime>
 #include <QColor>
+#include <QLocale>
+#include <QTimer>
 
 #include "base/global.h"
 #include "gui/uithememanager.h"
 
-const int MAX_VISIBLE_MESSAGES = 20000;
-
-BaseLogModel::Message::Message(const QString &time, const QString &message, const Log::MsgType type)
-    : m_time {time}
-    , m_message {message}
-    , m_type {type}
-{
-}
-
-QString BaseLogModel::Message::time() const
-{
-    return m_time;
-}
-
-QString BaseLogModel::Message::message() const
-{
-    return m_message;
-}
+using namespace std::chrono_literals;
 
-Log::MsgType BaseLogModel::Message::type() const
+namespace
 {
-    return m_type;
+    // entries added during this interval are shown at once
+    const std::chrono::milliseconds SYNC_INTERVAL = 100ms;
 }
 
 BaseLogModel::BaseLogModel(QObject *parent)
     : QAbstractListModel(parent)
-    , m_messages(MAX_VISIBLE_MESSAGES)
+    , m_syncTimer {new QTimer(this)}
 {
     loadColors();
+    m_syncTimer->setSingleShot(true);
+    m_syncTimer->setInterval(SYNC_INTERVAL);
+    connect(m_syncTimer, &QTimer::timeout, this, &BaseLogModel::sync);
     connect(UIThemeManager::instance(), &UIThemeManager::themeChanged, this, &BaseLogModel::onUIThemeChanged);
 }
 
-int BaseLogModel::rowCount(const QModelIndex &) const
+int BaseLogModel::rowCount(const QModelIndex &parent) const
 {
-    return static_cast<int>(m_messages.size());
+    return parent.isValid() ? 0 : static_cast<int>(m_ids.size());
 }
 
 int BaseLogModel::columnCount(const QModelIndex &) const
@@ -84,43 +75,109 @@ QVariant BaseLogModel::data(const QModelIndex &index, const int role) const
     if (!index.isValid())
         return {};
 
-    const int messageIndex = index.row();
-    if ((messageIndex < 0) || (messageIndex >= static_cast<int>(m_messages.size())))
+    const int row = index.row();
+    if ((row < 0) || (row >= static_cast<int>(m_ids.size())))
         return {};
 
-    const Message &message = m_messages[messageIndex];
+    // the most recent entry is at the top
+    const int id = m_ids[m_ids.size() - 1 - row];
     switch (role)
     {
     case TimeRole:
-        return message.time();
+        return QLocale::system().toString(QDateTime::fromSecsSinceEpoch(entryTimestamp(id)), QLocale::ShortFormat);
     case MessageRole:
-        return message.message();
+        return entryMessage(id);
     case TimeForegroundRole:
         return m_timeForeground;
     case MessageForegroundRole:
-        return messageForeground(message);
+        return entryForeground(id);
     case TypeRole:
-        return message.type();
+        return entryType(id);
     default:
         return {};
     }
 }
 
-void BaseLogModel::addNewMessage(const BaseLogModel::Message &message)
+bool BaseLogModel::isActive() const
+{
+    return m_isActive;
+}
+
+void BaseLogModel::setActive(const bool active)
+{
+    if (active == m_isActive)
+        return;
+
+    m_isActive = active;
+    if (m_isActive)
+        sync();
+    else
+        m_syncTimer->stop();
+}
+
+bool BaseLogModel::isAccepted([[maybe_unused]] const int id) const
+{
+    return true;
+}
+
+void BaseLogModel::scheduleSync()
 {
-    // if row is inserted on filled up buffer, the size will not change
-    // but because of calling of beginInsertRows function we'll have ghost rows.
-    if (m_messages.size() == MAX_VISIBLE_MESSAGES)
+    if (m_isActive && !m_syncTimer->isActive())
+        m_syncTimer->start();
+}
+
+void BaseLogModel::sync()
+{
+    m_syncTimer->stop();
+    updateView();
+
+    // remove the entries that are no longer kept by the Logger, they are at the bottom
+    const int begin = viewBegin();
+    std::size_t removedCount = 0;
+    while ((removedCount < m_ids.size()) && (m_ids[removedCount] < begin))
+        ++removedCount;
+    if (removedCount > 0)
     {
-        const int lastMessage = static_cast<int>(m_messages.size()) - 1;
-        beginRemoveRows(QModelIndex(), lastMessage, lastMessage);
-        m_messages.pop_back();
+        const auto rows = static_cast<int>(m_ids.size());
+        beginRemoveRows({}, (rows - static_cast<int>(removedCount)), (rows - 1));
+        m_ids.erase(m_ids.begin(), (m_ids.begin() + removedCount));
         endRemoveRows();
     }
 
-    beginInsertRows(QModelIndex(), 0, 0);
-    m_messages.push_front(message);
-    endInsertRows();
+    const int end = viewEnd();
+    QList<int> newIDs;
+    for (int id = std::max({begin, (m_lastID + 1), (m_clearedID + 1)}); id < end; ++id)
+    {
+        if (isAccepted(id))
+            newIDs.append(id);
+    }
+    m_lastID = std::max(m_lastID, (end - 1));
+
+    if (!newIDs.isEmpty())
+    {
+        beginInsertRows({}, 0, (static_cast<int>(newIDs.size()) - 1));
+        m_ids.insert(m_ids.end(), newIDs.cbegin(), newIDs.cend());
+        endInsertRows();
+    }
+}
+
+void BaseLogModel::rebuild()
+{
+    beginResetModel();
+    m_ids.clear();
+    m_lastID = -1;
+    if (m_isActive)
+    {
+        updateView();
+        const int end = viewEnd();
+        for (int id = std::max(viewBegin(), (m_clearedID + 1)); id < end; ++id)
+        {
+            if (isAccepted(id))
+                m_ids.push_back(id);
+        }
+        m_lastID = end - 1;
+    }
+    endResetModel();
 }
 
 void BaseLogModel::onUIThemeChanged()
@@ -137,29 +194,71 @@ void BaseLogModel::loadColors()
 void BaseLogModel::reset()
 {
     beginResetModel();
-    m_messages.clear();
+    m_clearedID = std::max(m_lastID, m_clearedID);
+    m_ids.clear();
     endResetModel();
 }
 
-LogMessageModel::LogMessageModel(QObject *parent)
+LogMessageModel::LogMessageModel(const Log::MsgTypes types, QObject *parent)
     : BaseLogModel(parent)
+    , m_types {types}
 {
     loadColors();
+    connect(Logger::instance(), &Logger::newLogMessage, this, &LogMessageModel::scheduleSync);
+}
+
+void LogMessageModel::setMessageTypes(const Log::MsgTypes types)
+{
+    if (types == m_types)
+        return;
 
-    for (const Log::Msg &msg : asConst(Logger::instance()->getMessages()))
-        handleNewMessage(msg);
-    connect(Logger::instance(), &Logger::newLogMessage, this, &LogMessageModel::handleNewMessage);
+    m_types = types;
+    rebuild();
 }
 
-void LogMessageModel::handleNewMessage(const Log::Msg &message)
+void LogMessageModel::updateView()
 {
-    const QString time = QLocale::system().toString(QDateTime::fromSecsSinceEpoch(message.timestamp), QLocale::ShortFormat);
-    addNewMessage({time, message.message, message.type});
+    m_view = Logger::instance()->messages();
 }
 
-QColor LogMessageModel::messageForeground(const Message &message) const
+int LogMessageModel::viewBegin() const
 {
-    return m_foregroundForMessageTypes.value(message.type());
+    return m_view.firstID();
+}
+
+int LogMessageModel::viewEnd() const
+{
+    return m_view.firstID() + m_view.size();
+}
+
+bool LogMessageModel::isAccepted(const int id) const
+{
+    return m_types.testFlag(entry(id).type);
+}
+
+qint64 LogMessageModel::entryTimestamp(const int id) const
+{
+    return entry(id).timestamp;
+}
+
+QString LogMessageModel::entryMessage(const int id) const
+{
+    return entry(id).message;
+}
+
+Log::MsgType LogMessageModel::entryType(const int id) const
+{
+    return entry(id).type;
+}
+
+QColor LogMessageModel::entryForeground(const int id) const
+{
+    return m_foregroundForMessageTypes.value(entry(id).type);
+}
+
+const Log::Msg &LogMessageModel::entry(const int id) const
+{
+    return m_view.at(id - m_view.firstID());
 }
 
 void LogMessageModel::onUIThemeChanged()
@@ -185,27 +284,52 @@ LogPeerModel::LogPeerModel(QObject *parent)
     : BaseLogModel(parent)
 {
     loadColors();
+    connect(Logger::instance(), &Logger::newLogPeer, this, &LogPeerModel::scheduleSync);
+}
+
+void LogPeerModel::updateView()
+{
+    m_view = Logger::instance()->peers();
+}
+
+int LogPeerModel::viewBegin() const
+{
+    return m_view.firstID();
+}
 
-    for (const Log::Peer &peer : asConst(Logger::instance()->getPeers()))
-        handleNewMessage(peer);
-    connect(Logger::instance(), &Logger::newLogPeer, this, &LogPeerModel::handleNewMessage);
+int LogPeerModel::viewEnd() const
+{
+    return m_view.firstID() + m_view.size();
 }
 
-void LogPeerModel::handleNewMessage(const Log::Peer &peer)
+qint64 LogPeerModel::entryTimestamp(const int id) const
 {
-    const QString time = QLocale::system().toString(QDateTime::fromSecsSinceEpoch(peer.timestamp), QLocale::ShortFormat);
-    const QString message = peer.blocked
+    return entry(id).timestamp;
+}
+
+QString LogPeerModel::entryMessage(const int id) const
+{
+    const Log::Peer &peer = entry(id);
+    return peer.blocked
             ? tr("%1 was blocked. Reason: %2.", "0.0.0.0 was blocked. Reason: reason for blocking.").arg(peer.ip, peer.reason)
             : tr("%1 was banned", "0.0.0.0 was banned").arg(peer.ip);
+}
 
-    addNewMessage({time, message, Log::NORMAL});
+Log::MsgType LogPeerModel::entryType([[maybe_unused]] const int id) const
+{
+    return Log::NORMAL;
 }
 
-QColor LogPeerModel::messageForeground([[maybe_unused]] const Message &message) const
+QColor LogPeerModel::entryForeground([[maybe_unused]] const int id) const
 {
     return m_bannedPeerForeground;
 }
 
+const Log::Peer &LogPeerModel::entry(const int id) const
+{
+    return m_view.at(id - m_view.firstID());
+}
+
 void LogPeerModel::onUIThemeChanged()
 {
     loadColors();
@@ -26,11 +26,10 @@
  * modify file(s), you may extend this exception to your version of the file(s),
  * but you are not obligated to do so. If you do not wish to do so, delete this
  * exception statement from your version.
- */
 
 #pragma once
 
-#include <boost/circular_buffer.hpp>
+#include <deque>
 
 #include <QAbstractListModel>
 #include <QColor>
@@ -38,6 +37,12 @@
 
 #include "base/logger.h"
 
+class QTimer;
+
+// Shows the entries kept by the Logger, the most recent one first.
+// The model doesn't copy the entries, it only keeps IDs of those that pass its filter
+// and formats them when they are painted. It follows the Logger only while it is active,
+// new entries are then added in batches instead of one row at a time.
 class BaseLogModel : public QAbstractListModel
 {
     Q_DISABLE_COPY_MOVE(BaseLogModel)
@@ -59,30 +64,40 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     void reset();
 
-protected:
-    class Message
-    {
-    public:
-        Message(const QString &time, const QString &message, Log::MsgType type);
-
-        QString time() const;
-        QString message() const;
-        Log::MsgType type() const;
+    bool isActive() const;
+    void setActive(bool active);
 
-    private:
-        QString m_time;
-        QString m_message;
-        Log::MsgType m_type;
-    };
+protected:
+    // takes new snapshot of the Logger entries
+    virtual void updateView() = 0;
+    // the entries of the snapshot have consecutive IDs in range [viewBegin, viewEnd)
+    virtual int viewBegin() const = 0;
+    virtual int viewEnd() const = 0;
+    virtual bool isAccepted(int id) const;
+
+    virtual qint64 entryTimestamp(int id) const = 0;
+    virtual QString entryMessage(int id) const = 0;
+    virtual Log::MsgType entryType(int id) const = 0;
+    virtual QColor entryForeground(int id) const = 0;
+
+    // called when new entry is added to the Logger
+    void scheduleSync();
+    // filters all the kept entries again
+    void rebuild();
 
-    void addNewMessage(const Message &message);
-    virtual QColor messageForeground(const Message &message) const = 0;
     virtual void onUIThemeChanged();
 
 private:
+    void sync();
     void loadColors();
 
-    boost::circular_buffer_space_optimized<Message> m_messages;
+    // IDs of the shown entries from the oldest one
+    std::deque<int> m_ids;
+    // entries up to this one were processed or cleared by user
+    int m_lastID = -1;
+    int m_clearedID = -1;
+    bool m_isActive = false;
+    QTimer *m_syncTimer = nullptr;
     QColor m_timeForeground;
 };
 
@@ -92,16 +107,28 @@ class LogMessageModel : public BaseLogModel
     Q_DISABLE_COPY_MOVE(LogMessageModel)
 
 public:
-    explicit LogMessageModel(QObject *parent = nullptr);
+    explicit LogMessageModel(Log::MsgTypes types = Log::ALL, QObject *parent = nullptr);
 
-private slots:
-    void handleNewMessage(const Log::Msg &message);
+    void setMessageTypes(Log::MsgTypes types);
 
 private:
-    QColor messageForeground(const Message &message) const override;
+    void updateView() override;
+    int viewBegin() const override;
+    int viewEnd() const override;
+    bool isAccepted(int id) const override;
+
+    qint64 entryTimestamp(int id) const override;
+    QString entryMessage(int id) const override;
+    Log::MsgType entryType(int id) const override;
+    QColor entryForeground(int id) const override;
+
     void onUIThemeChanged() override;
     void loadColors();
 
+    const Log::Msg &entry(int id) const;
+
+    Logger::MessagesView m_view;
+    Log::MsgTypes m_types;
     QHash<int, QColor> m_foregroundForMessageTypes;
 };
 
@@ -113,13 +140,21 @@ class LogPeerModel : public BaseLogModel
 public:
     explicit LogPeerModel(QObject *parent = nullptr);
 
-private slots:
-    void handleNewMessage(const Log::Peer &peer);
-
 private:
-    QColor messageForeground(const Message &message) const override;
+    void updateView() override;
+    int viewBegin() const override;
+    int viewEnd() const override;
+
+    qint64 entryTimestamp(int id) const override;
+    QString entryMessage(int id) const override;
+    Log::MsgType entryType(int id) const override;
+    QColor entryForeground(int id) const override;
+
     void onUIThemeChanged() override;
     void loadColors();
 
+    const Log::Peer &entry(int id) const;
+
+    Logger::PeersView m_view;
     QColor m_bannedPeerForeground;
 };
@@ -1105,6 +1105,8 @@ void MainWindow::showEvent(QShowEvent *e)
         if (currentTabWidget() == m_transferListWidget)
             m_propertiesWidget->loadDynamicData();
 
+        BitTorrent::Session::instance()->demandRefresh();
+
         // Make sure the window is initially centered
         if (!m_posInitialized)
         {
@@ -1172,8 +1174,8 @@ void MainWindow::closeEvent(QCloseEvent *e)
     }
 #endif // Q_OS_MACOS
 
-    const QVector<BitTorrent::Torrent *> allTorrents = BitTorrent::Session::instance()->torrents();
-    const bool hasActiveTorrents = std::any_of(allTorrents.cbegin(), allTorrents.cend(), [](BitTorrent::Torrent *torrent)
+    const std::span<BitTorrent::Torrent *const> allTorrents = BitTorrent::Session::instance()->torrentsView();
+    const bool hasActiveTorrents = std::any_of(allTorrents.begin(), allTorrents.end(), [](BitTorrent::Torrent *torrent)
     {
         return torrent->isActive();
     });
@@ -1521,6 +1523,10 @@ void MainWindow::loadSessionStats()
 #endif  // Q_OS_MACOS
 
     refreshWindowTitle();
+
+    // statuses are displayed, keep them refreshed at full rate
+    if (isVisible() && !isMinimized())
+        BitTorrent::Session::instance()->demandRefresh();
 }
 
 void MainWindow::reloadTorrentStats(const QVector<BitTorrent::Torrent *> &torrents)
@@ -1870,8 +1876,8 @@ void MainWindow::updatePowerManagementState() const
     const bool preventFromSuspendWhenDownloading = pref->preventFromSuspendWhenDownloading();
     const bool preventFromSuspendWhenSeeding = pref->preventFromSuspendWhenSeeding();
 
-    const QVector<BitTorrent::Torrent *> allTorrents = BitTorrent::Session::instance()->torrents();
-    const bool inhibitSuspend = std::any_of(allTorrents.cbegin(), allTorrents.cend(), [&](const BitTorrent::Torrent *torrent)
+    const std::span<BitTorrent::Torrent *const> allTorrents = BitTorrent::Session::instance()->torrentsView();
+    const bool inhibitSuspend = std::any_of(allTorrents.begin(), allTorrents.end(), [&](const BitTorrent::Torrent *torrent)
     {
         if (preventFromSuspendWhenDownloading && (!torrent->isFinished() && !torrent->isStopped() && !torrent->isErrored() && torrent->hasMetadata()))
             return true;
@@ -1957,7 +1963,7 @@ void MainWindow::installPython()
     // Download python
     const auto installerURL = u"https://www.python.org/ftp/python/3.10.11/python-3.10.11-amd64.exe"_s;
     Net::DownloadManager::instance()->download(
-            Net::DownloadRequest(installerURL).saveToFile(true)
+            Net::DownloadRequest(installerURL).saveToFile(true).streamToFile(true)
             , Preferences::instance()->useProxyForGeneralPurposes()
             , this, &MainWindow::pythonDownloadFinished);
 }
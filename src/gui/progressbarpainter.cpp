@@ -30,6 +30,8 @@
 
 #include <QPainter>
 #include <QPalette>
+#include <QPixmap>
+#include <QPixmapCache>
 #include <QStyleOptionProgressBar>
 #include <QStyleOptionViewItem>
 
@@ -69,6 +71,32 @@ void ProgressBarPainter::paint(QPainter *painter, const QStyleOptionViewItem &op
     painter->save();
     const QStyle *style = m_dummyProgressBar.style();
     style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, option.widget);
-    style->drawControl(QStyle::CE_ProgressBar, &styleOption, painter, &m_dummyProgressBar);
+
+    // Rendered progress bars are cached since lots of rows usually share the same
+    // look (e.g. completed torrents) and most of them don't change between updates.
+    // Item background is drawn separately because it also depends on row alternation and hovering.
+    const qreal devicePixelRatio = painter->device()->devicePixelRatio();
+    const QString cacheKey = u"qbt_progressbar_%1x%2@%3_%4_%5_%6_%7_%8"_s.arg(QString::number(option.rect.width())
+            , QString::number(option.rect.height()), QString::number(devicePixelRatio), QString::number(progress)
+            , QString::number(styleOption.state.toInt()), QString::number(styleOption.palette.cacheKey())
+            , painter->font().key(), text);
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(cacheKey, &pixmap))
+    {
+        pixmap = QPixmap(option.rect.size() * devicePixelRatio);
+        pixmap.setDevicePixelRatio(devicePixelRatio);
+        pixmap.fill(Qt::transparent);
+
+        styleOption.rect = QRect({0, 0}, option.rect.size());
+        QPainter pixmapPainter {&pixmap};
+        pixmapPainter.setFont(painter->font());
+        style->drawControl(QStyle::CE_ProgressBar, &styleOption, &pixmapPainter, &m_dummyProgressBar);
+        pixmapPainter.end();
+
+        QPixmapCache::insert(cacheKey, pixmap);
+    }
+
+    painter->drawPixmap(option.rect.topLeft(), pixmap);
     painter->restore();
 }
@@ -29,11 +29,7 @@
 
 #include "downloadedpiecesbar.h"
 
-#include <algorithm>
-#include <cmath>
-
 #include <QDebug>
-#include <QVector>
 
 #include "base/global.h"
 
@@ -52,83 +48,6 @@ DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent)
     updateColorsImpl();
 }
 
-QVector<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin, int reqSize)
-{
-    QVector<float> result(reqSize, 0.0);
-    if (vecin.isEmpty()) return result;
-
-    const float ratio = vecin.size() / static_cast<float>(reqSize);
-
-    // simple linear transformation algorithm
-    // for example:
-    // image.x(0) = pieces.x(0.0 >= x < 1.7)
-    // image.x(1) = pieces.x(1.7 >= x < 3.4)
-
-    for (int x = 0; x < reqSize; ++x)
-    {
-        // R - real
-        const float fromR = x * ratio;
-        const float toR = (x + 1) * ratio;
-
-        // C - integer
-        int fromC = fromR; // std::floor not needed
-        int toC = std::ceil(toR);
-        if (toC > vecin.size())
-            --toC;
-
-        // position in pieces table
-        int x2 = fromC;
-
-        // little speed up for really big pieces table, 10K+ size
-        const int toCMinusOne = toC - 1;
-
-        // value in returned vector
-        float value = 0;
-
-        // case when calculated range is (15.2 >= x < 15.7)
-        if (x2 == toCMinusOne)
-        {
-            if (vecin[x2])
-                value += ratio;
-            ++x2;
-        }
-        // case when (15.2 >= x < 17.8)
-        else
-        {
-            // subcase (15.2 >= x < 16)
-            if (x2 != fromR)
-            {
-                if (vecin[x2])
-                    value += 1.0 - (fromR - fromC);
-                ++x2;
-            }
-
-            // subcase (16 >= x < 17)
-            for (; x2 < toCMinusOne; ++x2)
-                if (vecin[x2])
-                    value += 1.0;
-
-            // subcase (17 >= x < 17.8)
-            if (x2 == toCMinusOne)
-            {
-                if (vecin[x2])
-                    value += 1.0 - (toC - toR);
-                ++x2;
-            }
-        }
-
-        // normalization <0, 1>
-        value /= ratio;
-
-        // float precision sometimes gives > 1, because it's not possible to store irrational numbers
-        value = std::min(value, 1.0f);
-
-        result[x] = value;
-    }
-
-    return result;
-}
-
 QImage DownloadedPiecesBar::renderImage()
 {
     //  qDebug() << "updateImage";
@@ -145,14 +64,17 @@ QImage DownloadedPiecesBar::renderImage()
         return image;
     }
 
-    QVector<float> scaledPieces = bitfieldToFloatVector(m_pieces, image.width());
-    QVector<float> scaledPiecesDl = bitfieldToFloatVector(m_downloadedPieces, image.width());
+    // buckets are only rebuilt when the width is changed, otherwise they are kept up to date by setProgress()
+    if (m_piecesBuckets.bucketCount() != image.width())
+        m_piecesBuckets.assign(m_pieces, image.width());
+    if (m_downloadedPiecesBuckets.bucketCount() != image.width())
+        m_downloadedPiecesBuckets.assign(m_downloadedPieces, image.width());
 
     // filling image
-    for (int x = 0; x < scaledPieces.size(); ++x)
+    for (int x = 0; x < image.width(); ++x)
     {
-        float piecesToValue = scaledPieces.at(x);
-        float piecesToValueDl = scaledPiecesDl.at(x);
+        const auto piecesToValue = static_cast<float>(m_piecesBuckets.value(x));
+        const auto piecesToValueDl = static_cast<float>(m_downloadedPiecesBuckets.value(x));
         if (piecesToValueDl != 0)
         {
             float fillRatio = piecesToValue + piecesToValueDl;
@@ -174,6 +96,8 @@ QImage DownloadedPiecesBar::renderImage()
 
 void DownloadedPiecesBar::setProgress(const QBitArray &pieces, const QBitArray &downloadedPieces)
 {
+    m_piecesBuckets.update(m_pieces, pieces);
+    m_downloadedPiecesBuckets.update(m_downloadedPieces, downloadedPieces);
     m_pieces = pieces;
     m_downloadedPieces = downloadedPieces;
 
@@ -184,6 +108,8 @@ void DownloadedPiecesBar::clear()
 {
     m_pieces.clear();
     m_downloadedPieces.clear();
+    m_piecesBuckets.clear();
+    m_downloadedPiecesBuckets.clear();
     base::clear();
 }
 
@@ -33,6 +33,7 @@
 #include <QtContainerFwd>
 
 #include "piecesbar.h"
+#include "piecesbarbuckets.h"
 
 class QWidget;
 
@@ -51,8 +52,6 @@ public:
     void clear() override;
 
 private:
-    // scale bitfield vector to float vector
-    QVector<float> bitfieldToFloatVector(const QBitArray &vecin, int reqSize);
     QImage renderImage() override;
     QString simpleToolTipText() const override;
     void updateColors() override;
@@ -60,8 +59,9 @@ private:
 
     // incomplete piece color
     QColor m_dlPieceColor;
-    // last used bitfields, uses to better resize redraw
-    // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
+    // last used bitfields, to find changed pieces and to redraw on resize
     QBitArray m_pieces;
     QBitArray m_downloadedPieces;
+    PiecesBarBuckets m_piecesBuckets;
+    PiecesBarBuckets m_downloadedPiecesBuckets;
 };
@@ -38,6 +38,7 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QPointer>
+#include <QScrollBar>
 #include <QSet>
 #include <QShortcut>
 #include <QSortFilterProxyModel>
@@ -77,6 +78,15 @@ std::size_t qHash(const PeerEndpoint &peerEndpoint, const std::size_t seed = 0)
 
 namespace
 {
+    // piece index the downloading files of DOWNLOADING_PIECE column were computed for
+    const int DownloadingPieceIndexRole = PeerListSortModel::UnderlyingDataRole + 1;
+
+    bool isModelDataChanged(const QStandardItemModel *model, const int row, const int column, const QVariant &underlyingData
+            , const int role = PeerListSortModel::UnderlyingDataRole)
+    {
+        return (model->data(model->index(row, column), role) != underlyingData);
+    }
+
     void setModelData(QStandardItemModel *model, const int row, const int column, const QString &displayData
             , const QVariant &underlyingData, const Qt::Alignment textAlignmentData = {}, const QString &toolTip = {})
     {
@@ -150,6 +160,7 @@ PeerListWidget::PeerListWidget(PropertiesWidget *parent)
     }
 
     m_resolveCountries = Preferences::instance()->resolvePeerCountries();
+    m_hideZeroValues = Preferences::instance()->getHideZeroValues();
     if (!m_resolveCountries)
         hideColumn(PeerListColumns::COUNTRY);
     // Ensure that at least one column is visible at all times
@@ -186,6 +197,7 @@ PeerListWidget::PeerListWidget(PropertiesWidget *parent)
     connect(header(), &QHeaderView::sectionMoved, this, &PeerListWidget::saveSettings);
     connect(header(), &QHeaderView::sectionResized, this, &PeerListWidget::saveSettings);
     connect(header(), &QHeaderView::sortIndicatorChanged, this, &PeerListWidget::saveSettings);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &PeerListWidget::resolveVisiblePeers);
     handleSortColumnChanged(header()->sortIndicatorSection());
     const auto *copyHotkey = new QShortcut(QKeySequence::Copy, this, nullptr, nullptr, Qt::WidgetShortcut);
     connect(copyHotkey, &QShortcut::activated, this, &PeerListWidget::copySelectedPeers);
@@ -250,7 +262,9 @@ void PeerListWidget::updatePeerHostNameResolutionState()
         {
             m_resolver = new Net::ReverseResolution(this);
             connect(m_resolver, &Net::ReverseResolution::ipResolved, this, &PeerListWidget::handleResolved);
-            loadPeers(m_properties->getCurrentTorrent());
+            // peers are only resolved once they appear, so resolve the already listed ones now
+            for (auto i = m_itemsByIP.cbegin(); i != m_itemsByIP.cend(); ++i)
+                m_resolver->resolve(i.key());
         }
     }
     else
@@ -472,30 +486,35 @@ void PeerListWidget::loadPeers(const BitTorrent::Torrent *torrent)
         if (torrent != m_properties->getCurrentTorrent())
             return;
 
-        // Remove I2P peers since they will be completely reloaded.
-        for (const QStandardItem *item : asConst(m_I2PPeerItems))
-            m_listModel->removeRow(item->row());
-        m_I2PPeerItems.clear();
-
         QSet<PeerEndpoint> existingPeers;
         existingPeers.reserve(m_peerItems.size());
         for (auto i = m_peerItems.cbegin(); i != m_peerItems.cend(); ++i)
             existingPeers.insert(i.key());
 
+        QSet<QString> existingI2PPeers;
+        existingI2PPeers.reserve(m_I2PPeerItems.size());
+        for (auto i = m_I2PPeerItems.cbegin(); i != m_I2PPeerItems.cend(); ++i)
+            existingI2PPeers.insert(i.key());
+
+        // already listed peers only get the cells whose values have changed updated,
+        // unless the way the values are displayed has changed
         const bool hideZeroValues = Preferences::instance()->getHideZeroValues();
+        const bool forceUpdate = (hideZeroValues != m_hideZeroValues);
+        m_hideZeroValues = hideZeroValues;
+
         for (const BitTorrent::PeerInfo &peer : peers)
         {
+            const bool useI2PSocket = peer.useI2PSocket();
             const PeerEndpoint peerEndpoint {peer.address(), peer.connectionType()};
+            const QString I2PAddress = useI2PSocket ? peer.I2PAddress() : QString();
 
-            auto itemIter = m_peerItems.find(peerEndpoint);
-            const bool isNewPeer = (itemIter == m_peerItems.end());
-            const int row = isNewPeer ? m_listModel->rowCount() : (*itemIter)->row();
+            QStandardItem *item = useI2PSocket ? m_I2PPeerItems.value(I2PAddress) : m_peerItems.value(peerEndpoint);
+            const bool isNewPeer = !item;
+            const int row = isNewPeer ? m_listModel->rowCount() : item->row();
             if (isNewPeer)
             {
                 m_listModel->insertRow(row);
 
-                const bool useI2PSocket = peer.useI2PSocket();
-
                 const QString peerIPString = useI2PSocket ? peer.I2PAddress() : peerEndpoint.address.ip.toString();
                 setModelData(m_listModel, row, PeerListColumns::IP, peerIPString, peerIPString, {}, peerIPString);
 
@@ -505,22 +524,31 @@ void PeerListWidget::loadPeers(const BitTorrent::Torrent *torrent)
                 const QString peerPortString = useI2PSocket ? tr("N/A") : QString::number(peer.address().port);
                 setModelData(m_listModel, row, PeerListColumns::PORT, peerPortString, peer.address().port, (Qt::AlignRight | Qt::AlignVCenter));
 
+                item = m_listModel->item(row, PeerListColumns::IP);
                 if (useI2PSocket)
                 {
-                    m_I2PPeerItems.append(m_listModel->item(row, PeerListColumns::IP));
+                    m_I2PPeerItems.insert(I2PAddress, item);
                 }
                 else
                 {
-                    itemIter = m_peerItems.insert(peerEndpoint, m_listModel->item(row, PeerListColumns::IP));
-                    m_itemsByIP[peerEndpoint.address.ip].insert(itemIter.value());
+                    m_peerItems.insert(peerEndpoint, item);
+                    m_itemsByIP[peerEndpoint.address.ip].insert(item);
+
+                    // the resolver caches host names, so each peer only needs to be resolved once
+                    if (m_resolver)
+                        m_resolver->resolve(peerEndpoint.address.ip);
                 }
             }
+            else if (useI2PSocket)
+            {
+                existingI2PPeers.remove(I2PAddress);
+            }
             else
             {
                 existingPeers.remove(peerEndpoint);
             }
 
-            updatePeer(row, torrent, peer, hideZeroValues);
+            updatePeer(row, torrent, peer, hideZeroValues, (isNewPeer || forceUpdate));
         }
 
         // Remove peers that are gone
@@ -530,74 +558,148 @@ void PeerListWidget::loadPeers(const BitTorrent::Torrent *torrent)
 
             const auto items = m_itemsByIP.find(peerEndpoint.address.ip);
             Q_ASSERT(items != m_itemsByIP.end());
-            if (items == m_itemsByIP.end()) [[unlikely]]
-                continue;
-
-            items->remove(item);
-            if (items->isEmpty())
-                m_itemsByIP.erase(items);
+            if (items != m_itemsByIP.end()) [[likely]]
+            {
+                items->remove(item);
+                if (items->isEmpty())
+                    m_itemsByIP.erase(items);
+            }
 
             m_listModel->removeRow(item->row());
         }
+
+        for (const QString &I2PAddress : asConst(existingI2PPeers))
+            m_listModel->removeRow(m_I2PPeerItems.take(I2PAddress)->row());
+
+        resolveVisiblePeers();
     });
 }
 
-void PeerListWidget::updatePeer(const int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, const bool hideZeroValues)
+void PeerListWidget::resolveVisiblePeers()
+{
+    if (!m_resolver)
+        return;
+
+    // host names of the peers the user is looking at are resolved first
+    const QRect viewportRect = viewport()->rect();
+    QModelIndex index = indexAt(viewportRect.topLeft());
+    while (index.isValid() && (visualRect(index).top() <= viewportRect.bottom()))
+    {
+        const int row = m_proxyModel->mapToSource(index).row();
+        const QString ip = m_listModel->item(row, PeerListColumns::IP_HIDDEN)->text();
+        // already resolved peers display their host name instead of IP
+        if (!ip.isEmpty() && (m_listModel->item(row, PeerListColumns::IP)->text() == ip))
+            m_resolver->resolve(QHostAddress(ip), true);
+
+        index = indexBelow(index);
+    }
+}
+
+void PeerListWidget::updatePeer(const int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer
+        , const bool hideZeroValues, const bool forceUpdate)
 {
     const Qt::Alignment intDataTextAlignment = Qt::AlignRight | Qt::AlignVCenter;
 
+    // Display data of each column is derived from its underlying data only,
+    // so the (relatively expensive) formatting is skipped for unchanged values.
+    const auto isChanged = [this, row, forceUpdate](const int column, const QVariant &underlyingData)
+    {
+        return forceUpdate || isModelDataChanged(m_listModel, row, column, underlyingData);
+    };
+
     const QString client = peer.client().toHtmlEscaped();
-    setModelData(m_listModel, row, PeerListColumns::CLIENT, client, client, {}, client);
+    if (isChanged(PeerListColumns::CLIENT, client))
+        setModelData(m_listModel, row, PeerListColumns::CLIENT, client, client, {}, client);
 
     const QString peerIdClient = peer.peerIdClient().toHtmlEscaped();
-    setModelData(m_listModel, row, PeerListColumns::PEERID_CLIENT, peerIdClient, peerIdClient);
-
-    const QString downSpeed = (hideZeroValues && (peer.payloadDownSpeed() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.payloadDownSpeed(), true);
-    setModelData(m_listModel, row, PeerListColumns::DOWN_SPEED, downSpeed, peer.payloadDownSpeed(), intDataTextAlignment);
-
-    const QString upSpeed = (hideZeroValues && (peer.payloadUpSpeed() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.payloadUpSpeed(), true);
-    setModelData(m_listModel, row, PeerListColumns::UP_SPEED, upSpeed, peer.payloadUpSpeed(), intDataTextAlignment);
-
-    const QString totalDown = (hideZeroValues && (peer.totalDownload() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.totalDownload());
-    setModelData(m_listModel, row, PeerListColumns::TOT_DOWN, totalDown, peer.totalDownload(), intDataTextAlignment);
-
-    const QString totalUp = (hideZeroValues && (peer.totalUpload() <= 0))
-            ? QString() : Utils::Misc::friendlyUnit(peer.totalUpload());
-    setModelData(m_listModel, row, PeerListColumns::TOT_UP, totalUp, peer.totalUpload(), intDataTextAlignment);
-
-    setModelData(m_listModel, row, PeerListColumns::CONNECTION, peer.connectionType(), peer.connectionType());
-    setModelData(m_listModel, row, PeerListColumns::FLAGS, peer.flags(), peer.flags(), {}, peer.flagsDescription());
-    setModelData(m_listModel, row, PeerListColumns::PROGRESS, (Utils::String::fromDouble(peer.progress() * 100, 1) + u'%')
-            , peer.progress(), intDataTextAlignment);
-    setModelData(m_listModel, row, PeerListColumns::RELEVANCE, (Utils::String::fromDouble(peer.relevance() * 100, 1) + u'%')
-            , peer.relevance(), intDataTextAlignment);
-    setModelData(m_listModel, row, PeerListColumns::SHADOWBANNED, peer.isShadowBanned() ? u"✓"_s : u""_s
-            , peer.isShadowBanned(), intDataTextAlignment);
-
-    const PathList filePaths = torrent->info().filesForPiece(peer.downloadingPieceIndex());
-    QStringList downloadingFiles;
-    downloadingFiles.reserve(filePaths.size());
-    for (const Path &filePath : filePaths)
-        downloadingFiles.append(filePath.toString());
-
-    const QString downloadingFilesDisplayValue = downloadingFiles.join(u';');
-    setModelData(m_listModel, row, PeerListColumns::DOWNLOADING_PIECE, downloadingFilesDisplayValue
-            , downloadingFilesDisplayValue, {}, downloadingFiles.join(u'\n'));
-
-    if (!peer.useI2PSocket() && m_resolver)
-        m_resolver->resolve(peer.address().ip);
+    if (isChanged(PeerListColumns::PEERID_CLIENT, peerIdClient))
+        setModelData(m_listModel, row, PeerListColumns::PEERID_CLIENT, peerIdClient, peerIdClient);
 
+    if (isChanged(PeerListColumns::DOWN_SPEED, peer.payloadDownSpeed()))
+    {
+        const QString downSpeed = (hideZeroValues && (peer.payloadDownSpeed() <= 0))
+                ? QString() : Utils::Misc::friendlyUnit(peer.payloadDownSpeed(), true);
+        setModelData(m_listModel, row, PeerListColumns::DOWN_SPEED, downSpeed, peer.payloadDownSpeed(), intDataTextAlignment);
+    }
+
+    if (isChanged(PeerListColumns::UP_SPEED, peer.payloadUpSpeed()))
+    {
+        const QString upSpeed = (hideZeroValues && (peer.payloadUpSpeed() <= 0))
+                ? QString() : Utils::Misc::friendlyUnit(peer.payloadUpSpeed(), true);
+        setModelData(m_listModel, row, PeerListColumns::UP_SPEED, upSpeed, peer.payloadUpSpeed(), intDataTextAlignment);
+    }
+
+    if (isChanged(PeerListColumns::TOT_DOWN, peer.totalDownload()))
+    {
+        const QString totalDown = (hideZeroValues && (peer.totalDownload() <= 0))
+                ? QString() : Utils::Misc::friendlyUnit(peer.totalDownload());
+        setModelData(m_listModel, row, PeerListColumns::TOT_DOWN, totalDown, peer.totalDownload(), intDataTextAlignment);
+    }
+
+    if (isChanged(PeerListColumns::TOT_UP, peer.totalUpload()))
+    {
+        const QString totalUp = (hideZeroValues && (peer.totalUpload() <= 0))
+                ? QString() : Utils::Misc::friendlyUnit(peer.totalUpload());
+        setModelData(m_listModel, row, PeerListColumns::TOT_UP, totalUp, peer.totalUpload(), intDataTextAlignment);
+    }
+
+    const QString connectionType = peer.connectionType();
+    if (isChanged(PeerListColumns::CONNECTION, connectionType))
+        setModelData(m_listModel, row, PeerListColumns::CONNECTION, connectionType, connectionType);
+
+    const QString flags = peer.flags();
+    if (isChanged(PeerListColumns::FLAGS, flags))
+        setModelData(m_listModel, row, PeerListColumns::FLAGS, flags, flags, {}, peer.flagsDescription());
+
+    if (isChanged(PeerListColumns::PROGRESS, peer.progress()))
+    {
+        setModelData(m_listModel, row, PeerListColumns::PROGRESS, (Utils::String::fromDouble(peer.progress() * 100, 1) + u'%')
+                , peer.progress(), intDataTextAlignment);
+    }
+
+    if (isChanged(PeerListColumns::RELEVANCE, peer.relevance()))
+    {
+        setModelData(m_listModel, row, PeerListColumns::RELEVANCE, (Utils::String::fromDouble(peer.relevance() * 100, 1) + u'%')
+                , peer.relevance(), intDataTextAlignment);
+    }
+
+    if (isChanged(PeerListColumns::SHADOWBANNED, peer.isShadowBanned()))
+    {
+        setModelData(m_listModel, row, PeerListColumns::SHADOWBANNED, peer.isShadowBanned() ? u"✓"_s : u""_s
+                , peer.isShadowBanned(), intDataTextAlignment);
+    }
+
+    const int downloadingPieceIndex = peer.downloadingPieceIndex();
+    if (forceUpdate || isModelDataChanged(m_listModel, row, PeerListColumns::DOWNLOADING_PIECE, downloadingPieceIndex, DownloadingPieceIndexRole))
+    {
+        const PathList filePaths = torrent->info().filesForPiece(downloadingPieceIndex);
+        QStringList downloadingFiles;
+        downloadingFiles.reserve(filePaths.size());
+        for (const Path &filePath : filePaths)
+            downloadingFiles.append(filePath.toString());
+
+        const QString downloadingFilesDisplayValue = downloadingFiles.join(u';');
+        setModelData(m_listModel, row, PeerListColumns::DOWNLOADING_PIECE, downloadingFilesDisplayValue
+                , downloadingFilesDisplayValue, {}, downloadingFiles.join(u'\n'));
+        m_listModel->setData(m_listModel->index(row, PeerListColumns::DOWNLOADING_PIECE), downloadingPieceIndex, DownloadingPieceIndexRole);
+    }
+
+    // Country is kept as underlying data of COUNTRY column, the flag and the name are
+    // only looked up again when it changes (e.g. after GeoIP database update)
     if (m_resolveCountries)
     {
-        const QIcon icon = UIThemeManager::instance()->getFlagIcon(peer.country());
-        if (!icon.isNull())
+        const QString country = peer.country();
+        if (isChanged(PeerListColumns::COUNTRY, country))
         {
-            m_listModel->setData(m_listModel->index(row, PeerListColumns::COUNTRY), icon, Qt::DecorationRole);
-            const QString countryName = Net::GeoIPManager::CountryName(peer.country());
-            m_listModel->setData(m_listModel->index(row, PeerListColumns::COUNTRY), countryName, Qt::ToolTipRole);
+            const QModelIndex countryIndex = m_listModel->index(row, PeerListColumns::COUNTRY);
+            m_listModel->setData(countryIndex, country, PeerListSortModel::UnderlyingDataRole);
+
+            const QIcon icon = UIThemeManager::instance()->getFlagIcon(country);
+            if (!icon.isNull())
+            {
+                m_listModel->setData(countryIndex, icon, Qt::DecorationRole);
+                m_listModel->setData(countryIndex, Net::GeoIPManager::CountryName(country), Qt::ToolTipRole);
+            }
         }
     }
 }
@@ -100,8 +100,9 @@ private slots:
     void handleResolved(const QHostAddress &ip, const QString &hostname) const;
 
 private:
-    void updatePeer(int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, bool hideZeroValues);
+    void updatePeer(int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, bool hideZeroValues, bool forceUpdate);
     int visibleColumnsCount() const;
+    void resolveVisiblePeers();
 
     void wheelEvent(QWheelEvent *event) override;
 
@@ -110,7 +111,8 @@ private:
     PropertiesWidget *m_properties = nullptr;
     Net::ReverseResolution *m_resolver = nullptr;
     QHash<PeerEndpoint, QStandardItem *> m_peerItems;
-    QList<QStandardItem *> m_I2PPeerItems;
+    QHash<QString, QStandardItem *> m_I2PPeerItems;  // <I2P address, item>
     QHash<QHostAddress, QSet<QStandardItem *>> m_itemsByIP;  // must be kept in sync with `m_peerItems`
     bool m_resolveCountries;
+    bool m_hideZeroValues;
 };
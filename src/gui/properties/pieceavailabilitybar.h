@@ -30,6 +30,7 @@
 #pragma once
 
 #include "piecesbar.h"
+#include "piecesbarbuckets.h"
 
 class PieceAvailabilityBar final : public PiecesBar
 {
@@ -50,10 +51,8 @@ private:
     QImage renderImage() override;
     QString simpleToolTipText() const override;
 
-    // last used int vector, uses to better resize redraw
-    // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
+    // last used int vector, to find changed pieces and to redraw on resize
     QVector<int> m_pieces;
-
-    // scale int vector to float vector
-    QVector<float> intToFloatVector(const QVector<int> &vecin, int reqSize);
+    PiecesBarBuckets m_piecesBuckets;
+    int m_maxAvailability = 0;
 };
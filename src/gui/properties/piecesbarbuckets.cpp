@@ -0,0 +1,163 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "piecesbarbuckets.h"
+
+#include <algorithm>
+#include <bit>
+
+#include <QBitArray>
+
+namespace
+{
+    // calls func with index of each set bit, zero bytes are skipped at once
+    template <typename Func>
+    void forEachSetBit(const QBitArray &bits, Func func)
+    {
+        const auto *data = reinterpret_cast<const uchar *>(bits.bits());
+        const qsizetype byteCount = (bits.size() + 7) / 8;
+        for (qsizetype byteIndex = 0; byteIndex < byteCount; ++byteIndex)
+        {
+            uchar byte = data[byteIndex];
+            while (byte != 0)
+            {
+                const int bit = std::countr_zero(byte);
+                func(static_cast<int>((byteIndex * 8) + bit));
+                byte &= (byte - 1);
+            }
+        }
+    }
+}
+
+int PiecesBarBuckets::bucketCount() const
+{
+    return static_cast<int>(m_sums.size());
+}
+
+void PiecesBarBuckets::assign(const QBitArray &pieces, const int bucketCount)
+{
+    reset(static_cast<int>(pieces.size()), bucketCount);
+    if (m_sums.isEmpty())
+        return;
+
+    forEachSetBit(pieces, [this](const int pieceIndex) { addToPiece(pieceIndex, 1); });
+}
+
+void PiecesBarBuckets::assign(const QList<int> &pieces, const int bucketCount)
+{
+    reset(static_cast<int>(pieces.size()), bucketCount);
+    if (m_sums.isEmpty())
+        return;
+
+    for (int i = 0; i < pieces.size(); ++i)
+    {
+        if (pieces[i] != 0)
+            addToPiece(i, pieces[i]);
+    }
+}
+
+void PiecesBarBuckets::update(const QBitArray &oldPieces, const QBitArray &newPieces)
+{
+    if (m_sums.isEmpty())
+        return;
+
+    if ((oldPieces.size() != m_pieceCount) || (newPieces.size() != m_pieceCount))
+    {
+        clear();
+        return;
+    }
+
+    const QBitArray changedPieces = oldPieces ^ newPieces;
+    forEachSetBit(changedPieces, [this, &newPieces](const int pieceIndex)
+    {
+        addToPiece(pieceIndex, (newPieces.testBit(pieceIndex) ? 1 : -1));
+    });
+}
+
+void PiecesBarBuckets::update(const QList<int> &oldPieces, const QList<int> &newPieces)
+{
+    if (m_sums.isEmpty())
+        return;
+
+    if ((oldPieces.size() != m_pieceCount) || (newPieces.size() != m_pieceCount))
+    {
+        clear();
+        return;
+    }
+
+    for (int i = 0; i < newPieces.size(); ++i)
+    {
+        if (const int delta = newPieces[i] - oldPieces[i]; delta != 0)
+            addToPiece(i, delta);
+    }
+}
+
+void PiecesBarBuckets::clear()
+{
+    m_pieceCount = 0;
+    m_sums.clear();
+}
+
+double PiecesBarBuckets::value(const int bucket) const
+{
+    if (m_sums.isEmpty())
+        return 0;
+
+    // each bucket covers as many units as there are pieces
+    return static_cast<double>(m_sums[bucket]) / static_cast<double>(m_pieceCount);
+}
+
+void PiecesBarBuckets::reset(const int pieceCount, const int bucketCount)
+{
+    if ((pieceCount <= 0) || (bucketCount <= 0))
+    {
+        clear();
+        return;
+    }
+
+    m_pieceCount = pieceCount;
+    m_sums.fill(0, bucketCount);
+}
+
+void PiecesBarBuckets::addToPiece(const int pieceIndex, const qint64 delta)
+{
+    // both pieces and buckets are measured in units of 1 / (pieceCount * bucketCount) of the bar,
+    // so piece spans bucketCount units and bucket spans pieceCount units
+    const qint64 bucketCount = m_sums.size();
+    const qint64 pieceBegin = pieceIndex * bucketCount;
+    const qint64 pieceEnd = pieceBegin + bucketCount;
+
+    const qint64 firstBucket = pieceBegin / m_pieceCount;
+    const qint64 lastBucket = (pieceEnd - 1) / m_pieceCount;
+    for (qint64 bucket = firstBucket; bucket <= lastBucket; ++bucket)
+    {
+        const qint64 bucketBegin = bucket * m_pieceCount;
+        const qint64 overlap = std::min(pieceEnd, (bucketBegin + m_pieceCount)) - std::max(pieceBegin, bucketBegin);
+        m_sums[bucket] += delta * overlap;
+    }
+}
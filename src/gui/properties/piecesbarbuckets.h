@@ -0,0 +1,63 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QtContainerFwd>
+#include <QList>
+
+class QBitArray;
+
+// Downsamples per piece values into per pixel buckets of pieces bar.
+// Each bucket keeps the sum of the values of the pieces it covers, weighted by the covered
+// part of each piece. The weights are exact integers, so when pieces change only the buckets
+// they overlap are updated instead of scaling all the pieces again.
+class PiecesBarBuckets
+{
+public:
+    int bucketCount() const;
+
+    // rebuilds all the buckets
+    void assign(const QBitArray &pieces, int bucketCount);
+    void assign(const QList<int> &pieces, int bucketCount);
+    // updates the buckets of the changed pieces only,
+    // buckets are invalidated if the number of pieces is changed
+    void update(const QBitArray &oldPieces, const QBitArray &newPieces);
+    void update(const QList<int> &oldPieces, const QList<int> &newPieces);
+    void clear();
+
+    // average value of the pieces covered by bucket, 0 if there are no pieces
+    double value(int bucket) const;
+
+private:
+    void reset(int pieceCount, int bucketCount);
+    void addToPiece(int pieceIndex, qint64 delta);
+
+    qint64 m_pieceCount = 0;
+    QList<qint64> m_sums;
+};
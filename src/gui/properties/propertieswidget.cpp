@@ -207,6 +207,7 @@ void PropertiesWidget::setVisibility(const bool visible)
 void PropertiesWidget::clear()
 {
     qDebug("Clearing torrent properties");
+    m_loadedStatusRevision = 0;
     m_ui->labelSavePathVal->clear();
     m_ui->labelCreatedOnVal->clear();
     m_ui->labelTotalPiecesVal->clear();
@@ -404,6 +405,11 @@ void PropertiesWidget::loadDynamicData()
     {
     case PropTabBar::MainTab:
         {
+            // nothing is displayed differently until the torrent data is changed
+            if (m_torrent->statusRevision() == m_loadedStatusRevision)
+                break;
+            m_loadedStatusRevision = m_torrent->statusRevision();
+
             m_ui->labelWastedVal->setText(Utils::Misc::friendlyUnit(m_torrent->wastedSize()));
 
             m_ui->labelUpTotalVal->setText(tr("%1 (%2 this session)").arg(Utils::Misc::friendlyUnit(m_torrent->totalUpload())
@@ -108,6 +108,8 @@ private:
 
     Ui::PropertiesWidget *m_ui = nullptr;
     BitTorrent::Torrent *m_torrent = nullptr;
+    // status revision of the torrent which data is displayed on the main tab
+    quint64 m_loadedStatusRevision = 0;
     SlideState m_state;
     PeerListWidget *m_peerList = nullptr;
     TrackerListWidget *m_trackerList = nullptr;
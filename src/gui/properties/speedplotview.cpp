@@ -29,6 +29,7 @@
 
 #include "speedplotview.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QLocale>
@@ -191,6 +192,13 @@ SpeedPlotView::SpeedPlotView(QWidget *parent)
     greenPen.setStyle(Qt::DotLine);
     m_properties[TRACKER_UP] = GraphProperties(tr("Tracker Upload"), bluePen);
     m_properties[TRACKER_DOWN] = GraphProperties(tr("Tracker Download"), greenPen);
+
+    bluePen.setStyle(Qt::SolidLine);
+    greenPen.setStyle(Qt::SolidLine);
+    bluePen.setWidthF(3);
+    greenPen.setWidthF(3);
+    m_properties[TORRENT_UP] = GraphProperties(tr("Selected Torrent Upload"), bluePen);
+    m_properties[TORRENT_DOWN] = GraphProperties(tr("Selected Torrent Download"), greenPen);
 }
 
 void SpeedPlotView::setGraphEnable(GraphID id, bool enable)
@@ -358,22 +366,59 @@ void SpeedPlotView::paintEvent(QPaintEvent *)
         if (!m_properties[static_cast<GraphID>(id)].enable)
             continue;
 
-        QVector<QPoint> points;
+        // samples falling into the same pixel column are decimated to their first, lowest,
+        // highest and last values, so at most 4 points per column are drawn and the
+        // polyline looks the same as if all the samples were drawn
+        m_points.clear();
         milliseconds duration {0};
+        int columnX = 0;
+        int firstY = 0;
+        int minY = 0;
+        int maxY = 0;
+        int lastY = 0;
+        int columnSize = 0;
+
+        const auto flushColumn = [this, &columnX, &firstY, &minY, &maxY, &lastY, &columnSize]()
+        {
+            m_points.push_back({columnX, firstY});
+            if (columnSize > 1)
+            {
+                m_points.push_back({columnX, minY});
+                m_points.push_back({columnX, maxY});
+                m_points.push_back({columnX, lastY});
+            }
+            columnSize = 0;
+        };
 
         for (int i = static_cast<int>(queue.size()) - 1; i >= 0; --i)
         {
             const int newX = rect.right() - (duration.count() * xTickSize);
             const int newY = rect.bottom() - (queue[i].data[id] * yMultiplier);
-            points.push_back(QPoint(newX, newY));
+            if ((columnSize > 0) && (newX != columnX))
+                flushColumn();
+
+            if (columnSize == 0)
+            {
+                columnX = newX;
+                firstY = minY = maxY = newY;
+            }
+            else
+            {
+                minY = std::min(minY, newY);
+                maxY = std::max(maxY, newY);
+            }
+            lastY = newY;
+            ++columnSize;
 
             duration += queue[i].duration;
             if (duration >= m_currentMaxDuration)
                 break;
         }
+        if (columnSize > 0)
+            flushColumn();
 
         painter.setPen(m_properties[static_cast<GraphID>(id)].pen);
-        painter.drawPolyline(points.data(), points.size());
+        painter.drawPolyline(m_points.data(), m_points.size());
     }
     painter.setClipping(false);
 
@@ -39,6 +39,8 @@
 #include <QElapsedTimer>
 #include <QGraphicsView>
 #include <QMap>
+#include <QPoint>
+#include <QVector>
 
 class QPen;
 
@@ -63,6 +65,8 @@ public:
         DHT_DOWN,
         TRACKER_UP,
         TRACKER_DOWN,
+        TORRENT_UP,
+        TORRENT_DOWN,
 
         NB_GRAPHS
     };
@@ -140,4 +144,6 @@ private:
 
     QMap<GraphID, GraphProperties> m_properties;
     milliseconds m_currentMaxDuration {0};
+    // reused by each repaint to avoid reallocations
+    QVector<QPoint> m_points;
 };
@@ -36,6 +36,7 @@
 
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/sessionstatus.h"
+#include "base/bittorrent/torrent.h"
 #include "base/preferences.h"
 #include "propertieswidget.h"
 #include "speedplotview.h"
@@ -56,6 +57,7 @@ void ComboBoxMenuButton::showPopup()
 
 SpeedWidget::SpeedWidget(PropertiesWidget *parent)
     : QWidget(parent)
+    , m_propertiesWidget {parent}
 {
     m_layout = new QVBoxLayout(this);
     m_layout->setContentsMargins(0, 0, 0, 0);
@@ -89,6 +91,8 @@ SpeedWidget::SpeedWidget(PropertiesWidget *parent)
     m_graphsMenu->addAction(tr("DHT Download"));
     m_graphsMenu->addAction(tr("Tracker Upload"));
     m_graphsMenu->addAction(tr("Tracker Download"));
+    m_graphsMenu->addAction(tr("Selected Torrent Upload"));
+    m_graphsMenu->addAction(tr("Selected Torrent Download"));
 
     m_graphsMenuActions = m_graphsMenu->actions();
 
@@ -142,6 +146,10 @@ void SpeedWidget::update()
     sampleData[SpeedPlotView::TRACKER_UP] = btStatus.trackerUploadRate;
     sampleData[SpeedPlotView::TRACKER_DOWN] = btStatus.trackerDownloadRate;
 
+    const BitTorrent::Torrent *torrent = m_propertiesWidget->getCurrentTorrent();
+    sampleData[SpeedPlotView::TORRENT_UP] = torrent ? torrent->uploadPayloadRate() : 0;
+    sampleData[SpeedPlotView::TORRENT_DOWN] = torrent ? torrent->downloadPayloadRate() : 0;
+
     m_plot->pushPoint(sampleData);
 }
 
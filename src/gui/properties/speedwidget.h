@@ -71,6 +71,7 @@ private:
     void loadSettings();
     void saveSettings() const;
 
+    PropertiesWidget *m_propertiesWidget = nullptr;
     QVBoxLayout *m_layout = nullptr;
     QHBoxLayout *m_hlayout = nullptr;
     QLabel *m_periodLabel = nullptr;
@@ -36,7 +36,6 @@
 #include <QKeyEvent>
 #include <QMenu>
 #include <QPalette>
-#include <QStandardItemModel>
 #include <QUrl>
 
 #include "base/preferences.h"
@@ -47,16 +46,12 @@
 #include "gui/interfaces/iguiapplication.h"
 #include "gui/lineedit.h"
 #include "gui/uithememanager.h"
+#include "searchresultlistmodel.h"
 #include "searchsortmodel.h"
 #include "ui_searchjobwidget.h"
 
 namespace
 {
-    enum DataRole
-    {
-        LinkVisitedRole = Qt::UserRole + 100
-    };
-
     QColor visitedRowColor()
     {
         return QApplication::palette().color(QPalette::Disabled, QPalette::WindowText);
@@ -78,18 +73,8 @@ SearchJobWidget::SearchJobWidget(SearchHandler *searchHandler, IGUIApplication *
     header()->setTextElideMode(Qt::ElideRight);
 
     // Set Search results list model
-    m_searchListModel = new QStandardItemModel(0, SearchSortModel::NB_SEARCH_COLUMNS, this);
-    m_searchListModel->setHeaderData(SearchSortModel::NAME, Qt::Horizontal, tr("Name", "i.e: file name"));
-    m_searchListModel->setHeaderData(SearchSortModel::SIZE, Qt::Horizontal, tr("Size", "i.e: file size"));
-    m_searchListModel->setHeaderData(SearchSortModel::SEEDS, Qt::Horizontal, tr("Seeders", "i.e: Number of full sources"));
-    m_searchListModel->setHeaderData(SearchSortModel::LEECHES, Qt::Horizontal, tr("Leechers", "i.e: Number of partial sources"));
-    m_searchListModel->setHeaderData(SearchSortModel::ENGINE_NAME, Qt::Horizontal, tr("Engine"));
-    m_searchListModel->setHeaderData(SearchSortModel::ENGINE_URL, Qt::Horizontal, tr("Engine URL"));
-    m_searchListModel->setHeaderData(SearchSortModel::PUB_DATE, Qt::Horizontal, tr("Published On"));
-    // Set columns text alignment
-    m_searchListModel->setHeaderData(SearchSortModel::SIZE, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_searchListModel->setHeaderData(SearchSortModel::SEEDS, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
-    m_searchListModel->setHeaderData(SearchSortModel::LEECHES, Qt::Horizontal, QVariant(Qt::AlignRight | Qt::AlignVCenter), Qt::TextAlignmentRole);
+    m_searchListModel = new SearchResultListModel(this);
+    m_searchListModel->setVisitedColor(visitedRowColor());
 
     m_proxyModel = new SearchSortModel(this);
     m_proxyModel->setDynamicSortFilter(true);
@@ -191,36 +176,15 @@ QHeaderView *SearchJobWidget::header() const
     return m_ui->resultsBrowser->header();
 }
 
-// Set the color of a row in data model
-void SearchJobWidget::setRowColor(int row, const QColor &color)
-{
-    for (int i = 0; i < m_proxyModel->columnCount(); ++i)
-        m_proxyModel->setData(m_proxyModel->index(row, i), color, Qt::ForegroundRole);
-}
-
 void SearchJobWidget::setRowVisited(const int row)
 {
-    m_proxyModel->setDynamicSortFilter(false);
-
-    m_proxyModel->setData(m_proxyModel->index(row, 0), true, LinkVisitedRole);
-    setRowColor(row, visitedRowColor());
-
-    m_proxyModel->setDynamicSortFilter(true);
+    const QModelIndex sourceIndex = m_proxyModel->mapToSource(m_proxyModel->index(row, 0));
+    m_searchListModel->setVisited(sourceIndex.row());
 }
 
 void SearchJobWidget::onUIThemeChanged()
 {
-    m_proxyModel->setDynamicSortFilter(false);
-
-    for (int row = 0; row < m_proxyModel->rowCount(); ++row)
-    {
-        const QVariant userData = m_proxyModel->data(m_proxyModel->index(row, 0), LinkVisitedRole);
-        const bool isVisited = userData.toBool();
-        if (isVisited)
-            setRowColor(row, visitedRowColor());
-    }
-
-    m_proxyModel->setDynamicSortFilter(true);
+    m_searchListModel->setVisitedColor(visitedRowColor());
 }
 
 SearchJobWidget::Status SearchJobWidget::status() const
@@ -548,35 +512,7 @@ void SearchJobWidget::searchFailed()
 
 void SearchJobWidget::appendSearchResults(const QVector<SearchResult> &results)
 {
-    for (const SearchResult &result : results)
-    {
-        // Add item to search result list
-        int row = m_searchListModel->rowCount();
-        m_searchListModel->insertRow(row);
-
-        const auto setModelData = [this, row] (const int column, const QString &displayData
-                , const QVariant &underlyingData, const Qt::Alignment textAlignmentData = {})
-        {
-            const QMap<int, QVariant> data =
-            {
-                {Qt::DisplayRole, displayData},
-                {SearchSortModel::UnderlyingDataRole, underlyingData},
-                {Qt::TextAlignmentRole, QVariant {textAlignmentData}}
-            };
-            m_searchListModel->setItemData(m_searchListModel->index(row, column), data);
-        };
-
-        setModelData(SearchSortModel::NAME, result.fileName, result.fileName);
-        setModelData(SearchSortModel::DL_LINK, result.fileUrl, result.fileUrl);
-        setModelData(SearchSortModel::ENGINE_NAME, result.engineName, result.engineName);
-        setModelData(SearchSortModel::ENGINE_URL, result.siteUrl, result.siteUrl);
-        setModelData(SearchSortModel::DESC_LINK, result.descrLink, result.descrLink);
-        setModelData(SearchSortModel::SIZE, Utils::Misc::friendlyUnit(result.fileSize), result.fileSize, (Qt::AlignRight | Qt::AlignVCenter));
-        setModelData(SearchSortModel::SEEDS, QString::number(result.nbSeeders), result.nbSeeders, (Qt::AlignRight | Qt::AlignVCenter));
-        setModelData(SearchSortModel::LEECHES, QString::number(result.nbLeechers), result.nbLeechers, (Qt::AlignRight | Qt::AlignVCenter));
-        setModelData(SearchSortModel::PUB_DATE, QLocale().toString(result.pubDate.toLocalTime(), QLocale::ShortFormat), result.pubDate);
-    }
-
+    m_searchListModel->addResults(results);
     updateResultsCount();
 }
 
@@ -40,10 +40,10 @@
 
 class QHeaderView;
 class QModelIndex;
-class QStandardItemModel;
 
 class LineEdit;
 class SearchHandler;
+class SearchResultListModel;
 class SearchSortModel;
 struct SearchResult;
 
@@ -114,7 +114,6 @@ private:
     NameFilteringMode filteringMode() const;
     QHeaderView *header() const;
     int visibleColumnsCount() const;
-    void setRowColor(int row, const QColor &color);
     void setRowVisited(int row);
     void onUIThemeChanged();
 
@@ -129,7 +128,7 @@ private:
 
     Ui::SearchJobWidget *m_ui = nullptr;
     SearchHandler *m_searchHandler = nullptr;
-    QStandardItemModel *m_searchListModel = nullptr;
+    SearchResultListModel *m_searchListModel = nullptr;
     SearchSortModel *m_proxyModel = nullptr;
     LineEdit *m_lineEditSearchResultsFilter = nullptr;
     Status m_status = Status::Ongoing;
@@ -0,0 +1,347 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "searchresultlistmodel.h"
+
+#include <QLocale>
+#include <QTemporaryFile>
+
+#include "base/global.h"
+#include "base/search/searchresult.h"
+#include "base/utils/misc.h"
+#include "searchsortmodel.h"
+
+namespace
+{
+    // links of very large jobs are moved to disk in chunks of this size
+    const qsizetype LINKS_BUFFER_MAX_SIZE = 4 * 1024 * 1024;
+}
+
+SearchResultListModel::SearchResultListModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+SearchResultListModel::~SearchResultListModel() = default;
+
+int SearchResultListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_names.size();
+}
+
+int SearchResultListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : SearchSortModel::NB_SEARCH_COLUMNS;
+}
+
+QVariant SearchResultListModel::data(const QModelIndex &index, const int role) const
+{
+    if (!index.isValid() || (index.row() >= rowCount()))
+        return {};
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return displayData(index.row(), index.column());
+    case SearchSortModel::UnderlyingDataRole:
+        return underlyingData(index.row(), index.column());
+    case Qt::TextAlignmentRole:
+        switch (index.column())
+        {
+        case SearchSortModel::SIZE:
+        case SearchSortModel::SEEDS:
+        case SearchSortModel::LEECHES:
+            return QVariant {Qt::AlignRight | Qt::AlignVCenter};
+        default:
+            return {};
+        }
+    case Qt::ForegroundRole:
+        if (isVisited(index.row()) && m_visitedColor.isValid())
+            return m_visitedColor;
+        return {};
+    default:
+        return {};
+    }
+}
+
+QVariant SearchResultListModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+    if (orientation != Qt::Horizontal)
+        return {};
+
+    if (role == Qt::DisplayRole)
+    {
+        switch (section)
+        {
+        case SearchSortModel::NAME:
+            return tr("Name", "i.e: file name");
+        case SearchSortModel::SIZE:
+            return tr("Size", "i.e: file size");
+        case SearchSortModel::SEEDS:
+            return tr("Seeders", "i.e: Number of full sources");
+        case SearchSortModel::LEECHES:
+            return tr("Leechers", "i.e: Number of partial sources");
+        case SearchSortModel::ENGINE_NAME:
+            return tr("Engine");
+        case SearchSortModel::ENGINE_URL:
+            return tr("Engine URL");
+        case SearchSortModel::PUB_DATE:
+            return tr("Published On");
+        default:
+            return {};
+        }
+    }
+
+    if (role == Qt::TextAlignmentRole)
+    {
+        switch (section)
+        {
+        case SearchSortModel::SIZE:
+        case SearchSortModel::SEEDS:
+        case SearchSortModel::LEECHES:
+            return QVariant {Qt::AlignRight | Qt::AlignVCenter};
+        default:
+            return {};
+        }
+    }
+
+    return {};
+}
+
+void SearchResultListModel::addResults(const QList<SearchResult> &results)
+{
+    if (results.isEmpty())
+        return;
+
+    const int firstRow = rowCount();
+    beginInsertRows({}, firstRow, (firstRow + results.size() - 1));
+
+    const qsizetype newSize = firstRow + results.size();
+    m_names.reserve(newSize);
+    m_sizes.reserve(newSize);
+    m_seeders.reserve(newSize);
+    m_leechers.reserve(newSize);
+    m_engineIds.reserve(newSize);
+    m_pubDates.reserve(newSize);
+    m_links.reserve(newSize);
+
+    for (const SearchResult &result : results)
+    {
+        m_names.append(result.fileName);
+        m_sizes.append(result.fileSize);
+        m_seeders.append(result.nbSeeders);
+        m_leechers.append(result.nbLeechers);
+        m_engineIds.append(engineId(result.engineName, result.siteUrl));
+        m_pubDates.append(result.pubDate);
+        storeLinks(result.fileUrl, result.descrLink);
+    }
+    m_visited.resize(newSize);
+
+    endInsertRows();
+}
+
+QString SearchResultListModel::name(const int row) const
+{
+    return m_names[row];
+}
+
+qint64 SearchResultListModel::size(const int row) const
+{
+    return m_sizes[row];
+}
+
+qint64 SearchResultListModel::seeders(const int row) const
+{
+    return m_seeders[row];
+}
+
+qint64 SearchResultListModel::leechers(const int row) const
+{
+    return m_leechers[row];
+}
+
+QString SearchResultListModel::engineName(const int row) const
+{
+    return m_engines[m_engineIds[row]].name;
+}
+
+QString SearchResultListModel::siteUrl(const int row) const
+{
+    return m_engines[m_engineIds[row]].siteUrl;
+}
+
+QDateTime SearchResultListModel::pubDate(const int row) const
+{
+    return m_pubDates[row];
+}
+
+QString SearchResultListModel::fileUrl(const int row) const
+{
+    const LinksLocation &location = m_links[row];
+    return QString::fromUtf8(readLinks(location).first(location.fileUrlSize));
+}
+
+QString SearchResultListModel::descrLink(const int row) const
+{
+    const LinksLocation &location = m_links[row];
+    return QString::fromUtf8(readLinks(location).sliced(location.fileUrlSize));
+}
+
+bool SearchResultListModel::isVisited(const int row) const
+{
+    return m_visited.testBit(row);
+}
+
+void SearchResultListModel::setVisited(const int row)
+{
+    if (isVisited(row))
+        return;
+
+    m_visited.setBit(row);
+    emit dataChanged(index(row, 0), index(row, (SearchSortModel::NB_SEARCH_COLUMNS - 1)), {Qt::ForegroundRole});
+}
+
+void SearchResultListModel::setVisitedColor(const QColor &color)
+{
+    m_visitedColor = color;
+    if (rowCount() > 0)
+        emit dataChanged(index(0, 0), index((rowCount() - 1), (SearchSortModel::NB_SEARCH_COLUMNS - 1)), {Qt::ForegroundRole});
+}
+
+QVariant SearchResultListModel::displayData(const int row, const int column) const
+{
+    switch (column)
+    {
+    case SearchSortModel::NAME:
+        return name(row);
+    case SearchSortModel::SIZE:
+        return Utils::Misc::friendlyUnit(size(row));
+    case SearchSortModel::SEEDS:
+        return QString::number(seeders(row));
+    case SearchSortModel::LEECHES:
+        return QString::number(leechers(row));
+    case SearchSortModel::ENGINE_NAME:
+        return engineName(row);
+    case SearchSortModel::ENGINE_URL:
+        return siteUrl(row);
+    case SearchSortModel::PUB_DATE:
+        return QLocale().toString(pubDate(row).toLocalTime(), QLocale::ShortFormat);
+    case SearchSortModel::DL_LINK:
+        return fileUrl(row);
+    case SearchSortModel::DESC_LINK:
+        return descrLink(row);
+    default:
+        return {};
+    }
+}
+
+QVariant SearchResultListModel::underlyingData(const int row, const int column) const
+{
+    switch (column)
+    {
+    case SearchSortModel::SIZE:
+        return size(row);
+    case SearchSortModel::SEEDS:
+        return seeders(row);
+    case SearchSortModel::LEECHES:
+        return leechers(row);
+    case SearchSortModel::PUB_DATE:
+        return pubDate(row);
+    default:
+        return displayData(row, column);
+    }
+}
+
+int SearchResultListModel::engineId(const QString &name, const QString &siteUrl)
+{
+    const QString key = name + u'\n' + siteUrl;
+    const auto it = m_engineIdsByKey.constFind(key);
+    if (it != m_engineIdsByKey.cend())
+        return it.value();
+
+    const int id = m_engines.size();
+    m_engines.append({.name = name, .siteUrl = siteUrl});
+    m_engineIdsByKey.insert(key, id);
+    return id;
+}
+
+void SearchResultListModel::storeLinks(const QString &fileUrl, const QString &descrLink)
+{
+    const QByteArray fileUrlData = fileUrl.toUtf8();
+    const QByteArray descrLinkData = descrLink.toUtf8();
+
+    m_links.append({.offset = (m_spilledLinksSize + m_linksBuffer.size())
+        , .fileUrlSize = static_cast<int>(fileUrlData.size()), .descrLinkSize = static_cast<int>(descrLinkData.size())});
+    m_linksBuffer.append(fileUrlData);
+    m_linksBuffer.append(descrLinkData);
+
+    if (m_linksBuffer.size() >= LINKS_BUFFER_MAX_SIZE)
+        spillLinks();
+}
+
+QByteArray SearchResultListModel::readLinks(const LinksLocation &location) const
+{
+    const qsizetype linksSize = location.fileUrlSize + location.descrLinkSize;
+    if (location.offset >= m_spilledLinksSize)
+        return m_linksBuffer.sliced((location.offset - m_spilledLinksSize), linksSize);
+
+    if (!m_linksFile->seek(location.offset))
+        return QByteArray(linksSize, '\0');
+
+    QByteArray data = m_linksFile->read(linksSize);
+    data.resize(linksSize);
+    return data;
+}
+
+void SearchResultListModel::spillLinks()
+{
+    if (m_isSpillingDisabled)
+        return;
+
+    if (!m_linksFile)
+    {
+        auto file = std::make_unique<QTemporaryFile>();
+        if (!file->open())
+        {
+            m_isSpillingDisabled = true;
+            return;
+        }
+
+        m_linksFile = std::move(file);
+    }
+
+    // on failure all the links not spilled so far just stay in memory
+    if (!m_linksFile->seek(m_spilledLinksSize) || (m_linksFile->write(m_linksBuffer) != m_linksBuffer.size()))
+    {
+        m_isSpillingDisabled = true;
+        return;
+    }
+
+    m_spilledLinksSize += m_linksBuffer.size();
+    m_linksBuffer.clear();
+}
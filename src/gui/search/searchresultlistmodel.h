@@ -0,0 +1,118 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <QAbstractTableModel>
+#include <QBitArray>
+#include <QByteArray>
+#include <QColor>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class QTemporaryFile;
+struct SearchResult;
+
+// Search results are stored column by column and display data is only produced when
+// it is requested. Engine names and URLs are shared between rows, links are packed into
+// single buffer which is moved to temporary file once it grows too large.
+class SearchResultListModel final : public QAbstractTableModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(SearchResultListModel)
+
+public:
+    explicit SearchResultListModel(QObject *parent = nullptr);
+    ~SearchResultListModel() override;
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void addResults(const QList<SearchResult> &results);
+
+    QString name(int row) const;
+    qint64 size(int row) const;
+    qint64 seeders(int row) const;
+    qint64 leechers(int row) const;
+    QString engineName(int row) const;
+    QString siteUrl(int row) const;
+    QDateTime pubDate(int row) const;
+    QString fileUrl(int row) const;
+    QString descrLink(int row) const;
+
+    bool isVisited(int row) const;
+    void setVisited(int row);
+    void setVisitedColor(const QColor &color);
+
+private:
+    struct Engine
+    {
+        QString name;
+        QString siteUrl;
+    };
+
+    struct LinksLocation
+    {
+        qint64 offset = 0;
+        int fileUrlSize = 0;
+        int descrLinkSize = 0;
+    };
+
+    QVariant displayData(int row, int column) const;
+    QVariant underlyingData(int row, int column) const;
+    int engineId(const QString &name, const QString &siteUrl);
+    void storeLinks(const QString &fileUrl, const QString &descrLink);
+    QByteArray readLinks(const LinksLocation &location) const;
+    void spillLinks();
+
+    QStringList m_names;
+    QList<qint64> m_sizes;
+    QList<qint64> m_seeders;
+    QList<qint64> m_leechers;
+    QList<int> m_engineIds;
+    QList<QDateTime> m_pubDates;
+    QList<LinksLocation> m_links;
+    QBitArray m_visited;
+
+    QList<Engine> m_engines;
+    QHash<QString, int> m_engineIdsByKey;
+
+    // links of the rows are stored one after another, older ones may be moved to file
+    QByteArray m_linksBuffer;
+    qint64 m_spilledLinksSize = 0;
+    std::unique_ptr<QTemporaryFile> m_linksFile;
+    bool m_isSpillingDisabled = false;
+
+    QColor m_visitedColor;
+};
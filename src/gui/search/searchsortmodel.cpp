@@ -29,6 +29,7 @@
 #include "searchsortmodel.h"
 
 #include "base/global.h"
+#include "searchresultlistmodel.h"
 
 SearchSortModel::SearchSortModel(QObject *parent)
     : base(parent)
@@ -99,18 +100,35 @@ qint64 SearchSortModel::maxSize() const
     return m_maxSize;
 }
 
+const SearchResultListModel *SearchSortModel::resultsModel() const
+{
+    Q_ASSERT(qobject_cast<const SearchResultListModel *>(sourceModel()));
+    return static_cast<const SearchResultListModel *>(sourceModel());
+}
+
 bool SearchSortModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
+    // compare values directly, building variants for every comparison is what makes sorting slow
+    const SearchResultListModel *model = resultsModel();
+    const int leftRow = left.row();
+    const int rightRow = right.row();
+
     switch (sortColumn())
     {
     case NAME:
+        return m_naturalLessThan(model->name(leftRow), model->name(rightRow));
     case ENGINE_URL:
-        {
-            const QString strL = left.data().toString();
-            const QString strR = right.data().toString();
-            return m_naturalLessThan(strL, strR);
-        }
-        break;
+        return m_naturalLessThan(model->siteUrl(leftRow), model->siteUrl(rightRow));
+    case SIZE:
+        return model->size(leftRow) < model->size(rightRow);
+    case SEEDS:
+        return model->seeders(leftRow) < model->seeders(rightRow);
+    case LEECHES:
+        return model->leechers(leftRow) < model->leechers(rightRow);
+    case ENGINE_NAME:
+        return model->engineName(leftRow) < model->engineName(rightRow);
+    case PUB_DATE:
+        return model->pubDate(leftRow) < model->pubDate(rightRow);
     default:
         return base::lessThan(left, right);
     };
@@ -118,11 +136,11 @@ bool SearchSortModel::lessThan(const QModelIndex &left, const QModelIndex &right
 
 bool SearchSortModel::filterAcceptsRow(const int sourceRow, const QModelIndex &sourceParent) const
 {
-    const QAbstractItemModel *const sourceModel = this->sourceModel();
+    const SearchResultListModel *model = resultsModel();
 
     if (m_isNameFilterEnabled && !m_searchTerm.isEmpty())
     {
-        const QString name = sourceModel->data(sourceModel->index(sourceRow, NAME, sourceParent), UnderlyingDataRole).toString();
+        const QString name = model->name(sourceRow);
         for (const QString &word : asConst(m_searchTermWords))
         {
             if (!name.contains(word, Qt::CaseInsensitive))
@@ -132,7 +150,7 @@ bool SearchSortModel::filterAcceptsRow(const int sourceRow, const QModelIndex &s
 
     if ((m_minSize > 0) || (m_maxSize >= 0))
     {
-        const qlonglong size = sourceModel->data(sourceModel->index(sourceRow, SIZE, sourceParent), UnderlyingDataRole).toLongLong();
+        const qint64 size = model->size(sourceRow);
         if (((m_minSize > 0) && (size < m_minSize))
             || ((m_maxSize > 0) && (size > m_maxSize)))
             return false;
@@ -140,7 +158,7 @@ bool SearchSortModel::filterAcceptsRow(const int sourceRow, const QModelIndex &s
 
     if ((m_minSeeds > 0) || (m_maxSeeds >= 0))
     {
-        const int seeds = sourceModel->data(sourceModel->index(sourceRow, SEEDS, sourceParent), UnderlyingDataRole).toInt();
+        const qint64 seeds = model->seeders(sourceRow);
         if (((m_minSeeds > 0) && (seeds < m_minSeeds))
             || ((m_maxSeeds > 0) && (seeds > m_maxSeeds)))
             return false;
@@ -148,7 +166,7 @@ bool SearchSortModel::filterAcceptsRow(const int sourceRow, const QModelIndex &s
 
     if ((m_minLeeches > 0) || (m_maxLeeches >= 0))
     {
-        const int leeches = sourceModel->data(sourceModel->index(sourceRow, LEECHES, sourceParent), UnderlyingDataRole).toInt();
+        const qint64 leeches = model->leechers(sourceRow);
         if (((m_minLeeches > 0) && (leeches < m_minLeeches))
             || ((m_maxLeeches > 0) && (leeches > m_maxLeeches)))
             return false;
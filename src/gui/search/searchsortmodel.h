@@ -33,6 +33,8 @@
 
 #include "base/utils/compare.h"
 
+class SearchResultListModel;
+
 class SearchSortModel final : public QSortFilterProxyModel
 {
     using base = QSortFilterProxyModel;
@@ -92,6 +94,8 @@ protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
 
 private:
+    const SearchResultListModel *resultsModel() const;
+
     bool m_isNameFilterEnabled = false;
     QString m_searchTerm;
     QStringList m_searchTermWords;
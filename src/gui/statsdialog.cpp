@@ -30,11 +30,15 @@
 
 #include <algorithm>
 
+#include <QTreeWidgetItem>
+
 #include "base/bittorrent/cachestatus.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/sessionmetrics.h"
 #include "base/bittorrent/sessionstatus.h"
 #include "base/bittorrent/torrent.h"
 #include "base/global.h"
+#include "base/memoryusage.h"
 #include "base/utils/misc.h"
 #include "base/utils/string.h"
 #include "ui_statsdialog.h"
@@ -42,6 +46,17 @@
 
 #define SETTINGS_KEY(name) u"StatisticsDialog/" name
 
+namespace
+{
+    // the busiest torrents only, the list is rebuilt on every update
+    const int MAX_DISK_IO_TORRENTS = 100;
+
+    QString formatDuration(const qint64 nanoseconds)
+    {
+        return StatsDialog::tr("%1 ms", "18 milliseconds").arg(Utils::String::fromDouble((nanoseconds / 1e6), 2));
+    }
+}
+
 StatsDialog::StatsDialog(QWidget *parent)
     : QDialog(parent)
     , m_ui(new Ui::StatsDialog)
@@ -51,15 +66,30 @@ StatsDialog::StatsDialog(QWidget *parent)
 
     connect(m_ui->buttonBox, &QDialogButtonBox::accepted, this, &StatsDialog::close);
 
+#ifdef QBT_USES_LIBTORRENT2
+    const QString jobNames[BitTorrent::DISK_JOB_TYPE_COUNT] = {tr("Read"), tr("Write"), tr("Hash"), tr("Other")};
+    for (const QString &jobName : jobNames)
+        new QTreeWidgetItem(m_ui->treeDiskJobs, {jobName});
+    for (int column = 1; column < m_ui->treeDiskJobs->columnCount(); ++column)
+        m_ui->treeDiskJobs->headerItem()->setTextAlignment(column, (Qt::AlignRight | Qt::AlignVCenter));
+    for (int column = 1; column < m_ui->treeDiskTorrents->columnCount(); ++column)
+        m_ui->treeDiskTorrents->headerItem()->setTextAlignment(column, (Qt::AlignRight | Qt::AlignVCenter));
+#else
+    // disk I/O statistics are collected by custom disk I/O backend of libtorrent 2.0
+    m_ui->tabWidget->removeTab(m_ui->tabWidget->indexOf(m_ui->tabDiskIO));
+#endif
+    for (int column = 1; column < m_ui->treeMemoryUsage->columnCount(); ++column)
+        m_ui->treeMemoryUsage->headerItem()->setTextAlignment(column, (Qt::AlignRight | Qt::AlignVCenter));
+    connect(m_ui->tabWidget, &QTabWidget::currentChanged, this, [this](const int index)
+    {
+        if (m_ui->tabWidget->widget(index) == m_ui->tabMemory)
+            updateMemoryUsage();
+    });
+
     update();
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::statsUpdated
             , this, &StatsDialog::update);
 
-#ifdef QBT_USES_LIBTORRENT2
-    m_ui->labelCacheHitsText->hide();
-    m_ui->labelCacheHits->hide();
-#endif
-
     if (const QSize dialogSize = m_storeDialogSize; dialogSize.isValid())
         resize(dialogSize);
 }
@@ -87,15 +117,13 @@ void StatsDialog::update()
                 ((atd > 0) && (atu > 0))
                 ? Utils::String::fromDouble(static_cast<qreal>(atu) / atd, 2)
                 : u"-"_s);
-#ifndef QBT_USES_LIBTORRENT2
     // Cache hits
     const qreal readRatio = cs.readRatio;
     m_ui->labelCacheHits->setText(u"%1%"_s.arg((readRatio > 0)
         ? Utils::String::fromDouble((100 * readRatio), 2)
         : u"0"_s));
-#endif
     // Buffers size
-    m_ui->labelTotalBuf->setText(Utils::Misc::friendlyUnit(cs.totalUsedBuffers * 16 * 1024));
+    m_ui->labelTotalBuf->setText(Utils::Misc::friendlyUnit((cs.totalUsedBuffers * 16 * 1024) + cs.readCacheSize));
     // Disk overload (100%) equivalent
     // From lt manual: disk_write_queue and disk_read_queue are the number of peers currently waiting on a disk write or disk read
     // to complete before it receives or sends any more data on the socket. It's a metric of how disk bound you are.
@@ -114,4 +142,70 @@ void StatsDialog::update()
 
     // Total connected peers
     m_ui->labelPeers->setText(QString::number(ss.peersCount));
+
+#ifdef QBT_USES_LIBTORRENT2
+    updateDiskIO();
+#endif
+    // the estimation walks through all the data, so it is only done while the results are visible
+    if (m_ui->tabWidget->currentWidget() == m_ui->tabMemory)
+        updateMemoryUsage();
+}
+
+#ifdef QBT_USES_LIBTORRENT2
+void StatsDialog::updateDiskIO()
+{
+    const auto *session = BitTorrent::Session::instance();
+    const BitTorrent::DiskIOStatistics stats = session->metrics().diskIO;
+
+    m_ui->labelDiskQueueDepth->setText(QString::number(stats.queueDepth));
+    m_ui->labelDiskMaxQueueDepth->setText(QString::number(stats.maxQueueDepth));
+
+    for (int i = 0; i < BitTorrent::DISK_JOB_TYPE_COUNT; ++i)
+    {
+        const BitTorrent::DiskJobLatency &latency = stats.latency[i];
+        QTreeWidgetItem *item = m_ui->treeDiskJobs->topLevelItem(i);
+        item->setText(1, QString::number(latency.count));
+        item->setText(2, formatDuration((latency.count > 0) ? (latency.totalTime / latency.count) : 0));
+        item->setText(3, formatDuration(latency.quantile(0.5)));
+        item->setText(4, formatDuration(latency.quantile(0.99)));
+        item->setText(5, formatDuration(latency.maxTime));
+        for (int column = 1; column < item->columnCount(); ++column)
+            item->setTextAlignment(column, (Qt::AlignRight | Qt::AlignVCenter));
+    }
+
+    using TorrentStats = std::pair<BitTorrent::TorrentID, BitTorrent::TorrentDiskIOStatistics>;
+    QList<TorrentStats> torrents;
+    torrents.reserve(stats.torrents.size());
+    for (auto it = stats.torrents.cbegin(); it != stats.torrents.cend(); ++it)
+        torrents.append({it.key(), it.value()});
+
+    const qsizetype count = std::min<qsizetype>(torrents.size(), MAX_DISK_IO_TORRENTS);
+    std::partial_sort(torrents.begin(), (torrents.begin() + count), torrents.end(), [](const TorrentStats &left, const TorrentStats &right)
+    {
+        return (left.second.bytesRead + left.second.bytesWritten) > (right.second.bytesRead + right.second.bytesWritten);
+    });
+
+    m_ui->treeDiskTorrents->clear();
+    for (qsizetype i = 0; i < count; ++i)
+    {
+        const auto &[id, torrentStats] = torrents[i];
+        const BitTorrent::Torrent *torrent = session->getTorrent(id);
+        auto *item = new QTreeWidgetItem(m_ui->treeDiskTorrents, {(torrent ? torrent->name() : id.toString())
+            , Utils::Misc::friendlyUnit(torrentStats.bytesRead), Utils::Misc::friendlyUnit(torrentStats.bytesWritten)});
+        item->setTextAlignment(1, (Qt::AlignRight | Qt::AlignVCenter));
+        item->setTextAlignment(2, (Qt::AlignRight | Qt::AlignVCenter));
+    }
+}
+#endif
+
+void StatsDialog::updateMemoryUsage()
+{
+    m_ui->treeMemoryUsage->clear();
+    for (const MemoryUsage::Entry &entry : asConst(MemoryUsage::report()))
+    {
+        auto *item = new QTreeWidgetItem(m_ui->treeMemoryUsage, {entry.name
+            , QString::number(entry.count), Utils::Misc::friendlyUnit(entry.bytes)});
+        item->setTextAlignment(1, (Qt::AlignRight | Qt::AlignVCenter));
+        item->setTextAlignment(2, (Qt::AlignRight | Qt::AlignVCenter));
+    }
 }
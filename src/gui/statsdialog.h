@@ -50,6 +50,11 @@ private slots:
     void update();
 
 private:
+#ifdef QBT_USES_LIBTORRENT2
+    void updateDiskIO();
+#endif
+    void updateMemoryUsage();
+
     Ui::StatsDialog *m_ui = nullptr;
     SettingValue<QSize> m_storeDialogSize;
 };
@@ -139,6 +139,12 @@ StatusBar::StatusBar(QWidget *parent)
     layout->addWidget(statusSep3);
     layout->addWidget(m_upSpeedLbl);
 
+    // removing content of large torrents can take a while
+    m_contentRemovingLbl = new QLabel(this);
+    m_contentRemovingLbl->setVisible(false);
+    addWidget(m_contentRemovingLbl);
+    connect(session, &BitTorrent::Session::torrentContentRemovingProgressChanged, this, &StatusBar::updateContentRemovingProgress);
+
     addPermanentWidget(container);
     setStyleSheet(u"QWidget {margin: 0;}"_s);
     container->adjustSize();
@@ -198,6 +204,13 @@ void StatusBar::updateConnectionStatus()
     }
 }
 
+void StatusBar::updateContentRemovingProgress(const int removedFiles, const int totalFiles)
+{
+    m_contentRemovingLbl->setVisible(totalFiles > 0);
+    if (totalFiles > 0)
+        m_contentRemovingLbl->setText(tr("Removing torrent content: %1/%2 files").arg(QString::number(removedFiles), QString::number(totalFiles)));
+}
+
 void StatusBar::updateDHTNodesNumber()
 {
     if (BitTorrent::Session::instance()->isDHTEnabled())
@@ -148,6 +148,8 @@ BitTorrent::CategoryOptions TorrentCategoryDialog::categoryOptions() const
         categoryOptions.downloadPath = {true, m_ui->comboDownloadPath->selectedPath()};
     else if (m_ui->comboUseDownloadPath->currentIndex() == 2)
         categoryOptions.downloadPath = {false, {}};
+    categoryOptions.uploadLimit = m_ui->spinUploadLimit->value() * 1024;
+    categoryOptions.downloadLimit = m_ui->spinDownloadLimit->value() * 1024;
 
     return categoryOptions;
 }
@@ -165,6 +167,9 @@ void TorrentCategoryDialog::setCategoryOptions(const BitTorrent::CategoryOptions
         m_ui->comboUseDownloadPath->setCurrentIndex(0);
         m_ui->comboDownloadPath->setSelectedPath({});
     }
+
+    m_ui->spinUploadLimit->setValue(categoryOptions.uploadLimit / 1024);
+    m_ui->spinDownloadLimit->setValue(categoryOptions.downloadLimit / 1024);
 }
 
 void TorrentCategoryDialog::categoryNameChanged(const QString &categoryName)
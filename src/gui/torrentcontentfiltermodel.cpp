@@ -87,15 +87,14 @@ bool TorrentContentFilterModel::lessThan(const QModelIndex &left, const QModelIn
     {
     case TorrentContentModelItem::COL_NAME:
         {
-            const TorrentContentModelItem::ItemType leftType = m_model->itemType(m_model->index(left.row(), 0, left.parent()));
-            const TorrentContentModelItem::ItemType rightType = m_model->itemType(m_model->index(right.row(), 0, right.parent()));
+            const QModelIndex leftNameIndex = m_model->index(left.row(), 0, left.parent());
+            const QModelIndex rightNameIndex = m_model->index(right.row(), 0, right.parent());
+            const TorrentContentModelItem::ItemType leftType = m_model->itemType(leftNameIndex);
+            const TorrentContentModelItem::ItemType rightType = m_model->itemType(rightNameIndex);
 
             if (leftType == rightType)
-            {
-                const QString strL = left.data().toString();
-                const QString strR = right.data().toString();
-                return m_naturalLessThan(strL, strR);
-            }
+                return (m_model->nameSortKey(leftNameIndex).compare(m_model->nameSortKey(rightNameIndex)) < 0);
+
 
             if ((leftType == TorrentContentModelItem::FolderType) && (sortOrder() == Qt::AscendingOrder))
             {
@@ -31,7 +31,6 @@
 
 #include <QSortFilterProxyModel>
 
-#include "base/utils/compare.h"
 #include "torrentcontentmodelitem.h"
 
 class TorrentContentModel;
@@ -56,5 +55,4 @@ private:
     bool hasFiltered(const QModelIndex &folder) const;
 
     TorrentContentModel *m_model = nullptr;
-    Utils::Compare::NaturalLessThan<Qt::CaseInsensitive> m_naturalLessThan;
 };
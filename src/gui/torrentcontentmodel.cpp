@@ -181,7 +181,20 @@ TorrentContentModel::~TorrentContentModel()
     delete m_rootItem;
 }
 
-void TorrentContentModel::updateFilesProgress()
+void TorrentContentModel::ChangedItems::add(TorrentContentModelItem *item)
+{
+    items.append(item);
+
+    // if a folder is already there, so are all of its ancestors
+    for (TorrentContentModelFolder *folder = item->parent(); !folder->isRootItem(); folder = folder->parent())
+    {
+        if (folders.contains(folder))
+            break;
+        folders.insert(folder);
+    }
+}
+
+void TorrentContentModel::updateFilesProgress(ChangedItems &changedItems)
 {
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
@@ -192,13 +205,17 @@ void TorrentContentModel::updateFilesProgress()
         return;
 
     for (int i = 0; i < filesProgress.size(); ++i)
-        m_filesIndex[i]->setProgress(filesProgress[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
+    {
+        TorrentContentModelFile *file = m_filesIndex[i];
+        if (file->progress() == filesProgress[i])
+            continue;
+
+        file->setProgress(filesProgress[i]);
+        changedItems.add(file);
+    }
 }
 
-void TorrentContentModel::updateFilesPriorities()
+void TorrentContentModel::updateFilesPriorities(ChangedItems &changedItems)
 {
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
@@ -209,7 +226,15 @@ void TorrentContentModel::updateFilesPriorities()
         return;
 
     for (int i = 0; i < fprio.size(); ++i)
-        m_filesIndex[i]->setPriority(static_cast<BitTorrent::DownloadPriority>(fprio[i]));
+    {
+        TorrentContentModelFile *file = m_filesIndex[i];
+        const auto priority = static_cast<BitTorrent::DownloadPriority>(fprio[i]);
+        if (file->priority() == priority)
+            continue;
+
+        file->setPriority(priority);
+        changedItems.add(file);
+    }
 }
 
 void TorrentContentModel::updateFilesAvailability()
@@ -227,13 +252,44 @@ void TorrentContentModel::updateFilesAvailability()
         if (m_filesIndex.size() != availableFileFractions.size()) [[unlikely]]
             return;
 
+        ChangedItems changedItems;
         for (int i = 0; i < m_filesIndex.size(); ++i)
-            m_filesIndex[i]->setAvailability(availableFileFractions[i]);
-        // Update folders progress in the tree
-        m_rootItem->recalculateProgress();
+        {
+            TorrentContentModelFile *file = m_filesIndex[i];
+            if (file->availability() == availableFileFractions[i])
+                continue;
+
+            file->setAvailability(availableFileFractions[i]);
+            changedItems.add(file);
+        }
+
+        recalculateFolders(changedItems.folders);
+        notifyItemsUpdated(changedItems, {{TorrentContentModelItem::COL_AVAILABILITY, TorrentContentModelItem::COL_AVAILABILITY}});
     });
 }
 
+void TorrentContentModel::recalculateFolders(const QSet<TorrentContentModelFolder *> &folders)
+{
+    // subfolders have to be recalculated before their parents
+    QVector<std::pair<int, TorrentContentModelFolder *>> foldersByDepth;
+    foldersByDepth.reserve(folders.size());
+    for (TorrentContentModelFolder *folder : folders)
+    {
+        int depth = 0;
+        for (const TorrentContentModelFolder *parent = folder->parent(); parent; parent = parent->parent())
+            ++depth;
+        foldersByDepth.append({depth, folder});
+    }
+    std::sort(foldersByDepth.begin(), foldersByDepth.end()
+        , [](const auto &left, const auto &right) { return left.first > right.first; });
+
+    for (const auto &[depth, folder] : asConst(foldersByDepth))
+    {
+        folder->recalculateProgress();
+        folder->recalculateAvailability();
+    }
+}
+
 bool TorrentContentModel::setItemPriority(const QModelIndex &index, BitTorrent::DownloadPriority priority)
 {
     Q_ASSERT(index.isValid());
@@ -246,14 +302,26 @@ bool TorrentContentModel::setItemPriority(const QModelIndex &index, BitTorrent::
     item->setPriority(priority);
     m_contentHandler->prioritizeFiles(getFilePriorities());
 
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
+    // Update progress of the folders in the subtree and of the ancestors
+    ChangedItems changedItems;
+    changedItems.add(item);
+    QVector<TorrentContentModelItem *> subtree {item};
+    while (!subtree.isEmpty())
+    {
+        TorrentContentModelItem *subtreeItem = subtree.takeLast();
+        if (subtreeItem->itemType() != TorrentContentModelItem::FolderType)
+            continue;
+
+        auto *folder = static_cast<TorrentContentModelFolder *>(subtreeItem);
+        changedItems.folders.insert(folder);
+        subtree.append(folder->children());
+    }
+    recalculateFolders(changedItems.folders);
 
     const QVector<ColumnInterval> columns =
     {
         {TorrentContentModelItem::COL_NAME, TorrentContentModelItem::COL_NAME},
-        {TorrentContentModelItem::COL_PRIO, TorrentContentModelItem::COL_PRIO}
+        {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_AVAILABILITY}
     };
     notifySubtreeUpdated(index, columns);
 
@@ -347,6 +415,11 @@ TorrentContentModelItem::ItemType TorrentContentModel::itemType(const QModelInde
     return static_cast<const TorrentContentModelItem *>(index.internalPointer())->itemType();
 }
 
+const Utils::Compare::NaturalSortKey &TorrentContentModel::nameSortKey(const QModelIndex &index) const
+{
+    return static_cast<const TorrentContentModelItem *>(index.internalPointer())->nameSortKey();
+}
+
 int TorrentContentModel::getFileIndex(const QModelIndex &index) const
 {
     auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
@@ -522,6 +595,7 @@ void TorrentContentModel::populate()
     const int filesCount = m_contentHandler->filesCount();
     m_filesIndex.reserve(filesCount);
 
+    QSet<TorrentContentModelFolder *> folders;
     QHash<TorrentContentModelFolder *, QHash<QString, TorrentContentModelFolder *>> folderMap;
     QVector<QString> lastParentPath;
     TorrentContentModelFolder *lastParent = m_rootItem;
@@ -552,6 +626,7 @@ void TorrentContentModel::populate()
                 {
                     newParent = new TorrentContentModelFolder(folderName, lastParent);
                     lastParent->appendChild(newParent);
+                    folders.insert(newParent);
                 }
 
                 lastParent = newParent;
@@ -564,8 +639,10 @@ void TorrentContentModel::populate()
         m_filesIndex.push_back(fileItem);
     }
 
-    updateFilesProgress();
-    updateFilesPriorities();
+    ChangedItems changedItems;
+    updateFilesProgress(changedItems);
+    updateFilesPriorities(changedItems);
+    recalculateFolders(folders);
     updateFilesAvailability();
 }
 
@@ -598,18 +675,19 @@ void TorrentContentModel::refresh()
 
     if (!m_filesIndex.isEmpty())
     {
-        updateFilesProgress();
-        updateFilesPriorities();
+        // only files that have changed and their ancestors are updated
+        ChangedItems changedItems;
+        updateFilesProgress(changedItems);
+        updateFilesPriorities(changedItems);
+        recalculateFolders(changedItems.folders);
         updateFilesAvailability();
 
         const QVector<ColumnInterval> columns =
         {
             {TorrentContentModelItem::COL_NAME, TorrentContentModelItem::COL_NAME},
-            {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_PROGRESS},
-            {TorrentContentModelItem::COL_PRIO, TorrentContentModelItem::COL_PRIO},
-            {TorrentContentModelItem::COL_AVAILABILITY, TorrentContentModelItem::COL_AVAILABILITY}
+            {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_AVAILABILITY}
         };
-        notifySubtreeUpdated(index(0, 0), columns);
+        notifyItemsUpdated(changedItems, columns);
     }
     else
     {
@@ -619,6 +697,36 @@ void TorrentContentModel::refresh()
     }
 }
 
+void TorrentContentModel::notifyItemsUpdated(const ChangedItems &changedItems, const QVector<ColumnInterval> &columns)
+{
+    // notify about each range of changed siblings at once
+    QHash<TorrentContentModelFolder *, std::pair<int, int>> rowRanges;
+    const auto addItem = [&rowRanges](const TorrentContentModelItem *item)
+    {
+        const int row = item->row();
+        const auto it = rowRanges.find(item->parent());
+        if (it == rowRanges.end())
+            rowRanges.insert(item->parent(), {row, row});
+        else
+            *it = {std::min(it->first, row), std::max(it->second, row)};
+    };
+
+    for (const TorrentContentModelItem *item : changedItems.items)
+        addItem(item);
+    for (const TorrentContentModelFolder *folder : changedItems.folders)
+        addItem(folder);
+
+    for (auto it = rowRanges.cbegin(); it != rowRanges.cend(); ++it)
+    {
+        TorrentContentModelFolder *parentItem = it.key();
+        const QModelIndex parentIndex = parentItem->isRootItem()
+            ? QModelIndex() : createIndex(parentItem->row(), 0, parentItem);
+        const auto [firstRow, lastRow] = it.value();
+        for (const ColumnInterval &column : columns)
+            emit dataChanged(index(firstRow, column.first(), parentIndex), index(lastRow, column.last(), parentIndex));
+    }
+}
+
 void TorrentContentModel::notifySubtreeUpdated(const QModelIndex &index, const QVector<ColumnInterval> &columns)
 {
     // For best performance, `columns` entries should be arranged from left to right
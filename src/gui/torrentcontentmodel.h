@@ -30,6 +30,7 @@
 #pragma once
 
 #include <QAbstractItemModel>
+#include <QSet>
 #include <QVector>
 
 #include "base/indexrange.h"
@@ -68,6 +69,7 @@ public:
 
     QVector<BitTorrent::DownloadPriority> getFilePriorities() const;
     TorrentContentModelItem::ItemType itemType(const QModelIndex &index) const;
+    const Utils::Compare::NaturalSortKey &nameSortKey(const QModelIndex &index) const;
     int getFileIndex(const QModelIndex &index) const;
     Path getItemPath(const QModelIndex &index) const;
 
@@ -86,11 +88,22 @@ signals:
 private:
     using ColumnInterval = IndexInterval<int>;
 
+    // Items changed by an update, their ancestor folders need to be recalculated
+    struct ChangedItems
+    {
+        QVector<TorrentContentModelItem *> items;
+        QSet<TorrentContentModelFolder *> folders;
+
+        void add(TorrentContentModelItem *item);
+    };
+
     void populate();
-    void updateFilesProgress();
-    void updateFilesPriorities();
+    void updateFilesProgress(ChangedItems &changedItems);
+    void updateFilesPriorities(ChangedItems &changedItems);
     void updateFilesAvailability();
+    void recalculateFolders(const QSet<TorrentContentModelFolder *> &folders);
     bool setItemPriority(const QModelIndex &index, BitTorrent::DownloadPriority priority);
+    void notifyItemsUpdated(const ChangedItems &changedItems, const QVector<ColumnInterval> &columns);
     void notifySubtreeUpdated(const QModelIndex &index, const QVector<ColumnInterval> &columns);
 
     BitTorrent::TorrentContentHandler *m_contentHandler = nullptr;
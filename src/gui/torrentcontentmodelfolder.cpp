@@ -71,6 +71,8 @@ const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children()
 void TorrentContentModelFolder::appendChild(TorrentContentModelItem *item)
 {
     Q_ASSERT(item);
+    // children are never reordered, so the row can be stored instead of looking it up
+    item->m_row = m_childItems.size();
     m_childItems.append(item);
     // Update own size
     if (item->itemType() == FileType)
@@ -140,8 +142,6 @@ void TorrentContentModelFolder::recalculateProgress()
         if (child->priority() == BitTorrent::DownloadPriority::Ignored)
             continue;
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder *>(child)->recalculateProgress();
         tProgress += child->progress() * child->size();
         tSize += child->size();
         tRemaining += child->remaining();
@@ -174,8 +174,6 @@ void TorrentContentModelFolder::recalculateAvailability()
         if (child->priority() == BitTorrent::DownloadPriority::Ignored)
             continue;
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder*>(child)->recalculateAvailability();
         const qreal childAvailability = child->availability();
         if (childAvailability >= 0)
         { // -1 means "no data"
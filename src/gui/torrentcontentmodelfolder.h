@@ -49,6 +49,7 @@ public:
     ItemType itemType() const override;
 
     void increaseSize(qulonglong delta);
+    // recalculate values from the direct children only, subfolders must be up to date
     void recalculateProgress();
     void recalculateAvailability();
     void updatePriority();
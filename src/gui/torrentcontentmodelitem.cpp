@@ -57,6 +57,19 @@ void TorrentContentModelItem::setName(const QString &name)
 {
     Q_ASSERT(!isRootItem());
     m_name = name;
+    m_nameSortKey.reset();
+}
+
+const Utils::Compare::NaturalSortKey &TorrentContentModelItem::nameSortKey() const
+{
+    Q_ASSERT(!isRootItem());
+
+    if (!m_nameSortKey)
+    {
+        static const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> naturalCompare;
+        m_nameSortKey = naturalCompare.sortKey(m_name);
+    }
+    return *m_nameSortKey;
 }
 
 qulonglong TorrentContentModelItem::size() const
@@ -172,9 +185,7 @@ QVariant TorrentContentModelItem::underlyingData(const int column) const
 
 int TorrentContentModelItem::row() const
 {
-    if (m_parentItem)
-        return m_parentItem->children().indexOf(const_cast<TorrentContentModelItem *>(this));
-    return 0;
+    return m_row;
 }
 
 TorrentContentModelFolder *TorrentContentModelItem::parent() const
@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include <optional>
+
 #include <QCoreApplication>
 #include <QVector>
 
 #include "base/bittorrent/downloadpriority.h"
+#include "base/utils/compare.h"
 
 class QVariant;
 
@@ -41,6 +44,8 @@ class TorrentContentModelItem
 {
     Q_DECLARE_TR_FUNCTIONS(TorrentContentModelItem)
 
+    friend class TorrentContentModelFolder;
+
 public:
     enum TreeItemColumns
     {
@@ -68,6 +73,8 @@ public:
 
     QString name() const;
     void setName(const QString &name);
+    // Case insensitive natural sort key of the name, it is made on first use
+    const Utils::Compare::NaturalSortKey &nameSortKey() const;
 
     qulonglong size() const;
     qreal progress() const;
@@ -85,10 +92,12 @@ public:
 
 protected:
     TorrentContentModelFolder *m_parentItem = nullptr;
+    int m_row = 0;
     // Root item members
     QVector<QString> m_itemData;
     // Non-root item members
     QString m_name;
+    mutable std::optional<Utils::Compare::NaturalSortKey> m_nameSortKey;
     qulonglong m_size = 0;
     qulonglong m_remaining = 0;
     BitTorrent::DownloadPriority m_priority = BitTorrent::DownloadPriority::Normal;
@@ -68,6 +68,7 @@ TorrentCreatorDialog::TorrentCreatorDialog(QWidget *parent, const Path &defaultP
     , m_storePrivateTorrent(SETTINGS_KEY(u"PrivateTorrent"_s))
     , m_storeStartSeeding(SETTINGS_KEY(u"StartSeeding"_s))
     , m_storeIgnoreRatio(SETTINGS_KEY(u"IgnoreRatio"_s))
+    , m_storeReusePieceHashes(SETTINGS_KEY(u"ReusePieceHashes"_s))
 #ifdef QBT_USES_LIBTORRENT2
     , m_storeTorrentFormat(SETTINGS_KEY(u"TorrentFormat"_s))
 #else
@@ -238,7 +239,8 @@ void TorrentCreatorDialog::onCreateButtonClicked()
         .comment = m_ui->txtComment->toPlainText(),
         .source = m_ui->lineEditSource->text(),
         .trackers = trackers,
-        .urlSeeds = m_ui->URLSeedsList->toPlainText().split(u'\n', Qt::SkipEmptyParts)
+        .urlSeeds = m_ui->URLSeedsList->toPlainText().split(u'\n', Qt::SkipEmptyParts),
+        .reuseExistingPieceHashes = m_ui->checkReusePieceHashes->isChecked()
     };
 
     auto *torrentCreator = new BitTorrent::TorrentCreator(params);
@@ -324,6 +326,7 @@ void TorrentCreatorDialog::setInteractionEnabled(const bool enabled) const
     m_ui->buttonCalcTotalPieces->setEnabled(enabled);
     m_ui->checkPrivate->setEnabled(enabled);
     m_ui->checkStartSeeding->setEnabled(enabled);
+    m_ui->checkReusePieceHashes->setEnabled(enabled);
     m_ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(enabled);
     m_ui->checkIgnoreShareLimits->setEnabled(enabled && m_ui->checkStartSeeding->isChecked());
 #ifdef QBT_USES_LIBTORRENT2
@@ -342,6 +345,7 @@ void TorrentCreatorDialog::saveSettings()
     m_storePrivateTorrent = m_ui->checkPrivate->isChecked();
     m_storeStartSeeding = m_ui->checkStartSeeding->isChecked();
     m_storeIgnoreRatio = m_ui->checkIgnoreShareLimits->isChecked();
+    m_storeReusePieceHashes = m_ui->checkReusePieceHashes->isChecked();
 #ifdef QBT_USES_LIBTORRENT2
     m_storeTorrentFormat = m_ui->comboTorrentFormat->currentIndex();
 #else
@@ -366,6 +370,7 @@ void TorrentCreatorDialog::loadSettings()
     m_ui->checkStartSeeding->setChecked(m_storeStartSeeding);
     m_ui->checkIgnoreShareLimits->setChecked(m_storeIgnoreRatio);
     m_ui->checkIgnoreShareLimits->setEnabled(m_ui->checkStartSeeding->isChecked());
+    m_ui->checkReusePieceHashes->setChecked(m_storeReusePieceHashes);
 #ifdef QBT_USES_LIBTORRENT2
     m_ui->comboTorrentFormat->setCurrentIndex(m_storeTorrentFormat.get(1));
 #else
@@ -29,6 +29,7 @@
 
 #include "trackerlistmodel.h"
 
+#include <bitset>
 #include <chrono>
 
 #include <boost/multi_index_container.hpp>
@@ -58,6 +59,18 @@ using namespace boost::multi_index;
 namespace
 {
     const std::chrono::milliseconds ANNOUNCE_TIME_REFRESH_INTERVAL = 4s;
+    // counting DHT/PeX/LSD peers requires fetching all the peers of the torrent
+    const std::chrono::milliseconds STICKY_ROWS_REFRESH_INTERVAL = 10s;
+
+    template <typename T>
+    bool assignChanged(T &target, const T &value)
+    {
+        if (target == value)
+            return false;
+
+        target = value;
+        return true;
+    }
 
     const char STR_WORKING[] = QT_TRANSLATE_NOOP("TrackerListModel", "Working");
     const char STR_DISABLED[] = QT_TRANSLATE_NOOP("TrackerListModel", "Disabled");
@@ -143,6 +156,7 @@ struct TrackerListModel::Item final
 
     QDateTime nextAnnounceTime {};
     QDateTime minAnnounceTime {};
+    QDateTime scheduledAnnounceTime {};
 
     qint64 secsToNextAnnounce = 0;
     qint64 secsToMinAnnounce = 0;
@@ -163,8 +177,10 @@ struct TrackerListModel::Item final
     explicit Item(const BitTorrent::TrackerEntryStatus &trackerEntryStatus);
     Item(const std::shared_ptr<Item> &parentItem, const BitTorrent::TrackerEndpointStatus &endpointStatus);
 
-    void fillFrom(const BitTorrent::TrackerEntryStatus &trackerEntryStatus);
-    void fillFrom(const BitTorrent::TrackerEndpointStatus &endpointStatus);
+    // both return the columns whose data was changed
+    ChangedColumns fillFrom(const BitTorrent::TrackerEntryStatus &trackerEntryStatus);
+    ChangedColumns fillFrom(const BitTorrent::TrackerEndpointStatus &endpointStatus);
+    void fillAnnounceTimes(const QDateTime &next, const QDateTime &min, const QDateTime &scheduled, ChangedColumns &changedColumns);
 };
 
 class TrackerListModel::Items final : public multi_index_container<
@@ -195,42 +211,60 @@ TrackerListModel::Item::Item(const std::shared_ptr<Item> &parentItem, const BitT
     fillFrom(endpointStatus);
 }
 
-void TrackerListModel::Item::fillFrom(const BitTorrent::TrackerEntryStatus &trackerEntryStatus)
+TrackerListModel::ChangedColumns TrackerListModel::Item::fillFrom(const BitTorrent::TrackerEntryStatus &trackerEntryStatus)
 {
     Q_ASSERT(parentItem.expired());
     Q_ASSERT(trackerEntryStatus.url == name);
 
-    tier = trackerEntryStatus.tier;
-    status = trackerEntryStatus.state;
-    message = trackerEntryStatus.message;
-    numPeers = trackerEntryStatus.numPeers;
-    numSeeds = trackerEntryStatus.numSeeds;
-    numLeeches = trackerEntryStatus.numLeeches;
-    numDownloaded = trackerEntryStatus.numDownloaded;
-    nextAnnounceTime = trackerEntryStatus.nextAnnounceTime;
-    minAnnounceTime = trackerEntryStatus.minAnnounceTime;
-    secsToNextAnnounce = 0;
-    secsToMinAnnounce = 0;
-    announceTimestamp = QDateTime();
+    ChangedColumns changedColumns;
+    changedColumns[COL_TIER] = assignChanged(tier, trackerEntryStatus.tier);
+    changedColumns[COL_STATUS] = assignChanged(status, trackerEntryStatus.state);
+    changedColumns[COL_MSG] = assignChanged(message, trackerEntryStatus.message);
+    changedColumns[COL_PEERS] = assignChanged(numPeers, trackerEntryStatus.numPeers);
+    changedColumns[COL_SEEDS] = assignChanged(numSeeds, trackerEntryStatus.numSeeds);
+    changedColumns[COL_LEECHES] = assignChanged(numLeeches, trackerEntryStatus.numLeeches);
+    changedColumns[COL_TIMES_DOWNLOADED] = assignChanged(numDownloaded, trackerEntryStatus.numDownloaded);
+    fillAnnounceTimes(trackerEntryStatus.nextAnnounceTime, trackerEntryStatus.minAnnounceTime
+            , trackerEntryStatus.scheduledAnnounceTime, changedColumns);
+    return changedColumns;
 }
 
-void TrackerListModel::Item::fillFrom(const BitTorrent::TrackerEndpointStatus &endpointStatus)
+TrackerListModel::ChangedColumns TrackerListModel::Item::fillFrom(const BitTorrent::TrackerEndpointStatus &endpointStatus)
 {
     Q_ASSERT(!parentItem.expired());
     Q_ASSERT(endpointStatus.name == name);
     Q_ASSERT(endpointStatus.btVersion == btVersion);
 
-    status = endpointStatus.state;
-    message = endpointStatus.message;
-    numPeers = endpointStatus.numPeers;
-    numSeeds = endpointStatus.numSeeds;
-    numLeeches = endpointStatus.numLeeches;
-    numDownloaded = endpointStatus.numDownloaded;
-    nextAnnounceTime = endpointStatus.nextAnnounceTime;
-    minAnnounceTime = endpointStatus.minAnnounceTime;
+    ChangedColumns changedColumns;
+    changedColumns[COL_STATUS] = assignChanged(status, endpointStatus.state);
+    changedColumns[COL_MSG] = assignChanged(message, endpointStatus.message);
+    changedColumns[COL_PEERS] = assignChanged(numPeers, endpointStatus.numPeers);
+    changedColumns[COL_SEEDS] = assignChanged(numSeeds, endpointStatus.numSeeds);
+    changedColumns[COL_LEECHES] = assignChanged(numLeeches, endpointStatus.numLeeches);
+    changedColumns[COL_TIMES_DOWNLOADED] = assignChanged(numDownloaded, endpointStatus.numDownloaded);
+    fillAnnounceTimes(endpointStatus.nextAnnounceTime, endpointStatus.minAnnounceTime, {}, changedColumns);
+    return changedColumns;
+}
+
+void TrackerListModel::Item::fillAnnounceTimes(const QDateTime &next, const QDateTime &min, const QDateTime &scheduled
+        , ChangedColumns &changedColumns)
+{
+    const bool isNextChanged = assignChanged(nextAnnounceTime, next);
+    const bool isMinChanged = assignChanged(minAnnounceTime, min);
+    const bool isScheduledChanged = assignChanged(scheduledAnnounceTime, scheduled);
+    if (!isNextChanged && !isMinChanged && !isScheduledChanged)
+        return;
+
+    // remaining times are calculated again on the next access
     secsToNextAnnounce = 0;
     secsToMinAnnounce = 0;
     announceTimestamp = QDateTime();
+
+    changedColumns[COL_NEXT_ANNOUNCE] = true;
+    changedColumns[COL_MIN_ANNOUNCE] = true;
+    // status depends on whether the announce is scheduled
+    if (isScheduledChanged)
+        changedColumns[COL_STATUS] = true;
 }
 
 TrackerListModel::TrackerListModel(BitTorrent::Session *btSession, QObject *parent)
@@ -238,12 +272,16 @@ TrackerListModel::TrackerListModel(BitTorrent::Session *btSession, QObject *pare
     , m_btSession {btSession}
     , m_items {std::make_unique<Items>()}
     , m_announceRefreshTimer {new QTimer(this)}
+    , m_stickyRowsRefreshTimer {new QTimer(this)}
 {
     Q_ASSERT(m_btSession);
 
     m_announceRefreshTimer->setSingleShot(true);
     connect(m_announceRefreshTimer, &QTimer::timeout, this, &TrackerListModel::refreshAnnounceTimes);
 
+    m_stickyRowsRefreshTimer->setSingleShot(true);
+    connect(m_stickyRowsRefreshTimer, &QTimer::timeout, this, &TrackerListModel::refreshStickyRows);
+
     connect(m_btSession, &BitTorrent::Session::trackersAdded, this
             , [this](BitTorrent::Torrent *torrent, const QList<BitTorrent::TrackerEntry> &newTrackers)
     {
@@ -283,9 +321,14 @@ void TrackerListModel::setTorrent(BitTorrent::Torrent *torrent)
     m_torrent = torrent;
 
     if (m_torrent)
+    {
         populate();
+    }
     else
+    {
         m_announceRefreshTimer->stop();
+        m_stickyRowsRefreshTimer->stop();
+    }
 }
 
 BitTorrent::Torrent *TrackerListModel::torrent() const
@@ -305,6 +348,20 @@ void TrackerListModel::populate()
     m_items->emplace_back(std::make_shared<Item>(u"** [PeX] **", privateTorrentMessage));
     m_items->emplace_back(std::make_shared<Item>(u"** [LSD] **", privateTorrentMessage));
 
+    for (const BitTorrent::TrackerEntryStatus &status : trackers)
+        addTrackerItem(status);
+
+    m_announceTimestamp = QDateTime::currentDateTime();
+    m_announceRefreshTimer->start(ANNOUNCE_TIME_REFRESH_INTERVAL);
+
+    refreshStickyRows();
+}
+
+void TrackerListModel::refreshStickyRows()
+{
+    if (!m_torrent)
+        return;
+
     using TorrentPtr = QPointer<const BitTorrent::Torrent>;
     m_torrent->fetchPeerInfo([this, torrent = TorrentPtr(m_torrent)](const QList<BitTorrent::PeerInfo> &peers)
     {
@@ -343,34 +400,39 @@ void TrackerListModel::populate()
             }
         }
 
-        auto &itemsByPos = m_items->get<0>();
-        itemsByPos.modify((itemsByPos.begin() + ROW_DHT), [&seedsDHT, &peersDHT](std::shared_ptr<Item> &item)
+        const auto updateStickyRow = [this](const int row, const int numSeeds, const int numLeeches)
         {
-            item->numSeeds = seedsDHT;
-            item->numLeeches = peersDHT;
-            return true;
-        });
-        itemsByPos.modify((itemsByPos.begin() + ROW_PEX), [&seedsPeX, &peersPeX](std::shared_ptr<Item> &item)
-        {
-            item->numSeeds = seedsPeX;
-            item->numLeeches = peersPeX;
-            return true;
-        });
-        itemsByPos.modify((itemsByPos.begin() + ROW_LSD), [&seedsLSD, &peersLSD](std::shared_ptr<Item> &item)
-        {
-            item->numSeeds = seedsLSD;
-            item->numLeeches = peersLSD;
-            return true;
-        });
-
-        emit dataChanged(index(ROW_DHT, COL_SEEDS), index(ROW_LSD, COL_LEECHES));
+            const std::shared_ptr<Item> &item = m_items->at(row);
+            ChangedColumns changedColumns;
+            changedColumns[COL_SEEDS] = assignChanged(item->numSeeds, numSeeds);
+            changedColumns[COL_LEECHES] = assignChanged(item->numLeeches, numLeeches);
+            notifyChangedColumns(row, {}, changedColumns);
+        };
+        updateStickyRow(ROW_DHT, seedsDHT, peersDHT);
+        updateStickyRow(ROW_PEX, seedsPeX, peersPeX);
+        updateStickyRow(ROW_LSD, seedsLSD, peersLSD);
+
+        m_stickyRowsRefreshTimer->start(STICKY_ROWS_REFRESH_INTERVAL);
     });
+}
 
-    for (const BitTorrent::TrackerEntryStatus &status : trackers)
-        addTrackerItem(status);
+void TrackerListModel::notifyChangedColumns(const int row, const QModelIndex &parent, const ChangedColumns &changedColumns)
+{
+    // notify each run of adjacent changed columns, so unchanged cells aren't repainted
+    int column = 0;
+    while (column < COL_COUNT)
+    {
+        if (!changedColumns[column])
+        {
+            ++column;
+            continue;
+        }
 
-    m_announceTimestamp = QDateTime::currentDateTime();
-    m_announceRefreshTimer->start(ANNOUNCE_TIME_REFRESH_INTERVAL);
+        const int firstColumn = column;
+        while ((column < COL_COUNT) && changedColumns[column])
+            ++column;
+        emit dataChanged(index(row, firstColumn, parent), index(row, (column - 1), parent));
+    }
 }
 
 std::shared_ptr<TrackerListModel::Item> TrackerListModel::createTrackerItem(const BitTorrent::TrackerEntryStatus &trackerEntryStatus)
@@ -390,32 +452,15 @@ void TrackerListModel::addTrackerItem(const BitTorrent::TrackerEntryStatus &trac
 
 void TrackerListModel::updateTrackerItem(const std::shared_ptr<Item> &item, const BitTorrent::TrackerEntryStatus &trackerEntryStatus)
 {
-    QSet<std::pair<QString, int>> endpointItemIDs;
-    QList<std::shared_ptr<Item>> newEndpointItems;
-    for (const auto &[id, endpointStatus] : trackerEntryStatus.endpoints.asKeyValueRange())
-    {
-        endpointItemIDs.insert(id);
-
-        auto &itemsByID = item->childItems.get<ByID>();
-        if (const auto &iter = itemsByID.find(std::make_tuple(id.first, id.second)); iter != itemsByID.end())
-        {
-            (*iter)->fillFrom(endpointStatus);
-        }
-        else
-        {
-            newEndpointItems.emplace_back(std::make_shared<Item>(item, endpointStatus));
-        }
-    }
-
     const auto &itemsByPos = m_items->get<0>();
-    const auto trackerRow = std::distance(itemsByPos.begin(), itemsByPos.iterator_to(item));
+    const auto trackerRow = static_cast<int>(std::distance(itemsByPos.begin(), itemsByPos.iterator_to(item)));
     const auto trackerIndex = index(trackerRow, 0);
 
+    // obsolete endpoints are removed first, so the rows of the remaining ones are final
     auto it = item->childItems.begin();
     while (it != item->childItems.end())
     {
-        if (const auto endpointItemID = std::make_pair((*it)->name, (*it)->btVersion)
-                ; endpointItemIDs.contains(endpointItemID))
+        if (trackerEntryStatus.endpoints.contains(std::make_pair((*it)->name, (*it)->btVersion)))
         {
             ++it;
         }
@@ -428,19 +473,36 @@ void TrackerListModel::updateTrackerItem(const std::shared_ptr<Item> &item, cons
         }
     }
 
-    const int numRows = rowCount(trackerIndex);
-    emit dataChanged(index(0, 0, trackerIndex), index((numRows - 1), (columnCount(trackerIndex) - 1), trackerIndex));
+    QList<std::shared_ptr<Item>> newEndpointItems;
+    const auto &endpointItemsByID = item->childItems.get<ByID>();
+    for (const auto &[id, endpointStatus] : trackerEntryStatus.endpoints.asKeyValueRange())
+    {
+        if (const auto &iter = endpointItemsByID.find(std::make_tuple(id.first, id.second)); iter != endpointItemsByID.end())
+        {
+            const ChangedColumns changedColumns = (*iter)->fillFrom(endpointStatus);
+            if (changedColumns.none())
+                continue;
+
+            const auto &endpointItemsByPos = item->childItems.get<0>();
+            const auto row = std::distance(endpointItemsByPos.begin(), item->childItems.project<0>(iter));
+            notifyChangedColumns(static_cast<int>(row), trackerIndex, changedColumns);
+        }
+        else
+        {
+            newEndpointItems.emplace_back(std::make_shared<Item>(item, endpointStatus));
+        }
+    }
 
     if (!newEndpointItems.isEmpty())
     {
+        const int numRows = rowCount(trackerIndex);
         beginInsertRows(trackerIndex, numRows, (numRows + newEndpointItems.size() - 1));
         for (const auto &newEndpointItem : asConst(newEndpointItems))
             item->childItems.get<0>().push_back(newEndpointItem);
         endInsertRows();
     }
 
-    item->fillFrom(trackerEntryStatus);
-    emit dataChanged(trackerIndex, index(trackerRow, (columnCount() - 1)));
+    notifyChangedColumns(trackerRow, {}, item->fillFrom(trackerEntryStatus));
 }
 
 void TrackerListModel::refreshAnnounceTimes()
@@ -449,7 +511,8 @@ void TrackerListModel::refreshAnnounceTimes()
         return;
 
     m_announceTimestamp = QDateTime::currentDateTime();
-    emit dataChanged(index(0, COL_NEXT_ANNOUNCE), index((rowCount() - 1), COL_MIN_ANNOUNCE));
+    // status of trackers depends on their scheduled announces
+    emit dataChanged(index(0, COL_STATUS), index((rowCount() - 1), COL_MIN_ANNOUNCE));
     for (int i = 0; i < rowCount(); ++i)
     {
         const QModelIndex parentIndex = index(i, 0);
@@ -543,9 +606,14 @@ QVariant TrackerListModel::data(const QModelIndex &index, const int role) const
     if (!itemPtr) [[unlikely]]
         return {};
 
+    const bool isAnnounceScheduled = itemPtr->scheduledAnnounceTime.isValid()
+            && (itemPtr->scheduledAnnounceTime > m_announceTimestamp)
+            && (itemPtr->status != BitTorrent::TrackerEndpointState::Updating);
+
     if (itemPtr->announceTimestamp != m_announceTimestamp)
     {
-        itemPtr->secsToNextAnnounce = std::max<qint64>(0, m_announceTimestamp.secsTo(itemPtr->nextAnnounceTime));
+        const QDateTime nextAnnounceTime = isAnnounceScheduled ? itemPtr->scheduledAnnounceTime : itemPtr->nextAnnounceTime;
+        itemPtr->secsToNextAnnounce = std::max<qint64>(0, m_announceTimestamp.secsTo(nextAnnounceTime));
         itemPtr->secsToMinAnnounce = std::max<qint64>(0, m_announceTimestamp.secsTo(itemPtr->minAnnounceTime));
         itemPtr->announceTimestamp = m_announceTimestamp;
     }
@@ -595,6 +663,8 @@ QVariant TrackerListModel::data(const QModelIndex &index, const int role) const
                 return statusPeX(m_torrent);
             if (index.row() == ROW_LSD)
                 return statusLSD(m_torrent);
+            if (isAnnounceScheduled)
+                return tr("Announce scheduled");
             return toString(itemPtr->status);
         case COL_PEERS:
             return prettyCount(itemPtr->numPeers);
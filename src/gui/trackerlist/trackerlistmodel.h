@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <bitset>
 #include <memory>
 
 #include <QtContainerFwd>
@@ -98,8 +99,11 @@ public:
 
 private:
     struct Item;
+    using ChangedColumns = std::bitset<COL_COUNT>;
 
     void populate();
+    void refreshStickyRows();
+    void notifyChangedColumns(int row, const QModelIndex &parent, const ChangedColumns &changedColumns);
     std::shared_ptr<Item> createTrackerItem(const BitTorrent::TrackerEntryStatus &trackerEntryStatus);
     void addTrackerItem(const BitTorrent::TrackerEntryStatus &trackerEntryStatus);
     void updateTrackerItem(const std::shared_ptr<Item> &item, const BitTorrent::TrackerEntryStatus &trackerEntryStatus);
@@ -117,4 +121,5 @@ private:
 
     QDateTime m_announceTimestamp;
     QTimer *m_announceRefreshTimer = nullptr;
+    QTimer *m_stickyRowsRefreshTimer = nullptr;
 };
@@ -99,7 +99,7 @@ void TrackersAdditionDialog::onDownloadButtonClicked()
     m_ui->downloadButton->setEnabled(false);
     setCursor(Qt::WaitCursor);
 
-    Net::DownloadManager::instance()->download(url, Preferences::instance()->useProxyForGeneralPurposes()
+    Net::DownloadManager::instance()->download(Net::DownloadRequest(url).priority(Net::DownloadPriority::High), Preferences::instance()->useProxyForGeneralPurposes()
             , this, &TrackersAdditionDialog::onTorrentListDownloadFinished);
 }
 
@@ -30,6 +30,7 @@
 
 #include <QHash>
 #include <QIcon>
+#include <QSet>
 
 #include "base/bittorrent/session.h"
 #include "base/global.h"
@@ -191,6 +192,7 @@ CategoryFilterModel::CategoryFilterModel(QObject *parent)
     connect(session, &Session::categoryAdded, this, &CategoryFilterModel::categoryAdded);
     connect(session, &Session::categoryRemoved, this, &CategoryFilterModel::categoryRemoved);
     connect(session, &Session::torrentCategoryChanged, this, &CategoryFilterModel::torrentCategoryChanged);
+    connect(session, &Session::torrentsCategoryChanged, this, &CategoryFilterModel::torrentsCategoryChanged);
     connect(session, &Session::subcategoriesSupportChanged, this, &CategoryFilterModel::subcategoriesSupportChanged);
     connect(session, &Session::torrentsLoaded, this, &CategoryFilterModel::torrentsLoaded);
     connect(session, &Session::torrentAboutToBeRemoved, this, &CategoryFilterModel::torrentAboutToBeRemoved);
@@ -413,6 +415,36 @@ void CategoryFilterModel::torrentCategoryChanged(BitTorrent::Torrent *const torr
     }
 }
 
+void CategoryFilterModel::torrentsCategoryChanged(const QHash<BitTorrent::Torrent *, QString> &oldCategories)
+{
+    // counters are updated for all the torrents first, so each affected item is notified only once
+    QSet<CategoryModelItem *> changedItems;
+    for (auto it = oldCategories.cbegin(); it != oldCategories.cend(); ++it)
+    {
+        auto *oldItem = findItem(it.value());
+        Q_ASSERT(oldItem);
+        oldItem->decreaseTorrentsCount();
+        changedItems.insert(oldItem);
+
+        auto *newItem = findItem(it.key()->category());
+        Q_ASSERT(newItem);
+        newItem->increaseTorrentsCount();
+        changedItems.insert(newItem);
+    }
+
+    QSet<QModelIndex> notifiedIndexes;
+    for (CategoryModelItem *item : asConst(changedItems))
+    {
+        QModelIndex i = index(item);
+        while (i.isValid() && !notifiedIndexes.contains(i))
+        {
+            notifiedIndexes.insert(i);
+            emit dataChanged(i, i);
+            i = parent(i);
+        }
+    }
+}
+
 void CategoryFilterModel::subcategoriesSupportChanged()
 {
     beginResetModel();
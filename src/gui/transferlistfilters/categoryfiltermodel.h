@@ -65,6 +65,7 @@ private slots:
     void torrentsLoaded(const QVector<BitTorrent::Torrent *> &torrents);
     void torrentAboutToBeRemoved(BitTorrent::Torrent *torrent);
     void torrentCategoryChanged(BitTorrent::Torrent *torrent, const QString &oldCategory);
+    void torrentsCategoryChanged(const QHash<BitTorrent::Torrent *, QString> &oldCategories);
     void subcategoriesSupportChanged();
 
 private:
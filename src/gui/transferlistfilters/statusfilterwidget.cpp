@@ -39,6 +39,25 @@
 #include "gui/transferlistwidget.h"
 #include "gui/uithememanager.h"
 
+namespace
+{
+    const BitTorrent::TorrentStatusFields STATUS_FIELDS = BitTorrent::TorrentStatusField::State
+        | BitTorrent::TorrentStatusField::Transfer;
+
+    const QVector<TorrentFilter> &statusFilters()
+    {
+        static const QVector<TorrentFilter> filters = []
+        {
+            QVector<TorrentFilter> result;
+            result.reserve(TorrentFilter::_Count);
+            for (int type = TorrentFilter::All; type < TorrentFilter::_Count; ++type)
+                result.append(TorrentFilter(static_cast<TorrentFilter::Type>(type)));
+            return result;
+        }();
+        return filters;
+    }
+}
+
 StatusFilterWidget::StatusFilterWidget(QWidget *parent, TransferListWidget *transferList)
     : BaseFilterWidget(parent, transferList)
 {
@@ -89,7 +108,7 @@ StatusFilterWidget::StatusFilterWidget(QWidget *parent, TransferListWidget *tran
     const QVector<BitTorrent::Torrent *> torrents = BitTorrent::Session::instance()->torrents();
     update(torrents);
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentsUpdated
-            , this, &StatusFilterWidget::update);
+            , this, &StatusFilterWidget::handleTorrentsUpdated);
 
     const Preferences *const pref = Preferences::instance();
     connect(pref, &Preferences::changed, this, &StatusFilterWidget::configure);
@@ -124,76 +143,95 @@ QSize StatusFilterWidget::sizeHint() const
         static_cast<int>((sizeHintForRow(0) + 2 * spacing()) * (numVisibleItems + 0.5))};
 }
 
-void StatusFilterWidget::updateTorrentStatus(const BitTorrent::Torrent *torrent)
+StatusFilterWidget::TorrentFilterBitset StatusFilterWidget::updateTorrentStatus(const BitTorrent::Torrent *torrent)
 {
+    TorrentFilterBitset statuses;
+    for (int type = TorrentFilter::Downloading; type < TorrentFilter::_Count; ++type)
+        statuses[type] = statusFilters()[type].match(torrent);
+
     TorrentFilterBitset &torrentStatus = m_torrentsStatus[torrent];
+    const TorrentFilterBitset changedStatuses = torrentStatus ^ statuses;
+    torrentStatus = statuses;
+    return adjustCounters(changedStatuses, statuses);
+}
 
-    const auto update = [torrent, &torrentStatus](const TorrentFilter::Type status, int &counter)
+StatusFilterWidget::TorrentFilterBitset StatusFilterWidget::adjustCounters(const TorrentFilterBitset changedStatuses, const TorrentFilterBitset &statuses)
+{
+    for (int type = TorrentFilter::Downloading; type < TorrentFilter::_Count; ++type)
     {
-        const bool hasStatus = torrentStatus[status];
-        const bool needStatus = TorrentFilter(status).match(torrent);
-        if (needStatus && !hasStatus)
-        {
-            ++counter;
-            torrentStatus.set(status);
-        }
-        else if (!needStatus && hasStatus)
-        {
-            --counter;
-            torrentStatus.reset(status);
-        }
-    };
+        if (changedStatuses[type])
+            m_counters[type] += (statuses[type] ? 1 : -1);
+    }
 
-    update(TorrentFilter::Downloading, m_nbDownloading);
-    update(TorrentFilter::Seeding, m_nbSeeding);
-    update(TorrentFilter::Completed, m_nbCompleted);
-    update(TorrentFilter::Running, m_nbRunning);
-    update(TorrentFilter::Stopped, m_nbStopped);
-    update(TorrentFilter::Active, m_nbActive);
-    update(TorrentFilter::Inactive, m_nbInactive);
-    update(TorrentFilter::StalledUploading, m_nbStalledUploading);
-    update(TorrentFilter::StalledDownloading, m_nbStalledDownloading);
-    update(TorrentFilter::Checking, m_nbChecking);
-    update(TorrentFilter::Moving, m_nbMoving);
-    update(TorrentFilter::Errored, m_nbErrored);
-
-    m_nbStalled = m_nbStalledUploading + m_nbStalledDownloading;
+    return changedStatuses;
 }
 
-void StatusFilterWidget::updateTexts()
+void StatusFilterWidget::updateCounters(const TorrentFilterBitset &changedCounters)
 {
-    const qsizetype torrentsCount = BitTorrent::Session::instance()->torrentsCount();
-    item(TorrentFilter::All)->setData(Qt::DisplayRole, tr("All (%1)").arg(torrentsCount));
-    item(TorrentFilter::Downloading)->setData(Qt::DisplayRole, tr("Downloading (%1)").arg(m_nbDownloading));
-    item(TorrentFilter::Seeding)->setData(Qt::DisplayRole, tr("Seeding (%1)").arg(m_nbSeeding));
-    item(TorrentFilter::Completed)->setData(Qt::DisplayRole, tr("Completed (%1)").arg(m_nbCompleted));
-    item(TorrentFilter::Running)->setData(Qt::DisplayRole, tr("Running (%1)").arg(m_nbRunning));
-    item(TorrentFilter::Stopped)->setData(Qt::DisplayRole, tr("Stopped (%1)").arg(m_nbStopped));
-    item(TorrentFilter::Active)->setData(Qt::DisplayRole, tr("Active (%1)").arg(m_nbActive));
-    item(TorrentFilter::Inactive)->setData(Qt::DisplayRole, tr("Inactive (%1)").arg(m_nbInactive));
-    item(TorrentFilter::Stalled)->setData(Qt::DisplayRole, tr("Stalled (%1)").arg(m_nbStalled));
-    item(TorrentFilter::StalledUploading)->setData(Qt::DisplayRole, tr("Stalled Uploading (%1)").arg(m_nbStalledUploading));
-    item(TorrentFilter::StalledDownloading)->setData(Qt::DisplayRole, tr("Stalled Downloading (%1)").arg(m_nbStalledDownloading));
-    item(TorrentFilter::Checking)->setData(Qt::DisplayRole, tr("Checking (%1)").arg(m_nbChecking));
-    item(TorrentFilter::Moving)->setData(Qt::DisplayRole, tr("Moving (%1)").arg(m_nbMoving));
-    item(TorrentFilter::Errored)->setData(Qt::DisplayRole, tr("Errored (%1)").arg(m_nbErrored));
+    if (changedCounters.none())
+        return;
+
+    updateTexts(changedCounters);
+
+    if (Preferences::instance()->getHideZeroStatusFilters())
+    {
+        hideZeroItems();
+        updateGeometry();
+    }
+}
+
+void StatusFilterWidget::updateTexts(const TorrentFilterBitset &filters)
+{
+    const auto itemText = [this](const int type) -> QString
+    {
+        const int counter = m_counters[type];
+        switch (type)
+        {
+        case TorrentFilter::All:
+            return tr("All (%1)").arg(BitTorrent::Session::instance()->torrentsCount());
+        case TorrentFilter::Downloading:
+            return tr("Downloading (%1)").arg(counter);
+        case TorrentFilter::Seeding:
+            return tr("Seeding (%1)").arg(counter);
+        case TorrentFilter::Completed:
+            return tr("Completed (%1)").arg(counter);
+        case TorrentFilter::Running:
+            return tr("Running (%1)").arg(counter);
+        case TorrentFilter::Stopped:
+            return tr("Stopped (%1)").arg(counter);
+        case TorrentFilter::Active:
+            return tr("Active (%1)").arg(counter);
+        case TorrentFilter::Inactive:
+            return tr("Inactive (%1)").arg(counter);
+        case TorrentFilter::Stalled:
+            return tr("Stalled (%1)").arg(counter);
+        case TorrentFilter::StalledUploading:
+            return tr("Stalled Uploading (%1)").arg(counter);
+        case TorrentFilter::StalledDownloading:
+            return tr("Stalled Downloading (%1)").arg(counter);
+        case TorrentFilter::Checking:
+            return tr("Checking (%1)").arg(counter);
+        case TorrentFilter::Moving:
+            return tr("Moving (%1)").arg(counter);
+        case TorrentFilter::Errored:
+            return tr("Errored (%1)").arg(counter);
+        default:
+            Q_ASSERT(false);
+            return {};
+        }
+    };
+
+    for (int type = TorrentFilter::All; type < TorrentFilter::_Count; ++type)
+    {
+        if (filters[type])
+            item(type)->setData(Qt::DisplayRole, itemText(type));
+    }
 }
 
 void StatusFilterWidget::hideZeroItems()
 {
-    item(TorrentFilter::Downloading)->setHidden(m_nbDownloading == 0);
-    item(TorrentFilter::Seeding)->setHidden(m_nbSeeding == 0);
-    item(TorrentFilter::Completed)->setHidden(m_nbCompleted == 0);
-    item(TorrentFilter::Running)->setHidden(m_nbRunning == 0);
-    item(TorrentFilter::Stopped)->setHidden(m_nbStopped == 0);
-    item(TorrentFilter::Active)->setHidden(m_nbActive == 0);
-    item(TorrentFilter::Inactive)->setHidden(m_nbInactive == 0);
-    item(TorrentFilter::Stalled)->setHidden(m_nbStalled == 0);
-    item(TorrentFilter::StalledUploading)->setHidden(m_nbStalledUploading == 0);
-    item(TorrentFilter::StalledDownloading)->setHidden(m_nbStalledDownloading == 0);
-    item(TorrentFilter::Checking)->setHidden(m_nbChecking == 0);
-    item(TorrentFilter::Moving)->setHidden(m_nbMoving == 0);
-    item(TorrentFilter::Errored)->setHidden(m_nbErrored == 0);
+    for (int type = TorrentFilter::Downloading; type < TorrentFilter::_Count; ++type)
+        item(type)->setHidden(m_counters[type] == 0);
 
     if (currentItem() && currentItem()->isHidden())
         setCurrentRow(TorrentFilter::All, QItemSelectionModel::SelectCurrent);
@@ -201,16 +239,28 @@ void StatusFilterWidget::hideZeroItems()
 
 void StatusFilterWidget::update(const QVector<BitTorrent::Torrent *> &torrents)
 {
+    TorrentFilterBitset changedCounters;
+    changedCounters.set(TorrentFilter::All);
     for (const BitTorrent::Torrent *torrent : torrents)
-        updateTorrentStatus(torrent);
+        changedCounters |= updateTorrentStatus(torrent);
+
+    updateCounters(changedCounters);
+}
 
-    updateTexts();
+void StatusFilterWidget::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents
+        , const QVector<BitTorrent::TorrentStatusFields> &changedFields)
+{
+    Q_ASSERT(torrents.size() == changedFields.size());
 
-    if (Preferences::instance()->getHideZeroStatusFilters())
+    TorrentFilterBitset changedCounters;
+    for (qsizetype i = 0; i < torrents.size(); ++i)
     {
-        hideZeroItems();
-        updateGeometry();
+        // status filters only depend on torrent state and transfer rates
+        if (changedFields[i].testAnyFlags(STATUS_FIELDS))
+            changedCounters |= updateTorrentStatus(torrents[i]);
     }
+
+    updateCounters(changedCounters);
 }
 
 void StatusFilterWidget::showMenu()
@@ -240,42 +290,11 @@ void StatusFilterWidget::handleTorrentsLoaded(const QVector<BitTorrent::Torrent
 
 void StatusFilterWidget::torrentAboutToBeDeleted(BitTorrent::Torrent *const torrent)
 {
-    const TorrentFilterBitset status = m_torrentsStatus.take(torrent);
-
-    if (status[TorrentFilter::Downloading])
-        --m_nbDownloading;
-    if (status[TorrentFilter::Seeding])
-        --m_nbSeeding;
-    if (status[TorrentFilter::Completed])
-        --m_nbCompleted;
-    if (status[TorrentFilter::Running])
-        --m_nbRunning;
-    if (status[TorrentFilter::Stopped])
-        --m_nbStopped;
-    if (status[TorrentFilter::Active])
-        --m_nbActive;
-    if (status[TorrentFilter::Inactive])
-        --m_nbInactive;
-    if (status[TorrentFilter::StalledUploading])
-        --m_nbStalledUploading;
-    if (status[TorrentFilter::StalledDownloading])
-        --m_nbStalledDownloading;
-    if (status[TorrentFilter::Checking])
-        --m_nbChecking;
-    if (status[TorrentFilter::Moving])
-        --m_nbMoving;
-    if (status[TorrentFilter::Errored])
-        --m_nbErrored;
-
-    m_nbStalled = m_nbStalledUploading + m_nbStalledDownloading;
-
-    updateTexts();
+    const TorrentFilterBitset statuses = m_torrentsStatus.take(torrent);
 
-    if (Preferences::instance()->getHideZeroStatusFilters())
-    {
-        hideZeroItems();
-        updateGeometry();
-    }
+    TorrentFilterBitset changedCounters = adjustCounters(statuses, {});
+    changedCounters.set(TorrentFilter::All);
+    updateCounters(changedCounters);
 }
 
 void StatusFilterWidget::configure()
@@ -29,11 +29,13 @@
 
 #pragma once
 
+#include <array>
 #include <bitset>
 
 #include <QtContainerFwd>
 #include <QHash>
 
+#include "base/bittorrent/torrentstatusfield.h"
 #include "base/torrentfilter.h"
 #include "basefilterwidget.h"
 
@@ -58,24 +60,18 @@ private:
 
     void configure();
 
+    using TorrentFilterBitset = std::bitset<TorrentFilter::_Count>;
+
     void update(const QVector<BitTorrent::Torrent *> &torrents);
-    void updateTorrentStatus(const BitTorrent::Torrent *torrent);
-    void updateTexts();
+    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents, const QVector<BitTorrent::TorrentStatusFields> &changedFields);
+    // returns filters whose counter has changed
+    TorrentFilterBitset updateTorrentStatus(const BitTorrent::Torrent *torrent);
+    TorrentFilterBitset adjustCounters(TorrentFilterBitset changedStatuses, const TorrentFilterBitset &statuses);
+    void updateCounters(const TorrentFilterBitset &changedCounters);
+    void updateTexts(const TorrentFilterBitset &filters);
     void hideZeroItems();
 
-    using TorrentFilterBitset = std::bitset<32>;  // approximated size, this should be the number of TorrentFilter::Type elements
+    // status of each torrent is kept to adjust counters only by transitions
     QHash<const BitTorrent::Torrent *, TorrentFilterBitset> m_torrentsStatus;
-    int m_nbDownloading = 0;
-    int m_nbSeeding = 0;
-    int m_nbCompleted = 0;
-    int m_nbRunning = 0;
-    int m_nbStopped = 0;
-    int m_nbActive = 0;
-    int m_nbInactive = 0;
-    int m_nbStalled = 0;
-    int m_nbStalledUploading = 0;
-    int m_nbStalledDownloading = 0;
-    int m_nbChecking = 0;
-    int m_nbMoving = 0;
-    int m_nbErrored = 0;
+    std::array<int, TorrentFilter::_Count> m_counters {};
 };
@@ -84,6 +84,8 @@ TagFilterModel::TagFilterModel(QObject *parent)
     connect(session, &Session::tagRemoved, this, &TagFilterModel::tagRemoved);
     connect(session, &Session::torrentTagAdded, this, &TagFilterModel::torrentTagAdded);
     connect(session, &Session::torrentTagRemoved, this, &TagFilterModel::torrentTagRemoved);
+    connect(session, &Session::torrentsTagAdded, this, &TagFilterModel::torrentsTagAdded);
+    connect(session, &Session::torrentsTagRemoved, this, &TagFilterModel::torrentsTagRemoved);
     connect(session, &Session::torrentsLoaded, this, &TagFilterModel::torrentsLoaded);
     connect(session, &Session::torrentAboutToBeRemoved, this, &TagFilterModel::torrentAboutToBeRemoved);
     populate();
@@ -236,6 +238,40 @@ void TagFilterModel::torrentTagRemoved(BitTorrent::Torrent *const torrent, const
     emit dataChanged(i, i);
 }
 
+void TagFilterModel::torrentsTagAdded(const QVector<BitTorrent::Torrent *> &torrents, const Tag &tag)
+{
+    const int row = findRow(tag);
+    Q_ASSERT(isValidRow(row));
+    TagModelItem &item = m_tagItems[row];
+
+    // counters are updated for all the torrents first, so the views are notified only once
+    for (const BitTorrent::Torrent *torrent : torrents)
+    {
+        if (torrent->tags().count() == 1)
+            untaggedItem()->decreaseTorrentsCount();
+        item.increaseTorrentsCount();
+    }
+
+    emit dataChanged(index(ROW_UNTAGGED, 0), index(ROW_UNTAGGED, 0));
+    emit dataChanged(index(row, 0), index(row, 0));
+}
+
+void TagFilterModel::torrentsTagRemoved(const QVector<BitTorrent::Torrent *> &torrents, const Tag &tag)
+{
+    const int row = findRow(tag);
+    for (const BitTorrent::Torrent *torrent : torrents)
+    {
+        if (torrent->tags().empty())
+            untaggedItem()->increaseTorrentsCount();
+        if (row >= 0)
+            m_tagItems[row].decreaseTorrentsCount();
+    }
+
+    emit dataChanged(index(ROW_UNTAGGED, 0), index(ROW_UNTAGGED, 0));
+    if (row >= 0)
+        emit dataChanged(index(row, 0), index(row, 0));
+}
+
 void TagFilterModel::torrentsLoaded(const QVector<BitTorrent::Torrent *> &torrents)
 {
     for (const BitTorrent::Torrent *torrent : torrents)
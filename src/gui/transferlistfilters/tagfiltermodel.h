@@ -64,6 +64,8 @@ private slots:
     void tagRemoved(const Tag &tag);
     void torrentTagAdded(BitTorrent::Torrent *torrent, const Tag &tag);
     void torrentTagRemoved(BitTorrent::Torrent *, const Tag &tag);
+    void torrentsTagAdded(const QVector<BitTorrent::Torrent *> &torrents, const Tag &tag);
+    void torrentsTagRemoved(const QVector<BitTorrent::Torrent *> &torrents, const Tag &tag);
     void torrentsLoaded(const QVector<BitTorrent::Torrent *> &torrents);
     void torrentAboutToBeRemoved(BitTorrent::Torrent *torrent);
 
@@ -284,8 +284,11 @@ void TrackersFilterWidget::removeItem(const QString &trackerURL, const BitTorren
 {
     const QString host = getHost(trackerURL);
 
-    QSet<BitTorrent::TorrentID> torrentIDs = m_trackers.value(host).torrents;
-    torrentIDs.remove(id);
+    const auto trackersIt = m_trackers.find(host);
+    if (trackersIt != m_trackers.end())
+        trackersIt->torrents.remove(id);
+    // sets of torrents can be large, so avoid copying them
+    const qsizetype torrentsCount = (trackersIt != m_trackers.end()) ? trackersIt->torrents.size() : 0;
 
     QListWidgetItem *trackerItem = nullptr;
 
@@ -334,28 +337,34 @@ void TrackersFilterWidget::removeItem(const QString &trackerURL, const BitTorren
             }
         }
 
-        trackerItem = m_trackers.value(host).item;
+        if (trackersIt == m_trackers.end())
+            return;
+
+        trackerItem = trackersIt->item;
 
-        if (torrentIDs.isEmpty())
+        if (torrentsCount == 0)
         {
             if (currentItem() == trackerItem)
                 setCurrentRow(0, QItemSelectionModel::SelectCurrent);
             delete trackerItem;
-            m_trackers.remove(host);
+            m_trackers.erase(trackersIt);
             updateGeometry();
             return;
         }
 
         if (trackerItem)
-            trackerItem->setText(u"%1 (%2)"_s.arg(host, QString::number(torrentIDs.size())));
+            trackerItem->setText(u"%1 (%2)"_s.arg(host, QString::number(torrentsCount)));
     }
     else
     {
         trackerItem = item(TRACKERLESS_ROW);
-        trackerItem->setText(formatItemText(TRACKERLESS_ROW, torrentIDs.size()));
-    }
+        trackerItem->setText(formatItemText(TRACKERLESS_ROW, torrentsCount));
 
-    m_trackers.insert(host, {torrentIDs, trackerItem});
+        if (trackersIt == m_trackers.end())
+            m_trackers.insert(host, {{}, trackerItem});
+        else
+            trackersIt->item = trackerItem;
+    }
 
     if (currentItem() == trackerItem)
         applyFilter(currentRow());
@@ -390,6 +399,10 @@ void TrackersFilterWidget::handleTrackerStatusesUpdated(const BitTorrent::Torren
     auto trackerErrorHashesIt = m_trackerErrors.find(id);
     auto warningHashesIt = m_warnings.find(id);
 
+    const bool wasErrored = (errorHashesIt != m_errors.end());
+    const bool hadTrackerError = (trackerErrorHashesIt != m_trackerErrors.end());
+    const bool wasWarned = (warningHashesIt != m_warnings.end());
+
     for (const BitTorrent::TrackerEntryStatus &trackerEntryStatus : updatedTrackers)
     {
         if (trackerEntryStatus.state == BitTorrent::TrackerEndpointState::Working)
@@ -453,6 +466,13 @@ void TrackersFilterWidget::handleTrackerStatusesUpdated(const BitTorrent::Torren
     if ((warningHashesIt != m_warnings.end()) && warningHashesIt->isEmpty())
         m_warnings.erase(warningHashesIt);
 
+    // counters and filters only depend on which torrents have errors or warnings
+    if ((m_errors.contains(id) == wasErrored) && (m_trackerErrors.contains(id) == hadTrackerError)
+        && (m_warnings.contains(id) == wasWarned))
+    {
+        return;
+    }
+
     item(OTHERERROR_ROW)->setText(formatItemText(OTHERERROR_ROW, m_errors.size()));
     item(TRACKERERROR_ROW)->setText(formatItemText(TRACKERERROR_ROW, m_trackerErrors.size()));
     item(WARNING_ROW)->setText(formatItemText(WARNING_ROW, m_warnings.size()));
@@ -473,7 +493,7 @@ void TrackersFilterWidget::downloadFavicon(const QString &trackerHost, const QSt
     if (downloadingFaviconNode.isEmpty())
     {
         Net::DownloadManager::instance()->download(
-                Net::DownloadRequest(faviconURL).saveToFile(true), Preferences::instance()->useProxyForGeneralPurposes()
+                Net::DownloadRequest(faviconURL).saveToFile(true).priority(Net::DownloadPriority::Low), Preferences::instance()->useProxyForGeneralPurposes()
                 , this, &TrackersFilterWidget::handleFavicoDownloadFinished);
     }
 
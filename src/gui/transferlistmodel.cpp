@@ -29,10 +29,14 @@
 
 #include "transferlistmodel.h"
 
+#include <algorithm>
+#include <functional>
+
 #include <QApplication>
 #include <QDateTime>
 #include <QDebug>
 
+#include "base/activityscope.h"
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrent.h"
@@ -129,7 +133,7 @@ TransferListModel::TransferListModel(QObject *parent)
 
     // Listen for torrent changes
     connect(Session::instance(), &Session::torrentsLoaded, this, &TransferListModel::addTorrents);
-    connect(Session::instance(), &Session::torrentAboutToBeRemoved, this, &TransferListModel::handleTorrentAboutToBeRemoved);
+    connect(Session::instance(), &Session::torrentsAboutToBeRemoved, this, &TransferListModel::handleTorrentsAboutToBeRemoved);
     connect(Session::instance(), &Session::torrentsUpdated, this, &TransferListModel::handleTorrentsUpdated);
 
     connect(Session::instance(), &Session::torrentFinished, this, &TransferListModel::handleTorrentStatusUpdated);
@@ -137,6 +141,25 @@ TransferListModel::TransferListModel(QObject *parent)
     connect(Session::instance(), &Session::torrentStarted, this, &TransferListModel::handleTorrentStatusUpdated);
     connect(Session::instance(), &Session::torrentStopped, this, &TransferListModel::handleTorrentStatusUpdated);
     connect(Session::instance(), &Session::torrentFinishedChecking, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentSavePathChanged, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentCategoryChanged, this, [this](Torrent *torrent)
+    {
+        handleTorrentStatusUpdated(torrent);
+    });
+    connect(Session::instance(), &Session::torrentTagAdded, this, [this](Torrent *torrent)
+    {
+        handleTorrentStatusUpdated(torrent);
+    });
+    connect(Session::instance(), &Session::torrentTagRemoved, this, [this](Torrent *torrent)
+    {
+        handleTorrentStatusUpdated(torrent);
+    });
+    connect(Session::instance(), &Session::torrentsCategoryChanged, this, [this](const QHash<Torrent *, QString> &oldCategories)
+    {
+        handleTorrentsStatusUpdated(oldCategories.keys());
+    });
+    connect(Session::instance(), &Session::torrentsTagAdded, this, &TransferListModel::handleTorrentsStatusUpdated);
+    connect(Session::instance(), &Session::torrentsTagRemoved, this, &TransferListModel::handleTorrentsStatusUpdated);
 }
 
 int TransferListModel::rowCount(const QModelIndex &) const
@@ -448,6 +471,21 @@ QString TransferListModel::displayValue(const BitTorrent::Torrent *torrent, cons
     return {};
 }
 
+const QString &TransferListModel::cachedDisplayValue(const int row, const int column) const
+{
+    std::unique_ptr<DisplayCache> &cache = m_displayCaches[row];
+    if (!cache)
+        cache = std::make_unique<DisplayCache>();
+
+    if (!cache->validColumns.test(column))
+    {
+        cache->values[column] = displayValue(m_torrentList[row], column);
+        cache->validColumns.set(column);
+    }
+
+    return cache->values[column];
+}
+
 QVariant TransferListModel::internalValue(const BitTorrent::Torrent *torrent, const int column, const bool alt) const
 {
     switch (column)
@@ -535,22 +573,23 @@ QVariant TransferListModel::data(const QModelIndex &index, const int role) const
 {
     if (!index.isValid()) return {};
 
-    const BitTorrent::Torrent *torrent = m_torrentList.value(index.row());
+    const int row = index.row();
+    const BitTorrent::Torrent *torrent = m_torrentList.value(row);
     if (!torrent) return {};
 
     switch (role)
     {
     case Qt::ForegroundRole:
-        return m_stateThemeColors.value(torrent->state());
+        return m_stateThemeColors.value(m_torrentStates[row]);
     case Qt::DisplayRole:
-        return displayValue(torrent, index.column());
+        return cachedDisplayValue(row, index.column());
     case UnderlyingDataRole:
         return internalValue(torrent, index.column(), false);
     case AdditionalUnderlyingDataRole:
         return internalValue(torrent, index.column(), true);
     case Qt::DecorationRole:
         if (index.column() == TR_NAME)
-            return getIconByState(torrent->state());
+            return getIconByState(m_torrentStates[row]);
         break;
     case Qt::ToolTipRole:
         switch (index.column())
@@ -564,7 +603,7 @@ QVariant TransferListModel::data(const QModelIndex &index, const int role) const
         case TR_DOWNLOAD_PATH:
         case TR_INFOHASH_V1:
         case TR_INFOHASH_V2:
-            return displayValue(torrent, index.column());
+            return cachedDisplayValue(row, index.column());
         }
         break;
     case Qt::TextAlignmentRole:
@@ -622,6 +661,9 @@ bool TransferListModel::setData(const QModelIndex &index, const QVariant &value,
         return false;
     }
 
+    if (DisplayCache *cache = m_displayCaches[index.row()].get())
+        cache->validColumns.reset(index.column());
+
     return true;
 }
 
@@ -633,11 +675,15 @@ void TransferListModel::addTorrents(const QVector<BitTorrent::Torrent *> &torren
     beginInsertRows({}, row, total);
 
     m_torrentList.reserve(total);
+    m_torrentStates.reserve(total);
+    m_displayCaches.reserve(total);
     for (BitTorrent::Torrent *torrent : torrents)
     {
         Q_ASSERT(!m_torrentMap.contains(torrent));
 
         m_torrentList.append(torrent);
+        m_torrentStates.append(torrent->state());
+        m_displayCaches.emplace_back();
         m_torrentMap[torrent] = row++;
     }
 
@@ -659,20 +705,47 @@ BitTorrent::Torrent *TransferListModel::torrentHandle(const QModelIndex &index)
     return m_torrentList.value(index.row());
 }
 
-void TransferListModel::handleTorrentAboutToBeRemoved(BitTorrent::Torrent *const torrent)
+void TransferListModel::handleTorrentsAboutToBeRemoved(const QVector<BitTorrent::Torrent *> &torrents)
 {
-    const int row = m_torrentMap.value(torrent, -1);
-    Q_ASSERT(row >= 0);
+    QList<int> rows;
+    rows.reserve(torrents.size());
+    for (BitTorrent::Torrent *const torrent : torrents)
+    {
+        const int row = m_torrentMap.value(torrent, -1);
+        Q_ASSERT(row >= 0);
+        if (row < 0) [[unlikely]]
+            continue;
+
+        rows.append(row);
+        m_torrentMap.remove(torrent);
+    }
+
+    if (rows.isEmpty())
+        return;
 
-    beginRemoveRows({}, row, row);
-    m_torrentList.removeAt(row);
-    m_torrentMap.remove(torrent);
-    for (int &value : m_torrentMap)
+    // adjacent rows are removed at once, starting from the last ones so the rows before them keep their numbers
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    for (qsizetype i = 0; i < rows.size();)
     {
-        if (value > row)
-            --value;
+        const int lastRow = rows[i];
+        qsizetype j = i + 1;
+        while ((j < rows.size()) && (rows[j] == (rows[j - 1] - 1)))
+            ++j;
+        const int firstRow = rows[j - 1];
+        const int count = lastRow - firstRow + 1;
+
+        beginRemoveRows({}, firstRow, lastRow);
+        m_torrentList.remove(firstRow, count);
+        m_torrentStates.remove(firstRow, count);
+        m_displayCaches.erase((m_displayCaches.begin() + firstRow), (m_displayCaches.begin() + lastRow + 1));
+        endRemoveRows();
+
+        i = j;
     }
-    endRemoveRows();
+
+    // row numbers are updated once for all the removed torrents
+    for (int row = rows.last(); row < m_torrentList.size(); ++row)
+        m_torrentMap[m_torrentList[row]] = row;
 }
 
 void TransferListModel::handleTorrentStatusUpdated(BitTorrent::Torrent *const torrent)
@@ -680,27 +753,170 @@ void TransferListModel::handleTorrentStatusUpdated(BitTorrent::Torrent *const to
     const int row = m_torrentMap.value(torrent, -1);
     Q_ASSERT(row >= 0);
 
+    refreshRow(row);
     emit dataChanged(index(row, 0), index(row, columnCount() - 1));
 }
 
-void TransferListModel::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents)
+void TransferListModel::handleTorrentsStatusUpdated(const QVector<BitTorrent::Torrent *> &torrents)
+{
+    QList<int> rows;
+    rows.reserve(torrents.size());
+    for (BitTorrent::Torrent *const torrent : torrents)
+    {
+        const int row = m_torrentMap.value(torrent, -1);
+        Q_ASSERT(row >= 0);
+        if (row < 0) [[unlikely]]
+            continue;
+
+        refreshRow(row);
+        rows.append(row);
+    }
+
+    // adjacent rows are reported at once
+    std::sort(rows.begin(), rows.end());
+    for (qsizetype i = 0; i < rows.size();)
+    {
+        qsizetype j = i + 1;
+        while ((j < rows.size()) && (rows[j] == (rows[j - 1] + 1)))
+            ++j;
+
+        emit dataChanged(index(rows[i], 0), index(rows[j - 1], (columnCount() - 1)));
+        i = j;
+    }
+}
+
+void TransferListModel::refreshRow(const int row)
 {
-    const int columns = (columnCount() - 1);
+    m_torrentStates[row] = m_torrentList[row]->state();
+    m_displayCaches[row].reset();
+}
+
+void TransferListModel::clearDisplayCache()
+{
+    for (std::unique_ptr<DisplayCache> &cache : m_displayCaches)
+        cache.reset();
+}
+
+void TransferListModel::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents
+        , const QVector<BitTorrent::TorrentStatusFields> &changedFields)
+{
+    const ActivityScope activityScope {"TransferListModel::handleTorrentsUpdated"};
+
+    using BitTorrent::TorrentStatusField;
+    using BitTorrent::TorrentStatusFields;
+
+    // Columns are only refreshed when the data they display has changed.
+    // Zero means the column depends on the current time, so it is refreshed on every update.
+    static const TorrentStatusFields columnFields[NB_COLUMNS] =
+    {
+        TorrentStatusField::State, // TR_QUEUE_POSITION
+        TorrentStatusField::State | TorrentStatusField::Properties, // TR_NAME
+        TorrentStatusField::Progress | TorrentStatusField::Properties, // TR_SIZE
+        TorrentStatusField::Progress | TorrentStatusField::Properties, // TR_TOTAL_SIZE
+        TorrentStatusField::Progress, // TR_PROGRESS
+        TorrentStatusField::State, // TR_STATUS
+        TorrentStatusField::Peers, // TR_SEEDS
+        TorrentStatusField::Peers, // TR_PEERS
+        TorrentStatusField::Transfer, // TR_DLSPEED
+        TorrentStatusField::Transfer, // TR_UPSPEED
+        TorrentStatusField::Transfer | TorrentStatusField::Totals | TorrentStatusField::Times
+            | TorrentStatusField::Progress | TorrentStatusField::Properties, // TR_ETA
+        TorrentStatusField::Totals | TorrentStatusField::Progress | TorrentStatusField::Properties, // TR_RATIO
+        TorrentStatusField::Totals | TorrentStatusField::Times | TorrentStatusField::Properties, // TR_POPULARITY
+        TorrentStatusField::Properties, // TR_CATEGORY
+        TorrentStatusField::Properties, // TR_TAGS
+        TorrentStatusField::Times, // TR_ADD_DATE
+        TorrentStatusField::Times, // TR_SEED_DATE
+        TorrentStatusField::Trackers, // TR_TRACKER
+        TorrentStatusField::Properties, // TR_DLLIMIT
+        TorrentStatusField::Properties, // TR_UPLIMIT
+        TorrentStatusField::Totals, // TR_AMOUNT_DOWNLOADED
+        TorrentStatusField::Totals, // TR_AMOUNT_UPLOADED
+        TorrentStatusField::Totals, // TR_AMOUNT_DOWNLOADED_SESSION
+        TorrentStatusField::Totals, // TR_AMOUNT_UPLOADED_SESSION
+        TorrentStatusField::Progress | TorrentStatusField::Properties, // TR_AMOUNT_LEFT
+        TorrentStatusField::Times, // TR_TIME_ELAPSED
+        TorrentStatusField::State | TorrentStatusField::Properties, // TR_SAVE_PATH
+        TorrentStatusField::Progress, // TR_COMPLETED
+        TorrentStatusField::Properties, // TR_RATIO_LIMIT
+        TorrentStatusField::Times, // TR_SEEN_COMPLETE_DATE
+        {}, // TR_LAST_ACTIVITY
+        TorrentStatusField::Availability, // TR_AVAILABILITY
+        TorrentStatusField::Properties, // TR_DOWNLOAD_PATH
+        TorrentStatusField::Properties, // TR_INFOHASH_V1
+        TorrentStatusField::Properties, // TR_INFOHASH_V2
+        TorrentStatusField::Times, // TR_REANNOUNCE
+        TorrentStatusField::Properties // TR_PRIVATE
+    };
+
+    // state affects colors and zero values hiding of every column
+    const auto isColumnChanged = [](const int column, const TorrentStatusFields fields)
+    {
+        return fields.testFlag(TorrentStatusField::State)
+            || !columnFields[column]
+            || fields.testAnyFlags(columnFields[column]);
+    };
+
+    const auto emitChangedColumns = [this, &isColumnChanged](const int firstRow, const int lastRow, const TorrentStatusFields fields)
+    {
+        int column = 0;
+        while (column < NB_COLUMNS)
+        {
+            if (!isColumnChanged(column, fields))
+            {
+                ++column;
+                continue;
+            }
+
+            const int firstColumn = column;
+            while ((column < NB_COLUMNS) && isColumnChanged(column, fields))
+                ++column;
+            emit dataChanged(index(firstRow, firstColumn), index(lastRow, (column - 1)));
+        }
+    };
+
+    Q_ASSERT(torrents.size() == changedFields.size());
+
+    for (qsizetype i = 0; i < torrents.size(); ++i)
+    {
+        const int row = m_torrentMap.value(torrents[i], -1);
+        Q_ASSERT(row >= 0);
+
+        const TorrentStatusFields fields = changedFields[i];
+        if (fields.testFlag(TorrentStatusField::State))
+        {
+            refreshRow(row);
+            continue;
+        }
+
+        DisplayCache *cache = m_displayCaches[row].get();
+        if (!cache)
+            continue;
+
+        for (int column = 0; column < NB_COLUMNS; ++column)
+        {
+            if (isColumnChanged(column, fields))
+                cache->validColumns.reset(column);
+        }
+    }
 
     if (torrents.size() <= (m_torrentList.size() * 0.5))
     {
-        for (BitTorrent::Torrent *const torrent : torrents)
+        for (qsizetype i = 0; i < torrents.size(); ++i)
         {
-            const int row = m_torrentMap.value(torrent, -1);
+            const int row = m_torrentMap.value(torrents[i], -1);
             Q_ASSERT(row >= 0);
 
-            emit dataChanged(index(row, 0), index(row, columns));
+            emitChangedColumns(row, row, changedFields[i]);
         }
     }
     else
     {
         // save the overhead when more than half of the torrent list needs update
-        emit dataChanged(index(0, 0), index((rowCount() - 1), columns));
+        TorrentStatusFields fields;
+        for (const TorrentStatusFields torrentFields : changedFields)
+            fields |= torrentFields;
+        emitChangedColumns(0, (rowCount() - 1), fields);
     }
 }
 
@@ -720,6 +936,7 @@ void TransferListModel::configure()
     if (m_hideZeroValuesMode != hideZeroValuesMode)
     {
         m_hideZeroValuesMode = hideZeroValuesMode;
+        clearDisplayCache();
         emit dataChanged(index(0, 0), index((rowCount() - 1), (columnCount() - 1)));
     }
 }
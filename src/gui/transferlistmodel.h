@@ -29,6 +29,11 @@
 
 #pragma once
 
+#include <array>
+#include <bitset>
+#include <memory>
+#include <vector>
+
 #include <QAbstractListModel>
 #include <QColor>
 #include <QHash>
@@ -110,19 +115,34 @@ public:
 
 private slots:
     void addTorrents(const QVector<BitTorrent::Torrent *> &torrents);
-    void handleTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent);
+    void handleTorrentsAboutToBeRemoved(const QVector<BitTorrent::Torrent *> &torrents);
+    void handleTorrentsStatusUpdated(const QVector<BitTorrent::Torrent *> &torrents);
     void handleTorrentStatusUpdated(BitTorrent::Torrent *torrent);
-    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents);
+    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents, const QVector<BitTorrent::TorrentStatusFields> &changedFields);
 
 private:
+    // Display strings of a row, formatted when the row is shown for the first time
+    // and kept until the torrent data they depend on changes
+    struct DisplayCache
+    {
+        std::array<QString, NB_COLUMNS> values;
+        std::bitset<NB_COLUMNS> validColumns;
+    };
+
     void configure();
     void loadUIThemeResources();
     QString displayValue(const BitTorrent::Torrent *torrent, int column) const;
+    const QString &cachedDisplayValue(int row, int column) const;
     QVariant internalValue(const BitTorrent::Torrent *torrent, int column, bool alt) const;
     QIcon getIconByState(BitTorrent::TorrentState state) const;
+    void refreshRow(int row);
+    void clearDisplayCache();
 
     QList<BitTorrent::Torrent *> m_torrentList;  // maps row number to torrent handle
     QHash<BitTorrent::Torrent *, int> m_torrentMap;  // maps torrent handle to row number
+    // per row data, refreshed only when torrents are updated so that repaints don't query torrents
+    QList<BitTorrent::TorrentState> m_torrentStates;
+    mutable std::vector<std::unique_ptr<DisplayCache>> m_displayCaches;
     const QHash<BitTorrent::TorrentState, QString> m_statusStrings;
     // row text colors
     QHash<BitTorrent::TorrentState, QColor> m_stateThemeColors;
@@ -0,0 +1,256 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "transferlistselectionsummary.h"
+
+#include <QList>
+#include <QVector>
+
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/torrent.h"
+
+namespace
+{
+    quint32 flagBit(const TransferListSelectionSummary::Flag flag)
+    {
+        return (1U << flag);
+    }
+}
+
+TransferListSelectionSummary::TransferListSelectionSummary(QObject *parent)
+    : QObject(parent)
+{
+    auto *session = BitTorrent::Session::instance();
+    connect(session, &BitTorrent::Session::torrentAboutToBeRemoved, this, &TransferListSelectionSummary::removeTorrent);
+    connect(session, &BitTorrent::Session::torrentsUpdated, this, [this](const QVector<BitTorrent::Torrent *> &torrents)
+    {
+        updateTorrents(torrents);
+    });
+    connect(session, &BitTorrent::Session::torrentFinished, this, &TransferListSelectionSummary::updateTorrent);
+    connect(session, &BitTorrent::Session::torrentFinishedChecking, this, &TransferListSelectionSummary::updateTorrent);
+    connect(session, &BitTorrent::Session::torrentMetadataReceived, this, &TransferListSelectionSummary::updateTorrent);
+    connect(session, &BitTorrent::Session::torrentStarted, this, &TransferListSelectionSummary::updateTorrent);
+    connect(session, &BitTorrent::Session::torrentStopped, this, &TransferListSelectionSummary::updateTorrent);
+    connect(session, &BitTorrent::Session::torrentSavingModeChanged, this, &TransferListSelectionSummary::updateTorrent);
+    connect(session, &BitTorrent::Session::torrentCategoryChanged, this, [this](BitTorrent::Torrent *torrent)
+    {
+        updateTorrent(torrent);
+    });
+    connect(session, &BitTorrent::Session::torrentsCategoryChanged, this, [this](const QHash<BitTorrent::Torrent *, QString> &oldCategories)
+    {
+        for (auto it = oldCategories.cbegin(); it != oldCategories.cend(); ++it)
+            updateTorrent(it.key());
+    });
+    connect(session, &BitTorrent::Session::torrentTagAdded, this, [this](BitTorrent::Torrent *torrent)
+    {
+        updateTorrent(torrent);
+    });
+    connect(session, &BitTorrent::Session::torrentTagRemoved, this, [this](BitTorrent::Torrent *torrent)
+    {
+        updateTorrent(torrent);
+    });
+    connect(session, &BitTorrent::Session::torrentsTagAdded, this, &TransferListSelectionSummary::updateTorrents);
+    connect(session, &BitTorrent::Session::torrentsTagRemoved, this, &TransferListSelectionSummary::updateTorrents);
+}
+
+void TransferListSelectionSummary::addTorrent(BitTorrent::Torrent *torrent)
+{
+    if (!torrent || m_records.contains(torrent))
+        return;
+
+    const TorrentRecord record = makeRecord(torrent);
+    addRecord(record);
+    m_records.insert(torrent, record);
+}
+
+void TransferListSelectionSummary::removeTorrent(BitTorrent::Torrent *torrent)
+{
+    const auto it = m_records.constFind(torrent);
+    if (it == m_records.cend())
+        return;
+
+    removeRecord(it.value());
+    m_records.erase(it);
+}
+
+void TransferListSelectionSummary::clear()
+{
+    m_records.clear();
+    m_flagCounts.fill(0);
+    m_categoryCounts.clear();
+    m_tagCounts.clear();
+}
+
+bool TransferListSelectionSummary::isEmpty() const
+{
+    return m_records.isEmpty();
+}
+
+qsizetype TransferListSelectionSummary::size() const
+{
+    return m_records.size();
+}
+
+QList<BitTorrent::Torrent *> TransferListSelectionSummary::torrents() const
+{
+    return m_records.keys();
+}
+
+QVector<BitTorrent::TorrentID> TransferListSelectionSummary::torrentIDs() const
+{
+    QVector<BitTorrent::TorrentID> torrentIDs;
+    torrentIDs.reserve(m_records.size());
+    for (auto it = m_records.keyBegin(); it != m_records.keyEnd(); ++it)
+        torrentIDs.append((*it)->id());
+    return torrentIDs;
+}
+
+qsizetype TransferListSelectionSummary::count(const Flag flag) const
+{
+    return m_flagCounts[flag];
+}
+
+bool TransferListSelectionSummary::any(const Flag flag) const
+{
+    return (m_flagCounts[flag] > 0);
+}
+
+Qt::CheckState TransferListSelectionSummary::checkState(const Flag flag, const qsizetype total) const
+{
+    const qsizetype flagCount = m_flagCounts[flag];
+    if (flagCount == 0)
+        return Qt::Unchecked;
+    return (flagCount >= total) ? Qt::Checked : Qt::PartiallyChecked;
+}
+
+std::optional<QString> TransferListSelectionSummary::commonCategory() const
+{
+    if (m_categoryCounts.size() != 1)
+        return std::nullopt;
+    return m_categoryCounts.cbegin().key();
+}
+
+TagSet TransferListSelectionSummary::tags() const
+{
+    TagSet tags;
+    for (auto it = m_tagCounts.keyBegin(); it != m_tagCounts.keyEnd(); ++it)
+        tags.insert(*it);
+    return tags;
+}
+
+Qt::CheckState TransferListSelectionSummary::tagCheckState(const Tag &tag) const
+{
+    const qsizetype tagCount = m_tagCounts.value(tag);
+    if (tagCount == 0)
+        return Qt::Unchecked;
+    return (tagCount >= m_records.size()) ? Qt::Checked : Qt::PartiallyChecked;
+}
+
+TransferListSelectionSummary::TorrentRecord TransferListSelectionSummary::makeRecord(const BitTorrent::Torrent *torrent)
+{
+    TorrentRecord record;
+    record.category = torrent->category();
+    record.tags = torrent->tags();
+
+    const auto setFlag = [&record](const Flag flag, const bool value)
+    {
+        if (value)
+            record.flags |= flagBit(flag);
+    };
+
+    const bool isStopped = torrent->isStopped();
+    const bool isChecking = torrent->isChecking();
+    const bool hasMetadata = torrent->hasMetadata();
+    const bool isFinished = torrent->isFinished();
+    setFlag(Stopped, isStopped);
+    setFlag(Forced, torrent->isForced());
+    setFlag(Errored, (torrent->isErrored() || torrent->hasMissingFiles()));
+    setFlag(Checking, isChecking);
+    setFlag(HasMetadata, hasMetadata);
+    setFlag(Finished, isFinished);
+    setFlag(SequentialDownload, (!isFinished && torrent->isSequentialDownload()));
+    setFlag(FirstLastPiecePriority, (!isFinished && torrent->hasFirstLastPiecePriority()));
+    setFlag(SuperSeeding, (isFinished && hasMetadata && torrent->superSeeding()));
+    setFlag(AutoTMM, torrent->isAutoTMMEnabled());
+    setFlag(CanReannounce, (!isStopped && !isChecking && !torrent->isQueued()));
+    setFlag(HasInfoHashV1, torrent->infoHash().v1().isValid());
+    setFlag(HasInfoHashV2, torrent->infoHash().v2().isValid());
+
+    return record;
+}
+
+void TransferListSelectionSummary::addRecord(const TorrentRecord &record)
+{
+    for (int flag = 0; flag < FlagsCount; ++flag)
+    {
+        if (record.flags & flagBit(static_cast<Flag>(flag)))
+            ++m_flagCounts[flag];
+    }
+
+    ++m_categoryCounts[record.category];
+    for (const Tag &tag : record.tags)
+        ++m_tagCounts[tag];
+}
+
+void TransferListSelectionSummary::removeRecord(const TorrentRecord &record)
+{
+    for (int flag = 0; flag < FlagsCount; ++flag)
+    {
+        if (record.flags & flagBit(static_cast<Flag>(flag)))
+            --m_flagCounts[flag];
+    }
+
+    if (const auto it = m_categoryCounts.find(record.category); --it.value() == 0)
+        m_categoryCounts.erase(it);
+
+    for (const Tag &tag : record.tags)
+    {
+        if (const auto it = m_tagCounts.find(tag); --it.value() == 0)
+            m_tagCounts.erase(it);
+    }
+}
+
+void TransferListSelectionSummary::updateTorrent(BitTorrent::Torrent *torrent)
+{
+    const auto it = m_records.find(torrent);
+    if (it == m_records.end())
+        return;
+
+    removeRecord(it.value());
+    it.value() = makeRecord(torrent);
+    addRecord(it.value());
+}
+
+void TransferListSelectionSummary::updateTorrents(const QVector<BitTorrent::Torrent *> &torrents)
+{
+    if (m_records.isEmpty())
+        return;
+
+    for (BitTorrent::Torrent *torrent : torrents)
+        updateTorrent(torrent);
+}
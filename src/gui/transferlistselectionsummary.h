@@ -0,0 +1,121 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+#include <optional>
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QtContainerFwd>
+
+#include "base/bittorrent/infohash.h"
+#include "base/tag.h"
+#include "base/tagset.h"
+
+namespace BitTorrent
+{
+    class Torrent;
+}
+
+// Aggregated state of the torrents selected in the transfer list.
+// It is updated incrementally as the torrents are (de)selected or their state changes,
+// so large selections don't have to be inspected torrent by torrent.
+class TransferListSelectionSummary final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TransferListSelectionSummary)
+
+public:
+    enum Flag
+    {
+        Stopped,
+        Forced,
+        // errored or has missing files
+        Errored,
+        Checking,
+        HasMetadata,
+        Finished,
+        // the following two are set only for the unfinished torrents
+        SequentialDownload,
+        FirstLastPiecePriority,
+        // set only for the finished torrents having metadata
+        SuperSeeding,
+        AutoTMM,
+        CanReannounce,
+        HasInfoHashV1,
+        HasInfoHashV2,
+
+        FlagsCount
+    };
+
+    explicit TransferListSelectionSummary(QObject *parent = nullptr);
+
+    void addTorrent(BitTorrent::Torrent *torrent);
+    void removeTorrent(BitTorrent::Torrent *torrent);
+    void clear();
+
+    bool isEmpty() const;
+    qsizetype size() const;
+    QList<BitTorrent::Torrent *> torrents() const;
+    QVector<BitTorrent::TorrentID> torrentIDs() const;
+
+    // number of the selected torrents having the flag
+    qsizetype count(Flag flag) const;
+    bool any(Flag flag) const;
+    // state of the flag among `total` torrents it is applicable to
+    Qt::CheckState checkState(Flag flag, qsizetype total) const;
+
+    // category of all the selected torrents, if they have the same one
+    std::optional<QString> commonCategory() const;
+    // tags of any of the selected torrents
+    TagSet tags() const;
+    Qt::CheckState tagCheckState(const Tag &tag) const;
+
+private:
+    struct TorrentRecord
+    {
+        quint32 flags = 0;
+        QString category;
+        TagSet tags;
+    };
+
+    static TorrentRecord makeRecord(const BitTorrent::Torrent *torrent);
+
+    void addRecord(const TorrentRecord &record);
+    void removeRecord(const TorrentRecord &record);
+    void updateTorrent(BitTorrent::Torrent *torrent);
+    void updateTorrents(const QVector<BitTorrent::Torrent *> &torrents);
+
+    QHash<BitTorrent::Torrent *, TorrentRecord> m_records;
+    std::array<qsizetype, FlagsCount> m_flagCounts {};
+    QHash<QString, qsizetype> m_categoryCounts;
+    QHash<Tag, qsizetype> m_tagCounts;
+};
@@ -28,6 +28,7 @@
 
 #include "transferlistsortmodel.h"
 
+#include <algorithm>
 #include <type_traits>
 
 #include <QDateTime>
@@ -46,16 +47,6 @@ namespace
         return (left < right) ? -1 : 1;
     }
 
-    int customCompare(const QDateTime &left, const QDateTime &right)
-    {
-        const bool isLeftValid = left.isValid();
-        const bool isRightValid = right.isValid();
-
-        if (isLeftValid == isRightValid)
-            return threeWayCompare(left, right);
-        return isLeftValid ? -1 : 1;
-    }
-
     int customCompare(const TagSet &left, const TagSet &right, const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> &compare)
     {
         for (auto leftIter = left.cbegin(), rightIter = right.cbegin();
@@ -84,17 +75,6 @@ namespace
         return isLeftValid ? -1 : 1;
     }
 
-    int compareAsBool(const QVariant &left, const QVariant &right)
-    {
-        const bool leftValid = left.isValid();
-        const bool rightValid = right.isValid();
-        if (leftValid && rightValid)
-            return threeWayCompare(left.toBool(), right.toBool());
-        if (!leftValid && !rightValid)
-            return 0;
-        return leftValid ? -1 : 1;
-    }
-
     int adjustSubSortColumn(const int column)
     {
         return ((column >= 0) && (column < TransferListModel::NB_COLUMNS))
@@ -110,12 +90,35 @@ TransferListSortModel::TransferListSortModel(QObject *parent)
     setSortRole(TransferListModel::UnderlyingDataRole);
 }
 
+void TransferListSortModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (this->sourceModel())
+        this->sourceModel()->disconnect(this);
+
+    // Caches must be updated before the base class handles the changes,
+    // so connect to the source model before it does.
+    if (sourceModel)
+    {
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &TransferListSortModel::handleSourceDataChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &TransferListSortModel::handleSourceRowsInserted);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &TransferListSortModel::handleSourceRowsRemoved);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &TransferListSortModel::clearCache);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &TransferListSortModel::clearCache);
+    }
+
+    m_sortKeys.clear();
+    m_filterResults.assign((sourceModel ? sourceModel->rowCount() : 0), std::nullopt);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 void TransferListSortModel::sort(const int column, const Qt::SortOrder order)
 {
     if ((m_lastSortColumn != column) && (m_lastSortColumn != -1))
     {
         m_subSortColumn = m_lastSortColumn;
         m_subSortOrder = m_lastSortOrder;
+        // only keys of the columns currently used for sorting are kept up to date
+        m_sortKeys.clear();
     }
     m_lastSortColumn = column;
     m_lastSortOrder = ((order == Qt::AscendingOrder) ? 0 : 1);
@@ -126,68 +129,139 @@ void TransferListSortModel::sort(const int column, const Qt::SortOrder order)
 void TransferListSortModel::setStatusFilter(const TorrentFilter::Type filter)
 {
     if (m_filter.setType(filter))
-        invalidateRowsFilter();
+        invalidateFilterCache();
 }
 
 void TransferListSortModel::setCategoryFilter(const QString &category)
 {
     if (m_filter.setCategory(category))
-        invalidateRowsFilter();
+        invalidateFilterCache();
 }
 
 void TransferListSortModel::disableCategoryFilter()
 {
     if (m_filter.setCategory(TorrentFilter::AnyCategory))
-        invalidateRowsFilter();
+        invalidateFilterCache();
 }
 
 void TransferListSortModel::setTagFilter(const Tag &tag)
 {
     if (m_filter.setTag(tag))
-        invalidateRowsFilter();
+        invalidateFilterCache();
 }
 
 void TransferListSortModel::disableTagFilter()
 {
     if (m_filter.setTag(TorrentFilter::AnyTag))
-        invalidateRowsFilter();
+        invalidateFilterCache();
 }
 
 void TransferListSortModel::setTrackerFilter(const QSet<BitTorrent::TorrentID> &torrentIDs)
 {
     if (m_filter.setTorrentIDSet(torrentIDs))
-        invalidateRowsFilter();
+        invalidateFilterCache();
 }
 
 void TransferListSortModel::disableTrackerFilter()
 {
     if (m_filter.setTorrentIDSet(TorrentFilter::AnyID))
-        invalidateRowsFilter();
+        invalidateFilterCache();
 }
 
-int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &right) const
+TransferListSortModel::SortKey TransferListSortModel::makeSortKey(const QModelIndex &index) const
 {
-    const int compareColumn = left.column();
-    const QVariant leftValue = left.data(TransferListModel::UnderlyingDataRole);
-    const QVariant rightValue = right.data(TransferListModel::UnderlyingDataRole);
+    const QVariant value = index.data(TransferListModel::UnderlyingDataRole);
 
-    switch (compareColumn)
+    SortKey key;
+    switch (index.column())
     {
     case TransferListModel::TR_CATEGORY:
     case TransferListModel::TR_DOWNLOAD_PATH:
     case TransferListModel::TR_NAME:
     case TransferListModel::TR_SAVE_PATH:
     case TransferListModel::TR_TRACKER:
-        return m_naturalCompare(leftValue.toString(), rightValue.toString());
+        key.naturalKey = m_naturalCompare.sortKey(value.toString());
+        break;
 
+    // hex representation preserves the order of digests
     case TransferListModel::TR_INFOHASH_V1:
-        return threeWayCompare(leftValue.value<SHA1Hash>(), rightValue.value<SHA1Hash>());
+        key.text = value.value<SHA1Hash>().toString();
+        break;
 
     case TransferListModel::TR_INFOHASH_V2:
-        return threeWayCompare(leftValue.value<SHA256Hash>(), rightValue.value<SHA256Hash>());
+        key.text = value.value<SHA256Hash>().toString();
+        break;
 
     case TransferListModel::TR_TAGS:
-        return customCompare(leftValue.value<TagSet>(), rightValue.value<TagSet>(), m_naturalCompare);
+        key.tags = value.value<TagSet>();
+        break;
+
+    case TransferListModel::TR_AVAILABILITY:
+    case TransferListModel::TR_PROGRESS:
+    case TransferListModel::TR_RATIO:
+    case TransferListModel::TR_RATIO_LIMIT:
+    case TransferListModel::TR_POPULARITY:
+        key.real = value.toReal();
+        break;
+
+    case TransferListModel::TR_ADD_DATE:
+    case TransferListModel::TR_SEED_DATE:
+    case TransferListModel::TR_SEEN_COMPLETE_DATE:
+        {
+            const QDateTime dateTime = value.toDateTime();
+            key.isValid = dateTime.isValid();
+            key.number = key.isValid ? dateTime.toMSecsSinceEpoch() : 0;
+        }
+        break;
+
+    case TransferListModel::TR_PRIVATE:
+        key.isValid = value.isValid();
+        key.number = value.toBool();
+        break;
+
+    case TransferListModel::TR_PEERS:
+    case TransferListModel::TR_SEEDS:
+        key.number = value.toInt();
+        key.additionalNumber = index.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
+        break;
+
+    default:
+        key.number = value.toLongLong();
+        break;
+    }
+
+    return key;
+}
+
+const TransferListSortModel::SortKey &TransferListSortModel::sortKey(const QModelIndex &index) const
+{
+    std::vector<std::optional<SortKey>> &keys = m_sortKeys[index.column()];
+    if (keys.empty())
+        keys.resize(sourceModel()->rowCount());
+
+    std::optional<SortKey> &key = keys[index.row()];
+    if (!key)
+        key = makeSortKey(index);
+    return *key;
+}
+
+int TransferListSortModel::compare(const int column, const SortKey &left, const SortKey &right) const
+{
+    switch (column)
+    {
+    case TransferListModel::TR_CATEGORY:
+    case TransferListModel::TR_DOWNLOAD_PATH:
+    case TransferListModel::TR_NAME:
+    case TransferListModel::TR_SAVE_PATH:
+    case TransferListModel::TR_TRACKER:
+        return left.naturalKey->compare(*right.naturalKey);
+
+    case TransferListModel::TR_INFOHASH_V1:
+    case TransferListModel::TR_INFOHASH_V2:
+        return threeWayCompare(left.text, right.text);
+
+    case TransferListModel::TR_TAGS:
+        return customCompare(left.tags, right.tags, m_naturalCompare);
 
     case TransferListModel::TR_AMOUNT_DOWNLOADED:
     case TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION:
@@ -201,46 +275,40 @@ int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &r
     case TransferListModel::TR_SIZE:
     case TransferListModel::TR_TIME_ELAPSED:
     case TransferListModel::TR_TOTAL_SIZE:
-        return customCompare(leftValue.toLongLong(), rightValue.toLongLong());
+    case TransferListModel::TR_DLLIMIT:
+    case TransferListModel::TR_DLSPEED:
+    case TransferListModel::TR_QUEUE_POSITION:
+    case TransferListModel::TR_UPLIMIT:
+    case TransferListModel::TR_UPSPEED:
+        return customCompare(left.number, right.number);
 
     case TransferListModel::TR_AVAILABILITY:
     case TransferListModel::TR_PROGRESS:
     case TransferListModel::TR_RATIO:
     case TransferListModel::TR_RATIO_LIMIT:
     case TransferListModel::TR_POPULARITY:
-        return customCompare(leftValue.toReal(), rightValue.toReal());
+        return customCompare(left.real, right.real);
 
     case TransferListModel::TR_STATUS:
-        return threeWayCompare(leftValue.toInt(), rightValue.toInt());
+        return threeWayCompare(left.number, right.number);
 
     case TransferListModel::TR_ADD_DATE:
     case TransferListModel::TR_SEED_DATE:
     case TransferListModel::TR_SEEN_COMPLETE_DATE:
-        return customCompare(leftValue.toDateTime(), rightValue.toDateTime());
-
-    case TransferListModel::TR_DLLIMIT:
-    case TransferListModel::TR_DLSPEED:
-    case TransferListModel::TR_QUEUE_POSITION:
-    case TransferListModel::TR_UPLIMIT:
-    case TransferListModel::TR_UPSPEED:
-        return customCompare(leftValue.toInt(), rightValue.toInt());
-
     case TransferListModel::TR_PRIVATE:
-        return compareAsBool(leftValue, rightValue);
+        // invalid values go last
+        if (left.isValid && right.isValid)
+            return threeWayCompare(left.number, right.number);
+        if (!left.isValid && !right.isValid)
+            return 0;
+        return left.isValid ? -1 : 1;
 
     case TransferListModel::TR_PEERS:
     case TransferListModel::TR_SEEDS:
-        {
-            // Active peers/seeds take precedence over total peers/seeds
-            const auto activeL = leftValue.toInt();
-            const auto activeR = rightValue.toInt();
-            if (activeL != activeR)
-                return threeWayCompare(activeL, activeR);
-
-            const auto totalL = left.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            const auto totalR = right.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            return threeWayCompare(totalL, totalR);
-        }
+        // Active peers/seeds take precedence over total peers/seeds
+        if (left.number != right.number)
+            return threeWayCompare(left.number, right.number);
+        return threeWayCompare(left.additionalNumber, right.additionalNumber);
 
     default:
         Q_ASSERT_X(false, Q_FUNC_INFO, "Missing comparison case");
@@ -250,14 +318,81 @@ int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &r
     return 0;
 }
 
+void TransferListSortModel::handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    // Columns whose data the torrent filter depends on
+    const int filterColumns[] =
+    {
+        TransferListModel::TR_STATUS, TransferListModel::TR_DLSPEED, TransferListModel::TR_UPSPEED,
+        TransferListModel::TR_CATEGORY, TransferListModel::TR_TAGS, TransferListModel::TR_PRIVATE
+    };
+
+    const int firstRow = topLeft.row();
+    const int lastRow = bottomRight.row();
+    const auto isColumnInRange = [&topLeft, &bottomRight](const int column)
+    {
+        return (column >= topLeft.column()) && (column <= bottomRight.column());
+    };
+
+    for (auto it = m_sortKeys.begin(); it != m_sortKeys.end(); ++it)
+    {
+        std::vector<std::optional<SortKey>> &keys = it.value();
+        if (keys.empty() || !isColumnInRange(it.key()))
+            continue;
+
+        for (int row = firstRow; row <= lastRow; ++row)
+            keys[row].reset();
+    }
+
+    if (std::any_of(std::begin(filterColumns), std::end(filterColumns), isColumnInRange))
+    {
+        for (int row = firstRow; row <= lastRow; ++row)
+            m_filterResults[row].reset();
+    }
+}
+
+void TransferListSortModel::handleSourceRowsInserted([[maybe_unused]] const QModelIndex &parent, const int first, const int last)
+{
+    const int count = last - first + 1;
+    for (std::vector<std::optional<SortKey>> &keys : m_sortKeys)
+    {
+        if (!keys.empty())
+            keys.insert((keys.begin() + first), count, std::nullopt);
+    }
+    m_filterResults.insert((m_filterResults.begin() + first), count, std::nullopt);
+}
+
+void TransferListSortModel::handleSourceRowsRemoved([[maybe_unused]] const QModelIndex &parent, const int first, const int last)
+{
+    for (std::vector<std::optional<SortKey>> &keys : m_sortKeys)
+    {
+        if (!keys.empty())
+            keys.erase((keys.begin() + first), (keys.begin() + last + 1));
+    }
+    m_filterResults.erase((m_filterResults.begin() + first), (m_filterResults.begin() + last + 1));
+}
+
+void TransferListSortModel::clearCache()
+{
+    m_sortKeys.clear();
+    m_filterResults.assign((sourceModel() ? sourceModel()->rowCount() : 0), std::nullopt);
+}
+
+void TransferListSortModel::invalidateFilterCache()
+{
+    std::fill(m_filterResults.begin(), m_filterResults.end(), std::nullopt);
+    invalidateRowsFilter();
+}
+
 bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
     Q_ASSERT(left.column() == right.column());
 
-    const int result = compare(left, right);
+    const int result = compare(left.column(), sortKey(left), sortKey(right));
     if (result == 0)
     {
-        const int subResult = compare(left.sibling(left.row(), m_subSortColumn), right.sibling(right.row(), m_subSortColumn));
+        const int subResult = compare(m_subSortColumn
+            , sortKey(left.sibling(left.row(), m_subSortColumn)), sortKey(right.sibling(right.row(), m_subSortColumn)));
         // Qt inverses lessThan() result when ordered descending.
         // For sub-sorting we have to do it manually.
         // When both are ordered descending subResult must be double-inversed, which is the same as no inversion.
@@ -279,8 +414,11 @@ bool TransferListSortModel::matchFilter(const int sourceRow, const QModelIndex &
     const auto *model = qobject_cast<TransferListModel *>(sourceModel());
     if (!model) return false;
 
-    const BitTorrent::Torrent *torrent = model->torrentHandle(model->index(sourceRow, 0, sourceParent));
-    if (!torrent) return false;
-
-    return m_filter.match(torrent);
+    std::optional<bool> &result = m_filterResults[sourceRow];
+    if (!result)
+    {
+        const BitTorrent::Torrent *torrent = model->torrentHandle(model->index(sourceRow, 0, sourceParent));
+        result = (torrent && m_filter.match(torrent));
+    }
+    return *result;
 }
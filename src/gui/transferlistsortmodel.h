@@ -28,9 +28,14 @@
 
 #pragma once
 
+#include <optional>
+#include <vector>
+
+#include <QHash>
 #include <QSortFilterProxyModel>
 
 #include "base/settingvalue.h"
+#include "base/tagset.h"
 #include "base/torrentfilter.h"
 #include "base/utils/compare.h"
 
@@ -47,6 +52,7 @@ class TransferListSortModel final : public QSortFilterProxyModel
 public:
     explicit TransferListSortModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
     void setStatusFilter(TorrentFilter::Type filter);
@@ -58,12 +64,36 @@ public:
     void disableTrackerFilter();
 
 private:
-    int compare(const QModelIndex &left, const QModelIndex &right) const;
+    // Source values of a single column unpacked once, so comparisons don't query the source model
+    struct SortKey
+    {
+        bool isValid = true;
+        qint64 number = 0;
+        qint64 additionalNumber = 0;
+        qreal real = 0;
+        QString text;
+        std::optional<Utils::Compare::NaturalSortKey> naturalKey;
+        TagSet tags;
+    };
+
+    SortKey makeSortKey(const QModelIndex &index) const;
+    const SortKey &sortKey(const QModelIndex &index) const;
+    int compare(int column, const SortKey &left, const SortKey &right) const;
+
+    void handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void handleSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void handleSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void clearCache();
+    void invalidateFilterCache();
 
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
     bool matchFilter(int sourceRow, const QModelIndex &sourceParent) const;
 
+    // caches indexed by source row, entries are dropped when source data they depend on changes
+    mutable QHash<int, std::vector<std::optional<SortKey>>> m_sortKeys;  // by column
+    mutable std::vector<std::optional<bool>> m_filterResults;
+
     TorrentFilter m_filter;
     CachedSettingValue<int> m_subSortColumn;
     CachedSettingValue<int> m_subSortOrder;
@@ -65,6 +65,7 @@
 #include "torrentoptionsdialog.h"
 #include "trackerentriesdialog.h"
 #include "transferlistdelegate.h"
+#include "transferlistselectionsummary.h"
 #include "transferlistsortmodel.h"
 #include "tristateaction.h"
 #include "uithememanager.h"
@@ -76,15 +77,6 @@
 
 namespace
 {
-    QVector<BitTorrent::TorrentID> extractIDs(const QVector<BitTorrent::Torrent *> &torrents)
-    {
-        QVector<BitTorrent::TorrentID> torrentIDs;
-        torrentIDs.reserve(torrents.size());
-        for (const BitTorrent::Torrent *torrent : torrents)
-            torrentIDs << torrent->id();
-        return torrentIDs;
-    }
-
     bool torrentContainsPreviewableFiles(const BitTorrent::Torrent *const torrent)
     {
         if (!torrent->hasMetadata())
@@ -118,8 +110,11 @@ namespace
         auto *session = BitTorrent::Session::instance();
         const BitTorrent::TorrentRemoveOption removeOption = isDeleteFileSelected
                 ? BitTorrent::TorrentRemoveOption::RemoveContent : BitTorrent::TorrentRemoveOption::KeepContent;
+        QVector<BitTorrent::TorrentID> torrentIDs;
+        torrentIDs.reserve(torrents.size());
         for (const BitTorrent::Torrent *torrent : torrents)
-            session->removeTorrent(torrent->id(), removeOption);
+            torrentIDs.append(torrent->id());
+        session->removeTorrents(torrentIDs, removeOption);
     }
 }
 
@@ -127,6 +122,7 @@ TransferListWidget::TransferListWidget(QWidget *parent, MainWindow *mainWindow)
     : QTreeView {parent}
     , m_listModel {new TransferListModel {this}}
     , m_sortFilterModel {new TransferListSortModel {this}}
+    , m_selectionSummary {new TransferListSelectionSummary {this}}
     , m_mainWindow {mainWindow}
 {
     // Load settings
@@ -143,6 +139,18 @@ TransferListWidget::TransferListWidget(QWidget *parent, MainWindow *mainWindow)
     m_sortFilterModel->setSortRole(TransferListModel::UnderlyingDataRole);
     setModel(m_sortFilterModel);
 
+    // selection model doesn't report the rows which are deselected because they are removed or filtered out
+    connect(m_sortFilterModel, &QAbstractItemModel::rowsAboutToBeRemoved, this
+            , [this](const QModelIndex &parent, const int first, const int last)
+    {
+        for (int row = first; row <= last; ++row)
+        {
+            if (selectionModel()->isRowSelected(row, parent))
+                m_selectionSummary->removeTorrent(m_listModel->torrentHandle(mapToSource(m_sortFilterModel->index(row, 0, parent))));
+        }
+    });
+    connect(m_sortFilterModel, &QAbstractItemModel::modelReset, m_selectionSummary, &TransferListSelectionSummary::clear);
+
     // Visual settings
     setUniformRowHeights(true);
     setRootIsDecorated(false);
@@ -391,13 +399,13 @@ void TransferListWidget::resumeSession()
 
 void TransferListWidget::startSelectedTorrents()
 {
-    for (BitTorrent::Torrent *const torrent : asConst(getSelectedTorrents()))
+    for (BitTorrent::Torrent *const torrent : asConst(m_selectionSummary->torrents()))
         torrent->start();
 }
 
 void TransferListWidget::forceStartSelectedTorrents()
 {
-    for (BitTorrent::Torrent *const torrent : asConst(getSelectedTorrents()))
+    for (BitTorrent::Torrent *const torrent : asConst(m_selectionSummary->torrents()))
         torrent->start(BitTorrent::TorrentOperatingMode::Forced);
 }
 
@@ -409,7 +417,7 @@ void TransferListWidget::startVisibleTorrents()
 
 void TransferListWidget::stopSelectedTorrents()
 {
-    for (BitTorrent::Torrent *const torrent : asConst(getSelectedTorrents()))
+    for (BitTorrent::Torrent *const torrent : asConst(m_selectionSummary->torrents()))
         torrent->stop();
 }
 
@@ -481,26 +489,26 @@ void TransferListWidget::increaseQueuePosSelectedTorrents()
 {
     qDebug() << Q_FUNC_INFO;
     if (m_mainWindow->currentTabWidget() == this)
-        BitTorrent::Session::instance()->increaseTorrentsQueuePos(extractIDs(getSelectedTorrents()));
+        BitTorrent::Session::instance()->increaseTorrentsQueuePos(m_selectionSummary->torrentIDs());
 }
 
 void TransferListWidget::decreaseQueuePosSelectedTorrents()
 {
     qDebug() << Q_FUNC_INFO;
     if (m_mainWindow->currentTabWidget() == this)
-        BitTorrent::Session::instance()->decreaseTorrentsQueuePos(extractIDs(getSelectedTorrents()));
+        BitTorrent::Session::instance()->decreaseTorrentsQueuePos(m_selectionSummary->torrentIDs());
 }
 
 void TransferListWidget::topQueuePosSelectedTorrents()
 {
     if (m_mainWindow->currentTabWidget() == this)
-        BitTorrent::Session::instance()->topTorrentsQueuePos(extractIDs(getSelectedTorrents()));
+        BitTorrent::Session::instance()->topTorrentsQueuePos(m_selectionSummary->torrentIDs());
 }
 
 void TransferListWidget::bottomQueuePosSelectedTorrents()
 {
     if (m_mainWindow->currentTabWidget() == this)
-        BitTorrent::Session::instance()->bottomTorrentsQueuePos(extractIDs(getSelectedTorrents()));
+        BitTorrent::Session::instance()->bottomTorrentsQueuePos(m_selectionSummary->torrentIDs());
 }
 
 void TransferListWidget::copySelectedMagnetURIs() const
@@ -713,7 +721,7 @@ void TransferListWidget::displayColumnHeaderMenu()
 
 void TransferListWidget::setSelectedTorrentsSuperSeeding(const bool enabled) const
 {
-    for (BitTorrent::Torrent *const torrent : asConst(getSelectedTorrents()))
+    for (BitTorrent::Torrent *const torrent : asConst(m_selectionSummary->torrents()))
     {
         if (torrent->hasMetadata())
             torrent->setSuperSeeding(enabled);
@@ -722,13 +730,13 @@ void TransferListWidget::setSelectedTorrentsSuperSeeding(const bool enabled) con
 
 void TransferListWidget::setSelectedTorrentsSequentialDownload(const bool enabled) const
 {
-    for (BitTorrent::Torrent *const torrent : asConst(getSelectedTorrents()))
+    for (BitTorrent::Torrent *const torrent : asConst(m_selectionSummary->torrents()))
         torrent->setSequentialDownload(enabled);
 }
 
 void TransferListWidget::setSelectedFirstLastPiecePrio(const bool enabled) const
 {
-    for (BitTorrent::Torrent *const torrent : asConst(getSelectedTorrents()))
+    for (BitTorrent::Torrent *const torrent : asConst(m_selectionSummary->torrents()))
         torrent->setFirstLastPiecePriority(enabled);
 }
 
@@ -742,7 +750,7 @@ void TransferListWidget::setSelectedAutoTMMEnabled(const bool enabled)
         if (btn != QMessageBox::Yes) return;
     }
 
-    for (BitTorrent::Torrent *const torrent : asConst(getSelectedTorrents()))
+    for (BitTorrent::Torrent *const torrent : asConst(m_selectionSummary->torrents()))
         torrent->setAutoTMMEnabled(enabled);
 }
 
@@ -888,20 +896,6 @@ TagSet TransferListWidget::askTagsForSelection(const QString &dialogTitle)
     return tags;
 }
 
-void TransferListWidget::applyToSelectedTorrents(const std::function<void (BitTorrent::Torrent *const)> &fn)
-{
-    // Changing the data may affect the layout of the sort/filter model, which in turn may invalidate
-    // the indexes previously obtained from selection model before we process them all.
-    // Therefore, we must map all the selected indexes to source before start processing them.
-    const QModelIndexList sourceRows = mapToSource(selectionModel()->selectedRows());
-    for (const QModelIndex &index : sourceRows)
-    {
-        BitTorrent::Torrent *const torrent = m_listModel->torrentHandle(index);
-        Q_ASSERT(torrent);
-        fn(torrent);
-    }
-}
-
 void TransferListWidget::renameSelectedTorrent()
 {
     const QModelIndexList selectedIndexes = selectionModel()->selectedRows();
@@ -926,28 +920,33 @@ void TransferListWidget::renameSelectedTorrent()
 
 void TransferListWidget::setSelectionCategory(const QString &category)
 {
-    applyToSelectedTorrents([&category](BitTorrent::Torrent *torrent) { torrent->setCategory(category); });
+    BitTorrent::Session::instance()->setTorrentsCategory(m_selectionSummary->torrentIDs(), category);
 }
 
 void TransferListWidget::addSelectionTag(const Tag &tag)
 {
-    applyToSelectedTorrents([&tag](BitTorrent::Torrent *const torrent) { torrent->addTag(tag); });
+    BitTorrent::Session::instance()->addTorrentsTag(m_selectionSummary->torrentIDs(), tag);
 }
 
 void TransferListWidget::removeSelectionTag(const Tag &tag)
 {
-    applyToSelectedTorrents([&tag](BitTorrent::Torrent *const torrent) { torrent->removeTag(tag); });
+    BitTorrent::Session::instance()->removeTorrentsTag(m_selectionSummary->torrentIDs(), tag);
 }
 
 void TransferListWidget::clearSelectionTags()
 {
-    applyToSelectedTorrents([](BitTorrent::Torrent *const torrent) { torrent->removeAllTags(); });
+    const QVector<BitTorrent::TorrentID> torrentIDs = m_selectionSummary->torrentIDs();
+    // the tags are taken before any of them is removed since the summary is updated immediately
+    const TagSet torrentsTags = m_selectionSummary->tags();
+
+    auto *session = BitTorrent::Session::instance();
+    for (const Tag &tag : torrentsTags)
+        session->removeTorrentsTag(torrentIDs, tag);
 }
 
 void TransferListWidget::displayListMenu()
 {
-    const QModelIndexList selectedIndexes = selectionModel()->selectedRows();
-    if (selectedIndexes.isEmpty())
+    if (m_selectionSummary->isEmpty())
         return;
 
     auto *listMenu = new QMenu(this);
@@ -1014,126 +1013,23 @@ void TransferListWidget::displayListMenu()
     // End of actions
 
     // Enable/disable stop/start action given the DL state
-    bool needsStop = false, needsStart = false, needsForce = false, needsPreview = false;
-    bool allSameSuperSeeding = true;
-    bool superSeedingMode = false;
-    bool allSameSequentialDownloadMode = true, allSamePrioFirstlast = true;
-    bool sequentialDownloadMode = false, prioritizeFirstLast = false;
-    bool oneHasMetadata = false, oneNotFinished = false;
-    bool allSameCategory = true;
-    bool allSameAutoTMM = true;
-    bool firstAutoTMM = false;
-    QString firstCategory;
-    bool first = true;
-    TagSet tagsInAny;
-    TagSet tagsInAll;
-    bool hasInfohashV1 = false, hasInfohashV2 = false;
-    bool oneCanForceReannounce = false;
-
-    for (const QModelIndex &index : selectedIndexes)
-    {
-        const BitTorrent::Torrent *torrent = m_listModel->torrentHandle(mapToSource(index));
-        if (!torrent)
-            continue;
-
-        if (firstCategory.isEmpty() && first)
-            firstCategory = torrent->category();
-        if (firstCategory != torrent->category())
-            allSameCategory = false;
-
-        const TagSet torrentTags = torrent->tags();
-        tagsInAny.unite(torrentTags);
-
-        if (first)
-        {
-            firstAutoTMM = torrent->isAutoTMMEnabled();
-            tagsInAll = torrentTags;
-        }
-        else
-        {
-            tagsInAll.intersect(torrentTags);
-        }
-
-        if (firstAutoTMM != torrent->isAutoTMMEnabled())
-             allSameAutoTMM = false;
-
-        if (torrent->hasMetadata())
-            oneHasMetadata = true;
-        if (!torrent->isFinished())
-        {
-            oneNotFinished = true;
-            if (first)
-            {
-                sequentialDownloadMode = torrent->isSequentialDownload();
-                prioritizeFirstLast = torrent->hasFirstLastPiecePriority();
-            }
-            else
-            {
-                if (sequentialDownloadMode != torrent->isSequentialDownload())
-                    allSameSequentialDownloadMode = false;
-                if (prioritizeFirstLast != torrent->hasFirstLastPiecePriority())
-                    allSamePrioFirstlast = false;
-            }
-        }
-        else
-        {
-            if (!oneNotFinished && allSameSuperSeeding && torrent->hasMetadata())
-            {
-                if (first)
-                    superSeedingMode = torrent->superSeeding();
-                else if (superSeedingMode != torrent->superSeeding())
-                    allSameSuperSeeding = false;
-            }
-        }
-
-        if (!torrent->isForced())
-            needsForce = true;
-        else
-            needsStart = true;
-
-        const bool isStopped = torrent->isStopped();
-        if (isStopped)
-            needsStart = true;
-        else
-            needsStop = true;
-
-        if (torrent->isErrored() || torrent->hasMissingFiles())
-        {
-            // If torrent is in "errored" or "missing files" state
-            // it cannot keep further processing until you restart it.
-            needsStart = true;
-            needsForce = true;
-        }
-
-        if (torrent->hasMetadata())
-            needsPreview = true;
-
-        if (!hasInfohashV1 && torrent->infoHash().v1().isValid())
-            hasInfohashV1 = true;
-        if (!hasInfohashV2 && torrent->infoHash().v2().isValid())
-            hasInfohashV2 = true;
-
-        first = false;
-
-        const bool rechecking = torrent->isChecking();
-        if (rechecking)
-        {
-            needsStart = true;
-            needsStop = true;
-        }
-
-        const bool queued = torrent->isQueued();
-        if (!isStopped && !rechecking && !queued)
-            oneCanForceReannounce = true;
-
-        if (oneHasMetadata && oneNotFinished && !allSameSequentialDownloadMode
-            && !allSamePrioFirstlast && !allSameSuperSeeding && !allSameCategory
-            && needsStart && needsForce && needsStop && needsPreview && !allSameAutoTMM
-            && hasInfohashV1 && hasInfohashV2 && oneCanForceReannounce)
-        {
-            break;
-        }
-    }
+    const TransferListSelectionSummary &summary = *m_selectionSummary;
+    using Flag = TransferListSelectionSummary::Flag;
+    const qsizetype selectedCount = summary.size();
+    const qsizetype unfinishedCount = selectedCount - summary.count(Flag::Finished);
+    // If torrent is in "errored" or "missing files" state
+    // it cannot keep further processing until you restart it.
+    const bool needsStart = summary.any(Flag::Stopped) || summary.any(Flag::Forced)
+            || summary.any(Flag::Errored) || summary.any(Flag::Checking);
+    const bool needsStop = (summary.count(Flag::Stopped) < selectedCount) || summary.any(Flag::Checking);
+    const bool needsForce = (summary.count(Flag::Forced) < selectedCount) || summary.any(Flag::Errored);
+    const bool oneHasMetadata = summary.any(Flag::HasMetadata);
+    const bool needsPreview = oneHasMetadata;
+    const bool oneNotFinished = (unfinishedCount > 0);
+    const std::optional<QString> commonCategory = summary.commonCategory();
+    const bool hasInfohashV1 = summary.any(Flag::HasInfoHashV1);
+    const bool hasInfohashV2 = summary.any(Flag::HasInfoHashV2);
+    const bool oneCanForceReannounce = summary.any(Flag::CanReannounce);
 
     if (needsStart)
         listMenu->addAction(actionStart);
@@ -1145,7 +1041,7 @@ void TransferListWidget::displayListMenu()
     listMenu->addAction(actionDelete);
     listMenu->addSeparator();
     listMenu->addAction(actionSetTorrentPath);
-    if (selectedIndexes.size() == 1)
+    if (selectedCount == 1)
         listMenu->addAction(actionRename);
     listMenu->addAction(actionEditTracker);
 
@@ -1167,7 +1063,7 @@ void TransferListWidget::displayListMenu()
         QAction *categoryAction = categoryMenu->addAction(UIThemeManager::instance()->getIcon(u"view-categories"_s), escapedCategory
             , this, [this, category]() { setSelectionCategory(category); });
 
-        if (allSameCategory && (category == firstCategory))
+        if (category == commonCategory)
         {
             categoryAction->setCheckable(true);
             categoryAction->setChecked(true);
@@ -1195,9 +1091,7 @@ void TransferListWidget::displayListMenu()
         auto *action = new TriStateAction(Utils::Gui::tagToWidgetText(tag), tagsMenu);
         action->setCloseOnInteraction(false);
 
-        const Qt::CheckState initialState = tagsInAll.contains(tag) ? Qt::Checked
-                                            : tagsInAny.contains(tag) ? Qt::PartiallyChecked : Qt::Unchecked;
-        action->setCheckState(initialState);
+        action->setCheckState(summary.tagCheckState(tag));
 
         connect(action, &QAction::toggled, this, [this, tag](const bool checked)
         {
@@ -1210,18 +1104,14 @@ void TransferListWidget::displayListMenu()
         tagsMenu->addAction(action);
     }
 
-    actionAutoTMM->setCheckState(allSameAutoTMM
-        ? (firstAutoTMM ? Qt::Checked : Qt::Unchecked)
-        : Qt::PartiallyChecked);
+    actionAutoTMM->setCheckState(summary.checkState(Flag::AutoTMM, selectedCount));
     listMenu->addAction(actionAutoTMM);
 
     listMenu->addSeparator();
     listMenu->addAction(actionTorrentOptions);
     if (!oneNotFinished && oneHasMetadata)
     {
-        actionSuperSeedingMode->setCheckState(allSameSuperSeeding
-            ? (superSeedingMode ? Qt::Checked : Qt::Unchecked)
-            : Qt::PartiallyChecked);
+        actionSuperSeedingMode->setCheckState(summary.checkState(Flag::SuperSeeding, summary.count(Flag::HasMetadata)));
         listMenu->addAction(actionSuperSeedingMode);
     }
     listMenu->addSeparator();
@@ -1233,14 +1123,10 @@ void TransferListWidget::displayListMenu()
     }
     if (oneNotFinished)
     {
-        actionSequentialDownload->setCheckState(allSameSequentialDownloadMode
-            ? (sequentialDownloadMode ? Qt::Checked : Qt::Unchecked)
-            : Qt::PartiallyChecked);
+        actionSequentialDownload->setCheckState(summary.checkState(Flag::SequentialDownload, unfinishedCount));
         listMenu->addAction(actionSequentialDownload);
 
-        actionFirstLastPiecePrio->setCheckState(allSamePrioFirstlast
-            ? (prioritizeFirstLast ? Qt::Checked : Qt::Unchecked)
-            : Qt::PartiallyChecked);
+        actionFirstLastPiecePrio->setCheckState(summary.checkState(Flag::FirstLastPiecePriority, unfinishedCount));
         listMenu->addAction(actionFirstLastPiecePrio);
 
         addedPreviewAction = true;
@@ -1298,6 +1184,29 @@ void TransferListWidget::currentChanged(const QModelIndex &current, const QModel
     emit currentTorrentChanged(torrent);
 }
 
+void TransferListWidget::selectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
+{
+    QTreeView::selectionChanged(selected, deselected);
+
+    updateSelectionSummary(deselected, false);
+    updateSelectionSummary(selected, true);
+}
+
+void TransferListWidget::updateSelectionSummary(const QItemSelection &selection, const bool selected)
+{
+    for (const QItemSelectionRange &range : selection)
+    {
+        for (int row = range.top(); row <= range.bottom(); ++row)
+        {
+            BitTorrent::Torrent *torrent = m_listModel->torrentHandle(mapToSource(m_sortFilterModel->index(row, 0, range.parent())));
+            if (selected)
+                m_selectionSummary->addTorrent(torrent);
+            else
+                m_selectionSummary->removeTorrent(torrent);
+        }
+    }
+}
+
 void TransferListWidget::applyCategoryFilter(const QString &category)
 {
     if (category.isNull())
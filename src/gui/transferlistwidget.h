@@ -29,8 +29,6 @@
 
 #pragma once
 
-#include <functional>
-
 #include <QtContainerFwd>
 #include <QTreeView>
 
@@ -39,6 +37,7 @@
 
 class MainWindow;
 class Path;
+class TransferListSelectionSummary;
 class TransferListSortModel;
 
 namespace BitTorrent
@@ -111,6 +110,7 @@ private slots:
     void displayListMenu();
     void displayColumnHeaderMenu();
     void currentChanged(const QModelIndex &current, const QModelIndex&) override;
+    void selectionChanged(const QItemSelection &selected, const QItemSelection &deselected) override;
     void setSelectedTorrentsSuperSeeding(bool enabled) const;
     void setSelectedTorrentsSequentialDownload(bool enabled) const;
     void setSelectedFirstLastPiecePrio(bool enabled) const;
@@ -130,11 +130,12 @@ private:
     void exportTorrent();
     void confirmRemoveAllTagsForSelection();
     TagSet askTagsForSelection(const QString &dialogTitle);
-    void applyToSelectedTorrents(const std::function<void (BitTorrent::Torrent *const)> &fn);
     QVector<BitTorrent::Torrent *> getVisibleTorrents() const;
     int visibleColumnsCount() const;
+    void updateSelectionSummary(const QItemSelection &selection, bool selected);
 
     TransferListModel *m_listModel = nullptr;
     TransferListSortModel *m_sortFilterModel = nullptr;
+    TransferListSelectionSummary *m_selectionSummary = nullptr;
     MainWindow *m_mainWindow = nullptr;
 };
@@ -29,19 +29,149 @@
 #include "apicontroller.h"
 
 #include <algorithm>
+#include <chrono>
+#include <utility>
 
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
 #include <QHash>
+#include <QJsonArray>
 #include <QJsonDocument>
-#include <QMetaObject>
+#include <QJsonObject>
+#include <QMetaMethod>
+#include <QTimer>
 #include <QVector>
 
+#include "base/http/responsestream.h"
+#include "base/http/types.h"
 #include "apierror.h"
 
+using namespace std::chrono_literals;
+
+namespace
+{
+    // streamed results are written in chunks of about this size,
+    // no more chunks are written while the client has this much data queued
+    const qsizetype STREAMED_RESULT_CHUNK_SIZE = 64 * 1024;
+    const qint64 STREAMED_RESULT_MAX_PENDING_SIZE = 1024 * 1024;
+    const std::chrono::milliseconds STREAMED_RESULT_POLL_INTERVAL = 10ms;
+
+    struct StreamedResult : std::enable_shared_from_this<StreamedResult>
+    {
+        StreamedResult(APIController::ResultChunkWriter chunkWriter, const DataFormat format)
+            : chunkWriter {std::move(chunkWriter)}
+            , writer {buffer, format}
+        {
+        }
+
+        void writeNext(QObject *context)
+        {
+            while (stream->isOpen() && (stream->pendingSize() < STREAMED_RESULT_MAX_PENDING_SIZE))
+            {
+                bool isFinished = false;
+                while (!isFinished && (buffer.size() < STREAMED_RESULT_CHUNK_SIZE))
+                    isFinished = !chunkWriter(writer);
+
+                stream->write(std::exchange(buffer, {}));
+                buffer.reserve(STREAMED_RESULT_CHUNK_SIZE * 2);
+                if (isFinished)
+                {
+                    stream->close();
+                    return;
+                }
+            }
+
+            // client has gone away
+            if (!stream->isOpen())
+                return;
+
+            QTimer::singleShot(STREAMED_RESULT_POLL_INTERVAL, context, [self = shared_from_this(), context]
+            {
+                self->writeNext(context);
+            });
+        }
+
+        APIController::ResultChunkWriter chunkWriter;
+        QByteArray buffer;
+        DataWriter writer;
+        std::shared_ptr<Http::ResponseStream> stream = std::make_shared<Http::ResponseStream>();
+    };
+
+    // Actions are the slots named "<action>Action". They are looked up once per controller class
+    // instead of resolving the method by its signature on each call.
+    QMetaMethod findActionMethod(const QMetaObject *metaObject, const QString &action)
+    {
+        static QHash<const QMetaObject *, QHash<QString, QMetaMethod>> actionMethods;
+
+        auto iter = actionMethods.find(metaObject);
+        if (iter == actionMethods.end())
+        {
+            const QByteArray actionSuffix = "Action";
+            QHash<QString, QMetaMethod> methods;
+            for (int i = 0; i < metaObject->methodCount(); ++i)
+            {
+                const QMetaMethod method = metaObject->method(i);
+                const QByteArray name = method.name();
+                if ((method.methodType() == QMetaMethod::Slot) && (method.parameterCount() == 0)
+                        && name.endsWith(actionSuffix))
+                {
+                    methods.insert(QString::fromLatin1(name.chopped(actionSuffix.size())), method);
+                }
+            }
+            iter = actionMethods.insert(metaObject, methods);
+        }
+
+        return iter->value(action);
+    }
+}
+
+struct DeferredAPIResult::State
+{
+    ~State()
+    {
+        stream->close();
+    }
+
+    std::shared_ptr<Http::ResponseStream> stream = std::make_shared<Http::ResponseStream>();
+    DataFormat format = DataFormat::JSON;
+};
+
+DeferredAPIResult::DeferredAPIResult(std::shared_ptr<State> state)
+    : m_state {std::move(state)}
+{
+}
+
+void DeferredAPIResult::setResult(const QJsonArray &result) const
+{
+    setResult((m_state->format == DataFormat::CBOR)
+            ? QCborValue(QCborArray::fromJsonArray(result)).toCbor()
+            : QJsonDocument(result).toJson(QJsonDocument::Compact));
+}
+
+void DeferredAPIResult::setResult(const QJsonObject &result) const
+{
+    setResult((m_state->format == DataFormat::CBOR)
+            ? QCborValue(QCborMap::fromJsonObject(result)).toCbor()
+            : QJsonDocument(result).toJson(QJsonDocument::Compact));
+}
+
+void DeferredAPIResult::setResult(const QByteArray &result) const
+{
+    if (!m_state->stream->isOpen())
+        return;
+
+    m_state->stream->write(result);
+    m_state->stream->close();
+}
+
 void APIResult::clear()
 {
     data.clear();
     mimeType.clear();
     filename.clear();
+    etag.clear();
+    stream.reset();
 }
 
 APIController::APIController(IApplication *app, QObject *parent)
@@ -49,14 +179,16 @@ APIController::APIController(IApplication *app, QObject *parent)
 {
 }
 
-APIResult APIController::run(const QString &action, const StringMap &params, const DataMap &data)
+APIResult APIController::run(const QString &action, const StringMap &params, const DataMap &data
+        , const DataFormat resultFormat)
 {
     m_result.clear(); // clear result
     m_params = params;
     m_data = data;
+    m_resultFormat = resultFormat;
 
-    const QByteArray methodName = action.toLatin1() + "Action";
-    if (!QMetaObject::invokeMethod(this, methodName.constData()))
+    const QMetaMethod method = findActionMethod(metaObject(), action);
+    if (!method.isValid() || !method.invoke(this, Qt::DirectConnection))
         throw APIError(APIErrorType::NotFound);
 
     return m_result;
@@ -84,6 +216,16 @@ void APIController::requireParams(const QVector<QString> &requiredParams) const
         throw APIError(APIErrorType::BadParams);
 }
 
+DataFormat APIController::resultFormat() const
+{
+    return m_resultFormat;
+}
+
+QString APIController::resultContentType() const
+{
+    return (m_resultFormat == DataFormat::CBOR) ? Http::CONTENT_TYPE_CBOR : Http::CONTENT_TYPE_JSON;
+}
+
 void APIController::setResult(const QString &result)
 {
     m_result.data = result;
@@ -105,3 +247,33 @@ void APIController::setResult(const QByteArray &result, const QString &mimeType,
     m_result.mimeType = mimeType;
     m_result.filename = filename;
 }
+
+void APIController::setResult(const QByteArray &result, std::shared_ptr<Http::ResponseStream> stream, const QString &mimeType
+        , const QString &filename)
+{
+    m_result.data = result;
+    m_result.mimeType = mimeType;
+    m_result.filename = filename;
+    m_result.stream = std::move(stream);
+}
+
+void APIController::setStreamedResult(ResultChunkWriter chunkWriter)
+{
+    const auto streamedResult = std::make_shared<StreamedResult>(std::move(chunkWriter), resultFormat());
+    setResult({}, streamedResult->stream, resultContentType());
+    // the first chunks are kept until the response is sent
+    streamedResult->writeNext(this);
+}
+
+DeferredAPIResult APIController::setDeferredResult(const QString &mimeType)
+{
+    const auto state = std::make_shared<DeferredAPIResult::State>();
+    state->format = resultFormat();
+    setResult({}, state->stream, (mimeType.isEmpty() ? resultContentType() : mimeType));
+    return DeferredAPIResult(state);
+}
+
+void APIController::setResultETag(const QString &etag)
+{
+    m_result.etag = etag;
+}
@@ -28,12 +28,21 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+
 #include <QtContainerFwd>
 #include <QObject>
 #include <QString>
 #include <QVariant>
 
 #include "base/applicationcomponent.h"
+#include "serialize/datawriter.h"
+
+namespace Http
+{
+    class ResponseStream;
+}
 
 using DataMap = QHash<QString, QByteArray>;
 using StringMap = QHash<QString, QString>;
@@ -43,10 +52,33 @@ struct APIResult
     QVariant data;
     QString mimeType;
     QString filename;
+    // if set, the result is omitted when the client has it already
+    QString etag;
+    std::shared_ptr<Http::ResponseStream> stream;
 
     void clear();
 };
 
+// Result which is set after the action returns, e.g. once the data fetched from libtorrent
+// asynchronously is available. The response is sent at once and its body is written once
+// the result is set, so the action doesn't wait for the data. If the result is never set,
+// the response is completed with empty body once the last copy is destroyed.
+class DeferredAPIResult
+{
+public:
+    void setResult(const QJsonArray &result) const;
+    void setResult(const QJsonObject &result) const;
+    void setResult(const QByteArray &result) const;
+
+private:
+    friend class APIController;
+
+    struct State;
+    explicit DeferredAPIResult(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> m_state;
+};
+
 class APIController : public ApplicationComponent<QObject>
 {
     Q_OBJECT
@@ -55,20 +87,38 @@ class APIController : public ApplicationComponent<QObject>
 public:
     explicit APIController(IApplication *app, QObject *parent = nullptr);
 
-    APIResult run(const QString &action, const StringMap &params, const DataMap &data = {});
+    APIResult run(const QString &action, const StringMap &params, const DataMap &data = {}
+            , DataFormat resultFormat = DataFormat::JSON);
 
 protected:
     const StringMap &params() const;
     const DataMap &data() const;
     void requireParams(const QVector<QString> &requiredParams) const;
+    // Format the client accepts the results written with DataWriter in
+    DataFormat resultFormat() const;
+    QString resultContentType() const;
 
     void setResult(const QString &result);
     void setResult(const QJsonArray &result);
     void setResult(const QJsonObject &result);
     void setResult(const QByteArray &result, const QString &mimeType = {}, const QString &filename = {});
+    // `result` is sent first and the rest of response is written to `stream` later
+    void setResult(const QByteArray &result, std::shared_ptr<Http::ResponseStream> stream, const QString &mimeType
+            , const QString &filename = {});
+    // Writes the next part of the result, returns false once the whole result is written
+    using ResultChunkWriter = std::function<bool (DataWriter &writer)>;
+    // The result is written in chunks as fast as the client receives them instead of building it at once,
+    // so the memory use doesn't depend on its size. `chunkWriter` is called later, the data it writes
+    // must not depend on the state of the request.
+    void setStreamedResult(ResultChunkWriter chunkWriter);
+    // Errors can't be reported once the result is deferred, so the request should be validated before.
+    // JSON results are written in the format the client accepts, `mimeType` is only used for the other ones.
+    DeferredAPIResult setDeferredResult(const QString &mimeType = {});
+    void setResultETag(const QString &etag);
 
 private:
     StringMap m_params;
     DataMap m_data;
+    DataFormat m_resultFormat = DataFormat::JSON;
     APIResult m_result;
 };
@@ -35,6 +35,7 @@
 #include <chrono>
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
@@ -42,33 +43,243 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkInterface>
+#include <QThreadPool>
 #include <QRegularExpression>
 #include <QStringList>
 #include <QTimer>
 #include <QTranslator>
 
+#include "base/bittorrent/bandwidthprofile.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/sessionmetrics.h"
 #include "base/global.h"
+#include "base/http/responsestream.h"
+#include "base/http/server.h"
 #include "base/interfaces/iapplication.h"
+#include "base/memoryusage.h"
+#include "base/net/downloadmanager.h"
 #include "base/net/portforwarder.h"
 #include "base/net/proxyconfigurationmanager.h"
 #include "base/path.h"
 #include "base/preferences.h"
 #include "base/rss/rss_autodownloader.h"
 #include "base/rss/rss_session.h"
+#include "base/settingsstorage.h"
 #include "base/torrentfileguard.h"
 #include "base/torrentfileswatcher.h"
+#include "base/tracing.h"
 #include "base/utils/fs.h"
 #include "base/utils/misc.h"
 #include "base/utils/net.h"
 #include "base/utils/password.h"
+#include "base/utils/random.h"
 #include "base/utils/string.h"
 #include "base/version.h"
 #include "apierror.h"
+#include "synccontroller.h"
 #include "../webapplication.h"
 
 using namespace std::chrono_literals;
 
+namespace
+{
+    // Metrics are reported using Prometheus text exposition format
+    const QString CONTENT_TYPE_METRICS = u"text/plain; version=0.0.4; charset=utf-8"_s;
+
+    // Preferences are requested often but change rarely, so they are rebuilt only
+    // when some setting or watched folder changes. ETag lets unchanged ones be skipped entirely.
+    struct PreferencesCache
+    {
+        QString etag;
+        QJsonObject data;
+    };
+
+    PreferencesCache &preferencesCache()
+    {
+        static PreferencesCache cache;
+        return cache;
+    }
+
+    // watched folders are stored apart from the other settings
+    quint64 watchedFoldersRevision()
+    {
+        static quint64 revision = 0;
+        [[maybe_unused]] static const bool isConnected = []
+        {
+            const auto *watcher = TorrentFilesWatcher::instance();
+            QObject::connect(watcher, &TorrentFilesWatcher::watchedFolderSet, watcher, [] { ++revision; });
+            QObject::connect(watcher, &TorrentFilesWatcher::watchedFolderRemoved, watcher, [] { ++revision; });
+            return true;
+        }();
+        return revision;
+    }
+
+    QString preferencesETag()
+    {
+        // revisions start over on restart while settings may be changed in the meantime
+        static const QString instanceID = QString::number(Utils::Random::rand(), 36);
+        return u"\"%1-%2-%3\""_s.arg(instanceID, QString::number(SettingsStorage::instance()->revision())
+                , QString::number(watchedFoldersRevision()));
+    }
+
+    // Directory listings are used for path autocompletion, so huge directories are truncated
+    const int MAX_DIRECTORY_LISTING_SIZE = 10'000;
+    const int DIRECTORY_LISTING_CACHE_SIZE = 8;
+    const auto DIRECTORY_LISTING_CACHE_TTL = 10s;
+
+    struct DirectoryListing
+    {
+        QString dirPath;
+        QDir::Filters filters;
+        QStringList entries;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    // Recently listed directories, most recently used first. Accessed from main thread only.
+    QList<DirectoryListing> &directoryListingCache()
+    {
+        static QList<DirectoryListing> cache;
+        return cache;
+    }
+
+    const QStringList *findCachedDirectoryListing(const QString &dirPath, const QDir::Filters filters)
+    {
+        QList<DirectoryListing> &cache = directoryListingCache();
+        const auto now = std::chrono::steady_clock::now();
+        cache.removeIf([now](const DirectoryListing &listing) { return (now - listing.time) > DIRECTORY_LISTING_CACHE_TTL; });
+
+        const auto iter = std::find_if(cache.begin(), cache.end(), [&dirPath, filters](const DirectoryListing &listing)
+        {
+            return (listing.dirPath == dirPath) && (listing.filters == filters);
+        });
+        if (iter == cache.end())
+            return nullptr;
+
+        cache.move(std::distance(cache.begin(), iter), 0);
+        return &cache.first().entries;
+    }
+
+    void cacheDirectoryListing(DirectoryListing listing)
+    {
+        QList<DirectoryListing> &cache = directoryListingCache();
+        cache.removeIf([&listing](const DirectoryListing &cached)
+        {
+            return (cached.dirPath == listing.dirPath) && (cached.filters == listing.filters);
+        });
+        cache.prepend(std::move(listing));
+        if (cache.size() > DIRECTORY_LISTING_CACHE_SIZE)
+            cache.removeLast();
+    }
+
+    // Listing of slow (e.g. network) file systems must not block the main thread
+    QThreadPool *directoryListingPool()
+    {
+        static QThreadPool pool;
+        return &pool;
+    }
+
+    QStringList listDirectory(const QString &dirPath, const QDir::Filters filters)
+    {
+        QStringList entries;
+        QDirIterator it {dirPath, (QDir::NoDotAndDotDot | filters)};
+        while (it.hasNext() && (entries.size() < MAX_DIRECTORY_LISTING_SIZE))
+            entries.append(it.next());
+        return entries;
+    }
+
+    QByteArray filterDirectoryListing(const QStringList &entries, const QString &prefix, const int limit)
+    {
+        QJsonArray ret;
+        for (const QString &entry : entries)
+        {
+            if ((limit > 0) && (ret.size() >= limit))
+                break;
+
+            if (!prefix.isEmpty() && !QStringView(entry).sliced(entry.lastIndexOf(u'/') + 1).startsWith(prefix, Qt::CaseInsensitive))
+                continue;
+
+            ret.append(entry);
+        }
+        return QJsonDocument(ret).toJson(QJsonDocument::Compact);
+    }
+
+    void appendMetric(QByteArray &output, const QByteArray &name, const QByteArray &type, const QByteArray &help, const QByteArray &value)
+    {
+        if (!help.isEmpty())
+            output += "# HELP " + name + ' ' + help + '\n';
+        output += "# TYPE " + name + ' ' + type + '\n';
+        output += name + ' ' + value + '\n';
+    }
+
+    void appendTimings(QByteArray &output, const QByteArray &name, const QByteArray &help, const BitTorrent::OperationTimings &timings)
+    {
+        const QByteArray metricName = "qbittorrent_" + name + "_seconds";
+        output += "# HELP " + metricName + ' ' + help + '\n';
+        output += "# TYPE " + metricName + " summary\n";
+        output += metricName + "_count " + QByteArray::number(timings.count) + '\n';
+        output += metricName + "_sum " + QByteArray::number((timings.totalTime / 1e9), 'f', 9) + '\n';
+
+        appendMetric(output, ("qbittorrent_" + name + "_max_seconds"), "gauge", {}
+                , QByteArray::number((timings.maxTime / 1e9), 'f', 9));
+    }
+
+#ifdef QBT_USES_LIBTORRENT2
+    void appendDiskIOMetrics(QByteArray &output, const BitTorrent::DiskIOStatistics &stats)
+    {
+        const QByteArray jobNames[BitTorrent::DISK_JOB_TYPE_COUNT] = {"read", "write", "hash", "other"};
+
+        const QByteArray latencyName = "qbittorrent_disk_job_duration_seconds";
+        output += "# HELP " + latencyName + " Time from submitting disk job until it is completed.\n";
+        output += "# TYPE " + latencyName + " histogram\n";
+        for (int i = 0; i < BitTorrent::DISK_JOB_TYPE_COUNT; ++i)
+        {
+            const BitTorrent::DiskJobLatency &latency = stats.latency[i];
+            const QByteArray labels = "job=\"" + jobNames[i] + '"';
+
+            qint64 accumulated = 0;
+            for (std::size_t bucket = 0; bucket < BitTorrent::DiskJobLatency::BUCKET_BOUNDS.size(); ++bucket)
+            {
+                accumulated += latency.buckets[bucket];
+                const QByteArray bound = QByteArray::number((BitTorrent::DiskJobLatency::BUCKET_BOUNDS[bucket] / 1e6), 'g', 6);
+                output += latencyName + "_bucket{" + labels + ",le=\"" + bound + "\"} " + QByteArray::number(accumulated) + '\n';
+            }
+            output += latencyName + "_bucket{" + labels + ",le=\"+Inf\"} " + QByteArray::number(latency.count) + '\n';
+            output += latencyName + "_sum{" + labels + "} " + QByteArray::number((latency.totalTime / 1e9), 'f', 9) + '\n';
+            output += latencyName + "_count{" + labels + "} " + QByteArray::number(latency.count) + '\n';
+        }
+
+        appendMetric(output, "qbittorrent_disk_queue_depth", "gauge", "Number of submitted disk jobs which aren't completed yet."
+                , QByteArray::number(stats.queueDepth));
+        appendMetric(output, "qbittorrent_disk_queue_depth_max", "gauge", "Maximal number of uncompleted disk jobs since the session start."
+                , QByteArray::number(stats.maxQueueDepth));
+
+        output += "# HELP qbittorrent_disk_read_bytes_total Number of bytes read from disk per torrent.\n";
+        output += "# TYPE qbittorrent_disk_read_bytes_total counter\n";
+        for (auto it = stats.torrents.cbegin(); it != stats.torrents.cend(); ++it)
+            output += "qbittorrent_disk_read_bytes_total{torrent=\"" + it.key().toString().toLatin1() + "\"} " + QByteArray::number(it->bytesRead) + '\n';
+        output += "# HELP qbittorrent_disk_written_bytes_total Number of bytes written to disk per torrent.\n";
+        output += "# TYPE qbittorrent_disk_written_bytes_total counter\n";
+        for (auto it = stats.torrents.cbegin(); it != stats.torrents.cend(); ++it)
+            output += "qbittorrent_disk_written_bytes_total{torrent=\"" + it.key().toString().toLatin1() + "\"} " + QByteArray::number(it->bytesWritten) + '\n';
+    }
+#endif
+
+    template <typename Func>
+    void appendServiceMetric(QByteArray &output, const QByteArray &name, const QByteArray &type, const QByteArray &help
+            , const QHash<Net::ServiceID, Net::ServiceStatistics> &statistics, Func &&value)
+    {
+        const QByteArray metricName = "qbittorrent_download_" + name;
+        output += "# HELP " + metricName + ' ' + help + '\n';
+        output += "# TYPE " + metricName + ' ' + type + '\n';
+        for (auto it = statistics.cbegin(); it != statistics.cend(); ++it)
+        {
+            QByteArray host = it.key().hostName.toUtf8() + ':' + QByteArray::number(it.key().port);
+            host.replace('\\', "\\\\").replace('"', "\\\"");
+            output += metricName + "{host=\"" + host + "\"} " + value(it.value()) + '\n';
+        }
+    }
+}
+
 void AppController::webapiVersionAction()
 {
     setResult(API_VERSION.toString());
@@ -100,11 +311,83 @@ void AppController::buildInfoAction()
         {u"openssl"_s, Utils::Misc::opensslVersionString()},
         {u"zlib"_s, Utils::Misc::zlibVersionString()},
         {u"bitness"_s, (QT_POINTER_SIZE * 8)},
-        {u"platform"_s, platformName}
+        {u"platform"_s, platformName},
+#ifdef QBT_USES_IO_URING
+        {u"io_uring"_s, true}
+#else
+        {u"io_uring"_s, false}
+#endif
     };
     setResult(versions);
 }
 
+// Counters are taken from the latest session stats, so no additional work is requested from libtorrent
+void AppController::metricsAction()
+{
+    const auto *session = BitTorrent::Session::instance();
+    const BitTorrent::SessionMetrics metrics = session->metrics();
+
+    QByteArray output;
+    output.reserve(64 * 1024);
+
+    for (const BitTorrent::SessionCounter &counter : metrics.counters)
+    {
+        // e.g. "net.sent_bytes" -> "libtorrent_net_sent_bytes_total"
+        QByteArray name = "libtorrent_" + counter.name.toLatin1().replace('.', '_');
+        if (!counter.isGauge)
+            name += "_total";
+        appendMetric(output, name, (counter.isGauge ? "gauge" : "counter"), {}, QByteArray::number(counter.value));
+    }
+
+    appendMetric(output, "qbittorrent_torrents", "gauge", "Number of torrents in the session."
+            , QByteArray::number(session->torrentsCount()));
+
+    appendTimings(output, "alerts_processing", "Time spent on handling libtorrent alerts.", metrics.alertsProcessing);
+    appendTimings(output, "refresh", "Time spent on applying torrent status updates.", metrics.refresh);
+    appendTimings(output, "resume_data_saving", "Time from requesting resume data until it is received.", metrics.resumeDataSaving);
+    appendTimings(output, "maindata_sync", "Time spent on generating WebAPI main data.", SyncController::maindataSyncTimings());
+
+    const Http::TLSHandshakeStatistics handshakes = Http::Server::tlsHandshakeStatistics();
+    appendTimings(output, "webui_tls_handshake", "Time spent on succeeded TLS handshakes of WebUI connections."
+            , {.count = handshakes.count, .totalTime = handshakes.totalTime, .maxTime = handshakes.maxTime});
+    appendMetric(output, "qbittorrent_webui_tls_handshake_failures_total", "counter", "Number of failed TLS handshakes of WebUI connections."
+            , QByteArray::number(handshakes.failedCount));
+#ifdef QBT_USES_LIBTORRENT2
+    appendDiskIOMetrics(output, metrics.diskIO);
+#endif
+
+    const QHash<Net::ServiceID, Net::ServiceStatistics> downloadStatistics = Net::DownloadManager::instance()->serviceStatistics();
+    appendServiceMetric(output, "requests_active", "gauge", "Number of running non-torrent downloads.", downloadStatistics
+            , [](const Net::ServiceStatistics &stats) { return QByteArray::number(stats.activeRequests); });
+    appendServiceMetric(output, "requests_waiting", "gauge", "Number of queued non-torrent downloads.", downloadStatistics
+            , [](const Net::ServiceStatistics &stats) { return QByteArray::number(stats.waitingRequests); });
+    appendServiceMetric(output, "requests_total", "counter", "Number of finished non-torrent downloads.", downloadStatistics
+            , [](const Net::ServiceStatistics &stats) { return QByteArray::number(stats.finishedRequests); });
+    appendServiceMetric(output, "latency_seconds", "gauge", "Average time until reply of non-torrent download is finished.", downloadStatistics
+            , [](const Net::ServiceStatistics &stats) { return QByteArray::number((stats.averageLatency.count() / 1e3), 'f', 3); });
+
+    setResult(output, CONTENT_TYPE_METRICS);
+}
+
+// Returns the estimated memory usage of the major data structures by subsystem:
+//  - "name": name of the data structure, e.g. "torrents.files"
+//  - "count": number of items
+//  - "bytes": estimated size of the items
+void AppController::memoryUsageAction()
+{
+    QJsonArray result;
+    for (const MemoryUsage::Entry &entry : asConst(MemoryUsage::report()))
+    {
+        result.append(QJsonObject {
+            {u"name"_s, entry.name},
+            {u"count"_s, entry.count},
+            {u"bytes"_s, entry.bytes}
+        });
+    }
+
+    setResult(result);
+}
+
 void AppController::shutdownAction()
 {
     // Special handling for shutdown, we
@@ -118,6 +401,15 @@ void AppController::shutdownAction()
 
 void AppController::preferencesAction()
 {
+    PreferencesCache &cache = preferencesCache();
+    const QString etag = preferencesETag();
+    setResultETag(etag);
+    if (cache.etag == etag)
+    {
+        setResult(cache.data);
+        return;
+    }
+
     const auto *pref = Preferences::instance();
     const auto *session = BitTorrent::Session::instance();
 
@@ -200,6 +492,8 @@ void AppController::preferencesAction()
     // Run an external program on torrent finished
     data[u"autorun_enabled"_s] = pref->isAutoRunOnTorrentFinishedEnabled();
     data[u"autorun_program"_s] = pref->getAutoRunOnTorrentFinishedProgram();
+    data[u"autorun_max_concurrent_programs"_s] = pref->autoRunMaxConcurrentPrograms();
+    data[u"autorun_batch_mode_enabled"_s] = pref->isAutoRunBatchModeEnabled();
 
     // Connection
     // Listening Port
@@ -229,6 +523,10 @@ void AppController::preferencesAction()
     Net::ProxyConfiguration proxyConf = proxyManager->proxyConfiguration();
     data[u"auto_ban_unknown_peer"_s] = session->isAutoBanUnknownPeerEnabled();
     data[u"auto_ban_bt_player_peer"_s] = session->isAutoBanBTPlayerPeerEnabled();
+    data[u"auto_ban_fake_progress_peer"_s] = session->isAutoBanFakeProgressPeerEnabled();
+    data[u"fake_progress_peer_min_upload"_s] = session->fakeProgressPeerMinUpload();
+    data[u"fake_progress_peer_min_progress"_s] = session->fakeProgressPeerMinProgress();
+    data[u"banned_peers_history_days"_s] = session->bannedPeersHistoryDays();
     data[u"proxy_type"_s] = Utils::String::fromEnum(proxyConf.type);
     data[u"proxy_ip"_s] = proxyConf.ip;
     data[u"proxy_port"_s] = proxyConf.port;
@@ -246,6 +544,9 @@ void AppController::preferencesAction()
     data[u"ip_filter_enabled"_s] = session->isIPFilteringEnabled();
     data[u"ip_filter_path"_s] = session->IPFilterFile().toString();
     data[u"ip_filter_trackers"_s] = session->isTrackerFilteringEnabled();
+    data[u"ip_filter_subscriptions"_s] = session->IPFilterSubscriptions().join(u'\n');
+    data[u"ip_filter_subscriptions_refresh_interval"_s] = session->IPFilterSubscriptionsRefreshInterval();
+    data[u"blocked_countries"_s] = session->blockedCountries().join(u',');
     data[u"banned_IPs"_s] = session->bannedIPs().join(u'\n');
     data[u"shadow_ban_enabled"_s] = session->isShadowBanEnabled();
     data[u"shadow_banned_IPs"_s] = session->shadowBannedIPs().join(u'\n');
@@ -269,6 +570,8 @@ void AppController::preferencesAction()
     data[u"schedule_to_hour"_s] = end_time.hour();
     data[u"schedule_to_min"_s] = end_time.minute();
     data[u"scheduler_days"_s] = static_cast<int>(pref->getSchedulerDays());
+    data[u"scheduler_profiles"_s] = pref->getSchedulerProfiles();
+    data[u"scheduler_transition_time"_s] = pref->getSchedulerTransitionTime();
 
     // Bittorrent
     // Privacy
@@ -282,6 +585,7 @@ void AppController::preferencesAction()
     data[u"auto_update_trackers_enabled"_s] = session->isAutoUpdateTrackersEnabled();
     data[u"customize_trackers_list_url"_s] = pref->customizeTrackersListUrl();
     data[u"public_trackers"_s] = session->publicTrackers();
+    data[u"max_public_trackers_per_torrent"_s] = session->maxPublicTrackersPerTorrent();
     // Torrent Queueing
     data[u"queueing_enabled"_s] = session->isQueueingSystemEnabled();
     data[u"max_active_downloads"_s] = session->maxActiveDownloads();
@@ -312,8 +616,10 @@ void AppController::preferencesAction()
     data[u"use_https"_s] = pref->isWebUIHttpsEnabled();
     data[u"web_ui_https_cert_path"_s] = pref->getWebUIHttpsCertificatePath().toString();
     data[u"web_ui_https_key_path"_s] = pref->getWebUIHttpsKeyPath().toString();
+    data[u"web_ui_https_http2"_s] = pref->isWebUIHttp2Enabled();
     // Authentication
     data[u"web_ui_username"_s] = pref->getWebUIUsername();
+    data[u"web_ui_api_key_enabled"_s] = !pref->getWebUIAPIKeyHash().isEmpty();
     data[u"bypass_local_auth"_s] = !pref->isWebUILocalAuthEnabled();
     data[u"bypass_auth_subnet_whitelist_enabled"_s] = pref->isWebUIAuthSubnetWhitelistEnabled();
     QStringList authSubnetWhitelistStringList;
@@ -323,6 +629,7 @@ void AppController::preferencesAction()
     data[u"web_ui_max_auth_fail_count"_s] = pref->getWebUIMaxAuthFailCount();
     data[u"web_ui_ban_duration"_s] = static_cast<int>(pref->getWebUIBanDuration().count());
     data[u"web_ui_session_timeout"_s] = pref->getWebUISessionTimeout();
+    data[u"web_ui_max_connections"_s] = pref->getWebUIMaxConnections();
     // Use alternative WebUI
     data[u"alternative_webui_enabled"_s] = pref->isAltWebUIEnabled();
     data[u"alternative_webui_path"_s] = pref->getWebUIRootFolder().toString();
@@ -357,10 +664,30 @@ void AppController::preferencesAction()
     // qBitorrent preferences
     // Resume data storage type
     data[u"resume_data_storage_type"_s] = Utils::String::fromEnum(session->resumeDataStorageType());
+    // Store fastresume files in subfolders
+    data[u"resume_data_storage_sharded"_s] = session->isResumeDataStorageSharded();
+    // Restore stopped completed torrents after startup
+    data[u"defer_stopped_torrents_loading"_s] = session->isDeferredStoppedTorrentsLoadingEnabled();
+    data[u"trusted_resume_data"_s] = session->isTrustedResumeDataEnabled();
+    // SQLite database transaction batch size
+    data[u"resume_data_storage_batch_size"_s] = session->resumeDataStorageBatchSize();
+    // SQLite database transaction batch latency
+    data[u"resume_data_storage_batch_latency"_s] = session->resumeDataStorageBatchLatency();
     // Torrent content removing mode
     data[u"torrent_content_remove_option"_s] = Utils::String::fromEnum(session->torrentContentRemoveOption());
+    // Maximum concurrent torrent moves per device
+    data[u"max_active_move_storage_jobs_per_device"_s] = session->maxActiveMoveStorageJobsPerDevice();
+    // Maximum concurrent torrent checks per device
+    data[u"max_active_checking_torrents_per_device"_s] = session->maxActiveCheckingTorrentsPerDevice();
+    // Maximum concurrent metadata downloads of queued torrents
+    data[u"max_active_metadata_downloads"_s] = session->maxActiveMetadataDownloads();
+    // Metadata download timeout of queued torrents
+    data[u"metadata_download_timeout"_s] = session->metadataDownloadTimeout();
     // Physical memory (RAM) usage limit
     data[u"memory_working_set_limit"_s] = app()->memoryWorkingSetLimit();
+    // Main thread stall watchdog
+    data[u"stall_watchdog_enabled"_s] = app()->isStallWatchdogEnabled();
+    data[u"stall_watchdog_threshold"_s] = app()->stallWatchdogThreshold();
     // Current network interface
     data[u"current_network_interface"_s] = session->networkInterface();
     // Current network interface name
@@ -381,6 +708,8 @@ void AppController::preferencesAction()
     data[u"resolve_peer_countries"_s] = pref->resolvePeerCountries();
     // Reannounce to all trackers when ip/port changed
     data[u"reannounce_when_address_changed"_s] = session->isReannounceWhenAddressChangedEnabled();
+    data[u"announce_ramp_rate"_s] = session->announceRampRate();
+    data[u"announce_jitter"_s] = session->announceJitter();
     // Embedded tracker
     data[u"enable_embedded_tracker"_s] = session->isTrackerEnabled();
     data[u"embedded_tracker_port"_s] = pref->getTrackerPort();
@@ -389,8 +718,16 @@ void AppController::preferencesAction()
     data[u"mark_of_the_web"_s] = pref->isMarkOfTheWebEnabled();
     // Ignore SSL errors
     data[u"ignore_ssl_errors"_s] = pref->isIgnoreSSLErrors();
+    // Download connections per host
+    data[u"download_connections_per_host"_s] = pref->getDownloadConnectionsPerHost();
     // Python executable path
     data[u"python_executable_path"_s] = pref->getPythonExecutablePath().toString();
+    // Search plugins
+    data[u"search_max_parallel_plugins"_s] = pref->searchMaxParallelPlugins();
+    data[u"search_plugin_timeout"_s] = pref->searchPluginTimeout();
+    // RSS parsing threads
+    data[u"rss_parsing_threads"_s] = RSS::Session::instance()->parsingThreadCount();
+    data[u"rss_duplicate_articles_retention"_s] = RSS::AutoDownloader::instance()->duplicateArticlesRetention();
 
     // libtorrent preferences
     // Bdecode depth limit
@@ -412,6 +749,11 @@ void AppController::preferencesAction()
     data[u"disk_queue_size"_s] = session->diskQueueSize();
     // Disk IO Type
     data[u"disk_io_type"_s] = static_cast<int>(session->diskIOType());
+    // Disk IO scheduling
+    data[u"disk_io_jobs_per_device"_s] = session->diskIOJobsPerDevice();
+    data[u"disk_io_reads_per_hash_job"_s] = session->diskIOReadsPerHashJob();
+    // Disk read cache
+    data[u"disk_read_cache_size"_s] = session->diskReadCacheSize();
     // Disk IO read mode
     data[u"disk_io_read_mode"_s] = static_cast<int>(session->diskIOReadMode());
     // Disk IO write mode
@@ -467,11 +809,14 @@ void AppController::preferencesAction()
     data[u"peer_turnover"_s] = session->peerTurnover();
     data[u"peer_turnover_cutoff"_s] = session->peerTurnoverCutoff();
     data[u"peer_turnover_interval"_s] = session->peerTurnoverInterval();
+    data[u"connections_rebalancing"_s] = session->isConnectionsRebalancingEnabled();
     // Maximum outstanding requests to a single peer
     data[u"request_queue_size"_s] = session->requestQueueSize();
     // DHT bootstrap nodes
     data[u"dht_bootstrap_nodes"_s] = session->getDHTBootstrapNodes();
 
+    cache.etag = etag;
+    cache.data = data;
     setResult(data);
 }
 
@@ -661,6 +1006,10 @@ void AppController::setPreferencesAction()
         pref->setAutoRunOnTorrentFinishedEnabled(it.value().toBool());
     if (hasKey(u"autorun_program"_s))
         pref->setAutoRunOnTorrentFinishedProgram(it.value().toString());
+    if (hasKey(u"autorun_max_concurrent_programs"_s))
+        pref->setAutoRunMaxConcurrentPrograms(it.value().toInt());
+    if (hasKey(u"autorun_batch_mode_enabled"_s))
+        pref->setAutoRunBatchModeEnabled(it.value().toBool());
 
     // Connection
     // Listening Port
@@ -742,12 +1091,26 @@ void AppController::setPreferencesAction()
         session->setIPFilterFile(Path(it.value().toString()));
     if (hasKey(u"ip_filter_trackers"_s))
         session->setTrackerFilteringEnabled(it.value().toBool());
+    if (hasKey(u"ip_filter_subscriptions"_s))
+        session->setIPFilterSubscriptions(it.value().toString().split(u'\n', Qt::SkipEmptyParts));
+    if (hasKey(u"ip_filter_subscriptions_refresh_interval"_s))
+        session->setIPFilterSubscriptionsRefreshInterval(it.value().toInt());
+    if (hasKey(u"blocked_countries"_s))
+        session->setBlockedCountries(it.value().toString().split(u',', Qt::SkipEmptyParts));
     if (hasKey(u"banned_IPs"_s))
         session->setBannedIPs(it.value().toString().split(u'\n', Qt::SkipEmptyParts));
     if (hasKey(u"auto_ban_unknown_peer"_s))
         session->setAutoBanUnknownPeer(it.value().toBool());
     if (hasKey(u"auto_ban_bt_player_peer"_s))
         session->setAutoBanBTPlayerPeer(it.value().toBool());
+    if (hasKey(u"auto_ban_fake_progress_peer"_s))
+        session->setAutoBanFakeProgressPeer(it.value().toBool());
+    if (hasKey(u"fake_progress_peer_min_upload"_s))
+        session->setFakeProgressPeerMinUpload(it.value().toInt());
+    if (hasKey(u"fake_progress_peer_min_progress"_s))
+        session->setFakeProgressPeerMinProgress(it.value().toInt());
+    if (hasKey(u"banned_peers_history_days"_s))
+        session->setBannedPeersHistoryDays(it.value().toInt());
     if (hasKey(u"shadow_ban"_s))
         session->setShadowBan(it.value().toBool());
     if (hasKey(u"shadow_banned_IPs"_s))
@@ -780,6 +1143,10 @@ void AppController::setPreferencesAction()
         pref->setSchedulerEndTime(QTime(m[u"schedule_to_hour"_s].toInt(), m[u"schedule_to_min"_s].toInt()));
     if (hasKey(u"scheduler_days"_s))
         pref->setSchedulerDays(static_cast<Scheduler::Days>(it.value().toInt()));
+    if (hasKey(u"scheduler_profiles"_s))
+        pref->setSchedulerProfiles(BandwidthProfile::entriesToString(BandwidthProfile::parseEntries(it.value().toString())));
+    if (hasKey(u"scheduler_transition_time"_s))
+        pref->setSchedulerTransitionTime(std::clamp(it.value().toInt(), 0, 120));
 
     // Bittorrent
     // Privacy
@@ -861,6 +1228,8 @@ void AppController::setPreferencesAction()
         session->setAutoUpdateTrackersEnabled(it.value().toBool());
     if (hasKey(u"customize_trackers_list_url"_s))
         pref->setCustomizeTrackersListUrl(it.value().toString());
+    if (hasKey(u"max_public_trackers_per_torrent"_s))
+        session->setMaxPublicTrackersPerTorrent(it.value().toInt());
 
     // WebUI
     // HTTP Server
@@ -878,6 +1247,8 @@ void AppController::setPreferencesAction()
         pref->setWebUIHttpsCertificatePath(Path(it.value().toString()));
     if (hasKey(u"web_ui_https_key_path"_s))
         pref->setWebUIHttpsKeyPath(Path(it.value().toString()));
+    if (hasKey(u"web_ui_https_http2"_s))
+        pref->setWebUIHttp2Enabled(it.value().toBool());
     // Authentication
     if (hasKey(u"web_ui_username"_s))
         pref->setWebUIUsername(it.value().toString());
@@ -898,6 +1269,8 @@ void AppController::setPreferencesAction()
         pref->setWebUIBanDuration(std::chrono::seconds {it.value().toInt()});
     if (hasKey(u"web_ui_session_timeout"_s))
         pref->setWebUISessionTimeout(it.value().toInt());
+    if (hasKey(u"web_ui_max_connections"_s))
+        pref->setWebUIMaxConnections(it.value().toInt());
     // Use alternative WebUI
     if (hasKey(u"alternative_webui_enabled"_s))
         pref->setAltWebUIEnabled(it.value().toBool());
@@ -954,12 +1327,44 @@ void AppController::setPreferencesAction()
     // Resume data storage type
     if (hasKey(u"resume_data_storage_type"_s))
         session->setResumeDataStorageType(Utils::String::toEnum(it.value().toString(), BitTorrent::ResumeDataStorageType::Legacy));
+    // Store fastresume files in subfolders
+    if (hasKey(u"resume_data_storage_sharded"_s))
+        session->setResumeDataStorageSharded(it.value().toBool());
+    // Restore stopped completed torrents after startup
+    if (hasKey(u"defer_stopped_torrents_loading"_s))
+        session->setDeferredStoppedTorrentsLoadingEnabled(it.value().toBool());
+    // Trust fastresume data after clean shutdown
+    if (hasKey(u"trusted_resume_data"_s))
+        session->setTrustedResumeDataEnabled(it.value().toBool());
+    // SQLite database transaction batch size
+    if (hasKey(u"resume_data_storage_batch_size"_s))
+        session->setResumeDataStorageBatchSize(it.value().toInt());
+    // SQLite database transaction batch latency
+    if (hasKey(u"resume_data_storage_batch_latency"_s))
+        session->setResumeDataStorageBatchLatency(it.value().toInt());
     // Torrent content removing mode
     if (hasKey(u"torrent_content_remove_option"_s))
         session->setTorrentContentRemoveOption(Utils::String::toEnum(it.value().toString(), BitTorrent::TorrentContentRemoveOption::MoveToTrash));
+    // Maximum concurrent torrent moves per device
+    if (hasKey(u"max_active_move_storage_jobs_per_device"_s))
+        session->setMaxActiveMoveStorageJobsPerDevice(it.value().toInt());
+    // Maximum concurrent torrent checks per device
+    if (hasKey(u"max_active_checking_torrents_per_device"_s))
+        session->setMaxActiveCheckingTorrentsPerDevice(it.value().toInt());
+    // Maximum concurrent metadata downloads of queued torrents
+    if (hasKey(u"max_active_metadata_downloads"_s))
+        session->setMaxActiveMetadataDownloads(it.value().toInt());
+    // Metadata download timeout of queued torrents
+    if (hasKey(u"metadata_download_timeout"_s))
+        session->setMetadataDownloadTimeout(it.value().toInt());
     // Physical memory (RAM) usage limit
     if (hasKey(u"memory_working_set_limit"_s))
         app()->setMemoryWorkingSetLimit(it.value().toInt());
+    // Main thread stall watchdog
+    if (hasKey(u"stall_watchdog_enabled"_s))
+        app()->setStallWatchdogEnabled(it.value().toBool());
+    if (hasKey(u"stall_watchdog_threshold"_s))
+        app()->setStallWatchdogThreshold(it.value().toInt());
     // Current network interface
     if (hasKey(u"current_network_interface"_s))
     {
@@ -1003,6 +1408,10 @@ void AppController::setPreferencesAction()
     // Reannounce to all trackers when ip/port changed
     if (hasKey(u"reannounce_when_address_changed"_s))
         session->setReannounceWhenAddressChangedEnabled(it.value().toBool());
+    if (hasKey(u"announce_ramp_rate"_s))
+        session->setAnnounceRampRate(it.value().toInt());
+    if (hasKey(u"announce_jitter"_s))
+        session->setAnnounceJitter(it.value().toInt());
     // Embedded tracker
     if (hasKey(u"embedded_tracker_port"_s))
         pref->setTrackerPort(it.value().toInt());
@@ -1016,9 +1425,22 @@ void AppController::setPreferencesAction()
     // Ignore SLL errors
     if (hasKey(u"ignore_ssl_errors"_s))
         pref->setIgnoreSSLErrors(it.value().toBool());
+    // Download connections per host
+    if (hasKey(u"download_connections_per_host"_s))
+        pref->setDownloadConnectionsPerHost(it.value().toInt());
     // Python executable path
     if (hasKey(u"python_executable_path"_s))
         pref->setPythonExecutablePath(Path(it.value().toString()));
+    // Search plugins
+    if (hasKey(u"search_max_parallel_plugins"_s))
+        pref->setSearchMaxParallelPlugins(it.value().toInt());
+    if (hasKey(u"search_plugin_timeout"_s))
+        pref->setSearchPluginTimeout(it.value().toInt());
+    // RSS parsing threads
+    if (hasKey(u"rss_parsing_threads"_s))
+        RSS::Session::instance()->setParsingThreadCount(it.value().toInt());
+    if (hasKey(u"rss_duplicate_articles_retention"_s))
+        RSS::AutoDownloader::instance()->setDuplicateArticlesRetention(it.value().toInt());
 
     // libtorrent preferences
     // Bdecode depth limit
@@ -1050,6 +1472,14 @@ void AppController::setPreferencesAction()
     // Disk IO Type
     if (hasKey(u"disk_io_type"_s))
         session->setDiskIOType(static_cast<BitTorrent::DiskIOType>(it.value().toInt()));
+    // Disk IO scheduling
+    if (hasKey(u"disk_io_jobs_per_device"_s))
+        session->setDiskIOJobsPerDevice(it.value().toInt());
+    if (hasKey(u"disk_io_reads_per_hash_job"_s))
+        session->setDiskIOReadsPerHashJob(it.value().toInt());
+    // Disk read cache
+    if (hasKey(u"disk_read_cache_size"_s))
+        session->setDiskReadCacheSize(it.value().toInt());
     // Disk IO read mode
     if (hasKey(u"disk_io_read_mode"_s))
         session->setDiskIOReadMode(static_cast<BitTorrent::DiskIOReadMode>(it.value().toInt()));
@@ -1140,6 +1570,8 @@ void AppController::setPreferencesAction()
         session->setPeerTurnoverCutoff(it.value().toInt());
     if (hasKey(u"peer_turnover_interval"_s))
         session->setPeerTurnoverInterval(it.value().toInt());
+    if (hasKey(u"connections_rebalancing"_s))
+        session->setConnectionsRebalancingEnabled(it.value().toBool());
     // Maximum outstanding requests to a single peer
     if (hasKey(u"request_queue_size"_s))
         session->setRequestQueueSize(it.value().toInt());
@@ -1161,7 +1593,56 @@ void AppController::sendTestEmailAction()
     app()->sendTestEmail();
 }
 
+// Generates a new API key and replaces the existing one.
+// Only the key hash is stored so the key is returned to the user just once.
+void AppController::rotateAPIKeyAction()
+{
+    const quint32 tmp[] =
+    {Utils::Random::rand(), Utils::Random::rand(), Utils::Random::rand()
+            , Utils::Random::rand(), Utils::Random::rand(), Utils::Random::rand()
+            , Utils::Random::rand(), Utils::Random::rand()};
+    const QByteArray apiKey = "qbt_" + QByteArray::fromRawData(reinterpret_cast<const char *>(tmp), sizeof(tmp))
+            .toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+
+    auto *pref = Preferences::instance();
+    pref->setWebUIAPIKeyHash(QCryptographicHash::hash(apiKey, QCryptographicHash::Sha256).toHex());
+    pref->apply();
+
+    setResult(QString::fromLatin1(apiKey));
+}
+
+void AppController::deleteAPIKeyAction()
+{
+    auto *pref = Preferences::instance();
+    pref->setWebUIAPIKeyHash({});
+    pref->apply();
+}
+
+// Starts recording of a new trace or stops recording
+void AppController::setTracingAction()
+{
+    requireParams({u"enabled"_s});
+
+    const std::optional<bool> enabled = Utils::String::parseBool(params()[u"enabled"_s]);
+    if (!enabled)
+        throw APIError(APIErrorType::BadParams, tr("Invalid value for \"enabled\" parameter"));
+
+    if (*enabled && !Tracing::isEnabled())
+        Tracing::clear();
+    Tracing::setEnabled(*enabled);
+}
 
+void AppController::traceAction()
+{
+    setResult(Tracing::toChromeTraceJson(), u"application/json"_s, u"qbittorrent-trace.json"_s);
+}
+
+// Lists the content of the directory
+// Params:
+//   - dirPath (string): absolute path of the directory
+//   - mode (string): "all" (default), "dirs" or "files"
+//   - prefix (string): if set, only the entries which names start with it are listed
+//   - limit (int): if set, the number of the listed entries doesn't exceed it
 void AppController::getDirectoryContentAction()
 {
     requireParams({u"dirPath"_s});
@@ -1189,11 +1670,38 @@ void AppController::getDirectoryContentAction()
         throw APIError(APIErrorType::BadParams, tr("Invalid mode, allowed values: %1").arg(u"all, dirs, files"_s));
     };
 
-    QJsonArray ret;
-    QDirIterator it {dirPath, (QDir::NoDotAndDotDot | parseDirectoryContentMode(visibility))};
-    while (it.hasNext())
-        ret.append(it.next());
-    setResult(ret);
+    const QDir::Filters filters = parseDirectoryContentMode(visibility);
+    const QString prefix = params().value(u"prefix"_s);
+
+    int limit = 0;
+    if (const QString limitParam = params().value(u"limit"_s); !limitParam.isEmpty())
+    {
+        bool ok = false;
+        limit = limitParam.toInt(&ok);
+        if (!ok || (limit < 0))
+            throw APIError(APIErrorType::BadParams, tr("Invalid value for \"limit\" parameter"));
+    }
+
+    if (const QStringList *entries = findCachedDirectoryListing(dirPath, filters))
+    {
+        setResult(filterDirectoryListing(*entries, prefix, limit), Http::CONTENT_TYPE_JSON);
+        return;
+    }
+
+    // the listing is sent once it is ready, without blocking the request processing
+    const auto stream = std::make_shared<Http::ResponseStream>();
+    directoryListingPool()->start([stream, dirPath, filters, prefix, limit]
+    {
+        QStringList entries = listDirectory(dirPath, filters);
+        stream->write(filterDirectoryListing(entries, prefix, limit));
+        stream->close();
+
+        QMetaObject::invokeMethod(qApp, [listing = DirectoryListing {dirPath, filters, std::move(entries), std::chrono::steady_clock::now()}]
+        {
+            cacheDirectoryListing(listing);
+        });
+    });
+    setResult({}, stream, Http::CONTENT_TYPE_JSON);
 }
 
 void AppController::networkInterfaceListAction()
@@ -44,11 +44,17 @@ private slots:
     void webapiVersionAction();
     void versionAction();
     void buildInfoAction();
+    void metricsAction();
+    void memoryUsageAction();
     void shutdownAction();
     void preferencesAction();
     void setPreferencesAction();
     void defaultSavePathAction();
     void sendTestEmailAction();
+    void rotateAPIKeyAction();
+    void deleteAPIKeyAction();
+    void setTracingAction();
+    void traceAction();
     void getDirectoryContentAction();
 
     void networkInterfaceListAction();
@@ -32,9 +32,11 @@
 #include <QJsonObject>
 #include <QVector>
 
+#include "base/bittorrent/bannedpeershistory.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/utils/string.h"
+#include "apierror.h"
 
 const QString KEY_LOG_ID = u"id"_s;
 const QString KEY_LOG_TIMESTAMP = u"timestamp"_s;
@@ -43,6 +45,13 @@ const QString KEY_LOG_MSG_MESSAGE = u"message"_s;
 const QString KEY_LOG_PEER_IP = u"ip"_s;
 const QString KEY_LOG_PEER_BLOCKED = u"blocked"_s;
 const QString KEY_LOG_PEER_REASON = u"reason"_s;
+const QString KEY_BANNED_PEER_CLIENT = u"client"_s;
+const QString KEY_BANNED_PEER_PEER_ID = u"peer_id"_s;
+const QString KEY_BANNED_PEER_TAG = u"tag"_s;
+const QString KEY_BANNED_PEER_HITS = u"hits"_s;
+const QString KEY_BANNED_PEER_LAST_BANNED = u"last_banned"_s;
+
+LogController::~LogController() = default;
 
 // Returns the log in JSON format.
 // The return value is an array of dictionaries.
@@ -61,10 +70,11 @@ void LogController::mainAction()
 {
     using Utils::String::parseBool;
 
-    const bool isNormal = parseBool(params()[u"normal"_s]).value_or(true);
-    const bool isInfo = parseBool(params()[u"info"_s]).value_or(true);
-    const bool isWarning = parseBool(params()[u"warning"_s]).value_or(true);
-    const bool isCritical = parseBool(params()[u"critical"_s]).value_or(true);
+    Log::MsgTypes types;
+    types.setFlag(Log::NORMAL, parseBool(params()[u"normal"_s]).value_or(true));
+    types.setFlag(Log::INFO, parseBool(params()[u"info"_s]).value_or(true));
+    types.setFlag(Log::WARNING, parseBool(params()[u"warning"_s]).value_or(true));
+    types.setFlag(Log::CRITICAL, parseBool(params()[u"critical"_s]).value_or(true));
 
     bool ok = false;
     int lastKnownId = params()[u"last_known_id"_s].toInt(&ok);
@@ -74,12 +84,10 @@ void LogController::mainAction()
     Logger *const logger = Logger::instance();
     QJsonArray msgList;
 
-    for (const Log::Msg &msg : asConst(logger->getMessages(lastKnownId)))
+    // the messages are iterated in place, only the requested ones are serialized
+    for (const Log::Msg &msg : logger->messages(lastKnownId))
     {
-        if (!(((msg.type == Log::NORMAL) && isNormal)
-              || ((msg.type == Log::INFO) && isInfo)
-              || ((msg.type == Log::WARNING) && isWarning)
-              || ((msg.type == Log::CRITICAL) && isCritical)))
+        if (!types.testFlag(msg.type))
             continue;
 
         msgList.append(QJsonObject
@@ -114,7 +122,7 @@ void LogController::peersAction()
     Logger *const logger = Logger::instance();
     QJsonArray peerList;
 
-    for (const Log::Peer &peer : asConst(logger->getPeers(lastKnownId)))
+    for (const Log::Peer &peer : logger->peers(lastKnownId))
     {
         peerList.append(QJsonObject
         {
@@ -128,3 +136,62 @@ void LogController::peersAction()
 
     setResult(peerList);
 }
+
+// Returns the history of banned peers in JSON format, starting from the most recently banned one.
+// The return value is an array of dictionaries.
+// The dictionary keys are:
+//   - "id": id of the record
+//   - "ip": IP of the peer
+//   - "client": client name of the peer
+//   - "peer_id": first 8 bytes of the peer ID, hex encoded
+//   - "tag": rule that banned the peer
+//   - "hits": how many times the peer was banned
+//   - "last_banned": seconds since epoch
+// GET params:
+//   - tag (string): only include peers banned by this rule
+//   - client (string): only include peers with this client name
+//   - limit (int): maximum number of records (default 100, at most 1000)
+//   - last_id, last_banned (int): continue after this record of the previous page
+void LogController::bannedPeersAction()
+{
+    const BitTorrent::BannedPeersHistory::Filter filter {
+        .tag = params()[u"tag"_s],
+        .client = params()[u"client"_s]
+    };
+
+    BitTorrent::BannedPeersHistory::Cursor cursor;
+    bool idOk = false;
+    bool lastBannedOk = false;
+    const qint64 lastID = params()[u"last_id"_s].toLongLong(&idOk);
+    const qint64 lastBanned = params()[u"last_banned"_s].toLongLong(&lastBannedOk);
+    if (idOk != lastBannedOk)
+        throw APIError(APIErrorType::BadParams, tr("Both \"last_id\" and \"last_banned\" must be specified"));
+    if (idOk)
+        cursor = {.lastBanned = lastBanned, .id = lastID};
+
+    bool ok = false;
+    int limit = params()[u"limit"_s].toInt(&ok);
+    if (!ok)
+        limit = 100;
+
+    if (!m_bannedPeersHistory)
+        m_bannedPeersHistory = std::make_unique<BitTorrent::BannedPeersHistory>();
+
+    const QList<BitTorrent::BannedPeerRecord> records = m_bannedPeersHistory->fetch(filter, cursor, limit);
+    QJsonArray peerList;
+    for (const BitTorrent::BannedPeerRecord &record : records)
+    {
+        peerList.append(QJsonObject
+        {
+            {KEY_LOG_ID, record.id},
+            {KEY_LOG_PEER_IP, record.ip},
+            {KEY_BANNED_PEER_CLIENT, record.client},
+            {KEY_BANNED_PEER_PEER_ID, QString::fromLatin1(record.peerIDPrefix.toHex())},
+            {KEY_BANNED_PEER_TAG, record.tag},
+            {KEY_BANNED_PEER_HITS, record.hits},
+            {KEY_BANNED_PEER_LAST_BANNED, record.lastBanned.toSecsSinceEpoch()}
+        });
+    }
+
+    setResult(peerList);
+}
@@ -28,8 +28,15 @@
 
 #pragma once
 
+#include <memory>
+
 #include "apicontroller.h"
 
+namespace BitTorrent
+{
+    class BannedPeersHistory;
+}
+
 class LogController final : public APIController
 {
     Q_OBJECT
@@ -37,8 +44,13 @@ class LogController final : public APIController
 
 public:
     using APIController::APIController;
+    ~LogController() override;
 
 private slots:
     void mainAction();
     void peersAction();
+    void bannedPeersAction();
+
+private:
+    std::unique_ptr<BitTorrent::BannedPeersHistory> m_bannedPeersHistory;
 };
@@ -32,6 +32,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QUuid>
 #include <QVector>
 
 #include "base/rss/rss_article.h"
@@ -45,6 +46,23 @@
 
 using Utils::String::parseBool;
 
+namespace
+{
+    QJsonObject folderChangesToJsonObject(const RSS::Folder *folder, const QHash<QUuid, RSS::ArticleChanges> &changes)
+    {
+        QJsonObject jsonObj;
+        for (const RSS::Item *item : asConst(folder->items()))
+        {
+            if (const auto *subfolder = qobject_cast<const RSS::Folder *>(item))
+                jsonObj.insert(item->name(), folderChangesToJsonObject(subfolder, changes));
+            else if (const auto *feed = qobject_cast<const RSS::Feed *>(item))
+                jsonObj.insert(item->name(), feed->toJsonValue(changes.value(feed->uid())));
+        }
+
+        return jsonObj;
+    }
+}
+
 void RSSController::addFolderAction()
 {
     requireParams({u"path"_s});
@@ -101,8 +119,25 @@ void RSSController::moveItemAction()
 void RSSController::itemsAction()
 {
     const bool withData {parseBool(params()[u"withData"_s]).value_or(false)};
+    const auto *session = RSS::Session::instance();
+
+    // Incremental mode: articles are only reported if they are added, removed or read
+    // since the revision the client knows, all the articles are reported if that revision
+    // is unknown (e.g. "rid" is 0)
+    if (withData && params().contains(u"rid"_s))
+    {
+        const qint64 revision = params()[u"rid"_s].toLongLong();
+        const std::optional<QHash<QUuid, RSS::ArticleChanges>> changes = session->articleChanges(revision);
+        const bool fullUpdate = (revision <= 0) || !changes;
+        setResult(QJsonObject {
+            {u"rid"_s, session->articlesRevision()},
+            {u"fullUpdate"_s, fullUpdate},
+            {u"items"_s, (fullUpdate ? session->rootFolder()->toJsonValue(true) : folderChangesToJsonObject(session->rootFolder(), *changes))}
+        });
+        return;
+    }
 
-    const auto jsonVal = RSS::Session::instance()->rootFolder()->toJsonValue(withData);
+    const auto jsonVal = session->rootFolder()->toJsonValue(withData);
     setResult(jsonVal.toObject());
 }
 
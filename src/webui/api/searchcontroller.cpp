@@ -30,6 +30,7 @@
 #include "searchcontroller.h"
 
 #include <limits>
+#include <optional>
 
 #include <QHash>
 #include <QJsonArray>
@@ -43,6 +44,7 @@
 #include "base/logger.h"
 #include "base/search/searchdownloadhandler.h"
 #include "base/search/searchhandler.h"
+#include "base/search/searchresultstore.h"
 #include "base/utils/datetime.h"
 #include "base/utils/foreignapps.h"
 #include "base/utils/random.h"
@@ -80,6 +82,40 @@ namespace
 
         return categoriesInfo;
     }
+
+    QJsonObject serializeSearchResult(const SearchResult &searchResult)
+    {
+        return {
+            {u"fileName"_s, searchResult.fileName},
+            {u"fileUrl"_s, searchResult.fileUrl},
+            {u"fileSize"_s, searchResult.fileSize},
+            {u"nbSeeders"_s, searchResult.nbSeeders},
+            {u"nbLeechers"_s, searchResult.nbLeechers},
+            {u"engineName"_s, searchResult.engineName},
+            {u"siteUrl"_s, searchResult.siteUrl},
+            {u"descrLink"_s, searchResult.descrLink},
+            {u"pubDate"_s, Utils::DateTime::toSecsSinceEpoch(searchResult.pubDate)}
+        };
+    }
+
+    std::optional<SearchResultStore::SortColumn> parseSortColumn(const QString &column)
+    {
+        if (column.isEmpty())
+            return SearchResultStore::SortColumn::None;
+        if (column == u"fileName")
+            return SearchResultStore::SortColumn::Name;
+        if (column == u"fileSize")
+            return SearchResultStore::SortColumn::Size;
+        if (column == u"nbSeeders")
+            return SearchResultStore::SortColumn::Seeders;
+        if (column == u"nbLeechers")
+            return SearchResultStore::SortColumn::Leechers;
+        if (column == u"engineName")
+            return SearchResultStore::SortColumn::Engine;
+        if (column == u"pubDate")
+            return SearchResultStore::SortColumn::PubDate;
+        return std::nullopt;
+    }
 }
 
 void SearchController::startAction()
@@ -180,9 +216,38 @@ void SearchController::resultsAction()
     if (iter == m_searchHandlers.end())
         throw APIError(APIErrorType::NotFound);
 
+    const std::optional<SearchResultStore::SortColumn> sortColumn = parseSortColumn(params()[u"sort"_s]);
+    if (!sortColumn)
+        throw APIError(APIErrorType::BadParams, tr("'sort' parameter is invalid"));
+
+    const auto parseLimit = [this](const QString &name) -> qlonglong
+    {
+        const QString value = params()[name];
+        if (value.isEmpty())
+            return -1;
+
+        bool ok = false;
+        const qlonglong result = value.toLongLong(&ok);
+        if (!ok)
+            throw APIError(APIErrorType::BadParams, tr("'%1' parameter is invalid").arg(name));
+        return result;
+    };
+
+    const SearchResultStore::Query query
+    {
+        .nameFilter = params()[u"filter"_s].trimmed(),
+        .minSeeders = parseLimit(u"min_seeders"_s),
+        .minSize = parseLimit(u"min_size"_s),
+        .maxSize = parseLimit(u"max_size"_s),
+        .sortColumn = *sortColumn,
+        .descending = Utils::String::parseBool(params()[u"reverse"_s]).value_or(false)
+    };
+
+    // results are served directly from the store, filtered and sorted ones via its index
     const std::shared_ptr<SearchHandler> &searchHandler = iter.value();
-    const QList<SearchResult> searchResults = searchHandler->results();
-    const int size = searchResults.size();
+    const SearchResultStore &searchResults = searchHandler->results();
+    const QList<int> *indexes = query.isEmpty() ? nullptr : &searchResults.select(query);
+    const int size = indexes ? indexes->size() : searchResults.size();
 
     if (offset > size)
         throw APIError(APIErrorType::Conflict, tr("Offset is out of range"));
@@ -195,10 +260,13 @@ void SearchController::resultsAction()
     if (limit <= 0)
         limit = -1;
 
-    if ((limit > 0) || (offset > 0))
-        setResult(getResults(searchResults.mid(offset, limit), searchHandler->isActive(), size));
-    else
-        setResult(getResults(searchResults, searchHandler->isActive(), size));
+    const int count = ((limit < 0) || (limit > (size - offset))) ? (size - offset) : limit;
+
+    QJsonArray searchResultsArray;
+    for (int i = offset; i < (offset + count); ++i)
+        searchResultsArray << serializeSearchResult(searchResults.at(indexes ? indexes->at(i) : i));
+
+    setResult(getResults(searchResultsArray, searchHandler->isActive(), size));
 }
 
 void SearchController::deleteAction()
@@ -332,25 +400,8 @@ int SearchController::generateSearchId() const
  *   - "descrLink"
  *   - "pubDate"
  */
-QJsonObject SearchController::getResults(const QList<SearchResult> &searchResults, const bool isSearchActive, const int totalResults) const
+QJsonObject SearchController::getResults(const QJsonArray &searchResultsArray, const bool isSearchActive, const int totalResults) const
 {
-    QJsonArray searchResultsArray;
-    for (const SearchResult &searchResult : searchResults)
-    {
-        searchResultsArray << QJsonObject
-        {
-            {u"fileName"_s, searchResult.fileName},
-            {u"fileUrl"_s, searchResult.fileUrl},
-            {u"fileSize"_s, searchResult.fileSize},
-            {u"nbSeeders"_s, searchResult.nbSeeders},
-            {u"nbLeechers"_s, searchResult.nbLeechers},
-            {u"engineName"_s, searchResult.engineName},
-            {u"siteUrl"_s, searchResult.siteUrl},
-            {u"descrLink"_s, searchResult.descrLink},
-            {u"pubDate"_s, Utils::DateTime::toSecsSinceEpoch(searchResult.pubDate)}
-        };
-    }
-
     const QJsonObject result =
     {
         {u"status"_s, isSearchActive ? u"Running"_s : u"Stopped"_s},
@@ -41,8 +41,6 @@
 class QJsonArray;
 class QJsonObject;
 
-struct SearchResult;
-
 class SearchController : public APIController
 {
     Q_OBJECT
@@ -70,7 +68,7 @@ private:
     void checkForUpdatesFinished(const QHash<QString, PluginVersion> &updateInfo);
     void checkForUpdatesFailed(const QString &reason);
     int generateSearchId() const;
-    QJsonObject getResults(const QList<SearchResult> &searchResults, bool isSearchActive, int totalResults) const;
+    QJsonObject getResults(const QJsonArray &searchResultsArray, bool isSearchActive, int totalResults) const;
     QJsonArray getPluginsInfo(const QStringList &plugins) const;
 
     QSet<int> m_activeSearches;
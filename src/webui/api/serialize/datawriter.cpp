@@ -0,0 +1,406 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "datawriter.h"
+
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include <QDateTime>
+#include <QLocale>
+#include <QStringList>
+#include <QtEndian>
+#include <QVariant>
+
+#include "base/global.h"
+
+namespace
+{
+    const char HEX_DIGITS[] = "0123456789abcdef";
+
+    // CBOR major types
+    const quint8 CBOR_UNSIGNED_INTEGER = 0;
+    const quint8 CBOR_NEGATIVE_INTEGER = 1;
+    const quint8 CBOR_BYTE_STRING = 2;
+    const quint8 CBOR_TEXT_STRING = 3;
+
+    const char CBOR_INDEFINITE_ARRAY = '\x9F';
+    const char CBOR_INDEFINITE_MAP = '\xBF';
+    const char CBOR_FALSE = '\xF4';
+    const char CBOR_TRUE = '\xF5';
+    const char CBOR_NULL = '\xF6';
+    const char CBOR_FLOAT = '\xFA';
+    const char CBOR_DOUBLE = '\xFB';
+    const char CBOR_BREAK = '\xFF';
+
+    template <typename T>
+    void appendBigEndian(QByteArray &buffer, const T value)
+    {
+        const T bigEndianValue = qToBigEndian(value);
+        buffer.append(reinterpret_cast<const char *>(&bigEndianValue), sizeof(bigEndianValue));
+    }
+}
+
+DataWriter::DataWriter(QByteArray &buffer, const DataFormat format)
+    : m_buffer {buffer}
+    , m_format {format}
+{
+}
+
+QByteArray DataWriter::encodeKey(const DataFormat format, const QStringView key)
+{
+    QByteArray encodedKey;
+    DataWriter writer {encodedKey, format};
+    writer.appendString(key);
+    if (format == DataFormat::JSON)
+        encodedKey.append(':');
+    return encodedKey;
+}
+
+DataFormat DataWriter::format() const
+{
+    return m_format;
+}
+
+void DataWriter::beginObject()
+{
+    beginValue();
+    m_buffer.append((m_format == DataFormat::CBOR) ? CBOR_INDEFINITE_MAP : '{');
+    m_hasItems.append(false);
+}
+
+void DataWriter::endObject()
+{
+    Q_ASSERT(!m_hasItems.isEmpty() && !m_isKeyWritten);
+
+    m_hasItems.removeLast();
+    m_buffer.append((m_format == DataFormat::CBOR) ? CBOR_BREAK : '}');
+}
+
+void DataWriter::beginArray()
+{
+    beginValue();
+    m_buffer.append((m_format == DataFormat::CBOR) ? CBOR_INDEFINITE_ARRAY : '[');
+    m_hasItems.append(false);
+}
+
+void DataWriter::endArray()
+{
+    Q_ASSERT(!m_hasItems.isEmpty());
+
+    m_hasItems.removeLast();
+    m_buffer.append((m_format == DataFormat::CBOR) ? CBOR_BREAK : ']');
+}
+
+void DataWriter::writeKey(const QStringView key)
+{
+    beginValue();
+    appendString(key);
+    if (m_format == DataFormat::JSON)
+        m_buffer.append(':');
+    m_isKeyWritten = true;
+}
+
+void DataWriter::writeEncodedKey(const QByteArray &encodedKey)
+{
+    beginValue();
+    m_buffer.append(encodedKey);
+    m_isKeyWritten = true;
+}
+
+void DataWriter::writeNull()
+{
+    beginValue();
+    if (m_format == DataFormat::CBOR)
+        m_buffer.append(CBOR_NULL);
+    else
+        m_buffer.append("null");
+}
+
+void DataWriter::writeBool(const bool value)
+{
+    beginValue();
+    if (m_format == DataFormat::CBOR)
+        m_buffer.append(value ? CBOR_TRUE : CBOR_FALSE);
+    else
+        m_buffer.append(value ? "true" : "false");
+}
+
+void DataWriter::writeInteger(const qint64 value)
+{
+    beginValue();
+    if (m_format == DataFormat::CBOR)
+    {
+        // negative integer N is encoded as -1 - N
+        if (value >= 0)
+            appendCborHead(CBOR_UNSIGNED_INTEGER, static_cast<quint64>(value));
+        else
+            appendCborHead(CBOR_NEGATIVE_INTEGER, ~static_cast<quint64>(value));
+        return;
+    }
+
+    m_buffer.append(QByteArray::number(value));
+}
+
+void DataWriter::writeDouble(const double value)
+{
+    beginValue();
+    if (m_format == DataFormat::CBOR)
+    {
+        // values representable in single precision without loss, e.g. the integral ones, take half the space
+        if (const auto floatValue = static_cast<float>(value); (floatValue == value) || std::isnan(value))
+        {
+            m_buffer.append(CBOR_FLOAT);
+            appendBigEndian(m_buffer, std::bit_cast<quint32>(floatValue));
+        }
+        else
+        {
+            m_buffer.append(CBOR_DOUBLE);
+            appendBigEndian(m_buffer, std::bit_cast<quint64>(value));
+        }
+        return;
+    }
+
+    // JSON has no representation of infinity and NaN, QJsonDocument writes them as null too
+    if (std::isfinite(value))
+        m_buffer.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+    else
+        m_buffer.append("null");
+}
+
+void DataWriter::writeString(const QStringView value)
+{
+    beginValue();
+    appendString(value);
+}
+
+void DataWriter::writeHash(const QStringView hash)
+{
+    if (m_format == DataFormat::JSON)
+    {
+        writeString(hash);
+        return;
+    }
+
+    beginValue();
+    const QByteArray hashBytes = QByteArray::fromHex(hash.toLatin1());
+    appendCborHead(CBOR_BYTE_STRING, static_cast<quint64>(hashBytes.size()));
+    m_buffer.append(hashBytes);
+}
+
+void DataWriter::writeValue(const QVariant &value)
+{
+    switch (value.userType())
+    {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        writeNull();
+        break;
+    case QMetaType::Bool:
+        writeBool(value.toBool());
+        break;
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+        writeInteger(value.toLongLong());
+        break;
+    case QMetaType::ULongLong:
+        // QJsonValue keeps the values not fitting qint64 as double as well
+        if (const qulonglong number = value.toULongLong(); number <= static_cast<qulonglong>(std::numeric_limits<qint64>::max()))
+            writeInteger(static_cast<qint64>(number));
+        else
+            writeDouble(static_cast<double>(number));
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        writeDouble(value.toDouble());
+        break;
+    case QMetaType::QString:
+        writeString(value.toString());
+        break;
+    case QMetaType::QDateTime:
+        writeString(value.toDateTime().toString(Qt::ISODateWithMs));
+        break;
+    case QMetaType::QStringList:
+        beginArray();
+        for (const QString &item : value.toStringList())
+            writeString(item);
+        endArray();
+        break;
+    case QMetaType::QVariantList:
+        beginArray();
+        for (const QVariant &item : value.toList())
+            writeValue(item);
+        endArray();
+        break;
+    case QMetaType::QVariantMap:
+        {
+            beginObject();
+            const QVariantMap map = value.toMap();
+            for (auto it = map.cbegin(); it != map.cend(); ++it)
+            {
+                writeKey(it.key());
+                writeValue(it.value());
+            }
+            endObject();
+        }
+        break;
+    case QMetaType::QVariantHash:
+        {
+            beginObject();
+            const QVariantHash hash = value.toHash();
+            for (auto it = hash.cbegin(); it != hash.cend(); ++it)
+            {
+                writeKey(it.key());
+                writeValue(it.value());
+            }
+            endObject();
+        }
+        break;
+    default:
+        Q_ASSERT_X(false, "DataWriter::writeValue"
+                   , u"Unexpected type: %1"_s
+                   .arg(QString::fromLatin1(value.metaType().name()))
+                   .toUtf8().constData());
+        writeString(value.toString());
+        break;
+    }
+}
+
+void DataWriter::beginValue()
+{
+    // CBOR has no separators
+    if (m_format == DataFormat::CBOR)
+    {
+        if (!m_hasItems.isEmpty())
+            m_hasItems.last() = true;
+        m_isKeyWritten = false;
+        return;
+    }
+
+    if (m_isKeyWritten)
+    {
+        m_isKeyWritten = false;
+        return;
+    }
+
+    if (m_hasItems.isEmpty())
+        return;
+
+    if (m_hasItems.last())
+        m_buffer.append(',');
+    m_hasItems.last() = true;
+}
+
+void DataWriter::appendString(const QStringView value)
+{
+    if (m_format == DataFormat::CBOR)
+    {
+        const QByteArray utf8Value = value.toUtf8();
+        appendCborHead(CBOR_TEXT_STRING, static_cast<quint64>(utf8Value.size()));
+        m_buffer.append(utf8Value);
+        return;
+    }
+
+    m_buffer.append('"');
+
+    // the characters not requiring escaping are appended in runs
+    qsizetype runStart = 0;
+    for (qsizetype i = 0; i < value.size(); ++i)
+    {
+        const char16_t c = value[i].unicode();
+        if ((c >= 0x20) && (c != u'"') && (c != u'\\'))
+            continue;
+
+        m_buffer.append(value.sliced(runStart, (i - runStart)).toUtf8());
+        runStart = i + 1;
+
+        switch (c)
+        {
+        case u'"':
+            m_buffer.append("\\\"");
+            break;
+        case u'\\':
+            m_buffer.append("\\\\");
+            break;
+        case u'\b':
+            m_buffer.append("\\b");
+            break;
+        case u'\f':
+            m_buffer.append("\\f");
+            break;
+        case u'\n':
+            m_buffer.append("\\n");
+            break;
+        case u'\r':
+            m_buffer.append("\\r");
+            break;
+        case u'\t':
+            m_buffer.append("\\t");
+            break;
+        default:
+            m_buffer.append("\\u00").append(HEX_DIGITS[c >> 4]).append(HEX_DIGITS[c & 0xF]);
+            break;
+        }
+    }
+    m_buffer.append(value.sliced(runStart).toUtf8());
+
+    m_buffer.append('"');
+}
+
+void DataWriter::appendCborHead(const quint8 majorType, const quint64 value)
+{
+    // the value is stored in the initial byte if it is small enough,
+    // otherwise it follows in the smallest of 1, 2, 4 or 8 bytes
+    const auto initialByte = static_cast<char>(majorType << 5);
+    if (value < 24)
+    {
+        m_buffer.append(static_cast<char>(initialByte | value));
+    }
+    else if (value <= std::numeric_limits<quint8>::max())
+    {
+        m_buffer.append(static_cast<char>(initialByte | 24));
+        m_buffer.append(static_cast<char>(value));
+    }
+    else if (value <= std::numeric_limits<quint16>::max())
+    {
+        m_buffer.append(static_cast<char>(initialByte | 25));
+        appendBigEndian(m_buffer, static_cast<quint16>(value));
+    }
+    else if (value <= std::numeric_limits<quint32>::max())
+    {
+        m_buffer.append(static_cast<char>(initialByte | 26));
+        appendBigEndian(m_buffer, static_cast<quint32>(value));
+    }
+    else
+    {
+        m_buffer.append(static_cast<char>(initialByte | 27));
+        appendBigEndian(m_buffer, value);
+    }
+}
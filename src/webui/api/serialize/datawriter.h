@@ -0,0 +1,85 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QStringView>
+#include <QVarLengthArray>
+
+class QVariant;
+
+enum class DataFormat
+{
+    JSON,
+    CBOR
+};
+
+// Writes JSON text or CBOR straight into the buffer without building intermediate documents.
+// Caller is responsible for the document structure: each key written to object must be
+// followed by its value and every object or array must be ended.
+// CBOR objects and arrays are written with indefinite length, so their items don't need to be known in advance.
+class DataWriter
+{
+public:
+    DataWriter(QByteArray &buffer, DataFormat format);
+
+    // Encodes key to be written with writeEncodedKey(), so constant keys are encoded only once
+    static QByteArray encodeKey(DataFormat format, QStringView key);
+
+    DataFormat format() const;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void writeKey(QStringView key);
+    void writeEncodedKey(const QByteArray &encodedKey);
+
+    void writeNull();
+    void writeBool(bool value);
+    void writeInteger(qint64 value);
+    void writeDouble(double value);
+    void writeString(QStringView value);
+    // Hash is given as hex string, it is written as byte string in CBOR
+    void writeHash(QStringView hash);
+    // Supports the types QJsonValue::fromVariant() converts to JSON values
+    void writeValue(const QVariant &value);
+
+private:
+    void beginValue();
+    void appendString(QStringView value);
+    void appendCborHead(quint8 majorType, quint64 value);
+
+    QByteArray &m_buffer;
+    DataFormat m_format;
+    // whether anything is written at each nesting level
+    QVarLengthArray<bool, 8> m_hasItems;
+    bool m_isKeyWritten = false;
+};
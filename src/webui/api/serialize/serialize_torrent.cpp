@@ -28,7 +28,11 @@
 
 #include "serialize_torrent.h"
 
+#include <bit>
+#include <iterator>
+
 #include <QDateTime>
+#include <QHash>
 #include <QVector>
 
 #include "base/bittorrent/infohash.h"
@@ -38,6 +42,7 @@
 #include "base/tagset.h"
 #include "base/utils/datetime.h"
 #include "base/utils/string.h"
+#include "datawriter.h"
 
 namespace
 {
@@ -85,87 +90,389 @@ namespace
             return u"unknown"_s;
         }
     }
-}
 
-QVariantMap serialize(const BitTorrent::Torrent &torrent)
-{
-    const auto adjustQueuePosition = [](const int position) -> int
+    int adjustQueuePosition(const int position)
     {
         return (position < 0) ? 0 : (position + 1);
-    };
+    }
 
-    const auto adjustRatio = [](const qreal ratio) -> qreal
+    qreal adjustRatio(const qreal ratio)
     {
         return (ratio > BitTorrent::Torrent::MAX_RATIO) ? -1 : ratio;
-    };
+    }
 
-    const auto getLastActivityTime = [&torrent]() -> qlonglong
+    qlonglong lastActivityTime(const BitTorrent::Torrent &torrent)
     {
         const qlonglong timeSinceActivity = torrent.timeSinceActivity();
         return (timeSinceActivity < 0)
             ? Utils::DateTime::toSecsSinceEpoch(torrent.addedTime())
             : (QDateTime::currentSecsSinceEpoch() - timeSinceActivity);
+    }
+
+    // Returns the keys of the values depending on the given fields
+    SerializedTorrent::KeySet dependentKeys(const BitTorrent::TorrentStatusFields fields)
+    {
+        using BitTorrent::TorrentStatusField;
+
+        struct FieldsKeys
+        {
+            BitTorrent::TorrentStatusFields fields;
+            SerializedTorrent::KeySet keys;
+        };
+
+        using enum SerializedTorrent::Key;
+        static const FieldsKeys dependencies[] =
+        {
+            {TorrentStatusField::Properties, SerializedTorrent::keySet({InfoHashV1, InfoHashV2, Name, SequentialDownload
+                , FirstLastPiecePriority, Category, Tags, SuperSeeding, ForceStart, SavePath, DownloadPath, ContentPath, RootPath
+                , DownloadLimit, UploadLimit, MaxRatio, MaxSeedingTime, MaxInactiveSeedingTime, RatioLimit, SeedingTimeLimit
+                , InactiveSeedingTimeLimit, AutoTorrentManagement, Comment, Private, HasMetadata})},
+            {TorrentStatusField::Properties | TorrentStatusField::Trackers, SerializedTorrent::keySet({MagnetURI, TrackersCount})},
+            {TorrentStatusField::Trackers, SerializedTorrent::keySet({Tracker})},
+            {TorrentStatusField::State, SerializedTorrent::keySet({State, QueuePosition})},
+            {TorrentStatusField::Progress | TorrentStatusField::Properties, SerializedTorrent::keySet({Size, TotalSize, AmountLeft})},
+            {TorrentStatusField::Progress, SerializedTorrent::keySet({Progress, AmountCompleted})},
+            {TorrentStatusField::Transfer, SerializedTorrent::keySet({DownloadSpeed, UploadSpeed})},
+            {TorrentStatusField::Transfer | TorrentStatusField::Totals | TorrentStatusField::Times | TorrentStatusField::Progress
+                | TorrentStatusField::Properties, SerializedTorrent::keySet({Eta})},
+            {TorrentStatusField::Totals, SerializedTorrent::keySet({AmountDownloaded, AmountUploaded, AmountDownloadedSession, AmountUploadedSession})},
+            {TorrentStatusField::Totals | TorrentStatusField::Progress | TorrentStatusField::Properties, SerializedTorrent::keySet({Ratio})},
+            {TorrentStatusField::Totals | TorrentStatusField::Times | TorrentStatusField::Properties, SerializedTorrent::keySet({Popularity})},
+            {TorrentStatusField::Peers, SerializedTorrent::keySet({Seeds, NumComplete, Leechs, NumIncomplete})},
+            {TorrentStatusField::Availability, SerializedTorrent::keySet({Availability})},
+            {TorrentStatusField::Times, SerializedTorrent::keySet({AddedOn, CompletionOn, LastSeenCompleteTime, TimeActive, SeedingTime, Reannounce})}
+        };
+
+        // torrent ID identifies the values and last activity time depends on current time
+        SerializedTorrent::KeySet keys = SerializedTorrent::keySet({ID, LastActivityTime});
+        for (const FieldsKeys &dependency : dependencies)
+        {
+            if (fields.testAnyFlags(dependency.fields))
+                keys |= dependency.keys;
+        }
+        return keys;
+    }
+}
+
+const QString &SerializedTorrent::keyName(const Key key)
+{
+    // ordered as the keys
+    static const QString names[] =
+    {
+        KEY_TORRENT_ID,
+        KEY_TORRENT_INFOHASHV1,
+        KEY_TORRENT_INFOHASHV2,
+        KEY_TORRENT_NAME,
+        KEY_TORRENT_MAGNET_URI,
+        KEY_TORRENT_SIZE,
+        KEY_TORRENT_PROGRESS,
+        KEY_TORRENT_DLSPEED,
+        KEY_TORRENT_UPSPEED,
+        KEY_TORRENT_QUEUE_POSITION,
+        KEY_TORRENT_SEEDS,
+        KEY_TORRENT_NUM_COMPLETE,
+        KEY_TORRENT_LEECHS,
+        KEY_TORRENT_NUM_INCOMPLETE,
+        KEY_TORRENT_RATIO,
+        KEY_TORRENT_POPULARITY,
+        KEY_TORRENT_ETA,
+        KEY_TORRENT_STATE,
+        KEY_TORRENT_SEQUENTIAL_DOWNLOAD,
+        KEY_TORRENT_FIRST_LAST_PIECE_PRIO,
+        KEY_TORRENT_CATEGORY,
+        KEY_TORRENT_TAGS,
+        KEY_TORRENT_SUPER_SEEDING,
+        KEY_TORRENT_FORCE_START,
+        KEY_TORRENT_SAVE_PATH,
+        KEY_TORRENT_DOWNLOAD_PATH,
+        KEY_TORRENT_CONTENT_PATH,
+        KEY_TORRENT_ROOT_PATH,
+        KEY_TORRENT_ADDED_ON,
+        KEY_TORRENT_COMPLETION_ON,
+        KEY_TORRENT_TRACKER,
+        KEY_TORRENT_TRACKERS_COUNT,
+        KEY_TORRENT_DL_LIMIT,
+        KEY_TORRENT_UP_LIMIT,
+        KEY_TORRENT_AMOUNT_DOWNLOADED,
+        KEY_TORRENT_AMOUNT_UPLOADED,
+        KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION,
+        KEY_TORRENT_AMOUNT_UPLOADED_SESSION,
+        KEY_TORRENT_AMOUNT_LEFT,
+        KEY_TORRENT_AMOUNT_COMPLETED,
+        KEY_TORRENT_MAX_RATIO,
+        KEY_TORRENT_MAX_SEEDING_TIME,
+        KEY_TORRENT_MAX_INACTIVE_SEEDING_TIME,
+        KEY_TORRENT_RATIO_LIMIT,
+        KEY_TORRENT_SEEDING_TIME_LIMIT,
+        KEY_TORRENT_INACTIVE_SEEDING_TIME_LIMIT,
+        KEY_TORRENT_LAST_SEEN_COMPLETE_TIME,
+        KEY_TORRENT_LAST_ACTIVITY_TIME,
+        KEY_TORRENT_TOTAL_SIZE,
+        KEY_TORRENT_AUTO_TORRENT_MANAGEMENT,
+        KEY_TORRENT_TIME_ACTIVE,
+        KEY_TORRENT_SEEDING_TIME,
+        KEY_TORRENT_AVAILABILITY,
+        KEY_TORRENT_REANNOUNCE,
+        KEY_TORRENT_COMMENT,
+        KEY_TORRENT_PRIVATE,
+        KEY_TORRENT_HAS_METADATA
     };
+    static_assert(std::size(names) == KeysCount);
+
+    return names[key];
+}
+
+std::optional<SerializedTorrent::Key> SerializedTorrent::findKey(const QString &name)
+{
+    static const QHash<QString, Key> keysByName = []
+    {
+        QHash<QString, Key> result;
+        result.reserve(KeysCount);
+        for (int i = 0; i < KeysCount; ++i)
+            result.insert(keyName(static_cast<Key>(i)), static_cast<Key>(i));
+        return result;
+    }();
+
+    if (const auto it = keysByName.constFind(name); it != keysByName.cend())
+        return it.value();
+    return std::nullopt;
+}
+
+void SerializedTorrent::setValue(const Key key, QVariant value)
+{
+    values[key] = std::move(value);
+    keys |= keySet(key);
+}
+
+SerializedTorrent::KeySet SerializedTorrent::update(const SerializedTorrent &other)
+{
+    KeySet changedKeys = 0;
+    for (KeySet otherKeys = other.keys; otherKeys != 0; otherKeys &= (otherKeys - 1))
+    {
+        const int key = std::countr_zero(otherKeys);
+        if (!(keys & keySet(static_cast<Key>(key))) || (values[key] != other.values[key]))
+        {
+            values[key] = other.values[key];
+            changedKeys |= keySet(static_cast<Key>(key));
+        }
+    }
+    keys |= other.keys;
 
-    return {
-        {KEY_TORRENT_ID, torrent.id().toString()},
-        {KEY_TORRENT_INFOHASHV1, torrent.infoHash().v1().toString()},
-        {KEY_TORRENT_INFOHASHV2, torrent.infoHash().v2().toString()},
-        {KEY_TORRENT_NAME, torrent.name()},
-        {KEY_TORRENT_MAGNET_URI, torrent.createMagnetURI()},
-        {KEY_TORRENT_SIZE, torrent.wantedSize()},
-        {KEY_TORRENT_PROGRESS, torrent.progress()},
-        {KEY_TORRENT_DLSPEED, torrent.downloadPayloadRate()},
-        {KEY_TORRENT_UPSPEED, torrent.uploadPayloadRate()},
-        {KEY_TORRENT_QUEUE_POSITION, adjustQueuePosition(torrent.queuePosition())},
-        {KEY_TORRENT_SEEDS, torrent.seedsCount()},
-        {KEY_TORRENT_NUM_COMPLETE, torrent.totalSeedsCount()},
-        {KEY_TORRENT_LEECHS, torrent.leechsCount()},
-        {KEY_TORRENT_NUM_INCOMPLETE, torrent.totalLeechersCount()},
-
-        {KEY_TORRENT_STATE, torrentStateToString(torrent.state())},
-        {KEY_TORRENT_ETA, torrent.eta()},
-        {KEY_TORRENT_SEQUENTIAL_DOWNLOAD, torrent.isSequentialDownload()},
-        {KEY_TORRENT_FIRST_LAST_PIECE_PRIO, torrent.hasFirstLastPiecePriority()},
-
-        {KEY_TORRENT_CATEGORY, torrent.category()},
-        {KEY_TORRENT_TAGS, Utils::String::joinIntoString(torrent.tags(), u", "_s)},
-        {KEY_TORRENT_SUPER_SEEDING, torrent.superSeeding()},
-        {KEY_TORRENT_FORCE_START, torrent.isForced()},
-        {KEY_TORRENT_SAVE_PATH, torrent.savePath().toString()},
-        {KEY_TORRENT_DOWNLOAD_PATH, torrent.downloadPath().toString()},
-        {KEY_TORRENT_CONTENT_PATH, torrent.contentPath().toString()},
-        {KEY_TORRENT_ROOT_PATH, torrent.rootPath().toString()},
-        {KEY_TORRENT_ADDED_ON, Utils::DateTime::toSecsSinceEpoch(torrent.addedTime())},
-        {KEY_TORRENT_COMPLETION_ON, Utils::DateTime::toSecsSinceEpoch(torrent.completedTime())},
-        {KEY_TORRENT_TRACKER, torrent.currentTracker()},
-        {KEY_TORRENT_TRACKERS_COUNT, torrent.trackers().size()},
-        {KEY_TORRENT_DL_LIMIT, torrent.downloadLimit()},
-        {KEY_TORRENT_UP_LIMIT, torrent.uploadLimit()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED, torrent.totalDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED, torrent.totalUpload()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, torrent.totalPayloadDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED_SESSION, torrent.totalPayloadUpload()},
-        {KEY_TORRENT_AMOUNT_LEFT, torrent.remainingSize()},
-        {KEY_TORRENT_AMOUNT_COMPLETED, torrent.completedSize()},
-        {KEY_TORRENT_MAX_RATIO, torrent.maxRatio()},
-        {KEY_TORRENT_MAX_SEEDING_TIME, torrent.maxSeedingTime()},
-        {KEY_TORRENT_MAX_INACTIVE_SEEDING_TIME, torrent.maxInactiveSeedingTime()},
-        {KEY_TORRENT_RATIO, adjustRatio(torrent.realRatio())},
-        {KEY_TORRENT_RATIO_LIMIT, torrent.ratioLimit()},
-        {KEY_TORRENT_POPULARITY, torrent.popularity()},
-        {KEY_TORRENT_SEEDING_TIME_LIMIT, torrent.seedingTimeLimit()},
-        {KEY_TORRENT_INACTIVE_SEEDING_TIME_LIMIT, torrent.inactiveSeedingTimeLimit()},
-        {KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, Utils::DateTime::toSecsSinceEpoch(torrent.lastSeenComplete())},
-        {KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, torrent.isAutoTMMEnabled()},
-        {KEY_TORRENT_TIME_ACTIVE, torrent.activeTime()},
-        {KEY_TORRENT_SEEDING_TIME, torrent.finishedTime()},
-        {KEY_TORRENT_LAST_ACTIVITY_TIME, getLastActivityTime()},
-        {KEY_TORRENT_AVAILABILITY, torrent.distributedCopies()},
-        {KEY_TORRENT_REANNOUNCE, torrent.nextAnnounce()},
-        {KEY_TORRENT_COMMENT, torrent.comment()},
-        {KEY_TORRENT_PRIVATE, (torrent.hasMetadata() ? torrent.isPrivate() : QVariant())},
-        {KEY_TORRENT_TOTAL_SIZE, torrent.totalSize()},
-        {KEY_TORRENT_HAS_METADATA, torrent.hasMetadata()}
+    return changedKeys;
+}
+
+QVariantMap SerializedTorrent::toVariantMap() const
+{
+    QVariantMap result;
+    for (KeySet setKeys = keys; setKeys != 0; setKeys &= (setKeys - 1))
+    {
+        const auto key = static_cast<Key>(std::countr_zero(setKeys));
+        result.insert(keyName(key), values[key]);
+    }
+    return result;
+}
+
+void SerializedTorrent::write(DataWriter &writer, const KeySet selectedKeys) const
+{
+    const auto encodeKeys = [](const DataFormat format)
+    {
+        std::array<QByteArray, KeysCount> result;
+        for (int i = 0; i < KeysCount; ++i)
+            result[i] = DataWriter::encodeKey(format, keyName(static_cast<Key>(i)));
+        return result;
     };
+    static const auto jsonKeys = encodeKeys(DataFormat::JSON);
+    static const auto cborKeys = encodeKeys(DataFormat::CBOR);
+    const auto &encodedKeys = (writer.format() == DataFormat::CBOR) ? cborKeys : jsonKeys;
+
+    constexpr KeySet hashKeys = keySet({ID, InfoHashV1, InfoHashV2});
+
+    writer.beginObject();
+    for (KeySet writtenKeys = (selectedKeys & keys); writtenKeys != 0; writtenKeys &= (writtenKeys - 1))
+    {
+        const int key = std::countr_zero(writtenKeys);
+        writer.writeEncodedKey(encodedKeys[key]);
+        if (hashKeys & keySet(static_cast<Key>(key)))
+            writer.writeHash(values[key].toString());
+        else
+            writer.writeValue(values[key]);
+    }
+    writer.endObject();
+}
+
+QVariant serializeValue(const BitTorrent::Torrent &torrent, const SerializedTorrent::Key key)
+{
+    switch (key)
+    {
+    case SerializedTorrent::ID:
+        return torrent.id().toString();
+    case SerializedTorrent::InfoHashV1:
+        return torrent.infoHash().v1().toString();
+    case SerializedTorrent::InfoHashV2:
+        return torrent.infoHash().v2().toString();
+    case SerializedTorrent::Name:
+        return torrent.name();
+    case SerializedTorrent::MagnetURI:
+        return torrent.createMagnetURI();
+    case SerializedTorrent::Size:
+        return torrent.wantedSize();
+    case SerializedTorrent::Progress:
+        return torrent.progress();
+    case SerializedTorrent::DownloadSpeed:
+        return torrent.downloadPayloadRate();
+    case SerializedTorrent::UploadSpeed:
+        return torrent.uploadPayloadRate();
+    case SerializedTorrent::QueuePosition:
+        return adjustQueuePosition(torrent.queuePosition());
+    case SerializedTorrent::Seeds:
+        return torrent.seedsCount();
+    case SerializedTorrent::NumComplete:
+        return torrent.totalSeedsCount();
+    case SerializedTorrent::Leechs:
+        return torrent.leechsCount();
+    case SerializedTorrent::NumIncomplete:
+        return torrent.totalLeechersCount();
+    case SerializedTorrent::Ratio:
+        return adjustRatio(torrent.realRatio());
+    case SerializedTorrent::Popularity:
+        return torrent.popularity();
+    case SerializedTorrent::Eta:
+        return torrent.eta();
+    case SerializedTorrent::State:
+        return torrentStateToString(torrent.state());
+    case SerializedTorrent::SequentialDownload:
+        return torrent.isSequentialDownload();
+    case SerializedTorrent::FirstLastPiecePriority:
+        return torrent.hasFirstLastPiecePriority();
+    case SerializedTorrent::Category:
+        return torrent.category();
+    case SerializedTorrent::Tags:
+        return Utils::String::joinIntoString(torrent.tags(), u", "_s);
+    case SerializedTorrent::SuperSeeding:
+        return torrent.superSeeding();
+    case SerializedTorrent::ForceStart:
+        return torrent.isForced();
+    case SerializedTorrent::SavePath:
+        return torrent.savePath().toString();
+    case SerializedTorrent::DownloadPath:
+        return torrent.downloadPath().toString();
+    case SerializedTorrent::ContentPath:
+        return torrent.contentPath().toString();
+    case SerializedTorrent::RootPath:
+        return torrent.rootPath().toString();
+    case SerializedTorrent::AddedOn:
+        return Utils::DateTime::toSecsSinceEpoch(torrent.addedTime());
+    case SerializedTorrent::CompletionOn:
+        return Utils::DateTime::toSecsSinceEpoch(torrent.completedTime());
+    case SerializedTorrent::Tracker:
+        return torrent.currentTracker();
+    case SerializedTorrent::TrackersCount:
+        return torrent.trackers().size();
+    case SerializedTorrent::DownloadLimit:
+        return torrent.downloadLimit();
+    case SerializedTorrent::UploadLimit:
+        return torrent.uploadLimit();
+    case SerializedTorrent::AmountDownloaded:
+        return torrent.totalDownload();
+    case SerializedTorrent::AmountUploaded:
+        return torrent.totalUpload();
+    case SerializedTorrent::AmountDownloadedSession:
+        return torrent.totalPayloadDownload();
+    case SerializedTorrent::AmountUploadedSession:
+        return torrent.totalPayloadUpload();
+    case SerializedTorrent::AmountLeft:
+        return torrent.remainingSize();
+    case SerializedTorrent::AmountCompleted:
+        return torrent.completedSize();
+    case SerializedTorrent::MaxRatio:
+        return torrent.maxRatio();
+    case SerializedTorrent::MaxSeedingTime:
+        return torrent.maxSeedingTime();
+    case SerializedTorrent::MaxInactiveSeedingTime:
+        return torrent.maxInactiveSeedingTime();
+    case SerializedTorrent::RatioLimit:
+        return torrent.ratioLimit();
+    case SerializedTorrent::SeedingTimeLimit:
+        return torrent.seedingTimeLimit();
+    case SerializedTorrent::InactiveSeedingTimeLimit:
+        return torrent.inactiveSeedingTimeLimit();
+    case SerializedTorrent::LastSeenCompleteTime:
+        return Utils::DateTime::toSecsSinceEpoch(torrent.lastSeenComplete());
+    case SerializedTorrent::LastActivityTime:
+        return lastActivityTime(torrent);
+    case SerializedTorrent::TotalSize:
+        return torrent.totalSize();
+    case SerializedTorrent::AutoTorrentManagement:
+        return torrent.isAutoTMMEnabled();
+    case SerializedTorrent::TimeActive:
+        return torrent.activeTime();
+    case SerializedTorrent::SeedingTime:
+        return torrent.finishedTime();
+    case SerializedTorrent::Availability:
+        return torrent.distributedCopies();
+    case SerializedTorrent::Reannounce:
+        return torrent.nextAnnounce();
+    case SerializedTorrent::Comment:
+        return torrent.comment();
+    case SerializedTorrent::Private:
+        return (torrent.hasMetadata() ? torrent.isPrivate() : QVariant());
+    case SerializedTorrent::HasMetadata:
+        return torrent.hasMetadata();
+    case SerializedTorrent::KeysCount:
+        break;
+    }
+
+    Q_ASSERT(false);
+    return {};
+}
+
+SerializedTorrent serialize(const BitTorrent::Torrent &torrent)
+{
+    return serialize(torrent, SerializedTorrent::ALL_KEYS);
+}
+
+SerializedTorrent serialize(const BitTorrent::Torrent &torrent, BitTorrent::TorrentStatusFields fields)
+{
+    // state change may affect any value
+    if (fields.testFlag(BitTorrent::TorrentStatusField::State))
+        return serialize(torrent);
+
+    return serialize(torrent, dependentKeys(fields));
+}
+
+SerializedTorrent serialize(const BitTorrent::Torrent &torrent, const SerializedTorrent::KeySet keys)
+{
+    SerializedTorrent result;
+    for (SerializedTorrent::KeySet serializedKeys = (keys & SerializedTorrent::ALL_KEYS); serializedKeys != 0; serializedKeys &= (serializedKeys - 1))
+    {
+        const auto key = static_cast<SerializedTorrent::Key>(std::countr_zero(serializedKeys));
+        result.setValue(key, serializeValue(torrent, key));
+    }
+    return result;
+}
+
+bool serializedValueLessThan(const QVariant &left, const QVariant &right)
+{
+    Q_ASSERT(left.userType() == right.userType());
+
+    switch (left.userType())
+    {
+    case QMetaType::Bool:
+        return left.value<bool>() < right.value<bool>();
+    case QMetaType::Double:
+        return left.value<double>() < right.value<double>();
+    case QMetaType::Float:
+        return left.value<float>() < right.value<float>();
+    case QMetaType::Int:
+        return left.value<int>() < right.value<int>();
+    case QMetaType::LongLong:
+        return left.value<qlonglong>() < right.value<qlonglong>();
+    case QMetaType::QString:
+        return left.value<QString>() < right.value<QString>();
+    default:
+        qWarning("Unhandled QVariant comparison, type: %d, name: %s"
+                , left.userType(), left.metaType().name());
+        break;
+    }
+    return false;
 }
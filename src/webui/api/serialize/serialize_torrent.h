@@ -28,8 +28,14 @@
 
 #pragma once
 
+#include <array>
+#include <initializer_list>
+#include <optional>
+
 #include <QVariant>
+#include <QVariantMap>
 
+#include "base/bittorrent/torrentstatusfield.h"
 #include "base/global.h"
 
 namespace BitTorrent
@@ -37,6 +43,8 @@ namespace BitTorrent
     class Torrent;
 }
 
+class DataWriter;
+
 // Torrent keys
 // TODO: Rename it to `id`.
 inline const QString KEY_TORRENT_ID = u"hash"_s;
@@ -97,4 +105,113 @@ inline const QString KEY_TORRENT_COMMENT = u"comment"_s;
 inline const QString KEY_TORRENT_PRIVATE = u"private"_s;
 inline const QString KEY_TORRENT_HAS_METADATA = u"has_metadata"_s;
 
-QVariantMap serialize(const BitTorrent::Torrent &torrent);
+// Torrent values kept in fixed order instead of the map of keys,
+// so they can be compared and written as JSON without any lookups.
+struct SerializedTorrent
+{
+    enum Key
+    {
+        ID,
+        InfoHashV1,
+        InfoHashV2,
+        Name,
+        MagnetURI,
+        Size,
+        Progress,
+        DownloadSpeed,
+        UploadSpeed,
+        QueuePosition,
+        Seeds,
+        NumComplete,
+        Leechs,
+        NumIncomplete,
+        Ratio,
+        Popularity,
+        Eta,
+        State,
+        SequentialDownload,
+        FirstLastPiecePriority,
+        Category,
+        Tags,
+        SuperSeeding,
+        ForceStart,
+        SavePath,
+        DownloadPath,
+        ContentPath,
+        RootPath,
+        AddedOn,
+        CompletionOn,
+        Tracker,
+        TrackersCount,
+        DownloadLimit,
+        UploadLimit,
+        AmountDownloaded,
+        AmountUploaded,
+        AmountDownloadedSession,
+        AmountUploadedSession,
+        AmountLeft,
+        AmountCompleted,
+        MaxRatio,
+        MaxSeedingTime,
+        MaxInactiveSeedingTime,
+        RatioLimit,
+        SeedingTimeLimit,
+        InactiveSeedingTimeLimit,
+        LastSeenCompleteTime,
+        LastActivityTime,
+        TotalSize,
+        AutoTorrentManagement,
+        TimeActive,
+        SeedingTime,
+        Availability,
+        Reannounce,
+        Comment,
+        Private,
+        HasMetadata,
+
+        KeysCount
+    };
+
+    // set of the keys as bit mask
+    using KeySet = quint64;
+    static_assert(KeysCount <= (sizeof(KeySet) * 8));
+
+    static constexpr KeySet ALL_KEYS = (KeySet(1) << KeysCount) - 1;
+
+    static constexpr KeySet keySet(const Key key)
+    {
+        return KeySet(1) << key;
+    }
+
+    static constexpr KeySet keySet(const std::initializer_list<Key> keys)
+    {
+        KeySet result = 0;
+        for (const Key key : keys)
+            result |= keySet(key);
+        return result;
+    }
+
+    static const QString &keyName(Key key);
+    static std::optional<Key> findKey(const QString &name);
+
+    void setValue(Key key, QVariant value);
+    // Takes the values set in other one, returns the keys of the values that have changed
+    KeySet update(const SerializedTorrent &other);
+
+    QVariantMap toVariantMap() const;
+    // Writes the given values as object, the hashes are written as such in the formats supporting it
+    void write(DataWriter &writer, KeySet keys) const;
+
+    // keys of the values set
+    KeySet keys = 0;
+    std::array<QVariant, KeysCount> values;
+};
+
+SerializedTorrent serialize(const BitTorrent::Torrent &torrent);
+// Serializes only the values depending on given fields, torrent ID is always included
+SerializedTorrent serialize(const BitTorrent::Torrent &torrent, BitTorrent::TorrentStatusFields fields);
+// Serializes only the values of given keys
+SerializedTorrent serialize(const BitTorrent::Torrent &torrent, SerializedTorrent::KeySet keys);
+QVariant serializeValue(const BitTorrent::Torrent &torrent, SerializedTorrent::Key key);
+// Compares serialized values of the same key, used to sort the torrents
+bool serializedValueLessThan(const QVariant &left, const QVariant &right);
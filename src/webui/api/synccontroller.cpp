@@ -29,26 +29,32 @@
 #include "synccontroller.h"
 
 #include <algorithm>
+#include <utility>
 
-#include <QJsonArray>
+#include <QElapsedTimer>
 #include <QJsonObject>
 #include <QMetaObject>
 
+#include "base/activityscope.h"
 #include "base/algorithm.h"
 #include "base/bittorrent/cachestatus.h"
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/sessionmetrics.h"
 #include "base/bittorrent/sessionstatus.h"
 #include "base/bittorrent/torrent.h"
 #include "base/bittorrent/torrentinfo.h"
 #include "base/bittorrent/trackerentrystatus.h"
 #include "base/global.h"
+#include "base/http/responsestream.h"
+#include "base/http/types.h"
 #include "base/net/geoipmanager.h"
 #include "base/preferences.h"
 #include "base/utils/string.h"
 #include "apierror.h"
+#include "serialize/datawriter.h"
 #include "serialize/serialize_torrent.h"
 
 namespace
@@ -88,6 +94,7 @@ namespace
     const QString KEY_TRANSFER_DLRATELIMIT = u"dl_rate_limit"_s;
     const QString KEY_TRANSFER_DLSPEED = u"dl_info_speed"_s;
     const QString KEY_TRANSFER_FREESPACEONDISK = u"free_space_on_disk"_s;
+    const QString KEY_TRANSFER_FREESPACEONPATHS = u"free_space_on_paths"_s;
     const QString KEY_TRANSFER_UPDATA = u"up_info_data"_s;
     const QString KEY_TRANSFER_UPRATELIMIT = u"up_rate_limit"_s;
     const QString KEY_TRANSFER_UPSPEED = u"up_info_speed"_s;
@@ -117,10 +124,29 @@ namespace
     const QString KEY_TRACKERS = u"trackers"_s;
     const QString KEY_TRACKERS_REMOVED = KEY_TRACKERS + KEY_SUFFIX_REMOVED;
     const QString KEY_SERVER_STATE = u"server_state"_s;
+    const QString KEY_VIEWPORT = u"viewport"_s;
+    const QString KEY_VIEWPORT_OFFSET = u"offset"_s;
+    const QString KEY_VIEWPORT_TOTAL = u"total"_s;
+    const QString KEY_VIEWPORT_TORRENTS = u"torrents"_s;
     const QString KEY_FULL_UPDATE = u"full_update"_s;
     const QString KEY_RESPONSE_ID = u"rid"_s;
 
+    const QString CONTENT_TYPE_EVENT_STREAM = u"text/event-stream"_s;
+
+    // number of maindata revisions kept to send the changes made since them,
+    // covers a few minutes with default refresh interval
+    const int MAX_MAINDATA_REVISIONS = 100;
+
+    // torrent ID is written as the key of torrent values
+    const SerializedTorrent::KeySet MAINDATA_TORRENT_KEYS = SerializedTorrent::ALL_KEYS & ~SerializedTorrent::keySet(SerializedTorrent::ID);
+
     void processMap(const QVariantMap &prevData, const QVariantMap &data, QVariantMap &syncData);
+
+    // Server-Sent Events message
+    QByteArray toMaindataEvent(const int id, const QByteArray &syncData)
+    {
+        return "id: " + QByteArray::number(id) + "\nevent: maindata\ndata: " + syncData + "\n\n";
+    }
     void processHash(QVariantHash prevData, const QVariantHash &data, QVariantMap &syncData, QVariantList &removedItems);
     void processList(QVariantList prevData, const QVariantList &data, QVariantList &syncData, QVariantList &removedItems);
     QJsonObject generateSyncData(int acceptedResponseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData);
@@ -147,9 +173,9 @@ namespace
         map[KEY_TRANSFER_GLOBAL_RATIO] = ((atd > 0) && (atu > 0)) ? Utils::String::fromDouble(static_cast<qreal>(atu) / atd, 2) : u"-"_s;
         map[KEY_TRANSFER_TOTAL_PEER_CONNECTIONS] = sessionStatus.peersCount;
 
-        const qreal readRatio = cacheStatus.readRatio;  // TODO: remove when LIBTORRENT_VERSION_NUM >= 20000
+        const qreal readRatio = cacheStatus.readRatio;
         map[KEY_TRANSFER_READ_CACHE_HITS] = (readRatio > 0) ? Utils::String::fromDouble(100 * readRatio, 2) : u"0"_s;
-        map[KEY_TRANSFER_TOTAL_BUFFERS_SIZE] = cacheStatus.totalUsedBuffers * 16 * 1024;
+        map[KEY_TRANSFER_TOTAL_BUFFERS_SIZE] = (cacheStatus.totalUsedBuffers * 16 * 1024) + cacheStatus.readCacheSize;
 
         map[KEY_TRANSFER_WRITE_CACHE_OVERLOAD] = ((sessionStatus.diskWriteQueue > 0) && (sessionStatus.peersCount > 0))
             ? Utils::String::fromDouble((100. * sessionStatus.diskWriteQueue / sessionStatus.peersCount), 2)
@@ -349,6 +375,25 @@ namespace
         }
     }
 
+    // Apply the changes calculated by processMap() to the previous changes of the same structure.
+    void mergeMap(QVariantMap &map, const QVariantMap &changes)
+    {
+        for (auto i = changes.cbegin(); i != changes.cend(); ++i)
+        {
+            if (auto iter = map.find(i.key())
+                    ; (iter != map.end()) && (iter->userType() == QMetaType::QVariantMap) && (i.value().userType() == QMetaType::QVariantMap))
+            {
+                QVariantMap nestedMap = iter->toMap();
+                mergeMap(nestedMap, i.value().toMap());
+                *iter = nestedMap;
+            }
+            else
+            {
+                map.insert(i.key(), i.value());
+            }
+        }
+    }
+
     QJsonObject generateSyncData(int acceptedResponseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData)
     {
         QVariantMap syncData;
@@ -384,16 +429,26 @@ namespace
 
         return QJsonObject::fromVariantMap(syncData);
     }
+
+    BitTorrent::OperationTimings syncTimings;
 }
 
-SyncController::SyncController(IApplication *app, QObject *parent)
+SyncController::SyncController(MaindataChangeLog *maindataChangeLog, IApplication *app, QObject *parent)
     : APIController(app, parent)
+    , m_maindataChangeLog {maindataChangeLog}
 {
+    Q_ASSERT(m_maindataChangeLog);
 }
 
-void SyncController::updateFreeDiskSpace(const qint64 freeDiskSpace)
+SyncController::~SyncController()
 {
-    m_freeDiskSpace = freeDiskSpace;
+    if (m_maindataStream)
+        m_maindataStream->close();
+}
+
+BitTorrent::OperationTimings SyncController::maindataSyncTimings()
+{
+    return syncTimings;
 }
 
 // The function returns the changed data from the server to synchronize with the web client.
@@ -457,133 +512,351 @@ void SyncController::updateFreeDiskSpace(const qint64 freeDiskSpace)
 //  - "queueing": queue system usage flag
 //  - "refresh_interval": torrents table refresh interval
 //  - "free_space_on_disk": Free space on the default save path
+//  - "free_space_on_paths": Free space ("free") and its change rate per second ("rate") on each save/download path in use
 // GET param:
 //   - rid (int): last response id
+//   - viewport_count (int): number of torrents the client displays; if set, only the torrents
+//     of the viewport are sent, torrents leaving it are listed as removed ones and the response
+//     contains "viewport" map with "offset", "total" and ordered "torrents" IDs
+//   - viewport_offset (int): position of the first torrent of the viewport
+//   - viewport_sort (string): torrent key to sort by, "priority" by default
+//   - viewport_reverse (bool): whether to sort in descending order
+//   - viewport_filter, viewport_category, viewport_tag (string): same as the filter params of torrents/info
 void SyncController::maindataAction()
 {
-    if (m_maindataAcceptedID < 0)
-    {
-        makeMaindataSnapshot();
-
-        const auto *btSession = BitTorrent::Session::instance();
-        connect(btSession, &BitTorrent::Session::categoryAdded, this, &SyncController::onCategoryAdded);
-        connect(btSession, &BitTorrent::Session::categoryRemoved, this, &SyncController::onCategoryRemoved);
-        connect(btSession, &BitTorrent::Session::categoryOptionsChanged, this, &SyncController::onCategoryOptionsChanged);
-        connect(btSession, &BitTorrent::Session::subcategoriesSupportChanged, this, &SyncController::onSubcategoriesSupportChanged);
-        connect(btSession, &BitTorrent::Session::tagAdded, this, &SyncController::onTagAdded);
-        connect(btSession, &BitTorrent::Session::tagRemoved, this, &SyncController::onTagRemoved);
-        connect(btSession, &BitTorrent::Session::torrentAdded, this, &SyncController::onTorrentAdded);
-        connect(btSession, &BitTorrent::Session::torrentAboutToBeRemoved, this, &SyncController::onTorrentAboutToBeRemoved);
-        connect(btSession, &BitTorrent::Session::torrentCategoryChanged, this, &SyncController::onTorrentCategoryChanged);
-        connect(btSession, &BitTorrent::Session::torrentMetadataReceived, this, &SyncController::onTorrentMetadataReceived);
-        connect(btSession, &BitTorrent::Session::torrentStopped, this, &SyncController::onTorrentStopped);
-        connect(btSession, &BitTorrent::Session::torrentStarted, this, &SyncController::onTorrentStarted);
-        connect(btSession, &BitTorrent::Session::torrentSavePathChanged, this, &SyncController::onTorrentSavePathChanged);
-        connect(btSession, &BitTorrent::Session::torrentSavingModeChanged, this, &SyncController::onTorrentSavingModeChanged);
-        connect(btSession, &BitTorrent::Session::torrentTagAdded, this, &SyncController::onTorrentTagAdded);
-        connect(btSession, &BitTorrent::Session::torrentTagRemoved, this, &SyncController::onTorrentTagRemoved);
-        connect(btSession, &BitTorrent::Session::torrentsUpdated, this, &SyncController::onTorrentsUpdated);
-        connect(btSession, &BitTorrent::Session::trackersAdded, this, &SyncController::onTorrentTrackersChanged);
-        connect(btSession, &BitTorrent::Session::trackersRemoved, this, &SyncController::onTorrentTrackersChanged);
-        connect(btSession, &BitTorrent::Session::trackersChanged, this, &SyncController::onTorrentTrackersChanged);
-    }
+    const ActivityScope activityScope {"SyncController::maindataAction"};
+
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+
+    BitTorrent::Session::instance()->demandRefresh();
+
+    m_maindataChangeLog->update();
 
+    // the client is able to continue from any revision this session has sent it so far
     const int acceptedID = params()[u"rid"_s].toInt();
-    bool fullUpdate = true;
-    if ((acceptedID > 0) && (m_maindataLastSentID > 0))
+    const int baseRevision = ((acceptedID > 0) && (acceptedID <= m_maindataLastSentID)) ? acceptedID : 0;
+    if (const int viewportCount = params()[u"viewport_count"_s].toInt(); viewportCount > 0)
     {
-        if (m_maindataLastSentID == acceptedID)
-        {
-            m_maindataAcceptedID = acceptedID;
-            m_maindataSyncBuf = {};
-        }
+        const MaindataChangeLog::Viewport viewport = parseViewport(viewportCount);
+        // viewport torrents are known only for the revision sent last
+        const int viewportRevision = (baseRevision == m_maindataLastSentID) ? baseRevision : 0;
+        setResult(m_maindataChangeLog->viewportSyncData(viewportRevision, viewport, m_maindataViewportTorrents, resultFormat()), resultContentType());
+    }
+    else
+    {
+        m_maindataViewportTorrents.clear();
+        setResult(m_maindataChangeLog->syncData(baseRevision, MaindataChangeLog::Section::All, resultFormat()), resultContentType());
+    }
+    m_maindataLastSentID = m_maindataChangeLog->currentRevision();
 
-        if (m_maindataAcceptedID == acceptedID)
-        {
-            // We are still able to send changes for the current state of the data having by client.
-            fullUpdate = false;
-        }
+    syncTimings.add(syncTimer.nsecsElapsed());
+}
+
+MaindataChangeLog::Viewport SyncController::parseViewport(const int count) const
+{
+    MaindataChangeLog::Viewport viewport;
+    viewport.count = count;
+    viewport.offset = params()[u"viewport_offset"_s].toInt();
+    viewport.reverseOrder = Utils::String::parseBool(params()[u"viewport_reverse"_s]).value_or(false);
+
+    if (const QString sortKey = params()[u"viewport_sort"_s]; !sortKey.isEmpty())
+    {
+        const std::optional<SerializedTorrent::Key> key = SerializedTorrent::findKey(sortKey);
+        if (!key)
+            throw APIError(APIErrorType::BadParams, tr("'viewport_sort' parameter is invalid"));
+        viewport.sortKey = *key;
     }
 
-    const int id = (m_maindataLastSentID % 1000000) + 1;  // cycle between 1 and 1000000
-    setResult(generateMaindataSyncData(id, fullUpdate));
-    m_maindataLastSentID = id;
+    viewport.filter.setTypeByName(params()[u"viewport_filter"_s]);
+    if (const auto it = params().constFind(u"viewport_category"_s); it != params().cend())
+        viewport.filter.setCategory(it.value());
+    if (const auto it = params().constFind(u"viewport_tag"_s); it != params().cend())
+        viewport.filter.setTag(Tag(it.value()));
+
+    return viewport;
 }
 
-void SyncController::makeMaindataSnapshot()
+// Opens Server-Sent Events stream of maindata changes.
+// The first event contains full update, the following ones are sent as soon as
+// the data changes and contain only the changes, in the same format as sync/maindata response.
+// Each event is of "maindata" type and has its "rid" as event ID.
+// Only one stream is kept per session, opening a new one closes the previous stream.
+// GET param:
+//   - sections (string): comma separated list of the data to include,
+//     any of "torrents", "categories", "tags", "trackers" and "server_state", all of them by default
+void SyncController::maindataEventsAction()
 {
-    m_knownTrackers.clear();
-    m_maindataAcceptedID = 0;
-    m_maindataSnapshot = {};
+    using Section = MaindataChangeLog::Section;
+    const QHash<QString, Section> knownSections
+    {
+        {KEY_TORRENTS, Section::Torrents},
+        {KEY_CATEGORIES, Section::Categories},
+        {KEY_TAGS, Section::Tags},
+        {KEY_TRACKERS, Section::Trackers},
+        {KEY_SERVER_STATE, Section::ServerState}
+    };
+    MaindataChangeLog::Sections sections;
+    for (const QString &section : asConst(params()[u"sections"_s].split(u',', Qt::SkipEmptyParts)))
+    {
+        const QString name = section.trimmed();
+        const auto sectionIter = knownSections.constFind(name);
+        if (sectionIter == knownSections.cend())
+            throw APIError(APIErrorType::BadParams, tr("Unknown section: \"%1\"").arg(name));
+        sections |= sectionIter.value();
+    }
+    if (!sections)
+        sections = Section::All;
 
-    const auto *session = BitTorrent::Session::instance();
+    BitTorrent::Session::instance()->demandRefresh();
+
+    if (m_maindataStream)
+        m_maindataStream->close();
+
+    const auto *btSession = BitTorrent::Session::instance();
+    connect(btSession, &BitTorrent::Session::statsUpdated, this, &SyncController::scheduleMaindataPush, Qt::UniqueConnection);
+    connect(btSession, &BitTorrent::Session::torrentsUpdated, this, &SyncController::scheduleMaindataPush, Qt::UniqueConnection);
 
-    for (const BitTorrent::Torrent *torrent : asConst(session->torrents()))
+    m_maindataStreamSections = sections;
+    m_maindataStream = std::make_shared<Http::ResponseStream>();
+
+    setResult(generateMaindataEvent(true), m_maindataStream, CONTENT_TYPE_EVENT_STREAM);
+}
+
+QByteArray SyncController::generateMaindataEvent(const bool fullUpdate)
+{
+    m_maindataChangeLog->update();
+
+    // events are delivered in order, so each one is considered accepted by the client once it is sent
+    const int baseRevision = fullUpdate ? 0 : m_maindataLastSentID;
+    const bool hasChanges = fullUpdate || m_maindataChangeLog->hasChanges(baseRevision, m_maindataStreamSections);
+    m_maindataLastSentID = m_maindataChangeLog->currentRevision();
+    if (!hasChanges)
+        return {};
+
+    return toMaindataEvent(m_maindataLastSentID, m_maindataChangeLog->syncData(baseRevision, m_maindataStreamSections));
+}
+
+void SyncController::scheduleMaindataPush()
+{
+    if (!m_maindataStream || m_isMaindataPushScheduled)
+        return;
+
+    // coalesce the changes reported at once into single event
+    m_isMaindataPushScheduled = true;
+    QMetaObject::invokeMethod(this, &SyncController::pushMaindata, Qt::QueuedConnection);
+}
+
+void SyncController::pushMaindata()
+{
+    m_isMaindataPushScheduled = false;
+
+    if (!m_maindataStream)
+        return;
+
+    if (!m_maindataStream->isOpen())
     {
-        const BitTorrent::TorrentID torrentID = torrent->id();
+        m_maindataStream.reset();
+        return;
+    }
 
-        QVariantMap serializedTorrent = serialize(*torrent);
-        serializedTorrent.remove(KEY_TORRENT_ID);
+    QElapsedTimer syncTimer;
+    syncTimer.start();
 
-        for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
-            m_knownTrackers[status.url].insert(torrentID);
+    // keep torrent statuses refreshed at active rate while the client listens
+    BitTorrent::Session::instance()->demandRefresh();
+
+    if (const QByteArray event = generateMaindataEvent(false); !event.isEmpty())
+        m_maindataStream->write(event);
+
+    syncTimings.add(syncTimer.nsecsElapsed());
+}
+
+// GET param:
+//   - hash (string): torrent hash (ID)
+//   - rid (int): last response id
+void SyncController::torrentPeersAction()
+{
+    BitTorrent::Session::instance()->demandRefresh();
+
+    const auto id = BitTorrent::TorrentID::fromString(params()[u"hash"_s]);
+    const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(id);
+    if (!torrent)
+        throw APIError(APIErrorType::NotFound);
+
+    QVariantMap data;
+    QVariantHash peers;
 
-        m_maindataSnapshot.torrents[torrentID.toString()] = serializedTorrent;
+    const QVector<BitTorrent::PeerInfo> peersList = torrent->peers();
+
+    bool resolvePeerCountries = Preferences::instance()->resolvePeerCountries();
+
+    data[KEY_SYNC_TORRENT_PEERS_SHOW_FLAGS] = resolvePeerCountries;
+
+    if ((id != m_peersTorrentID) || (resolvePeerCountries != m_peersCountriesResolved))
+    {
+        m_peersTorrentID = id;
+        m_peersCountriesResolved = resolvePeerCountries;
+        m_peersDerivedData.clear();
     }
 
-    const QStringList categoriesList = session->categories();
-    for (const auto &categoryName : categoriesList)
+    QHash<QString, PeerDerivedData> peersDerivedData;
+    peersDerivedData.reserve(peersList.size());
+    peers.reserve(peersList.size());
+
+    // resolve countries of all the new peers at once
+    QList<qsizetype> newPeerIndexes;
+    for (qsizetype i = 0; i < peersList.size(); ++i)
     {
-        const BitTorrent::CategoryOptions categoryOptions = session->categoryOptions(categoryName);
-        QJsonObject category = categoryOptions.toJSON();
-        // adjust it to be compatible with existing WebAPI
-        category[u"savePath"_s] = category.take(u"save_path"_s);
-        category.insert(u"name"_s, categoryName);
-        m_maindataSnapshot.categories[categoryName] = category.toVariantMap();
+        const BitTorrent::PeerInfo &pi = peersList[i];
+        if (pi.address().ip.isNull())
+            continue;
+
+        const QString peerID = pi.address().toString();
+        if (const auto iter = m_peersDerivedData.constFind(peerID); iter != m_peersDerivedData.cend())
+            peersDerivedData.insert(peerID, iter.value());
+        else
+            newPeerIndexes.append(i);
     }
 
-    for (const Tag &tag : asConst(session->tags()))
-        m_maindataSnapshot.tags.append(tag.toString());
+    if (resolvePeerCountries && !newPeerIndexes.isEmpty())
+    {
+        QList<QHostAddress> addresses;
+        addresses.reserve(newPeerIndexes.size());
+        for (const qsizetype i : asConst(newPeerIndexes))
+            addresses.append(peersList[i].address().ip);
+        const QList<quint16> countryCodes = Net::GeoIPManager::instance()->lookupCountryCodes(addresses);
 
-    for (auto trackersIter = m_knownTrackers.cbegin(); trackersIter != m_knownTrackers.cend(); ++trackersIter)
+        for (qsizetype j = 0; j < newPeerIndexes.size(); ++j)
+        {
+            const QString country = Net::GeoIPManager::countryCodeToString(countryCodes[j]);
+            PeerDerivedData &derivedData = peersDerivedData[peersList[newPeerIndexes[j]].address().toString()];
+            derivedData.countryCode = country.toLower();
+            derivedData.country = Net::GeoIPManager::CountryName(country);
+        }
+    }
+
+    for (const BitTorrent::PeerInfo &pi : peersList)
     {
-        QStringList torrentIDs;
-        for (const BitTorrent::TorrentID &torrentID : asConst(trackersIter.value()))
-            torrentIDs.append(torrentID.toString());
+        if (pi.address().ip.isNull()) continue;
+
+        const QString peerID = pi.address().toString();
+        PeerDerivedData &derivedData = peersDerivedData[peerID];
+
+        QVariantMap peer =
+        {
+            {KEY_PEER_IP, pi.address().ip.toString()},
+            {KEY_PEER_PORT, pi.address().port},
+            {KEY_PEER_CLIENT, pi.client()},
+            {KEY_PEER_ID_CLIENT, pi.peerIdClient()},
+            {KEY_PEER_PROGRESS, pi.progress()},
+            {KEY_PEER_DOWN_SPEED, pi.payloadDownSpeed()},
+            {KEY_PEER_UP_SPEED, pi.payloadUpSpeed()},
+            {KEY_PEER_TOT_DOWN, pi.totalDownload()},
+            {KEY_PEER_TOT_UP, pi.totalUpload()},
+            {KEY_PEER_CONNECTION_TYPE, pi.connectionType()},
+            {KEY_PEER_FLAGS, pi.flags()},
+            {KEY_PEER_FLAGS_DESCRIPTION, pi.flagsDescription()},
+            {KEY_PEER_RELEVANCE, pi.relevance()},
+            {KEY_PEER_SHADOWBANNED, pi.isShadowBanned()}
+        };
+
+        if (torrent->hasMetadata())
+        {
+            if (const int pieceIndex = pi.downloadingPieceIndex()
+                    ; pieceIndex != derivedData.downloadingPieceIndex)
+            {
+                const PathList filePaths = torrent->info().filesForPiece(pieceIndex);
+                QStringList filesForPiece;
+                filesForPiece.reserve(filePaths.size());
+                for (const Path &filePath : filePaths)
+                    filesForPiece.append(filePath.toString());
+                derivedData.downloadingPieceIndex = pieceIndex;
+                derivedData.files = filesForPiece.join(u'\n');
+            }
+            peer.insert(KEY_PEER_FILES, derivedData.files);
+        }
+
+        if (resolvePeerCountries)
+        {
+            peer[KEY_PEER_COUNTRY_CODE] = derivedData.countryCode;
+            peer[KEY_PEER_COUNTRY] = derivedData.country;
+        }
 
-        m_maindataSnapshot.trackers[trackersIter.key()] = torrentIDs;
+        peers[peerID] = peer;
     }
+    data[u"peers"_s] = peers;
+    // data of the disconnected peers is dropped
+    m_peersDerivedData = peersDerivedData;
 
-    m_maindataSnapshot.serverState = getTransferInfo();
-    m_maindataSnapshot.serverState[KEY_TRANSFER_FREESPACEONDISK] = m_freeDiskSpace;
-    m_maindataSnapshot.serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
-    m_maindataSnapshot.serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
-    m_maindataSnapshot.serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
-    m_maindataSnapshot.serverState[KEY_SYNC_MAINDATA_USE_SUBCATEGORIES] = session->isSubcategoriesEnabled();
+    const int acceptedResponseId = params()[u"rid"_s].toInt();
+    setResult(generateSyncData(acceptedResponseId, data, m_lastAcceptedPeersResponse, m_lastPeersResponse));
 }
 
-QJsonObject SyncController::generateMaindataSyncData(const int id, const bool fullUpdate)
+MaindataChangeLog::MaindataChangeLog(QObject *parent)
+    : QObject(parent)
 {
-    // if need to update existing sync data
-    for (const QString &category : asConst(m_updatedCategories))
-        m_maindataSyncBuf.removedCategories.removeOne(category);
-    for (const QString &category : asConst(m_removedCategories))
-        m_maindataSyncBuf.categories.remove(category);
+    MemoryUsage::registerEstimator(this, [this] { return estimateMemoryUsage(); });
+}
 
-    for (const QString &tag : asConst(m_addedTags))
-        m_maindataSyncBuf.removedTags.removeOne(tag);
-    for (const QString &tag : asConst(m_removedTags))
-        m_maindataSyncBuf.tags.removeOne(tag);
+QList<MemoryUsage::Entry> MaindataChangeLog::estimateMemoryUsage() const
+{
+    qint64 snapshotSize = MemoryUsage::sizeOf(QVariant(m_snapshot.serverState)) + MemoryUsage::sizeOf(QVariant(m_snapshot.tags));
+    for (auto it = m_snapshot.torrents.cbegin(); it != m_snapshot.torrents.cend(); ++it)
+    {
+        snapshotSize += MemoryUsage::sizeOf(it.key()) + sizeof(SerializedTorrent);
+        for (const QVariant &value : it.value().values)
+            snapshotSize += MemoryUsage::sizeOf(value) - sizeof(QVariant);
+    }
+    for (auto it = m_snapshot.categories.cbegin(); it != m_snapshot.categories.cend(); ++it)
+        snapshotSize += MemoryUsage::sizeOf(it.key()) + MemoryUsage::sizeOf(QVariant(it.value()));
+    for (auto it = m_snapshot.trackers.cbegin(); it != m_snapshot.trackers.cend(); ++it)
+        snapshotSize += MemoryUsage::sizeOf(it.key()) + MemoryUsage::sizeOf(QVariant(it.value()));
+
+    // the changes refer to the items by their IDs, the values are taken from the snapshot
+    qint64 revisionsSize = 0;
+    for (const Revision &revision : m_revisions)
+    {
+        const MaindataSyncBuf &changes = revision.changes;
+        revisionsSize += sizeof(Revision)
+            + (changes.torrents.size() * (sizeof(QString) + sizeof(SerializedTorrent::KeySet) + (40 * sizeof(QChar))))
+            + ((changes.categories.size() + changes.trackers.size()) * sizeof(QString))
+            + ((changes.removedCategories.size() + changes.removedTags.size()
+                + changes.removedTorrents.size() + changes.removedTrackers.size()) * sizeof(QString));
+    }
 
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_updatedTorrents))
-        m_maindataSyncBuf.removedTorrents.removeOne(torrentID.toString());
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_removedTorrents))
-        m_maindataSyncBuf.torrents.remove(torrentID.toString());
+    qint64 cacheSize = 0;
+    for (const QByteArray &syncData : m_syncDataCache)
+        cacheSize += MemoryUsage::sizeOf(syncData);
 
-    for (const QString &tracker : asConst(m_updatedTrackers))
-        m_maindataSyncBuf.removedTrackers.removeOne(tracker);
-    for (const QString &tracker : asConst(m_removedTrackers))
-        m_maindataSyncBuf.trackers.remove(tracker);
+    return {
+        {u"webui.maindata.snapshot"_s, m_snapshot.torrents.size(), snapshotSize}
+        , {u"webui.maindata.revisions"_s, m_revisions.size(), revisionsSize}
+        , {u"webui.maindata.cache"_s, m_syncDataCache.size(), cacheSize}
+    };
+}
+
+int MaindataChangeLog::currentRevision() const
+{
+    return m_currentRevision;
+}
+
+void MaindataChangeLog::updateFreeDiskSpace(const qint64 freeDiskSpace, const QVariantMap &pathsInfo)
+{
+    m_freeDiskSpace = freeDiskSpace;
+    m_freeDiskSpaceOnPaths = pathsInfo;
+}
+
+void MaindataChangeLog::update()
+{
+    if (!m_isTracking)
+    {
+        // nothing is tracked until some client asks for the data
+        startTracking();
+        return;
+    }
+
+    MaindataSyncBuf changes;
 
     const auto *session = BitTorrent::Session::instance();
 
@@ -595,51 +868,60 @@ QJsonObject SyncController::generateMaindataSyncData(const int id, const bool fu
         category[u"savePath"_s] = category.take(u"save_path"_s);
         category.insert(u"name"_s, categoryName);
 
-        auto &categorySnapshot = m_maindataSnapshot.categories[categoryName];
-        processMap(categorySnapshot, category, m_maindataSyncBuf.categories[categoryName]);
+        auto &categorySnapshot = m_snapshot.categories[categoryName];
+        QVariantMap categoryChanges;
+        processMap(categorySnapshot, category, categoryChanges);
+        if (!categoryChanges.isEmpty())
+            changes.categories[categoryName] = categoryChanges;
         categorySnapshot = category;
     }
     m_updatedCategories.clear();
 
     for (const QString &category : asConst(m_removedCategories))
     {
-        m_maindataSyncBuf.removedCategories.append(category);
-        m_maindataSnapshot.categories.remove(category);
+        changes.removedCategories.append(category);
+        m_snapshot.categories.remove(category);
     }
     m_removedCategories.clear();
 
     for (const QString &tag : asConst(m_addedTags))
     {
-        m_maindataSyncBuf.tags.append(tag);
-        m_maindataSnapshot.tags.append(tag);
+        changes.tags.append(tag);
+        m_snapshot.tags.append(tag);
     }
     m_addedTags.clear();
 
     for (const QString &tag : asConst(m_removedTags))
     {
-        m_maindataSyncBuf.removedTags.append(tag);
-        m_maindataSnapshot.tags.removeOne(tag);
+        changes.removedTags.append(tag);
+        m_snapshot.tags.removeOne(tag);
     }
     m_removedTags.clear();
 
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_updatedTorrents))
+    for (const auto &[torrentID, changedFields] : asConst(m_updatedTorrents).asKeyValueRange())
     {
         const BitTorrent::Torrent *torrent = session->getTorrent(torrentID);
         Q_ASSERT(torrent);
 
-        QVariantMap serializedTorrent = serialize(*torrent);
-        serializedTorrent.remove(KEY_TORRENT_ID);
-
-        auto &torrentSnapshot = m_maindataSnapshot.torrents[torrentID.toString()];
-        processMap(torrentSnapshot, serializedTorrent, m_maindataSyncBuf.torrents[torrentID.toString()]);
-        torrentSnapshot = serializedTorrent;
+        const QString torrentIDString = torrentID.toString();
+        if (const auto snapshotIter = m_snapshot.torrents.find(torrentIDString); snapshotIter != m_snapshot.torrents.end())
+        {
+            // only the values depending on changed fields are serialized again
+            if (const SerializedTorrent::KeySet changedKeys = snapshotIter->update(serialize(*torrent, changedFields)) & MAINDATA_TORRENT_KEYS)
+                changes.torrents[torrentIDString] = changedKeys;
+        }
+        else
+        {
+            m_snapshot.torrents.insert(torrentIDString, serialize(*torrent));
+            changes.torrents[torrentIDString] = MAINDATA_TORRENT_KEYS;
+        }
     }
     m_updatedTorrents.clear();
 
     for (const BitTorrent::TorrentID &torrentID : asConst(m_removedTorrents))
     {
-        m_maindataSyncBuf.removedTorrents.append(torrentID.toString());
-        m_maindataSnapshot.torrents.remove(torrentID.toString());
+        changes.removedTorrents.append(torrentID.toString());
+        m_snapshot.torrents.remove(torrentID.toString());
     }
     m_removedTorrents.clear();
 
@@ -651,166 +933,483 @@ QJsonObject SyncController::generateMaindataSyncData(const int id, const bool fu
         for (const BitTorrent::TorrentID &torrentID : torrentIDs)
             serializedTorrentIDs.append(torrentID.toString());
 
-        m_maindataSyncBuf.trackers[tracker] = serializedTorrentIDs;
-        m_maindataSnapshot.trackers[tracker] = serializedTorrentIDs;
+        changes.trackers[tracker] = serializedTorrentIDs;
+        m_snapshot.trackers[tracker] = serializedTorrentIDs;
     }
     m_updatedTrackers.clear();
 
     for (const QString &tracker : asConst(m_removedTrackers))
     {
-        m_maindataSyncBuf.removedTrackers.append(tracker);
-        m_maindataSnapshot.trackers.remove(tracker);
+        changes.removedTrackers.append(tracker);
+        m_snapshot.trackers.remove(tracker);
     }
     m_removedTrackers.clear();
 
-    QVariantMap serverState = getTransferInfo();
-    serverState[KEY_TRANSFER_FREESPACEONDISK] = m_freeDiskSpace;
-    serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
-    serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
-    serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
-    serverState[KEY_SYNC_MAINDATA_USE_SUBCATEGORIES] = session->isSubcategoriesEnabled();
-    processMap(m_maindataSnapshot.serverState, serverState, m_maindataSyncBuf.serverState);
-    m_maindataSnapshot.serverState = serverState;
-
-    QJsonObject syncData;
-    syncData[KEY_RESPONSE_ID] = id;
-    if (fullUpdate)
+    const QVariantMap currentServerState = serverState();
+    processMap(m_snapshot.serverState, currentServerState, changes.serverState);
+    m_snapshot.serverState = currentServerState;
+
+    if (changes.isEmpty())
+        return;
+
+    m_revisions.append({++m_currentRevision, changes});
+    if (m_revisions.size() > MAX_MAINDATA_REVISIONS)
+        m_revisions.removeFirst();
+    m_syncDataCache.clear();
+}
+
+QByteArray MaindataChangeLog::syncData(const int revision, const Sections sections, const DataFormat format)
+{
+    // the clients being in sync usually ask for the changes since the same revision,
+    // so they share the data generated for the first one of them
+    const bool fullUpdate = isFullUpdateRequired(revision);
+    const SyncDataKey cacheKey {(fullUpdate ? 0 : revision), sections.toInt(), format};
+    if (const auto it = m_syncDataCache.constFind(cacheKey); it != m_syncDataCache.cend())
+        return it.value();
+
+    const QByteArray result = generateSyncData(collectChanges(revision, fullUpdate, sections), fullUpdate, sections, format);
+    m_syncDataCache.insert(cacheKey, result);
+    return result;
+}
+
+QByteArray MaindataChangeLog::viewportSyncData(const int revision, const Viewport &viewport
+        , QSet<QString> &viewportTorrents, const DataFormat format)
+{
+    const bool fullUpdate = isFullUpdateRequired(revision);
+    // torrents are handled below, only the ones of the viewport are sent
+    MaindataSyncBuf changes = collectChanges(revision, fullUpdate, Sections(Section::All).setFlag(Section::Torrents, false));
+    const ViewportData data = viewportData(viewport);
+
+    QSet<QString> newViewportTorrents;
+    newViewportTorrents.reserve(data.torrents.size());
+    for (const QString &torrentID : data.torrents)
     {
-        m_maindataSyncBuf = m_maindataSnapshot;
-        syncData[KEY_FULL_UPDATE] = true;
+        newViewportTorrents.insert(torrentID);
+
+        // the torrents which were not in the viewport are sent with all their data
+        if (fullUpdate || !viewportTorrents.contains(torrentID))
+        {
+            changes.torrents.insert(torrentID, MAINDATA_TORRENT_KEYS);
+            continue;
+        }
+
+        SerializedTorrent::KeySet changedKeys = 0;
+        for (const Revision &rev : asConst(m_revisions))
+        {
+            if (rev.id > revision)
+                changedKeys |= rev.changes.torrents.value(torrentID);
+        }
+        if (changedKeys != 0)
+            changes.torrents.insert(torrentID, changedKeys);
     }
 
-    if (!m_maindataSyncBuf.categories.isEmpty())
+    if (!fullUpdate)
     {
-        QJsonObject categories;
-        for (auto it = m_maindataSyncBuf.categories.cbegin(); it != m_maindataSyncBuf.categories.cend(); ++it)
-            categories[it.key()] = QJsonObject::fromVariantMap(it.value());
-        syncData[KEY_CATEGORIES] = categories;
+        // the torrents which left the viewport are reported as removed ones
+        for (const QString &torrentID : asConst(viewportTorrents))
+        {
+            if (!newViewportTorrents.contains(torrentID))
+                changes.removedTorrents.append(torrentID);
+        }
     }
-    if (!m_maindataSyncBuf.removedCategories.isEmpty())
-        syncData[KEY_CATEGORIES_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedCategories);
 
-    if (!m_maindataSyncBuf.tags.isEmpty())
-        syncData[KEY_TAGS] = QJsonArray::fromVariantList(m_maindataSyncBuf.tags);
-    if (!m_maindataSyncBuf.removedTags.isEmpty())
-        syncData[KEY_TAGS_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedTags);
+    viewportTorrents = std::move(newViewportTorrents);
+    return generateSyncData(changes, fullUpdate, Section::All, format, &data);
+}
 
-    if (!m_maindataSyncBuf.torrents.isEmpty())
+MaindataChangeLog::MaindataSyncBuf MaindataChangeLog::collectChanges(const int revision, const bool fullUpdate, const Sections sections) const
+{
+    MaindataSyncBuf changes;
+    if (fullUpdate)
+    {
+        changes.categories = m_snapshot.categories;
+        changes.tags = m_snapshot.tags;
+        changes.trackers = m_snapshot.trackers;
+        changes.serverState = m_snapshot.serverState;
+        if (sections.testFlag(Section::Torrents))
+        {
+            changes.torrents.reserve(m_snapshot.torrents.size());
+            for (auto it = m_snapshot.torrents.cbegin(); it != m_snapshot.torrents.cend(); ++it)
+                changes.torrents.insert(it.key(), MAINDATA_TORRENT_KEYS);
+        }
+    }
+    else
     {
-        QJsonObject torrents;
-        for (auto it = m_maindataSyncBuf.torrents.cbegin(); it != m_maindataSyncBuf.torrents.cend(); ++it)
-            torrents[it.key()] = QJsonObject::fromVariantMap(it.value());
-        syncData[KEY_TORRENTS] = torrents;
+        for (const Revision &rev : asConst(m_revisions))
+        {
+            if (rev.id > revision)
+                changes.merge(rev.changes);
+        }
+
+        if (!sections.testFlag(Section::Torrents))
+        {
+            changes.torrents.clear();
+            changes.removedTorrents.clear();
+        }
     }
-    if (!m_maindataSyncBuf.removedTorrents.isEmpty())
-        syncData[KEY_TORRENTS_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedTorrents);
 
-    if (!m_maindataSyncBuf.trackers.isEmpty())
+    return changes;
+}
+
+MaindataChangeLog::ViewportData MaindataChangeLog::viewportData(const Viewport &viewport) const
+{
+    const auto *session = BitTorrent::Session::instance();
+
+    QList<std::pair<QVariant, QString>> sortedTorrents;
+    sortedTorrents.reserve(m_snapshot.torrents.size());
+    for (auto it = m_snapshot.torrents.cbegin(); it != m_snapshot.torrents.cend(); ++it)
     {
-        QJsonObject trackers;
-        for (auto it = m_maindataSyncBuf.trackers.cbegin(); it != m_maindataSyncBuf.trackers.cend(); ++it)
-            trackers[it.key()] = QJsonArray::fromStringList(it.value());
-        syncData[KEY_TRACKERS] = trackers;
+        const BitTorrent::Torrent *torrent = session->getTorrent(BitTorrent::TorrentID::fromString(it.key()));
+        if (torrent && viewport.filter.match(torrent))
+            sortedTorrents.emplaceBack(it->values[viewport.sortKey], it.key());
     }
-    if (!m_maindataSyncBuf.removedTrackers.isEmpty())
-        syncData[KEY_TRACKERS_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedTrackers);
 
-    if (!m_maindataSyncBuf.serverState.isEmpty())
-        syncData[KEY_SERVER_STATE] = QJsonObject::fromVariantMap(m_maindataSyncBuf.serverState);
+    // torrents having equal values are ordered by their IDs so that pages don't overlap
+    std::sort(sortedTorrents.begin(), sortedTorrents.end()
+        , [reverse = viewport.reverseOrder](const auto &item1, const auto &item2)
+    {
+        if (serializedValueLessThan(item1.first, item2.first))
+            return !reverse;
+        if (serializedValueLessThan(item2.first, item1.first))
+            return reverse;
+        return item1.second < item2.second;
+    });
 
-    return syncData;
+    ViewportData data;
+    data.total = sortedTorrents.size();
+    data.offset = std::clamp(viewport.offset, 0, std::max(0, (data.total - 1)));
+    const int end = std::min(data.total, (data.offset + viewport.count));
+    data.torrents.reserve(std::max(0, (end - data.offset)));
+    for (int i = data.offset; i < end; ++i)
+        data.torrents.append(sortedTorrents[i].second);
+
+    return data;
 }
 
-// GET param:
-//   - hash (string): torrent hash (ID)
-//   - rid (int): last response id
-void SyncController::torrentPeersAction()
+bool MaindataChangeLog::hasChanges(const int revision, const Sections sections) const
 {
-    const auto id = BitTorrent::TorrentID::fromString(params()[u"hash"_s]);
-    const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(id);
-    if (!torrent)
-        throw APIError(APIErrorType::NotFound);
+    if (isFullUpdateRequired(revision))
+        return true;
 
-    QVariantMap data;
-    QVariantHash peers;
+    return std::any_of(m_revisions.cbegin(), m_revisions.cend(), [revision, sections](const Revision &rev)
+    {
+        return (rev.id > revision) && !rev.changes.isEmpty(sections);
+    });
+}
 
-    const QVector<BitTorrent::PeerInfo> peersList = torrent->peers();
+bool MaindataChangeLog::isFullUpdateRequired(const int revision) const
+{
+    const int oldestBaseRevision = m_currentRevision - m_revisions.size();
+    return (revision <= 0) || (revision < oldestBaseRevision) || (revision > m_currentRevision);
+}
 
-    bool resolvePeerCountries = Preferences::instance()->resolvePeerCountries();
+QByteArray MaindataChangeLog::generateSyncData(const MaindataSyncBuf &changes, const bool fullUpdate
+        , const Sections sections, const DataFormat format, const ViewportData *viewport) const
+{
+    QByteArray syncData;
+    DataWriter writer {syncData, format};
 
-    data[KEY_SYNC_TORRENT_PEERS_SHOW_FLAGS] = resolvePeerCountries;
+    const auto writeList = [&writer](const QString &key, const QStringList &items)
+    {
+        if (items.isEmpty())
+            return;
 
-    for (const BitTorrent::PeerInfo &pi : peersList)
+        writer.writeKey(key);
+        writer.beginArray();
+        for (const QString &item : items)
+            writer.writeString(item);
+        writer.endArray();
+    };
+
+    writer.beginObject();
+
+    writer.writeKey(KEY_RESPONSE_ID);
+    writer.writeInteger(m_currentRevision);
+    if (fullUpdate)
     {
-        if (pi.address().ip.isNull()) continue;
+        writer.writeKey(KEY_FULL_UPDATE);
+        writer.writeBool(true);
+    }
 
-        QVariantMap peer =
+    if (sections.testFlag(Section::Categories))
+    {
+        if (!changes.categories.isEmpty())
         {
-            {KEY_PEER_IP, pi.address().ip.toString()},
-            {KEY_PEER_PORT, pi.address().port},
-            {KEY_PEER_CLIENT, pi.client()},
-            {KEY_PEER_ID_CLIENT, pi.peerIdClient()},
-            {KEY_PEER_PROGRESS, pi.progress()},
-            {KEY_PEER_DOWN_SPEED, pi.payloadDownSpeed()},
-            {KEY_PEER_UP_SPEED, pi.payloadUpSpeed()},
-            {KEY_PEER_TOT_DOWN, pi.totalDownload()},
-            {KEY_PEER_TOT_UP, pi.totalUpload()},
-            {KEY_PEER_CONNECTION_TYPE, pi.connectionType()},
-            {KEY_PEER_FLAGS, pi.flags()},
-            {KEY_PEER_FLAGS_DESCRIPTION, pi.flagsDescription()},
-            {KEY_PEER_RELEVANCE, pi.relevance()},
-            {KEY_PEER_SHADOWBANNED, pi.isShadowBanned()}
-        };
+            writer.writeKey(KEY_CATEGORIES);
+            writer.beginObject();
+            for (auto it = changes.categories.cbegin(); it != changes.categories.cend(); ++it)
+            {
+                writer.writeKey(it.key());
+                writer.writeValue(it.value());
+            }
+            writer.endObject();
+        }
+        writeList(KEY_CATEGORIES_REMOVED, changes.removedCategories);
+    }
 
-        if (torrent->hasMetadata())
+    if (sections.testFlag(Section::Tags))
+    {
+        if (!changes.tags.isEmpty())
         {
-            const PathList filePaths = torrent->info().filesForPiece(pi.downloadingPieceIndex());
-            QStringList filesForPiece;
-            filesForPiece.reserve(filePaths.size());
-            for (const Path &filePath : filePaths)
-                filesForPiece.append(filePath.toString());
-            peer.insert(KEY_PEER_FILES, filesForPiece.join(u'\n'));
+            writer.writeKey(KEY_TAGS);
+            writer.writeValue(changes.tags);
         }
+        writeList(KEY_TAGS_REMOVED, changes.removedTags);
+    }
 
-        if (resolvePeerCountries)
+    if (sections.testFlag(Section::Torrents))
+    {
+        if (!changes.torrents.isEmpty())
         {
-            peer[KEY_PEER_COUNTRY_CODE] = pi.country().toLower();
-            peer[KEY_PEER_COUNTRY] = Net::GeoIPManager::CountryName(pi.country());
+            writer.writeKey(KEY_TORRENTS);
+            writer.beginObject();
+            for (auto it = changes.torrents.cbegin(); it != changes.torrents.cend(); ++it)
+            {
+                const auto torrentIter = m_snapshot.torrents.constFind(it.key());
+                Q_ASSERT(torrentIter != m_snapshot.torrents.cend());
+                if (torrentIter == m_snapshot.torrents.cend()) [[unlikely]]
+                    continue;
+
+                writer.writeKey(it.key());
+                torrentIter->write(writer, it.value());
+            }
+            writer.endObject();
         }
+        writeList(KEY_TORRENTS_REMOVED, changes.removedTorrents);
+    }
 
-        peers[pi.address().toString()] = peer;
+    if (sections.testFlag(Section::Trackers))
+    {
+        if (!changes.trackers.isEmpty())
+        {
+            writer.writeKey(KEY_TRACKERS);
+            writer.beginObject();
+            for (auto it = changes.trackers.cbegin(); it != changes.trackers.cend(); ++it)
+            {
+                writer.writeKey(it.key());
+                writer.writeValue(it.value());
+            }
+            writer.endObject();
+        }
+        writeList(KEY_TRACKERS_REMOVED, changes.removedTrackers);
     }
-    data[u"peers"_s] = peers;
 
-    const int acceptedResponseId = params()[u"rid"_s].toInt();
-    setResult(generateSyncData(acceptedResponseId, data, m_lastAcceptedPeersResponse, m_lastPeersResponse));
+    if (sections.testFlag(Section::ServerState) && !changes.serverState.isEmpty())
+    {
+        writer.writeKey(KEY_SERVER_STATE);
+        writer.writeValue(changes.serverState);
+    }
+
+    if (viewport)
+    {
+        writer.writeKey(KEY_VIEWPORT);
+        writer.beginObject();
+        writer.writeKey(KEY_VIEWPORT_OFFSET);
+        writer.writeInteger(viewport->offset);
+        writer.writeKey(KEY_VIEWPORT_TOTAL);
+        writer.writeInteger(viewport->total);
+        writer.writeKey(KEY_VIEWPORT_TORRENTS);
+        writer.beginArray();
+        for (const QString &torrentID : viewport->torrents)
+            writer.writeHash(torrentID);
+        writer.endArray();
+        writer.endObject();
+    }
+
+    writer.endObject();
+
+    return syncData;
+}
+
+void MaindataChangeLog::startTracking()
+{
+    m_isTracking = true;
+    m_currentRevision = 1;
+    makeSnapshot();
+
+    const auto *btSession = BitTorrent::Session::instance();
+    connect(btSession, &BitTorrent::Session::categoryAdded, this, &MaindataChangeLog::onCategoryAdded);
+    connect(btSession, &BitTorrent::Session::categoryRemoved, this, &MaindataChangeLog::onCategoryRemoved);
+    connect(btSession, &BitTorrent::Session::categoryOptionsChanged, this, &MaindataChangeLog::onCategoryOptionsChanged);
+    connect(btSession, &BitTorrent::Session::subcategoriesSupportChanged, this, &MaindataChangeLog::onSubcategoriesSupportChanged);
+    connect(btSession, &BitTorrent::Session::tagAdded, this, &MaindataChangeLog::onTagAdded);
+    connect(btSession, &BitTorrent::Session::tagRemoved, this, &MaindataChangeLog::onTagRemoved);
+    // also reports torrents restored in the background after startup
+    connect(btSession, &BitTorrent::Session::torrentsLoaded, this, &MaindataChangeLog::onTorrentsLoaded);
+    connect(btSession, &BitTorrent::Session::torrentsAboutToBeRemoved, this, &MaindataChangeLog::onTorrentsAboutToBeRemoved);
+    connect(btSession, &BitTorrent::Session::torrentCategoryChanged, this, &MaindataChangeLog::onTorrentCategoryChanged);
+    connect(btSession, &BitTorrent::Session::torrentMetadataReceived, this, &MaindataChangeLog::onTorrentMetadataReceived);
+    connect(btSession, &BitTorrent::Session::torrentStopped, this, &MaindataChangeLog::onTorrentStopped);
+    connect(btSession, &BitTorrent::Session::torrentStarted, this, &MaindataChangeLog::onTorrentStarted);
+    connect(btSession, &BitTorrent::Session::torrentSavePathChanged, this, &MaindataChangeLog::onTorrentSavePathChanged);
+    connect(btSession, &BitTorrent::Session::torrentSavingModeChanged, this, &MaindataChangeLog::onTorrentSavingModeChanged);
+    connect(btSession, &BitTorrent::Session::torrentTagAdded, this, &MaindataChangeLog::onTorrentTagAdded);
+    connect(btSession, &BitTorrent::Session::torrentTagRemoved, this, &MaindataChangeLog::onTorrentTagRemoved);
+    connect(btSession, &BitTorrent::Session::torrentsCategoryChanged, this
+            , [this](const QHash<BitTorrent::Torrent *, QString> &oldCategories)
+    {
+        onTorrentsChanged(oldCategories.keys());
+    });
+    connect(btSession, &BitTorrent::Session::torrentsTagAdded, this, &MaindataChangeLog::onTorrentsChanged);
+    connect(btSession, &BitTorrent::Session::torrentsTagRemoved, this, &MaindataChangeLog::onTorrentsChanged);
+    connect(btSession, &BitTorrent::Session::torrentsUpdated, this, &MaindataChangeLog::onTorrentsUpdated);
+    connect(btSession, &BitTorrent::Session::trackersAdded, this, &MaindataChangeLog::onTorrentTrackersChanged);
+    connect(btSession, &BitTorrent::Session::trackersRemoved, this, &MaindataChangeLog::onTorrentTrackersChanged);
+    connect(btSession, &BitTorrent::Session::trackersChanged, this, &MaindataChangeLog::onTorrentTrackersChanged);
+}
+
+QVariantMap MaindataChangeLog::serverState() const
+{
+    const auto *session = BitTorrent::Session::instance();
+
+    QVariantMap map = getTransferInfo();
+    map[KEY_TRANSFER_FREESPACEONDISK] = m_freeDiskSpace;
+    map[KEY_TRANSFER_FREESPACEONPATHS] = m_freeDiskSpaceOnPaths;
+    map[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
+    map[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
+    map[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
+    map[KEY_SYNC_MAINDATA_USE_SUBCATEGORIES] = session->isSubcategoriesEnabled();
+    return map;
+}
+
+void MaindataChangeLog::makeSnapshot()
+{
+    m_knownTrackers.clear();
+    m_snapshot = {};
+
+    const auto *session = BitTorrent::Session::instance();
+
+    for (const BitTorrent::Torrent *torrent : session->torrentsView())
+    {
+        const BitTorrent::TorrentID torrentID = torrent->id();
+
+        for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
+            m_knownTrackers[status.url].insert(torrentID);
+
+        m_snapshot.torrents.insert(torrentID.toString(), serialize(*torrent));
+    }
+
+    const QStringList categoriesList = session->categories();
+    for (const auto &categoryName : categoriesList)
+    {
+        const BitTorrent::CategoryOptions categoryOptions = session->categoryOptions(categoryName);
+        QJsonObject category = categoryOptions.toJSON();
+        // adjust it to be compatible with existing WebAPI
+        category[u"savePath"_s] = category.take(u"save_path"_s);
+        category.insert(u"name"_s, categoryName);
+        m_snapshot.categories[categoryName] = category.toVariantMap();
+    }
+
+    for (const Tag &tag : asConst(session->tags()))
+        m_snapshot.tags.append(tag.toString());
+
+    for (auto trackersIter = m_knownTrackers.cbegin(); trackersIter != m_knownTrackers.cend(); ++trackersIter)
+    {
+        QStringList torrentIDs;
+        for (const BitTorrent::TorrentID &torrentID : asConst(trackersIter.value()))
+            torrentIDs.append(torrentID.toString());
+
+        m_snapshot.trackers[trackersIter.key()] = torrentIDs;
+    }
+
+    m_snapshot.serverState = serverState();
+}
+
+bool MaindataChangeLog::MaindataSyncBuf::isEmpty(const Sections sections) const
+{
+    if (sections.testFlag(Section::Categories) && (!categories.isEmpty() || !removedCategories.isEmpty()))
+        return false;
+    if (sections.testFlag(Section::Tags) && (!tags.isEmpty() || !removedTags.isEmpty()))
+        return false;
+    if (sections.testFlag(Section::Torrents) && (!torrents.isEmpty() || !removedTorrents.isEmpty()))
+        return false;
+    if (sections.testFlag(Section::Trackers) && (!trackers.isEmpty() || !removedTrackers.isEmpty()))
+        return false;
+    if (sections.testFlag(Section::ServerState) && !serverState.isEmpty())
+        return false;
+    return true;
+}
+
+// Applies the changes of the following revision
+void MaindataChangeLog::MaindataSyncBuf::merge(const MaindataSyncBuf &changes)
+{
+    for (const QString &category : changes.removedCategories)
+    {
+        categories.remove(category);
+        if (!removedCategories.contains(category))
+            removedCategories.append(category);
+    }
+    for (auto it = changes.categories.cbegin(); it != changes.categories.cend(); ++it)
+    {
+        removedCategories.removeOne(it.key());
+        mergeMap(categories[it.key()], it.value());
+    }
+
+    for (const QString &tag : changes.removedTags)
+    {
+        tags.removeOne(tag);
+        if (!removedTags.contains(tag))
+            removedTags.append(tag);
+    }
+    for (const QVariant &tag : changes.tags)
+    {
+        removedTags.removeOne(tag.toString());
+        if (!tags.contains(tag))
+            tags.append(tag);
+    }
+
+    for (const QString &torrentID : changes.removedTorrents)
+    {
+        torrents.remove(torrentID);
+        if (!removedTorrents.contains(torrentID))
+            removedTorrents.append(torrentID);
+    }
+    for (auto it = changes.torrents.cbegin(); it != changes.torrents.cend(); ++it)
+    {
+        removedTorrents.removeOne(it.key());
+        torrents[it.key()] |= it.value();
+    }
+
+    for (const QString &tracker : changes.removedTrackers)
+    {
+        trackers.remove(tracker);
+        if (!removedTrackers.contains(tracker))
+            removedTrackers.append(tracker);
+    }
+    for (auto it = changes.trackers.cbegin(); it != changes.trackers.cend(); ++it)
+    {
+        removedTrackers.removeOne(it.key());
+        trackers[it.key()] = it.value();
+    }
+
+    mergeMap(serverState, changes.serverState);
 }
 
-void SyncController::onCategoryAdded(const QString &categoryName)
+void MaindataChangeLog::onCategoryAdded(const QString &categoryName)
 {
     m_removedCategories.remove(categoryName);
     m_updatedCategories.insert(categoryName);
 }
 
-void SyncController::onCategoryRemoved(const QString &categoryName)
+void MaindataChangeLog::onCategoryRemoved(const QString &categoryName)
 {
     m_updatedCategories.remove(categoryName);
     m_removedCategories.insert(categoryName);
 }
 
-void SyncController::onCategoryOptionsChanged(const QString &categoryName)
+void MaindataChangeLog::onCategoryOptionsChanged(const QString &categoryName)
 {
     Q_ASSERT(!m_removedCategories.contains(categoryName));
 
     m_updatedCategories.insert(categoryName);
 }
 
-void SyncController::onSubcategoriesSupportChanged()
+void MaindataChangeLog::onSubcategoriesSupportChanged()
 {
     const QStringList categoriesList = BitTorrent::Session::instance()->categories();
     for (const auto &categoryName : categoriesList)
     {
-        if (!m_maindataSnapshot.categories.contains(categoryName))
+        if (!m_snapshot.categories.contains(categoryName))
         {
             m_removedCategories.remove(categoryName);
             m_updatedCategories.insert(categoryName);
@@ -818,24 +1417,24 @@ void SyncController::onSubcategoriesSupportChanged()
     }
 }
 
-void SyncController::onTagAdded(const Tag &tag)
+void MaindataChangeLog::onTagAdded(const Tag &tag)
 {
     m_removedTags.remove(tag.toString());
     m_addedTags.insert(tag.toString());
 }
 
-void SyncController::onTagRemoved(const Tag &tag)
+void MaindataChangeLog::onTagRemoved(const Tag &tag)
 {
     m_addedTags.remove(tag.toString());
     m_removedTags.insert(tag.toString());
 }
 
-void SyncController::onTorrentAdded(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentAdded(BitTorrent::Torrent *torrent)
 {
     const BitTorrent::TorrentID torrentID = torrent->id();
 
     m_removedTorrents.remove(torrentID);
-    m_updatedTorrents.insert(torrentID);
+    m_updatedTorrents.insert(torrentID, BitTorrent::TorrentStatusField::All);
 
     for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
     {
@@ -845,7 +1444,19 @@ void SyncController::onTorrentAdded(BitTorrent::Torrent *torrent)
     }
 }
 
-void SyncController::onTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentsLoaded(const QVector<BitTorrent::Torrent *> &torrents)
+{
+    for (BitTorrent::Torrent *torrent : torrents)
+        onTorrentAdded(torrent);
+}
+
+void MaindataChangeLog::onTorrentsAboutToBeRemoved(const QVector<BitTorrent::Torrent *> &torrents)
+{
+    for (BitTorrent::Torrent *const torrent : torrents)
+        onTorrentAboutToBeRemoved(torrent);
+}
+
+void MaindataChangeLog::onTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent)
 {
     const BitTorrent::TorrentID torrentID = torrent->id();
 
@@ -874,54 +1485,61 @@ void SyncController::onTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent)
     }
 }
 
-void SyncController::onTorrentCategoryChanged(BitTorrent::Torrent *torrent
+void MaindataChangeLog::onTorrentCategoryChanged(BitTorrent::Torrent *torrent
         , [[maybe_unused]] const QString &oldCategory)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentMetadataReceived(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentMetadataReceived(BitTorrent::Torrent *torrent)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentStopped(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentStopped(BitTorrent::Torrent *torrent)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentStarted(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentStarted(BitTorrent::Torrent *torrent)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentSavePathChanged(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentSavePathChanged(BitTorrent::Torrent *torrent)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentSavingModeChanged(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentSavingModeChanged(BitTorrent::Torrent *torrent)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentTagAdded(BitTorrent::Torrent *torrent, [[maybe_unused]] const Tag &tag)
+void MaindataChangeLog::onTorrentTagAdded(BitTorrent::Torrent *torrent, [[maybe_unused]] const Tag &tag)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentTagRemoved(BitTorrent::Torrent *torrent, [[maybe_unused]] const Tag &tag)
+void MaindataChangeLog::onTorrentTagRemoved(BitTorrent::Torrent *torrent, [[maybe_unused]] const Tag &tag)
 {
-    m_updatedTorrents.insert(torrent->id());
+    m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
 }
 
-void SyncController::onTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents)
+void MaindataChangeLog::onTorrentsChanged(const QVector<BitTorrent::Torrent *> &torrents)
 {
     for (const BitTorrent::Torrent *torrent : torrents)
-        m_updatedTorrents.insert(torrent->id());
+        m_updatedTorrents.insert(torrent->id(), BitTorrent::TorrentStatusField::All);
+}
+
+void MaindataChangeLog::onTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents
+        , const QVector<BitTorrent::TorrentStatusFields> &changedFields)
+{
+    for (qsizetype i = 0; i < torrents.size(); ++i)
+        m_updatedTorrents[torrents[i]->id()] |= changedFields[i];
 }
 
-void SyncController::onTorrentTrackersChanged(BitTorrent::Torrent *torrent)
+void MaindataChangeLog::onTorrentTrackersChanged(BitTorrent::Torrent *torrent)
 {
     using namespace BitTorrent;
 
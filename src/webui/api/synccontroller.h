@@ -28,38 +28,152 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <cstddef>
+
+#include <QByteArray>
+#include <QFlags>
+#include <QHash>
+#include <QList>
+#include <QObject>
 #include <QSet>
 #include <QVariantMap>
 
 #include "base/bittorrent/infohash.h"
+#include "base/bittorrent/torrentstatusfield.h"
+#include "base/memoryusage.h"
 #include "base/tag.h"
+#include "base/torrentfilter.h"
 #include "apicontroller.h"
+#include "serialize/serialize_torrent.h"
 
 namespace BitTorrent
 {
     class Torrent;
+    struct OperationTimings;
 }
 
-class SyncController : public APIController
+namespace Http
+{
+    class ResponseStream;
+}
+
+// Session-wide log of maindata changes shared by the sync controllers of all the WebUI sessions.
+// The data is serialized and compared with its previous state once per update regardless of
+// the number of clients, the changes are recorded as revisions kept in a ring buffer, so each
+// client only needs to know the revision it has received last.
+class MaindataChangeLog final : public QObject
 {
     Q_OBJECT
-    Q_DISABLE_COPY_MOVE(SyncController)
+    Q_DISABLE_COPY_MOVE(MaindataChangeLog)
 
 public:
-    using APIController::APIController;
+    enum class Section
+    {
+        Categories = 1,
+        Tags = 2,
+        Torrents = 4,
+        Trackers = 8,
+        ServerState = 16,
 
-    explicit SyncController(IApplication *app, QObject *parent = nullptr);
+        All = Categories | Tags | Torrents | Trackers | ServerState
+    };
+    Q_DECLARE_FLAGS(Sections, Section)
 
-public slots:
-    void updateFreeDiskSpace(qint64 freeDiskSpace);
+    // Part of the filtered and sorted torrent list the client displays
+    struct Viewport
+    {
+        TorrentFilter filter;
+        SerializedTorrent::Key sortKey = SerializedTorrent::QueuePosition;
+        bool reverseOrder = false;
+        int offset = 0;
+        int count = 0;
+    };
 
-private slots:
-    void maindataAction();
-    void torrentPeersAction();
+    explicit MaindataChangeLog(QObject *parent = nullptr);
+
+    // Records the changes made since the previous update as new revision
+    void update();
+    int currentRevision() const;
+    // Returns the changes made after the given revision written in the given format
+    // or the full data if the revision is unknown or no longer kept
+    QByteArray syncData(int revision, Sections sections = Section::All, DataFormat format = DataFormat::JSON);
+    // Returns the changes made after the given revision like syncData() does, but the torrents
+    // are limited to the ones currently in the viewport. The client is supposed to keep only
+    // the torrents of the viewport it was sent last, their IDs are passed with viewportTorrents
+    // and replaced with the IDs of the torrents sent this time.
+    QByteArray viewportSyncData(int revision, const Viewport &viewport, QSet<QString> &viewportTorrents, DataFormat format = DataFormat::JSON);
+    // Whether the data of the given sections has changed after the revision
+    bool hasChanges(int revision, Sections sections) const;
+
+public slots:
+    void updateFreeDiskSpace(qint64 freeDiskSpace, const QVariantMap &pathsInfo);
 
 private:
-    void makeMaindataSnapshot();
-    QJsonObject generateMaindataSyncData(int id, bool fullUpdate);
+    struct MaindataSyncBuf
+    {
+        bool isEmpty(Sections sections = Section::All) const;
+        void merge(const MaindataSyncBuf &changes);
+
+        QHash<QString, QVariantMap> categories;
+        QVariantList tags;
+        // keys of the changed values of the torrents, the values themselves are taken from snapshot
+        QHash<QString, SerializedTorrent::KeySet> torrents;
+        QHash<QString, QStringList> trackers;
+        QVariantMap serverState;
+
+        QStringList removedCategories;
+        QStringList removedTags;
+        QStringList removedTorrents;
+        QStringList removedTrackers;
+    };
+
+    struct MaindataSnapshot
+    {
+        QHash<QString, QVariantMap> categories;
+        QVariantList tags;
+        QHash<QString, SerializedTorrent> torrents;
+        QHash<QString, QStringList> trackers;
+        QVariantMap serverState;
+    };
+
+    struct Revision
+    {
+        int id = 0;
+        MaindataSyncBuf changes;
+    };
+
+    struct ViewportData
+    {
+        int offset = 0;
+        int total = 0;
+        QStringList torrents;
+    };
+
+    struct SyncDataKey
+    {
+        int baseRevision = 0;
+        int sections = 0;
+        DataFormat format = DataFormat::JSON;
+
+        friend bool operator==(const SyncDataKey &left, const SyncDataKey &right) = default;
+
+        friend std::size_t qHash(const SyncDataKey &key, const std::size_t seed = 0)
+        {
+            return qHashMulti(seed, key.baseRevision, key.sections, static_cast<int>(key.format));
+        }
+    };
+
+    void startTracking();
+    void makeSnapshot();
+    QList<MemoryUsage::Entry> estimateMemoryUsage() const;
+    QVariantMap serverState() const;
+    bool isFullUpdateRequired(int revision) const;
+    MaindataSyncBuf collectChanges(int revision, bool fullUpdate, Sections sections) const;
+    ViewportData viewportData(const Viewport &viewport) const;
+    QByteArray generateSyncData(const MaindataSyncBuf &changes, bool fullUpdate, Sections sections, DataFormat format
+            , const ViewportData *viewport = nullptr) const;
 
     void onCategoryAdded(const QString &categoryName);
     void onCategoryRemoved(const QString &categoryName);
@@ -68,7 +182,9 @@ private:
     void onTagAdded(const Tag &tag);
     void onTagRemoved(const Tag &tag);
     void onTorrentAdded(BitTorrent::Torrent *torrent);
+    void onTorrentsLoaded(const QVector<BitTorrent::Torrent *> &torrents);
     void onTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent);
+    void onTorrentsAboutToBeRemoved(const QVector<BitTorrent::Torrent *> &torrents);
     void onTorrentCategoryChanged(BitTorrent::Torrent *torrent, const QString &oldCategory);
     void onTorrentMetadataReceived(BitTorrent::Torrent *torrent);
     void onTorrentStopped(BitTorrent::Torrent *torrent);
@@ -77,13 +193,13 @@ private:
     void onTorrentSavingModeChanged(BitTorrent::Torrent *torrent);
     void onTorrentTagAdded(BitTorrent::Torrent *torrent, const Tag &tag);
     void onTorrentTagRemoved(BitTorrent::Torrent *torrent, const Tag &tag);
-    void onTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents);
+    void onTorrentsChanged(const QVector<BitTorrent::Torrent *> &torrents);
+    void onTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents, const QVector<BitTorrent::TorrentStatusFields> &changedFields);
     void onTorrentTrackersChanged(BitTorrent::Torrent *torrent);
 
+    bool m_isTracking = false;
     qint64 m_freeDiskSpace = 0;
-
-    QVariantMap m_lastPeersResponse;
-    QVariantMap m_lastAcceptedPeersResponse;
+    QVariantMap m_freeDiskSpaceOnPaths;
 
     QHash<QString, QSet<BitTorrent::TorrentID>> m_knownTrackers;
 
@@ -93,25 +209,69 @@ private:
     QSet<QString> m_removedTags;
     QSet<QString> m_updatedTrackers;
     QSet<QString> m_removedTrackers;
-    QSet<BitTorrent::TorrentID> m_updatedTorrents;
+    QHash<BitTorrent::TorrentID, BitTorrent::TorrentStatusFields> m_updatedTorrents;
     QSet<BitTorrent::TorrentID> m_removedTorrents;
 
-    struct MaindataSyncBuf
-    {
-        QHash<QString, QVariantMap> categories;
-        QVariantList tags;
-        QHash<QString, QVariantMap> torrents;
-        QHash<QString, QStringList> trackers;
-        QVariantMap serverState;
+    MaindataSnapshot m_snapshot;
+    // changes of the most recent revisions, oldest first
+    QList<Revision> m_revisions;
+    int m_currentRevision = 0;
+    // sync data of the current revision generated so far, by the revision it is based on, its sections and format
+    QHash<SyncDataKey, QByteArray> m_syncDataCache;
+};
 
-        QStringList removedCategories;
-        QStringList removedTags;
-        QStringList removedTorrents;
-        QStringList removedTrackers;
+Q_DECLARE_OPERATORS_FOR_FLAGS(MaindataChangeLog::Sections)
+
+class SyncController : public APIController
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(SyncController)
+
+public:
+    SyncController(MaindataChangeLog *maindataChangeLog, IApplication *app, QObject *parent = nullptr);
+    ~SyncController() override;
+
+    // Time spent on generating main data of all the sessions
+    static BitTorrent::OperationTimings maindataSyncTimings();
+
+private slots:
+    void maindataAction();
+    void maindataEventsAction();
+    void torrentPeersAction();
+
+private:
+    // Returns empty event if there are no changes
+    QByteArray generateMaindataEvent(bool fullUpdate);
+    MaindataChangeLog::Viewport parseViewport(int count) const;
+    void scheduleMaindataPush();
+    void pushMaindata();
+
+    MaindataChangeLog *m_maindataChangeLog = nullptr;
+
+    // Peer fields which are expensive to obtain are kept between the requests
+    // and updated only for new peers or when the downloading piece changes
+    struct PeerDerivedData
+    {
+        // files are resolved for this piece
+        std::optional<int> downloadingPieceIndex;
+        QString files;
+        QString countryCode;
+        QString country;
     };
 
-    MaindataSyncBuf m_maindataSnapshot;
-    MaindataSyncBuf m_maindataSyncBuf;
+    QVariantMap m_lastPeersResponse;
+    QVariantMap m_lastAcceptedPeersResponse;
+    BitTorrent::TorrentID m_peersTorrentID;
+    bool m_peersCountriesResolved = false;
+    QHash<QString, PeerDerivedData> m_peersDerivedData;
+
+    // revision of the maindata sent to the client last
     int m_maindataLastSentID = 0;
-    int m_maindataAcceptedID = -1;
+    // torrents of the viewport sent to the client last, if it uses one
+    QSet<QString> m_maindataViewportTorrents;
+
+    // maindata changes pushed to the client as Server-Sent Events
+    std::shared_ptr<Http::ResponseStream> m_maindataStream;
+    MaindataChangeLog::Sections m_maindataStreamSections;
+    bool m_isMaindataPushScheduled = false;
 };
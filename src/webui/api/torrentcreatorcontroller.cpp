@@ -41,6 +41,7 @@
 #include "apierror.h"
 
 const QString KEY_COMMENT = u"comment"_s;
+const QString KEY_ETA = u"eta"_s;
 const QString KEY_ERROR_MESSAGE = u"errorMessage"_s;
 const QString KEY_FORMAT = u"format"_s;
 const QString KEY_OPTIMIZE_ALIGNMENT = u"optimizeAlignment"_s;
@@ -48,6 +49,8 @@ const QString KEY_PADDED_FILE_SIZE_LIMIT = u"paddedFileSizeLimit"_s;
 const QString KEY_PIECE_SIZE = u"pieceSize"_s;
 const QString KEY_PRIVATE = u"private"_s;
 const QString KEY_PROGRESS = u"progress"_s;
+const QString KEY_QUEUE_POSITION = u"queuePosition"_s;
+const QString KEY_REUSE_PIECE_HASHES = u"reusePieceHashes"_s;
 const QString KEY_SOURCE = u"source"_s;
 const QString KEY_SOURCE_PATH = u"sourcePath"_s;
 const QString KEY_STATUS = u"status"_s;
@@ -131,7 +134,8 @@ void TorrentCreatorController::addTaskAction()
         .comment = params()[KEY_COMMENT],
         .source = params()[KEY_SOURCE],
         .trackers = params()[KEY_TRACKERS].split(u'|'),
-        .urlSeeds = params()[KEY_URL_SEEDS].split(u'|')
+        .urlSeeds = params()[KEY_URL_SEEDS].split(u'|'),
+        .reuseExistingPieceHashes = parseBool(params()[KEY_REUSE_PIECE_HASHES]).value_or(false)
     };
 
     bool const startSeeding = parseBool(params()[u"startSeeding"_s]).value_or(createTorrentParams.torrentFilePath.isEmpty());
@@ -170,6 +174,7 @@ void TorrentCreatorController::statusAction()
             {KEY_PADDED_FILE_SIZE_LIMIT, task->params().paddedFileSizeLimit},
 #endif
             {KEY_STATUS, taskStatusString(task)},
+            {KEY_REUSE_PIECE_HASHES, task->params().reuseExistingPieceHashes},
         };
 
         if (!task->params().comment.isEmpty())
@@ -207,6 +212,11 @@ void TorrentCreatorController::statusAction()
         else if (task->isRunning())
         {
             taskJson[KEY_PROGRESS] = task->progress();
+            taskJson[KEY_ETA] = task->eta();
+        }
+        else if (const int queuePosition = m_torrentCreationManager->queuePosition(task->id()); queuePosition > 0)
+        {
+            taskJson[KEY_QUEUE_POSITION] = queuePosition;
         }
 
         statusArray.append(taskJson);
@@ -0,0 +1,134 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentfilestree.h"
+
+#include "base/bittorrent/torrent.h"
+#include "base/global.h"
+
+TorrentFilesTree::TorrentFilesTree(const BitTorrent::Torrent &torrent)
+    : m_torrentID {torrent.id()}
+    , m_filePaths {torrent.filePaths()}
+    , m_filePriorities {torrent.filePriorities()}
+    , m_filesProgress {torrent.filesProgress()}
+{
+    const int filesCount = m_filePaths.size();
+    Q_ASSERT((m_filePriorities.size() == filesCount) && (m_filesProgress.size() == filesCount));
+    if ((m_filePriorities.size() != filesCount) || (m_filesProgress.size() != filesCount)) [[unlikely]]
+        return;
+
+    m_items.append({});
+    m_folderItemIndexes.append(0);
+
+    for (int fileIndex = 0; fileIndex < filesCount; ++fileIndex)
+    {
+        // need to provide paths using a platform-independent separator format
+        const QString filePath = m_filePaths[fileIndex].data();
+
+        // folders are looked up by their names within the parent folder,
+        // so the path of each folder is only made when the folder is added
+        PathInterner::ID folderID = PathInterner::ROOT_ID;
+        qsizetype nameStart = 0;
+        for (qsizetype separatorPos = filePath.indexOf(u'/'); separatorPos >= 0; separatorPos = filePath.indexOf(u'/', (separatorPos + 1)))
+        {
+            const PathInterner::ID parentFolderID = folderID;
+            folderID = m_folders.intern(parentFolderID, QStringView(filePath).sliced(nameStart, (separatorPos - nameStart)));
+            if (folderID == static_cast<PathInterner::ID>(m_folderItemIndexes.size()))
+            {
+                const int folderIndex = m_items.size();
+                m_items.append({.path = filePath.left(separatorPos)});
+                m_items[m_folderItemIndexes[parentFolderID]].children.append(folderIndex);
+                m_folderItemIndexes.append(folderIndex);
+            }
+            nameStart = separatorPos + 1;
+        }
+
+        m_items[m_folderItemIndexes[folderID]].children.append(m_items.size());
+        m_items.append({
+            .path = filePath,
+            .fileIndex = fileIndex,
+            .size = torrent.fileSize(fileIndex),
+            .progress = m_filesProgress[fileIndex],
+            .priority = m_filePriorities[fileIndex],
+            .filesCount = 1
+        });
+    }
+
+    // the content of each folder follows it, so folders are aggregated from the last one
+    for (qsizetype index = (m_items.size() - 1); index >= 0; --index)
+    {
+        Item &folder = m_items[index];
+        if ((folder.fileIndex >= 0) || folder.children.isEmpty())
+            continue;
+
+        // progress is calculated of the content to be downloaded, the same way as in the GUI
+        qreal completedSize = 0;
+        qlonglong wantedSize = 0;
+        folder.priority = m_items[folder.children.first()].priority;
+        for (const int childIndex : asConst(folder.children))
+        {
+            const Item &child = m_items[childIndex];
+            folder.size += child.size;
+            folder.filesCount += child.filesCount;
+            if (child.priority != folder.priority)
+                folder.priority = BitTorrent::DownloadPriority::Mixed;
+            if (child.priority != BitTorrent::DownloadPriority::Ignored)
+            {
+                completedSize += child.progress * child.size;
+                wantedSize += child.size;
+            }
+        }
+        folder.progress = (wantedSize > 0) ? (completedSize / wantedSize) : 1;
+    }
+}
+
+BitTorrent::TorrentID TorrentFilesTree::torrentID() const
+{
+    return m_torrentID;
+}
+
+bool TorrentFilesTree::isUpToDate(const BitTorrent::Torrent &torrent) const
+{
+    // the torrent keeps its data shared with the tree until the data is changed,
+    // so the comparison is cheap when nothing has changed
+    return (torrent.id() == m_torrentID)
+        && (torrent.filesProgress() == m_filesProgress)
+        && (torrent.filePriorities() == m_filePriorities)
+        && (torrent.filePaths() == m_filePaths);
+}
+
+int TorrentFilesTree::findFolder(const QString &path) const
+{
+    const PathInterner::ID folderID = m_folders.find(Path(path));
+    return (folderID != PathInterner::INVALID_ID) ? m_folderItemIndexes[folderID] : -1;
+}
+
+const TorrentFilesTree::Item &TorrentFilesTree::item(const int index) const
+{
+    return m_items[index];
+}
@@ -0,0 +1,85 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "base/bittorrent/downloadpriority.h"
+#include "base/bittorrent/infohash.h"
+#include "base/path.h"
+#include "base/pathinterner.h"
+
+namespace BitTorrent
+{
+    class Torrent;
+}
+
+// Folder tree of torrent files with the size, progress and priority of each folder
+// aggregated from its content. It is built once and can be reused as long as it is up to date.
+class TorrentFilesTree
+{
+public:
+    struct Item
+    {
+        // "/" separated path, empty for the root folder
+        QString path;
+        // -1 for folders
+        int fileIndex = -1;
+        qlonglong size = 0;
+        qreal progress = 0;
+        BitTorrent::DownloadPriority priority = BitTorrent::DownloadPriority::Normal;
+        int filesCount = 0;
+        // indexes of the child items
+        QList<int> children;
+    };
+
+    explicit TorrentFilesTree(const BitTorrent::Torrent &torrent);
+
+    BitTorrent::TorrentID torrentID() const;
+    // Whether the files of the torrent, their priorities and progress are still the same as the tree was built of
+    bool isUpToDate(const BitTorrent::Torrent &torrent) const;
+
+    // Returns index of the folder item or -1 if there is no such folder
+    int findFolder(const QString &path) const;
+    const Item &item(int index) const;
+
+private:
+    BitTorrent::TorrentID m_torrentID;
+    PathList m_filePaths;
+    QVector<BitTorrent::DownloadPriority> m_filePriorities;
+    QVector<qreal> m_filesProgress;
+
+    // root folder is the first item, each folder is placed before its content
+    QList<Item> m_items;
+    PathInterner m_folders;
+    // item index of each folder, by its ID in m_folders
+    QList<int> m_folderItemIndexes;
+};
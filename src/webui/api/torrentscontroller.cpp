@@ -28,9 +28,17 @@
 
 #include "torrentscontroller.h"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <utility>
 
 #include <QBitArray>
+#include <QCache>
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QList>
@@ -42,6 +50,7 @@
 #include "base/bittorrent/categoryoptions.h"
 #include "base/bittorrent/downloadpriority.h"
 #include "base/bittorrent/infohash.h"
+#include "base/bittorrent/movestoragejobinfo.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
@@ -52,15 +61,20 @@
 #include "base/bittorrent/trackerentrystatus.h"
 #include "base/interfaces/iapplication.h"
 #include "base/global.h"
+#include "base/http/responsestream.h"
+#include "base/http/types.h"
 #include "base/logger.h"
 #include "base/net/downloadmanager.h"
 #include "base/torrentfilter.h"
 #include "base/utils/datetime.h"
 #include "base/utils/fs.h"
+#include "base/utils/random.h"
 #include "base/utils/sslkey.h"
 #include "base/utils/string.h"
 #include "apierror.h"
+#include "serialize/datawriter.h"
 #include "serialize/serialize_torrent.h"
+#include "torrentfilestree.h"
 
 // Tracker keys
 const QString KEY_TRACKER_URL = u"url"_s;
@@ -128,6 +142,8 @@ const QString KEY_FILE_PRIORITY = u"priority"_s;
 const QString KEY_FILE_IS_SEED = u"is_seed"_s;
 const QString KEY_FILE_PIECE_RANGE = u"piece_range"_s;
 const QString KEY_FILE_AVAILABILITY = u"availability"_s;
+const QString KEY_FILE_IS_FOLDER = u"is_folder"_s;
+const QString KEY_FILE_FILES_COUNT = u"files_count"_s;
 
 namespace
 {
@@ -135,6 +151,115 @@ namespace
     using Utils::String::parseInt;
     using Utils::String::parseDouble;
 
+    // number of torrent files generated at once during archive export
+    const int MAX_CONCURRENT_TORRENT_EXPORTS = 4;
+
+    // larger torrent lists are streamed instead of being serialized at once
+    const qsizetype MIN_STREAMED_TORRENTS_COUNT = 1000;
+
+    // Properties of the selected torrent are polled by every open WebUI client, so they are
+    // built once per revision of the torrent status and shared. ETag lets unchanged ones be skipped entirely.
+    const int PROPERTIES_CACHE_SIZE = 64;
+
+    struct CachedProperties
+    {
+        quint64 statusRevision = 0;
+        QJsonObject data;
+    };
+
+    QCache<BitTorrent::TorrentID, CachedProperties> &propertiesCache()
+    {
+        static QCache<BitTorrent::TorrentID, CachedProperties> cache {PROPERTIES_CACHE_SIZE};
+        return cache;
+    }
+
+    QString propertiesETag(const quint64 statusRevision)
+    {
+        // revisions start over on restart
+        static const QString instanceID = QString::number(Utils::Random::rand(), 36);
+        return u"\"%1-%2\""_s.arg(instanceID, QString::number(statusRevision));
+    }
+
+    // Writes file entry in "ustar" format, it is understood by most archivers
+    QByteArray tarEntry(const QString &fileName, const QByteArray &data, const qint64 mtime)
+    {
+        const int BLOCK_SIZE = 512;
+
+        QByteArray header(BLOCK_SIZE, '\0');
+        const auto writeField = [&header](const int offset, const int size, const QByteArray &value)
+        {
+            std::memcpy((header.data() + offset), value.constData(), std::min<qsizetype>(value.size(), size));
+        };
+        const auto writeOctal = [&writeField](const int offset, const int size, const qint64 value)
+        {
+            writeField(offset, (size - 1), QByteArray::number(value, 8).rightJustified((size - 1), '0'));
+        };
+
+        writeField(0, 100, fileName.toUtf8());
+        writeOctal(100, 8, 0644);  // mode
+        writeOctal(108, 8, 0);  // uid
+        writeOctal(116, 8, 0);  // gid
+        writeOctal(124, 12, data.size());
+        writeOctal(136, 12, mtime);
+        header[156] = '0';  // regular file
+        writeField(257, 6, QByteArrayLiteral("ustar"));
+        writeField(263, 2, QByteArrayLiteral("00"));
+
+        // checksum is calculated with its own field filled with spaces
+        writeField(148, 8, QByteArray(8, ' '));
+        const int checksum = std::accumulate(header.cbegin(), header.cend(), 0
+                , [](const int sum, const char c) { return sum + static_cast<unsigned char>(c); });
+        writeField(148, 7, (QByteArray::number(checksum, 8).rightJustified(6, '0') + '\0'));
+
+        const qsizetype paddingSize = (BLOCK_SIZE - (data.size() % BLOCK_SIZE)) % BLOCK_SIZE;
+        return header + data + QByteArray(paddingSize, '\0');
+    }
+
+    // Generates torrent files a few at a time and writes them to archive as soon as they are ready
+    struct TorrentsArchiveExport : std::enable_shared_from_this<TorrentsArchiveExport>
+    {
+        QList<BitTorrent::TorrentID> pendingTorrentIDs;
+        int runningCount = 0;
+        qint64 mtime = 0;
+        std::shared_ptr<Http::ResponseStream> stream;
+
+        void exportNext()
+        {
+            while ((runningCount < MAX_CONCURRENT_TORRENT_EXPORTS) && !pendingTorrentIDs.isEmpty())
+            {
+                if (!stream->isOpen())
+                {
+                    // client has gone away
+                    pendingTorrentIDs.clear();
+                    break;
+                }
+
+                const BitTorrent::TorrentID id = pendingTorrentIDs.takeFirst();
+                const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(id);
+                if (!torrent || !torrent->hasMetadata())
+                    continue;
+
+                ++runningCount;
+                torrent->fetchTorrentFile([self = shared_from_this(), id](const nonstd::expected<QByteArray, QString> &result)
+                {
+                    --self->runningCount;
+                    if (result)
+                        self->stream->write(tarEntry((id.toString() + u".torrent"), result.value(), self->mtime));
+                    else
+                        LogMsg(TorrentsController::tr("Unable to export torrent file. Error: %1").arg(result.error()), Log::WARNING);
+                    self->exportNext();
+                });
+            }
+
+            if ((runningCount == 0) && pendingTorrentIDs.isEmpty())
+            {
+                // end of archive is marked by two empty blocks
+                stream->write(QByteArray(1024, '\0'));
+                stream->close();
+            }
+        }
+    };
+
     void applyToTorrents(const QStringList &idList, const std::function<void (BitTorrent::Torrent *torrent)> &func)
     {
         if ((idList.size() == 1) && (idList[0] == u"all"))
@@ -252,8 +377,68 @@ namespace
             idList << BitTorrent::TorrentID::fromString(hash);
         return idList;
     }
+
+    // One byte per piece, see TorrentsController::pieceStatesAction()
+    QByteArray pieceStatesData(const QBitArray &pieces, const QBitArray &downloadingPieces)
+    {
+        const qsizetype piecesCount = pieces.size();
+        QByteArray states {piecesCount, 0};
+        char *statesData = states.data();
+
+        // QBitArray stores bits starting from least significant one, so whole bytes can be skipped or filled at once
+        const char *piecesBits = pieces.bits();
+        const qsizetype fullBytes = piecesCount / 8;
+        for (qsizetype i = 0; i < fullBytes; ++i)
+        {
+            const auto byte = static_cast<unsigned char>(piecesBits[i]);
+            if (byte == 0)
+                continue;
+
+            if (byte == 0xFF)
+            {
+                std::memset((statesData + (i * 8)), 2, 8);
+                continue;
+            }
+
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                if (byte & (1 << bit))
+                    statesData[(i * 8) + bit] = 2;
+            }
+        }
+        for (qsizetype i = (fullBytes * 8); i < piecesCount; ++i)
+        {
+            if (pieces.testBit(i))
+                statesData[i] = 2;
+        }
+
+        if (downloadingPieces.size() == piecesCount)
+        {
+            const char *downloadingBits = downloadingPieces.bits();
+            for (qsizetype i = 0; i < ((piecesCount + 7) / 8); ++i)
+            {
+                if (downloadingBits[i] == 0)
+                    continue;
+
+                for (qsizetype piece = (i * 8); piece < std::min(((i + 1) * 8), piecesCount); ++piece)
+                {
+                    if (downloadingPieces.testBit(piece))
+                        statesData[piece] = 1;
+                }
+            }
+        }
+
+        return states;
+    }
 }
 
+TorrentsController::TorrentsController(IApplication *app, QObject *parent)
+    : APIController(app, parent)
+{
+}
+
+TorrentsController::~TorrentsController() = default;
+
 void TorrentsController::countAction()
 {
     setResult(QString::number(BitTorrent::Session::instance()->torrentsCount()));
@@ -290,8 +475,11 @@ void TorrentsController::countAction()
 //   - reverse (bool): enable reverse sorting
 //   - limit (int): set limit number of torrents returned (if greater than 0, otherwise - unlimited)
 //   - offset (int): set offset (if less than 0 - offset from end)
+//   - fields (string): comma separated list of the keys to include, all of them by default
 void TorrentsController::infoAction()
 {
+    BitTorrent::Session::instance()->demandRefresh();
+
     const QString filter {params()[u"filter"_s]};
     const std::optional<QString> category = getOptionalString(params(), u"category"_s);
     const std::optional<Tag> tag = getOptionalTag(params(), u"tag"_s);
@@ -310,12 +498,33 @@ void TorrentsController::infoAction()
             idSet->insert(BitTorrent::TorrentID::fromString(hash));
     }
 
+    SerializedTorrent::KeySet keys = SerializedTorrent::ALL_KEYS;
+    if (const QStringList fields = params()[u"fields"_s].split(u',', Qt::SkipEmptyParts); !fields.isEmpty())
+    {
+        keys = 0;
+        for (const QString &field : fields)
+        {
+            const std::optional<SerializedTorrent::Key> key = SerializedTorrent::findKey(field.trimmed());
+            if (!key)
+                throw APIError(APIErrorType::BadParams, tr("'fields' parameter is invalid"));
+            keys |= SerializedTorrent::keySet(*key);
+        }
+    }
+
+    std::optional<SerializedTorrent::Key> sortedKey;
+    if (!sortedColumn.isEmpty())
+    {
+        sortedKey = SerializedTorrent::findKey(sortedColumn);
+        if (!sortedKey)
+            throw APIError(APIErrorType::BadParams, tr("'sort' parameter is invalid"));
+    }
+
     const TorrentFilter torrentFilter {filter, idSet, category, tag, isPrivate};
-    QVariantList torrentList;
-    for (const BitTorrent::Torrent *torrent : asConst(BitTorrent::Session::instance()->torrents()))
+    QList<const BitTorrent::Torrent *> torrentList;
+    for (const BitTorrent::Torrent *torrent : BitTorrent::Session::instance()->torrentsView())
     {
         if (torrentFilter.match(torrent))
-            torrentList.append(serialize(*torrent));
+            torrentList.append(torrent);
     }
 
     if (torrentList.isEmpty())
@@ -324,44 +533,24 @@ void TorrentsController::infoAction()
         return;
     }
 
-    if (!sortedColumn.isEmpty())
+    if (sortedKey)
     {
-        if (!torrentList[0].toMap().contains(sortedColumn))
-            throw APIError(APIErrorType::BadParams, tr("'sort' parameter is invalid"));
-
-        const auto lessThan = [](const QVariant &left, const QVariant &right) -> bool
+        // only the value being sorted by is serialized for all the torrents
+        QList<std::pair<QVariant, const BitTorrent::Torrent *>> sortedTorrents;
+        sortedTorrents.reserve(torrentList.size());
+        for (const BitTorrent::Torrent *torrent : asConst(torrentList))
+            sortedTorrents.emplaceBack(serializeValue(*torrent, *sortedKey), torrent);
+
+        std::sort(sortedTorrents.begin(), sortedTorrents.end()
+            , [reverse](const auto &item1, const auto &item2)
         {
-            Q_ASSERT(left.userType() == right.userType());
-
-            switch (left.userType())
-            {
-            case QMetaType::Bool:
-                return left.value<bool>() < right.value<bool>();
-            case QMetaType::Double:
-                return left.value<double>() < right.value<double>();
-            case QMetaType::Float:
-                return left.value<float>() < right.value<float>();
-            case QMetaType::Int:
-                return left.value<int>() < right.value<int>();
-            case QMetaType::LongLong:
-                return left.value<qlonglong>() < right.value<qlonglong>();
-            case QMetaType::QString:
-                return left.value<QString>() < right.value<QString>();
-            default:
-                qWarning("Unhandled QVariant comparison, type: %d, name: %s"
-                        , left.userType(), left.metaType().name());
-                break;
-            }
-            return false;
-        };
-
-        std::sort(torrentList.begin(), torrentList.end()
-            , [reverse, &sortedColumn, &lessThan](const QVariant &torrent1, const QVariant &torrent2)
-        {
-            const QVariant value1 {torrent1.toMap().value(sortedColumn)};
-            const QVariant value2 {torrent2.toMap().value(sortedColumn)};
-            return reverse ? lessThan(value2, value1) : lessThan(value1, value2);
+            return reverse
+                ? serializedValueLessThan(item2.first, item1.first)
+                : serializedValueLessThan(item1.first, item2.first);
         });
+
+        for (qsizetype i = 0; i < sortedTorrents.size(); ++i)
+            torrentList[i] = sortedTorrents[i].second;
     }
 
     const int size = torrentList.size();
@@ -377,7 +566,44 @@ void TorrentsController::infoAction()
     if ((limit > 0) || (offset > 0))
         torrentList = torrentList.mid(offset, limit);
 
-    setResult(QJsonArray::fromVariantList(torrentList));
+    if (torrentList.size() >= MIN_STREAMED_TORRENTS_COUNT)
+    {
+        // torrents are looked up again when they are written, they can be removed in the meantime
+        QList<BitTorrent::TorrentID> torrentIDs;
+        torrentIDs.reserve(torrentList.size());
+        for (const BitTorrent::Torrent *torrent : asConst(torrentList))
+            torrentIDs.append(torrent->id());
+
+        setStreamedResult([torrentIDs = std::move(torrentIDs), keys, index = qsizetype(-1)](DataWriter &writer) mutable
+        {
+            if (index < 0)
+            {
+                writer.beginArray();
+                index = 0;
+                return true;
+            }
+
+            if (index == torrentIDs.size())
+            {
+                writer.endArray();
+                return false;
+            }
+
+            if (const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(torrentIDs[index++]))
+                serialize(*torrent, keys).write(writer, keys);
+            return true;
+        });
+        return;
+    }
+
+    // only the requested values of the torrents of the page are serialized
+    QByteArray result;
+    DataWriter writer {result, resultFormat()};
+    writer.beginArray();
+    for (const BitTorrent::Torrent *torrent : asConst(torrentList))
+        serialize(*torrent, keys).write(writer, keys);
+    writer.endArray();
+    setResult(result, resultContentType());
 }
 
 // Returns the properties for a torrent in JSON format.
@@ -431,6 +657,17 @@ void TorrentsController::propertiesAction()
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
+    const quint64 statusRevision = torrent->statusRevision();
+    setResultETag(propertiesETag(statusRevision));
+
+    QCache<BitTorrent::TorrentID, CachedProperties> &cache = propertiesCache();
+    if (const CachedProperties *cachedProperties = cache.object(id)
+            ; cachedProperties && (cachedProperties->statusRevision == statusRevision))
+    {
+        setResult(cachedProperties->data);
+        return;
+    }
+
     const BitTorrent::InfoHash infoHash = torrent->infoHash();
     const qlonglong totalDownload = torrent->totalDownload();
     const qlonglong totalUpload = torrent->totalUpload();
@@ -489,6 +726,7 @@ void TorrentsController::propertiesAction()
         {KEY_PROP_HAS_METADATA, torrent->hasMetadata()}
     };
 
+    cache.insert(id, new CachedProperties {.statusRevision = statusRevision, .data = ret});
     setResult(ret);
 }
 
@@ -548,16 +786,20 @@ void TorrentsController::webseedsAction()
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
-    QJsonArray webSeedList;
-    for (const QUrl &webseed : asConst(torrent->urlSeeds()))
+    const DeferredAPIResult result = setDeferredResult();
+    torrent->fetchURLSeeds([result](const QVector<QUrl> &urlSeeds)
     {
-        webSeedList.append(QJsonObject
+        QJsonArray webSeedList;
+        for (const QUrl &webseed : urlSeeds)
         {
-            {KEY_WEBSEED_URL, webseed.toString()}
-        });
-    }
+            webSeedList.append(QJsonObject
+            {
+                {KEY_WEBSEED_URL, webseed.toString()}
+            });
+        }
 
-    setResult(webSeedList);
+        result.setResult(webSeedList);
+    });
 }
 
 // Returns the files in a torrent in JSON format.
@@ -571,6 +813,19 @@ void TorrentsController::webseedsAction()
 //   - "is_seed": Flag indicating if torrent is seeding/complete
 //   - "piece_range": Piece index range, the first number is the starting piece index
 //        and the second number is the ending piece index (inclusive)
+// When "path" param is given, the content of the folder is returned instead, folders along with
+// the files, each one followed by its own content up to the given depth. Folder dictionary keys are:
+//   - "name": Folder path
+//   - "is_folder": true
+//   - "size": Total size of the folder content
+//   - "progress": Progress of the folder content to be downloaded
+//   - "priority": Priority of the folder content, -1 if it is mixed
+//   - "files_count": Number of files in the folder and its subfolders
+// GET params:
+//   - hash (string): torrent hash
+//   - indexes (string): indexes of the files separated by "|", ignored if "path" is given
+//   - path (string): "/" separated path of the folder, empty for the top level
+//   - depth (int): number of folder levels to return, 1 by default
 void TorrentsController::filesAction()
 {
     requireParams({u"hash"_s});
@@ -580,6 +835,17 @@ void TorrentsController::filesAction()
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
+    const auto pathIt = params().constFind(u"path"_s);
+    const bool isTreeRequested = (pathIt != params().cend());
+    int depth = 1;
+    if (const QString depthParam = params()[u"depth"_s]; !depthParam.isEmpty())
+    {
+        bool ok = false;
+        depth = depthParam.toInt(&ok);
+        if (!ok || (depth < 1))
+            throw APIError(APIErrorType::BadParams, tr("'depth' must be positive integer"));
+    }
+
     const int filesCount = torrent->filesCount();
     QVector<int> fileIndexes;
     const auto idxIt = params().constFind(u"indexes"_s);
@@ -606,14 +872,35 @@ void TorrentsController::filesAction()
             fileIndexes.append(i);
     }
 
-    QJsonArray fileList;
-    if (torrent->hasMetadata())
+    if (!torrent->hasMetadata())
+    {
+        setResult(QJsonArray());
+        return;
+    }
+
+    std::shared_ptr<const TorrentFilesTree> filesTree;
+    int folderIndex = -1;
+    if (isTreeRequested)
+    {
+        // the tree and its aggregates are only rebuilt once the files or their progress or priorities change
+        if (!m_filesTree || !m_filesTree->isUpToDate(*torrent))
+            m_filesTree = std::make_shared<const TorrentFilesTree>(*torrent);
+
+        folderIndex = m_filesTree->findFolder(pathIt.value());
+        if (folderIndex < 0)
+            throw APIError(APIErrorType::NotFound, tr("Folder not found: \"%1\"").arg(pathIt.value()));
+
+        filesTree = m_filesTree;
+    }
+
+    // availability of the files is queried from libtorrent, so the result is written once it is fetched
+    const DeferredAPIResult result = setDeferredResult();
+    torrent->fetchAvailableFileFractions([result, torrent, filesTree, folderIndex, depth, fileIndexes](const QVector<qreal> &fileAvailability)
     {
         const QVector<BitTorrent::DownloadPriority> priorities = torrent->filePriorities();
         const QVector<qreal> fp = torrent->filesProgress();
-        const QVector<qreal> fileAvailability = torrent->availableFileFractions();
         const BitTorrent::TorrentInfo info = torrent->info();
-        for (const int index : asConst(fileIndexes))
+        const auto serializeFile = [&](const int index)
         {
             QJsonObject fileDict =
             {
@@ -621,7 +908,7 @@ void TorrentsController::filesAction()
                 {KEY_FILE_PROGRESS, fp[index]},
                 {KEY_FILE_PRIORITY, static_cast<int>(priorities[index])},
                 {KEY_FILE_SIZE, torrent->fileSize(index)},
-                {KEY_FILE_AVAILABILITY, fileAvailability[index]},
+                {KEY_FILE_AVAILABILITY, fileAvailability.value(index)},
                 // need to provide paths using a platform-independent separator format
                 {KEY_FILE_NAME, torrent->filePath(index).data()}
             };
@@ -632,11 +919,46 @@ void TorrentsController::filesAction()
             if (index == 0)
                 fileDict[KEY_FILE_IS_SEED] = torrent->isFinished();
 
-            fileList.append(fileDict);
+            return fileDict;
+        };
+
+        QJsonArray fileList;
+        if (filesTree)
+        {
+            const auto appendContent = [&filesTree, &fileList, &serializeFile](const auto &self, const int index, const int levels) -> void
+            {
+                for (const int childIndex : asConst(filesTree->item(index).children))
+                {
+                    const TorrentFilesTree::Item &child = filesTree->item(childIndex);
+                    if (child.fileIndex >= 0)
+                    {
+                        fileList.append(serializeFile(child.fileIndex));
+                        continue;
+                    }
+
+                    fileList.append(QJsonObject
+                    {
+                        {KEY_FILE_NAME, child.path},
+                        {KEY_FILE_IS_FOLDER, true},
+                        {KEY_FILE_SIZE, child.size},
+                        {KEY_FILE_PROGRESS, child.progress},
+                        {KEY_FILE_PRIORITY, static_cast<int>(child.priority)},
+                        {KEY_FILE_FILES_COUNT, child.filesCount}
+                    });
+                    if (levels > 1)
+                        self(self, childIndex, (levels - 1));
+                }
+            };
+            appendContent(appendContent, folderIndex, depth);
+        }
+        else
+        {
+            for (const int index : fileIndexes)
+                fileList.append(serializeFile(index));
         }
-    }
 
-    setResult(fileList);
+        result.setResult(fileList);
+    });
 }
 
 // Returns an array of hashes (of each pieces respectively) for a torrent in JSON format.
@@ -663,6 +985,8 @@ void TorrentsController::pieceHashesAction()
 
 // Returns an array of states (of each pieces respectively) for a torrent in JSON format.
 // The return value is a JSON-formatted array of ints.
+// If "format" parameter is "binary" the states are returned as raw byte array instead,
+// one byte per piece.
 // 0: piece not downloaded
 // 1: piece requested or downloading
 // 2: piece already downloaded
@@ -675,19 +999,98 @@ void TorrentsController::pieceStatesAction()
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
-    QJsonArray pieceStates;
-    const QBitArray states = torrent->pieces();
-    for (int i = 0; i < states.size(); ++i)
-        pieceStates.append(static_cast<int>(states[i]) * 2);
+    const QString format = params()[u"format"_s];
+    if (!format.isEmpty() && (format != u"json") && (format != u"binary"))
+        throw APIError(APIErrorType::BadParams, tr("Unsupported format: \"%1\"").arg(format));
+
+    // downloading pieces are queried from libtorrent, so the result is written once they are fetched
+    const bool isBinary = (format == u"binary");
+    const DeferredAPIResult result = setDeferredResult(isBinary ? u"application/octet-stream"_s : QString());
+    torrent->fetchDownloadingPieces([result, torrent, isBinary](const QBitArray &downloadingPieces)
+    {
+        const QByteArray states = pieceStatesData(torrent->pieces(), downloadingPieces);
+        if (isBinary)
+        {
+            result.setResult(states);
+            return;
+        }
+
+        QJsonArray pieceStates;
+        for (const char state : states)
+            pieceStates.append(static_cast<int>(state));
+
+        result.setResult(pieceStates);
+    });
+}
+
+// Returns payload speed history summed over the matching torrents
+// Params:
+// - period (string): "minute" (default), "hour" or "day"
+// - hashes (string): torrent hashes separated by '|', all the torrents if omitted
+// - category, tag (string): the same as in torrents/info
+// - tracker (string): host of one of the torrent trackers
+// The result contains resolution of the history (in seconds) and speeds (in bytes/s), the oldest first
+void TorrentsController::speedHistoryAction()
+{
+    const QString periodName = params()[u"period"_s];
+    SpeedHistory::Period period = SpeedHistory::Period::Minute;
+    if (periodName == u"hour")
+        period = SpeedHistory::Period::Hour;
+    else if (periodName == u"day")
+        period = SpeedHistory::Period::Day;
+    else if (!periodName.isEmpty() && (periodName != u"minute"))
+        throw APIError(APIErrorType::BadParams, tr("Unsupported period: \"%1\"").arg(periodName));
+
+    const std::optional<QString> category = getOptionalString(params(), u"category"_s);
+    const std::optional<Tag> tag = getOptionalTag(params(), u"tag"_s);
+    const QString trackerHost = params()[u"tracker"_s];
+    const QStringList hashes {params()[u"hashes"_s].split(u'|', Qt::SkipEmptyParts)};
+
+    std::optional<TorrentIDSet> idSet;
+    if (!hashes.isEmpty() && (hashes != QStringList {u"all"_s}))
+    {
+        idSet = TorrentIDSet();
+        for (const QString &hash : hashes)
+            idSet->insert(BitTorrent::TorrentID::fromString(hash));
+    }
+
+    const auto hasTracker = [&trackerHost](const BitTorrent::Torrent *torrent)
+    {
+        const QList<BitTorrent::TrackerEntryStatus> trackers = torrent->trackers();
+        return std::any_of(trackers.cbegin(), trackers.cend(), [&trackerHost](const BitTorrent::TrackerEntryStatus &tracker)
+        {
+            return QUrl(tracker.url).host() == trackerHost;
+        });
+    };
+
+    // all the histories are taken at the same time so their buckets match each other
+    const qint64 timestamp = SpeedHistory::currentTimestamp();
+    QList<SpeedSample> samples(SpeedHistory::samplesCount(period));
 
-    const QBitArray dlstates = torrent->downloadingPieces();
-    for (int i = 0; i < states.size(); ++i)
+    const TorrentFilter torrentFilter {TorrentFilter::All, idSet, category, tag};
+    for (const BitTorrent::Torrent *torrent : BitTorrent::Session::instance()->torrentsView())
     {
-        if (dlstates[i])
-            pieceStates[i] = 1;
+        if (!torrentFilter.match(torrent) || (!trackerHost.isEmpty() && !hasTracker(torrent)))
+            continue;
+
+        const QList<SpeedSample> torrentSamples = torrent->payloadRateHistory(period, timestamp);
+        for (qsizetype i = 0; i < samples.size(); ++i)
+            samples[i] += torrentSamples[i];
+    }
+
+    QJsonArray dlSpeeds;
+    QJsonArray upSpeeds;
+    for (const SpeedSample &sample : asConst(samples))
+    {
+        dlSpeeds.append(sample.download);
+        upSpeeds.append(sample.upload);
     }
 
-    setResult(pieceStates);
+    setResult(QJsonObject {
+        {u"resolution"_s, (SpeedHistory::resolution(period) / 1000)},
+        {u"dl_speed"_s, dlSpeeds},
+        {u"up_speed"_s, upSpeeds}
+    });
 }
 
 void TorrentsController::addAction()
@@ -787,18 +1190,25 @@ void TorrentsController::addAction()
     }
 
     const DataMap &torrents = data();
-    for (auto it = torrents.constBegin(); it != torrents.constEnd(); ++it)
+    const QStringList torrentNames = torrents.keys();
+    const auto loadResults = BitTorrent::TorrentDescriptor::loadAll(torrents.values());
+    QList<BitTorrent::TorrentDescriptor> torrentDescrs;
+    torrentDescrs.reserve(loadResults.size());
+    for (qsizetype i = 0; i < loadResults.size(); ++i)
     {
-        if (const auto loadResult = BitTorrent::TorrentDescriptor::load(it.value()))
-        {
-            partialSuccess |= BitTorrent::Session::instance()->addTorrent(loadResult.value(), addTorrentParams);
-        }
-        else
+        if (!loadResults[i])
         {
-            throw APIError(APIErrorType::BadData, tr("Error: '%1' is not a valid torrent file.").arg(it.key()));
+            // torrents preceding the invalid one are still added
+            BitTorrent::Session::instance()->addTorrents(torrentDescrs, addTorrentParams);
+            throw APIError(APIErrorType::BadData, tr("Error: '%1' is not a valid torrent file.").arg(torrentNames[i]));
         }
+
+        torrentDescrs.append(loadResults[i].value());
     }
 
+    if (!torrentDescrs.isEmpty())
+        partialSuccess |= (BitTorrent::Session::instance()->addTorrents(torrentDescrs, addTorrentParams) > 0);
+
     if (partialSuccess)
         setResult(u"Ok."_s);
     else
@@ -906,21 +1316,21 @@ void TorrentsController::addPeersAction()
     if (peerList.isEmpty())
         throw APIError(APIErrorType::BadParams, u"No valid peers were specified"_s);
 
-    QJsonObject results;
+    QList<BitTorrent::TorrentID> torrentIDs;
+    applyToTorrents(hashes, [&torrentIDs](const BitTorrent::Torrent *torrent) { torrentIDs.append(torrent->id()); });
 
-    applyToTorrents(hashes, [peers, peerList, &results](BitTorrent::Torrent *const torrent)
-    {
-        const int peersAdded = std::count_if(peerList.cbegin(), peerList.cend(), [torrent](const BitTorrent::PeerAddress &peer)
-        {
-            return torrent->connectPeer(peer);
-        });
+    // peers are connected gradually, so "added" counts the peers accepted to be connected
+    const QHash<BitTorrent::TorrentID, int> acceptedCounts = BitTorrent::Session::instance()->connectPeers(torrentIDs, peerList);
 
-        results[torrent->id().toString()] = QJsonObject
+    QJsonObject results;
+    for (auto it = acceptedCounts.cbegin(); it != acceptedCounts.cend(); ++it)
+    {
+        results[it.key().toString()] = QJsonObject
         {
-            {u"added"_s, peersAdded},
-            {u"failed"_s, (peers.size() - peersAdded)}
+            {u"added"_s, it.value()},
+            {u"failed"_s, (peers.size() - it.value())}
         };
-    });
+    }
 
     setResult(results);
 }
@@ -1103,10 +1513,13 @@ void TorrentsController::deleteAction()
     const QStringList hashes {params()[u"hashes"_s].split(u'|')};
     const BitTorrent::TorrentRemoveOption deleteOption = parseBool(params()[u"deleteFiles"_s]).value_or(false)
             ? BitTorrent::TorrentRemoveOption::RemoveContent : BitTorrent::TorrentRemoveOption::KeepContent;
-    applyToTorrents(hashes, [deleteOption](const BitTorrent::Torrent *torrent)
+
+    QVector<BitTorrent::TorrentID> torrentIDs;
+    applyToTorrents(hashes, [&torrentIDs](const BitTorrent::Torrent *torrent)
     {
-        BitTorrent::Session::instance()->removeTorrent(torrent->id(), deleteOption);
+        torrentIDs.append(torrent->id());
     });
+    BitTorrent::Session::instance()->removeTorrents(torrentIDs, deleteOption);
 }
 
 void TorrentsController::increasePrioAction()
@@ -1226,6 +1639,29 @@ void TorrentsController::setDownloadPathAction()
     });
 }
 
+// Returns the storage moves which are in progress or waiting for their devices to be free
+void TorrentsController::moveStorageQueueAction()
+{
+    const auto *session = BitTorrent::Session::instance();
+
+    const QList<BitTorrent::MoveStorageJobInfo> jobs = session->moveStorageJobs();
+
+    QJsonArray result;
+    for (const BitTorrent::MoveStorageJobInfo &job : jobs)
+    {
+        const BitTorrent::Torrent *torrent = session->getTorrent(job.torrentID);
+        result << QJsonObject {
+            {KEY_TORRENT_ID, job.torrentID.toString()},
+            {KEY_TORRENT_NAME, (torrent ? torrent->name() : QString())},
+            {u"source"_s, job.sourcePath.toString()},
+            {u"destination"_s, job.destinationPath.toString()},
+            {u"is_active"_s, job.isActive}
+        };
+    }
+
+    setResult(result);
+}
+
 void TorrentsController::renameAction()
 {
     requireParams({u"hash"_s, u"name"_s});
@@ -1280,11 +1716,13 @@ void TorrentsController::setCategoryAction()
     const QStringList hashes {params()[u"hashes"_s].split(u'|')};
     const QString category {params()[u"category"_s]};
 
-    applyToTorrents(hashes, [category](BitTorrent::Torrent *const torrent)
+    QVector<BitTorrent::TorrentID> torrentIDs;
+    applyToTorrents(hashes, [&torrentIDs](const BitTorrent::Torrent *torrent)
     {
-        if (!torrent->setCategory(category))
-            throw APIError(APIErrorType::Conflict, tr("Incorrect category name"));
+        torrentIDs.append(torrent->id());
     });
+    if (!BitTorrent::Session::instance()->setTorrentsCategory(torrentIDs, category))
+        throw APIError(APIErrorType::Conflict, tr("Incorrect category name"));
 }
 
 void TorrentsController::createCategoryAction()
@@ -1307,6 +1745,8 @@ void TorrentsController::createCategoryAction()
         const Path downloadPath {params()[u"downloadPath"_s]};
         categoryOptions.downloadPath = {useDownloadPath.value(), downloadPath};
     }
+    categoryOptions.uploadLimit = std::max(params()[u"uploadLimit"_s].toInt(), 0);
+    categoryOptions.downloadLimit = std::max(params()[u"downloadLimit"_s].toInt(), 0);
 
     if (!BitTorrent::Session::instance()->addCategory(category, categoryOptions))
         throw APIError(APIErrorType::Conflict, tr("Unable to create category"));
@@ -1330,6 +1770,13 @@ void TorrentsController::editCategoryAction()
         categoryOptions.downloadPath = {useDownloadPath.value(), downloadPath};
     }
 
+    // rate limits are kept unless specified
+    const BitTorrent::CategoryOptions currentOptions = BitTorrent::Session::instance()->categoryOptions(category);
+    categoryOptions.uploadLimit = params().contains(u"uploadLimit"_s)
+            ? std::max(params()[u"uploadLimit"_s].toInt(), 0) : currentOptions.uploadLimit;
+    categoryOptions.downloadLimit = params().contains(u"downloadLimit"_s)
+            ? std::max(params()[u"downloadLimit"_s].toInt(), 0) : currentOptions.downloadLimit;
+
     if (!BitTorrent::Session::instance()->editCategory(category, categoryOptions))
         throw APIError(APIErrorType::Conflict, tr("Unable to edit category"));
 }
@@ -1355,6 +1802,8 @@ void TorrentsController::categoriesAction()
         QJsonObject category = categoryOptions.toJSON();
         // adjust it to be compatible with existing WebAPI
         category[u"savePath"_s] = category.take(u"save_path"_s);
+        category[u"uploadLimit"_s] = category.take(u"upload_limit"_s).toInt();
+        category[u"downloadLimit"_s] = category.take(u"download_limit"_s).toInt();
         category.insert(u"name"_s, categoryName);
         categories[categoryName] = category;
     }
@@ -1369,13 +1818,15 @@ void TorrentsController::addTagsAction()
     const QStringList hashes {params()[u"hashes"_s].split(u'|')};
     const QStringList tags {params()[u"tags"_s].split(u',', Qt::SkipEmptyParts)};
 
-    for (const QString &tagStr : tags)
+    QVector<BitTorrent::TorrentID> torrentIDs;
+    applyToTorrents(hashes, [&torrentIDs](const BitTorrent::Torrent *torrent)
     {
-        applyToTorrents(hashes, [&tagStr](BitTorrent::Torrent *const torrent)
-        {
-            torrent->addTag(Tag(tagStr));
-        });
-    }
+        torrentIDs.append(torrent->id());
+    });
+
+    auto *session = BitTorrent::Session::instance();
+    for (const QString &tagStr : tags)
+        session->addTorrentsTag(torrentIDs, Tag(tagStr));
 }
 
 void TorrentsController::removeTagsAction()
@@ -1385,20 +1836,24 @@ void TorrentsController::removeTagsAction()
     const QStringList hashes {params()[u"hashes"_s].split(u'|')};
     const QStringList tags {params()[u"tags"_s].split(u',', Qt::SkipEmptyParts)};
 
-    for (const QString &tagStr : tags)
+    QVector<BitTorrent::TorrentID> torrentIDs;
+    TagSet torrentsTags;
+    applyToTorrents(hashes, [&torrentIDs, &torrentsTags](const BitTorrent::Torrent *torrent)
     {
-        applyToTorrents(hashes, [&tagStr](BitTorrent::Torrent *const torrent)
-        {
-            torrent->removeTag(Tag(tagStr));
-        });
-    }
+        torrentIDs.append(torrent->id());
+        torrentsTags.unite(torrent->tags());
+    });
 
+    auto *session = BitTorrent::Session::instance();
     if (tags.isEmpty())
     {
-        applyToTorrents(hashes, [](BitTorrent::Torrent *const torrent)
-        {
-            torrent->removeAllTags();
-        });
+        for (const Tag &tag : asConst(torrentsTags))
+            session->removeTorrentsTag(torrentIDs, tag);
+    }
+    else
+    {
+        for (const QString &tagStr : tags)
+            session->removeTorrentsTag(torrentIDs, Tag(tagStr));
     }
 }
 
@@ -1489,6 +1944,26 @@ void TorrentsController::exportAction()
     setResult(result.value(), u"application/x-bittorrent"_s, (id.toString() + u".torrent"));
 }
 
+// Exports the torrent files of the given torrents as a single "tar" archive.
+// The files are generated in background and the archive is streamed while they are ready.
+// Params:
+//   - hashes (string): hashes of the torrents separated by "|" or "all"
+void TorrentsController::exportArchiveAction()
+{
+    requireParams({u"hashes"_s});
+
+    const auto archiveExport = std::make_shared<TorrentsArchiveExport>();
+    archiveExport->mtime = QDateTime::currentSecsSinceEpoch();
+    archiveExport->stream = std::make_shared<Http::ResponseStream>();
+    applyToTorrents(params()[u"hashes"_s].split(u'|'), [&archiveExport](const BitTorrent::Torrent *torrent)
+    {
+        archiveExport->pendingTorrentIDs.append(torrent->id());
+    });
+
+    setResult({}, archiveExport->stream, u"application/x-tar"_s, u"torrents.tar"_s);
+    archiveExport->exportNext();
+}
+
 void TorrentsController::SSLParametersAction()
 {
     requireParams({u"hash"_s});
@@ -28,15 +28,20 @@
 
 #pragma once
 
+#include <memory>
+
 #include "apicontroller.h"
 
+class TorrentFilesTree;
+
 class TorrentsController : public APIController
 {
     Q_OBJECT
     Q_DISABLE_COPY_MOVE(TorrentsController)
 
 public:
-    using APIController::APIController;
+    explicit TorrentsController(IApplication *app, QObject *parent = nullptr);
+    ~TorrentsController() override;
 
 private slots:
     void countAction();
@@ -47,6 +52,7 @@ private slots:
     void filesAction();
     void pieceHashesAction();
     void pieceStatesAction();
+    void speedHistoryAction();
     void startAction();
     void stopAction();
     void recheckAction();
@@ -81,6 +87,7 @@ private slots:
     void setLocationAction();
     void setSavePathAction();
     void setDownloadPathAction();
+    void moveStorageQueueAction();
     void setAutoManagementAction();
     void setSuperSeedingAction();
     void setForceStartAction();
@@ -89,6 +96,12 @@ private slots:
     void renameFileAction();
     void renameFolderAction();
     void exportAction();
+    void exportArchiveAction();
     void SSLParametersAction();
     void setSSLParametersAction();
+
+private:
+    // folder tree of the torrent files requested last, reused as long as it is up to date
+    // shared with the pending requests, so it can be replaced before their results are written
+    std::shared_ptr<const TorrentFilesTree> m_filesTree;
 };
@@ -28,14 +28,25 @@
 
 #include "transfercontroller.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
+#include <QTimer>
 #include <QVector>
 
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/sessionstatus.h"
+#include "base/bittorrent/torrent.h"
 #include "base/global.h"
+#include "base/http/responsestream.h"
+#include "base/net/geoipmanager.h"
+#include "base/preferences.h"
 #include "base/utils/string.h"
 #include "apierror.h"
 
@@ -48,6 +59,134 @@ const QString KEY_TRANSFER_UPRATELIMIT = u"up_rate_limit"_s;
 const QString KEY_TRANSFER_DHT_NODES = u"dht_nodes"_s;
 const QString KEY_TRANSFER_CONNECTION_STATUS = u"connection_status"_s;
 
+using namespace std::chrono_literals;
+
+namespace
+{
+    // peers of the torrents removed while being queried are never reported
+    const auto PEERS_QUERY_TIMEOUT = 10s;
+
+    struct PeersFilter
+    {
+        QString client;
+        QStringList countryCodes;
+        QString flags;
+        int minDownloadSpeed = 0;
+        int minUploadSpeed = 0;
+
+        bool matches(const BitTorrent::PeerInfo &peer) const
+        {
+            if (peer.address().ip.isNull())
+                return false;
+            if ((peer.payloadDownSpeed() < minDownloadSpeed) || (peer.payloadUpSpeed() < minUploadSpeed))
+                return false;
+            if (!client.isEmpty() && !peer.client().contains(client, Qt::CaseInsensitive)
+                    && !peer.peerIdClient().contains(client, Qt::CaseInsensitive))
+            {
+                return false;
+            }
+
+            const QString peerFlags = peer.flags();
+            return std::all_of(flags.cbegin(), flags.cend(), [&peerFlags](const QChar flag)
+            {
+                return flag.isSpace() || peerFlags.contains(flag);
+            });
+        }
+    };
+
+    // Collects the peers of many torrents which are reported asynchronously
+    struct PeersQuery
+    {
+        PeersFilter filter;
+        bool resolveCountries = false;
+        int pendingTorrentsCount = 0;
+        bool isFinished = false;
+        QList<std::pair<BitTorrent::TorrentID, BitTorrent::PeerInfo>> peers;
+        std::shared_ptr<Http::ResponseStream> stream;
+
+        void finish()
+        {
+            if (isFinished)
+                return;
+            isFinished = true;
+
+            // resolve countries of all the peers at once
+            QList<quint16> countryCodes;
+            if (resolveCountries)
+            {
+                QList<QHostAddress> addresses;
+                addresses.reserve(peers.size());
+                for (const auto &[torrentID, peer] : asConst(peers))
+                    addresses.append(peer.address().ip);
+                countryCodes = Net::GeoIPManager::instance()->lookupCountryCodes(addresses);
+            }
+
+            QJsonArray result;
+            for (qsizetype i = 0; i < peers.size(); ++i)
+            {
+                const auto &[torrentID, peer] = peers[i];
+
+                QJsonObject peerData
+                {
+                    {u"hash"_s, torrentID.toString()},
+                    {u"ip"_s, peer.address().ip.toString()},
+                    {u"port"_s, peer.address().port},
+                    {u"client"_s, peer.client()},
+                    {u"peer_id_client"_s, peer.peerIdClient()},
+                    {u"progress"_s, peer.progress()},
+                    {u"dl_speed"_s, peer.payloadDownSpeed()},
+                    {u"up_speed"_s, peer.payloadUpSpeed()},
+                    {u"downloaded"_s, peer.totalDownload()},
+                    {u"uploaded"_s, peer.totalUpload()},
+                    {u"connection"_s, peer.connectionType()},
+                    {u"flags"_s, peer.flags()},
+                    {u"relevance"_s, peer.relevance()},
+                    {u"shadowbanned"_s, peer.isShadowBanned()}
+                };
+
+                if (resolveCountries)
+                {
+                    const QString countryCode = Net::GeoIPManager::countryCodeToString(countryCodes[i]).toLower();
+                    if (!filter.countryCodes.isEmpty() && !filter.countryCodes.contains(countryCode))
+                        continue;
+                    peerData[u"country_code"_s] = countryCode;
+                }
+
+                result.append(peerData);
+            }
+
+            peers.clear();
+            stream->write(QJsonDocument(result).toJson(QJsonDocument::Compact));
+            stream->close();
+        }
+    };
+
+    int parseSpeedParam(const QString &param, const QString &name)
+    {
+        if (param.isEmpty())
+            return 0;
+
+        const std::optional<int> speed = Utils::String::parseInt(param);
+        if (!speed || (*speed < 0))
+            throw APIError(APIErrorType::BadParams, TransferController::tr("'%1': invalid argument").arg(name));
+
+        return *speed;
+    }
+
+    // Missing or zero duration means permanent ban
+    std::chrono::seconds banDuration(const QString &durationParam)
+    {
+        if (durationParam.isEmpty())
+            return {};
+
+        const std::optional<int> duration = Utils::String::parseInt(durationParam);
+        if (!duration || (*duration < 0))
+            throw APIError(APIErrorType::BadParams, TransferController::tr("'duration': invalid argument"));
+
+        return std::chrono::seconds {*duration};
+    }
+}
+
 // Returns the global transfer information in JSON format.
 // The return value is a JSON-formatted dictionary.
 // The dictionary keys are:
@@ -61,6 +200,8 @@ const QString KEY_TRANSFER_CONNECTION_STATUS = u"connection_status"_s;
 //   - "connection_status": Connection status
 void TransferController::infoAction()
 {
+    BitTorrent::Session::instance()->demandRefresh();
+
     const BitTorrent::SessionStatus &sessionStatus = BitTorrent::Session::instance()->status();
 
     QJsonObject dict;
@@ -135,12 +276,13 @@ void TransferController::banPeersAction()
 {
     requireParams({u"peers"_s});
 
+    const std::chrono::seconds duration = banDuration(params().value(u"duration"_s));
     const QStringList peers = params()[u"peers"_s].split(u'|');
     for (const QString &peer : peers)
     {
         const BitTorrent::PeerAddress addr = BitTorrent::PeerAddress::parse(peer.trimmed());
         if (!addr.ip.isNull())
-            BitTorrent::Session::instance()->banIP(addr.ip.toString());
+            BitTorrent::Session::instance()->banIP(addr.ip.toString(), duration);
     }
 }
 
@@ -148,11 +290,70 @@ void TransferController::shadowbanPeersAction()
 {
     requireParams({u"peers"_s});
 
+    const std::chrono::seconds duration = banDuration(params().value(u"duration"_s));
     const QStringList peers = params()[u"peers"_s].split(u'|');
     for (const QString &peer : peers)
     {
         const BitTorrent::PeerAddress addr = BitTorrent::PeerAddress::parse(peer.trimmed());
         if (!addr.ip.isNull())
-            BitTorrent::Session::instance()->shadowbanIP(addr.ip.toString());
+            BitTorrent::Session::instance()->shadowbanIP(addr.ip.toString(), duration);
+    }
+}
+
+// Returns the peers of all the torrents matching the given filters in JSON format.
+// The peers of all the torrents are queried at once, the response is sent when all of them are reported.
+// Params:
+//   - client (string): part of the peer client name or its peer ID client
+//   - countries (string): lowercase country codes separated by "|"
+//   - flags (string): peer flags which all must be set
+//   - min_dl_speed, min_up_speed (int): minimal transfer rates in bytes per second
+void TransferController::peersAction()
+{
+    PeersFilter filter;
+    filter.client = params()[u"client"_s];
+    filter.flags = params()[u"flags"_s];
+    filter.minDownloadSpeed = parseSpeedParam(params()[u"min_dl_speed"_s], u"min_dl_speed"_s);
+    filter.minUploadSpeed = parseSpeedParam(params()[u"min_up_speed"_s], u"min_up_speed"_s);
+    if (const QString countries = params()[u"countries"_s]; !countries.isEmpty())
+    {
+        for (const QString &countryCode : asConst(countries.split(u'|', Qt::SkipEmptyParts)))
+            filter.countryCodes.append(countryCode.trimmed().toLower());
     }
+
+    const auto query = std::make_shared<PeersQuery>();
+    query->filter = filter;
+    query->resolveCountries = !filter.countryCodes.isEmpty() || Preferences::instance()->resolvePeerCountries();
+    query->stream = std::make_shared<Http::ResponseStream>();
+    setResult({}, query->stream, Http::CONTENT_TYPE_JSON);
+
+    for (const BitTorrent::Torrent *torrent : BitTorrent::Session::instance()->torrentsView())
+    {
+        // torrents without connections are skipped without querying libtorrent
+        if (torrent->peersCount() <= 0)
+            continue;
+
+        ++query->pendingTorrentsCount;
+        torrent->fetchPeerInfo([query, torrentID = torrent->id()](const QVector<BitTorrent::PeerInfo> &peers)
+        {
+            if (query->isFinished)
+                return;
+
+            for (const BitTorrent::PeerInfo &peer : peers)
+            {
+                if (query->filter.matches(peer))
+                    query->peers.emplace_back(torrentID, peer);
+            }
+
+            if (--query->pendingTorrentsCount == 0)
+                query->finish();
+        });
+    }
+
+    if (query->pendingTorrentsCount == 0)
+    {
+        query->finish();
+        return;
+    }
+
+    QTimer::singleShot(PEERS_QUERY_TIMEOUT, [query] { query->finish(); });
 }
@@ -49,4 +49,5 @@ private slots:
     void setDownloadLimitAction();
     void banPeersAction();
     void shadowbanPeersAction();
+    void peersAction();
 };
@@ -29,16 +29,108 @@
 
 #include "freediskspacechecker.h"
 
+#include <QSet>
+
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/torrent.h"
+#include "base/global.h"
+#include "base/path.h"
 #include "base/utils/fs.h"
 
+namespace
+{
+    qint64 queryFreeDiskSpace(const Path &path)
+    {
+        // for non-existent directories (which will be created on demand)
+        // the nearest existing ancestor is queried instead
+        Path current = path;
+        while (!current.isEmpty() && !current.exists())
+            current = current.parentPath();
+        return Utils::Fs::freeDiskSpaceOnPath(current.isEmpty() ? path : current);
+    }
+}
+
+PathList FreeDiskSpaceChecker::monitoredPaths()
+{
+    const auto *session = BitTorrent::Session::instance();
+
+    PathList paths;
+    QSet<Path> knownPaths;
+    const auto addPath = [&paths, &knownPaths](const Path &path)
+    {
+        if (path.isEmpty() || knownPaths.contains(path))
+            return;
+
+        knownPaths.insert(path);
+        paths.append(path);
+    };
+
+    addPath(session->savePath());
+    if (session->isDownloadPathEnabled())
+        addPath(session->downloadPath());
+
+    for (const QString &categoryName : asConst(session->categories()))
+    {
+        addPath(session->categorySavePath(categoryName));
+        addPath(session->categoryDownloadPath(categoryName));
+    }
+
+    for (const BitTorrent::Torrent *torrent : session->torrentsView())
+    {
+        addPath(torrent->savePath());
+        addPath(torrent->downloadPath());
+    }
+
+    return paths;
+}
+
 qint64 FreeDiskSpaceChecker::lastResult() const
 {
     return m_lastResult;
 }
 
-void FreeDiskSpaceChecker::check()
+void FreeDiskSpaceChecker::check(const PathList &paths)
 {
-    m_lastResult = Utils::Fs::freeDiskSpaceOnPath(BitTorrent::Session::instance()->savePath());
-    emit checked(m_lastResult);
+    const auto now = std::chrono::steady_clock::now();
+
+    QHash<Path, QByteArray> deviceIDs;
+    QHash<QByteArray, DeviceSample> deviceSamples;
+    QVariantMap pathsInfo;
+    for (const Path &path : paths)
+    {
+        QByteArray deviceID = m_deviceIDs.value(path);
+        if (deviceID.isEmpty())
+        {
+            deviceID = Utils::Fs::storageDeviceID(path);
+            if (deviceID.isEmpty())
+                deviceID = path.data().toUtf8();  // device is unknown, treat the path as standalone
+        }
+        deviceIDs.insert(path, deviceID);
+
+        // the free space is queried only once per device
+        auto sampleIter = deviceSamples.find(deviceID);
+        if (sampleIter == deviceSamples.end())
+        {
+            DeviceSample sample {.freeSpace = queryFreeDiskSpace(path), .time = now};
+            if (const auto prevSampleIter = m_deviceSamples.constFind(deviceID); prevSampleIter != m_deviceSamples.cend())
+            {
+                const DeviceSample &prevSample = prevSampleIter.value();
+                const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - prevSample.time).count();
+                if ((elapsed > 0) && (prevSample.freeSpace >= 0) && (sample.freeSpace >= 0))
+                    sample.rate = (sample.freeSpace - prevSample.freeSpace) / elapsed;
+            }
+            sampleIter = deviceSamples.insert(deviceID, sample);
+        }
+
+        pathsInfo[path.toString()] = QVariantMap {
+            {u"free"_s, sampleIter->freeSpace},
+            {u"rate"_s, sampleIter->rate}
+        };
+    }
+
+    m_deviceIDs = deviceIDs;
+    m_deviceSamples = deviceSamples;
+
+    m_lastResult = paths.isEmpty() ? 0 : deviceSamples.value(deviceIDs.value(paths.first())).freeSpace;
+    emit checked(m_lastResult, pathsInfo);
 }
@@ -29,7 +29,13 @@
 
 #pragma once
 
+#include <chrono>
+
+#include <QHash>
 #include <QObject>
+#include <QVariantMap>
+
+#include "base/pathfwd.h"
 
 class FreeDiskSpaceChecker final : public QObject
 {
@@ -39,14 +45,31 @@ class FreeDiskSpaceChecker final : public QObject
 public:
     using QObject::QObject;
 
+    // Collects the default save path followed by all other save and download paths in use.
+    // Must be called from the main thread.
+    static PathList monitoredPaths();
+
     qint64 lastResult() const;
 
 public slots:
-    void check();
+    // The first path is considered the default one
+    void check(const PathList &paths);
 
 signals:
-    void checked(qint64 freeSpaceSize);
+    // `pathsInfo` maps every checked path to its free space ("free") and
+    // the rate of its change in bytes per second ("rate", negative when shrinking)
+    void checked(qint64 freeSpaceSize, const QVariantMap &pathsInfo);
 
 private:
+    struct DeviceSample
+    {
+        qint64 freeSpace = -1;
+        qint64 rate = 0;
+        std::chrono::steady_clock::time_point time;
+    };
+
     qint64 m_lastResult = 0;
+    // paths rarely move between devices so the device lookups are cached
+    QHash<Path, QByteArray> m_deviceIDs;
+    QHash<QByteArray, DeviceSample> m_deviceSamples;
 };
@@ -31,12 +31,18 @@
 
 #include <algorithm>
 #include <chrono>
+#include <optional>
 
+#include <QCryptographicHash>
+#include <QCborValue>
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
 #include <QMetaObject>
 #include <QMimeDatabase>
 #include <QMimeType>
@@ -47,14 +53,22 @@
 #include <QUrl>
 
 #include "base/algorithm.h"
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/torrent.h"
 #include "base/bittorrent/torrentcreationmanager.h"
+#include "base/bittorrent/torrentfilestream.h"
+#include "base/http/byterange.h"
 #include "base/http/httperror.h"
+#include "base/http/responsegenerator.h"
+#include "base/http/responsestream.h"
 #include "base/logger.h"
 #include "base/preferences.h"
+#include "base/tracing.h"
 #include "base/types.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
 #include "base/utils/misc.h"
+#include "base/utils/password.h"
 #include "base/utils/random.h"
 #include "base/utils/string.h"
 #include "api/apierror.h"
@@ -70,6 +84,7 @@
 #include "freediskspacechecker.h"
 
 const int MAX_ALLOWED_FILESIZE = 10 * 1024 * 1024;
+const int MAX_CACHED_FILESIZE = 1024 * 1024;
 const QString DEFAULT_SESSION_COOKIE_NAME = u"SID"_s;
 
 const QString WWW_FOLDER = u":/www"_s;
@@ -80,6 +95,12 @@ using namespace std::chrono_literals;
 
 const std::chrono::seconds FREEDISKSPACE_CHECK_TIMEOUT = 30s;
 
+// streamed file data is read from the pieces in chunks of this size,
+// no more chunks are written while the client has this much data queued
+const qint64 STREAM_CHUNK_SIZE = 256 * 1024;
+const qint64 STREAM_MAX_PENDING_SIZE = 4 * 1024 * 1024;
+const std::chrono::milliseconds STREAM_POLL_INTERVAL = 100ms;
+
 namespace
 {
     QStringMap parseCookie(const QStringView cookieStr)
@@ -121,7 +142,112 @@ namespace
             return u"private, max-age=43200"_s;  // 12 hrs
         }
 
-        return u"no-store"_s;
+        // always revalidated, unchanged files are then answered with "304 Not Modified" using their ETag
+        return u"no-cache"_s;
+    }
+
+    bool isETagMatched(const QString &ifNoneMatch, const QString &etag)
+    {
+        // [rfc9110] 13.1.2. If-None-Match, weak comparison is used
+        const QList<QStringView> tags = QStringView(ifNoneMatch).split(u',', Qt::SkipEmptyParts);
+        return std::any_of(tags.cbegin(), tags.cend(), [&etag](QStringView tag)
+        {
+            tag = tag.trimmed();
+            if (tag.startsWith(u"W/"))
+                tag = tag.mid(2);
+            return (tag == u"*") || (tag == etag);
+        });
+    }
+
+    // Writes the file data to the response as it becomes available and the client keeps pace with it.
+    // Returns false once the streaming is over.
+    bool feedResponseStream(BitTorrent::TorrentFileStream *fileStream, Http::ResponseStream *responseStream)
+    {
+        while (!fileStream->atEnd() && responseStream->isOpen()
+                && (responseStream->pendingSize() < STREAM_MAX_PENDING_SIZE))
+        {
+            const QByteArray data = fileStream->read(STREAM_CHUNK_SIZE);
+            if (data.isEmpty())
+                return true;  // waiting for the next piece
+
+            responseStream->write(data);
+        }
+
+        if (fileStream->atEnd() || !responseStream->isOpen())
+        {
+            responseStream->close();
+            return false;
+        }
+
+        return true;
+    }
+
+    QJsonValue toJsonValue(const QJsonDocument &document)
+    {
+        return document.isArray() ? QJsonValue(document.array()) : QJsonValue(document.object());
+    }
+
+    QJsonValue toJsonValue(const APIResult &result)
+    {
+        switch (result.data.userType())
+        {
+        case QMetaType::QJsonDocument:
+            return toJsonValue(result.data.toJsonDocument());
+        case QMetaType::QByteArray:
+            if (result.mimeType == Http::CONTENT_TYPE_JSON)
+                return toJsonValue(QJsonDocument::fromJson(result.data.toByteArray()));
+            return QString::fromUtf8(result.data.toByteArray());
+        case QMetaType::QString:
+        default:
+            return result.data.toString();
+        }
+    }
+
+    HTTPError toHTTPError(const APIError &error)
+    {
+        switch (error.type())
+        {
+        case APIErrorType::AccessDenied:
+            return ForbiddenHTTPError(error.message());
+        case APIErrorType::BadData:
+            return UnsupportedMediaTypeHTTPError(error.message());
+        case APIErrorType::BadParams:
+            return BadRequestHTTPError(error.message());
+        case APIErrorType::Conflict:
+            return ConflictHTTPError(error.message());
+        case APIErrorType::NotFound:
+            return NotFoundHTTPError(error.message());
+        default:
+            Q_ASSERT(false);
+            return InternalServerErrorHTTPError(error.message());
+        }
+    }
+
+    // Picks the format of API results, JSON unless CBOR is preferred
+    DataFormat negotiateResultFormat(const QString &accept)
+    {
+        // [rfc9110] 12.5.1. Accept
+        double cborQuality = 0;
+        double jsonQuality = 0;
+        for (const QStringView mediaRange : QStringView(accept).split(u',', Qt::SkipEmptyParts))
+        {
+            const QList<QStringView> parts = mediaRange.split(u';');
+            double quality = 1;
+            for (const QStringView param : parts.sliced(1))
+            {
+                const QStringView trimmedParam = param.trimmed();
+                if (trimmedParam.startsWith(u"q=", Qt::CaseInsensitive))
+                    quality = trimmedParam.sliced(2).toDouble();
+            }
+
+            const QStringView mediaType = parts.first().trimmed();
+            if (mediaType.compare(Http::CONTENT_TYPE_CBOR, Qt::CaseInsensitive) == 0)
+                cborQuality = quality;
+            else if (mediaType.compare(Http::CONTENT_TYPE_JSON, Qt::CaseInsensitive) == 0)
+                jsonQuality = quality;
+        }
+
+        return ((cborQuality > 0) && (cborQuality >= jsonQuality)) ? DataFormat::CBOR : DataFormat::JSON;
     }
 
     QString createLanguagesOptionsHtml()
@@ -155,6 +281,48 @@ namespace
 
         return true;
     }
+
+    struct APIPath
+    {
+        QString scope;
+        QString action;
+    };
+
+    bool isAPIName(const QStringView name)
+    {
+        const auto isLetter = [](const QChar c)
+        {
+            return ((c >= u'A') && (c <= u'Z')) || ((c >= u'a') && (c <= u'z')) || (c == u'_');
+        };
+
+        if (name.isEmpty() || !isLetter(name.front()))
+            return false;
+
+        return std::all_of(name.cbegin(), name.cend(), [&isLetter](const QChar c)
+        {
+            return isLetter(c) || ((c >= u'0') && (c <= u'9'));
+        });
+    }
+
+    // Splits "/api/v2/<scope>/<action>" path, it is done for each request so no regular expression is used
+    std::optional<APIPath> parseAPIPath(const QStringView path)
+    {
+        const QStringView prefix = u"/api/v2/";
+        if (!path.startsWith(prefix))
+            return std::nullopt;
+
+        const QStringView scopeAndAction = path.sliced(prefix.size());
+        const qsizetype separatorPos = scopeAndAction.indexOf(u'/');
+        if (separatorPos < 0)
+            return std::nullopt;
+
+        const QStringView scope = scopeAndAction.first(separatorPos);
+        const QStringView action = scopeAndAction.sliced(separatorPos + 1);
+        if (!isAPIName(scope) || !isAPIName(action))
+            return std::nullopt;
+
+        return APIPath {.scope = scope.toString(), .action = action.toString()};
+    }
 }
 
 WebApplication::WebApplication(IApplication *app, QObject *parent)
@@ -165,6 +333,7 @@ WebApplication::WebApplication(IApplication *app, QObject *parent)
     , m_freeDiskSpaceChecker {new FreeDiskSpaceChecker}
     , m_freeDiskSpaceCheckingTimer {new QTimer(this)}
     , m_torrentCreationManager {new BitTorrent::TorrentCreationManager(app, this)}
+    , m_maindataChangeLog {new MaindataChangeLog(this)}
 {
     declarePublicAPI(u"auth/login"_s);
 
@@ -188,15 +357,26 @@ WebApplication::WebApplication(IApplication *app, QObject *parent)
 
     m_freeDiskSpaceCheckingTimer->setInterval(FREEDISKSPACE_CHECK_TIMEOUT);
     m_freeDiskSpaceCheckingTimer->setSingleShot(true);
-    connect(m_freeDiskSpaceCheckingTimer, &QTimer::timeout, m_freeDiskSpaceChecker, &FreeDiskSpaceChecker::check);
+    // the paths are collected in main thread since the session isn't thread safe,
+    // the (possibly slow) free space queries are performed in worker thread
+    const auto checkFreeDiskSpace = [checker = m_freeDiskSpaceChecker]
+    {
+        QMetaObject::invokeMethod(checker, [checker, paths = FreeDiskSpaceChecker::monitoredPaths()]
+        {
+            checker->check(paths);
+        });
+    };
+    connect(m_freeDiskSpaceCheckingTimer, &QTimer::timeout, this, checkFreeDiskSpace);
     connect(m_freeDiskSpaceChecker, &FreeDiskSpaceChecker::checked, m_freeDiskSpaceCheckingTimer, qOverload<>(&QTimer::start));
-    QMetaObject::invokeMethod(m_freeDiskSpaceChecker, &FreeDiskSpaceChecker::check);
+    connect(m_freeDiskSpaceChecker, &FreeDiskSpaceChecker::checked, m_maindataChangeLog, &MaindataChangeLog::updateFreeDiskSpace);
+    checkFreeDiskSpace();
 }
 
 WebApplication::~WebApplication()
 {
     // cleanup sessions data
     qDeleteAll(m_sessions);
+    qDeleteAll(m_apiKeySessions);
 }
 
 void WebApplication::sendWebUIFile()
@@ -309,15 +489,27 @@ void WebApplication::setPasswordHash(const QByteArray &passwordHash)
 
 void WebApplication::doProcessRequest()
 {
-    const QRegularExpressionMatch match = m_apiPathPattern.match(request().path);
-    if (!match.hasMatch())
+    if (request().path == m_batchAPIPath)
+    {
+        processBatchRequest();
+        return;
+    }
+
+    if (request().path == m_streamAPIPath)
+    {
+        processStreamRequest();
+        return;
+    }
+
+    const std::optional<APIPath> apiPath = parseAPIPath(request().path);
+    if (!apiPath)
     {
         sendWebUIFile();
         return;
     }
 
-    const QString action = match.captured(u"action"_s);
-    const QString scope = match.captured(u"scope"_s);
+    const QString &action = apiPath->action;
+    const QString &scope = apiPath->scope;
 
     // Check public/private scope
     if (!session() && !isPublicAPI(scope, action))
@@ -355,11 +547,30 @@ void WebApplication::doProcessRequest()
 
     try
     {
-        const APIResult result = controller->run(action, m_params, data);
+        const DataFormat resultFormat = negotiateResultFormat(request().headers.value(Http::HEADER_ACCEPT));
+        const APIResult result = controller->run(action, m_params, data, resultFormat);
+
+        // the same URL may be answered in either format
+        setHeader({Http::HEADER_VARY, Http::HEADER_ACCEPT});
+
+        if (!result.etag.isEmpty())
+        {
+            setHeader({Http::HEADER_ETAG, result.etag});
+            setHeader({Http::HEADER_CACHE_CONTROL, u"no-cache"_s});
+            if (isETagMatched(request().headers.value(Http::HEADER_IF_NONE_MATCH), result.etag))
+            {
+                status(304, u"Not Modified"_s);
+                return;
+            }
+        }
+
         switch (result.data.userType())
         {
         case QMetaType::QJsonDocument:
-            print(result.data.toJsonDocument().toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
+            if (const QJsonDocument document = result.data.toJsonDocument(); resultFormat == DataFormat::CBOR)
+                print(QCborValue::fromJsonValue(toJsonValue(document)).toCbor(), Http::CONTENT_TYPE_CBOR);
+            else
+                print(document.toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
             break;
         case QMetaType::QByteArray:
             {
@@ -376,26 +587,176 @@ void WebApplication::doProcessRequest()
             print(result.data.toString(), Http::CONTENT_TYPE_TXT);
             break;
         }
+
+        if (result.stream)
+            setStream(result.stream);
     }
     catch (const APIError &error)
     {
         // re-throw as HTTPError
-        switch (error.type())
+        throw toHTTPError(error);
+    }
+}
+
+// Executes several actions in one request, one after another.
+// The request is authenticated and checked only once and the whole batch is executed
+// in one pass of the event loop, so its changes are reported to the clients in one sync update.
+// Only the actions requiring POST method are allowed, they are the ones changing the data.
+// POST param:
+//   - operations (string): JSON array of objects with the keys:
+//       - "action" (string): action in "<scope>/<action>" form, e.g. "torrents/setCategory"
+//       - "params" (object): parameters of the action
+// Returns JSON array of the operation results in the same order, each one being an object with the keys:
+//   - "status" (int): HTTP status code of the action
+//   - "result": result of the successful action
+//   - "error" (string): error message of the failed action
+// Streams a file of the torrent, so it can be played while the torrent is being downloaded.
+// Single byte range requests are supported, so the client can seek within the file
+// without waiting for its beginning. The pieces ahead of the requested position are
+// downloaded with priority and the data is sent as soon as they are complete.
+// GET params:
+//   - hash (string): hash of the torrent
+//   - id (int): index of the file
+void WebApplication::processStreamRequest()
+{
+    if (!session())
+        throw ForbiddenHTTPError();
+    if (m_request.method != Http::METHOD_GET)
+        throw MethodNotAllowedHTTPError();
+
+    const auto id = BitTorrent::TorrentID::fromString(m_params.value(u"hash"_s));
+    const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(id);
+    if (!torrent)
+        throw NotFoundHTTPError();
+    if (!torrent->hasMetadata())
+        throw ConflictHTTPError(tr("Torrent metadata hasn't been downloaded yet"));
+
+    bool ok = false;
+    const int fileIndex = m_params.value(u"id"_s).toInt(&ok);
+    if (!ok || (fileIndex < 0) || (fileIndex >= torrent->filesCount()))
+        throw BadRequestHTTPError(tr("'id' must be a valid file index"));
+
+    const qint64 fileSize = torrent->fileSize(fileIndex);
+    Http::ByteRange range {.first = 0, .last = (fileSize - 1)};
+    switch (Http::parseByteRange(request().headers.value(Http::HEADER_RANGE), fileSize, range))
+    {
+    case Http::ByteRangeStatus::None:
+        break;
+    case Http::ByteRangeStatus::Satisfiable:
+        status(206, u"Partial Content"_s);
+        setHeader({Http::HEADER_CONTENT_RANGE, u"bytes %1-%2/%3"_s.arg(QString::number(range.first)
+            , QString::number(range.last), QString::number(fileSize))});
+        break;
+    case Http::ByteRangeStatus::Unsatisfiable:
+        status(416, u"Range Not Satisfiable"_s);
+        setHeader({Http::HEADER_CONTENT_RANGE, u"bytes */%1"_s.arg(fileSize)});
+        return;
+    }
+
+    const QMimeType mimeType = QMimeDatabase().mimeTypeForFile(torrent->filePath(fileIndex).filename(), QMimeDatabase::MatchExtension);
+    const auto responseStream = std::make_shared<Http::ResponseStream>();
+    print(QByteArray(), mimeType.name());
+    setHeader({Http::HEADER_ACCEPT_RANGES, u"bytes"_s});
+    setHeader({Http::HEADER_CONTENT_LENGTH, QString::number(range.size())});
+    setStream(responseStream);
+
+    if (range.size() == 0)
+    {
+        responseStream->close();
+        return;
+    }
+
+    auto *fileStream = new BitTorrent::TorrentFileStream(BitTorrent::Session::instance(), torrent, fileIndex
+            , range.first, range.size(), this);
+    const auto feed = [fileStream, responseStream]
+    {
+        if (!feedResponseStream(fileStream, responseStream.get()))
+            fileStream->deleteLater();
+    };
+    connect(fileStream, &BitTorrent::TorrentFileStream::readyRead, fileStream, feed);
+    connect(fileStream, &BitTorrent::TorrentFileStream::failed, fileStream, [fileStream, responseStream](const QString &errorMessage)
+    {
+        LogMsg(tr("Failed to stream torrent file. Reason: \"%1\"").arg(errorMessage), Log::WARNING);
+        responseStream->close();
+        fileStream->deleteLater();
+    });
+
+    // sending pace and disconnection of the client are only known by polling
+    auto *pollTimer = new QTimer(fileStream);
+    connect(pollTimer, &QTimer::timeout, fileStream, feed);
+    pollTimer->start(STREAM_POLL_INTERVAL);
+}
+
+void WebApplication::processBatchRequest()
+{
+    if (!session())
+        throw ForbiddenHTTPError();
+    if (m_request.method != Http::METHOD_POST)
+        throw MethodNotAllowedHTTPError();
+
+    QJsonParseError jsonError;
+    const QJsonDocument operationsDoc = QJsonDocument::fromJson(m_params.value(u"operations"_s).toUtf8(), &jsonError);
+    if ((jsonError.error != QJsonParseError::NoError) || !operationsDoc.isArray())
+        throw BadRequestHTTPError(tr("'operations' parameter must be JSON array"));
+
+    QJsonArray results;
+    const auto addError = [&results](const HTTPError &error)
+    {
+        results.append(QJsonObject {
+            {u"status"_s, error.statusCode()},
+            {u"error"_s, (!error.message().isEmpty() ? error.message() : error.statusText())}
+        });
+    };
+
+    const QJsonArray operations = operationsDoc.array();
+    for (const QJsonValue &operation : operations)
+    {
+        const QJsonObject operationObj = operation.toObject();
+        const QString actionPath = operationObj.value(u"action"_s).toString();
+        const std::optional<APIPath> apiPath = parseAPIPath(QString(u"/api/v2/" + actionPath));
+        const QString scope = apiPath ? apiPath->scope : QString();
+        const QString action = apiPath ? apiPath->action : QString();
+
+        APIController *controller = apiPath ? session()->getAPIController(scope) : nullptr;
+        if (!controller)
         {
-        case APIErrorType::AccessDenied:
-            throw ForbiddenHTTPError(error.message());
-        case APIErrorType::BadData:
-            throw UnsupportedMediaTypeHTTPError(error.message());
-        case APIErrorType::BadParams:
-            throw BadRequestHTTPError(error.message());
-        case APIErrorType::Conflict:
-            throw ConflictHTTPError(error.message());
-        case APIErrorType::NotFound:
-            throw NotFoundHTTPError(error.message());
-        default:
-            Q_ASSERT(false);
+            addError(NotFoundHTTPError(tr("Unknown action: \"%1\"").arg(actionPath)));
+            continue;
+        }
+        if (m_allowedMethod.value({scope, action}) != Http::METHOD_POST)
+        {
+            addError(MethodNotAllowedHTTPError(tr("Action can't be executed in batch: \"%1\"").arg(actionPath)));
+            continue;
+        }
+
+        StringMap params;
+        const QJsonObject paramsObj = operationObj.value(u"params"_s).toObject();
+        for (auto it = paramsObj.constBegin(); it != paramsObj.constEnd(); ++it)
+        {
+            const QJsonValue value = it.value();
+            params.insert(it.key(), (value.isBool() ? (value.toBool() ? u"true"_s : u"false"_s) : value.toVariant().toString()));
+        }
+
+        try
+        {
+            const APIResult result = controller->run(action, params);
+            results.append(QJsonObject {
+                {u"status"_s, 200},
+                {u"result"_s, toJsonValue(result)}
+            });
+        }
+        catch (const APIError &error)
+        {
+            addError(toHTTPError(error));
         }
     }
+
+    const DataFormat resultFormat = negotiateResultFormat(request().headers.value(Http::HEADER_ACCEPT));
+    if (resultFormat == DataFormat::CBOR)
+        print(QCborValue::fromJsonValue(results).toCbor(), Http::CONTENT_TYPE_CBOR);
+    else
+        print(QJsonDocument(results).toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
+    setHeader({Http::HEADER_VARY, Http::HEADER_ACCEPT});
 }
 
 void WebApplication::configure()
@@ -408,7 +769,7 @@ void WebApplication::configure()
     {
         m_isAltUIUsed = isAltUIUsed;
         m_rootFolder = rootFolder;
-        m_translatedFiles.clear();
+        m_cachedFiles.clear();
         if (!m_isAltUIUsed)
             LogMsg(tr("Using built-in WebUI."));
         else
@@ -419,7 +780,7 @@ void WebApplication::configure()
     if (m_currentLocale != newLocale)
     {
         m_currentLocale = newLocale;
-        m_translatedFiles.clear();
+        m_cachedFiles.clear();
 
         m_translationFileLoaded = m_translator.load((m_rootFolder / Path(u"translations/webui_"_s) + newLocale).data());
         if (m_translationFileLoaded)
@@ -438,8 +799,25 @@ void WebApplication::configure()
     m_authSubnetWhitelist = pref->getWebUIAuthSubnetWhitelist();
     m_sessionTimeout = pref->getWebUISessionTimeout();
 
-    m_domainList = pref->getServerDomains().split(u';', Qt::SkipEmptyParts);
-    std::for_each(m_domainList.begin(), m_domainList.end(), [](QString &entry) { entry = entry.trimmed(); });
+    // Sessions authenticated by the previous key must not outlive it.
+    // The key can be changed by a request that runs within such a session so deletion is deferred.
+    const QByteArray apiKeyHash = pref->getWebUIAPIKeyHash();
+    if (apiKeyHash != m_apiKeyHash)
+    {
+        m_apiKeyHash = apiKeyHash;
+        for (WebSession *session : asConst(m_apiKeySessions))
+            session->deleteLater();
+        m_apiKeySessions.clear();
+    }
+
+    // Domain patterns are compiled once here instead of on every request
+    m_domainPatterns.clear();
+    for (const QString &domain : asConst(pref->getServerDomains().split(u';', Qt::SkipEmptyParts)))
+    {
+        const QString trimmedDomain = domain.trimmed();
+        if (!trimmedDomain.isEmpty())
+            m_domainPatterns.append(QRegularExpression(Utils::String::wildcardToRegexPattern(trimmedDomain), QRegularExpression::CaseInsensitiveOption));
+    }
 
     m_isCSRFProtectionEnabled = pref->isWebUICSRFProtectionEnabled();
     m_isSecureCookieEnabled = pref->isWebUISecureCookieEnabled();
@@ -532,12 +910,27 @@ void WebApplication::sendFile(const Path &path)
 {
     const QDateTime lastModified = Utils::Fs::lastModified(path);
 
-    // find translated file in cache
-    if (const auto it = m_translatedFiles.constFind(path);
-        (it != m_translatedFiles.constEnd()) && (lastModified <= it->lastModified))
+    const auto sendCachedFile = [this](const CachedFile &file)
+    {
+        setHeader({Http::HEADER_CACHE_CONTROL, getCachingInterval(file.mimeType)});
+        setHeader({Http::HEADER_ETAG, file.etag});
+        setHeader({Http::HEADER_VARY, u"accept-encoding"_s});
+
+        if (isETagMatched(request().headers.value(Http::HEADER_IF_NONE_MATCH), file.etag))
+        {
+            status(304, u"Not Modified"_s);
+            return;
+        }
+
+        print(file.data, file.mimeType);
+        setGzipContent(file.gzipData);
+    };
+
+    // find file in cache, its data is shared with the response instead of being read and compressed again
+    if (const auto it = m_cachedFiles.constFind(path);
+        (it != m_cachedFiles.constEnd()) && (lastModified <= it->lastModified))
     {
-        print(it->data, it->mimeType);
-        setHeader({Http::HEADER_CACHE_CONTROL, getCachingInterval(it->mimeType)});
+        sendCachedFile(*it);
         return;
     }
 
@@ -582,7 +975,26 @@ void WebApplication::sendFile(const Path &path)
             dataStr.replace(u"${LANGUAGE_OPTIONS}"_s, createLanguagesOptionsHtml());
 
         data = dataStr.toUtf8();
-        m_translatedFiles[path] = {data, mimeType.name(), lastModified}; // caching translated file
+    }
+
+    if (isTranslatable || (data.size() <= MAX_CACHED_FILESIZE))
+    {
+        // compress it once using the same rules as for the regular responses
+        Http::Response compressed;
+        compressed.headers[Http::HEADER_CONTENT_TYPE] = mimeType.name();
+        compressed.headers[Http::HEADER_CONTENT_ENCODING] = u"gzip"_s;
+        compressed.content = data;
+        Http::compressContent(compressed);
+
+        CachedFile &file = m_cachedFiles[path];
+        file.data = data;
+        file.gzipData = compressed.headers.contains(Http::HEADER_CONTENT_ENCODING) ? compressed.content : QByteArray();
+        file.mimeType = mimeType.name();
+        file.etag = u"\"%1\""_s.arg(QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex()));
+        file.lastModified = lastModified;
+
+        sendCachedFile(file);
+        return;
     }
 
     print(data, mimeType.name());
@@ -591,6 +1003,8 @@ void WebApplication::sendFile(const Path &path)
 
 Http::Response WebApplication::processRequest(const Http::Request &request, const Http::Environment &env)
 {
+    QBT_TRACE_SCOPE("WebApplication::processRequest");
+
     m_currentSession = nullptr;
     m_request = request;
     m_env = env;
@@ -613,7 +1027,7 @@ Http::Response WebApplication::processRequest(const Http::Request &request, cons
     {
         // block suspicious requests
         if ((m_isCSRFProtectionEnabled && isCrossSiteRequest(m_request))
-            || (m_isHostHeaderValidationEnabled && !validateHostHeader(m_domainList)))
+            || (m_isHostHeaderValidationEnabled && !validateHostHeader()))
         {
             throw UnauthorizedHTTPError();
         }
@@ -649,6 +1063,9 @@ void WebApplication::sessionInitialize()
 
     // TODO: Additional session check
 
+    if (sessionId.isEmpty() && apiKeySessionInitialize())
+        return;
+
     if (!sessionId.isEmpty())
     {
         m_currentSession = m_sessions.value(sessionId);
@@ -675,6 +1092,55 @@ void WebApplication::sessionInitialize()
         sessionStart();
 }
 
+bool WebApplication::apiKeySessionInitialize()
+{
+    if (m_apiKeyHash.isEmpty())
+        return false;
+
+    const QString authorization = m_request.headers.value(Http::HEADER_AUTHORIZATION);
+    const QString bearerPrefix = u"Bearer "_s;
+    if (!authorization.startsWith(bearerPrefix, Qt::CaseInsensitive))
+        return false;
+
+    const QByteArray apiKey = QStringView(authorization).sliced(bearerPrefix.size()).trimmed().toUtf8();
+    const QByteArray apiKeyHash = QCryptographicHash::hash(apiKey, QCryptographicHash::Sha256).toHex();
+    if (!Utils::Password::slowEquals(apiKeyHash, m_apiKeyHash))
+        throw UnauthorizedHTTPError();
+
+    // API clients don't keep cookies so a session is kept per client address instead,
+    // otherwise stateful controllers (e.g. "sync") would be recreated on every request
+    const QString id = clientId();
+    m_currentSession = m_apiKeySessions.value(id);
+    if (m_currentSession && m_currentSession->hasExpired(m_sessionTimeout))
+    {
+        delete m_apiKeySessions.take(id);
+        m_currentSession = nullptr;
+    }
+
+    if (m_currentSession)
+    {
+        m_currentSession->updateTimestamp();
+        return true;
+    }
+
+    // remove outdated sessions
+    Algorithm::removeIf(m_apiKeySessions, [this](const QString &, const WebSession *session)
+    {
+        if (session->hasExpired(m_sessionTimeout))
+        {
+            delete session;
+            return true;
+        }
+
+        return false;
+    });
+
+    m_currentSession = new WebSession(id, app());
+    m_apiKeySessions[id] = m_currentSession;
+    registerAPIControllers(m_currentSession);
+    return true;
+}
+
 QString WebApplication::generateSid() const
 {
     QString sid;
@@ -723,19 +1189,7 @@ void WebApplication::sessionStart()
 
     m_currentSession = new WebSession(generateSid(), app());
     m_sessions[m_currentSession->id()] = m_currentSession;
-
-    m_currentSession->registerAPIController(u"app"_s, new AppController(app(), m_currentSession));
-    m_currentSession->registerAPIController(u"log"_s, new LogController(app(), m_currentSession));
-    m_currentSession->registerAPIController(u"torrentcreator"_s, new TorrentCreatorController(m_torrentCreationManager, app(), m_currentSession));
-    m_currentSession->registerAPIController(u"rss"_s, new RSSController(app(), m_currentSession));
-    m_currentSession->registerAPIController(u"search"_s, new SearchController(app(), m_currentSession));
-    m_currentSession->registerAPIController(u"torrents"_s, new TorrentsController(app(), m_currentSession));
-    m_currentSession->registerAPIController(u"transfer"_s, new TransferController(app(), m_currentSession));
-
-    auto *syncController = new SyncController(app(), m_currentSession);
-    syncController->updateFreeDiskSpace(m_freeDiskSpaceChecker->lastResult());
-    connect(m_freeDiskSpaceChecker, &FreeDiskSpaceChecker::checked, syncController, &SyncController::updateFreeDiskSpace);
-    m_currentSession->registerAPIController(u"sync"_s, syncController);
+    registerAPIControllers(m_currentSession);
 
     QNetworkCookie cookie {m_sessionCookieName.toLatin1(), m_currentSession->id().toLatin1()};
     cookie.setHttpOnly(true);
@@ -749,10 +1203,31 @@ void WebApplication::sessionStart()
     setHeader({Http::HEADER_SET_COOKIE, QString::fromLatin1(cookie.toRawForm())});
 }
 
+void WebApplication::registerAPIControllers(WebSession *session)
+{
+    session->registerAPIController(u"app"_s, new AppController(app(), session));
+    session->registerAPIController(u"log"_s, new LogController(app(), session));
+    session->registerAPIController(u"torrentcreator"_s, new TorrentCreatorController(m_torrentCreationManager, app(), session));
+    session->registerAPIController(u"rss"_s, new RSSController(app(), session));
+    session->registerAPIController(u"search"_s, new SearchController(app(), session));
+    session->registerAPIController(u"torrents"_s, new TorrentsController(app(), session));
+    session->registerAPIController(u"transfer"_s, new TransferController(app(), session));
+
+    session->registerAPIController(u"sync"_s, new SyncController(m_maindataChangeLog, app(), session));
+}
+
 void WebApplication::sessionEnd()
 {
     Q_ASSERT(m_currentSession);
 
+    // sessions authenticated by API key have no cookie to clear
+    if (m_apiKeySessions.value(m_currentSession->id()) == m_currentSession)
+    {
+        delete m_apiKeySessions.take(m_currentSession->id());
+        m_currentSession = nullptr;
+        return;
+    }
+
     QNetworkCookie cookie {m_sessionCookieName.toLatin1()};
     cookie.setPath(u"/"_s);
     cookie.setExpirationDate(QDateTime::currentDateTime().addDays(-1));
@@ -814,7 +1289,7 @@ bool WebApplication::isCrossSiteRequest(const Http::Request &request) const
     return true;
 }
 
-bool WebApplication::validateHostHeader(const QStringList &domains) const
+bool WebApplication::validateHostHeader() const
 {
     const QUrl hostHeader = urlFromHostHeader(m_request.headers[Http::HEADER_HOST]);
     const QString requestHost = hostHeader.host();
@@ -837,9 +1312,8 @@ bool WebApplication::validateHostHeader(const QStringList &domains) const
         return true;
 
     // try matching host header with domain list
-    for (const auto &domain : domains)
+    for (const QRegularExpression &domainRegex : asConst(m_domainPatterns))
     {
-        const QRegularExpression domainRegex {Utils::String::wildcardToRegexPattern(domain), QRegularExpression::CaseInsensitiveOption};
         if (requestHost.contains(domainRegex))
             return true;
     }
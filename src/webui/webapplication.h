@@ -54,13 +54,14 @@
 #include "base/utils/version.h"
 #include "api/isessionmanager.h"
 
-inline const Utils::Version<3, 2> API_VERSION {2, 11, 2};
+inline const Utils::Version<3, 2> API_VERSION {2, 11, 46};
 
 class QTimer;
 
 class APIController;
 class AuthController;
 class FreeDiskSpaceChecker;
+class MaindataChangeLog;
 class WebApplication;
 
 namespace BitTorrent
@@ -113,6 +114,8 @@ private:
     void sessionEnd() override;
 
     void doProcessRequest();
+    void processBatchRequest();
+    void processStreamRequest();
     void configure();
 
     void declarePublicAPI(const QString &apiPath);
@@ -125,16 +128,19 @@ private:
     // Session management
     QString generateSid() const;
     void sessionInitialize();
+    bool apiKeySessionInitialize();
+    void registerAPIControllers(WebSession *session);
     bool isAuthNeeded();
     bool isPublicAPI(const QString &scope, const QString &action) const;
 
     bool isCrossSiteRequest(const Http::Request &request) const;
-    bool validateHostHeader(const QStringList &domains) const;
+    bool validateHostHeader() const;
 
     QHostAddress resolveClientAddress() const;
 
     // Persistent data
     QHash<QString, WebSession *> m_sessions;
+    QHash<QString, WebSession *> m_apiKeySessions;  // per client address
 
     // Current data
     WebSession *m_currentSession = nullptr;
@@ -143,14 +149,18 @@ private:
     QHash<QString, QString> m_params;
     const QString m_cacheID;
 
-    const QRegularExpression m_apiPathPattern {u"^/api/v2/(?<scope>[A-Za-z_][A-Za-z_0-9]*)/(?<action>[A-Za-z_][A-Za-z_0-9]*)$"_s};
+    const QString m_batchAPIPath {u"/api/v2/batch"_s};
+    const QString m_streamAPIPath {u"/api/v2/torrents/stream"_s};
 
     QSet<QString> m_publicAPIs;
     const QHash<std::pair<QString, QString>, QString> m_allowedMethod =
     {
         // <<controller name, action name>, HTTP method>
+        {{u"app"_s, u"deleteAPIKey"_s}, Http::METHOD_POST},
+        {{u"app"_s, u"rotateAPIKey"_s}, Http::METHOD_POST},
         {{u"app"_s, u"sendTestEmail"_s}, Http::METHOD_POST},
         {{u"app"_s, u"setPreferences"_s}, Http::METHOD_POST},
+        {{u"app"_s, u"setTracing"_s}, Http::METHOD_POST},
         {{u"app"_s, u"shutdown"_s}, Http::METHOD_POST},
         {{u"auth"_s, u"login"_s}, Http::METHOD_POST},
         {{u"auth"_s, u"logout"_s}, Http::METHOD_POST},
@@ -220,13 +230,15 @@ private:
     bool m_isAltUIUsed = false;
     Path m_rootFolder;
 
-    struct TranslatedFile
+    struct CachedFile
     {
         QByteArray data;
+        QByteArray gzipData;  // empty if compression isn't worth it
         QString mimeType;
+        QString etag;
         QDateTime lastModified;
     };
-    QHash<Path, TranslatedFile> m_translatedFiles;
+    QHash<Path, CachedFile> m_cachedFiles;
     QString m_currentLocale;
     QTranslator m_translator;
     bool m_translationFileLoaded = false;
@@ -237,9 +249,10 @@ private:
     QVector<Utils::Net::Subnet> m_authSubnetWhitelist;
     int m_sessionTimeout = 0;
     QString m_sessionCookieName;
+    QByteArray m_apiKeyHash;
 
     // security related
-    QStringList m_domainList;
+    QList<QRegularExpression> m_domainPatterns;
     bool m_isCSRFProtectionEnabled = true;
     bool m_isSecureCookieEnabled = true;
     bool m_isHostHeaderValidationEnabled = true;
@@ -256,4 +269,5 @@ private:
     FreeDiskSpaceChecker *m_freeDiskSpaceChecker = nullptr;
     QTimer *m_freeDiskSpaceCheckingTimer = nullptr;
     BitTorrent::TorrentCreationManager *m_torrentCreationManager = nullptr;
+    MaindataChangeLog *m_maindataChangeLog = nullptr;
 };
@@ -99,6 +99,8 @@ void WebUI::configure()
 
         m_webapp->setUsername(username);
         m_webapp->setPasswordHash(m_passwordHash);
+        m_httpServer->setConnectionsLimit(pref->getWebUIMaxConnections());
+        m_httpServer->setHttp2Enabled(pref->isWebUIHttp2Enabled());
 
         if (pref->isWebUIHttpsEnabled())
         {
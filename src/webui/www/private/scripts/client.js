@@ -850,6 +850,9 @@ window.addEventListener("DOMContentLoaded", () => {
                             updateTags = true; // Always to update All tag
                         });
                     }
+                    // the filters depend on the lists of the categories and trackers
+                    if (update_categories || updateTrackers)
+                        torrentsTable.invalidateRowsOrder();
                     torrentsTable.updateTable(full_update);
                     torrentsTable.altRow();
                     if (response["server_state"]) {
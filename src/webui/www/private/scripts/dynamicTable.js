@@ -67,8 +67,15 @@ window.qBittorrent.DynamicTable = (function() {
     let DynamicTableHeaderContextMenuClass = null;
     let ProgressColumnWidth = -1;
 
+    // number of rows rendered above and below the visible part of virtual list
+    const VIRTUAL_LIST_EXTRA_ROWS = 10;
+    const DEFAULT_ROW_HEIGHT = 24;
+
     const DynamicTable = new Class({
 
+        // render only the rows scrolled into view, the space of the other ones is kept by the table margins
+        useVirtualList: false,
+
         initialize: function() {},
 
         setup: function(dynamicTableDivId, dynamicTableFixedHeaderDivId, contextMenu) {
@@ -79,6 +86,11 @@ window.qBittorrent.DynamicTable = (function() {
             this.tableBody = $(dynamicTableDivId).getElements("tbody")[0];
             this.rows = new Hash();
             this.selectedRows = [];
+            this.filteredRows = [];
+            this.isRowsOrderDirty = true;
+            this.updatedRowProperties = new Set();
+            this.rowHeight = 0;
+            this.isVirtualListRenderScheduled = false;
             this.columns = [];
             this.contextMenu = contextMenu;
             this.sortedColumn = LocalPreferences.get("sorted_column_" + this.dynamicTableDivId, 0);
@@ -95,6 +107,8 @@ window.qBittorrent.DynamicTable = (function() {
         setupCommonEvents: function() {
             const scrollFn = function() {
                 $(this.dynamicTableFixedHeaderDivId).getElements("table")[0].style.left = -$(this.dynamicTableDivId).scrollLeft + "px";
+                if (this.useVirtualList)
+                    this.scheduleVirtualListRender();
             }.bind(this);
 
             $(this.dynamicTableDivId).addEvent("scroll", scrollFn);
@@ -118,6 +132,8 @@ window.qBittorrent.DynamicTable = (function() {
                     }
 
                     this.lastPanelHeight = panel.getBoundingClientRect().height;
+                    if (this.useVirtualList)
+                        this.scheduleVirtualListRender();
                 }.bind(this);
 
                 $(this.dynamicTableDivId).getParent(".panel").addEvent("resize", resizeFn);
@@ -584,6 +600,12 @@ window.qBittorrent.DynamicTable = (function() {
         selectAll: function() {
             this.deselectAll();
 
+            if (this.useVirtualList) {
+                this.selectedRows = this.filteredRows.map(row => row.rowId);
+                this.setRowClass();
+                return;
+            }
+
             const trs = this.tableBody.getElements("tr");
             for (let i = 0; i < trs.length; ++i) {
                 const tr = trs[i];
@@ -617,16 +639,15 @@ window.qBittorrent.DynamicTable = (function() {
             }
 
             let select = false;
-            const that = this;
-            this.tableBody.getElements("tr").each((tr) => {
-                if ((tr.rowId === rowId1) || (tr.rowId === rowId2)) {
+            for (const rowId of this.getDisplayedRowIds()) {
+                if ((rowId === rowId1) || (rowId === rowId2)) {
                     select = !select;
-                    that.selectedRows.push(tr.rowId);
+                    this.selectedRows.push(rowId);
                 }
                 else if (select) {
-                    that.selectedRows.push(tr.rowId);
+                    this.selectedRows.push(rowId);
                 }
-            });
+            }
             this.setRowClass();
             this.onSelectedRowChanged();
         },
@@ -663,6 +684,7 @@ window.qBittorrent.DynamicTable = (function() {
                     "rowId": rowId
                 };
                 this.rows.set(rowId, row);
+                this.isRowsOrderDirty = true;
             }
             else {
                 row = this.rows.get(rowId);
@@ -673,9 +695,26 @@ window.qBittorrent.DynamicTable = (function() {
                 if (!Object.hasOwn(data, x))
                     continue;
                 row["full_data"][x] = data[x];
+                this.updatedRowProperties.add(x);
             }
         },
 
+        // makes rows to be filtered and sorted again even if their data is unchanged,
+        // e.g. when the data the filters depend on is changed
+        invalidateRowsOrder: function() {
+            this.isRowsOrderDirty = true;
+        },
+
+        // IDs of the rows in the order they are displayed
+        getDisplayedRowIds: function() {
+            if (this.useVirtualList)
+                return this.filteredRows.map(row => row.rowId);
+
+            return this.tableBody.getElements("tr")
+                .filter(tr => tr.getStyle("display") !== "none")
+                .map(tr => tr.rowId);
+        },
+
         getFilteredAndSortedRows: function() {
             const filteredRows = [];
 
@@ -716,6 +755,12 @@ window.qBittorrent.DynamicTable = (function() {
                 }
             }
 
+            if (this.useVirtualList) {
+                this.filteredRows = rows;
+                this.renderVirtualList(fullUpdate);
+                return;
+            }
+
             const trs = this.tableBody.getElements("tr");
 
             for (let rowPos = 0; rowPos < rows.length; ++rowPos) {
@@ -737,68 +782,7 @@ window.qBittorrent.DynamicTable = (function() {
                     this.updateRow(trs[rowPos], fullUpdate);
                 }
                 else { // else create a new row in the table
-                    const tr = new Element("tr");
-                    // set tabindex so element receives keydown events
-                    // more info: https://developer.mozilla.org/en-US/docs/Web/API/Element/keydown_event
-                    tr.setProperty("tabindex", "-1");
-
-                    const rowId = rows[rowPos]["rowId"];
-                    tr.setProperty("data-row-id", rowId);
-                    tr["rowId"] = rowId;
-
-                    tr._this = this;
-                    tr.addEvent("contextmenu", function(e) {
-                        if (!this._this.isRowSelected(this.rowId)) {
-                            this._this.deselectAll();
-                            this._this.selectRow(this.rowId);
-                        }
-                        return true;
-                    });
-                    tr.addEvent("click", function(e) {
-                        e.stop();
-                        if (e.control || e.meta) {
-                            // CTRL/CMD ⌘ key was pressed
-                            if (this._this.isRowSelected(this.rowId))
-                                this._this.deselectRow(this.rowId);
-                            else
-                                this._this.selectRow(this.rowId);
-                        }
-                        else if (e.shift && (this._this.selectedRows.length === 1)) {
-                            // Shift key was pressed
-                            this._this.selectRows(this._this.getSelectedRowId(), this.rowId);
-                        }
-                        else {
-                            // Simple selection
-                            this._this.deselectAll();
-                            this._this.selectRow(this.rowId);
-                        }
-                        return false;
-                    });
-                    tr.addEvent("touchstart", function(e) {
-                        if (!this._this.isRowSelected(this.rowId)) {
-                            this._this.deselectAll();
-                            this._this.selectRow(this.rowId);
-                        }
-                    });
-                    tr.addEvent("keydown", function(event) {
-                        switch (event.key) {
-                            case "up":
-                                this._this.selectPreviousRow();
-                                return false;
-                            case "down":
-                                this._this.selectNextRow();
-                                return false;
-                        }
-                    });
-
-                    this.setupTr(tr);
-
-                    for (let k = 0; k < this.columns.length; ++k) {
-                        const td = new Element("td");
-                        if ((this.columns[k].visible === "0") || this.columns[k].force_hide)
-                            td.addClass("invisible");
-                        td.injectInside(tr);
-                    }
+                    const tr = this.createTr(rows[rowPos]["rowId"]);
 
                     // Insert
                     if (rowPos >= trs.length) {
@@ -824,6 +808,170 @@ window.qBittorrent.DynamicTable = (function() {
                 trs.pop().destroy();
         },
 
+        scheduleVirtualListRender: function() {
+            if (this.isVirtualListRenderScheduled)
+                return;
+
+            this.isVirtualListRenderScheduled = true;
+            window.requestAnimationFrame(() => {
+                this.isVirtualListRenderScheduled = false;
+                this.renderVirtualList(false);
+            });
+        },
+
+        getRowHeight: function() {
+            if (this.rowHeight <= 0) {
+                const tr = this.tableBody.getElement("tr");
+                if ((tr !== null) && (tr.offsetHeight > 0))
+                    this.rowHeight = tr.offsetHeight;
+            }
+            return (this.rowHeight > 0) ? this.rowHeight : DEFAULT_ROW_HEIGHT;
+        },
+
+        // creates, moves and removes the elements of only the rows scrolled into view,
+        // so the cost of the update doesn't depend on the total number of rows
+        renderVirtualList: function(fullUpdate) {
+            const tableDiv = $(this.dynamicTableDivId);
+            // dynamicTableDivId is not visible on the UI
+            if (!tableDiv)
+                return;
+
+            const rows = this.filteredRows;
+            const rowHeight = this.getRowHeight();
+            let firstPos = Math.max(0, (Math.floor(tableDiv.scrollTop / rowHeight) - VIRTUAL_LIST_EXTRA_ROWS));
+            // keep the alternating row colors bound to the rows
+            firstPos -= (firstPos % 2);
+            const lastPos = Math.min(rows.length, (Math.ceil((tableDiv.scrollTop + tableDiv.clientHeight) / rowHeight) + VIRTUAL_LIST_EXTRA_ROWS));
+
+            const table = this.tableBody.getParent("table");
+            table.style.marginTop = (firstPos * rowHeight) + "px";
+            table.style.marginBottom = (Math.max(0, (rows.length - lastPos)) * rowHeight) + "px";
+
+            const obsoleteTrs = new Map();
+            for (const tr of this.tableBody.getElements("tr"))
+                obsoleteTrs.set(tr.rowId, tr);
+
+            let prevTr = null;
+            for (let rowPos = firstPos; rowPos < lastPos; ++rowPos) {
+                const rowId = rows[rowPos]["rowId"];
+                let tr = obsoleteTrs.get(rowId);
+                const isNewTr = (tr === undefined);
+                if (isNewTr) {
+                    tr = this.createTr(rowId);
+                    if (this.isRowSelected(rowId))
+                        tr.addClass("selected");
+                }
+                else {
+                    obsoleteTrs.delete(rowId);
+                }
+
+                const nextTr = (prevTr !== null) ? prevTr.getNext() : this.tableBody.getFirst();
+                if (nextTr !== tr) {
+                    if (nextTr !== null)
+                        tr.inject(nextTr, "before");
+                    else
+                        tr.inject(this.tableBody);
+                }
+
+                // Update context menu
+                if (isNewTr && this.contextMenu)
+                    this.contextMenu.addTarget(tr);
+
+                this.updateRow(tr, (fullUpdate || isNewTr));
+                prevTr = tr;
+            }
+
+            for (const tr of obsoleteTrs.values())
+                tr.destroy();
+
+            // render again once the actual height of the rows is known
+            if ((rowHeight === DEFAULT_ROW_HEIGHT) && (this.getRowHeight() !== rowHeight))
+                this.scheduleVirtualListRender();
+        },
+
+        scrollToRow: function(rowId) {
+            if (!this.useVirtualList)
+                return;
+
+            const rowPos = this.filteredRows.findIndex(row => row.rowId === rowId);
+            if (rowPos < 0)
+                return;
+
+            const tableDiv = $(this.dynamicTableDivId);
+            const rowHeight = this.getRowHeight();
+            const rowTop = rowPos * rowHeight;
+            if (rowTop < tableDiv.scrollTop)
+                tableDiv.scrollTop = rowTop;
+            else if ((rowTop + rowHeight) > (tableDiv.scrollTop + tableDiv.clientHeight))
+                tableDiv.scrollTop = rowTop + rowHeight - tableDiv.clientHeight;
+        },
+
+        createTr: function(rowId) {
+            const tr = new Element("tr");
+            // set tabindex so element receives keydown events
+            // more info: https://developer.mozilla.org/en-US/docs/Web/API/Element/keydown_event
+            tr.setProperty("tabindex", "-1");
+
+            tr.setProperty("data-row-id", rowId);
+            tr["rowId"] = rowId;
+
+            tr._this = this;
+            tr.addEvent("contextmenu", function(e) {
+                if (!this._this.isRowSelected(this.rowId)) {
+                    this._this.deselectAll();
+                    this._this.selectRow(this.rowId);
+                }
+                return true;
+            });
+            tr.addEvent("click", function(e) {
+                e.stop();
+                if (e.control || e.meta) {
+                    // CTRL/CMD ⌘ key was pressed
+                    if (this._this.isRowSelected(this.rowId))
+                        this._this.deselectRow(this.rowId);
+                    else
+                        this._this.selectRow(this.rowId);
+                }
+                else if (e.shift && (this._this.selectedRows.length === 1)) {
+                    // Shift key was pressed
+                    this._this.selectRows(this._this.getSelectedRowId(), this.rowId);
+                }
+                else {
+                    // Simple selection
+                    this._this.deselectAll();
+                    this._this.selectRow(this.rowId);
+                }
+                return false;
+            });
+            tr.addEvent("touchstart", function(e) {
+                if (!this._this.isRowSelected(this.rowId)) {
+                    this._this.deselectAll();
+                    this._this.selectRow(this.rowId);
+                }
+            });
+            tr.addEvent("keydown", function(event) {
+                switch (event.key) {
+                    case "up":
+                        this._this.selectPreviousRow();
+                        return false;
+                    case "down":
+                        this._this.selectNextRow();
+                        return false;
+                }
+            });
+
+            this.setupTr(tr);
+
+            for (let k = 0; k < this.columns.length; ++k) {
+                const td = new Element("td");
+                if ((this.columns[k].visible === "0") || this.columns[k].force_hide)
+                    td.addClass("invisible");
+                td.injectInside(tr);
+            }
+
+            return tr;
+        },
+
         setupTr: function(tr) {},
 
         updateRow: function(tr, fullUpdate) {
@@ -844,6 +992,13 @@ window.qBittorrent.DynamicTable = (function() {
             if (tr !== null) {
                 tr.destroy();
                 this.rows.erase(rowId);
+                this.isRowsOrderDirty = true;
+                return true;
+            }
+            // virtual list has elements only for the rows scrolled into view
+            if (this.useVirtualList && this.rows.has(rowId)) {
+                this.rows.erase(rowId);
+                this.isRowsOrderDirty = true;
                 return true;
             }
             return false;
@@ -852,6 +1007,8 @@ window.qBittorrent.DynamicTable = (function() {
         clear: function() {
             this.deselectAll();
             this.rows.empty();
+            this.filteredRows = [];
+            this.isRowsOrderDirty = true;
             const trs = this.tableBody.getElements("tr");
             while (trs.length > 0)
                 trs.pop().destroy();
@@ -866,46 +1023,30 @@ window.qBittorrent.DynamicTable = (function() {
         },
 
         selectNextRow: function() {
-            const visibleRows = $(this.dynamicTableDivId).getElements("tbody tr").filter(e => e.getStyle("display") !== "none");
-            const selectedRowId = this.getSelectedRowId();
-
-            let selectedIndex = -1;
-            for (let i = 0; i < visibleRows.length; ++i) {
-                const row = visibleRows[i];
-                if (row.getProperty("data-row-id") === selectedRowId) {
-                    selectedIndex = i;
-                    break;
-                }
-            }
+            const visibleRowIds = this.getDisplayedRowIds();
+            const selectedIndex = visibleRowIds.indexOf(this.getSelectedRowId());
 
-            const isLastRowSelected = (selectedIndex >= (visibleRows.length - 1));
+            const isLastRowSelected = (selectedIndex >= (visibleRowIds.length - 1));
             if (!isLastRowSelected) {
                 this.deselectAll();
 
-                const newRow = visibleRows[selectedIndex + 1];
-                this.selectRow(newRow.getProperty("data-row-id"));
+                const newRowId = visibleRowIds[selectedIndex + 1];
+                this.selectRow(newRowId);
+                this.scrollToRow(newRowId);
             }
         },
 
         selectPreviousRow: function() {
-            const visibleRows = $(this.dynamicTableDivId).getElements("tbody tr").filter(e => e.getStyle("display") !== "none");
-            const selectedRowId = this.getSelectedRowId();
-
-            let selectedIndex = -1;
-            for (let i = 0; i < visibleRows.length; ++i) {
-                const row = visibleRows[i];
-                if (row.getProperty("data-row-id") === selectedRowId) {
-                    selectedIndex = i;
-                    break;
-                }
-            }
+            const visibleRowIds = this.getDisplayedRowIds();
+            const selectedIndex = visibleRowIds.indexOf(this.getSelectedRowId());
 
             const isFirstRowSelected = selectedIndex <= 0;
             if (!isFirstRowSelected) {
                 this.deselectAll();
 
-                const newRow = visibleRows[selectedIndex - 1];
-                this.selectRow(newRow.getProperty("data-row-id"));
+                const newRowId = visibleRowIds[selectedIndex - 1];
+                this.selectRow(newRowId);
+                this.scrollToRow(newRowId);
             }
         },
     });
@@ -913,6 +1054,8 @@ window.qBittorrent.DynamicTable = (function() {
     const TorrentsTable = new Class({
         Extends: DynamicTable,
 
+        useVirtualList: true,
+
         initColumns: function() {
             this.newColumn("priority", "", "#", 30, true);
             this.newColumn("state_icon", "cursor: default", "", 22, true);
@@ -1535,19 +1678,47 @@ window.qBittorrent.DynamicTable = (function() {
         },
 
         getFilteredAndSortedRows: function() {
-            const filteredRows = [];
-
-            const rows = this.rows.getValues();
             const useRegex = $("torrentsFilterRegexBox").checked;
             const filterText = $("torrentsFilterInput").value.trim().toLowerCase();
-            const filterTerms = (filterText.length > 0)
-                ? (useRegex ? new RegExp(filterText) : filterText.split(" "))
-                : null;
 
-            for (let i = 0; i < rows.length; ++i) {
-                if (this.applyFilter(rows[i], selected_filter, selected_category, selectedTag, selectedTracker, filterTerms)) {
-                    filteredRows.push(rows[i]);
-                    filteredRows[rows[i].rowId] = rows[i];
+            // most of the updates change only the values which don't affect the order of the rows,
+            // so the rows are filtered and sorted again only if the filter or the sorted value is changed
+            const filterState = JSON.stringify([selected_filter, selected_category, selectedTag, selectedTracker, useSubcategories, useRegex, filterText]);
+            const sortState = `${this.sortedColumn}|${this.reverseSort}`;
+            const filterProperties = ["state", "name", "category", "tags", "trackers_count"];
+            if ((selected_filter === "active") || (selected_filter === "inactive"))
+                filterProperties.push("upspeed");
+            const isUpdated = properties => properties.some(property => this.updatedRowProperties.has(property));
+
+            const isFilteringRequired = this.isRowsOrderDirty
+                || (filterState !== this.filteredRowsFilterState)
+                || isUpdated(filterProperties);
+            const isSortingRequired = isFilteringRequired
+                || (sortState !== this.filteredRowsSortState)
+                || isUpdated(this.columns[this.sortedColumn].dataProperties);
+
+            this.isRowsOrderDirty = false;
+            this.updatedRowProperties.clear();
+            if (!isSortingRequired)
+                return this.filteredRows;
+
+            this.filteredRowsFilterState = filterState;
+            this.filteredRowsSortState = sortState;
+
+            let filteredRows = this.filteredRows;
+            if (isFilteringRequired) {
+                filteredRows = [];
+
+                const rows = this.rows.getValues();
+                const filterTerms = (filterText.length > 0)
+                    ? (useRegex ? new RegExp(filterText) : filterText.split(" "))
+                    : null;
+
+                for (let i = 0; i < rows.length; ++i) {
+                    if (this.applyFilter(rows[i], selected_filter, selected_category, selectedTag, selectedTracker, filterTerms)) {
+                        filteredRows.push(rows[i]);
+                        filteredRows[rows[i].rowId] = rows[i];
+                    }
                 }
             }
 
@@ -97,7 +97,7 @@ window.qBittorrent.PiecesBar = (() => {
     });
 
     function setPieces(pieces) {
-        if (!Array.isArray(pieces))
+        if (!Array.isArray(pieces) && !(pieces instanceof Uint8Array))
             pieces = [];
 
         this.vals.pieces = pieces;
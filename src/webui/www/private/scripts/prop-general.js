@@ -229,28 +229,29 @@ window.qBittorrent.PropGeneral = (function() {
             }
         }).send();
 
-        const piecesUrl = new URI("api/v2/torrents/pieceStates?hash=" + current_id);
-        new Request.JSON({
-            url: piecesUrl,
-            method: "get",
-            noCache: true,
-            onFailure: function() {
-                $("error_div").set("html", "QBT_TR(qBittorrent client is not reachable)QBT_TR[CONTEXT=HttpServer]");
-                clearTimeout(loadTorrentDataTimer);
-                loadTorrentDataTimer = loadTorrentData.delay(10000);
-            },
-            onSuccess: function(data) {
+        // piece states are fetched as raw bytes, one per piece, which is much more compact than JSON for large torrents
+        const piecesUrl = new URI("api/v2/torrents/pieceStates?hash=" + current_id + "&format=binary");
+        fetch(piecesUrl.toString(), {
+            method: "GET",
+            cache: "no-store"
+        })
+            .then(function(response) {
+                if (!response.ok)
+                    throw new Error(response.statusText);
+                return response.arrayBuffer();
+            })
+            .then(function(data) {
                 $("error_div").set("html", "");
 
-                if (data)
-                    piecesBar.setPieces(data);
-                else
-                    clearData();
+                piecesBar.setPieces(new Uint8Array(data));
 
                 clearTimeout(loadTorrentDataTimer);
                 loadTorrentDataTimer = loadTorrentData.delay(5000);
-            }
-        }).send();
+            }, function() {
+                $("error_div").set("html", "QBT_TR(qBittorrent client is not reachable)QBT_TR[CONTEXT=HttpServer]");
+                clearTimeout(loadTorrentDataTimer);
+                loadTorrentDataTimer = loadTorrentData.delay(10000);
+            });
     };
 
     const updateData = function() {
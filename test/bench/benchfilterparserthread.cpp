@@ -0,0 +1,128 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QByteArray>
+#include <QFile>
+#include <QObject>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/filterparserthread.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/path.h"
+#include "base/utils/fs.h"
+#include "base/utils/io.h"
+
+namespace
+{
+    const int RULE_COUNT = 100000;
+
+    // eMule DAT format: "first IP - last IP , access level , description"
+    QByteArray makeDatFilter()
+    {
+        QByteArray data;
+        for (int i = 0; i < RULE_COUNT; ++i)
+        {
+            const QByteArray prefix = QByteArray::number(1 + (i / 65536)) + '.' + QByteArray::number((i / 256) % 256)
+                + '.' + QByteArray::number(i % 256) + '.';
+            data += prefix + "0 - " + prefix + "255 , 000 , Some Organization " + QByteArray::number(i) + '\n';
+        }
+        return data;
+    }
+}
+
+class BenchFilterParserThread final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchFilterParserThread)
+
+public:
+    BenchFilterParserThread() = default;
+
+private slots:
+    void initTestCase()
+    {
+        Logger::initInstance();
+
+        QVERIFY(m_tempDir.isValid());
+        QVERIFY(Utils::IO::saveToFile(filterPath(), makeDatFilter()));
+    }
+
+    void cleanupTestCase()
+    {
+        Logger::freeInstance();
+    }
+
+    void benchParse() const
+    {
+        QBENCHMARK
+        {
+            // filter is parsed from scratch only if there is no cache
+            Utils::Fs::removeFile(cachePath());
+            QCOMPARE(parse(), RULE_COUNT);
+        }
+    }
+
+    void benchLoadCache() const
+    {
+        QCOMPARE(parse(), RULE_COUNT);
+
+        QBENCHMARK
+        {
+            QCOMPARE(parse(), RULE_COUNT);
+        }
+    }
+
+private:
+    Path filterPath() const
+    {
+        return Path(m_tempDir.path()) / Path(u"filter.dat"_s);
+    }
+
+    Path cachePath() const
+    {
+        return Path(m_tempDir.path()) / Path(u"filter.cache"_s);
+    }
+
+    int parse() const
+    {
+        FilterParserThread parser;
+        const QSignalSpy spy {&parser, &FilterParserThread::IPFilterParsed};
+        parser.processFilterFile(filterPath(), cachePath());
+        parser.wait();
+        return spy.isEmpty() ? -1 : spy.first().first().toInt();
+    }
+
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_APPLESS_MAIN(BenchFilterParserThread)
+#include "benchfilterparserthread.moc"
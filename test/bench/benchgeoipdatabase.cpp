@@ -0,0 +1,186 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <memory>
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/net/geoipdatabase.h"
+
+namespace
+{
+    // minimal MaxMind DB with 24 bit records: IPv4 addresses are mapped to `::ffff:0:0/96`
+    // and their first 16 bits select one of several country records
+    const int IPV4_PREFIX_BITS = 16;
+    const char COUNTRIES[][3] = {"US", "DE", "CN", "NL", "FR", "JP", "BR", "RU"};
+    const int COUNTRY_COUNT = sizeof(COUNTRIES) / sizeof(COUNTRIES[0]);
+
+    void appendUInt(QByteArray &data, const quint64 value, const int bytes)
+    {
+        for (int i = (bytes - 1); i >= 0; --i)
+            data += static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+
+    void appendString(QByteArray &data, const QByteArray &str)
+    {
+        data += static_cast<char>(0x40 | str.size());
+        data += str;
+    }
+
+    void appendNode(QByteArray &tree, const quint32 left, const quint32 right)
+    {
+        appendUInt(tree, left, 3);
+        appendUInt(tree, right, 3);
+    }
+
+    QByteArray makeDatabase()
+    {
+        const quint32 chainNodeCount = 96;
+        const quint32 treeNodeCount = (1U << IPV4_PREFIX_BITS) - 1;
+        const quint32 nodeCount = chainNodeCount + treeNodeCount;
+        const quint32 separatorSize = 16;
+
+        // data section: {"country": {"iso_code": "XX"}}
+        QByteArray dataSection;
+        QList<quint32> recordOffsets;
+        for (const char *country : COUNTRIES)
+        {
+            recordOffsets.append(dataSection.size());
+            dataSection += '\xE1';
+            appendString(dataSection, "country");
+            dataSection += '\xE1';
+            appendString(dataSection, "iso_code");
+            appendString(dataSection, country);
+        }
+
+        QByteArray db;
+        // ::ffff:0:0/96 prefix, any other address isn't found
+        for (quint32 i = 0; i < chainNodeCount; ++i)
+        {
+            if (i < 80)
+                appendNode(db, (i + 1), nodeCount);
+            else
+                appendNode(db, nodeCount, (i + 1));
+        }
+        // complete binary tree over the first bits of IPv4 address
+        const quint32 firstLeafNode = (treeNodeCount / 2);
+        for (quint32 i = 0; i < treeNodeCount; ++i)
+        {
+            if (i < firstLeafNode)
+            {
+                appendNode(db, (chainNodeCount + (2 * i) + 1), (chainNodeCount + (2 * i) + 2));
+            }
+            else
+            {
+                const quint32 prefix = (i - firstLeafNode) * 2;
+                const auto recordId = [&](const quint32 p) { return nodeCount + separatorSize + recordOffsets[p % COUNTRY_COUNT]; };
+                appendNode(db, recordId(prefix), recordId(prefix + 1));
+            }
+        }
+
+        db += QByteArray(separatorSize, '\0');
+        db += dataSection;
+
+        db += QByteArray("\xAB\xCD\xEFMaxMind.com");
+        db += '\xE7';
+        appendString(db, "binary_format_major_version");
+        db += '\xA1';
+        appendUInt(db, 2, 1);
+        appendString(db, "binary_format_minor_version");
+        db += '\xA1';
+        appendUInt(db, 0, 1);
+        appendString(db, "ip_version");
+        db += '\xA1';
+        appendUInt(db, 6, 1);
+        appendString(db, "record_size");
+        db += '\xA1';
+        appendUInt(db, 24, 1);
+        appendString(db, "node_count");
+        db += '\xC4';
+        appendUInt(db, nodeCount, 4);
+        appendString(db, "database_type");
+        appendString(db, "DBIP-Country-Lite");
+        appendString(db, "build_epoch");
+        db += '\x08';
+        db += '\x02';
+        appendUInt(db, 1700000000, 8);
+
+        return db;
+    }
+}
+
+class BenchGeoIPDatabase final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchGeoIPDatabase)
+
+public:
+    BenchGeoIPDatabase() = default;
+
+private slots:
+    void initTestCase()
+    {
+        QString error;
+        m_db.reset(GeoIPDatabase::load(makeDatabase(), error));
+        QVERIFY2(m_db, qPrintable(error));
+        QCOMPARE(m_db->lookup(QHostAddress(u"0.1.2.3"_s)), u"DE"_s);
+
+        for (quint32 i = 0; i < 10000; ++i)
+            m_addresses.append(QHostAddress(i * 2654435761U));
+    }
+
+    void benchLookup() const
+    {
+        QBENCHMARK
+        {
+            for (const QHostAddress &address : m_addresses)
+                [[maybe_unused]] const QString country = m_db->lookup(address);
+        }
+    }
+
+    void benchLookupCountryCodes() const
+    {
+        QBENCHMARK
+        {
+            [[maybe_unused]] const QList<quint16> countryCodes = m_db->lookupCountryCodes(m_addresses);
+        }
+    }
+
+private:
+    std::unique_ptr<GeoIPDatabase> m_db;
+    QList<QHostAddress> m_addresses;
+};
+
+QTEST_APPLESS_MAIN(BenchGeoIPDatabase)
+#include "benchgeoipdatabase.moc"
@@ -0,0 +1,84 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/path.h"
+
+class BenchPath final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchPath)
+
+public:
+    BenchPath() = default;
+
+private slots:
+    void benchNormalize_data() const
+    {
+        QTest::addColumn<QString>("path");
+        QTest::newRow("clean") << u"/home/user/Downloads/Some Torrent/Season 1/episode01.mkv"_s;
+        QTest::newRow("unclean") << u"/home/user//Downloads/./Some Torrent/../Some Torrent/Season 1/episode01.mkv"_s;
+        QTest::newRow("relative") << u"Some Torrent/Season 1/Extras/./featurette.mkv"_s;
+    }
+
+    void benchNormalize() const
+    {
+        QFETCH(const QString, path);
+
+        qsizetype length = 0;
+        QBENCHMARK
+        {
+            length += Path(path).data().size();
+        }
+        QVERIFY(length > 0);
+    }
+
+    void benchJoin() const
+    {
+        // file paths of a torrent are built from save path and relative file path
+        QList<Path> filePaths;
+        for (int i = 0; i < 10000; ++i)
+            filePaths.append(Path(u"Some Torrent/Disc %1/track%2.flac"_s.arg(i / 100).arg(i % 100)));
+        const Path savePath {u"/home/user/Downloads"_s};
+
+        QBENCHMARK
+        {
+            for (const Path &filePath : filePaths)
+                [[maybe_unused]] const Path fullPath = savePath / filePath;
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(BenchPath)
+#include "benchpath.moc"
@@ -0,0 +1,76 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <vector>
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/peer_blacklist.hpp"
+#include "base/global.h"
+#include "benchpeers.h"
+
+class BenchPeerBlacklist final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchPeerBlacklist)
+
+public:
+    BenchPeerBlacklist() = default;
+
+private slots:
+    void benchMatch_data() const
+    {
+        // rules depending on peer country need GeoIP database, so they are left out
+        QTest::addColumn<bool>("mediaPlayers");
+        QTest::newRow("bad peers") << false;
+        QTest::newRow("bad peers and media players") << true;
+    }
+
+    void benchMatch() const
+    {
+        QFETCH(const bool, mediaPlayers);
+
+        const builtin_peer_rules rules {{.unknown_peers = false, .offline_downloaders = false, .media_players = mediaPlayers}};
+        const std::vector<lt::peer_info> peers = makePeers(10000);
+        int matched = 0;
+        QBENCHMARK
+        {
+            for (const lt::peer_info &peer : peers)
+            {
+                if (rules.match(peer))
+                    ++matched;
+            }
+        }
+        QVERIFY(matched > 0);
+    }
+};
+
+QTEST_APPLESS_MAIN(BenchPeerBlacklist)
+#include "benchpeerblacklist.moc"
@@ -0,0 +1,108 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <vector>
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/peer_filter.hpp"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/path.h"
+#include "base/utils/io.h"
+#include "benchpeers.h"
+
+class BenchPeerFilter final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchPeerFilter)
+
+public:
+    BenchPeerFilter() = default;
+
+private slots:
+    void initTestCase()
+    {
+        Logger::initInstance();
+        QVERIFY(m_tempDir.isValid());
+    }
+
+    void cleanupTestCase()
+    {
+        Logger::freeInstance();
+    }
+
+    void benchMatchPeer_data() const
+    {
+        QTest::addColumn<QByteArray>("rules");
+        QTest::addColumn<bool>("skipName");
+        // "peer id expression" "client name expression" per line
+        const QByteArray rules = "-XL0012- .*\n"
+            "^-SD\\d{4}- .*\n"
+            "-BC0205- BitComet.*\n"
+            "^-TR[0-3] Transmission.*\n"
+            "-(DT|HP)\\d+- .*\n"
+            ".* (dt|hp)/torrent.*\n"
+            "^-qB4[0-3] qBittorrent.*\n"
+            "^-LT1220- .*\n";
+        QTest::newRow("handshake") << rules << true;
+        QTest::newRow("with client name") << rules << false;
+    }
+
+    void benchMatchPeer() const
+    {
+        QFETCH(const QByteArray, rules);
+        QFETCH(const bool, skipName);
+
+        const Path filterPath = Path(m_tempDir.path()) / Path(u"peer_blacklist.txt"_s);
+        QVERIFY(Utils::IO::saveToFile(filterPath, rules));
+        const peer_filter filter {filterPath.data()};
+        QVERIFY(!filter.is_empty());
+
+        const std::vector<lt::peer_info> peers = makePeers(10000);
+        int matched = 0;
+        QBENCHMARK
+        {
+            for (const lt::peer_info &peer : peers)
+            {
+                if (filter.match_peer(peer, skipName))
+                    ++matched;
+            }
+        }
+        QVERIFY(matched > 0);
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_APPLESS_MAIN(BenchPeerFilter)
+#include "benchpeerfilter.moc"
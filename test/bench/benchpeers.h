@@ -0,0 +1,78 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <libtorrent/address.hpp>
+#include <libtorrent/peer_id.hpp>
+#include <libtorrent/peer_info.hpp>
+#include <libtorrent/socket.hpp>
+
+// Synthetic swarm with the mix of clients the peer filters usually see
+inline std::vector<lt::peer_info> makePeers(const int count)
+{
+    struct Client
+    {
+        std::string pid;
+        std::string name;
+    };
+
+    const Client clients[] =
+    {
+        {"-qB4650-", "qBittorrent/4.6.5"},
+        {"-qB5010-", "qBittorrent/5.0.1"},
+        {"-TR4060-", "Transmission 4.0.6"},
+        {"-UT360S-", "\xC2\xB5Torrent 3.6.0"},
+        {"-LT2090-", "libtorrent/2.0.9"},
+        {"-DE13F0-", "Deluge 1.3.15"},
+        {"-XL0012-", "Xunlei 0.0.1.2"},
+        {"-SD0100-", "Thunder 0.1.0.0"},
+        {"M7-5-0--", "Mainline 7.5.0"},
+        {"-BC0205-", "BitComet 2.05"}
+    };
+    const int clientCount = sizeof(clients) / sizeof(clients[0]);
+
+    std::vector<lt::peer_info> peers(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const Client &client = clients[i % clientCount];
+        std::string pid = client.pid + std::to_string(100000000000 + i);
+        pid.resize(20, '0');
+
+        lt::peer_info &peer = peers[i];
+        peer.pid = lt::peer_id(pid.data());
+        peer.client = client.name;
+        peer.ip = lt::tcp::endpoint(lt::address_v4(static_cast<std::uint32_t>(i) * 2654435761U), static_cast<unsigned short>(1024 + (i % 60000)));
+    }
+    return peers;
+}
@@ -0,0 +1,89 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <algorithm>
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/utils/compare.h"
+
+class BenchUtilsCompare final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchUtilsCompare)
+
+public:
+    BenchUtilsCompare() = default;
+
+private slots:
+    void benchNaturalCompare() const
+    {
+        const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> compare;
+        const QString left = u"Some.Show.S01E09.1080p.WEB-DL"_s;
+        const QString right = u"Some.Show.S01E10.1080p.WEB-DL"_s;
+        int result = 0;
+        QBENCHMARK
+        {
+            result += compare(left, right);
+        }
+        QVERIFY(result != 0);
+    }
+
+    void benchNaturalSort_data() const
+    {
+        QTest::addColumn<int>("count");
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("10000") << 10000;
+    }
+
+    void benchNaturalSort() const
+    {
+        QFETCH(const int, count);
+
+        // typical torrent names, sorted by the transfer list
+        QList<QString> names;
+        names.reserve(count);
+        for (int i = 0; i < count; ++i)
+            names.append(u"Torrent %1 - Part %2.mkv"_s.arg(((i * 7919) % count)).arg(i % 13));
+
+        const Utils::Compare::NaturalLessThan<Qt::CaseInsensitive> lessThan;
+        QBENCHMARK
+        {
+            QList<QString> sorted = names;
+            std::sort(sorted.begin(), sorted.end(), lessThan);
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(BenchUtilsCompare)
+#include "benchutilscompare.moc"
@@ -0,0 +1,96 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QByteArray>
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/utils/gzip.h"
+
+namespace
+{
+    // JSON-like data, similar to WebAPI responses which are compressed the most
+    QByteArray makeData(const int size)
+    {
+        QByteArray data;
+        data.reserve(size);
+        for (int i = 0; data.size() < size; ++i)
+            data += R"({"hash":")" + QByteArray::number((i * 2654435761U), 16) + R"(","progress":)" + QByteArray::number(i % 100) + "},";
+        data.truncate(size);
+        return data;
+    }
+}
+
+class BenchUtilsGzip final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BenchUtilsGzip)
+
+public:
+    BenchUtilsGzip() = default;
+
+private slots:
+    void benchCompress_data() const
+    {
+        QTest::addColumn<int>("size");
+        QTest::addColumn<int>("level");
+        QTest::newRow("4KiB, level 6") << 4096 << 6;
+        QTest::newRow("1MiB, level 1") << (1024 * 1024) << 1;
+        QTest::newRow("1MiB, level 6") << (1024 * 1024) << 6;
+    }
+
+    void benchCompress() const
+    {
+        QFETCH(const int, size);
+        QFETCH(const int, level);
+
+        const QByteArray data = makeData(size);
+        bool ok = false;
+        QBENCHMARK
+        {
+            [[maybe_unused]] const QByteArray compressedData = Utils::Gzip::compress(data, level, &ok);
+        }
+        QVERIFY(ok);
+    }
+
+    void benchDecompress() const
+    {
+        const QByteArray compressedData = Utils::Gzip::compress(makeData(1024 * 1024));
+        bool ok = false;
+        QBENCHMARK
+        {
+            [[maybe_unused]] const QByteArray data = Utils::Gzip::decompress(compressedData, &ok);
+        }
+        QVERIFY(ok);
+    }
+};
+
+QTEST_APPLESS_MAIN(BenchUtilsGzip)
+#include "benchutilsgzip.moc"
@@ -0,0 +1,27 @@
+# Runs the benchmarks and converts their CSV results to single JSON file.
+# Expects `BENCHMARKS` (list of benchmark executables) and `OUTPUT_DIR`.
+
+set(results)
+foreach(benchmark ${BENCHMARKS})
+    get_filename_component(benchmarkName "${benchmark}" NAME_WE)
+    set(csvFile "${OUTPUT_DIR}/${benchmarkName}.csv")
+
+    message(STATUS "Running ${benchmarkName}")
+    execute_process(COMMAND "${benchmark}" -o "${csvFile},csv" -o "-,txt"
+        RESULT_VARIABLE exitCode)
+    if (NOT exitCode EQUAL 0)
+        message(FATAL_ERROR "${benchmarkName} failed")
+    endif()
+
+    # QtTest writes one line per benchmark: "function","tag","metric",value,total,iterations
+    file(STRINGS "${csvFile}" lines)
+    foreach(line ${lines})
+        if (line MATCHES "^\"([^\"]*)\",\"([^\"]*)\",\"([^\"]*)\",([^,]+),([^,]+),([^,]+)$")
+            list(APPEND results "    {\"benchmark\": \"${benchmarkName}\", \"function\": \"${CMAKE_MATCH_1}\", \"tag\": \"${CMAKE_MATCH_2}\", \"metric\": \"${CMAKE_MATCH_3}\", \"value\": ${CMAKE_MATCH_4}, \"total\": ${CMAKE_MATCH_5}, \"iterations\": ${CMAKE_MATCH_6}}")
+        endif()
+    endforeach()
+endforeach()
+
+list(JOIN results ",\n" resultsJson)
+file(WRITE "${OUTPUT_DIR}/benchmark_results.json" "[\n${resultsJson}\n]\n")
+message(STATUS "Benchmark results written to ${OUTPUT_DIR}/benchmark_results.json")
@@ -0,0 +1,387 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+// Synthetic session load generator.
+// Fills the session with generated torrents, keeps some of them announcing to local
+// unreachable trackers and fetches peer lists at the given rate, while the latency of
+// the main thread, the cost of consuming torrent updates and the memory usage are measured.
+// Results are written to standard output as JSON.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/entry.hpp>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <QFile>
+#include <unistd.h>
+#endif
+
+#include "base/bittorrent/addtorrentparams.h"
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/torrent.h"
+#include "base/bittorrent/torrentdescriptor.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/net/downloadmanager.h"
+#include "base/net/proxyconfigurationmanager.h"
+#include "base/path.h"
+#include "base/preferences.h"
+#include "base/profile.h"
+#include "base/settingsstorage.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct Options
+    {
+        int torrentCount = 20000;
+        int runningCount = 1000;
+        int fileCount = 4;
+        int trackerCount = 2;
+        int peerListRate = 10;
+        std::chrono::seconds duration = 60s;
+    };
+
+    // generated metadata only, content of the torrents never exists
+    QByteArray makeTorrent(const int index, const Options &options)
+    {
+        const lt::entry::integer_type pieceLength = 256 * 1024;
+        const lt::entry::integer_type fileSize = ((index % 64) + 1) * pieceLength;
+
+        lt::entry info;
+        info["name"] = "Synthetic torrent " + std::to_string(index);
+        info["piece length"] = pieceLength;
+        lt::entry::list_type files;
+        for (int i = 0; i < options.fileCount; ++i)
+        {
+            lt::entry file;
+            file["length"] = fileSize;
+            file["path"] = lt::entry::list_type {lt::entry("file" + std::to_string(i) + ".bin")};
+            files.push_back(file);
+        }
+        info["files"] = files;
+        const auto pieceCount = static_cast<std::size_t>((fileSize * options.fileCount) / pieceLength);
+        info["pieces"] = std::string((pieceCount * 20), static_cast<char>(index % 256));
+
+        lt::entry torrent;
+        torrent["info"] = info;
+        lt::entry::list_type announceList;
+        for (int i = 0; i < options.trackerCount; ++i)
+        {
+            // discard port on loopback, every announce fails immediately
+            const std::string url = "udp://127.0.0.1:9/announce?tier=" + std::to_string(i);
+            announceList.push_back(lt::entry::list_type {lt::entry(url)});
+        }
+        if (!announceList.empty())
+            torrent["announce-list"] = announceList;
+
+        QByteArray data;
+        lt::bencode(std::back_inserter(data), torrent);
+        return data;
+    }
+
+    qint64 residentMemory()
+    {
+#ifdef Q_OS_LINUX
+        QFile file {u"/proc/self/statm"_s};
+        if (!file.open(QIODevice::ReadOnly))
+            return -1;
+
+        const QList<QByteArray> values = file.readAll().split(' ');
+        if (values.size() < 2)
+            return -1;
+
+        return values[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+        return -1;
+#endif
+    }
+
+    QJsonObject summarize(QList<qint64> samples)
+    {
+        if (samples.isEmpty())
+            return {{u"count"_s, 0}};
+
+        std::sort(samples.begin(), samples.end());
+        const auto percentile = [&samples](const int p) { return samples[((samples.size() - 1) * p) / 100]; };
+        return {
+            {u"count"_s, samples.size()},
+            {u"p50"_s, percentile(50)},
+            {u"p99"_s, percentile(99)},
+            {u"max"_s, samples.last()}
+        };
+    }
+}
+
+class SessionLoad final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(SessionLoad)
+
+public:
+    explicit SessionLoad(const Options &options)
+        : m_options {options}
+    {
+    }
+
+    void start()
+    {
+        auto *session = BitTorrent::Session::instance();
+        session->setDHTEnabled(false);
+        session->setLSDEnabled(false);
+        session->setPeXEnabled(false);
+        session->setQueueingSystemEnabled(false);
+        session->setSavePath(Path(m_contentDir.path()));
+
+        connect(session, &BitTorrent::Session::torrentsLoaded, this, &SessionLoad::handleTorrentsLoaded);
+        connect(session, &BitTorrent::Session::torrentsUpdated, this, &SessionLoad::handleTorrentsUpdated);
+        connect(session, &BitTorrent::Session::trackerEntryStatusesUpdated, this, [this] { ++m_trackerEvents; });
+
+        m_memoryBefore = residentMemory();
+
+        QList<BitTorrent::TorrentDescriptor> stoppedTorrents;
+        QList<BitTorrent::TorrentDescriptor> runningTorrents;
+        for (int i = 0; i < m_options.torrentCount; ++i)
+        {
+            const auto torrentDescr = BitTorrent::TorrentDescriptor::load(makeTorrent(i, m_options));
+            if (!torrentDescr)
+                qFatal("Couldn't generate torrent: %s", qUtf8Printable(torrentDescr.error()));
+
+            if (i < m_options.runningCount)
+                runningTorrents.append(torrentDescr.value());
+            else
+                stoppedTorrents.append(torrentDescr.value());
+        }
+
+        m_addTimer.start();
+        // running torrents skip checking, so they are seeding and announcing right away
+        session->addTorrents(runningTorrents, {.addStopped = false, .skipChecking = true});
+        session->addTorrents(stoppedTorrents, {.addStopped = true});
+    }
+
+signals:
+    void finished(const QJsonObject &results);
+
+private:
+    void handleTorrentsLoaded(const QVector<BitTorrent::Torrent *> &torrents)
+    {
+        m_loadedCount += torrents.size();
+        if (m_loadedCount < m_options.torrentCount)
+            return;
+
+        m_addTime = m_addTimer.elapsed();
+        m_memoryLoaded = residentMemory();
+        startRunPhase();
+    }
+
+    void startRunPhase()
+    {
+        m_isRunning = true;
+
+        // timer that fires late shows how long the main thread was busy
+        auto *latencyTimer = new QTimer(this);
+        latencyTimer->setTimerType(Qt::PreciseTimer);
+        latencyTimer->setInterval(10ms);
+        m_latencyTimer.start();
+        connect(latencyTimer, &QTimer::timeout, this, [this, latencyTimer]
+        {
+            const qint64 elapsed = m_latencyTimer.restart();
+            m_latencySamples.append(std::max<qint64>(0, (elapsed - latencyTimer->interval())));
+        });
+        latencyTimer->start();
+
+        if (m_options.peerListRate > 0)
+        {
+            auto *peerListTimer = new QTimer(this);
+            peerListTimer->setInterval(std::chrono::milliseconds(1000 / m_options.peerListRate));
+            connect(peerListTimer, &QTimer::timeout, this, &SessionLoad::fetchPeerList);
+            peerListTimer->start();
+        }
+
+        QTimer::singleShot(m_options.duration, this, &SessionLoad::finish);
+    }
+
+    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents)
+    {
+        if (!m_isRunning)
+            return;
+
+        // the same data transfer list model and WebAPI read from each updated torrent
+        QElapsedTimer timer;
+        timer.start();
+        qint64 checksum = 0;
+        for (const BitTorrent::Torrent *torrent : torrents)
+        {
+            checksum += torrent->name().size() + static_cast<int>(torrent->state()) + torrent->eta()
+                + torrent->downloadPayloadRate() + torrent->uploadPayloadRate()
+                + static_cast<qint64>(torrent->progress() * 1000) + static_cast<qint64>(torrent->realRatio() * 1000);
+        }
+        m_updateSamples.append(timer.nsecsElapsed() / 1000);
+        m_updatedTorrentCount += torrents.size();
+        m_checksum += checksum;
+    }
+
+    void fetchPeerList()
+    {
+        const QVector<BitTorrent::Torrent *> torrents = BitTorrent::Session::instance()->torrents();
+        if (torrents.isEmpty())
+            return;
+
+        const BitTorrent::Torrent *torrent = torrents[m_peerListFetches++ % torrents.size()];
+        QElapsedTimer timer;
+        timer.start();
+        torrent->fetchPeerInfo([this, timer](const QVector<BitTorrent::PeerInfo> &)
+        {
+            m_peerListSamples.append(timer.elapsed());
+        });
+    }
+
+    void finish()
+    {
+        m_isRunning = false;
+
+        const QJsonObject results
+        {
+            {u"torrents"_s, m_options.torrentCount},
+            {u"running_torrents"_s, m_options.runningCount},
+            {u"files_per_torrent"_s, m_options.fileCount},
+            {u"trackers_per_torrent"_s, m_options.trackerCount},
+            {u"duration_s"_s, static_cast<qint64>(m_options.duration.count())},
+            {u"add_time_ms"_s, m_addTime},
+            {u"main_thread_latency_ms"_s, summarize(m_latencySamples)},
+            {u"torrents_update_us"_s, summarize(m_updateSamples)},
+            {u"updated_torrents"_s, m_updatedTorrentCount},
+            {u"tracker_events"_s, m_trackerEvents},
+            {u"peer_list_fetch_ms"_s, summarize(m_peerListSamples)},
+            {u"memory_before_bytes"_s, m_memoryBefore},
+            {u"memory_loaded_bytes"_s, m_memoryLoaded},
+            {u"memory_end_bytes"_s, residentMemory()}
+        };
+        emit finished(results);
+    }
+
+    const Options m_options;
+    QTemporaryDir m_contentDir;
+
+    QElapsedTimer m_addTimer;
+    qint64 m_addTime = 0;
+    qsizetype m_loadedCount = 0;
+    bool m_isRunning = false;
+
+    QElapsedTimer m_latencyTimer;
+    QList<qint64> m_latencySamples;
+    QList<qint64> m_updateSamples;
+    qint64 m_updatedTorrentCount = 0;
+    qint64 m_checksum = 0;
+    qint64 m_trackerEvents = 0;
+    int m_peerListFetches = 0;
+    QList<qint64> m_peerListSamples;
+
+    qint64 m_memoryBefore = 0;
+    qint64 m_memoryLoaded = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app {argc, argv};
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Synthetic session load generator"_s);
+    parser.addHelpOption();
+    const QCommandLineOption torrentsOption {u"torrents"_s, u"Number of torrents."_s, u"count"_s, u"20000"_s};
+    const QCommandLineOption runningOption {u"running"_s, u"Number of seeding torrents announcing to trackers."_s, u"count"_s, u"1000"_s};
+    const QCommandLineOption filesOption {u"files"_s, u"Number of files per torrent."_s, u"count"_s, u"4"_s};
+    const QCommandLineOption trackersOption {u"trackers"_s, u"Number of trackers per torrent."_s, u"count"_s, u"2"_s};
+    const QCommandLineOption peerListRateOption {u"peer-list-rate"_s, u"Peer list fetches per second."_s, u"rate"_s, u"10"_s};
+    const QCommandLineOption durationOption {u"duration"_s, u"Duration of the measurement after all torrents are loaded."_s, u"seconds"_s, u"60"_s};
+    parser.addOptions({torrentsOption, runningOption, filesOption, trackersOption, peerListRateOption, durationOption});
+    parser.process(app);
+
+    Options options;
+    options.torrentCount = std::max(1, parser.value(torrentsOption).toInt());
+    options.runningCount = std::clamp(parser.value(runningOption).toInt(), 0, options.torrentCount);
+    options.fileCount = std::max(1, parser.value(filesOption).toInt());
+    options.trackerCount = std::max(0, parser.value(trackersOption).toInt());
+    options.peerListRate = std::clamp(parser.value(peerListRateOption).toInt(), 0, 1000);
+    options.duration = std::chrono::seconds(std::max(1, parser.value(durationOption).toInt()));
+
+    // everything is kept in temporary profile
+    const QTemporaryDir profileDir;
+    Logger::initInstance();
+    Profile::initInstance(Path(profileDir.path()), {}, false);
+    SettingsStorage::initInstance();
+    SettingsStorage::instance()->storeValue(u"Network/PortForwardingEnabled"_s, false);
+    Preferences::initInstance();
+    Net::ProxyConfigurationManager::initInstance();
+    Net::DownloadManager::initInstance();
+    BitTorrent::Session::initInstance();
+
+    int exitCode = 0;
+    {
+        SessionLoad load {options};
+        QObject::connect(&load, &SessionLoad::finished, &app, [](const QJsonObject &results)
+        {
+            std::fputs(QJsonDocument(results).toJson().constData(), stdout);
+            QCoreApplication::quit();
+        });
+
+        auto *session = BitTorrent::Session::instance();
+        if (session->isRestored())
+            load.start();
+        else
+            QObject::connect(session, &BitTorrent::Session::restored, &load, &SessionLoad::start);
+        exitCode = app.exec();
+    }
+
+    BitTorrent::Session::freeInstance();
+    Net::DownloadManager::freeInstance();
+    Net::ProxyConfigurationManager::freeInstance();
+    Preferences::freeInstance();
+    SettingsStorage::freeInstance();
+    Profile::freeInstance();
+    Logger::freeInstance();
+
+    return exitCode;
+}
+
+#include "sessionload.moc"
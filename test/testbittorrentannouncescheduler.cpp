@@ -0,0 +1,98 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <chrono>
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/announcescheduler.h"
+#include "base/global.h"
+
+using namespace std::chrono_literals;
+
+class TestBittorrentAnnounceScheduler final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentAnnounceScheduler)
+
+public:
+    TestBittorrentAnnounceScheduler() = default;
+
+private slots:
+    void testSchedule() const
+    {
+        const auto now = BitTorrent::AnnounceScheduler::Clock::now();
+        BitTorrent::AnnounceScheduler scheduler {4};
+
+        QCOMPARE(scheduler.schedule(u"a.example.org"_s, now), 0ms);
+        QCOMPARE(scheduler.schedule(u"a.example.org"_s, now), 250ms);
+        QCOMPARE(scheduler.schedule(u"a.example.org"_s, now), 500ms);
+        // hosts are scheduled independently
+        QCOMPARE(scheduler.schedule(u"b.example.org"_s, now), 0ms);
+
+        QCOMPARE(scheduler.pendingDelay(u"a.example.org"_s, now), 750ms);
+        QCOMPARE(scheduler.pendingDelay(u"a.example.org"_s, (now + 500ms)), 250ms);
+        QCOMPARE(scheduler.pendingDelay(u"c.example.org"_s, now), 0ms);
+
+        // unused slots are not accumulated
+        QCOMPARE(scheduler.schedule(u"a.example.org"_s, (now + 10s)), 0ms);
+        QCOMPARE(scheduler.schedule(u"a.example.org"_s, (now + 10s)), 250ms);
+    }
+
+    void testSetAnnouncesPerSecond() const
+    {
+        const auto now = BitTorrent::AnnounceScheduler::Clock::now();
+        BitTorrent::AnnounceScheduler scheduler;
+        QCOMPARE(scheduler.announcesPerSecond(), 1);
+
+        scheduler.setAnnouncesPerSecond(0);
+        QCOMPARE(scheduler.announcesPerSecond(), 1);
+
+        scheduler.setAnnouncesPerSecond(10);
+        QCOMPARE(scheduler.schedule(u"a.example.org"_s, now), 0ms);
+        QCOMPARE(scheduler.schedule(u"a.example.org"_s, now), 100ms);
+    }
+
+    void testPurge() const
+    {
+        const auto now = BitTorrent::AnnounceScheduler::Clock::now();
+        BitTorrent::AnnounceScheduler scheduler {1};
+
+        scheduler.schedule(u"a.example.org"_s, now);
+        scheduler.schedule(u"a.example.org"_s, now);
+        scheduler.schedule(u"b.example.org"_s, now);
+
+        scheduler.purge(now + 1s);
+        QCOMPARE(scheduler.pendingDelay(u"a.example.org"_s, (now + 1s)), 1000ms);
+        QCOMPARE(scheduler.pendingDelay(u"b.example.org"_s, (now + 1s)), 0ms);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentAnnounceScheduler)
+#include "testbittorrentannouncescheduler.moc"
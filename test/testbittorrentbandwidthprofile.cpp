@@ -0,0 +1,88 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <chrono>
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/bandwidthprofile.h"
+#include "base/global.h"
+
+using namespace std::chrono_literals;
+
+class TestBittorrentBandwidthProfile final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentBandwidthProfile)
+
+public:
+    TestBittorrentBandwidthProfile() = default;
+
+private slots:
+    void testParse() const
+    {
+        const QList<BandwidthProfile::Entry> entries = BandwidthProfile::parseEntries(u"22:00=100, 07:00=30,bad,18:00=0,18:00=10"_s);
+        QCOMPARE(entries.size(), 3);
+        QCOMPARE(entries[1].start, QTime(7, 0));
+        QCOMPARE(entries[1].percent, 30);
+        QCOMPARE(BandwidthProfile::entriesToString(entries), u"22:00=100, 07:00=30, 18:00=10"_s);
+    }
+
+    void testEmpty() const
+    {
+        const BandwidthProfile profile;
+        QVERIFY(profile.isEmpty());
+        QCOMPARE(profile.percentAt(QTime(12, 0)), 100);
+    }
+
+    void testPercentAt() const
+    {
+        const BandwidthProfile profile {BandwidthProfile::parseEntries(u"22:00=100,07:00=30,18:00=10"_s), 0s};
+        QCOMPARE(profile.percentAt(QTime(7, 0)), 30);
+        QCOMPARE(profile.percentAt(QTime(17, 59)), 30);
+        QCOMPARE(profile.percentAt(QTime(18, 0)), 10);
+        QCOMPARE(profile.percentAt(QTime(23, 0)), 100);
+        // the last profile of the day continues until the first one
+        QCOMPARE(profile.percentAt(QTime(3, 0)), 100);
+    }
+
+    void testTransition() const
+    {
+        const BandwidthProfile profile {BandwidthProfile::parseEntries(u"22:00=100,07:00=30,18:00=10"_s), 10min};
+        QCOMPARE(profile.percentAt(QTime(7, 0)), 100);
+        QCOMPARE(profile.percentAt(QTime(7, 5)), 65);
+        QCOMPARE(profile.percentAt(QTime(7, 10)), 30);
+        QCOMPARE(profile.percentAt(QTime(22, 5)), 55);
+        QCOMPARE(profile.percentAt(QTime(0, 0)), 100);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentBandwidthProfile)
+#include "testbittorrentbandwidthprofile.moc"
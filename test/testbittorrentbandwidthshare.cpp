@@ -0,0 +1,71 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/bandwidthshare.h"
+#include "base/global.h"
+
+class TestBittorrentBandwidthShare final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentBandwidthShare)
+
+public:
+    TestBittorrentBandwidthShare() = default;
+
+private slots:
+    void testEmpty() const
+    {
+        QVERIFY(BitTorrent::shareBandwidth(1000, {}).isEmpty());
+    }
+
+    void testFairShare() const
+    {
+        // the consumer needing less gets what it needs, the others split the rest
+        QCOMPARE(BitTorrent::shareBandwidth(1000, {100, 800, 800}), QList<int>({100, 450, 450}));
+        QCOMPARE(BitTorrent::shareBandwidth(900, {800, 800, 800}), QList<int>({300, 300, 300}));
+    }
+
+    void testUnusedBandwidth() const
+    {
+        QCOMPARE(BitTorrent::shareBandwidth(1000, {100, 100}), QList<int>({500, 500}));
+        QCOMPARE(BitTorrent::shareBandwidth(1000, {0, 600}), QList<int>({200, 800}));
+    }
+
+    void testNonZeroShare() const
+    {
+        QCOMPARE(BitTorrent::shareBandwidth(2, {100, 100, 100}), QList<int>({1, 1, 1}));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentBandwidthShare)
+#include "testbittorrentbandwidthshare.moc"
@@ -0,0 +1,161 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QByteArray>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/blockreadcache.h"
+#include "base/global.h"
+
+using BitTorrent::BlockReadCache;
+
+namespace
+{
+    const int BLOCK_LENGTH = 1024;
+
+    BlockReadCache::BlockKey blockKey(const int storage, const int piece, const int offset = 0)
+    {
+        return {.storage = storage, .piece = piece, .offset = offset, .length = BLOCK_LENGTH};
+    }
+
+    QByteArray blockData(const char fill)
+    {
+        return QByteArray(BLOCK_LENGTH, fill);
+    }
+
+    // simulates two peers requesting the block before it gets cached
+    void requestTwiceAndInsert(BlockReadCache &cache, const BlockReadCache::BlockKey &key, const char fill)
+    {
+        cache.find(key);
+        cache.find(key);
+        QVERIFY(cache.insert(key, blockData(fill), cache.generation(key.storage)));
+    }
+}
+
+class TestBittorrentBlockReadCache final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentBlockReadCache)
+
+public:
+    TestBittorrentBlockReadCache() = default;
+
+private slots:
+    void testDisabled() const
+    {
+        BlockReadCache cache;
+        const auto key = blockKey(0, 0);
+
+        QVERIFY(cache.find(key).isNull());
+        QVERIFY(cache.find(key).isNull());
+        QVERIFY(!cache.isAdmitted(key));
+        QVERIFY(!cache.insert(key, blockData('a'), cache.generation(0)));
+        QCOMPARE(cache.size(), 0);
+    }
+
+    void testAdmission() const
+    {
+        BlockReadCache cache {4 * BLOCK_LENGTH};
+        const auto key = blockKey(0, 0);
+
+        // block requested just once isn't worth caching
+        QVERIFY(cache.find(key).isNull());
+        QVERIFY(!cache.isAdmitted(key));
+        QVERIFY(!cache.insert(key, blockData('a'), cache.generation(0)));
+
+        QVERIFY(cache.find(key).isNull());
+        QVERIFY(cache.isAdmitted(key));
+        QVERIFY(cache.insert(key, blockData('a'), cache.generation(0)));
+
+        QCOMPARE(cache.find(key), blockData('a'));
+        QCOMPARE(cache.count(), 1);
+        QCOMPARE(cache.size(), BLOCK_LENGTH);
+        QCOMPARE(cache.hits(), 1);
+        QCOMPARE(cache.misses(), 2);
+    }
+
+    void testFrequentBlocksSurvive() const
+    {
+        BlockReadCache cache {3 * BLOCK_LENGTH};
+        const auto hot = blockKey(0, 0);
+        requestTwiceAndInsert(cache, hot, 'h');
+        QVERIFY(!cache.find(hot).isNull());
+
+        for (int piece = 1; piece <= 3; ++piece)
+            requestTwiceAndInsert(cache, blockKey(0, piece), 'c');
+
+        // blocks that weren't requested again are evicted first
+        QCOMPARE(cache.count(), 3);
+        QVERIFY(cache.size() <= cache.capacity());
+        QCOMPARE(cache.find(hot), blockData('h'));
+        QVERIFY(cache.find(blockKey(0, 1)).isNull());
+        QVERIFY(!cache.find(blockKey(0, 3)).isNull());
+    }
+
+    void testRemove() const
+    {
+        BlockReadCache cache {8 * BLOCK_LENGTH};
+        requestTwiceAndInsert(cache, blockKey(0, 0, 0), 'a');
+        requestTwiceAndInsert(cache, blockKey(0, 0, BLOCK_LENGTH), 'b');
+        requestTwiceAndInsert(cache, blockKey(0, 1), 'c');
+        requestTwiceAndInsert(cache, blockKey(1, 0), 'd');
+
+        cache.removePiece(0, 0);
+        QCOMPARE(cache.count(), 2);
+        QVERIFY(cache.find(blockKey(0, 0)).isNull());
+
+        const quint64 generation = cache.generation(1);
+        cache.find(blockKey(1, 1));
+        cache.find(blockKey(1, 1));
+        cache.removeStorage(1);
+        QCOMPARE(cache.count(), 1);
+        QCOMPARE(cache.size(), BLOCK_LENGTH);
+        // block read before the storage was removed is rejected
+        QVERIFY(!cache.insert(blockKey(1, 1), blockData('e'), generation));
+    }
+
+    void testShrink() const
+    {
+        BlockReadCache cache {4 * BLOCK_LENGTH};
+        for (int piece = 0; piece < 4; ++piece)
+            requestTwiceAndInsert(cache, blockKey(0, piece), 'a');
+
+        cache.setCapacity(2 * BLOCK_LENGTH);
+        QCOMPARE(cache.count(), 2);
+        QCOMPARE(cache.size(), (2 * BLOCK_LENGTH));
+
+        cache.setCapacity(0);
+        QCOMPARE(cache.count(), 0);
+        QCOMPARE(cache.size(), 0);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentBlockReadCache)
+#include "testbittorrentblockreadcache.moc"
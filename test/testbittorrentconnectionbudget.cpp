@@ -0,0 +1,86 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/connectionbudget.h"
+#include "base/global.h"
+
+class TestBittorrentConnectionBudget final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentConnectionBudget)
+
+public:
+    TestBittorrentConnectionBudget() = default;
+
+private slots:
+    void testDemand() const
+    {
+        QCOMPARE(BitTorrent::connectionDemand({}), 4);
+        QCOMPARE(BitTorrent::connectionDemand({.interestedPeers = 10}), 15);
+        QCOMPARE(BitTorrent::connectionDemand({.uploadRate = (800 * 1024)}), 100);
+    }
+
+    void testSaturatedDemand() const
+    {
+        // torrent using up its budget asks for more
+        QCOMPARE(BitTorrent::connectionDemand({.connections = 19, .budget = 20}), 29);
+        QCOMPARE(BitTorrent::connectionDemand({.connections = 10, .budget = 20}), 4);
+    }
+
+    void testSwarmLimitedDemand() const
+    {
+        QCOMPARE(BitTorrent::connectionDemand({.interestedPeers = 20, .swarmPeers = 6}), 6);
+        QCOMPARE(BitTorrent::connectionDemand({.interestedPeers = 20, .swarmPeers = 0}), 4);
+    }
+
+    void testRebalance() const
+    {
+        QVERIFY(BitTorrent::rebalanceConnections(100, {}).isEmpty());
+        QCOMPARE(BitTorrent::rebalanceConnections(100, {{}, {.interestedPeers = 40}, {.interestedPeers = 40}})
+                , QList<int>({4, 48, 48}));
+    }
+
+    void testHysteresis() const
+    {
+        // small changes of current budget are ignored
+        QCOMPARE(BitTorrent::rebalanceConnections(100, {{}, {.budget = 46, .interestedPeers = 40}, {.budget = 20, .interestedPeers = 40}})
+                , QList<int>({4, 46, 48}));
+    }
+
+    void testMinBudget() const
+    {
+        QCOMPARE(BitTorrent::rebalanceConnections(2, {{}, {}, {}}), QList<int>({2, 2, 2}));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentConnectionBudget)
+#include "testbittorrentconnectionbudget.moc"
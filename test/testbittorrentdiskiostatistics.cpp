@@ -0,0 +1,128 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <chrono>
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/diskiostatistics.h"
+#include "base/bittorrent/infohash.h"
+#include "base/global.h"
+
+using namespace std::chrono_literals;
+
+using BitTorrent::DiskJobType;
+
+class TestBittorrentDiskIOStatistics final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentDiskIOStatistics)
+
+public:
+    TestBittorrentDiskIOStatistics() = default;
+
+private slots:
+    void testLatencyBuckets() const
+    {
+        BitTorrent::DiskJobLatency latency;
+        QCOMPARE(latency.quantile(0.5), 0);
+
+        latency.add(10'000);  // 10 us
+        latency.add(50'000);  // 50 us, upper bounds are inclusive
+        latency.add(70'000);
+        latency.add(5'000'000'000);  // 5 s, unbounded bucket
+
+        QCOMPARE(latency.count, 4);
+        QCOMPARE(latency.totalTime, 5'000'130'000);
+        QCOMPARE(latency.maxTime, 5'000'000'000);
+        QCOMPARE(latency.buckets[0], 2);
+        QCOMPARE(latency.buckets[1], 1);
+        QCOMPARE(latency.buckets.back(), 1);
+
+        QCOMPARE(latency.quantile(0.5), 50'000);
+        QCOMPARE(latency.quantile(0.75), 100'000);
+        QCOMPARE(latency.quantile(1.0), 5'000'000'000);
+    }
+
+    void testQuantileLimitedByMax() const
+    {
+        BitTorrent::DiskJobLatency latency;
+        latency.add(700'000);  // falls into bucket up to 1 ms
+
+        QCOMPARE(latency.quantile(0.5), 700'000);
+    }
+
+    void testQueueDepth() const
+    {
+        BitTorrent::DiskIOStatisticsCollector collector;
+        const auto start = BitTorrent::DiskIOStatisticsCollector::Clock::now();
+
+        collector.jobStarted();
+        collector.jobStarted();
+        QCOMPARE(collector.statistics().queueDepth, 2);
+
+        collector.jobFinished(DiskJobType::Read, start, (start + 1ms));
+        collector.jobStarted();
+        collector.jobFinished(DiskJobType::Write, start, (start + 2ms));
+        collector.jobFinished(DiskJobType::Write, start, (start + 3ms));
+
+        const BitTorrent::DiskIOStatistics stats = collector.statistics();
+        QCOMPARE(stats.queueDepth, 0);
+        QCOMPARE(stats.maxQueueDepth, 2);
+        QCOMPARE(stats.latency[static_cast<int>(DiskJobType::Read)].count, 1);
+        QCOMPARE(stats.latency[static_cast<int>(DiskJobType::Write)].count, 2);
+        QCOMPARE(stats.latency[static_cast<int>(DiskJobType::Write)].maxTime, 3'000'000);
+        QCOMPARE(stats.latency[static_cast<int>(DiskJobType::Hash)].count, 0);
+    }
+
+    void testStorageBytes() const
+    {
+        const auto id = BitTorrent::TorrentID::fromString(u"0123456789abcdef0123456789abcdef01234567"_s);
+
+        BitTorrent::DiskIOStatisticsCollector collector;
+        collector.addStorage(0, id);
+        collector.addBytesRead(0, 16384);
+        collector.addBytesWritten(0, 100);
+        collector.addBytesWritten(0, 200);
+        // unknown storage is ignored
+        collector.addBytesRead(1, 1);
+
+        BitTorrent::DiskIOStatistics stats = collector.statistics();
+        QCOMPARE(stats.torrents.size(), 1);
+        QCOMPARE(stats.torrents[id].bytesRead, 16384);
+        QCOMPARE(stats.torrents[id].bytesWritten, 300);
+
+        collector.removeStorage(0);
+        QVERIFY(collector.statistics().torrents.isEmpty());
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentDiskIOStatistics)
+#include "testbittorrentdiskiostatistics.moc"
@@ -0,0 +1,129 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/diskjobscheduler.h"
+#include "base/global.h"
+
+using JobClass = BitTorrent::DiskJobScheduler::JobClass;
+
+class TestBittorrentDiskJobScheduler final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentDiskJobScheduler)
+
+public:
+    TestBittorrentDiskJobScheduler() = default;
+
+private slots:
+    void testUnlimited() const
+    {
+        BitTorrent::DiskJobScheduler scheduler;
+        QList<int> started;
+
+        for (int i = 0; i < 10; ++i)
+            scheduler.submit(u"sda"_s, 0, JobClass::Read, [&started, i] { started.append(i); });
+
+        QCOMPARE(started.size(), 10);
+        QCOMPARE(scheduler.activeJobs(u"sda"_s), 10);
+        QCOMPARE(scheduler.waitingJobs(u"sda"_s), 0);
+    }
+
+    void testLimitPerDevice() const
+    {
+        BitTorrent::DiskJobScheduler scheduler;
+        scheduler.setMaxActiveJobs(2);
+        QList<QString> started;
+
+        scheduler.submit(u"hdd"_s, 0, JobClass::Read, [&started] { started.append(u"hdd1"_s); });
+        scheduler.submit(u"hdd"_s, 0, JobClass::Read, [&started] { started.append(u"hdd2"_s); });
+        scheduler.submit(u"hdd"_s, 0, JobClass::Read, [&started] { started.append(u"hdd3"_s); });
+        // busy device doesn't hold back the others
+        scheduler.submit(u"ssd"_s, 1, JobClass::Read, [&started] { started.append(u"ssd1"_s); });
+
+        QCOMPARE(started, QList<QString>({u"hdd1"_s, u"hdd2"_s, u"ssd1"_s}));
+        QCOMPARE(scheduler.waitingJobs(u"hdd"_s), 1);
+
+        QVERIFY(scheduler.jobFinished(u"hdd"_s));
+        QCOMPARE(started.last(), u"hdd3"_s);
+        QCOMPARE(scheduler.activeJobs(u"hdd"_s), 2);
+
+        QVERIFY(!scheduler.jobFinished(u"hdd"_s));
+        QCOMPARE(scheduler.activeJobs(u"hdd"_s), 1);
+    }
+
+    void testReadsPreferred() const
+    {
+        BitTorrent::DiskJobScheduler scheduler;
+        scheduler.setMaxActiveJobs(1);
+        scheduler.setReadsPerHashJob(2);
+        QList<QString> started;
+
+        scheduler.submit(u"hdd"_s, 0, JobClass::Hash, [&started] { started.append(u"h1"_s); });
+        scheduler.submit(u"hdd"_s, 0, JobClass::Hash, [&started] { started.append(u"h2"_s); });
+        scheduler.submit(u"hdd"_s, 0, JobClass::Hash, [&started] { started.append(u"h3"_s); });
+        for (int i = 1; i <= 4; ++i)
+            scheduler.submit(u"hdd"_s, 1, JobClass::Read, [&started, i] { started.append(u"r"_s + QString::number(i)); });
+
+        while (scheduler.jobFinished(u"hdd"_s))
+        {
+        }
+
+        // waiting hash job isn't starved by reads either
+        QCOMPARE(started, QList<QString>({u"h1"_s, u"r1"_s, u"r2"_s, u"h2"_s, u"r3"_s, u"r4"_s, u"h3"_s}));
+    }
+
+    void testFlushStorage() const
+    {
+        BitTorrent::DiskJobScheduler scheduler;
+        scheduler.setMaxActiveJobs(1);
+        QList<QString> started;
+
+        scheduler.submit(u"hdd"_s, 0, JobClass::Read, [&started] { started.append(u"a1"_s); });
+        scheduler.submit(u"hdd"_s, 1, JobClass::Read, [&started] { started.append(u"b1"_s); });
+        scheduler.submit(u"hdd"_s, 0, JobClass::Hash, [&started] { started.append(u"a2"_s); });
+        scheduler.submit(u"hdd"_s, 1, JobClass::Hash, [&started] { started.append(u"b2"_s); });
+
+        QVERIFY(scheduler.flushStorage(1));
+        QCOMPARE(started, QList<QString>({u"a1"_s, u"b1"_s, u"b2"_s}));
+        QCOMPARE(scheduler.waitingJobs(u"hdd"_s), 1);
+        QVERIFY(!scheduler.flushStorage(1));
+
+        QVERIFY(scheduler.flushAll());
+        QCOMPARE(started.last(), u"a2"_s);
+        QCOMPARE(scheduler.waitingJobs(u"hdd"_s), 0);
+        QCOMPARE(scheduler.activeJobs(u"hdd"_s), 4);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentDiskJobScheduler)
+#include "testbittorrentdiskjobscheduler.moc"
@@ -0,0 +1,124 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTest>
+
+#include "base/bittorrent/fakeprogressdetector.h"
+#include "base/bittorrent/infohash.h"
+#include "base/global.h"
+
+using BitTorrent::FakeProgressDetector;
+
+namespace
+{
+    const qint64 MiB = 1024 * 1024;
+    const qint64 TORRENT_SIZE = 1024 * MiB;
+    const qint64 PIECE_LENGTH = MiB;
+
+    const BitTorrent::TorrentID torrentID = BitTorrent::TorrentID::fromString(u"0123456789abcdef0123456789abcdef01234567"_s);
+}
+
+class TestBittorrentFakeProgressDetector final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentFakeProgressDetector)
+
+public:
+    TestBittorrentFakeProgressDetector() = default;
+
+private slots:
+    void testHonestPeer() const
+    {
+        FakeProgressDetector detector {{.minUploaded = (16 * MiB), .minProgressRatio = 0.5}};
+
+        qreal progress = 0.1;
+        qint64 uploaded = 0;
+        for (int i = 0; i < 100; ++i)
+        {
+            QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, progress, uploaded}}).isEmpty());
+            // the peer downloads from others too
+            uploaded += 4 * MiB;
+            progress += (8.0 * MiB) / TORRENT_SIZE;
+        }
+    }
+
+    void testStuckPeer() const
+    {
+        FakeProgressDetector detector {{.minUploaded = (16 * MiB), .minProgressRatio = 0.5}};
+
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0.1, 0}}).isEmpty());
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0.1, (8 * MiB)}}).isEmpty());
+        QCOMPARE(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0.1, (16 * MiB)}})
+                , QStringList {u"192.0.2.1"_s});
+
+        // detected peer is forgotten
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0.1, (32 * MiB)}}).isEmpty());
+    }
+
+    void testReconnectingPeer() const
+    {
+        FakeProgressDetector detector {{.minUploaded = (16 * MiB), .minProgressRatio = 0.5}};
+
+        // upload counter restarts with every new connection, but the data is still accounted
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0.2, 0}}).isEmpty());
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0, (10 * MiB)}}).isEmpty());
+        QCOMPARE(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0, (8 * MiB)}})
+                , QStringList {u"192.0.2.1"_s});
+    }
+
+    void testLargePieces() const
+    {
+        FakeProgressDetector detector {{.minUploaded = (16 * MiB), .minProgressRatio = 0.5}};
+
+        // incomplete pieces aren't reported, so the peer isn't judged too early
+        const qint64 pieceLength = 16 * MiB;
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, pieceLength, {{u"192.0.2.1"_s, 0, 0}}).isEmpty());
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, pieceLength, {{u"192.0.2.1"_s, 0, (32 * MiB)}}).isEmpty());
+        QCOMPARE(detector.analyze(torrentID, TORRENT_SIZE, pieceLength, {{u"192.0.2.1"_s, 0, (64 * MiB)}})
+                , QStringList {u"192.0.2.1"_s});
+    }
+
+    void testSeedsAndRemovedTorrents() const
+    {
+        FakeProgressDetector detector {{.minUploaded = MiB, .minProgressRatio = 0.5}};
+
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0.5, 0}}).isEmpty());
+        detector.removeTorrent(torrentID);
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.1"_s, 0.5, (64 * MiB)}}).isEmpty());
+
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.2"_s, 1, 0}}).isEmpty());
+        QVERIFY(detector.analyze(torrentID, TORRENT_SIZE, PIECE_LENGTH, {{u"192.0.2.2"_s, 1, (64 * MiB)}}).isEmpty());
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentFakeProgressDetector)
+#include "testbittorrentfakeprogressdetector.moc"
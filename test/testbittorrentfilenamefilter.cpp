@@ -0,0 +1,86 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/filenamefilter.h"
+#include "base/global.h"
+#include "base/path.h"
+
+using BitTorrent::FileNameFilter;
+
+class TestBittorrentFileNameFilter final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentFileNameFilter)
+
+public:
+    TestBittorrentFileNameFilter() = default;
+
+private slots:
+    void testEmpty() const
+    {
+        const FileNameFilter filter {{u""_s}};
+        QVERIFY(filter.isEmpty());
+
+        FileNameFilter::FolderVerdicts folderVerdicts;
+        QVERIFY(!filter.isExcluded(Path(u"folder/file.txt"_s), folderVerdicts));
+    }
+
+    void testFileName() const
+    {
+        const FileNameFilter filter {{u"*.txt"_s, u"sample.*"_s}};
+        QVERIFY(!filter.isEmpty());
+
+        FileNameFilter::FolderVerdicts folderVerdicts;
+        QVERIFY(filter.isExcluded(Path(u"readme.TXT"_s), folderVerdicts));
+        QVERIFY(filter.isExcluded(Path(u"folder/Sample.mkv"_s), folderVerdicts));
+        QVERIFY(!filter.isExcluded(Path(u"folder/movie.mkv"_s), folderVerdicts));
+        QVERIFY(!filter.isExcluded(Path(u"folder.txt.d/movie.mkv"_s), folderVerdicts));
+    }
+
+    void testFolderName() const
+    {
+        const FileNameFilter filter {{u"extras"_s}};
+
+        FileNameFilter::FolderVerdicts folderVerdicts;
+        QVERIFY(filter.isExcluded(Path(u"movie/extras/a.mkv"_s), folderVerdicts));
+        QVERIFY(filter.isExcluded(Path(u"movie/extras/deep/b.mkv"_s), folderVerdicts));
+        QVERIFY(!filter.isExcluded(Path(u"movie/main.mkv"_s), folderVerdicts));
+        QVERIFY(!filter.isExcluded(Path(u"movie/extras2/c.mkv"_s), folderVerdicts));
+
+        QCOMPARE(folderVerdicts.value(u"movie"_s, true), false);
+        QCOMPARE(folderVerdicts.value(u"movie/extras"_s, false), true);
+        QCOMPARE(folderVerdicts.value(u"movie/extras/deep"_s, false), true);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentFileNameFilter)
+#include "testbittorrentfilenamefilter.moc"
@@ -0,0 +1,169 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <libtorrent/address.hpp>
+#include <libtorrent/peer_id.hpp>
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/peerreputationtable.h"
+#include "base/global.h"
+
+using namespace std::chrono_literals;
+using BitTorrent::PeerReputationTable;
+
+namespace
+{
+    lt::peer_id peerID(const char *prefix)
+    {
+        lt::peer_id pid;
+        std::copy_n(prefix, PeerReputationTable::PEER_ID_PREFIX_SIZE, pid.begin());
+        return pid;
+    }
+
+    const PeerReputationTable::Clock::time_point startTime {std::chrono::hours(500000)};
+}
+
+class TestBittorrentPeerReputationTable final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentPeerReputationTable)
+
+public:
+    TestBittorrentPeerReputationTable() = default;
+
+private slots:
+    void testViolation() const
+    {
+        PeerReputationTable table;
+        const lt::address address = lt::make_address("192.0.2.1");
+        const lt::peer_id pid = peerID("-XL0012-");
+
+        QVERIFY(!table.isBanned(address, pid, startTime));
+
+        table.addViolation(address, pid, startTime);
+        QVERIFY(table.isBanned(address, pid, startTime));
+        QVERIFY(table.isBanned(lt::make_address("::ffff:192.0.2.1"), pid, startTime));
+        QVERIFY(!table.isBanned(address, peerID("-qB5000-"), startTime));
+        QVERIFY(!table.isBanned(lt::make_address("192.0.2.2"), pid, startTime));
+
+        table.clear();
+        QVERIFY(!table.isBanned(address, pid, startTime));
+    }
+
+    void testDecay() const
+    {
+        PeerReputationTable table;
+        const lt::address address = lt::make_address("2001:db8::1");
+        const lt::peer_id pid = peerID("-XL0012-");
+
+        table.addViolation(address, pid, startTime);
+        QCOMPARE(table.score(address, pid, startTime), 1.0);
+        QCOMPARE(table.score(address, pid, (startTime + PeerReputationTable::HALF_LIFE)), 0.5);
+        QVERIFY(!table.isBanned(address, pid, (startTime + (2 * PeerReputationTable::HALF_LIFE))));
+
+        // repeated violations keep the peer banned for longer
+        table.addViolation(address, pid, startTime);
+        table.addViolation(address, pid, startTime);
+        table.addViolation(address, pid, startTime);
+        QCOMPARE(table.score(address, pid, startTime), 4.0);
+        QVERIFY(table.isBanned(address, pid, (startTime + (2 * PeerReputationTable::HALF_LIFE))));
+    }
+
+    void testBannedAddresses() const
+    {
+        PeerReputationTable table;
+        const lt::address address4 = lt::make_address("192.0.2.1");
+        const lt::address address6 = lt::make_address("2001:db8::1");
+
+        table.addViolation(address6, peerID("-XL0012-"), startTime);
+        table.addViolation(address4, peerID("-XL0012-"), startTime);
+        table.addViolation(address4, peerID("-qB5000-"), startTime);
+        table.addViolation(lt::make_address("192.0.2.2"), peerID("-XL0012-"), (startTime - (2 * PeerReputationTable::HALF_LIFE)));
+
+        const std::vector<lt::address> expected {address4, address6};
+        QVERIFY(table.bannedAddresses(startTime) == expected);
+        QVERIFY(table.bannedAddresses(startTime + (2 * PeerReputationTable::HALF_LIFE)).empty());
+    }
+
+    void testEntries() const
+    {
+        PeerReputationTable table;
+        const lt::address address4 = lt::make_address("192.0.2.1");
+        const lt::address address6 = lt::make_address("2001:db8::1");
+        const lt::peer_id pid = peerID("-XL0012-");
+
+        table.addViolation(address4, pid, startTime);
+        table.addViolation(address6, pid, startTime);
+        table.addViolation(address6, pid, startTime);
+
+        const QList<PeerReputationTable::Entry> entries = table.entries(startTime + PeerReputationTable::HALF_LIFE);
+        QCOMPARE(entries.size(), 2);
+        for (const PeerReputationTable::Entry &entry : entries)
+        {
+            QVERIFY((entry.address == address4) || (entry.address == address6));
+            QCOMPARE(entry.peerIDPrefix, QByteArray("-XL0012-"));
+        }
+
+        PeerReputationTable loadedTable;
+        loadedTable.load(entries);
+        QCOMPARE(loadedTable.score(address4, pid, (startTime + PeerReputationTable::HALF_LIFE)), 0.5);
+        QCOMPARE(loadedTable.score(address6, pid, (startTime + PeerReputationTable::HALF_LIFE)), 1.0);
+
+        // forgotten entries aren't returned
+        QVERIFY(table.entries(startTime + (20 * PeerReputationTable::HALF_LIFE)).isEmpty());
+    }
+
+    void testEviction() const
+    {
+        PeerReputationTable table {4};
+        const lt::peer_id pid = peerID("-XL0012-");
+        const lt::address oldAddress = lt::make_address("192.0.2.1");
+
+        table.addViolation(oldAddress, pid, startTime);
+        for (int i = 2; i < 100; ++i)
+        {
+            const lt::address address = lt::make_address_v4(lt::address_v4::bytes_type {192, 0, 2, static_cast<unsigned char>(i)});
+            table.addViolation(address, pid, (startTime + 1h));
+            QVERIFY(table.isBanned(address, pid, (startTime + 1h)));
+        }
+
+        QVERIFY(table.entries(startTime + 1h).size() <= 4);
+        QVERIFY(!table.isBanned(oldAddress, pid, (startTime + 1h)));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentPeerReputationTable)
+#include "testbittorrentpeerreputationtable.moc"
@@ -0,0 +1,118 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/speedhistory.h"
+#include "base/global.h"
+
+namespace
+{
+    // aligned to the buckets of all the periods
+    const qint64 START = 1'800'000'000;
+}
+
+class TestBittorrentSpeedHistory final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentSpeedHistory)
+
+public:
+    TestBittorrentSpeedHistory() = default;
+
+private slots:
+    void testEmpty() const
+    {
+        const SpeedHistory history;
+        const QList<SpeedSample> samples = history.samples(SpeedHistory::Period::Hour, START);
+
+        QCOMPARE(samples.size(), SpeedHistory::samplesCount(SpeedHistory::Period::Hour));
+        for (const SpeedSample &sample : samples)
+        {
+            QCOMPARE(sample.download, 0);
+            QCOMPARE(sample.upload, 0);
+        }
+    }
+
+    void testAverage() const
+    {
+        SpeedHistory history;
+        history.addSample({1000, 100}, START);
+        history.addSample({3000, 300}, (START + 2500));
+
+        const QList<SpeedSample> samples = history.samples(SpeedHistory::Period::Minute, (START + 5000));
+        QCOMPARE(samples.last().download, 2000);
+        QCOMPARE(samples.last().upload, 200);
+        QCOMPARE(samples.first().download, 0);
+    }
+
+    void testRateIsKept() const
+    {
+        SpeedHistory history;
+        history.addSample({1000, 100}, START);
+        history.addSample({3000, 300}, (START + 5000));
+        history.addSample({0, 0}, (START + 12000));
+
+        const QList<SpeedSample> samples = history.samples(SpeedHistory::Period::Minute, (START + 20000));
+        const int count = samples.size();
+        QCOMPARE(samples[count - 4].download, 1000);
+        QCOMPARE(samples[count - 3].download, 3000);
+        QCOMPARE(samples[count - 2].download, 1200);
+        QCOMPARE(samples[count - 1].download, 0);
+    }
+
+    void testResolutions() const
+    {
+        SpeedHistory history;
+        history.addSample({600, 60}, START);
+        history.addSample({0, 0}, (START + 30'000));
+
+        const qint64 end = START + SpeedHistory::resolution(SpeedHistory::Period::Day);
+        QCOMPARE(history.samples(SpeedHistory::Period::Hour, end)[59 - 14].download, 300);
+        QCOMPARE(history.samples(SpeedHistory::Period::Day, end).last().download, 20);
+    }
+
+    void testLongGap() const
+    {
+        SpeedHistory history;
+        history.addSample({1000, 100}, START);
+        history.addSample({500, 50}, (START + 5000));
+        history.addSample({0, 0}, (START + 3'600'000));
+
+        const QList<SpeedSample> samples = history.samples(SpeedHistory::Period::Minute, (START + 3'600'000));
+        QCOMPARE(samples.size(), SpeedHistory::samplesCount(SpeedHistory::Period::Minute));
+        for (const SpeedSample &sample : samples)
+            QCOMPARE(sample.download, 500);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentSpeedHistory)
+#include "testbittorrentspeedhistory.moc"
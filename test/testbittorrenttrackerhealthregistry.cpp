@@ -0,0 +1,128 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <chrono>
+
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTest>
+
+#include "base/bittorrent/trackerentry.h"
+#include "base/bittorrent/trackerhealthregistry.h"
+#include "base/global.h"
+
+using namespace std::chrono_literals;
+
+class TestBittorrentTrackerHealthRegistry final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentTrackerHealthRegistry)
+
+public:
+    TestBittorrentTrackerHealthRegistry() = default;
+
+private slots:
+    void testTrackerHost() const
+    {
+        QCOMPARE(BitTorrent::TrackerHealthRegistry::trackerHost(u"udp://tracker.example.org:1337/announce"_s), u"tracker.example.org"_s);
+        QCOMPARE(BitTorrent::TrackerHealthRegistry::trackerHost(u"https://Tracker.Example.org/announce"_s), u"tracker.example.org"_s);
+        QCOMPARE(BitTorrent::TrackerHealthRegistry::trackerHost(u"http://[::1]:8080/announce"_s), u"::1"_s);
+    }
+
+    void testScore() const
+    {
+        BitTorrent::TrackerHealthRegistry registry;
+
+        const qreal unknownScore = registry.score(u"unknown"_s);
+        QVERIFY(unknownScore > 0);
+
+        registry.addSuccess(u"fast"_s, 100ms);
+        registry.addSuccess(u"slow"_s, 5000ms);
+        registry.addFailure(u"broken"_s);
+
+        QVERIFY(registry.score(u"fast"_s) > unknownScore);
+        QVERIFY(registry.score(u"fast"_s) > registry.score(u"slow"_s));
+        QVERIFY(registry.score(u"broken"_s) < unknownScore);
+        QVERIFY(!registry.isFailing(u"broken"_s));
+    }
+
+    void testFailing() const
+    {
+        BitTorrent::TrackerHealthRegistry registry;
+
+        for (int i = 0; i < 100; ++i)
+            registry.addFailure(u"dead"_s);
+        QVERIFY(registry.isFailing(u"dead"_s));
+
+        registry.addSuccess(u"dead"_s, 500ms);
+        QVERIFY(!registry.isFailing(u"dead"_s));
+    }
+
+    void testRankTrackers() const
+    {
+        using Entries = QList<BitTorrent::TrackerEntry>;
+
+        const auto urls = [](const Entries &entries)
+        {
+            QStringList result;
+            for (const BitTorrent::TrackerEntry &entry : entries)
+                result.append(entry.url);
+            return result;
+        };
+
+        const Entries trackers {
+            {u"udp://a.example.org:6969/announce"_s},
+            {u"udp://b.example.org:6969/announce"_s},
+            {u"udp://c.example.org:6969/announce"_s},
+            {u"udp://d.example.org:6969/announce"_s}
+        };
+
+        BitTorrent::TrackerHealthRegistry registry;
+
+        // trackers without results keep their order
+        QCOMPARE(urls(registry.rankTrackers(trackers, 10)), urls(trackers));
+        QCOMPARE(registry.rankTrackers(trackers, 2).size(), 2);
+        QVERIFY(registry.rankTrackers(trackers, 0).isEmpty());
+
+        registry.addSuccess(u"c.example.org"_s, 50ms);
+        for (int i = 0; i < 100; ++i)
+            registry.addFailure(u"a.example.org"_s);
+
+        const QStringList expected {
+            u"udp://c.example.org:6969/announce"_s,
+            u"udp://b.example.org:6969/announce"_s,
+            u"udp://d.example.org:6969/announce"_s
+        };
+        QCOMPARE(urls(registry.rankTrackers(trackers, 10)), expected);
+        QCOMPARE(urls(registry.rankTrackers(trackers, 1)), expected.mid(0, 1));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentTrackerHealthRegistry)
+#include "testbittorrenttrackerhealthregistry.moc"
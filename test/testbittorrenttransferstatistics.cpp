@@ -0,0 +1,116 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QDate>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/transferstatistics.h"
+#include "base/global.h"
+
+using BitTorrent::TransferStatistics;
+using BitTorrent::TransferTotals;
+
+namespace
+{
+    const BitTorrent::TorrentID torrentID = BitTorrent::TorrentID::fromString(u"0123456789abcdef0123456789abcdef01234567"_s);
+}
+
+class TestBittorrentTransferStatistics final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentTransferStatistics)
+
+public:
+    TestBittorrentTransferStatistics() = default;
+
+private slots:
+    void testSessionTransfer() const
+    {
+        TransferStatistics statistics;
+        const QDate day {2024, 1, 1};
+
+        statistics.addSessionTransfer(day, {});
+        QVERIFY(!statistics.hasPending());
+
+        statistics.addSessionTransfer(day, {.downloaded = 10, .uploaded = 1});
+        statistics.addSessionTransfer(day, {.downloaded = 5, .uploaded = 2});
+        statistics.addSessionTransfer(day.addDays(1), {.downloaded = 1, .uploaded = 0});
+        QVERIFY(statistics.hasPending());
+
+        const TransferStatistics::Pending pending = statistics.takePending();
+        QCOMPARE(pending.allTime.downloaded, 16);
+        QCOMPARE(pending.allTime.uploaded, 3);
+        QCOMPARE(pending.days.size(), 2);
+        QCOMPARE(pending.days[day].downloaded, 15);
+        QCOMPARE(pending.days[day].uploaded, 3);
+        QCOMPARE(pending.days[day.addDays(1)].downloaded, 1);
+        QVERIFY(!statistics.hasPending());
+    }
+
+    void testTorrentTransfer() const
+    {
+        TransferStatistics statistics;
+
+        // totals transferred before are not counted
+        statistics.updateTorrent(torrentID, u"movies"_s, u"tracker.example"_s, {.downloaded = 100, .uploaded = 50});
+        QVERIFY(!statistics.hasPending());
+
+        statistics.updateTorrent(torrentID, u"movies"_s, u"tracker.example"_s, {.downloaded = 130, .uploaded = 60});
+        statistics.updateTorrent(torrentID, u"movies"_s, QString(), {.downloaded = 140, .uploaded = 60});
+
+        const TransferStatistics::Pending pending = statistics.takePending();
+        QVERIFY(pending.allTime.isEmpty());
+        QCOMPARE(pending.categories[u"movies"_s].downloaded, 40);
+        QCOMPARE(pending.categories[u"movies"_s].uploaded, 10);
+        QCOMPARE(pending.trackers.size(), 1);
+        QCOMPARE(pending.trackers[u"tracker.example"_s].downloaded, 30);
+        QCOMPARE(pending.trackers[u"tracker.example"_s].uploaded, 10);
+    }
+
+    void testTorrentCountersReset() const
+    {
+        TransferStatistics statistics;
+
+        statistics.updateTorrent(torrentID, {}, {}, {.downloaded = 100, .uploaded = 50});
+        statistics.updateTorrent(torrentID, {}, {}, {.downloaded = 10, .uploaded = 5});
+        QVERIFY(!statistics.hasPending());
+
+        statistics.updateTorrent(torrentID, {}, {}, {.downloaded = 20, .uploaded = 5});
+        QCOMPARE(statistics.takePending().categories[QString()].downloaded, 10);
+
+        statistics.removeTorrent(torrentID);
+        statistics.updateTorrent(torrentID, {}, {}, {.downloaded = 50, .uploaded = 5});
+        QVERIFY(!statistics.hasPending());
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentTransferStatistics)
+#include "testbittorrenttransferstatistics.moc"
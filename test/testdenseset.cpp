@@ -0,0 +1,97 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/denseset.h"
+#include "base/global.h"
+
+class TestDenseSet final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestDenseSet)
+
+public:
+    TestDenseSet() = default;
+
+private slots:
+    void testInsert() const
+    {
+        DenseSet<int> set;
+        QVERIFY(set.isEmpty());
+        QVERIFY(set.insert(1));
+        QVERIFY(set.insert(2));
+        QVERIFY(!set.insert(1));
+        QCOMPARE(set.size(), 2);
+        QVERIFY(set.contains(2));
+        QVERIFY(!set.contains(3));
+        QCOMPARE(QList<int>(set.begin(), set.end()), QList<int>({1, 2}));
+    }
+
+    void testRemove() const
+    {
+        DenseSet<int> set;
+        for (const int value : {1, 2, 3, 4})
+            set.insert(value);
+
+        // last value is moved to the place of the removed one
+        QVERIFY(set.remove(2));
+        QVERIFY(!set.remove(2));
+        QCOMPARE(QList<int>(set.values().begin(), set.values().end()), QList<int>({1, 4, 3}));
+
+        QVERIFY(set.remove(3));
+        QVERIFY(set.remove(1));
+        QCOMPARE(QList<int>(set.values().begin(), set.values().end()), QList<int>({4}));
+        QVERIFY(set.contains(4));
+        QVERIFY(set.remove(4));
+        QVERIFY(set.isEmpty());
+    }
+
+    void testGeneration() const
+    {
+        DenseSet<int> set;
+        const quint64 initial = set.generation();
+
+        set.insert(1);
+        const quint64 inserted = set.generation();
+        QVERIFY(inserted != initial);
+
+        // unchanged set keeps its generation
+        set.insert(1);
+        set.remove(2);
+        QCOMPARE(set.generation(), inserted);
+
+        set.clear();
+        QVERIFY(set.generation() != inserted);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestDenseSet)
+#include "testdenseset.moc"
@@ -0,0 +1,97 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QTest>
+
+#include "base/global.h"
+#include "base/http/byterange.h"
+
+using Http::ByteRange;
+using Http::ByteRangeStatus;
+
+class TestHttpByteRange final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestHttpByteRange)
+
+public:
+    TestHttpByteRange() = default;
+
+private slots:
+    void testSatisfiable() const
+    {
+        ByteRange range;
+
+        QCOMPARE(Http::parseByteRange(u"bytes=0-499", 1000, range), ByteRangeStatus::Satisfiable);
+        QCOMPARE(range, (ByteRange {.first = 0, .last = 499}));
+        QCOMPARE(range.size(), qint64 {500});
+
+        QCOMPARE(Http::parseByteRange(u"bytes=500-", 1000, range), ByteRangeStatus::Satisfiable);
+        QCOMPARE(range, (ByteRange {.first = 500, .last = 999}));
+
+        QCOMPARE(Http::parseByteRange(u"bytes=-200", 1000, range), ByteRangeStatus::Satisfiable);
+        QCOMPARE(range, (ByteRange {.first = 800, .last = 999}));
+
+        // bounds exceeding the resource are clamped
+        QCOMPARE(Http::parseByteRange(u"bytes=900-5000", 1000, range), ByteRangeStatus::Satisfiable);
+        QCOMPARE(range, (ByteRange {.first = 900, .last = 999}));
+        QCOMPARE(Http::parseByteRange(u"bytes=-5000", 1000, range), ByteRangeStatus::Satisfiable);
+        QCOMPARE(range, (ByteRange {.first = 0, .last = 999}));
+
+        QCOMPARE(Http::parseByteRange(u" Bytes=10 - 20 ", 1000, range), ByteRangeStatus::Satisfiable);
+        QCOMPARE(range, (ByteRange {.first = 10, .last = 20}));
+    }
+
+    void testUnsatisfiable() const
+    {
+        ByteRange range;
+
+        QCOMPARE(Http::parseByteRange(u"bytes=1000-", 1000, range), ByteRangeStatus::Unsatisfiable);
+        QCOMPARE(Http::parseByteRange(u"bytes=2000-3000", 1000, range), ByteRangeStatus::Unsatisfiable);
+        QCOMPARE(Http::parseByteRange(u"bytes=-0", 1000, range), ByteRangeStatus::Unsatisfiable);
+        QCOMPARE(Http::parseByteRange(u"bytes=0-", 0, range), ByteRangeStatus::Unsatisfiable);
+        QCOMPARE(Http::parseByteRange(u"bytes=-10", 0, range), ByteRangeStatus::Unsatisfiable);
+    }
+
+    void testIgnored() const
+    {
+        ByteRange range;
+
+        QCOMPARE(Http::parseByteRange(u"", 1000, range), ByteRangeStatus::None);
+        QCOMPARE(Http::parseByteRange(u"items=0-10", 1000, range), ByteRangeStatus::None);
+        QCOMPARE(Http::parseByteRange(u"bytes=0-10,20-30", 1000, range), ByteRangeStatus::None);
+        QCOMPARE(Http::parseByteRange(u"bytes=20-10", 1000, range), ByteRangeStatus::None);
+        QCOMPARE(Http::parseByteRange(u"bytes=abc-", 1000, range), ByteRangeStatus::None);
+        QCOMPARE(Http::parseByteRange(u"bytes=-", 1000, range), ByteRangeStatus::None);
+        QCOMPARE(Http::parseByteRange(u"bytes=10", 1000, range), ByteRangeStatus::None);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestHttpByteRange)
+#include "testhttpbyterange.moc"
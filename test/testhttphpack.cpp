@@ -0,0 +1,150 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/http/hpack.h"
+
+using Http::HPack::HeaderField;
+using Http::HPack::HeaderList;
+
+class TestHttpHPack final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestHttpHPack)
+
+public:
+    TestHttpHPack() = default;
+
+private slots:
+    void testInteger() const
+    {
+        // [rfc7541] C.1. Integer Representation Examples
+        QByteArray data;
+        Http::HPack::encodeInteger(10, 5, 0x00, data);
+        QCOMPARE(data, QByteArray::fromHex("0a"));
+
+        data.clear();
+        Http::HPack::encodeInteger(1337, 5, 0x00, data);
+        QCOMPARE(data, QByteArray::fromHex("1f9a0a"));
+
+        data.clear();
+        Http::HPack::encodeInteger(42, 8, 0x00, data);
+        QCOMPARE(data, QByteArray::fromHex("2a"));
+
+        qsizetype pos = 0;
+        quint64 value = 0;
+        QVERIFY(Http::HPack::decodeInteger(QByteArray::fromHex("1f9a0a"), pos, 5, value));
+        QCOMPARE(value, quint64 {1337});
+        QCOMPARE(pos, qsizetype {3});
+
+        pos = 0;
+        QVERIFY(!Http::HPack::decodeInteger(QByteArray::fromHex("1f9a"), pos, 5, value));
+    }
+
+    void testHuffman() const
+    {
+        const QByteArray data = "www.example.com";
+        const QByteArray encodedData = QByteArray::fromHex("f1e3c2e5f23a6ba0ab90f4ff");
+        QCOMPARE(Http::HPack::huffmanEncodedSize(data), encodedData.size());
+
+        QByteArray output;
+        Http::HPack::huffmanEncode(data, output);
+        QCOMPARE(output, encodedData);
+
+        output.clear();
+        QVERIFY(Http::HPack::huffmanDecode(encodedData, output));
+        QCOMPARE(output, data);
+
+        // padding must consist of the most significant bits of EOS and be shorter than 8 bits
+        output.clear();
+        QVERIFY(!Http::HPack::huffmanDecode(QByteArray::fromHex("f1e3c2e5f23a6ba0ab90f4fe"), output));
+        output.clear();
+        QVERIFY(!Http::HPack::huffmanDecode(QByteArray::fromHex("f1e3c2e5f23a6ba0ab90f4ffff"), output));
+    }
+
+    void testDecode() const
+    {
+        // [rfc7541] C.4. Request Examples with Huffman Coding
+        Http::HPack::Decoder decoder;
+
+        HeaderList headers;
+        QVERIFY(decoder.decode(QByteArray::fromHex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), headers));
+        QCOMPARE(headers, (HeaderList {{":method", "GET"}, {":scheme", "http"}, {":path", "/"}
+            , {":authority", "www.example.com"}}));
+
+        headers.clear();
+        QVERIFY(decoder.decode(QByteArray::fromHex("828684be5886a8eb10649cbf"), headers));
+        QCOMPARE(headers, (HeaderList {{":method", "GET"}, {":scheme", "http"}, {":path", "/"}
+            , {":authority", "www.example.com"}, {"cache-control", "no-cache"}}));
+
+        headers.clear();
+        QVERIFY(decoder.decode(QByteArray::fromHex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf"), headers));
+        QCOMPARE(headers, (HeaderList {{":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"}
+            , {":authority", "www.example.com"}, {"custom-key", "custom-value"}}));
+
+        // index beyond the dynamic table
+        headers.clear();
+        QVERIFY(!Http::HPack::Decoder().decode(QByteArray::fromHex("be"), headers));
+
+        // table size update larger than the allowed one
+        headers.clear();
+        QVERIFY(!Http::HPack::Decoder(256).decode(QByteArray::fromHex("3fe11f"), headers));
+    }
+
+    void testEncode() const
+    {
+        const HeaderList headers {{":status", "200"}, {"content-type", "application/json"}
+            , {"x-frame-options", "SAMEORIGIN"}, {"content-length", "1024"}};
+
+        Http::HPack::Encoder encoder;
+        Http::HPack::Decoder decoder;
+        const QByteArray firstBlock = encoder.encode(headers);
+        const QByteArray secondBlock = encoder.encode(headers);
+        // repeated values are referenced in the dynamic table
+        QVERIFY(secondBlock.size() < firstBlock.size());
+
+        HeaderList decodedHeaders;
+        QVERIFY(decoder.decode(firstBlock, decodedHeaders));
+        QCOMPARE(decodedHeaders, headers);
+        decodedHeaders.clear();
+        QVERIFY(decoder.decode(secondBlock, decodedHeaders));
+        QCOMPARE(decodedHeaders, headers);
+
+        // table size change is signalled to the decoder
+        encoder.setMaxTableSize(0);
+        decodedHeaders.clear();
+        QVERIFY(decoder.decode(encoder.encode(headers), decodedHeaders));
+        QCOMPARE(decodedHeaders, headers);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestHttpHPack)
+#include "testhttphpack.moc"
@@ -0,0 +1,154 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/logbuffer.h"
+
+namespace
+{
+    struct Entry
+    {
+        int id = -1;
+        QString text;
+    };
+
+    QList<int> ids(const LogBuffer<Entry>::View &view)
+    {
+        QList<int> result;
+        for (const Entry &entry : view)
+            result.append(entry.id);
+        return result;
+    }
+}
+
+class TestLogBuffer final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestLogBuffer)
+
+public:
+    TestLogBuffer() = default;
+
+private slots:
+    void testEmpty() const
+    {
+        const LogBuffer<Entry> buffer {10};
+        QVERIFY(buffer.view().isEmpty());
+        QVERIFY(buffer.view(5).isEmpty());
+    }
+
+    void testAppend() const
+    {
+        LogBuffer<Entry> buffer {10};
+        QCOMPARE(buffer.append({.text = u"a"_s}).id, 0);
+        QCOMPARE(buffer.append({.text = u"b"_s}).id, 1);
+        QCOMPARE(buffer.append({.text = u"c"_s}).id, 2);
+
+        const LogBuffer<Entry>::View view = buffer.view();
+        QCOMPARE(view.size(), 3);
+        QCOMPARE(view.begin()->text, u"a"_s);
+        QCOMPARE(ids(view), (QList<int> {0, 1, 2}));
+    }
+
+    void testLastKnownID() const
+    {
+        LogBuffer<Entry> buffer {10};
+        for (int i = 0; i < 5; ++i)
+            buffer.append({});
+
+        QCOMPARE(ids(buffer.view(2)), (QList<int> {3, 4}));
+        QVERIFY(buffer.view(4).isEmpty());
+        // unknown IDs, e.g. of the previous run, result in no entries
+        QVERIFY(buffer.view(100).isEmpty());
+    }
+
+    void testCapacity() const
+    {
+        const int capacity = 1000;
+        LogBuffer<Entry> buffer {capacity};
+        for (int i = 0; i < 5000; ++i)
+            buffer.append({});
+
+        const LogBuffer<Entry>::View view = buffer.view();
+        QCOMPARE(view.size(), capacity);
+        QCOMPARE(view.begin()->id, (5000 - capacity));
+
+        // entries that are no longer kept are skipped
+        QCOMPARE(buffer.view(10).size(), capacity);
+        QCOMPARE(buffer.view(4997).size(), 2);
+    }
+
+    void testViewIsStable() const
+    {
+        LogBuffer<Entry> buffer {100};
+        for (int i = 0; i < 10; ++i)
+            buffer.append({.text = QString::number(i)});
+
+        const LogBuffer<Entry>::View view = buffer.view();
+        // the entries of the view are kept even if they are no longer in the buffer
+        for (int i = 0; i < 2000; ++i)
+            buffer.append({});
+
+        QCOMPARE(view.size(), 10);
+        int i = 0;
+        for (const Entry &entry : view)
+        {
+            QCOMPARE(entry.id, i);
+            QCOMPARE(entry.text, QString::number(i));
+            ++i;
+        }
+        QCOMPARE(buffer.view().begin()->id, 1910);
+    }
+
+    void testRandomAccess() const
+    {
+        LogBuffer<Entry> buffer {1000};
+        for (int i = 0; i < 3000; ++i)
+            buffer.append({.text = QString::number(i)});
+
+        const LogBuffer<Entry>::View view = buffer.view();
+        QCOMPARE(view.firstID(), 2000);
+        QCOMPARE(view.at(0).id, 2000);
+        QCOMPARE(view.at(511).text, u"2511"_s);
+        QCOMPARE(view.at(999).id, 2999);
+
+        const LogBuffer<Entry>::View recent = buffer.view(2990);
+        QCOMPARE(recent.firstID(), 2991);
+        QCOMPARE(recent.at(0).text, u"2991"_s);
+        QVERIFY(buffer.view(5000).isEmpty());
+        QCOMPARE(buffer.view(5000).firstID(), 3000);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestLogBuffer)
+#include "testlogbuffer.moc"
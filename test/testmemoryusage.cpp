@@ -0,0 +1,100 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <memory>
+
+#include <QObject>
+#include <QTest>
+#include <QVariant>
+
+#include "base/global.h"
+#include "base/memoryusage.h"
+
+class TestMemoryUsage final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestMemoryUsage)
+
+public:
+    TestMemoryUsage() = default;
+
+private slots:
+    void testReport() const
+    {
+        QVERIFY(MemoryUsage::report().isEmpty());
+
+        auto first = std::make_unique<QObject>();
+        MemoryUsage::registerEstimator(first.get(), []() -> QList<MemoryUsage::Entry>
+        {
+            return {{u"b"_s, 2, 20}, {u"a"_s, 1, 10}};
+        });
+        auto second = std::make_unique<QObject>();
+        MemoryUsage::registerEstimator(second.get(), []() -> QList<MemoryUsage::Entry>
+        {
+            return {{u"b"_s, 3, 30}};
+        });
+
+        QList<MemoryUsage::Entry> report = MemoryUsage::report();
+        QCOMPARE(report.size(), 2);
+        QCOMPARE(report[0].name, u"a"_s);
+        QCOMPARE(report[0].count, 1);
+        QCOMPARE(report[0].bytes, 10);
+        QCOMPARE(report[1].name, u"b"_s);
+        QCOMPARE(report[1].count, 5);
+        QCOMPARE(report[1].bytes, 50);
+
+        // estimators are unregistered along with their owners
+        first.reset();
+        report = MemoryUsage::report();
+        QCOMPARE(report.size(), 1);
+        QCOMPARE(report[0].count, 3);
+
+        second.reset();
+        QVERIFY(MemoryUsage::report().isEmpty());
+    }
+
+    void testSizeOf() const
+    {
+        QString str;
+        str.reserve(100);
+        QVERIFY(MemoryUsage::sizeOf(str) >= static_cast<qint64>(sizeof(QString) + (100 * sizeof(QChar))));
+
+        const QString value = u"value"_s;
+        const qint64 stringSize = MemoryUsage::sizeOf(QVariant(value));
+        QVERIFY(stringSize > static_cast<qint64>(sizeof(QVariant)));
+
+        // the containers include the size of their items
+        const QVariantMap map {{u"key"_s, value}};
+        QVERIFY(MemoryUsage::sizeOf(QVariant(map)) > stringSize);
+        QVERIFY(MemoryUsage::sizeOf(QVariant(QVariantList {value, value})) > (2 * stringSize));
+        QCOMPARE(MemoryUsage::sizeOf(QVariant(42)), static_cast<qint64>(sizeof(QVariant)));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestMemoryUsage)
+#include "testmemoryusage.moc"
@@ -0,0 +1,101 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/multistringmatcher.h"
+
+namespace
+{
+    QList<qsizetype> sorted(QList<qsizetype> list)
+    {
+        std::sort(list.begin(), list.end());
+        return list;
+    }
+}
+
+class TestMultiStringMatcher final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestMultiStringMatcher)
+
+public:
+    TestMultiStringMatcher() = default;
+
+private slots:
+    void testEmpty() const
+    {
+        const MultiStringMatcher matcher;
+        QCOMPARE(matcher.patternCount(), 0);
+        QVERIFY(matcher.matchedPatterns(u"text"_s).isEmpty());
+
+        const MultiStringMatcher emptyPatternMatcher {{u""_s}};
+        QCOMPARE(emptyPatternMatcher.patternCount(), 1);
+        QVERIFY(emptyPatternMatcher.matchedPatterns(u"text"_s).isEmpty());
+    }
+
+    void testMatch() const
+    {
+        const MultiStringMatcher matcher {{u"he"_s, u"she"_s, u"his"_s, u"hers"_s}};
+        QCOMPARE(matcher.patternCount(), 4);
+        QCOMPARE(sorted(matcher.matchedPatterns(u"ushers"_s)), (QList<qsizetype> {0, 1, 3}));
+        QCOMPARE(matcher.matchedPatterns(u"this"_s), QList<qsizetype> {2});
+        QVERIFY(matcher.matchedPatterns(u"hx sh"_s).isEmpty());
+        QVERIFY(matcher.matchedPatterns(u""_s).isEmpty());
+    }
+
+    void testReportedOnce() const
+    {
+        const MultiStringMatcher matcher {{u"a"_s, u"aa"_s}};
+        QCOMPARE(sorted(matcher.matchedPatterns(u"aaaa"_s)), (QList<qsizetype> {0, 1}));
+    }
+
+    void testDuplicatePatterns() const
+    {
+        const MultiStringMatcher matcher {{u"abc"_s, u"x"_s, u"abc"_s}};
+        QCOMPARE(sorted(matcher.matchedPatterns(u"zabcz"_s)), (QList<qsizetype> {0, 2}));
+    }
+
+    void testCaseSensitivity() const
+    {
+        const MultiStringMatcher sensitive {{u"Show"_s}};
+        QVERIFY(sensitive.matchedPatterns(u"the show s01"_s).isEmpty());
+        QCOMPARE(sensitive.matchedPatterns(u"The Show S01"_s), QList<qsizetype> {0});
+
+        const MultiStringMatcher insensitive {{u"Show"_s, u"1080P"_s}, Qt::CaseInsensitive};
+        QCOMPARE(sorted(insensitive.matchedPatterns(u"THE SHOW s01 1080p"_s)), (QList<qsizetype> {0, 1}));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestMultiStringMatcher)
+#include "testmultistringmatcher.moc"
@@ -0,0 +1,144 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/path.h"
+#include "base/pathinterner.h"
+
+class TestPathInterner final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestPathInterner)
+
+public:
+    TestPathInterner() = default;
+
+private slots:
+    void testIntern() const
+    {
+        PathInterner interner;
+        QCOMPARE(interner.size(), 1);
+        QCOMPARE(interner.intern(Path()), PathInterner::ROOT_ID);
+
+        const PathInterner::ID fileID = interner.intern(Path(u"folder/subfolder/file.txt"_s));
+        QCOMPARE(interner.size(), 4);
+        QCOMPARE(interner.intern(Path(u"folder/subfolder/file.txt"_s)), fileID);
+        QCOMPARE(interner.size(), 4);
+
+        const PathInterner::ID otherFileID = interner.intern(Path(u"folder/subfolder/other.txt"_s));
+        QVERIFY(otherFileID != fileID);
+        QCOMPARE(interner.size(), 5);
+        QCOMPARE(interner.parent(otherFileID), interner.parent(fileID));
+
+        const PathInterner::ID folderID = interner.find(Path(u"folder"_s));
+        QCOMPARE(interner.parent(folderID), PathInterner::ROOT_ID);
+        QCOMPARE(interner.intern(folderID, u"subfolder"), interner.parent(fileID));
+        QCOMPARE(interner.size(), 5);
+    }
+
+    void testFind() const
+    {
+        PathInterner interner;
+        const PathInterner::ID fileID = interner.intern(Path(u"folder/file.txt"_s));
+
+        QCOMPARE(interner.find(Path(u"folder/file.txt"_s)), fileID);
+        QCOMPARE(interner.find(Path()), PathInterner::ROOT_ID);
+        QCOMPARE(interner.find(Path(u"folder/other.txt"_s)), PathInterner::INVALID_ID);
+        QCOMPARE(interner.find(Path(u"other/file.txt"_s)), PathInterner::INVALID_ID);
+        QCOMPARE(interner.find(Path(u"Folder/file.txt"_s)), PathInterner::INVALID_ID);
+        QCOMPARE(interner.find(PathInterner::INVALID_ID, u"folder"), PathInterner::INVALID_ID);
+        QCOMPARE(interner.size(), 3);
+    }
+
+    void testCaseInsensitive() const
+    {
+        PathInterner interner {Qt::CaseInsensitive};
+        const PathInterner::ID fileID = interner.intern(Path(u"Folder/File.txt"_s));
+
+        QCOMPARE(interner.find(Path(u"folder/file.TXT"_s)), fileID);
+        QCOMPARE(interner.intern(Path(u"FOLDER/file.txt"_s)), fileID);
+        QCOMPARE(interner.name(fileID), u"File.txt"_s);
+    }
+
+    void testPath() const
+    {
+        PathInterner interner;
+
+        const Path relativePath {u"folder/subfolder/file.txt"_s};
+        QCOMPARE(interner.path(interner.intern(relativePath)), relativePath);
+
+        const Path absolutePath {u"/home/user/file.txt"_s};
+        QCOMPARE(interner.path(interner.intern(absolutePath)), absolutePath);
+
+        QCOMPARE(interner.path(PathInterner::ROOT_ID), Path());
+        QCOMPARE(interner.path(PathInterner::INVALID_ID), Path());
+    }
+
+    void testNodeInfo() const
+    {
+        PathInterner interner;
+        const PathInterner::ID fileID = interner.intern(Path(u"folder/subfolder/file.txt"_s));
+        const PathInterner::ID subfolderID = interner.parent(fileID);
+        const PathInterner::ID folderID = interner.parent(subfolderID);
+
+        QCOMPARE(interner.name(fileID), u"file.txt"_s);
+        QCOMPARE(interner.name(subfolderID), u"subfolder"_s);
+        QCOMPARE(interner.depth(fileID), 3);
+        QCOMPARE(interner.depth(folderID), 1);
+        QCOMPARE(interner.depth(PathInterner::ROOT_ID), 0);
+        QCOMPARE(interner.parent(PathInterner::ROOT_ID), PathInterner::INVALID_ID);
+
+        QVERIFY(interner.hasAncestor(fileID, folderID));
+        QVERIFY(interner.hasAncestor(fileID, PathInterner::ROOT_ID));
+        QVERIFY(!interner.hasAncestor(folderID, fileID));
+        QVERIFY(!interner.hasAncestor(fileID, fileID));
+
+        // equal paths have equal hashes in any interner
+        PathInterner otherInterner;
+        otherInterner.intern(Path(u"unrelated/file.txt"_s));
+        QCOMPARE(otherInterner.hash(otherInterner.intern(Path(u"folder/subfolder/file.txt"_s))), interner.hash(fileID));
+    }
+
+    void testClear() const
+    {
+        PathInterner interner;
+        interner.intern(Path(u"folder/file.txt"_s));
+        interner.clear();
+
+        QCOMPARE(interner.size(), 1);
+        QCOMPARE(interner.find(Path(u"folder"_s)), PathInterner::INVALID_ID);
+        QCOMPARE(interner.intern(Path(u"other"_s)), PathInterner::ID {1});
+    }
+};
+
+QTEST_APPLESS_MAIN(TestPathInterner)
+#include "testpathinterner.moc"
@@ -0,0 +1,127 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/search/searchresult.h"
+#include "base/search/searchresultstore.h"
+
+namespace
+{
+    SearchResult makeResult(const QString &name, const QString &fileUrl, const qlonglong size, const qlonglong seeders
+            , const QString &descrLink = {})
+    {
+        SearchResult result;
+        result.fileName = name;
+        result.fileUrl = fileUrl;
+        result.fileSize = size;
+        result.nbSeeders = seeders;
+        result.descrLink = descrLink;
+        return result;
+    }
+}
+
+class TestSearchResultStore final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestSearchResultStore)
+
+public:
+    TestSearchResultStore() = default;
+
+private slots:
+    void testDedupKey() const
+    {
+        QCOMPARE(SearchResultStore::dedupKey(makeResult(u"a"_s, u"magnet:?xt=urn:btih:ABCDEF&dn=a"_s, 0, 0, u"https://a.example.org/1"_s))
+                , u"btih:abcdef"_s);
+        QCOMPARE(SearchResultStore::dedupKey(makeResult(u"a"_s, u"magnet:?dn=a&xt=urn:btih:abcdef"_s, 0, 0)), u"btih:abcdef"_s);
+        QCOMPARE(SearchResultStore::dedupKey(makeResult(u"a"_s, u"https://a.example.org/a.torrent"_s, 0, 0, u"https://a.example.org/1"_s))
+                , u"https://a.example.org/1"_s);
+        QCOMPARE(SearchResultStore::dedupKey(makeResult(u"a"_s, u"https://a.example.org/a.torrent"_s, 0, 0))
+                , u"https://a.example.org/a.torrent"_s);
+    }
+
+    void testAppend() const
+    {
+        SearchResultStore store {3};
+
+        const QList<SearchResult> added = store.append({
+            makeResult(u"a"_s, u"magnet:?xt=urn:btih:aaaa"_s, 1, 1),
+            makeResult(u"a copy"_s, u"magnet:?xt=urn:btih:AAAA"_s, 1, 1),
+            makeResult(u"b"_s, u"https://b.example.org/b.torrent"_s, 2, 2)
+        });
+        QCOMPARE(added.size(), 2);
+        QCOMPARE(store.size(), 2);
+        QCOMPARE(store.duplicateCount(), 1);
+        QCOMPARE(store.at(1).fileName, u"b"_s);
+
+        store.append({
+            makeResult(u"c"_s, u"https://c.example.org/c.torrent"_s, 3, 3),
+            makeResult(u"d"_s, u"https://d.example.org/d.torrent"_s, 4, 4)
+        });
+        QCOMPARE(store.size(), 3);
+        QCOMPARE(store.droppedCount(), 1);
+    }
+
+    void testSelect() const
+    {
+        SearchResultStore store;
+        store.append({
+            makeResult(u"Ubuntu Desktop"_s, u"https://example.org/1"_s, 300, 10),
+            makeResult(u"Debian"_s, u"https://example.org/2"_s, 100, 50),
+            makeResult(u"Ubuntu Server"_s, u"https://example.org/3"_s, 200, 5)
+        });
+
+        QVERIFY(SearchResultStore::Query().isEmpty());
+
+        const SearchResultStore::Query bySize {.sortColumn = SearchResultStore::SortColumn::Size};
+        QCOMPARE(store.select(bySize), (QList<int> {1, 2, 0}));
+
+        // new results are merged into existing index
+        store.append({makeResult(u"Fedora"_s, u"https://example.org/4"_s, 150, 20)});
+        QCOMPARE(store.select(bySize), (QList<int> {1, 3, 2, 0}));
+
+        const SearchResultStore::Query bySeeders {.sortColumn = SearchResultStore::SortColumn::Seeders, .descending = true};
+        QCOMPARE(store.select(bySeeders), (QList<int> {1, 3, 0, 2}));
+
+        const SearchResultStore::Query byName {.nameFilter = u"ubuntu desk"_s};
+        QCOMPARE(store.select(byName), (QList<int> {0}));
+
+        const SearchResultStore::Query bySizeRange {.minSize = 150, .maxSize = 250};
+        QCOMPARE(store.select(bySizeRange), (QList<int> {2, 3}));
+
+        const SearchResultStore::Query byMinSeeders {.minSeeders = 20};
+        QCOMPARE(store.select(byMinSeeders), (QList<int> {1, 3}));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestSearchResultStore)
+#include "testsearchresultstore.moc"
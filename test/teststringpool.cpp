@@ -0,0 +1,89 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/stringpool.h"
+
+class TestStringPool final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestStringPool)
+
+public:
+    TestStringPool() = default;
+
+private slots:
+    void testIntern() const
+    {
+        StringPool pool;
+
+        const QString str1 = QString::fromLatin1("udp://tracker.example.org:6969/announce");
+        const QString str2 = QString::fromLatin1("udp://tracker.example.org:6969/announce");
+        QVERIFY(str1.constData() != str2.constData());
+
+        const QString interned1 = pool.intern(str1);
+        const QString interned2 = pool.intern(str2);
+        QCOMPARE(interned1, str1);
+        QCOMPARE(interned2, str2);
+        QCOMPARE(interned1.constData(), interned2.constData());
+        QCOMPARE(pool.size(), 1);
+        QVERIFY(pool.contains(str2));
+
+        QVERIFY(pool.intern({}).isEmpty());
+        QCOMPARE(pool.size(), 1);
+    }
+
+    void testPurge() const
+    {
+        StringPool pool;
+
+        QString used = pool.intern(QString::fromLatin1("used"));
+        pool.intern(QString::fromLatin1("unused"));
+        QCOMPARE(pool.size(), 2);
+
+        pool.purge();
+        QCOMPARE(pool.size(), 1);
+        QVERIFY(pool.contains(u"used"_s));
+        QVERIFY(!pool.contains(u"unused"_s));
+
+        used.clear();
+        pool.purge();
+        QCOMPARE(pool.size(), 0);
+
+        pool.intern(QString::fromLatin1("cleared"));
+        pool.clear();
+        QCOMPARE(pool.size(), 0);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestStringPool)
+#include "teststringpool.moc"
@@ -0,0 +1,93 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/timerwheel.h"
+
+class TestTimerWheel final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestTimerWheel)
+
+public:
+    TestTimerWheel() = default;
+
+private slots:
+    void testEmpty() const
+    {
+        TimerWheel<int> wheel {100};
+        QVERIFY(wheel.isEmpty());
+        QVERIFY(wheel.advance(200).isEmpty());
+        QCOMPARE(wheel.currentTime(), 200);
+    }
+
+    void testExpiresOnDeadline() const
+    {
+        TimerWheel<int> wheel {0};
+        wheel.insert(1, 10);
+        wheel.insert(2, 70);
+        wheel.insert(3, 5000);
+        wheel.insert(4, 300000);
+        QCOMPARE(wheel.count(), 4);
+
+        QVERIFY(wheel.advance(9).isEmpty());
+        QCOMPARE(wheel.advance(10), QList<int> {1});
+        QVERIFY(wheel.advance(69).isEmpty());
+        QCOMPARE(wheel.advance(70), QList<int> {2});
+        QVERIFY(wheel.advance(4999).isEmpty());
+        QCOMPARE(wheel.advance(5000), QList<int> {3});
+        QVERIFY(wheel.advance(299999).isEmpty());
+        QCOMPARE(wheel.advance(300000), QList<int> {4});
+        QVERIFY(wheel.isEmpty());
+    }
+
+    void testBatchExpiration() const
+    {
+        TimerWheel<int> wheel {1000};
+        for (int i = 0; i < 100; ++i)
+            wheel.insert(i, (1000 + (i * 50)));
+
+        const QList<int> expired = wheel.advance(3000);
+        QCOMPARE(expired.size(), 41);
+        QCOMPARE(wheel.count(), 59);
+    }
+
+    void testPastDeadline() const
+    {
+        TimerWheel<int> wheel {1000};
+        wheel.insert(1, 10);
+        QCOMPARE(wheel.advance(1001), QList<int> {1});
+    }
+};
+
+QTEST_APPLESS_MAIN(TestTimerWheel)
+#include "testtimerwheel.moc"
@@ -0,0 +1,129 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+#include <QTest>
+#include <QThread>
+
+#include "base/global.h"
+#include "base/tracing.h"
+
+namespace
+{
+    QJsonArray traceEvents()
+    {
+        return QJsonDocument::fromJson(Tracing::toChromeTraceJson()).object().value(u"traceEvents"_s).toArray();
+    }
+
+    QStringList eventNames(const QJsonArray &events)
+    {
+        QStringList names;
+        for (const QJsonValue &event : events)
+            names.append(event.toObject().value(u"name"_s).toString());
+        return names;
+    }
+}
+
+class TestTracing final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestTracing)
+
+public:
+    TestTracing() = default;
+
+private slots:
+    void init() const
+    {
+        Tracing::setEnabled(false);
+        Tracing::clear();
+    }
+
+    void testDisabled() const
+    {
+        {
+            QBT_TRACE_SCOPE("disabled");
+        }
+        QVERIFY(traceEvents().isEmpty());
+    }
+
+    void testSpans() const
+    {
+        Tracing::setEnabled(true);
+        {
+            QBT_TRACE_SCOPE("outer");
+            {
+                QBT_TRACE_SCOPE("inner");
+                QThread::msleep(2);
+            }
+        }
+        Tracing::setEnabled(false);
+
+        const QJsonArray events = traceEvents();
+        QCOMPARE(eventNames(events), QStringList({u"inner"_s, u"outer"_s}));
+
+        const QJsonObject inner = events[0].toObject();
+        const QJsonObject outer = events[1].toObject();
+        QCOMPARE(inner.value(u"ph"_s).toString(), u"X"_s);
+        QVERIFY(inner.value(u"dur"_s).toInteger() >= 2000);
+        QVERIFY(inner.value(u"ts"_s).toInteger() >= outer.value(u"ts"_s).toInteger());
+        QVERIFY(outer.value(u"dur"_s).toInteger() >= inner.value(u"dur"_s).toInteger());
+        QCOMPARE(inner.value(u"tid"_s), outer.value(u"tid"_s));
+    }
+
+    void testThreads() const
+    {
+        Tracing::setEnabled(true);
+        {
+            QBT_TRACE_SCOPE("main");
+        }
+        QThread *thread = QThread::create([] { QBT_TRACE_SCOPE("worker"); });
+        thread->start();
+        thread->wait();
+        delete thread;
+        Tracing::setEnabled(false);
+
+        const QJsonArray events = traceEvents();
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(eventNames(events), QStringList({u"main"_s, u"worker"_s}));
+        QVERIFY(events[0].toObject().value(u"tid"_s) != events[1].toObject().value(u"tid"_s));
+
+        // spans of finished threads are kept until they are cleared
+        Tracing::clear();
+        QVERIFY(traceEvents().isEmpty());
+    }
+};
+
+QTEST_APPLESS_MAIN(TestTracing)
+#include "testtracing.moc"
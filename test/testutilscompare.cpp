@@ -28,6 +28,7 @@
 
 #include <QLocale>
 #include <QObject>
+#include <QStringList>
 #include <QTest>
 
 #include "base/global.h"
@@ -190,6 +191,33 @@ private slots:
         for (const TestData &data : testData)
             testLessThan(data, cmp(data.lhs, data.rhs), data.caseSensitiveResult);
     }
+
+    void testNaturalSortKeyCaseInsensitive() const
+    {
+        const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> cmp;
+
+        for (const TestData &data : testData)
+            testCompare(data, cmp.sortKey(data.lhs).compare(cmp.sortKey(data.rhs)), data.caseInsensitiveResult);
+    }
+
+    void testNaturalSortKeyCaseSensitive() const
+    {
+        const Utils::Compare::NaturalCompare<Qt::CaseSensitive> cmp;
+
+        for (const TestData &data : testData)
+            testCompare(data, cmp.sortKey(data.lhs).compare(cmp.sortKey(data.rhs)), data.caseSensitiveResult);
+    }
+
+    void testNaturalSort() const
+    {
+        QStringList strings {u"abc100"_s, u"ABC9"_s, u"abc10"_s, u""_s, u"1abc"_s};
+        Utils::Compare::naturalSort<Qt::CaseInsensitive>(strings);
+        QCOMPARE(strings, QStringList({u""_s, u"1abc"_s, u"ABC9"_s, u"abc10"_s, u"abc100"_s}));
+
+        QStringList empty;
+        Utils::Compare::naturalSort<Qt::CaseInsensitive>(empty);
+        QVERIFY(empty.isEmpty());
+    }
 };
 
 QTEST_APPLESS_MAIN(TestUtilsCompare)
@@ -65,6 +65,95 @@ private slots:
         QVERIFY(ok);
         QCOMPARE(decompressedData, data);
     }
+
+    void testCompressParallel() const
+    {
+        QByteArray data;
+        for (int i = 0; i < 1000000; ++i)
+            data += QByteArray::number(i) + ',';
+        QVERIFY(data.size() > (4 * 1024 * 1024));
+
+        for (const qsizetype size : {qsizetype(3), qsizetype(1024 * 1024), qsizetype(1024 * 1024 + 1), data.size()})
+        {
+            const QByteArray input = data.left(size);
+
+            bool ok = false;
+            const QByteArray compressedData = Utils::Gzip::compressParallel(input, 6, &ok);
+            QVERIFY(ok);
+            QVERIFY(compressedData != input);
+
+            ok = false;
+            const QByteArray decompressedData = Utils::Gzip::decompress(compressedData, &ok);
+            QVERIFY(ok);
+            QCOMPARE(decompressedData, input);
+
+            Utils::Gzip::Decompressor decompressor;
+            QByteArray streamedData;
+            QVERIFY(decompressor.decompress(compressedData, streamedData));
+            QVERIFY(decompressor.isFinished());
+            QCOMPARE(streamedData, input);
+        }
+    }
+
+    void testAdaptiveLevel() const
+    {
+        QCOMPARE(Utils::Gzip::adaptiveLevel(1024), 6);
+        QVERIFY(Utils::Gzip::adaptiveLevel(32 * 1024 * 1024) < 6);
+        QVERIFY(Utils::Gzip::adaptiveLevel(32 * 1024 * 1024) <= Utils::Gzip::adaptiveLevel(4 * 1024 * 1024));
+    }
+
+    void testCompressor() const
+    {
+        QByteArray data;
+        for (int i = 0; i < 100000; ++i)
+            data += QByteArray::number(i) + ',';
+
+        Utils::Gzip::Compressor compressor;
+        QByteArray compressedData;
+        for (qsizetype i = 0; i < data.size(); i += 4096)
+        {
+            QVERIFY(compressor.compress(QByteArrayView(data).mid(i, 4096), compressedData));
+
+            // the data compressed so far can be decompressed without the end of stream
+            Utils::Gzip::Decompressor decompressor;
+            QByteArray decompressedData;
+            QVERIFY(decompressor.decompress(compressedData, decompressedData));
+            QCOMPARE(decompressedData, data.left(i + 4096));
+        }
+        QVERIFY(compressor.finish(compressedData));
+        QVERIFY(!compressor.compress(QByteArrayView("abc"), compressedData));
+
+        bool ok = false;
+        const QByteArray decompressedData = Utils::Gzip::decompress(compressedData, &ok);
+        QVERIFY(ok);
+        QCOMPARE(decompressedData, data);
+    }
+
+    void testDecompressor() const
+    {
+        QByteArray data;
+        for (int i = 0; i < 100000; ++i)
+            data += QByteArray::number(i) + ',';
+
+        bool ok = false;
+        const QByteArray compressedData = Utils::Gzip::compress(data, 6, &ok);
+        QVERIFY(ok);
+
+        for (const int chunkSize : {1, 7, 4096, static_cast<int>(compressedData.size())})
+        {
+            Utils::Gzip::Decompressor decompressor;
+            QByteArray decompressedData;
+            for (qsizetype i = 0; i < compressedData.size(); i += chunkSize)
+                QVERIFY(decompressor.decompress(QByteArrayView(compressedData).mid(i, chunkSize), decompressedData));
+            QVERIFY(decompressor.isFinished());
+            QCOMPARE(decompressedData, data);
+        }
+
+        Utils::Gzip::Decompressor decompressor;
+        QByteArray decompressedData;
+        QVERIFY(!decompressor.decompress(QByteArrayView("not compressed data"), decompressedData));
+        QVERIFY(!decompressor.isFinished());
+    }
 };
 
 QTEST_APPLESS_MAIN(TestUtilsGzip)
@@ -115,6 +115,47 @@ private slots:
             QCOMPARE(readResult.has_value(), true);
             QCOMPARE(readResult.value().length(), 0);
         }
+#endif
+    }
+
+    void testMapFile() const
+    {
+        const Path testFolder = Path(QString::fromUtf8(__FILE__)).parentPath() / Path(u"testdata"_s);
+
+        const Path size10File = testFolder / Path(u"size10.txt"_s);
+        const QByteArray size10Data = QByteArrayLiteral("123456789\n");
+
+        {
+            const auto mapResult = Utils::IO::mapFile(size10File, 9);
+            QCOMPARE(mapResult.has_value(), false);
+            QCOMPARE(mapResult.error().status, Utils::IO::ReadError::ExceedSize);
+            QCOMPARE(mapResult.error().message.isEmpty(), false);
+        }
+        {
+            const auto mapResult = Utils::IO::mapFile(size10File, 10);
+            QCOMPARE(mapResult.has_value(), true);
+            QCOMPARE(mapResult.value()->data(), size10Data);
+        }
+        {
+            const auto mapResult = Utils::IO::mapFile(size10File, -1);
+            QCOMPARE(mapResult.has_value(), true);
+            QCOMPARE(mapResult.value()->data(), size10Data);
+        }
+
+        {
+            const Path nonExistFile = testFolder / Path(u".non_existent_file_1234"_s);
+            const auto mapResult = Utils::IO::mapFile(nonExistFile, 1);
+            QCOMPARE(mapResult.has_value(), false);
+            QCOMPARE(mapResult.error().status, Utils::IO::ReadError::NotExist);
+            QCOMPARE(mapResult.error().message.isEmpty(), false);
+        }
+
+#ifdef Q_OS_UNIX
+        {
+            const auto mapResult = Utils::IO::mapFile(Path(u"/dev/null"_s), -1);
+            QCOMPARE(mapResult.has_value(), true);
+            QCOMPARE(mapResult.value()->data().length(), 0);
+        }
 #endif
     }
 };